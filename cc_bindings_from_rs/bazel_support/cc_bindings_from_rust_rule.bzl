@@ -38,10 +38,15 @@ load(
     "compile_rust",
 )
 load("@bazel_tools//tools/cpp:toolchain_utils.bzl", "find_cpp_toolchain", "use_cpp_toolchain")
+load("@bazel_skylib//rules:common_settings.bzl", "BuildSettingInfo")
 load(
     "//rs_bindings_from_cc/bazel_support:providers.bzl",
     "RustBindingsFromCcInfo",
 )
+load(
+    "//cc_bindings_from_rs/bazel_support:generic_fn_instantiations_aspect_hint.bzl",
+    "collect_generic_fn_instantiations",
+)
 
 # Targets which do not receive C++ bindings at all.
 targets_to_remove = [
@@ -93,8 +98,12 @@ def _generate_bindings(ctx, basename, inputs, rustc_args, rustc_env):
       rustc_env: `rustc` environment to use when running `cc_bindings_from_rs`
 
     Returns:
-      A pair of files:
+      A tuple of:
       - h_out_file (named "<basename>_cc_api.h")
+      - h_shards_out_files: a list with the directory with the per-module
+        shards of the header (named "<basename>_cc_api_shards") if
+        `//cc_bindings_from_rs/bazel_support:shard_headers` is set, and an
+        empty list otherwise
       - rs_out_file (named "<basename>_cc_api_impl.rs")
     """
     h_out_file = ctx.actions.declare_file(basename + "_cc_api.h")
@@ -104,6 +113,13 @@ def _generate_bindings(ctx, basename, inputs, rustc_args, rustc_env):
     crubit_args.add("--h-out", h_out_file)
     crubit_args.add("--rs-out", rs_out_file)
 
+    h_shards_out_files = []
+    if ctx.attr._shard_headers[BuildSettingInfo].value:
+        h_shards_out = ctx.actions.declare_directory(basename + "_cc_api_shards")
+        crubit_args.add("--h-shards-out", h_shards_out.path)
+        crubit_args.add("--h-shards-include-dir", h_shards_out.short_path)
+        h_shards_out_files.append(h_shards_out)
+
     crubit_args.add("--crubit-support-path", "support")
 
     crubit_args.add("--clang-format-exe-path", ctx.file._clang_format)
@@ -114,28 +130,54 @@ def _generate_bindings(ctx, basename, inputs, rustc_args, rustc_env):
         arg = dep_bindings_info.crate_key + "=" + dep_bindings_info.h_out_file.short_path
         crubit_args.add("--bindings-from-dependency", arg)
 
+    for instantiation in collect_generic_fn_instantiations(ctx):
+        crubit_args.add("--instantiate-generic-fn", instantiation)
+
+    if ctx.attr._skip_analysis[BuildSettingInfo].value:
+        crubit_args.add("--skip-analysis")
+
+    crubit_args.add("--")
+
+    # TODO(lukasza): Figure out why we need a '-Cpanic=abort' here.
+    rustc_args.add("-Cpanic=abort")
+
+    execution_requirements = {}
+    if ctx.attr._use_persistent_worker[BuildSettingInfo].value:
+        # A persistent worker gets the arguments of each action from its params
+        # files.  The arguments of all the `Args` objects have to go through
+        # params files, so that none of them become part of the worker key.
+        for args in [crubit_args, rustc_args]:
+            args.use_param_file("@%s", use_always = True)
+            args.set_param_file_format("multiline")
+        execution_requirements = {
+            "requires-worker-protocol": "json",
+            "supports-workers": "1",
+        }
+
     ctx.actions.run(
-        outputs = [h_out_file, rs_out_file],
+        outputs = [h_out_file, rs_out_file] + h_shards_out_files,
         inputs = depset(
             [ctx.file._clang_format, ctx.file._rustfmt, ctx.file._rustfmt_cfg],
             transitive = [inputs],
         ),
         env = rustc_env,
         executable = ctx.executable._cc_bindings_from_rs_tool,
+        execution_requirements = execution_requirements,
         mnemonic = "CcBindingsFromRust",
         progress_message = "Generating C++ bindings from Rust: %s" % h_out_file,
-        # TODO(lukasza): Figure out why we need a '-Cpanic=abort' here.
-        arguments = [crubit_args, "--", rustc_args, "-Cpanic=abort"],
+        arguments = [crubit_args, rustc_args],
     )
 
-    return (h_out_file, rs_out_file)
+    return (h_out_file, h_shards_out_files, rs_out_file)
 
-def _make_cc_info_for_h_out_file(ctx, h_out_file, linking_contexts):
+def _make_cc_info_for_h_out_file(ctx, h_out_file, h_shards_out_files, linking_contexts):
     """Creates and returns CcInfo for the generated ..._cc_api.h header file.
 
     Args:
       ctx: The rule context.
       h_out_file: The generated "..._cc_api.h" header file
+      h_shards_out_files: The generated directory with the shards of the
+          header (if any)
       linking_contexts: Linking contexts - should include both:
           1) the target `crate` and
           2) the compiled Rust glue crate (`..._cc_api_impl.rs` file).
@@ -168,7 +210,7 @@ def _make_cc_info_for_h_out_file(ctx, h_out_file, linking_contexts):
         actions = ctx.actions,
         feature_configuration = feature_configuration,
         cc_toolchain = cc_toolchain,
-        public_hdrs = [h_out_file],
+        public_hdrs = [h_out_file] + h_shards_out_files,
         compilation_contexts = cc_deps_compilation_contexts,
     )
     (linking_context, _) = cc_common.create_linking_context_from_compilation_outputs(
@@ -281,7 +323,7 @@ def _cc_bindings_from_rust_aspect_impl(target, ctx):
         use_json_output = False,
     )
 
-    (h_out_file, rs_out_file) = _generate_bindings(
+    (h_out_file, h_shards_out_files, rs_out_file) = _generate_bindings(
         ctx,
         basename,
         compile_inputs,
@@ -296,6 +338,7 @@ def _cc_bindings_from_rust_aspect_impl(target, ctx):
     cc_info = _make_cc_info_for_h_out_file(
         ctx,
         h_out_file,
+        h_shards_out_files,
         [target_crate_linking_context, impl_linking_context],
     )
     return [
@@ -304,7 +347,7 @@ def _cc_bindings_from_rust_aspect_impl(target, ctx):
             crate_key = crate_info.name,
             h_out_file = h_out_file,
         ),
-        OutputGroupInfo(out = depset([h_out_file, rs_out_file])),
+        OutputGroupInfo(out = depset([h_out_file, rs_out_file] + h_shards_out_files)),
     ]
 
 cc_bindings_from_rust_aspect = aspect(
@@ -331,7 +374,14 @@ cc_bindings_from_rust_aspect = aspect(
             doc = "Dependencies needed to build the C++ sources generated by cc_bindings_from_rs.",
             default = [
                 "//support/internal:bindings_support",
+                "//support/rs_std:box",
+                "//support/rs_std:chunked_range",
+                "//support/rs_std:future",
                 "//support/rs_std:rs_char",
+                "//support/rs_std:rs_string",
+                "//support/rs_std:slice_ref",
+                "//support/rs_std:str_ref",
+                "//support/rs_std:vec",
             ],
         ),
         "_process_wrapper": attr.label(
@@ -343,6 +393,8 @@ cc_bindings_from_rust_aspect = aspect(
         "_rs_deps_for_bindings": attr.label_list(
             doc = "Dependencies needed to build the Rust sources generated by cc_bindings_from_rs.",
             default = [
+                "//support/rs_std:rs_std_future",
+                "//support/rs_std:rs_std_owned",
                 "@crate_index//:memoffset",
             ],
         ),
@@ -356,6 +408,15 @@ cc_bindings_from_rust_aspect = aspect(
             default = "//nowhere:rustfmt.toml",
             allow_single_file = True,
         ),
+        "_use_persistent_worker": attr.label(
+            default = "//cc_bindings_from_rs/bazel_support:use_persistent_worker",
+        ),
+        "_skip_analysis": attr.label(
+            default = "//cc_bindings_from_rs/bazel_support:skip_analysis",
+        ),
+        "_shard_headers": attr.label(
+            default = "//cc_bindings_from_rs/bazel_support:shard_headers",
+        ),
     },
     toolchains = [
         "@rules_rust//rust:toolchain",
@@ -379,6 +440,7 @@ def _cc_bindings_from_rust_rule_impl(ctx):
             ),
             target_args = depset([]),
             namespaces = None,
+            modules = None,
         ),
     ]
 
@@ -0,0 +1,52 @@
+# Part of the Crubit project, under the Apache License v2.0 with LLVM
+# Exceptions. See /LICENSE for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+"""The aspect hint, to be attached to a Rust library, specifies the monomorphizations of its
+generic functions that `cc_bindings_from_rs` should generate C++ bindings for."""
+
+_GenericFnInstantiationsInfo = provider(
+    doc = "The provider that specifies the instantiations of generic functions to bind.",
+    fields = {
+        "instantiations": "A dict from Rust paths with type arguments to C++ function names.",
+    },
+)
+
+def _cc_bindings_from_rust_generic_fn_instantiations_impl(ctx):
+    return [_GenericFnInstantiationsInfo(
+        instantiations = ctx.attr.instantiations,
+    )]
+
+cc_bindings_from_rust_generic_fn_instantiations = rule(
+    attrs = {
+        "instantiations": attr.string_dict(
+            doc = ("A dict from the paths of generic functions of the crate with their type " +
+                   "arguments (e.g. `\"some_mod::max::<i32>\"`) to the names of the C++ " +
+                   "functions to generate for them (e.g. `\"max_i32\"`)."),
+            mandatory = True,
+        ),
+    },
+    implementation = _cc_bindings_from_rust_generic_fn_instantiations_impl,
+    doc = """
+Defines an aspect hint that lists the concrete instantiations of generic Rust functions which
+`cc_bindings_from_rs` generates C++ bindings for. Each instantiation becomes a separate,
+non-template C++ function, which calls the instantiated Rust function through a thunk.
+""",
+)
+
+def collect_generic_fn_instantiations(aspect_ctx):
+    """Returns the `--instantiate-generic-fn` values for `cc_bindings_from_rs`.
+
+    Args:
+        aspect_ctx: The ctx from an aspect_hint.
+
+    Returns:
+        A list of "RUST_PATH::<TYPES>=CC_NAME" strings. The list is empty if no instantiations
+        are specified.
+    """
+    instantiations = []
+    for hint in getattr(aspect_ctx.rule.attr, "aspect_hints", []):
+        if _GenericFnInstantiationsInfo in hint:
+            for rust_path, cc_name in hint[_GenericFnInstantiationsInfo].instantiations.items():
+                instantiations.append(rust_path + "=" + cc_name)
+    return instantiations
@@ -3,6 +3,7 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 use anyhow::{anyhow, bail, ensure, Context, Result};
+use chrome_trace::ChromeTrace;
 use code_gen_utils::{
     escape_non_identifier_chars, format_cc_ident, format_cc_includes,
     format_namespace_bound_cc_tokens, make_rs_ident, CcInclude, NamespaceQualifier,
@@ -10,17 +11,21 @@ use code_gen_utils::{
 use itertools::Itertools;
 use proc_macro2::{Ident, Literal, TokenStream};
 use quote::{format_ident, quote, ToTokens};
-use rustc_hir::{AssocItemKind, Item, ItemKind, Node, Unsafety};
+use rustc_ast::LitKind;
+use rustc_hir::def::Res;
+use rustc_hir::{AssocItemKind, BlockCheckMode, ExprKind, Item, ItemKind, Node, QPath, Unsafety};
 use rustc_infer::infer::TyCtxtInferExt;
 use rustc_middle::dep_graph::DepContext;
 use rustc_middle::mir::Mutability;
 use rustc_middle::ty::{self, Ty, TyCtxt}; // See <internal link>/ty.html#import-conventions
-use rustc_span::def_id::{DefId, LocalDefId, LOCAL_CRATE};
+use rustc_span::def_id::{DefId, DefIndex, LocalDefId, LOCAL_CRATE};
 use rustc_span::symbol::{kw, sym, Symbol};
+use rustc_span::Span;
 use rustc_target::abi::{Abi, FieldsShape, Integer, Layout, Primitive, Scalar};
 use rustc_target::spec::PanicStrategy;
 use rustc_trait_selection::infer::InferCtxtExt;
 use rustc_type_ir::sty::RegionKind;
+use std::cell::RefCell;
 use std::collections::{BTreeSet, HashMap, HashSet};
 use std::iter::once;
 use std::ops::AddAssign;
@@ -43,6 +48,27 @@ pub struct Input<'tcx> {
     // a "hash" of the crate version and compilation flags.
     pub crate_name_to_include_path: HashMap<Rc<str>, CcInclude>,
 
+    /// Path to the directory with the shards of the C++ header (see
+    /// `Output::h_shards`) in a format that should be used in the `#include`
+    /// directives inside the generated C++ files.  If `None`, then all the C++
+    /// bindings are generated into a single header.
+    pub h_shards_include_dir: Option<Rc<str>>,
+
+    /// Records a span for the formatting of each item (see `format_crate`), and
+    /// for each of the formatters of an ADT (see `format_adt`).
+    pub trace: ChromeTrace,
+
+    /// Memoizes `does_type_implement_trait`, which would otherwise run trait
+    /// selection again for each use of an ADT (e.g. in `format_adt_core` and
+    /// `is_c_abi_compatible_by_value`) and for each formatter of the ADT.
+    pub trait_impls: RefCell<HashMap<(Ty<'tcx>, DefId), bool>>,
+
+    /// Monomorphizations of generic functions of the crate to generate C++
+    /// bindings for, as pairs of the path of the function with its type
+    /// arguments (e.g. `some_mod::max::<i32>`) and the name of the C++
+    /// function (e.g. `max_i32`).  See `get_generic_fn_instantiations`.
+    pub generic_fn_instantiations: Vec<(String, String)>,
+
     // TODO(b/262878759): Provide a set of enabled/disabled Crubit features.
     pub _features: (),
 }
@@ -59,7 +85,16 @@ impl<'tcx> Input<'tcx> {
 }
 
 pub struct Output {
+    /// The C++ header with the bindings.  When `Input::h_shards_include_dir`
+    /// is set, this is an umbrella header that just includes all the
+    /// `h_shards`.
     pub h_body: TokenStream,
+
+    /// File names (inside `Input::h_shards_include_dir`) and contents of the
+    /// C++ headers with the bindings for each Rust module.  Empty unless
+    /// `Input::h_shards_include_dir` is set.
+    pub h_shards: Vec<(Rc<str>, TokenStream)>,
+
     pub rs_body: TokenStream,
 }
 
@@ -78,21 +113,28 @@ pub fn generate_bindings(input: &Input) -> Result<Output> {
         quote! { __COMMENT__ #txt __NEWLINE__ }
     };
 
-    let Output { h_body, rs_body } = format_crate(input).unwrap_or_else(|err| {
+    let Output { h_body, h_shards, rs_body } = format_crate(input).unwrap_or_else(|err| {
         let txt = format!("Failed to generate bindings for the crate: {err}");
         let src = quote! { __COMMENT__ #txt };
-        Output { h_body: src.clone(), rs_body: src }
+        Output { h_body: src.clone(), h_shards: vec![], rs_body: src }
     });
 
-    let h_body = quote! {
-        #top_comment
+    let format_h_file = |h_body: TokenStream| {
+        quote! {
+            #top_comment
 
-        // TODO(b/251445877): Replace `#pragma once` with include guards.
-        __HASH_TOKEN__ pragma once __NEWLINE__
-        __NEWLINE__
+            // TODO(b/251445877): Replace `#pragma once` with include guards.
+            __HASH_TOKEN__ pragma once __NEWLINE__
+            __NEWLINE__
 
-        #h_body
+            #h_body
+        }
     };
+    let h_body = format_h_file(h_body);
+    let h_shards = h_shards
+        .into_iter()
+        .map(|(file_name, h_shard)| (file_name, format_h_file(h_shard)))
+        .collect();
 
     let rs_body = quote! {
         #top_comment
@@ -112,7 +154,7 @@ pub fn generate_bindings(input: &Input) -> Result<Output> {
         #rs_body
     };
 
-    Ok(Output { h_body, rs_body })
+    Ok(Output { h_body, h_shards, rs_body })
 }
 
 #[derive(Clone, Debug, Default)]
@@ -139,13 +181,36 @@ struct CcPrerequisites {
     /// *not* need to appear earlier (and therefore `defs` will *not*
     /// contain `LocalDefId` corresponding to `S`).
     fwd_decls: HashSet<LocalDefId>,
+
+    /// Set of definitions from other crates that a `CcSnippet` depends on.
+    /// These are covered by `#include`ing the bindings of the other crate
+    /// (see `Input::crate_name_to_include_path`) - `format_crate` translates
+    /// them into `includes`.  Unlike `includes`, `foreign_defs` can be
+    /// weakened into `foreign_fwd_decls` by `move_defs_to_fwd_decls`.
+    foreign_defs: HashSet<DefId>,
+
+    /// Set of forward declarations of ADTs from other crates that a
+    /// `CcSnippet` depends on.  `format_crate` emits these forward
+    /// declarations, unless the bindings of the other crate are `#include`d
+    /// anyway (e.g. because of `foreign_defs` of another snippet).
+    foreign_fwd_decls: HashSet<DefId>,
 }
 
 impl CcPrerequisites {
     #[cfg(test)]
     fn is_empty(&self) -> bool {
-        let &Self { ref includes, ref defs, ref fwd_decls } = self;
-        includes.is_empty() && defs.is_empty() && fwd_decls.is_empty()
+        let &Self {
+            ref includes,
+            ref defs,
+            ref fwd_decls,
+            ref foreign_defs,
+            ref foreign_fwd_decls,
+        } = self;
+        includes.is_empty()
+            && defs.is_empty()
+            && fwd_decls.is_empty()
+            && foreign_defs.is_empty()
+            && foreign_fwd_decls.is_empty()
     }
 
     /// Weakens all dependencies to only require a forward declaration. Example
@@ -155,13 +220,14 @@ impl CcPrerequisites {
     /// - Computing prerequisites of function declarations (parameter types and
     ///   return type can just be forward-declared).
     fn move_defs_to_fwd_decls(&mut self) {
-        self.fwd_decls.extend(std::mem::take(&mut self.defs))
+        self.fwd_decls.extend(std::mem::take(&mut self.defs));
+        self.foreign_fwd_decls.extend(std::mem::take(&mut self.foreign_defs));
     }
 }
 
 impl AddAssign for CcPrerequisites {
     fn add_assign(&mut self, rhs: Self) {
-        let Self { mut includes, defs, fwd_decls } = rhs;
+        let Self { mut includes, defs, fwd_decls, foreign_defs, foreign_fwd_decls } = rhs;
 
         // `BTreeSet::append` is used because it _seems_ to be more efficient than
         // calling `extend`.  This is because `extend` takes an iterator
@@ -174,6 +240,8 @@ impl AddAssign for CcPrerequisites {
 
         self.defs.extend(defs);
         self.fwd_decls.extend(fwd_decls);
+        self.foreign_defs.extend(foreign_defs);
+        self.foreign_fwd_decls.extend(foreign_fwd_decls);
     }
 }
 
@@ -275,7 +343,7 @@ impl FullyQualifiedName {
 
 /// Whether functions using `extern "C"` ABI can safely handle values of type
 /// `ty` (e.g. when passing by value arguments or return values of such type).
-fn is_c_abi_compatible_by_value(ty: Ty) -> bool {
+fn is_c_abi_compatible_by_value<'tcx>(input: &Input<'tcx>, ty: Ty<'tcx>) -> bool {
     match ty.kind() {
         // `improper_ctypes_definitions` warning doesn't complain about the following types:
         ty::TyKind::Bool |
@@ -301,14 +369,15 @@ fn is_c_abi_compatible_by_value(ty: Ty) -> bool {
         // - To replicate field offsets, Crubit may insert explicit padding fields. These
         //   extra fields may also impact the ABI of the generated bindings.
         //
+        // `is_c_abi_compatible_struct` covers the structs where neither of the above can
+        // happen.
+        //
         // TODO(lukasza): In the future, some additional performance gains may be realized by
-        // returning `true` in a few limited cases (this may require additional complexity to
-        // ensure that `format_adt` never injects explicit padding into such structs):
-        // - `#[repr(C)]` structs and unions,
-        // - `#[repr(transparent)]` struct that wraps an ABI-safe type,
+        // returning `true` in a few more cases:
+        // - `#[repr(C)]` unions and structs with non-primitive fields,
         // - Discriminant-only enums (b/259984090).
         ty::TyKind::Tuple{..} |  // An empty tuple (`()` - the unit type) is handled above.
-        ty::TyKind::Adt{..} => false,
+        ty::TyKind::Adt{..} => is_c_abi_compatible_struct(input, ty),
 
         // These kinds of reference-related types are not implemented yet - `is_c_abi_compatible_by_value`
         // should never need to handle them, because `format_ty_for_cc` fails for such types.
@@ -331,6 +400,66 @@ fn is_c_abi_compatible_by_value(ty: Ty) -> bool {
     }
 }
 
+/// Whether `ty` is a `#[repr(C)]` or `#[repr(transparent)]` struct whose C++
+/// bindings are passed and returned by value exactly like the Rust struct.
+///
+/// This requires that
+/// - `format_fields` emits all fields with their original, primitive types
+///   (i.e. without explicit padding and without replacing any of the fields with
+///   an array of bytes),
+/// - the C++ struct is trivial for the purposes of calls (i.e. it has a trivial
+///   destructor and a trivial move constructor, and no user-provided copy
+///   constructor - see `format_adt`).
+fn is_c_abi_compatible_struct<'tcx>(input: &Input<'tcx>, ty: Ty<'tcx>) -> bool {
+    let tcx = input.tcx;
+    let ty::TyKind::Adt(adt, substs) = ty.kind() else { return false };
+    let repr = adt.repr();
+    if !adt.is_struct()
+        || !substs.is_empty()
+        || !(repr.c() || repr.transparent())
+        || repr.packed()
+        || repr.align.is_some()
+    {
+        return false;
+    }
+
+    let param_env = tcx.param_env(adt.did());
+    if ty.needs_drop(tcx, param_env) {
+        return false;
+    }
+    if !ty.is_copy_modulo_regions(tcx, param_env) {
+        // Non-`Copy` `Clone` types get a user-provided C++ copy constructor.
+        let is_clone = tcx
+            .lang_items()
+            .clone_trait()
+            .map(|trait_id| does_type_implement_trait(input, ty, trait_id))
+            .unwrap_or(true);
+        if is_clone {
+            return false;
+        }
+    }
+
+    let Ok(layout) = get_layout(tcx, ty) else { return false };
+    let mut size_of_fields = 0;
+    for field_def in adt.all_fields() {
+        let field_ty = field_def.ty(tcx, substs);
+        if !matches!(
+            field_ty.kind(),
+            ty::TyKind::Bool | ty::TyKind::Int(_) | ty::TyKind::Uint(_) | ty::TyKind::Float(_)
+        ) {
+            return false;
+        }
+        let Ok(field_layout) = get_layout(tcx, field_ty) else { return false };
+        // 128-bit integers are not supported by `format_ty_for_cc` yet (b/254094650).
+        if field_layout.size().bytes() > 8 {
+            return false;
+        }
+        size_of_fields += field_layout.size().bytes();
+    }
+    // Any gap between the fields would be filled with explicit padding by `format_fields`.
+    size_of_fields > 0 && size_of_fields == layout.size().bytes()
+}
+
 /// Location where a type is used.
 enum TypeLocation {
     /// The top-level return type.
@@ -371,6 +500,59 @@ fn format_pointer_or_reference_ty_for_cc<'tcx>(
     Ok(CcSnippet { prereqs, tokens: quote! { #tokens #const_qualifier #pointer_sigil } })
 }
 
+/// Formats a slice reference (`&[T]` or `&mut [T]`) or a string reference
+/// (`&str`) as `rs_std::SliceRef<const T>`, `rs_std::SliceRef<T>`, or
+/// `rs_std::StrRef`.
+fn format_slice_or_str_ref_for_cc<'tcx>(
+    input: &Input<'tcx>,
+    ref_ty: Ty<'tcx>,
+    referent_ty: Ty<'tcx>,
+    mutability: Mutability,
+) -> Result<CcSnippet> {
+    // Asserting that the target architecture meets the assumption from Crubit's
+    // `rust_builtin_type_abi_assumptions.md` - we assume that slice references
+    // and string references have the same ABI as a struct with a pointer and a
+    // `usize` length (in this order).
+    let tcx = input.tcx;
+    let layout = get_layout(tcx, ref_ty)?;
+    let pointer_size = tcx.data_layout.pointer_size;
+    assert_eq!(2 * pointer_size.bytes(), layout.size().bytes());
+    assert_eq!(tcx.data_layout.pointer_align.abi, layout.align().abi);
+    assert!(matches!(
+        layout.abi(),
+        Abi::ScalarPair(
+            Scalar::Initialized { value: Primitive::Pointer(_), .. },
+            Scalar::Initialized { value: Primitive::Int(len, /* signedness = */ false), .. }
+        ) if len.size() == pointer_size
+    ));
+
+    match referent_ty.kind() {
+        ty::TyKind::Slice(element_ty) => {
+            let const_qualifier = match mutability {
+                Mutability::Mut => quote! {},
+                Mutability::Not => quote! { const },
+            };
+            let CcSnippet { tokens, mut prereqs } =
+                format_ty_for_cc(input, *element_ty, TypeLocation::Other)?;
+            // `rs_std::SliceRef<T>` only holds a `T*` pointer.
+            prereqs.move_defs_to_fwd_decls();
+            prereqs.includes.insert(input.support_header("rs_std/slice_ref.h"));
+            Ok(CcSnippet {
+                prereqs,
+                tokens: quote! { rs_std::SliceRef< #tokens #const_qualifier > },
+            })
+        }
+        ty::TyKind::Str => {
+            ensure!(mutability == Mutability::Not, "`&mut str` is not supported yet");
+            Ok(CcSnippet::with_include(
+                quote! { rs_std::StrRef },
+                input.support_header("rs_std/str_ref.h"),
+            ))
+        }
+        _ => panic!("Caller should only pass slice and `str` referents"),
+    }
+}
+
 /// Formats `ty` into a `CcSnippet` that represents how the type should be
 /// spelled in a C++ declaration of a function parameter or field.
 //
@@ -500,20 +682,16 @@ fn format_ty_for_cc<'tcx>(
                 prereqs.defs.insert(def_id.expect_local());
             } else {
                 let other_crate_name = input.tcx.crate_name(def_id.krate);
-                let include = input
-                    .crate_name_to_include_path
-                    .get(other_crate_name.as_str())
-                    .ok_or_else(|| {
-                        anyhow!(
-                            "Type `{ty}` comes from the `{other_crate_name}` crate, \
-                             but no `--other-crate-bindings` were specified for this crate"
-                        )
-                    })?;
-                prereqs.includes.insert(include.clone());
+                ensure!(
+                    input.crate_name_to_include_path.contains_key(other_crate_name.as_str()),
+                    "Type `{ty}` comes from the `{other_crate_name}` crate, \
+                     but no `--other-crate-bindings` were specified for this crate"
+                );
+                prereqs.foreign_defs.insert(def_id);
             }
 
             // Verify if definition of `ty` can be succesfully imported and bail otherwise.
-            format_adt_core(input.tcx, def_id).with_context(|| {
+            format_adt_core(input, def_id).with_context(|| {
                 format!("Failed to generate bindings for the definition of `{ty}`")
             })?;
 
@@ -538,16 +716,22 @@ fn format_ty_for_cc<'tcx>(
                      function parameter types and return types (b/286256327)",
                 ),
             };
-            let lifetime = format_region_as_cc_lifetime(region);
-            format_pointer_or_reference_ty_for_cc(
-                input,
-                *referent_ty,
-                *mutability,
-                quote! { & #lifetime },
-            )
-            .with_context(|| {
-                format!("Failed to format the referent of the reference type `{ty}`")
-            })?
+            if matches!(referent_ty.kind(), ty::TyKind::Slice(_) | ty::TyKind::Str) {
+                format_slice_or_str_ref_for_cc(input, ty, *referent_ty, *mutability).with_context(
+                    || format!("Failed to format the referent of the reference type `{ty}`"),
+                )?
+            } else {
+                let lifetime = format_region_as_cc_lifetime(region);
+                format_pointer_or_reference_ty_for_cc(
+                    input,
+                    *referent_ty,
+                    *mutability,
+                    quote! { & #lifetime },
+                )
+                .with_context(|| {
+                    format!("Failed to format the referent of the reference type `{ty}`")
+                })?
+            }
         }
 
         ty::TyKind::FnPtr(sig) => {
@@ -556,7 +740,7 @@ fn format_ty_for_cc<'tcx>(
                 Some(sig) => sig,
             };
             check_fn_sig(&sig)?;
-            is_thunk_required(&sig).context("Function pointers can't have a thunk")?;
+            is_thunk_required(input, &sig).context("Function pointers can't have a thunk")?;
 
             // `is_thunk_required` check above implies `extern "C"` (or `"C-unwind"`).
             // This assertion reinforces that the generated C++ code doesn't need
@@ -598,8 +782,252 @@ fn format_ty_for_cc<'tcx>(
 }
 
 fn format_ret_ty_for_cc<'tcx>(input: &Input<'tcx>, sig: &ty::FnSig<'tcx>) -> Result<CcSnippet> {
-    format_ty_for_cc(input, sig.output(), TypeLocation::FnReturn)
-        .context("Error formatting function return type")
+    let tcx = input.tcx;
+    let result = if let Some(boxed_ret_ty) = BoxedRetTy::new(tcx, sig.output()) {
+        format_boxed_ret_ty_for_cc(input, sig, boxed_ret_ty)
+    } else if let Some(owned_ret_ty) = OwnedRetTy::new(tcx, sig.output()) {
+        format_owned_ret_ty_for_cc(input, sig, owned_ret_ty)
+    } else {
+        format_ty_for_cc(input, sig.output(), TypeLocation::FnReturn)
+    };
+    result.context("Error formatting function return type")
+}
+
+/// An opaque `impl Trait` return type, whose values are boxed and returned to
+/// C++ together with the Rust functions that C++ calls to use them and to drop
+/// them (see `format_thunk_impl`).
+#[derive(Clone, Copy)]
+enum BoxedRetTy<'tcx> {
+    /// `impl Iterator<Item = T>`, returned as `rs_std::ChunkedRange<T>`.
+    Iterator { item_ty: Ty<'tcx> },
+
+    /// `impl Future<Output = T>` (e.g. the return type of an `async fn`),
+    /// returned as `rs_std::Future<T>`.
+    Future { output_ty: Ty<'tcx> },
+}
+
+impl<'tcx> BoxedRetTy<'tcx> {
+    fn new(tcx: TyCtxt<'tcx>, ty: Ty<'tcx>) -> Option<Self> {
+        let ty::TyKind::Alias(ty::AliasKind::Opaque, alias_ty) = ty.kind() else { return None };
+        let iterator_trait_id = tcx.get_diagnostic_item(sym::Iterator);
+        let future_trait_id = tcx.lang_items().future_trait();
+        tcx.item_bounds(alias_ty.def_id).subst(tcx, alias_ty.substs).iter().find_map(|predicate| {
+            let projection = match predicate.kind().skip_binder() {
+                ty::PredicateKind::Clause(ty::Clause::Projection(projection)) => projection,
+                _ => return None,
+            };
+            let trait_id = Some(projection.projection_ty.trait_def_id(tcx));
+            let ty = projection.term.ty()?;
+            if trait_id == iterator_trait_id {
+                Some(BoxedRetTy::Iterator { item_ty: ty })
+            } else if trait_id == future_trait_id {
+                Some(BoxedRetTy::Future { output_ty: ty })
+            } else {
+                None
+            }
+        })
+    }
+
+    /// Returns the name of the C++ function pointer type (a member of the C++
+    /// return type), and of the thunk parameter, of the function that C++
+    /// calls to use the boxed value.
+    fn cc_access_fn(&self) -> (TokenStream, TokenStream) {
+        match self {
+            BoxedRetTy::Iterator { .. } => (quote! { NextChunkFn }, quote! { __next_chunk }),
+            BoxedRetTy::Future { .. } => (quote! { PollFn }, quote! { __poll }),
+        }
+    }
+}
+
+/// Formats the return type of a function returning an opaque `impl Iterator`
+/// or `impl Future` type.  The returned C++ object owns the boxed Rust value,
+/// and receives its items (or its output) by copying their bytes, which
+/// requires that
+/// - the items (or the output) are `Copy` (so that the C++ type is trivially
+///   copyable),
+/// - neither the items nor the boxed value borrow anything (because the C++
+///   object may outlive any borrowed values).
+///
+/// Futures also need to be `Send`, because they are polled by the thread that
+/// wakes them (see `support/rs_std/future.rs`).
+fn format_boxed_ret_ty_for_cc<'tcx>(
+    input: &Input<'tcx>,
+    sig: &ty::FnSig<'tcx>,
+    boxed_ret_ty: BoxedRetTy<'tcx>,
+) -> Result<CcSnippet> {
+    let tcx = input.tcx;
+    let has_lifetimes = |ty: Ty<'tcx>| {
+        ty.walk().any(|generic_arg| matches!(generic_arg.unpack(), ty::GenericArgKind::Lifetime(_)))
+    };
+    let has_lifetimes_in_inputs = sig.inputs().iter().copied().any(has_lifetimes);
+    let is_copy = |ty: Ty<'tcx>| ty.is_copy_modulo_regions(tcx, ty::ParamEnv::empty());
+
+    let mut prereqs = CcPrerequisites::default();
+    let tokens = match boxed_ret_ty {
+        BoxedRetTy::Iterator { item_ty } => {
+            ensure!(
+                !has_lifetimes(item_ty) && !has_lifetimes_in_inputs,
+                "Iterators that borrow from the parameters or from their items \
+                 can't be returned to C++ yet"
+            );
+            let item_cc_type = format_ty_for_cc(input, item_ty, TypeLocation::Other)
+                .with_context(|| format!("Failed to format the item type of `{}`", sig.output()))?
+                .into_tokens(&mut prereqs);
+            ensure!(
+                is_copy(item_ty),
+                "Iterators can only be returned to C++ if their items are `Copy`, \
+                 but `{item_ty}` isn't"
+            );
+            prereqs.includes.insert(input.support_header("rs_std/chunked_range.h"));
+            quote! { rs_std::ChunkedRange<#item_cc_type> }
+        }
+        BoxedRetTy::Future { output_ty } => {
+            ensure!(
+                !has_lifetimes(output_ty) && !has_lifetimes_in_inputs,
+                "Futures that borrow from the parameters or from their output \
+                 can't be returned to C++ yet"
+            );
+            let output_cc_type = if output_ty.is_unit() {
+                quote! { void }
+            } else {
+                let output_cc_type = format_ty_for_cc(input, output_ty, TypeLocation::Other)
+                    .with_context(|| {
+                        format!("Failed to format the output type of `{}`", sig.output())
+                    })?
+                    .into_tokens(&mut prereqs);
+                ensure!(
+                    is_copy(output_ty),
+                    "Futures can only be returned to C++ if their output is `Copy`, \
+                     but `{output_ty}` isn't"
+                );
+                output_cc_type
+            };
+            let send_trait_id = tcx
+                .get_diagnostic_item(sym::Send)
+                .ok_or(anyhow!("Couldn't find `core::marker::Send`"))?;
+            ensure!(
+                does_type_implement_trait(input, sig.output(), send_trait_id),
+                "Futures can only be returned to C++ if they are `Send`"
+            );
+            prereqs.includes.insert(input.support_header("rs_std/future.h"));
+            quote! { rs_std::Future<#output_cc_type> }
+        }
+    };
+    Ok(CcSnippet { prereqs, tokens })
+}
+
+/// A `Vec<T>`, `String`, or `Box<T>` return type, whose values are returned to
+/// C++ as their raw parts (without copying the elements or the pointee),
+/// together with the Rust function that C++ calls to drop them (see
+/// `support/rs_std/owned.rs`).
+#[derive(Clone, Copy)]
+enum OwnedRetTy<'tcx> {
+    /// `Vec<T>`, returned as `rs_std::Vec<T>`.
+    Vec { elem_ty: Ty<'tcx> },
+
+    /// `String`, returned as `rs_std::String`.
+    String,
+
+    /// `Box<T>`, returned as `rs_std::Box<T>`.
+    Box { pointee_ty: Ty<'tcx> },
+}
+
+impl<'tcx> OwnedRetTy<'tcx> {
+    fn new(tcx: TyCtxt<'tcx>, ty: Ty<'tcx>) -> Option<Self> {
+        let ty::TyKind::Adt(adt, substs) = ty.kind() else { return None };
+        // `owned.rs` drops the values with the global allocator.
+        let has_global_allocator = substs.types().skip(1).all(|alloc_ty| match alloc_ty.kind() {
+            ty::TyKind::Adt(alloc, _) => {
+                tcx.crate_name(alloc.did().krate) == sym::alloc
+                    && tcx.item_name(alloc.did()).as_str() == "Global"
+            }
+            _ => false,
+        });
+        if !has_global_allocator {
+            None
+        } else if ty.is_box() {
+            Some(OwnedRetTy::Box { pointee_ty: ty.boxed_ty() })
+        } else if tcx.is_diagnostic_item(sym::Vec, adt.did()) {
+            Some(OwnedRetTy::Vec { elem_ty: substs.type_at(0) })
+        } else if tcx.is_diagnostic_item(sym::String, adt.did()) {
+            Some(OwnedRetTy::String)
+        } else {
+            None
+        }
+    }
+
+    /// Returns the type of the raw parts that the thunk returns, and the
+    /// function of `owned.rs` that turns the returned value into them.
+    fn format_raw_parts_for_rs(&self, tcx: TyCtxt<'tcx>) -> Result<(TokenStream, TokenStream)> {
+        Ok(match self {
+            OwnedRetTy::Vec { elem_ty } => {
+                let elem_ty = format_ty_for_rs(tcx, *elem_ty)?;
+                (
+                    quote! { ::rs_std_owned::RawVec<#elem_ty> },
+                    quote! { ::rs_std_owned::vec_into_raw },
+                )
+            }
+            OwnedRetTy::String => {
+                (quote! { ::rs_std_owned::RawVec<u8> }, quote! { ::rs_std_owned::string_into_raw })
+            }
+            OwnedRetTy::Box { pointee_ty } => {
+                let pointee_ty = format_ty_for_rs(tcx, *pointee_ty)?;
+                (
+                    quote! { ::rs_std_owned::RawBox<#pointee_ty> },
+                    quote! { ::rs_std_owned::box_into_raw },
+                )
+            }
+        })
+    }
+}
+
+/// Formats the return type of a function returning `Vec<T>`, `String`, or
+/// `Box<T>`.  The returned C++ object owns the Rust value, and gives direct
+/// access to its elements (or to its pointee), which requires that they don't
+/// borrow anything (because the C++ object may outlive any borrowed values).
+fn format_owned_ret_ty_for_cc<'tcx>(
+    input: &Input<'tcx>,
+    sig: &ty::FnSig<'tcx>,
+    owned_ret_ty: OwnedRetTy<'tcx>,
+) -> Result<CcSnippet> {
+    let has_lifetimes = sig
+        .output()
+        .walk()
+        .any(|generic_arg| matches!(generic_arg.unpack(), ty::GenericArgKind::Lifetime(_)));
+    ensure!(
+        !has_lifetimes,
+        "`Vec<T>`, `String`, and `Box<T>` values that borrow can't be returned to C++ yet"
+    );
+
+    let mut prereqs = CcPrerequisites::default();
+    let mut format_target_ty = |ty: Ty<'tcx>| -> Result<TokenStream> {
+        let CcSnippet { tokens, prereqs: mut target_prereqs } =
+            format_ty_for_cc(input, ty, TypeLocation::Other).with_context(|| {
+                format!("Failed to format the type argument of `{}`", sig.output())
+            })?;
+        // Like `rs_std::SliceRef<T>`, the returned C++ object only holds a `T*`
+        // pointer.
+        target_prereqs.move_defs_to_fwd_decls();
+        prereqs += target_prereqs;
+        Ok(tokens)
+    };
+    let tokens = match owned_ret_ty {
+        OwnedRetTy::Vec { elem_ty } => {
+            let elem_cc_type = format_target_ty(elem_ty)?;
+            prereqs.includes.insert(input.support_header("rs_std/vec.h"));
+            quote! { rs_std::Vec<#elem_cc_type> }
+        }
+        OwnedRetTy::String => {
+            prereqs.includes.insert(input.support_header("rs_std/rs_string.h"));
+            quote! { rs_std::String }
+        }
+        OwnedRetTy::Box { pointee_ty } => {
+            let pointee_cc_type = format_target_ty(pointee_ty)?;
+            prereqs.includes.insert(input.support_header("rs_std/box.h"));
+            quote! { rs_std::Box<#pointee_cc_type> }
+        }
+    };
+    Ok(CcSnippet { prereqs, tokens })
 }
 
 fn format_param_types_for_cc<'tcx>(
@@ -657,6 +1085,11 @@ fn format_ty_for_rs(tcx: TyCtxt, ty: Ty) -> Result<TokenStream> {
             })?;
             quote! { * #qualifier #ty }
         }
+        ty::TyKind::Slice(element_ty) => {
+            let element_ty = format_ty_for_rs(tcx, *element_ty)?;
+            quote! { [#element_ty] }
+        }
+        ty::TyKind::Str => quote! { str },
         ty::TyKind::Ref(region, referent_ty, mutability) => {
             let mutability = match mutability {
                 Mutability::Mut => quote! { mut },
@@ -770,7 +1203,7 @@ fn format_thunk_decl<'tcx>(
             .zip(cc_types.into_iter())
             .map(|(&ty, cc_type)| -> Result<TokenStream> {
                 let cc_type = cc_type.into_tokens(&mut prereqs);
-                if is_c_abi_compatible_by_value(ty) {
+                if is_c_abi_compatible_by_value(input, ty) {
                     Ok(quote! { #cc_type })
                 } else {
                     // Rust thunk will move a value via memcpy - we need to `ensure` that
@@ -787,13 +1220,22 @@ fn format_thunk_decl<'tcx>(
     };
 
     let thunk_ret_type: TokenStream;
-    if is_c_abi_compatible_by_value(sig.output()) {
+    if let Some(boxed_ret_ty) = BoxedRetTy::new(tcx, sig.output()) {
+        // The thunk returns the boxed Rust value, together with the functions that
+        // C++ calls to use it and to drop it.
+        let (access_fn_type, access_fn_name) = boxed_ret_ty.cc_access_fn();
+        thunk_ret_type = quote! { void* };
+        thunk_params.push(quote! { #main_api_ret_type::#access_fn_type* #access_fn_name });
+        thunk_params.push(quote! { #main_api_ret_type::DropFn* __drop });
+    } else if OwnedRetTy::new(tcx, sig.output()).is_some() {
+        // The thunk writes the raw parts of the returned value (see `owned.rs`).
+        thunk_ret_type = quote! { void };
+        thunk_params.push(quote! { #main_api_ret_type::RawParts* __ret_ptr });
+    } else if is_c_abi_compatible_by_value(input, sig.output()) {
         thunk_ret_type = main_api_ret_type;
     } else {
         thunk_ret_type = quote! { void };
         thunk_params.push(quote! { #main_api_ret_type* __ret_ptr });
-        prereqs.includes.insert(CcInclude::utility());
-        prereqs.includes.insert(input.support_header("internal/return_value_slot.h"));
     };
     Ok(CcSnippet {
         prereqs,
@@ -816,12 +1258,13 @@ fn format_thunk_decl<'tcx>(
 /// - `<::create_name::some_module::SomeStruct as
 ///   ::core::default::Default>::default`
 fn format_thunk_impl<'tcx>(
-    tcx: TyCtxt<'tcx>,
+    input: &Input<'tcx>,
     fn_def_id: DefId,
     sig: &ty::FnSig<'tcx>,
     thunk_name: &str,
     fully_qualified_fn_name: TokenStream,
 ) -> Result<TokenStream> {
+    let tcx = input.tcx;
     let param_names_and_types: Vec<(Ident, Ty)> = {
         let param_names = tcx.fn_arg_names(fn_def_id).iter().enumerate().map(|(i, ident)| {
             if ident.as_str().is_empty() {
@@ -841,7 +1284,7 @@ fn format_thunk_impl<'tcx>(
         .map(|(param_name, ty)| {
             let rs_type = format_ty_for_rs(tcx, *ty)
                 .with_context(|| format!("Error handling parameter `{param_name}`"))?;
-            Ok(if is_c_abi_compatible_by_value(*ty) {
+            Ok(if is_c_abi_compatible_by_value(input, *ty) {
                 quote! { #param_name: #rs_type }
             } else {
                 quote! { #param_name: &mut ::core::mem::MaybeUninit<#rs_type> }
@@ -849,10 +1292,19 @@ fn format_thunk_impl<'tcx>(
         })
         .collect::<Result<Vec<_>>>()?;
 
-    let mut thunk_ret_type = format_ty_for_rs(tcx, sig.output())?;
+    let boxed_ret_ty = BoxedRetTy::new(tcx, sig.output());
+    let owned_ret_ty = OwnedRetTy::new(tcx, sig.output())
+        .map(|owned_ret_ty| owned_ret_ty.format_raw_parts_for_rs(tcx))
+        .transpose()?;
+    let mut thunk_ret_type = match (boxed_ret_ty, &owned_ret_ty) {
+        // The opaque return type can't be named, so its values are boxed below.
+        (Some(_), _) => quote! { *mut ::core::ffi::c_void },
+        (None, Some((raw_parts_type, _))) => raw_parts_type.clone(),
+        (None, None) => format_ty_for_rs(tcx, sig.output())?,
+    };
     let mut thunk_body = {
         let fn_args = param_names_and_types.iter().map(|(rs_name, ty)| {
-            if is_c_abi_compatible_by_value(*ty) {
+            if is_c_abi_compatible_by_value(input, *ty) {
                 quote! { #rs_name }
             } else {
                 quote! { unsafe { #rs_name.assume_init_read() } }
@@ -862,7 +1314,66 @@ fn format_thunk_impl<'tcx>(
             #fully_qualified_fn_name( #( #fn_args ),* )
         }
     };
-    if !is_c_abi_compatible_by_value(sig.output()) {
+    if let Some((_, into_raw_fn)) = owned_ret_ty {
+        // The raw parts are written to `__ret_slot` below.
+        thunk_body = quote! { #into_raw_fn(#thunk_body) };
+    }
+    if let Some(BoxedRetTy::Future { .. }) = boxed_ret_ty {
+        // See `support/rs_std/future.rs`.
+        thunk_params.push(quote! {
+            __poll: &mut ::core::mem::MaybeUninit<::rs_std_future::PollFn>
+        });
+        thunk_params.push(quote! {
+            __drop: &mut ::core::mem::MaybeUninit<::rs_std_future::DropFn>
+        });
+        thunk_body = quote! { ::rs_std_future::into_raw(#thunk_body, __poll, __drop) };
+    } else if let Some(BoxedRetTy::Iterator { item_ty }) = boxed_ret_ty {
+        // `__next_chunk_impl` and `__drop_impl` are instantiated with the opaque
+        // iterator type, and passed to C++ as the functions that `rs_std::ChunkedRange`
+        // calls to pull the items (a chunk at a time) and to drop the iterator.
+        let item_ty = format_ty_for_rs(tcx, item_ty)
+            .with_context(|| format!("Failed to format the item type of `{}`", sig.output()))?;
+        let next_chunk_fn_type = quote! {
+            unsafe extern "C" fn(*mut ::core::ffi::c_void, *mut #item_ty, usize) -> usize
+        };
+        let drop_fn_type = quote! { unsafe extern "C" fn(*mut ::core::ffi::c_void) };
+        thunk_params.push(quote! {
+            __next_chunk: &mut ::core::mem::MaybeUninit<#next_chunk_fn_type>
+        });
+        thunk_params.push(quote! { __drop: &mut ::core::mem::MaybeUninit<#drop_fn_type> });
+        thunk_body = quote! {
+            unsafe extern "C" fn __next_chunk_impl<I: ::core::iter::Iterator<Item = #item_ty>>(
+                iter: *mut ::core::ffi::c_void,
+                out: *mut #item_ty,
+                capacity: usize,
+            ) -> usize {
+                let iter = &mut *(iter as *mut I);
+                let mut len = 0;
+                while len < capacity {
+                    match iter.next() {
+                        Some(item) => out.add(len).write(item),
+                        None => break,
+                    }
+                    len += 1;
+                }
+                len
+            }
+            unsafe extern "C" fn __drop_impl<I>(iter: *mut ::core::ffi::c_void) {
+                ::core::mem::drop(::std::boxed::Box::from_raw(iter as *mut I));
+            }
+            fn __into_raw<I: ::core::iter::Iterator<Item = #item_ty>>(
+                iter: I,
+                next_chunk: &mut ::core::mem::MaybeUninit<#next_chunk_fn_type>,
+                drop: &mut ::core::mem::MaybeUninit<#drop_fn_type>,
+            ) -> *mut ::core::ffi::c_void {
+                next_chunk.write(__next_chunk_impl::<I>);
+                drop.write(__drop_impl::<I>);
+                let iter = ::std::boxed::Box::new(iter);
+                ::std::boxed::Box::into_raw(iter) as *mut ::core::ffi::c_void
+            }
+            __into_raw(#thunk_body, __next_chunk, __drop)
+        };
+    } else if !is_c_abi_compatible_by_value(input, sig.output()) {
         thunk_params.push(quote! {
             __ret_slot: &mut ::core::mem::MaybeUninit<#thunk_ret_type>
         });
@@ -930,7 +1441,7 @@ fn check_fn_sig(sig: &ty::FnSig) -> Result<()> {
 
 /// Returns `Ok(())` if no thunk is required.
 /// Otherwise returns an error the describes why the thunk is needed.
-fn is_thunk_required(sig: &ty::FnSig) -> Result<()> {
+fn is_thunk_required<'tcx>(input: &Input<'tcx>, sig: &ty::FnSig<'tcx>) -> Result<()> {
     match sig.abi {
         // "C" ABI is okay: Before https://rust-lang.github.io/rfcs/2945-c-unwind-abi.html a
         // Rust panic that "escapes" a "C" ABI function leads to Undefined Behavior.  This is
@@ -953,9 +1464,12 @@ fn is_thunk_required(sig: &ty::FnSig) -> Result<()> {
         _ => bail!("Calling convention other than `extern \"C\"` requires a thunk"),
     };
 
-    ensure!(is_c_abi_compatible_by_value(sig.output()), "Return type requires a thunk");
+    ensure!(is_c_abi_compatible_by_value(input, sig.output()), "Return type requires a thunk");
     for (i, param_ty) in sig.inputs().iter().enumerate() {
-        ensure!(is_c_abi_compatible_by_value(*param_ty), "Type of parameter #{i} requires a thunk",);
+        ensure!(
+            is_c_abi_compatible_by_value(input, *param_ty),
+            "Type of parameter #{i} requires a thunk",
+        );
     }
 
     Ok(())
@@ -986,7 +1500,210 @@ impl FunctionKind {
     }
 }
 
-/// Formats a function with the given `local_def_id`.
+/// Returns the body of an equivalent C++ `inline` definition of the function
+/// with the given `local_def_id`, or `None` if the function has to be called
+/// through its thunk (or through its `extern "C"` symbol).
+///
+/// Only `#[inline]` functions whose body is trivially translatable are
+/// supported:
+/// - a constant: `#[inline] fn f() -> i32 { 42 }` => `return 42;`
+/// - a read of a field of `self` or of a by-value struct parameter:
+///   `#[inline] fn x(&self) -> i32 { self.x }` => `return this->x;`
+///
+/// The C++ definition reads the field directly, which relies on the C++ struct
+/// having the same layout as the Rust struct (which is verified by the field
+/// offset assertions generated by `format_fields`).
+fn format_inline_fn_body(
+    tcx: TyCtxt,
+    local_def_id: LocalDefId,
+    sig: &ty::FnSig,
+    has_self_param: bool,
+) -> Option<TokenStream> {
+    // `#[inline]` is an explicit request from the author of the Rust crate to make
+    // the function body available to callers in other crates.
+    if !tcx.has_attr(local_def_id.to_def_id(), sym::inline) {
+        return None;
+    }
+    let ret_ty = sig.output();
+    if !ret_ty.is_integral() && !ret_ty.is_bool() && !ret_ty.is_floating_point() {
+        return None;
+    }
+    let body = tcx.hir().body(tcx.hir().maybe_body_owned_by(local_def_id)?);
+    let expr = match body.value.kind {
+        ExprKind::Block(block, None)
+            if block.stmts.is_empty() && block.rules == BlockCheckMode::DefaultBlock =>
+        {
+            block.expr?
+        }
+        _ => return None,
+    };
+    if expr.span.from_expansion() {
+        return None;
+    }
+    match expr.kind {
+        ExprKind::Lit(lit) if body.params.is_empty() => match lit.node {
+            LitKind::Bool(value) if ret_ty.is_bool() => Some(quote! { return #value; }),
+            LitKind::Int(value, _) if ret_ty.is_integral() => {
+                // Large literals don't fit into C++ (signed) integer literals.
+                let value = i64::try_from(value).ok()?;
+                let layout = get_layout(tcx, ret_ty).ok()?;
+                let max_value = match ret_ty.kind() {
+                    ty::TyKind::Int(_) => (1i128 << (layout.size().bits() - 1)) - 1,
+                    _ => (1i128 << layout.size().bits()) - 1,
+                };
+                if i128::from(value) > max_value {
+                    return None;
+                }
+                let value = Literal::i64_unsuffixed(value);
+                Some(quote! { return #value; })
+            }
+            _ => None,
+        },
+        ExprKind::Field(base, field_ident) if body.params.len() == 1 => {
+            let param = &body.params[0];
+            match base.kind {
+                ExprKind::Path(QPath::Resolved(None, path))
+                    if path.res == Res::Local(param.pat.hir_id) => {}
+                _ => return None,
+            }
+            let param_ty = sig.inputs()[0];
+            let adt_ty = match param_ty.kind() {
+                ty::TyKind::Ref(_, referent_ty, _) if has_self_param => *referent_ty,
+                _ => param_ty,
+            };
+            let (adt, substs) = match adt_ty.kind() {
+                ty::TyKind::Adt(adt, substs) if adt.is_struct() && adt.did().is_local() => {
+                    (adt, substs)
+                }
+                _ => return None,
+            };
+            let (index, field_def) = adt
+                .non_enum_variant()
+                .fields
+                .iter()
+                .enumerate()
+                .find(|(_, field_def)| field_def.name == field_ident.name)?;
+            if field_def.ty(tcx, substs) != ret_ty {
+                return None;
+            }
+            // Keep in sync with the C++ names given to fields by `format_fields`.
+            let field_name = format_cc_ident(field_def.name.as_str())
+                .unwrap_or_else(|_err| format_ident!("__field{index}").into_token_stream());
+            if has_self_param {
+                Some(quote! { return this->#field_name; })
+            } else if field_def.vis == ty::Visibility::Public {
+                let param_name =
+                    format_cc_ident(tcx.fn_arg_names(local_def_id.to_def_id())[0].as_str()).ok()?;
+                Some(quote! { return #param_name.#field_name; })
+            } else {
+                None
+            }
+        }
+        _ => None,
+    }
+}
+
+/// Splits the path of a generic function instantiation (see
+/// `Input::generic_fn_instantiations`), e.g. `crate::some_mod::max::<i32, u8>`,
+/// into the path of the function (`some_mod::max`) and the type arguments
+/// (`["i32", "u8"]`).
+fn split_generic_fn_instantiation(rust_path: &str) -> Option<(&str, Vec<&str>)> {
+    let (fn_path, ty_args) = rust_path.strip_suffix('>')?.split_once("::<")?;
+    let fn_path = fn_path.strip_prefix("crate::").unwrap_or(fn_path);
+    Some((fn_path, ty_args.split(',').map(str::trim).collect()))
+}
+
+/// Resolves a type argument of a generic function instantiation (see
+/// `Input::generic_fn_instantiations`), which can be a primitive type or the
+/// path of a non-generic struct, enum, or union of the crate.
+fn resolve_generic_fn_ty_arg<'tcx>(tcx: TyCtxt<'tcx>, ty_arg: &str) -> Result<Ty<'tcx>> {
+    use rustc_hir::def::DefKind;
+    let ty = match ty_arg {
+        "bool" => tcx.types.bool,
+        "char" => tcx.types.char,
+        "i8" => tcx.types.i8,
+        "i16" => tcx.types.i16,
+        "i32" => tcx.types.i32,
+        "i64" => tcx.types.i64,
+        "isize" => tcx.types.isize,
+        "u8" => tcx.types.u8,
+        "u16" => tcx.types.u16,
+        "u32" => tcx.types.u32,
+        "u64" => tcx.types.u64,
+        "usize" => tcx.types.usize,
+        "f32" => tcx.types.f32,
+        "f64" => tcx.types.f64,
+        _ => {
+            let ty_path = ty_arg.strip_prefix("crate::").unwrap_or(ty_arg);
+            let def_id = tcx
+                .hir()
+                .items()
+                .map(|item_id| item_id.owner_id.to_def_id())
+                .filter(|&def_id| {
+                    matches!(tcx.def_kind(def_id), DefKind::Struct | DefKind::Enum | DefKind::Union)
+                })
+                .find(|&def_id| tcx.def_path_str(def_id) == ty_path)
+                .ok_or_else(|| {
+                    anyhow!(
+                        "Type argument `{ty_arg}` is neither a primitive type nor a struct, \
+                         enum, or union of the crate"
+                    )
+                })?;
+            ensure!(
+                tcx.generics_of(def_id).count() == 0,
+                "Generic type arguments are not supported yet: `{ty_arg}`"
+            );
+            tcx.type_of(def_id).subst_identity()
+        }
+    };
+    Ok(ty)
+}
+
+/// Returns the type arguments and the C++ names of the instantiations of the
+/// generic function `def_id` that `Input::generic_fn_instantiations` requests.
+fn get_generic_fn_instantiations<'a, 'tcx>(
+    input: &'a Input<'tcx>,
+    def_id: DefId,
+) -> Result<Vec<(ty::SubstsRef<'tcx>, &'a str)>> {
+    let tcx = input.tcx;
+    let fn_path = tcx.def_path_str(def_id);
+    input
+        .generic_fn_instantiations
+        .iter()
+        .filter_map(|(rust_path, cc_name)| {
+            let (path, ty_args) = split_generic_fn_instantiation(rust_path)?;
+            (path == fn_path).then_some((rust_path, ty_args, cc_name))
+        })
+        .map(|(rust_path, ty_args, cc_name)| {
+            let generics = tcx.generics_of(def_id);
+            ensure!(
+                generics.parent.is_none()
+                    && generics
+                        .params
+                        .iter()
+                        .all(|param| matches!(param.kind, ty::GenericParamDefKind::Type { .. })),
+                "Only free functions whose generic parameters are all types can be \
+                 instantiated, unlike `{fn_path}`"
+            );
+            ensure!(
+                generics.params.len() == ty_args.len(),
+                "`{rust_path}` has {} type arguments, but `{fn_path}` has {} type parameters",
+                ty_args.len(),
+                generics.params.len(),
+            );
+            let ty_args = ty_args
+                .iter()
+                .map(|ty_arg| resolve_generic_fn_ty_arg(tcx, ty_arg).map(Into::into))
+                .collect::<Result<Vec<ty::GenericArg>>>()?;
+            Ok((tcx.mk_substs(&ty_args), cc_name.as_str()))
+        })
+        .collect()
+}
+
+/// Formats a function with the given `local_def_id`.  Generic functions are
+/// only supported through the monomorphizations that
+/// `Input::generic_fn_instantiations` requests, which are formatted as separate
+/// C++ functions.
 ///
 /// Will panic if `local_def_id`
 /// - is invalid
@@ -995,18 +1712,48 @@ fn format_fn(input: &Input, local_def_id: LocalDefId) -> Result<ApiSnippets> {
     let tcx = input.tcx;
     let def_id: DefId = local_def_id.to_def_id(); // Convert LocalDefId to DefId.
 
-    ensure!(
-        tcx.generics_of(def_id).count() == 0,
-        "Generic functions are not supported yet (b/259749023)"
-    );
+    if tcx.generics_of(def_id).count() == 0 {
+        return format_fn_instance(input, local_def_id, ty::List::empty(), None);
+    }
+    let instantiations = get_generic_fn_instantiations(input, def_id)?;
+    ensure!(!instantiations.is_empty(), "Generic functions are not supported yet (b/259749023)");
+    instantiations
+        .into_iter()
+        .map(|(substs, cc_name)| {
+            format_fn_instance(input, local_def_id, substs, Some(cc_name))
+                .with_context(|| format!("Error formatting the instantiation `{cc_name}`"))
+        })
+        .collect()
+}
+
+/// Formats the function `local_def_id` instantiated with `substs` (which are
+/// empty for non-generic functions).  The C++ function is named `cc_name`, or
+/// after the Rust function if `None`.
+fn format_fn_instance<'tcx>(
+    input: &Input<'tcx>,
+    local_def_id: LocalDefId,
+    substs: ty::SubstsRef<'tcx>,
+    cc_name: Option<&str>,
+) -> Result<ApiSnippets> {
+    let tcx = input.tcx;
+    let def_id: DefId = local_def_id.to_def_id(); // Convert LocalDefId to DefId.
+    let is_instantiation = !substs.is_empty();
 
-    let sig = get_fn_sig(tcx, local_def_id);
+    let sig = if is_instantiation {
+        let sig = tcx.fn_sig(def_id).subst(tcx, substs);
+        liberate_and_deanonymize_late_bound_regions(tcx, sig, def_id)
+    } else {
+        get_fn_sig(tcx, local_def_id)
+    };
     check_fn_sig(&sig)?;
-    let needs_thunk = is_thunk_required(&sig).is_err();
+    let boxed_ret_ty = BoxedRetTy::new(tcx, sig.output());
+    // The instantiations of generic functions are only monomorphized in the
+    // crate that calls them, so C++ always calls them through a thunk.
+    let needs_thunk =
+        boxed_ret_ty.is_some() || is_instantiation || is_thunk_required(input, &sig).is_err();
     let thunk_name = {
         let symbol_name = {
-            // Call to `mono` is ok - `generics_of` have been checked above.
-            let instance = ty::Instance::mono(tcx, def_id);
+            let instance = ty::Instance::new(def_id, substs);
             tcx.symbol_name(instance).name
         };
         if needs_thunk {
@@ -1019,8 +1766,8 @@ fn format_fn(input: &Input, local_def_id: LocalDefId) -> Result<ApiSnippets> {
     let fully_qualified_fn_name = FullyQualifiedName::new(tcx, def_id);
     let short_fn_name =
         fully_qualified_fn_name.name.expect("Functions are assumed to always have a name");
-    let main_api_fn_name =
-        format_cc_ident(short_fn_name.as_str()).context("Error formatting function name")?;
+    let main_api_fn_name = format_cc_ident(cc_name.unwrap_or(short_fn_name.as_str()))
+        .context("Error formatting function name")?;
 
     let mut main_api_prereqs = CcPrerequisites::default();
     let main_api_ret_type = format_ret_ty_for_cc(input, &sig)?.into_tokens(&mut main_api_prereqs);
@@ -1101,6 +1848,11 @@ fn format_fn(input: &Input, local_def_id: LocalDefId) -> Result<ApiSnippets> {
         None => None,
     };
     let needs_definition = short_fn_name.as_str() != thunk_name;
+    let inline_body = if needs_definition && !is_instantiation {
+        format_inline_fn_body(tcx, local_def_id, &sig, method_kind.has_self_param())
+    } else {
+        None
+    };
     let main_api_params = params
         .iter()
         .skip(if method_kind.has_self_param() { 1 } else { 0 })
@@ -1153,40 +1905,78 @@ fn format_fn(input: &Input, local_def_id: LocalDefId) -> Result<ApiSnippets> {
         };
 
         let mut prereqs = main_api_prereqs;
-        let thunk_decl =
-            format_thunk_decl(input, def_id, &sig, &thunk_name)?.into_tokens(&mut prereqs);
+        let thunk_decl = if inline_body.is_some() {
+            quote! {}
+        } else {
+            format_thunk_decl(input, def_id, &sig, &thunk_name)?.into_tokens(&mut prereqs)
+        };
 
         let mut thunk_args = params
             .iter()
             .enumerate()
             .map(|(i, Param { cc_name, ty, .. })| {
+                let is_adt_by_value = ty.is_adt() && is_c_abi_compatible_by_value(input, *ty);
                 if i == 0 && method_kind.has_self_param() {
-                    if method_kind == FunctionKind::MethodTakingSelfByValue {
-                        quote! { this }
-                    } else {
+                    if method_kind != FunctionKind::MethodTakingSelfByValue {
                         quote! { *this }
+                    } else if is_adt_by_value {
+                        quote! { std::move(*this) }
+                    } else {
+                        quote! { this }
                     }
-                } else if is_c_abi_compatible_by_value(*ty) {
+                } else if is_adt_by_value {
+                    // The C++ copy constructor may be deleted (e.g. for non-`Copy` types).
+                    quote! { std::move(#cc_name) }
+                } else if is_c_abi_compatible_by_value(input, *ty) {
                     quote! { #cc_name }
                 } else {
                     quote! { & #cc_name }
                 }
             })
             .collect_vec();
+        if params
+            .iter()
+            .any(|Param { ty, .. }| ty.is_adt() && is_c_abi_compatible_by_value(input, *ty))
+        {
+            prereqs.includes.insert(CcInclude::utility()); // for `std::move`
+        }
         let impl_body: TokenStream;
-        if is_c_abi_compatible_by_value(sig.output()) {
+        if let Some(inline_body) = inline_body.clone() {
+            impl_body = inline_body;
+        } else if let Some(boxed_ret_ty) = boxed_ret_ty {
+            let (access_fn_type, access_fn_name) = boxed_ret_ty.cc_access_fn();
+            thunk_args.push(quote! { & #access_fn_name });
+            thunk_args.push(quote! { &__drop });
+            impl_body = quote! {
+                #main_api_ret_type::#access_fn_type #access_fn_name;
+                #main_api_ret_type::DropFn __drop;
+                void* __boxed = __crubit_internal :: #thunk_name( #( #thunk_args ),* );
+                return #main_api_ret_type(__boxed, #access_fn_name, __drop);
+            };
+        } else if OwnedRetTy::new(tcx, sig.output()).is_some() {
+            thunk_args.push(quote! { &__raw });
+            impl_body = quote! {
+                #main_api_ret_type::RawParts __raw;
+                __crubit_internal :: #thunk_name( #( #thunk_args ),* );
+                return #main_api_ret_type(__raw);
+            };
+        } else if is_c_abi_compatible_by_value(input, sig.output()) {
             impl_body = quote! {
                 return __crubit_internal :: #thunk_name( #( #thunk_args ),* );
             };
         } else {
-            thunk_args.push(quote! { __ret_slot.Get() });
+            // Returning a prvalue constructed through `crubit::InitInPlaceTag` means that the
+            // thunk writes directly into the caller's storage (see `format_init_in_place_ctor`)
+            // - no C++ move constructor needs to run afterwards.
+            thunk_args.push(quote! { __ret_ptr });
             impl_body = quote! {
-                crubit::ReturnValueSlot<#main_api_ret_type> __ret_slot;
-                __crubit_internal :: #thunk_name( #( #thunk_args ),* );
-                return std::move(__ret_slot).AssumeInitAndTakeValue();
+                return #main_api_ret_type(
+                    crubit::InitInPlaceTag{},
+                    [&](#main_api_ret_type* __ret_ptr) {
+                        __crubit_internal :: #thunk_name( #( #thunk_args ),* );
+                    });
             };
-            prereqs.includes.insert(CcInclude::utility());
-            prereqs.includes.insert(input.support_header("internal/return_value_slot.h"));
+            prereqs.includes.insert(input.support_header("internal/init_in_place.h"));
         };
         CcSnippet {
             prereqs,
@@ -1202,10 +1992,18 @@ fn format_fn(input: &Input, local_def_id: LocalDefId) -> Result<ApiSnippets> {
         }
     };
 
-    let rs_details = if !needs_thunk {
+    let rs_details = if !needs_thunk || inline_body.is_some() {
         quote! {}
     } else {
         let fully_qualified_fn_name = match struct_name.as_ref() {
+            None if is_instantiation => {
+                let fn_name = fully_qualified_fn_name.format_for_rs();
+                let ty_args = substs
+                    .types()
+                    .map(|ty| format_ty_for_rs(tcx, ty))
+                    .collect::<Result<Vec<_>>>()?;
+                quote! { #fn_name ::< #( #ty_args ),* > }
+            }
             None => fully_qualified_fn_name.format_for_rs(),
             Some(struct_name) => {
                 let fn_name = make_rs_ident(short_fn_name.as_str());
@@ -1213,7 +2011,7 @@ fn format_fn(input: &Input, local_def_id: LocalDefId) -> Result<ApiSnippets> {
                 quote! { #struct_name :: #fn_name }
             }
         };
-        format_thunk_impl(tcx, def_id, &sig, &thunk_name, fully_qualified_fn_name)?
+        format_thunk_impl(input, def_id, &sig, &thunk_name, fully_qualified_fn_name)?
     };
     Ok(ApiSnippets { main_api, cc_details, rs_details })
 }
@@ -1314,7 +2112,9 @@ fn get_layout<'tcx>(tcx: TyCtxt<'tcx>, ty: Ty<'tcx>) -> Result<Layout<'tcx>> {
 /// is why the `def_id` parameter is a DefId rather than LocalDefId.
 //
 // TODO(b/259724276): This function's results should be memoized.
-fn format_adt_core(tcx: TyCtxt<'_>, def_id: DefId) -> Result<AdtCoreBindings<'_>> {
+fn format_adt_core<'tcx>(input: &Input<'tcx>, def_id: DefId) -> Result<AdtCoreBindings<'tcx>> {
+    let tcx = input.tcx;
+    let _span = input.trace.span("format_adt_core", || tcx.def_path_str(def_id));
     let self_ty = tcx.type_of(def_id).subst_identity();
     assert!(self_ty.is_adt());
     assert!(is_directly_public(tcx, def_id), "Caller should verify");
@@ -1331,7 +2131,7 @@ fn format_adt_core(tcx: TyCtxt<'_>, def_id: DefId) -> Result<AdtCoreBindings<'_>
         // `is_c_abi_compatible_by_value` verifies if a move constructor is present
         // or not.
         ensure!(
-            does_implement_default_trait(tcx, self_ty),
+            does_implement_default_trait(input, self_ty),
             "Custom `Drop` implementation and/or \"drop glue\" are only supported \
              if `Default` is also implemented",
         );
@@ -1382,7 +2182,10 @@ fn format_adt_core(tcx: TyCtxt<'_>, def_id: DefId) -> Result<AdtCoreBindings<'_>
     })
 }
 
-fn format_fields<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> ApiSnippets {
+/// Formats the fields of the ADT.  Also returns whether all the fields are
+/// trivial for the purpose of calls in C++, which is required for the ADT to be
+/// `trivial_abi` (see `format_adt`).
+fn format_fields<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> (ApiSnippets, bool) {
     let tcx = input.tcx;
 
     // TODO(b/259749095): Support non-empty set of generic parameters.
@@ -1391,6 +2194,9 @@ fn format_fields<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> Api
     struct FieldTypeInfo {
         size: u64,
         cc_type: CcSnippet,
+        /// Whether the C++ type of the field has a non-trivial destructor and
+        /// move constructor (because the Rust type needs drop glue).
+        needs_drop: bool,
     }
     struct Field {
         type_info: Result<FieldTypeInfo>,
@@ -1435,6 +2241,7 @@ fn format_fields<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> Api
                     Ok(FieldTypeInfo {
                         size,
                         cc_type: format_ty_for_cc(input, field_ty, TypeLocation::Other)?,
+                        needs_drop: field_ty.needs_drop(tcx, tcx.param_env(core.def_id)),
                     })
                 });
                 let name = field_def.ident(tcx);
@@ -1504,6 +2311,31 @@ fn format_fields<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> Api
         }
     };
 
+    // `#[repr(C)]` structs with only public `Copy` fields are exposed as plain
+    // C++ data members, without the anonymous unions and the explicit padding
+    // below.  The C++ struct is then standard-layout and trivially copyable, so
+    // that C++ code can access the fields (e.g. in loops over arrays of such
+    // structs) like those of any C struct.  The natural C++ layout of such a
+    // struct is the same as its `#[repr(C)]` layout, which is still verified by
+    // the `static_assert`s below.
+    let is_plain_old_data = {
+        let repr =
+            core.self_ty.ty_adt_def().expect("`core.def_id` needs to identify an ADT").repr();
+        core.self_ty.is_struct()
+            && repr.c()
+            && !repr.packed()
+            && core.self_ty.is_copy_modulo_regions(tcx, tcx.param_env(core.def_id))
+            && fields.iter().all(|field| field.is_public && field.type_info.is_ok())
+    };
+
+    // Fields replaced with a blob of bytes are trivial.  The others are wrapped in
+    // anonymous unions (unless `is_plain_old_data`, in which case they are
+    // `Copy`), which are only trivial for the purpose of calls if the type of
+    // the field has a trivial destructor and move constructor - even if that
+    // type is itself `trivial_abi`.
+    let is_trivial_for_calls =
+        fields.iter().all(|field| field.type_info.as_ref().map_or(true, |info| !info.needs_drop));
+
     let cc_details = if fields.is_empty() {
         CcSnippet::default()
     } else {
@@ -1576,6 +2408,15 @@ fn format_fields<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> Api
                             }
                         }
                     }
+                    Ok(FieldTypeInfo { cc_type, .. }) if is_plain_old_data => {
+                        let cc_type = cc_type.into_tokens(&mut prereqs);
+                        let doc_comment = field.doc_comment;
+                        quote! {
+                            public: __NEWLINE__
+                                #doc_comment
+                                #cc_type #cc_name;
+                        }
+                    }
                     Ok(FieldTypeInfo { cc_type, size }) => {
                         assert!((field.offset + size) <= field.offset_of_next_field);
                         let padding = field.offset_of_next_field - field.offset - size;
@@ -1618,10 +2459,20 @@ fn format_fields<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> Api
         }
     };
 
-    ApiSnippets { main_api, cc_details, rs_details }
+    (ApiSnippets { main_api, cc_details, rs_details }, is_trivial_for_calls)
 }
 
-fn does_type_implement_trait<'tcx>(tcx: TyCtxt<'tcx>, self_ty: Ty<'tcx>, trait_id: DefId) -> bool {
+/// Returns `true` if `self_ty` implements the trait `trait_id`.  The results
+/// are memoized in `Input::trait_impls`.
+fn does_type_implement_trait<'tcx>(
+    input: &Input<'tcx>,
+    self_ty: Ty<'tcx>,
+    trait_id: DefId,
+) -> bool {
+    if let Some(&result) = input.trait_impls.borrow().get(&(self_ty, trait_id)) {
+        return result;
+    }
+    let tcx = input.tcx;
     assert!(tcx.is_trait(trait_id));
 
     let generics = tcx.generics_of(trait_id);
@@ -1633,10 +2484,13 @@ fn does_type_implement_trait<'tcx>(tcx: TyCtxt<'tcx>, self_ty: Ty<'tcx>, trait_i
     );
     let substs = [self_ty];
 
-    tcx.infer_ctxt()
+    let result = tcx
+        .infer_ctxt()
         .build()
         .type_implements_trait(trait_id, substs, tcx.param_env(trait_id))
-        .must_apply_modulo_regions()
+        .must_apply_modulo_regions();
+    input.trait_impls.borrow_mut().insert((self_ty, trait_id), result);
+    result
 }
 
 struct TraitThunks {
@@ -1651,6 +2505,9 @@ fn format_trait_thunks<'tcx>(
     adt: &AdtCoreBindings<'tcx>,
 ) -> Result<TraitThunks> {
     let tcx = input.tcx;
+    let _span = input.trace.span("format_trait_thunks", || {
+        format!("{} for {}", tcx.def_path_str(trait_id), tcx.def_path_str(adt.def_id))
+    });
     assert!(tcx.is_trait(trait_id));
 
     let self_ty = adt.self_ty;
@@ -1660,7 +2517,7 @@ fn format_trait_thunks<'tcx>(
         // the `Drop` trait.  Instead we require the caller to check
         // `needs_drop`.
         assert!(self_ty.needs_drop(tcx, tcx.param_env(adt.def_id)));
-    } else if !does_type_implement_trait(tcx, self_ty, trait_id) {
+    } else if !does_type_implement_trait(input, self_ty, trait_id) {
         let trait_name = tcx.item_name(trait_id);
         bail!("`{self_ty}` doesn't implement the `{trait_name}` trait");
     }
@@ -1725,7 +2582,7 @@ fn format_trait_thunks<'tcx>(
                     let method_name = make_rs_ident(method.name.as_str());
                     quote! { <#struct_name as #fully_qualified_trait_name>::#method_name }
                 };
-                format_thunk_impl(tcx, method.def_id, &sig, &thunk_name, fully_qualified_fn_name)?
+                format_thunk_impl(input, method.def_id, &sig, &thunk_name, fully_qualified_fn_name)?
             }
         });
     }
@@ -1744,9 +2601,9 @@ fn get_def_id_of_default_trait(tcx: TyCtxt) -> Result<DefId> {
 /// include the default constructor - `format_trait_thunks` needs to succeed for
 /// that.  OTOH if `format_adt_core` succeeds, then `format_trait_thunks` _will_
 /// succeed for the `Default` trait.
-fn does_implement_default_trait<'tcx>(tcx: TyCtxt<'tcx>, self_ty: Ty<'tcx>) -> bool {
-    get_def_id_of_default_trait(tcx)
-        .map(|trait_id| does_type_implement_trait(tcx, self_ty, trait_id))
+fn does_implement_default_trait<'tcx>(input: &Input<'tcx>, self_ty: Ty<'tcx>) -> bool {
+    get_def_id_of_default_trait(input.tcx)
+        .map(|trait_id| does_type_implement_trait(input, self_ty, trait_id))
         .unwrap_or(false)
 }
 
@@ -1760,6 +2617,7 @@ fn format_default_ctor<'tcx>(
     core: &AdtCoreBindings<'tcx>,
 ) -> Result<ApiSnippets> {
     let tcx = input.tcx;
+    let _span = input.trace.span("format_default_ctor", || tcx.def_path_str(core.def_id));
     let trait_id = get_def_id_of_default_trait(tcx)?;
     let TraitThunks { method_name_to_cc_thunk_name, cc_thunk_decls, rs_thunk_impls: rs_details } =
         format_trait_thunks(input, trait_id, core)?;
@@ -1778,10 +2636,18 @@ fn format_default_ctor<'tcx>(
         let mut prereqs = CcPrerequisites::default();
         let cc_thunk_decls = cc_thunk_decls.into_tokens(&mut prereqs);
 
-        let tokens = quote! {
-            #cc_thunk_decls
-            inline #cc_struct_name::#cc_struct_name() {
-                __crubit_internal::#thunk_name(this);
+        let tokens = if is_c_abi_compatible_by_value(input, core.self_ty) {
+            quote! {
+                #cc_thunk_decls
+                inline #cc_struct_name::#cc_struct_name()
+                    : #cc_struct_name(__crubit_internal::#thunk_name()) {}
+            }
+        } else {
+            quote! {
+                #cc_thunk_decls
+                inline #cc_struct_name::#cc_struct_name() {
+                    __crubit_internal::#thunk_name(this);
+                }
             }
         };
         CcSnippet { tokens, prereqs }
@@ -1797,6 +2663,9 @@ fn format_copy_ctor_and_assignment_operator<'tcx>(
     core: &AdtCoreBindings<'tcx>,
 ) -> Result<ApiSnippets> {
     let tcx = input.tcx;
+    let _span = input
+        .trace
+        .span("format_copy_ctor_and_assignment_operator", || tcx.def_path_str(core.def_id));
     let cc_struct_name = &core.cc_short_name;
 
     let is_copy = {
@@ -1859,17 +2728,49 @@ fn format_copy_ctor_and_assignment_operator<'tcx>(
     Ok(ApiSnippets { main_api, cc_details, rs_details })
 }
 
+/// Formats the constructor that lets a Rust thunk initialize the ADT in place.
+///
+/// Functions that return the ADT by value use this constructor to avoid an
+/// extra call to the C++ move constructor (which, for ADTs that need drop,
+/// calls into Rust both for `Default::default` and for `Drop::drop`).  The
+/// constructor can leave the object uninitialized before calling `init`
+/// because all fields of the generated ADTs are wrapped in anonymous unions
+/// (see `format_fields`).
+fn format_init_in_place_ctor<'tcx>(
+    input: &Input<'tcx>,
+    core: &AdtCoreBindings<'tcx>,
+) -> ApiSnippets {
+    let adt_cc_name = &core.cc_short_name;
+    let mut prereqs = CcPrerequisites::default();
+    prereqs.includes.insert(input.support_header("internal/init_in_place.h"));
+    let main_api = CcSnippet {
+        prereqs,
+        tokens: quote! {
+            __NEWLINE__ __COMMENT__ "Used by functions that return this type by value."
+            template <typename F> __NEWLINE__
+            explicit #adt_cc_name(crubit::InitInPlaceTag, F init) {
+                init(this);
+            }
+            __NEWLINE__
+        },
+    };
+    ApiSnippets { main_api, ..Default::default() }
+}
+
 /// Formats the move constructor and the move-assignment operator for an ADT.
 fn format_move_ctor_and_assignment_operator<'tcx>(
     input: &Input<'tcx>,
     core: &AdtCoreBindings<'tcx>,
 ) -> ApiSnippets {
     let tcx = input.tcx;
+    let _span = input
+        .trace
+        .span("format_move_ctor_and_assignment_operator", || tcx.def_path_str(core.def_id));
     let adt_cc_name = &core.cc_short_name;
     if core.needs_drop(tcx) {
         let main_api = CcSnippet::new(quote! {
-            #adt_cc_name(#adt_cc_name&&); __NEWLINE__
-            #adt_cc_name& operator=(#adt_cc_name&&); __NEWLINE__
+            #adt_cc_name(#adt_cc_name&&) noexcept; __NEWLINE__
+            #adt_cc_name& operator=(#adt_cc_name&&) noexcept; __NEWLINE__
         });
         let cc_details = {
             // Move constructor depends on presence of the default constructor.
@@ -1882,15 +2783,19 @@ fn format_move_ctor_and_assignment_operator<'tcx>(
             // validated by the caller because otherwise `format_adt` fails.
             assert!(core.self_ty.is_unpin(tcx, tcx.param_env(core.def_id)));
 
+            // Both operators are `noexcept`, so that C++ containers use them (rather than
+            // the copy constructor, which may call `Clone::clone`) when they can't
+            // relocate their elements with `memcpy`.
             let mut prereqs = CcPrerequisites::default();
             prereqs.includes.insert(input.support_header("internal/memswap.h"));
             prereqs.includes.insert(CcInclude::utility()); // for `std::move`
             let tokens = quote! {
-                inline #adt_cc_name::#adt_cc_name(#adt_cc_name&& other)
+                inline #adt_cc_name::#adt_cc_name(#adt_cc_name&& other) noexcept
                         : #adt_cc_name() {
                     *this = std::move(other);
                 }
-                inline #adt_cc_name& #adt_cc_name::operator=(#adt_cc_name&& other) {
+                inline #adt_cc_name& #adt_cc_name::operator=(
+                        #adt_cc_name&& other) noexcept {
                     crubit::MemSwap(*this, other);
                     return *this;
                 }
@@ -1949,6 +2854,7 @@ fn format_move_ctor_and_assignment_operator<'tcx>(
 /// for the ADT.
 fn format_adt<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> ApiSnippets {
     let tcx = input.tcx;
+    let _span = input.trace.span("format_adt", || tcx.def_path_str(core.def_id));
     let adt_cc_name = &core.cc_short_name;
 
     // `format_adt` should only be called for local ADTs.
@@ -2022,6 +2928,8 @@ fn format_adt<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> ApiSni
 
     let move_ctor_and_assignment_snippets = format_move_ctor_and_assignment_operator(input, core);
 
+    let init_in_place_ctor_snippets = format_init_in_place_ctor(input, core);
+
     let impl_items_snippets = tcx
         .inherent_impls(core.def_id)
         .iter()
@@ -2030,10 +2938,7 @@ fn format_adt<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> ApiSni
             ItemKind::Impl(impl_) => impl_.items,
             other => panic!("Unexpected `ItemKind` from `inherent_impls`: {other:?}"),
         })
-        .sorted_by_key(|impl_item_ref| {
-            let def_id = impl_item_ref.id.owner_id.def_id;
-            tcx.def_span(def_id)
-        })
+        .sorted_by_key(|impl_item_ref| source_order_key(tcx, impl_item_ref.id.owner_id.def_id))
         .filter_map(|impl_item_ref| {
             let def_id = impl_item_ref.id.owner_id.def_id;
             if !tcx.effective_visibilities(()).is_directly_public(def_id) {
@@ -2055,24 +2960,39 @@ fn format_adt<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> ApiSni
         default_ctor_snippets,
         destructor_snippets,
         move_ctor_and_assignment_snippets,
+        init_in_place_ctor_snippets,
         copy_ctor_and_assignment_snippets,
         impl_items_snippets,
     ]
     .into_iter()
     .collect();
 
-    let ApiSnippets {
-        main_api: fields_main_api,
-        cc_details: fields_cc_details,
-        rs_details: fields_rs_details,
-    } = format_fields(input, core);
+    let (
+        ApiSnippets {
+            main_api: fields_main_api,
+            cc_details: fields_cc_details,
+            rs_details: fields_rs_details,
+        },
+        fields_are_trivial_for_calls,
+    ) = format_fields(input, core);
 
     let alignment = Literal::u64_unsuffixed(core.alignment_in_bytes);
     let size = Literal::u64_unsuffixed(core.size_in_bytes);
     let main_api = {
         let rs_type = core.rs_fully_qualified_name.to_string();
-        let mut attributes =
-            vec![quote! {CRUBIT_INTERNAL_RUST_TYPE(#rs_type)}, quote! {alignas(#alignment)}];
+        // All Rust types are trivially relocatable (see also the comments in
+        // `format_move_ctor_and_assignment_operator`), including the ones that
+        // need drop glue and therefore have a user-provided move constructor and
+        // destructor in C++.  `trivial_abi` lets C++ take advantage of this (e.g.
+        // `std::vector` can then relocate its elements with `memcpy` instead of
+        // calling the move constructor and destructor thunks for each of them).
+        // Clang ignores `trivial_abi` (and warns about it) unless all the fields
+        // are trivial for the purpose of calls, so it is only emitted then.
+        let mut attributes = vec![quote! {CRUBIT_INTERNAL_RUST_TYPE(#rs_type)}];
+        if fields_are_trivial_for_calls {
+            attributes.push(quote! {CRUBIT_INTERNAL_TRIVIAL_ABI});
+        }
+        attributes.push(quote! {alignas(#alignment)});
         if tcx
             .get_attrs(core.def_id, rustc_span::symbol::sym::repr)
             .flat_map(|attr| rustc_attr::parse_repr_attr(tcx.sess(), attr))
@@ -2142,18 +3062,63 @@ fn format_adt<'tcx>(input: &Input<'tcx>, core: &AdtCoreBindings<'tcx>) -> ApiSni
 ///
 /// Will panic if `def_id` doesn't identify an ADT that can be successfully
 /// handled by `format_adt_core`.
-fn format_fwd_decl(tcx: TyCtxt, def_id: LocalDefId) -> TokenStream {
-    let def_id = def_id.to_def_id(); // LocalDefId -> DefId conversion.
-
+fn format_fwd_decl(input: &Input, def_id: DefId) -> TokenStream {
     // `format_fwd_decl` should only be called for items from
-    // `CcPrerequisites::fwd_decls` and `fwd_decls` should only contain ADTs
-    // that `format_adt_core` succeeds for.
-    let AdtCoreBindings { keyword, cc_short_name, .. } = format_adt_core(tcx, def_id)
+    // `CcPrerequisites::fwd_decls` or `CcPrerequisites::foreign_fwd_decls`, and
+    // these should only contain ADTs that `format_adt_core` succeeds for.
+    let AdtCoreBindings { keyword, cc_short_name, .. } = format_adt_core(input, def_id)
         .expect("`format_fwd_decl` should only be called if `format_adt_core` succeeded");
 
     quote! { #keyword #cc_short_name; }
 }
 
+/// Returns the `#include` of the bindings of the crate that defines `def_id`
+/// (an item from `CcPrerequisites::foreign_defs` or
+/// `CcPrerequisites::foreign_fwd_decls`).
+///
+/// Will panic if `Input::crate_name_to_include_path` doesn't cover the crate
+/// (`format_ty_for_cc` verifies that it does).
+fn format_foreign_include(input: &Input, def_id: DefId) -> CcInclude {
+    let crate_name = input.tcx.crate_name(def_id.krate);
+    input.crate_name_to_include_path[crate_name.as_str()].clone()
+}
+
+/// Formats the forward declarations of `foreign_fwd_decls` (ADTs from other
+/// crates - see `CcPrerequisites::foreign_fwd_decls`), except for the ones
+/// whose bindings are covered by `includes` anyway.
+fn format_foreign_fwd_decls(
+    input: &Input,
+    includes: &BTreeSet<CcInclude>,
+    foreign_fwd_decls: &HashSet<DefId>,
+) -> TokenStream {
+    let tcx = input.tcx;
+    let fwd_decls = foreign_fwd_decls
+        .iter()
+        .copied()
+        .filter(|&def_id| !includes.contains(&format_foreign_include(input, def_id)))
+        .sorted_by_key(|&def_id| tcx.def_path_str(def_id))
+        .map(|def_id| {
+            let FullyQualifiedName { krate, mod_path, .. } = FullyQualifiedName::new(tcx, def_id);
+            let namespace = NamespaceQualifier::new(once(krate.as_str()).chain(mod_path.parts()));
+            (namespace, format_fwd_decl(input, def_id))
+        })
+        .collect_vec();
+    if fwd_decls.is_empty() {
+        return TokenStream::default();
+    }
+    let fwd_decls = format_namespace_bound_cc_tokens(fwd_decls);
+    quote! { #fwd_decls __NEWLINE__ __NEWLINE__ }
+}
+
+/// Returns the key by which items are ordered in the generated bindings: their
+/// location in the source.  Items expanded from the same macro invocation may
+/// share their `def_span` (e.g. when a proc macro gives them all its
+/// `Span::call_site()`), and are ordered by their `DefIndex` (which, unlike the
+/// order of the `HashMap`s they are collected in, is the same on every run).
+fn source_order_key(tcx: TyCtxt, local_def_id: LocalDefId) -> (Span, DefIndex) {
+    (tcx.def_span(local_def_id), local_def_id.local_def_index)
+}
+
 fn format_source_location(tcx: TyCtxt, local_def_id: LocalDefId) -> String {
     let def_span = tcx.def_span(local_def_id);
     let rustc_span::FileLines { file, lines } =
@@ -2212,7 +3177,7 @@ fn format_item(input: &Input, def_id: LocalDefId) -> Result<Option<ApiSnippets>>
         },
         Item { kind: ItemKind::Fn(..), .. } => format_fn(input, def_id).map(Some),
         Item { kind: ItemKind::Struct(..) | ItemKind::Enum(..) | ItemKind::Union(..), .. } =>
-            format_adt_core(input.tcx, def_id.to_def_id())
+            format_adt_core(input, def_id.to_def_id())
                 .map(|core| Some(format_adt(input, &core))),
         Item { kind: ItemKind::Impl(_), .. } |  // Handled by `format_adt`
         Item { kind: ItemKind::Mod(_), .. } =>  // Handled by `format_crate`
@@ -2239,23 +3204,75 @@ fn format_unsupported_def(
     ApiSnippets { main_api, cc_details: CcSnippet::default(), rs_details: quote! {} }
 }
 
+/// Computes the `tcx` queries that `format_item` needs for the public items
+/// among `def_ids` (e.g. their signatures and layouts).
+///
+/// With a parallel Rust compiler (`-Zthreads=N`), the queries of different
+/// items are computed on different threads of rustc's thread pool. `format_item`
+/// itself can't run there, because the `TokenStream`s it returns are not
+/// `Send`, but it then finds most of what it needs in the query caches.
+/// Without a parallel compiler this is only a sequential warm-up, which
+/// doesn't change the amount of work.
+fn prefetch_item_queries(tcx: TyCtxt, def_ids: &[LocalDefId]) {
+    use rustc_hir::def::DefKind;
+    let effective_visibilities = tcx.effective_visibilities(());
+    rustc_data_structures::sync::par_for_each_in(def_ids, |&def_id| {
+        if !effective_visibilities.is_directly_public(def_id) {
+            return;
+        }
+        match tcx.def_kind(def_id) {
+            DefKind::Fn => {
+                let _ = tcx.fn_sig(def_id);
+            }
+            DefKind::Struct | DefKind::Enum | DefKind::Union => {
+                // Layouts of generic ADTs can't be computed (and their bindings
+                // are not supported yet anyway).
+                if tcx.generics_of(def_id).count() == 0 {
+                    let ty = tcx.type_of(def_id).subst_identity();
+                    let _ = tcx.layout_of(tcx.param_env(def_id).and(ty));
+                }
+                for impl_def_id in tcx.inherent_impls(def_id.to_def_id()) {
+                    for method_def_id in tcx.associated_item_def_ids(*impl_def_id) {
+                        if tcx.def_kind(*method_def_id) == DefKind::AssocFn {
+                            let _ = tcx.fn_sig(*method_def_id);
+                        }
+                    }
+                }
+            }
+            _ => (),
+        }
+    });
+}
+
 /// Formats all public items from the Rust crate being compiled.
 fn format_crate(input: &Input) -> Result<Output> {
     let tcx = input.tcx;
-    let mut cc_details_prereqs = CcPrerequisites::default();
-    let mut cc_details: Vec<(LocalDefId, TokenStream)> = vec![];
+    let mut cc_details: Vec<(LocalDefId, CcSnippet)> = vec![];
     let mut rs_body = TokenStream::default();
     let mut main_apis = HashMap::<LocalDefId, CcSnippet>::new();
-    let formatted_items = tcx
-        .hir()
-        .items()
-        .filter_map(|item_id| {
-            let def_id: LocalDefId = item_id.owner_id.def_id;
+    let def_ids = tcx.hir().items().map(|item_id| item_id.owner_id.def_id).collect_vec();
+    for (rust_path, _) in input.generic_fn_instantiations.iter() {
+        let fn_path = split_generic_fn_instantiation(rust_path).map(|(fn_path, _)| fn_path);
+        let is_generic_fn = |def_id: &LocalDefId| {
+            tcx.def_kind(*def_id) == rustc_hir::def::DefKind::Fn
+                && tcx.generics_of(def_id.to_def_id()).count() != 0
+                && Some(tcx.def_path_str(def_id.to_def_id()).as_str()) == fn_path
+        };
+        ensure!(
+            def_ids.iter().any(is_generic_fn),
+            "`{rust_path}` is not an instantiation of a generic function of the crate"
+        );
+    }
+    prefetch_item_queries(tcx, &def_ids);
+    let formatted_items = def_ids
+        .into_iter()
+        .filter_map(|def_id| {
+            let _span = input.trace.span("format_item", || tcx.def_path_str(def_id.to_def_id()));
             format_item(input, def_id)
                 .unwrap_or_else(|err| Some(format_unsupported_def(tcx, def_id, err)))
                 .map(|api_snippets| (def_id, api_snippets))
         })
-        .sorted_by_key(|(def_id, _)| tcx.def_span(*def_id));
+        .sorted_by_key(|(def_id, _)| source_order_key(tcx, *def_id));
     for (def_id, api_snippets) in formatted_items {
         let old_item = main_apis.insert(def_id, api_snippets.main_api);
         assert!(old_item.is_none(), "Duplicated key: {def_id:?}");
@@ -2264,7 +3281,7 @@ fn format_crate(input: &Input) -> Result<Output> {
         // `CcPrerequisites::defs` always use `main_api` as the predecessor
         // - `chain`ing `cc_details` after `ordered_main_apis` trivially
         // meets the prerequisites.
-        cc_details.push((def_id, api_snippets.cc_details.into_tokens(&mut cc_details_prereqs)));
+        cc_details.push((def_id, api_snippets.cc_details));
         rs_body.extend(api_snippets.rs_details);
     }
 
@@ -2279,7 +3296,7 @@ fn format_crate(input: &Input) -> Result<Output> {
                 predecessors.map(move |predecessor| toposort::Dependency { predecessor, successor })
             });
             toposort::toposort(nodes, deps, move |lhs_id, rhs_id| {
-                tcx.def_span(*lhs_id).cmp(&tcx.def_span(*rhs_id))
+                source_order_key(tcx, *lhs_id).cmp(&source_order_key(tcx, *rhs_id))
             })
         };
         assert_eq!(
@@ -2292,12 +3309,27 @@ fn format_crate(input: &Input) -> Result<Output> {
         ordered_ids
     };
 
+    if let Some(h_shards_include_dir) = &input.h_shards_include_dir {
+        let (h_body, h_shards) =
+            format_h_shards(input, h_shards_include_dir, ordered_ids, main_apis, cc_details)?;
+        return Ok(Output { h_body, h_shards, rs_body });
+    }
+
     // Destructure/rebuild `main_apis` (in the same order as `ordered_ids`) into
-    // `includes`, and `ordered_cc` (mixing in `fwd_decls` and `cc_details`).
-    let (includes, ordered_cc) = {
+    // `includes`, `foreign_fwd_decls`, and `ordered_cc` (mixing in `fwd_decls`
+    // and `cc_details`).
+    let (includes, foreign_fwd_decls, ordered_cc) = {
         let mut already_declared = HashSet::new();
         let mut fwd_decls = HashSet::new();
-        let mut includes = cc_details_prereqs.includes;
+        let mut cc_details_prereqs = CcPrerequisites::default();
+        let cc_details = cc_details
+            .into_iter()
+            .map(|(def_id, cc_details)| (def_id, cc_details.into_tokens(&mut cc_details_prereqs)))
+            .collect_vec();
+        let CcPrerequisites { mut includes, foreign_defs, mut foreign_fwd_decls, .. } =
+            cc_details_prereqs;
+        includes
+            .extend(foreign_defs.into_iter().map(|def_id| format_foreign_include(input, def_id)));
         let mut ordered_main_apis: Vec<(LocalDefId, TokenStream)> = Vec::new();
         for def_id in ordered_ids.into_iter() {
             let CcSnippet {
@@ -2305,6 +3337,8 @@ fn format_crate(input: &Input) -> Result<Output> {
                 prereqs: CcPrerequisites {
                     includes: mut inner_includes,
                     fwd_decls: inner_fwd_decls,
+                    foreign_defs: inner_foreign_defs,
+                    foreign_fwd_decls: inner_foreign_fwd_decls,
                     .. // `defs` have already been utilized by `toposort` above
                 }
             } = main_apis.remove(&def_id).unwrap();
@@ -2314,13 +3348,17 @@ fn format_crate(input: &Input) -> Result<Output> {
             already_declared.extend(inner_fwd_decls.into_iter());
 
             includes.append(&mut inner_includes);
+            includes.extend(
+                inner_foreign_defs.into_iter().map(|def_id| format_foreign_include(input, def_id)),
+            );
+            foreign_fwd_decls.extend(inner_foreign_fwd_decls);
             ordered_main_apis.push((def_id, cc_tokens));
         }
 
         let fwd_decls = fwd_decls
             .into_iter()
-            .sorted_by_key(|def_id| tcx.def_span(*def_id))
-            .map(|local_def_id| (local_def_id, format_fwd_decl(tcx, local_def_id)));
+            .sorted_by_key(|def_id| source_order_key(tcx, *def_id))
+            .map(|local_def_id| (local_def_id, format_fwd_decl(input, local_def_id.to_def_id())));
 
         let ordered_cc: Vec<(NamespaceQualifier, TokenStream)> = fwd_decls
             .into_iter()
@@ -2332,31 +3370,187 @@ fn format_crate(input: &Input) -> Result<Output> {
             })
             .collect_vec();
 
-        (includes, ordered_cc)
+        (includes, foreign_fwd_decls, ordered_cc)
     };
 
     // Generate top-level elements of the C++ header file.
-    let h_body = {
-        // TODO(b/254690602): Decide whether using `#crate_name` as the name of the
-        // top-level namespace is okay (e.g. investigate if this name is globally
-        // unique + ergonomic).
-        let crate_name = format_cc_ident(tcx.crate_name(LOCAL_CRATE).as_str())?;
-
-        let includes = format_cc_includes(&includes);
-        let ordered_cc = format_namespace_bound_cc_tokens(ordered_cc);
-        quote! {
-            #includes
-            __NEWLINE__ __NEWLINE__
-            namespace #crate_name {
-                __NEWLINE__
-                #ordered_cc
-                __NEWLINE__
-            }
+    let h_body = format_h_body(input, &includes, &foreign_fwd_decls, ordered_cc)?;
+
+    Ok(Output { h_body, h_shards: vec![], rs_body })
+}
+
+/// Formats the body of a generated C++ header: the `includes` and the
+/// `foreign_fwd_decls` (see `format_foreign_fwd_decls`), followed by the
+/// `ordered_cc` items nested in the top-level namespace of the crate.
+fn format_h_body(
+    input: &Input,
+    includes: &BTreeSet<CcInclude>,
+    foreign_fwd_decls: &HashSet<DefId>,
+    ordered_cc: Vec<(NamespaceQualifier, TokenStream)>,
+) -> Result<TokenStream> {
+    let tcx = input.tcx;
+    // TODO(b/254690602): Decide whether using `#crate_name` as the name of the
+    // top-level namespace is okay (e.g. investigate if this name is globally
+    // unique + ergonomic).
+    let crate_name = format_cc_ident(tcx.crate_name(LOCAL_CRATE).as_str())?;
+
+    let foreign_fwd_decls = format_foreign_fwd_decls(input, includes, foreign_fwd_decls);
+    let includes = format_cc_includes(includes);
+    let ordered_cc = format_namespace_bound_cc_tokens(ordered_cc);
+    Ok(quote! {
+        #includes
+        __NEWLINE__ __NEWLINE__
+        #foreign_fwd_decls
+        namespace #crate_name {
+            __NEWLINE__
+            #ordered_cc
             __NEWLINE__
         }
+        __NEWLINE__
+    })
+}
+
+/// Returns the name of the C++ header shard with the bindings for the items
+/// from the `mod_path` module (e.g. `crate.foo.bar.h` for `crate::foo::bar`).
+///
+/// The names of different Rust modules never collide, because `crate` can't
+/// be the name of a Rust module.
+fn format_h_shard_file_name(mod_path: &NamespaceQualifier) -> Rc<str> {
+    once("crate").chain(mod_path.parts()).chain(once("h")).join(".").into()
+}
+
+/// Name of the C++ header shard with the forward declarations shared by all the
+/// other shards (see `format_h_shards`).
+const FWD_DECLS_H_SHARD_FILE_NAME: &str = "crate_fwd.h";
+
+/// Formats the C++ bindings as separate headers ("shards") for each Rust
+/// module, so that a C++ translation unit only has to parse the bindings of the
+/// modules that it uses (and of the modules that they depend on).
+///
+/// Forward declarations (`CcPrerequisites::fwd_decls`) of all the shards are
+/// gathered into a single, shared shard.  A shard `#include`s the shards that
+/// define the items required by its `CcPrerequisites::defs`.  Modules that
+/// would `#include` each other (directly or transitively) are merged into a
+/// single shard.
+///
+/// Returns the umbrella header that includes all the shards, and the file
+/// names and contents of the shards (see `Output::h_shards`).
+fn format_h_shards(
+    input: &Input,
+    h_shards_include_dir: &str,
+    ordered_ids: Vec<LocalDefId>,
+    mut main_apis: HashMap<LocalDefId, CcSnippet>,
+    cc_details: Vec<(LocalDefId, CcSnippet)>,
+) -> Result<(TokenStream, Vec<(Rc<str>, TokenStream)>)> {
+    let tcx = input.tcx;
+    let mod_path_of =
+        |def_id: LocalDefId| FullyQualifiedName::new(tcx, def_id.to_def_id()).mod_path;
+
+    // `main_apis` (in the same order as `ordered_ids`), followed by `cc_details`.
+    let items: Vec<(LocalDefId, NamespaceQualifier, CcSnippet)> = ordered_ids
+        .into_iter()
+        .map(|def_id| (def_id, main_apis.remove(&def_id).unwrap()))
+        .chain(cc_details.into_iter())
+        .map(|(def_id, snippet)| (def_id, mod_path_of(def_id), snippet))
+        .collect_vec();
+
+    // Assign the modules to shards, merging the modules that form `#include`
+    // cycles (and the modules that depend on them) into a single shard.
+    let mod_path_to_file_name: HashMap<NamespaceQualifier, Rc<str>> = {
+        let nodes: BTreeSet<NamespaceQualifier> =
+            items.iter().map(|(_, mod_path, _)| mod_path.clone()).collect();
+        let deps = items
+            .iter()
+            .flat_map(|(_, successor, snippet)| {
+                snippet.prereqs.defs.iter().map(move |&def_id| (mod_path_of(def_id), successor))
+            })
+            .filter(|(predecessor, successor)| predecessor != *successor)
+            .map(|(predecessor, successor)| toposort::Dependency {
+                predecessor,
+                successor: successor.clone(),
+            })
+            .collect_vec();
+        let toposort::TopoSortResult { ordered, failed } =
+            toposort::toposort(nodes, deps, Ord::cmp);
+        let merged_file_name = failed.iter().min().map(format_h_shard_file_name);
+        ordered
+            .into_iter()
+            .map(|mod_path| {
+                let file_name = format_h_shard_file_name(&mod_path);
+                (mod_path, file_name)
+            })
+            .chain(failed.into_iter().map(|mod_path| (mod_path, merged_file_name.clone().unwrap())))
+            .collect()
     };
+    let shard_include = |file_name: &str| {
+        CcInclude::user_header(format!("{h_shards_include_dir}/{file_name}").into())
+    };
+
+    #[derive(Default)]
+    struct Shard {
+        includes: BTreeSet<CcInclude>,
+        foreign_fwd_decls: HashSet<DefId>,
+        ordered_cc: Vec<(NamespaceQualifier, TokenStream)>,
+    }
+    let mut shards = HashMap::<Rc<str>, Shard>::new();
+    let mut fwd_decls = HashSet::<LocalDefId>::new();
+    for (_, mod_path, snippet) in items.into_iter() {
+        let file_name = &mod_path_to_file_name[&mod_path];
+        let shard = shards.entry(file_name.clone()).or_default();
+        let CcSnippet {
+            tokens,
+            prereqs:
+                CcPrerequisites {
+                    mut includes,
+                    defs,
+                    fwd_decls: inner,
+                    foreign_defs,
+                    foreign_fwd_decls,
+                },
+        } = snippet;
+        shard.includes.append(&mut includes);
+        shard
+            .includes
+            .extend(foreign_defs.into_iter().map(|def_id| format_foreign_include(input, def_id)));
+        shard.foreign_fwd_decls.extend(foreign_fwd_decls);
+        for def in defs {
+            let def_file_name = &mod_path_to_file_name[&mod_path_of(def)];
+            if def_file_name != file_name {
+                shard.includes.insert(shard_include(def_file_name));
+            }
+        }
+        if !inner.is_empty() {
+            shard.includes.insert(shard_include(FWD_DECLS_H_SHARD_FILE_NAME));
+            fwd_decls.extend(inner);
+        }
+        shard.ordered_cc.push((mod_path, tokens));
+    }
+
+    let mut h_shards = vec![];
+    if !fwd_decls.is_empty() {
+        let ordered_fwd_decls = fwd_decls
+            .into_iter()
+            .sorted_by_key(|def_id| source_order_key(tcx, *def_id))
+            .map(|def_id| (mod_path_of(def_id), format_fwd_decl(input, def_id.to_def_id())))
+            .collect_vec();
+        let h_body = format_h_body(input, &BTreeSet::new(), &HashSet::new(), ordered_fwd_decls)?;
+        h_shards.push((FWD_DECLS_H_SHARD_FILE_NAME.into(), h_body));
+    }
+    for (file_name, Shard { includes, foreign_fwd_decls, ordered_cc }) in
+        shards.into_iter().sorted_by(|(lhs, _), (rhs, _)| lhs.cmp(rhs))
+    {
+        let h_body = format_h_body(input, &includes, &foreign_fwd_decls, ordered_cc)?;
+        h_shards.push((file_name, h_body));
+    }
+
+    let umbrella_includes: BTreeSet<CcInclude> = h_shards
+        .iter()
+        .filter(|(file_name, _)| &**file_name != FWD_DECLS_H_SHARD_FILE_NAME)
+        .map(|(file_name, _)| shard_include(file_name))
+        .collect();
+    let h_body = format_cc_includes(&umbrella_includes);
 
-    Ok(Output { h_body, rs_body })
+    Ok((h_body, h_shards))
 }
 
 #[cfg(test)]
@@ -2491,7 +3685,7 @@ pub mod tests {
                 quote! {
                     namespace rust_out {
                         ...
-                        struct CRUBIT_INTERNAL_RUST_TYPE(":: rust_out :: Point") alignas(4) Point final {
+                        struct CRUBIT_INTERNAL_RUST_TYPE(":: rust_out :: Point") CRUBIT_INTERNAL_TRIVIAL_ABI alignas(4) Point final {
                             // No point replicating test coverage of
                             // `test_format_item_struct_with_fields`.
                             ...
@@ -2613,11 +3807,11 @@ pub mod tests {
                 quote! {
                     namespace rust_out {
                     ...
-                        struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(1) Inner final {
+                        struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(1) Inner final {
                           ... union { ... bool __field0; }; ...
                         };
                     ...
-                        struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(1) Outer final {
+                        struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(1) Outer final {
                           ... union { ... ::rust_out::Inner __field0; }; ...
                         };
                     ...
@@ -2651,7 +3845,7 @@ pub mod tests {
                         ...
                         void f(::rust_out::S const* __param_0);
                         ...
-                        struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(...) S final { ... }
+                        struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(...) S final { ... }
                         ...
                         inline void f(::rust_out::S const* __param_0) { ... }
                         ...
@@ -2693,7 +3887,7 @@ pub mod tests {
                         // include `S` as a `fwd_decls` edge, rather than as a `defs` edge.
                         bool f(::rust_out::S s);
                         ...
-                        struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(...) S final { ... }
+                        struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(...) S final { ... }
                         ...
                     }  // namespace rust_out
                 }
@@ -2775,11 +3969,11 @@ pub mod tests {
                         void f3 ...
 
                         namespace a { ...
-                        struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(...) S1 final { ... } ...
-                        struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(...) S2 final { ... } ...
+                        struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(...) S1 final { ... } ...
+                        struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(...) S2 final { ... } ...
                         } ...
                         namespace b { ...
-                        struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(...) S3 final { ... } ...
+                        struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(...) S3 final { ... } ...
                         } ...
                     }  // namespace rust_out
                 }
@@ -2807,6 +4001,170 @@ pub mod tests {
         });
     }
 
+    /// Tests that ADTs from other crates are only forward-declared (rather
+    /// than `#include`d) when the bindings only use pointers to them.
+    #[test]
+    fn test_generated_bindings_foreign_fwd_decls() {
+        let test_src = r#"
+                pub fn f(_: *const std::cmp::Ordering) {}
+            "#;
+        test_generated_bindings_with_core_bindings(test_src, |bindings| {
+            let bindings = bindings.unwrap();
+            assert_cc_matches!(
+                bindings.h_body,
+                quote! {
+                    namespace core::cmp {
+                        struct Ordering;
+                    }
+                    namespace rust_out {
+                        ...
+                        void f(::core::cmp::Ordering const* __param_0);
+                        ...
+                    }
+                }
+            );
+            assert_cc_not_matches!(bindings.h_body, quote! { include "core_cc_api.h" });
+        });
+    }
+
+    /// Tests that the bindings of other crates are `#include`d (and their ADTs
+    /// are not forward-declared) when the bindings need the definitions of
+    /// their ADTs.
+    #[test]
+    fn test_generated_bindings_foreign_defs() {
+        let test_src = r#"
+                pub fn f(_: *const std::cmp::Ordering) {}
+                pub fn g(_: std::cmp::Ordering) {}
+            "#;
+        test_generated_bindings_with_core_bindings(test_src, |bindings| {
+            let bindings = bindings.unwrap();
+            assert_cc_matches!(bindings.h_body, quote! { __HASH_TOKEN__ include "core_cc_api.h" });
+            assert_cc_not_matches!(bindings.h_body, quote! { struct Ordering; });
+        });
+    }
+
+    /// Returns the contents of the shard named `file_name`.
+    fn get_h_shard<'a>(bindings: &'a Output, file_name: &str) -> &'a TokenStream {
+        let (_, h_shard) = bindings
+            .h_shards
+            .iter()
+            .find(|(name, _)| &**name == file_name)
+            .unwrap_or_else(|| panic!("No `{file_name}` shard"));
+        h_shard
+    }
+
+    /// Tests that the bindings of each module go into a separate shard, which
+    /// `#include`s the shards of the modules that it depends on.
+    #[test]
+    fn test_generated_bindings_h_shards() {
+        let test_src = r#"
+                pub fn root_fn() {}
+                pub mod a {
+                    pub fn get_s() -> super::b::S { super::b::S(true) }
+                }
+                pub mod b {
+                    #[derive(Clone, Copy)]
+                    pub struct S(pub bool);
+                }
+            "#;
+        test_generated_sharded_bindings(test_src, |bindings| {
+            let bindings = bindings.unwrap();
+            let shard_names = bindings.h_shards.iter().map(|(name, _)| &**name).collect_vec();
+            assert_eq!(vec!["crate.a.h", "crate.b.h", "crate.h"], shard_names);
+            assert_cc_matches!(
+                bindings.h_body,
+                quote! {
+                    __HASH_TOKEN__ pragma once ...
+                    __HASH_TOKEN__ include "shards/dir/crate.a.h" ...
+                    __HASH_TOKEN__ include "shards/dir/crate.b.h" ...
+                    __HASH_TOKEN__ include "shards/dir/crate.h"
+                }
+            );
+            assert_cc_not_matches!(bindings.h_body, quote! { namespace rust_out });
+
+            let a_shard = get_h_shard(&bindings, "crate.a.h");
+            assert_cc_matches!(
+                a_shard,
+                quote! {
+                    __HASH_TOKEN__ pragma once ...
+                    __HASH_TOKEN__ include "shards/dir/crate.b.h" ...
+                    namespace rust_out {
+                        namespace a {
+                            ... ::rust_out::b::S get_s(); ...
+                        }
+                    }
+                }
+            );
+            assert_cc_not_matches!(a_shard, quote! { struct ... S final });
+
+            let b_shard = get_h_shard(&bindings, "crate.b.h");
+            assert_cc_matches!(b_shard, quote! { struct ... S final });
+            assert_cc_not_matches!(b_shard, quote! { include "shards/dir/crate.a.h" });
+            assert_cc_not_matches!(b_shard, quote! { get_s });
+
+            let root_shard = get_h_shard(&bindings, "crate.h");
+            assert_cc_matches!(root_shard, quote! { void root_fn(); });
+            assert_cc_not_matches!(root_shard, quote! { include "shards/dir/crate.a.h" });
+        });
+    }
+
+    /// Tests that forward declarations go into a shared shard.
+    #[test]
+    fn test_generated_bindings_h_shards_fwd_decls() {
+        let test_src = r#"
+                pub mod a {
+                    pub fn f(_: *const super::b::S) {}
+                }
+                pub mod b {
+                    pub struct S(bool);
+                }
+            "#;
+        test_generated_sharded_bindings(test_src, |bindings| {
+            let bindings = bindings.unwrap();
+            assert_cc_matches!(
+                get_h_shard(&bindings, "crate_fwd.h"),
+                quote! {
+                    namespace rust_out {
+                        namespace b {
+                            struct S;
+                        }
+                    }
+                }
+            );
+            let a_shard = get_h_shard(&bindings, "crate.a.h");
+            assert_cc_matches!(a_shard, quote! { __HASH_TOKEN__ include "shards/dir/crate_fwd.h" });
+            assert_cc_not_matches!(a_shard, quote! { include "shards/dir/crate.b.h" });
+            assert_cc_not_matches!(bindings.h_body, quote! { include "shards/dir/crate_fwd.h" });
+        });
+    }
+
+    /// Tests that modules that depend on each other are merged into a single
+    /// shard (rather than `#include`ing each other).
+    #[test]
+    fn test_generated_bindings_h_shards_cycle() {
+        let test_src = r#"
+                pub mod a {
+                    #[derive(Clone, Copy)]
+                    pub struct A(pub bool);
+                    pub fn get_b() -> super::b::B { super::b::B(true) }
+                }
+                pub mod b {
+                    #[derive(Clone, Copy)]
+                    pub struct B(pub bool);
+                    pub fn get_a() -> super::a::A { super::a::A(true) }
+                }
+            "#;
+        test_generated_sharded_bindings(test_src, |bindings| {
+            let bindings = bindings.unwrap();
+            let shard_names = bindings.h_shards.iter().map(|(name, _)| &**name).collect_vec();
+            assert_eq!(vec!["crate.a.h"], shard_names);
+            let a_shard = get_h_shard(&bindings, "crate.a.h");
+            assert_cc_matches!(a_shard, quote! { struct ... A final });
+            assert_cc_matches!(a_shard, quote! { struct ... B final });
+            assert_cc_not_matches!(a_shard, quote! { include "shards/dir/crate.a.h" });
+        });
+    }
+
     /// This test verifies that a method declaration doesn't ask for a forward
     /// declaration to the struct.
     #[test]
@@ -3099,6 +4457,98 @@ pub mod tests {
         });
     }
 
+    #[test]
+    fn test_format_item_fn_inline_constant() {
+        let test_src = r#"
+                #[inline]
+                pub fn inline_constant() -> i32 { 42 }
+            "#;
+        test_format_item(test_src, "inline_constant", |result| {
+            let result = result.unwrap().unwrap();
+            assert_cc_matches!(
+                result.main_api.tokens,
+                quote! {
+                    std::int32_t inline_constant();
+                }
+            );
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    inline std::int32_t inline_constant() {
+                        return 42;
+                    }
+                }
+            );
+            assert_cc_not_matches!(result.cc_details.tokens, quote! { __crubit_internal });
+            assert!(result.rs_details.is_empty());
+        });
+    }
+
+    #[test]
+    fn test_format_item_fn_inline_field_read() {
+        let test_src = r#"
+                #[repr(C)]
+                pub struct Point {
+                    pub x: i32,
+                    y: i32,
+                }
+
+                impl Point {
+                    #[inline]
+                    pub fn get_y(&self) -> i32 { self.y }
+                }
+
+                #[inline]
+                pub fn get_x(p: Point) -> i32 { p.x }
+            "#;
+        test_format_item(test_src, "get_x", |result| {
+            let result = result.unwrap().unwrap();
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    inline std::int32_t get_x(::rust_out::Point p) {
+                        return p.x;
+                    }
+                }
+            );
+            assert!(result.rs_details.is_empty());
+        });
+        test_format_item(test_src, "Point", |result| {
+            let result = result.unwrap().unwrap();
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    inline std::int32_t Point::get_y() const [[clang::annotate_type("lifetime", "__anon1")]] {
+                        return this->y;
+                    }
+                }
+            );
+            assert_rs_not_matches!(result.rs_details, quote! { get_y });
+        });
+    }
+
+    /// Bodies that are not trivially translatable to C++, and functions that
+    /// are not `#[inline]`, are still called through a thunk.
+    #[test]
+    fn test_format_item_fn_not_inlined() {
+        let test_src = r#"
+                #[inline]
+                pub fn add(x: i32, y: i32) -> i32 { x + y }
+
+                pub fn not_inline() -> i32 { 42 }
+
+                #[inline]
+                pub fn too_large() -> u64 { 18446744073709551615 }
+            "#;
+        for name in ["add", "not_inline", "too_large"] {
+            test_format_item(test_src, name, |result| {
+                let result = result.unwrap().unwrap();
+                assert_cc_matches!(result.cc_details.tokens, quote! { __crubit_internal });
+                assert!(!result.rs_details.is_empty());
+            });
+        }
+    }
+
     /// The `test_format_item_fn_explicit_unit_return_type` test below is very
     /// similar to the
     /// `test_format_item_fn_extern_c_no_mangle_no_params_no_return_type` above,
@@ -3343,6 +4793,21 @@ pub mod tests {
                 quote! { include <cstdint> }
             );
 
+            // `S` is returned through `crubit::InitInPlaceTag`, which only needs a
+            // small support header (and neither `<utility>` nor `ReturnValueSlot`).
+            assert_cc_matches!(
+                format_cc_includes(&result.cc_details.prereqs.includes),
+                quote! { include "crubit/support/for/tests/internal/init_in_place.h" }
+            );
+            for prereqs in [&main_api.prereqs, &result.cc_details.prereqs] {
+                let includes = format_cc_includes(&prereqs.includes);
+                assert_cc_not_matches!(includes, quote! { include <utility> });
+                assert_cc_not_matches!(
+                    includes,
+                    quote! { include "crubit/support/for/tests/internal/return_value_slot.h" }
+                );
+            }
+
             // Main checks: `CcPrerequisites::defs` and `CcPrerequisites::fwd_decls`.
             //
             // Verifying the actual def_id is tricky, because `test_format_item` doesn't
@@ -3391,35 +4856,133 @@ pub mod tests {
     }
 
     #[test]
-    fn test_format_item_fn_with_type_aliased_return_type() {
-        // Type aliases disappear at the `rustc_middle::ty::Ty` level and therefore in
-        // the short-term the generated bindings also ignore type aliases.
-        //
-        // TODO(b/254096006): Consider preserving `type` aliases when generating
-        // bindings.
+    fn test_format_item_fn_extern_c_with_repr_c_struct_by_value() {
         let test_src = r#"
-                type MyTypeAlias = f64;
+                #[repr(C)]
+                pub struct Pair {
+                    pub first: i32,
+                    pub second: f32,
+                }
 
                 #[no_mangle]
-                pub extern "C" fn type_aliased_return() -> MyTypeAlias { 42.0 }
+                pub extern "C" fn swap(p: Pair) -> Pair {
+                    Pair { first: p.second as i32, second: p.first as f32 }
+                }
             "#;
-        test_format_item(test_src, "type_aliased_return", |result| {
+        test_format_item(test_src, "swap", |result| {
             let result = result.unwrap().unwrap();
-            let main_api = &result.main_api;
-            assert!(main_api.prereqs.is_empty());
             assert_cc_matches!(
-                main_api.tokens,
+                result.main_api.tokens,
                 quote! {
-                    extern "C" double type_aliased_return();
+                    extern "C" ::rust_out::Pair swap(::rust_out::Pair p);
                 }
             );
+            // The C++ struct has the same ABI as the Rust struct, so there is no need for a
+            // C++-side definition of `swap`, nor for a thunk.
+            assert!(result.cc_details.tokens.is_empty());
+            assert!(result.rs_details.is_empty());
         });
     }
 
     #[test]
-    fn test_format_item_fn_with_doc_comment_with_unmangled_name() {
+    fn test_format_item_fn_rust_abi_with_repr_transparent_struct_by_value() {
         let test_src = r#"
-            /// Outer line doc.
+                #[repr(transparent)]
+                pub struct Meters(pub f64);
+
+                pub fn twice(m: Meters) -> Meters {
+                    Meters(m.0 * 2.0)
+                }
+            "#;
+        test_format_item(test_src, "twice", |result| {
+            let result = result.unwrap().unwrap();
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    namespace __crubit_internal {
+                        extern "C" ::rust_out::Meters ...(::rust_out::Meters);
+                    }
+                    inline ::rust_out::Meters twice(::rust_out::Meters m) {
+                        return __crubit_internal::...(std::move(m));
+                    }
+                }
+            );
+            assert_rs_matches!(
+                result.rs_details,
+                quote! {
+                    #[no_mangle]
+                    extern "C" fn ...(m: ::rust_out::Meters) -> ::rust_out::Meters {
+                        ::rust_out::twice(m)
+                    }
+                }
+            );
+        });
+    }
+
+    /// Structs with padding, or with a user-provided C++ copy constructor, may
+    /// be passed differently by C++ than by Rust, and therefore still need to
+    /// go through a thunk.
+    #[test]
+    fn test_format_item_fn_extern_c_with_struct_requiring_thunk() {
+        let test_src = r#"
+                #[repr(C)]
+                pub struct WithPadding {
+                    pub x: u8,
+                    pub y: u32,
+                }
+
+                #[repr(C)]
+                #[derive(Clone)]
+                pub struct WithClone {
+                    pub x: u32,
+                }
+
+                #[no_mangle]
+                pub extern "C" fn with_padding(s: WithPadding) -> u32 { s.y }
+
+                #[no_mangle]
+                pub extern "C" fn with_clone(s: WithClone) -> u32 { s.x }
+            "#;
+        for name in ["with_padding", "with_clone"] {
+            test_format_item(test_src, name, |result| {
+                let result = result.unwrap().unwrap();
+                assert_cc_not_matches!(result.main_api.tokens, quote! { extern "C" });
+                assert_cc_matches!(result.cc_details.tokens, quote! { __crubit_internal });
+                assert!(!result.rs_details.is_empty());
+            });
+        }
+    }
+
+    #[test]
+    fn test_format_item_fn_with_type_aliased_return_type() {
+        // Type aliases disappear at the `rustc_middle::ty::Ty` level and therefore in
+        // the short-term the generated bindings also ignore type aliases.
+        //
+        // TODO(b/254096006): Consider preserving `type` aliases when generating
+        // bindings.
+        let test_src = r#"
+                type MyTypeAlias = f64;
+
+                #[no_mangle]
+                pub extern "C" fn type_aliased_return() -> MyTypeAlias { 42.0 }
+            "#;
+        test_format_item(test_src, "type_aliased_return", |result| {
+            let result = result.unwrap().unwrap();
+            let main_api = &result.main_api;
+            assert!(main_api.prereqs.is_empty());
+            assert_cc_matches!(
+                main_api.tokens,
+                quote! {
+                    extern "C" double type_aliased_return();
+                }
+            );
+        });
+    }
+
+    #[test]
+    fn test_format_item_fn_with_doc_comment_with_unmangled_name() {
+        let test_src = r#"
+            /// Outer line doc.
             /** Outer block doc that spans lines.
              */
             #[doc = "Doc comment via doc attribute."]
@@ -3707,6 +5270,74 @@ pub mod tests {
         });
     }
 
+    #[test]
+    fn test_format_item_generic_fn_instantiations() {
+        let test_src = r#"
+                pub mod some_mod {
+                    pub fn max<T: PartialOrd>(x: T, y: T) -> T {
+                        if x < y { y } else { x }
+                    }
+                }
+            "#;
+        run_compiler_for_testing(test_src, |tcx| {
+            let input = Input {
+                generic_fn_instantiations: vec![
+                    ("some_mod::max::<i32>".into(), "max_i32".into()),
+                    ("crate::some_mod::max::<f64>".into(), "max_f64".into()),
+                ],
+                ..bindings_input_for_tests(tcx)
+            };
+            let def_id = find_def_id_by_name(tcx, "max");
+            let result = format_item(&input, def_id).unwrap().unwrap();
+            assert_cc_matches!(
+                result.main_api.tokens,
+                quote! {
+                    ...
+                    std::int32_t max_i32(std::int32_t x, std::int32_t y);
+                    ...
+                    double max_f64(double x, double y);
+                    ...
+                }
+            );
+            assert_rs_matches!(
+                result.rs_details,
+                quote! {
+                    #[no_mangle]
+                    extern "C" fn ...(x: i32, y: i32) -> i32 {
+                        ::rust_out::some_mod::max::<i32>(x, y)
+                    }
+                    #[no_mangle]
+                    extern "C" fn ...(x: f64, y: f64) -> f64 {
+                        ::rust_out::some_mod::max::<f64>(x, y)
+                    }
+                }
+            );
+        });
+    }
+
+    #[test]
+    fn test_format_item_generic_fn_instantiation_with_wrong_arity() {
+        let test_src = r#"
+                pub fn generic_function<T>(_: T) {}
+            "#;
+        run_compiler_for_testing(test_src, |tcx| {
+            let input = Input {
+                generic_fn_instantiations: vec![(
+                    "generic_function::<i32, u8>".into(),
+                    "generic_function_i32".into(),
+                )],
+                ..bindings_input_for_tests(tcx)
+            };
+            let def_id = find_def_id_by_name(tcx, "generic_function");
+            let err = format!("{:#}", format_item(&input, def_id).unwrap_err());
+            assert_eq!(
+                err,
+                "`generic_function::<i32, u8>` has 2 type arguments, \
+                 but `generic_function` has 1 type parameters"
+            );
+        });
+    }
+
     #[test]
     fn test_format_item_unsupported_type_generic_struct() {
         let test_src = r#"
@@ -3734,85 +5365,349 @@ pub mod tests {
                     // hidden underneath the `Self` type), and some at the `fn` level.
                     pub fn new<'b, 'c>(_x: &'b i32, _y: &'c i32) -> Self { unimplemented!() }
                 }
-            "#;
-        test_format_item(test_src, "Point", |result| {
-            let err = result.unwrap_err();
-            assert_eq!(err, "Generic types are not supported yet (b/259749095)");
+            "#;
+        test_format_item(test_src, "Point", |result| {
+            let err = result.unwrap_err();
+            assert_eq!(err, "Generic types are not supported yet (b/259749095)");
+        });
+    }
+
+    #[test]
+    fn test_format_item_unsupported_generic_enum() {
+        let test_src = r#"
+                pub enum Point<T> {
+                    Cartesian{x: T, y: T},
+                    Polar{angle: T, dist: T},
+                }
+            "#;
+        test_format_item(test_src, "Point", |result| {
+            let err = result.unwrap_err();
+            assert_eq!(err, "Generic types are not supported yet (b/259749095)");
+        });
+    }
+
+    #[test]
+    fn test_format_item_unsupported_generic_union() {
+        let test_src = r#"
+                pub union SomeUnion<T> {
+                    pub x: std::mem::ManuallyDrop<T>,
+                    pub y: i32,
+                }
+            "#;
+        test_format_item(test_src, "SomeUnion", |result| {
+            let err = result.unwrap_err();
+            assert_eq!(err, "Generic types are not supported yet (b/259749095)");
+        });
+    }
+
+    #[test]
+    fn test_format_item_unsupported_fn_async() {
+        let test_src = r#"
+                pub async fn async_function() {}
+            "#;
+        test_format_item(test_src, "async_function", |result| {
+            let err = result.unwrap_err();
+            assert_eq!(
+                err,
+                "Error formatting function return type: \
+                             The following Rust type is not supported yet: \
+                             impl std::future::Future<Output = ()>"
+            );
+        });
+    }
+
+    #[test]
+    fn test_format_item_fn_rust_abi() {
+        let test_src = r#"
+                pub fn add(x: f64, y: f64) -> f64 { x * y }
+            "#;
+        test_format_item(test_src, "add", |result| {
+            // TODO(b/261074843): Re-add thunk name verification once we are using stable
+            // name mangling (which may be coming in Q1 2023).  (This might mean
+            // reverting cl/492333432 + manual review and tweaks.)
+            let result = result.unwrap().unwrap();
+            let main_api = &result.main_api;
+            assert!(main_api.prereqs.is_empty());
+            assert_cc_matches!(
+                main_api.tokens,
+                quote! {
+                    double add(double x, double y);
+                }
+            );
+            assert!(result.cc_details.prereqs.is_empty());
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    namespace __crubit_internal {
+                        extern "C" double ...(double, double);
+                    }
+                    ...
+                    inline double add(double x, double y) {
+                        return __crubit_internal::...(x, y);
+                    }
+                }
+            );
+            assert_rs_matches!(
+                result.rs_details,
+                quote! {
+                    #[no_mangle]
+                    extern "C"
+                    fn ...(x: f64, y: f64) -> f64 {
+                        ::rust_out::add(x, y)
+                    }
+                }
+            );
+        });
+    }
+
+    #[test]
+    fn test_format_item_fn_rust_abi_with_param_taking_struct_by_value() {
+        let test_src = r#"
+                pub struct S(i32);
+                pub fn into_i32(s: S) -> i32 { s.0 }
+            "#;
+        test_format_item(test_src, "into_i32", |result| {
+            let result = result.unwrap().unwrap();
+            let main_api = &result.main_api;
+            assert_cc_matches!(
+                main_api.tokens,
+                quote! {
+                    std::int32_t into_i32(::rust_out::S s);
+                }
+            );
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    namespace __crubit_internal {
+                        extern "C" std::int32_t ...(::rust_out::S*);
+                    }
+                    ...
+                    inline std::int32_t into_i32(::rust_out::S s) {
+                        return __crubit_internal::...(&s);
+                    }
+                }
+            );
+            assert_rs_matches!(
+                result.rs_details,
+                quote! {
+                    #[no_mangle]
+                    extern "C"
+                    fn ...(s: &mut ::core::mem::MaybeUninit<::rust_out::S>) -> i32 {
+                        ::rust_out::into_i32(unsafe { s.assume_init_read() })
+                    }
+                }
+            );
+        });
+    }
+
+    #[test]
+    fn test_format_item_fn_rust_abi_returning_struct_by_value() {
+        let test_src = r#"
+                pub struct S(i32);
+                pub fn create(i: i32) -> S { S(i) }
+            "#;
+        test_format_item(test_src, "create", |result| {
+            let result = result.unwrap().unwrap();
+            let main_api = &result.main_api;
+            assert_cc_matches!(
+                main_api.tokens,
+                quote! {
+                    ::rust_out::S create(std::int32_t i);
+                }
+            );
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    namespace __crubit_internal {
+                        extern "C" void ...(std::int32_t, ::rust_out::S* __ret_ptr);
+                    }
+                    ...
+                    inline ::rust_out::S create(std::int32_t i) {
+                        return ::rust_out::S(
+                            crubit::InitInPlaceTag{},
+                            [&](::rust_out::S* __ret_ptr) {
+                                __crubit_internal::...(i, __ret_ptr);
+                            });
+                    }
+                }
+            );
+            assert_rs_matches!(
+                result.rs_details,
+                quote! {
+                    #[no_mangle]
+                    extern "C"
+                    fn ...(
+                        i: i32,
+                        __ret_slot: &mut ::core::mem::MaybeUninit<::rust_out::S>
+                    ) -> () {
+                        __ret_slot.write(::rust_out::create(i));
+                    }
+                }
+            );
+        });
+    }
+
+    #[test]
+    fn test_format_item_fn_returning_vec() {
+        let test_src = r#"
+                pub fn squares(n: i32) -> Vec<i32> {
+                    (0..n).map(|i| i * i).collect()
+                }
+            "#;
+        test_format_item(test_src, "squares", |result| {
+            let result = result.unwrap().unwrap();
+            let main_api = &result.main_api;
+            let vec_h = CcInclude::user_header("crubit/support/for/tests/rs_std/vec.h".into());
+            assert!(main_api.prereqs.includes.contains(&vec_h));
+            assert_cc_matches!(
+                main_api.tokens,
+                quote! {
+                    rs_std::Vec<std::int32_t> squares(std::int32_t n);
+                }
+            );
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    namespace __crubit_internal {
+                        extern "C" void ...(
+                            std::int32_t,
+                            rs_std::Vec<std::int32_t>::RawParts* __ret_ptr);
+                    }
+                    inline rs_std::Vec<std::int32_t> squares(std::int32_t n) {
+                        rs_std::Vec<std::int32_t>::RawParts __raw;
+                        __crubit_internal::...(n, &__raw);
+                        return rs_std::Vec<std::int32_t>(__raw);
+                    }
+                }
+            );
+            assert_rs_matches!(
+                result.rs_details,
+                quote! {
+                    #[no_mangle]
+                    extern "C"
+                    fn ...(
+                        n: i32,
+                        __ret_slot: &mut ::core::mem::MaybeUninit<::rs_std_owned::RawVec<i32>>
+                    ) -> () {
+                        __ret_slot.write(::rs_std_owned::vec_into_raw(::rust_out::squares(n)));
+                    }
+                }
+            );
         });
     }
 
     #[test]
-    fn test_format_item_unsupported_generic_enum() {
+    fn test_format_item_fn_returning_string() {
         let test_src = r#"
-                pub enum Point<T> {
-                    Cartesian{x: T, y: T},
-                    Polar{angle: T, dist: T},
+                pub fn greeting() -> String {
+                    "Hello, world!".to_string()
                 }
             "#;
-        test_format_item(test_src, "Point", |result| {
-            let err = result.unwrap_err();
-            assert_eq!(err, "Generic types are not supported yet (b/259749095)");
+        test_format_item(test_src, "greeting", |result| {
+            let result = result.unwrap().unwrap();
+            assert_cc_matches!(result.main_api.tokens, quote! { rs_std::String greeting(); });
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    inline rs_std::String greeting() {
+                        rs_std::String::RawParts __raw;
+                        __crubit_internal::...(&__raw);
+                        return rs_std::String(__raw);
+                    }
+                }
+            );
+            assert_rs_matches!(
+                result.rs_details,
+                quote! {
+                    __ret_slot.write(::rs_std_owned::string_into_raw(::rust_out::greeting()));
+                }
+            );
         });
     }
 
     #[test]
-    fn test_format_item_unsupported_generic_union() {
+    fn test_format_item_fn_returning_box() {
         let test_src = r#"
-                pub union SomeUnion<T> {
-                    pub x: std::mem::ManuallyDrop<T>,
+                pub struct Point {
+                    pub x: i32,
                     pub y: i32,
                 }
+
+                pub fn new_point(x: i32, y: i32) -> Box<Point> {
+                    Box::new(Point { x, y })
+                }
             "#;
-        test_format_item(test_src, "SomeUnion", |result| {
-            let err = result.unwrap_err();
-            assert_eq!(err, "Generic types are not supported yet (b/259749095)");
+        test_format_item(test_src, "new_point", |result| {
+            let result = result.unwrap().unwrap();
+            let main_api = &result.main_api;
+            // `rs_std::Box<Point>` only needs a forward declaration of `Point`.
+            assert!(main_api.prereqs.defs.is_empty());
+            assert_cc_matches!(
+                main_api.tokens,
+                quote! {
+                    rs_std::Box<::rust_out::Point> new_point(std::int32_t x, std::int32_t y);
+                }
+            );
+            assert_rs_matches!(
+                result.rs_details,
+                quote! {
+                    __ret_slot: &mut ::core::mem::MaybeUninit<
+                        ::rs_std_owned::RawBox<::rust_out::Point>
+                    >
+                }
+            );
         });
     }
 
     #[test]
-    fn test_format_item_unsupported_fn_async() {
+    fn test_format_item_fn_returning_vec_that_borrows() {
         let test_src = r#"
-                pub async fn async_function() {}
+                pub fn names() -> Vec<&'static str> {
+                    vec!["foo", "bar"]
+                }
             "#;
-        test_format_item(test_src, "async_function", |result| {
+        test_format_item(test_src, "names", |result| {
             let err = result.unwrap_err();
             assert_eq!(
                 err,
                 "Error formatting function return type: \
-                             The following Rust type is not supported yet: \
-                             impl std::future::Future<Output = ()>"
+                 `Vec<T>`, `String`, and `Box<T>` values that borrow can't be returned to C++ yet"
             );
         });
     }
 
     #[test]
-    fn test_format_item_fn_rust_abi() {
+    fn test_format_item_fn_returning_iterator() {
         let test_src = r#"
-                pub fn add(x: f64, y: f64) -> f64 { x * y }
+                pub fn evens(n: u32) -> impl Iterator<Item = u32> {
+                    (0..n).filter(|i| i % 2 == 0)
+                }
             "#;
-        test_format_item(test_src, "add", |result| {
-            // TODO(b/261074843): Re-add thunk name verification once we are using stable
-            // name mangling (which may be coming in Q1 2023).  (This might mean
-            // reverting cl/492333432 + manual review and tweaks.)
+        test_format_item(test_src, "evens", |result| {
             let result = result.unwrap().unwrap();
             let main_api = &result.main_api;
-            assert!(main_api.prereqs.is_empty());
             assert_cc_matches!(
                 main_api.tokens,
                 quote! {
-                    double add(double x, double y);
+                    rs_std::ChunkedRange<std::uint32_t> evens(std::uint32_t n);
                 }
             );
-            assert!(result.cc_details.prereqs.is_empty());
             assert_cc_matches!(
                 result.cc_details.tokens,
                 quote! {
                     namespace __crubit_internal {
-                        extern "C" double ...(double, double);
+                        extern "C" void* ...(
+                            std::uint32_t,
+                            rs_std::ChunkedRange<std::uint32_t>::NextChunkFn* __next_chunk,
+                            rs_std::ChunkedRange<std::uint32_t>::DropFn* __drop);
                     }
                     ...
-                    inline double add(double x, double y) {
-                        return __crubit_internal::...(x, y);
+                    inline rs_std::ChunkedRange<std::uint32_t> evens(std::uint32_t n) {
+                        rs_std::ChunkedRange<std::uint32_t>::NextChunkFn __next_chunk;
+                        rs_std::ChunkedRange<std::uint32_t>::DropFn __drop;
+                        void* __boxed = __crubit_internal::...(n, &__next_chunk, &__drop);
+                        return rs_std::ChunkedRange<std::uint32_t>(
+                            __boxed, __next_chunk, __drop);
                     }
                 }
             );
@@ -3821,8 +5716,23 @@ pub mod tests {
                 quote! {
                     #[no_mangle]
                     extern "C"
-                    fn ...(x: f64, y: f64) -> f64 {
-                        ::rust_out::add(x, y)
+                    fn ...(
+                        n: u32,
+                        __next_chunk: &mut ::core::mem::MaybeUninit<
+                            unsafe extern "C" fn(*mut ::core::ffi::c_void, *mut u32, usize)
+                                -> usize
+                        >,
+                        __drop: &mut ::core::mem::MaybeUninit<
+                            unsafe extern "C" fn(*mut ::core::ffi::c_void)
+                        >
+                    ) -> *mut ::core::ffi::c_void {
+                        unsafe extern "C" fn __next_chunk_impl<
+                            I: ::core::iter::Iterator<Item = u32>
+                        >(...) -> usize {
+                            ...
+                        }
+                        ...
+                        __into_raw(::rust_out::evens(n), __next_chunk, __drop)
                     }
                 }
             );
@@ -3830,29 +5740,53 @@ pub mod tests {
     }
 
     #[test]
-    fn test_format_item_fn_rust_abi_with_param_taking_struct_by_value() {
+    fn test_format_item_fn_returning_iterator_that_borrows() {
         let test_src = r#"
-                pub struct S(i32);
-                pub fn into_i32(s: S) -> i32 { s.0 }
+                pub fn iter(slice: &[u32]) -> impl Iterator<Item = u32> + '_ {
+                    slice.iter().copied()
+                }
             "#;
-        test_format_item(test_src, "into_i32", |result| {
+        test_format_item(test_src, "iter", |result| {
+            let err = result.unwrap_err();
+            assert_eq!(
+                err,
+                "Error formatting function return type: \
+                 Iterators that borrow from the parameters or from their items \
+                 can't be returned to C++ yet"
+            );
+        });
+    }
+
+    #[test]
+    fn test_format_item_fn_async() {
+        let test_src = r#"
+                pub async fn add(x: i32, y: i32) -> i32 { x + y }
+            "#;
+        test_format_item(test_src, "add", |result| {
             let result = result.unwrap().unwrap();
             let main_api = &result.main_api;
             assert_cc_matches!(
                 main_api.tokens,
                 quote! {
-                    std::int32_t into_i32(::rust_out::S s);
+                    rs_std::Future<std::int32_t> add(std::int32_t x, std::int32_t y);
                 }
             );
             assert_cc_matches!(
                 result.cc_details.tokens,
                 quote! {
                     namespace __crubit_internal {
-                        extern "C" std::int32_t ...(::rust_out::S*);
+                        extern "C" void* ...(
+                            std::int32_t,
+                            std::int32_t,
+                            rs_std::Future<std::int32_t>::PollFn* __poll,
+                            rs_std::Future<std::int32_t>::DropFn* __drop);
                     }
                     ...
-                    inline std::int32_t into_i32(::rust_out::S s) {
-                        return __crubit_internal::...(&s);
+                    inline rs_std::Future<std::int32_t> add(std::int32_t x, std::int32_t y) {
+                        rs_std::Future<std::int32_t>::PollFn __poll;
+                        rs_std::Future<std::int32_t>::DropFn __drop;
+                        void* __boxed = __crubit_internal::...(x, y, &__poll, &__drop);
+                        return rs_std::Future<std::int32_t>(__boxed, __poll, __drop);
                     }
                 }
             );
@@ -3861,8 +5795,13 @@ pub mod tests {
                 quote! {
                     #[no_mangle]
                     extern "C"
-                    fn ...(s: &mut ::core::mem::MaybeUninit<::rust_out::S>) -> i32 {
-                        ::rust_out::into_i32(unsafe { s.assume_init_read() })
+                    fn ...(
+                        x: i32,
+                        y: i32,
+                        __poll: &mut ::core::mem::MaybeUninit<::rs_std_future::PollFn>,
+                        __drop: &mut ::core::mem::MaybeUninit<::rs_std_future::DropFn>
+                    ) -> *mut ::core::ffi::c_void {
+                        ::rs_std_future::into_raw(::rust_out::add(x, y), __poll, __drop)
                     }
                 }
             );
@@ -3870,46 +5809,37 @@ pub mod tests {
     }
 
     #[test]
-    fn test_format_item_fn_rust_abi_returning_struct_by_value() {
+    fn test_format_item_fn_async_unit_output() {
         let test_src = r#"
-                pub struct S(i32);
-                pub fn create(i: i32) -> S { S(i) }
+                pub async fn do_nothing() {}
             "#;
-        test_format_item(test_src, "create", |result| {
+        test_format_item(test_src, "do_nothing", |result| {
             let result = result.unwrap().unwrap();
-            let main_api = &result.main_api;
-            assert_cc_matches!(
-                main_api.tokens,
-                quote! {
-                    ::rust_out::S create(std::int32_t i);
-                }
-            );
             assert_cc_matches!(
-                result.cc_details.tokens,
+                result.main_api.tokens,
                 quote! {
-                    namespace __crubit_internal {
-                        extern "C" void ...(std::int32_t, ::rust_out::S* __ret_ptr);
-                    }
-                    ...
-                    inline ::rust_out::S create(std::int32_t i) {
-                        crubit::ReturnValueSlot<::rust_out::S> __ret_slot;
-                        __crubit_internal::...(i, __ret_slot.Get());
-                        return std::move(__ret_slot).AssumeInitAndTakeValue();
-                    }
+                    rs_std::Future<void> do_nothing();
                 }
             );
-            assert_rs_matches!(
-                result.rs_details,
-                quote! {
-                    #[no_mangle]
-                    extern "C"
-                    fn ...(
-                        i: i32,
-                        __ret_slot: &mut ::core::mem::MaybeUninit<::rust_out::S>
-                    ) -> () {
-                        __ret_slot.write(::rust_out::create(i));
-                    }
+        });
+    }
+
+    #[test]
+    fn test_format_item_fn_async_not_send() {
+        let test_src = r#"
+                use std::rc::Rc;
+                pub async fn not_send() -> i32 {
+                    let rc = Rc::new(42);
+                    async {}.await;
+                    *rc
                 }
+            "#;
+        test_format_item(test_src, "not_send", |result| {
+            let err = result.unwrap_err();
+            assert_eq!(
+                err,
+                "Error formatting function return type: \
+                 Futures can only be returned to C++ if they are `Send`"
             );
         });
     }
@@ -4188,7 +6118,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(4) SomeStruct final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(4) SomeStruct final {
                         public:
                             __COMMENT__ "`SomeStruct` doesn't implement the `Default` trait"
                             SomeStruct() = delete;
@@ -4198,6 +6128,12 @@ pub mod tests {
                             SomeStruct(SomeStruct&&) = default;
                             SomeStruct& operator=(SomeStruct&&) = default;
 
+                            __COMMENT__ "Used by functions that return this type by value."
+                            template <typename F>
+                            explicit SomeStruct(crubit::InitInPlaceTag, F init) {
+                                init(this);
+                            }
+
                             __COMMENT__ "`SomeStruct` doesn't implement the `Clone` trait"
                             SomeStruct(const SomeStruct&) = delete;
                             SomeStruct& operator=(const SomeStruct&) = delete;
@@ -4251,7 +6187,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(4) TupleStruct final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(4) TupleStruct final {
                         public:
                             __COMMENT__ "`TupleStruct` doesn't implement the `Default` trait"
                             TupleStruct() = delete;
@@ -4261,6 +6197,12 @@ pub mod tests {
                             TupleStruct(TupleStruct&&) = default;
                             TupleStruct& operator=(TupleStruct&&) = default;
 
+                            __COMMENT__ "Used by functions that return this type by value."
+                            template <typename F>
+                            explicit TupleStruct(crubit::InitInPlaceTag, F init) {
+                                init(this);
+                            }
+
                             __COMMENT__ "`TupleStruct` doesn't implement the `Clone` trait"
                             TupleStruct(const TupleStruct&) = delete;
                             TupleStruct& operator=(const TupleStruct&) = delete;
@@ -4319,7 +6261,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(4) SomeStruct final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(4) SomeStruct final {
                         ...
                         // The particular order below is not guaranteed,
                         // so we may need to adjust this test assertion
@@ -4382,7 +6324,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(1) __attribute__((packed)) SomeStruct final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(1) __attribute__((packed)) SomeStruct final {
                         ...
                         public: union { ... std::uint16_t field1; };
                         public: union { ... std::uint32_t field2; };
@@ -4419,6 +6361,46 @@ pub mod tests {
         });
     }
 
+    #[test]
+    fn test_format_item_repr_c_copy_struct_fields_are_plain_data_members() {
+        let test_src = r#"
+                #[derive(Clone, Copy)]
+                #[repr(C)]
+                pub struct SomeStruct {
+                    pub f1: u8,
+                    pub f2: u32,
+                }
+            "#;
+        test_format_item(test_src, "SomeStruct", |result| {
+            let result = result.unwrap().unwrap();
+            let main_api = &result.main_api;
+            assert_cc_matches!(
+                main_api.tokens,
+                quote! {
+                    ...
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(4) SomeStruct final {
+                        ...
+                        public: ... std::uint8_t f1;
+                        public: ... std::uint32_t f2;
+                        private:
+                            static void __crubit_field_offset_assertions();
+                    };
+                }
+            );
+            assert_cc_not_matches!(main_api.tokens, quote! { union });
+            assert_cc_not_matches!(main_api.tokens, quote! { __padding0 });
+            assert_cc_matches!(
+                result.cc_details.tokens,
+                quote! {
+                    inline void SomeStruct::__crubit_field_offset_assertions() {
+                      static_assert(0 == offsetof(SomeStruct, f1));
+                      static_assert(4 == offsetof(SomeStruct, f2));
+                    }
+                }
+            );
+        });
+    }
+
     #[test]
     fn test_format_item_struct_with_explicit_padding_in_generated_code() {
         let test_src = r#"
@@ -4437,7 +6419,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(4) SomeStruct final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(4) SomeStruct final {
                         ...
                         public: union { ... std::uint32_t f2; };
                         public: union { ... std::uint8_t f1; };
@@ -4989,6 +6971,27 @@ pub mod tests {
         });
     }
 
+    #[test]
+    fn test_does_type_implement_trait_is_memoized() {
+        let test_src = r#"
+                #[derive(Default)]
+                pub struct Point(i32, i32);
+            "#;
+        run_compiler_for_testing(test_src, |tcx| {
+            let input = bindings_input_for_tests(tcx);
+            let def_id = find_def_id_by_name(tcx, "Point");
+            format_item(&input, def_id).unwrap().unwrap();
+
+            let self_ty = tcx.type_of(def_id).subst_identity();
+            let default_trait_id = get_def_id_of_default_trait(tcx).unwrap();
+            assert_eq!(input.trait_impls.borrow().get(&(self_ty, default_trait_id)), Some(&true));
+
+            // A memoized result is returned without running trait selection again.
+            input.trait_impls.borrow_mut().insert((self_ty, default_trait_id), false);
+            assert!(!does_implement_default_trait(&input, self_ty));
+        });
+    }
+
     #[test]
     fn test_format_item_struct_with_copy_trait() {
         let test_src = r#"
@@ -5328,15 +7331,16 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct ... TypeUnderTest final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI
+                        alignas(...) TypeUnderTest final {
                         ...
                         public:
                           ...
                           __COMMENT__ "Drop::drop"
                           ~TypeUnderTest();
-                          TypeUnderTest(TypeUnderTest&&);
+                          TypeUnderTest(TypeUnderTest&&) noexcept;
                           TypeUnderTest& operator=(
-                              TypeUnderTest&&);
+                              TypeUnderTest&&) noexcept;
                         ...
                     };
                 }
@@ -5353,12 +7357,12 @@ pub mod tests {
                       __crubit_internal::...(*this);
                     }
                     inline TypeUnderTest::TypeUnderTest(
-                        TypeUnderTest&& other)
+                        TypeUnderTest&& other) noexcept
                         : TypeUnderTest() {
                       *this = std::move(other);
                     }
                     inline TypeUnderTest& TypeUnderTest::operator=(
-                        TypeUnderTest&& other) {
+                        TypeUnderTest&& other) noexcept {
                       crubit::MemSwap(*this, other);
                       return *this;
                     }
@@ -5419,6 +7423,41 @@ pub mod tests {
         test_format_item_struct_with_custom_drop_and_with_default_impl(test_src);
     }
 
+    /// Clang would ignore `trivial_abi` on `TypeUnderTest`, because the
+    /// anonymous union around `field` has a non-trivial destructor.
+    #[test]
+    fn test_format_item_struct_with_public_field_with_drop_glue_is_not_trivial_abi() {
+        let test_src = r#"
+                #[derive(Default)]
+                pub struct StructWithCustomDropImpl {
+                    pub x: i32,
+                }
+
+                impl Drop for StructWithCustomDropImpl {
+                    fn drop(&mut self) {}
+                }
+
+                #[derive(Default)]
+                pub struct TypeUnderTest {
+                    pub field: StructWithCustomDropImpl,
+                }
+            "#;
+        test_format_item(test_src, "TypeUnderTest", |result| {
+            let main_api = result.unwrap().unwrap().main_api;
+            assert_cc_matches!(
+                main_api.tokens,
+                quote! {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(4) TypeUnderTest final { ... }
+                }
+            );
+            assert_cc_not_matches!(main_api.tokens, quote! { CRUBIT_INTERNAL_TRIVIAL_ABI });
+        });
+        test_format_item(test_src, "StructWithCustomDropImpl", |result| {
+            let main_api = result.unwrap().unwrap().main_api;
+            assert_cc_matches!(main_api.tokens, quote! { CRUBIT_INTERNAL_TRIVIAL_ABI });
+        });
+    }
+
     #[test]
     fn test_format_item_unsupported_struct_with_custom_drop_and_default_and_nonunpin() {
         let test_src = r#"
@@ -5628,7 +7667,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(1) SomeEnum final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(1) SomeEnum final {
                         public:
                             __COMMENT__ "`SomeEnum` doesn't implement the `Default` trait"
                             SomeEnum() = delete;
@@ -5638,6 +7677,12 @@ pub mod tests {
                             SomeEnum(SomeEnum&&) = default;
                             SomeEnum& operator=(SomeEnum&&) = default;
 
+                            __COMMENT__ "Used by functions that return this type by value."
+                            template <typename F>
+                            explicit SomeEnum(crubit::InitInPlaceTag, F init) {
+                                init(this);
+                            }
+
                             __COMMENT__ "`SomeEnum` doesn't implement the `Clone` trait"
                             SomeEnum(const SomeEnum&) = delete;
                             SomeEnum& operator=(const SomeEnum&) = delete;
@@ -5689,7 +7734,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(4) Point final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(4) Point final {
                         public:
                             __COMMENT__ "`Point` doesn't implement the `Default` trait"
                             Point() = delete;
@@ -5699,6 +7744,12 @@ pub mod tests {
                             Point(Point&&) = default;
                             Point& operator=(Point&&) = default;
 
+                            __COMMENT__ "Used by functions that return this type by value."
+                            template <typename F>
+                            explicit Point(crubit::InitInPlaceTag, F init) {
+                                init(this);
+                            }
+
                             __COMMENT__ "`Point` doesn't implement the `Clone` trait"
                             Point(const Point&) = delete;
                             Point& operator=(const Point&) = delete;
@@ -5763,7 +7814,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    union CRUBIT_INTERNAL_RUST_TYPE(...) alignas(8) SomeUnion final {
+                    union CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(8) SomeUnion final {
                         public:
                             __COMMENT__ "`SomeUnion` doesn't implement the `Default` trait"
                             SomeUnion() = delete;
@@ -5773,6 +7824,12 @@ pub mod tests {
                             SomeUnion(SomeUnion&&) = default;
                             SomeUnion& operator=(SomeUnion&&) = default;
 
+                            __COMMENT__ "Used by functions that return this type by value."
+                            template <typename F>
+                            explicit SomeUnion(crubit::InitInPlaceTag, F init) {
+                                init(this);
+                            }
+
                             __COMMENT__ "`SomeUnion` doesn't implement the `Clone` trait"
                             SomeUnion(const SomeUnion&) = delete;
                             SomeUnion& operator=(const SomeUnion&) = delete;
@@ -6014,7 +8071,7 @@ pub mod tests {
                 main_api.tokens,
                 quote! {
                     ...
-                    struct CRUBIT_INTERNAL_RUST_TYPE(...) alignas(4) SomeStruct final {
+                    struct CRUBIT_INTERNAL_RUST_TYPE(...) CRUBIT_INTERNAL_TRIVIAL_ABI alignas(4) SomeStruct final {
                         ...
                         __COMMENT__ #unsupported_msg
                         ...
@@ -6108,6 +8165,38 @@ pub mod tests {
                     "",
                 ),
             ),
+            (
+                "&'static [i32]",
+                (
+                    "rs_std::SliceRef<std::int32_t const>",
+                    "\"crubit/support/for/tests/rs_std/slice_ref.h\"",
+                    "",
+                    "",
+                ),
+            ),
+            (
+                "&'static mut [f64]",
+                (
+                    "rs_std::SliceRef<double>",
+                    "\"crubit/support/for/tests/rs_std/slice_ref.h\"",
+                    "",
+                    "",
+                ),
+            ),
+            (
+                "&'static str",
+                ("rs_std::StrRef", "\"crubit/support/for/tests/rs_std/str_ref.h\"", "", ""),
+            ),
+            // Like for pointers, the element type of a slice is a `fwd_decls` prerequisite:
+            (
+                "&'static [SomeStruct]",
+                (
+                    "rs_std::SliceRef<::rust_out::SomeStruct const>",
+                    "\"crubit/support/for/tests/rs_std/slice_ref.h\"",
+                    "",
+                    "SomeStruct",
+                ),
+            ),
             // `SomeStruct` is a `fwd_decls` prerequisite (not `defs` prerequisite):
             ("*mut SomeStruct", ("::rust_out::SomeStruct*", "", "", "SomeStruct")),
             // Testing propagation of deeper/nested `fwd_decls`:
@@ -6267,14 +8356,15 @@ pub mod tests {
                 "The following Rust type is not supported yet: [i32; 42]",
             ),
             (
-                "&'static [i32]", // TyKind::Slice (nested underneath TyKind::Ref)
-                "Failed to format the referent of the reference type `&'static [i32]`: \
-                 The following Rust type is not supported yet: [i32]",
+                "&'static mut str", // TyKind::Str (nested underneath TyKind::Ref)
+                "Failed to format the referent of the reference type `&'static mut str`: \
+                 `&mut str` is not supported yet",
             ),
             (
-                "&'static str", // TyKind::Str (nested underneath TyKind::Ref)
-                "Failed to format the referent of the reference type `&'static str`: \
-                 The following Rust type is not supported yet: str",
+                "&'static [&'static i32]", // TyKind::Ref (nested reference - slice element)
+                "Failed to format the referent of the reference type `&'static [&'static i32]`: \
+                 Can't format `&'static i32`, because references are only supported \
+                 in function parameter types and return types (b/286256327)",
             ),
             (
                 "impl Eq", // TyKind::Alias
@@ -6343,7 +8433,8 @@ pub mod tests {
         let preamble = quote! {
             #![feature(never_type)]
 
-            #[repr(C)]
+            // Not `#[repr(C)]`, so that function pointers taking or returning `SomeStruct`
+            // require a thunk.
             pub struct SomeStruct {
                 pub x: i32,
                 pub y: i32,
@@ -6413,6 +8504,10 @@ pub mod tests {
             ("&mut i32", "& '__anon1 mut i32"),
             ("&'_ i32", "& '__anon1 i32"),
             ("&'static i32", "& 'static i32"),
+            // Slice and string references:
+            ("&[i32]", "& '__anon1 [i32]"),
+            ("&mut [i32]", "& '__anon1 mut [i32]"),
+            ("&str", "& '__anon1 str"),
             // Pointer to an ADT:
             ("*mut SomeStruct", "* mut :: rust_out :: SomeStruct"),
             ("extern \"C\" fn(i32) -> i32", "extern \"C\" fn(i32) -> i32"),
@@ -6454,16 +8549,6 @@ pub mod tests {
                 "[i32; 42]", // TyKind::Array
                 "The following Rust type is not supported yet: [i32; 42]",
             ),
-            (
-                "&'static [i32]", // TyKind::Slice (nested underneath TyKind::Ref)
-                "Failed to format the referent of the reference type `&'static [i32]`: \
-                 The following Rust type is not supported yet: [i32]",
-            ),
-            (
-                "&'static str", // TyKind::Str (nested underneath TyKind::Ref)
-                "Failed to format the referent of the reference type `&'static str`: \
-                 The following Rust type is not supported yet: str",
-            ),
             (
                 "impl Eq", // TyKind::Alias
                 "The following Rust type is not supported yet: impl Eq",
@@ -6575,6 +8660,10 @@ pub mod tests {
             tcx,
             crubit_support_path: "crubit/support/for/tests".into(),
             crate_name_to_include_path: Default::default(),
+            trace: ChromeTrace::default(),
+            trait_impls: Default::default(),
+            generic_fn_instantiations: vec![],
+            h_shards_include_dir: None,
             _features: (),
         }
     }
@@ -6592,4 +8681,37 @@ pub mod tests {
             test_function(generate_bindings(&bindings_input_for_tests(tcx)))
         })
     }
+
+    /// Same as `test_generated_bindings`, but with bindings for the `core`
+    /// crate in `core_cc_api.h`.
+    fn test_generated_bindings_with_core_bindings<F, T>(source: &str, test_function: F) -> T
+    where
+        F: FnOnce(Result<Output>) -> T + Send,
+        T: Send,
+    {
+        run_compiler_for_testing(source, |tcx| {
+            let core_include = CcInclude::user_header("core_cc_api.h".into());
+            let input = Input {
+                crate_name_to_include_path: [("core".into(), core_include)].into_iter().collect(),
+                ..bindings_input_for_tests(tcx)
+            };
+            test_function(generate_bindings(&input))
+        })
+    }
+
+    /// Same as `test_generated_bindings`, but shards the C++ bindings (see
+    /// `Input::h_shards_include_dir`).
+    fn test_generated_sharded_bindings<F, T>(source: &str, test_function: F) -> T
+    where
+        F: FnOnce(Result<Output>) -> T + Send,
+        T: Send,
+    {
+        run_compiler_for_testing(source, |tcx| {
+            let input = Input {
+                h_shards_include_dir: Some("shards/dir".into()),
+                ..bindings_input_for_tests(tcx)
+            };
+            test_function(generate_bindings(&input))
+        })
+    }
 }
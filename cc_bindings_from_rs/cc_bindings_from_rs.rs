@@ -6,7 +6,9 @@
 #![feature(rustc_private)]
 #![deny(rustc::internal)]
 
+extern crate rustc_ast;
 extern crate rustc_attr;
+extern crate rustc_data_structures;
 extern crate rustc_driver;
 extern crate rustc_error_codes;
 extern crate rustc_errors;
@@ -26,17 +28,20 @@ extern crate rustc_type_ir;
 // separate crates.
 mod bindings;
 mod cmdline;
+mod persistent_worker;
 mod run_compiler;
 
 use anyhow::Context;
 use itertools::Itertools;
 use rustc_middle::ty::TyCtxt; // See also <internal link>/ty.html#import-conventions
-use std::path::Path;
+use std::iter::once;
+use std::path::{Path, PathBuf};
 
 use bindings::Input;
+use chrome_trace::ChromeTrace;
 use cmdline::Cmdline;
 use code_gen_utils::CcInclude;
-use run_compiler::run_compiler;
+use run_compiler::{run_compiler, run_compiler_without_analysis};
 use token_stream_printer::{
     cc_tokens_to_formatted_string, rs_tokens_to_formatted_string, RustfmtConfig,
 };
@@ -46,6 +51,77 @@ fn write_file(path: &Path, content: &str) -> anyhow::Result<()> {
         .with_context(|| format!("Error when writing to {}", path.display()))
 }
 
+/// Same as `write_file`, but leaves the file untouched if it already has the
+/// right `content`, so that build systems relying on modification times don't
+/// rebuild its dependents.
+fn write_file_if_changed(path: &Path, content: &str) -> anyhow::Result<()> {
+    match std::fs::read(path) {
+        Ok(old_content) if old_content == content.as_bytes() => Ok(()),
+        _ => write_file(path, content),
+    }
+}
+
+/// Returns the key under which the formatted outputs of `run_with_tcx` are
+/// cached: a hash of the unformatted bindings, of the cmdline arguments that
+/// affect their formatting, and of the identity (size and modification time)
+/// of the running executable.
+///
+/// The unformatted bindings only depend on the parts of the public API of the
+/// crate that they consume, so changes to function bodies and to private items
+/// don't change the key.
+fn output_cache_key(
+    cmdline: &Cmdline,
+    h_outputs: &[(PathBuf, proc_macro2::TokenStream)],
+    rs_body: &proc_macro2::TokenStream,
+) -> anyhow::Result<String> {
+    use rustc_data_structures::fingerprint::Fingerprint;
+    use rustc_data_structures::stable_hasher::StableHasher;
+    use std::hash::Hash;
+
+    let mut hasher = StableHasher::new();
+    for (_, h_body) in h_outputs {
+        h_body.to_string().hash(&mut hasher);
+    }
+    rs_body.to_string().hash(&mut hasher);
+    cmdline.clang_format_exe_path.hash(&mut hasher);
+    cmdline.rustfmt_exe_path.hash(&mut hasher);
+    if let Some(rustfmt_config_path) = &cmdline.rustfmt_config_path {
+        std::fs::read(rustfmt_config_path)
+            .with_context(|| format!("Error when reading {}", rustfmt_config_path.display()))?
+            .hash(&mut hasher);
+    }
+    let exe_metadata = std::env::current_exe().and_then(std::fs::metadata)?;
+    exe_metadata.len().hash(&mut hasher);
+    exe_metadata.modified()?.hash(&mut hasher);
+    Ok(hasher.finish::<Fingerprint>().to_hex())
+}
+
+/// Returns the paths of the cached `.h` outputs (in the same order as
+/// `h_outputs`: the `--h-out` file, followed by the shards in
+/// `--h-shards-out`) and of the cached `.rs` output stored under `key`.
+fn output_cache_paths(
+    cache_dir: &Path,
+    key: &str,
+    h_outputs: &[(PathBuf, proc_macro2::TokenStream)],
+) -> (Vec<PathBuf>, PathBuf) {
+    let h_shard_paths = h_outputs.iter().skip(1).map(|(path, _)| {
+        let file_name = path.file_name().unwrap_or_default().to_string_lossy();
+        cache_dir.join(format!("{key}_cc_api_shard_{file_name}"))
+    });
+    let h_paths = once(cache_dir.join(format!("{key}_cc_api.h"))).chain(h_shard_paths).collect();
+    (h_paths, cache_dir.join(format!("{key}_cc_api_impl.rs")))
+}
+
+/// Stores `content` at `path`, via a temporary file that is renamed into
+/// place, so that concurrent invocations never read a partially written
+/// cache entry.
+fn write_cache_entry(path: &Path, content: &str) -> anyhow::Result<()> {
+    let tmp_path = path.with_extension(format!("tmp{}", std::process::id()));
+    write_file(&tmp_path, content)?;
+    std::fs::rename(&tmp_path, path)
+        .with_context(|| format!("Error when writing to {}", path.display()))
+}
+
 fn new_input<'tcx>(cmdline: &Cmdline, tcx: TyCtxt<'tcx>) -> Input<'tcx> {
     let crubit_support_path = cmdline.crubit_support_path.as_str().into();
 
@@ -57,26 +133,90 @@ fn new_input<'tcx>(cmdline: &Cmdline, tcx: TyCtxt<'tcx>) -> Input<'tcx> {
         })
         .collect();
 
-    Input { tcx, crubit_support_path, crate_name_to_include_path, _features: () }
+    let trace =
+        if cmdline.trace_out.is_some() { ChromeTrace::new() } else { ChromeTrace::default() };
+
+    let h_shards_include_dir = cmdline.h_shards_include_dir.as_deref().map(Into::into);
+
+    Input {
+        tcx,
+        crubit_support_path,
+        crate_name_to_include_path,
+        trace,
+        trait_impls: Default::default(),
+        generic_fn_instantiations: cmdline.generic_fn_instantiations.clone(),
+        h_shards_include_dir,
+        _features: (),
+    }
 }
 
 fn run_with_tcx(cmdline: &Cmdline, tcx: TyCtxt) -> anyhow::Result<()> {
     use bindings::{generate_bindings, Output};
-    let Output { h_body, rs_body } = {
-        let input = new_input(cmdline, tcx);
-        generate_bindings(&input)?
+    let input = new_input(cmdline, tcx);
+    let Output { h_body, h_shards, rs_body } = generate_bindings(&input)?;
+
+    // The paths and contents of all the C++ headers: the `--h-out` file,
+    // followed by the shards (if any).
+    let mut h_outputs = vec![(cmdline.h_out.clone(), h_body)];
+    if let Some(h_shards_out) = &cmdline.h_shards_out {
+        std::fs::create_dir_all(h_shards_out)
+            .with_context(|| format!("Error when creating {}", h_shards_out.display()))?;
+        h_outputs.extend(
+            h_shards
+                .into_iter()
+                .map(|(file_name, h_shard)| (h_shards_out.join(&*file_name), h_shard)),
+        );
+    }
+
+    // Reuses the outputs of an earlier invocation whose bindings had the same
+    // tokens, which saves running the formatters.
+    let cache_paths = match &cmdline.cache_dir {
+        None => None,
+        Some(cache_dir) => {
+            let key = output_cache_key(cmdline, &h_outputs, &rs_body)?;
+            Some(output_cache_paths(cache_dir, &key, &h_outputs))
+        }
     };
+    if let Some((cached_h_paths, cached_rs_path)) = &cache_paths {
+        let cached_h_bodies: Result<Vec<String>, _> =
+            cached_h_paths.iter().map(std::fs::read_to_string).collect();
+        if let (Ok(h_bodies), Ok(rs_body)) =
+            (cached_h_bodies, std::fs::read_to_string(cached_rs_path))
+        {
+            for ((h_path, _), h_body) in h_outputs.iter().zip(h_bodies) {
+                write_file_if_changed(h_path, &h_body)?;
+            }
+            write_file_if_changed(&cmdline.rs_out, &rs_body)?;
+            if let Some(trace_out) = &cmdline.trace_out {
+                write_file(trace_out, &input.trace.to_json().to_string())?;
+            }
+            return Ok(());
+        }
+    }
 
-    {
+    let mut h_bodies = vec![];
+    for (h_path, h_body) in h_outputs {
         let h_body = cc_tokens_to_formatted_string(h_body, &cmdline.clang_format_exe_path)?;
-        write_file(&cmdline.h_out, &h_body)?;
+        write_file_if_changed(&h_path, &h_body)?;
+        h_bodies.push(h_body);
     }
 
-    {
-        let rustfmt_config =
-            RustfmtConfig::new(&cmdline.rustfmt_exe_path, cmdline.rustfmt_config_path.as_deref());
-        let rs_body = rs_tokens_to_formatted_string(rs_body, &rustfmt_config)?;
-        write_file(&cmdline.rs_out, &rs_body)?;
+    let rustfmt_config =
+        RustfmtConfig::new(&cmdline.rustfmt_exe_path, cmdline.rustfmt_config_path.as_deref());
+    let rs_body = rs_tokens_to_formatted_string(rs_body, &rustfmt_config)?;
+    write_file_if_changed(&cmdline.rs_out, &rs_body)?;
+
+    if let Some((cached_h_paths, cached_rs_path)) = &cache_paths {
+        // The `.rs` entry is written last, so that readers that find it also
+        // find the `.h` entries.
+        for (cached_h_path, h_body) in cached_h_paths.iter().zip(&h_bodies) {
+            write_cache_entry(cached_h_path, h_body)?;
+        }
+        write_cache_entry(cached_rs_path, &rs_body)?;
+    }
+
+    if let Some(trace_out) = &cmdline.trace_out {
+        write_file(trace_out, &input.trace.to_json().to_string())?;
     }
 
     Ok(())
@@ -87,7 +227,11 @@ fn run_with_tcx(cmdline: &Cmdline, tcx: TyCtxt) -> anyhow::Result<()> {
 /// `init_env_logger`) and therefore can be used from the tests module below.
 fn run_with_cmdline_args(args: &[String]) -> anyhow::Result<()> {
     let cmdline = Cmdline::new(args)?;
-    run_compiler(&cmdline.rustc_args, |tcx| run_with_tcx(&cmdline, tcx))
+    if cmdline.skip_analysis {
+        run_compiler_without_analysis(&cmdline.rustc_args, |tcx| run_with_tcx(&cmdline, tcx))
+    } else {
+        run_compiler(&cmdline.rustc_args, |tcx| run_with_tcx(&cmdline, tcx))
+    }
 }
 
 fn main() -> anyhow::Result<()> {
@@ -131,6 +275,25 @@ fn main() -> anyhow::Result<()> {
         }
     }
 
+    // In the persistent worker mode the process (and the loaded `rustc_driver`)
+    // is reused across work requests, but each request still runs its own Rust
+    // compiler session.  Bazel starts the worker with `--persistent_worker`
+    // appended to the startup arguments;  the actual cmdline of each request
+    // comes through stdin.
+    if args.iter().any(|arg| arg == "--persistent_worker") {
+        let argv0 = args[0].clone();
+        return persistent_worker::run_persistent_worker(
+            std::io::stdin().lock(),
+            std::io::stdout(),
+            |request_args| {
+                let args = std::iter::once(argv0.clone())
+                    .chain(request_args.iter().cloned())
+                    .collect_vec();
+                run_with_cmdline_args(&args)
+            },
+        );
+    }
+
     run_with_cmdline_args(&args).map_err(|anyhow_err| match anyhow_err.downcast::<clap::Error>() {
         // Explicitly call `clap::Error::exit`, because 1) it results in *colored* output and
         // 2) it uses a zero exit code for specific "errors" (e.g. for `--help` output).
@@ -374,6 +537,59 @@ extern "C" fn __crubit_thunk__ANY_IDENTIFIER_CHARACTERS()
         Ok(())
     }
 
+    /// `test_cache_dir` tests that `--cache-dir` reuses the outputs of an
+    /// earlier invocation with the same bindings.
+    #[test]
+    fn test_cache_dir() -> anyhow::Result<()> {
+        let cache_dir = tempdir()?;
+        let cache_dir_arg = format!("--cache-dir={}", cache_dir.path().display());
+        let test_args = TestArgs::default_args()?.with_extra_crubit_args(&[&cache_dir_arg]);
+
+        let test_result = test_args.run()?;
+        let h_body = std::fs::read_to_string(&test_result.h_path)?;
+        let rs_body = std::fs::read_to_string(&test_result.rs_path)?;
+        let cache_entries = std::fs::read_dir(cache_dir.path())?
+            .map(|entry| entry.map(|entry| entry.path()))
+            .collect::<std::io::Result<Vec<_>>>()?;
+        assert_eq!(2, cache_entries.len(), "cache entries: {cache_entries:?}");
+
+        // An invocation with the same bindings reads them from the cache (which
+        // is demonstrated by tampering with the cache entries).
+        for path in &cache_entries {
+            let content = std::fs::read_to_string(path)?;
+            std::fs::write(path, format!("{content}// From the cache.\n"))?;
+        }
+        let test_result = test_args.run()?;
+        assert_eq!(
+            format!("{h_body}// From the cache.\n"),
+            std::fs::read_to_string(&test_result.h_path)?
+        );
+        assert_eq!(
+            format!("{rs_body}// From the cache.\n"),
+            std::fs::read_to_string(&test_result.rs_path)?
+        );
+        Ok(())
+    }
+
+    /// `test_h_shards` tests that `--h-shards-out` writes the shards next to an
+    /// umbrella `--h-out` header.
+    #[test]
+    fn test_h_shards() -> anyhow::Result<()> {
+        let shards_dir = tempdir()?;
+        let h_shards_out_arg = format!("--h-shards-out={}", shards_dir.path().display());
+        let test_args = TestArgs::default_args()?
+            .with_extra_crubit_args(&[&h_shards_out_arg, "--h-shards-include-dir=shards"]);
+
+        let test_result = test_args.run()?;
+        let h_body = std::fs::read_to_string(&test_result.h_path)?;
+        assert!(h_body.contains(r#"#include "shards/crate.public_module.h""#), "{h_body}");
+        assert!(!h_body.contains("public_function"), "{h_body}");
+
+        let h_shard = std::fs::read_to_string(shards_dir.path().join("crate.public_module.h"))?;
+        assert!(h_shard.contains("void public_function();"), "{h_shard}");
+        Ok(())
+    }
+
     /// `test_cmdline_error_propagation` tests that errors from `Cmdline::new`
     /// get propagated. More detailed test coverage of various specific
     /// error types can be found in tests in `cmdline.rs`.
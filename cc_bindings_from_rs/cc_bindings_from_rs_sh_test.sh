@@ -185,4 +185,57 @@ function test::rustc_warnings_are_silenced() {
   EXPECT_STR_EMPTY "$(cat $STDERR_PATH)"
 }
 
+# Remote caching needs the outputs to be the same byte-for-byte on every run.
+# Each run is a separate process, which gets a different address space layout
+# and different seeds for the Rust hash maps.
+function test::output_is_deterministic() {
+  local RS_INPUT_PATH="${TEST_TMPDIR}/crate_name.rs"
+  echo >"$RS_INPUT_PATH" "
+      macro_rules! define_struct {
+          (\$name:ident) => {
+              #[derive(Clone, Copy, Default)]
+              pub struct \$name { pub field: i32 }
+              impl \$name {
+                  pub fn get(&self) -> i32 { self.field }
+              }
+          };
+      }
+      define_struct!(A);
+      define_struct!(B);
+      define_struct!(C);
+
+      pub fn sum(a: A, b: B, c: C) -> i32 {
+          a.field + b.field + c.field
+      }
+  "
+
+  local run
+  for run in 1 2; do
+    delete_all_test_outputs
+    EXPECT_SUCCEED \
+      "\"$CC_BINDINGS_FROM_RS_PATH\" >\"$STDOUT_PATH\" 2>\"$STDERR_PATH\" \
+          \"--h-out=${H_OUT_PATH}\" \
+          \"--rs-out=${RS_OUT_PATH}\" \
+          \"--crubit-support-path=crubit/support/for/tests\" \
+          \"--clang-format-exe-path=${DEFAULT_CLANG_FORMAT_EXE_PATH}\" \
+          \"--rustfmt-exe-path=$RUSTFMT_PATH\" \
+          -- \
+          \"$RS_INPUT_PATH\" \
+          --crate-type=lib \
+          --sysroot=$SYSROOT_PATH \
+          --codegen=panic=abort" \
+      "Expecting that this invocation of cc_bindings_from_rs will succeed"
+    cp "$H_OUT_PATH" "${TEST_TMPDIR}/${run}_cc_api.h"
+    cp "$RS_OUT_PATH" "${TEST_TMPDIR}/${run}_cc_api_impl.rs"
+  done
+
+  local out
+  for out in cc_api.h cc_api_impl.rs; do
+    EXPECT_FILE_NOT_EMPTY "${TEST_TMPDIR}/1_${out}"
+    EXPECT_SUCCEED \
+      "cmp \"${TEST_TMPDIR}/1_${out}\" \"${TEST_TMPDIR}/2_${out}\"" \
+      "${out} should be the same on every run"
+  done
+}
+
 gbash::unit::main "$@"
@@ -53,6 +53,48 @@ pub struct Cmdline {
     #[clap(long, value_parser, value_name = "FILE")]
     pub rustfmt_config_path: Option<PathBuf>,
 
+    /// Output path for a Chrome trace (viewable in chrome://tracing or
+    /// https://ui.perfetto.dev) with a span for the generation of the bindings
+    /// of each item.
+    #[clap(long, value_parser, value_name = "FILE")]
+    pub trace_out: Option<PathBuf>,
+
+    /// Generate the bindings right after macro expansion and name resolution,
+    /// instead of after the Rust compiler's full analysis of the crate (which
+    /// type-checks and borrow-checks every function body). Errors in function
+    /// bodies are then only reported by the actual compilation of the crate.
+    #[clap(long)]
+    pub skip_analysis: bool,
+
+    /// Directory in which to cache the formatted outputs of the tool, keyed by a
+    /// hash of the unformatted bindings. Invocations whose bindings are
+    /// unchanged (e.g. after changes to function bodies or private items of the
+    /// crate) then write the same outputs without running the formatters.
+    #[clap(long, value_parser, value_name = "DIR")]
+    pub cache_dir: Option<PathBuf>,
+
+    /// Output directory for C++ headers with the bindings of each Rust module
+    /// ("shards"), so that C++ files only parse the bindings of the modules
+    /// that they use. When set, the `--h-out` file just includes all the
+    /// shards.
+    #[clap(long, value_parser, value_name = "DIR", requires = "h_shards_include_dir")]
+    pub h_shards_out: Option<PathBuf>,
+
+    /// Path to the `--h-shards-out` directory in a format that should be used
+    /// in the `#include` directives inside the generated C++ files.
+    #[clap(long, value_parser, value_name = "STRING", requires = "h_shards_out")]
+    // This is a `String` rather than `PathBuf` for the same reasons as for
+    // `crubit_support_path`.
+    pub h_shards_include_dir: Option<String>,
+
+    /// Monomorphizations of generic functions of the crate to generate C++
+    /// bindings for, as the path of the function with its type arguments and
+    /// the name of the C++ function.
+    /// Example: "--instantiate-generic-fn=some_mod::max::<i32>=max_i32".
+    #[clap(long = "instantiate-generic-fn", value_parser = parse_generic_fn_instantiation,
+           value_name = "RUST_PATH::<TYPES>=CC_NAME")]
+    pub generic_fn_instantiations: Vec<(String, String)>,
+
     /// Command line arguments of the Rust compiler.
     #[clap(last = true, value_parser)]
     pub rustc_args: Vec<String>,
@@ -107,6 +149,25 @@ fn parse_bindings_from_dependency(s: &str) -> Result<(String, String)> {
     Ok((crate_name.to_string(), include.to_string()))
 }
 
+/// Parse cmdline arguments of the following form:
+/// `"some_mod::generic_fn::<Type1, Type2>=cc_name"`.
+fn parse_generic_fn_instantiation(s: &str) -> Result<(String, String)> {
+    let pos = s
+        .rfind('=')
+        .ok_or_else(|| anyhow!("Expected KEY=VALUE syntax but no `=` found in `{s}`"))?;
+
+    let rust_path = &s[..pos];
+    ensure!(
+        rust_path.contains("::<") && rust_path.ends_with('>'),
+        "Expected a function path with type arguments (e.g. `max::<i32>`) but got `{rust_path}`"
+    );
+
+    let cc_name = &s[(pos + 1)..];
+    ensure!(!cc_name.is_empty(), "Empty C++ function names are invalid");
+
+    Ok((rust_path.to_string(), cc_name.to_string()))
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -143,6 +204,12 @@ mod tests {
         assert_eq!(Path::new("rustfmt.exe"), cmdline.rustfmt_exe_path);
         assert!(cmdline.bindings_from_dependencies.is_empty());
         assert!(cmdline.rustfmt_config_path.is_none());
+        assert!(cmdline.trace_out.is_none());
+        assert!(!cmdline.skip_analysis);
+        assert!(cmdline.cache_dir.is_none());
+        assert!(cmdline.h_shards_out.is_none());
+        assert!(cmdline.h_shards_include_dir.is_none());
+        assert!(cmdline.generic_fn_instantiations.is_empty());
         // Ignoring `rustc_args` in this test - they are covered in a separate
         // test below: `test_rustc_args_happy_path`.
     }
@@ -217,6 +284,18 @@ Options:
           Path to a rustfmt executable that will be used to format the Rust source files generated by the tool
       --rustfmt-config-path <FILE>
           Path to a rustfmt.toml file that should replace the default formatting of the .rs files generated by the tool
+      --trace-out <FILE>
+          Output path for a Chrome trace (viewable in chrome://tracing or https://ui.perfetto.dev) with a span for the generation of the bindings of each item
+      --skip-analysis
+          Generate the bindings right after macro expansion and name resolution, instead of after the Rust compiler's full analysis of the crate (which type-checks and borrow-checks every function body). Errors in function bodies are then only reported by the actual compilation of the crate
+      --cache-dir <DIR>
+          Directory in which to cache the formatted outputs of the tool, keyed by a hash of the unformatted bindings. Invocations whose bindings are unchanged (e.g. after changes to function bodies or private items of the crate) then write the same outputs without running the formatters
+      --h-shards-out <DIR>
+          Output directory for C++ headers with the bindings of each Rust module ("shards"), so that C++ files only parse the bindings of the modules that they use. When set, the `--h-out` file just includes all the shards
+      --h-shards-include-dir <STRING>
+          Path to the `--h-shards-out` directory in a format that should be used in the `#include` directives inside the generated C++ files
+      --instantiate-generic-fn <RUST_PATH::<TYPES>=CC_NAME>
+          Monomorphizations of generic functions of the crate to generate C++ bindings for, as the path of the function with its type arguments and the name of the C++ function. Example: "--instantiate-generic-fn=some_mod::max::<i32>=max_i32"
   -h, --help
           Print help
 "#;
@@ -283,6 +362,29 @@ Options:
         assert_eq!("path2", cmdline.bindings_from_dependencies[1].1);
     }
 
+    #[test]
+    fn test_h_shards() {
+        let args = [
+            "--h-out=foo.h",
+            "--rs-out=foo_impl.rs",
+            "--crubit-support-path=crubit/support/for/tests",
+            "--clang-format-exe-path=clang-format.exe",
+            "--rustfmt-exe-path=rustfmt.exe",
+        ];
+        let cmdline = new_cmdline(
+            args.into_iter().chain(["--h-shards-out=out/foo", "--h-shards-include-dir=foo"]),
+        )
+        .unwrap();
+        assert_eq!(Some(Path::new("out/foo")), cmdline.h_shards_out.as_deref());
+        assert_eq!(Some("foo"), cmdline.h_shards_include_dir.as_deref());
+
+        // The two flags have to be used together.
+        let err = new_cmdline(args.into_iter().chain(["--h-shards-out=out/foo"])).unwrap_err();
+        assert!(err.to_string().contains("--h-shards-include-dir"), "err = {err}");
+        let err = new_cmdline(args.into_iter().chain(["--h-shards-include-dir=foo"])).unwrap_err();
+        assert!(err.to_string().contains("--h-shards-out"), "err = {err}");
+    }
+
     #[test]
     fn test_parse_bindings_from_dependency() {
         assert_eq!(
@@ -306,4 +408,28 @@ Options:
             "Empty include paths are invalid",
         );
     }
+
+    #[test]
+    fn test_parse_generic_fn_instantiation() {
+        assert_eq!(
+            parse_generic_fn_instantiation("m::max::<i32>=max_i32").unwrap(),
+            ("m::max::<i32>".into(), "max_i32".into()),
+        );
+        assert_eq!(
+            parse_generic_fn_instantiation("f::<u8, m::S>=f_u8_s").unwrap(),
+            ("f::<u8, m::S>".into(), "f_u8_s".into()),
+        );
+        assert_eq!(
+            parse_generic_fn_instantiation("no-equal-char").unwrap_err().to_string(),
+            "Expected KEY=VALUE syntax but no `=` found in `no-equal-char`",
+        );
+        assert_eq!(
+            parse_generic_fn_instantiation("max=max_i32").unwrap_err().to_string(),
+            "Expected a function path with type arguments (e.g. `max::<i32>`) but got `max`",
+        );
+        assert_eq!(
+            parse_generic_fn_instantiation("max::<i32>=").unwrap_err().to_string(),
+            "Empty C++ function names are invalid",
+        );
+    }
 }
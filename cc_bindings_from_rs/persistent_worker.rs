@@ -0,0 +1,109 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! The `persistent_worker` module implements the JSON flavour of the Bazel
+//! persistent worker protocol (see
+//! https://bazel.build/remote/persistent#work-requests).
+
+use anyhow::{Context, Result};
+use serde::{Deserialize, Serialize};
+use std::io::{BufRead, Write};
+
+#[derive(Debug, Default, Deserialize)]
+#[serde(default, rename_all = "camelCase")]
+struct WorkRequest {
+    arguments: Vec<String>,
+    request_id: i64,
+}
+
+#[derive(Debug, Serialize)]
+#[serde(rename_all = "camelCase")]
+struct WorkResponse {
+    exit_code: i32,
+    output: String,
+    request_id: i64,
+}
+
+/// Reads work requests (one JSON object per line) from `input` until EOF, and
+/// for each of them calls `handle_request` with the request's arguments and
+/// writes a work response to `output`.
+///
+/// A failed request is reported through a non-zero `exitCode` of its response
+/// and doesn't stop the loop.  Only errors when reading `input` or writing
+/// `output` are returned.
+pub fn run_persistent_worker(
+    input: impl BufRead,
+    mut output: impl Write,
+    mut handle_request: impl FnMut(&[String]) -> Result<()>,
+) -> Result<()> {
+    for line in input.lines() {
+        let line = line.context("Error when reading a work request")?;
+        if line.trim().is_empty() {
+            continue;
+        }
+        let response = match serde_json::from_str::<WorkRequest>(&line) {
+            Err(err) => WorkResponse {
+                exit_code: 1,
+                output: format!("Invalid work request: {err}"),
+                request_id: 0,
+            },
+            Ok(WorkRequest { arguments, request_id }) => match handle_request(&arguments) {
+                Ok(()) => WorkResponse { exit_code: 0, output: String::new(), request_id },
+                Err(err) => WorkResponse { exit_code: 1, output: format!("{err:#}"), request_id },
+            },
+        };
+        serde_json::to_writer(&mut output, &response)?;
+        writeln!(output)?;
+        output.flush()?;
+    }
+    Ok(())
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use anyhow::bail;
+
+    fn run(input: &str, handle_request: impl FnMut(&[String]) -> Result<()>) -> String {
+        let mut output = Vec::new();
+        run_persistent_worker(input.as_bytes(), &mut output, handle_request).unwrap();
+        String::from_utf8(output).unwrap()
+    }
+
+    #[test]
+    fn test_responses_in_request_order() {
+        let mut seen_args = vec![];
+        let output = run(
+            "{\"arguments\": [\"--a\"], \"requestId\": 1}\n\
+             \n\
+             {\"arguments\": [\"--b\", \"--c\"], \"requestId\": 2}\n",
+            |args| {
+                seen_args.push(args.to_vec());
+                Ok(())
+            },
+        );
+        assert_eq!(seen_args, vec![vec!["--a"], vec!["--b", "--c"]]);
+        assert_eq!(
+            output,
+            "{\"exitCode\":0,\"output\":\"\",\"requestId\":1}\n\
+             {\"exitCode\":0,\"output\":\"\",\"requestId\":2}\n"
+        );
+    }
+
+    #[test]
+    fn test_failed_request_does_not_stop_the_worker() {
+        let output = run("{\"arguments\": [\"--fail\"]}\nnot json\n{\"requestId\": 3}\n", |args| {
+            if args.is_empty() {
+                Ok(())
+            } else {
+                bail!("Failed on {}", args[0])
+            }
+        });
+        let lines = output.lines().collect::<Vec<_>>();
+        assert_eq!(lines.len(), 3);
+        assert_eq!(lines[0], "{\"exitCode\":1,\"output\":\"Failed on --fail\",\"requestId\":0}");
+        assert!(lines[1].starts_with("{\"exitCode\":1,\"output\":\"Invalid work request: "));
+        assert_eq!(lines[2], "{\"exitCode\":0,\"output\":\"\",\"requestId\":3}");
+    }
+}
@@ -23,6 +23,41 @@ use rustc_session::EarlyErrorHandler;
 /// - Is safe to run from unit tests (which may run in parallel / on multiple
 ///   threads).
 pub fn run_compiler<F, R>(rustc_args: &[String], callback: F) -> anyhow::Result<R>
+where
+    F: FnOnce(TyCtxt) -> anyhow::Result<R> + Send,
+    R: Send,
+{
+    run_compiler_impl(rustc_args, Stage::AfterAnalysis, callback)
+}
+
+/// Same as `run_compiler`, but invokes the `callback` right after macro
+/// expansion and name resolution, without waiting for the full analysis of
+/// the crate.
+///
+/// The `TyCtxt` queries are computed on demand, so the `callback` only pays
+/// for the facts it asks for (e.g. `fn_sig` or `layout_of` of the public
+/// items), rather than for type-checking and borrow-checking every function
+/// body. Errors in the parts of the crate that the `callback` doesn't look at
+/// are not reported.
+pub fn run_compiler_without_analysis<F, R>(rustc_args: &[String], callback: F) -> anyhow::Result<R>
+where
+    F: FnOnce(TyCtxt) -> anyhow::Result<R> + Send,
+    R: Send,
+{
+    run_compiler_impl(rustc_args, Stage::AfterExpansion, callback)
+}
+
+/// The compilation stage after which `run_compiler_impl` invokes its
+/// callback.
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Stage {
+    /// After macro expansion and name resolution.
+    AfterExpansion,
+    /// After the full analysis of the crate.
+    AfterAnalysis,
+}
+
+fn run_compiler_impl<F, R>(rustc_args: &[String], stage: Stage, callback: F) -> anyhow::Result<R>
 where
     F: FnOnce(TyCtxt) -> anyhow::Result<R> + Send,
     R: Send,
@@ -42,31 +77,32 @@ where
     });
     Lazy::force(&ENV_LOGGER_INIT);
 
-    AfterAnalysisCallback::new(rustc_args, callback).run()
+    StageCallback::new(rustc_args, stage, callback).run()
 }
 
-struct AfterAnalysisCallback<'a, F, R>
+struct StageCallback<'a, F, R>
 where
     F: FnOnce(TyCtxt) -> anyhow::Result<R> + Send,
     R: Send,
 {
     args: &'a [String],
+    stage: Stage,
     callback_or_result: Either<F, anyhow::Result<R>>,
 }
 
-impl<'a, F, R> AfterAnalysisCallback<'a, F, R>
+impl<'a, F, R> StageCallback<'a, F, R>
 where
     F: FnOnce(TyCtxt) -> anyhow::Result<R> + Send,
     R: Send,
 {
-    fn new(args: &'a [String], callback: F) -> Self {
-        Self { args, callback_or_result: Either::Left(callback) }
+    fn new(args: &'a [String], stage: Stage, callback: F) -> Self {
+        Self { args, stage, callback_or_result: Either::Left(callback) }
     }
 
     /// Runs Rust compiler, and then invokes the stored callback (with
-    /// `TyCtxt` of the parsed+analyzed Rust crate as the callback's
-    /// argument), and then finally returns the combined results
-    /// from Rust compiler *and* the callback.
+    /// `TyCtxt` of the parsed (and, unless `stage` is `AfterExpansion`,
+    /// analyzed) Rust crate as the callback's argument), and then finally
+    /// returns the combined results from Rust compiler *and* the callback.
     fn run(mut self) -> anyhow::Result<R> {
         // Rust compiler unwinds with a special sentinel value to abort compilation on
         // fatal errors. We use `catch_fatal_errors` to 1) catch such panics and
@@ -97,15 +133,31 @@ where
         rustc_result.and_then(|()| {
             self.callback_or_result.right_or_else(|_left| {
                 // When rustc cmdline arguments (i.e. `self.args`) are empty (or contain
-                // `--help`) then the `after_analysis` callback won't be invoked.  Handle
-                // this case by emitting an explicit error at the Crubit level.
+                // `--help`) then the `after_expansion` and `after_analysis` callbacks
+                // won't be invoked.  Handle this case by emitting an explicit error at
+                // the Crubit level.
                 Err(anyhow!("The Rust compiler had no crate to compile and analyze"))
             })
         })
     }
+
+    /// Invokes the stored callback with the `TyCtxt` of the crate.
+    fn invoke_callback<'tcx>(
+        &mut self,
+        queries: &'tcx Queries<'tcx>,
+    ) -> rustc_interface::interface::Result<()> {
+        enter_tcx(queries, |tcx| {
+            let callback = {
+                let temporary_placeholder = Either::Right(Err(anyhow::anyhow!("unused")));
+                std::mem::replace(&mut self.callback_or_result, temporary_placeholder)
+                    .left_or_else(|_| panic!("the callback should only run once"))
+            };
+            self.callback_or_result = Either::Right(callback(tcx));
+        })
+    }
 }
 
-impl<'a, F, R> rustc_driver::Callbacks for AfterAnalysisCallback<'a, F, R>
+impl<'a, F, R> rustc_driver::Callbacks for StageCallback<'a, F, R>
 where
     F: FnOnce(TyCtxt) -> anyhow::Result<R> + Send,
     R: Send,
@@ -119,20 +171,30 @@ where
         config.opts.lint_opts.push(("warnings".to_string(), rustc_lint_defs::Level::Allow));
     }
 
+    fn after_expansion<'tcx>(
+        &mut self,
+        _handler: &EarlyErrorHandler,
+        _compiler: &Compiler,
+        queries: &'tcx Queries<'tcx>,
+    ) -> rustc_driver::Compilation {
+        if self.stage != Stage::AfterExpansion {
+            return rustc_driver::Compilation::Continue;
+        }
+
+        // Errors (either from the earlier stages, or emitted by the queries of the
+        // callback) don't need to be handled here: `rustc_driver` checks for them
+        // when compilation stops, and then `run` reports them.
+        let _ = self.invoke_callback(queries);
+        rustc_driver::Compilation::Stop
+    }
+
     fn after_analysis<'tcx>(
         &mut self,
         _handler: &EarlyErrorHandler,
         _compiler: &Compiler,
         queries: &'tcx Queries<'tcx>,
     ) -> rustc_driver::Compilation {
-        let rustc_result = enter_tcx(queries, |tcx| {
-            let callback = {
-                let temporary_placeholder = Either::Right(Err(anyhow::anyhow!("unused")));
-                std::mem::replace(&mut self.callback_or_result, temporary_placeholder)
-                    .left_or_else(|_| panic!("`after_analysis` should only run once"))
-            };
-            self.callback_or_result = Either::Right(callback(tcx));
-        });
+        let rustc_result = self.invoke_callback(queries);
 
         // `expect`ing no errors in `rustc_result`, because `after_analysis` is only
         // called by `rustc_driver` if earlier compiler analysis was successful
@@ -160,7 +222,7 @@ where
 
 #[cfg(test)]
 pub mod tests {
-    use super::run_compiler;
+    use super::{run_compiler, run_compiler_without_analysis};
 
     use rustc_middle::ty::TyCtxt; // See also <internal link>/ty.html#import-conventions
     use std::path::PathBuf;
@@ -245,6 +307,44 @@ pub mod tests {
         Ok(())
     }
 
+    /// `test_run_compiler_without_analysis` tests that
+    /// `run_compiler_without_analysis` doesn't type-check function bodies,
+    /// while `run_compiler` does.
+    #[test]
+    fn test_run_compiler_without_analysis() -> anyhow::Result<()> {
+        let tmpdir = tempdir()?;
+
+        let rs_path = tmpdir.path().join("input_crate.rs");
+        std::fs::write(
+            &rs_path,
+            r#" pub fn public_function() -> i32 {
+                    "type error in the function body"
+                }
+            "#,
+        )?;
+
+        let rustc_args = vec![
+            "run_compiler_unittest_executable".to_string(),
+            "--crate-type=lib".to_string(),
+            format!("--sysroot={}", get_sysroot_for_testing().display()),
+            rs_path.display().to_string(),
+        ];
+
+        let fn_count = run_compiler_without_analysis(&rustc_args, |tcx| {
+            Ok(tcx
+                .hir()
+                .items()
+                .filter(|item_id| tcx.def_kind(item_id.owner_id).is_fn_like())
+                .count())
+        })?;
+        assert_eq!(1, fn_count);
+
+        let err = run_compiler(&rustc_args, |_tcx| Ok(()))
+            .expect_err("The type error should be reported by the full analysis");
+        assert_eq!("Errors reported by Rust compiler.", format!("{err:#}"));
+        Ok(())
+    }
+
     #[cfg(llvm_unstable)]
     const CROSSTOOL_VERSION: &str = "llvm_unstable";
     #[cfg(stable)]
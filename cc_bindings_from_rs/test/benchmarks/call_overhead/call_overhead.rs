@@ -0,0 +1,70 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! This crate is called from C++ by `call_overhead_benchmark.cc`, to measure
+//! the cost of the thunks generated by `cc_bindings_from_rs`.
+
+/// Called without a thunk, as a baseline.
+#[no_mangle]
+pub extern "C" fn add_extern_c(x: i32, y: i32) -> i32 {
+    x.wrapping_add(y)
+}
+
+pub fn add(x: i32, y: i32) -> i32 {
+    x.wrapping_add(y)
+}
+
+pub struct Accumulator {
+    total: i32,
+}
+
+impl Accumulator {
+    pub fn create() -> Self {
+        Self { total: 0 }
+    }
+
+    pub fn add(&mut self, x: i32) -> i32 {
+        self.total = self.total.wrapping_add(x);
+        self.total
+    }
+}
+
+/// A struct using default layout, which is returned by value (the Rust thunk
+/// initializes the caller's object in place, through `crubit::InitInPlaceTag`).
+pub struct Point {
+    x: i32,
+    y: i32,
+}
+
+impl Point {
+    pub fn create(x: i32, y: i32) -> Self {
+        Self { x, y }
+    }
+
+    pub fn x(&self) -> i32 {
+        self.x
+    }
+
+    pub fn y(&self) -> i32 {
+        self.y
+    }
+}
+
+/// A struct with drop glue.  Its C++ move constructor calls into Rust (to
+/// `Default::default` the destination, and to drop the moved-from value), so
+/// returning it by value measures whether the bindings need to move it.
+#[derive(Default)]
+pub struct Buffer {
+    bytes: Vec<u8>,
+}
+
+impl Buffer {
+    pub fn with_first_byte(first_byte: i32) -> Self {
+        Self { bytes: vec![first_byte as u8] }
+    }
+
+    pub fn first_byte(&self) -> i32 {
+        self.bytes.first().copied().unwrap_or_default().into()
+    }
+}
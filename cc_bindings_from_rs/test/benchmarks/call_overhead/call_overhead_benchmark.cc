@@ -0,0 +1,71 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Microbenchmarks of the cost of calling Rust from C++ through the bindings
+// generated by `cc_bindings_from_rs`.
+//
+// Each test prints the average time per call, e.g.:
+//
+//   bazel test -c opt --test_output=all \
+//       //cc_bindings_from_rs/test/benchmarks/call_overhead:call_overhead_benchmark
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <iostream>
+
+#include "gtest/gtest.h"
+#include "cc_bindings_from_rs/test/benchmarks/call_overhead/call_overhead_cc_api.h"
+
+namespace crubit {
+namespace {
+
+constexpr std::int32_t kCalls = 1'000'000;
+
+// Calls `f` `kCalls` times, and prints the average time per call.
+template <typename F>
+void ReportTimePerCall(const char* name, F f) {
+  // Keeps the compiler from optimizing the calls away.
+  volatile std::int32_t sink = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (std::int32_t i = 0; i < kCalls; ++i) {
+    sink = f(i);
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << name << ": " << elapsed.count() / kCalls << " ns/call\n";
+}
+
+TEST(CallOverheadBenchmark, ExternCFunction) {
+  ReportTimePerCall("extern \"C\" function", [](std::int32_t i) {
+    return call_overhead::add_extern_c(i, 1);
+  });
+}
+
+TEST(CallOverheadBenchmark, FreeFunction) {
+  ReportTimePerCall("free function",
+                    [](std::int32_t i) { return call_overhead::add(i, 1); });
+}
+
+TEST(CallOverheadBenchmark, Method) {
+  call_overhead::Accumulator accumulator = call_overhead::Accumulator::create();
+  ReportTimePerCall("method",
+                    [&](std::int32_t i) { return accumulator.add(i); });
+}
+
+TEST(CallOverheadBenchmark, StructReturnedByValue) {
+  ReportTimePerCall("struct returned by value", [](std::int32_t i) {
+    return call_overhead::Point::create(i, 1).x();
+  });
+}
+
+TEST(CallOverheadBenchmark, StructWithDropGlueReturnedByValue) {
+  ReportTimePerCall("struct with drop glue returned by value",
+                    [](std::int32_t i) {
+                      return call_overhead::Buffer::with_first_byte(i)
+                          .first_byte();
+                    });
+}
+
+}  // namespace
+}  // namespace crubit
@@ -92,6 +92,29 @@ pub mod fn_param_ty_tests {
     pub fn set_mut_ref_to_sum_of_ints(sum: &mut i32, x: i32, y: i32) {
         *sum = x + y;
     }
+
+    pub fn sum_i32_slice(slice: &[i32]) -> i32 {
+        slice.iter().sum()
+    }
+
+    pub fn double_i32_slice(slice: &mut [i32]) {
+        for x in slice.iter_mut() {
+            *x *= 2;
+        }
+    }
+
+    pub fn get_middle_of_i32_slice(slice: &[i32]) -> &[i32] {
+        let len = slice.len();
+        &slice[len / 4..len - len / 4]
+    }
+
+    pub fn count_chars_in_str(s: &str) -> usize {
+        s.chars().count()
+    }
+
+    pub fn trim_str(s: &str) -> &str {
+        s.trim()
+    }
 }
 
 /// APIs for testing functions that return the unit / `()` / `void` type.
@@ -113,6 +136,37 @@ pub mod unit_ret_ty_tests {
     }
 }
 
+/// APIs for testing functions that return `impl Iterator<Item = T>`.
+pub mod iterator_ret_ty_tests {
+    /// Returns the even numbers below `n`.
+    pub fn evens(n: u32) -> impl Iterator<Item = u32> {
+        (0..n).step_by(2)
+    }
+}
+
+/// APIs for testing functions that return `Vec<T>`, `String`, or `Box<T>`.
+pub mod owned_ret_ty_tests {
+    /// Returns the squares of the numbers below `n`.
+    pub fn squares(n: u64) -> Vec<u64> {
+        (0..n).map(|i| i * i).collect()
+    }
+
+    pub fn greeting(name: &str) -> String {
+        format!("Hello, {name}!")
+    }
+
+    pub fn boxed_i64(value: i64) -> Box<i64> {
+        Box::new(value)
+    }
+}
+
+/// APIs for testing `async fn`s.
+pub mod async_fn_tests {
+    pub async fn add_i32_async(x: i32, y: i32) -> i32 {
+        x + y
+    }
+}
+
 pub mod other_fn_param_tests {
     pub fn add_i32_via_rust_abi_with_duplicated_param_names(x: i32, y: i32, _: i32, _: i32) -> i32 {
         x + y
@@ -2,15 +2,28 @@
 // Exceptions. See /LICENSE for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <cstdint>
+#include <optional>
+#include <string_view>
+#include <vector>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "cc_bindings_from_rs/test/functions/functions_cc_api.h"
+#include "support/rs_std/box.h"
+#include "support/rs_std/chunked_range.h"
+#include "support/rs_std/future.h"
 #include "support/rs_std/rs_char.h"
+#include "support/rs_std/rs_string.h"
+#include "support/rs_std/slice_ref.h"
+#include "support/rs_std/str_ref.h"
+#include "support/rs_std/vec.h"
 
 namespace crubit {
 namespace {
 
 using testing::DoubleEq;
+using testing::ElementsAre;
 
 namespace fn_abi_tests = functions::fn_abi_tests;
 namespace fn_param_ty_tests = functions::fn_param_ty_tests;
@@ -87,6 +100,38 @@ TEST(FnParamTyTests, Int32MutRef) {
   EXPECT_EQ(sum, 456 + 789);
 }
 
+TEST(FnParamTyTests, SliceRef) {
+  std::vector<std::int32_t> v = {1, 2, 3, 4};
+  EXPECT_EQ(1 + 2 + 3 + 4, fn_param_ty_tests::sum_i32_slice(
+                               rs_std::SliceRef<const std::int32_t>(
+                                   v.data(), v.size())));
+  EXPECT_EQ(0, fn_param_ty_tests::sum_i32_slice({}));
+
+  fn_param_ty_tests::double_i32_slice(
+      rs_std::SliceRef<std::int32_t>(v.data(), v.size()));
+  EXPECT_THAT(v, ElementsAre(2, 4, 6, 8));
+
+  // The returned slice points into `v` - the elements are not copied.
+  rs_std::SliceRef<const std::int32_t> middle =
+      fn_param_ty_tests::get_middle_of_i32_slice(
+          rs_std::SliceRef<const std::int32_t>(v.data(), v.size()));
+  EXPECT_EQ(v.data() + 1, middle.data());
+  EXPECT_EQ(2u, middle.size());
+}
+
+TEST(FnParamTyTests, StrRef) {
+  std::optional<rs_std::StrRef> s =
+      rs_std::StrRef::from_utf8("  \xf0\x9f\xa6\x80 crab  ");
+  ASSERT_TRUE(s.has_value());
+  EXPECT_EQ(10u, fn_param_ty_tests::count_chars_in_str(*s));
+  EXPECT_EQ(0u, fn_param_ty_tests::count_chars_in_str(rs_std::StrRef()));
+
+  // The returned string points into `*s` - the characters are not copied.
+  std::string_view trimmed = fn_param_ty_tests::trim_str(*s);
+  EXPECT_EQ("\xf0\x9f\xa6\x80 crab", trimmed);
+  EXPECT_EQ(s->data() + 2, trimmed.data());
+}
+
 std::int32_t AddInt32(std::int32_t x, std::int32_t y) { return x + y; }
 
 std::int32_t MultiplyInt32(std::int32_t x, std::int32_t y) { return x * y; }
@@ -109,6 +154,56 @@ TEST(OtherFnTests, VoidReturningFunction) {
   EXPECT_EQ(456, tests::get_global_i32_via_extern_c_with_export_name());
 }
 
+TEST(OtherFnTests, IteratorReturningFunction) {
+  namespace tests = functions::iterator_ret_ty_tests;
+  std::vector<std::uint32_t> evens;
+  for (std::uint32_t i : tests::evens(10)) evens.push_back(i);
+  EXPECT_THAT(evens, ElementsAre(0, 2, 4, 6, 8));
+
+  // More items than fit into one chunk.
+  std::uint32_t expected = 0;
+  rs_std::ChunkedRange<std::uint32_t> range = tests::evens(10000);
+  for (std::uint32_t i : range) {
+    EXPECT_EQ(expected, i);
+    expected += 2;
+  }
+  EXPECT_EQ(10000u, expected);
+}
+
+TEST(OtherFnTests, OwnedTypeReturningFunctions) {
+  namespace tests = functions::owned_ret_ty_tests;
+  rs_std::Vec<std::uint64_t> squares = tests::squares(5);
+  EXPECT_THAT(std::vector<std::uint64_t>(squares.begin(), squares.end()),
+              ElementsAre(0, 1, 4, 9, 16));
+  EXPECT_TRUE(tests::squares(0).empty());
+
+  rs_std::String greeting =
+      tests::greeting(rs_std::StrRef::from_utf8("world").value());
+  EXPECT_EQ("Hello, world!", std::string_view(greeting));
+
+  rs_std::Box<std::int64_t> boxed = tests::boxed_i64(42);
+  EXPECT_EQ(42, *boxed);
+}
+
+// The test is built as C++17, so it uses the awaiter interface of
+// `rs_std::Future` directly, rather than through `co_await`.
+class NeverResumedHandle {
+ public:
+  static NeverResumedHandle from_address(void*) { return {}; }
+  void* address() const { return nullptr; }
+  void resume() { ADD_FAILURE() << "Resumed a ready future"; }
+};
+
+TEST(OtherFnTests, AsyncFunction) {
+  namespace tests = functions::async_fn_tests;
+  rs_std::Future<std::int32_t> future = tests::add_i32_async(12, 34);
+  EXPECT_FALSE(future.await_ready());
+  // The Rust future is ready when first polled, so there is no need to
+  // suspend the caller.
+  EXPECT_FALSE(future.await_suspend(NeverResumedHandle()));
+  EXPECT_EQ(12 + 34, future.await_resume());
+}
+
 TEST(OtherFnTests, DuplicatedParamNames) {
   namespace tests = functions::other_fn_param_tests;
   EXPECT_EQ(12 + 34, tests::add_i32_via_rust_abi_with_duplicated_param_names(
@@ -4,6 +4,7 @@
 
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
@@ -26,13 +27,25 @@ TYPED_TEST(CustomDropWithDefaultTest, StaticAsserts) {
   static_assert(!std::is_trivially_default_constructible_v<TypeUnderTest>);
   static_assert(std::is_move_constructible_v<TypeUnderTest>);
   static_assert(!std::is_trivially_move_constructible_v<TypeUnderTest>);
+  static_assert(std::is_nothrow_move_constructible_v<TypeUnderTest>);
   static_assert(std::is_move_assignable_v<TypeUnderTest>);
   static_assert(!std::is_trivially_move_assignable_v<TypeUnderTest>);
+  static_assert(std::is_nothrow_move_assignable_v<TypeUnderTest>);
   static_assert(!std::is_trivially_destructible_v<TypeUnderTest>);
   static_assert(!std::is_copy_constructible_v<TypeUnderTest>);
   static_assert(!std::is_copy_assignable_v<TypeUnderTest>);
 }
 
+#if defined(__clang__) && __has_builtin(__is_trivially_relocatable)
+// Thanks to `[[clang::trivial_abi]]`, which is only emitted when all the fields
+// are trivial for the purpose of calls. `DropGlueWithDefault` doesn't get it,
+// because its `field` (in an anonymous union) has a non-trivial destructor.
+static_assert(__is_trivially_relocatable(
+    drop::drop_impl_with_default::DropImplWithDefault));
+static_assert(!__is_trivially_relocatable(
+    drop::drop_glue_with_default::DropGlueWithDefault));
+#endif
+
 TYPED_TEST(CustomDropWithDefaultTest, Destructor) {
   using TypeUnderTest = TypeParam;
   drop::counters::reset_counts();
@@ -96,5 +109,23 @@ TYPED_TEST(CustomDropWithDefaultTest, MoveAssignmentOperator) {
   EXPECT_EQ(2, drop::counters::get_drop_count());
 }
 
+TYPED_TEST(CustomDropWithDefaultTest, VectorReallocation) {
+  using TypeUnderTest = TypeParam;
+  drop::counters::reset_counts();
+  {
+    std::vector<TypeUnderTest> v;
+    for (int i = 0; i < 100; ++i) {
+      v.emplace_back().set_int(i);
+    }
+    for (int i = 0; i < 100; ++i) {
+      EXPECT_EQ(i, v[i].get_int());
+    }
+  }
+  // Whether the vector relocates its elements with `memcpy` or with the move
+  // constructor and destructor, every `Default` is matched by one `Drop`.
+  EXPECT_EQ(drop::counters::get_default_count(),
+            drop::counters::get_drop_count());
+}
+
 }  // namespace
 }  // namespace crubit
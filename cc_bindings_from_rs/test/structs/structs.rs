@@ -23,6 +23,51 @@ pub mod repr_c {
     }
 }
 
+/// Test for `#[inline]` functions with trivial bodies, which are translated to
+/// C++ (rather than called through a thunk).  Each of them has a non-`#[inline]`
+/// counterpart, so that the test can verify that both behave the same.
+pub mod inline_fns {
+
+    #[repr(C)]
+    pub struct Counter {
+        pub count: u32,
+        max: u64,
+    }
+
+    impl Counter {
+        pub fn create(count: u32, max: u64) -> Self {
+            Self { count, max }
+        }
+
+        #[inline]
+        pub fn max(&self) -> u64 {
+            self.max
+        }
+
+        pub fn max_via_thunk(&self) -> u64 {
+            self.max
+        }
+
+        #[inline]
+        pub fn default_max() -> u64 {
+            1000
+        }
+
+        pub fn default_max_via_thunk() -> u64 {
+            1000
+        }
+    }
+
+    #[inline]
+    pub fn get_count(c: Counter) -> u32 {
+        c.count
+    }
+
+    pub fn get_count_via_thunk(c: Counter) -> u32 {
+        c.count
+    }
+}
+
 /// Test for a struct using default layout (i.e. one without an explicit
 /// `#[repr(C)]` or similar attribute).  Among other things, it tests that
 /// building generated `..._cc_api_impl.rs` will not warn about
@@ -229,6 +274,61 @@ pub mod struct_by_float_passing_with_no_thunk {
     }
 }
 
+/// Test for structs whose C++ bindings have the same ABI as the Rust structs
+/// (`#[repr(C)]` or `#[repr(transparent)]`, primitive fields, no padding).
+/// `extern "C"` functions that take or return such structs by value don't need
+/// a thunk, and the thunks of other functions pass them by value.
+pub mod c_abi_compatible_structs {
+    #[repr(C)]
+    pub struct Pair {
+        pub first: i32,
+        pub second: f32,
+    }
+
+    #[repr(transparent)]
+    pub struct Meters(pub f64);
+
+    #[no_mangle]
+    pub extern "C" fn c_abi_compatible_structs_make_pair(first: i32, second: f32) -> Pair {
+        Pair { first, second }
+    }
+
+    #[no_mangle]
+    pub extern "C" fn c_abi_compatible_structs_sum(p: Pair) -> f32 {
+        p.first as f32 + p.second
+    }
+
+    pub fn meters(value: f64) -> Meters {
+        Meters(value)
+    }
+
+    #[no_mangle]
+    pub extern "C" fn c_abi_compatible_structs_double(m: Meters) -> Meters {
+        Meters(m.0 * 2.0)
+    }
+
+    pub fn swap(p: Pair) -> Pair {
+        Pair { first: p.second as i32, second: p.first as f32 }
+    }
+}
+
+/// Test for `#[repr(C)]` structs with only public `Copy` fields, which are
+/// exposed to C++ as plain, standard-layout structs (without the explicit
+/// padding, even though `Particle` has some).
+pub mod plain_old_data {
+    #[derive(Clone, Copy)]
+    #[repr(C)]
+    pub struct Particle {
+        pub x: f32,
+        pub y: f32,
+        pub mass: u8,
+    }
+
+    pub fn create(x: f32, y: f32, mass: u8) -> Particle {
+        Particle { x, y, mass }
+    }
+}
+
 /// Dynamically sized types 1) don't get bindings today, and 2) shouldn't
 /// generate assertions about the size of the type (the latter is a regression
 /// test for b/279587535).
@@ -19,6 +19,19 @@ TEST(StructsTest, ReprCPointReturnedOrTakenByValue) {
   EXPECT_EQ(123, structs::repr_c::get_x(std::move(p)));
 }
 
+TEST(StructsTest, InlineFnsMatchThunks) {
+  namespace test = structs::inline_fns;
+  test::Counter c = test::Counter::create(123, 456);
+  EXPECT_EQ(456, c.max());
+  EXPECT_EQ(c.max_via_thunk(), c.max());
+  EXPECT_EQ(1000, test::Counter::default_max());
+  EXPECT_EQ(test::Counter::default_max_via_thunk(),
+            test::Counter::default_max());
+  EXPECT_EQ(123, test::get_count(test::Counter::create(123, 456)));
+  EXPECT_EQ(test::get_count_via_thunk(test::Counter::create(123, 456)),
+            test::get_count(test::Counter::create(123, 456)));
+}
+
 TEST(StructsTest, ZstFieldsReturnedOrTakenByValue) {
   structs::zst_fields::ZstFields x = structs::zst_fields::create(42);
   EXPECT_EQ(42, x.value);
@@ -77,6 +90,39 @@ TEST(StructsTest, ThunklessStructFloat) {
   EXPECT_EQ(111.0 * 222.0, test::thunkless_inspect(std::move(product)));
 }
 
+TEST(StructsTest, CAbiCompatibleStructs) {
+  namespace test = structs::c_abi_compatible_structs;
+  test::Pair p = test::c_abi_compatible_structs_make_pair(12, 34.0);
+  EXPECT_EQ(12, p.first);
+  EXPECT_EQ(34.0, p.second);
+  EXPECT_EQ(46.0, test::c_abi_compatible_structs_sum(std::move(p)));
+
+  test::Pair swapped =
+      test::swap(test::c_abi_compatible_structs_make_pair(12, 34.0));
+  EXPECT_EQ(34, swapped.first);
+  EXPECT_EQ(12.0, swapped.second);
+
+  test::Meters m = test::c_abi_compatible_structs_double(test::meters(1.5));
+  EXPECT_EQ(3.0, m.__field0);
+}
+
+TEST(StructsTest, PlainOldDataFieldsAreDataMembers) {
+  namespace test = structs::plain_old_data;
+  static_assert(std::is_standard_layout_v<test::Particle>);
+  static_assert(std::is_trivially_copyable_v<test::Particle>);
+
+  test::Particle particles[] = {test::create(1.0, 2.0, 3),
+                                test::create(4.0, 5.0, 6)};
+  float sum_of_x = 0;
+  int total_mass = 0;
+  for (const test::Particle& p : particles) {
+    sum_of_x += p.x;
+    total_mass += p.mass;
+  }
+  EXPECT_EQ(5.0, sum_of_x);
+  EXPECT_EQ(9, total_mass);
+}
+
 // This is a regression test for b/286876315 - it verifies that the mutability
 // qualifiers of nested pointers / pointees are correctly propagated.
 TEST(StructsTest, NestedPtrTypeMutabilityQualifiers) {
@@ -2,7 +2,7 @@
 // Exceptions. See /LICENSE for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
-use std::cmp::Ordering;
+use std::cmp::{Ordering, Reverse};
 use std::collections::{BinaryHeap, HashMap};
 use std::fmt::Debug;
 use std::hash::Hash;
@@ -63,10 +63,12 @@ use std::hash::Hash;
 /// queue](https://en.wikipedia.org/wiki/Priority_queue) - this helps remove nodes in the desired
 /// order.
 ///
-/// Rust's standard library conveniently provides a priority queue as
-/// `std::collections::BinaryHeap`.  The `preferred_order` function is exposed
-/// to the `BinaryHeap` via the `Ord` implementation of the private `HeapNode`
-/// struct below.
+/// The nodes are sorted in the `preferred_order` once upfront, and from then
+/// on each node is represented by its dense `u32` rank in that order.  The
+/// priority queue (Rust's `std::collections::BinaryHeap`) and the adjacency
+/// lists hold these ranks, so the sort itself runs in O(E + N log N) time
+/// without calling `preferred_order` (which may be expensive - e.g. it may
+/// compare source locations) more than the initial sort does.
 ///
 /// # Why not use an existing Cargo crate?
 ///
@@ -126,58 +128,80 @@ where
     NodeId: Clone + Debug + Eq + Hash,
     CmpFn: Fn(&NodeId, &NodeId) -> Ordering,
 {
-    // Translating `nodes` and `deps` into a `graph` that maps node ids into 1)
-    // `count_of_predecessors` and 2) a set of `successor` ids.
-    let mut graph: HashMap<NodeId, GraphNode<NodeId>> =
-        nodes.into_iter().map(|id| (id, GraphNode::default())).collect();
+    // Translating `nodes` into a vector sorted in the `preferred_order`, so that
+    // the rest of the algorithm can refer to nodes by their rank in this order.
+    let mut sorted_nodes: Vec<NodeId> = Vec::new();
+    let mut ranks: HashMap<NodeId, u32> = HashMap::new();
+    for id in nodes.into_iter() {
+        if !ranks.contains_key(&id) {
+            ranks.insert(id.clone(), 0);
+            sorted_nodes.push(id);
+        }
+    }
+    sorted_nodes.sort_by(&preferred_order);
+    for (rank, id) in sorted_nodes.iter().enumerate() {
+        *ranks.get_mut(id).unwrap() =
+            u32::try_from(rank).expect("`toposort` supports at most `u32::MAX` nodes");
+    }
+
+    // Translating `deps` into 1) `count_of_predecessors` and 2) lists of
+    // `successors`, both indexed by rank.
+    let mut count_of_predecessors: Vec<u32> = vec![0; sorted_nodes.len()];
+    let mut successors: Vec<Vec<u32>> = vec![Vec::new(); sorted_nodes.len()];
     for Dependency { predecessor, successor } in deps.into_iter() {
-        graph
-            .get_mut(&successor)
-            .unwrap_or_else(|| panic!(
-                "`Dependency::successor` should refer to a NodeId in the `nodes` parameter. \
-                 predecessor = {predecessor:?}; successor = {successor:?}"))
-            .count_of_predecessors += 1;
-        graph
-            .get_mut(&predecessor)
-            .unwrap_or_else(|| panic!(
-                "`Dependency::predecessor` should refer to a NodeId in the `nodes` parameter. \
-                 predecessor = {predecessor:?}; successor = {successor:?}"))
-            .successors
-            .push(successor);
+        let (Some(&predecessor_rank), Some(&successor_rank)) =
+            (ranks.get(&predecessor), ranks.get(&successor))
+        else {
+            panic!(
+                "`Dependency` should refer to NodeIds in the `nodes` parameter. \
+                 predecessor = {predecessor:?}; successor = {successor:?}"
+            );
+        };
+        count_of_predecessors[successor_rank as usize] += 1;
+        successors[predecessor_rank as usize].push(successor_rank);
     }
 
-    // `ready` contains ids of nodes which have no remaining predecessors (and which
-    // therefore are ready to be added to the `ordered` result of the
-    // topological sort).  Using a BinaryHeap to store the `ready` nodes helps
-    // to extract them in the `preferred_order`.  (This is the `S` data structure from
+    // `ready` contains ranks of nodes which have no remaining predecessors (and
+    // which therefore are ready to be added to the `ordered` result of the
+    // topological sort).  `BinaryHeap` pops the greatest item, so the ranks are
+    // wrapped in `Reverse` to extract them in the `preferred_order`.  (This is
+    // the `S` data structure from
     // https://en.wikipedia.org/wiki/Topological_sorting#Kahn%27s_algorithm.)
-    let mut ready: BinaryHeap<HeapNode<'_, NodeId, CmpFn>> = graph
-        .iter()
-        .filter(|(_, graph_node)| graph_node.count_of_predecessors == 0)
-        .map(|(id, _)| HeapNode { id: id.clone(), cmp_fn: &preferred_order })
+    let mut ready: BinaryHeap<Reverse<u32>> = (0..sorted_nodes.len() as u32)
+        .filter(|&rank| count_of_predecessors[rank as usize] == 0)
+        .map(Reverse)
         .collect();
 
-    // `ordered` contains the topologically ordered results.  (This is the `L` list
-    // from https://en.wikipedia.org/wiki/Topological_sorting#Kahn%27s_algorithm.)
-    let mut ordered: Vec<NodeId> = Vec::with_capacity(graph.len());
-    while let Some(HeapNode { id: removed_id, .. }) = ready.pop() {
-        let removed_graph_node = graph.remove(&removed_id).unwrap();
-        for succ_id in removed_graph_node.successors.into_iter() {
-            let succ = graph.get_mut(&succ_id).unwrap();
-            assert!(succ.count_of_predecessors > 0);
-            succ.count_of_predecessors -= 1;
-            if succ.count_of_predecessors == 0 {
-                ready.push(HeapNode { id: succ_id, cmp_fn: &preferred_order });
+    // `ordered_ranks` contains the topologically ordered results.  (This is the
+    // `L` list from https://en.wikipedia.org/wiki/Topological_sorting#Kahn%27s_algorithm.)
+    let mut ordered_ranks: Vec<u32> = Vec::with_capacity(sorted_nodes.len());
+    let mut is_ordered: Vec<bool> = vec![false; sorted_nodes.len()];
+    while let Some(Reverse(removed_rank)) = ready.pop() {
+        for &succ_rank in successors[removed_rank as usize].iter() {
+            let count = &mut count_of_predecessors[succ_rank as usize];
+            assert!(*count > 0);
+            *count -= 1;
+            if *count == 0 {
+                ready.push(Reverse(succ_rank));
             }
         }
-        ordered.push(removed_id);
+        is_ordered[removed_rank as usize] = true;
+        ordered_ranks.push(removed_rank);
     }
 
     // `failed` contains the remaining nodes - ones that either formed a dependency
     // cycle or (possibly indirectly) depended on a node participating in a
-    // cycle.
-    let mut failed: Vec<NodeId> = graph.into_keys().collect();
-    failed.sort_by(preferred_order);
+    // cycle.  They are visited in the order of their ranks, and therefore end up
+    // sorted in the `preferred_order`.
+    let mut sorted_nodes: Vec<Option<NodeId>> = sorted_nodes.into_iter().map(Some).collect();
+    let ordered =
+        ordered_ranks.into_iter().map(|rank| sorted_nodes[rank as usize].take().unwrap()).collect();
+    let failed = sorted_nodes
+        .into_iter()
+        .zip(is_ordered)
+        .filter(|(_, is_ordered)| !is_ordered)
+        .map(|(id, _)| id.unwrap())
+        .collect();
 
     TopoSortResult { ordered, failed }
 }
@@ -201,65 +225,6 @@ pub struct TopoSortResult<NodeId> {
     pub failed: Vec<NodeId>,
 }
 
-struct GraphNode<NodeId> {
-    count_of_predecessors: usize,
-    successors: Vec<NodeId>,
-}
-
-// TODO(https://github.com/rust-lang/rust/issues/26925): It should be possible to
-// `#[derive(Default)]` here, but `derive` insists that `NodeId` has to
-// implement `Default` even though the default vector doesn't contain any
-// `NodeId`s.
-impl<NodeId> Default for GraphNode<NodeId> {
-    fn default() -> Self {
-        Self { count_of_predecessors: 0, successors: Vec::new() }
-    }
-}
-
-struct HeapNode<'a, NodeId, CmpFn>
-where
-    CmpFn: Fn(&NodeId, &NodeId) -> Ordering,
-{
-    id: NodeId,
-    cmp_fn: &'a CmpFn,
-}
-
-impl<'a, NodeId, CmpFn> Ord for HeapNode<'a, NodeId, CmpFn>
-where
-    CmpFn: Fn(&NodeId, &NodeId) -> Ordering,
-{
-    fn cmp(&self, other: &Self) -> Ordering {
-        // https://doc.rust-lang.org/stable/std/collections/struct.BinaryHeap.html#method.pop
-        // "removes the greatest item from the binary heap" and therefore to pop items
-        // in the `cmp_fn`-described preferred order we need to call `reverse()`
-        // below.
-        (self.cmp_fn)(&self.id, &other.id).reverse()
-    }
-}
-
-impl<'a, NodeId, CmpFn> PartialOrd for HeapNode<'a, NodeId, CmpFn>
-where
-    CmpFn: Fn(&NodeId, &NodeId) -> Ordering,
-{
-    fn partial_cmp(&self, other: &Self) -> Option<Ordering> {
-        Some(self.cmp(other))
-    }
-}
-
-impl<'a, NodeId, CmpFn> PartialEq for HeapNode<'a, NodeId, CmpFn>
-where
-    CmpFn: Fn(&NodeId, &NodeId) -> Ordering,
-{
-    fn eq(&self, other: &Self) -> bool {
-        self.cmp(other) == Ordering::Equal
-    }
-}
-
-impl<'a, NodeId, CmpFn> Eq for HeapNode<'a, NodeId, CmpFn> where
-    CmpFn: Fn(&NodeId, &NodeId) -> Ordering
-{
-}
-
 #[cfg(test)]
 mod tests {
     /// Test helper providing simplified API for `super::toposort`:
@@ -316,6 +281,22 @@ mod tests {
         assert_eq!(failed, vec![5, 6, 7]);
     }
 
+    #[test]
+    fn test_toposort_duplicate_nodes() {
+        let (ordered, failed) = toposort(&[2, 1, 2, 3, 1], &[(3, 1)]);
+        assert_eq!(ordered, vec![2, 3, 1]);
+        assert_eq!(failed, vec![]);
+    }
+
+    #[test]
+    fn test_toposort_chain_against_preferred_order() {
+        let nodes = (0..1000).collect::<Vec<i32>>();
+        let deps = (1..1000).map(|i| (i, i - 1)).collect::<Vec<(i32, i32)>>();
+        let (ordered, failed) = toposort(&nodes, &deps);
+        assert_eq!(ordered, (0..1000).rev().collect::<Vec<i32>>());
+        assert_eq!(failed, vec![]);
+    }
+
     #[test]
     fn test_example() {
         // TODO: Remove this test once rustdoc examples of the `toposort` function are
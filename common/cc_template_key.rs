@@ -0,0 +1,290 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! Canonical spelling of the C++ template instantiations requested through
+//! `cc_template!`.
+//!
+//! `rs_bindings_from_cc/collect_instantiations.rs` collects the requested
+//! instantiations and `support/cc_template/cc_template_impl.rs` looks them up
+//! in the resulting instantiations map. Both must turn the tokens passed to
+//! `cc_template!` into the same key, and spelling variants of the same type
+//! should map to the same key, so that the instantiation is only generated and
+//! compiled once. For example `::std::vector<std::int32_t>` and
+//! `std::vector<int>` both become `std :: vector < int >`.
+//!
+//! The key is also valid C++, in which the instantiation is spelled. Only
+//! rewrites that can't change which type is named are applied:
+//!   * a leading `::` before `std` is removed,
+//!   * the fixed-width integer typedefs of `<cstdint>` are replaced by the
+//!     builtin types they name on the LP64 platforms that Crubit supports,
+//!   * builtin integer types are spelled in a single way (e.g. `unsigned` and
+//!     `unsigned int` both become `unsigned int`, `long int` becomes `long`).
+//!
+//! This crate intentionally depends on nothing but `proc_macro2`, so that the
+//! proc macro can use it.
+
+use proc_macro2::{Delimiter, Ident, Punct, Spacing, Span, TokenStream, TokenTree};
+
+/// Returns the canonical key for the instantiation spelled by `tokens`.
+pub fn instantiation_key(tokens: TokenStream) -> String {
+    let mut key = String::new();
+    write_tokens(&canonicalize(tokens), &mut key);
+    key
+}
+
+fn canonicalize(tokens: TokenStream) -> Vec<TokenTree> {
+    let mut result = Vec::<TokenTree>::new();
+    let mut tokens = tokens.into_iter().peekable();
+    while let Some(token) = tokens.next() {
+        match token {
+            TokenTree::Group(group) => {
+                let inner = canonicalize(group.stream()).into_iter().collect();
+                let mut canonical = proc_macro2::Group::new(group.delimiter(), inner);
+                canonical.set_span(group.span());
+                result.push(canonical.into());
+            }
+            TokenTree::Punct(ref punct)
+                if is_path_separator_start(punct, tokens.peek()) && is_path_start(&result) =>
+            {
+                // Skip a leading `::` before `std`.
+                let mut lookahead = tokens.clone();
+                lookahead.next();
+                match lookahead.next() {
+                    Some(TokenTree::Ident(ident)) if ident == "std" => {
+                        tokens.next();
+                    }
+                    _ => result.push(token),
+                }
+            }
+            TokenTree::Ident(ref ident) => {
+                let name = ident.to_string();
+                match fixed_width_builtin(&name) {
+                    Some(builtin) if strip_std_qualifier(&mut result) => {
+                        result.extend(builtin.split(' ').map(make_ident))
+                    }
+                    _ => result.push(token),
+                }
+            }
+            _ => result.push(token),
+        }
+    }
+    canonicalize_builtin_integers(result)
+}
+
+/// Returns whether `punct` and `next` form a `::`.
+fn is_path_separator_start(punct: &Punct, next: Option<&TokenTree>) -> bool {
+    punct.as_char() == ':'
+        && punct.spacing() == Spacing::Joint
+        && matches!(next, Some(TokenTree::Punct(next)) if next.as_char() == ':')
+}
+
+/// Returns whether a `::` following `preceding` starts a path, rather than
+/// separating two of its components.
+fn is_path_start(preceding: &[TokenTree]) -> bool {
+    match preceding.last() {
+        None => true,
+        Some(TokenTree::Punct(punct)) => punct.as_char() != '>' && punct.as_char() != ':',
+        Some(TokenTree::Ident(_) | TokenTree::Literal(_) | TokenTree::Group(_)) => false,
+    }
+}
+
+/// If the tokens end with `std ::` at the start of a path, removes them.
+/// Returns whether the following identifier is unqualified, i.e. whether that
+/// was the case or the tokens don't end with `::` at all.
+fn strip_std_qualifier(tokens: &mut Vec<TokenTree>) -> bool {
+    let len = tokens.len();
+    let ends_with_separator = len >= 2
+        && matches!(&tokens[len - 2], TokenTree::Punct(p) if p.as_char() == ':')
+        && matches!(&tokens[len - 1], TokenTree::Punct(p) if p.as_char() == ':');
+    if !ends_with_separator {
+        return true;
+    }
+    let qualified_by_std = len >= 3
+        && matches!(&tokens[len - 3], TokenTree::Ident(ident) if ident == "std")
+        && is_path_start(&tokens[..len - 3]);
+    if qualified_by_std {
+        tokens.truncate(len - 3);
+    }
+    qualified_by_std
+}
+
+/// The builtin type that a `<cstdint>` typedef names on LP64 platforms.
+fn fixed_width_builtin(name: &str) -> Option<&'static str> {
+    Some(match name {
+        "int8_t" => "signed char",
+        "int16_t" => "short",
+        "int32_t" => "int",
+        "int64_t" => "long",
+        "uint8_t" => "unsigned char",
+        "uint16_t" => "unsigned short",
+        "uint32_t" => "unsigned int",
+        "uint64_t" => "unsigned long",
+        _ => return None,
+    })
+}
+
+fn make_ident(name: &str) -> TokenTree {
+    Ident::new(name, Span::call_site()).into()
+}
+
+/// Replaces each run of the keywords that spell a builtin integer type (e.g.
+/// `unsigned long int`) by the canonical spelling of that type.
+fn canonicalize_builtin_integers(tokens: Vec<TokenTree>) -> Vec<TokenTree> {
+    let mut result = Vec::with_capacity(tokens.len());
+    let mut run = Vec::<TokenTree>::new();
+    for token in tokens {
+        if let TokenTree::Ident(ident) = &token {
+            if INTEGER_KEYWORDS.iter().any(|keyword| ident == keyword) {
+                run.push(token);
+                continue;
+            }
+        }
+        flush_integer_keywords(&mut run, &mut result);
+        result.push(token);
+    }
+    flush_integer_keywords(&mut run, &mut result);
+    result
+}
+
+const INTEGER_KEYWORDS: [&str; 6] = ["signed", "unsigned", "short", "long", "int", "char"];
+
+fn flush_integer_keywords(run: &mut Vec<TokenTree>, result: &mut Vec<TokenTree>) {
+    if run.is_empty() {
+        return;
+    }
+    let count = |keyword: &str| {
+        run.iter().filter(|token| matches!(token, TokenTree::Ident(i) if i == keyword)).count()
+    };
+    let (signed, unsigned, short, long, int, char) = (
+        count("signed"),
+        count("unsigned"),
+        count("short"),
+        count("long"),
+        count("int"),
+        count("char"),
+    );
+    let sign = if unsigned == 1 { "unsigned " } else { "" };
+    let canonical = match (signed + unsigned, short, long, int, char) {
+        // `char`, `signed char` and `unsigned char` are three distinct types.
+        (0, 0, 0, 0, 1) => Some("char".to_string()),
+        (1, 0, 0, 0, 1) if signed == 1 => Some("signed char".to_string()),
+        (1, 0, 0, 0, 1) => Some("unsigned char".to_string()),
+        (0 | 1, 1, 0, 0 | 1, 0) => Some(format!("{sign}short")),
+        (0 | 1, 0, 1, 0 | 1, 0) => Some(format!("{sign}long")),
+        (0 | 1, 0, 2, 0 | 1, 0) => Some(format!("{sign}long long")),
+        (0 | 1, 0, 0, 0 | 1, 0) => Some(format!("{sign}int")),
+        // Not a valid spelling; keep it as it is.
+        _ => None,
+    };
+    match canonical {
+        Some(canonical) => result.extend(canonical.split(' ').map(make_ident)),
+        None => result.append(run),
+    }
+    run.clear();
+}
+
+/// Writes `tokens` separated by single spaces, except after the first
+/// character of a multi-character punctuation such as `::`. This matches how
+/// `proc_macro2` prints tokens outside of a proc macro, but doesn't depend on
+/// how the compiler prints them inside one.
+fn write_tokens(tokens: &[TokenTree], out: &mut String) {
+    let mut needs_space = false;
+    for token in tokens {
+        if needs_space {
+            out.push(' ');
+        }
+        needs_space = true;
+        match token {
+            TokenTree::Group(group) => {
+                let inner = group.stream().into_iter().collect::<Vec<_>>();
+                // Like `proc_macro2`, pad the contents of braces with spaces.
+                let (open, close) = match group.delimiter() {
+                    Delimiter::Parenthesis => ("(", ")"),
+                    Delimiter::Brace if !inner.is_empty() => ("{ ", " }"),
+                    Delimiter::Brace => ("{", "}"),
+                    Delimiter::Bracket => ("[", "]"),
+                    Delimiter::None => ("", ""),
+                };
+                out.push_str(open);
+                write_tokens(&inner, out);
+                out.push_str(close);
+            }
+            TokenTree::Punct(punct) => {
+                out.push(punct.as_char());
+                needs_space = punct.spacing() == Spacing::Alone;
+            }
+            TokenTree::Ident(ident) => out.push_str(&ident.to_string()),
+            TokenTree::Literal(literal) => out.push_str(&literal.to_string()),
+        }
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use quote::quote;
+
+    #[test]
+    fn test_unchanged_spelling() {
+        assert_eq!(instantiation_key(quote! { MyTemplate<int> }), "MyTemplate < int >");
+        assert_eq!(
+            instantiation_key(quote! { std::unique_ptr<absl::Time> }),
+            "std :: unique_ptr < absl :: Time >"
+        );
+        assert_eq!(
+            instantiation_key(quote! { vector<42, "a b", 'a', 3.14, int*> }),
+            "vector < 42 , \"a b\" , 'a' , 3.14 , int * >"
+        );
+    }
+
+    #[test]
+    fn test_matches_token_stream_to_string() {
+        for tokens in [
+            quote! { Pair<int, Pair<int,int> > },
+            quote! { zip<short, int>::with<unsigned short, unsigned int> },
+            quote! { A<B<C<int>>> },
+            quote! { F<(int), {1}, [2]> },
+        ] {
+            assert_eq!(instantiation_key(tokens.clone()), tokens.to_string());
+        }
+    }
+
+    #[test]
+    fn test_leading_global_namespace() {
+        assert_eq!(
+            instantiation_key(quote! { ::std::vector<::std::string> }),
+            "std :: vector < std :: string >"
+        );
+        assert_eq!(instantiation_key(quote! { ::ns::Foo<int> }), ":: ns :: Foo < int >");
+    }
+
+    #[test]
+    fn test_fixed_width_integers() {
+        assert_eq!(
+            instantiation_key(quote! { std::vector<std::int32_t> }),
+            instantiation_key(quote! { std::vector<int> })
+        );
+        assert_eq!(
+            instantiation_key(quote! { Map<::std::uint64_t, int64_t> }),
+            "Map < unsigned long , long >"
+        );
+        // Only the `<cstdint>` typedefs are replaced.
+        assert_eq!(instantiation_key(quote! { Foo<ns::int32_t> }), "Foo < ns :: int32_t >");
+    }
+
+    #[test]
+    fn test_builtin_integers() {
+        assert_eq!(instantiation_key(quote! { Foo<unsigned> }), "Foo < unsigned int >");
+        assert_eq!(instantiation_key(quote! { Foo<signed int> }), "Foo < int >");
+        assert_eq!(instantiation_key(quote! { Foo<long int> }), "Foo < long >");
+        assert_eq!(
+            instantiation_key(quote! { Foo<unsigned long long int> }),
+            "Foo < unsigned long long >"
+        );
+        assert_eq!(instantiation_key(quote! { Foo<short int> }), "Foo < short >");
+        assert_eq!(instantiation_key(quote! { Foo<signed char> }), "Foo < signed char >");
+        assert_eq!(instantiation_key(quote! { Foo<char> }), "Foo < char >");
+        assert_eq!(instantiation_key(quote! { Foo<int, long> }), "Foo < int , long >");
+    }
+}
@@ -0,0 +1,176 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! Collection of spans in the Chrome trace event format, which can be viewed
+//! in `chrome://tracing` or https://ui.perfetto.dev. See
+//! https://docs.google.com/document/d/1CvAClvFfyA5R-PhYUmn5OOQtYMH4h6I0nSsKchNAySU
+//! for the format.
+
+use std::cell::Cell;
+use std::sync::atomic::{AtomicU64, Ordering};
+use std::sync::Mutex;
+use std::time::{Instant, SystemTime, UNIX_EPOCH};
+
+/// A "complete" (`"ph": "X"`) trace event.
+struct Event {
+    name: String,
+    category: &'static str,
+    start_micros: u64,
+    duration_micros: u64,
+    thread_id: u64,
+}
+
+/// Spans recorded for a Chrome trace.
+///
+/// `ChromeTrace::default()` is disabled: it ignores the spans, without
+/// computing their names. `ChromeTrace::new()` records them.
+///
+/// Timestamps are in microseconds since the Unix epoch, so that the events can
+/// be merged with events recorded by other code in the same process (e.g. by
+/// the C++ `ChromeTrace` of `rs_bindings_from_cc`).
+#[derive(Default)]
+pub struct ChromeTrace {
+    events: Option<Mutex<Vec<Event>>>,
+}
+
+impl ChromeTrace {
+    /// Returns a trace that records spans.
+    pub fn new() -> Self {
+        Self { events: Some(Mutex::new(vec![])) }
+    }
+
+    pub fn is_enabled(&self) -> bool {
+        self.events.is_some()
+    }
+
+    /// Returns a span named `name()` that ends when it is dropped. `name` is
+    /// only called if the trace is enabled.
+    pub fn span(&self, category: &'static str, name: impl FnOnce() -> String) -> Span<'_> {
+        Span {
+            trace: self,
+            started: self.is_enabled().then(|| (name(), SystemTime::now(), Instant::now())),
+            category,
+        }
+    }
+
+    /// Returns the recorded events, as a JSON array of trace events.
+    pub fn to_json_events(&self) -> serde_json::Value {
+        let Some(events) = &self.events else {
+            return serde_json::json!([]);
+        };
+        let pid = std::process::id();
+        events
+            .lock()
+            .unwrap()
+            .iter()
+            .map(|event| {
+                serde_json::json!({
+                    "name": event.name,
+                    "cat": event.category,
+                    "ph": "X",
+                    "ts": event.start_micros,
+                    "dur": event.duration_micros,
+                    "pid": pid,
+                    "tid": event.thread_id,
+                })
+            })
+            .collect()
+    }
+
+    /// Returns the trace as a JSON object, as written to a trace file.
+    pub fn to_json(&self) -> serde_json::Value {
+        serde_json::json!({"traceEvents": self.to_json_events(), "displayTimeUnit": "ms"})
+    }
+}
+
+/// A span of a `ChromeTrace`, recorded when it is dropped.
+pub struct Span<'a> {
+    trace: &'a ChromeTrace,
+    /// The name and start time of the span, if the trace is enabled.
+    started: Option<(String, SystemTime, Instant)>,
+    category: &'static str,
+}
+
+impl Drop for Span<'_> {
+    fn drop(&mut self) {
+        let (Some(events), Some((name, start_time, start))) =
+            (&self.trace.events, self.started.take())
+        else {
+            return;
+        };
+        let event = Event {
+            name,
+            category: self.category,
+            start_micros: start_time.duration_since(UNIX_EPOCH).unwrap_or_default().as_micros()
+                as u64,
+            duration_micros: start.elapsed().as_micros() as u64,
+            thread_id: current_thread_id(),
+        };
+        events.lock().unwrap().push(event);
+    }
+}
+
+/// Returns a small number identifying the current thread in the trace.
+fn current_thread_id() -> u64 {
+    static NEXT_THREAD_ID: AtomicU64 = AtomicU64::new(1);
+    thread_local! {
+        static THREAD_ID: Cell<u64> = Cell::new(0);
+    }
+    THREAD_ID.with(|thread_id| {
+        if thread_id.get() == 0 {
+            thread_id.set(NEXT_THREAD_ID.fetch_add(1, Ordering::Relaxed));
+        }
+        thread_id.get()
+    })
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    #[test]
+    fn test_disabled_trace_ignores_spans() {
+        let trace = ChromeTrace::default();
+        {
+            let _span = trace.span("test", || panic!("The name shouldn't be computed"));
+        }
+        assert_eq!(trace.to_json_events(), serde_json::json!([]));
+    }
+
+    #[test]
+    fn test_enabled_trace_records_nested_spans() {
+        let trace = ChromeTrace::new();
+        {
+            let _outer = trace.span("test", || "outer".to_string());
+            let _inner = trace.span("test", || "inner".to_string());
+        }
+        let events = trace.to_json_events();
+        let events = events.as_array().unwrap();
+        assert_eq!(events.len(), 2);
+        // Spans are recorded when they end.
+        assert_eq!(events[0]["name"], "inner");
+        assert_eq!(events[1]["name"], "outer");
+        for event in events {
+            assert_eq!(event["ph"], "X");
+            assert_eq!(event["cat"], "test");
+        }
+        assert!(events[1]["ts"].as_u64().unwrap() <= events[0]["ts"].as_u64().unwrap());
+        assert_eq!(events[0]["tid"], events[1]["tid"]);
+    }
+
+    #[test]
+    fn test_threads_have_distinct_ids() {
+        let trace = ChromeTrace::new();
+        {
+            let _span = trace.span("test", || "main".to_string());
+        }
+        std::thread::scope(|scope| {
+            scope.spawn(|| {
+                let _span = trace.span("test", || "worker".to_string());
+            });
+        });
+        let events = trace.to_json_events();
+        assert_ne!(events[0]["tid"], events[1]["tid"]);
+    }
+}
@@ -119,6 +119,11 @@ impl NamespaceQualifier {
         Self(iter.into_iter().map(Into::into).collect())
     }
 
+    /// Returns the names in the qualifier (e.g. `["foo", "bar", "baz"]`).
+    pub fn parts(&self) -> impl Iterator<Item = &str> + '_ {
+        self.0.iter().map(|part| &**part)
+    }
+
     /// Returns `foo::bar::baz::` (escaping Rust keywords as needed).
     pub fn format_for_rs(&self) -> TokenStream {
         let namespace_rs_idents = self.0.iter().map(|ns| make_rs_ident(ns));
@@ -608,6 +613,12 @@ pub mod tests {
         assert_cc_matches!(actual_cc, quote! { foo::bar:: });
     }
 
+    #[test]
+    fn test_namespace_qualifier_parts() {
+        let ns = NamespaceQualifier::new(["foo", "bar"]);
+        assert_eq!(vec!["foo", "bar"], ns.parts().collect::<Vec<_>>());
+    }
+
     #[test]
     fn test_namespace_qualifier_reserved_cc_keyword() {
         let ns = NamespaceQualifier::new(["foo", "impl", "bar"]);
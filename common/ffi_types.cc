@@ -4,10 +4,16 @@
 
 #include "common/ffi_types.h"
 
+#include <string>
+
 #include "absl/strings/string_view.h"
 
 namespace crubit {
 
+static void AppendToString(void* string, FfiU8Slice bytes) {
+  static_cast<std::string*>(string)->append(bytes.ptr, bytes.size);
+}
+
 FfiU8Slice MakeFfiU8Slice(absl::string_view s) {
   FfiU8Slice result;
   result.ptr = s.data();
@@ -19,4 +25,11 @@ absl::string_view StringViewFromFfiU8Slice(FfiU8Slice ffi_u8_slice) {
   return absl::string_view(ffi_u8_slice.ptr, ffi_u8_slice.size);
 }
 
+FfiStringBuffer MakeFfiStringBuffer(std::string& s) {
+  FfiStringBuffer result;
+  result.string = &s;
+  result.append = AppendToString;
+  return result;
+}
+
 }  // namespace crubit
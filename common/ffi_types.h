@@ -6,6 +6,7 @@
 #define CRUBIT_COMMON_FFI_TYPES_H_
 
 #include <cstddef>
+#include <string>
 
 #include "absl/strings/string_view.h"
 
@@ -24,12 +25,23 @@ struct FfiU8Slice {
   size_t size;
 };
 
+// Growable, C++-owned byte array, which Rust appends to through
+// `append(string, bytes)`. Lets Rust hand its outputs over to C++ without
+// allocating them in Rust first.
+struct FfiStringBuffer {
+  void* string;
+  void (*append)(void* string, FfiU8Slice bytes);
+};
+
 // Returns an `FfiU8Slice` referencing the same data as `s`.
 FfiU8Slice MakeFfiU8Slice(absl::string_view s);
 
 // Returns a `string_view` referencing the same data as `ffi_u8_slice`.
 absl::string_view StringViewFromFfiU8Slice(FfiU8Slice ffi_u8_slice);
 
+// Returns an `FfiStringBuffer` that appends to `s`, which must outlive it.
+FfiStringBuffer MakeFfiStringBuffer(std::string& s);
+
 // Returns an `FfiU8SliceBox` containing a copy of the data in `ffi_u8_slice`.
 // The returned `FfiU8SliceBox` must be freed by calling `FreeFfiU8SliceBox()`.
 // Implemented in Rust.
@@ -46,6 +58,27 @@ enum SourceLocationDocComment {
   Enabled,
 };
 
+// How the generated source code is formatted.
+enum FormatMode {
+  // Printed straight from the token stream.
+  Raw,
+  // Printed from the token stream with line breaks and indentation.
+  Fast,
+  // Formatted by rustfmt and clang-format.
+  Full,
+};
+
+// How the generated bindings assert that the Rust and C++ layouts of records
+// match.
+enum LayoutAssertions {
+  // A separate assertion for the size and alignment of each record and the
+  // offset of each of its fields.
+  PerItem,
+  // A single assertion over a table of all of the above, in `rs_api.rs` and
+  // in `rs_api_impl.cc` each.
+  Consolidated,
+};
+
 }  // namespace crubit
 
 #endif  // CRUBIT_COMMON_FFI_TYPES_H_
@@ -3,6 +3,8 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 use std::boxed::Box;
+use std::ffi::c_void;
+use std::io;
 use std::panic::catch_unwind;
 use std::process;
 use std::slice;
@@ -91,6 +93,36 @@ impl FfiU8SliceBox {
     }
 }
 
+/// Growable, C++-owned byte array (see `ffi_types.h`), which Rust appends to
+/// instead of returning an `FfiU8SliceBox`.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct FfiStringBuffer {
+    string: *mut c_void,
+    append: unsafe extern "C" fn(string: *mut c_void, bytes: FfiU8Slice),
+}
+
+impl FfiStringBuffer {
+    /// Appends `bytes` to the buffer.
+    pub fn append(&mut self, bytes: &[u8]) {
+        // Safety:
+        // Instances of `FfiStringBuffer` are only created by FFI functions, which are unsafe
+        // themselves so it's their responsibility to maintain safety.
+        unsafe { (self.append)(self.string, FfiU8Slice::from_slice(bytes)) }
+    }
+}
+
+impl io::Write for FfiStringBuffer {
+    fn write(&mut self, buf: &[u8]) -> io::Result<usize> {
+        self.append(buf);
+        Ok(buf.len())
+    }
+
+    fn flush(&mut self) -> io::Result<()> {
+        Ok(())
+    }
+}
+
 /// Whether or not the generated binding will have doc comments indicating their
 /// source location.
 #[repr(C)]
@@ -100,6 +132,32 @@ pub enum SourceLocationDocComment {
     Enabled,
 }
 
+/// How the generated source code is formatted.
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq, Eq, Hash, PartialOrd, Ord)]
+pub enum FormatMode {
+    /// Printed straight from the token stream.
+    Raw,
+    /// Printed from the token stream with line breaks and indentation (see
+    /// `token_stream_printer::tokens_to_indented_string`).
+    Fast,
+    /// Formatted by `rustfmt` and `clang-format`.
+    Full,
+}
+
+/// How the generated bindings assert that the Rust and C++ layouts of records
+/// match.
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq, Eq, Hash, PartialOrd, Ord)]
+pub enum LayoutAssertions {
+    /// A separate assertion for the size and alignment of each record and the
+    /// offset of each of its fields.
+    PerItem,
+    /// A single assertion over a table of all of the above, in `rs_api.rs` and
+    /// in `rs_api_impl.cc` each.
+    Consolidated,
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -110,4 +168,20 @@ mod tests {
         let ffi_slice = FfiU8SliceBox::from_boxed_slice(slice.clone());
         assert_eq!(ffi_slice.into_boxed_slice(), slice);
     }
+
+    unsafe extern "C" fn append_to_vec(vec: *mut c_void, bytes: FfiU8Slice) {
+        (*(vec as *mut Vec<u8>)).extend_from_slice(bytes.as_slice());
+    }
+
+    #[test]
+    fn test_ffi_string_buffer() {
+        let mut vec = Vec::<u8>::new();
+        let mut buffer = FfiStringBuffer {
+            string: &mut vec as *mut Vec<u8> as *mut c_void,
+            append: append_to_vec,
+        };
+        buffer.append(b"Hello");
+        io::Write::write_all(&mut buffer, b" World!").unwrap();
+        assert_eq!(vec, b"Hello World!");
+    }
 }
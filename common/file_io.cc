@@ -4,14 +4,19 @@
 
 #include "common/file_io.h"
 
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <system_error>
+#include <vector>
 
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/FileSystem.h"
 #include "llvm/Support/MemoryBuffer.h"
 #include "llvm/Support/raw_ostream.h"
 
@@ -42,4 +47,52 @@ absl::Status SetFileContents(absl::string_view path,
   return absl::OkStatus();
 }
 
+// Returns whether the file at `path` has the given `contents`. The file is
+// compared chunk by chunk, so that large files are never read into memory as a
+// whole.
+static bool HasFileContents(absl::string_view path,
+                            absl::string_view contents) {
+  llvm::StringRef path_ref(path.data(), path.size());
+  // Any error reading the existing file (e.g. because it doesn't exist) just
+  // means that it needs to be written.
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(path_ref, status) ||
+      status.getSize() != contents.size()) {
+    return false;
+  }
+  llvm::Expected<llvm::sys::fs::file_t> file =
+      llvm::sys::fs::openNativeFileForRead(path_ref);
+  if (!file) {
+    llvm::consumeError(file.takeError());
+    return false;
+  }
+
+  constexpr size_t kChunkSize = 64 * 1024;
+  std::vector<char> chunk(kChunkSize);
+  bool same_contents = true;
+  while (same_contents && !contents.empty()) {
+    llvm::Expected<size_t> bytes_read =
+        llvm::sys::fs::readNativeFile(*file, chunk);
+    if (!bytes_read) {
+      llvm::consumeError(bytes_read.takeError());
+      same_contents = false;
+    } else if (*bytes_read == 0 || *bytes_read > contents.size()) {
+      // The file changed size while it was being read.
+      same_contents = false;
+    } else {
+      same_contents = absl::string_view(chunk.data(), *bytes_read) ==
+                      contents.substr(0, *bytes_read);
+      contents.remove_prefix(*bytes_read);
+    }
+  }
+  llvm::sys::fs::closeFile(*file);
+  return same_contents;
+}
+
+absl::Status SetFileContentsIfChanged(absl::string_view path,
+                                      absl::string_view contents) {
+  if (HasFileContents(path, contents)) return absl::OkStatus();
+  return SetFileContents(path, contents);
+}
+
 }  // namespace crubit
@@ -18,6 +18,11 @@ absl::StatusOr<std::string> GetFileContents(absl::string_view path);
 absl::Status SetFileContents(absl::string_view path,
                              absl::string_view contents);
 
+// Like `SetFileContents`, but leaves the file untouched (keeping its
+// modification time) if it already has the given `contents`.
+absl::Status SetFileContentsIfChanged(absl::string_view path,
+                                      absl::string_view contents);
+
 }  // namespace crubit
 
 #endif  // CRUBIT_COMMON_FILE_IO_H_
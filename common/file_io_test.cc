@@ -0,0 +1,92 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "common/file_io.h"
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "common/status_test_matchers.h"
+#include "common/test_utils.h"
+#include "llvm/Support/Chrono.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Process.h"
+
+namespace crubit {
+namespace {
+
+// A modification time that no file written by a test has.
+const llvm::sys::TimePoint<> kOldTime =
+    llvm::sys::TimePoint<>(std::chrono::hours(24 * 365));
+
+// Sets the modification time of the file at `path` to `kOldTime`, so that the
+// test can tell whether the file is written again.
+void SetOldModificationTime(const std::string& path) {
+  int fd;
+  ASSERT_FALSE(llvm::sys::fs::openFileForWrite(path, fd,
+                                               llvm::sys::fs::CD_OpenExisting,
+                                               llvm::sys::fs::OF_Append));
+  ASSERT_FALSE(llvm::sys::fs::setLastAccessAndModificationTime(fd, kOldTime));
+  ASSERT_FALSE(llvm::sys::Process::SafelyCloseFileDescriptor(fd));
+}
+
+bool HasOldModificationTime(const std::string& path) {
+  llvm::sys::fs::file_status status;
+  if (llvm::sys::fs::status(path, status)) return false;
+  return status.getLastModificationTime() == kOldTime;
+}
+
+// Returns contents spanning several of the chunks that
+// `SetFileContentsIfChanged` compares at a time.
+std::string LargeContents() {
+  std::string contents;
+  for (size_t i = 0; contents.size() < 200 * 1024; ++i) {
+    contents += std::to_string(i);
+    contents += '\n';
+  }
+  return contents;
+}
+
+TEST(FileIoTest, SetFileContentsIfChangedKeepsIdenticalFile) {
+  std::string contents = LargeContents();
+  std::string path = WriteFileForCurrentTest("file.txt", contents);
+  SetOldModificationTime(path);
+
+  ASSERT_OK(SetFileContentsIfChanged(path, contents));
+
+  EXPECT_TRUE(HasOldModificationTime(path));
+  EXPECT_THAT(GetFileContents(path), IsOkAndHolds(contents));
+}
+
+TEST(FileIoTest, SetFileContentsIfChangedWritesDifferenceInLaterChunk) {
+  std::string contents = LargeContents();
+  std::string path = WriteFileForCurrentTest("file.txt", contents);
+  SetOldModificationTime(path);
+
+  // Same size, and the same first chunk.
+  contents[contents.size() - 2] = 'x';
+  ASSERT_OK(SetFileContentsIfChanged(path, contents));
+
+  EXPECT_FALSE(HasOldModificationTime(path));
+  EXPECT_THAT(GetFileContents(path), IsOkAndHolds(contents));
+}
+
+TEST(FileIoTest, SetFileContentsIfChangedWritesDifferentSize) {
+  std::string contents = LargeContents();
+  std::string path = WriteFileForCurrentTest("file.txt", contents);
+  SetOldModificationTime(path);
+
+  // A prefix of the existing contents.
+  contents.resize(contents.size() / 2);
+  ASSERT_OK(SetFileContentsIfChanged(path, contents));
+
+  EXPECT_FALSE(HasOldModificationTime(path));
+  EXPECT_THAT(GetFileContents(path), IsOkAndHolds(contents));
+}
+
+}  // namespace
+}  // namespace crubit
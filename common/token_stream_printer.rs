@@ -3,9 +3,10 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 use anyhow::{bail, Result};
-use proc_macro2::{Delimiter, TokenStream, TokenTree};
+use proc_macro2::{Delimiter, Spacing, TokenStream, TokenTree};
 use std::ffi::{OsStr, OsString};
 use std::io::Write as _;
+use std::iter;
 use std::path::{Path, PathBuf};
 use std::process::{Command, Stdio};
 
@@ -175,6 +176,212 @@ fn tokens_to_string(tokens: TokenStream) -> Result<String> {
     Ok(result)
 }
 
+/// Like `tokens_to_string`, but also breaks lines and indents the contents of
+/// `{ }` blocks by `indent_width` spaces per level, so that the output is
+/// readable without running `rustfmt` or `clang-format`.
+///
+/// Lines are broken after `;`, after attributes, around the contents of `{ }`
+/// blocks, and after `,` outside of `( )`, `[ ]`, and generic arguments.  At
+/// most one empty line is kept in a row.  The output only depends on `tokens`.
+pub fn tokens_to_indented_string(tokens: TokenStream, indent_width: usize) -> Result<String> {
+    let mut printer = IndentingPrinter::new(indent_width);
+    printer.write_tokens(tokens, /* break_lines= */ true)?;
+    printer.line_break();
+    Ok(printer.result)
+}
+
+/// Operators that `tokens_to_indented_string` surrounds with spaces.
+const SPACED_OPERATORS: &[&str] =
+    &["=", "==", "!=", "<=", ">=", "+=", "-=", "*=", "/=", "|=", "&=", "=>", "->"];
+
+/// What `IndentingPrinter` should do before printing the next token.
+#[derive(Clone, Copy, PartialEq, Eq)]
+enum Separator {
+    Nothing,
+    Space,
+    /// Break the line, unless the next token continues the expression or
+    /// statement that ended with a `}` (e.g. `;`, `,`, or `else`).
+    LineBreakAfterBlock,
+    LineBreak,
+}
+
+struct IndentingPrinter {
+    result: String,
+    indent_width: usize,
+    depth: usize,
+    /// Number of `\n` at the end of `result`.  Starts at 2, so that leading
+    /// newlines are dropped.
+    trailing_newlines: usize,
+    separator: Separator,
+    /// Whether the last printed token was an identifier or a literal.
+    after_word: bool,
+}
+
+impl IndentingPrinter {
+    fn new(indent_width: usize) -> Self {
+        Self {
+            result: String::new(),
+            indent_width,
+            depth: 0,
+            trailing_newlines: 2,
+            separator: Separator::Nothing,
+            after_word: false,
+        }
+    }
+
+    /// Ends the current line, if it is not empty.
+    fn line_break(&mut self) {
+        if self.trailing_newlines == 0 {
+            self.result.push('\n');
+            self.trailing_newlines = 1;
+        }
+        self.separator = Separator::Nothing;
+    }
+
+    /// Handles an explicit `__NEWLINE__`.
+    fn newline(&mut self) {
+        if self.trailing_newlines < 2 {
+            self.result.push('\n');
+            self.trailing_newlines += 1;
+        }
+        self.separator = Separator::Nothing;
+    }
+
+    fn write(&mut self, text: &str, is_word: bool) {
+        let mut space = match self.separator {
+            Separator::Nothing => false,
+            Separator::Space => true,
+            Separator::LineBreak => {
+                self.line_break();
+                false
+            }
+            Separator::LineBreakAfterBlock => {
+                if !matches!(text, "else" | "as")
+                    && !text.starts_with(&[',', ';', '.', '?', ')', ']'][..])
+                {
+                    self.line_break();
+                }
+                is_word
+            }
+        };
+        space |= self.after_word && is_word;
+        if self.trailing_newlines > 0 {
+            self.result.extend(iter::repeat(' ').take(self.depth * self.indent_width));
+            self.trailing_newlines = 0;
+        } else if space {
+            self.result.push(' ');
+        }
+        self.result.push_str(text);
+        self.separator = Separator::Nothing;
+        self.after_word = is_word;
+    }
+
+    fn write_tokens(&mut self, tokens: TokenStream, break_lines: bool) -> Result<()> {
+        let mut it = tokens.into_iter().peekable();
+        // Punctuation of a multi-character operator, like `->` or `::`.
+        let mut operator = String::new();
+        // Nesting depth of `< >`, so that `,` in generic arguments doesn't break
+        // lines.
+        let mut angle_depth = 0usize;
+        // Whether the last tokens were `#` or `#!`, starting an attribute.
+        let mut in_attribute = false;
+        while let Some(tt) = it.next() {
+            match tt {
+                TokenTree::Ident(ref tt) if tt == "__NEWLINE__" => self.newline(),
+                TokenTree::Ident(ref tt) if tt == "__SPACE__" => self.separator = Separator::Space,
+                TokenTree::Ident(ref tt) if tt == "__HASH_TOKEN__" => self.write("#", false),
+                TokenTree::Ident(ref tt) if tt == "__COMMENT__" => {
+                    if let Some(TokenTree::Literal(lit)) = it.next() {
+                        self.line_break();
+                        for line in lit.to_string().trim_matches('"').split("\\n") {
+                            self.write(&format!("// {line}"), false);
+                            self.line_break();
+                        }
+                    } else {
+                        bail!("__COMMENT__ must be followed by a literal")
+                    }
+                }
+                TokenTree::Group(ref tt) => {
+                    match tt.delimiter() {
+                        Delimiter::Brace if tt.stream().is_empty() => {
+                            self.separator = Separator::Space;
+                            self.write("{}", false);
+                        }
+                        Delimiter::Brace => {
+                            self.separator = Separator::Space;
+                            self.write("{", false);
+                            self.depth += 1;
+                            self.line_break();
+                            self.write_tokens(tt.stream(), /* break_lines= */ true)?;
+                            self.depth -= 1;
+                            self.line_break();
+                            self.write("}", false);
+                        }
+                        Delimiter::Parenthesis | Delimiter::Bracket => {
+                            let (open_delimiter, closed_delimiter) =
+                                if tt.delimiter() == Delimiter::Parenthesis {
+                                    ("(", ")")
+                                } else {
+                                    ("[", "]")
+                                };
+                            self.write(open_delimiter, false);
+                            self.write_tokens(tt.stream(), /* break_lines= */ false)?;
+                            self.write(closed_delimiter, false);
+                            // Separate a following word, as in `pub(crate) fn`.
+                            self.after_word = true;
+                        }
+                        Delimiter::None => self.write_tokens(tt.stream(), break_lines)?,
+                    }
+                    self.separator = if tt.delimiter() == Delimiter::Brace {
+                        Separator::LineBreakAfterBlock
+                    } else if in_attribute && tt.delimiter() == Delimiter::Bracket && break_lines {
+                        Separator::LineBreak
+                    } else {
+                        Separator::Nothing
+                    };
+                    in_attribute = false;
+                }
+                TokenTree::Punct(ref punct) => {
+                    operator.push(punct.as_char());
+                    if punct.spacing() == Spacing::Joint
+                        && matches!(it.peek(), Some(TokenTree::Punct(_)))
+                    {
+                        continue;
+                    }
+                    in_attribute = matches!(operator.as_str(), "#" | "#!")
+                        || (in_attribute && operator == "!");
+                    let is_spaced = SPACED_OPERATORS.contains(&operator.as_str());
+                    if is_spaced {
+                        self.separator = Separator::Space;
+                    }
+                    self.write(&operator, false);
+                    match operator.as_str() {
+                        "<" => angle_depth += 1,
+                        ">" => angle_depth = angle_depth.saturating_sub(1),
+                        ">>" => angle_depth = angle_depth.saturating_sub(2),
+                        _ => {}
+                    }
+                    // Separate a following word, as in `Vec<T> x`.
+                    self.after_word = operator.ends_with('>') && !is_spaced;
+                    self.separator = match operator.as_str() {
+                        ";" if break_lines => Separator::LineBreak,
+                        "," if break_lines && angle_depth == 0 => Separator::LineBreak,
+                        ";" | "," | ":" => Separator::Space,
+                        _ if is_spaced => Separator::Space,
+                        _ => Separator::Nothing,
+                    };
+                    operator.clear();
+                }
+                _ => {
+                    in_attribute = false;
+                    self.write(&tt.to_string(), true);
+                }
+            }
+        }
+        Ok(())
+    }
+}
+
 /// Returns true if token1 and token2 should have whitespace between them, and
 /// false if they should not.
 ///
@@ -466,4 +673,71 @@ void bar() {}
 }  // namespace ns"#
         );
     }
+
+    #[test]
+    fn test_indented_rs_tokens() -> Result<()> {
+        let token_stream = quote! {
+            #![no_std] __NEWLINE__ __NEWLINE__ __NEWLINE__
+            #[derive(Clone, Copy)]
+            pub struct S { pub a: i32, b: HashMap<K, Vec<V>>, }
+            impl S {
+                pub(crate) fn f(&self, x: i32) -> Option<&i32> {
+                    if x == 1 { return None; } else { g(|| { 1 }); }
+                    match x { 1 => a, _ => b, }
+                }
+            }
+        };
+        assert_eq!(
+            tokens_to_indented_string(token_stream, 4)?,
+            r#"#![no_std]
+
+#[derive(Clone, Copy)]
+pub struct S {
+    pub a: i32,
+    b: HashMap<K, Vec<V>>,
+}
+impl S {
+    pub(crate) fn f(&self, x: i32) -> Option<&i32> {
+        if x == 1 {
+            return None;
+        } else {
+            g(|| {
+                1
+            });
+        }
+        match x {
+            1 => a,
+            _ => b,
+        }
+    }
+}
+"#
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_indented_cc_tokens() -> Result<()> {
+        let token_stream = quote! {
+            __HASH_TOKEN__ include "a/b.h" __NEWLINE__ __NEWLINE__
+            __COMMENT__ "line 1\nline 2"
+            namespace ns { struct S final { int x; }; }
+            static_assert(sizeof(struct ns::S) == 4);
+        };
+        assert_eq!(
+            tokens_to_indented_string(token_stream, 2)?,
+            r#"#include "a/b.h"
+
+// line 1
+// line 2
+namespace ns {
+  struct S final {
+    int x;
+  };
+}
+static_assert(sizeof(struct ns::S) == 4);
+"#
+        );
+        Ok(())
+    }
 }
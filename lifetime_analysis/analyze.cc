@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <cassert>
+#include <chrono>
 #include <cstddef>
 #include <cstdint>
 #include <map>
@@ -32,12 +33,15 @@
 #include "lifetime_annotations/lifetime.h"
 #include "lifetime_annotations/lifetime_annotations.h"
 #include "lifetime_annotations/lifetime_substitutions.h"
+#include "lifetime_annotations/lifetime_summaries.h"
 #include "lifetime_annotations/type_lifetimes.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/Expr.h"
 #include "clang/AST/ExprCXX.h"
+#include "clang/AST/OperationKinds.h"
+#include "clang/AST/RecursiveASTVisitor.h"
 #include "clang/AST/Type.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
@@ -50,6 +54,7 @@
 #include "clang/Basic/DiagnosticIDs.h"
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Index/USRGeneration.h"
 #include "clang/Lex/Lexer.h"
 #include "llvm/ADT/ArrayRef.h"
@@ -64,8 +69,47 @@
 namespace clang {
 namespace tidy {
 namespace lifetimes {
+
+// The state of the analysis of a function, as captured for its
+// `FunctionDebugInfo`.
+struct FunctionDebugState {
+  // The human-readable representations, once `FunctionDebugInfo::Render()` has
+  // been called.
+  struct Rendered {
+    std::string ast;
+    std::string object_repository;
+    std::string points_to_map_dot;
+    std::string cfg_dot;
+    std::string constraints_dot;
+  };
+
+  // The definition of the function.
+  const clang::FunctionDecl* func = nullptr;
+  // Null if the function wasn't analyzed.
+  std::shared_ptr<const ObjectRepository> object_repository;
+  // The points-to map and constraints at the end of the function.
+  PointsToMap points_to_map;
+  LifetimeConstraints constraints;
+  // The CFG and the lattice at the end of each of its blocks, if the function
+  // body was analyzed.
+  std::shared_ptr<const clang::dataflow::ControlFlowContext> cfctx;
+  std::vector<std::optional<LifetimeLattice>> block_to_output_lattice;
+  std::optional<Rendered> rendered;
+};
+
 namespace {
 
+// Returns the state captured for the analysis of `func` in `debug_info`,
+// creating it if necessary.
+FunctionDebugState& GetDebugState(FunctionDebugInfo& debug_info,
+                                  const clang::FunctionDecl* func) {
+  if (!debug_info.state) {
+    debug_info.state = std::make_shared<FunctionDebugState>();
+  }
+  debug_info.state->func = func;
+  return *debug_info.state;
+}
+
 struct VisitedCallStackEntry {
   const clang::FunctionDecl* func;
   bool in_cycle;
@@ -77,6 +121,12 @@ using BaseToOverrides =
     llvm::DenseMap<const clang::CXXMethodDecl*,
                    llvm::SmallPtrSet<const clang::CXXMethodDecl*, 2>>;
 
+// A map from canonical function declarations to the result of `GetCallees()`
+// for them. Functions for which `GetCallees()` fails are not in the map.
+using CalleeMap =
+    llvm::DenseMap<const clang::FunctionDecl*,
+                   llvm::DenseSet<const clang::FunctionDecl*>>;
+
 // Enforce the invariant that an object of static lifetime should only point at
 // other objects of static lifetime.
 llvm::Error PropagateStaticToPointees(LifetimeSubstitutions& subst,
@@ -320,9 +370,7 @@ std::string CfgBlockLabel(const clang::CFGBlock* block, const clang::CFG& cfg,
 
 std::string CreateCfgDot(
     const clang::CFG& cfg, const clang::ASTContext& ast_context,
-    const std::vector<
-        std::optional<clang::dataflow::DataflowAnalysisState<LifetimeLattice>>>&
-        block_to_output_state,
+    const std::vector<std::optional<LifetimeLattice>>& block_to_output_lattice,
     const ObjectRepository& object_repository) {
   std::string result = "digraph d {\ncompound=true;\nedge [minlen=2];\n";
 
@@ -345,15 +393,14 @@ std::string CreateCfgDot(
         id);
     absl::StrAppend(&result, "}\n");
 
-    const auto& block_state = block_to_output_state[id];
-    if (block_state) {
-      auto lattice = block_state->Lattice;
-      if (!lattice.IsError()) {
+    const auto& lattice = block_to_output_lattice[id];
+    if (lattice) {
+      if (!lattice->IsError()) {
         absl::StrAppend(&result,
-                        PointsToEdgesDot(object_repository, lattice.PointsTo(),
+                        PointsToEdgesDot(object_repository, lattice->PointsTo(),
                                          absl::StrCat("B", id, "_")));
         absl::StrAppend(&result, ConstraintsEdgesDot(
-                                     object_repository, lattice.Constraints(),
+                                     object_repository, lattice->Constraints(),
                                      absl::StrCat("B", id, "_cstr_")));
       }
     }
@@ -413,7 +460,8 @@ llvm::Error ConstrainLifetimes(FunctionLifetimes& base,
 }
 
 struct FunctionAnalysis {
-  ObjectRepository object_repository;
+  // Shared with the `FunctionDebugState`, if any.
+  std::shared_ptr<ObjectRepository> object_repository;
   PointsToMap points_to_map;
   LifetimeConstraints constraints;
   LifetimeSubstitutions subst;
@@ -428,6 +476,42 @@ const CXXConstructorDecl* GetDefaultConstructor(const CXXRecordDecl* record) {
   return nullptr;
 }
 
+// A base class or field that the defaulted default constructor of a record
+// initializes by calling `ctor`.
+struct DefaultConstructedSubobject {
+  // Exactly one of `base` and `field` is non-null.
+  const CXXBaseSpecifier* base;
+  const clang::FieldDecl* field;
+  const clang::CXXConstructorDecl* ctor;
+};
+
+// Returns the base classes and fields of `record` that have a default
+// constructor, along with that constructor. These are the callees of the
+// defaulted default constructor of `record`.
+llvm::SmallVector<DefaultConstructedSubobject> GetDefaultConstructedSubobjects(
+    const clang::CXXRecordDecl* record) {
+  llvm::SmallVector<DefaultConstructedSubobject> subobjects;
+  for (const CXXBaseSpecifier& base : record->bases()) {
+    if (const clang::CXXRecordDecl* base_record =
+            base.getType()->getAsCXXRecordDecl()) {
+      if (const clang::CXXConstructorDecl* base_ctor =
+              GetDefaultConstructor(base_record)) {
+        subobjects.push_back({&base, nullptr, base_ctor});
+      }
+    }
+  }
+  for (const clang::FieldDecl* field : record->fields()) {
+    if (const clang::CXXRecordDecl* field_record =
+            field->getType()->getAsCXXRecordDecl()) {
+      if (const clang::CXXConstructorDecl* field_ctor =
+              GetDefaultConstructor(field_record)) {
+        subobjects.push_back({nullptr, field, field_ctor});
+      }
+    }
+  }
+  return subobjects;
+}
+
 llvm::Error TransferDefaultConstructor(
     const clang::CXXConstructorDecl* default_ctor, const Object* this_object,
     ObjectRepository& object_repository, PointsToMap& points_to_map,
@@ -477,35 +561,18 @@ llvm::Error AnalyzeDefaultedDefaultConstructor(
   }
   const Object* this_object = *this_object_maybe;
 
-  const clang::CXXRecordDecl* record = ctor->getParent();
-  for (const CXXBaseSpecifier& base : record->bases()) {
-    if (const clang::CXXRecordDecl* base_record =
-            base.getType()->getAsCXXRecordDecl()) {
-      if (const clang::CXXConstructorDecl* base_ctor =
-              GetDefaultConstructor(base_record)) {
-        const Object* base_this_object =
-            object_repository.GetBaseClassObject(this_object, base.getType());
-        if (llvm::Error err = TransferDefaultConstructor(
-                base_ctor, base_this_object, object_repository, points_to_map,
-                constraints, single_valued_objects, callee_lifetimes)) {
-          return err;
-        }
-      }
-    }
-  }
-  for (const clang::FieldDecl* field : record->fields()) {
-    if (const clang::CXXRecordDecl* field_record =
-            field->getType()->getAsCXXRecordDecl()) {
-      if (const clang::CXXConstructorDecl* field_ctor =
-              GetDefaultConstructor(field_record)) {
-        const Object* field_this_object =
-            object_repository.GetFieldObject(this_object, field);
-        if (llvm::Error err = TransferDefaultConstructor(
-                field_ctor, field_this_object, object_repository, points_to_map,
-                constraints, single_valued_objects, callee_lifetimes)) {
-          return err;
-        }
-      }
+  for (const DefaultConstructedSubobject& subobject :
+       GetDefaultConstructedSubobjects(ctor->getParent())) {
+    const Object* subobject_this_object =
+        subobject.base != nullptr
+            ? object_repository.GetBaseClassObject(this_object,
+                                                   subobject.base->getType())
+            : object_repository.GetFieldObject(this_object, subobject.field);
+    if (llvm::Error err = TransferDefaultConstructor(
+            subobject.ctor, subobject_this_object, object_repository,
+            points_to_map, constraints, single_valued_objects,
+            callee_lifetimes)) {
+      return err;
     }
   }
 
@@ -540,7 +607,7 @@ llvm::Error AnalyzeFunctionBody(
         callee_lifetimes,
     const DiagnosticReporter& diag_reporter,
     ObjectRepository& object_repository, PointsToMap& points_to_map,
-    LifetimeConstraints& constraints, std::string* cfg_dot) {
+    LifetimeConstraints& constraints, FunctionDebugInfo* debug_info) {
   auto cfctx = clang::dataflow::ControlFlowContext::build(*func);
   if (!cfctx) return cfctx.takeError();
 
@@ -551,15 +618,37 @@ llvm::Error AnalyzeFunctionBody(
   LifetimeAnalysis analysis(func, object_repository, callee_lifetimes,
                             diag_reporter);
 
+  auto start = std::chrono::steady_clock::now();
   llvm::Expected<std::vector<
       std::optional<clang::dataflow::DataflowAnalysisState<LifetimeLattice>>>>
       maybe_block_to_output_state =
           clang::dataflow::runDataflowAnalysis(*cfctx, analysis, environment);
+  if (debug_info) {
+    // Accumulate, as functions in a recursive cycle are analyzed repeatedly.
+    debug_info->dataflow_time += std::chrono::steady_clock::now() - start;
+    for (const clang::CFGBlock* block : cfctx->getCFG()) {
+      debug_info->num_cfg_elements += block->size();
+    }
+    debug_info->num_transfers += analysis.NumTransfers();
+  }
   if (!maybe_block_to_output_state) {
     return maybe_block_to_output_state.takeError();
   }
   auto& block_to_output_state = *maybe_block_to_output_state;
 
+  if (debug_info) {
+    for (const auto& block_state : block_to_output_state) {
+      if (!block_state || block_state->Lattice.IsError()) continue;
+      int64_t edges = 0;
+      for (const auto& [pointer, pointees] :
+           block_state->Lattice.PointsTo().PointerPointsTos()) {
+        edges += pointees.size();
+      }
+      debug_info->max_points_to_edges =
+          std::max(debug_info->max_points_to_edges, edges);
+    }
+  }
+
   const auto& exit_block_state =
       block_to_output_state[cfctx->getCFG().getExit().getBlockID()];
   if (!exit_block_state.has_value()) {
@@ -610,14 +699,150 @@ llvm::Error AnalyzeFunctionBody(
     }
   }
 
-  if (cfg_dot) {
-    *cfg_dot = CreateCfgDot(cfctx->getCFG(), func->getASTContext(),
-                            block_to_output_state, object_repository);
+  if (debug_info) {
+    std::vector<std::optional<LifetimeLattice>> block_to_output_lattice;
+    block_to_output_lattice.reserve(block_to_output_state.size());
+    for (const auto& block_state : block_to_output_state) {
+      block_to_output_lattice.push_back(
+          block_state ? std::optional(block_state->Lattice) : std::nullopt);
+    }
+    FunctionDebugState& state = GetDebugState(*debug_info, func);
+    state.block_to_output_lattice = std::move(block_to_output_lattice);
+    state.cfctx = std::make_shared<clang::dataflow::ControlFlowContext>(
+        std::move(*cfctx));
   }
 
   return llvm::Error::success();
 }
 
+// Returns whether values of `type` may contain pointers or references, i.e.
+// whether the analysis could ever attach a lifetime to them. Errs on the side
+// of returning true.
+bool MayContainPointers(
+    clang::QualType type,
+    llvm::SmallPtrSetImpl<const clang::CXXRecordDecl*>& visited_records) {
+  type = type.getCanonicalType();
+  if (type->isDependentType()) return true;
+  if (type->isBuiltinType() || type->isEnumeralType() ||
+      type->isFunctionType()) {
+    return false;
+  }
+  if (const clang::ArrayType* array = type->getAsArrayTypeUnsafe()) {
+    return MayContainPointers(array->getElementType(), visited_records);
+  }
+  if (const auto* record = type->getAsCXXRecordDecl()) {
+    if (!visited_records.insert(record).second) return false;
+    record = record->getDefinition();
+    if (record == nullptr || !record->isTrivial() ||
+        !GetLifetimeParameters(type).empty()) {
+      return true;
+    }
+    for (const clang::CXXBaseSpecifier& base : record->bases()) {
+      if (MayContainPointers(base.getType(), visited_records)) return true;
+    }
+    for (const clang::FieldDecl* field : record->fields()) {
+      if (MayContainPointers(field->getType(), visited_records)) return true;
+    }
+    return false;
+  }
+  // Pointers, references, and anything we don't know about.
+  return true;
+}
+
+// Looks for anything in a function that the analysis could attach a lifetime
+// to: values that may contain pointers, `this`, and calls that pass an implicit
+// object argument.
+class PointerFinder : public clang::RecursiveASTVisitor<PointerFinder> {
+ public:
+  bool shouldVisitImplicitCode() { return true; }
+
+  bool VisitExpr(clang::Expr* expr) {
+    // Errors in the function are reported by the full analysis.
+    if (expr->containsErrors()) return Found();
+    // Calls to functions whose signature has no pointers are fine; their
+    // arguments and results are visited separately.
+    if (const auto* cast = clang::dyn_cast<clang::ImplicitCastExpr>(expr);
+        cast && cast->getCastKind() == clang::CK_FunctionToPointerDecay) {
+      return true;
+    }
+    if (clang::isa<clang::CXXThisExpr>(expr)) return Found();
+    if (const auto* call = clang::dyn_cast<clang::CallExpr>(expr)) {
+      const auto* method =
+          clang::dyn_cast_or_null<clang::CXXMethodDecl>(call->getCalleeDecl());
+      if (method && !method->isStatic()) return Found();
+    }
+    if (const auto* construct = clang::dyn_cast<clang::CXXConstructExpr>(expr);
+        construct && !construct->getConstructor()->isTrivial()) {
+      return Found();
+    }
+    if (MayContainPointers(expr->getType(), visited_records_)) return Found();
+    return true;
+  }
+
+  bool VisitValueDecl(clang::ValueDecl* decl) {
+    if (MayContainPointers(decl->getType(), visited_records_)) return Found();
+    return true;
+  }
+
+  bool found() const { return found_; }
+
+ private:
+  // Returning false from a Visit method stops the traversal.
+  bool Found() {
+    found_ = true;
+    return false;
+  }
+
+  llvm::SmallPtrSet<const clang::CXXRecordDecl*, 4> visited_records_;
+  bool found_ = false;
+};
+
+// Returns whether neither the signature nor the body of `func` contain
+// anything that can have a lifetime. The lifetimes of such a function are
+// trivially empty, so we don't need to build an ObjectRepository or a CFG to
+// analyze it.
+bool IsPointerFree(const clang::FunctionDecl* func) {
+  if (const auto* method = clang::dyn_cast<clang::CXXMethodDecl>(func);
+      method && !method->isStatic()) {
+    return false;
+  }
+  func = func->getDefinition();
+  if (func == nullptr || func->isDefaulted() || !func->getBody()) {
+    return false;
+  }
+
+  PointerFinder finder;
+  llvm::SmallPtrSet<const clang::CXXRecordDecl*, 4> visited_records;
+  if (MayContainPointers(func->getReturnType(), visited_records)) return false;
+  finder.TraverseDecl(const_cast<clang::FunctionDecl*>(func));
+  return !finder.found();
+}
+
+// Returns the lifetimes of a function for which `IsPointerFree()` holds. As the
+// function's signature doesn't contain any lifetimes, this is simply the
+// structure of the signature.
+FunctionLifetimesOrError AnalyzePointerFreeFunction(
+    const clang::FunctionDecl* func, FunctionDebugInfoMap* debug_info) {
+  func = func->getDefinition();
+  if (debug_info) {
+    FunctionDebugInfo& info = (*debug_info)[func];
+    GetDebugState(info, func);
+    info.pointer_free_fast_path = true;
+  }
+
+  FunctionLifetimeFactorySingleCallback factory(
+      [func](const clang::Expr*) -> llvm::Expected<Lifetime> {
+        return llvm::createStringError(
+            llvm::inconvertibleErrorCode(),
+            absl::StrCat("Unexpected lifetime in the signature of '",
+                         func->getNameAsString(), "'"));
+      });
+  llvm::Expected<FunctionLifetimes> lifetimes =
+      FunctionLifetimes::CreateForDecl(func, factory);
+  if (!lifetimes) return FunctionAnalysisError(lifetimes.takeError());
+  return std::move(*lifetimes);
+}
+
 llvm::Expected<FunctionAnalysis> AnalyzeSingleFunction(
     const clang::FunctionDecl* func,
     const FunctionLifetimesMap& callee_lifetimes,
@@ -627,7 +852,9 @@ llvm::Expected<FunctionAnalysis> AnalyzeSingleFunction(
   if (auto err = object_repository.takeError()) {
     return std::move(err);
   }
-  FunctionAnalysis analysis{.object_repository = std::move(*object_repository)};
+  FunctionAnalysis analysis{.object_repository =
+                                std::make_shared<ObjectRepository>(
+                                    std::move(*object_repository))};
 
   const auto* cxxmethod = clang::dyn_cast<clang::CXXMethodDecl>(func);
   if (cxxmethod && cxxmethod->isPure()) {
@@ -653,18 +880,18 @@ llvm::Expected<FunctionAnalysis> AnalyzeSingleFunction(
     // Single-valued objects are only used during the analysis itself, so no
     // need to keep track of them past this point.
     ObjectSet single_valued_objects =
-        analysis.object_repository.InitialSingleValuedObjects();
+        analysis.object_repository->InitialSingleValuedObjects();
     if (llvm::Error err = AnalyzeDefaultedFunction(
-            func, callee_lifetimes, analysis.object_repository,
+            func, callee_lifetimes, *analysis.object_repository,
             analysis.points_to_map, analysis.constraints,
             single_valued_objects)) {
       return std::move(err);
     }
   } else if (func->getBody()) {
-    std::string* cfg_dot = debug_info ? &(*debug_info)[func].cfg_dot : nullptr;
     if (llvm::Error err = AnalyzeFunctionBody(
-            func, callee_lifetimes, diag_reporter, analysis.object_repository,
-            analysis.points_to_map, analysis.constraints, cfg_dot)) {
+            func, callee_lifetimes, diag_reporter, *analysis.object_repository,
+            analysis.points_to_map, analysis.constraints,
+            debug_info ? &(*debug_info)[func] : nullptr)) {
       return std::move(err);
     }
   } else {
@@ -673,17 +900,12 @@ llvm::Expected<FunctionAnalysis> AnalyzeSingleFunction(
   }
 
   if (debug_info) {
-    std::string ast;
-    llvm::raw_string_ostream os(ast);
-    func->dump(os);
-    os.flush();
-    (*debug_info)[func].ast = std::move(ast);
-    (*debug_info)[func].object_repository =
-        analysis.object_repository.DebugString();
-    (*debug_info)[func].points_to_map_dot =
-        PointsToGraphDot(analysis.object_repository, analysis.points_to_map);
-    (*debug_info)[func].constraints_dot =
-        ConstraintsDot(analysis.object_repository, analysis.constraints);
+    // Only capture the state of the analysis here; `FunctionDebugInfo` renders
+    // it on request.
+    FunctionDebugState& state = GetDebugState((*debug_info)[func], func);
+    state.object_repository = analysis.object_repository;
+    state.points_to_map = analysis.points_to_map;
+    state.constraints = analysis.constraints;
   }
 
   if (llvm::Error err =
@@ -754,12 +976,10 @@ llvm::Expected<FunctionLifetimes> ConstructFunctionLifetimes(
     }
   }
 
-  auto& [object_repository, points_to_map, constraints, subst] = analysis;
-
   FunctionLifetimes result;
 
-  result = object_repository.GetOriginalFunctionLifetimes();
-  if (llvm::Error err = constraints.ApplyToFunctionLifetimes(result)) {
+  result = analysis.object_repository->GetOriginalFunctionLifetimes();
+  if (llvm::Error err = analysis.constraints.ApplyToFunctionLifetimes(result)) {
     return std::move(err);
   }
 
@@ -779,24 +999,9 @@ GetDefaultedFunctionCallees(const clang::FunctionDecl* func) {
   if (const auto* ctor = clang::dyn_cast<clang::CXXConstructorDecl>(func)) {
     if (ctor->isDefaultConstructor()) {
       llvm::DenseSet<const clang::FunctionDecl*> callees;
-      const clang::CXXRecordDecl* record = ctor->getParent();
-      for (const CXXBaseSpecifier& base : record->bases()) {
-        if (const clang::CXXRecordDecl* base_record =
-                base.getType()->getAsCXXRecordDecl()) {
-          if (const clang::CXXConstructorDecl* base_ctor =
-                  GetDefaultConstructor(base_record)) {
-            callees.insert(base_ctor);
-          }
-        }
-      }
-      for (const clang::FieldDecl* field : record->fields()) {
-        if (const clang::CXXRecordDecl* field_record =
-                field->getType()->getAsCXXRecordDecl()) {
-          if (const clang::CXXConstructorDecl* field_ctor =
-                  GetDefaultConstructor(field_record)) {
-            callees.insert(field_ctor);
-          }
-        }
+      for (const DefaultConstructedSubobject& subobject :
+           GetDefaultConstructedSubobjects(ctor->getParent())) {
+        callees.insert(subobject.ctor);
       }
       return callees;
     }
@@ -924,9 +1129,14 @@ llvm::SmallVector<const clang::FunctionDecl*> GetAllFunctionDefinitions(
   return functions;
 }
 
-BaseToOverrides BuildBaseToOverrides(const clang::TranslationUnitDecl* tu) {
+// Builds a map from a base method to its overrides among `definitions`, the
+// function definitions of a TU. It will not find out all the overrides, but
+// still cover (and can partially update) all the base methods that the TU
+// implements.
+BaseToOverrides BuildBaseToOverrides(
+    llvm::ArrayRef<const clang::FunctionDecl*> definitions) {
   BaseToOverrides base_to_overrides;
-  for (const clang::FunctionDecl* f : GetAllFunctionDefinitions(tu)) {
+  for (const clang::FunctionDecl* f : definitions) {
     auto* func = clang::dyn_cast<clang::CXXMethodDecl>(f);
     if (!func) continue;
     func = func->getCanonicalDecl();
@@ -954,6 +1164,111 @@ void GetBaseMethods(const clang::CXXMethodDecl* cxxmethod,
   }
 }
 
+// Returns the strongly connected components of the graph of `funcs`, in which
+// a function has an edge to each function it calls, to its base methods, and
+// to its overrides in `base_to_overrides`. Base methods and overrides are
+// included because `AnalyzeFunctionRecursive()` traverses them too.
+//
+// The components are returned bottom-up: each component comes after all the
+// components it has edges to. Functions in a component keep their order in
+// `funcs`. `callee_map` is filled with the callees of `funcs`.
+std::vector<llvm::SmallVector<const clang::FunctionDecl*, 1>>
+GetBottomUpComponents(llvm::ArrayRef<const clang::FunctionDecl*> funcs,
+                      const BaseToOverrides& base_to_overrides,
+                      CalleeMap& callee_map) {
+  llvm::SmallVector<const clang::FunctionDecl*> nodes;
+  llvm::DenseMap<const clang::FunctionDecl*, unsigned> node_index;
+  for (const clang::FunctionDecl* func : funcs) {
+    func = func->getCanonicalDecl();
+    if (node_index.try_emplace(func, nodes.size()).second) {
+      nodes.push_back(func);
+    }
+  }
+
+  std::vector<llvm::SmallVector<unsigned>> successors(nodes.size());
+  for (unsigned i = 0; i < nodes.size(); ++i) {
+    const clang::FunctionDecl* func = nodes[i];
+    auto add_edge = [&](const clang::FunctionDecl* to) {
+      auto iter = node_index.find(to->getCanonicalDecl());
+      if (iter != node_index.end()) successors[i].push_back(iter->second);
+    };
+    auto maybe_callees = GetCallees(func);
+    if (maybe_callees) {
+      for (const clang::FunctionDecl* callee : *maybe_callees) {
+        add_edge(callee);
+      }
+      callee_map[func] = std::move(*maybe_callees);
+    } else {
+      // `AnalyzeFunctionRecursive()` will report the error.
+      llvm::consumeError(maybe_callees.takeError());
+    }
+    const auto* cxxmethod = clang::dyn_cast<clang::CXXMethodDecl>(func);
+    if (cxxmethod == nullptr || !cxxmethod->isVirtual()) continue;
+    llvm::DenseSet<const clang::CXXMethodDecl*> bases;
+    GetBaseMethods(cxxmethod, bases);
+    for (const auto* base : bases) add_edge(base);
+    auto iter = base_to_overrides.find(cxxmethod);
+    if (iter != base_to_overrides.end()) {
+      for (const auto* derived : iter->second) add_edge(derived);
+    }
+  }
+
+  // Tarjan's algorithm, with an explicit stack so that deep call chains don't
+  // overflow the native one.
+  constexpr unsigned kUnvisited = ~0u;
+  std::vector<unsigned> index(nodes.size(), kUnvisited);
+  std::vector<unsigned> lowlink(nodes.size());
+  std::vector<bool> on_stack(nodes.size());
+  std::vector<unsigned> stack;
+  // Pairs of a node and the index of the next of its successors to visit.
+  std::vector<std::pair<unsigned, unsigned>> work;
+  unsigned next_index = 0;
+  std::vector<llvm::SmallVector<const clang::FunctionDecl*, 1>> components;
+
+  auto visit = [&](unsigned node) {
+    index[node] = lowlink[node] = next_index++;
+    stack.push_back(node);
+    on_stack[node] = true;
+    work.push_back({node, 0});
+  };
+  for (unsigned root = 0; root < nodes.size(); ++root) {
+    if (index[root] != kUnvisited) continue;
+    visit(root);
+    while (!work.empty()) {
+      auto [node, next_successor] = work.back();
+      if (next_successor < successors[node].size()) {
+        ++work.back().second;
+        unsigned successor = successors[node][next_successor];
+        if (index[successor] == kUnvisited) {
+          visit(successor);
+        } else if (on_stack[successor]) {
+          lowlink[node] = std::min(lowlink[node], index[successor]);
+        }
+        continue;
+      }
+      work.pop_back();
+      if (!work.empty()) {
+        unsigned parent = work.back().first;
+        lowlink[parent] = std::min(lowlink[parent], lowlink[node]);
+      }
+      if (lowlink[node] != index[node]) continue;
+
+      llvm::SmallVector<unsigned, 1> members;
+      unsigned member;
+      do {
+        member = stack.back();
+        stack.pop_back();
+        on_stack[member] = false;
+        members.push_back(member);
+      } while (member != node);
+      std::sort(members.begin(), members.end());
+      auto& component = components.emplace_back();
+      for (unsigned m : members) component.push_back(nodes[m]);
+    }
+  }
+  return components;
+}
+
 std::optional<FunctionLifetimes> GetFunctionLifetimesFromAnalyzed(
     const clang::FunctionDecl* canonical_func,
     const llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
@@ -1085,6 +1400,17 @@ llvm::Error AnalyzeRecursiveFunctions(
   return llvm::Error::success();
 }
 
+// Returns whether a declaration of `func` has an explicit lifetime annotation
+// (rather than lifetimes that are only elided).
+bool HasLifetimeAnnotation(const clang::FunctionDecl* func) {
+  for (const clang::FunctionDecl* redecl : func->redecls()) {
+    for (const auto* attr : redecl->specific_attrs<clang::AnnotateAttr>()) {
+      if (attr->getAnnotation() == "lifetimes") return true;
+    }
+  }
+  return false;
+}
+
 // The entry point for analyzing a function named by `func`.
 //
 // This function is recursive as it searches for and walks through all CallExpr
@@ -1111,7 +1437,7 @@ void AnalyzeFunctionRecursive(
     const clang::FunctionDecl* func,
     const LifetimeAnnotationContext& lifetime_context,
     const DiagnosticReporter& diag_reporter, FunctionDebugInfoMap* debug_info,
-    const BaseToOverrides& base_to_overrides) {
+    const BaseToOverrides& base_to_overrides, const CalleeMap& callee_map) {
   // Make sure we're always using the canonical declaration when using the
   // function as a key in maps and sets.
   func = func->getCanonicalDecl();
@@ -1127,6 +1453,27 @@ void AnalyzeFunctionRecursive(
     return;
   }
 
+  if (!is_analyzed && lifetime_context.summaries != nullptr &&
+      !HasLifetimeAnnotation(func)) {
+    // Functions that this TU doesn't own may have been analyzed elsewhere.
+    // Lifetimes annotated in the source take precedence over inferred ones.
+    const clang::FunctionDecl* definition = func->getDefinition();
+    const clang::SourceManager& source_manager =
+        func->getASTContext().getSourceManager();
+    if (definition == nullptr ||
+        !source_manager.isInMainFile(definition->getLocation())) {
+      if (auto summary_lifetimes = lifetime_context.summaries->Lookup(func)) {
+        if (!*summary_lifetimes) {
+          analyzed[func] =
+              FunctionAnalysisError(summary_lifetimes->takeError());
+        } else {
+          analyzed[func] = std::move(**summary_lifetimes);
+        }
+        return;
+      }
+    }
+  }
+
   if (!func->isDefined() && !is_pure_virtual && !is_analyzed) {
     FunctionLifetimes annotations;
     if (llvm::Error err = GetLifetimeAnnotations(func, lifetime_context)
@@ -1168,9 +1515,11 @@ void AnalyzeFunctionRecursive(
     return;
   }
 
-  auto maybe_callees = GetCallees(func);
-  if (!maybe_callees) {
-    analyzed[func] = FunctionAnalysisError(maybe_callees.takeError());
+  llvm::DenseSet<const clang::FunctionDecl*> callees;
+  if (auto iter = callee_map.find(func); iter != callee_map.end()) {
+    callees = iter->second;
+  } else if (llvm::Error err = GetCallees(func).moveInto(callees)) {
+    analyzed[func] = FunctionAnalysisError(err);
     return;
   }
 
@@ -1183,12 +1532,13 @@ void AnalyzeFunctionRecursive(
   visited.emplace_back(VisitedCallStackEntry{
       .func = func, .in_cycle = false, .in_overrides_traversal = false});
 
-  for (auto& callee : maybe_callees.get()) {
+  for (auto& callee : callees) {
     if (analyzed.count(callee)) {
       continue;
     }
     AnalyzeFunctionRecursive(analyzed, visited, callee, lifetime_context,
-                             diag_reporter, debug_info, base_to_overrides);
+                             diag_reporter, debug_info, base_to_overrides,
+                             callee_map);
   }
 
   llvm::DenseSet<const clang::CXXMethodDecl*> bases;
@@ -1206,7 +1556,8 @@ void AnalyzeFunctionRecursive(
       GetBaseMethods(cxxmethod, bases);
       for (const auto* base : bases) {
         AnalyzeFunctionRecursive(analyzed, visited, base, lifetime_context,
-                                 diag_reporter, debug_info, base_to_overrides);
+                                 diag_reporter, debug_info, base_to_overrides,
+                                 callee_map);
       }
     } else {
       // We are in an overrides traversal for a virtual method starting from its
@@ -1218,8 +1569,8 @@ void AnalyzeFunctionRecursive(
         overrides = iter->second;
         for (const auto* derived : overrides) {
           AnalyzeFunctionRecursive(analyzed, visited, derived, lifetime_context,
-                                   diag_reporter, debug_info,
-                                   base_to_overrides);
+                                   diag_reporter, debug_info, base_to_overrides,
+                                   callee_map);
         }
       }
     }
@@ -1260,9 +1611,11 @@ void AnalyzeFunctionRecursive(
     if (bases.empty()) {
       // This function is not where we initiated an overrides traversal from its
       // base methods.
-      auto analysis_result =
-          AnalyzeSingleFunction(func, analyzed, diag_reporter, debug_info);
-      if (!analysis_result) {
+      if (IsPointerFree(func)) {
+        analyzed[func] = AnalyzePointerFreeFunction(func, debug_info);
+      } else if (auto analysis_result = AnalyzeSingleFunction(
+                     func, analyzed, diag_reporter, debug_info);
+                 !analysis_result) {
         analyzed[func] = FunctionAnalysisError(analysis_result.takeError());
       } else {
         auto func_lifetimes_result = ConstructFunctionLifetimes(
@@ -1309,18 +1662,51 @@ void AnalyzeFunctionRecursive(
   visited.resize(func_in_visited);
 }
 
+// Analyzes `funcs` one strongly connected component of the call graph at a
+// time, callees first.
+//
+// Each function is still analyzed by `AnalyzeFunctionRecursive()`, but by the
+// time it is entered, everything it calls outside its own recursive cycle has
+// been analyzed, so the recursion stays shallow. The callees of each function
+// are also only computed once.
+void AnalyzeFunctionsBottomUp(
+    llvm::ArrayRef<const clang::FunctionDecl*> funcs,
+    llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
+        analyzed,
+    const LifetimeAnnotationContext& lifetime_context,
+    const DiagnosticReporter& diag_reporter, FunctionDebugInfoMap* debug_info,
+    const BaseToOverrides& base_to_overrides) {
+  CalleeMap callee_map;
+  llvm::SmallVector<VisitedCallStackEntry> visited;
+  for (const auto& component :
+       GetBottomUpComponents(funcs, base_to_overrides, callee_map)) {
+    // Entering the first function of a recursive cycle usually analyzes the
+    // whole cycle, in which case entering the rest is a no-op.
+    for (const clang::FunctionDecl* func : component) {
+      AnalyzeFunctionRecursive(analyzed, visited, func, lifetime_context,
+                               diag_reporter, debug_info, base_to_overrides,
+                               callee_map);
+    }
+  }
+}
+
 llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
 AnalyzeTranslationUnitAndCollectTemplates(
     const clang::TranslationUnitDecl* tu,
     const LifetimeAnnotationContext& lifetime_context,
     const DiagnosticReporter& diag_reporter, FunctionDebugInfoMap* debug_info,
     llvm::DenseMap<clang::FunctionTemplateDecl*, const clang::FunctionDecl*>&
-        uninstantiated_templates,
-    const BaseToOverrides& base_to_overrides) {
+        uninstantiated_templates) {
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError> result;
-  llvm::SmallVector<VisitedCallStackEntry> visited;
+  llvm::SmallVector<const clang::FunctionDecl*> funcs;
 
-  for (const clang::FunctionDecl* func : GetAllFunctionDefinitions(tu)) {
+  // Walking the TU is expensive for TUs that include large headers, so the
+  // overrides are found among the same definitions as the functions to analyze.
+  llvm::SmallVector<const clang::FunctionDecl*> definitions =
+      GetAllFunctionDefinitions(tu);
+  BaseToOverrides base_to_overrides = BuildBaseToOverrides(definitions);
+
+  for (const clang::FunctionDecl* func : definitions) {
     // Skip templated functions.
     if (func->isTemplated()) {
       clang::FunctionTemplateDecl* template_decl =
@@ -1340,13 +1726,12 @@ AnalyzeTranslationUnitAndCollectTemplates(
     // returning two matches for every function definition; maybe there are two
     // different paths from a TranslationUnitDecl to a function definition.
     // This doesn't really have any ill effect, however, as
-    // AnalyzeFunctionRecursive() bails out anyway if it has analyzed the
-    // function before.
-
-    AnalyzeFunctionRecursive(result, visited, func, lifetime_context,
-                             diag_reporter, debug_info, base_to_overrides);
+    // GetBottomUpComponents() only keeps the first of them.
+    funcs.push_back(func);
   }
 
+  AnalyzeFunctionsBottomUp(funcs, result, lifetime_context, diag_reporter,
+                           debug_info, base_to_overrides);
   return result;
 }
 
@@ -1361,9 +1746,24 @@ std::string GetFunctionUSRString(const clang::Decl* func) {
   return std::string(usr.data(), usr.size());
 }
 
-// Run AnalyzeFunctionRecursive with `context`. Report results through
-// `result_callback` and update `debug_info` using USR strings to map functions
-// to the original ASTContext.
+// If `func` instantiates one of the templates in `template_usr_to_decl`,
+// returns the templated function in the original ASTContext that it
+// corresponds to. Otherwise, returns null.
+const clang::FunctionDecl* GetOriginalTemplatedFunction(
+    const clang::FunctionDecl* func,
+    const std::map<std::string, const clang::FunctionDecl*>&
+        template_usr_to_decl) {
+  if (!func->isFunctionTemplateSpecialization()) return nullptr;
+  auto* tmpl = func->getTemplateSpecializationInfo()->getTemplate();
+  auto iter = template_usr_to_decl.find(GetFunctionUSRString(tmpl));
+  if (iter == template_usr_to_decl.end()) return nullptr;
+  return iter->second;
+}
+
+// Run AnalyzeFunctionRecursive with `context` on the placeholder
+// instantiations of the templates in `template_usr_to_decl`. Report their
+// results, and those in `initial_result`, through `result_callback` and update
+// `debug_info` using USR strings to map functions to the original ASTContext.
 void AnalyzeTemplateFunctionsInSeparateASTContext(
     const LifetimeAnnotationContext& lifetime_context,
     const llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
@@ -1372,21 +1772,29 @@ void AnalyzeTemplateFunctionsInSeparateASTContext(
     const DiagnosticReporter& diag_reporter, FunctionDebugInfoMap* debug_info,
     const std::map<std::string, const clang::FunctionDecl*>&
         template_usr_to_decl,
-    const BaseToOverrides& base_to_overrides, clang::ASTContext& context) {
+    clang::ASTContext& context) {
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
       inner_result;
-  llvm::SmallVector<VisitedCallStackEntry> inner_visited;
+  llvm::SmallVector<const clang::FunctionDecl*> funcs;
   FunctionDebugInfoMap inner_debug_info;
 
   for (const clang::FunctionDecl* func :
        GetAllFunctionDefinitions(context.getTranslationUnitDecl())) {
     // Skip templated functions.
     if (func->isTemplated()) continue;
-
-    AnalyzeFunctionRecursive(inner_result, inner_visited, func,
-                             lifetime_context, diag_reporter, &inner_debug_info,
-                             base_to_overrides);
+    // Everything else in this context is a copy of a function that already has
+    // a result in `initial_result`. Only the instantiations need to be
+    // analyzed; AnalyzeFunctionRecursive() analyzes the functions they call as
+    // needed.
+    if (GetOriginalTemplatedFunction(func, template_usr_to_decl) == nullptr) {
+      continue;
+    }
+    funcs.push_back(func);
   }
+  // The overrides found in the original context can't be looked up with the
+  // methods of this one, so there are none to pass.
+  AnalyzeFunctionsBottomUp(funcs, inner_result, lifetime_context,
+                           diag_reporter, &inner_debug_info, BaseToOverrides());
 
   // We need to remap the results with FunctionDecl* in the
   // original ASTContext. (Because this context goes away after
@@ -1394,21 +1802,21 @@ void AnalyzeTemplateFunctionsInSeparateASTContext(
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
       merged_result = initial_result;
   for (const auto& [decl, lifetimes_or_error] : inner_result) {
-    if (!decl->isFunctionTemplateSpecialization()) continue;
-    auto* tmpl = decl->getTemplateSpecializationInfo()->getTemplate();
-    auto iter = template_usr_to_decl.find(GetFunctionUSRString(tmpl));
-    if (iter != template_usr_to_decl.end()) {
-      merged_result.insert({iter->second, lifetimes_or_error});
+    if (const clang::FunctionDecl* original =
+            GetOriginalTemplatedFunction(decl, template_usr_to_decl)) {
+      merged_result.insert({original, lifetimes_or_error});
     }
   }
   for (const auto& [decl, lifetimes_or_error] : merged_result) {
     result_callback(decl, lifetimes_or_error);
   }
   for (auto& [decl, info] : inner_debug_info) {
-    if (!decl->isFunctionTemplateSpecialization()) continue;
-    auto* tmpl = decl->getTemplateSpecializationInfo()->getTemplate();
-    auto iter = template_usr_to_decl.find(GetFunctionUSRString(tmpl));
-    if (iter != template_usr_to_decl.end()) (*debug_info)[iter->second] = info;
+    if (const clang::FunctionDecl* original =
+            GetOriginalTemplatedFunction(decl, template_usr_to_decl)) {
+      // The captured state refers to this context's AST, so render it now.
+      info.Render();
+      (*debug_info)[original] = info;
+    }
   }
 }
 
@@ -1438,6 +1846,8 @@ FunctionLifetimesOrError AnalyzeFunction(
     const clang::FunctionDecl* func,
     const LifetimeAnnotationContext& lifetime_context,
     FunctionDebugInfo* debug_info) {
+  LifetimeIdAllocator lifetime_ids;
+  LifetimeIdAllocator::Scope lifetime_id_scope(lifetime_ids);
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError> analyzed;
   llvm::SmallVector<VisitedCallStackEntry> visited;
   std::optional<FunctionDebugInfoMap> debug_info_map;
@@ -1448,7 +1858,8 @@ FunctionLifetimesOrError AnalyzeFunction(
       DiagReporterForDiagEngine(func->getASTContext().getDiagnostics());
   AnalyzeFunctionRecursive(
       analyzed, visited, func, lifetime_context, diag_reporter,
-      debug_info_map ? &debug_info_map.value() : nullptr, BaseToOverrides());
+      debug_info_map ? &debug_info_map.value() : nullptr, BaseToOverrides(),
+      CalleeMap());
   if (debug_info) {
     *debug_info = debug_info_map->lookup(func);
   }
@@ -1460,6 +1871,8 @@ AnalyzeTranslationUnit(const clang::TranslationUnitDecl* tu,
                        const LifetimeAnnotationContext& lifetime_context,
                        DiagnosticReporter diag_reporter,
                        FunctionDebugInfoMap* debug_info) {
+  LifetimeIdAllocator lifetime_ids;
+  LifetimeIdAllocator::Scope lifetime_id_scope(lifetime_ids);
   if (!diag_reporter) {
     diag_reporter =
         DiagReporterForDiagEngine(tu->getASTContext().getDiagnostics());
@@ -1468,15 +1881,10 @@ AnalyzeTranslationUnit(const clang::TranslationUnitDecl* tu,
   llvm::DenseMap<clang::FunctionTemplateDecl*, const clang::FunctionDecl*>
       uninstantiated_templates;
 
-  // Builds a map from a base method to its overrides within this TU. It will
-  // not find out all the overrides, but still cover (and can partially update)
-  // all the base methods that this TU implements.
-  auto base_to_overrides = BuildBaseToOverrides(tu);
-
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError> result =
       AnalyzeTranslationUnitAndCollectTemplates(
           tu, lifetime_context, diag_reporter, debug_info,
-          uninstantiated_templates, base_to_overrides);
+          uninstantiated_templates);
 
   return result;
 }
@@ -1486,6 +1894,8 @@ void AnalyzeTranslationUnitWithTemplatePlaceholder(
     const LifetimeAnnotationContext& lifetime_context,
     const FunctionAnalysisResultCallback& result_callback,
     DiagnosticReporter diag_reporter, FunctionDebugInfoMap* debug_info) {
+  LifetimeIdAllocator lifetime_ids;
+  LifetimeIdAllocator::Scope lifetime_id_scope(lifetime_ids);
   if (!diag_reporter) {
     diag_reporter =
         DiagReporterForDiagEngine(tu->getASTContext().getDiagnostics());
@@ -1494,15 +1904,19 @@ void AnalyzeTranslationUnitWithTemplatePlaceholder(
   llvm::DenseMap<clang::FunctionTemplateDecl*, const clang::FunctionDecl*>
       uninstantiated_templates;
 
-  // Builds a map from a base method to its overrides within this TU. It will
-  // not find out all the overrides, but still cover (and can partially update)
-  // all the base methods that this TU implements.
-  auto base_to_overrides = BuildBaseToOverrides(tu);
-
   llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>
       initial_result = AnalyzeTranslationUnitAndCollectTemplates(
           tu, lifetime_context, diag_reporter, debug_info,
-          uninstantiated_templates, base_to_overrides);
+          uninstantiated_templates);
+
+  // Without templates to instantiate, there is nothing to add to the results
+  // we already have, so don't reparse the TU.
+  if (uninstantiated_templates.empty()) {
+    for (const auto& [decl, lifetimes_or_error] : initial_result) {
+      result_callback(decl, lifetimes_or_error);
+    }
+    return;
+  }
 
   // Make a map from USRString to funcDecls in the original ASTContext.
   std::map<std::string, const clang::FunctionDecl*> template_usr_to_decl;
@@ -1525,11 +1939,10 @@ void AnalyzeTranslationUnitWithTemplatePlaceholder(
   // placeholders. This is passed to RunToolOnCodeWithOverlay below.
   auto analyze_with_placeholder =
       [&lifetime_context, &initial_result, &result_callback, &diag_reporter,
-       &debug_info, &template_usr_to_decl,
-       &base_to_overrides](clang::ASTContext& context) {
+       &debug_info, &template_usr_to_decl](clang::ASTContext& context) {
         AnalyzeTemplateFunctionsInSeparateASTContext(
             lifetime_context, initial_result, result_callback, diag_reporter,
-            debug_info, template_usr_to_decl, base_to_overrides, context);
+            debug_info, template_usr_to_decl, context);
       };
 
   // Run `analyze_with_placeholder` in a separate ASTContext on top of an
@@ -1539,6 +1952,60 @@ void AnalyzeTranslationUnitWithTemplatePlaceholder(
                            analyze_with_placeholder);
 }
 
+std::string FunctionDebugInfo::Ast() const {
+  if (!state) return "";
+  if (state->rendered) return state->rendered->ast;
+  std::string ast;
+  llvm::raw_string_ostream os(ast);
+  state->func->dump(os);
+  os.flush();
+  return ast;
+}
+
+std::string FunctionDebugInfo::ObjectRepositoryString() const {
+  if (!state) return "";
+  if (state->rendered) return state->rendered->object_repository;
+  if (!state->object_repository) return "";
+  return state->object_repository->DebugString();
+}
+
+std::string FunctionDebugInfo::PointsToMapDot() const {
+  if (!state) return "";
+  if (state->rendered) return state->rendered->points_to_map_dot;
+  if (!state->object_repository) return "";
+  return PointsToGraphDot(*state->object_repository, state->points_to_map);
+}
+
+std::string FunctionDebugInfo::CfgDot() const {
+  if (!state) return "";
+  if (state->rendered) return state->rendered->cfg_dot;
+  if (!state->object_repository || !state->cfctx) return "";
+  return CreateCfgDot(state->cfctx->getCFG(), state->func->getASTContext(),
+                      state->block_to_output_lattice,
+                      *state->object_repository);
+}
+
+std::string FunctionDebugInfo::ConstraintsDot() const {
+  if (!state) return "";
+  if (state->rendered) return state->rendered->constraints_dot;
+  if (!state->object_repository) return "";
+  return lifetimes::ConstraintsDot(*state->object_repository,
+                                   state->constraints);
+}
+
+void FunctionDebugInfo::Render() {
+  if (!state || state->rendered) return;
+  FunctionDebugState::Rendered rendered{
+      .ast = Ast(),
+      .object_repository = ObjectRepositoryString(),
+      .points_to_map_dot = PointsToMapDot(),
+      .cfg_dot = CfgDot(),
+      .constraints_dot = ConstraintsDot(),
+  };
+  // Drop everything that refers to the AST.
+  *state = FunctionDebugState{.rendered = std::move(rendered)};
+}
+
 }  // namespace lifetimes
 }  // namespace tidy
 }  // namespace clang
@@ -5,7 +5,10 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_ANALYZE_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_ANALYZE_H_
 
+#include <chrono>
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "lifetime_analysis/lifetime_analysis.h"
@@ -18,22 +21,59 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+struct FunctionDebugState;
+
 // Lifetime analysis debug info for a single function.
+//
+// The analysis only captures its state; the human-readable representations
+// are built on demand by the accessors below. Until `Render()` has been
+// called, the accessors require the AST of the function to still be alive.
 struct FunctionDebugInfo {
   // Human-readable representation of the function's AST.
-  std::string ast;
+  std::string Ast() const;
 
   // Human-readable representation of the function's ObjectRepository.
-  std::string object_repository;
+  std::string ObjectRepositoryString() const;
 
   // A graph of the exit-block's points-to map in .dot file format.
-  std::string points_to_map_dot;
+  std::string PointsToMapDot() const;
 
   // A graph of the CFG in .dot file format.
-  std::string cfg_dot;
+  std::string CfgDot() const;
 
   // A graph of the constraints in .dot file format.
-  std::string constraints_dot;
+  std::string ConstraintsDot() const;
+
+  // Builds all of the representations above and releases the captured state,
+  // so that the accessors can be used after the AST has been destroyed.
+  void Render();
+
+  // The captured state of the analysis; null if the function wasn't analyzed.
+  std::shared_ptr<FunctionDebugState> state;
+
+  // The number of elements in the CFG, and the number of times the dataflow
+  // analysis transferred one of them before reaching a fixpoint. Their ratio is
+  // the average number of visits per element; a high ratio points to slow
+  // convergence. Both are summed over all analyses of the function if it is
+  // part of a recursive cycle.
+  int64_t num_cfg_elements = 0;
+  int64_t num_transfers = 0;
+
+  // The time spent running the dataflow analysis on the function's body,
+  // summed like the counts above.
+  std::chrono::nanoseconds dataflow_time{0};
+
+  // The largest number of points-to edges, i.e. of (pointer, pointee) pairs,
+  // in the lattice at the end of any CFG block, over all analyses of the
+  // function.
+  int64_t max_points_to_edges = 0;
+
+  // Whether the function contains nothing that can have a lifetime, so that
+  // its (empty) lifetimes were determined without running the analysis. In
+  // this case, only `Ast()` is available. The number of entries in a
+  // `FunctionDebugInfoMap` with this flag set is the number of functions that
+  // took this fast path.
+  bool pointer_free_fast_path = false;
 };
 
 // Returns if the two FunctionLifetimes have the same structures, without
@@ -46,6 +86,10 @@ bool IsIsomorphic(const FunctionLifetimes& a, const FunctionLifetimes& b);
 using FunctionDebugInfoMap =
     llvm::DenseMap<const clang::FunctionDecl*, FunctionDebugInfo>;
 
+// The analysis functions below create lifetimes from a `LifetimeIdAllocator`
+// of their own, so their results are reproducible, but they must not be mixed
+// with lifetimes created elsewhere, or by another call.
+
 // Runs a static analysis on `func` and returns the result.
 FunctionLifetimesOrError AnalyzeFunction(
     const clang::FunctionDecl* func,
@@ -0,0 +1,182 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Measures the cost of the lifetime analysis on synthetic code that scales up
+// the scenarios of lifetime_analysis/test: many pointers per function, deep
+// call chains, large recursive cycles and many template instantiations.
+//
+// For each scenario and size, prints the time taken to analyze the whole TU,
+// the slowest function, the average number of times each CFG element was
+// transferred, and the largest points-to map seen at the end of a CFG block.
+// With --per_function, also prints these numbers for every function.
+//
+// Example:
+//
+//   bazel run -c opt //lifetime_analysis:analyze_benchmark
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "lifetime_analysis/analyze.h"
+#include "lifetime_annotations/lifetime_annotations.h"
+#include "lifetime_annotations/test/run_on_code.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "llvm/Support/CommandLine.h"
+
+llvm::cl::opt<bool> PerFunction{
+    "per_function",
+    llvm::cl::desc("Print the numbers for every analyzed function"),
+    llvm::cl::init(false),
+};
+
+namespace clang {
+namespace tidy {
+namespace lifetimes {
+namespace {
+
+struct Scenario {
+  const char* name;
+  std::vector<int> sizes;
+  std::function<std::string(int)> generate;
+};
+
+// A function that may return any of its `n` pointer parameters.
+std::string ManyPointers(int n) {
+  std::string params, body;
+  for (int i = 0; i < n; ++i) {
+    absl::StrAppend(&params, "int* p", i, ", ");
+    absl::StrAppend(&body, "  if (c == ", i, ") r = p", i, ";\n");
+  }
+  return absl::StrCat("int* f(", params, "int c) {\n  int* r = nullptr;\n",
+                      body, "  return r;\n}\n");
+}
+
+// `n` functions, each calling the previous one.
+std::string CallChain(int n) {
+  std::string code = "int* f0(int* p, int* q) { return p; }\n";
+  for (int i = 1; i < n; ++i) {
+    absl::StrAppend(&code, "int* f", i, "(int* p, int* q) { return f", i - 1,
+                    "(q, p); }\n");
+  }
+  return code;
+}
+
+// `n` functions that form a single recursive cycle.
+std::string RecursiveCycle(int n) {
+  std::string code;
+  for (int i = 0; i < n; ++i) {
+    absl::StrAppend(&code, "int* f", i, "(int* p, int* q, int c);\n");
+  }
+  for (int i = 0; i < n; ++i) {
+    absl::StrAppend(&code, "int* f", i, "(int* p, int* q, int c) {\n",
+                    "  if (c > 0) return f", (i + 1) % n, "(q, p, c - 1);\n",
+                    "  return p;\n}\n");
+  }
+  return code;
+}
+
+// A chain of `n` instantiations of a function template and a class template.
+std::string TemplateInstantiations(int n) {
+  return absl::StrCat(
+      "template <int N> struct Holder {\n"
+      "  int* p;\n"
+      "  int* get() { return p; }\n"
+      "};\n"
+      "template <int N> int* Chain(int* p) {\n"
+      "  Holder<N> h{p};\n"
+      "  return Chain<N - 1>(h.get());\n"
+      "}\n"
+      "template <> int* Chain<0>(int* p) { return p; }\n"
+      "int* Use(int* p) { return Chain<",
+      n, ">(p); }\n");
+}
+
+void RunScenario(const Scenario& scenario, int size) {
+  std::string code = scenario.generate(size);
+  runOnCodeWithLifetimeHandlers(
+      code,
+      [&](const clang::ASTContext& ast_context,
+          const LifetimeAnnotationContext& lifetime_context) {
+        FunctionDebugInfoMap debug_info;
+        int num_functions = 0;
+        auto start = std::chrono::steady_clock::now();
+        AnalyzeTranslationUnitWithTemplatePlaceholder(
+            ast_context.getTranslationUnitDecl(), lifetime_context,
+            [&num_functions](const clang::FunctionDecl*,
+                             const FunctionLifetimesOrError&) {
+              ++num_functions;
+            },
+            /*diag_reporter=*/{}, &debug_info);
+        std::chrono::duration<double, std::milli> total =
+            std::chrono::steady_clock::now() - start;
+
+        std::string slowest = "-";
+        std::chrono::nanoseconds slowest_time{0};
+        int64_t num_cfg_elements = 0;
+        int64_t num_transfers = 0;
+        int64_t max_points_to_edges = 0;
+        for (const auto& [func, info] : debug_info) {
+          if (info.dataflow_time > slowest_time) {
+            slowest = func->getNameAsString();
+            slowest_time = info.dataflow_time;
+          }
+          num_cfg_elements += info.num_cfg_elements;
+          num_transfers += info.num_transfers;
+          max_points_to_edges =
+              std::max(max_points_to_edges, info.max_points_to_edges);
+          if (PerFunction) {
+            std::cout << "  " << func->getNameAsString() << "\t"
+                      << std::chrono::duration<double, std::milli>(
+                             info.dataflow_time)
+                             .count()
+                      << " ms\t" << info.num_transfers << "/"
+                      << info.num_cfg_elements << " transfers/elements\t"
+                      << info.max_points_to_edges << " edges\n";
+          }
+        }
+        std::cout << scenario.name << "\t" << size << "\t" << num_functions
+                  << "\t" << total.count() << "\t" << slowest << "\t"
+                  << std::chrono::duration<double, std::milli>(slowest_time)
+                         .count()
+                  << "\t"
+                  << (num_cfg_elements > 0
+                          ? static_cast<double>(num_transfers) /
+                                num_cfg_elements
+                          : 0.0)
+                  << "\t" << max_points_to_edges << "\n";
+      },
+      {"-std=c++17"});
+}
+
+void Run() {
+  const Scenario scenarios[] = {
+      {"many_pointers", {8, 32, 128}, ManyPointers},
+      {"call_chain", {10, 100, 1000}, CallChain},
+      {"recursive_cycle", {4, 16, 64}, RecursiveCycle},
+      {"template_instantiations", {10, 100, 500}, TemplateInstantiations},
+  };
+  std::cout << "scenario\tsize\tfunctions\ttotal_ms\tslowest\tslowest_ms\t"
+               "transfers_per_element\tmax_points_to_edges\n";
+  for (const Scenario& scenario : scenarios) {
+    for (int size : scenario.sizes) RunScenario(scenario, size);
+  }
+}
+
+}  // namespace
+}  // namespace lifetimes
+}  // namespace tidy
+}  // namespace clang
+
+int main(int argc, char** argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+  clang::tidy::lifetimes::Run();
+  return 0;
+}
@@ -4,9 +4,14 @@
 
 #include "lifetime_analysis/builtin_lifetimes.h"
 
+#include <atomic>
 #include <cassert>
+#include <cstdint>
+#include <memory>
+#include <mutex>  // NOLINT(build/c++11)
 #include <optional>
 #include <string>
+#include <variant>
 
 #include "lifetime_annotations/function_lifetimes.h"
 #include "lifetime_annotations/lifetime.h"
@@ -17,6 +22,7 @@
 #include "clang/AST/Type.h"
 #include "clang/AST/TypeLoc.h"
 #include "clang/Basic/Builtins.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
@@ -50,9 +56,50 @@ class ForwardAndMoveFactory : public FunctionLifetimeFactory {
   }
 };
 
-}  // namespace
+// The lifetimes built for the builtins of one `ASTContext`, keyed by the
+// canonical declaration of the builtin.
+using ContextBuiltinLifetimes =
+    llvm::DenseMap<const clang::FunctionDecl*,
+                   std::shared_ptr<const FunctionLifetimesOrError>>;
 
-FunctionLifetimesOrError GetBuiltinLifetimes(const clang::FunctionDecl* decl) {
+struct BuiltinLifetimesCache {
+  std::mutex mutex;
+  // Only contains live `ASTContext`s.
+  llvm::DenseMap<const clang::ASTContext*, ContextBuiltinLifetimes> by_context;
+};
+
+BuiltinLifetimesCache& GetBuiltinLifetimesCache() {
+  static auto* cache = new BuiltinLifetimesCache();
+  return *cache;
+}
+
+std::atomic<int64_t> num_requests = 0;
+std::atomic<int64_t> num_builds = 0;
+
+// Called when an `ASTContext` is destroyed, so that its declarations can't be
+// confused with those of a later `ASTContext` allocated at the same address.
+void EvictASTContext(void* ast_context) {
+  BuiltinLifetimesCache& cache = GetBuiltinLifetimesCache();
+  std::lock_guard<std::mutex> lock(cache.mutex);
+  cache.by_context.erase(static_cast<const clang::ASTContext*>(ast_context));
+}
+
+// Returns a copy of `lifetimes` in which every variable lifetime has been
+// replaced by a fresh one.
+FunctionLifetimes WithFreshVariables(const FunctionLifetimes& lifetimes) {
+  FunctionLifetimes result = lifetimes;
+  llvm::DenseMap<Lifetime, Lifetime> renaming;
+  result.Traverse([&renaming](Lifetime& l, Variance) {
+    if (!l.IsVariable()) return;
+    auto [iter, inserted] = renaming.try_emplace(l);
+    if (inserted) iter->second = Lifetime::CreateVariable();
+    l = iter->second;
+  });
+  return result;
+}
+
+FunctionLifetimesOrError BuildBuiltinLifetimes(
+    const clang::FunctionDecl* decl) {
   unsigned builtin_id = decl->getBuiltinID();
   const auto& builtin_info = decl->getASTContext().BuiltinInfo;
   assert(builtin_id != 0);
@@ -98,6 +145,42 @@ FunctionLifetimesOrError GetBuiltinLifetimes(const clang::FunctionDecl* decl) {
   }
 }
 
+}  // namespace
+
+FunctionLifetimesOrError GetBuiltinLifetimes(const clang::FunctionDecl* decl) {
+  decl = decl->getCanonicalDecl();
+  ++num_requests;
+
+  std::shared_ptr<const FunctionLifetimesOrError> cached;
+  {
+    BuiltinLifetimesCache& cache = GetBuiltinLifetimesCache();
+    std::lock_guard<std::mutex> lock(cache.mutex);
+    clang::ASTContext& ast_context = decl->getASTContext();
+    auto [context_iter, new_context] =
+        cache.by_context.try_emplace(&ast_context);
+    if (new_context) {
+      ast_context.AddDeallocation(&EvictASTContext, &ast_context);
+    }
+    std::shared_ptr<const FunctionLifetimesOrError>& entry =
+        context_iter->second[decl];
+    if (entry == nullptr) {
+      entry = std::make_shared<const FunctionLifetimesOrError>(
+          BuildBuiltinLifetimes(decl));
+      ++num_builds;
+    }
+    cached = entry;
+  }
+
+  if (const auto* lifetimes = std::get_if<FunctionLifetimes>(cached.get())) {
+    return WithFreshVariables(*lifetimes);
+  }
+  return *cached;
+}
+
+int64_t NumBuiltinLifetimesRequests() { return num_requests; }
+
+int64_t NumBuiltinLifetimesBuilds() { return num_builds; }
+
 }  // namespace lifetimes
 }  // namespace tidy
 }  // namespace clang
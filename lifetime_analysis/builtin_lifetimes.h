@@ -5,6 +5,8 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_BUILTIN_LIFETIMES_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_BUILTIN_LIFETIMES_H_
 
+#include <cstdint>
+
 #include "lifetime_annotations/function_lifetimes.h"
 #include "clang/AST/Decl.h"
 
@@ -12,8 +14,18 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+// Returns the lifetimes of the builtin `decl`.
+// The lifetimes of each builtin declaration are only built once per
+// `ASTContext`; repeated calls return the cached lifetimes renamed to fresh
+// variable lifetimes, so that lifetimes obtained by different calls never
+// alias.
 FunctionLifetimesOrError GetBuiltinLifetimes(const clang::FunctionDecl* decl);
 
+// Returns how many times `GetBuiltinLifetimes()` has been called in this
+// process, and how many of these calls had to build the lifetimes.
+int64_t NumBuiltinLifetimesRequests();
+int64_t NumBuiltinLifetimesBuilds();
+
 }  // namespace lifetimes
 }  // namespace tidy
 }  // namespace clang
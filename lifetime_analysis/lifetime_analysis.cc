@@ -105,8 +105,8 @@ class TransferStmtVisitor
 void GenerateConstraintsForSingleAssignment(const Object* oldp,
                                             const Object* newp,
                                             LifetimeConstraints& constraints) {
-  if (oldp->GetFuncLifetimes().has_value() &&
-      newp->GetFuncLifetimes().has_value()) {
+  if (oldp->GetFuncLifetimes() != nullptr &&
+      newp->GetFuncLifetimes() != nullptr) {
     // The order of `newp` and `oldp` here may seem surprising. However, this
     // can be thought of as: "I am assigning `newp` where before I had `oldp`,
     // therefore `oldp` needs to be able to represent a call to whatever it is
@@ -335,7 +335,9 @@ void TransferInitializer(const Object* dest, clang::QualType type,
 }
 
 LifetimeLattice LifetimeAnalysis::initialElement() {
-  return LifetimeLattice(object_repository_.InitialPointsToMap(),
+  PointsToMap points_to_map = object_repository_.InitialPointsToMap();
+  points_to_map.UseExprObjectSets(expr_object_sets_);
+  return LifetimeLattice(std::move(points_to_map),
                          object_repository_.InitialSingleValuedObjects());
 }
 
@@ -351,6 +353,7 @@ bool LifetimeAnalysis::IsEqual(const LifetimeLattice& state1,
 void LifetimeAnalysis::transfer(const clang::CFGElement& elt,
                                 LifetimeLattice& state,
                                 clang::dataflow::Environment& /*environment*/) {
+  ++num_transfers_;
   if (state.IsError()) return;
 
   auto cfg_stmt = elt.getAs<clang::CFGStmt>();
@@ -849,9 +852,8 @@ std::optional<std::string> TransferStmtVisitor::VisitCallExpr(
   } else {
     const clang::Expr* callee = call->getCallee();
     for (const auto& object : points_to_map_.GetExprObjectSet(callee)) {
-      if (const std::optional<FunctionLifetimes>& func_lifetimes =
-              object->GetFuncLifetimes();
-          func_lifetimes.has_value()) {
+      if (const FunctionLifetimes* func_lifetimes =
+              object->GetFuncLifetimes()) {
         callees.push_back(
             {.is_member_operator = false,
              .lifetimes = *func_lifetimes,
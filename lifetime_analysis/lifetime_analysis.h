@@ -5,7 +5,9 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_LIFETIME_ANALYSIS_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_LIFETIME_ANALYSIS_H_
 
+#include <cstdint>
 #include <functional>
+#include <memory>
 #include <string>
 
 #include "lifetime_analysis/lifetime_constraints.h"
@@ -86,12 +88,20 @@ class LifetimeAnalysis
   void transfer(const clang::CFGElement& elt, LifetimeLattice& state,
                 clang::dataflow::Environment& environment);
 
+  // Returns how many CFG elements `transfer()` has been called on so far,
+  // counting repeated visits of the same element.
+  int64_t NumTransfers() const { return num_transfers_; }
+
  private:
   const clang::FunctionDecl* func_;
   ObjectRepository& object_repository_;
   const llvm::DenseMap<const clang::FunctionDecl*, FunctionLifetimesOrError>&
       callee_lifetimes_;
   const DiagnosticReporter& diag_reporter_;
+  // The object sets of expressions, shared by all lattice elements.
+  std::shared_ptr<ExprObjectSets> expr_object_sets_ =
+      std::make_shared<ExprObjectSets>();
+  int64_t num_transfers_ = 0;
 };
 
 }  // namespace lifetimes
@@ -0,0 +1,386 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// lifetime_analyzer infers the lifetimes of the functions defined in many
+// translation units, e.g. all of those in a compilation database:
+//
+//   lifetime_analyzer -p=BUILD_DIR -output_dir=OUT [FILES...]
+//
+// With no FILES, it analyzes every file in the compilation database. The
+// results for each translation unit go to a file of its own under -output_dir,
+// named after a hash of its path. Each line of that file is the JSON result
+// for one function, e.g.
+//
+//   {"usr":"c:@F@f#*I#","name":"f","loc":"a.cc:3","lifetimes":"a, a"}
+//   {"usr":"c:@F@g#","name":"g","loc":"a.cc:7","error":"..."}
+//
+// where "lifetimes" is in the summary format of lifetime_summaries.h. By
+// default, only functions defined in the main file are reported, so that each
+// function is reported by a single translation unit.
+//
+// Next to the results, the summaries of each translation unit are written in
+// the `LifetimeSummaries` file format, to a file with the same name and the
+// extension ".summaries". With -summaries_out=PATH, all of the summaries in
+// -output_dir (including those of other shards writing to the same directory,
+// and of earlier runs) are merged into PATH once the analysis is done. That
+// file can be passed as -lifetime_summaries to later runs, and as
+// --lifetime_summaries to rs_bindings_from_cc.
+//
+// The translation units can be split between processes (e.g. on different
+// machines) with -num_shards=N and -shard=I: each process only analyzes the
+// translation units whose path hashes to shard I. Within a process, -j sets
+// how many translation units are analyzed at a time.
+//
+// Each output file is written to a temporary file first and then renamed, and
+// translation units that already have an output file are skipped, so an
+// interrupted run can be resumed by running the same command again.
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "lifetime_analysis/analyze.h"
+#include "lifetime_annotations/function_lifetimes.h"
+#include "lifetime_annotations/lifetime_annotations.h"
+#include "lifetime_annotations/lifetime_summaries.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/CommonOptionsParser.h"
+#include "clang/Tooling/CompilationDatabase.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+llvm::cl::OptionCategory Opts("lifetime_analyzer options");
+llvm::cl::opt<std::string> OutputDir{
+    "output_dir",
+    llvm::cl::desc("Directory to write the results of each translation unit "
+                   "to"),
+    llvm::cl::Required,
+    llvm::cl::cat(Opts),
+};
+llvm::cl::opt<unsigned> NumShards{
+    "num_shards",
+    llvm::cl::desc("Number of shards to split the translation units into"),
+    llvm::cl::init(1),
+    llvm::cl::cat(Opts),
+};
+llvm::cl::opt<unsigned> Shard{
+    "shard",
+    llvm::cl::desc("The shard of translation units to analyze, in "
+                   "[0, num_shards)"),
+    llvm::cl::init(0),
+    llvm::cl::cat(Opts),
+};
+llvm::cl::opt<bool> Resume{
+    "resume",
+    llvm::cl::desc("Skip translation units that already have results in "
+                   "-output_dir"),
+    llvm::cl::init(true),
+    llvm::cl::cat(Opts),
+};
+llvm::cl::opt<bool> MainFileOnly{
+    "main_file_only",
+    llvm::cl::desc("Only report functions defined in the main file"),
+    llvm::cl::init(true),
+    llvm::cl::cat(Opts),
+};
+llvm::cl::opt<std::string> LifetimeSummariesIn{
+    "lifetime_summaries",
+    llvm::cl::desc("File of lifetime summaries (see lifetime_summaries.h) to "
+                   "use for functions not defined in the main file"),
+    llvm::cl::cat(Opts),
+};
+llvm::cl::opt<std::string> SummariesOut{
+    "summaries_out",
+    llvm::cl::desc("File to write the lifetime summaries of all translation "
+                   "units with results in -output_dir to"),
+    llvm::cl::cat(Opts),
+};
+llvm::cl::opt<unsigned> Threads{
+    "j",
+    llvm::cl::desc("Number of translation units to analyze at a time "
+                   "(default: all cores)"),
+    llvm::cl::init(0),
+    llvm::cl::cat(Opts),
+};
+
+namespace clang {
+namespace tidy {
+namespace lifetimes {
+namespace {
+
+// Returns the result of analyzing `func` as a JSON object.
+llvm::json::Object ResultToJson(const clang::FunctionDecl* func,
+                                const FunctionLifetimesOrError& result) {
+  llvm::json::Object json;
+  llvm::SmallString<128> usr;
+  if (!clang::index::generateUSRForDecl(func, usr)) {
+    json["usr"] = usr.str();
+  }
+  json["name"] = func->getQualifiedNameAsString();
+
+  const clang::SourceManager& source_manager =
+      func->getASTContext().getSourceManager();
+  clang::PresumedLoc loc = source_manager.getPresumedLoc(
+      source_manager.getExpansionLoc(func->getLocation()));
+  if (loc.isValid()) {
+    json["loc"] = (llvm::Twine(loc.getFilename()) + ":" +
+                   llvm::Twine(loc.getLine()))
+                      .str();
+  }
+
+  if (const auto* error = std::get_if<FunctionAnalysisError>(&result)) {
+    json["error"] = error->message;
+  } else if (llvm::Expected<std::string> summary = SummarizeFunctionLifetimes(
+                 func, std::get<FunctionLifetimes>(result))) {
+    json["lifetimes"] = std::move(*summary);
+  } else {
+    json["error"] = llvm::toString(summary.takeError());
+  }
+  return json;
+}
+
+// The file that holds the summaries for the translation unit whose results
+// are in `output_path`.
+std::string SummariesPath(llvm::StringRef output_path) {
+  llvm::SmallString<256> path(output_path);
+  llvm::sys::path::replace_extension(path, ".summaries");
+  return std::string(path);
+}
+
+llvm::Error WriteFileAtomically(llvm::StringRef path,
+                                llvm::StringRef contents) {
+  std::string temp_path = (path + ".tmp").str();
+  {
+    std::error_code ec;
+    llvm::raw_fd_ostream os(temp_path, ec);
+    if (ec) return llvm::createFileError(temp_path, ec);
+    os << contents;
+    os.close();
+    if (os.has_error()) return llvm::createFileError(temp_path, os.error());
+  }
+  if (std::error_code ec = llvm::sys::fs::rename(temp_path, path)) {
+    return llvm::createFileError(path, ec);
+  }
+  return llvm::Error::success();
+}
+
+class AnalyzerConsumer : public clang::ASTConsumer {
+ public:
+  AnalyzerConsumer(std::string output_path,
+                   std::shared_ptr<LifetimeAnnotationContext> lifetime_context)
+      : output_path_(std::move(output_path)),
+        lifetime_context_(std::move(lifetime_context)) {}
+
+  void HandleTranslationUnit(clang::ASTContext& ast_context) override {
+    std::string results;
+    llvm::raw_string_ostream os(results);
+    LifetimeSummaries summaries;
+    AnalyzeTranslationUnitWithTemplatePlaceholder(
+        ast_context.getTranslationUnitDecl(), *lifetime_context_,
+        [&os, &summaries](const clang::FunctionDecl* func,
+                          const FunctionLifetimesOrError& result) {
+          const clang::SourceManager& source_manager =
+              func->getASTContext().getSourceManager();
+          if (MainFileOnly && !source_manager.isInMainFile(
+                                  source_manager.getExpansionLoc(
+                                      func->getLocation()))) {
+            return;
+          }
+          os << llvm::json::Value(ResultToJson(func, result)) << "\n";
+          if (const auto* lifetimes = std::get_if<FunctionLifetimes>(&result)) {
+            // `ResultToJson` already reported why there is no summary.
+            llvm::consumeError(summaries.Add(func, *lifetimes));
+          }
+        });
+    os.flush();
+    // The summaries are written first: the results file marks the translation
+    // unit as done.
+    std::string summaries_text;
+    llvm::raw_string_ostream summaries_os(summaries_text);
+    summaries.Write(summaries_os);
+    summaries_os.flush();
+    if (llvm::Error err =
+            WriteFileAtomically(SummariesPath(output_path_), summaries_text)) {
+      llvm::errs() << "Failed to write summaries: "
+                   << llvm::toString(std::move(err)) << "\n";
+      return;
+    }
+    if (llvm::Error err = WriteFileAtomically(output_path_, results)) {
+      llvm::errs() << "Failed to write results: "
+                   << llvm::toString(std::move(err)) << "\n";
+    }
+  }
+
+ private:
+  std::string output_path_;
+  std::shared_ptr<LifetimeAnnotationContext> lifetime_context_;
+};
+
+class AnalyzerAction : public clang::ASTFrontendAction {
+ public:
+  AnalyzerAction(std::string output_path,
+                 std::shared_ptr<const LifetimeSummaries> summaries)
+      : output_path_(std::move(output_path)),
+        summaries_(std::move(summaries)) {}
+
+  std::unique_ptr<clang::ASTConsumer> CreateASTConsumer(
+      clang::CompilerInstance& compiler, llvm::StringRef) override {
+    auto lifetime_context = std::make_shared<LifetimeAnnotationContext>();
+    lifetime_context->summaries = summaries_;
+    AddLifetimeAnnotationHandlers(compiler.getPreprocessor(), lifetime_context);
+    return std::make_unique<AnalyzerConsumer>(output_path_,
+                                              std::move(lifetime_context));
+  }
+
+ private:
+  std::string output_path_;
+  std::shared_ptr<const LifetimeSummaries> summaries_;
+};
+
+class AnalyzerActionFactory : public clang::tooling::FrontendActionFactory {
+ public:
+  AnalyzerActionFactory(std::string output_path,
+                        std::shared_ptr<const LifetimeSummaries> summaries)
+      : output_path_(std::move(output_path)),
+        summaries_(std::move(summaries)) {}
+
+  std::unique_ptr<clang::FrontendAction> create() override {
+    return std::make_unique<AnalyzerAction>(output_path_, summaries_);
+  }
+
+ private:
+  std::string output_path_;
+  std::shared_ptr<const LifetimeSummaries> summaries_;
+};
+
+// The file that holds the results for the translation unit of `file`.
+std::string OutputPath(llvm::StringRef file) {
+  // Unlike std::hash, xxHash64 is the same in every process.
+  llvm::SmallString<256> path(OutputDir.getValue());
+  llvm::sys::path::append(path,
+                          llvm::utohexstr(llvm::xxHash64(file)) + ".jsonl");
+  return std::string(path);
+}
+
+bool InShard(llvm::StringRef file) {
+  return llvm::xxHash64(file) % NumShards == Shard;
+}
+
+// Merges the summaries of all translation units in -output_dir into
+// -summaries_out.
+llvm::Error MergeSummaries() {
+  std::vector<std::string> paths;
+  std::error_code ec;
+  for (llvm::sys::fs::directory_iterator it(OutputDir.getValue(), ec), end;
+       it != end && !ec; it.increment(ec)) {
+    if (llvm::sys::path::extension(it->path()) == ".summaries") {
+      paths.push_back(it->path());
+    }
+  }
+  if (ec) return llvm::createFileError(OutputDir.getValue(), ec);
+  // Directory order is unspecified, and the first summary of a function wins.
+  std::sort(paths.begin(), paths.end());
+  llvm::Expected<LifetimeSummaries> merged =
+      LifetimeSummaries::LoadAndMerge(paths);
+  if (!merged) return merged.takeError();
+  std::string text;
+  llvm::raw_string_ostream os(text);
+  merged->Write(os);
+  os.flush();
+  return WriteFileAtomically(SummariesOut.getValue(), text);
+}
+
+}  // namespace
+}  // namespace lifetimes
+}  // namespace tidy
+}  // namespace clang
+
+int main(int argc, const char** argv) {
+  using clang::tidy::lifetimes::LifetimeSummaries;
+  auto options = clang::tooling::CommonOptionsParser::create(
+      argc, argv, Opts, llvm::cl::ZeroOrMore);
+  QCHECK(options) << toString(options.takeError());
+  QCHECK(NumShards > 0) << "-num_shards must be positive";
+  QCHECK(Shard < NumShards) << "-shard must be less than -num_shards";
+  QCHECK(!llvm::sys::fs::create_directories(OutputDir.getValue()))
+      << "Failed to create " << OutputDir.getValue();
+
+  std::shared_ptr<const LifetimeSummaries> summaries;
+  if (!LifetimeSummariesIn.empty()) {
+    llvm::Expected<LifetimeSummaries> loaded =
+        LifetimeSummaries::Load(LifetimeSummariesIn);
+    QCHECK(loaded) << toString(loaded.takeError());
+    summaries = std::make_shared<LifetimeSummaries>(std::move(*loaded));
+  }
+
+  const clang::tooling::CompilationDatabase& compilations =
+      options->getCompilations();
+  std::vector<std::string> files = options->getSourcePathList();
+  if (files.empty()) files = compilations.getAllFiles();
+
+  std::mutex mu;
+  unsigned skipped = 0;
+  unsigned failed = 0;
+  llvm::ThreadPool pool(llvm::hardware_concurrency(Threads));
+  for (const std::string& file : files) {
+    if (!clang::tidy::lifetimes::InShard(file)) continue;
+    std::string output_path = clang::tidy::lifetimes::OutputPath(file);
+    if (Resume && llvm::sys::fs::exists(output_path)) {
+      ++skipped;
+      continue;
+    }
+    pool.async([&, file, output_path] {
+      clang::tooling::ClangTool tool(compilations, {file});
+      // Disable warnings, they are not what this tool is about.
+      tool.appendArgumentsAdjuster(clang::tooling::getInsertArgumentAdjuster(
+          "-w", clang::tooling::ArgumentInsertPosition::BEGIN));
+      clang::tidy::lifetimes::AnalyzerActionFactory factory(output_path,
+                                                            summaries);
+      if (tool.run(&factory) != 0) {
+        std::lock_guard<std::mutex> lock(mu);
+        llvm::errs() << "Failed to analyze " << file << "\n";
+        ++failed;
+      }
+    });
+  }
+  pool.wait();
+  if (skipped > 0) {
+    llvm::errs() << "Skipped " << skipped
+                 << " translation units that already have results\n";
+  }
+  if (!SummariesOut.empty()) {
+    if (llvm::Error err = clang::tidy::lifetimes::MergeSummaries()) {
+      llvm::errs() << "Failed to merge summaries: "
+                   << llvm::toString(std::move(err)) << "\n";
+      return 1;
+    }
+  }
+  return failed > 0 ? 1 : 0;
+}
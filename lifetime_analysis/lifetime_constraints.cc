@@ -8,6 +8,7 @@
 #include <cassert>
 #include <cstddef>
 #include <optional>
+#include <utility>
 #include <vector>
 
 #include "lifetime_annotations/lifetime.h"
@@ -17,22 +18,116 @@
 #include "clang/AST/Type.h"
 #include "clang/Analysis/FlowSensitive/DataflowLattice.h"
 #include "clang/Basic/LLVM.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Error.h"
 
 namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+void LifetimeConstraints::AddOutlivesConstraint(Lifetime shorter,
+                                                Lifetime longer) {
+  if (!outlives_constraints_.insert({shorter, longer}).second) return;
+  Lifetime shorter_rep = Representative(shorter);
+  Lifetime longer_rep = Representative(longer);
+  if (shorter_rep == longer_rep) return;
+  // If `shorter` already outlives `longer`, the new constraint closes a cycle,
+  // and all the classes on it become equal.
+  llvm::SmallVector<Lifetime> cycle = ClassesBetween(longer_rep, shorter_rep);
+  longer_[shorter_rep].push_back(longer);
+  if (!cycle.empty()) MergeClasses(cycle);
+}
+
 clang::dataflow::LatticeJoinEffect LifetimeConstraints::join(
     const LifetimeConstraints& other) {
-  bool changed = false;
-  for (auto p : other.outlives_constraints_) {
-    changed |= outlives_constraints_.insert(p).second;
+  size_t size_before = outlives_constraints_.size();
+  for (auto [shorter, longer] : other.outlives_constraints_) {
+    AddOutlivesConstraint(shorter, longer);
+  }
+  return outlives_constraints_.size() != size_before
+             ? clang::dataflow::LatticeJoinEffect::Changed
+             : clang::dataflow::LatticeJoinEffect::Unchanged;
+}
+
+llvm::ArrayRef<Lifetime> LifetimeConstraints::Members(
+    const Lifetime& rep) const {
+  auto it = members_.find(rep);
+  if (it == members_.end()) return rep;
+  return it->second;
+}
+
+llvm::SmallVector<Lifetime> LifetimeConstraints::ClassesBetween(
+    Lifetime from, Lifetime to) const {
+  // Depth-first search from `from`, recording for each class whether it can
+  // reach `to`. The graph of classes is acyclic, so a class that has already
+  // been visited and is no longer on the stack has its final answer.
+  llvm::DenseMap<Lifetime, bool> reaches_to;
+  reaches_to[to] = true;
+  reaches_to[from] = false;
+  // Classes on the DFS path, with the index of the next edge to visit.
+  std::vector<std::pair<Lifetime, size_t>> stack{{from, 0}};
+  while (!stack.empty()) {
+    auto [rep, next] = stack.back();
+    auto edges = longer_.find(rep);
+    if (edges != longer_.end() && next < edges->second.size()) {
+      ++stack.back().second;
+      Lifetime succ = Representative(edges->second[next]);
+      auto [it, inserted] = reaches_to.try_emplace(succ, false);
+      if (inserted) {
+        stack.push_back({succ, 0});
+      } else if (it->second) {
+        reaches_to[rep] = true;
+      }
+      continue;
+    }
+    stack.pop_back();
+    if (!stack.empty() && reaches_to[rep]) {
+      reaches_to[stack.back().first] = true;
+    }
+  }
+
+  llvm::SmallVector<Lifetime> result;
+  if (!reaches_to[from]) return result;
+  for (auto [rep, reaches] : reaches_to) {
+    if (reaches) result.push_back(rep);
   }
-  return changed ? clang::dataflow::LatticeJoinEffect::Changed
-                 : clang::dataflow::LatticeJoinEffect::Unchanged;
+  return result;
+}
+
+void LifetimeConstraints::MergeClasses(llvm::ArrayRef<Lifetime> reps) {
+  // Keep the representative of the largest class, so that as few lifetimes as
+  // possible need to be relabeled.
+  Lifetime target = *std::max_element(
+      reps.begin(), reps.end(), [this](Lifetime a, Lifetime b) {
+        return Members(a).size() < Members(b).size();
+      });
+  llvm::ArrayRef<Lifetime> old_target_members = Members(target);
+  llvm::SmallVector<Lifetime, 2> target_members(old_target_members.begin(),
+                                                old_target_members.end());
+  llvm::SmallVector<Lifetime, 2> target_longer = longer_.lookup(target);
+  for (Lifetime rep : reps) {
+    if (rep == target) continue;
+    for (Lifetime member : Members(rep)) {
+      representative_[member] = target;
+      target_members.push_back(member);
+    }
+    members_.erase(rep);
+    auto edges = longer_.find(rep);
+    if (edges != longer_.end()) {
+      target_longer.append(edges->second.begin(), edges->second.end());
+      longer_.erase(edges);
+    }
+  }
+  // Edges within the merged class aren't needed any more.
+  llvm::erase_if(target_longer, [this, target](Lifetime l) {
+    return Representative(l) == target;
+  });
+  members_[target] = std::move(target_members);
+  longer_[target] = std::move(target_longer);
 }
 
 namespace {
@@ -62,24 +157,23 @@ class LifetimeDSU {
 
 llvm::DenseSet<Lifetime> LifetimeConstraints::GetOutlivingLifetimes(
     const Lifetime l) const {
-  // TODO(veluca): here we could certainly reduce complexity, for example by
-  // constructing the constraint graph instead of iterating over all constraints
-  // each time.
-  std::vector<Lifetime> stack{l};
-  llvm::DenseSet<Lifetime> visited;
+  Lifetime l_rep = Representative(l);
+  std::vector<Lifetime> stack{l_rep};
+  llvm::DenseSet<Lifetime> visited{l_rep};
+  llvm::DenseSet<Lifetime> result;
   while (!stack.empty()) {
-    Lifetime v = stack.back();
+    Lifetime rep = stack.back();
     stack.pop_back();
-    if (visited.contains(v)) continue;
-    visited.insert(v);
-    for (auto [shorter, longer] : outlives_constraints_) {
-      if (shorter == v) {
-        stack.push_back(longer);
-      }
+    for (Lifetime member : Members(rep)) result.insert(member);
+    auto edges = longer_.find(rep);
+    if (edges == longer_.end()) continue;
+    for (Lifetime longer : edges->second) {
+      Lifetime longer_rep = Representative(longer);
+      if (visited.insert(longer_rep).second) stack.push_back(longer_rep);
     }
   }
-  visited.erase(l);
-  return visited;
+  result.erase(l);
+  return result;
 }
 
 llvm::Error LifetimeConstraints::ApplyToFunctionLifetimes(
@@ -10,7 +10,10 @@
 #include "lifetime_annotations/function_lifetimes.h"
 #include "lifetime_annotations/lifetime.h"
 #include "clang/Analysis/FlowSensitive/DataflowLattice.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/Support/Error.h"
 
 namespace clang {
@@ -35,12 +38,12 @@ class LifetimeConstraints {
       const FunctionLifetimes& replacement_callable);
 
   // Imposes the constraint shorter <= longer.
-  void AddOutlivesConstraint(Lifetime shorter, Lifetime longer) {
-    outlives_constraints_.insert({shorter, longer});
-  }
+  void AddOutlivesConstraint(Lifetime shorter, Lifetime longer);
 
   // Returns all the lifetimes that this set of constraints implies must outlive
   // the given lifetime l.
+  // This only visits the classes of equal lifetimes that outlive l, not the
+  // whole set of constraints.
   llvm::DenseSet<Lifetime> GetOutlivingLifetimes(Lifetime l) const;
 
   // Merges this set of constraints with the provided constraints, returning
@@ -60,8 +63,40 @@ class LifetimeConstraints {
   }
 
  private:
+  // Returns the representative of the class of lifetimes that the constraints
+  // imply are equal to `l`.
+  Lifetime Representative(Lifetime l) const {
+    auto it = representative_.find(l);
+    return it == representative_.end() ? l : it->second;
+  }
+
+  // Returns the lifetimes in the class whose representative is `rep`.
+  llvm::ArrayRef<Lifetime> Members(const Lifetime& rep) const;
+
+  // Returns the representatives of all the classes that lie on a path from the
+  // class of `from` to the class of `to`, including both; returns an empty
+  // vector if there is no such path.
+  llvm::SmallVector<Lifetime> ClassesBetween(Lifetime from, Lifetime to) const;
+
+  // Merges the classes with the given representatives into one.
+  void MergeClasses(llvm::ArrayRef<Lifetime> reps);
+
   // Constraints of the form p.first <= p.second
   llvm::DenseSet<std::pair<Lifetime, Lifetime>> outlives_constraints_;
+
+  // The same constraints, as a graph over the classes of lifetimes that
+  // outlive each other (i.e. the strongly connected components of the graph of
+  // `outlives_constraints_`). This is kept up to date as constraints are added,
+  // so queries don't need to recompute it.
+
+  // Maps lifetimes to the representative of their class. Lifetimes that aren't
+  // in the map are the representatives of classes with a single member.
+  llvm::DenseMap<Lifetime, Lifetime> representative_;
+  // The members of each class with more than one member, by representative.
+  llvm::DenseMap<Lifetime, llvm::SmallVector<Lifetime, 2>> members_;
+  // Maps the representative of each class to lifetimes (which may not be
+  // representatives) in the classes that must outlive it.
+  llvm::DenseMap<Lifetime, llvm::SmallVector<Lifetime, 2>> longer_;
 };
 
 }  // namespace lifetimes
@@ -0,0 +1,71 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "lifetime_analysis/lifetime_constraints.h"
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lifetime_annotations/lifetime.h"
+#include "clang/Analysis/FlowSensitive/DataflowLattice.h"
+
+namespace clang {
+namespace tidy {
+namespace lifetimes {
+namespace {
+
+using testing::IsEmpty;
+using testing::UnorderedElementsAre;
+
+TEST(LifetimeConstraintsTest, OutlivingLifetimesAreTransitive) {
+  Lifetime a = Lifetime::CreateVariable();
+  Lifetime b = Lifetime::CreateVariable();
+  Lifetime c = Lifetime::CreateVariable();
+  LifetimeConstraints constraints;
+  constraints.AddOutlivesConstraint(a, b);
+  constraints.AddOutlivesConstraint(b, c);
+
+  EXPECT_THAT(constraints.GetOutlivingLifetimes(a), UnorderedElementsAre(b, c));
+  EXPECT_THAT(constraints.GetOutlivingLifetimes(b), UnorderedElementsAre(c));
+  EXPECT_THAT(constraints.GetOutlivingLifetimes(c), IsEmpty());
+}
+
+TEST(LifetimeConstraintsTest, CyclesMakeLifetimesEqual) {
+  Lifetime a = Lifetime::CreateVariable();
+  Lifetime b = Lifetime::CreateVariable();
+  Lifetime c = Lifetime::CreateVariable();
+  Lifetime d = Lifetime::CreateVariable();
+  LifetimeConstraints constraints;
+  constraints.AddOutlivesConstraint(a, b);
+  constraints.AddOutlivesConstraint(b, c);
+  constraints.AddOutlivesConstraint(c, d);
+  constraints.AddOutlivesConstraint(c, a);
+
+  EXPECT_THAT(constraints.GetOutlivingLifetimes(a),
+              UnorderedElementsAre(b, c, d));
+  EXPECT_THAT(constraints.GetOutlivingLifetimes(b),
+              UnorderedElementsAre(a, c, d));
+  EXPECT_THAT(constraints.GetOutlivingLifetimes(d), IsEmpty());
+}
+
+TEST(LifetimeConstraintsTest, Join) {
+  Lifetime a = Lifetime::CreateVariable();
+  Lifetime b = Lifetime::CreateVariable();
+  Lifetime c = Lifetime::CreateVariable();
+  LifetimeConstraints constraints;
+  constraints.AddOutlivesConstraint(a, b);
+  LifetimeConstraints other;
+  other.AddOutlivesConstraint(b, c);
+  other.AddOutlivesConstraint(b, a);
+
+  EXPECT_EQ(constraints.join(other), dataflow::LatticeJoinEffect::Changed);
+  EXPECT_EQ(constraints.join(other), dataflow::LatticeJoinEffect::Unchanged);
+  EXPECT_THAT(constraints.GetOutlivingLifetimes(a), UnorderedElementsAre(b, c));
+  EXPECT_THAT(constraints.GetOutlivingLifetimes(b), UnorderedElementsAre(a, c));
+  EXPECT_THAT(constraints.AllConstraints(), testing::SizeIs(3));
+}
+
+}  // namespace
+}  // namespace lifetimes
+}  // namespace tidy
+}  // namespace clang
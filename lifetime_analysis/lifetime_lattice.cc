@@ -64,9 +64,7 @@ clang::dataflow::LatticeJoinEffect LifetimeLattice::join(
 
   auto effect = Constraints().join(other.Constraints());
 
-  PointsToMap joined_points_to_map = PointsTo().Union(other.PointsTo());
-  if (PointsTo() != joined_points_to_map) {
-    PointsTo() = std::move(joined_points_to_map);
+  if (PointsTo().UnionWith(other.PointsTo())) {
     effect = clang::dataflow::LatticeJoinEffect::Changed;
   }
 
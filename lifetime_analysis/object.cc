@@ -20,18 +20,37 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
-Object::Object(Lifetime lifetime, clang::QualType type,
+namespace {
+
+// The table of objects created without an `ObjectRepository`, in tests.
+ObjectTable& TestObjectTable() {
+  thread_local ObjectTable table;
+  return table;
+}
+
+}  // namespace
+
+Object::Object(ObjectTable& table, Lifetime lifetime, clang::QualType type,
                std::optional<FunctionLifetimes> func_lifetimes)
-    : lifetime_(lifetime),
-      type_(type),
-      func_lifetimes_(std::move(func_lifetimes)) {
+    : table_(&table),
+      index_(table.Add(this)),
+      func_lifetimes_index_(
+          func_lifetimes.has_value()
+              ? table.AddFuncLifetimes(std::move(*func_lifetimes))
+              : kNoFuncLifetimes),
+      lifetime_(lifetime),
+      type_(type) {
   assert(!type.isNull());
 }
 
+Object::Object(Lifetime lifetime, clang::QualType type,
+               std::optional<FunctionLifetimes> func_lifetimes)
+    : Object(TestObjectTable(), lifetime, type, std::move(func_lifetimes)) {}
+
 std::string Object::DebugString() const {
   std::string result = absl::StrFormat("p%p %s", this, lifetime_.DebugString());
-  if (func_lifetimes_.has_value()) {
-    absl::StrAppend(&result, " (fn: ", func_lifetimes_->DebugString(), ")");
+  if (const FunctionLifetimes* func_lifetimes = GetFuncLifetimes()) {
+    absl::StrAppend(&result, " (fn: ", func_lifetimes->DebugString(), ")");
   }
   if (!type_.isNull()) {
     absl::StrAppend(&result, " (", type_.getAsString(), ")");
@@ -5,9 +5,13 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_OBJECT_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_OBJECT_H_
 
+#include <deque>
+#include <limits>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <utility>
+#include <vector>
 
 #include "lifetime_annotations/function_lifetimes.h"
 #include "lifetime_annotations/lifetime.h"
@@ -17,6 +21,49 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+class Object;
+
+// Assigns dense indices to `Object`s, so that sets of objects can be stored as
+// bitsets (see `ObjectSet`). Each `ObjectRepository` has its own table.
+//
+// The table also holds the function lifetimes of the objects that represent
+// functions. Few objects do, so keeping them out of line keeps `Object` small
+// and trivially destructible.
+class ObjectTable {
+ public:
+  ObjectTable() = default;
+
+  ObjectTable(const ObjectTable&) = delete;
+  ObjectTable& operator=(const ObjectTable&) = delete;
+
+  // Returns the object with the given index.
+  const Object* Get(unsigned index) const { return objects_[index]; }
+
+  // Returns the number of objects in the table.
+  unsigned size() const { return objects_.size(); }
+
+ private:
+  friend class Object;
+
+  unsigned Add(const Object* object) {
+    objects_.push_back(object);
+    return objects_.size() - 1;
+  }
+
+  unsigned AddFuncLifetimes(FunctionLifetimes func_lifetimes) {
+    func_lifetimes_.push_back(std::move(func_lifetimes));
+    return func_lifetimes_.size() - 1;
+  }
+
+  const FunctionLifetimes& GetFuncLifetimes(unsigned index) const {
+    return func_lifetimes_[index];
+  }
+
+  std::vector<const Object*> objects_;
+  // A deque, so that references to its elements stay valid.
+  std::deque<FunctionLifetimes> func_lifetimes_;
+};
+
 // Any object that has a lifetime. Multiple objects might have the same
 // lifetime, but two equal objects always have the same lifetime.
 // An object may also represent a function whose lifetime signature is
@@ -28,9 +75,15 @@ class Object {
   Object& operator=(const Object&) = delete;
   Object& operator=(Object&&) = delete;
 
-  // Creates an object with the given lifetime and type.
-  // This constructor should only be used in tests. Outside of tests, use
-  // one of the ObjectRepository::CreateObject...() functions.
+  // Creates an object with the given lifetime and type, and adds it to `table`.
+  // Outside of tests, use one of the ObjectRepository::CreateObject...()
+  // functions instead.
+  Object(ObjectTable& table, Lifetime lifetime, clang::QualType type,
+         std::optional<FunctionLifetimes> func_lifetimes);
+
+  // Creates an object with the given lifetime and type, in a table shared by
+  // all objects created this way on the current thread.
+  // This constructor should only be used in tests.
   Object(Lifetime lifetime, clang::QualType type,
          std::optional<FunctionLifetimes> func_lifetimes);
 
@@ -39,19 +92,30 @@ class Object {
 
   clang::QualType Type() const { return type_; }
 
+  // Returns the table that the object belongs to, and its index there.
+  const ObjectTable& Table() const { return *table_; }
+  unsigned Index() const { return index_; }
+
   // Returns a textual representation of the object for debug logging.
   std::string DebugString() const;
 
-  // Returns the lifetimes of function that this object represents, if known;
-  // note that lifetimes may not be known even if GetFunc() returns non-null.
-  const std::optional<FunctionLifetimes>& GetFuncLifetimes() const {
-    return func_lifetimes_;
+  // Returns the lifetimes of function that this object represents, if known,
+  // or null otherwise.
+  const FunctionLifetimes* GetFuncLifetimes() const {
+    if (func_lifetimes_index_ == kNoFuncLifetimes) return nullptr;
+    return &table_->GetFuncLifetimes(func_lifetimes_index_);
   }
 
  private:
+  static constexpr unsigned kNoFuncLifetimes =
+      std::numeric_limits<unsigned>::max();
+
+  const ObjectTable* table_;
+  unsigned index_;
+  // Index of the function lifetimes in `table_`, or `kNoFuncLifetimes`.
+  unsigned func_lifetimes_index_;
   Lifetime lifetime_;
   clang::QualType type_;
-  std::optional<FunctionLifetimes> func_lifetimes_;
 };
 
 std::ostream& operator<<(std::ostream& os, Object object);
@@ -895,7 +895,7 @@ const Object* ObjectRepository::CreateObject(clang::QualType type,
 
 template <typename... Args>
 const Object* ObjectRepository::ConstructObject(Args&&... args) {
-  return new (object_allocator_.Allocate()) Object(args...);
+  return new (object_allocator_.Allocate()) Object(*object_table_, args...);
 }
 
 // Clones an object and its base classes and fields, if any.
@@ -905,8 +905,12 @@ const Object* ObjectRepository::CloneObject(const Object* object) {
     const Object* new_object;
   };
   auto clone = [this](const Object* obj) {
-    auto new_obj = ConstructObject(obj->GetLifetime(), obj->Type(),
-                                   obj->GetFuncLifetimes());
+    std::optional<FunctionLifetimes> func_lifetimes;
+    if (obj->GetFuncLifetimes() != nullptr) {
+      func_lifetimes = *obj->GetFuncLifetimes();
+    }
+    auto new_obj =
+        ConstructObject(obj->GetLifetime(), obj->Type(), func_lifetimes);
     initial_points_to_map_.SetPointerPointsToSet(
         new_obj, initial_points_to_map_.GetPointerPointsToSet(obj));
     return new_obj;
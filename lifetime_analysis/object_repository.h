@@ -6,6 +6,7 @@
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_OBJECT_REPOSITORY_H_
 
 #include <cstddef>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -250,6 +251,10 @@ class ObjectRepository {
   // Owns all the `const Object*` members of the object repository.
   llvm::SpecificBumpPtrAllocator<Object> object_allocator_;
 
+  // Indexes the objects in `object_allocator_`. Held by pointer so that it
+  // stays put when the repository is moved.
+  std::unique_ptr<ObjectTable> object_table_ = std::make_unique<ObjectTable>();
+
   // Map from each variable declaration to the object which it declares.
   MapType object_repository_;
 
@@ -4,6 +4,9 @@
 
 #include "lifetime_analysis/object_set.h"
 
+#include <algorithm>
+#include <cassert>
+#include <functional>
 #include <string>
 #include <vector>
 
@@ -14,14 +17,150 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+namespace {
+
+// Orders objects by table and index.
+bool ObjectLess(const Object* a, const Object* b) {
+  if (&a->Table() != &b->Table()) {
+    return std::less<const ObjectTable*>()(&a->Table(), &b->Table());
+  }
+  return a->Index() < b->Index();
+}
+
+}  // namespace
+
 std::string ObjectSet::DebugString() const {
   std::vector<std::string> parts;
-  for (const Object* object : objects_) {
+  for (const Object* object : *this) {
     parts.push_back(object->DebugString());
   }
   return absl::StrJoin(parts, ", ");
 }
 
+ObjectSet::const_iterator ObjectSet::begin() const {
+  const_iterator result;
+  if (table_) {
+    result.table_ = table_;
+    result.bit_ = bits_.begin();
+  } else {
+    result.object_ = objects_.begin();
+  }
+  return result;
+}
+
+ObjectSet::const_iterator ObjectSet::end() const {
+  const_iterator result;
+  if (table_) {
+    result.table_ = table_;
+    result.bit_ = bits_.end();
+  } else {
+    result.object_ = objects_.end();
+  }
+  return result;
+}
+
+bool ObjectSet::Contains(const Object* object) const {
+  if (table_) {
+    return &object->Table() == table_ && bits_.test(object->Index());
+  }
+  return std::binary_search(objects_.begin(), objects_.end(), object,
+                            ObjectLess);
+}
+
+bool ObjectSet::Contains(const ObjectSet& other) const {
+  if (table_ && table_ == other.table_) {
+    return bits_.contains(other.bits_);
+  }
+  if (!table_ && !other.table_) {
+    return std::includes(objects_.begin(), objects_.end(),
+                         other.objects_.begin(), other.objects_.end(),
+                         ObjectLess);
+  }
+  for (const Object* object : other) {
+    if (!Contains(object)) {
+      return false;
+    }
+  }
+  return true;
+}
+
+ObjectSet ObjectSet::Intersection(const ObjectSet& other) const {
+  ObjectSet result;
+  if (table_ && table_ == other.table_) {
+    result.table_ = table_;
+    result.bits_ = bits_ & other.bits_;
+    result.Normalize();
+    return result;
+  }
+  const ObjectSet& smaller = size() <= other.size() ? *this : other;
+  const ObjectSet& larger = &smaller == this ? other : *this;
+  for (const Object* obj : smaller) {
+    if (larger.Contains(obj)) result.Add(obj);
+  }
+  return result;
+}
+
+void ObjectSet::Add(const Object* object) {
+  if (table_) {
+    if (&object->Table() == table_) {
+      bits_.set(object->Index());
+      return;
+    }
+    ConvertToInline();
+  }
+  auto iter =
+      std::lower_bound(objects_.begin(), objects_.end(), object, ObjectLess);
+  if (iter != objects_.end() && *iter == object) return;
+  objects_.insert(iter, object);
+  Normalize();
+}
+
+void ObjectSet::Add(const ObjectSet& other) {
+  // `other` can only be a bitset if it's larger than `kMaxInline`, so the
+  // union is large enough to be a bitset too.
+  if (other.table_ &&
+      (table_ == other.table_ || (!table_ && ConvertToBitset(other.table_)))) {
+    bits_ |= other.bits_;
+    return;
+  }
+  for (const Object* object : other) {
+    Add(object);
+  }
+}
+
+void ObjectSet::Normalize() {
+  if (table_) {
+    if (bits_.count() <= kMaxInline) ConvertToInline();
+  } else if (objects_.size() > kMaxInline) {
+    ConvertToBitset(&objects_.front()->Table());
+  }
+}
+
+bool ObjectSet::ConvertToBitset(const ObjectTable* table) {
+  assert(!table_);
+  for (const Object* object : objects_) {
+    if (&object->Table() != table) return false;
+  }
+  for (const Object* object : objects_) {
+    bits_.set(object->Index());
+  }
+  objects_.clear();
+  table_ = table;
+  return true;
+}
+
+void ObjectSet::ConvertToInline() {
+  assert(table_);
+  assert(objects_.empty());
+  // Iterating over the bitset yields ascending indices in a single table, so
+  // `objects_` comes out sorted.
+  for (unsigned index : bits_) {
+    objects_.push_back(table_->Get(index));
+  }
+  bits_.clear();
+  table_ = nullptr;
+}
+
 }  // namespace lifetimes
 }  // namespace tidy
 }  // namespace clang
@@ -7,20 +7,70 @@
 
 #include <cstddef>
 #include <initializer_list>
+#include <iterator>
 #include <ostream>
 #include <string>
 
 #include "lifetime_analysis/object.h"
-#include "llvm/ADT/SmallSet.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/SparseBitVector.h"
 
 namespace clang {
 namespace tidy {
 namespace lifetimes {
 
 // A set of `Object`s.
+//
+// Small sets are stored inline, as a sorted array. Sets with more than
+// `kMaxInline` objects, all from the same `ObjectTable`, are stored as a sparse
+// bitset of the objects' indices in the table, so that unions and
+// intersections of them operate on whole words. Which of the two a set uses
+// only depends on its contents.
 class ObjectSet {
  public:
-  using const_iterator = llvm::SmallSet<const Object*, 2>::const_iterator;
+  // Iterates over the objects in the set, ordered by table and index.
+  class const_iterator {
+   public:
+    using iterator_category = std::forward_iterator_tag;
+    using value_type = const Object*;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const value_type*;
+    using reference = value_type;
+
+    const_iterator() = default;
+
+    value_type operator*() const {
+      return table_ ? table_->Get(*bit_) : *object_;
+    }
+
+    const_iterator& operator++() {
+      if (table_) {
+        ++bit_;
+      } else {
+        ++object_;
+      }
+      return *this;
+    }
+    const_iterator operator++(int) {
+      const_iterator result = *this;
+      ++*this;
+      return result;
+    }
+
+    bool operator==(const const_iterator& other) const {
+      return table_ ? bit_ == other.bit_ : object_ == other.object_;
+    }
+    bool operator!=(const const_iterator& other) const {
+      return !(*this == other);
+    }
+
+   private:
+    friend class ObjectSet;
+
+    const Object* const* object_ = nullptr;
+    llvm::SparseBitVector<>::iterator bit_;
+    const ObjectTable* table_ = nullptr;
+  };
   using value_type = const Object*;
 
   ObjectSet() = default;
@@ -33,36 +83,27 @@ class ObjectSet {
   // Initializes the object set with `objects`.
   ObjectSet(std::initializer_list<const Object*> objects) {
     for (const Object* object : objects) {
-      objects_.insert(object);
+      Add(object);
     }
   }
 
   // Returns a human-readable string representation of the object set.
   std::string DebugString() const;
 
-  const_iterator begin() const { return objects_.begin(); }
+  const_iterator begin() const;
 
-  const_iterator end() const { return objects_.end(); }
+  const_iterator end() const;
 
-  bool empty() const { return objects_.empty(); }
+  bool empty() const { return table_ == nullptr && objects_.empty(); }
 
-  size_t size() const { return objects_.size(); }
+  size_t size() const { return table_ ? bits_.count() : objects_.size(); }
 
   // Returns whether this set contains `object`.
-  bool Contains(const Object* object) const {
-    return objects_.contains(object);
-  }
+  bool Contains(const Object* object) const;
 
   // Returns whether this set contains all objects in `other`, i.e. whether
   // this set is a superset of `other`.
-  bool Contains(const ObjectSet& other) const {
-    for (const Object* object : other) {
-      if (!Contains(object)) {
-        return false;
-      }
-    }
-    return true;
-  }
+  bool Contains(const ObjectSet& other) const;
 
   // Returns a `ObjectSet` containing the union of the pointees from this
   // `ObjectSet` and `other`.
@@ -74,34 +115,46 @@ class ObjectSet {
 
   // Returns a `ObjectSet` containing the intersection of the pointees from this
   // `ObjectSet` and `other`.
-  ObjectSet Intersection(const ObjectSet& other) const {
-    ObjectSet result;
-    for (const Object* obj : *this) {
-      if (other.Contains(obj)) result.Add(obj);
-    }
-    return result;
-  }
+  ObjectSet Intersection(const ObjectSet& other) const;
 
   // Adds `object` to this object set.
-  void Add(const Object* object) { objects_.insert(object); }
+  void Add(const Object* object);
 
   // Adds the `other` objects to this object set.
-  void Add(const ObjectSet& other) {
-    objects_.insert(other.objects_.begin(), other.objects_.end());
-  }
+  void Add(const ObjectSet& other);
 
   bool operator==(const ObjectSet& other) const {
-    return objects_ == other.objects_;
+    if (table_ != other.table_) return false;
+    return table_ ? bits_ == other.bits_ : objects_ == other.objects_;
   }
   bool operator!=(const ObjectSet& other) const { return !(*this == other); }
 
  private:
+  // The maximum number of objects in a set stored inline.
+  static constexpr size_t kMaxInline = 4;
+
   friend std::ostream& operator<<(std::ostream& os,
                                   const ObjectSet& object_set) {
     return os << object_set.DebugString();
   }
 
-  llvm::SmallSet<const Object*, 2> objects_;
+  // Switches to a bitset if the inline array is too large and all its objects
+  // are from the same table, or back to the inline array if the bitset is
+  // small enough.
+  void Normalize();
+
+  // Switches to a bitset of the objects in `table`, whatever the size of the
+  // set. Returns false, and does nothing, if some object isn't in `table`.
+  bool ConvertToBitset(const ObjectTable* table);
+
+  // Switches to the inline array.
+  void ConvertToInline();
+
+  // The objects in the set, sorted by table and index, if `table_` is null.
+  llvm::SmallVector<const Object*, kMaxInline> objects_;
+  // If not null, the set is stored as the indices of its objects in `table_`.
+  const ObjectTable* table_ = nullptr;
+  llvm::SparseBitVector<> bits_;
 };
 
 }  // namespace lifetimes
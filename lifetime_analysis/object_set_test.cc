@@ -4,6 +4,7 @@
 
 #include "lifetime_analysis/object_set.h"
 
+#include <deque>
 #include <optional>
 
 #include "gmock/gmock.h"
@@ -130,6 +131,48 @@ TEST(ObjectSet, Equality) {
       {});
 }
 
+TEST(ObjectSet, LargeSets) {
+  runOnCodeWithLifetimeHandlers(
+      "",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext&) {
+        ObjectTable table;
+        std::deque<Object> objects;
+        for (int i = 0; i < 10; ++i) {
+          objects.emplace_back(table, Lifetime::CreateLocal(),
+                               ast_context.IntTy, std::nullopt);
+        }
+        ObjectSet evens, odds, all;
+        for (int i = 0; i < 10; ++i) {
+          (i % 2 ? odds : evens).Add(&objects[i]);
+        }
+        for (int i = 9; i >= 0; --i) all.Add(&objects[i]);
+
+        EXPECT_EQ(evens.size(), 5u);
+        EXPECT_EQ(evens.Union(odds), all);
+        EXPECT_TRUE(all.Contains(evens));
+        EXPECT_FALSE(evens.Contains(all));
+        EXPECT_TRUE(all.Contains(&objects[3]));
+        EXPECT_FALSE(evens.Contains(&objects[3]));
+        EXPECT_TRUE(evens.Intersection(odds).empty());
+        EXPECT_EQ(all.Intersection(evens), evens);
+        EXPECT_THAT(
+            all.Intersection({&objects[1], &objects[2], &objects[3]}),
+            UnorderedElementsAre(&objects[1], &objects[2], &objects[3]));
+
+        // Objects from another table can be mixed in.
+        Object other(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        ObjectSet mixed = evens;
+        mixed.Add(&other);
+        EXPECT_EQ(mixed.size(), 6u);
+        EXPECT_TRUE(mixed.Contains(evens));
+        EXPECT_TRUE(mixed.Contains(&other));
+        EXPECT_EQ(mixed.Intersection(all), evens);
+        EXPECT_NE(mixed, evens);
+      },
+      {});
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
@@ -92,6 +92,40 @@ bool MayPointTo(clang::QualType pointer_type, clang::QualType object_type,
   return PointeesCompatible(pointee_type, object_type, ast_context);
 }
 
+bool PointerCompatibilityCache::PointeesCompatible(
+    clang::QualType pointee_type, clang::QualType object_type) {
+  assert(!pointee_type.isNull());
+  assert(!object_type.isNull());
+
+  auto [it, inserted] = pointees_compatible_.try_emplace(
+      {pointee_type.getCanonicalType(), object_type.getCanonicalType()},
+      false);
+  if (!inserted) {
+    ++num_hits_;
+    return it->second;
+  }
+  ++num_misses_;
+  // `it` may be invalidated by other insertions, but the uncached function
+  // doesn't insert anything.
+  it->second = lifetimes::PointeesCompatible(pointee_type, object_type,
+                                             ast_context_);
+  return it->second;
+}
+
+bool PointerCompatibilityCache::MayPointTo(clang::QualType pointer_type,
+                                           clang::QualType object_type) {
+  assert(!pointer_type.isNull());
+  assert(!object_type.isNull());
+
+  clang::QualType pointee_type = PointeeType(pointer_type.getCanonicalType());
+
+  if (pointee_type.isNull()) {
+    llvm::report_fatal_error("pointee_type is null");
+  }
+
+  return PointeesCompatible(pointee_type, object_type);
+}
+
 }  // namespace lifetimes
 }  // namespace tidy
 }  // namespace clang
@@ -5,7 +5,13 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_POINTER_COMPATIBILITY_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_POINTER_COMPATIBILITY_H_
 
+#include <cstdint>
+#include <utility>
+
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/Type.h"
+#include "clang/AST/TypeOrdering.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace clang {
 namespace tidy {
@@ -28,6 +34,37 @@ bool PointeesCompatible(clang::QualType pointee_type,
 bool MayPointTo(clang::QualType pointer_type, clang::QualType object_type,
                 clang::ASTContext& ast_context);
 
+// Memoizes `PointeesCompatible()` (and, through it, `MayPointTo()`) for the
+// types of one `ASTContext`, for which the answer for a given pair of types
+// never changes.
+class PointerCompatibilityCache {
+ public:
+  explicit PointerCompatibilityCache(clang::ASTContext& ast_context)
+      : ast_context_(ast_context) {}
+
+  PointerCompatibilityCache(const PointerCompatibilityCache&) = delete;
+  PointerCompatibilityCache& operator=(const PointerCompatibilityCache&) =
+      delete;
+
+  // Same as the free functions above, for the cache's `ASTContext`.
+  bool PointeesCompatible(clang::QualType pointee_type,
+                          clang::QualType object_type);
+  bool MayPointTo(clang::QualType pointer_type, clang::QualType object_type);
+
+  // The number of queries that were answered from the cache, and of those
+  // that weren't.
+  int64_t NumHits() const { return num_hits_; }
+  int64_t NumMisses() const { return num_misses_; }
+
+ private:
+  clang::ASTContext& ast_context_;
+  // Keyed by the canonical pointee and object types.
+  llvm::DenseMap<std::pair<clang::QualType, clang::QualType>, bool>
+      pointees_compatible_;
+  int64_t num_hits_ = 0;
+  int64_t num_misses_ = 0;
+};
+
 }  // namespace lifetimes
 }  // namespace tidy
 }  // namespace clang
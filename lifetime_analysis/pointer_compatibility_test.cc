@@ -194,6 +194,40 @@ TEST(PointerCompatibilityTest, MayPointTo) {
       {});
 }
 
+TEST(PointerCompatibilityTest, Cache) {
+  runOnCodeWithLifetimeHandlers(
+      "class Base {};"
+      "class Derived : public Base {};"
+      "class Unrelated {};",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext&) {
+        clang::QualType base_type = getClassType("Base", ast_context);
+        clang::QualType derived_type = getClassType("Derived", ast_context);
+        clang::QualType unrelated_type = getClassType("Unrelated", ast_context);
+        clang::QualType pointer_to_base = ast_context.getPointerType(base_type);
+
+        PointerCompatibilityCache cache(
+            const_cast<clang::ASTContext&>(ast_context));
+        EXPECT_TRUE(cache.MayPointTo(pointer_to_base, derived_type));
+        EXPECT_FALSE(cache.MayPointTo(pointer_to_base, unrelated_type));
+        EXPECT_EQ(cache.NumHits(), 0);
+        EXPECT_EQ(cache.NumMisses(), 2);
+
+        // The same query, directly or through `MayPointTo()`, hits the cache.
+        EXPECT_TRUE(cache.MayPointTo(pointer_to_base, derived_type));
+        EXPECT_TRUE(cache.PointeesCompatible(base_type, derived_type));
+        EXPECT_FALSE(cache.PointeesCompatible(base_type, unrelated_type));
+        EXPECT_EQ(cache.NumHits(), 3);
+        EXPECT_EQ(cache.NumMisses(), 2);
+
+        // Differently qualified types are cached separately.
+        EXPECT_TRUE(
+            cache.PointeesCompatible(base_type.withConst(), derived_type));
+        EXPECT_EQ(cache.NumMisses(), 3);
+      },
+      {});
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
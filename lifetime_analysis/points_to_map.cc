@@ -4,7 +4,9 @@
 
 #include "lifetime_analysis/points_to_map.h"
 
+#include <algorithm>
 #include <cassert>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -24,43 +26,92 @@ namespace tidy {
 namespace lifetimes {
 
 bool PointsToMap::operator==(const PointsToMap& other) const {
-  return pointer_points_tos_ == other.pointer_points_tos_ &&
-         expr_objects_ == other.expr_objects_;
+  if (!(pointer_points_tos_ == other.pointer_points_tos_)) return false;
+  if (expr_objects_ == other.expr_objects_) {
+    return expr_objects_version_ == other.expr_objects_version_;
+  }
+  const auto* exprs = ExprObjects();
+  const auto* other_exprs = other.ExprObjects();
+  if (!exprs || !other_exprs) {
+    return (!exprs || exprs->empty()) && (!other_exprs || other_exprs->empty());
+  }
+  return *exprs == *other_exprs;
 }
 
 std::string PointsToMap::DebugString() const {
   std::vector<std::string> parts;
-  for (const auto& [pointer, points_to] : pointer_points_tos_) {
+  for (const auto& [pointer, points_to] : pointer_points_tos_.Get()) {
     parts.push_back(absl::StrFormat("%s -> %s", pointer->DebugString(),
                                     points_to.DebugString()));
   }
-  for (const auto& [expr, objects] : expr_objects_) {
-    parts.push_back(absl::StrFormat("%s (%p) -> %s", expr->getStmtClassName(),
-                                    expr, objects.DebugString()));
+  if (const auto* exprs = ExprObjects()) {
+    for (const auto& [expr, objects] : *exprs) {
+      parts.push_back(absl::StrFormat("%s (%p) -> %s",
+                                      expr->getStmtClassName(), expr,
+                                      objects.DebugString()));
+    }
   }
   return absl::StrJoin(parts, "\n");
 }
 
-PointsToMap PointsToMap::Union(const PointsToMap& other) const {
-  PointsToMap result;
-
-  result.pointer_points_tos_ = pointer_points_tos_;
-  for (const auto& [pointer, points_to] : other.pointer_points_tos_) {
-    result.pointer_points_tos_[pointer].Add(points_to);
-  }
-  // TODO(mboehme): Do we even need to perform a union on expression object
-  // sets?
-  result.expr_objects_ = expr_objects_;
-  for (const auto& [expr, objects] : other.expr_objects_) {
-    result.expr_objects_[expr].Add(objects);
+namespace {
+
+// Adds the entries of `other` to `result`. Only copies `result` if an entry of
+// `other` isn't already included in it. Returns whether `result` changed.
+template <typename KeyT>
+bool UnionInto(CopyOnWriteObjectSetMap<KeyT>& result,
+               const CopyOnWriteObjectSetMap<KeyT>& other) {
+  if (result.SharesStorageWith(other)) return false;
+  bool changed = false;
+  for (const auto& [key, objects] : other.Get()) {
+    auto iter = result.Get().find(key);
+    if (iter != result.Get().end() && iter->second.Contains(objects)) {
+      continue;
+    }
+    result.Mutable()[key].Add(objects);
+    changed = true;
   }
+  return changed;
+}
+
+}  // namespace
 
+PointsToMap PointsToMap::Union(const PointsToMap& other) const {
+  PointsToMap result = *this;
+  result.UnionWith(other);
   return result;
 }
 
+bool PointsToMap::UnionWith(const PointsToMap& other) {
+  bool changed = UnionInto(pointer_points_tos_, other.pointer_points_tos_);
+
+  if (expr_objects_ == other.expr_objects_) {
+    if (other.expr_objects_version_ > expr_objects_version_) {
+      expr_objects_version_ = other.expr_objects_version_;
+      changed = true;
+    }
+  } else if (!expr_objects_) {
+    changed = changed || !other.ExprObjects()->empty();
+    expr_objects_ = other.expr_objects_;
+    expr_objects_version_ = other.expr_objects_version_;
+  } else if (other.expr_objects_) {
+    // The maps are from different analyses (or tests), so merge the tables.
+    auto merged = std::make_shared<ExprObjectSets>(*expr_objects_);
+    for (const auto& [expr, objects] : other.expr_objects_->objects) {
+      auto [iter, inserted] = merged->objects.try_emplace(expr);
+      if (inserted || !iter->second.Contains(objects)) {
+        iter->second.Add(objects);
+        changed = true;
+      }
+    }
+    UseExprObjectSets(std::move(merged));
+  }
+  return changed;
+}
+
 ObjectSet PointsToMap::GetPointerPointsToSet(const Object* pointer) const {
-  auto iter = pointer_points_tos_.find(pointer);
-  if (iter == pointer_points_tos_.end()) {
+  auto iter = pointer_points_tos_.Get().find(pointer);
+  if (iter == pointer_points_tos_.Get().end()) {
     return ObjectSet();
   }
   return iter->second;
@@ -68,7 +119,7 @@ ObjectSet PointsToMap::GetPointerPointsToSet(const Object* pointer) const {
 
 void PointsToMap::SetPointerPointsToSet(const Object* pointer,
                                         ObjectSet points_to) {
-  pointer_points_tos_[pointer] = std::move(points_to);
+  pointer_points_tos_.Mutable()[pointer] = std::move(points_to);
 }
 
 void PointsToMap::SetPointerPointsToSet(const ObjectSet& pointers,
@@ -80,15 +131,15 @@ void PointsToMap::SetPointerPointsToSet(const ObjectSet& pointers,
 
 void PointsToMap::ExtendPointerPointsToSet(const Object* pointer,
                                            const ObjectSet& points_to) {
-  ObjectSet& set = pointer_points_tos_[pointer];
+  ObjectSet& set = pointer_points_tos_.Mutable()[pointer];
   set.Add(points_to);
 }
 
 ObjectSet PointsToMap::GetPointerPointsToSet(const ObjectSet& pointers) const {
   ObjectSet result;
   for (const Object* pointer : pointers) {
-    auto iter = pointer_points_tos_.find(pointer);
-    if (iter != pointer_points_tos_.end()) {
+    auto iter = pointer_points_tos_.Get().find(pointer);
+    if (iter != pointer_points_tos_.Get().end()) {
       result.Add(iter->second);
     }
   }
@@ -107,30 +158,35 @@ ObjectSet PointsToMap::GetExprObjectSet(const clang::Expr* expr) const {
          expr->getType()->isArrayType() || expr->getType()->isFunctionType() ||
          expr->getType()->isBuiltinType());
 
-  auto iter = expr_objects_.find(expr);
-  if (iter == expr_objects_.end()) {
-    llvm::errs() << "Didn't find object set for expression:\n";
-    expr->dump();
-    llvm::report_fatal_error("Didn't find object set for expression");
+  if (const auto* exprs = ExprObjects()) {
+    auto iter = exprs->find(expr);
+    if (iter != exprs->end()) return iter->second;
   }
-  return iter->second;
+  llvm::errs() << "Didn't find object set for expression:\n";
+  expr->dump();
+  llvm::report_fatal_error("Didn't find object set for expression");
 }
 
 bool PointsToMap::ExprHasObjectSet(const clang::Expr* expr) const {
-  auto iter = expr_objects_.find(expr->IgnoreParens());
-  return (iter != expr_objects_.end());
+  const auto* exprs = ExprObjects();
+  return exprs && exprs->count(expr->IgnoreParens());
 }
 
 void PointsToMap::SetExprObjectSet(const clang::Expr* expr, ObjectSet objects) {
   assert(expr->isGLValue() || expr->getType()->isPointerType() ||
          expr->getType()->isArrayType() || expr->getType()->isBuiltinType());
-  expr_objects_[expr] = std::move(objects);
+  if (!expr_objects_) expr_objects_ = std::make_shared<ExprObjectSets>();
+  auto [iter, inserted] = expr_objects_->objects.try_emplace(expr);
+  if (inserted || !iter->second.Contains(objects)) {
+    iter->second.Add(objects);
+    expr_objects_version_ = ++expr_objects_->num_updates;
+  }
 }
 
 std::vector<const Object*> PointsToMap::GetAllPointersWithLifetime(
     Lifetime lifetime) const {
   std::vector<const Object*> result;
-  for (const auto& [pointer, _] : pointer_points_tos_) {
+  for (const auto& [pointer, _] : pointer_points_tos_.Get()) {
     if (pointer->GetLifetime() == lifetime) {
       result.push_back(pointer);
     }
@@ -5,6 +5,8 @@
 #ifndef DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_POINTS_TO_MAP_H_
 #define DEVTOOLS_RUST_CC_INTEROP_LIFETIME_ANALYSIS_POINTS_TO_MAP_H_
 
+#include <cstdint>
+#include <memory>
 #include <string>
 #include <vector>
 
@@ -18,6 +20,60 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+// A map from `KeyT` to `ObjectSet`, shared between copies until one of them is
+// modified, so that copying it is O(1).
+template <typename KeyT>
+class CopyOnWriteObjectSetMap {
+ public:
+  using MapT = llvm::DenseMap<KeyT, ObjectSet>;
+
+  // Returns the map for reading.
+  const MapT& Get() const { return map_ ? *map_ : Empty(); }
+
+  // Returns the map for modification, first copying it if it's shared.
+  MapT& Mutable() {
+    if (!map_) {
+      map_ = std::make_shared<MapT>();
+    } else if (map_.use_count() > 1) {
+      map_ = std::make_shared<MapT>(*map_);
+    }
+    return *map_;
+  }
+
+  // Returns whether this map is known to be equal to `other` because they
+  // share their storage.
+  bool SharesStorageWith(const CopyOnWriteObjectSetMap& other) const {
+    return map_ == other.map_;
+  }
+
+  bool operator==(const CopyOnWriteObjectSetMap& other) const {
+    return SharesStorageWith(other) || Get() == other.Get();
+  }
+
+ private:
+  static const MapT& Empty() {
+    static const MapT* empty = new MapT();
+    return *empty;
+  }
+
+  // Null if the map is empty and has never been modified.
+  std::shared_ptr<MapT> map_;
+};
+
+// The object sets of expressions, shared by all the `PointsToMap`s of an
+// analysis (see `PointsToMap::UseExprObjectSets()`).
+//
+// An expression's object set is computed where the expression is evaluated,
+// and only read there or in blocks that the evaluation flows into, so it
+// doesn't need to be tracked flow-sensitively. As the analysis only ever
+// grows its inputs, an expression's object set only grows too.
+struct ExprObjectSets {
+  llvm::DenseMap<const clang::Expr*, ObjectSet> objects;
+  // The number of times that an object set in `objects` has been added or
+  // grown.
+  uint64_t num_updates = 0;
+};
+
 // Maintains the points-to sets needed for the analysis of a function.
 // A `PointsToMap` stores points-to sets for
 // - Objects of reference-like type
@@ -37,6 +93,17 @@ namespace lifetimes {
 // The PointsToMap class does not enforce these type relationships because we
 // intend to allow type punning (at least within the implementations of
 // functions).
+//
+// The dataflow framework copies lattice elements, and so `PointsToMap`s, at
+// every block boundary and join. Copies share their storage until one of them
+// is modified, so copying is O(1), and so is comparing and joining a map with
+// an unmodified copy of itself.
+//
+// The object sets of expressions are not part of the flow-sensitive state:
+// copies share them in an `ExprObjectSets` table. The map only records how
+// many updates of the table it has seen, so that a block which grows an
+// object set still changes its output state, and the blocks that it flows
+// into are analyzed again.
 class PointsToMap {
  public:
   PointsToMap() = default;
@@ -53,7 +120,7 @@ class PointsToMap {
   std::string DebugString() const;
 
   const llvm::DenseMap<const Object*, ObjectSet>& PointerPointsTos() const {
-    return pointer_points_tos_;
+    return pointer_points_tos_.Get();
   }
 
   // Returns a `PointsToMap` containing the union of mappings from this map and
@@ -63,6 +130,11 @@ class PointsToMap {
   // corresponding points-to sets.
   PointsToMap Union(const PointsToMap& other) const;
 
+  // Adds the mappings from `other` to this map, as `Union()` does, and returns
+  // whether this map changed. This is cheaper than computing the union and
+  // comparing it to the original map.
+  bool UnionWith(const PointsToMap& other);
+
   // Returns the points-to set associated with `pointer`, or an empty set if
   // `pointer` is not associated with a points-to set.
   ObjectSet GetPointerPointsToSet(const Object* pointer) const;
@@ -96,13 +168,29 @@ class PointsToMap {
   // Returns if `expr` has an object set.
   bool ExprHasObjectSet(const clang::Expr* expr) const;
 
+  // Makes this map, and its future copies, record the object sets of
+  // expressions in `expr_object_sets`.
+  void UseExprObjectSets(std::shared_ptr<ExprObjectSets> expr_object_sets) {
+    expr_objects_ = std::move(expr_object_sets);
+    expr_objects_version_ = expr_objects_->num_updates;
+  }
+
   // Returns all the pointers (not objects) with the given `lifetime`.
   std::vector<const Object*> GetAllPointersWithLifetime(
       Lifetime lifetime) const;
 
  private:
-  llvm::DenseMap<const Object*, ObjectSet> pointer_points_tos_;
-  llvm::DenseMap<const clang::Expr*, ObjectSet> expr_objects_;
+  // Returns the object sets of expressions, or null if there are none.
+  const llvm::DenseMap<const clang::Expr*, ObjectSet>* ExprObjects() const {
+    return expr_objects_ ? &expr_objects_->objects : nullptr;
+  }
+
+  CopyOnWriteObjectSetMap<const Object*> pointer_points_tos_;
+  // Created on first use if `UseExprObjectSets()` isn't called.
+  std::shared_ptr<ExprObjectSets> expr_objects_;
+  // The value of `expr_objects_->num_updates` as of the last update made
+  // through this map or one of the maps it was joined from.
+  uint64_t expr_objects_version_ = 0;
 };
 
 }  // namespace lifetimes
@@ -4,6 +4,7 @@
 
 #include "lifetime_analysis/points_to_map.h"
 
+#include <memory>
 #include <optional>
 
 #include "gtest/gtest.h"
@@ -90,6 +91,96 @@ TEST(PointsToMapTest, Union) {
       {});
 }
 
+TEST(PointsToMapTest, UnionWithReportsChanges) {
+  runOnCodeWithLifetimeHandlers(
+      "int *return_int_ptr();"
+      "int* p = return_int_ptr();",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext&) {
+        Object p1(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        Object p2(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        Object p3(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        const clang::CallExpr* expr = getFirstCallExpr(ast_context);
+
+        PointsToMap map1, map2;
+        map1.SetPointerPointsToSet(&p1, {&p2});
+        map2.SetPointerPointsToSet(&p1, {&p2, &p3});
+
+        PointsToMap map3 = map2;
+        EXPECT_FALSE(map3.UnionWith(map1));
+        EXPECT_EQ(map3, map2);
+        EXPECT_TRUE(map1.UnionWith(map2));
+        EXPECT_EQ(map1, map2);
+        EXPECT_FALSE(map1.UnionWith(map2));
+
+        // Growing a shared expression object set is a change too.
+        map2.SetExprObjectSet(expr, {&p3});
+        EXPECT_TRUE(map1.UnionWith(map2));
+        EXPECT_EQ(map1, map2);
+        EXPECT_FALSE(map1.UnionWith(map2));
+      },
+      {});
+}
+
+TEST(PointsToMapTest, CopiesAreIndependent) {
+  runOnCodeWithLifetimeHandlers(
+      "int *return_int_ptr();"
+      "int* p = return_int_ptr();",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext&) {
+        Object p1(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        Object p2(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        Object p3(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        const clang::CallExpr* expr = getFirstCallExpr(ast_context);
+
+        PointsToMap map1;
+        map1.SetPointerPointsToSet(&p1, {&p2});
+        map1.SetExprObjectSet(expr, {&p2});
+
+        PointsToMap map2 = map1;
+        map2.ExtendPointerPointsToSet(&p1, {&p3});
+        EXPECT_EQ(map1.GetPointerPointsToSet(&p1), ObjectSet({&p2}));
+        EXPECT_EQ(map2.GetPointerPointsToSet(&p1), ObjectSet({&p2, &p3}));
+
+        // Joining with a subset leaves the map unchanged.
+        EXPECT_EQ(map2.Union(map1), map2);
+        EXPECT_EQ(map1.Union(map1), map1);
+      },
+      {});
+}
+
+TEST(PointsToMapTest, CopiesShareExprObjectSets) {
+  runOnCodeWithLifetimeHandlers(
+      "int *return_int_ptr();"
+      "int* p = return_int_ptr();",
+      [](const clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext&) {
+        Object p1(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        Object p2(Lifetime::CreateLocal(), ast_context.IntTy, std::nullopt);
+        const clang::CallExpr* expr = getFirstCallExpr(ast_context);
+
+        PointsToMap map1;
+        map1.UseExprObjectSets(std::make_shared<ExprObjectSets>());
+        PointsToMap map2 = map1;
+        map2.SetExprObjectSet(expr, {&p1});
+        EXPECT_TRUE(map1.ExprHasObjectSet(expr));
+
+        // The map that grew an object set compares unequal until joined.
+        EXPECT_NE(map1, map2);
+        EXPECT_EQ(map1.Union(map2), map2);
+
+        // Setting an object set adds to it.
+        map1.SetExprObjectSet(expr, {&p2});
+        EXPECT_EQ(map2.GetExprObjectSet(expr), ObjectSet({&p1, &p2}));
+
+        // Setting a subset of an object set doesn't change anything.
+        PointsToMap map3 = map1;
+        map3.SetExprObjectSet(expr, {&p2});
+        EXPECT_EQ(map3, map1);
+      },
+      {});
+}
+
 TEST(PointsToMapTest, GetPointerPointsToSet) {
   runOnCodeWithLifetimeHandlers(
       "",
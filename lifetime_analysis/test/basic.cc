@@ -42,6 +42,22 @@ TEST_F(LifetimeAnalysisTest, CompilationErrorFallback) {
           {{"target", "ERROR: encountered an expression containing errors"}}));
 }
 
+TEST_F(LifetimeAnalysisTest, CompilationErrorFallbackWithoutPointers) {
+  // Functions that don't contain any pointers aren't analyzed, but errors in
+  // them should still be reported.
+  AnalyzeBrokenCode();
+
+  EXPECT_THAT(
+      GetLifetimes(R"(
+    int target(int a) {
+      undefined(a);
+      return a;
+    }
+  )"),
+      LifetimesAre(
+          {{"target", "ERROR: encountered an expression containing errors"}}));
+}
+
 TEST_F(LifetimeAnalysisTest, CompilationErrorFromWerrorDoesNotPreventAnalysis) {
   // Warnings upgraded through -Werror should not prevent analysis.
   EXPECT_THAT(GetLifetimes(R"(
@@ -64,6 +80,24 @@ TEST_F(LifetimeAnalysisTest, NoLifetimes) {
               LifetimesAre({{"target", ""}}));
 }
 
+TEST_F(LifetimeAnalysisTest, NoLifetimesPlainStructs) {
+  EXPECT_THAT(GetLifetimes(R"(
+    struct Point {
+      int x;
+      int y;
+    };
+    Point add(Point a, Point b) {
+      Point result = {a.x + b.x, a.y + b.y};
+      return result;
+    }
+    int* target(int* p, int i) {
+      Point q = add({*p, i}, {i, *p});
+      return q.x == q.y ? p : nullptr;
+    }
+  )"),
+              LifetimesAre({{"add", "(), ()"}, {"target", "a, () -> a"}}));
+}
+
 TEST_F(LifetimeAnalysisTest, NoLifetimesArithmetic) {
   EXPECT_THAT(GetLifetimes(R"(
     int target(int a, int b) {
@@ -4,8 +4,11 @@
 
 // Tests involving builtins.
 
+#include <cstdint>
+
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
+#include "lifetime_analysis/builtin_lifetimes.h"
 #include "lifetime_analysis/test/lifetime_analysis_test.h"
 
 namespace clang {
@@ -42,6 +45,22 @@ TEST_F(LifetimeAnalysisTest, BuiltinNoLifetimes) {
               LifetimesContain({{"target", "()"}}));
 }
 
+TEST_F(LifetimeAnalysisTest, BuiltinLifetimesBuiltOnce) {
+  int64_t requests = NumBuiltinLifetimesRequests();
+  int64_t builds = NumBuiltinLifetimesBuilds();
+  EXPECT_THAT(GetLifetimes(R"(
+    const char* f(const char* a, int val) {
+      return __builtin_strchr(a, val);
+    }
+    const char* g(const char* a, int val) {
+      return __builtin_strchr(__builtin_strchr(a, val), val);
+    }
+  )"),
+              LifetimesContain({{"f", "a, () -> a"}, {"g", "a, () -> a"}}));
+  EXPECT_GT(NumBuiltinLifetimesRequests() - requests, 2);
+  EXPECT_EQ(NumBuiltinLifetimesBuilds() - builds, 1);
+}
+
 // TODO(veluca): add tests for the strto* functions.
 
 TEST_F(LifetimeAnalysisTest, BuiltinMemStrChr) {
@@ -496,6 +496,33 @@ TEST_F(LifetimeAnalysisTest, StructDoubleCall) {
                             {"target", "(a, b), a -> a"}}));
 }
 
+TEST_F(LifetimeAnalysisTest, FnWithSummary) {
+  GetLifetimesOptions options;
+  options.summaries = {{"f", "a, b -> b"}};
+  EXPECT_THAT(GetLifetimes(R"(
+    int* f(int* a, int* b);
+    int* target(int* a, int* b) {
+      return f(a, b);
+    }
+  )",
+                           options),
+              LifetimesAre({{"f", "a, b -> b"}, {"target", "a, b -> b"}}));
+}
+
+TEST_F(LifetimeAnalysisTest, FnAnnotationTakesPrecedenceOverSummary) {
+  GetLifetimesOptions options;
+  options.summaries = {{"f", "a, b -> b"}};
+  EXPECT_THAT(GetLifetimes(R"(
+    [[clang::annotate("lifetimes", "a, b -> a")]]
+    int* f(int* a, int* b);
+    int* target(int* a, int* b) {
+      return f(a, b);
+    }
+  )",
+                           options),
+              LifetimesAre({{"f", "a, b -> a"}, {"target", "a, b -> a"}}));
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
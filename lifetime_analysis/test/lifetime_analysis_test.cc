@@ -5,12 +5,17 @@
 #include "lifetime_analysis/test/lifetime_analysis_test.h"
 
 #include <fstream>
+#include <memory>
 #include <ostream>
 #include <string>
 #include <utility>
 #include <variant>
 
+#include "lifetime_annotations/lifetime_annotations.h"
+#include "lifetime_annotations/lifetime_summaries.h"
 #include "lifetime_annotations/test/run_on_code.h"
+#include "clang/AST/Decl.h"
+#include "llvm/Support/Error.h"
 
 namespace clang {
 namespace tidy {
@@ -46,20 +51,20 @@ void SaveDotFile(absl::string_view dot, absl::string_view filename_base,
 void LifetimeAnalysisTest::TearDown() {
   if (HasFailure()) {
     for (const auto& [func, debug_info] : debug_info_map_) {
-      std::cerr << debug_info.ast << "\n";
+      std::cerr << debug_info.Ast() << "\n";
 
-      std::cerr << debug_info.object_repository << "\n";
+      std::cerr << debug_info.ObjectRepositoryString() << "\n";
 
       const char* test_name =
           testing::UnitTest::GetInstance()->current_test_info()->name();
 
-      SaveDotFile(debug_info.points_to_map_dot,
+      SaveDotFile(debug_info.PointsToMapDot(),
                   absl::StrCat(func, "_points_to"), test_name,
                   "Points-to map of exit block");
-      SaveDotFile(debug_info.constraints_dot,
+      SaveDotFile(debug_info.ConstraintsDot(),
                   absl::StrCat(func, "_constraints"), test_name,
                   "Constraint set at exit block");
-      SaveDotFile(debug_info.cfg_dot, absl::StrCat(func, "_cfg"), test_name,
+      SaveDotFile(debug_info.CfgDot(), absl::StrCat(func, "_cfg"), test_name,
                   "Control-flow graph");
     }
     std::cerr << "Debug graphs can be found in " << testing::TempDir()
@@ -83,7 +88,7 @@ NamedFuncLifetimes LifetimeAnalysisTest::GetLifetimes(
 
   auto test = [&tu_lifetimes, &options, this](
                   clang::ASTContext& ast_context,
-                  const LifetimeAnnotationContext& lifetime_context) {
+                  const LifetimeAnnotationContext& base_lifetime_context) {
     // This will get called even if the code contains compilation errors.
     // So we need to check to avoid performing an analysis on code that
     // doesn't compile.
@@ -93,6 +98,28 @@ NamedFuncLifetimes LifetimeAnalysisTest::GetLifetimes(
       return;
     }
 
+    LifetimeAnnotationContext lifetime_context = base_lifetime_context;
+    if (!options.summaries.empty()) {
+      auto summaries = std::make_shared<LifetimeSummaries>();
+      for (const clang::Decl* decl :
+           ast_context.getTranslationUnitDecl()->decls()) {
+        const auto* func = clang::dyn_cast<clang::FunctionDecl>(decl);
+        if (func == nullptr) continue;
+        auto iter = options.summaries.find(func->getNameAsString());
+        if (iter == options.summaries.end()) continue;
+        llvm::Expected<FunctionLifetimes> lifetimes =
+            ParseLifetimeAnnotations(func, iter->second);
+        if (!lifetimes) {
+          ADD_FAILURE() << llvm::toString(lifetimes.takeError());
+          continue;
+        }
+        if (llvm::Error err = summaries->Add(func, *lifetimes)) {
+          ADD_FAILURE() << llvm::toString(std::move(err));
+        }
+      }
+      lifetime_context.summaries = std::move(summaries);
+    }
+
     auto result_callback = [&tu_lifetimes, &options](
                                const clang::FunctionDecl* func,
                                const FunctionLifetimesOrError&
@@ -144,6 +171,8 @@ NamedFuncLifetimes LifetimeAnalysisTest::GetLifetimes(
     }
 
     for (auto& [func, debug_info] : func_ptr_debug_info_map) {
+      // The AST doesn't outlive this callback.
+      debug_info.Render();
       debug_info_map_.try_emplace(func->getDeclName().getAsString(),
                                   std::move(debug_info));
     }
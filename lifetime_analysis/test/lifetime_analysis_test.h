@@ -27,6 +27,9 @@ class LifetimeAnalysisTest : public testing::Test {
         : with_template_placeholder(false), include_implicit_methods(false) {}
     bool with_template_placeholder;
     bool include_implicit_methods;
+    // Lifetimes (e.g. "a, b -> a") of top-level functions, keyed by name, that
+    // the analysis uses as `LifetimeSummaries` from other translation units.
+    absl::flat_hash_map<std::string, std::string> summaries;
   };
 
   NamedFuncLifetimes GetLifetimes(
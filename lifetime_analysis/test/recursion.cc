@@ -72,6 +72,26 @@ TEST_F(LifetimeAnalysisTest, MutualFiniteRecursion) {
               LifetimesAre({{"f", "(), a -> a"}, {"g", "(), a -> a"}}));
 }
 
+TEST_F(LifetimeAnalysisTest, CallerOfMutualRecursionDefinedFirst) {
+  EXPECT_THAT(GetLifetimes(R"(
+    int* f(int n, int* a);
+    int* h(int* a, int* b) {
+      return f(1, b);
+    }
+    int* g(int n, int* a) {
+      if (n == 0) return a;
+      return f(n - 1, a);
+    }
+    int* f(int n, int* a) {
+      if (n == 0) return a;
+      return g(n - 1, a);
+    }
+  )"),
+              LifetimesAre({{"f", "(), a -> a"},
+                            {"g", "(), a -> a"},
+                            {"h", "a, b -> b"}}));
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
@@ -4,7 +4,6 @@
 
 #include "lifetime_annotations/lifetime.h"
 
-#include <atomic>
 #include <cassert>
 #include <ostream>
 #include <string>
@@ -21,17 +20,50 @@ constexpr int STATIC_LIFETIME_ID = -1;
 constexpr int FIRST_VARIABLE_LIFETIME_ID = 2;
 constexpr int FIRST_LOCAL_LIFETIME_ID = -2;
 
-std::atomic<int> Lifetime::next_variable_id_{FIRST_VARIABLE_LIFETIME_ID};
+namespace {
 
-std::atomic<int> Lifetime::next_local_id_{FIRST_LOCAL_LIFETIME_ID};
+// The allocator installed by the innermost live `LifetimeIdAllocator::Scope`,
+// or null if there is none.
+thread_local LifetimeIdAllocator* current_allocator = nullptr;
+
+}  // namespace
+
+LifetimeIdAllocator::LifetimeIdAllocator()
+    : next_variable_id_(FIRST_VARIABLE_LIFETIME_ID),
+      next_local_id_(FIRST_LOCAL_LIFETIME_ID) {}
+
+int LifetimeIdAllocator::NumVariables() const {
+  return next_variable_id_ - FIRST_VARIABLE_LIFETIME_ID;
+}
+
+int LifetimeIdAllocator::NumLocals() const {
+  return FIRST_LOCAL_LIFETIME_ID - next_local_id_;
+}
+
+LifetimeIdAllocator::Scope::Scope(LifetimeIdAllocator& allocator)
+    : previous_(current_allocator) {
+  current_allocator = &allocator;
+}
+
+LifetimeIdAllocator::Scope::~Scope() { current_allocator = previous_; }
+
+LifetimeIdAllocator& LifetimeIdAllocator::Current() {
+  if (current_allocator != nullptr) return *current_allocator;
+  thread_local LifetimeIdAllocator default_allocator;
+  return default_allocator;
+}
 
 Lifetime::Lifetime() : id_(INVALID_LIFETIME_ID_EMPTY) {}
 
-Lifetime Lifetime::CreateVariable() { return Lifetime(next_variable_id_++); }
+Lifetime Lifetime::CreateVariable() {
+  return Lifetime(LifetimeIdAllocator::Current().next_variable_id_++);
+}
 
 Lifetime Lifetime::Static() { return Lifetime(STATIC_LIFETIME_ID); }
 
-Lifetime Lifetime::CreateLocal() { return Lifetime(next_local_id_--); }
+Lifetime Lifetime::CreateLocal() {
+  return Lifetime(LifetimeIdAllocator::Current().next_local_id_--);
+}
 
 bool Lifetime::IsVariable() const {
   assert(IsValid());
@@ -5,7 +5,6 @@
 #ifndef CRUBIT_LIFETIME_ANNOTATIONS_LIFETIME_H_
 #define CRUBIT_LIFETIME_ANNOTATIONS_LIFETIME_H_
 
-#include <atomic>
 #include <cassert>
 #include <functional>
 #include <ostream>
@@ -17,6 +16,55 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+class Lifetime;
+
+// Allocates the IDs of new lifetimes.
+//
+// `Lifetime::CreateVariable()` and `Lifetime::CreateLocal()` allocate IDs from
+// the allocator installed by the innermost live `LifetimeIdAllocator::Scope` on
+// the current thread, or from a per-thread default allocator if there is none.
+// IDs are dense: the variables and the locals created from one allocator are
+// numbered consecutively from the start.
+//
+// Lifetimes created from different allocators may have the same ID, so they
+// must not be compared or stored in the same containers. An analysis should
+// install its own allocator while it runs, so that its results don't depend on
+// what else the process (or thread) has analyzed before.
+class LifetimeIdAllocator {
+ public:
+  LifetimeIdAllocator();
+
+  LifetimeIdAllocator(const LifetimeIdAllocator&) = delete;
+  LifetimeIdAllocator& operator=(const LifetimeIdAllocator&) = delete;
+
+  // Returns the number of lifetime variables created from this allocator.
+  int NumVariables() const;
+
+  // Returns the number of local lifetimes created from this allocator.
+  int NumLocals() const;
+
+  // Installs an allocator on the current thread for the lifetime of the scope.
+  class Scope {
+   public:
+    explicit Scope(LifetimeIdAllocator& allocator);
+    ~Scope();
+
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+   private:
+    LifetimeIdAllocator* previous_;
+  };
+
+ private:
+  friend class Lifetime;
+
+  static LifetimeIdAllocator& Current();
+
+  int next_variable_id_;
+  int next_local_id_;
+};
+
 // A lifetime variable or constant lifetime.
 class Lifetime {
  public:
@@ -32,13 +80,14 @@ class Lifetime {
   Lifetime(const Lifetime&) = default;
   Lifetime& operator=(const Lifetime&) = default;
 
-  // Creates a new lifetime variable.
+  // Creates a new lifetime variable, using the current `LifetimeIdAllocator`.
   static Lifetime CreateVariable();
 
   // Returns the 'static lifetime constant.
   static Lifetime Static();
 
-  // Creates a new local lifetime constant.
+  // Creates a new local lifetime constant, using the current
+  // `LifetimeIdAllocator`.
   static Lifetime CreateLocal();
 
   // Returns whether this lifetime is a lifetime variable.
@@ -50,7 +99,8 @@ class Lifetime {
   // Returns whether this lifetime is a local lifetime.
   bool IsLocal() const;
 
-  // Returns a unique numeric ID for the lifetime.
+  // Returns a numeric ID for the lifetime, unique among the lifetimes created
+  // from the same `LifetimeIdAllocator`.
   int Id() const { return id_; }
 
   // Returns a textual representation of the lifetime for debug logging.
@@ -76,8 +126,6 @@ class Lifetime {
   friend class std::less<Lifetime>;
 
   int id_;
-  static std::atomic<int> next_variable_id_;
-  static std::atomic<int> next_local_id_;
 };
 
 std::ostream& operator<<(std::ostream& os, Lifetime lifetime);
@@ -16,6 +16,7 @@
 #include "lifetime_annotations/function_lifetimes.h"
 #include "lifetime_annotations/lifetime.h"
 #include "lifetime_annotations/lifetime_error.h"
+#include "lifetime_annotations/lifetime_substitutions.h"
 #include "lifetime_annotations/lifetime_symbol_table.h"
 #include "lifetime_annotations/pointee_type.h"
 #include "lifetime_annotations/type_lifetimes.h"
@@ -35,6 +36,7 @@
 #include "clang/Lex/Lexer.h"
 #include "clang/Lex/Pragma.h"
 #include "clang/Lex/Preprocessor.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
@@ -43,6 +45,17 @@
 namespace clang {
 namespace tidy {
 namespace lifetimes {
+
+// The outcome of a call to GetLifetimeAnnotationsInternal() for a given
+// declaration: either the lifetimes together with the names assigned to them,
+// or the error that was produced.
+struct CachedLifetimeAnnotations {
+  std::optional<FunctionLifetimes> lifetimes;
+  LifetimeSymbolTable symbol_table;
+  LifetimeError::Type error_type = LifetimeError::Type::Other;
+  std::string error_message;
+};
+
 namespace {
 
 llvm::Expected<FunctionLifetimes> ParseLifetimeAnnotations(
@@ -318,6 +331,35 @@ llvm::Expected<FunctionLifetimes> GetLifetimeAnnotationsInternal(
   Factory factory(elision_enabled, func, symbol_table);
   return FunctionLifetimes::CreateForDecl(func, factory);
 }
+
+// Returns a copy of `cached` in which every variable lifetime has been replaced
+// by a fresh one, and adds the names of the fresh lifetimes to the (empty)
+// `symbol_table`.
+FunctionLifetimes InstantiateCachedLifetimes(
+    const CachedLifetimeAnnotations& cached,
+    LifetimeSymbolTable& symbol_table) {
+  llvm::DenseMap<Lifetime, Lifetime> renaming;
+  LifetimeSubstitutions subst;
+  auto rename = [&renaming, &subst](Lifetime l) {
+    auto [iter, inserted] = renaming.try_emplace(l);
+    if (inserted) {
+      iter->second = Lifetime::CreateVariable();
+      subst.Add(l, iter->second);
+    }
+    return iter->second;
+  };
+
+  cached.lifetimes->Traverse([&rename](const Lifetime& l, Variance) {
+    if (l.IsVariable()) rename(l);
+  });
+  for (const auto& [name, l] : cached.symbol_table.GetMapping()) {
+    symbol_table.Add(name, l.IsVariable() ? rename(l) : l);
+  }
+
+  FunctionLifetimes result = *cached.lifetimes;
+  result.SubstituteLifetimes(subst);
+  return result;
+}
 }  // namespace
 
 char LifetimeError::ID;
@@ -328,17 +370,58 @@ llvm::Expected<FunctionLifetimes> GetLifetimeAnnotations(
   // TODO(mboehme): if we have multiple declarations of a function, make sure
   // they are all annotated with the same lifetimes.
 
+  LifetimeSymbolTable throw_away_symbol_table;
+  if (!symbol_table) {
+    symbol_table = &throw_away_symbol_table;
+  }
+
+  // Lifetimes from the cache can only be named in a symbol table that doesn't
+  // already bind any of the names; otherwise, the caller expects existing
+  // bindings to be reused.
+  bool use_cache = symbol_table->GetMapping().empty();
+  if (use_cache) {
+    auto iter = context.annotations_cache.find(func);
+    if (iter != context.annotations_cache.end()) {
+      const CachedLifetimeAnnotations& cached = *iter->second;
+      if (!cached.lifetimes.has_value()) {
+        return llvm::make_error<LifetimeError>(cached.error_type,
+                                               cached.error_message);
+      }
+      return InstantiateCachedLifetimes(cached, *symbol_table);
+    }
+  }
+
   clang::SourceManager& source_manager =
       func->getASTContext().getSourceManager();
   clang::FileID file_id =
       source_manager.getFileID(func->getSourceRange().getBegin());
   bool elision_enabled = context.lifetime_elision_files.contains(file_id);
 
-  LifetimeSymbolTable throw_away_symbol_table;
-  if (!symbol_table) {
-    symbol_table = &throw_away_symbol_table;
+  llvm::Expected<FunctionLifetimes> result =
+      GetLifetimeAnnotationsInternal(func, *symbol_table, elision_enabled);
+  if (!use_cache) {
+    return result;
+  }
+
+  auto cached = std::make_shared<CachedLifetimeAnnotations>();
+  if (result) {
+    cached->lifetimes = *result;
+    cached->symbol_table = *symbol_table;
+  } else {
+    llvm::Error err = llvm::handleErrors(
+        result.takeError(),
+        [&cached](std::unique_ptr<LifetimeError> lifetime_err) -> llvm::Error {
+          cached->error_type = lifetime_err->type();
+          cached->error_message = lifetime_err->message();
+          return llvm::Error(std::move(lifetime_err));
+        });
+    if (err.isA<LifetimeError>()) {
+      context.annotations_cache[func] = std::move(cached);
+    }
+    return std::move(err);
   }
-  return GetLifetimeAnnotationsInternal(func, *symbol_table, elision_enabled);
+  context.annotations_cache[func] = std::move(cached);
+  return result;
 }
 
 llvm::Expected<FunctionLifetimes> ParseLifetimeAnnotations(
@@ -13,6 +13,7 @@
 #include "clang/AST/Decl.h"
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/DenseSet.h"
 #include "llvm/Support/Error.h"
 
@@ -20,10 +21,25 @@ namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+class LifetimeSummaries;
+struct CachedLifetimeAnnotations;
+
 // Context that is required to obtain lifetime annotations for a function.
 struct LifetimeAnnotationContext {
   // Files in which the `lifetime_elision` pragma was specified.
   llvm::DenseSet<clang::FileID> lifetime_elision_files;
+
+  // Lifetimes inferred for functions in other translation units, if any.
+  // Lifetime analysis uses these for functions that aren't defined in the main
+  // file instead of analyzing them again.
+  std::shared_ptr<const LifetimeSummaries> summaries;
+
+  // Results of previous calls to GetLifetimeAnnotations(), keyed by the
+  // declaration that was queried. Populated lazily; the annotations on a
+  // declaration don't change once it has been parsed.
+  mutable llvm::DenseMap<const clang::FunctionDecl*,
+                         std::shared_ptr<const CachedLifetimeAnnotations>>
+      annotations_cache;
 };
 
 // Returns the lifetimes annotated on `func`.
@@ -36,6 +52,9 @@ struct LifetimeAnnotationContext {
 // rules were not applicable.
 // The names of annotated function lifetimes as well as autogenerated names for
 // elided lifetimes are added to `symbol_table`.
+// The result for each declaration is cached in `context`; repeated calls
+// return the cached lifetimes renamed to fresh variable lifetimes, so that
+// lifetimes obtained by different calls never alias.
 //
 // Returns structured error information as a `LifetimeError`.
 llvm::Expected<FunctionLifetimes> GetLifetimeAnnotations(
@@ -867,6 +867,51 @@ TEST_F(LifetimeAnnotationsTest, LifetimeAnnotation_ReturnFunctionPtr) {
               IsOkAndHolds(LifetimesAre({{"f", "a -> (b -> b)"}})));
 }
 
+TEST_F(LifetimeAnnotationsTest, RepeatedQueriesReturnFreshLifetimes) {
+  bool success = runOnCodeWithLifetimeHandlers(
+      WithLifetimeMacros(R"(
+        int* $a f(int* $a, int* $b);
+        int& g(int&, int&);
+      )"),
+      [](clang::ASTContext& ast_context,
+         const LifetimeAnnotationContext& lifetime_context) {
+        using clang::ast_matchers::functionDecl;
+        using clang::ast_matchers::hasName;
+        using clang::ast_matchers::match;
+
+        const auto* f = match(functionDecl(hasName("f")).bind("func"),
+                              ast_context)[0]
+                            .getNodeAs<clang::FunctionDecl>("func");
+        LifetimeSymbolTable first_symbol_table;
+        FunctionLifetimes first = llvm::cantFail(
+            GetLifetimeAnnotations(f, lifetime_context, &first_symbol_table));
+        LifetimeSymbolTable second_symbol_table;
+        FunctionLifetimes second = llvm::cantFail(
+            GetLifetimeAnnotations(f, lifetime_context, &second_symbol_table));
+
+        EXPECT_EQ(NameLifetimes(first, first_symbol_table), "a, b -> a");
+        EXPECT_EQ(NameLifetimes(second, second_symbol_table), "a, b -> a");
+        first.Traverse([&second](const Lifetime& l, Variance) {
+          EXPECT_FALSE(second.HasAny([l](Lifetime other) {
+            return other == l;
+          }));
+        });
+
+        // Errors are reported again on every query.
+        const auto* g = match(functionDecl(hasName("g")).bind("func"),
+                              ast_context)[0]
+                            .getNodeAs<clang::FunctionDecl>("func");
+        for (int i = 0; i < 2; ++i) {
+          EXPECT_THAT(
+              FormatErrorString(
+                  GetLifetimeAnnotations(g, lifetime_context).takeError()),
+              StartsWith("ERROR(ElisionNotEnabled): "));
+        }
+      },
+      {});
+  EXPECT_TRUE(success);
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
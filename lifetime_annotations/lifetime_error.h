@@ -30,6 +30,7 @@ class LifetimeError : public llvm::ErrorInfo<LifetimeError> {
       : type_(type), message_(std::move(message)) {}
 
   Type type() const { return type_; }
+  const std::string& message() const { return message_; }
 
   void log(llvm::raw_ostream& OS) const override { OS << message_; }
 
@@ -0,0 +1,209 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "lifetime_annotations/lifetime_summaries.h"
+
+#include <algorithm>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <tuple>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "lifetime_annotations/function_lifetimes.h"
+#include "lifetime_annotations/lifetime.h"
+#include "lifetime_annotations/lifetime_annotations.h"
+#include "lifetime_annotations/lifetime_symbol_table.h"
+#include "lifetime_annotations/type_lifetimes.h"
+#include "clang/AST/Decl.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tidy {
+namespace lifetimes {
+namespace {
+
+std::optional<std::string> GetUSR(const clang::FunctionDecl* func) {
+  llvm::SmallString</*inline size=*/128> usr;
+  if (clang::index::generateUSRForDecl(func, usr)) return std::nullopt;
+  return std::string(usr.str());
+}
+
+}  // namespace
+
+llvm::Expected<std::string> SummarizeFunctionLifetimes(
+    const clang::FunctionDecl* func, const FunctionLifetimes& lifetimes) {
+  // Create lifetimes for `func` in the order in which
+  // `ParseFunctionLifetimesSummary()` will consume them. Traversing them in
+  // parallel with `lifetimes` tells us which lifetime of `lifetimes` each of
+  // them corresponds to.
+  llvm::SmallVector<Lifetime> creation_order;
+  FunctionLifetimeFactorySingleCallback factory(
+      [&creation_order](const clang::Expr*) -> llvm::Expected<Lifetime> {
+        creation_order.push_back(Lifetime::CreateVariable());
+        return creation_order.back();
+      });
+  FunctionLifetimes skeleton;
+  if (llvm::Error err =
+          FunctionLifetimes::CreateForDecl(func, factory).moveInto(skeleton)) {
+    return std::move(err);
+  }
+
+  llvm::SmallVector<Lifetime> skeleton_lifetimes;
+  skeleton.Traverse([&skeleton_lifetimes](const Lifetime& l, Variance) {
+    skeleton_lifetimes.push_back(l);
+  });
+  llvm::SmallVector<Lifetime> actual_lifetimes;
+  lifetimes.Traverse([&actual_lifetimes](const Lifetime& l, Variance) {
+    actual_lifetimes.push_back(l);
+  });
+  if (skeleton_lifetimes.size() != actual_lifetimes.size() ||
+      skeleton.IsNonStaticMethod() != lifetimes.IsNonStaticMethod()) {
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        absl::StrCat("Lifetimes don't match the signature of function ",
+                     func->getNameAsString()));
+  }
+  llvm::DenseMap<Lifetime, Lifetime> skeleton_to_actual;
+  for (size_t i = 0; i < skeleton_lifetimes.size(); ++i) {
+    skeleton_to_actual[skeleton_lifetimes[i]] = actual_lifetimes[i];
+  }
+
+  LifetimeSymbolTable symbol_table;
+  std::string summary;
+  for (Lifetime l : creation_order) {
+    Lifetime actual = skeleton_to_actual.lookup(l);
+    if (!actual.IsVariable() && actual != Lifetime::Static()) {
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          absl::StrCat("Can't summarize local lifetime of function ",
+                       func->getNameAsString()));
+    }
+    if (!summary.empty()) summary += ", ";
+    summary += symbol_table.LookupLifetimeAndMaybeDeclare(actual).str();
+  }
+  return summary;
+}
+
+llvm::Expected<FunctionLifetimes> ParseFunctionLifetimesSummary(
+    const clang::FunctionDecl* func, llvm::StringRef summary,
+    LifetimeSymbolTable* symbol_table) {
+  return ParseLifetimeAnnotations(func, summary.str(), symbol_table);
+}
+
+llvm::Error LifetimeSummaries::Add(const clang::FunctionDecl* func,
+                                   const FunctionLifetimes& lifetimes) {
+  std::optional<std::string> usr = GetUSR(func);
+  if (!usr) {
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        absl::StrCat("Could not generate USR for function ",
+                     func->getNameAsString()));
+  }
+  if (summaries_.count(*usr)) return llvm::Error::success();
+  std::string summary;
+  if (llvm::Error err =
+          SummarizeFunctionLifetimes(func, lifetimes).moveInto(summary)) {
+    return err;
+  }
+  summaries_[*usr] = std::move(summary);
+  return llvm::Error::success();
+}
+
+void LifetimeSummaries::Merge(const LifetimeSummaries& other) {
+  for (const auto& entry : other.summaries_) {
+    summaries_.try_emplace(entry.getKey(), entry.getValue());
+  }
+}
+
+std::optional<llvm::StringRef> LifetimeSummaries::Find(
+    const clang::FunctionDecl* func) const {
+  if (summaries_.empty()) return std::nullopt;
+  std::optional<std::string> usr = GetUSR(func);
+  if (!usr) return std::nullopt;
+  auto iter = summaries_.find(*usr);
+  if (iter == summaries_.end()) return std::nullopt;
+  return llvm::StringRef(iter->getValue());
+}
+
+std::optional<llvm::Expected<FunctionLifetimes>> LifetimeSummaries::Lookup(
+    const clang::FunctionDecl* func) const {
+  std::optional<llvm::StringRef> summary = Find(func);
+  if (!summary) return std::nullopt;
+  return ParseFunctionLifetimesSummary(func, *summary);
+}
+
+void LifetimeSummaries::Write(llvm::raw_ostream& os) const {
+  std::vector<const llvm::StringMapEntry<std::string>*> entries;
+  for (const auto& entry : summaries_) entries.push_back(&entry);
+  std::sort(entries.begin(), entries.end(),
+            [](const auto* a, const auto* b) {
+              return a->getKey() < b->getKey();
+            });
+  for (const auto* entry : entries) {
+    os << entry->getKey() << "\t" << entry->getValue() << "\n";
+  }
+}
+
+llvm::Error LifetimeSummaries::Save(llvm::StringRef path) const {
+  std::error_code ec;
+  llvm::raw_fd_ostream os(path, ec);
+  if (ec) return llvm::createFileError(path, ec);
+  Write(os);
+  os.close();
+  if (os.has_error()) return llvm::createFileError(path, os.error());
+  return llvm::Error::success();
+}
+
+llvm::Expected<LifetimeSummaries> LifetimeSummaries::Parse(
+    llvm::StringRef text) {
+  LifetimeSummaries result;
+  size_t line_number = 0;
+  while (!text.empty()) {
+    llvm::StringRef line;
+    std::tie(line, text) = text.split('\n');
+    ++line_number;
+    if (line.empty()) continue;
+    auto [usr, summary] = line.split('\t');
+    if (usr.empty() || usr.size() == line.size()) {
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          absl::StrCat("Invalid lifetime summary on line ", line_number));
+    }
+    result.summaries_.try_emplace(usr, summary.str());
+  }
+  return result;
+}
+
+llvm::Expected<LifetimeSummaries> LifetimeSummaries::Load(
+    llvm::StringRef path) {
+  auto buffer = llvm::MemoryBuffer::getFile(path);
+  if (!buffer) return llvm::createFileError(path, buffer.getError());
+  return Parse((*buffer)->getBuffer());
+}
+
+llvm::Expected<LifetimeSummaries> LifetimeSummaries::LoadAndMerge(
+    llvm::ArrayRef<std::string> paths) {
+  LifetimeSummaries result;
+  for (const std::string& path : paths) {
+    llvm::Expected<LifetimeSummaries> loaded = Load(path);
+    if (!loaded) return loaded.takeError();
+    result.Merge(*loaded);
+  }
+  return result;
+}
+
+}  // namespace lifetimes
+}  // namespace tidy
+}  // namespace clang
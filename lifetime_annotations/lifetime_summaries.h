@@ -0,0 +1,91 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_LIFETIME_ANNOTATIONS_LIFETIME_SUMMARIES_H_
+#define CRUBIT_LIFETIME_ANNOTATIONS_LIFETIME_SUMMARIES_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "lifetime_annotations/function_lifetimes.h"
+#include "lifetime_annotations/lifetime_symbol_table.h"
+#include "clang/AST/Decl.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tidy {
+namespace lifetimes {
+
+// Returns a summary of `lifetimes`, the lifetimes of `func`, that
+// `ParseFunctionLifetimesSummary()` can turn back into lifetimes for `func`,
+// even in a different translation unit.
+//
+// The summary lists the names of the lifetimes in the order in which
+// `FunctionLifetimes::CreateForDecl()` creates them, e.g. "a, b, a". This is
+// also a valid input for `ParseLifetimeAnnotations()`.
+//
+// Returns an error if `lifetimes` contain a local lifetime, or don't have the
+// structure of the lifetimes of `func`.
+llvm::Expected<std::string> SummarizeFunctionLifetimes(
+    const clang::FunctionDecl* func, const FunctionLifetimes& lifetimes);
+
+// Creates lifetimes for `func` from a summary returned by
+// `SummarizeFunctionLifetimes()`. The names of the lifetimes are added to
+// `symbol_table`, if given.
+llvm::Expected<FunctionLifetimes> ParseFunctionLifetimesSummary(
+    const clang::FunctionDecl* func, llvm::StringRef summary,
+    LifetimeSymbolTable* symbol_table = nullptr);
+
+// Summaries of the lifetimes of functions, keyed by USR, so that the results
+// of analyzing one translation unit can be used when analyzing others.
+//
+// In the file format, each line holds the USR of a function, a tab, and its
+// summary. Lines are sorted by USR, so files written for the same functions
+// are identical. `lifetime_analyzer` writes such a file for each translation
+// unit, and merges them into one with `-summaries_out`.
+class LifetimeSummaries {
+ public:
+  // Adds the summary of `lifetimes` for `func`. If `func` already has a
+  // summary, keeps the existing one.
+  llvm::Error Add(const clang::FunctionDecl* func,
+                  const FunctionLifetimes& lifetimes);
+
+  // Adds the summaries from `other` for functions that don't have one yet.
+  void Merge(const LifetimeSummaries& other);
+
+  // Returns the summary for `func`, or nullopt if there is none.
+  std::optional<llvm::StringRef> Find(const clang::FunctionDecl* func) const;
+
+  // Returns lifetimes for `func` created from its summary, or nullopt if there
+  // is no summary for `func`.
+  std::optional<llvm::Expected<FunctionLifetimes>> Lookup(
+      const clang::FunctionDecl* func) const;
+
+  size_t size() const { return summaries_.size(); }
+
+  void Write(llvm::raw_ostream& os) const;
+  llvm::Error Save(llvm::StringRef path) const;
+
+  static llvm::Expected<LifetimeSummaries> Parse(llvm::StringRef text);
+  static llvm::Expected<LifetimeSummaries> Load(llvm::StringRef path);
+
+  // Loads the files at `paths` and merges them. For a function with summaries
+  // in several files, the summary in the first of them is kept.
+  static llvm::Expected<LifetimeSummaries> LoadAndMerge(
+      llvm::ArrayRef<std::string> paths);
+
+ private:
+  llvm::StringMap<std::string> summaries_;
+};
+
+}  // namespace lifetimes
+}  // namespace tidy
+}  // namespace clang
+
+#endif  // CRUBIT_LIFETIME_ANNOTATIONS_LIFETIME_SUMMARIES_H_
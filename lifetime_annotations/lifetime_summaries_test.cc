@@ -0,0 +1,198 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "lifetime_annotations/lifetime_summaries.h"
+
+#include <string>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "lifetime_annotations/function_lifetimes.h"
+#include "lifetime_annotations/lifetime_annotations.h"
+#include "lifetime_annotations/test/named_func_lifetimes.h"
+#include "lifetime_annotations/test/run_on_code.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang {
+namespace tidy {
+namespace lifetimes {
+namespace {
+
+using testing::Optional;
+
+const clang::FunctionDecl* GetFunction(clang::ASTContext& ast_context,
+                                       llvm::StringRef name) {
+  using clang::ast_matchers::functionDecl;
+  using clang::ast_matchers::hasName;
+  using clang::ast_matchers::match;
+  using clang::ast_matchers::selectFirst;
+  return selectFirst<clang::FunctionDecl>(
+      "func", match(functionDecl(hasName(name)).bind("func"), ast_context));
+}
+
+FunctionLifetimes Parse(const clang::FunctionDecl* func,
+                        llvm::StringRef lifetimes) {
+  return llvm::cantFail(ParseLifetimeAnnotations(func, lifetimes.str()));
+}
+
+// Returns the summary of `lifetimes` for the function `name` in `code`, and
+// checks that parsing the summary again gives the same lifetimes.
+std::string Summarize(llvm::StringRef code, llvm::StringRef name,
+                      llvm::StringRef lifetimes) {
+  std::string summary;
+  runOnCodeWithLifetimeHandlers(
+      code,
+      [&](clang::ASTContext& ast_context, const LifetimeAnnotationContext&) {
+        const clang::FunctionDecl* func = GetFunction(ast_context, name);
+        ASSERT_NE(func, nullptr);
+        llvm::Expected<FunctionLifetimes> func_lifetimes =
+            ParseLifetimeAnnotations(func, lifetimes.str());
+        ASSERT_TRUE(bool(func_lifetimes)) << func_lifetimes.takeError();
+        llvm::Expected<std::string> maybe_summary =
+            SummarizeFunctionLifetimes(func, *func_lifetimes);
+        ASSERT_TRUE(bool(maybe_summary)) << maybe_summary.takeError();
+        summary = *maybe_summary;
+
+        llvm::Expected<FunctionLifetimes> parsed =
+            ParseFunctionLifetimesSummary(func, summary);
+        ASSERT_TRUE(bool(parsed)) << parsed.takeError();
+        EXPECT_EQ(NameLifetimes(*parsed), NameLifetimes(*func_lifetimes));
+      },
+      {});
+  return summary;
+}
+
+TEST(LifetimeSummariesTest, Summarize) {
+  EXPECT_EQ(Summarize("int* f(int* a, int* b);", "f", "a, b -> a"), "a, b, a");
+  EXPECT_EQ(Summarize("int* f(int* a, int* b);", "f", "b, a -> static"),
+            "a, b, static");
+  EXPECT_EQ(Summarize("int** f(int** p);", "f", "(a, b) -> (a, b)"),
+            "a, b, a, b");
+  EXPECT_EQ(Summarize(R"cc(
+                        struct S {
+                          int* f(int* p);
+                        };
+                      )cc",
+                      "f", "a: b -> a"),
+            "a, b, a");
+}
+
+TEST(LifetimeSummariesTest, WriteAndParse) {
+  runOnCodeWithLifetimeHandlers(
+      R"cc(
+        int* f(int* a, int* b);
+        int* g(int* a);
+      )cc",
+      [](clang::ASTContext& ast_context, const LifetimeAnnotationContext&) {
+        const clang::FunctionDecl* f = GetFunction(ast_context, "f");
+        const clang::FunctionDecl* g = GetFunction(ast_context, "g");
+
+        LifetimeSummaries summaries;
+        ASSERT_FALSE(summaries.Add(f, Parse(f, "a, b -> b")));
+        // Later summaries for the same function are ignored.
+        ASSERT_FALSE(summaries.Add(f, Parse(f, "a, b -> a")));
+        EXPECT_EQ(summaries.size(), 1u);
+        EXPECT_THAT(summaries.Find(f), Optional(llvm::StringRef("a, b, b")));
+        EXPECT_EQ(summaries.Find(g), std::nullopt);
+
+        LifetimeSummaries other;
+        ASSERT_FALSE(other.Add(g, Parse(g, "a -> a")));
+        ASSERT_FALSE(other.Add(f, Parse(f, "a, a -> a")));
+        summaries.Merge(other);
+        EXPECT_EQ(summaries.size(), 2u);
+        EXPECT_THAT(summaries.Find(f), Optional(llvm::StringRef("a, b, b")));
+
+        std::string text;
+        llvm::raw_string_ostream os(text);
+        summaries.Write(os);
+        os.flush();
+        llvm::Expected<LifetimeSummaries> parsed =
+            LifetimeSummaries::Parse(text);
+        ASSERT_TRUE(bool(parsed)) << parsed.takeError();
+        EXPECT_EQ(parsed->size(), 2u);
+        auto g_lifetimes = parsed->Lookup(g);
+        ASSERT_TRUE(g_lifetimes.has_value());
+        ASSERT_TRUE(bool(*g_lifetimes)) << g_lifetimes->takeError();
+        EXPECT_EQ(NameLifetimes(**g_lifetimes), "a -> a");
+      },
+      {});
+}
+
+// Returns a path for the file `name` in the test's temporary directory.
+std::string TempPath(llvm::StringRef name) {
+  llvm::SmallString<256> path(testing::TempDir());
+  llvm::sys::path::append(path, name);
+  return std::string(path);
+}
+
+TEST(LifetimeSummariesTest, SaveAndLoadAndMerge) {
+  // Like the summaries `lifetime_analyzer` writes for two translation units,
+  // which both define an inline function `f`.
+  runOnCodeWithLifetimeHandlers(
+      R"cc(
+        int* f(int* a, int* b);
+        int* g(int* a);
+        int* h(int* a, int* b);
+      )cc",
+      [](clang::ASTContext& ast_context, const LifetimeAnnotationContext&) {
+        const clang::FunctionDecl* f = GetFunction(ast_context, "f");
+        const clang::FunctionDecl* g = GetFunction(ast_context, "g");
+        const clang::FunctionDecl* h = GetFunction(ast_context, "h");
+
+        LifetimeSummaries first;
+        ASSERT_FALSE(first.Add(f, Parse(f, "a, b -> a")));
+        ASSERT_FALSE(first.Add(g, Parse(g, "a -> a")));
+        std::string first_path = TempPath("first.summaries");
+        ASSERT_FALSE(first.Save(first_path));
+
+        LifetimeSummaries second;
+        ASSERT_FALSE(second.Add(f, Parse(f, "a, b -> b")));
+        ASSERT_FALSE(second.Add(h, Parse(h, "a, b -> static")));
+        std::string second_path = TempPath("second.summaries");
+        ASSERT_FALSE(second.Save(second_path));
+
+        llvm::Expected<LifetimeSummaries> merged =
+            LifetimeSummaries::LoadAndMerge({first_path, second_path});
+        ASSERT_TRUE(bool(merged)) << merged.takeError();
+        std::string merged_path = TempPath("merged.summaries");
+        ASSERT_FALSE(merged->Save(merged_path));
+
+        llvm::Expected<LifetimeSummaries> loaded =
+            LifetimeSummaries::Load(merged_path);
+        ASSERT_TRUE(bool(loaded)) << loaded.takeError();
+        EXPECT_EQ(loaded->size(), 3u);
+        EXPECT_THAT(loaded->Find(f), Optional(llvm::StringRef("a, b, a")));
+        auto h_lifetimes = loaded->Lookup(h);
+        ASSERT_TRUE(h_lifetimes.has_value());
+        ASSERT_TRUE(bool(*h_lifetimes)) << h_lifetimes->takeError();
+        EXPECT_EQ(NameLifetimes(**h_lifetimes), "a, b -> static");
+
+        llvm::Expected<LifetimeSummaries> missing =
+            LifetimeSummaries::LoadAndMerge(
+                {first_path, TempPath("missing.summaries")});
+        EXPECT_FALSE(missing);
+        llvm::consumeError(missing.takeError());
+      },
+      {});
+}
+
+TEST(LifetimeSummariesTest, ParseRejectsMalformedLines) {
+  llvm::Expected<LifetimeSummaries> parsed =
+      LifetimeSummaries::Parse("c:@F@f#*I#\ta, a\nno tab here\n");
+  EXPECT_FALSE(parsed);
+  llvm::consumeError(parsed.takeError());
+}
+
+}  // namespace
+}  // namespace lifetimes
+}  // namespace tidy
+}  // namespace clang
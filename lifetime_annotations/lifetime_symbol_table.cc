@@ -6,24 +6,55 @@
 
 #include <cassert>
 #include <cstddef>
+#include <mutex>
 #include <optional>
 #include <string>
 
 #include "lifetime_annotations/lifetime.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
 #include "llvm/Support/ErrorHandling.h"
 
 namespace clang {
 namespace tidy {
 namespace lifetimes {
 
+// Returns a copy of `name` that lives as long as the program. There are few
+// distinct lifetime names, so the pool stays small.
+static llvm::StringRef InternName(llvm::StringRef name) {
+  static auto* mu = new std::mutex();
+  static auto* pool = new llvm::StringSet<>();
+  std::lock_guard<std::mutex> lock(*mu);
+  return pool->insert(name).first->getKey();
+}
+
+LifetimeSymbolTable::Entry* LifetimeSymbolTable::FindName(
+    llvm::StringRef name) {
+  return llvm::partition_point(
+      entries_, [name](const Entry& entry) { return entry.first < name; });
+}
+
+const LifetimeSymbolTable::Entry* LifetimeSymbolTable::FindName(
+    llvm::StringRef name) const {
+  return const_cast<LifetimeSymbolTable*>(this)->FindName(name);
+}
+
+const LifetimeSymbolTable::Entry* LifetimeSymbolTable::FindLifetime(
+    Lifetime lifetime) const {
+  return llvm::find_if(entries_, [lifetime](const Entry& entry) {
+    return entry.second == lifetime;
+  });
+}
+
 std::optional<Lifetime> LifetimeSymbolTable::LookupName(
     llvm::StringRef name) const {
   if (name == "static") {
     return Lifetime::Static();
   }
 
-  auto iter = name_to_lifetime_.find(name);
-  if (iter == name_to_lifetime_.end()) {
+  const Entry* iter = FindName(name);
+  if (iter == entries_.end() || iter->first != name) {
     return std::nullopt;
   }
   return iter->second;
@@ -34,13 +65,11 @@ Lifetime LifetimeSymbolTable::LookupNameAndMaybeDeclare(llvm::StringRef name) {
     return Lifetime::Static();
   }
 
-  auto [iter, inserted] =
-      name_to_lifetime_.try_emplace(name, Lifetime::Static());
-  if (inserted) {
+  Entry* iter = FindName(name);
+  if (iter == entries_.end() || iter->first != name) {
     Lifetime lifetime = Lifetime::CreateVariable();
-    iter->second = lifetime;
-    assert(!lifetime_to_name_.count(lifetime));
-    lifetime_to_name_[lifetime] = name;
+    assert(FindLifetime(lifetime) == entries_.end());
+    iter = entries_.insert(iter, {InternName(name), lifetime});
   }
   return iter->second;
 }
@@ -51,11 +80,11 @@ std::optional<llvm::StringRef> LifetimeSymbolTable::LookupLifetime(
     return "static";
   }
 
-  auto iter = lifetime_to_name_.find(lifetime);
-  if (iter == lifetime_to_name_.end()) {
+  const Entry* iter = FindLifetime(lifetime);
+  if (iter == entries_.end()) {
     return std::nullopt;
   }
-  return iter->second;
+  return iter->first;
 }
 
 static std::string NameFromIndex(int index) {
@@ -82,37 +111,32 @@ llvm::StringRef LifetimeSymbolTable::LookupLifetimeAndMaybeDeclare(
     return "static";
   }
 
-  auto lifetime_to_name_iter = lifetime_to_name_.find(lifetime);
-  if (lifetime_to_name_iter != lifetime_to_name_.end()) {
-    return lifetime_to_name_iter->second;
+  if (const Entry* iter = FindLifetime(lifetime); iter != entries_.end()) {
+    return iter->first;
   }
 
   while (true) {
     std::string name = NameFromIndex(next_name_index_++);
-    auto [name_to_lifetime_iter, inserted] =
-        name_to_lifetime_.try_emplace(name, lifetime);
-    if (inserted) {
-      lifetime_to_name_[lifetime] = name;
-      return name_to_lifetime_iter->first();
+    Entry* iter = FindName(name);
+    if (iter == entries_.end() || iter->first != name) {
+      return entries_.insert(iter, {InternName(name), lifetime})->first;
     }
   }
 }
 
 void LifetimeSymbolTable::Add(llvm::StringRef name, Lifetime lifetime) {
-  auto [_, inserted] = name_to_lifetime_.try_emplace(name, lifetime);
-  if (!inserted) {
+  Entry* iter = FindName(name);
+  if (iter != entries_.end() && iter->first == name) {
     llvm::report_fatal_error("duplicate lifetime parameter");
   }
-  lifetime_to_name_[lifetime] = name;
+  entries_.insert(iter, {InternName(name), lifetime});
 }
 
 void LifetimeSymbolTable::Rebind(llvm::StringRef name, Lifetime lifetime) {
-  auto iter = name_to_lifetime_.find(name);
-  if (iter == name_to_lifetime_.end()) {
+  Entry* iter = FindName(name);
+  if (iter == entries_.end() || iter->first != name) {
     llvm::report_fatal_error("invalid call to rebind");
   }
-  lifetime_to_name_.erase(iter->second);
-  lifetime_to_name_[lifetime] = name;
   iter->second = lifetime;
 }
 
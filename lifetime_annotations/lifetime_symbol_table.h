@@ -6,11 +6,11 @@
 #define CRUBIT_LIFETIME_ANNOTATIONS_LIFETIME_SYMBOL_TABLE_H_
 
 #include <optional>
-#include <string>
+#include <utility>
 
 #include "lifetime_annotations/lifetime.h"
-#include "llvm/ADT/DenseMap.h"
-#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallVector.h"
 #include "llvm/ADT/StringRef.h"
 
 namespace clang {
@@ -18,8 +18,15 @@ namespace tidy {
 namespace lifetimes {
 
 // One-to-one mapping between lifetime names and the corresponding lifetimes.
+//
+// Tables are created for every function and record type, and usually hold
+// only a few entries, so the entries are kept inline and the names are
+// interned: copying a table doesn't allocate, and the names it returns remain
+// valid even after the table is destroyed.
 class LifetimeSymbolTable {
  public:
+  using Entry = std::pair<llvm::StringRef, Lifetime>;
+
   // Looks up a lifetime name in the symbol table.
   // Returns the corresponding lifetime if the name was present in the symbol
   // table, or nullopt if the lifetime name wasn't found.
@@ -55,14 +62,17 @@ class LifetimeSymbolTable {
   // The name *must* be already used.
   void Rebind(llvm::StringRef name, Lifetime lifetime);
 
-  // Accessor for hashing/debugging purposes.
-  const llvm::StringMap<Lifetime>& GetMapping() const {
-    return name_to_lifetime_;
-  }
+  // Accessor for hashing/debugging purposes. The entries are sorted by name.
+  llvm::ArrayRef<Entry> GetMapping() const { return entries_; }
 
  private:
-  llvm::StringMap<Lifetime> name_to_lifetime_;
-  llvm::DenseMap<Lifetime, std::string> lifetime_to_name_;
+  // Returns the position of `name` in `entries_`, or where it would be
+  // inserted.
+  Entry* FindName(llvm::StringRef name);
+  const Entry* FindName(llvm::StringRef name) const;
+  const Entry* FindLifetime(Lifetime lifetime) const;
+
+  llvm::SmallVector<Entry, 4> entries_;
   int next_name_index_ = 0;
 };
 
@@ -8,6 +8,7 @@
 
 #include "gtest/gtest.h"
 #include "lifetime_annotations/lifetime.h"
+#include "llvm/ADT/StringRef.h"
 
 namespace clang {
 namespace tidy {
@@ -84,6 +85,24 @@ TEST(LifetimeSymbolTableTest, LookupLifetimeAndMaybeDeclare) {
   }
 }
 
+TEST(LifetimeSymbolTableTest, MappingIsSortedAndOutlivesTable) {
+  llvm::StringRef name;
+  LifetimeSymbolTable copy;
+  {
+    LifetimeSymbolTable table;
+    Lifetime c = table.LookupNameAndMaybeDeclare("c");
+    Lifetime a = table.LookupNameAndMaybeDeclare("a");
+    name = *table.LookupLifetime(c);
+    copy = table;
+
+    ASSERT_EQ(copy.GetMapping().size(), 2u);
+    EXPECT_EQ(copy.GetMapping()[0], LifetimeSymbolTable::Entry("a", a));
+    EXPECT_EQ(copy.GetMapping()[1], LifetimeSymbolTable::Entry("c", c));
+  }
+  EXPECT_EQ(name, "c");
+  EXPECT_EQ(copy.LookupLifetime(*copy.LookupName("c")), "c");
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
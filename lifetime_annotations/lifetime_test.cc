@@ -58,6 +58,41 @@ TEST(Lifetime, Copy) {
   EXPECT_EQ(l1, l3);
 }
 
+TEST(Lifetime, IdsAreScopedToAllocator) {
+  LifetimeIdAllocator allocator1;
+  Lifetime variable1, local1;
+  {
+    LifetimeIdAllocator::Scope scope(allocator1);
+    variable1 = Lifetime::CreateVariable();
+    local1 = Lifetime::CreateLocal();
+    Lifetime::CreateVariable();
+  }
+  EXPECT_EQ(allocator1.NumVariables(), 2);
+  EXPECT_EQ(allocator1.NumLocals(), 1);
+
+  LifetimeIdAllocator allocator2;
+  LifetimeIdAllocator::Scope scope(allocator2);
+  EXPECT_EQ(Lifetime::CreateVariable(), variable1);
+  EXPECT_EQ(Lifetime::CreateLocal(), local1);
+  EXPECT_EQ(allocator2.NumVariables(), 1);
+  EXPECT_EQ(allocator2.NumLocals(), 1);
+  EXPECT_EQ(allocator1.NumVariables(), 2);
+}
+
+TEST(Lifetime, NestedScopes) {
+  LifetimeIdAllocator outer;
+  LifetimeIdAllocator::Scope outer_scope(outer);
+  Lifetime::CreateVariable();
+  {
+    LifetimeIdAllocator inner;
+    LifetimeIdAllocator::Scope inner_scope(inner);
+    Lifetime::CreateVariable();
+    EXPECT_EQ(inner.NumVariables(), 1);
+  }
+  Lifetime::CreateVariable();
+  EXPECT_EQ(outer.NumVariables(), 2);
+}
+
 }  // namespace
 }  // namespace lifetimes
 }  // namespace tidy
@@ -174,33 +174,26 @@ llvm::SmallVector<std::string> GetLifetimeParameters(clang::QualType type) {
   return ret;
 }
 
-ValueLifetimes::ValueLifetimes(const ValueLifetimes& other) { *this = other; }
-
-ValueLifetimes& ValueLifetimes::operator=(const ValueLifetimes& other) {
-  type_ = other.type_;
-  template_argument_lifetimes_ = other.template_argument_lifetimes_;
-  lifetime_parameters_by_name_ = other.lifetime_parameters_by_name_;
-  auto pointee_lifetimes =
-      other.pointee_lifetimes_
-          ? std::make_unique<ObjectLifetimes>(*other.pointee_lifetimes_)
-          : nullptr;
-  auto function_lifetimes =
-      other.function_lifetimes_
-          ? std::make_unique<FunctionLifetimes>(*other.function_lifetimes_)
-          : nullptr;
-  // Note: because ValueLifetimes is a recursive type (pointee_lifetimes_
-  // contains a ValueLifetimes), the following line can destroy `other`.
-  // (Thus the temporary local variables before we perform the assignment.)
-  pointee_lifetimes_ = std::move(pointee_lifetimes);
-  function_lifetimes_ = std::move(function_lifetimes);
-  return *this;
-}
+// Copies only share the pointee and function lifetimes; see the comment on
+// `pointee_lifetimes_`.
+ValueLifetimes::ValueLifetimes(const ValueLifetimes& other) = default;
+
+ValueLifetimes& ValueLifetimes::operator=(const ValueLifetimes& other) =
+    default;
 
 // Defined here because FunctionLifetimes is an incomplete type in the header.
 ValueLifetimes::~ValueLifetimes() = default;
 
 namespace {
 
+// Returns `*ptr`, after replacing it with a copy of its own if it is shared
+// with other ValueLifetimes.
+template <typename T>
+T& MakeUnshared(std::shared_ptr<T>& ptr) {
+  if (ptr.use_count() > 1) ptr = std::make_shared<T>(*ptr);
+  return *ptr;
+}
+
 llvm::Error ForEachTemplateArgument(
     clang::QualType type, clang::TypeLoc type_loc,
     const std::function<llvm::Error(int, clang::QualType, clang::TypeLoc)>&
@@ -291,7 +284,7 @@ ValueLifetimes ValueLifetimes::PointerTo(const clang::QualType pointer_type,
   ret.type_ = pointer_type;
   assert(pointer_type->getPointeeType().getCanonicalType() ==
          obj.Type().getCanonicalType());
-  ret.pointee_lifetimes_ = std::make_unique<ObjectLifetimes>(obj);
+  ret.pointee_lifetimes_ = std::make_shared<ObjectLifetimes>(obj);
   return ret;
 }
 
@@ -328,7 +321,7 @@ llvm::Expected<ValueLifetimes> ValueLifetimes::Create(
       return std::move(err);
     }
     ret.function_lifetimes_ =
-        std::make_unique<FunctionLifetimes>(std::move(fn_lftm));
+        std::make_shared<FunctionLifetimes>(std::move(fn_lftm));
     return ret;
   }
 
@@ -429,7 +422,7 @@ llvm::Expected<ValueLifetimes> ValueLifetimes::Create(
     }
   }
   ret.pointee_lifetimes_ =
-      std::make_unique<ObjectLifetimes>(object_lifetime, value_lifetimes);
+      std::make_shared<ObjectLifetimes>(object_lifetime, value_lifetimes);
   return ret;
 }
 
@@ -443,7 +436,7 @@ ValueLifetimes ValueLifetimes::ForPointerLikeType(
   assert(!PointeeType(type).isNull());
   ValueLifetimes result(type);
   result.pointee_lifetimes_ =
-      std::make_unique<ObjectLifetimes>(object_lifetimes);
+      std::make_shared<ObjectLifetimes>(object_lifetimes);
   return result;
 }
 
@@ -579,6 +572,11 @@ bool ValueLifetimes::HasAny(
 }
 
 void ValueLifetimes::SubstituteLifetimes(const LifetimeSubstitutions& subst) {
+  // Shared lifetimes are only copied if the substitution changes them.
+  auto changes = [&subst](Lifetime l) { return subst.Substitute(l) != l; };
+  auto needs_substitution = [&changes](const auto& ptr) {
+    return ptr.use_count() == 1 || ptr->HasAny(changes);
+  };
   for (auto& tmpl_arg_at_depth : template_argument_lifetimes_) {
     for (std::optional<ValueLifetimes>& tmpl_arg : tmpl_arg_at_depth) {
       if (tmpl_arg) {
@@ -586,8 +584,8 @@ void ValueLifetimes::SubstituteLifetimes(const LifetimeSubstitutions& subst) {
       }
     }
   }
-  if (pointee_lifetimes_) {
-    pointee_lifetimes_->SubstituteLifetimes(subst);
+  if (pointee_lifetimes_ && needs_substitution(pointee_lifetimes_)) {
+    MakeUnshared(pointee_lifetimes_).SubstituteLifetimes(subst);
   }
   for (const auto& lftm_arg : GetLifetimeParameters(type_)) {
     std::optional<Lifetime> lifetime =
@@ -595,8 +593,8 @@ void ValueLifetimes::SubstituteLifetimes(const LifetimeSubstitutions& subst) {
     assert(lifetime.has_value());
     lifetime_parameters_by_name_.Rebind(lftm_arg, subst.Substitute(*lifetime));
   }
-  if (function_lifetimes_) {
-    function_lifetimes_->SubstituteLifetimes(subst);
+  if (function_lifetimes_ && needs_substitution(function_lifetimes_)) {
+    MakeUnshared(function_lifetimes_).SubstituteLifetimes(subst);
   }
 }
 
@@ -610,7 +608,7 @@ void ValueLifetimes::Traverse(std::function<void(Lifetime&, Variance)> visitor,
     }
   }
   if (pointee_lifetimes_) {
-    pointee_lifetimes_->Traverse(visitor, variance, Type());
+    MakeUnshared(pointee_lifetimes_).Traverse(visitor, variance, Type());
   }
   for (const auto& lftm_arg : GetLifetimeParameters(type_)) {
     std::optional<Lifetime> lifetime =
@@ -618,26 +616,41 @@ void ValueLifetimes::Traverse(std::function<void(Lifetime&, Variance)> visitor,
     assert(lifetime.has_value());
     Lifetime new_lifetime = *lifetime;
     visitor(new_lifetime, variance);
-
-    // Note that this check is not an optimization, but a guard against UB:
-    // if one calls the const version of Traverse, with a callback that does not
-    // mutate the lifetime, on a const instance of the Value/ObjectLifetimes,
-    // then calling Rebind would be UB, even if Rebind would do nothing in
-    // practice.
     if (new_lifetime != lifetime) {
       lifetime_parameters_by_name_.Rebind(lftm_arg, new_lifetime);
     }
   }
   if (function_lifetimes_) {
-    function_lifetimes_->Traverse(visitor);
+    MakeUnshared(function_lifetimes_).Traverse(visitor);
   }
 }
 
+// This doesn't defer to the non-const overload, as that would unshare the
+// pointee and function lifetimes.
 void ValueLifetimes::Traverse(
     std::function<void(const Lifetime&, Variance)> visitor,
     Variance variance) const {
-  const_cast<ValueLifetimes*>(this)->Traverse(
-      [&visitor](Lifetime& l, Variance v) { visitor(l, v); }, variance);
+  for (const auto& tmpl_arg_at_depth : template_argument_lifetimes_) {
+    for (const std::optional<ValueLifetimes>& tmpl_arg : tmpl_arg_at_depth) {
+      if (tmpl_arg) {
+        tmpl_arg->Traverse(visitor, kInvariant);
+      }
+    }
+  }
+  if (pointee_lifetimes_) {
+    const ObjectLifetimes& pointee_lifetimes = *pointee_lifetimes_;
+    pointee_lifetimes.Traverse(visitor, variance, Type());
+  }
+  for (const auto& lftm_arg : GetLifetimeParameters(type_)) {
+    std::optional<Lifetime> lifetime =
+        lifetime_parameters_by_name_.LookupName(lftm_arg);
+    assert(lifetime.has_value());
+    visitor(*lifetime, variance);
+  }
+  if (function_lifetimes_) {
+    const FunctionLifetimes& function_lifetimes = *function_lifetimes_;
+    function_lifetimes.Traverse(visitor);
+  }
 }
 
 ValueLifetimes::ValueLifetimes(clang::QualType type) : type_(type) {}
@@ -930,9 +943,14 @@ void ObjectLifetimes::Traverse(std::function<void(Lifetime&, Variance)> visitor,
 void ObjectLifetimes::Traverse(
     std::function<void(const Lifetime&, Variance)> visitor, Variance variance,
     clang::QualType indirection_type) const {
-  const_cast<ObjectLifetimes*>(this)->Traverse(
-      [&visitor](Lifetime& l, Variance v) { visitor(l, v); }, variance,
-      indirection_type);
+  assert(indirection_type.isNull() ||
+         StripAttributes(indirection_type->getPointeeType().IgnoreParens()) ==
+             Type());
+  value_lifetimes_.Traverse(
+      visitor, indirection_type.isNull() || indirection_type.isConstQualified()
+                   ? kCovariant
+                   : kInvariant);
+  visitor(lifetime_, variance);
 }
 
 llvm::Expected<llvm::StringRef> EvaluateAsStringLiteral(
@@ -979,7 +997,7 @@ bool DenseMapInfo<clang::tidy::lifetimes::ValueLifetimes>::isEqual(
       (rhs.pointee_lifetimes_ == nullptr)) {
     return false;
   }
-  if (lhs.pointee_lifetimes_ &&
+  if (lhs.pointee_lifetimes_ != rhs.pointee_lifetimes_ &&
       !DenseMapInfo<clang::tidy::lifetimes::ObjectLifetimes>::isEqual(
           *lhs.pointee_lifetimes_, *rhs.pointee_lifetimes_)) {
     return false;
@@ -1029,7 +1047,7 @@ unsigned DenseMapInfo<clang::tidy::lifetimes::ValueLifetimes>::getHashValue(
   for (const auto& lifetime_arg :
        value_lifetimes.lifetime_parameters_by_name_.GetMapping()) {
     hash = hash_combine(hash, DenseMapInfo<llvm::StringRef>::getHashValue(
-                                  lifetime_arg.first()));
+                                  lifetime_arg.first));
     hash = hash_combine(
         hash, DenseMapInfo<clang::tidy::lifetimes::Lifetime>::getHashValue(
                   lifetime_arg.second));
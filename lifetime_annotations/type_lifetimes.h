@@ -205,8 +205,14 @@ class ValueLifetimes {
 
   // Note: only one of `pointee_lifetimes_`, `function_lifetimes_` or
   // `template_argument_lifetimes_` is non-empty.
-  std::unique_ptr<ObjectLifetimes> pointee_lifetimes_;
-  std::unique_ptr<FunctionLifetimes> function_lifetimes_;
+  //
+  // The pointee and function lifetimes are shared between copies of a
+  // ValueLifetimes, so that copying one only copies pointers. They are copied
+  // on write: functions that modify them first make a copy of their own if
+  // they are shared, and SubstituteLifetimes() doesn't do so if the
+  // substitution doesn't change them.
+  std::shared_ptr<ObjectLifetimes> pointee_lifetimes_;
+  std::shared_ptr<FunctionLifetimes> function_lifetimes_;
   std::vector<std::vector<std::optional<ValueLifetimes>>>
       template_argument_lifetimes_;
   clang::QualType type_;
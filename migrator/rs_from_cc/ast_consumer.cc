@@ -4,13 +4,47 @@
 
 #include "migrator/rs_from_cc/ast_consumer.h"
 
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "migrator/rs_from_cc/converter.h"
+#include "rs_bindings_from_cc/bazel_types.h"
+#include "rs_bindings_from_cc/decl_importer.h"
+#include "rs_bindings_from_cc/importer.h"
+#include "rs_bindings_from_cc/ir.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/CompilerInstance.h"
 
 namespace crubit_rs_from_cc {
 
+namespace {
+
+// Imports the decls of the main file into the IR that rs_bindings_from_cc
+// would generate bindings from, so that the converter can reuse the Rust types
+// the importer maps C++ types to, without parsing the file again.
+crubit::IR ImportIr(clang::ASTContext& ast_context, clang::Sema& sema) {
+  const clang::SourceManager& source_manager = ast_context.getSourceManager();
+  clang::OptionalFileEntryRef main_file =
+      source_manager.getFileEntryRefForID(source_manager.getMainFileID());
+  if (!main_file) return crubit::IR();
+
+  const crubit::BazelLabel target("//migrator/rs_from_cc:migrated_target");
+  std::vector<crubit::HeaderName> public_headers = {
+      crubit::HeaderName(std::string(main_file->getName()))};
+  absl::flat_hash_map<crubit::HeaderName, crubit::BazelLabel> header_targets =
+      {{public_headers[0], target}};
+  crubit::Invocation invocation(target, public_headers, header_targets);
+  crubit::Importer importer(invocation, ast_context, sema);
+  importer.Import(ast_context.getTranslationUnitDecl());
+  return std::move(invocation.ir_);
+}
+
+}  // namespace
+
 void AstConsumer::HandleTranslationUnit(clang::ASTContext& ast_context) {
   if (ast_context.getDiagnostics().hasErrorOccurred()) {
     // We do not need to process partially incorrect headers, we assume all
@@ -20,7 +54,8 @@ void AstConsumer::HandleTranslationUnit(clang::ASTContext& ast_context) {
     return;
   }
   CHECK(instance_.hasSema());
-  Converter converter(invocation_, ast_context);
+  crubit::IR ir = ImportIr(ast_context, instance_.getSema());
+  Converter converter(invocation_, ast_context, &ir);
   converter.Convert(ast_context.getTranslationUnitDecl());
 }
 
@@ -4,16 +4,137 @@
 
 #include "migrator/rs_from_cc/converter.h"
 
-#include "absl/strings/str_split.h"
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "rs_bindings_from_cc/ir.h"
 #include "clang/AST/CXXInheritance.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclFriend.h"
 #include "clang/AST/RecordLayout.h"
 #include "clang/Basic/FileManager.h"
-#include "third_party/re2/re2.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace crubit_rs_from_cc {
 
+namespace {
+
+// Writes the dump of a decl to `out` as `//` comments, one line at a time, so
+// that the dump is never held in memory as a whole.
+//
+// Addresses are removed since they're not useful and add non-determinism that
+// would break golden testing. Spaces at the end of each line are removed too,
+// those are a pain in golden tests since IDEs often strip spaces at end of
+// line. Lines left empty are dropped.
+class CommentedDumpStream final : public llvm::raw_ostream {
+ public:
+  // `prefix` starts each line, e.g. to indent the comments.
+  explicit CommentedDumpStream(llvm::raw_ostream& out,
+                               llvm::StringRef prefix = "// ")
+      : out_(out), prefix_(prefix) {}
+  ~CommentedDumpStream() override {
+    flush();
+    EndLine();
+  }
+
+ private:
+  void write_impl(const char* ptr, size_t size) override {
+    for (char c : llvm::StringRef(ptr, size)) {
+      if (c == '\n') {
+        EndLine();
+      } else {
+        line_ += c;
+      }
+    }
+    pos_ += size;
+  }
+
+  uint64_t current_pos() const override { return pos_; }
+
+  static bool IsAddressChar(char c) {
+    return llvm::isDigit(c) || (c >= 'a' && c <= 'z');
+  }
+
+  void EndLine() {
+    // Removes every " 0x" followed by address characters.
+    size_t end = 0;
+    for (size_t i = 0; i < line_.size();) {
+      if (line_.compare(i, 3, " 0x") == 0 && i + 3 < line_.size() &&
+          IsAddressChar(line_[i + 3])) {
+        i += 3;
+        while (i < line_.size() && IsAddressChar(line_[i])) ++i;
+        continue;
+      }
+      line_[end++] = line_[i++];
+    }
+    while (end > 0 && line_[end - 1] == ' ') --end;
+    if (end > 0) {
+      out_ << prefix_ << llvm::StringRef(line_.data(), end) << '\n';
+    }
+    line_.clear();
+  }
+
+  llvm::raw_ostream& out_;
+  llvm::StringRef prefix_;
+  // The current line, without its newline.
+  std::string line_;
+  uint64_t pos_ = 0;
+};
+
+// Returns how `type` is spelled in Rust, or nullopt if it can't be spelled
+// without more context (e.g. lifetimes) or isn't a plain type (e.g. function
+// pointers, or the types from `crubit/support`).
+std::optional<std::string> GetRsTypeName(const crubit::IR& ir,
+                                         const crubit::RsType& type) {
+  if (type.decl_id.has_value()) {
+    const crubit::IR::Item* item = ir.FindItem(*type.decl_id);
+    if (item == nullptr) return std::nullopt;
+    if (const auto* record = std::get_if<crubit::Record>(item)) {
+      return record->rs_name;
+    }
+    if (const auto* record = std::get_if<crubit::IncompleteRecord>(item)) {
+      return record->rs_name;
+    }
+    if (const auto* enum_ = std::get_if<crubit::Enum>(item)) {
+      return std::string(enum_->identifier.Ident());
+    }
+    if (const auto* alias = std::get_if<crubit::TypeAlias>(item)) {
+      return std::string(alias->identifier.Ident());
+    }
+    return std::nullopt;
+  }
+  if (!type.lifetime_args.empty() || type.name.empty() ||
+      type.name[0] == '#') {
+    return std::nullopt;
+  }
+  std::vector<std::string> type_args;
+  for (const crubit::RsType& type_arg : type.type_args) {
+    std::optional<std::string> type_arg_name = GetRsTypeName(ir, type_arg);
+    if (!type_arg_name.has_value()) return std::nullopt;
+    type_args.push_back(*std::move(type_arg_name));
+  }
+  if (type.name == "*const" || type.name == "*mut" || type.name == "&mut") {
+    if (type_args.size() != 1) return std::nullopt;
+    return absl::StrCat(type.name, " ", type_args[0]);
+  }
+  if (type.name == "&") {
+    if (type_args.size() != 1) return std::nullopt;
+    return absl::StrCat("&", type_args[0]);
+  }
+  if (type_args.empty()) return type.name;
+  return absl::StrCat(type.name, "<", absl::StrJoin(type_args, ", "), ">");
+}
+
+}  // namespace
+
 void Converter::Convert(const clang::TranslationUnitDecl* translation_unit) {
   for (clang::Decl* decl : translation_unit->decls()) {
     if (decl->getBeginLoc().isInvalid()) {
@@ -31,31 +152,65 @@ void Converter::Convert(const clang::Decl* decl) {
       Convert(dynamic_cast<const clang::TranslationUnitDecl*>(decl));
       break;
 
+    case clang::Decl::Function:
+      ConvertFunction(clang::cast<clang::FunctionDecl>(decl));
+      break;
+
     default:
       ConvertUnhandled(decl);
   }
 }
 
-void Converter::ConvertUnhandled(const clang::Decl* decl) {
-  std::string ast;
-  llvm::raw_string_ostream os(ast);
-  decl->dump(os);
-  os.flush();
-  result_ += "\n";
-  result_ += "// Unsupported decl:\n//\n";
-  // Remove addresses since they're not useful and add non-determinism that
-  // would break golden testing.
-  // Also remove spaces at the end of each line, those are a pain in golden
-  // tests since IDEs often strip spaces at end of line.
-  RE2::GlobalReplace(&ast, "(?m) 0x[a-z0-9]+| +$", "");
-  for (auto line : absl::StrSplit(ast, '\n')) {
-    if (line.empty()) {
-      continue;
-    }
-    result_ += "// ";
-    result_ += line;
-    result_ += '\n';
+void Converter::ConvertFunction(const clang::FunctionDecl* function) {
+  std::optional<std::string> signature;
+  if (function->doesThisDeclarationHaveABody()) {
+    signature = GetRsSignature(function);
+  }
+  if (!signature.has_value()) {
+    ConvertUnhandled(function);
+    return;
   }
+  out_ << "\n" << *signature << " {\n";
+  out_ << "    // Unsupported body:\n    //\n";
+  {
+    CommentedDumpStream dump(out_, "    // ");
+    function->getBody()->dump(dump, ctx_);
+  }
+  out_ << "    todo!()\n}\n";
+}
+
+std::optional<std::string> Converter::GetRsSignature(
+    const clang::FunctionDecl* function) const {
+  if (ir_ == nullptr) return std::nullopt;
+  const crubit::Func* func =
+      ir_->FindItem<crubit::Func>(crubit::GenerateItemId(function));
+  if (func == nullptr || func->member_func_metadata.has_value()) {
+    return std::nullopt;
+  }
+  const auto* name = std::get_if<crubit::Identifier>(&func->name);
+  if (name == nullptr) return std::nullopt;
+
+  std::vector<std::string> params;
+  for (const crubit::FuncParam& param : func->params) {
+    std::optional<std::string> type = GetRsTypeName(*ir_, param.type.rs_type);
+    if (!type.has_value()) return std::nullopt;
+    params.push_back(absl::StrCat(param.identifier.Ident(), ": ", *type));
+  }
+  std::string signature = absl::StrCat("pub fn ", name->Ident(), "(",
+                                       absl::StrJoin(params, ", "), ")");
+  if (!func->return_type.IsVoid()) {
+    std::optional<std::string> return_type =
+        GetRsTypeName(*ir_, func->return_type.rs_type);
+    if (!return_type.has_value()) return std::nullopt;
+    absl::StrAppend(&signature, " -> ", *return_type);
+  }
+  return signature;
+}
+
+void Converter::ConvertUnhandled(const clang::Decl* decl) {
+  out_ << "\n// Unsupported decl:\n//\n";
+  CommentedDumpStream dump(out_);
+  decl->dump(dump);
 }
 
 }  // namespace crubit_rs_from_cc
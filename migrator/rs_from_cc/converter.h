@@ -18,6 +18,7 @@
 #include "absl/status/statusor.h"
 #include "absl/types/span.h"
 #include "lifetime_annotations/lifetime_annotations.h"
+#include "rs_bindings_from_cc/ir.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/Mangle.h"
@@ -26,6 +27,7 @@
 #include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/Specifiers.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace crubit_rs_from_cc {
 
@@ -36,23 +38,41 @@ class Converter {
   // Top-level parameters as well as return value of a migrator invocation.
   class Invocation {
    public:
-    std::string rs_code_;
+    explicit Invocation(llvm::raw_ostream& rs_code) : rs_code_(rs_code) {}
+
+    // Receives the Rust code as it is generated, decl by decl.
+    llvm::raw_ostream& rs_code_;
   };
 
-  explicit Converter(Invocation& invocation, clang::ASTContext& ctx)
-      : result_(invocation.rs_code_), ctx_(ctx) {}
+  // If non-null, `ir` is the IR rs_bindings_from_cc imported from the same
+  // AST, whose mapping of C++ types to Rust types is reused.
+  explicit Converter(Invocation& invocation, clang::ASTContext& ctx,
+                     const crubit::IR* ir = nullptr)
+      : out_(invocation.rs_code_), ctx_(ctx), ir_(ir) {}
 
   void Convert(const clang::TranslationUnitDecl* translation_unit);
 
  private:
   void Convert(const clang::Decl* decl);
 
+  // Converts a function definition into a Rust function with the signature of
+  // its bindings, if it has any, and its body as a comment.
+  void ConvertFunction(const clang::FunctionDecl* function);
+
+  // Returns the signature of the Rust function for `function`, as computed by
+  // rs_bindings_from_cc, or nullopt if the IR has none that can be spelled
+  // without more context.
+  std::optional<std::string> GetRsSignature(
+      const clang::FunctionDecl* function) const;
+
   void ConvertUnhandled(const clang::Decl* decl);
 
   // The main output of the conversion process (Rust code).
-  std::string& result_;
+  llvm::raw_ostream& out_;
 
   clang::ASTContext& ctx_;
+
+  const crubit::IR* ir_;
 };  // class Converter
 
 }  // namespace crubit_rs_from_cc
@@ -6,6 +6,7 @@
 
 #include <iostream>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
@@ -16,6 +17,7 @@
 #include "absl/strings/string_view.h"
 #include "common/file_io.h"
 #include "migrator/rs_from_cc/rs_from_cc_lib.h"
+#include "llvm/Support/raw_ostream.h"
 
 ABSL_FLAG(std::string, cc_in, "",
           "input path for the C++ source file (it may or may not be a header)");
@@ -44,11 +46,16 @@ int main(int argc, char* argv[]) {
   // Skip $0.
   ++argv;
 
-  absl::StatusOr<std::string> rs_code = crubit_rs_from_cc::RsFromCc(
-      cc_file_content, cc_in,
-      std::vector<absl::string_view>(argv, argv + argc));
-  CHECK_OK(rs_code);
-
-  CHECK_OK(crubit::SetFileContents(rs_out, *rs_code));
+  // The Rust code is written as it is generated, rather than held in memory.
+  std::error_code error_code;
+  llvm::raw_fd_ostream rs_code(rs_out, error_code);
+  QCHECK(!error_code) << "Failed to open " << rs_out << ": "
+                      << error_code.message();
+  CHECK_OK(crubit_rs_from_cc::RsFromCc(
+      rs_code, cc_file_content, cc_in,
+      std::vector<absl::string_view>(argv, argv + argc)));
+  rs_code.close();
+  QCHECK(!rs_code.has_error())
+      << "Failed to write " << rs_out << ": " << rs_code.error().message();
   return 0;
 }
@@ -15,30 +15,43 @@
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "common/status_macros.h"
 #include "migrator/rs_from_cc/converter.h"
 #include "migrator/rs_from_cc/frontend_action.h"
 #include "clang/Basic/FileManager.h"
 #include "clang/Basic/FileSystemOptions.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace crubit_rs_from_cc {
 
 absl::StatusOr<std::string> RsFromCc(const absl::string_view cc_file_content,
                                      const absl::string_view cc_file_name,
                                      absl::Span<const absl::string_view> args) {
+  std::string rs_code;
+  llvm::raw_string_ostream os(rs_code);
+  CRUBIT_RETURN_IF_ERROR(RsFromCc(os, cc_file_content, cc_file_name, args));
+  os.flush();
+  return rs_code;
+}
+
+absl::Status RsFromCc(llvm::raw_ostream& rs_code,
+                      const absl::string_view cc_file_content,
+                      const absl::string_view cc_file_name,
+                      absl::Span<const absl::string_view> args) {
   std::vector<std::string> args_as_strings{
       // Parse non-doc comments that are used as documention
       "-fparse-all-comments"};
   args_as_strings.insert(args_as_strings.end(), args.begin(), args.end());
 
-  Converter::Invocation invocation;
+  Converter::Invocation invocation(rs_code);
   if (clang::tooling::runToolOnCodeWithArgs(
           std::make_unique<FrontendAction>(invocation), cc_file_content,
           args_as_strings, cc_file_name, "rs_from_cc",
           std::make_shared<clang::PCHContainerOperations>(),
           clang::tooling::FileContentMappings())) {
-    return invocation.rs_code_;
+    return absl::OkStatus();
   } else {
     return absl::Status(absl::StatusCode::kInvalidArgument,
                         "Could not compile source file contents");
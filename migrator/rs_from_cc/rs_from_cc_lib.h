@@ -8,9 +8,11 @@
 #include <string>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace crubit_rs_from_cc {
 
@@ -27,6 +29,14 @@ absl::StatusOr<std::string> RsFromCc(
     absl::string_view cc_file_name = "testing/file_name.cc",
     absl::Span<const absl::string_view> args = {});
 
+// Like `RsFromCc` above, but writes the Rust code to `rs_code` as it is
+// generated, one top-level decl at a time, rather than returning it. If the
+// source code doesn't compile, `rs_code` may have received some of the code.
+absl::Status RsFromCc(llvm::raw_ostream& rs_code,
+                      absl::string_view cc_file_content,
+                      absl::string_view cc_file_name = "testing/file_name.cc",
+                      absl::Span<const absl::string_view> args = {});
+
 }  // namespace crubit_rs_from_cc
 
 #endif  // CRUBIT_MIGRATOR_RS_FROM_CC_RS_FROM_CC_LIB_H_
@@ -4,6 +4,7 @@
 
 #include "migrator/rs_from_cc/rs_from_cc_lib.h"
 
+#include <string>
 #include <variant>
 
 #include "gmock/gmock.h"
@@ -12,12 +13,14 @@
 #include "absl/strings/string_view.h"
 #include "common/status_test_matchers.h"
 #include "clang/AST/ASTContext.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace crubit_rs_from_cc {
 namespace {
 
 using crubit::StatusIs;
 using ::testing::Eq;
+using ::testing::HasSubstr;
 using ::testing::IsEmpty;
 
 TEST(RsFromCcTest, Noop) {
@@ -43,10 +46,49 @@ TEST(RsFromCcTest, FunctionDeclaration) {
   ASSERT_OK_AND_ASSIGN(std::string rs_code, RsFromCc("void f() {}"));
 
   EXPECT_THAT(rs_code, Eq(R"end_of_string(
+pub fn f() {
+    // Unsupported body:
+    //
+    // CompoundStmt <testing/file_name.cc:1:10, col:11>
+    todo!()
+}
+)end_of_string"));
+}
+
+TEST(RsFromCcTest, FunctionSignatureFromBindingsIr) {
+  ASSERT_OK_AND_ASSIGN(
+      std::string rs_code,
+      RsFromCc("struct S {};\nint f(S* s, int i) { return i; }"));
+
+  EXPECT_THAT(rs_code, HasSubstr("\npub fn f(s: *mut S, i: ::core::ffi::c_int) "
+                                 "-> ::core::ffi::c_int {\n"));
+}
+
+TEST(RsFromCcTest, FunctionDeclarationWithoutBody) {
+  ASSERT_OK_AND_ASSIGN(std::string rs_code, RsFromCc("void f();"));
+
+  EXPECT_THAT(rs_code, Eq(R"end_of_string(
+// Unsupported decl:
+//
+// FunctionDecl <testing/file_name.cc:1:1, col:8> col:6 f 'void ()'
+)end_of_string"));
+}
+
+TEST(RsFromCcTest, StreamsEachDecl) {
+  std::string rs_code;
+  llvm::raw_string_ostream os(rs_code);
+  ASSERT_OK(RsFromCc(os, "int x;\nint* y;"));
+  os.flush();
+
+  // Each decl is dumped on its own, so their locations are printed in full.
+  EXPECT_THAT(rs_code, Eq(R"end_of_string(
+// Unsupported decl:
+//
+// VarDecl <testing/file_name.cc:1:1, col:5> col:5 x 'int'
+
 // Unsupported decl:
 //
-// FunctionDecl <testing/file_name.cc:1:1, col:11> col:6 f 'void ()'
-// `-CompoundStmt <col:10, col:11>
+// VarDecl <testing/file_name.cc:2:1, col:6> col:6 y 'int *'
 )end_of_string"));
 }
 
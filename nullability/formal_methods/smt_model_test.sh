@@ -0,0 +1,53 @@
+#!/bin/sh -e
+# Part of the Crubit project, under the Apache License v2.0 with LLVM
+# Exceptions. See /LICENSE for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+# Runs an SMT2 model with cvc5, and checks that its results still hold.
+#
+# Usage: smt_model_test.sh MODEL TIME_LIMIT [EXPECTED...]
+#
+# The solver flags are taken from the model's `;; Run:` line. The results of
+# the model's (check-sat) commands must match EXPECTED (e.g. `sat unsat`), or,
+# if none are given, the `(echo "Expected: ...")` lines in the model itself.
+# The test fails if the solver takes more than TIME_LIMIT seconds.
+#
+# cvc5 isn't a build dependency: it's found in $CVC5 or on $PATH.
+
+MODEL="$1"
+TIME_LIMIT="$2"
+shift 2
+SOLVER="${CVC5:-cvc5}"
+LOG="${TEST_TMPDIR:-/tmp}/$(basename "$MODEL").log"
+
+if ! command -v "$SOLVER" >/dev/null; then
+  echo "cvc5 not found: install it, or set CVC5 to its path"
+  exit 1
+fi
+
+FLAGS=$(sed -n 's/^;; Run: cvc5 \(.*\) [^ ]*$/\1/p' "$MODEL")
+if [ $# -eq 0 ]; then
+  set -- $(sed -n 's/.*(echo "Expected: \([a-z]*\)").*/\1/p' "$MODEL")
+fi
+if [ $# -eq 0 ]; then
+  echo "$MODEL has no expected results"
+  exit 1
+fi
+
+START=$(date +%s.%N)
+STATUS=0
+timeout "$TIME_LIMIT" "$SOLVER" $FLAGS "$MODEL" >"$LOG" 2>&1 || STATUS=$?
+END=$(date +%s.%N)
+echo "$MODEL: solved in $(awk "BEGIN { print $END - $START }") seconds"
+if [ $STATUS -eq 124 ]; then
+  echo "Timed out after $TIME_LIMIT seconds"
+  exit 1
+fi
+
+ACTUAL=$(grep -x 'sat\|unsat\|unknown' "$LOG" | tr '\n' ' ')
+if [ "$ACTUAL" != "$* " ]; then
+  echo "Expected results: $*"
+  echo "Actual results:   $ACTUAL"
+  cat "$LOG"
+  exit 1
+fi
@@ -4,6 +4,8 @@
 
 #include "nullability/inference/collect_evidence.h"
 
+#include <chrono>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -12,6 +14,7 @@
 #include "nullability/inference/inference.proto.h"
 #include "nullability/pointer_nullability.h"
 #include "nullability/pointer_nullability_analysis.h"
+#include "nullability/pointer_nullability_diagnosis.h"
 #include "nullability/pointer_nullability_lattice.h"
 #include "nullability/type_nullability.h"
 #include "clang/AST/ASTContext.h"
@@ -29,43 +32,65 @@
 #include "clang/Analysis/FlowSensitive/DataflowAnalysisContext.h"
 #include "clang/Analysis/FlowSensitive/DataflowEnvironment.h"
 #include "clang/Analysis/FlowSensitive/Formula.h"
+#include "clang/Analysis/FlowSensitive/Solver.h"
 #include "clang/Analysis/FlowSensitive/Value.h"
 #include "clang/Analysis/FlowSensitive/WatchedLiteralsSolver.h"
 #include "clang/Basic/LLVM.h"
+#include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/Specifiers.h"
 #include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/FunctionExtras.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/Support/Debug.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
+#define DEBUG_TYPE "nullability-inference"
+
 namespace clang::tidy::nullability {
 using ::clang::dataflow::DataflowAnalysisContext;
 using ::clang::dataflow::Environment;
 
+std::optional<unsigned> SymbolTable::intern(const Decl &D) {
+  auto [It, Inserted] = IDByDecl.try_emplace(&D);
+  if (Inserted) {
+    // Redeclarations are distinct Decls with the same USR, so the USR itself
+    // is only looked up the first time we see each Decl.
+    llvm::SmallString<128> USR;
+    if (!index::generateUSRForDecl(&D, USR)) {
+      auto [USRIt, NewUSR] = IDByUSR.try_emplace(USR, USRs.size());
+      if (NewUSR) USRs.push_back(USRIt->getKey());
+      It->second = USRIt->second;
+    }
+  }
+  return It->second;
+}
+
 llvm::unique_function<EvidenceEmitter> evidenceEmitter(
-    llvm::unique_function<void(const Evidence &) const> Emit) {
+    SymbolTable &Symbols,
+    llvm::unique_function<void(unsigned Symbol, const Evidence &) const>
+        Emit) {
   class EvidenceEmitterImpl {
    public:
     EvidenceEmitterImpl(
-        llvm::unique_function<void(const Evidence &) const> Emit)
-        : Emit(std::move(Emit)) {}
+        SymbolTable &Symbols,
+        llvm::unique_function<void(unsigned, const Evidence &) const> Emit)
+        : Symbols(Symbols), Emit(std::move(Emit)) {}
 
     void operator()(const Decl &Target, Slot S, Evidence::Kind Kind,
                     SourceLocation Loc) const {
+      std::optional<unsigned> Symbol = Symbols.intern(Target);
+      if (!Symbol) return;  // Can't emit without a USR
+
       Evidence E;
       E.set_slot(S);
       E.set_kind(Kind);
 
-      auto [It, Inserted] = USRCache.try_emplace(&Target);
-      if (Inserted) {
-        llvm::SmallString<128> USR;
-        if (!index::generateUSRForDecl(&Target, USR)) It->second = USR.str();
-      }
-      if (It->second.empty()) return;  // Can't emit without a USR
-      E.mutable_symbol()->set_usr(It->second);
-
       // TODO: make collecting and propagating location information optional?
       auto &SM =
           Target.getDeclContext()->getParentASTContext().getSourceManager();
@@ -74,14 +99,27 @@ llvm::unique_function<EvidenceEmitter> evidenceEmitter(
       if (Loc = SM.getFileLoc(Loc); Loc.isValid())
         E.set_location(Loc.printToString(SM));
 
-      Emit(E);
+      Emit(*Symbol, E);
     }
 
    private:
-    mutable llvm::DenseMap<const Decl *, std::string> USRCache;
-    llvm::unique_function<void(const Evidence &) const> Emit;
+    SymbolTable &Symbols;
+    llvm::unique_function<void(unsigned, const Evidence &) const> Emit;
   };
-  return EvidenceEmitterImpl(std::move(Emit));
+  return EvidenceEmitterImpl(Symbols, std::move(Emit));
+}
+
+llvm::unique_function<EvidenceEmitter> evidenceEmitter(
+    llvm::unique_function<void(const Evidence &) const> Emit) {
+  auto Symbols = std::make_unique<SymbolTable>();
+  SymbolTable &SymbolsRef = *Symbols;
+  return evidenceEmitter(
+      SymbolsRef, [Symbols(std::move(Symbols)), Emit(std::move(Emit))](
+                      unsigned Symbol, const Evidence &E) {
+        Evidence WithSymbol = E;
+        WithSymbol.mutable_symbol()->set_usr(Symbols->usr(Symbol).str());
+        Emit(WithSymbol);
+      });
 }
 
 namespace {
@@ -239,7 +277,7 @@ void collectEvidenceFromReturn(
 }
 
 void collectEvidenceFromElement(
-    std::vector<std::pair<PointerTypeNullability, Slot>> InferrableSlots,
+    std::vector<std::pair<PointerTypeNullability, Slot>> &InferrableSlots,
     const CFGElement &Element, const Environment &Env,
     llvm::function_ref<EvidenceEmitter> Emit) {
   collectEvidenceFromDereference(InferrableSlots, Element, Env, Emit);
@@ -249,6 +287,47 @@ void collectEvidenceFromElement(
   // TODO: add more heuristic collections here
 }
 
+// Enforces the solver-related parts of an AnalysisBudget, across all the
+// queries made while analyzing one implementation.
+class BudgetedSolver : public dataflow::Solver {
+ public:
+  explicit BudgetedSolver(const AnalysisBudget &Budget)
+      : Inner(Budget.MaxSolverWork
+                  ? dataflow::WatchedLiteralsSolver(Budget.MaxSolverWork)
+                  : dataflow::WatchedLiteralsSolver()) {
+    if (Budget.Timeout.count() > 0)
+      Deadline = std::chrono::steady_clock::now() + Budget.Timeout;
+  }
+
+  Result solve(llvm::ArrayRef<const dataflow::Formula *> Vals) override {
+    if (Deadline && std::chrono::steady_clock::now() > *Deadline) {
+      TimedOut = true;
+      return Result::TimedOut();
+    }
+    Result R = Inner.solve(Vals);
+    if (R.getStatus() == Result::Status::TimedOut) ReachedWorkLimit = true;
+    return R;
+  }
+
+  // Returns an error if the budget was exceeded.
+  llvm::Error check() const {
+    if (TimedOut)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "analysis budget exceeded: time limit");
+    if (ReachedWorkLimit)
+      return llvm::createStringError(
+          llvm::inconvertibleErrorCode(),
+          "analysis budget exceeded: solver work limit");
+    return llvm::Error::success();
+  }
+
+ private:
+  dataflow::WatchedLiteralsSolver Inner;
+  std::optional<std::chrono::steady_clock::time_point> Deadline;
+  bool TimedOut = false;
+  bool ReachedWorkLimit = false;
+};
+
 std::optional<Evidence::Kind> evidenceKindFromDeclaredType(QualType T) {
   if (!T.getNonReferenceType()->isPointerType()) return std::nullopt;
   auto Nullability = getNullabilityAnnotationsFromType(T);
@@ -263,8 +342,41 @@ std::optional<Evidence::Kind> evidenceKindFromDeclaredType(QualType T) {
 }
 }  // namespace
 
+PreviousInferences::PreviousInferences(llvm::ArrayRef<Inference> All) {
+  for (const Inference &I : All) {
+    auto &Slots = SlotsByUSR[I.symbol().usr()];
+    for (const auto &SI : I.slot_inference()) {
+      if (SI.conflict()) continue;
+      std::optional<NullabilityKind> NK;
+      switch (SI.nullability()) {
+        case Inference::NONNULL:
+          NK = NullabilityKind::NonNull;
+          break;
+        case Inference::NULLABLE:
+          NK = NullabilityKind::Nullable;
+          break;
+        default:
+          continue;
+      }
+      if (Slots.size() <= SI.slot()) Slots.resize(SI.slot() + 1);
+      Slots[SI.slot()] = NK;
+    }
+  }
+}
+
+std::optional<NullabilityKind> PreviousInferences::lookup(const Decl &D,
+                                                          Slot S) const {
+  llvm::SmallString<128> USR;
+  if (index::generateUSRForDecl(&D, USR)) return std::nullopt;
+  auto It = SlotsByUSR.find(USR);
+  if (It == SlotsByUSR.end() || It->second.size() <= S) return std::nullopt;
+  return It->second[S];
+}
+
 llvm::Error collectEvidenceFromImplementation(
-    const Decl &Decl, llvm::function_ref<EvidenceEmitter> Emit) {
+    const Decl &Decl, llvm::function_ref<EvidenceEmitter> Emit,
+    const PreviousInferences *Previous, const AnalysisBudget &Budget,
+    TypeNullabilityCache *TypeCache, std::vector<CFGElement> *Diagnostics) {
   const FunctionDecl *Func = dyn_cast<FunctionDecl>(&Decl);
   if (!Func || !Func->doesThisDeclarationHaveABody()) {
     return llvm::createStringError(
@@ -275,25 +387,77 @@ llvm::Error collectEvidenceFromImplementation(
   llvm::Expected<dataflow::ControlFlowContext> ControlFlowContext =
       dataflow::ControlFlowContext::build(*Func);
   if (!ControlFlowContext) return ControlFlowContext.takeError();
+  if (unsigned NumBlocks = ControlFlowContext->getCFG().size();
+      Budget.MaxCFGBlocks && NumBlocks > Budget.MaxCFGBlocks)
+    return llvm::createStringError(
+        llvm::inconvertibleErrorCode(),
+        "analysis budget exceeded: %u CFG blocks (limit %u)", NumBlocks,
+        Budget.MaxCFGBlocks);
 
-  DataflowAnalysisContext AnalysisContext(
-      std::make_unique<dataflow::WatchedLiteralsSolver>());
+  auto Solver = std::make_unique<BudgetedSolver>(Budget);
+  const BudgetedSolver &SolverRef = *Solver;
+  DataflowAnalysisContext AnalysisContext(std::move(Solver));
   Environment Environment(AnalysisContext, *Func);
   PointerNullabilityAnalysis Analysis(
-      Decl.getDeclContext()->getParentASTContext());
-  std::vector<std::pair<PointerTypeNullability, Slot>> InferrableSlots;
+      Decl.getDeclContext()->getParentASTContext(), TypeCache);
+  Analysis.setMaxJoinDepth(Budget.MaxJoinDepth);
+  if (Previous)
+    Analysis.assignReturnNullabilityOverride(
+        [Previous](
+            const FunctionDecl &Callee) -> std::optional<NullabilityKind> {
+          // Annotations take precedence over previous inferences.
+          if (evidenceKindFromDeclaredType(Callee.getReturnType()))
+            return std::nullopt;
+          return Previous->lookup(Callee, SLOT_RETURN_TYPE);
+        });
+  // Parameters that are never read don't need variables, which would only make
+  // the SAT queries larger.
+  std::vector<std::pair<const ValueDecl *, Slot>> InferrableParams;
   auto Parameters = Func->parameters();
   for (auto I = 0; I < Parameters.size(); ++I) {
     auto T = Parameters[I]->getType().getNonReferenceType();
     if (T->isPointerType() && !evidenceKindFromDeclaredType(T)) {
-      InferrableSlots.push_back(
-          std::make_pair(Analysis.assignNullabilityVariable(
-                             Parameters[I], AnalysisContext.arena()),
-                         paramSlot(I)));
+      Analysis.assignNullabilityVariableOnFirstUse(Parameters[I]);
+      InferrableParams.push_back({Parameters[I], paramSlot(I)});
     }
   }
 
-  std::vector<Evidence> AllEvidence;
+  // Elements are only visited once the analysis has converged, by which point
+  // the variables of all parameters that are read have been created.
+  std::optional<std::vector<std::pair<PointerTypeNullability, Slot>>>
+      InferrableSlots;
+  std::optional<PointerNullabilityDiagnoser> Diagnoser;
+  auto FindInferrableSlots = [&] {
+    InferrableSlots.emplace();
+    for (const auto &[Param, S] : InferrableParams)
+      if (auto *PN = Analysis.getNullabilityVariable(Param))
+        InferrableSlots->push_back({*PN, S});
+    if (!Diagnostics) return;
+    // Diagnose the code as if the parameters had their declared (unspecified)
+    // nullability, rather than the variables' unconstrained values.
+    Diagnoser.emplace();
+    auto &A = AnalysisContext.arena();
+    const dataflow::Formula *Unspecified = &A.makeLiteral(true);
+    for (const auto &[Nullability, S] : *InferrableSlots)
+      Unspecified = &A.makeAnd(
+          *Unspecified, A.makeAnd(A.makeNot(Nullability.isNullable(A)),
+                                  A.makeNot(Nullability.isNonnull(A))));
+    Analysis.assumeForDiagnosis(*Unspecified);
+  };
+  std::vector<CFGElement> PendingDiagnostics;
+
+  // Evidence is held back until we know the analysis finished within budget.
+  struct PendingEvidence {
+    const clang::Decl *Target;
+    Slot S;
+    Evidence::Kind Kind;
+    SourceLocation Loc;
+  };
+  std::vector<PendingEvidence> Pending;
+  auto Buffer = [&](const clang::Decl &Target, Slot S, Evidence::Kind Kind,
+                    SourceLocation Loc) {
+    Pending.push_back({&Target, S, Kind, Loc});
+  };
   llvm::Expected<std::vector<std::optional<
       dataflow::DataflowAnalysisState<PointerNullabilityLattice>>>>
       BlockToOutputStateOrError = dataflow::runDataflowAnalysis(
@@ -301,10 +465,27 @@ llvm::Error collectEvidenceFromImplementation(
           [&](const CFGElement &Element,
               const dataflow::DataflowAnalysisState<PointerNullabilityLattice>
                   &State) {
-            collectEvidenceFromElement(InferrableSlots, Element, State.Env,
-                                       Emit);
+            if (!InferrableSlots) FindInferrableSlots();
+            collectEvidenceFromElement(*InferrableSlots, Element, State.Env,
+                                       Buffer);
+            if (Diagnoser)
+              if (auto Diag = Diagnoser->diagnose(
+                      &Element, Func->getASTContext(),
+                      dataflow::TransferStateForDiagnostics<
+                          PointerNullabilityLattice>(State.Lattice,
+                                                     State.Env)))
+                PendingDiagnostics.push_back(*Diag);
           });
-
+  if (!BlockToOutputStateOrError)
+    return BlockToOutputStateOrError.takeError();
+  if (auto Err = SolverRef.check()) return Err;
+  LLVM_DEBUG(llvm::dbgs() << "Analyzed " << Func->getQualifiedNameAsString()
+                          << ": " << Analysis.atomsCreated()
+                          << " atoms created\n");
+
+  for (const auto &E : Pending) Emit(*E.Target, E.S, E.Kind, E.Loc);
+  if (Diagnostics)
+    llvm::append_range(*Diagnostics, PendingDiagnostics);
   return llvm::Error::success();
 }
 
@@ -322,13 +503,23 @@ void collectEvidenceFromTargetDeclaration(
   }
 }
 
-EvidenceSites EvidenceSites::discover(ASTContext &Ctx) {
+EvidenceSites EvidenceSites::discover(
+    ASTContext &Ctx, llvm::function_ref<bool(const Decl &)> ShouldTraverse) {
   struct Walker : public RecursiveASTVisitor<Walker> {
     EvidenceSites Out;
+    llvm::function_ref<bool(const Decl &)> ShouldTraverse;
 
     // We do want to see concrete code, including function instantiations.
     bool shouldVisitTemplateInstantiations() const { return true; }
 
+    bool TraverseDecl(Decl *D) {
+      // Pruning here skips the whole subtree, not just the Visit* callbacks.
+      if (D && ShouldTraverse && !isa<TranslationUnitDecl>(D) &&
+          !ShouldTraverse(*D))
+        return true;
+      return RecursiveASTVisitor::TraverseDecl(D);
+    }
+
     bool VisitFunctionDecl(const FunctionDecl *FD) {
       if (isInferenceTarget(*FD)) Out.Declarations.push_back(FD);
 
@@ -345,6 +536,7 @@ EvidenceSites EvidenceSites::discover(ASTContext &Ctx) {
   };
 
   Walker W;
+  W.ShouldTraverse = ShouldTraverse;
   W.TraverseAST(Ctx);
   return std::move(W.Out);
 }
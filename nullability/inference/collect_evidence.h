@@ -5,14 +5,24 @@
 #ifndef CRUBIT_NULLABILITY_INFERENCE_COLLECT_EVIDENCE_H_
 #define CRUBIT_NULLABILITY_INFERENCE_COLLECT_EVIDENCE_H_
 
+#include <chrono>
+#include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
 #include "nullability/inference/inference.proto.h"
+#include "nullability/type_nullability.h"
 #include "clang/AST/DeclBase.h"
+#include "clang/Analysis/CFG.h"
 #include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/Specifiers.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseMap.h"
 #include "llvm/ADT/FunctionExtras.h"
 #include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
 namespace clang::tidy::nullability {
@@ -25,16 +35,94 @@ using EvidenceEmitter = void(const Decl &Target, Slot, Evidence::Kind,
 llvm::unique_function<EvidenceEmitter> evidenceEmitter(
     llvm::unique_function<void(const Evidence &) const>);
 
+// Interns the symbols that evidence is collected for into dense IDs.
+//
+// Each symbol's USR is only generated and hashed once, so evidence can then be
+// grouped by symbol without hashing or comparing USR strings.
+class SymbolTable {
+ public:
+  // Returns the ID of the symbol declared by D (the same for all redecls),
+  // or std::nullopt if it has no USR.
+  std::optional<unsigned> intern(const Decl &D);
+
+  // The USR of a symbol, given its ID.
+  llvm::StringRef usr(unsigned ID) const { return USRs[ID]; }
+  // IDs are [0, size()).
+  unsigned size() const { return USRs.size(); }
+
+ private:
+  llvm::DenseMap<const Decl *, std::optional<unsigned>> IDByDecl;
+  llvm::StringMap<unsigned> IDByUSR;
+  std::vector<llvm::StringRef> USRs;  // Owned by IDByUSR.
+};
+
+// Creates an EvidenceEmitter that interns symbols into Symbols, and reports
+// Evidence protos without a `symbol` (which is identified by ID instead).
+// This is cheaper than the above, as USRs are not copied into every Evidence.
+llvm::unique_function<EvidenceEmitter> evidenceEmitter(
+    SymbolTable &Symbols,
+    llvm::unique_function<void(unsigned Symbol, const Evidence &) const>);
+
+// The conclusions of a previous round of inference.
+//
+// When analyzing an implementation, these stand in for the missing
+// annotations of the functions it calls.
+class PreviousInferences {
+ public:
+  explicit PreviousInferences(llvm::ArrayRef<Inference>);
+
+  // Returns the inferred nullability of a slot of the function D, if it was
+  // inferred as Nonnull or Nullable without conflicts.
+  std::optional<NullabilityKind> lookup(const Decl &D, Slot) const;
+
+ private:
+  // Indexed by slot.
+  llvm::StringMap<std::vector<std::optional<NullabilityKind>>> SlotsByUSR;
+};
+
+// Limits on the work spent analyzing one implementation, so that a single
+// pathological function can't dominate the runtime. Zero means unlimited.
+//
+// Implementations that exceed the budget produce no evidence, and an error
+// that says which limit was exceeded.
+struct AnalysisBudget {
+  // Maximum number of blocks in the function's CFG, checked up front.
+  unsigned MaxCFGBlocks = 0;
+  // Maximum total work (iterations) of the SAT solver.
+  std::int64_t MaxSolverWork = 0;
+  // Maximum wall-clock time. The analysis stops making SAT queries once this
+  // has elapsed, which is where pathological functions spend their time.
+  std::chrono::milliseconds Timeout{0};
+  // Joins nested deeper than this lose precision instead of growing the flow
+  // condition (see PointerNullabilityAnalysis::setMaxJoinDepth).
+  unsigned MaxJoinDepth = 0;
+};
+
 // Analyze code (such as a function body) to infer nullability.
 //
 // Produces Evidence constraining the nullability slots of the symbols that
 // the code interacts with, such as the function's own parameters.
 // This is based on the function's behavior and our definition of null-safety.
 //
+// If Previous is provided, values returned by unannotated callees are assumed
+// to have the nullability that was previously inferred for them.
+//
+// If TypeCache is provided, it memoizes the nullability of types across calls.
+// It must only be shared between implementations in the same ASTContext.
+//
+// If Diagnostics is provided, the same analysis run also checks the code's
+// null-safety (as PointerNullabilityDiagnoser does), and appends the elements
+// that violate it. This avoids analyzing the code twice when both evidence and
+// diagnostics are needed.
+//
 // It is up to the caller to ensure the implementation is eligible for inference
 // (function has a body, is not dependent, etc).
 llvm::Error collectEvidenceFromImplementation(
-    const Decl &, llvm::function_ref<EvidenceEmitter>);
+    const Decl &, llvm::function_ref<EvidenceEmitter>,
+    const PreviousInferences *Previous = nullptr,
+    const AnalysisBudget &Budget = {},
+    TypeNullabilityCache *TypeCache = nullptr,
+    std::vector<CFGElement> *Diagnostics = nullptr);
 
 // Gathers evidence of a symbol's nullability from a declaration of it.
 //
@@ -56,7 +144,15 @@ struct EvidenceSites {
   std::vector<const Decl *> Implementations;
 
   // Find the evidence sites within the provided AST.
-  static EvidenceSites discover(ASTContext &);
+  //
+  // If ShouldTraverse is provided, declarations for which it returns false are
+  // skipped together with everything they contain (e.g. all the members of a
+  // namespace or class), without being traversed. This allows limiting the
+  // discovery to e.g. the code in the main file, or the code of one target,
+  // without walking all the headers it includes.
+  static EvidenceSites discover(
+      ASTContext &,
+      llvm::function_ref<bool(const Decl &)> ShouldTraverse = {});
 };
 
 // Returns the slot number for the I'th parameter (0-based).
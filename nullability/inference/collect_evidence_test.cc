@@ -4,6 +4,7 @@
 
 #include "nullability/inference/collect_evidence.h"
 
+#include <optional>
 #include <string>
 #include <utility>
 #include <vector>
@@ -17,6 +18,7 @@
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
+#include "llvm/Testing/Support/Error.h"
 #include "third_party/llvm/llvm-project/third-party/unittest/googlemock/include/gmock/gmock.h"  // IWYU pragma: keep
 #include "third_party/llvm/llvm-project/third-party/unittest/googletest/include/gtest/gtest.h"
 
@@ -103,6 +105,31 @@ TEST(CollectEvidenceFromImplementationTest, OneParamUsedWithoutRestriction) {
               Not(Contains(evidence(_, _, functionNamed("target")))));
 }
 
+TEST(CollectEvidenceFromImplementationTest, OverBudget) {
+  clang::TestAST AST(getInputsWithAnnotationDefinitions(R"cc(
+    void target(int *p, bool b) {
+      if (b) *p;
+    }
+  )cc"));
+  const auto &Target = *dataflow::test::findValueDecl(AST.context(), "target");
+  std::vector<Evidence> Results;
+  auto Emitter =
+      evidenceEmitter([&](const Evidence& E) { Results.push_back(E); });
+
+  AnalysisBudget Budget;
+  Budget.MaxCFGBlocks = 2;
+  EXPECT_THAT_ERROR(
+      collectEvidenceFromImplementation(Target, Emitter, nullptr, Budget),
+      llvm::FailedWithMessage(testing::HasSubstr("analysis budget exceeded")));
+  EXPECT_THAT(Results, IsEmpty());
+
+  Budget.MaxCFGBlocks = 100;
+  EXPECT_THAT_ERROR(
+      collectEvidenceFromImplementation(Target, Emitter, nullptr, Budget),
+      llvm::Succeeded());
+  EXPECT_THAT(Results, Not(IsEmpty()));
+}
+
 TEST(CollectEvidenceFromImplementationTest, Deref) {
   static constexpr llvm::StringRef Src = R"cc(
     void target(int *p0, int *p1) {
@@ -492,5 +519,73 @@ TEST(EvidenceSitesTest, Templates) {
                           declNamed("S::f<0>"), declNamed("T<0>::f")));
 }
 
+TEST(EvidenceSitesTest, ShouldTraverse) {
+  TestAST AST(R"cc(
+    void foo() {}
+    namespace skipped {
+    void bar() {}
+    struct S {
+      void member() {}
+    };
+    }  // namespace skipped
+    struct Skipped {
+      void member() {}
+    };
+    void baz();
+  )cc");
+  int NumSkipped = 0;
+  auto Sites = EvidenceSites::discover(AST.context(), [&](const Decl &D) {
+    const auto *ND = dyn_cast<NamedDecl>(&D);
+    bool Skip = ND && (ND->getNameAsString() == "skipped" ||
+                       ND->getNameAsString() == "Skipped");
+    NumSkipped += Skip;
+    return !Skip;
+  });
+  EXPECT_THAT(Sites.Declarations,
+              ElementsAre(declNamed("foo"), declNamed("baz")));
+  EXPECT_THAT(Sites.Implementations, ElementsAre(declNamed("foo")));
+  // The contents of skipped declarations aren't even offered to the filter.
+  EXPECT_EQ(NumSkipped, 2);
+}
+
+TEST(SymbolTableTest, Redecls) {
+  TestAST AST(R"cc(
+    void f(int *);
+    void f(int *p) {}
+    void g(int *);
+  )cc");
+  SymbolTable Symbols;
+  std::vector<std::optional<unsigned>> IDs;
+  for (const Decl* D : AST.context().getTranslationUnitDecl()->decls())
+    if (isa<FunctionDecl>(D)) IDs.push_back(Symbols.intern(*D));
+
+  // Redecls of the same function get the same ID, IDs are dense.
+  ASSERT_THAT(IDs, ElementsAre(0u, 0u, 1u));
+  EXPECT_EQ(Symbols.size(), 2u);
+  EXPECT_EQ(Symbols.usr(0), "c:@F@f#*I#");
+  EXPECT_EQ(Symbols.usr(1), "c:@F@g#*I#");
+}
+
+TEST(SymbolTableTest, InterningEmitter) {
+  clang::TestAST AST(getInputsWithAnnotationDefinitions(R"cc(
+    void target(Nonnull<int *> p, Nullable<int *> q);
+  )cc"));
+  SymbolTable Symbols;
+  std::vector<std::pair<unsigned, Evidence>> Results;
+  collectEvidenceFromTargetDeclaration(
+      *dataflow::test::findValueDecl(AST.context(), "target"),
+      evidenceEmitter(Symbols, [&](unsigned Symbol, const Evidence& E) {
+        Results.emplace_back(Symbol, E);
+      }));
+
+  ASSERT_EQ(Results.size(), 2u);
+  for (const auto& [Symbol, E] : Results) {
+    EXPECT_EQ(Symbol, 0u);
+    // The symbol is only identified by its ID.
+    EXPECT_FALSE(E.has_symbol());
+  }
+  EXPECT_THAT(Symbols.usr(0), testing::HasSubstr("@F@target#"));
+}
+
 }  // namespace
 }  // namespace clang::tidy::nullability
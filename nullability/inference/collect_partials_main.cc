@@ -0,0 +1,242 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// collect_partials_main is the "map" phase of whole-codebase inference.
+//
+// For each translation unit, it collects the evidence about all symbols and
+// writes the combined Partials to -output_dir, sharded into -num_shards files
+// by symbol (see partial_shards.h). merge_partials_main then reduces each
+// shard into Inferences.
+//
+// The translation units may be processed by many invocations in parallel
+// (e.g. on different machines), as long as they share -output_dir and
+// -num_shards. Within one invocation, `--executor=all-TUs` together with
+// `--execute-concurrency=N` processes N translation units at a time: each has
+// its own AST, and writes its own output files.
+//
+// Functions defined outside the main file (e.g. inline functions in headers)
+// are only analyzed in one of the translation units that include them: the
+// first one processed by this invocation, or across invocations that share
+// -claims_dir.
+//
+// With -check_null_safety, the analysis that collects each function's evidence
+// also checks its null-safety, like nullability_check_main does, and reports
+// violations as warnings. This avoids analyzing every function twice.
+//
+// (Functions within a translation unit are analyzed one at a time: the
+// dataflow analysis creates types in the shared ASTContext, and ASTContext is
+// not thread-safe.)
+
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+
+#include "absl/log/check.h"
+#include "nullability/inference/collect_evidence.h"
+#include "nullability/inference/infer_tu.h"
+#include "nullability/inference/partial_shards.h"
+#include "nullability/pointer_nullability_diagnosis.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Tooling/ArgumentsAdjusters.h"
+#include "clang/Tooling/Execution.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/StringSet.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+llvm::cl::OptionCategory Opts("collect_partials_main options");
+llvm::cl::opt<std::string> OutputDir{
+    "output_dir",
+    llvm::cl::desc("Directory to write the sharded Partials to"),
+    llvm::cl::Required,
+};
+llvm::cl::opt<unsigned> NumShards{
+    "num_shards",
+    llvm::cl::desc("Number of shards to partition the Partials into"),
+    llvm::cl::init(64),
+};
+llvm::cl::opt<bool> DedupHeaderImplementations{
+    "dedup_header_implementations",
+    llvm::cl::desc("Analyze each function defined outside the main file in "
+                   "only one of the translation units that include it"),
+    llvm::cl::init(true),
+};
+llvm::cl::opt<bool> CheckNullSafety{
+    "check_null_safety",
+    llvm::cl::desc("Also warn about null-safety violations in the analyzed "
+                   "functions, from the same analysis as the evidence"),
+    llvm::cl::init(false),
+};
+llvm::cl::opt<std::string> ClaimsDir{
+    "claims_dir",
+    llvm::cl::desc("Directory shared by all invocations, recording which "
+                   "translation unit analyzes each function defined outside "
+                   "the main file (default: only dedup within this process)"),
+};
+
+llvm::cl::opt<unsigned> MaxCFGBlocks{
+    "max_cfg_blocks",
+    llvm::cl::desc("Skip functions with more CFG blocks (0: unlimited)"),
+    llvm::cl::init(0),
+};
+llvm::cl::opt<int64_t> MaxSolverWork{
+    "max_solver_work",
+    llvm::cl::desc("Skip functions needing more SAT solver work "
+                   "(0: unlimited)"),
+    llvm::cl::init(0),
+};
+llvm::cl::opt<unsigned> TimeoutMs{
+    "timeout_ms",
+    llvm::cl::desc("Skip functions taking longer to analyze (0: unlimited)"),
+    llvm::cl::init(0),
+};
+llvm::cl::opt<unsigned> MaxJoinDepth{
+    "max_join_depth",
+    llvm::cl::desc("Forget what's known about pointers after this many nested "
+                   "joins, to keep SAT queries fast (0: unlimited)"),
+    llvm::cl::init(0),
+};
+
+clang::tidy::nullability::AnalysisBudget analysisBudget() {
+  clang::tidy::nullability::AnalysisBudget Budget;
+  Budget.MaxCFGBlocks = MaxCFGBlocks;
+  Budget.MaxSolverWork = MaxSolverWork;
+  Budget.Timeout = std::chrono::milliseconds(TimeoutMs);
+  Budget.MaxJoinDepth = MaxJoinDepth;
+  return Budget;
+}
+
+namespace clang::tidy::nullability {
+namespace {
+
+// Decides which translation unit analyzes each implementation that is not in
+// its main file (e.g. inline functions in headers). The evidence from such an
+// implementation is the same in every translation unit that includes it, so
+// it only needs to be collected once.
+class ImplementationClaims {
+  std::mutex Mu;
+  llvm::StringSet<> Claimed;  // USRs claimed in this process. Guarded by Mu.
+
+  // Claims USR for the translation unit Stem in ClaimsDir, which is shared
+  // with other processes. Returns whether Stem owns the claim, which remains
+  // true if the translation unit is processed again.
+  static bool claimInDir(llvm::StringRef USR, llvm::StringRef Stem) {
+    llvm::SmallString<256> Path(ClaimsDir.getValue());
+    llvm::sys::path::append(Path, llvm::utohexstr(llvm::xxHash64(USR)));
+    int FD;
+    if (!llvm::sys::fs::openFileForWrite(Path, FD,
+                                         llvm::sys::fs::CD_CreateNew)) {
+      llvm::raw_fd_ostream(FD, /*shouldClose=*/true) << Stem;
+      return true;
+    }
+    auto Owner = llvm::MemoryBuffer::getFile(Path);
+    return Owner && (*Owner)->getBuffer() == Stem;
+  }
+
+ public:
+  bool claim(const Decl &Impl, llvm::StringRef Stem) {
+    const auto &SM = Impl.getASTContext().getSourceManager();
+    if (SM.isInMainFile(SM.getExpansionLoc(Impl.getLocation()))) return true;
+    llvm::SmallString<128> USR;
+    // Without a USR we can't dedup, so always analyze.
+    if (index::generateUSRForDecl(&Impl, USR)) return true;
+    {
+      std::lock_guard<std::mutex> Lock(Mu);
+      if (!Claimed.insert(USR).second) return false;
+    }
+    return ClaimsDir.empty() || claimInDir(USR, Stem);
+  }
+};
+
+// Shared by all translation units processed in this process.
+ImplementationClaims &claims() {
+  static auto *Claims = new ImplementationClaims();
+  return *Claims;
+}
+
+class Action : public SyntaxOnlyAction {
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
+                                                 llvm::StringRef) override {
+    class Consumer : public ASTConsumer {
+      void HandleTranslationUnit(ASTContext &Ctx) override {
+        const auto &SM = Ctx.getSourceManager();
+        llvm::StringRef MainFile =
+            SM.getFileEntryRefForID(SM.getMainFileID())->getName();
+        // Name the output after the main file, so that reprocessing a
+        // translation unit replaces its previous output.
+        std::string Stem = llvm::utohexstr(llvm::xxHash64(MainFile));
+        auto ShouldAnalyze = [&](const Decl &Impl) {
+          return !DedupHeaderImplementations || claims().claim(Impl, Stem);
+        };
+        unsigned DiagViolation = Ctx.getDiagnostics().getCustomDiagID(
+            DiagnosticsEngine::Warning, "violates null-safety [nullability]");
+        auto ReportViolations = [&](const Decl &,
+                                    llvm::ArrayRef<CFGElement> Violations) {
+          for (const CFGElement &Element : Violations)
+            if (SourceLocation Loc = getDiagnosticLocation(Element);
+                Loc.isValid())
+              Ctx.getDiagnostics().Report(Loc, DiagViolation);
+        };
+        auto Partials = collectPartials(
+            Ctx, ShouldAnalyze, analysisBudget(),
+            CheckNullSafety
+                ? llvm::function_ref<void(const Decl &,
+                                          llvm::ArrayRef<CFGElement>)>(
+                      ReportViolations)
+                : nullptr);
+        if (auto Err =
+                writeShardedPartials(Partials, OutputDir, Stem, NumShards))
+          llvm::errs() << "Failed to write Partials for " << MainFile << ": "
+                       << toString(std::move(Err)) << "\n";
+      }
+    };
+    return std::make_unique<Consumer>();
+  }
+};
+
+}  // namespace
+}  // namespace clang::tidy::nullability
+
+int main(int argc, const char **argv) {
+  using namespace clang::tooling;
+  auto Exec = createExecutorFromCommandLineArgs(argc, argv, Opts);
+  QCHECK(Exec) << toString(Exec.takeError());
+  QCHECK(NumShards > 0) << "-num_shards must be positive";
+  QCHECK(!llvm::sys::fs::create_directories(OutputDir.getValue()))
+      << "Failed to create " << OutputDir.getValue();
+  if (!ClaimsDir.empty())
+    QCHECK(!llvm::sys::fs::create_directories(ClaimsDir.getValue()))
+        << "Failed to create " << ClaimsDir.getValue();
+  // Unless we report null-safety violations as warnings, silence warnings.
+  auto Err = (*Exec)->execute(
+      newFrontendActionFactory<clang::tidy::nullability::Action>(),
+      CheckNullSafety
+          ? getInsertArgumentAdjuster("-Wno-everything",
+                                      ArgumentInsertPosition::BEGIN)
+          : getInsertArgumentAdjuster("-w", ArgumentInsertPosition::BEGIN));
+  QCHECK(!Err) << toString(std::move(Err));
+}
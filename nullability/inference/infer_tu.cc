@@ -4,49 +4,196 @@
 
 #include "nullability/inference/infer_tu.h"
 
+#include <optional>
 #include <utility>
 #include <vector>
 
 #include "nullability/inference/collect_evidence.h"
 #include "nullability/inference/inference.proto.h"
 #include "nullability/inference/merge.h"
+#include "nullability/type_nullability.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Analysis/CFG.h"
 #include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/DenseSet.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/raw_ostream.h"
 
 namespace clang::tidy::nullability {
 
-std::vector<Inference> inferTU(ASTContext& Ctx) {
-  std::vector<Evidence> AllEvidence;
+namespace {
+
+// Merges evidence into one Partial per symbol, as soon as it is emitted.
+// This way we only hold one Partial per symbol rather than every Evidence.
+// Symbols are identified by their ID in a SymbolTable: the Partials only get
+// their USRs once they're complete.
+class PartialsBySymbol {
+  std::vector<std::optional<Partial>> Partials;
+
+ public:
+  void add(unsigned Symbol, Partial P) {
+    if (Symbol >= Partials.size()) Partials.resize(Symbol + 1);
+    if (auto& Merged = Partials[Symbol])
+      mergePartials(*Merged, P);
+    else
+      Merged = std::move(P);
+  }
+
+  void addAll(const PartialsBySymbol& Other) {
+    for (unsigned Symbol = 0; Symbol < Other.Partials.size(); ++Symbol)
+      if (Other.Partials[Symbol]) add(Symbol, *Other.Partials[Symbol]);
+  }
+
+  // Returns the Partials with their USRs, ordered by USR so the output is
+  // deterministic.
+  std::vector<Partial> finish(const SymbolTable& Symbols) && {
+    std::vector<Partial> AllPartials;
+    AllPartials.reserve(Partials.size());
+    for (unsigned Symbol = 0; Symbol < Partials.size(); ++Symbol) {
+      if (!Partials[Symbol]) continue;
+      Partial& P = AllPartials.emplace_back(std::move(*Partials[Symbol]));
+      P.mutable_symbol()->set_usr(Symbols.usr(Symbol).str());
+    }
+    llvm::sort(AllPartials, [&](const Partial& L, const Partial& R) {
+      return L.symbol().usr() < R.symbol().usr();
+    });
+    return AllPartials;
+  }
+};
+
+void analyze(const Decl& Impl, llvm::function_ref<EvidenceEmitter> Emitter,
+             const PreviousInferences* Previous,
+             const AnalysisBudget& Budget, TypeNullabilityCache& TypeCache,
+             std::vector<CFGElement>* Diagnostics = nullptr) {
+  if (auto Err = collectEvidenceFromImplementation(
+          Impl, Emitter, Previous, Budget, &TypeCache, Diagnostics)) {
+    llvm::errs() << "Skipping function: " << toString(std::move(Err)) << "\n";
+    Impl.print(llvm::errs());
+  }
+}
+
+// Returns the functions that Impl calls directly (their canonical decls).
+llvm::DenseSet<const FunctionDecl*> directCallees(const Decl& Impl) {
+  struct Visitor : RecursiveASTVisitor<Visitor> {
+    llvm::DenseSet<const FunctionDecl*> Callees;
+    bool VisitCallExpr(CallExpr* CE) {
+      if (auto* Callee = CE->getDirectCallee())
+        Callees.insert(Callee->getCanonicalDecl());
+      return true;
+    }
+  } V;
+  V.TraverseStmt(Impl.getBody());
+  return std::move(V.Callees);
+}
+
+std::vector<Inference> finalizeAll(llvm::ArrayRef<Partial> Partials) {
+  std::vector<Inference> AllInference;
+  AllInference.reserve(Partials.size());
+  for (const Partial& P : Partials) AllInference.push_back(finalize(P));
+  return AllInference;
+}
+
+}  // namespace
+
+std::vector<Partial> collectPartials(
+    ASTContext& Ctx, llvm::function_ref<bool(const Decl&)> ShouldAnalyze,
+    const AnalysisBudget& Budget,
+    llvm::function_ref<void(const Decl&, llvm::ArrayRef<CFGElement>)>
+        OnDiagnostics,
+    llvm::function_ref<bool(const Decl&)> ShouldTraverse) {
+  SymbolTable Symbols;
+  PartialsBySymbol Partials;
+  TypeNullabilityCache TypeCache;
 
   // Collect all evidence.
-  auto Sites = EvidenceSites::discover(Ctx);
-  auto Emitter = evidenceEmitter([&](auto& E) { AllEvidence.push_back(E); });
+  auto Sites = EvidenceSites::discover(Ctx, ShouldTraverse);
+  auto Emitter =
+      evidenceEmitter(Symbols, [&](unsigned Symbol, const Evidence& E) {
+        Partials.add(Symbol, partialFromEvidence(E));
+      });
   for (const auto* Decl : Sites.Declarations)
     collectEvidenceFromTargetDeclaration(*Decl, Emitter);
+  // Implementations can't be analyzed concurrently: the analysis creates types
+  // etc in the ASTContext, which isn't thread-safe. Run one TU per thread
+  // instead (see collect_partials_main).
+  std::vector<CFGElement> Diagnostics;
   for (const auto* Impl : Sites.Implementations) {
-    if (auto Err = collectEvidenceFromImplementation(*Impl, Emitter)) {
-      llvm::errs() << "Skipping function: " << toString(std::move(Err)) << "\n";
-      Impl->print(llvm::errs());
-    }
+    if (ShouldAnalyze && !ShouldAnalyze(*Impl)) continue;
+    Diagnostics.clear();
+    analyze(*Impl, Emitter, /*Previous=*/nullptr, Budget, TypeCache,
+            OnDiagnostics ? &Diagnostics : nullptr);
+    if (OnDiagnostics) OnDiagnostics(*Impl, Diagnostics);
   }
-  // Group by symbol.
-  llvm::sort(AllEvidence, [&](const Evidence& L, const Evidence& R) {
-    return L.symbol().usr() < R.symbol().usr();
-  });
-  // For each symbol, combine evidence into an inference.
-  llvm::ArrayRef<Evidence> RemainingEvidence = AllEvidence;
+  return std::move(Partials).finish(Symbols);
+}
+
+std::vector<Inference> inferTU(
+    ASTContext& Ctx, unsigned MaxRounds, const AnalysisBudget& Budget,
+    llvm::function_ref<bool(const Decl&)> ShouldTraverse) {
+  if (MaxRounds <= 1)
+    return finalizeAll(collectPartials(Ctx, /*ShouldAnalyze=*/{}, Budget,
+                                       /*OnDiagnostics=*/{}, ShouldTraverse));
+
+  // Each round keeps the evidence from each implementation separately, so
+  // that the next round only needs to re-analyze the implementations that
+  // call functions whose inferences changed.
+  SymbolTable Symbols;
+  TypeNullabilityCache TypeCache;
+  PartialsBySymbol* Target = nullptr;
+  auto Emitter =
+      evidenceEmitter(Symbols, [&](unsigned Symbol, const Evidence& E) {
+        Target->add(Symbol, partialFromEvidence(E));
+      });
+  auto Sites = EvidenceSites::discover(Ctx, ShouldTraverse);
+
+  PartialsBySymbol FromDeclarations;
+  Target = &FromDeclarations;
+  for (const auto* Decl : Sites.Declarations)
+    collectEvidenceFromTargetDeclaration(*Decl, Emitter);
+
+  std::vector<PartialsBySymbol> FromImplementations(
+      Sites.Implementations.size());
+  std::vector<llvm::DenseSet<const FunctionDecl*>> Callees;
+  for (const auto* Impl : Sites.Implementations)
+    Callees.push_back(directCallees(*Impl));
+
+  std::optional<PreviousInferences> Previous;
+  llvm::DenseSet<const FunctionDecl*> Changed;
   std::vector<Inference> AllInference;
-  while (!RemainingEvidence.empty()) {
-    auto Batch = RemainingEvidence.take_while([&](const Evidence& E) {
-      return E.symbol().usr() == RemainingEvidence.front().symbol().usr();
-    });
-    RemainingEvidence = RemainingEvidence.drop_front(Batch.size());
-    AllInference.push_back(mergeEvidence(Batch));
-  }
+  for (unsigned Round = 0; Round < MaxRounds; ++Round) {
+    for (unsigned I = 0; I < Sites.Implementations.size(); ++I) {
+      if (Round > 0 && llvm::none_of(Callees[I], [&](const FunctionDecl* C) {
+            return Changed.contains(C);
+          }))
+        continue;
+      FromImplementations[I] = PartialsBySymbol();
+      Target = &FromImplementations[I];
+      analyze(*Sites.Implementations[I], Emitter,
+              Previous ? &*Previous : nullptr, Budget, TypeCache);
+    }
 
+    PartialsBySymbol All = FromDeclarations;
+    for (const auto& Partials : FromImplementations) All.addAll(Partials);
+    AllInference = finalizeAll(std::move(All).finish(Symbols));
+
+    // Stop at a fixpoint: when no callee's inferred return nullability (which
+    // is all that the analysis takes from the previous round) has changed.
+    PreviousInferences Next(AllInference);
+    Changed.clear();
+    for (const auto& ImplCallees : Callees)
+      for (const FunctionDecl* C : ImplCallees)
+        if ((Previous ? Previous->lookup(*C, SLOT_RETURN_TYPE)
+                      : std::nullopt) != Next.lookup(*C, SLOT_RETURN_TYPE))
+          Changed.insert(C);
+    if (Changed.empty()) break;
+    Previous.emplace(std::move(Next));
+  }
   return AllInference;
 }
 
@@ -7,8 +7,13 @@
 
 #include <vector>
 
+#include "nullability/inference/collect_evidence.h"
 #include "nullability/inference/inference.proto.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/Analysis/CFG.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 
 namespace clang::tidy::nullability {
 
@@ -17,7 +22,46 @@ namespace clang::tidy::nullability {
 // This is not as powerful as running inference over the whole codebase, but is
 // useful in observing the behavior of the inference system.
 // It also lets us write tests for the whole inference system.
-std::vector<Inference> inferTU(ASTContext &);
+//
+// Evidence about a function's callers depends on what is known about the
+// functions they call. If MaxRounds > 1, inference is repeated, each round
+// using the previous round's conclusions in place of missing annotations on
+// callees' return types. Only implementations that call functions whose
+// conclusions changed are re-analyzed, until nothing changes (a fixpoint) or
+// MaxRounds rounds have run.
+//
+// Each implementation is analyzed within Budget. If ShouldTraverse is
+// provided, only the declarations it accepts (and the ones they contain) are
+// considered, see EvidenceSites::discover.
+std::vector<Inference> inferTU(
+    ASTContext &, unsigned MaxRounds = 1, const AnalysisBudget &Budget = {},
+    llvm::function_ref<bool(const Decl &)> ShouldTraverse = {});
+
+// Collects the evidence within a single translation unit, combined into one
+// Partial per symbol (ordered by USR).
+//
+// This is the "map" phase of whole-codebase inference: the Partials of all
+// translation units are merged and finalized by merge_partials_main.
+//
+// If ShouldAnalyze is provided, implementations for which it returns false
+// are skipped. This allows e.g. analyzing inline functions defined in headers
+// in only one of the translation units that include them. Implementations are
+// analyzed within Budget.
+//
+// If OnDiagnostics is provided, the analysis of each implementation also
+// checks its null-safety, and OnDiagnostics receives the elements that violate
+// it (see collectEvidenceFromImplementation).
+//
+// If ShouldTraverse is provided, declarations it rejects are pruned from the
+// discovery of evidence sites, along with the declarations they contain (see
+// EvidenceSites::discover). Unlike ShouldAnalyze, this also skips their
+// declarations, and doesn't walk them at all.
+std::vector<Partial> collectPartials(
+    ASTContext &, llvm::function_ref<bool(const Decl &)> ShouldAnalyze = {},
+    const AnalysisBudget &Budget = {},
+    llvm::function_ref<void(const Decl &, llvm::ArrayRef<CFGElement>)>
+        OnDiagnostics = {},
+    llvm::function_ref<bool(const Decl &)> ShouldTraverse = {});
 
 }  // namespace clang::tidy::nullability
 
@@ -6,20 +6,28 @@
 //
 // By default (-diagnostics=1) it shows findings as diagnostics.
 // It can optionally (-protos=1) print the Inference proto.
+// It can also (-partials_out=FILE) write the TU's Partials in binary form, for
+// merge_partials_main or other tools reading them with RecordReader.
 //
 // This is not the intended way to fully analyze a real codebase.
 // e.g. it can't jointly inspect all callsites of a function (in different TUs).
 
+#include <chrono>
+#include <cstdint>
 #include <memory>
 #include <string>
+#include <system_error>
 #include <utility>
 
 #include "absl/log/check.h"
+#include "nullability/inference/collect_evidence.h"
 #include "nullability/inference/infer_tu.h"
 #include "nullability/inference/inference.proto.h"
+#include "nullability/inference/partial_shards.h"
 #include "clang/AST/ASTConsumer.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/Frontend/CompilerInstance.h"
 #include "clang/Frontend/FrontendAction.h"
 #include "clang/Frontend/FrontendActions.h"
@@ -58,6 +66,55 @@ llvm::cl::opt<bool> IncludeTrivial{
     llvm::cl::desc("Include trivial inferences (annotated, no conflicts)"),
     llvm::cl::init(false),
 };
+llvm::cl::opt<std::string> PartialsOut{
+    "partials_out",
+    llvm::cl::desc("Write the TU's Partial protos to this file, as a stream of "
+                   "length-delimited binary records (see partial_shards.h)"),
+};
+llvm::cl::opt<bool> MainFileOnly{
+    "main_file_only",
+    llvm::cl::desc("Only collect evidence from code in the main file, without "
+                   "walking the headers it includes"),
+    llvm::cl::init(false),
+};
+llvm::cl::opt<unsigned> Rounds{
+    "rounds",
+    llvm::cl::desc("Maximum rounds of inference, each one building on the "
+                   "conclusions of the previous one"),
+    llvm::cl::init(1),
+};
+
+llvm::cl::opt<unsigned> MaxCFGBlocks{
+    "max_cfg_blocks",
+    llvm::cl::desc("Skip functions with more CFG blocks (0: unlimited)"),
+    llvm::cl::init(0),
+};
+llvm::cl::opt<int64_t> MaxSolverWork{
+    "max_solver_work",
+    llvm::cl::desc("Skip functions needing more SAT solver work "
+                   "(0: unlimited)"),
+    llvm::cl::init(0),
+};
+llvm::cl::opt<unsigned> TimeoutMs{
+    "timeout_ms",
+    llvm::cl::desc("Skip functions taking longer to analyze (0: unlimited)"),
+    llvm::cl::init(0),
+};
+llvm::cl::opt<unsigned> MaxJoinDepth{
+    "max_join_depth",
+    llvm::cl::desc("Forget what's known about pointers after this many nested "
+                   "joins, to keep SAT queries fast (0: unlimited)"),
+    llvm::cl::init(0),
+};
+
+clang::tidy::nullability::AnalysisBudget analysisBudget() {
+  clang::tidy::nullability::AnalysisBudget Budget;
+  Budget.MaxCFGBlocks = MaxCFGBlocks;
+  Budget.MaxSolverWork = MaxSolverWork;
+  Budget.Timeout = std::chrono::milliseconds(TimeoutMs);
+  Budget.MaxJoinDepth = MaxJoinDepth;
+  return Budget;
+}
 
 namespace clang::tidy::nullability {
 namespace {
@@ -128,13 +185,31 @@ bool isTrivial(const Inference::SlotInference &I) {
   return false;
 }
 
+// Prunes the evidence sites outside of the main file, with -main_file_only.
+bool shouldTraverse(const Decl &D) {
+  const SourceManager &SM = D.getASTContext().getSourceManager();
+  return !MainFileOnly || SM.isInMainFile(SM.getExpansionLoc(D.getLocation()));
+}
+
+void writePartials(ASTContext &Ctx) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(PartialsOut, EC);
+  QCHECK(!EC) << "Failed to open " << PartialsOut.getValue() << ": "
+              << EC.message();
+  for (const Partial &P :
+       collectPartials(Ctx, /*ShouldAnalyze=*/{}, analysisBudget(),
+                       /*OnDiagnostics=*/{}, shouldTraverse))
+    writeRecord(P, OS);
+}
+
 class Action : public SyntaxOnlyAction {
   std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
                                                  llvm::StringRef) override {
     class Consumer : public ASTConsumer {
       void HandleTranslationUnit(ASTContext &Ctx) override {
+        if (!PartialsOut.empty()) writePartials(Ctx);
         llvm::errs() << "Running inference...";
-        auto Results = inferTU(Ctx);
+        auto Results = inferTU(Ctx, Rounds, analysisBudget(), shouldTraverse);
         if (!IncludeTrivial)
           llvm::erase_if(Results, [](Inference &I) {
             llvm::erase_if(*I.mutable_slot_inference(), isTrivial);
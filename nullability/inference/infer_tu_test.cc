@@ -5,14 +5,20 @@
 #include "nullability/inference/infer_tu.h"
 
 #include <optional>
+#include <string>
 #include <vector>
 
 #include "nullability/inference/inference.proto.h"
 #include "nullability/proto_matchers.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclBase.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Analysis/CFG.h"
 #include "clang/Index/USRGeneration.h"
 #include "clang/Testing/TestAST.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
 #include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "third_party/llvm/llvm-project/third-party/unittest/googlemock/include/gmock/gmock.h"
@@ -50,7 +56,12 @@ class InferTUTest : public ::testing::Test {
     AST.emplace(Inputs);
   }
 
-  auto infer() { return inferTU(AST->context()); }
+  auto infer(unsigned MaxRounds = 1) {
+    return inferTU(AST->context(), MaxRounds);
+  }
+  auto collect(llvm::function_ref<bool(const Decl &)> ShouldAnalyze) {
+    return collectPartials(AST->context(), ShouldAnalyze);
+  }
 
   // Returns a matcher for an Inference.
   // The DeclMatcher should uniquely identify the symbol being described.
@@ -194,5 +205,74 @@ TEST_F(InferTUTest, ReturnTypeNonnullAndNullable) {
                                  {inferredSlot(0, Inference::NULLABLE)})));
 }
 
+TEST_F(InferTUTest, IterativeRounds) {
+  build(R"cc(
+    int* getNull() { return nullptr; }
+    int* forward() { return getNull(); }
+    int* forwardAgain() { return forward(); }
+  )cc");
+  // A single round only learns about the function returning nullptr directly.
+  EXPECT_THAT(infer(),
+              Contains(inference(hasName("forward"),
+                                 {inferredSlot(0, Inference::UNKNOWN)})));
+  // Each further round propagates that through another caller.
+  auto Results = infer(/*MaxRounds=*/2);
+  EXPECT_THAT(Results,
+              Contains(inference(hasName("forward"),
+                                 {inferredSlot(0, Inference::NULLABLE)})));
+  EXPECT_THAT(Results,
+              Contains(inference(hasName("forwardAgain"),
+                                 {inferredSlot(0, Inference::UNKNOWN)})));
+  // Until nothing changes.
+  EXPECT_THAT(infer(/*MaxRounds=*/10),
+              ElementsAre(inference(hasName("forward"),
+                                    {inferredSlot(0, Inference::NULLABLE)}),
+                          inference(hasName("forwardAgain"),
+                                    {inferredSlot(0, Inference::NULLABLE)}),
+                          inference(hasName("getNull"),
+                                    {inferredSlot(0, Inference::NULLABLE)})));
+}
+
+TEST_F(InferTUTest, CollectPartialsSkipsImplementations) {
+  build(R"cc(
+    void target(int *p) { *p; }
+    void skipped(int *p) { *p; }
+    void annotated(Nonnull<int *> p);
+  )cc");
+  auto Partials = collect([](const Decl &Impl) {
+    return cast<NamedDecl>(Impl).getName() != "skipped";
+  });
+
+  // Declarations are still inspected, only implementations are skipped.
+  std::vector<std::string> USRs;
+  for (const auto &P : Partials) USRs.push_back(P.symbol().usr());
+  EXPECT_THAT(USRs, ElementsAre(testing::HasSubstr("@F@annotated#"),
+                                testing::HasSubstr("@F@target#")));
+}
+
+TEST_F(InferTUTest, CollectPartialsDiagnoses) {
+  build(R"cc(
+    void unannotated(int *p) { *p; }
+    void nullable(Nullable<int *> p) { *p; }
+    void checked(Nullable<int *> p) {
+      if (p) *p;
+    }
+  )cc");
+  std::vector<std::string> Violations;
+  auto Partials = collectPartials(
+      AST->context(), /*ShouldAnalyze=*/{}, /*Budget=*/{},
+      [&](const Decl &Impl, llvm::ArrayRef<CFGElement> Diagnostics) {
+        for (unsigned I = 0; I < Diagnostics.size(); ++I)
+          Violations.push_back(cast<NamedDecl>(Impl).getName().str());
+      });
+
+  // Unannotated parameters are checked as unspecified, even though the same
+  // analysis infers their nullability.
+  EXPECT_THAT(Violations, ElementsAre("nullable"));
+  std::vector<std::string> USRs;
+  for (const auto &P : Partials) USRs.push_back(P.symbol().usr());
+  EXPECT_THAT(USRs, testing::Contains(testing::HasSubstr("@F@unannotated#")));
+}
+
 }  // namespace
 }  // namespace clang::tidy::nullability
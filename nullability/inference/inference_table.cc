@@ -0,0 +1,146 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "nullability/inference/inference_table.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "nullability/inference/inference.proto.h"
+#include "clang/Basic/Specifiers.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Endian.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang::tidy::nullability {
+namespace {
+
+constexpr llvm::StringLiteral Magic = "NULLINF1";
+constexpr uint64_t HeaderSize = 8 + 4;
+constexpr uint64_t IndexEntrySize = 4 + 4;
+
+void append32(uint32_t V, std::string &Out) {
+  char Bytes[4];
+  llvm::support::endian::write32le(Bytes, V);
+  Out.append(Bytes, sizeof(Bytes));
+}
+
+}  // namespace
+
+void writeInferenceTable(llvm::ArrayRef<Inference> Inferences,
+                         llvm::raw_ostream &OS) {
+  std::vector<const Inference *> Sorted;
+  for (const Inference &I : Inferences) Sorted.push_back(&I);
+  std::stable_sort(Sorted.begin(), Sorted.end(),
+                   [](const Inference *L, const Inference *R) {
+                     return L->symbol().usr() < R->symbol().usr();
+                   });
+  Sorted.erase(std::unique(Sorted.begin(), Sorted.end(),
+                           [](const Inference *L, const Inference *R) {
+                             return L->symbol().usr() == R->symbol().usr();
+                           }),
+               Sorted.end());
+
+  std::vector<std::string> Records;
+  for (const Inference *I : Sorted) {
+    std::string Nullability;
+    for (const auto &SI : I->slot_inference()) {
+      if (SI.slot() >= Nullability.size())
+        Nullability.resize(SI.slot() + 1,
+                           static_cast<char>(Inference::UNKNOWN));
+      Nullability[SI.slot()] = static_cast<char>(
+          SI.conflict() ? Inference::UNKNOWN : SI.nullability());
+    }
+    std::string Record = I->symbol().usr();
+    append32(Nullability.size(), Record);
+    Record += Nullability;
+    Records.push_back(std::move(Record));
+  }
+
+  std::string Index = Magic.str();
+  append32(Sorted.size(), Index);
+  uint64_t Offset = HeaderSize + IndexEntrySize * Sorted.size();
+  for (unsigned I = 0; I < Sorted.size(); ++I) {
+    append32(Offset, Index);
+    append32(Sorted[I]->symbol().usr().size(), Index);
+    Offset += Records[I].size();
+  }
+  OS << Index;
+  for (const std::string &Record : Records) OS << Record;
+}
+
+llvm::Expected<InferenceTable> InferenceTable::open(llvm::StringRef Path) {
+  auto Buffer = llvm::MemoryBuffer::getFile(Path, /*IsText=*/false,
+                                            /*RequiresNullTerminator=*/false);
+  if (!Buffer) return llvm::createFileError(Path, Buffer.getError());
+  return fromBuffer(std::move(*Buffer));
+}
+
+llvm::Expected<InferenceTable> InferenceTable::fromBuffer(
+    std::unique_ptr<llvm::MemoryBuffer> Buffer) {
+  llvm::StringRef Data = Buffer->getBuffer();
+  if (Data.size() < HeaderSize || !Data.startswith(Magic))
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "not an inference table");
+  uint32_t NumSymbols =
+      llvm::support::endian::read32le(Data.data() + Magic.size());
+  if (HeaderSize + IndexEntrySize * NumSymbols > Data.size())
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "truncated inference table");
+  return InferenceTable(std::move(Buffer), NumSymbols);
+}
+
+std::optional<llvm::StringRef> InferenceTable::usr(uint32_t I,
+                                                   uint64_t &RecordEnd) const {
+  llvm::StringRef Data = Buffer->getBuffer();
+  const char *Entry = Data.data() + HeaderSize + IndexEntrySize * I;
+  uint64_t Offset = llvm::support::endian::read32le(Entry);
+  uint64_t Length = llvm::support::endian::read32le(Entry + 4);
+  if (Offset + Length > Data.size()) return std::nullopt;
+  RecordEnd = Offset + Length;
+  return Data.substr(Offset, Length);
+}
+
+std::optional<NullabilityKind> InferenceTable::lookup(llvm::StringRef USR,
+                                                      unsigned Slot) const {
+  // Binary search for the first symbol whose USR is not less than USR.
+  uint32_t Lo = 0, Hi = NumSymbols;
+  while (Lo < Hi) {
+    uint32_t Mid = Lo + (Hi - Lo) / 2;
+    uint64_t End;
+    auto MidUSR = usr(Mid, End);
+    if (!MidUSR) return std::nullopt;
+    if (*MidUSR < USR)
+      Lo = Mid + 1;
+    else
+      Hi = Mid;
+  }
+  if (Lo == NumSymbols) return std::nullopt;
+  uint64_t End;
+  auto FoundUSR = usr(Lo, End);
+  if (!FoundUSR || *FoundUSR != USR) return std::nullopt;
+
+  llvm::StringRef Data = Buffer->getBuffer();
+  if (End + 4 > Data.size()) return std::nullopt;
+  uint32_t NumSlots = llvm::support::endian::read32le(Data.data() + End);
+  if (Slot >= NumSlots || End + 4 + Slot >= Data.size()) return std::nullopt;
+  switch (static_cast<uint8_t>(Data[End + 4 + Slot])) {
+    case Inference::NONNULL:
+      return NullabilityKind::NonNull;
+    case Inference::NULLABLE:
+      return NullabilityKind::Nullable;
+    default:
+      return std::nullopt;
+  }
+}
+
+}  // namespace clang::tidy::nullability
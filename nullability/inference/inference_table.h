@@ -0,0 +1,76 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// A compact, sorted table of the Inferences for a whole codebase, for tools
+// that consume inferred nullability (e.g. rs_bindings_from_cc).
+//
+// The table is memory-mapped and searched in place: looking up a symbol
+// takes O(log n) time, without parsing the rest of the table.
+//
+// The file starts with a header:
+//   - 8 bytes: the magic "NULLINF1"
+//   - 4 bytes: the number of symbols N
+// followed by an index of N entries, sorted by USR:
+//   - 4 bytes: the offset of the symbol's record from the start of the file
+//   - 4 bytes: the length of the symbol's USR
+// and then the records. Each record is the symbol's USR, followed by
+//   - 4 bytes: the number of slots S
+//   - S bytes: the Inference::Nullability of each slot
+// Numbers are little-endian. Conflicting slots are stored as UNKNOWN.
+
+#ifndef CRUBIT_NULLABILITY_INFERENCE_INFERENCE_TABLE_H_
+#define CRUBIT_NULLABILITY_INFERENCE_INFERENCE_TABLE_H_
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+
+#include "nullability/inference/inference.proto.h"
+#include "clang/Basic/Specifiers.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang::tidy::nullability {
+
+// Writes a table holding Inferences to OS. If several Inferences have the same
+// USR, the first one is kept.
+void writeInferenceTable(llvm::ArrayRef<Inference> Inferences,
+                         llvm::raw_ostream &OS);
+
+class InferenceTable {
+ public:
+  // Maps the table in the file at Path.
+  static llvm::Expected<InferenceTable> open(llvm::StringRef Path);
+  static llvm::Expected<InferenceTable> fromBuffer(
+      std::unique_ptr<llvm::MemoryBuffer> Buffer);
+
+  // Returns the nullability inferred for Slot of the symbol with USR, or
+  // nullopt if there is no conclusion.
+  //
+  // A malformed table isn't detected when it's opened, so lookups in it may
+  // also return nullopt.
+  std::optional<NullabilityKind> lookup(llvm::StringRef USR,
+                                        unsigned Slot) const;
+
+  unsigned size() const { return NumSymbols; }
+
+ private:
+  InferenceTable(std::unique_ptr<llvm::MemoryBuffer> Buffer,
+                 uint32_t NumSymbols)
+      : Buffer(std::move(Buffer)), NumSymbols(NumSymbols) {}
+
+  // Returns the USR of the I'th symbol, and sets RecordEnd to the end of it.
+  // Returns nullopt if the index entry points outside the table.
+  std::optional<llvm::StringRef> usr(uint32_t I, uint64_t &RecordEnd) const;
+
+  std::unique_ptr<llvm::MemoryBuffer> Buffer;
+  uint32_t NumSymbols;
+};
+
+}  // namespace clang::tidy::nullability
+
+#endif  // CRUBIT_NULLABILITY_INFERENCE_INFERENCE_TABLE_H_
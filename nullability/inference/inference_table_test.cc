@@ -0,0 +1,95 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "nullability/inference/inference_table.h"
+
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "nullability/inference/inference.proto.h"
+#include "clang/Basic/Specifiers.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
+#include "third_party/llvm/llvm-project/third-party/unittest/googletest/include/gtest/gtest.h"
+#include "third_party/protobuf/text_format.h"
+
+namespace clang::tidy::nullability {
+namespace {
+
+Inference inference(llvm::StringRef Text) {
+  Inference Result;
+  CHECK(proto2::TextFormat::ParseFromString(Text, &Result));
+  return Result;
+}
+
+InferenceTable table(const std::vector<Inference> &Inferences) {
+  std::string Data;
+  llvm::raw_string_ostream OS(Data);
+  writeInferenceTable(Inferences, OS);
+  OS.flush();
+  auto Table =
+      InferenceTable::fromBuffer(llvm::MemoryBuffer::getMemBufferCopy(Data));
+  CHECK(Table) << toString(Table.takeError());
+  return std::move(*Table);
+}
+
+TEST(InferenceTableTest, Lookup) {
+  InferenceTable Table = table({
+      inference(R"pb(
+        symbol { usr: "c:@F@target#*I#" }
+        slot_inference { slot: 0 nullability: NONNULL }
+        slot_inference { slot: 2 nullability: NULLABLE }
+      )pb"),
+      inference(R"pb(
+        symbol { usr: "c:@F@other#" }
+        slot_inference { slot: 0 nullability: NULLABLE }
+      )pb"),
+  });
+  EXPECT_EQ(Table.size(), 2u);
+
+  EXPECT_EQ(Table.lookup("c:@F@target#*I#", 0), NullabilityKind::NonNull);
+  EXPECT_EQ(Table.lookup("c:@F@target#*I#", 1), std::nullopt);
+  EXPECT_EQ(Table.lookup("c:@F@target#*I#", 2), NullabilityKind::Nullable);
+  EXPECT_EQ(Table.lookup("c:@F@target#*I#", 3), std::nullopt);
+  EXPECT_EQ(Table.lookup("c:@F@other#", 0), NullabilityKind::Nullable);
+  EXPECT_EQ(Table.lookup("c:@F@missing#", 0), std::nullopt);
+}
+
+TEST(InferenceTableTest, ConflictsAreUnknown) {
+  InferenceTable Table = table({inference(R"pb(
+    symbol { usr: "c:@F@target#*I#" }
+    slot_inference { slot: 1 nullability: NONNULL conflict: true }
+  )pb")});
+  EXPECT_EQ(Table.lookup("c:@F@target#*I#", 1), std::nullopt);
+}
+
+TEST(InferenceTableTest, KeepsFirstOfDuplicates) {
+  InferenceTable Table = table({
+      inference(R"pb(
+        symbol { usr: "c:@F@target#" }
+        slot_inference { slot: 0 nullability: NONNULL }
+      )pb"),
+      inference(R"pb(
+        symbol { usr: "c:@F@target#" }
+        slot_inference { slot: 0 nullability: NULLABLE }
+      )pb"),
+  });
+  EXPECT_EQ(Table.size(), 1u);
+  EXPECT_EQ(Table.lookup("c:@F@target#", 0), NullabilityKind::NonNull);
+}
+
+TEST(InferenceTableTest, RejectsOtherFiles) {
+  auto Table = InferenceTable::fromBuffer(
+      llvm::MemoryBuffer::getMemBufferCopy("not a table"));
+  EXPECT_FALSE(Table);
+  llvm::consumeError(Table.takeError());
+}
+
+}  // namespace
+}  // namespace clang::tidy::nullability
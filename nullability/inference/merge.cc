@@ -5,35 +5,59 @@
 #include "nullability/inference/merge.h"
 
 #include <array>
+#include <cstdint>
 #include <optional>
+#include <string>
 #include <utility>
 
 #include "absl/log/check.h"
 #include "nullability/inference/inference.proto.h"
 #include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/xxhash.h"
 
 namespace clang::tidy::nullability {
 namespace {
 
+// Sample locations are chosen by smallest hash, which makes a deterministic
+// choice among all the locations seen regardless of the order of merging.
+// (Keeping the first ones seen would depend on how the reducers were sharded.)
+static std::pair<uint64_t, llvm::StringRef> sampleKey(llvm::StringRef Loc) {
+  return {llvm::xxHash64(Loc), Loc};
+}
+
 static void mergeSampleLocations(Partial::SampleLocations &LHS,
-                                 const Partial::SampleLocations &RHS) {
-  static constexpr unsigned Limit = 3;
-  // We don't care which we pick, but they should be unique.
-  // Multiple instantiations of the same template are not interesting.
-  for (const auto &Loc : RHS.location()) {
-    if (LHS.location_size() >= Limit) break;
-    // Linear scan is fine because Limit is tiny.
-    if (!llvm::is_contained(LHS.location(), Loc)) LHS.add_location(Loc);
+                                 const Partial::SampleLocations &RHS,
+                                 unsigned MaxSamples) {
+  // They should be unique: multiple instantiations of the same template are
+  // not interesting.
+  llvm::SmallVector<std::string> Locs(LHS.location().begin(),
+                                      LHS.location().end());
+  for (const auto &Loc : RHS.location())
+    // Linear scan is fine because MaxSamples is small.
+    if (!llvm::is_contained(Locs, Loc)) Locs.push_back(Loc);
+  if (Locs.size() > MaxSamples) {
+    llvm::sort(Locs, [&](llvm::StringRef L, llvm::StringRef R) {
+      return sampleKey(L) < sampleKey(R);
+    });
+    Locs.resize(MaxSamples);
   }
+  // Keep the selected samples in a canonical order.
+  llvm::sort(Locs);
+  LHS.clear_location();
+  for (auto &Loc : Locs) LHS.add_location(std::move(Loc));
 }
 
 static void mergeSlotPartials(Partial::SlotPartial &LHS,
-                              const Partial::SlotPartial &RHS) {
+                              const Partial::SlotPartial &RHS,
+                              unsigned MaxSamples) {
   for (auto [Kind, Count] : RHS.kind_count())
     (*LHS.mutable_kind_count())[Kind] += Count;
   for (const auto &[Kind, Samples] : RHS.kind_samples())
-    mergeSampleLocations((*LHS.mutable_kind_samples())[Kind], Samples);
+    mergeSampleLocations((*LHS.mutable_kind_samples())[Kind], Samples,
+                         MaxSamples);
 }
 
 }  // namespace
@@ -50,12 +74,12 @@ Partial partialFromEvidence(const Evidence &E) {
   return P;
 }
 
-void mergePartials(Partial &LHS, const Partial &RHS) {
+void mergePartials(Partial &LHS, const Partial &RHS, unsigned MaxSamples) {
   CHECK_EQ(LHS.symbol().usr(), RHS.symbol().usr());
   auto *Slots = LHS.mutable_slot();
   while (RHS.slot_size() > Slots->size()) Slots->Add();
   for (unsigned I = 0; I < RHS.slot_size(); ++I)
-    mergeSlotPartials(*LHS.mutable_slot(I), RHS.slot(I));
+    mergeSlotPartials(*LHS.mutable_slot(I), RHS.slot(I), MaxSamples);
 }
 
 // Form nullability conclusions from a set of evidence.
@@ -22,10 +22,17 @@ namespace clang::tidy::nullability {
 
 // Build a Partial representing a single piece of evidence.
 Partial partialFromEvidence(const Evidence &);
+// The default bound on the sample locations kept per slot and kind.
+constexpr unsigned DefaultMaxSamples = 3;
 // Update LHS to include the evidence from RHS.
 // The two must describe the same symbol.
 // The merging of partials is commutative and associative.
-void mergePartials(Partial &LHS, const Partial &RHS);
+//
+// At most MaxSamples locations are kept for each slot and kind, so Partials
+// stay bounded however much evidence they combine. The same ones are chosen
+// regardless of the order of merging (given the same MaxSamples).
+void mergePartials(Partial &LHS, const Partial &RHS,
+                   unsigned MaxSamples = DefaultMaxSamples);
 // Form nullability conclusions from a set of evidence.
 Inference finalize(const Partial &);
 
@@ -0,0 +1,157 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// merge_partials_main is the "reduce" phase of whole-codebase inference.
+//
+// It merges the sharded Partials written by collect_partials_main, and writes
+// the Inferences of shard N to "inference-N-of-M" under -output_dir, as a
+// stream of records (see partial_shards.h).
+//
+// Shards are independent: they are reduced in parallel on -j threads, and
+// -shards selects a subset of them, so that a large codebase can split the
+// work across many invocations (e.g. on different machines).
+//
+// -table_out also writes the Inferences of all reduced shards to a single
+// InferenceTable (see inference_table.h), for tools that look up the inferred
+// nullability of individual symbols.
+
+#include <mutex>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "nullability/inference/inference.proto.h"
+#include "nullability/inference/inference_table.h"
+#include "nullability/inference/merge.h"
+#include "nullability/inference/partial_shards.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/ThreadPool.h"
+#include "llvm/Support/Threading.h"
+#include "llvm/Support/raw_ostream.h"
+
+llvm::cl::opt<std::string> InputDir{
+    "input_dir",
+    llvm::cl::desc("Directory that collect_partials_main wrote Partials to"),
+    llvm::cl::Required,
+};
+llvm::cl::opt<std::string> OutputDir{
+    "output_dir",
+    llvm::cl::desc("Directory to write the Inferences to"),
+    llvm::cl::Required,
+};
+llvm::cl::opt<unsigned> NumShards{
+    "num_shards",
+    llvm::cl::desc("Number of shards, as passed to collect_partials_main"),
+    llvm::cl::init(64),
+};
+llvm::cl::list<unsigned> Shards{
+    "shards",
+    llvm::cl::desc("Shards to reduce (default: all)"),
+    llvm::cl::CommaSeparated,
+};
+llvm::cl::opt<unsigned> MaxSamples{
+    "max_samples",
+    llvm::cl::desc("Maximum sample locations kept per slot and kind"),
+    llvm::cl::init(clang::tidy::nullability::DefaultMaxSamples),
+};
+llvm::cl::opt<std::string> TableOut{
+    "table_out",
+    llvm::cl::desc("File to write an InferenceTable of all Inferences to"),
+};
+llvm::cl::opt<unsigned> Threads{
+    "j",
+    llvm::cl::desc("Number of threads (default: all cores)"),
+    llvm::cl::init(0),
+};
+
+namespace clang::tidy::nullability {
+namespace {
+
+// The Inferences of all reduced shards, for -table_out.
+std::mutex TableMu;
+std::vector<Inference> *TableInferences = nullptr;  // Guarded by TableMu.
+
+llvm::Error reduceShard(unsigned Shard) {
+  auto Files = findShardFiles(InputDir, Shard, NumShards);
+  if (!Files) return Files.takeError();
+  auto Inferences = mergeShardFiles(*Files, MaxSamples);
+  if (!Inferences) return Inferences.takeError();
+
+  llvm::SmallString<256> Path(OutputDir.getValue());
+  std::string Name;
+  llvm::raw_string_ostream(Name)
+      << llvm::format("inference-%05u-of-%05u", Shard, NumShards.getValue());
+  llvm::sys::path::append(Path, Name);
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(Path, EC);
+  if (EC) return llvm::createFileError(Path, EC);
+  for (const Inference &I : *Inferences) writeRecord(I, OS);
+  OS.close();
+  if (OS.has_error()) return llvm::createFileError(Path, OS.error());
+  if (!TableOut.empty()) {
+    std::lock_guard<std::mutex> Lock(TableMu);
+    for (Inference &I : *Inferences) TableInferences->push_back(std::move(I));
+  }
+  return llvm::Error::success();
+}
+
+llvm::Error writeTable(llvm::ArrayRef<Inference> Inferences) {
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(TableOut, EC);
+  if (EC) return llvm::createFileError(TableOut, EC);
+  writeInferenceTable(Inferences, OS);
+  OS.close();
+  if (OS.has_error()) return llvm::createFileError(TableOut, OS.error());
+  return llvm::Error::success();
+}
+
+}  // namespace
+}  // namespace clang::tidy::nullability
+
+int main(int argc, const char **argv) {
+  llvm::cl::ParseCommandLineOptions(argc, argv);
+  QCHECK(NumShards > 0) << "-num_shards must be positive";
+  std::vector<unsigned> ToReduce(Shards.begin(), Shards.end());
+  if (ToReduce.empty())
+    for (unsigned Shard = 0; Shard < NumShards; ++Shard)
+      ToReduce.push_back(Shard);
+  for (unsigned Shard : ToReduce)
+    QCHECK(Shard < NumShards) << "Shard " << Shard << " is out of range";
+  QCHECK(!llvm::sys::fs::create_directories(OutputDir.getValue()))
+      << "Failed to create " << OutputDir.getValue();
+
+  std::vector<clang::tidy::nullability::Inference> AllInferences;
+  clang::tidy::nullability::TableInferences = &AllInferences;
+
+  std::mutex Mu;
+  bool Failed = false;
+  llvm::ThreadPool Pool(llvm::hardware_concurrency(Threads));
+  for (unsigned Shard : ToReduce) {
+    Pool.async([&, Shard] {
+      if (auto Err = clang::tidy::nullability::reduceShard(Shard)) {
+        std::lock_guard<std::mutex> Lock(Mu);
+        llvm::errs() << "Failed to reduce shard " << Shard << ": "
+                     << toString(std::move(Err)) << "\n";
+        Failed = true;
+      }
+    });
+  }
+  Pool.wait();
+  if (!Failed && !TableOut.empty()) {
+    if (auto Err = clang::tidy::nullability::writeTable(AllInferences)) {
+      llvm::errs() << "Failed to write the table: "
+                   << toString(std::move(Err)) << "\n";
+      Failed = true;
+    }
+  }
+  return Failed ? 1 : 0;
+}
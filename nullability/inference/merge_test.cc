@@ -5,10 +5,13 @@
 #include "nullability/inference/merge.h"
 
 #include <array>
+#include <string>
+#include <vector>
 
 #include "absl/log/check.h"
 #include "nullability/inference/inference.proto.h"
 #include "nullability/proto_matchers.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/StringRef.h"
 #include "third_party/llvm/llvm-project/third-party/unittest/googlemock/include/gmock/gmock.h"
 #include "third_party/llvm/llvm-project/third-party/unittest/googletest/include/gtest/gtest.h"
@@ -72,7 +75,7 @@ TEST(MergeEvidenceTest, MergePartials) {
     slot { kind_count { key: 3 value: 1 } }
   )pb");
 
-  mergePartials(L, R);
+  mergePartials(L, R, /*MaxSamples=*/4);
   EXPECT_THAT(L, EqualsProto(R"pb(
                 symbol { usr: "func" }
                 slot {
@@ -81,7 +84,12 @@ TEST(MergeEvidenceTest, MergePartials) {
                   kind_count { key: 1 value: 1 }
                   kind_samples {
                     key: 0
-                    value { location: "a" location: "b" location: "c" }
+                    value {
+                      location: "a"
+                      location: "b"
+                      location: "c"
+                      location: "d"
+                    }
                   }
                 }
                 slot { kind_count { key: 0 value: 1 } }
@@ -89,6 +97,37 @@ TEST(MergeEvidenceTest, MergePartials) {
               )pb"));
 }
 
+TEST(MergeEvidenceTest, MergePartialsBoundsSamples) {
+  std::vector<Partial> Partials;
+  for (int I = 0; I < 20; ++I) {
+    Evidence E;
+    E.mutable_symbol()->set_usr("func");
+    E.set_slot(0);
+    E.set_kind(Evidence::UNCHECKED_DEREFERENCE);
+    E.set_location("foo.cc:" + std::to_string(I));
+    Partials.push_back(partialFromEvidence(E));
+  }
+
+  // Merge the same partials one by one, and in a different grouping/order.
+  Partial Forward = Partials.front();
+  for (const auto &P : llvm::ArrayRef(Partials).drop_front())
+    mergePartials(Forward, P);
+  Partial Odd = Partials[1], Even = Partials[0];
+  for (unsigned I = 2; I < Partials.size(); ++I)
+    mergePartials(I % 2 ? Odd : Even, Partials[Partials.size() + 1 - I]);
+  mergePartials(Odd, Even);
+
+  EXPECT_EQ(Forward.slot(0).kind_count().at(Evidence::UNCHECKED_DEREFERENCE),
+            20u);
+  EXPECT_EQ(Forward.slot(0)
+                .kind_samples()
+                .at(Evidence::UNCHECKED_DEREFERENCE)
+                .location_size(),
+            static_cast<int>(DefaultMaxSamples));
+  // The same samples are chosen either way.
+  EXPECT_THAT(Odd, EqualsProto(Forward.DebugString()));
+}
+
 TEST(MergeEvidenceTest, Finalize) {
   EXPECT_THAT(finalize(proto<Partial>(R"pb(
                 symbol { usr: "func" }
@@ -0,0 +1,190 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "nullability/inference/partial_shards.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "nullability/inference/inference.proto.h"
+#include "nullability/inference/merge.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringMap.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/Format.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
+
+namespace clang::tidy::nullability {
+namespace {
+
+// The suffix shared by the files of one shard, e.g. ".partials-00003-of-00016".
+std::string shardSuffix(unsigned Shard, unsigned NumShards) {
+  std::string Suffix;
+  llvm::raw_string_ostream(Suffix)
+      << llvm::format(".partials-%05u-of-%05u", Shard, NumShards);
+  return Suffix;
+}
+
+llvm::Error writeFile(llvm::StringRef Path, llvm::StringRef Contents) {
+  std::string TempPath = (Path + ".tmp").str();
+  {
+    std::error_code EC;
+    llvm::raw_fd_ostream OS(TempPath, EC);
+    if (EC) return llvm::createFileError(TempPath, EC);
+    OS << Contents;
+    OS.close();
+    if (OS.has_error()) return llvm::createFileError(TempPath, OS.error());
+  }
+  if (auto EC = llvm::sys::fs::rename(TempPath, Path))
+    return llvm::createFileError(Path, EC);
+  return llvm::Error::success();
+}
+
+}  // namespace
+
+llvm::Expected<std::unique_ptr<RecordReader>> RecordReader::open(
+    llvm::StringRef Path) {
+  auto FD = llvm::sys::fs::openNativeFileForRead(Path);
+  if (!FD) return llvm::createFileError(Path, FD.takeError());
+  return std::unique_ptr<RecordReader>(new RecordReader(*FD));
+}
+
+RecordReader::~RecordReader() { llvm::sys::fs::closeFile(FD); }
+
+// Larger sizes are assumed to be corrupt data, rather than trying to allocate.
+static constexpr uint64_t MaxRecordSize = uint64_t{1} << 30;
+
+llvm::Error RecordReader::fill(size_t N) {
+  static constexpr size_t ChunkSize = 64 * 1024;
+  if (Buffer.size() - Pos >= N || AtEnd) return llvm::Error::success();
+  // Drop the bytes that were already read.
+  Buffer.erase(Buffer.begin(), Buffer.begin() + Pos);
+  Pos = 0;
+  while (Buffer.size() < N && !AtEnd) {
+    size_t Old = Buffer.size();
+    Buffer.resize(Old + std::max(ChunkSize, N - Old));
+    auto Read = llvm::sys::fs::readNativeFile(
+        FD, llvm::MutableArrayRef<char>(Buffer).drop_front(Old));
+    if (!Read) {
+      Buffer.resize(Old);
+      return Read.takeError();
+    }
+    Buffer.resize(Old + *Read);
+    if (*Read == 0) AtEnd = true;
+  }
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::optional<llvm::StringRef>> RecordReader::nextBytes() {
+  // A ULEB128-encoded uint64_t takes at most 10 bytes.
+  if (auto Err = fill(10)) return std::move(Err);
+  if (Pos == Buffer.size()) return std::nullopt;
+
+  const auto *Begin = reinterpret_cast<const uint8_t *>(Buffer.data()) + Pos;
+  const auto *End = reinterpret_cast<const uint8_t *>(Buffer.data()) +
+                    Buffer.size();
+  unsigned SizeLength;
+  const char *Error = nullptr;
+  uint64_t Size = llvm::decodeULEB128(Begin, &SizeLength, End, &Error);
+  if (Error)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(), Error);
+  if (Size > MaxRecordSize)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "record too large");
+  if (auto Err = fill(SizeLength + Size)) return std::move(Err);
+  if (Buffer.size() - Pos < SizeLength + Size)
+    return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                   "truncated record");
+  llvm::StringRef Bytes(Buffer.data() + Pos + SizeLength, Size);
+  Pos += SizeLength + Size;
+  return Bytes;
+}
+
+unsigned shardForUSR(llvm::StringRef USR, unsigned NumShards) {
+  // Unlike std::hash, xxHash64 is the same in every process.
+  return llvm::xxHash64(USR) % NumShards;
+}
+
+std::string shardFileName(llvm::StringRef Stem, unsigned Shard,
+                          unsigned NumShards) {
+  return Stem.str() + shardSuffix(Shard, NumShards);
+}
+
+llvm::Error writeShardedPartials(llvm::ArrayRef<Partial> Partials,
+                                 llvm::StringRef Dir, llvm::StringRef Stem,
+                                 unsigned NumShards) {
+  std::vector<std::string> Shards(NumShards);
+  for (const Partial &P : Partials) {
+    llvm::raw_string_ostream OS(
+        Shards[shardForUSR(P.symbol().usr(), NumShards)]);
+    writeRecord(P, OS);
+  }
+  for (unsigned Shard = 0; Shard < NumShards; ++Shard) {
+    if (Shards[Shard].empty()) continue;
+    llvm::SmallString<256> Path(Dir);
+    llvm::sys::path::append(Path, shardFileName(Stem, Shard, NumShards));
+    if (auto Err = writeFile(Path, Shards[Shard])) return Err;
+  }
+  return llvm::Error::success();
+}
+
+llvm::Expected<std::vector<std::string>> findShardFiles(llvm::StringRef Dir,
+                                                        unsigned Shard,
+                                                        unsigned NumShards) {
+  std::string Suffix = shardSuffix(Shard, NumShards);
+  std::vector<std::string> Files;
+  std::error_code EC;
+  for (llvm::sys::fs::directory_iterator It(Dir, EC), End; It != End && !EC;
+       It.increment(EC)) {
+    if (llvm::StringRef(It->path()).endswith(Suffix))
+      Files.push_back(It->path());
+  }
+  if (EC) return llvm::createFileError(Dir, EC);
+  llvm::sort(Files);
+  return Files;
+}
+
+llvm::Expected<std::vector<Inference>> mergeShardFiles(
+    llvm::ArrayRef<std::string> Files, unsigned MaxSamples) {
+  llvm::StringMap<Partial> PartialsByUSR;
+  for (const std::string &File : Files) {
+    auto Reader = RecordReader::open(File);
+    if (!Reader) return Reader.takeError();
+    Partial P;
+    while (true) {
+      auto HasNext = (*Reader)->next(P);
+      if (!HasNext) return llvm::createFileError(File, HasNext.takeError());
+      if (!*HasNext) break;
+      auto [It, Inserted] = PartialsByUSR.try_emplace(P.symbol().usr());
+      if (Inserted)
+        It->second = std::move(P);
+      else
+        mergePartials(It->second, P, MaxSamples);
+    }
+  }
+
+  std::vector<Inference> Result;
+  Result.reserve(PartialsByUSR.size());
+  for (const auto &Entry : PartialsByUSR)
+    Result.push_back(finalize(Entry.second));
+  llvm::sort(Result, [&](const Inference &L, const Inference &R) {
+    return L.symbol().usr() < R.symbol().usr();
+  });
+  return Result;
+}
+
+}  // namespace clang::tidy::nullability
@@ -0,0 +1,138 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Storage of Partials between the "map" and "reduce" phases of inference.
+//
+// Each mapper (one per translation unit) writes its Partials to a few files,
+// partitioned by a hash of the symbol's USR. All Partials for a symbol end up
+// in the same shard, so each shard can then be reduced independently (and in
+// parallel, possibly on different machines) by merging its files.
+//
+// Files are a stream of records: the ULEB128-encoded size of a serialized
+// proto, followed by its bytes. Like Partial itself, this is not stable.
+
+#ifndef CRUBIT_NULLABILITY_INFERENCE_PARTIAL_SHARDS_H_
+#define CRUBIT_NULLABILITY_INFERENCE_PARTIAL_SHARDS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "nullability/inference/inference.proto.h"
+#include "nullability/inference/merge.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/STLFunctionalExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/LEB128.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace clang::tidy::nullability {
+
+// Appends a record holding Message to OS.
+template <typename Proto>
+void writeRecord(const Proto &Message, llvm::raw_ostream &OS) {
+  std::string Bytes = Message.SerializeAsString();
+  llvm::encodeULEB128(Bytes.size(), OS);
+  OS << Bytes;
+}
+
+// Parses the records in Data, passing each to Callback in order.
+template <typename Proto>
+llvm::Error readRecords(llvm::StringRef Data,
+                        llvm::function_ref<void(Proto)> Callback) {
+  const auto *P = reinterpret_cast<const uint8_t *>(Data.begin());
+  const auto *End = reinterpret_cast<const uint8_t *>(Data.end());
+  while (P != End) {
+    unsigned SizeLength;
+    const char *Error = nullptr;
+    uint64_t Size = llvm::decodeULEB128(P, &SizeLength, End, &Error);
+    if (Error)
+      return llvm::createStringError(llvm::inconvertibleErrorCode(), Error);
+    P += SizeLength;
+    if (Size > static_cast<uint64_t>(End - P))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "truncated record");
+    Proto Message;
+    if (!Message.ParseFromArray(P, Size))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "malformed record");
+    P += Size;
+    Callback(std::move(Message));
+  }
+  return llvm::Error::success();
+}
+
+// Reads the records of a file one at a time, without loading the whole file.
+class RecordReader {
+ public:
+  static llvm::Expected<std::unique_ptr<RecordReader>> open(
+      llvm::StringRef Path);
+  ~RecordReader();
+  RecordReader(const RecordReader &) = delete;
+  RecordReader &operator=(const RecordReader &) = delete;
+
+  // Reads the next record into Message. Returns false at the end of the file.
+  template <typename Proto>
+  llvm::Expected<bool> next(Proto &Message) {
+    auto Bytes = nextBytes();
+    if (!Bytes) return Bytes.takeError();
+    if (!*Bytes) return false;
+    if (!Message.ParseFromArray((*Bytes)->data(), (*Bytes)->size()))
+      return llvm::createStringError(llvm::inconvertibleErrorCode(),
+                                     "malformed record");
+    return true;
+  }
+
+ private:
+  explicit RecordReader(llvm::sys::fs::file_t FD) : FD(FD) {}
+
+  // Returns the bytes of the next record, which remain valid until the next
+  // call, or std::nullopt at the end of the file.
+  llvm::Expected<std::optional<llvm::StringRef>> nextBytes();
+  // Reads more of the file, until at least N bytes are buffered or the file
+  // ends.
+  llvm::Error fill(size_t N);
+
+  llvm::sys::fs::file_t FD;
+  // Bytes read from the file; the unread ones are Buffer[Pos:].
+  std::vector<char> Buffer;
+  size_t Pos = 0;
+  bool AtEnd = false;
+};
+
+// Returns the shard, in [0, NumShards), that holds the Partials for a symbol.
+// This is stable across processes and machines.
+unsigned shardForUSR(llvm::StringRef USR, unsigned NumShards);
+
+// The name of the file for one shard of a mapper's output.
+// Stem identifies the mapper, e.g. a hash of the translation unit's path.
+std::string shardFileName(llvm::StringRef Stem, unsigned Shard,
+                          unsigned NumShards);
+
+// Writes the Partials into the shard files for Stem under Dir.
+// Files are only created for shards that hold some Partials. Each is written
+// to a temporary file first, so reducers never see a partially written shard.
+llvm::Error writeShardedPartials(llvm::ArrayRef<Partial>, llvm::StringRef Dir,
+                                 llvm::StringRef Stem, unsigned NumShards);
+
+// Lists the files of one shard under Dir, written by any mapper (sorted).
+llvm::Expected<std::vector<std::string>> findShardFiles(llvm::StringRef Dir,
+                                                        unsigned Shard,
+                                                        unsigned NumShards);
+
+// Merges the Partials in Files, and finalizes an Inference for each symbol.
+// The result is ordered by USR. MaxSamples is as for mergePartials.
+// The files are streamed: only the merged Partials are held in memory.
+llvm::Expected<std::vector<Inference>> mergeShardFiles(
+    llvm::ArrayRef<std::string> Files,
+    unsigned MaxSamples = DefaultMaxSamples);
+
+}  // namespace clang::tidy::nullability
+
+#endif
@@ -0,0 +1,183 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "nullability/inference/partial_shards.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "nullability/inference/inference.proto.h"
+#include "nullability/inference/merge.h"
+#include "nullability/proto_matchers.h"
+#include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+#include "third_party/llvm/llvm-project/third-party/unittest/googlemock/include/gmock/gmock.h"
+#include "third_party/llvm/llvm-project/third-party/unittest/googletest/include/gtest/gtest.h"
+#include "third_party/protobuf/text_format.h"
+
+namespace clang::tidy::nullability {
+namespace {
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+using ::testing::SizeIs;
+
+template <typename T>
+T proto(llvm::StringRef Text) {
+  T Result;
+  CHECK(proto2::TextFormat::ParseFromString(Text, &Result));
+  return Result;
+}
+
+Evidence evidence(llvm::StringRef USR, Evidence::Kind Kind) {
+  Evidence E;
+  E.mutable_symbol()->set_usr(USR.str());
+  E.set_slot(1);
+  E.set_kind(Kind);
+  E.set_location("input.cc:1:1");
+  return E;
+}
+
+TEST(PartialShardsTest, RecordsRoundTrip) {
+  std::vector<Partial> Written = {
+      partialFromEvidence(evidence("a", Evidence::UNCHECKED_DEREFERENCE)),
+      Partial(),
+      partialFromEvidence(evidence("b", Evidence::ANNOTATED_NULLABLE)),
+  };
+  std::string Data;
+  llvm::raw_string_ostream OS(Data);
+  for (const Partial &P : Written) writeRecord(P, OS);
+  OS.flush();
+
+  std::vector<Partial> Read;
+  ASSERT_FALSE(llvm::errorToBool(readRecords<Partial>(
+      Data, [&](Partial P) { Read.push_back(std::move(P)); })));
+  ASSERT_THAT(Read, SizeIs(3));
+  for (unsigned I = 0; I < Read.size(); ++I)
+    EXPECT_THAT(Read[I], EqualsProto(Written[I].DebugString()));
+}
+
+TEST(PartialShardsTest, TruncatedRecord) {
+  std::string Data;
+  llvm::raw_string_ostream OS(Data);
+  writeRecord(partialFromEvidence(evidence("a", Evidence::ANNOTATED_NONNULL)),
+              OS);
+  OS.flush();
+  Data.pop_back();
+
+  EXPECT_TRUE(llvm::errorToBool(readRecords<Partial>(Data, [](Partial) {})));
+}
+
+TEST(PartialShardsTest, RecordReader) {
+  llvm::SmallString<256> Path;
+  int FD;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("partial_shards_test", "", FD, Path));
+  // Enough records that the reader needs several reads to see them all.
+  constexpr int NumRecords = 10000;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    for (int I = 0; I < NumRecords; ++I)
+      writeRecord(partialFromEvidence(evidence("sym" + std::to_string(I),
+                                               Evidence::ANNOTATED_NONNULL)),
+                  OS);
+  }
+
+  auto Reader = RecordReader::open(Path);
+  ASSERT_TRUE(bool(Reader)) << toString(Reader.takeError());
+  Partial P;
+  for (int I = 0; I < NumRecords; ++I) {
+    auto HasNext = (*Reader)->next(P);
+    ASSERT_TRUE(bool(HasNext)) << toString(HasNext.takeError());
+    ASSERT_TRUE(*HasNext);
+    EXPECT_EQ(P.symbol().usr(), "sym" + std::to_string(I));
+  }
+  auto HasNext = (*Reader)->next(P);
+  ASSERT_TRUE(bool(HasNext)) << toString(HasNext.takeError());
+  EXPECT_FALSE(*HasNext);
+
+  ASSERT_FALSE(llvm::sys::fs::remove(Path));
+}
+
+TEST(PartialShardsTest, RecordReaderTruncated) {
+  llvm::SmallString<256> Path;
+  int FD;
+  ASSERT_FALSE(
+      llvm::sys::fs::createTemporaryFile("partial_shards_test", "", FD, Path));
+  {
+    std::string Data;
+    llvm::raw_string_ostream DataOS(Data);
+    writeRecord(partialFromEvidence(evidence("a", Evidence::ANNOTATED_NONNULL)),
+                DataOS);
+    DataOS.flush();
+    Data.pop_back();
+    llvm::raw_fd_ostream(FD, /*shouldClose=*/true) << Data;
+  }
+
+  auto Reader = RecordReader::open(Path);
+  ASSERT_TRUE(bool(Reader)) << toString(Reader.takeError());
+  Partial P;
+  EXPECT_TRUE(llvm::errorToBool((*Reader)->next(P).takeError()));
+
+  ASSERT_FALSE(llvm::sys::fs::remove(Path));
+}
+
+TEST(PartialShardsTest, ShardForUSR) {
+  for (llvm::StringRef USR : {"", "c:@F@foo#", "c:@F@bar#*I#"}) {
+    EXPECT_LT(shardForUSR(USR, 7), 7u);
+    EXPECT_EQ(shardForUSR(USR, 7), shardForUSR(USR, 7));
+    EXPECT_EQ(shardForUSR(USR, 1), 0u);
+  }
+}
+
+TEST(PartialShardsTest, MergeShardFiles) {
+  llvm::SmallString<256> Dir;
+  ASSERT_FALSE(
+      llvm::sys::fs::createUniqueDirectory("partial_shards_test", Dir));
+  constexpr unsigned NumShards = 3;
+
+  // Two "translation units" see evidence about the same symbols.
+  auto TU1 = {
+      partialFromEvidence(evidence("a", Evidence::UNCHECKED_DEREFERENCE)),
+      partialFromEvidence(evidence("b", Evidence::ANNOTATED_NULLABLE)),
+  };
+  auto TU2 = {
+      partialFromEvidence(evidence("a", Evidence::ANNOTATED_NULLABLE)),
+  };
+  ASSERT_FALSE(llvm::errorToBool(
+      writeShardedPartials(TU1, Dir, "tu1", NumShards)));
+  ASSERT_FALSE(llvm::errorToBool(
+      writeShardedPartials(TU2, Dir, "tu2", NumShards)));
+
+  std::vector<Inference> All;
+  for (unsigned Shard = 0; Shard < NumShards; ++Shard) {
+    auto Files = findShardFiles(Dir, Shard, NumShards);
+    ASSERT_TRUE(bool(Files)) << toString(Files.takeError());
+    auto Inferences = mergeShardFiles(*Files);
+    ASSERT_TRUE(bool(Inferences)) << toString(Inferences.takeError());
+    if (shardForUSR("a", NumShards) != Shard &&
+        shardForUSR("b", NumShards) != Shard)
+      EXPECT_THAT(*Files, IsEmpty());
+    All.insert(All.end(), Inferences->begin(), Inferences->end());
+  }
+  llvm::sort(All, [](const Inference &L, const Inference &R) {
+    return L.symbol().usr() < R.symbol().usr();
+  });
+
+  // The result is the same as merging all evidence at once.
+  Inference A = mergeEvidence({evidence("a", Evidence::UNCHECKED_DEREFERENCE),
+                               evidence("a", Evidence::ANNOTATED_NULLABLE)});
+  Inference B = mergeEvidence({evidence("b", Evidence::ANNOTATED_NULLABLE)});
+  EXPECT_THAT(All, ElementsAre(EqualsProto(A.DebugString()),
+                               EqualsProto(B.DebugString())));
+
+  ASSERT_FALSE(llvm::sys::fs::remove_directories(Dir));
+}
+
+}  // namespace
+}  // namespace clang::tidy::nullability
@@ -0,0 +1,375 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// nullability_check_main checks the null-safety of every function defined in
+// the main files of some translation units.
+//
+// By default (-diagnostics=1) it shows findings as warnings, like the
+// clang-tidy check would. It can also (-sarif_out=FILE) write all findings to
+// FILE as a SARIF log, sorted and deduplicated, for presubmit tooling.
+//
+// -check_headers also checks the functions defined in headers, such as inline
+// functions. Such a function is the same in every translation unit that
+// includes its header, and -cache_dir=DIR makes sure that it's only analyzed
+// once: its findings are stored in DIR, and reused as long as neither the
+// function, nor the declarations it uses, nor the checker change.
+//
+// -print_timing prints how long checking each translation unit took, which,
+// run over large translation units, serves as a benchmark of the analysis.
+//
+// `--executor=all-TUs` together with `--execute-concurrency=N` checks N
+// translation units at a time. (Functions within a translation unit are
+// analyzed one at a time: the dataflow analysis creates types in the shared
+// ASTContext, and ASTContext is not thread-safe.)
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "nullability/pointer_nullability_diagnosis.h"
+#include "clang/AST/ASTConsumer.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/RecursiveASTVisitor.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Basic/Diagnostic.h"
+#include "clang/Basic/FileManager.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Basic/Version.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendAction.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Index/USRGeneration.h"
+#include "clang/Tooling/Execution.h"
+#include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/ArrayRef.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/CommandLine.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/xxhash.h"
+#include "llvm/Support/raw_ostream.h"
+
+llvm::cl::OptionCategory Opts("nullability_check_main options");
+llvm::cl::opt<bool> Diagnostics{
+    "diagnostics",
+    llvm::cl::desc("Print null-safety violations as warnings"),
+    llvm::cl::init(true),
+};
+llvm::cl::opt<std::string> SarifOut{
+    "sarif_out",
+    llvm::cl::desc("Write null-safety violations to this file as SARIF"),
+};
+llvm::cl::opt<bool> CheckHeaders{
+    "check_headers",
+    llvm::cl::desc("Also check functions defined outside the main file"),
+    llvm::cl::init(false),
+};
+llvm::cl::opt<std::string> CacheDir{
+    "cache_dir",
+    llvm::cl::desc("Directory where the findings for functions defined outside "
+                   "the main file are cached across translation units"),
+};
+llvm::cl::opt<bool> PrintTiming{
+    "print_timing",
+    llvm::cl::desc("Print the time spent checking each translation unit"),
+    llvm::cl::init(false),
+};
+
+namespace clang::tidy::nullability {
+namespace {
+
+constexpr llvm::StringLiteral RuleID = "nullability";
+constexpr llvm::StringLiteral Message = "violates null-safety";
+
+// Where each translation unit reports its findings for -sarif_out.
+// Keys are "file:line:col", values are serialized SARIF result objects.
+tooling::ExecutionContext *Results = nullptr;
+
+llvm::json::Value sarifResult(llvm::StringRef File, unsigned Line,
+                              unsigned Col) {
+  return llvm::json::Object{
+      {"ruleId", RuleID},
+      {"level", "warning"},
+      {"message", llvm::json::Object{{"text", Message}}},
+      {"locations",
+       llvm::json::Array{llvm::json::Object{
+           {"physicalLocation",
+            llvm::json::Object{
+                {"artifactLocation", llvm::json::Object{{"uri", File}}},
+                {"region", llvm::json::Object{{"startLine", Line},
+                                              {"startColumn", Col}}},
+            }},
+       }}},
+  };
+}
+
+// Caches the findings for functions defined in headers in -cache_dir.
+//
+// Each entry holds the findings for one function, one per line, as
+// "file\tline\tcolumn". Entries are written atomically, so translation units
+// that are checked concurrently may share the cache.
+namespace cache {
+
+// Bump whenever the findings of the checker may change.
+constexpr llvm::StringLiteral Version = "1";
+
+// Returns the name of FD's entry, which hashes whatever its findings depend on:
+// the checker's version, FD's location, signature and body, and the types of
+// the declarations that FD uses (and so their nullability annotations).
+std::optional<std::string> key(const FunctionDecl &FD) {
+  class UsedDecls : public RecursiveASTVisitor<UsedDecls> {
+    llvm::raw_ostream &OS;
+
+    void add(const ValueDecl *D) {
+      if (D)
+        OS << D->getQualifiedNameAsString() << ':' << D->getType().getAsString()
+           << ';';
+    }
+
+   public:
+    explicit UsedDecls(llvm::raw_ostream &OS) : OS(OS) {}
+
+    bool VisitDeclRefExpr(const DeclRefExpr *E) {
+      add(E->getDecl());
+      return true;
+    }
+    bool VisitMemberExpr(const MemberExpr *E) {
+      add(E->getMemberDecl());
+      return true;
+    }
+    bool VisitCXXConstructExpr(const CXXConstructExpr *E) {
+      add(E->getConstructor());
+      return true;
+    }
+  };
+
+  llvm::SmallString<128> USR;
+  if (index::generateUSRForDecl(&FD, USR)) return std::nullopt;
+  PresumedLoc PLoc = FD.getASTContext().getSourceManager().getPresumedLoc(
+      FD.getLocation(), /*UseLineDirectives=*/false);
+  if (PLoc.isInvalid()) return std::nullopt;
+
+  std::string Hashed;
+  llvm::raw_string_ostream OS(Hashed);
+  OS << Version << ';' << getClangFullVersion() << ';' << USR << ';'
+     << PLoc.getFilename() << ':' << PLoc.getLine() << ';'
+     << FD.getType().getAsString() << ';'
+     << const_cast<FunctionDecl &>(FD).getODRHash() << ';';
+  UsedDecls(OS).TraverseStmt(FD.getBody());
+  return llvm::utohexstr(llvm::xxHash64(OS.str()));
+}
+
+std::string path(llvm::StringRef Key) {
+  llvm::SmallString<256> Path(CacheDir.getValue());
+  llvm::sys::path::append(Path, Key);
+  return std::string(Path);
+}
+
+// Returns the cached findings for Key, if any.
+std::optional<std::vector<SourceLocation>> read(llvm::StringRef Key,
+                                                SourceManager &SM) {
+  auto Buffer = llvm::MemoryBuffer::getFile(path(Key));
+  if (!Buffer) return std::nullopt;
+  std::vector<SourceLocation> Findings;
+  llvm::SmallVector<llvm::StringRef> Lines;
+  (*Buffer)->getBuffer().split(Lines, '\n', /*MaxSplit=*/-1,
+                               /*KeepEmpty=*/false);
+  for (llvm::StringRef Line : Lines) {
+    auto [File, LineCol] = Line.split('\t');
+    auto [LineNo, ColNo] = LineCol.split('\t');
+    unsigned L, C;
+    auto FE = SM.getFileManager().getOptionalFileRef(File);
+    // A corrupt or stale entry: analyze the function again.
+    if (!FE || LineNo.getAsInteger(10, L) || ColNo.getAsInteger(10, C))
+      return std::nullopt;
+    Findings.push_back(SM.translateFileLineCol(&FE->getFileEntry(), L, C));
+  }
+  return Findings;
+}
+
+void write(llvm::StringRef Key, llvm::ArrayRef<SourceLocation> Findings,
+           const SourceManager &SM) {
+  std::string Path = path(Key);
+  int FD;
+  llvm::SmallString<256> TempPath;
+  if (llvm::sys::fs::createUniqueFile(Path + "-%%%%%%.tmp", FD, TempPath))
+    return;
+  {
+    llvm::raw_fd_ostream OS(FD, /*shouldClose=*/true);
+    for (SourceLocation Loc : Findings) {
+      PresumedLoc PLoc = SM.getPresumedLoc(Loc, /*UseLineDirectives=*/false);
+      if (PLoc.isInvalid()) continue;
+      OS << PLoc.getFilename() << '\t' << PLoc.getLine() << '\t'
+         << PLoc.getColumn() << '\n';
+    }
+  }
+  if (llvm::sys::fs::rename(TempPath, Path))
+    llvm::sys::fs::remove(TempPath);
+}
+
+}  // namespace cache
+
+class FunctionChecker : public RecursiveASTVisitor<FunctionChecker> {
+  ASTContext &Ctx;
+  DiagnosticsEngine &Diags;
+  unsigned DiagViolation;
+  unsigned Checked = 0;
+
+  void report(SourceLocation Loc) {
+    if (Diagnostics) Diags.Report(Loc, DiagViolation);
+    if (Results) {
+      PresumedLoc PLoc = Ctx.getSourceManager().getPresumedLoc(Loc);
+      if (PLoc.isInvalid()) return;
+      auto Key = llvm::formatv("{0}:{1}:{2}", PLoc.getFilename(),
+                               PLoc.getLine(), PLoc.getColumn())
+                     .str();
+      Results->reportResult(
+          Key, llvm::formatv("{0}", sarifResult(PLoc.getFilename(),
+                                                PLoc.getLine(),
+                                                PLoc.getColumn()))
+                   .str());
+    }
+  }
+
+  // Returns the locations of FD's null-safety violations, or nullopt if FD
+  // couldn't be analyzed.
+  std::optional<std::vector<SourceLocation>> check(const FunctionDecl &FD) {
+    ++Checked;
+    auto Violations = diagnosePointerNullability(FD);
+    if (!Violations) {
+      llvm::errs() << "Skipping function " << FD.getQualifiedNameAsString()
+                   << ": " << toString(Violations.takeError()) << "\n";
+      return std::nullopt;
+    }
+    std::vector<SourceLocation> Findings;
+    for (const CFGElement &Element : *Violations)
+      if (SourceLocation Loc = getDiagnosticLocation(Element); Loc.isValid())
+        Findings.push_back(Loc);
+    return Findings;
+  }
+
+ public:
+  explicit FunctionChecker(ASTContext &Ctx)
+      : Ctx(Ctx), Diags(Ctx.getDiagnostics()) {
+    DiagViolation = Diags.getCustomDiagID(
+        DiagnosticsEngine::Warning, (Message + " [" + RuleID + "]").str());
+  }
+
+  bool VisitFunctionDecl(const FunctionDecl *FD) {
+    if (!FD->doesThisDeclarationHaveABody() || FD->isDependentContext() ||
+        FD->isImplicit())
+      return true;
+    bool InMainFile = Ctx.getSourceManager().isInMainFile(FD->getLocation());
+    if (!InMainFile && !CheckHeaders) return true;
+
+    std::optional<std::string> Key;
+    if (!InMainFile && !CacheDir.empty()) Key = cache::key(*FD);
+    std::optional<std::vector<SourceLocation>> Findings;
+    if (Key) Findings = cache::read(*Key, Ctx.getSourceManager());
+    if (!Findings) {
+      Findings = check(*FD);
+      if (!Findings) return true;
+      if (Key) cache::write(*Key, *Findings, Ctx.getSourceManager());
+    }
+    for (SourceLocation Loc : *Findings)
+      if (Loc.isValid()) report(Loc);
+    return true;
+  }
+
+  unsigned checked() const { return Checked; }
+};
+
+class Action : public SyntaxOnlyAction {
+  std::unique_ptr<ASTConsumer> CreateASTConsumer(CompilerInstance &,
+                                                 llvm::StringRef) override {
+    class Consumer : public ASTConsumer {
+      void HandleTranslationUnit(ASTContext &Ctx) override {
+        auto Start = std::chrono::steady_clock::now();
+        FunctionChecker Checker(Ctx);
+        Checker.TraverseAST(Ctx);
+        if (PrintTiming) {
+          std::chrono::duration<double, std::milli> Elapsed =
+              std::chrono::steady_clock::now() - Start;
+          const SourceManager &SM = Ctx.getSourceManager();
+          const FileEntry *Main = SM.getFileEntryForID(SM.getMainFileID());
+          llvm::errs() << llvm::formatv(
+              "{0}: analyzed {1} functions in {2:f1} ms\n",
+              Main ? Main->getName() : "<unknown>", Checker.checked(),
+              Elapsed.count());
+        }
+      }
+    };
+    return std::make_unique<Consumer>();
+  }
+};
+
+void writeSarif(tooling::ToolResults &ToolResults) {
+  // Headers are checked once per including TU: keep one result per location.
+  std::map<std::string, llvm::json::Value> Sorted;
+  ToolResults.forEachResult([&](llvm::StringRef Key, llvm::StringRef Value) {
+    if (Sorted.count(Key.str())) return;
+    auto Parsed = llvm::json::parse(Value);
+    QCHECK(Parsed) << toString(Parsed.takeError());
+    Sorted.emplace(Key.str(), std::move(*Parsed));
+  });
+  llvm::json::Array SarifResults;
+  for (auto &[Key, Result] : Sorted) SarifResults.push_back(std::move(Result));
+
+  std::error_code EC;
+  llvm::raw_fd_ostream OS(SarifOut, EC);
+  QCHECK(!EC) << "Failed to open " << SarifOut.getValue() << ": "
+              << EC.message();
+  OS << llvm::formatv(
+      "{0:2}\n",
+      llvm::json::Value(llvm::json::Object{
+          {"version", "2.1.0"},
+          {"$schema", "https://json.schemastore.org/sarif-2.1.0.json"},
+          {"runs",
+           llvm::json::Array{llvm::json::Object{
+               {"tool",
+                llvm::json::Object{
+                    {"driver",
+                     llvm::json::Object{
+                         {"name", "nullability_check"},
+                         {"rules", llvm::json::Array{llvm::json::Object{
+                                       {"id", RuleID}}}},
+                     }},
+                }},
+               {"results", std::move(SarifResults)},
+           }}},
+      }));
+}
+
+}  // namespace
+}  // namespace clang::tidy::nullability
+
+int main(int argc, const char **argv) {
+  using namespace clang::tooling;
+  auto Exec = createExecutorFromCommandLineArgs(argc, argv, Opts);
+  QCHECK(Exec) << toString(Exec.takeError());
+  if (!SarifOut.empty())
+    clang::tidy::nullability::Results = (*Exec)->getExecutionContext();
+  auto Err = (*Exec)->execute(
+      newFrontendActionFactory<clang::tidy::nullability::Action>());
+  QCHECK(!Err) << toString(std::move(Err));
+  if (!SarifOut.empty())
+    clang::tidy::nullability::writeSarif(*(*Exec)->getToolResults());
+}
@@ -0,0 +1,60 @@
+#!/bin/sh -ex
+# Part of the Crubit project, under the Apache License v2.0 with LLVM
+# Exceptions. See /LICENSE for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+CHECK="$1"
+HEADER="$TEST_TMPDIR/test.h"
+SOURCE="$TEST_TMPDIR/test.cc"
+LOG="$TEST_TMPDIR/test.log"
+SARIF="$TEST_TMPDIR/test.sarif"
+CACHE="$TEST_TMPDIR/cache"
+
+# Fails unless $LOG holds exactly $1 findings.
+expect_findings() {
+  COUNT=$(grep -c "violates null-safety \[nullability\]" $LOG || true)
+  if [ "$COUNT" -ne "$1" ]; then
+    cat $LOG
+    echo "Expected $1 findings, got $COUNT"
+    exit 1
+  fi
+}
+
+cat >$HEADER <<EOF
+  inline int derefInHeader(int *_Nullable p) { return *p; }
+EOF
+cat >$SOURCE <<EOF
+  #include "test.h"
+
+  int good(int *_Nonnull p) { return *p; }
+  int bad(int *_Nullable p) { return *p; }
+  int alsoBad(int *_Nullable p, int *_Nullable q) { return *p + *q; }
+EOF
+
+# Only functions defined in the main file are checked by default.
+$CHECK $SOURCE -- -I$TEST_TMPDIR 2> $LOG
+expect_findings 3
+
+$CHECK -check_headers $SOURCE -- -I$TEST_TMPDIR 2> $LOG
+expect_findings 4
+
+# The second run reads derefInHeader's findings from the cache.
+mkdir -p $CACHE
+$CHECK -check_headers -cache_dir=$CACHE $SOURCE -- -I$TEST_TMPDIR 2> $LOG
+expect_findings 4
+if [ -z "$(ls $CACHE)" ]; then
+  echo "Should have cached the findings for derefInHeader"
+  exit 1
+fi
+$CHECK -check_headers -cache_dir=$CACHE $SOURCE -- -I$TEST_TMPDIR 2> $LOG
+expect_findings 4
+
+# -sarif_out writes one result per finding, even without -diagnostics.
+$CHECK -diagnostics=0 -sarif_out=$SARIF $SOURCE -- -I$TEST_TMPDIR 2> $LOG
+expect_findings 0
+COUNT=$(grep -c '"ruleId": "nullability"' $SARIF || true)
+if [ "$COUNT" -ne 3 ]; then
+  cat $SARIF
+  echo "Expected 3 SARIF results, got $COUNT"
+  exit 1
+fi
@@ -76,25 +76,37 @@ void initPointerNullState(PointerValue &PointerVal, Environment &Env,
   initPointerBoolProperty(PointerVal, kNull, NullConstraint, Env);
 }
 
+bool ImplicationCache::flowConditionImplies(const Environment &Env,
+                                            const dataflow::Formula &F) {
+  std::pair<unsigned, const dataflow::Formula *> Key = {
+      static_cast<unsigned>(Env.getFlowConditionToken()), &F};
+  if (Proven.contains(Key)) return true;
+  if (!Env.flowConditionImplies(F)) return false;
+  Proven.insert(Key);
+  return true;
+}
+
 bool isNullable(const PointerValue &PointerVal, const Environment &Env,
-                const dataflow::Formula *AdditionalConstraints) {
+                const dataflow::Formula *AdditionalConstraints,
+                ImplicationCache *Cache) {
   auto &A = Env.getDataflowAnalysisContext().arena();
   auto [FromNullable, Null] = getPointerNullState(PointerVal);
   auto *ForseeablyNull = &A.makeAnd(FromNullable.formula(), Null.formula());
   if (AdditionalConstraints)
     ForseeablyNull = &A.makeAnd(*AdditionalConstraints, *ForseeablyNull);
-  return !Env.flowConditionImplies(A.makeNot(*ForseeablyNull));
+  return !flowConditionImplies(Env, A.makeNot(*ForseeablyNull), Cache);
 }
 
 NullabilityKind getNullability(const dataflow::PointerValue &PointerVal,
                                const dataflow::Environment &Env,
-                               const dataflow::Formula *AdditionalConstraints) {
+                               const dataflow::Formula *AdditionalConstraints,
+                               ImplicationCache *Cache) {
   auto &A = Env.getDataflowAnalysisContext().arena();
   auto *Null = &getPointerNullState(PointerVal).second.formula();
   if (AdditionalConstraints) Null = &A.makeAnd(*AdditionalConstraints, *Null);
-  if (Env.flowConditionImplies(A.makeNot(*Null)))
+  if (flowConditionImplies(Env, A.makeNot(*Null), Cache))
     return NullabilityKind::NonNull;
-  return isNullable(PointerVal, Env, AdditionalConstraints)
+  return isNullable(PointerVal, Env, AdditionalConstraints, Cache)
              ? NullabilityKind::Nullable
              : NullabilityKind::Unspecified;
 }
@@ -19,8 +19,10 @@
 #include "clang/AST/ASTDumper.h"
 #include "clang/AST/Expr.h"
 #include "clang/Analysis/FlowSensitive/DataflowEnvironment.h"
+#include "clang/Analysis/FlowSensitive/Formula.h"
 #include "clang/Analysis/FlowSensitive/Value.h"
 #include "clang/Basic/Specifiers.h"
+#include "llvm/ADT/DenseSet.h"
 
 namespace clang::tidy::nullability {
 
@@ -104,10 +106,39 @@ inline void initUnknownPointer(dataflow::PointerValue &PointerVal,
       /*FromNullableConstraint=*/&Env.getBoolLiteralValue(false));
 }
 
+/// Remembers the formulas that flow conditions have been proven to imply, so
+/// that repeated queries (e.g. about the same pointer at the same program
+/// point) don't invoke the SAT solver again.
+///
+/// Only successful proofs are remembered: a flow condition token can gain
+/// more constraints as later statements are transferred, so a formula that
+/// could not be proven may become provable, but not the reverse.
+///
+/// A cache must only be used with environments from one analysis context.
+class ImplicationCache {
+ public:
+  /// Equivalent to `Env.flowConditionImplies(F)`.
+  bool flowConditionImplies(const dataflow::Environment &Env,
+                            const dataflow::Formula &F);
+
+ private:
+  llvm::DenseSet<std::pair<unsigned, const dataflow::Formula *>> Proven;
+};
+
+/// Returns `Cache->flowConditionImplies(Env, F)`, or if Cache is null,
+/// `Env.flowConditionImplies(F)`.
+inline bool flowConditionImplies(const dataflow::Environment &Env,
+                                 const dataflow::Formula &F,
+                                 ImplicationCache *Cache) {
+  return Cache ? Cache->flowConditionImplies(Env, F)
+               : Env.flowConditionImplies(F);
+}
+
 /// Returns true if there is evidence that `PointerVal` may hold a nullptr.
 bool isNullable(const dataflow::PointerValue &PointerVal,
                 const dataflow::Environment &Env,
-                const dataflow::Formula *AdditionalConstraints = nullptr);
+                const dataflow::Formula *AdditionalConstraints = nullptr,
+                ImplicationCache *Cache = nullptr);
 
 /// Returns the strongest provable assertion we can make about `PointerVal`.
 /// If PointerVal may not be null, returns Nonnull.
@@ -115,15 +146,17 @@ bool isNullable(const dataflow::PointerValue &PointerVal,
 /// Otherwise, returns Unspecified.
 clang::NullabilityKind getNullability(
     const dataflow::PointerValue &PointerVal, const dataflow::Environment &Env,
-    const dataflow::Formula *AdditionalConstraints = nullptr);
+    const dataflow::Formula *AdditionalConstraints = nullptr,
+    ImplicationCache *Cache = nullptr);
 
 /// Returns the strongest provable assertion we can make about the value of
 /// `E` in `Env`.
 inline clang::NullabilityKind getNullability(
     const Expr *E, const dataflow::Environment &Env,
-    const dataflow::Formula *AdditionalConstraints = nullptr) {
+    const dataflow::Formula *AdditionalConstraints = nullptr,
+    ImplicationCache *Cache = nullptr) {
   if (auto *P = getPointerValueFromExpr(E, Env))
-    return getNullability(*P, Env, AdditionalConstraints);
+    return getNullability(*P, Env, AdditionalConstraints, Cache);
   return clang::NullabilityKind::Unspecified;
 }
 
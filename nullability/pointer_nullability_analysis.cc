@@ -4,6 +4,7 @@
 
 #include "nullability/pointer_nullability_analysis.h"
 
+#include <algorithm>
 #include <optional>
 #include <string>
 #include <utility>
@@ -13,6 +14,7 @@
 #include "nullability/pointer_nullability.h"
 #include "nullability/pointer_nullability_lattice.h"
 #include "nullability/pointer_nullability_matchers.h"
+#include "nullability/stmt_class_match_switch.h"
 #include "nullability/type_nullability.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/ASTDumper.h"
@@ -24,7 +26,6 @@
 #include "clang/ASTMatchers/ASTMatchFinder.h"
 #include "clang/ASTMatchers/ASTMatchers.h"
 #include "clang/Analysis/FlowSensitive/Arena.h"
-#include "clang/Analysis/FlowSensitive/CFGMatchSwitch.h"
 #include "clang/Analysis/FlowSensitive/DataflowEnvironment.h"
 #include "clang/Analysis/FlowSensitive/Value.h"
 #include "clang/Basic/LLVM.h"
@@ -34,7 +35,6 @@ namespace clang::tidy::nullability {
 
 using ast_matchers::MatchFinder;
 using dataflow::BoolValue;
-using dataflow::CFGMatchSwitchBuilder;
 using dataflow::Environment;
 using dataflow::PointerValue;
 using dataflow::ReferenceValue;
@@ -54,7 +54,7 @@ void computeNullability(const Expr *E,
                         std::function<TypeNullability()> Compute) {
   (void)State.Lattice.insertExprNullabilityIfAbsent(E, [&] {
     auto Nullability = Compute();
-    if (unsigned ExpectedSize = countPointersInType(E);
+    if (unsigned ExpectedSize = State.Lattice.countPointersInType(E);
         ExpectedSize != Nullability.size()) {
       // A nullability vector must have one entry per pointer in the type.
       // If this is violated, we probably failed to handle some AST node.
@@ -90,7 +90,7 @@ const TypeNullability &getNullabilityForChild(
     dump(E, llvm::dbgs());
     llvm::dbgs() << "==================================\n";
 
-    return unspecifiedNullability(E);
+    return State.Lattice.unspecifiedNullability(E);
   });
 }
 
@@ -127,7 +127,7 @@ const TypeNullability &getNullabilityForChild(
 /// substitutions, which in this case is [_Nullable, _Nonnull].
 TypeNullability substituteNullabilityAnnotationsInClassTemplate(
     QualType T, const TypeNullability &BaseNullabilityAnnotations,
-    QualType BaseType) {
+    QualType BaseType, const PointerNullabilityLattice &Lattice) {
   return getNullabilityAnnotationsFromType(
       T,
       [&](const SubstTemplateTypeParmType *ST)
@@ -159,10 +159,11 @@ TypeNullability substituteNullabilityAnnotationsInClassTemplate(
         unsigned PointerCount =
             countPointersInType(Specialization->getDeclContext());
         for (auto TA : TemplateArgs.take_front(ArgIndex)) {
-          PointerCount += countPointersInType(TA);
+          PointerCount += Lattice.countPointersInType(TA);
         }
 
-        unsigned SliceSize = countPointersInType(TemplateArgs[ArgIndex]);
+        unsigned SliceSize =
+            Lattice.countPointersInType(TemplateArgs[ArgIndex]);
         return ArrayRef(BaseNullabilityAnnotations)
             .slice(PointerCount, SliceSize)
             .vec();
@@ -402,28 +403,38 @@ void transferFlowSensitiveCallExpr(
 // (N is the nullability of an access to D).
 void overrideNullabilityFromDecl(const ValueDecl *D,
                                  PointerNullabilityLattice &Lattice,
-                                 TypeNullability &N) {
+                                 dataflow::Arena &A, TypeNullability &N) {
   // For now, overrides are always for pointer values only, and override only
   // the top-level nullability.
-  if (auto *PN = Lattice.getDeclNullability(D)) {
+  if (auto *PN = Lattice.getOrCreateDeclNullability(D, A)) {
     CHECK(!N.empty());
     N.front() = *PN;
   }
 }
 
+// Applies the overridden nullability of the value returned by the callee of
+// CE, if any.
+void overrideNullabilityFromCallee(const CallExpr &CE,
+                                   PointerNullabilityLattice &Lattice,
+                                   TypeNullability &N) {
+  // Like decl overrides, these only override the top-level nullability.
+  auto *Callee = CE.getDirectCallee();
+  if (!Callee || N.empty() || !CE.getType()->isPointerType()) return;
+  if (auto NK = Lattice.getReturnNullabilityOverride(*Callee)) N.front() = *NK;
+}
+
 void transferNonFlowSensitiveDeclRefExpr(
-    const DeclRefExpr *DRE, const MatchFinder::MatchResult &MR,
-    TransferState<PointerNullabilityLattice> &State) {
+    const DeclRefExpr *DRE, TransferState<PointerNullabilityLattice> &State) {
   computeNullability(DRE, State, [&] {
-    auto Nullability = getNullabilityAnnotationsFromType(DRE->getType());
-    overrideNullabilityFromDecl(DRE->getDecl(), State.Lattice, Nullability);
+    auto Nullability = State.Lattice.getTypeNullability(DRE->getType());
+    overrideNullabilityFromDecl(DRE->getDecl(), State.Lattice,
+                                State.Env.arena(), Nullability);
     return Nullability;
   });
 }
 
 void transferNonFlowSensitiveMemberExpr(
-    const MemberExpr *ME, const MatchFinder::MatchResult &MR,
-    TransferState<PointerNullabilityLattice> &State) {
+    const MemberExpr *ME, TransferState<PointerNullabilityLattice> &State) {
   computeNullability(ME, State, [&]() {
     auto BaseNullability = getNullabilityForChild(ME->getBase(), State);
     QualType MemberType = ME->getType();
@@ -438,26 +449,28 @@ void transferNonFlowSensitiveMemberExpr(
       MemberType = ME->getMemberDecl()->getType();
     }
     auto Nullability = substituteNullabilityAnnotationsInClassTemplate(
-        MemberType, BaseNullability, ME->getBase()->getType());
+        MemberType, BaseNullability, ME->getBase()->getType(), State.Lattice);
     overrideNullabilityFromDecl(ME->getMemberDecl(), State.Lattice,
-                                Nullability);
+                                State.Env.arena(), Nullability);
     return Nullability;
   });
 }
 
 void transferNonFlowSensitiveMemberCallExpr(
-    const CXXMemberCallExpr *MCE, const MatchFinder::MatchResult &MR,
+    const CXXMemberCallExpr *MCE,
     TransferState<PointerNullabilityLattice> &State) {
   computeNullability(MCE, State, [&]() {
-    return ArrayRef(getNullabilityForChild(MCE->getCallee(), State))
-        .take_front(countPointersInType(MCE))
-        .vec();
+    auto Nullability =
+        ArrayRef(getNullabilityForChild(MCE->getCallee(), State))
+            .take_front(State.Lattice.countPointersInType(MCE))
+            .vec();
+    overrideNullabilityFromCallee(*MCE, State.Lattice, Nullability);
+    return Nullability;
   });
 }
 
 void transferNonFlowSensitiveCastExpr(
-    const CastExpr *CE, const MatchFinder::MatchResult &MR,
-    TransferState<PointerNullabilityLattice> &State) {
+    const CastExpr *CE, TransferState<PointerNullabilityLattice> &State) {
   computeNullability(CE, State, [&]() -> TypeNullability {
     // Most casts that can convert ~unrelated types drop nullability in general.
     // As a special case, preserve nullability of outer pointer types.
@@ -482,7 +495,8 @@ void transferNonFlowSensitiveCastExpr(
       case CK_LValueBitCast:
       case CK_BitCast:
       case CK_LValueToRValueBitCast:
-        return PreserveTopLevelPointers(unspecifiedNullability(CE));
+        return PreserveTopLevelPointers(
+            State.Lattice.unspecifiedNullability(CE));
 
       // Casts between equivalent types.
       case CK_LValueToRValue:
@@ -497,13 +511,14 @@ void transferNonFlowSensitiveCastExpr(
       case CK_BaseToDerived:
       case CK_DerivedToBase:
       case CK_UncheckedDerivedToBase:
-        return PreserveTopLevelPointers(unspecifiedNullability(CE));
+        return PreserveTopLevelPointers(
+            State.Lattice.unspecifiedNullability(CE));
       case CK_UserDefinedConversion:
       case CK_ConstructorConversion:
-        return unspecifiedNullability(CE);
+        return State.Lattice.unspecifiedNullability(CE);
 
       case CK_Dynamic: {
-        auto Result = unspecifiedNullability(CE);
+        auto Result = State.Lattice.unspecifiedNullability(CE);
         // A dynamic_cast to pointer is null if the runtime check fails.
         if (isa<PointerType>(CE->getType().getCanonicalType()))
           Result.front() = NullabilityKind::Nullable;
@@ -542,7 +557,7 @@ void transferNonFlowSensitiveCastExpr(
 
       // This can definitely be null!
       case CK_NullToPointer: {
-        auto Nullability = getNullabilityAnnotationsFromType(CE->getType());
+        auto Nullability = State.Lattice.getTypeNullability(CE->getType());
         // Despite the name `NullToPointer`, the destination type of the cast
         // may be `nullptr_t` (which is, itself, not a pointer type).
         if (!CE->getType()->isNullPtrType())
@@ -552,7 +567,7 @@ void transferNonFlowSensitiveCastExpr(
 
       // Pointers out of thin air, who knows?
       case CK_IntegralToPointer:
-        return unspecifiedNullability(CE);
+        return State.Lattice.unspecifiedNullability(CE);
 
       // Decayed objects are never null.
       case CK_ArrayToPointerDecay:
@@ -571,7 +586,7 @@ void transferNonFlowSensitiveCastExpr(
       case CK_NullToMemberPointer:
       case CK_ReinterpretMemberPointer:
       case CK_ToUnion:  // and unions?
-        return unspecifiedNullability(CE);
+        return State.Lattice.unspecifiedNullability(CE);
 
       // TODO: Non-C/C++ constructs, do we care about these?
       case CK_CPointerToObjCPointerCast:
@@ -587,7 +602,7 @@ void transferNonFlowSensitiveCastExpr(
       case CK_CopyAndAutoreleaseBlockObject:
       case CK_ZeroToOCLOpaqueType:
       case CK_IntToOCLSampler:
-        return unspecifiedNullability(CE);
+        return State.Lattice.unspecifiedNullability(CE);
 
       case CK_Dependent:
         CHECK(false) << "Shouldn't see dependent casts here?";
@@ -596,7 +611,7 @@ void transferNonFlowSensitiveCastExpr(
 }
 
 void transferNonFlowSensitiveMaterializeTemporaryExpr(
-    const MaterializeTemporaryExpr *MTE, const MatchFinder::MatchResult &MR,
+    const MaterializeTemporaryExpr *MTE,
     TransferState<PointerNullabilityLattice> &State) {
   computeNullability(MTE, State, [&]() {
     return getNullabilityForChild(MTE->getSubExpr(), State);
@@ -604,22 +619,22 @@ void transferNonFlowSensitiveMaterializeTemporaryExpr(
 }
 
 void transferNonFlowSensitiveCallExpr(
-    const CallExpr *CE, const MatchFinder::MatchResult &MR,
-    TransferState<PointerNullabilityLattice> &State) {
+    const CallExpr *CE, TransferState<PointerNullabilityLattice> &State) {
   // TODO: Check CallExpr arguments in the diagnoser against the nullability of
   // parameters.
   computeNullability(CE, State, [&]() {
     // TODO(mboehme): Instead of relying on Clang to propagate nullability sugar
     // to the `CallExpr`'s type, we should extract nullability directly from the
     // callee `Expr .
-    return substituteNullabilityAnnotationsInFunctionTemplate(CE->getType(),
-                                                              CE);
+    auto Nullability =
+        substituteNullabilityAnnotationsInFunctionTemplate(CE->getType(), CE);
+    overrideNullabilityFromCallee(*CE, State.Lattice, Nullability);
+    return Nullability;
   });
 }
 
 void transferNonFlowSensitiveUnaryOperator(
-    const UnaryOperator *UO, const MatchFinder::MatchResult &MR,
-    TransferState<PointerNullabilityLattice> &State) {
+    const UnaryOperator *UO, TransferState<PointerNullabilityLattice> &State) {
   computeNullability(UO, State, [&]() -> TypeNullability {
     switch (UO->getOpcode()) {
       case UO_AddrOf:
@@ -645,16 +660,15 @@ void transferNonFlowSensitiveUnaryOperator(
 
       case UO_Coawait:
         // TODO: work out what to do here!
-        return unspecifiedNullability(UO);
+        return State.Lattice.unspecifiedNullability(UO);
     }
   });
 }
 
 void transferNonFlowSensitiveNewExpr(
-    const CXXNewExpr *NE, const MatchFinder::MatchResult &MR,
-    TransferState<PointerNullabilityLattice> &State) {
+    const CXXNewExpr *NE, TransferState<PointerNullabilityLattice> &State) {
   computeNullability(NE, State, [&]() {
-    TypeNullability result = getNullabilityAnnotationsFromType(NE->getType());
+    TypeNullability result = State.Lattice.getTypeNullability(NE->getType());
     result.front() = NE->shouldNullCheckAllocation() ? NullabilityKind::Nullable
                                                      : NullabilityKind::NonNull;
     return result;
@@ -662,7 +676,7 @@ void transferNonFlowSensitiveNewExpr(
 }
 
 void transferNonFlowSensitiveArraySubscriptExpr(
-    const ArraySubscriptExpr *ASE, const MatchFinder::MatchResult &MR,
+    const ArraySubscriptExpr *ASE,
     TransferState<PointerNullabilityLattice> &State) {
   computeNullability(ASE, State, [&]() {
     auto &BaseNullability = getNullabilityForChild(ASE->getBase(), State);
@@ -675,72 +689,72 @@ void transferNonFlowSensitiveArraySubscriptExpr(
 }
 
 void transferNonFlowSensitiveThisExpr(
-    const CXXThisExpr *TE, const MatchFinder::MatchResult &MR,
-    TransferState<PointerNullabilityLattice> &State) {
+    const CXXThisExpr *TE, TransferState<PointerNullabilityLattice> &State) {
   computeNullability(TE, State, [&]() {
-    TypeNullability result = getNullabilityAnnotationsFromType(TE->getType());
+    TypeNullability result = State.Lattice.getTypeNullability(TE->getType());
     result.front() = NullabilityKind::NonNull;
     return result;
   });
 }
 
 auto buildNonFlowSensitiveTransferer() {
-  return CFGMatchSwitchBuilder<TransferState<PointerNullabilityLattice>>()
-      .CaseOfCFGStmt<DeclRefExpr>(ast_matchers::declRefExpr(),
-                                  transferNonFlowSensitiveDeclRefExpr)
-      .CaseOfCFGStmt<MemberExpr>(ast_matchers::memberExpr(),
-                                 transferNonFlowSensitiveMemberExpr)
-      .CaseOfCFGStmt<CXXMemberCallExpr>(ast_matchers::cxxMemberCallExpr(),
-                                        transferNonFlowSensitiveMemberCallExpr)
-      .CaseOfCFGStmt<CastExpr>(ast_matchers::castExpr(),
-                               transferNonFlowSensitiveCastExpr)
+  return StmtClassMatchSwitch<TransferState<PointerNullabilityLattice>>()
+      .CaseOfCFGStmt<DeclRefExpr>(transferNonFlowSensitiveDeclRefExpr)
+      .CaseOfCFGStmt<MemberExpr>(transferNonFlowSensitiveMemberExpr)
+      .CaseOfCFGStmt<CXXMemberCallExpr>(transferNonFlowSensitiveMemberCallExpr)
+      .CaseOfCFGStmt<CastExpr>(transferNonFlowSensitiveCastExpr)
       .CaseOfCFGStmt<MaterializeTemporaryExpr>(
-          ast_matchers::materializeTemporaryExpr(),
           transferNonFlowSensitiveMaterializeTemporaryExpr)
-      .CaseOfCFGStmt<CallExpr>(ast_matchers::callExpr(),
-                               transferNonFlowSensitiveCallExpr)
-      .CaseOfCFGStmt<UnaryOperator>(ast_matchers::unaryOperator(),
-                                    transferNonFlowSensitiveUnaryOperator)
-      .CaseOfCFGStmt<CXXNewExpr>(ast_matchers::cxxNewExpr(),
-                                 transferNonFlowSensitiveNewExpr)
+      .CaseOfCFGStmt<CallExpr>(transferNonFlowSensitiveCallExpr)
+      .CaseOfCFGStmt<UnaryOperator>(transferNonFlowSensitiveUnaryOperator)
+      .CaseOfCFGStmt<CXXNewExpr>(transferNonFlowSensitiveNewExpr)
       .CaseOfCFGStmt<ArraySubscriptExpr>(
-          ast_matchers::arraySubscriptExpr(),
           transferNonFlowSensitiveArraySubscriptExpr)
-      .CaseOfCFGStmt<CXXThisExpr>(ast_matchers::cxxThisExpr(),
-                                  transferNonFlowSensitiveThisExpr)
-      .Build();
+      .CaseOfCFGStmt<CXXThisExpr>(transferNonFlowSensitiveThisExpr);
 }
 
 auto buildFlowSensitiveTransferer() {
-  return CFGMatchSwitchBuilder<TransferState<PointerNullabilityLattice>>()
+  return StmtClassMatchSwitch<TransferState<PointerNullabilityLattice>>()
       // Handles initialization of the null states of pointers.
-      .CaseOfCFGStmt<Expr>(isAddrOf(), transferFlowSensitiveNotNullPointer)
+      .CaseOfCFGStmt<UnaryOperator>(isAddrOf(),
+                                    transferFlowSensitiveNotNullPointer)
       // TODO(mboehme): I believe we should be able to move handling of null
       // pointers to the non-flow-sensitive part of the analysis.
-      .CaseOfCFGStmt<Expr>(isNullPointerLiteral(),
-                           transferFlowSensitiveNullPointer)
+      .CaseOfCFGStmt<ImplicitCastExpr>(isNullPointerLiteral(),
+                                       transferFlowSensitiveNullPointer)
       .CaseOfCFGStmt<CallExpr>(isCallExpr(), transferFlowSensitiveCallExpr)
       .CaseOfCFGStmt<Expr>(isPointerExpr(), transferFlowSensitivePointer)
       // Handles comparison between 2 pointers.
       .CaseOfCFGStmt<BinaryOperator>(isPointerCheckBinOp(),
                                      transferFlowSensitiveNullCheckComparison)
       // Handles checking of pointer as boolean.
-      .CaseOfCFGStmt<Expr>(isImplicitCastPointerToBool(),
-                           transferFlowSensitiveNullCheckImplicitCastPtrToBool)
-      .Build();
+      .CaseOfCFGStmt<ImplicitCastExpr>(
+          isImplicitCastPointerToBool(),
+          transferFlowSensitiveNullCheckImplicitCastPtrToBool);
 }
 }  // namespace
 
-PointerNullabilityAnalysis::PointerNullabilityAnalysis(ASTContext &Context)
+PointerNullabilityAnalysis::PointerNullabilityAnalysis(
+    ASTContext &Context, TypeNullabilityCache *TypeCache)
     : DataflowAnalysis<PointerNullabilityAnalysis, PointerNullabilityLattice>(
           Context),
       NonFlowSensitiveTransferer(buildNonFlowSensitiveTransferer()),
-      FlowSensitiveTransferer(buildFlowSensitiveTransferer()) {}
+      FlowSensitiveTransferer(buildFlowSensitiveTransferer()) {
+  if (!TypeCache) {
+    OwnedTypeCache = std::make_unique<TypeNullabilityCache>();
+    TypeCache = OwnedTypeCache.get();
+  }
+  NFS.TypeCache = TypeCache;
+}
 
 PointerTypeNullability PointerNullabilityAnalysis::assignNullabilityVariable(
     const ValueDecl *D, dataflow::Arena &A) {
+  NFS.LazyNullabilityVariables.erase(D);
   auto [It, Inserted] = NFS.DeclTopLevelNullability.try_emplace(D);
-  if (Inserted) It->second = PointerTypeNullability::createSymbolic(A);
+  if (Inserted) {
+    It->second = PointerTypeNullability::createSymbolic(A);
+    NFS.AtomsCreated += 2;
+  }
   return It->second;
 }
 
@@ -752,28 +766,41 @@ void PointerNullabilityAnalysis::transfer(const CFGElement &Elt,
   FlowSensitiveTransferer(Elt, getASTContext(), State);
 }
 
-BoolValue &mergeBoolValues(BoolValue &Bool1, const Environment &Env1,
-                           BoolValue &Bool2, const Environment &Env2,
-                           Environment &MergedEnv) {
-  if (&Bool1 == &Bool2) {
+BoolValue &PointerNullabilityAnalysis::mergeBoolValues(
+    BoolValue &Bool1, const Environment &Env1, BoolValue &Bool2,
+    const Environment &Env2, Environment &MergedEnv) {
+  // Formulas are hash-consed by the arena, so equal formulas may be shared by
+  // distinct BoolValues.
+  if (&Bool1 == &Bool2 || &Bool1.formula() == &Bool2.formula()) {
     return Bool1;
   }
 
   auto &A = MergedEnv.arena();
   auto &MergedBool = A.makeAtomRef(A.makeAtom());
+  ++NFS.AtomsCreated;
 
   // If `Bool1` and `Bool2` is constrained to the same true / false value,
   // `MergedBool` can be constrained similarly without needing to consider the
   // path taken - this simplifies the flow condition tracked in `MergedEnv`.
   // Otherwise, information about which path was taken is used to associate
   // `MergedBool` with `Bool1` and `Bool2`.
-  if (Env1.flowConditionImplies(Bool1.formula()) &&
-      Env2.flowConditionImplies(Bool2.formula())) {
+  auto &Implications = NFS.Implications;
+  if (Implications.flowConditionImplies(Env1, Bool1.formula()) &&
+      Implications.flowConditionImplies(Env2, Bool2.formula())) {
     MergedEnv.addToFlowCondition(MergedBool);
-  } else if (Env1.flowConditionImplies(A.makeNot(Bool1.formula())) &&
-             Env2.flowConditionImplies(A.makeNot(Bool2.formula()))) {
+  } else if (Implications.flowConditionImplies(Env1,
+                                               A.makeNot(Bool1.formula())) &&
+             Implications.flowConditionImplies(Env2,
+                                               A.makeNot(Bool2.formula()))) {
     MergedEnv.addToFlowCondition(A.makeNot(MergedBool));
   } else {
+    unsigned Depth = std::max(JoinDepth.lookup(&Bool1.formula()),
+                              JoinDepth.lookup(&Bool2.formula())) +
+                     1;
+    // Widen: leave MergedBool unconstrained.
+    if (MaxJoinDepth && Depth > MaxJoinDepth)
+      return A.makeBoolValue(MergedBool);
+    JoinDepth[&MergedBool] = Depth;
     // TODO(b/233582219): Flow conditions are not necessarily mutually
     // exclusive, a fix is in order: https://reviews.llvm.org/D130270. Update
     // this section when the patch is commited.
@@ -5,19 +5,25 @@
 #ifndef CRUBIT_NULLABILITY_POINTER_NULLABILITY_ANALYSIS_H_
 #define CRUBIT_NULLABILITY_POINTER_NULLABILITY_ANALYSIS_H_
 
+#include <functional>
+#include <memory>
+#include <optional>
 #include <utility>
 
 #include "nullability/pointer_nullability_lattice.h"
+#include "nullability/stmt_class_match_switch.h"
 #include "nullability/type_nullability.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/Type.h"
 #include "clang/Analysis/FlowSensitive/Arena.h"
-#include "clang/Analysis/FlowSensitive/CFGMatchSwitch.h"
 #include "clang/Analysis/FlowSensitive/DataflowAnalysis.h"
 #include "clang/Analysis/FlowSensitive/DataflowEnvironment.h"
 #include "clang/Analysis/FlowSensitive/Formula.h"
+#include "clang/Analysis/FlowSensitive/MatchSwitch.h"
 #include "clang/Analysis/FlowSensitive/Value.h"
+#include "clang/Basic/Specifiers.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace clang {
 namespace tidy {
@@ -32,7 +38,11 @@ class PointerNullabilityAnalysis
   PointerNullabilityLattice::NonFlowSensitiveState NFS;
 
  public:
-  explicit PointerNullabilityAnalysis(ASTContext &context);
+  // The nullability of types is memoized in TypeCache if provided, which must
+  // outlive the analysis, and may be shared with other analyses of code in the
+  // same ASTContext. Otherwise, the analysis uses a cache of its own.
+  explicit PointerNullabilityAnalysis(
+      ASTContext &context, TypeNullabilityCache *TypeCache = nullptr);
 
   PointerNullabilityLattice initialElement() {
     return PointerNullabilityLattice(NFS);
@@ -67,6 +77,61 @@ class PointerNullabilityAnalysis
   PointerTypeNullability assignNullabilityVariable(const ValueDecl *D,
                                                    dataflow::Arena &);
 
+  // Like assignNullabilityVariable, but the variables are only created when
+  // the analysis first reads a value from D, and can then be retrieved with
+  // getNullabilityVariable. An unused D adds no variables to the analysis.
+  void assignNullabilityVariableOnFirstUse(const ValueDecl *D) {
+    if (!NFS.DeclTopLevelNullability.contains(D))
+      NFS.LazyNullabilityVariables.insert(D);
+  }
+
+  // Returns the nullability variables assigned to D, if they have been
+  // created.
+  const PointerTypeNullability *getNullabilityVariable(
+      const ValueDecl *D) const {
+    auto It = NFS.DeclTopLevelNullability.find(D);
+    if (It == NFS.DeclTopLevelNullability.end()) return nullptr;
+    return &It->second;
+  }
+
+  // Returns the number of SAT atoms that the analysis has created itself
+  // (nullability variables, and values merged at joins), excluding those
+  // created by the dataflow framework.
+  unsigned atomsCreated() const { return NFS.AtomsCreated; }
+
+  // Overrides the top-level nullability of the values returned by calls to
+  // functions, in place of their declared return types. Override returns
+  // std::nullopt to use the declared return type.
+  //
+  // This allows inference to take into account what is already known about
+  // functions that are not annotated yet, e.g. from a previous round.
+  void assignReturnNullabilityOverride(
+      std::function<std::optional<NullabilityKind>(const FunctionDecl &)>
+          Override) {
+    NFS.ReturnNullabilityOverride = std::move(Override);
+  }
+
+  // Makes the diagnoser assume Assumptions when checking null-safety.
+  //
+  // After assignNullabilityVariable(), this allows the same analysis run to be
+  // diagnosed as if D had its declared nullability, by assuming that the
+  // variables take the corresponding values.
+  void assumeForDiagnosis(const dataflow::Formula &Assumptions) {
+    NFS.DiagnosisAssumptions = &Assumptions;
+  }
+
+  // Bounds the growth of the flow condition at joins.
+  //
+  // Merging two pointers whose nullability properties differ introduces a new
+  // variable, constrained by a disjunction over the incoming flow conditions.
+  // Through many joins (e.g. long chains of branches, or loops), these nest
+  // and make SAT queries exponentially slow.
+  // Once a merged property is the result of more than MaxJoinDepth nested
+  // joins, it is instead left unconstrained (i.e. unknown). This loses
+  // precision, so that e.g. more dereferences may be diagnosed as unsafe.
+  // Zero (the default) means unlimited.
+  void setMaxJoinDepth(unsigned Depth) { MaxJoinDepth = Depth; }
+
   void transfer(const CFGElement &Elt, PointerNullabilityLattice &Lattice,
                 dataflow::Environment &Env);
 
@@ -77,12 +142,25 @@ class PointerNullabilityAnalysis
 
  private:
   // Applies non-flow-sensitive transfer functions on statements
-  dataflow::CFGMatchSwitch<dataflow::TransferState<PointerNullabilityLattice>>
+  StmtClassMatchSwitch<dataflow::TransferState<PointerNullabilityLattice>>
       NonFlowSensitiveTransferer;
 
   // Applies flow-sensitive transfer functions on statements
-  dataflow::CFGMatchSwitch<dataflow::TransferState<PointerNullabilityLattice>>
+  StmtClassMatchSwitch<dataflow::TransferState<PointerNullabilityLattice>>
       FlowSensitiveTransferer;
+
+  dataflow::BoolValue &mergeBoolValues(dataflow::BoolValue &Bool1,
+                                       const dataflow::Environment &Env1,
+                                       dataflow::BoolValue &Bool2,
+                                       const dataflow::Environment &Env2,
+                                       dataflow::Environment &MergedEnv);
+
+  // Used when no TypeNullabilityCache is provided.
+  std::unique_ptr<TypeNullabilityCache> OwnedTypeCache;
+
+  unsigned MaxJoinDepth = 0;
+  // The number of nested joins that produced each merged property.
+  llvm::DenseMap<const dataflow::Formula *, unsigned> JoinDepth;
 };
 }  // namespace nullability
 }  // namespace tidy
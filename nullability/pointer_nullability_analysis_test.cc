@@ -88,5 +88,82 @@ TEST(PointerNullabilityAnalysis, AssignNullabilityVariable) {
                      ExitState.Env));
 }
 
+TEST(PointerNullabilityAnalysis, AssignNullabilityVariableOnFirstUse) {
+  TestAST AST(R"cpp(
+    int *target(int *used, int *unused) { return used; }
+  )cpp");
+  auto *Target = cast<FunctionDecl>(
+      lookup("target", *AST.context().getTranslationUnitDecl()));
+  auto *Used = Target->getParamDecl(0);
+  auto *Unused = Target->getParamDecl(1);
+
+  dataflow::DataflowAnalysisContext DACtx(
+      std::make_unique<dataflow::WatchedLiteralsSolver>());
+  auto CFCtx = dataflow::ControlFlowContext::build(*Target);
+  PointerNullabilityAnalysis Analysis(AST.context());
+  Analysis.assignNullabilityVariableOnFirstUse(Used);
+  Analysis.assignNullabilityVariableOnFirstUse(Unused);
+  EXPECT_EQ(Analysis.getNullabilityVariable(Used), nullptr);
+  EXPECT_EQ(Analysis.atomsCreated(), 0);
+
+  ASSERT_TRUE(!!dataflow::runDataflowAnalysis(
+      *CFCtx, Analysis, dataflow::Environment(DACtx, *Target)));
+  const PointerTypeNullability *PN = Analysis.getNullabilityVariable(Used);
+  ASSERT_NE(PN, nullptr);
+  EXPECT_TRUE(PN->isSymbolic());
+  EXPECT_EQ(Analysis.getNullabilityVariable(Unused), nullptr);
+  EXPECT_EQ(Analysis.atomsCreated(), 2);
+}
+
+TEST(PointerNullabilityAnalysis, MaxJoinDepth) {
+  TestAST AST(R"cpp(
+    int *target(bool b, bool c, int *_Nonnull p, int *_Nullable q) {
+      int *r = q;
+      if (b) r = p;
+      if (c) r = q;
+      return r;
+    }
+  )cpp");
+  auto *Target = cast<FunctionDecl>(
+      lookup("target", *AST.context().getTranslationUnitDecl()));
+
+  // Returns whether the analysis proves that r is nonnull when b && !c.
+  auto ProvesNonnull = [&](unsigned MaxJoinDepth) -> std::optional<bool> {
+    dataflow::DataflowAnalysisContext::Options Opts;
+    Opts.ContextSensitiveOpts.emplace();
+    Opts.ContextSensitiveOpts->Depth = 0;
+    dataflow::DataflowAnalysisContext DACtx(
+        std::make_unique<dataflow::WatchedLiteralsSolver>(), Opts);
+    auto &A = DACtx.arena();
+    auto CFCtx = dataflow::ControlFlowContext::build(*Target);
+    PointerNullabilityAnalysis Analysis(AST.context());
+    Analysis.setMaxJoinDepth(MaxJoinDepth);
+    auto ExitState = std::move(
+        *cantFail(dataflow::runDataflowAnalysis(
+                      *CFCtx, Analysis, dataflow::Environment(DACtx, *Target)))
+             .front());
+    auto *Ret = dyn_cast_or_null<dataflow::PointerValue>(
+        ExitState.Env.getReturnValue());
+    auto *B = dyn_cast_or_null<dataflow::BoolValue>(
+        ExitState.Env.getValue(*Target->getParamDecl(0)));
+    auto *C = dyn_cast_or_null<dataflow::BoolValue>(
+        ExitState.Env.getValue(*Target->getParamDecl(1)));
+    if (!Ret || !B || !C) {
+      ADD_FAILURE() << "missing values";
+      return std::nullopt;
+    }
+    auto [RetFromNullable, RetNull] = getPointerNullState(*Ret);
+    return evaluate(
+        A.makeImplies(A.makeAnd(B->formula(), A.makeNot(C->formula())),
+                      A.makeNot(RetFromNullable.formula())),
+        ExitState.Env);
+  };
+
+  EXPECT_EQ(true, ProvesNonnull(/*MaxJoinDepth=*/0));
+  EXPECT_EQ(true, ProvesNonnull(/*MaxJoinDepth=*/2));
+  // The second join is widened.
+  EXPECT_EQ(std::nullopt, ProvesNonnull(/*MaxJoinDepth=*/1));
+}
+
 }  // namespace
 }  // namespace clang::tidy::nullability
@@ -6,8 +6,10 @@
 
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "nullability/pointer_nullability.h"
+#include "nullability/pointer_nullability_analysis.h"
 #include "nullability/pointer_nullability_matchers.h"
 #include "nullability/type_nullability.h"
 #include "clang/AST/ASTContext.h"
@@ -16,9 +18,16 @@
 #include "clang/AST/ExprCXX.h"
 #include "clang/AST/Stmt.h"
 #include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/Analysis/CFG.h"
 #include "clang/Analysis/FlowSensitive/CFGMatchSwitch.h"
+#include "clang/Analysis/FlowSensitive/ControlFlowContext.h"
+#include "clang/Analysis/FlowSensitive/DataflowAnalysis.h"
+#include "clang/Analysis/FlowSensitive/DataflowAnalysisContext.h"
 #include "clang/Analysis/FlowSensitive/DataflowEnvironment.h"
+#include "clang/Analysis/FlowSensitive/WatchedLiteralsSolver.h"
+#include "clang/Basic/SourceLocation.h"
 #include "clang/Basic/Specifiers.h"
+#include "llvm/Support/Error.h"
 
 namespace clang::tidy::nullability {
 
@@ -30,8 +39,10 @@ using dataflow::TransferStateForDiagnostics;
 namespace {
 
 // Returns true if `Expr` is uninterpreted or known to be nullable.
-bool isNullableOrUntracked(const Expr *E, const Environment &Env) {
-  auto *ActualVal = getPointerValueFromExpr(E, Env);
+bool isNullableOrUntracked(
+    const Expr *E,
+    const TransferStateForDiagnostics<PointerNullabilityLattice> &State) {
+  auto *ActualVal = getPointerValueFromExpr(E, State.Env);
   if (ActualVal == nullptr) {
     llvm::dbgs()
         << "The dataflow analysis framework does not model a PointerValue for "
@@ -39,22 +50,26 @@ bool isNullableOrUntracked(const Expr *E, const Environment &Env) {
            "unsafe:\n";
     E->dump();
   }
-  return !ActualVal || isNullable(*ActualVal, Env);
+  return !ActualVal || isNullable(*ActualVal, State.Env,
+                                 State.Lattice.getDiagnosisAssumptions(),
+                                 &State.Lattice.implications());
 }
 
 // Returns true if an uninterpreted or nullable `Expr` was assigned to a
 // construct with a non-null `DeclaredType`.
-bool isIncompatibleAssignment(QualType DeclaredType, const Expr *E,
-                              const Environment &Env, ASTContext &Ctx) {
+bool isIncompatibleAssignment(
+    QualType DeclaredType, const Expr *E,
+    const TransferStateForDiagnostics<PointerNullabilityLattice> &State,
+    ASTContext &Ctx) {
   CHECK(DeclaredType->isAnyPointerType());
   return getNullabilityKind(DeclaredType, Ctx) == NullabilityKind::NonNull &&
-         isNullableOrUntracked(E, Env);
+         isNullableOrUntracked(E, State);
 }
 
 std::optional<CFGElement> diagnoseDereference(
     const UnaryOperator *UnaryOp, const MatchFinder::MatchResult &,
     const TransferStateForDiagnostics<PointerNullabilityLattice> &State) {
-  if (isNullableOrUntracked(UnaryOp->getSubExpr(), State.Env)) {
+  if (isNullableOrUntracked(UnaryOp->getSubExpr(), State)) {
     return std::optional<CFGElement>(CFGStmt(UnaryOp));
   }
   return std::nullopt;
@@ -63,15 +78,16 @@ std::optional<CFGElement> diagnoseDereference(
 std::optional<CFGElement> diagnoseArrow(
     const MemberExpr *MemberExpr, const MatchFinder::MatchResult &Result,
     const TransferStateForDiagnostics<PointerNullabilityLattice> &State) {
-  if (isNullableOrUntracked(MemberExpr->getBase(), State.Env)) {
+  if (isNullableOrUntracked(MemberExpr->getBase(), State)) {
     return std::optional<CFGElement>(CFGStmt(MemberExpr));
   }
   return std::nullopt;
 }
 
-bool isIncompatibleArgumentList(const FunctionProtoType &CalleeFPT,
-                                ArrayRef<const Expr *> Args,
-                                const Environment &Env, ASTContext &Ctx) {
+bool isIncompatibleArgumentList(
+    const FunctionProtoType &CalleeFPT, ArrayRef<const Expr *> Args,
+    const TransferStateForDiagnostics<PointerNullabilityLattice> &State,
+    ASTContext &Ctx) {
   auto ParamTypes = CalleeFPT.getParamTypes();
   // C-style varargs cannot be annotated and therefore are unchecked.
   if (CalleeFPT.isVariadic()) {
@@ -84,7 +100,7 @@ bool isIncompatibleArgumentList(const FunctionProtoType &CalleeFPT,
     if (!ParamType->isAnyPointerType()) {
       continue;
     }
-    if (isIncompatibleAssignment(ParamType, Args[I], Env, Ctx)) {
+    if (isIncompatibleAssignment(ParamType, Args[I], State, Ctx)) {
       return true;
     }
   }
@@ -183,7 +199,7 @@ std::optional<CFGElement> diagnoseCallExpr(
   //   member function type").
   //   Note that in `(obj.*nullable_pmf)()` the deref is *before* the call.
   if (!CE->getDirectCallee() && !isa<CXXMemberCallExpr>(CE) &&
-      isNullableOrUntracked(CE->getCallee(), State.Env)) {
+      isNullableOrUntracked(CE->getCallee(), State)) {
     return std::optional<CFGElement>(CFGStmt(CE->getCallee()));
   }
 
@@ -230,8 +246,7 @@ std::optional<CFGElement> diagnoseCallExpr(
       isa<CXXMethodDecl>(CE->getDirectCallee())) {
     Args = Args.drop_front();
   }
-  return isIncompatibleArgumentList(*CalleeFPT, Args, State.Env,
-                                    *Result.Context)
+  return isIncompatibleArgumentList(*CalleeFPT, Args, State, *Result.Context)
              ? std::optional<CFGElement>(CFGStmt(CE))
              : std::nullopt;
 }
@@ -242,7 +257,7 @@ std::optional<CFGElement> diagnoseConstructExpr(
   auto *CalleeFPT = CE->getConstructor()->getType()->getAs<FunctionProtoType>();
   if (!CalleeFPT) return std::nullopt;
   ArrayRef<const Expr *> ConstructorArgs(CE->getArgs(), CE->getNumArgs());
-  return isIncompatibleArgumentList(*CalleeFPT, ConstructorArgs, State.Env,
+  return isIncompatibleArgumentList(*CalleeFPT, ConstructorArgs, State,
                                     *Result.Context)
              ? std::optional<CFGElement>(CFGStmt(CE))
              : std::nullopt;
@@ -261,7 +276,7 @@ std::optional<CFGElement> diagnoseReturn(
   auto *ReturnExpr = RS->getRetValue();
   CHECK(ReturnExpr->getType()->isPointerType());
 
-  return isIncompatibleAssignment(ReturnType, ReturnExpr, State.Env,
+  return isIncompatibleAssignment(ReturnType, ReturnExpr, State,
                                   *Result.Context)
              ? std::optional<CFGElement>(CFGStmt(RS))
              : std::nullopt;
@@ -276,7 +291,7 @@ std::optional<CFGElement> diagnoseMemberInitializer(
     return std::nullopt;
   }
   auto MemberInitExpr = CI->getInit();
-  return isIncompatibleAssignment(MemberType, MemberInitExpr, State.Env,
+  return isIncompatibleAssignment(MemberType, MemberInitExpr, State,
                                   *Result.Context)
              ? std::optional<CFGElement>(CFGInitializer(CI))
              : std::nullopt;
@@ -304,4 +319,40 @@ auto buildDiagnoser() {
 PointerNullabilityDiagnoser::PointerNullabilityDiagnoser()
     : Diagnoser(buildDiagnoser()) {}
 
+llvm::Expected<std::vector<CFGElement>> diagnosePointerNullability(
+    const FunctionDecl &Func) {
+  ASTContext &Ctx = Func.getASTContext();
+  llvm::Expected<dataflow::ControlFlowContext> ControlFlowContext =
+      dataflow::ControlFlowContext::build(Func);
+  if (!ControlFlowContext) return ControlFlowContext.takeError();
+
+  dataflow::DataflowAnalysisContext AnalysisContext(
+      std::make_unique<dataflow::WatchedLiteralsSolver>());
+  Environment Env(AnalysisContext, Func);
+  PointerNullabilityAnalysis Analysis(Ctx);
+  PointerNullabilityDiagnoser Diagnoser;
+  std::vector<CFGElement> Diagnostics;
+  auto Result = dataflow::runDataflowAnalysis(
+      *ControlFlowContext, Analysis, Env,
+      [&](const CFGElement &Elt,
+          const dataflow::DataflowAnalysisState<PointerNullabilityLattice>
+              &State) {
+        if (auto Diag = Diagnoser.diagnose(
+                &Elt, Ctx,
+                TransferStateForDiagnostics<PointerNullabilityLattice>(
+                    State.Lattice, State.Env)))
+          Diagnostics.push_back(*Diag);
+      });
+  if (!Result) return Result.takeError();
+  return Diagnostics;
+}
+
+SourceLocation getDiagnosticLocation(const CFGElement &Element) {
+  if (auto Stmt = Element.getAs<CFGStmt>())
+    return Stmt->getStmt()->getBeginLoc();
+  if (auto Init = Element.getAs<CFGInitializer>())
+    return Init->getInitializer()->getSourceLocation();
+  return SourceLocation();
+}
+
 }  // namespace clang::tidy::nullability
@@ -6,12 +6,17 @@
 #define CRUBIT_NULLABILITY_POINTER_NULLABILITY_DIAGNOSIS_H_
 
 #include <optional>
+#include <vector>
 
 #include "nullability/pointer_nullability_lattice.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
 #include "clang/AST/Stmt.h"
+#include "clang/Analysis/CFG.h"
 #include "clang/Analysis/FlowSensitive/CFGMatchSwitch.h"
 #include "clang/Analysis/FlowSensitive/DataflowEnvironment.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/Support/Error.h"
 
 namespace clang {
 namespace tidy {
@@ -46,6 +51,16 @@ class PointerNullabilityDiagnoser {
       Diagnoser;
 };
 
+/// Runs `PointerNullabilityAnalysis` over the body of `Func`, and returns the
+/// elements that violate null safety.
+///
+/// `Func` must have a body and must not be dependent.
+llvm::Expected<std::vector<CFGElement>> diagnosePointerNullability(
+    const FunctionDecl &Func);
+
+/// Returns the location to report a diagnosed element at.
+SourceLocation getDiagnosticLocation(const CFGElement &Element);
+
 }  // namespace nullability
 }  // namespace tidy
 }  // namespace clang
@@ -5,15 +5,24 @@
 #ifndef CRUBIT_NULLABILITY_POINTER_NULLABILITY_LATTICE_H_
 #define CRUBIT_NULLABILITY_POINTER_NULLABILITY_LATTICE_H_
 
+#include <functional>
 #include <optional>
 #include <ostream>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "nullability/pointer_nullability.h"
 #include "nullability/type_nullability.h"
+#include "clang/AST/Decl.h"
 #include "clang/AST/Expr.h"
+#include "clang/AST/TemplateBase.h"
+#include "clang/AST/Type.h"
+#include "clang/Analysis/FlowSensitive/Arena.h"
 #include "clang/Analysis/FlowSensitive/DataflowAnalysisContext.h"
 #include "clang/Analysis/FlowSensitive/DataflowLattice.h"
+#include "clang/Analysis/FlowSensitive/Formula.h"
+#include "clang/Basic/Specifiers.h"
 
 namespace clang::tidy::nullability {
 
@@ -27,6 +36,26 @@ class PointerNullabilityLattice {
     // and take precedence over the declared type.
     absl::flat_hash_map<const ValueDecl *, PointerTypeNullability>
         DeclTopLevelNullability;
+    // Decls whose nullability variables are only created on first use.
+    // Set by PointerNullabilityAnalysis::assignNullabilityVariableOnFirstUse.
+    absl::flat_hash_set<const ValueDecl *> LazyNullabilityVariables;
+    // The number of SAT atoms created by the nullability analysis itself (not
+    // by the framework), as a measure of the cost of the analysis.
+    unsigned AtomsCreated = 0;
+    // Overridden concrete nullability of the values returned by calls to
+    // functions. This is set by
+    // PointerNullabilityAnalysis::assignReturnNullabilityOverride, and takes
+    // precedence over the declared return type.
+    std::function<std::optional<NullabilityKind>(const FunctionDecl &)>
+        ReturnNullabilityOverride;
+    // Memoizes the nullability of types, possibly across analysis runs.
+    TypeNullabilityCache *TypeCache = nullptr;
+    // Memoizes flow condition queries made by the analysis and diagnoser.
+    ImplicationCache Implications;
+    // Assumed by the diagnoser when checking null-safety, so that code
+    // analyzed with symbolic nullability (see assignNullabilityVariable) can
+    // be checked as if the symbols had their declared nullability.
+    const dataflow::Formula *DiagnosisAssumptions = nullptr;
   };
 
   PointerNullabilityLattice(NonFlowSensitiveState &NFS) : NFS(NFS) {}
@@ -62,6 +91,59 @@ class PointerNullabilityLattice {
     return &It->second;
   }
 
+  // Like getDeclNullability, but first creates D's nullability variable if it
+  // was only assigned to be created on first use.
+  const PointerTypeNullability *getOrCreateDeclNullability(const ValueDecl *D,
+                                                           dataflow::Arena &A) {
+    if (NFS.LazyNullabilityVariables.erase(D)) {
+      NFS.DeclTopLevelNullability.try_emplace(
+          D, PointerTypeNullability::createSymbolic(A));
+      NFS.AtomsCreated += 2;
+    }
+    return getDeclNullability(D);
+  }
+
+  // Returns the cache to use for flow condition queries about this lattice's
+  // environments.
+  ImplicationCache &implications() const { return NFS.Implications; }
+
+  // Returns the constraints the diagnoser should assume, if any.
+  const dataflow::Formula *getDiagnosisAssumptions() const {
+    return NFS.DiagnosisAssumptions;
+  }
+
+  // Returns getNullabilityAnnotationsFromType(T), memoized if the analysis has
+  // a TypeNullabilityCache.
+  TypeNullability getTypeNullability(QualType T) const {
+    if (NFS.TypeCache) return NFS.TypeCache->get(T);
+    return getNullabilityAnnotationsFromType(T);
+  }
+
+  // Returns countPointersInType(...), memoized if the analysis has a
+  // TypeNullabilityCache.
+  unsigned countPointersInType(const Expr *E) const {
+    if (NFS.TypeCache) return NFS.TypeCache->countPointers(E);
+    return nullability::countPointersInType(E);
+  }
+  unsigned countPointersInType(TemplateArgument TA) const {
+    if (NFS.TypeCache) return NFS.TypeCache->countPointers(TA);
+    return nullability::countPointersInType(TA);
+  }
+
+  // Returns unspecifiedNullability(E), using the memoized pointer count.
+  TypeNullability unspecifiedNullability(const Expr *E) const {
+    return TypeNullability(countPointersInType(E),
+                           NullabilityKind::Unspecified);
+  }
+
+  // Returns the overridden top-level nullability of values returned by calls
+  // to FD, if any.
+  std::optional<NullabilityKind> getReturnNullabilityOverride(
+      const FunctionDecl &FD) const {
+    if (!NFS.ReturnNullabilityOverride) return std::nullopt;
+    return NFS.ReturnNullabilityOverride(FD);
+  }
+
   bool operator==(const PointerNullabilityLattice &Other) const { return true; }
 
   dataflow::LatticeJoinEffect join(const PointerNullabilityLattice &Other) {
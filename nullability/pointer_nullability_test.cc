@@ -53,6 +53,23 @@ TEST_F(NullabilityPropertiesTest, Test) {
       isNullable(makePointer(/*FromNullable=*/False2, /*Null=*/True), Env));
 }
 
+TEST_F(NullabilityPropertiesTest, ImplicationCache) {
+  ImplicationCache Cache;
+  auto &X = Env.makeAtomicBoolValue().formula();
+  EXPECT_FALSE(Cache.flowConditionImplies(Env, X));
+  // Failures aren't cached: the flow condition may become stronger.
+  Env.addToFlowCondition(X);
+  EXPECT_TRUE(Cache.flowConditionImplies(Env, X));
+  EXPECT_TRUE(Cache.flowConditionImplies(Env, X));
+  EXPECT_FALSE(Cache.flowConditionImplies(Env, DACtx.arena().makeNot(X)));
+
+  auto &FromNullable = Env.makeAtomicBoolValue().formula();
+  auto &Null = Env.makeAtomicBoolValue().formula();
+  EXPECT_EQ(getNullability(makePointer(FromNullable, Null), Env,
+                           /*AdditionalConstraints=*/nullptr, &Cache),
+            NullabilityKind::Nullable);
+}
+
 TEST_F(NullabilityPropertiesTest, IsNullableAdditionalConstraints) {
   auto &FromNullable = Env.makeAtomicBoolValue().formula();
   auto &Null = Env.makeAtomicBoolValue().formula();
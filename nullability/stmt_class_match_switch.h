@@ -0,0 +1,118 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_NULLABILITY_STMT_CLASS_MATCH_SWITCH_H_
+#define CRUBIT_NULLABILITY_STMT_CLASS_MATCH_SWITCH_H_
+
+#include <functional>
+#include <optional>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Stmt.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/ASTMatchers/ASTMatchersInternal.h"
+#include "clang/Analysis/CFG.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/Support/Casting.h"
+
+namespace clang::tidy::nullability {
+
+/// Like a `dataflow::CFGMatchSwitch` over `CFGStmt` elements, but keyed by
+/// `Stmt::StmtClass`.
+///
+/// A `CFGMatchSwitch` tries the matchers of all its cases, in order, on every
+/// CFG element. Here every case also names the statement type `CandidateT` it
+/// can apply to, so that an element is only matched against the cases whose
+/// `CandidateT` its class derives from. The candidates for each class are
+/// computed the first time the class is seen. Cases without a matcher apply to
+/// every statement of type `CandidateT`, and don't run any matcher at all.
+///
+/// As for `CFGMatchSwitch`, only the first case that matches is applied.
+template <typename State>
+class StmtClassMatchSwitch {
+ public:
+  /// Applies `A` to statements of type `CandidateT` which match `M`.
+  template <typename CandidateT, typename NodeT>
+  StmtClassMatchSwitch &&CaseOfCFGStmt(
+      ast_matchers::internal::Matcher<Stmt> M,
+      void (*A)(const NodeT *, const ast_matchers::MatchFinder::MatchResult &,
+                State &)) && {
+    static_assert(std::is_base_of_v<NodeT, CandidateT>);
+    Cases.push_back({[](const Stmt &S) { return llvm::isa<CandidateT>(S); },
+                     std::move(M),
+                     [A](const Stmt &S, const ast_matchers::BoundNodes *Nodes,
+                         ASTContext &Ctx, State &St) {
+                       A(llvm::cast<NodeT>(&S),
+                         ast_matchers::MatchFinder::MatchResult(*Nodes, &Ctx),
+                         St);
+                     }});
+    return std::move(*this);
+  }
+
+  /// Applies `A` to all statements of type `CandidateT`.
+  template <typename CandidateT>
+  StmtClassMatchSwitch &&CaseOfCFGStmt(void (*A)(const CandidateT *,
+                                                 State &)) && {
+    Cases.push_back({[](const Stmt &S) { return llvm::isa<CandidateT>(S); },
+                     std::nullopt,
+                     [A](const Stmt &S, const ast_matchers::BoundNodes *,
+                         ASTContext &, State &St) {
+                       A(llvm::cast<CandidateT>(&S), St);
+                     }});
+    return std::move(*this);
+  }
+
+  void operator()(const CFGElement &Elt, ASTContext &Ctx, State &St) {
+    auto CS = Elt.getAs<CFGStmt>();
+    if (!CS) return;
+    const Stmt &S = *CS->getStmt();
+    for (unsigned I : candidates(S)) {
+      const Case &C = Cases[I];
+      if (!C.Matcher) {
+        C.Apply(S, nullptr, Ctx, St);
+        return;
+      }
+      auto Nodes = ast_matchers::match(
+          ast_matchers::traverse(TK_AsIs, *C.Matcher), S, Ctx);
+      if (!Nodes.empty()) {
+        C.Apply(S, &Nodes.front(), Ctx, St);
+        return;
+      }
+    }
+  }
+
+ private:
+  struct Case {
+    bool (*IsCandidate)(const Stmt &);
+    // If empty, the case applies to every candidate.
+    std::optional<ast_matchers::internal::Matcher<Stmt>> Matcher;
+    std::function<void(const Stmt &, const ast_matchers::BoundNodes *,
+                       ASTContext &, State &)>
+        Apply;
+  };
+
+  // Returns the indices in `Cases` of the cases that may apply to `S`.
+  const llvm::SmallVector<unsigned, 2> &candidates(const Stmt &S) {
+    if (ByClass.empty()) ByClass.resize(Stmt::lastStmtConstant + 1);
+    auto &Candidates = ByClass[S.getStmtClass()];
+    if (!Candidates) {
+      Candidates.emplace();
+      for (unsigned I = 0; I < Cases.size(); ++I)
+        if (Cases[I].IsCandidate(S)) Candidates->push_back(I);
+    }
+    return *Candidates;
+  }
+
+  std::vector<Case> Cases;
+  // Indexed by `Stmt::StmtClass`. Allocated on first use.
+  std::vector<std::optional<llvm::SmallVector<unsigned, 2>>> ByClass;
+};
+
+}  // namespace clang::tidy::nullability
+
+#endif  // CRUBIT_NULLABILITY_STMT_CLASS_MATCH_SWITCH_H_
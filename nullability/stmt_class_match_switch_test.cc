@@ -0,0 +1,100 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "nullability/stmt_class_match_switch.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/log/check.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/Expr.h"
+#include "clang/ASTMatchers/ASTMatchFinder.h"
+#include "clang/ASTMatchers/ASTMatchers.h"
+#include "clang/Analysis/CFG.h"
+#include "clang/Testing/TestAST.h"
+#include "llvm/ADT/StringRef.h"
+#include "third_party/llvm/llvm-project/third-party/unittest/googlemock/include/gmock/gmock.h"
+#include "third_party/llvm/llvm-project/third-party/unittest/googletest/include/gtest/gtest.h"
+
+namespace clang::tidy::nullability {
+namespace {
+using ast_matchers::MatchFinder;
+using testing::ElementsAre;
+
+using Log = std::vector<std::string>;
+
+void logCall(const CallExpr *, Log &L) { L.push_back("call"); }
+void logDeclRef(const DeclRefExpr *DRE, Log &L) {
+  L.push_back(("ref " + DRE->getDecl()->getName()).str());
+}
+void logPointer(const Expr *, const MatchFinder::MatchResult &, Log &L) {
+  L.push_back("pointer");
+}
+void logCast(const Expr *, const MatchFinder::MatchResult &, Log &L) {
+  L.push_back("cast");
+}
+
+// Runs `Switch` on the CFG elements of the body of `target`, which must have
+// no branches.
+Log run(llvm::StringRef Code, StmtClassMatchSwitch<Log> &Switch) {
+  TestAST AST(Code);
+  auto Lookup = AST.context().getTranslationUnitDecl()->lookup(
+      &AST.context().Idents.get("target"));
+  CHECK(Lookup.isSingleResult());
+  const auto *Target = Lookup.find_first<FunctionDecl>();
+  CFG::BuildOptions Options;
+  Options.setAllAlwaysAdd();
+  auto CFG =
+      CFG::buildCFG(Target, Target->getBody(), &AST.context(), Options);
+  CHECK(CFG);
+  Log L;
+  for (const CFGBlock *Block : *CFG)
+    for (const CFGElement &Elt : *Block) Switch(Elt, AST.context(), L);
+  return L;
+}
+
+TEST(StmtClassMatchSwitchTest, AppliesFirstMatchingCase) {
+  auto Switch =
+      StmtClassMatchSwitch<Log>()
+          .CaseOfCFGStmt<DeclRefExpr>(logDeclRef)
+          .CaseOfCFGStmt<ImplicitCastExpr>(
+              ast_matchers::implicitCastExpr(
+                  ast_matchers::hasCastKind(CK_LValueToRValue)),
+              logCast)
+          .CaseOfCFGStmt<Expr>(
+              ast_matchers::expr(ast_matchers::hasType(
+                  ast_matchers::isAnyPointer())),
+              logPointer)
+          .CaseOfCFGStmt<CallExpr>(logCall);
+  // The load of `p` is logged as a cast, not as a pointer.
+  // The call is logged as a pointer: it returns one, and the pointer case comes
+  // first. So is the decay of `f` to a function pointer.
+  EXPECT_THAT(run(R"cc(
+                int *f();
+                void target(int *p) {
+                  int *q = p;
+                  f();
+                }
+              )cc",
+                  Switch),
+              ElementsAre("ref p", "cast", "ref f", "pointer", "pointer"));
+}
+
+TEST(StmtClassMatchSwitchTest, IgnoresOtherClasses) {
+  auto Switch = StmtClassMatchSwitch<Log>().CaseOfCFGStmt<CallExpr>(logCall);
+  EXPECT_THAT(run(R"cc(
+                void f(int);
+                void target(int i) {
+                  i + 1;
+                  f(i);
+                }
+              )cc",
+                  Switch),
+              ElementsAre("call"));
+}
+
+}  // namespace
+}  // namespace clang::tidy::nullability
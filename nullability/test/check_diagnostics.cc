@@ -7,6 +7,7 @@
 #include "nullability/pointer_nullability_analysis.h"
 #include "nullability/pointer_nullability_diagnosis.h"
 #include "clang/Analysis/CFG.h"
+#include "clang/Basic/SourceLocation.h"
 #include "third_party/llvm/llvm-project/clang/unittests/Analysis/FlowSensitive/TestingSupport.h"
 #include "llvm/Testing/Support/Error.h"
 #include "third_party/llvm/llvm-project/third-party/unittest/googletest/include/gtest/gtest.h"
@@ -74,13 +75,9 @@ bool checkDiagnostics(llvm::StringRef SourceCode) {
             }
             auto &SrcMgr = AnalysisData.ASTCtx.getSourceManager();
             for (auto Element : Diagnostics) {
-              if (std::optional<CFGStmt> stmt = Element.getAs<CFGStmt>()) {
-                ActualLines.insert(SrcMgr.getPresumedLineNumber(
-                    stmt->getStmt()->getBeginLoc()));
-              } else if (std::optional<CFGInitializer> init =
-                             Element.getAs<CFGInitializer>()) {
-                ActualLines.insert(SrcMgr.getPresumedLineNumber(
-                    init->getInitializer()->getSourceLocation()));
+              SourceLocation Loc = getDiagnosticLocation(Element);
+              if (Loc.isValid()) {
+                ActualLines.insert(SrcMgr.getPresumedLineNumber(Loc));
               } else {
                 ADD_FAILURE() << "this code should not be reached";
               }
@@ -474,6 +474,33 @@ TypeNullability getNullabilityAnnotationsFromType(
   return std::move(AnnotationVisitor.Annotations);
 }
 
+const TypeNullability &TypeNullabilityCache::get(QualType T) {
+  if (auto It = Cache.find(T); It != Cache.end()) return It->second;
+  if (Cache.size() >= MaxEntries) Cache.clear();
+  return Cache.try_emplace(T, getNullabilityAnnotationsFromType(T))
+      .first->second;
+}
+
+unsigned TypeNullabilityCache::countPointers(QualType T) {
+  const Type *Canonical = T.getCanonicalType().getTypePtr();
+  if (auto It = PointerCounts.find(Canonical); It != PointerCounts.end())
+    return It->second;
+  if (PointerCounts.size() >= MaxEntries) PointerCounts.clear();
+  unsigned Count = countPointersInType(QualType(Canonical, 0));
+  PointerCounts.try_emplace(Canonical, Count);
+  return Count;
+}
+
+unsigned TypeNullabilityCache::countPointers(const Expr *E) {
+  return countPointers(exprType(E));
+}
+
+unsigned TypeNullabilityCache::countPointers(TemplateArgument TA) {
+  if (TA.getKind() == TemplateArgument::Type)
+    return countPointers(TA.getAsType());
+  return countPointersInType(TA);
+}
+
 TypeNullability unspecifiedNullability(const Expr *E) {
   return TypeNullability(countPointersInType(E), NullabilityKind::Unspecified);
 }
@@ -36,6 +36,7 @@
 #include "clang/Analysis/FlowSensitive/Formula.h"
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/Specifiers.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace clang::tidy::nullability {
 
@@ -135,6 +136,35 @@ TypeNullability getNullabilityAnnotationsFromType(
     QualType T,
     llvm::function_ref<GetTypeParamNullability> SubstituteTypeParam = nullptr);
 
+/// Memoizes getNullabilityAnnotationsFromType() (without substitutions) and
+/// countPointersInType(), for the types of one ASTContext. A cache can be
+/// shared by the analyses of all functions in a translation unit, which mostly
+/// use the same few types.
+///
+/// Sugar carries the annotations, so nullability entries are keyed by the type
+/// as written rather than its canonical type. Pointer counts only depend on
+/// the canonical type. The cache is bounded: each kind of entry is cleared
+/// once it holds MaxEntries types.
+class TypeNullabilityCache {
+ public:
+  explicit TypeNullabilityCache(unsigned MaxEntries = 1 << 16)
+      : MaxEntries(MaxEntries) {}
+
+  /// Returns getNullabilityAnnotationsFromType(T).
+  /// The reference is only valid until the next call.
+  const TypeNullability &get(QualType T);
+
+  /// Returns countPointersInType(T).
+  unsigned countPointers(QualType T);
+  unsigned countPointers(const Expr *E);
+  unsigned countPointers(TemplateArgument TA);
+
+ private:
+  llvm::DenseMap<QualType, TypeNullability> Cache;
+  llvm::DenseMap<const Type *, unsigned> PointerCounts;
+  unsigned MaxEntries;
+};
+
 /// Prints QualType's underlying canonical type, annotated with nullability.
 /// See rebuildWithNullability().
 std::string printWithNullability(QualType, const TypeNullability &,
@@ -419,6 +419,47 @@ TEST_F(GetNullabilityAnnotationsFromTypeTest, AnnotateNullable) {
               ElementsAre(NullabilityKind::NonNull));
 }
 
+TEST(TypeNullabilityCacheTest, MatchesUncached) {
+  clang::TestAST AST(R"cpp(
+    using A = int *_Nullable;
+    using B = int *_Nonnull *;
+  )cpp");
+  auto Lookup = [&](llvm::StringRef Name) {
+    auto Result = AST.context().getTranslationUnitDecl()->lookup(
+        &AST.context().Idents.get(Name));
+    CHECK(Result.isSingleResult());
+    return AST.context().getTypedefType(Result.find_first<TypeAliasDecl>());
+  };
+  QualType A = Lookup("A"), B = Lookup("B");
+
+  TypeNullabilityCache Cache(/*MaxEntries=*/1);
+  EXPECT_EQ(Cache.get(A), getNullabilityAnnotationsFromType(A));
+  EXPECT_EQ(Cache.get(A), getNullabilityAnnotationsFromType(A));
+  // Evicts A.
+  EXPECT_EQ(Cache.get(B), getNullabilityAnnotationsFromType(B));
+  EXPECT_EQ(Cache.get(A), getNullabilityAnnotationsFromType(A));
+}
+
+TEST(TypeNullabilityCacheTest, CountPointers) {
+  clang::TestAST AST(R"cpp(
+    template <class T> struct S {};
+    using A = S<int *_Nullable *>;
+    using B = S<int **>;
+  )cpp");
+  auto Lookup = [&](llvm::StringRef Name) {
+    auto Result = AST.context().getTranslationUnitDecl()->lookup(
+        &AST.context().Idents.get(Name));
+    CHECK(Result.isSingleResult());
+    return AST.context().getTypedefType(Result.find_first<TypeAliasDecl>());
+  };
+
+  TypeNullabilityCache Cache;
+  EXPECT_EQ(Cache.countPointers(Lookup("A")), 2);
+  // Same canonical type, so the count is shared.
+  EXPECT_EQ(Cache.countPointers(Lookup("B")), 2);
+  EXPECT_EQ(Cache.countPointers(AST.context().IntTy), 0);
+}
+
 class PrintWithNullabilityTest : public ::testing::Test {
  protected:
   // C++ declarations prepended before parsing type in nullVec().
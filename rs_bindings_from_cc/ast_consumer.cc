@@ -4,13 +4,84 @@
 
 #include "rs_bindings_from_cc/ast_consumer.h"
 
+#include <memory>
+#include <string>
+#include <utility>
+#include <variant>
+#include <vector>
+
 #include "absl/log/check.h"
+#include "lifetime_analysis/analyze.h"
+#include "lifetime_annotations/function_lifetimes.h"
+#include "lifetime_annotations/lifetime_summaries.h"
+#include "nullability/inference/infer_tu.h"
+#include "nullability/inference/inference.proto.h"
+#include "nullability/inference/inference_table.h"
 #include "rs_bindings_from_cc/importer.h"
+#include "rs_bindings_from_cc/timing_report.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/Frontend/CompilerInstance.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace crubit {
 
+namespace {
+
+// Infers the nullability of the functions of the current target into a table,
+// so that the importer can look it up like a table read from a file. The code
+// of other targets isn't walked: its bindings are generated elsewhere.
+void InferNullability(clang::ASTContext& ast_context, Invocation& invocation,
+                      const ImportContext& importer) {
+  TimingReport::Phase phase(invocation.timing_report_, "nullability_inference");
+  std::vector<clang::tidy::nullability::Inference> inferences =
+      clang::tidy::nullability::inferTU(
+          ast_context, /*MaxRounds=*/1, /*Budget=*/{},
+          [&importer](const clang::Decl& decl) {
+            return importer.IsFromCurrentTarget(&decl);
+          });
+  std::string table;
+  llvm::raw_string_ostream os(table);
+  clang::tidy::nullability::writeInferenceTable(inferences, os);
+  os.flush();
+  llvm::Expected<clang::tidy::nullability::InferenceTable> inferred =
+      clang::tidy::nullability::InferenceTable::fromBuffer(
+          llvm::MemoryBuffer::getMemBufferCopy(table));
+  // The table was just written, so it can only fail to open because of a bug.
+  CHECK(inferred) << llvm::toString(inferred.takeError());
+  invocation.inferred_nullability_ = std::move(*inferred);
+  invocation.nullability_inferences_ = &*invocation.inferred_nullability_;
+}
+
+// Analyzes the lifetimes of the functions defined in `ast_context`, and adds
+// them to the summaries the importer falls back to. Summaries that were
+// already there (e.g. from a whole-codebase analysis) take precedence.
+void InferLifetimes(clang::ASTContext& ast_context, Invocation& invocation) {
+  TimingReport::Phase phase(invocation.timing_report_, "lifetime_analysis");
+  auto summaries =
+      std::make_shared<clang::tidy::lifetimes::LifetimeSummaries>();
+  if (invocation.lifetime_context_->summaries != nullptr) {
+    summaries->Merge(*invocation.lifetime_context_->summaries);
+  }
+  for (const auto& [func, result] :
+       clang::tidy::lifetimes::AnalyzeTranslationUnit(
+           ast_context.getTranslationUnitDecl(),
+           *invocation.lifetime_context_)) {
+    const auto* lifetimes =
+        std::get_if<clang::tidy::lifetimes::FunctionLifetimes>(&result);
+    if (lifetimes == nullptr) continue;
+    // Lifetimes that can't be summarized, e.g. because they have a local
+    // lifetime, can't be expressed in the bindings either.
+    if (llvm::Error err = summaries->Add(func, *lifetimes)) {
+      llvm::consumeError(std::move(err));
+    }
+  }
+  invocation.lifetime_context_->summaries = std::move(summaries);
+}
+
+}  // namespace
+
 void AstConsumer::HandleTranslationUnit(clang::ASTContext& ast_context) {
   if (ast_context.getDiagnostics().hasErrorOccurred()) {
     // We do not need to process partially incorrect headers, we assume all
@@ -21,6 +92,14 @@ void AstConsumer::HandleTranslationUnit(clang::ASTContext& ast_context) {
   }
   CHECK(instance_.hasSema());
   Importer importer(invocation_, ast_context, instance_.getSema());
+  // The analyses run on the same AST as the importer, so that their results
+  // don't have to go through files or a separate parse of the headers.
+  if (invocation_.infer_nullability_) {
+    InferNullability(ast_context, invocation_, importer);
+  }
+  if (invocation_.infer_lifetimes_) {
+    InferLifetimes(ast_context, invocation_);
+  }
   importer.Import(ast_context.getTranslationUnitDecl());
 }
 
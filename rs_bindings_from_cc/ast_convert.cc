@@ -7,6 +7,7 @@
 #include "absl/functional/function_ref.h"
 #include "absl/log/check.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
 #include "clang/Basic/LLVM.h"
@@ -65,10 +66,58 @@ bool HasNoUserProvidedSpecialMember(
   return record->forallBases(nonrecursive_has_only_defaulted);
 }
 
+// Returns true if `decl` (a special member function of `record`) is defaulted
+// on a later declaration (e.g. `S::S(const S&) = default;` out of line), and
+// would be trivial if it had been defaulted on its first declaration instead.
+//
+// Defaulting out of line makes a special member user-provided, and so
+// non-trivial as far as the language (and the ABI) is concerned, even though
+// it does nothing more than its trivial counterpart would.
+//
+// Args:
+//   record: the class/struct that declares `decl`.
+//   decl: the special member function of `record` in question.
+//   has_trivial: a function which returns true if the special member function
+//       in question is trivial for a base class or a field type.
+bool IsTrivialInPractice(
+    const clang::CXXRecordDecl& record, const clang::CXXMethodDecl& decl,
+    absl::FunctionRef<bool(const clang::CXXRecordDecl&)> has_trivial) {
+  // The definition needs to be visible: a special member defaulted in a `.cc`
+  // file can't be told apart from one with a user-written body.
+  const clang::FunctionDecl* definition = nullptr;
+  if (decl.isVirtual() || !decl.isDefined(definition) ||
+      !definition->isExplicitlyDefaulted()) {
+    return false;
+  }
+  if (record.isPolymorphic() || record.getNumVBases() != 0) {
+    return false;
+  }
+  for (const clang::CXXBaseSpecifier& base : record.bases()) {
+    const clang::CXXRecordDecl* base_decl =
+        base.getType()->getAsCXXRecordDecl();
+    if (base_decl == nullptr || !has_trivial(*base_decl)) {
+      return false;
+    }
+  }
+  const clang::ASTContext& ast_context = record.getASTContext();
+  for (const clang::FieldDecl* field : record.fields()) {
+    clang::QualType type = ast_context.getBaseElementType(field->getType());
+    if (type.isVolatileQualified()) {
+      return false;
+    }
+    const clang::CXXRecordDecl* field_decl = type->getAsCXXRecordDecl();
+    if (field_decl != nullptr && !has_trivial(*field_decl)) {
+      return false;
+    }
+  }
+  return true;
+}
+
 SpecialMemberFunc GetSpecialMemberFunc(
     const clang::RecordDecl& record_decl,
     absl::FunctionRef<const clang::CXXMethodDecl*(const clang::CXXRecordDecl*)>
-        getter) {
+        getter,
+    absl::FunctionRef<bool(const clang::CXXRecordDecl&)> has_trivial) {
   const auto* cxx_record_decl =
       clang::dyn_cast<clang::CXXRecordDecl>(&record_decl);
   if (cxx_record_decl == nullptr) {
@@ -95,7 +144,8 @@ SpecialMemberFunc GetSpecialMemberFunc(
 
   if (decl->isDeleted()) {
     return SpecialMemberFunc::kUnavailable;
-  } else if (decl->isTrivial()) {
+  } else if (decl->isTrivial() ||
+             IsTrivialInPractice(*cxx_record_decl, *decl, has_trivial)) {
     return SpecialMemberFunc::kTrivial;
   } else if (HasNoUserProvidedSpecialMember(cxx_record_decl, getter)) {
     return SpecialMemberFunc::kNontrivialMembers;
@@ -108,18 +158,31 @@ SpecialMemberFunc GetSpecialMemberFunc(
 
 SpecialMemberFunc GetCopyCtorSpecialMemberFunc(
     const clang::RecordDecl& record_decl) {
-  return GetSpecialMemberFunc(record_decl, &GetCopyCtor);
+  return GetSpecialMemberFunc(record_decl, &GetCopyCtor,
+                              [](const clang::CXXRecordDecl& record) {
+                                return record.hasTrivialCopyConstructor();
+                              });
 }
 
 SpecialMemberFunc GetMoveCtorSpecialMemberFunc(
     const clang::RecordDecl& record_decl) {
-  return GetSpecialMemberFunc(record_decl, &GetMoveCtor);
+  // Members without a move constructor (e.g. because they declare a copy
+  // constructor) are moved with their copy constructor.
+  return GetSpecialMemberFunc(
+      record_decl, &GetMoveCtor, [](const clang::CXXRecordDecl& record) {
+        return record.hasTrivialMoveConstructor() ||
+               (!record.hasMoveConstructor() &&
+                record.hasTrivialCopyConstructor());
+      });
 }
 
 SpecialMemberFunc GetDestructorSpecialMemberFunc(
     const clang::RecordDecl& record_decl) {
-  return GetSpecialMemberFunc(record_decl,
-                              [](auto c) { return c->getDestructor(); });
+  return GetSpecialMemberFunc(
+      record_decl, [](auto c) { return c->getDestructor(); },
+      [](const clang::CXXRecordDecl& record) {
+        return record.hasTrivialDestructor();
+      });
 }
 
 }  // namespace crubit
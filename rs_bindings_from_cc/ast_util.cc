@@ -4,26 +4,53 @@
 
 #include "rs_bindings_from_cc/ast_util.h"
 
+#include <string>
+
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclBase.h"
 #include "clang/AST/DeclTemplate.h"
+#include "clang/AST/PrettyPrinter.h"
+#include "clang/AST/Type.h"
 #include "clang/Basic/LLVM.h"
 
 namespace crubit {
 
 bool IsFullClassTemplateSpecializationOrChild(const clang::Decl* decl) {
-  if (clang::isa<clang::ClassTemplatePartialSpecializationDecl>(decl)) {
-    return false;
-  }
-  if (clang::isa<clang::ClassTemplateSpecializationDecl>(decl)) {
-    return true;
-  }
+  return GetFullClassTemplateSpecializationOrParent(decl) != nullptr;
+}
 
-  if (const auto* decl_context = decl->getDeclContext()) {
-    return IsFullClassTemplateSpecializationOrChild(
-        clang::dyn_cast<clang::Decl>(decl_context));
+const clang::ClassTemplateSpecializationDecl*
+GetFullClassTemplateSpecializationOrParent(const clang::Decl* decl) {
+  while (decl != nullptr) {
+    if (clang::isa<clang::ClassTemplatePartialSpecializationDecl>(decl)) {
+      return nullptr;
+    }
+    if (const auto* specialization_decl =
+            clang::dyn_cast<clang::ClassTemplateSpecializationDecl>(decl)) {
+      return specialization_decl;
+    }
+    decl = clang::dyn_cast_or_null<clang::Decl>(decl->getDeclContext());
   }
+  return nullptr;
+}
+
+std::string GetClassTemplateSpecializationCcName(
+    const clang::ASTContext& ast_context,
+    const clang::ClassTemplateSpecializationDecl* specialization_decl,
+    bool use_preferred_names) {
+  clang::PrintingPolicy policy(ast_context.getLangOpts());
+  policy.IncludeTagDefinition = false;
+  // Canonicalize types -- in particular, the template parameter types must be
+  // desugared out of an `ElaboratedType` so that their namespaces are written
+  // down.
+  policy.PrintCanonicalTypes = true;
+  policy.UsePreferredNames = use_preferred_names;
+  // Use type suffix (e.g. `123u` rather than just `123`) to avoid the
+  // `-Wimplicitly-unsigned-literal` warning.  See also b/244616557.
+  policy.AlwaysIncludeTypeForTemplateArgument = true;
 
-  return false;
+  return clang::QualType(specialization_decl->getTypeForDecl(), 0)
+      .getAsString(policy);
 }
 
 }  // namespace crubit
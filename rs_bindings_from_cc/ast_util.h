@@ -5,7 +5,11 @@
 #ifndef CRUBIT_RS_BINDINGS_FROM_CC_AST_UTIL_H_
 #define CRUBIT_RS_BINDINGS_FROM_CC_AST_UTIL_H_
 
+#include <string>
+
+#include "clang/AST/ASTContext.h"
 #include "clang/AST/DeclBase.h"
+#include "clang/AST/DeclTemplate.h"
 
 namespace crubit {
 
@@ -14,6 +18,22 @@ namespace crubit {
 // function decl) nested inside a ClassTemplateSpecializationDecl.
 bool IsFullClassTemplateSpecializationOrChild(const clang::Decl* decl);
 
+// Returns `decl` if it is a ClassTemplateSpecializationDecl (but not a
+// ClassTemplatePartialSpecializationDecl), or else the innermost one `decl`
+// is nested inside, or null if there is none.
+const clang::ClassTemplateSpecializationDecl*
+GetFullClassTemplateSpecializationOrParent(const clang::Decl* decl);
+
+// Returns the C++ name of `specialization_decl`, with its template arguments
+// canonicalized, e.g. `std::vector<int, std::allocator<int>>`.
+//
+// If `use_preferred_names` is true, preferred names are used, e.g.
+// `std::string_view` instead of `std::basic_string_view<char>`.
+std::string GetClassTemplateSpecializationCcName(
+    const clang::ASTContext& ast_context,
+    const clang::ClassTemplateSpecializationDecl* specialization_decl,
+    bool use_preferred_names);
+
 }  // namespace crubit
 
 #endif  // CRUBIT_RS_BINDINGS_FROM_CC_AST_UTIL_H_
@@ -0,0 +1,75 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/batch.h"
+
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <thread>  // NOLINT(build/c++11)
+#include <utility>
+#include <vector>
+
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+
+namespace crubit {
+
+namespace {
+
+struct BatchTarget {
+  std::vector<std::string> arguments;
+};
+
+bool fromJSON(const llvm::json::Value& json, BatchTarget& out,
+              llvm::json::Path path) {
+  llvm::json::ObjectMapper mapper(json, path);
+  return mapper && mapper.map("arguments", out.arguments);
+}
+
+}  // namespace
+
+absl::StatusOr<std::vector<std::vector<std::string>>> ParseBatchManifest(
+    absl::string_view manifest) {
+  llvm::Expected<std::vector<BatchTarget>> targets =
+      llvm::json::parse<std::vector<BatchTarget>>(
+          llvm::StringRef(manifest.data(), manifest.size()));
+  if (!targets) {
+    return absl::InvalidArgumentError(absl::StrCat(
+        "Invalid batch manifest: ", llvm::toString(targets.takeError())));
+  }
+  std::vector<std::vector<std::string>> arguments;
+  arguments.reserve(targets->size());
+  for (BatchTarget& target : *targets) {
+    arguments.push_back(std::move(target.arguments));
+  }
+  return arguments;
+}
+
+std::vector<absl::Status> RunInParallel(
+    int count, int threads, absl::FunctionRef<absl::Status(int)> run) {
+  std::vector<absl::Status> statuses(count);
+  // Items are handed out one at a time, since their costs vary widely.
+  std::atomic<int> next_item = 0;
+  auto work = [&] {
+    for (int i = next_item++; i < count; i = next_item++) {
+      statuses[i] = run(i);
+    }
+  };
+  std::vector<std::thread> workers;
+  for (int i = 1; i < std::min(threads, count); ++i) {
+    workers.emplace_back(work);
+  }
+  work();
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+  return statuses;
+}
+
+}  // namespace crubit
@@ -0,0 +1,39 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_BATCH_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_BATCH_H_
+
+#include <string>
+#include <vector>
+
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+
+namespace crubit {
+
+// Parses the contents of a `--batch_manifest` file: a JSON array with one
+// object per target, holding the same arguments as a one-shot invocation of
+// the tool (other than argv[0]), like a persistent worker's work requests:
+//
+//   [
+//     {"arguments": ["--target=//foo:bar", "--public_headers=foo/bar.h", ...]},
+//     ...
+//   ]
+//
+// Returns the arguments of each target.
+absl::StatusOr<std::vector<std::vector<std::string>>> ParseBatchManifest(
+    absl::string_view manifest);
+
+// Calls `run(i)` for every `i` in `[0, count)`, on up to `threads` threads, and
+// returns the statuses in the order of `i`. `run` is called on at most one
+// thread when `threads` is 1, and must be thread-safe otherwise.
+std::vector<absl::Status> RunInParallel(
+    int count, int threads, absl::FunctionRef<absl::Status(int)> run);
+
+}  // namespace crubit
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_BATCH_H_
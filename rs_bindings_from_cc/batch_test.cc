@@ -0,0 +1,73 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/batch.h"
+
+#include <atomic>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/status/status.h"
+#include "common/status_test_matchers.h"
+
+namespace crubit {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::IsEmpty;
+
+TEST(BatchTest, ParseBatchManifest) {
+  EXPECT_THAT(ParseBatchManifest(R"([
+                {"arguments": ["--target=//foo:bar", "-I."]},
+                {"arguments": []}
+              ])"),
+              IsOkAndHolds(ElementsAre(ElementsAre("--target=//foo:bar", "-I."),
+                                       IsEmpty())));
+}
+
+TEST(BatchTest, ParseEmptyBatchManifest) {
+  EXPECT_THAT(ParseBatchManifest("[]"), IsOkAndHolds(IsEmpty()));
+}
+
+TEST(BatchTest, ParseInvalidBatchManifest) {
+  EXPECT_THAT(ParseBatchManifest("not json"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid batch manifest")));
+  EXPECT_THAT(ParseBatchManifest(R"([{"args": []}])"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid batch manifest")));
+}
+
+TEST(BatchTest, RunInParallelReturnsStatusesInOrder) {
+  for (int threads : {1, 3, 100}) {
+    std::atomic<int> calls = 0;
+    std::vector<absl::Status> statuses =
+        RunInParallel(10, threads, [&](int i) {
+          ++calls;
+          return i % 2 == 0 ? absl::OkStatus()
+                            : absl::InternalError(std::to_string(i));
+        });
+    EXPECT_EQ(calls, 10);
+    ASSERT_EQ(statuses.size(), 10);
+    for (int i = 0; i < 10; ++i) {
+      if (i % 2 == 0) {
+        EXPECT_THAT(statuses[i], IsOk());
+      } else {
+        EXPECT_THAT(statuses[i], StatusIs(absl::StatusCode::kInternal,
+                                          std::to_string(i)));
+      }
+    }
+  }
+}
+
+TEST(BatchTest, RunInParallelWithoutItems) {
+  EXPECT_THAT(RunInParallel(0, 4, [](int i) { return absl::OkStatus(); }),
+              IsEmpty());
+}
+
+}  // namespace
+}  // namespace crubit
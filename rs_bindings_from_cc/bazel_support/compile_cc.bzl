@@ -15,7 +15,8 @@ def compile_cc(
         feature_configuration,
         src,
         cc_infos,
-        extra_cc_compilation_action_inputs):
+        extra_cc_compilation_action_inputs,
+        cross_language_lto = False):
     """Compiles a C++ source file.
 
     Args:
@@ -26,12 +27,22 @@ def compile_cc(
       src: The source file to be compiled.
       cc_infos: List[CcInfo]: A list of CcInfo dependencies.
       extra_cc_compilation_action_inputs: A list of input files for the C++ compilation action.
+      cross_language_lto: Whether to compile to ThinLTO bitcode, and to link the binaries that
+        depend on the result with ThinLTO (see `compile_rust`).
 
     Returns:
       A CcInfo provider.
     """
     cc_info = cc_common.merge_cc_infos(cc_infos = cc_infos)
 
+    user_compile_flags = attr.copts if hasattr(attr, "copts") else []
+    user_link_flags = []
+    if cross_language_lto:
+        user_compile_flags = user_compile_flags + ["-flto=thin"]
+
+        # Only lld can link the bitcode that rustc emits with `-Clinker-plugin-lto`.
+        user_link_flags = ["-flto=thin", "-fuse-ld=lld"]
+
     (compilation_context, compilation_outputs) = cc_common.compile(
         name = src.basename,
         actions = ctx.actions,
@@ -40,7 +51,7 @@ def compile_cc(
         srcs = [src],
         additional_inputs = extra_cc_compilation_action_inputs,
         grep_includes = ctx.file._grep_includes,
-        user_compile_flags = attr.copts if hasattr(attr, "copts") else [],
+        user_compile_flags = user_compile_flags,
         compilation_contexts = [cc_info.compilation_context],
     )
 
@@ -51,6 +62,7 @@ def compile_cc(
         cc_toolchain = cc_toolchain,
         compilation_outputs = compilation_outputs,
         linking_contexts = [cc_info.linking_context],
+        user_link_flags = user_link_flags,
     )
 
     return CcInfo(
@@ -35,7 +35,7 @@ def _get_cc_info(providers):
             return provider
     fail("Couldn't find a CcInfo in the list of providers")
 
-def compile_rust(ctx, attr, src, extra_srcs, deps):
+def compile_rust(ctx, attr, src, extra_srcs, deps, cross_language_lto = False, extern_args_file = None):
     """Compiles a Rust source file.
 
     Args:
@@ -44,6 +44,12 @@ def compile_rust(ctx, attr, src, extra_srcs, deps):
       src: The source file to be compiled.
       extra_srcs: Additional source files to include in the crate.
       deps: List[DepVariantInfo]: A list of dependencies needed.
+      cross_language_lto: Whether to emit LLVM bitcode that the linker optimizes together with the
+        ThinLTO bitcode of the C++ thunks (see `compile_cc`), so that the thunks can be inlined
+        into their Rust callers. This requires rustc and Clang to use the same LLVM version.
+      extern_args_file: An optional rustc argument file with the `--extern` flags of the
+        transitive dependencies that `src` uses. Without it, rustc gets an `--extern` flag for
+        every transitive dependency; with it, only for the direct ones and those in the file.
 
     Returns:
       A DepVariantInfo provider.
@@ -72,6 +78,12 @@ def compile_rust(ctx, attr, src, extra_srcs, deps):
     lib = ctx.actions.declare_file(lib_name)
     rmeta = ctx.actions.declare_file(rmeta_name)
 
+    rust_flags = ["-Clinker-plugin-lto"] if cross_language_lto else []
+    compile_data = []
+    if extern_args_file:
+        rust_flags.append("@" + extern_args_file.path)
+        compile_data.append(extern_args_file)
+
     providers = rustc_compile_action(
         ctx = ctx,
         attr = attr,
@@ -89,12 +101,13 @@ def compile_rust(ctx, attr, src, extra_srcs, deps):
             edition = "2018",
             is_test = False,
             rustc_env = {},
-            compile_data = depset([]),
+            compile_data = depset(compile_data),
             compile_data_targets = depset([]),
             owner = ctx.label,
         ),
         output_hash = output_hash,
-        force_all_deps_direct = True,
+        rust_flags = rust_flags,
+        force_all_deps_direct = not extern_args_file,
     )
 
     return DepVariantInfo(
@@ -17,6 +17,80 @@ def _get_hdrs_command_line(hdrs):
 def _get_extra_rs_srcs_command_line(extra_rs_srcs):
     return ["--extra_rs_srcs=" + ",".join([x.path for x in extra_rs_srcs])]
 
+def _get_dependency_modules_command_line(dependency_modules):
+    return ["--dependency_modules=" + ",".join([x.path for x in dependency_modules])]
+
+def _run_as_persistent_worker(
+        ctx,
+        cc_toolchain,
+        feature_configuration,
+        variables,
+        rs_bindings_from_cc_flags,
+        target_args,
+        inputs,
+        outputs):
+    """Runs `rs_bindings_from_cc` as a Bazel persistent worker.
+
+    `cc_common.create_compile_action` doesn't support persistent workers, so this action runs
+    `rs_bindings_from_cc` directly, passing it the Clang flags of a C++ compile action.
+    """
+    clang_args = cc_common.get_memory_inefficient_command_line(
+        feature_configuration = feature_configuration,
+        action_name = ACTION_NAMES.cpp_compile,
+        variables = variables,
+    )
+
+    # The target args of all transitive dependencies can be too long for the command line (and for
+    # each work request), so they are passed in a file. `ctx.actions.write` expands the depset at
+    # execution time, not during analysis.
+    target_args_file = ctx.actions.declare_file(ctx.label.name + "_target_args.json")
+    target_args_content = ctx.actions.args()
+    target_args_content.add_joined(target_args, join_with = ",", format_joined = "[%s]")
+    ctx.actions.write(target_args_file, target_args_content)
+
+    args = ctx.actions.args()
+    args.add_all(rs_bindings_from_cc_flags)
+    args.add("--target_args=@" + target_args_file.path)
+    args.add("--")
+    args.add_all(clang_args)
+
+    # Persistent workers receive the arguments in the params file in their work requests.
+    args.use_param_file("@%s", use_always = True)
+    args.set_param_file_format("multiline")
+    ctx.actions.run(
+        executable = ctx.executable._generator,
+        arguments = [args],
+        inputs = depset([target_args_file], transitive = [inputs, cc_toolchain.all_files]),
+        outputs = outputs,
+        env = cc_common.get_environment_variables(
+            feature_configuration = feature_configuration,
+            action_name = ACTION_NAMES.cpp_compile,
+            variables = variables,
+        ),
+        execution_requirements = {
+            "requires-worker-protocol": "json",
+            "supports-workers": "1",
+        },
+        mnemonic = "RustBindingsFromCc",
+        progress_message = "Generating Rust bindings for %{label}",
+    )
+
+def _run_codegen(ctx, rs_bindings_from_cc_flags, inputs, outputs):
+    """Runs `rs_bindings_from_cc` to generate the bindings from the IR written by another action.
+
+    Unlike the import of the headers, this doesn't need the C++ toolchain or the headers.
+    """
+    args = ctx.actions.args()
+    args.add_all(rs_bindings_from_cc_flags)
+    ctx.actions.run(
+        executable = ctx.executable._generator,
+        arguments = [args],
+        inputs = inputs,
+        outputs = outputs,
+        mnemonic = "RustBindingsFromCcCodegen",
+        progress_message = "Generating Rust bindings from the IR of %{label}",
+    )
+
 def generate_bindings(
         ctx,
         attr,
@@ -28,7 +102,9 @@ def generate_bindings(
         action_inputs,
         target_args,
         extra_rs_srcs,
-        extra_rs_bindings_from_cc_cli_flags):
+        extra_rs_bindings_from_cc_cli_flags,
+        dependency_modules = depset(),
+        rustc_dep_externs = None):
     """Runs the bindings generator.
 
     Args:
@@ -44,39 +120,115 @@ def generate_bindings(
                         its per-target arguments (headers, features) in json format.
       extra_rs_srcs: A list of extra source files to add.
       extra_rs_bindings_from_cc_cli_flags: CLI flags to be passed to `rs_bindings_from_cc`.
+      dependency_modules: A depset of Clang modules for the public headers of dependencies.
+      rustc_dep_externs: An optional JSON file mapping the labels of dependencies to the
+                         `name=path` values of the `--extern` flags for their bindings crates.
 
     Returns:
-      tuple(cc_output, rs_output, namespaces_output, error_report_output): The generated source files.
+      tuple(cc_output, rs_output, namespaces_output, error_report_output, size_report_output,
+      rustc_dep_externs_output, module_output): The generated files. `error_report_output`,
+      `size_report_output` and `module_output` are None unless requested.
+      `rustc_dep_externs_output` is a rustc argument file with the `--extern` flags of the
+      `rustc_dep_externs` crates named by `rs_output`, or None without `rustc_dep_externs`.
     """
     cc_output = ctx.actions.declare_file(ctx.label.name + "_rust_api_impl.cc")
     rs_output = ctx.actions.declare_file(ctx.label.name + "_rust_api.rs")
     namespaces_output = ctx.actions.declare_file(ctx.label.name + "_namespaces.json")
     error_report_output = None
+    size_report_output = None
+    rustc_dep_externs_output = None
+    module_output = None
+
+    split_actions = ctx.attr._split_ir_and_codegen_actions[BuildSettingInfo].value
 
-    rs_bindings_from_cc_flags = [
+    common_flags = [
         "--stderrthreshold=2",
         "--target=" + str(ctx.label),
+    ] + extra_rs_bindings_from_cc_cli_flags
+
+    # The flags of the import of the headers into IR.
+    import_flags = [
+        "--namespaces_out",
+        namespaces_output.path,
+    ]
+    if ctx.attr._use_dependency_modules[BuildSettingInfo].value:
+        module_output = ctx.actions.declare_file(ctx.label.name + "_rust_api_module.pcm")
+        import_flags += [
+            "--module_out",
+            module_output.path,
+        ]
+        dependency_module_files = dependency_modules.to_list()
+        if dependency_module_files:
+            import_flags += _get_dependency_modules_command_line(dependency_module_files)
+    import_flags += _get_hdrs_command_line(public_hdrs) + _get_extra_rs_srcs_command_line(extra_rs_srcs)
+
+    # The flags of the generation of the bindings from the IR.
+    codegen_flags = [
         "--rs_out",
         rs_output.path,
         "--cc_out",
         cc_output.path,
-        "--namespaces_out",
-        namespaces_output.path,
         "--crubit_support_path",
         "support",
-        "--clang_format_exe_path",
-        ctx.file._clang_format.path,
         "--rustfmt_exe_path",
         ctx.file._rustfmt.path,
         "--rustfmt_config_path",
         ctx.file._rustfmt_cfg.path,
-    ] + extra_rs_bindings_from_cc_cli_flags
+        "--format=" + ctx.attr._format[BuildSettingInfo].value,
+    ]
+    if ctx.attr._format_cc_in_process[BuildSettingInfo].value:
+        codegen_flags.append("--format_cc_in_process")
+    else:
+        codegen_flags += [
+            "--clang_format_exe_path",
+            ctx.file._clang_format.path,
+        ]
+    if ctx.attr._omit_thunk_free_rs_api_impl[BuildSettingInfo].value:
+        codegen_flags.append("--omit_thunk_free_rs_api_impl")
+    if ctx.attr._collapse_opaque_fields[BuildSettingInfo].value:
+        codegen_flags.append("--collapse_opaque_fields")
     if ctx.attr._generate_error_report[BuildSettingInfo].value:
         error_report_output = ctx.actions.declare_file(ctx.label.name + "_rust_api_error_report.json")
-        rs_bindings_from_cc_flags += [
+        codegen_flags += [
             "--error_report_out",
             error_report_output.path,
         ]
+    if ctx.attr._generate_size_report[BuildSettingInfo].value:
+        size_report_output = ctx.actions.declare_file(ctx.label.name + "_rust_api_size_report.json")
+        codegen_flags += [
+            "--size_report_out",
+            size_report_output.path,
+        ]
+    codegen_inputs = []
+    if rustc_dep_externs:
+        rustc_dep_externs_output = ctx.actions.declare_file(ctx.label.name + "_rust_api_dep_externs.params")
+        codegen_flags += [
+            "--rustc_dep_externs",
+            rustc_dep_externs.path,
+            "--rustc_dep_externs_out",
+            rustc_dep_externs_output.path,
+        ]
+        codegen_inputs.append(rustc_dep_externs)
+
+    formatter_inputs = [ctx.executable._clang_format, ctx.executable._rustfmt] + ctx.files._rustfmt_cfg
+    if split_actions:
+        binary_ir_output = ctx.actions.declare_file(ctx.label.name + "_rust_api_ir.bin")
+        rs_bindings_from_cc_flags = common_flags + import_flags + [
+            "--binary_ir_out",
+            binary_ir_output.path,
+        ]
+        _run_codegen(
+            ctx,
+            common_flags + codegen_flags + ["--binary_ir_in", binary_ir_output.path],
+            inputs = [binary_ir_output] + formatter_inputs + codegen_inputs,
+            outputs = [x for x in [cc_output, rs_output, error_report_output, size_report_output, rustc_dep_externs_output] if x != None],
+        )
+        outputs = [x for x in [binary_ir_output, namespaces_output, module_output] if x != None]
+        import_inputs = [ctx.executable._generator]
+    else:
+        rs_bindings_from_cc_flags = common_flags + import_flags + codegen_flags
+        outputs = [x for x in [cc_output, rs_output, namespaces_output, error_report_output, size_report_output, rustc_dep_externs_output, module_output] if x != None]
+        import_inputs = [ctx.executable._generator] + formatter_inputs + codegen_inputs
 
     variables = cc_common.create_compile_variables(
         feature_configuration = feature_configuration,
@@ -102,12 +254,30 @@ def generate_bindings(
         preprocessor_defines = compilation_context.defines,
         variables_extension = {
             "rs_bindings_from_cc_tool": ctx.executable._generator.path,
-            "rs_bindings_from_cc_flags": rs_bindings_from_cc_flags + _get_hdrs_command_line(public_hdrs) + _get_extra_rs_srcs_command_line(extra_rs_srcs),
+            "rs_bindings_from_cc_flags": rs_bindings_from_cc_flags,
             "target_args": target_args,
         },
     )
 
-    # Run the `rs_bindings_from_cc` to generate the _rust_api_impl.cc and _rust_api.rs files.
+    additional_inputs = depset(
+        direct = import_inputs + extra_rs_srcs,
+        transitive = [action_inputs, dependency_modules],
+    )
+    if ctx.attr._use_persistent_worker[BuildSettingInfo].value:
+        _run_as_persistent_worker(
+            ctx = ctx,
+            cc_toolchain = cc_toolchain,
+            feature_configuration = feature_configuration,
+            variables = variables,
+            rs_bindings_from_cc_flags = rs_bindings_from_cc_flags,
+            target_args = target_args,
+            inputs = depset(transitive = [additional_inputs, compilation_context.headers]),
+            outputs = outputs,
+        )
+        return (cc_output, rs_output, namespaces_output, error_report_output, size_report_output, rustc_dep_externs_output, module_output)
+
+    # Run the `rs_bindings_from_cc` to generate the _rust_api_impl.cc and _rust_api.rs files (or,
+    # with split actions, the IR they are generated from).
     cc_common.create_compile_action(
         compilation_context = compilation_context,
         actions = ctx.actions,
@@ -115,17 +285,10 @@ def generate_bindings(
         feature_configuration = feature_configuration,
         cc_toolchain = cc_toolchain,
         source_file = public_hdrs[0],
-        output_file = cc_output,
+        output_file = outputs[0],
         grep_includes = ctx.file._grep_includes,
-        additional_inputs = depset(
-            direct = [
-                ctx.executable._clang_format,
-                ctx.executable._rustfmt,
-                ctx.executable._generator,
-            ] + ctx.files._rustfmt_cfg + extra_rs_srcs,
-            transitive = [action_inputs],
-        ),
-        additional_outputs = [x for x in [rs_output, namespaces_output, error_report_output] if x != None],
+        additional_inputs = additional_inputs,
+        additional_outputs = outputs[1:],
         variables = variables,
     )
-    return (cc_output, rs_output, namespaces_output, error_report_output)
+    return (cc_output, rs_output, namespaces_output, error_report_output, size_report_output, rustc_dep_externs_output, module_output)
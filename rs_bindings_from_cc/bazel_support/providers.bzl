@@ -17,6 +17,13 @@ RustBindingsFromCcInfo = provider(
                         "{'t': <target>, 'h': [<header>], 'f': [<feature>]}"),
         "namespaces": ("A json file containing the namespace hierarchy for the target we " +
                        "are generating bindings for, or None."),
+        "modules": ("A depset of Clang modules for the public headers of the target and its " +
+                    "transitive dependencies, or None. Only populated when " +
+                    "`//rs_bindings_from_cc/bazel_support:use_dependency_modules` is set."),
+        "rust_api_impl_srcs": ("A depset of the generated `_rust_api_impl.cc` files of the " +
+                               "target and its transitive dependencies that still need to be " +
+                               "compiled, or None. Only populated when " +
+                               "`//rs_bindings_from_cc/bazel_support:unity_rust_api_impl` is set."),
     },
 )
 
@@ -156,6 +156,9 @@ def _rust_bindings_from_cc_aspect_impl(target, ctx):
     #    This requires changes to Bazel.
     direct_target_args = {}
     features = find_crubit_features(target, ctx)
+    if features and _is_proto_library(target) and "proto_accessors" not in features:
+        # Protobuf getters are generated inline, so read them without thunks.
+        features = sorted(features + ["proto_accessors"])
     if all_standalone_hdrs:
         direct_target_args["h"] = [h.path for h in all_standalone_hdrs]
     if features:
@@ -208,6 +211,18 @@ def _rust_bindings_from_cc_aspect_impl(target, ctx):
         ] + ctx.attr._deps_for_bindings[DepsForBindingsInfo].deps_for_rs_file,
         extra_cc_compilation_action_inputs = extra_cc_compilation_action_inputs,
         extra_rs_bindings_from_cc_cli_flags = collect_rust_bindings_from_cc_cli_flags(target, ctx),
+        dependency_modules = depset(transitive = [
+            dep[RustBindingsFromCcInfo].modules
+            for dep in all_deps
+            if RustBindingsFromCcInfo in dep and
+               getattr(dep[RustBindingsFromCcInfo], "modules", None)
+        ]),
+        dependency_rust_api_impl_srcs = depset(transitive = [
+            dep[RustBindingsFromCcInfo].rust_api_impl_srcs
+            for dep in all_deps
+            if RustBindingsFromCcInfo in dep and
+               getattr(dep[RustBindingsFromCcInfo], "rust_api_impl_srcs", None)
+        ]),
     )
 
 rust_bindings_from_cc_aspect = aspect(
@@ -11,13 +11,48 @@ not be used yet.
 load("//rs_bindings_from_cc/bazel_support:compile_cc.bzl", "compile_cc")
 load("//rs_bindings_from_cc/bazel_support:compile_rust.bzl", "compile_rust")
 load("//rs_bindings_from_cc/bazel_support:generate_bindings.bzl", "generate_bindings")
+load("@bazel_skylib//rules:common_settings.bzl", "BuildSettingInfo")
 load("@bazel_tools//tools/cpp:toolchain_utils.bzl", "find_cpp_toolchain")
 load(
     "//rs_bindings_from_cc/bazel_support:providers.bzl",
+    "DepsForBindingsInfo",
     "GeneratedBindingsInfo",
     "RustBindingsFromCcInfo",
 )
 
+def _write_rustc_dep_externs(ctx, deps_for_rs_file):
+    """Writes the `--rustc_dep_externs` file of the crates that the generated Rust code may omit.
+
+    These are the crates of transitive dependencies: the crates in `deps_for_rs_file` (the bindings
+    of direct dependencies and the support crates) are always passed to rustc, and so are the crates
+    that the support crates depend on.
+
+    Returns:
+      The JSON file, which maps the label of the target owning each crate to the `name=path` value
+      of the `--extern` flag for the crate.
+    """
+    toolchain = ctx.toolchains["@rules_rust//rust:toolchain"]
+    kept = {}
+    for dep in deps_for_rs_file:
+        kept[dep.crate_info.output.path] = True
+    for dep in ctx.attr._deps_for_bindings[DepsForBindingsInfo].deps_for_rs_file:
+        for crate in dep.dep_info.transitive_crates.to_list():
+            kept[crate.output.path] = True
+
+    externs = {}
+    for dep in deps_for_rs_file:
+        for crate in dep.dep_info.transitive_crates.to_list():
+            if crate.output.path in kept:
+                continue
+            use_metadata = toolchain._pipelined_compilation and crate.metadata
+            externs[str(crate.owner)] = "{}={}".format(
+                crate.name,
+                crate.metadata.path if use_metadata else crate.output.path,
+            )
+    output = ctx.actions.declare_file(ctx.label.name + "_rust_api_dep_externs.json")
+    ctx.actions.write(output, json.encode(externs))
+    return output
+
 def generate_and_compile_bindings(
         ctx,
         attr,
@@ -30,7 +65,9 @@ def generate_and_compile_bindings(
         deps_for_cc_file,
         deps_for_rs_file,
         extra_cc_compilation_action_inputs = [],
-        extra_rs_bindings_from_cc_cli_flags = []):
+        extra_rs_bindings_from_cc_cli_flags = [],
+        dependency_modules = depset(),
+        dependency_rust_api_impl_srcs = depset()):
     """Runs the bindings generator.
 
     Args:
@@ -48,6 +85,9 @@ def generate_and_compile_bindings(
       extra_cc_compilation_action_inputs: A list of input files for the C++ compilation action.
       extra_rs_bindings_from_cc_cli_flags: CLI flags to pass to `rs_bindings_from_cc`, in addition
                                            to the flags that are passed by the build rule.
+      dependency_modules: A depset of Clang modules for the public headers of dependencies.
+      dependency_rust_api_impl_srcs: A depset of the `_rust_api_impl.cc` files of dependencies that
+                                     haven't been compiled yet.
     Returns:
       A RustBindingsFromCcInfo containing the result of the compilation of the generated source
       files, as well a GeneratedBindingsInfo provider containing the generated source files.
@@ -61,7 +101,12 @@ def generate_and_compile_bindings(
         unsupported_features = ctx.disabled_features + ["module_maps"],
     )
 
-    cc_output, rs_output, namespaces_output, error_report_output = generate_bindings(
+    # Additional Rust sources may use any crate, so they are compiled against all of them.
+    rustc_dep_externs = None
+    if ctx.attr._prune_rustc_deps[BuildSettingInfo].value and not extra_rs_srcs:
+        rustc_dep_externs = _write_rustc_dep_externs(ctx, deps_for_rs_file)
+
+    cc_output, rs_output, namespaces_output, error_report_output, size_report_output, rustc_dep_externs_output, module_output = generate_bindings(
         ctx = ctx,
         attr = attr,
         cc_toolchain = cc_toolchain,
@@ -73,6 +118,8 @@ def generate_and_compile_bindings(
         target_args = target_args,
         extra_rs_srcs = extra_rs_srcs,
         extra_rs_bindings_from_cc_cli_flags = extra_rs_bindings_from_cc_cli_flags,
+        dependency_modules = dependency_modules,
+        rustc_dep_externs = rustc_dep_externs,
     )
 
     # Relocate the rs files so that they can be read by rustc using relative paths.
@@ -82,16 +129,28 @@ def generate_and_compile_bindings(
         ctx.actions.symlink(output = new_file, target_file = file)
         extra_rs_srcs_relocated.append(new_file)
 
-    # Compile the "_rust_api_impl.cc" file
-    cc_info = compile_cc(
-        ctx,
-        attr,
-        cc_toolchain,
-        feature_configuration,
-        cc_output,
-        deps_for_cc_file,
-        extra_cc_compilation_action_inputs,
-    )
+    cross_language_lto = ctx.attr._cross_language_lto[BuildSettingInfo].value
+    if ctx.attr._unity_rust_api_impl[BuildSettingInfo].value:
+        # Leave the "_rust_api_impl.cc" file to a `crubit_unity_rust_api_impl` target, which
+        # compiles it together with the rest of its dependency closure.
+        cc_info = cc_common.merge_cc_infos(cc_infos = deps_for_cc_file)
+        rust_api_impl_srcs = depset(
+            direct = [cc_output],
+            transitive = [dependency_rust_api_impl_srcs],
+        )
+    else:
+        # Compile the "_rust_api_impl.cc" file
+        cc_info = compile_cc(
+            ctx,
+            attr,
+            cc_toolchain,
+            feature_configuration,
+            cc_output,
+            deps_for_cc_file,
+            extra_cc_compilation_action_inputs,
+            cross_language_lto = cross_language_lto,
+        )
+        rust_api_impl_srcs = depset()
 
     # Compile the "_rust_api.rs" file together with extra_rs_srcs.
     dep_variant_info = compile_rust(
@@ -100,6 +159,8 @@ def generate_and_compile_bindings(
         rs_output,
         extra_rs_srcs_relocated,
         deps_for_rs_file,
+        cross_language_lto = cross_language_lto,
+        extern_args_file = rustc_dep_externs_output,
     )
 
     return [
@@ -108,13 +169,18 @@ def generate_and_compile_bindings(
             dep_variant_info = dep_variant_info,
             target_args = target_args,
             namespaces = namespaces_output,
+            modules = depset(
+                direct = [module_output] if module_output else [],
+                transitive = [dependency_modules],
+            ),
+            rust_api_impl_srcs = rust_api_impl_srcs,
         ),
         GeneratedBindingsInfo(
             cc_file = cc_output,
             rust_file = rs_output,
             namespaces_file = namespaces_output,
         ),
-        OutputGroupInfo(out = depset([x for x in [cc_output, rs_output, namespaces_output, error_report_output] if x != None])),
+        OutputGroupInfo(out = depset([x for x in [cc_output, rs_output, namespaces_output, error_report_output, size_report_output] if x != None])),
     ]
 
 bindings_attrs = {
@@ -173,4 +239,37 @@ bindings_attrs = {
     "_generate_error_report": attr.label(
         default = "//rs_bindings_from_cc/bazel_support:generate_error_report",
     ),
+    "_generate_size_report": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:generate_size_report",
+    ),
+    "_use_dependency_modules": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:use_dependency_modules",
+    ),
+    "_format_cc_in_process": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:format_cc_in_process",
+    ),
+    "_format": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:format",
+    ),
+    "_use_persistent_worker": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:use_persistent_worker",
+    ),
+    "_omit_thunk_free_rs_api_impl": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:omit_thunk_free_rs_api_impl",
+    ),
+    "_collapse_opaque_fields": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:collapse_opaque_fields",
+    ),
+    "_split_ir_and_codegen_actions": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:split_ir_and_codegen_actions",
+    ),
+    "_unity_rust_api_impl": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:unity_rust_api_impl",
+    ),
+    "_cross_language_lto": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:cross_language_lto",
+    ),
+    "_prune_rustc_deps": attr.label(
+        default = "//rs_bindings_from_cc/bazel_support:prune_rustc_deps",
+    ),
 }
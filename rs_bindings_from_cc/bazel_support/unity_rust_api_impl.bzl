@@ -0,0 +1,117 @@
+# Part of the Crubit project, under the Apache License v2.0 with LLVM
+# Exceptions. See /LICENSE for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+"""A rule that compiles the generated `_rust_api_impl.cc` files of a dependency closure at once.
+
+By default, the `_rust_api_impl.cc` file of every C++ target is compiled as its own translation
+unit, which parses the headers of the target and of its dependencies again. When
+`//rs_bindings_from_cc/bazel_support:unity_rust_api_impl` is set, the aspect skips these
+compilations. Instead, a `crubit_unity_rust_api_impl` target (usually one per binary or test)
+includes all of the `_rust_api_impl.cc` files of the dependency closure of its C++ `deps` in a
+single translation unit, so that each header is only parsed once.
+
+For example:
+
+```
+crubit_unity_rust_api_impl(
+    name = "my_binary_rust_api_impl",
+    deps = [":my_cc_library"],
+)
+
+rust_binary(
+    name = "my_binary",
+    cc_deps = [":my_cc_library"],
+    deps = [":my_binary_rust_api_impl"],
+)
+```
+
+Only one `crubit_unity_rust_api_impl` target may be linked into a binary, and its `deps` must
+cover all of the C++ targets that the binary uses through Crubit: otherwise their thunks are
+either missing or defined twice.
+
+Disclaimer: This project is experimental, under heavy development, and should
+not be used yet.
+"""
+
+load("//rs_bindings_from_cc/bazel_support:compile_cc.bzl", "compile_cc")
+load(
+    "//rs_bindings_from_cc/bazel_support:providers.bzl",
+    "DepsForBindingsInfo",
+    "RustBindingsFromCcInfo",
+)
+load(
+    "//rs_bindings_from_cc/bazel_support:rust_bindings_from_cc_aspect.bzl",
+    "rust_bindings_from_cc_aspect",
+)
+load("@bazel_skylib//rules:common_settings.bzl", "BuildSettingInfo")
+load("@bazel_tools//tools/cpp:toolchain_utils.bzl", "find_cpp_toolchain")
+
+def _crubit_unity_rust_api_impl_impl(ctx):
+    bindings_infos = [
+        dep[RustBindingsFromCcInfo]
+        for dep in ctx.attr.deps
+        if RustBindingsFromCcInfo in dep
+    ]
+    rust_api_impl_srcs = depset(transitive = [
+        info.rust_api_impl_srcs
+        for info in bindings_infos
+        if getattr(info, "rust_api_impl_srcs", None)
+    ])
+
+    # The order of the files doesn't matter: each of them includes the headers that it needs.
+    args = ctx.actions.args()
+    args.set_param_file_format("multiline")
+    args.add_all(rust_api_impl_srcs, format_each = "#include \"%s\"")
+    unity_src = ctx.actions.declare_file(ctx.label.name + ".cc")
+    ctx.actions.write(unity_src, args)
+
+    cc_toolchain = find_cpp_toolchain(ctx)
+    feature_configuration = cc_common.configure_features(
+        ctx = ctx,
+        cc_toolchain = cc_toolchain,
+        requested_features = ctx.features,
+        unsupported_features = ctx.disabled_features + ["module_maps"],
+    )
+    cc_info = compile_cc(
+        ctx,
+        ctx.attr,
+        cc_toolchain,
+        feature_configuration,
+        unity_src,
+        [info.cc_info for info in bindings_infos if info.cc_info] +
+        ctx.attr._deps_for_bindings[DepsForBindingsInfo].deps_for_cc_file,
+        rust_api_impl_srcs.to_list(),
+        cross_language_lto = ctx.attr._cross_language_lto[BuildSettingInfo].value,
+    )
+    return [cc_info]
+
+crubit_unity_rust_api_impl = rule(
+    implementation = _crubit_unity_rust_api_impl_impl,
+    attrs = {
+        "deps": attr.label_list(
+            doc = ("The C++ targets whose dependency closure gets its " +
+                   "`_rust_api_impl.cc` files compiled."),
+            aspects = [rust_bindings_from_cc_aspect],
+        ),
+        "_cc_toolchain": attr.label(
+            default = "@bazel_tools//tools/cpp:current_cc_toolchain",
+        ),
+        "_cross_language_lto": attr.label(
+            default = "//rs_bindings_from_cc/bazel_support:cross_language_lto",
+        ),
+        "_deps_for_bindings": attr.label(
+            doc = "Dependencies that are needed to compile the generated .cc files.",
+            default = "//rs_bindings_from_cc/bazel_support:deps_for_bindings",
+        ),
+        "_grep_includes": attr.label(
+            allow_single_file = True,
+            default = Label("@bazel_tools//tools/cpp:grep-includes"),
+            cfg = "exec",
+        ),
+    },
+    toolchains = [
+        "@bazel_tools//tools/cpp:toolchain_type",
+    ],
+    fragments = ["cpp"],
+)
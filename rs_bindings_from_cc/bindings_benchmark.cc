@@ -0,0 +1,469 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Benchmarks `GenerateBindingsAndMetadata` end to end on synthetic headers
+// (and optionally on real-world headers passed with `--headers`), and prints
+// the throughput in IR items per second, the size of the generated code, and
+// the peak memory use.
+//
+// Example:
+//
+//   bazel run -c opt //rs_bindings_from_cc:bindings_benchmark -- \
+//       --workloads=records,templates --scales=1,10,100
+//
+// The generated code is formatted with `--format=fast`, so that the results
+// don't depend on rustfmt and clang-format.
+//
+// With `--compile_dir`, the generated code is also compiled, and the time
+// taken by rustc (`--rustc`) and by clang (`--clang`) is reported separately,
+// so that changes to the shape of the generated code can be judged by their
+// cost to the build as a whole. The generated code needs the Crubit support
+// libraries, which are passed with `--rustc_args` (e.g. `-L` and `--extern`
+// flags for the crates) and `--clang_args` (e.g. `-I` flags for the
+// headers, which are included as `crubit/support/...`).
+//
+// The peak memory use is that of the process so far, so it only measures the
+// first workload accurately: to compare the memory use of workloads, run one
+// workload per invocation.
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/flags/declare.h"
+#include "absl/flags/flag.h"
+#include "absl/flags/parse.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "common/file_io.h"
+#include "common/status_macros.h"
+#include "rs_bindings_from_cc/cmdline.h"
+#include "rs_bindings_from_cc/generate_bindings_and_metadata.h"
+#include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/Program.h"
+
+ABSL_FLAG(std::vector<std::string>, workloads, std::vector<std::string>(),
+          "names of the synthetic workloads to run: records, namespaces, "
+          "templates, enums, comments, operators. Defaults to all of them, "
+          "unless --headers is passed.");
+ABSL_FLAG(std::vector<std::string>, headers, std::vector<std::string>(),
+          "paths of real-world headers to run as one more workload. Clang "
+          "arguments needed to parse them (e.g. include paths) can be passed "
+          "after `--`.");
+ABSL_FLAG(int, scale, 1, "multiplier of the size of the synthetic workloads");
+ABSL_FLAG(std::vector<std::string>, scales, std::vector<std::string>(),
+          "if set, the synthetic workloads are run at each of these scales "
+          "instead of at --scale (e.g. `1,10,100`)");
+ABSL_FLAG(std::string, compile_dir, "",
+          "if set, the generated code (and the synthetic headers) are written "
+          "to this directory, and compiled with --rustc and --clang");
+ABSL_FLAG(std::string, rustc, "rustc",
+          "the rustc used to compile the generated Rust code");
+ABSL_FLAG(std::vector<std::string>, rustc_args, std::vector<std::string>(),
+          "extra arguments of --rustc (e.g. `-Copt-level=2`)");
+ABSL_FLAG(std::string, clang, "clang++",
+          "the clang used to compile the generated C++ code");
+ABSL_FLAG(std::vector<std::string>, clang_args, std::vector<std::string>(),
+          "extra arguments of --clang (e.g. `-O2`)");
+ABSL_FLAG(int, iterations, 3,
+          "number of times each workload is run; the fastest run is reported");
+ABSL_DECLARE_FLAG(int, codegen_threads);
+
+namespace crubit {
+namespace {
+
+constexpr absl::string_view kTarget = "//benchmark:target";
+
+// Returns `scale * 100` records with 20 methods and 4 fields each.
+std::string RecordsHeader(int scale) {
+  std::string header;
+  for (int i = 0; i < scale * 100; ++i) {
+    absl::StrAppend(&header, "struct Record", i, " {\n");
+    for (int j = 0; j < 20; ++j) {
+      absl::StrAppend(&header, "  int Method", j, "(int x, Record", i,
+                      "* other) const;\n");
+    }
+    for (int j = 0; j < 4; ++j) {
+      absl::StrAppend(&header, "  int field", j, ";\n");
+    }
+    absl::StrAppend(&header, "};\n");
+  }
+  return header;
+}
+
+// Returns `scale * 10` chains of 20 nested namespaces, with a record and a
+// function at each level.
+std::string NamespacesHeader(int scale) {
+  constexpr int kDepth = 20;
+  std::string header;
+  for (int i = 0; i < scale * 10; ++i) {
+    for (int depth = 0; depth < kDepth; ++depth) {
+      absl::StrAppend(&header, "namespace ns", i, "_", depth, " {\n",
+                      "struct S { int x; };\n",
+                      "inline int F(S s) { return s.x; }\n");
+    }
+    for (int depth = 0; depth < kDepth; ++depth) {
+      absl::StrAppend(&header, "}\n");
+    }
+  }
+  return header;
+}
+
+// Returns `scale * 100` instantiations of a class template, each with a
+// handful of members.
+std::string TemplatesHeader(int scale) {
+  std::string header = R"(
+    template <typename T, int N>
+    struct Array {
+      T Get(int i) const { return values[i]; }
+      void Set(int i, T value) { values[i] = value; }
+      int Size() const { return N; }
+      T values[N];
+    };
+    template <typename T>
+    struct Pair {
+      T first;
+      T second;
+      T Sum() const { return first + second; }
+    };
+  )";
+  for (int i = 0; i < scale * 100; ++i) {
+    absl::StrAppend(&header, "using Array", i, " = Array<int, ", i + 1,
+                    ">;\n");
+    absl::StrAppend(&header, "using PairOfArray", i, " = Pair<Array", i,
+                    ">;\n");
+  }
+  return header;
+}
+
+// Returns 10 enums with `scale * 500` enumerators each.
+std::string EnumsHeader(int scale) {
+  std::string header;
+  for (int i = 0; i < 10; ++i) {
+    absl::StrAppend(&header, "enum class Enum", i, " : int {\n");
+    for (int j = 0; j < scale * 500; ++j) {
+      absl::StrAppend(&header, "  kEnumerator", j, " = ", j, ",\n");
+    }
+    absl::StrAppend(&header, "};\n");
+  }
+  return header;
+}
+
+// Returns `scale * 500` documented functions, separated by free-standing
+// comments.
+std::string CommentsHeader(int scale) {
+  std::string header;
+  for (int i = 0; i < scale * 500; ++i) {
+    absl::StrAppend(&header, "// Free-standing comment ", i, ".\n\n",
+                    "// Doc comment of Function", i, ",\n",
+                    "// spanning several lines.\n", "void Function", i,
+                    "(int x);\n\n");
+  }
+  return header;
+}
+
+// Returns `scale * 100` records with comparison and arithmetic operators,
+// which are bound as trait implementations. Half of the operators are free
+// functions, and half are members.
+std::string OperatorsHeader(int scale) {
+  std::string header;
+  for (int i = 0; i < scale * 100; ++i) {
+    std::string name = absl::StrCat("Value", i);
+    absl::StrAppend(&header, "struct ", name, " final {\n", "  int x;\n",
+                    "  ", name, "& operator+=(const ", name, "& other);\n",
+                    "  ", name, "& operator-=(const ", name, "& other);\n",
+                    "  ", name, " operator-() const;\n", "};\n");
+    for (absl::string_view op : {"==", "<"}) {
+      absl::StrAppend(&header, "bool operator", op, "(const ", name,
+                      "& lhs, const ", name, "& rhs);\n");
+    }
+    for (absl::string_view op : {"+", "-", "*"}) {
+      absl::StrAppend(&header, name, " operator", op, "(const ", name,
+                      "& lhs, const ", name, "& rhs);\n");
+    }
+  }
+  return header;
+}
+
+struct Workload {
+  std::string name;
+  // The contents of the headers, keyed by their include paths.
+  absl::flat_hash_map<HeaderName, std::string> headers;
+};
+
+// Returns the workloads at `scale`, and the `--headers` workload only if
+// `with_headers` is true (since its size doesn't depend on the scale).
+absl::StatusOr<std::vector<Workload>> GetWorkloads(int scale,
+                                                   bool with_headers) {
+  struct SyntheticWorkload {
+    absl::string_view name;
+    std::string (*header)(int scale);
+  };
+  static constexpr SyntheticWorkload kSyntheticWorkloads[] = {
+      {"records", RecordsHeader},     {"namespaces", NamespacesHeader},
+      {"templates", TemplatesHeader}, {"enums", EnumsHeader},
+      {"comments", CommentsHeader},   {"operators", OperatorsHeader},
+  };
+
+  std::vector<std::string> names = absl::GetFlag(FLAGS_workloads);
+  std::vector<std::string> header_paths = absl::GetFlag(FLAGS_headers);
+  if (names.empty() && header_paths.empty()) {
+    for (const SyntheticWorkload& workload : kSyntheticWorkloads) {
+      names.emplace_back(workload.name);
+    }
+  }
+
+  std::vector<Workload> workloads;
+  for (const std::string& name : names) {
+    const SyntheticWorkload* synthetic = nullptr;
+    for (const SyntheticWorkload& workload : kSyntheticWorkloads) {
+      if (workload.name == name) synthetic = &workload;
+    }
+    if (synthetic == nullptr) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("unknown workload in --workloads: ", name));
+    }
+    Workload& workload = workloads.emplace_back();
+    workload.name = absl::GetFlag(FLAGS_scales).empty()
+                        ? name
+                        : absl::StrCat(name, "@", scale);
+    workload.headers.try_emplace(HeaderName(absl::StrCat(name, ".h")),
+                                 synthetic->header(scale));
+  }
+  if (with_headers && !header_paths.empty()) {
+    Workload& workload = workloads.emplace_back();
+    workload.name = "headers";
+    for (const std::string& path : header_paths) {
+      CRUBIT_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+      workload.headers.try_emplace(HeaderName(path), std::move(contents));
+    }
+  }
+  return workloads;
+}
+
+struct Measurement {
+  int64_t items = 0;
+  absl::Duration wall = absl::InfiniteDuration();
+  // The size of the generated code, in bytes.
+  int64_t rs_api_bytes = 0;
+  int64_t rs_api_impl_bytes = 0;
+  // Only measured with `--compile_dir`.
+  absl::Duration rustc = absl::InfiniteDuration();
+  absl::Duration clang = absl::InfiniteDuration();
+};
+
+// Runs `program` with `args`, and returns how long it took.
+absl::StatusOr<absl::Duration> RunCompiler(
+    const std::string& program, const std::vector<std::string>& args) {
+  llvm::ErrorOr<std::string> path = llvm::sys::findProgramByName(program);
+  if (!path) {
+    return absl::NotFoundError(absl::StrCat("Could not find `", program,
+                                            "`: ", path.getError().message()));
+  }
+  std::vector<llvm::StringRef> argv = {program};
+  argv.insert(argv.end(), args.begin(), args.end());
+  std::string error;
+  absl::Time start = absl::Now();
+  int exit_code = llvm::sys::ExecuteAndWait(*path, argv, /*Env=*/std::nullopt,
+                                            /*Redirects=*/{},
+                                            /*SecondsToWait=*/0,
+                                            /*MemoryLimit=*/0, &error);
+  absl::Duration wall = absl::Now() - start;
+  if (exit_code != 0) {
+    return absl::InternalError(absl::StrCat("`", program,
+                                            "` failed with exit code ",
+                                            exit_code, ": ", error));
+  }
+  return wall;
+}
+
+// Writes `workload`'s headers (unless their paths are absolute) and
+// `bindings` to `dir`, compiles them, and adds the times taken by rustc and
+// clang to `measurement`.
+absl::Status CompileBindings(absl::string_view dir, const Workload& workload,
+                             const BindingsAndMetadata& bindings,
+                             Measurement& measurement) {
+  for (const auto& [header_name, contents] : workload.headers) {
+    llvm::StringRef include_path(header_name.IncludePath().data(),
+                                 header_name.IncludePath().size());
+    if (llvm::sys::path::is_absolute(include_path)) continue;
+    std::string path = absl::StrCat(dir, "/", header_name.IncludePath());
+    if (std::error_code err = llvm::sys::fs::create_directories(
+            llvm::sys::path::parent_path(path))) {
+      return absl::InternalError(absl::StrCat(
+          "Could not create the directory of `", path, "`: ", err.message()));
+    }
+    CRUBIT_RETURN_IF_ERROR(SetFileContents(path, contents));
+  }
+  std::string prefix = absl::StrCat(dir, "/", workload.name);
+  std::string rs_api_path = absl::StrCat(prefix, "_rs_api.rs");
+  std::string rs_api_impl_path = absl::StrCat(prefix, "_rs_api_impl.cc");
+  CRUBIT_RETURN_IF_ERROR(SetFileContents(rs_api_path, bindings.rs_api));
+  CRUBIT_RETURN_IF_ERROR(
+      SetFileContents(rs_api_impl_path, bindings.rs_api_impl));
+
+  // The crate is only compiled, not linked, like a library in a build.
+  std::vector<std::string> rustc_args = {"--edition=2021", "--crate-type=rlib",
+                                         "--crate-name=rs_api",
+                                         "--cap-lints=allow", "-o",
+                                         absl::StrCat(prefix, ".rlib")};
+  for (const std::string& arg : absl::GetFlag(FLAGS_rustc_args)) {
+    rustc_args.push_back(arg);
+  }
+  rustc_args.push_back(rs_api_path);
+  CRUBIT_ASSIGN_OR_RETURN(absl::Duration rustc,
+                          RunCompiler(absl::GetFlag(FLAGS_rustc), rustc_args));
+  measurement.rustc = std::min(measurement.rustc, rustc);
+
+  std::vector<std::string> compile_args = {
+      "-std=c++17", "-c", "-o", absl::StrCat(prefix, "_rs_api_impl.o"),
+      absl::StrCat("-I", dir)};
+  for (const std::string& arg : absl::GetFlag(FLAGS_clang_args)) {
+    compile_args.push_back(arg);
+  }
+  compile_args.push_back(rs_api_impl_path);
+  CRUBIT_ASSIGN_OR_RETURN(
+      absl::Duration clang,
+      RunCompiler(absl::GetFlag(FLAGS_clang), compile_args));
+  measurement.clang = std::min(measurement.clang, clang);
+  return absl::OkStatus();
+}
+
+absl::StatusOr<Measurement> RunWorkload(
+    const Workload& workload, const std::vector<std::string>& clang_args) {
+  std::vector<std::string> public_headers;
+  llvm::json::Array header_paths;
+  for (const auto& [header_name, contents] : workload.headers) {
+    public_headers.emplace_back(header_name.IncludePath());
+    header_paths.push_back(std::string(header_name.IncludePath()));
+  }
+  std::string target_args =
+      llvm::formatv("{0}",
+                    llvm::json::Value(llvm::json::Array{llvm::json::Object{
+                        {"t", std::string(kTarget)},
+                        {"h", std::move(header_paths)},
+                        {"f", llvm::json::Array{"supported", "experimental"}},
+                    }}))
+          .str();
+
+  Measurement measurement;
+  for (int i = 0; i < absl::GetFlag(FLAGS_iterations); ++i) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        Cmdline cmdline,
+        Cmdline::CreateForTesting(
+            std::string(kTarget), "rs_api_impl.cc", "rs_api.rs",
+            /*ir_out=*/"", /*namespaces_out=*/"",
+            /*crubit_support_path=*/"crubit/support",
+            /*clang_format_exe_path=*/"", /*rustfmt_exe_path=*/"",
+            /*rustfmt_config_path=*/"", /*do_nothing=*/false, public_headers,
+            target_args, /*extra_rs_srcs=*/{},
+            /*srcs_to_scan_for_instantiations=*/{},
+            /*instantiations_out=*/"", /*error_report_out=*/"",
+            SourceLocationDocComment::Enabled, /*ir_cache_dir=*/"",
+            /*module_out=*/"", /*dependency_modules=*/{},
+            absl::GetFlag(FLAGS_codegen_threads),
+            /*format_cc_in_process=*/false, FormatMode::Fast));
+    absl::flat_hash_map<const HeaderName, const std::string> headers(
+        workload.headers.begin(), workload.headers.end());
+
+    absl::Time start = absl::Now();
+    CRUBIT_ASSIGN_OR_RETURN(
+        BindingsAndMetadata bindings,
+        GenerateBindingsAndMetadata(cmdline, clang_args, std::move(headers)));
+    measurement.wall = std::min(measurement.wall, absl::Now() - start);
+    measurement.items = bindings.ir.items.size();
+    measurement.rs_api_bytes = bindings.rs_api.size();
+    measurement.rs_api_impl_bytes = bindings.rs_api_impl.size();
+
+    std::string compile_dir = absl::GetFlag(FLAGS_compile_dir);
+    if (!compile_dir.empty()) {
+      CRUBIT_RETURN_IF_ERROR(
+          CompileBindings(compile_dir, workload, bindings, measurement));
+    }
+  }
+  return measurement;
+}
+
+// Returns `duration` in seconds, or "-" if it wasn't measured.
+std::string FormatSeconds(absl::Duration duration) {
+  if (duration == absl::InfiniteDuration()) return "-";
+  return absl::StrFormat("%.3f", absl::ToDoubleSeconds(duration));
+}
+
+absl::Status Main(std::vector<std::string> clang_args) {
+  if (absl::GetFlag(FLAGS_iterations) < 1) {
+    return absl::InvalidArgumentError(
+        "please specify a positive number of --iterations");
+  }
+  std::vector<int> scales;
+  for (const std::string& arg : absl::GetFlag(FLAGS_scales)) {
+    int scale = 0;
+    if (!absl::SimpleAtoi(arg, &scale) || scale < 1) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("not a positive number in --scales: ", arg));
+    }
+    scales.push_back(scale);
+  }
+  if (scales.empty()) scales.push_back(absl::GetFlag(FLAGS_scale));
+  std::vector<Workload> workloads;
+  for (int scale : scales) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        std::vector<Workload> workloads_at_scale,
+        GetWorkloads(scale, /*with_headers=*/scale == scales.front()));
+    for (Workload& workload : workloads_at_scale) {
+      workloads.push_back(std::move(workload));
+    }
+  }
+
+  std::cout << absl::StrFormat(
+      "%-16s %10s %12s %12s %12s %12s %10s %10s %16s\n", "workload", "items",
+      "seconds", "items/s", "rs_api KiB", "impl KiB", "rustc s", "clang s",
+      "peak RSS (MiB)");
+  for (const Workload& workload : workloads) {
+    CRUBIT_ASSIGN_OR_RETURN(Measurement measurement,
+                            RunWorkload(workload, clang_args));
+    double seconds = absl::ToDoubleSeconds(measurement.wall);
+    std::cout << absl::StrFormat(
+        "%-16s %10d %12.3f %12.0f %12.1f %12.1f %10s %10s %16.1f\n",
+        workload.name, measurement.items, seconds, measurement.items / seconds,
+        measurement.rs_api_bytes / 1024.0,
+        measurement.rs_api_impl_bytes / 1024.0,
+        FormatSeconds(measurement.rustc), FormatSeconds(measurement.clang),
+        PeakRssBytes() / (1024.0 * 1024.0));
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace
+}  // namespace crubit
+
+int main(int argc, char* argv[]) {
+  std::vector<char*> args = absl::ParseCommandLine(argc, argv);
+  // Everything but argv[0] is passed on to Clang.
+  absl::Status status =
+      crubit::Main(std::vector<std::string>(args.begin() + 1, args.end()));
+  if (!status.ok()) {
+    std::cerr << status.message() << "\n";
+    return 1;
+  }
+  return 0;
+}
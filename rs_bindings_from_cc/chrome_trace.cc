@@ -0,0 +1,59 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/chrome_trace.h"
+
+#include <unistd.h>
+
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/functional/function_ref.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+
+namespace crubit {
+
+ChromeTrace::Span::Span(ChromeTrace* trace, absl::string_view category,
+                        absl::FunctionRef<std::string()> name)
+    : trace_(trace) {
+  if (trace_ == nullptr) return;
+  category_ = std::string(category);
+  name_ = name();
+  start_ = absl::Now();
+}
+
+ChromeTrace::Span::~Span() {
+  if (trace_ == nullptr) return;
+  absl::Duration duration = absl::Now() - start_;
+  trace_->events_.push_back(llvm::json::Object{
+      {"name", std::move(name_)},
+      {"cat", std::move(category_)},
+      {"ph", "X"},
+      {"ts", absl::ToUnixMicros(start_)},
+      {"dur", absl::ToInt64Microseconds(duration)},
+      {"pid", static_cast<int64_t>(getpid())},
+      {"tid", 0},
+  });
+}
+
+void ChromeTrace::AddEvents(llvm::json::Array events) {
+  for (llvm::json::Value& event : events) {
+    events_.push_back(std::move(event));
+  }
+}
+
+std::string ChromeTrace::ToJson() const {
+  llvm::json::Object trace = {
+      {"traceEvents", events_},
+      {"displayTimeUnit", "ms"},
+  };
+  return llvm::formatv("{0}", llvm::json::Value(std::move(trace))).str();
+}
+
+}  // namespace crubit
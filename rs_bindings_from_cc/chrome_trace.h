@@ -0,0 +1,59 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_CHROME_TRACE_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_CHROME_TRACE_H_
+
+#include <string>
+
+#include "absl/functional/function_ref.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "llvm/Support/JSON.h"
+
+namespace crubit {
+
+// Collects spans in the Chrome trace event format, as written to
+// `--trace_out`. The trace can be viewed in chrome://tracing or
+// https://ui.perfetto.dev.
+//
+// Timestamps are in microseconds since the Unix epoch, like those of the Rust
+// `ChromeTrace` (see common/chrome_trace.rs), so that the events recorded in
+// Rust can be merged with `AddEvents`.
+//
+// Not thread-safe. All the spans recorded in C++ are attributed to the same
+// thread.
+class ChromeTrace {
+ public:
+  // Records a span named `name()` in `category`, from construction to
+  // destruction. Does nothing, and doesn't call `name`, if `trace` is null.
+  class Span {
+   public:
+    Span(ChromeTrace* trace, absl::string_view category,
+         absl::FunctionRef<std::string()> name);
+    ~Span();
+
+    Span(const Span&) = delete;
+    Span& operator=(const Span&) = delete;
+
+   private:
+    ChromeTrace* trace_;
+    std::string category_;
+    std::string name_;
+    absl::Time start_;
+  };
+
+  // Adds the trace events in `events`, e.g. events recorded in Rust.
+  void AddEvents(llvm::json::Array events);
+
+  // Returns the trace as a JSON object (`{"traceEvents": [...]}`).
+  std::string ToJson() const;
+
+ private:
+  llvm::json::Array events_;
+};
+
+}  // namespace crubit
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_CHROME_TRACE_H_
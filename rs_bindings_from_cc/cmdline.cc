@@ -6,6 +6,7 @@
 
 #include <algorithm>
 #include <iterator>
+#include <memory>
 #include <string>
 #include <utility>
 #include <vector>
@@ -13,25 +14,44 @@
 #include "absl/flags/flag.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "common/ffi_types.h"
 #include "common/status_macros.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
 
 ABSL_FLAG(bool, do_nothing, false,
           "if set to true the tool will produce empty files "
           "(useful for testing Bazel integration)");
 ABSL_FLAG(std::string, rs_out, "",
           "output path for the Rust source file with bindings");
+ABSL_FLAG(std::vector<std::string>, rs_out_shards, std::vector<std::string>(),
+          "(optional) output paths for shards of the generated Rust source "
+          "code. If present, the bindings of top-level namespaces are split "
+          "across these files, which the --rs_out file `include!`s. They must "
+          "be in the same directory as --rs_out.");
 ABSL_FLAG(std::string, cc_out, "",
           "output path for the C++ source file with bindings implementation");
 ABSL_FLAG(std::string, ir_out, "",
           "(optional) output path for the JSON IR. If not present, the JSON IR "
           "will not be dumped.");
+ABSL_FLAG(std::string, binary_ir_out, "",
+          "(optional) output path for the binary IR, which another invocation "
+          "of the tool can generate bindings from via --binary_ir_in. If "
+          "present without --rs_out and --cc_out, the tool only imports the "
+          "headers and doesn't generate bindings.");
+ABSL_FLAG(std::string, binary_ir_in, "",
+          "(optional) path to a binary IR file written via --binary_ir_out. "
+          "If present, the tool generates bindings from it instead of "
+          "parsing --public_headers.");
 ABSL_FLAG(std::string, crubit_support_path, "",
           "path to the crubit/support directory in a format that "
           "should be used in the #include directives inside the generated .cc "
@@ -53,21 +73,35 @@ ABSL_FLAG(std::string, target, "", "The target to generate bindings for.");
 ABSL_FLAG(std::string, target_args, "",
           "Per-target Crubit arguments, encoded as a JSON array. This contains "
           "both the list of headers assigned to the target (h), and the set of "
-          "enabled features (f). For example:"
+          "enabled features (f). A target may also own the bindings of class "
+          "template instantiations (i), which other targets then reuse instead "
+          "of generating their own. For example:"
           "[\n"
           "  {\n"
           "     \"t\": \"//foo/bar:baz\",\n"
           "     \"h\": [\"foo/bar/header1.h\", \"foo/bar/header2.h\"],\n"
           "     \"f\": [\"supported\"]\n"
           "  },\n"
+          "  {\n"
+          "     \"t\": \"//foo/bar:instantiations\",\n"
+          "     \"i\": [\"std::vector<int, std::allocator<int>>\"]\n"
+          "  },\n"
           "...\n"
-          "]");
+          "]\n"
+          "For deep dependency graphs, the array can instead be written to a "
+          "file, which is passed as `--target_args=@<path>`.");
 ABSL_FLAG(std::vector<std::string>, extra_rs_srcs, std::vector<std::string>(),
           "Additional Rust source files to include into the crate.");
 ABSL_FLAG(std::vector<std::string>, srcs_to_scan_for_instantiations,
           std::vector<std::string>(),
           "[template instantiation mode only] all Rust source files of a crate "
           "for which we are instantiating templates.");
+ABSL_FLAG(std::vector<std::string>, srcs_to_scan_for_used_names,
+          std::vector<std::string>(),
+          "(optional) Rust source files using the bindings. If present, "
+          "bindings are only generated for the C++ items whose names appear in "
+          "these files, and for the items those depend on. Not passed by the "
+          "Bazel aspect.");
 ABSL_FLAG(std::string, instantiations_out, "",
           "[template instantiation mode only] output path for the JSON file "
           "with mapping from a template instantiation to a generated Rust "
@@ -77,9 +111,110 @@ ABSL_FLAG(std::string, namespaces_out, "",
           "namespace hierarchy.");
 ABSL_FLAG(std::string, error_report_out, "",
           "(optional) output path for the JSON error report");
+ABSL_FLAG(std::string, size_report_out, "",
+          "(optional) output path for a JSON report of the size of the code "
+          "generated for each item: tokens and bytes in rs_api and "
+          "rs_api_impl, number of thunks, and number of generic parameters.");
+ABSL_FLAG(std::string, query_profile_out, "",
+          "(optional) output path for a JSON report of the number of calls, "
+          "cache hits and executions of each memoized query of the code "
+          "generation, and of the wall time spent in its calls. The report is "
+          "empty when the bindings are read from --ir_cache_dir.");
+ABSL_FLAG(std::string, rustc_dep_externs, "",
+          "(optional) path of a JSON object mapping the labels of dependency "
+          "targets to the `name=path` values of the rustc `--extern` flags "
+          "for their bindings crates. Requires --rustc_dep_externs_out.");
+ABSL_FLAG(std::string, rustc_dep_externs_out, "",
+          "(optional) output path for a rustc argument file with an "
+          "`--extern` flag for each --rustc_dep_externs target whose crate "
+          "the generated Rust code names.");
+ABSL_FLAG(std::string, timing_report_out, "",
+          "(optional) output path for a JSON report of the wall time, CPU "
+          "time and peak memory use of each phase of the tool, and of the "
+          "number of items of each kind.");
+ABSL_FLAG(std::string, trace_out, "",
+          "(optional) output path for a Chrome trace (viewable in "
+          "chrome://tracing or https://ui.perfetto.dev) with a span for the "
+          "import of each C++ decl and the generation of each item.");
+ABSL_FLAG(bool, lazy_dependency_imports, false,
+          "only import the declarations of other targets that the current "
+          "target's declarations refer to, instead of all the declarations "
+          "of the headers it includes.");
+ABSL_FLAG(bool, consolidate_layout_assertions, false,
+          "assert that the Rust and C++ layouts of all records match in a "
+          "single assertion over a table, rather than in a separate assertion "
+          "for each size, alignment and field offset. This is faster to "
+          "compile for targets with many records.");
+ABSL_FLAG(bool, omit_thunk_free_rs_api_impl, false,
+          "if the bindings don't need any C++ thunks, generate a --cc_out "
+          "file without includes and without C++ layout assertions, so that "
+          "compiling it doesn't parse the public headers again.");
+ABSL_FLAG(bool, collapse_opaque_fields, false,
+          "lay out the fields of records that have no Rust-visible fields "
+          "(e.g. because they are all private or of unsupported types) as a "
+          "single blob of bytes, whose layout is covered by the size and "
+          "alignment assertions alone, rather than as a blob per field with an "
+          "offset assertion each.");
 ABSL_FLAG(bool, generate_source_location_in_doc_comment, true,
           "add the source code location from which the binding originates in"
           "the doc comment of the binding");
+ABSL_FLAG(std::string, ir_cache_dir, "",
+          "(optional) directory in which to cache the outputs of the tool, "
+          "keyed by a hash of the preprocessed headers and of all other "
+          "inputs. If present, invocations with unchanged inputs copy their "
+          "outputs from the cache instead of parsing the headers, and "
+          "invocations whose headers produce an unchanged IR reuse the "
+          "generated bindings.");
+ABSL_FLAG(std::string, module_out, "",
+          "(optional) output path for a Clang module containing the public "
+          "headers, which targets depending on this one can pass in "
+          "--dependency_modules.");
+ABSL_FLAG(std::vector<std::string>, dependency_modules,
+          std::vector<std::string>(),
+          "(optional) Clang modules produced via --module_out for dependency "
+          "targets. Headers belonging to these modules are imported from them "
+          "instead of being parsed.");
+ABSL_FLAG(std::string, nullability_inference_table, "",
+          "(optional) path of an InferenceTable written by "
+          "//nullability/inference:merge_partials_main --table_out. Pointer "
+          "parameters and return types that were inferred to be non-null are "
+          "bound as references rather than as `Option`s of references.");
+ABSL_FLAG(std::string, lifetime_summaries, "",
+          "(optional) path of a LifetimeSummaries file with the lifetimes "
+          "inferred by lifetime_analysis for functions in the headers, as "
+          "written by `lifetime_analyzer -summaries_out`. "
+          "Functions without lifetime annotations use these lifetimes, so "
+          "that their pointer parameters and return types are bound as "
+          "references rather than as raw pointers.");
+ABSL_FLAG(bool, infer_nullability, false,
+          "infer the nullability of functions in the headers from the AST the "
+          "bindings are imported from, without reparsing them, and bind "
+          "pointers inferred to be non-null like --nullability_inference_table "
+          "does. Only the translation unit of the headers is analyzed.");
+ABSL_FLAG(bool, infer_lifetimes, false,
+          "run lifetime_analysis on the functions defined in the headers, on "
+          "the AST the bindings are imported from, and use the inferred "
+          "lifetimes like those of --lifetime_summaries (which take "
+          "precedence).");
+ABSL_FLAG(int, max_template_instantiations, 0,
+          "(optional) if positive, the maximum number of class template "
+          "specializations that are instantiated because the declarations of "
+          "the headers refer to them. Declarations referring to others are "
+          "not bound, and --timing_report_out lists the skipped ones.");
+ABSL_FLAG(int, max_template_instantiation_depth, 0,
+          "(optional) if positive, the maximum nesting of class template "
+          "specializations that are instantiated because the declarations of "
+          "other specializations refer to them.");
+ABSL_FLAG(int, codegen_threads, 1,
+          "number of threads used to generate bindings for top-level items. "
+          "The generated bindings do not depend on this value.");
+ABSL_FLAG(bool, format_cc_in_process, false,
+          "format the generated C++ code with the clang-format library "
+          "linked into the tool, instead of running --clang_format_exe_path.");
+ABSL_FLAG(std::string, format, "full",
+          "how to format the generated code: `none` prints it as is, `fast` "
+          "only breaks lines and indents blocks, and `full` runs rustfmt and "
+          "clang-format.");
 
 namespace crubit {
 
@@ -89,19 +224,31 @@ struct TargetArgs {
   std::string target;
   std::vector<std::string> headers;
   std::vector<std::string> features;
+  std::vector<std::string> instantiations;
 };
 
+absl::StatusOr<FormatMode> ParseFormatMode(absl::string_view format) {
+  if (format == "none") return FormatMode::Raw;
+  if (format == "fast") return FormatMode::Fast;
+  if (format == "full") return FormatMode::Full;
+  return absl::InvalidArgumentError(absl::StrCat(
+      "please specify --format as one of none, fast, or full; got: ", format));
+}
+
 bool fromJSON(const llvm::json::Value& json, TargetArgs& out,
               llvm::json::Path path) {
   llvm::json::ObjectMapper mapper(json, path);
   return mapper && mapper.map("t", out.target) &&
          mapper.mapOptional("h", out.headers) &&
-         mapper.mapOptional("f", out.features);
+         mapper.mapOptional("f", out.features) &&
+         mapper.mapOptional("i", out.instantiations);
 }
 
 }  // namespace
 
 absl::StatusOr<Cmdline> Cmdline::Create() {
+  CRUBIT_ASSIGN_OR_RETURN(FormatMode format_mode,
+                          ParseFormatMode(absl::GetFlag(FLAGS_format)));
   return CreateFromArgs(
       absl::GetFlag(FLAGS_target), absl::GetFlag(FLAGS_cc_out),
       absl::GetFlag(FLAGS_rs_out), absl::GetFlag(FLAGS_ir_out),
@@ -117,7 +264,31 @@ absl::StatusOr<Cmdline> Cmdline::Create() {
       absl::GetFlag(FLAGS_error_report_out),
       absl::GetFlag(FLAGS_generate_source_location_in_doc_comment)
           ? SourceLocationDocComment::Enabled
-          : SourceLocationDocComment::Disabled);
+          : SourceLocationDocComment::Disabled,
+      absl::GetFlag(FLAGS_ir_cache_dir), absl::GetFlag(FLAGS_module_out),
+      absl::GetFlag(FLAGS_dependency_modules),
+      absl::GetFlag(FLAGS_codegen_threads),
+      absl::GetFlag(FLAGS_format_cc_in_process), format_mode,
+      absl::GetFlag(FLAGS_rs_out_shards),
+      absl::GetFlag(FLAGS_srcs_to_scan_for_used_names),
+      absl::GetFlag(FLAGS_timing_report_out), absl::GetFlag(FLAGS_trace_out),
+      absl::GetFlag(FLAGS_lazy_dependency_imports),
+      absl::GetFlag(FLAGS_consolidate_layout_assertions)
+          ? LayoutAssertions::Consolidated
+          : LayoutAssertions::PerItem,
+      absl::GetFlag(FLAGS_omit_thunk_free_rs_api_impl),
+      absl::GetFlag(FLAGS_binary_ir_out), absl::GetFlag(FLAGS_binary_ir_in),
+      absl::GetFlag(FLAGS_nullability_inference_table),
+      absl::GetFlag(FLAGS_lifetime_summaries),
+      absl::GetFlag(FLAGS_size_report_out),
+      absl::GetFlag(FLAGS_rustc_dep_externs),
+      absl::GetFlag(FLAGS_rustc_dep_externs_out),
+      absl::GetFlag(FLAGS_infer_nullability),
+      absl::GetFlag(FLAGS_infer_lifetimes),
+      absl::GetFlag(FLAGS_max_template_instantiations),
+      absl::GetFlag(FLAGS_max_template_instantiation_depth),
+      absl::GetFlag(FLAGS_collapse_opaque_fields),
+      absl::GetFlag(FLAGS_query_profile_out));
 }
 
 absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
@@ -129,19 +300,85 @@ absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
     std::string target_args_str, std::vector<std::string> extra_rs_srcs,
     std::vector<std::string> srcs_to_scan_for_instantiations,
     std::string instantiations_out, std::string error_report_out,
-    SourceLocationDocComment generate_source_location_in_doc_comment) {
+    SourceLocationDocComment generate_source_location_in_doc_comment,
+    std::string ir_cache_dir, std::string module_out,
+    std::vector<std::string> dependency_modules, int codegen_threads,
+    bool format_cc_in_process, FormatMode format_mode,
+    std::vector<std::string> rs_out_shards,
+    std::vector<std::string> srcs_to_scan_for_used_names,
+    std::string timing_report_out, std::string trace_out,
+    bool lazy_dependency_imports, LayoutAssertions layout_assertions,
+    bool omit_thunk_free_rs_api_impl, std::string binary_ir_out,
+    std::string binary_ir_in, std::string nullability_inference_table,
+    std::string lifetime_summaries, std::string size_report_out,
+    std::string rustc_dep_externs, std::string rustc_dep_externs_out,
+    bool infer_nullability, bool infer_lifetimes,
+    int max_template_instantiations, int max_template_instantiation_depth,
+    bool collapse_opaque_fields, std::string query_profile_out) {
   Cmdline cmdline;
   if (current_target.empty()) {
     return absl::InvalidArgumentError("please specify --target");
   }
   cmdline.current_target_ = BazelLabel(std::move(current_target));
 
-  if (rs_out.empty()) {
+  // With --binary_ir_in, the headers were already imported by another
+  // invocation of the tool, so only the outputs of the code generation can be
+  // requested.
+  if (!binary_ir_in.empty()) {
+    for (const auto& [flag, value] :
+         {std::pair<absl::string_view, absl::string_view>{"binary_ir_out",
+                                                          binary_ir_out},
+          {"ir_out", ir_out},
+          {"namespaces_out", namespaces_out},
+          {"instantiations_out", instantiations_out},
+          {"module_out", module_out},
+          {"ir_cache_dir", ir_cache_dir},
+          {"nullability_inference_table", nullability_inference_table},
+          {"lifetime_summaries", lifetime_summaries}}) {
+      if (!value.empty()) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "please don't specify --", flag, " together with --binary_ir_in"));
+      }
+    }
+    if (infer_nullability || infer_lifetimes) {
+      return absl::InvalidArgumentError(
+          "please don't specify --infer_nullability or --infer_lifetimes "
+          "together with --binary_ir_in");
+    }
+  }
+  if (infer_nullability && !nullability_inference_table.empty()) {
+    return absl::InvalidArgumentError(
+        "please don't specify --infer_nullability together with "
+        "--nullability_inference_table");
+  }
+  if (!binary_ir_out.empty() && !ir_cache_dir.empty()) {
+    return absl::InvalidArgumentError(
+        "please don't specify --ir_cache_dir together with --binary_ir_out");
+  }
+  cmdline.binary_ir_out_ = std::move(binary_ir_out);
+  cmdline.binary_ir_in_ = std::move(binary_ir_in);
+
+  // Without --rs_out and --cc_out, the tool only writes the binary IR.
+  bool import_only =
+      !cmdline.binary_ir_out_.empty() && rs_out.empty() && cc_out.empty();
+
+  if (rs_out.empty() && !import_only) {
     return absl::InvalidArgumentError("please specify --rs_out");
   }
   cmdline.rs_out_ = std::move(rs_out);
 
-  if (cc_out.empty()) {
+  for (const std::string& rs_out_shard : rs_out_shards) {
+    if (llvm::sys::path::parent_path(rs_out_shard) !=
+        llvm::sys::path::parent_path(cmdline.rs_out_)) {
+      return absl::InvalidArgumentError(absl::Substitute(
+          "please specify --rs_out_shards in the directory of --rs_out ($0); "
+          "got: $1",
+          cmdline.rs_out_, rs_out_shard));
+    }
+  }
+  cmdline.rs_out_shards_ = std::move(rs_out_shards);
+
+  if (cc_out.empty() && !import_only) {
     return absl::InvalidArgumentError("please specify --cc_out");
   }
   cmdline.cc_out_ = std::move(cc_out);
@@ -150,17 +387,22 @@ absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
 
   cmdline.namespaces_out_ = std::move(namespaces_out);
 
-  if (crubit_support_path.empty()) {
+  if (crubit_support_path.empty() && !import_only) {
     return absl::InvalidArgumentError("please specify --crubit_support_path");
   }
   cmdline.crubit_support_path_ = std::move(crubit_support_path);
 
-  if (clang_format_exe_path.empty()) {
+  // The formatter executables are only needed for full formatting.
+  cmdline.format_mode_ = format_mode;
+  if (clang_format_exe_path.empty() && !format_cc_in_process &&
+      format_mode == FormatMode::Full && !import_only) {
     return absl::InvalidArgumentError("please specify --clang_format_exe_path");
   }
   cmdline.clang_format_exe_path_ = std::move(clang_format_exe_path);
+  cmdline.format_cc_in_process_ = format_cc_in_process;
 
-  if (rustfmt_exe_path.empty()) {
+  if (rustfmt_exe_path.empty() && format_mode == FormatMode::Full &&
+      !import_only) {
     return absl::InvalidArgumentError("please specify --rustfmt_exe_path");
   }
   cmdline.rustfmt_exe_path_ = std::move(rustfmt_exe_path);
@@ -170,7 +412,7 @@ absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
   cmdline.generate_source_location_in_doc_comment_ =
       generate_source_location_in_doc_comment;
 
-  if (public_headers.empty()) {
+  if (public_headers.empty() && cmdline.binary_ir_in_.empty()) {
     return absl::InvalidArgumentError("please specify --public_headers");
   }
   std::transform(public_headers.begin(), public_headers.end(),
@@ -187,13 +429,69 @@ absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
   cmdline.instantiations_out_ = std::move(instantiations_out);
   cmdline.srcs_to_scan_for_instantiations_ =
       std::move(srcs_to_scan_for_instantiations);
+  cmdline.srcs_to_scan_for_used_names_ = std::move(srcs_to_scan_for_used_names);
   cmdline.error_report_out_ = std::move(error_report_out);
+  cmdline.size_report_out_ = std::move(size_report_out);
+  cmdline.query_profile_out_ = std::move(query_profile_out);
+  if (rustc_dep_externs.empty() != rustc_dep_externs_out.empty()) {
+    return absl::InvalidArgumentError(
+        "please specify both --rustc_dep_externs and --rustc_dep_externs_out, "
+        "or neither");
+  }
+  cmdline.rustc_dep_externs_ = std::move(rustc_dep_externs);
+  cmdline.rustc_dep_externs_out_ = std::move(rustc_dep_externs_out);
+  cmdline.timing_report_out_ = std::move(timing_report_out);
+  cmdline.trace_out_ = std::move(trace_out);
+  cmdline.lazy_dependency_imports_ = lazy_dependency_imports;
+  cmdline.layout_assertions_ = layout_assertions;
+  cmdline.omit_thunk_free_rs_api_impl_ = omit_thunk_free_rs_api_impl;
+  cmdline.collapse_opaque_fields_ = collapse_opaque_fields;
+  cmdline.ir_cache_dir_ = std::move(ir_cache_dir);
+  cmdline.nullability_inference_table_ = std::move(nullability_inference_table);
+  cmdline.lifetime_summaries_ = std::move(lifetime_summaries);
+  cmdline.infer_nullability_ = infer_nullability;
+  cmdline.infer_lifetimes_ = infer_lifetimes;
+  if (max_template_instantiations < 0 || max_template_instantiation_depth < 0) {
+    return absl::InvalidArgumentError(
+        "please don't specify a negative --max_template_instantiations or "
+        "--max_template_instantiation_depth");
+  }
+  cmdline.max_template_instantiations_ = max_template_instantiations;
+  cmdline.max_template_instantiation_depth_ = max_template_instantiation_depth;
+  cmdline.module_out_ = std::move(module_out);
+  cmdline.dependency_modules_ = std::move(dependency_modules);
+
+  if (codegen_threads < 1) {
+    return absl::InvalidArgumentError(
+        "please specify a positive number of --codegen_threads");
+  }
+  cmdline.codegen_threads_ = codegen_threads;
 
   if (target_args_str.empty()) {
-    return absl::InvalidArgumentError("please specify --target_args");
+    if (cmdline.binary_ir_in_.empty()) {
+      return absl::InvalidArgumentError("please specify --target_args");
+    }
+    // The features of the targets are already recorded in the binary IR.
+    target_args_str = "[]";
+  }
+  // The JSON of all transitive dependencies may not fit on the command line,
+  // so it can also be read from a file.
+  std::unique_ptr<llvm::MemoryBuffer> target_args_file;
+  llvm::StringRef target_args_json = target_args_str;
+  if (target_args_json.consume_front("@")) {
+    auto buffer = llvm::MemoryBuffer::getFile(target_args_json,
+                                              /*IsText=*/true);
+    if (!buffer) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Failed to read the `--target_args` file `",
+                       target_args_json.str(), "`: ",
+                       buffer.getError().message()));
+    }
+    target_args_file = std::move(*buffer);
+    target_args_json = target_args_file->getBuffer();
   }
   auto target_args =
-      llvm::json::parse<std::vector<TargetArgs>>(std::move(target_args_str));
+      llvm::json::parse<std::vector<TargetArgs>>(target_args_json);
   if (auto err = target_args.takeError()) {
     return absl::InvalidArgumentError(absl::StrCat(
         "Malformed `--target_args` argument: ", toString(std::move(err))));
@@ -233,6 +531,21 @@ absl::StatusOr<Cmdline> Cmdline::CreateFromArgs(
       }
       cmdline.target_to_features_[BazelLabel(target)].insert(feature);
     }
+    for (const std::string& instantiation : it.instantiations) {
+      if (instantiation.empty()) {
+        return absl::InvalidArgumentError(
+            "Expected `i` (instantiation) fields of `--target_args` to be an "
+            "array of non-empty strings");
+      }
+      auto [it, inserted] = cmdline.instantiations_to_targets_.try_emplace(
+          instantiation, BazelLabel(target));
+      if (!inserted) {
+        return absl::InvalidArgumentError(absl::StrCat(
+            "The `--target_args` cmdline argument assigns `", instantiation,
+            "` instantiation to two conflicting targets: `", target, "` vs `",
+            it->second.value(), "`"));
+      }
+    }
   }
 
   for (const HeaderName& public_header : cmdline.public_headers_) {
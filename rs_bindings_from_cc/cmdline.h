@@ -36,7 +36,25 @@ class Cmdline {
       std::string target_args_str, std::vector<std::string> extra_rs_srcs,
       std::vector<std::string> srcs_to_scan_for_instantiations,
       std::string instantiations_out, std::string error_report_out,
-      SourceLocationDocComment generate_source_location_in_doc_comment) {
+      SourceLocationDocComment generate_source_location_in_doc_comment,
+      std::string ir_cache_dir = "", std::string module_out = "",
+      std::vector<std::string> dependency_modules = {},
+      int codegen_threads = 1, bool format_cc_in_process = false,
+      FormatMode format_mode = FormatMode::Full,
+      std::vector<std::string> rs_out_shards = {},
+      std::vector<std::string> srcs_to_scan_for_used_names = {},
+      std::string timing_report_out = "", std::string trace_out = "",
+      bool lazy_dependency_imports = false,
+      LayoutAssertions layout_assertions = LayoutAssertions::PerItem,
+      bool omit_thunk_free_rs_api_impl = false,
+      std::string binary_ir_out = "", std::string binary_ir_in = "",
+      std::string nullability_inference_table = "",
+      std::string lifetime_summaries = "", std::string size_report_out = "",
+      std::string rustc_dep_externs = "",
+      std::string rustc_dep_externs_out = "", bool infer_nullability = false,
+      bool infer_lifetimes = false, int max_template_instantiations = 0,
+      int max_template_instantiation_depth = 0,
+      bool collapse_opaque_fields = false, std::string query_profile_out = "") {
     return CreateFromArgs(
         std::move(current_target), std::move(cc_out), std::move(rs_out),
         std::move(ir_out), std::move(namespaces_out),
@@ -45,7 +63,19 @@ class Cmdline {
         std::move(public_headers), std::move(target_args_str),
         std::move(extra_rs_srcs), std::move(srcs_to_scan_for_instantiations),
         std::move(instantiations_out), std::move(error_report_out),
-        generate_source_location_in_doc_comment);
+        generate_source_location_in_doc_comment, std::move(ir_cache_dir),
+        std::move(module_out), std::move(dependency_modules),
+        codegen_threads, format_cc_in_process, format_mode,
+        std::move(rs_out_shards), std::move(srcs_to_scan_for_used_names),
+        std::move(timing_report_out), std::move(trace_out),
+        lazy_dependency_imports, layout_assertions,
+        omit_thunk_free_rs_api_impl, std::move(binary_ir_out),
+        std::move(binary_ir_in), std::move(nullability_inference_table),
+        std::move(lifetime_summaries), std::move(size_report_out),
+        std::move(rustc_dep_externs), std::move(rustc_dep_externs_out),
+        infer_nullability, infer_lifetimes, max_template_instantiations,
+        max_template_instantiation_depth, collapse_opaque_fields,
+        std::move(query_profile_out));
   }
 
   Cmdline(const Cmdline&) = delete;
@@ -55,7 +85,12 @@ class Cmdline {
 
   absl::string_view cc_out() const { return cc_out_; }
   absl::string_view rs_out() const { return rs_out_; }
+  const std::vector<std::string>& rs_out_shards() const {
+    return rs_out_shards_;
+  }
   absl::string_view ir_out() const { return ir_out_; }
+  absl::string_view binary_ir_out() const { return binary_ir_out_; }
+  absl::string_view binary_ir_in() const { return binary_ir_in_; }
   absl::string_view namespaces_out() const { return namespaces_out_; }
   absl::string_view crubit_support_path() const { return crubit_support_path_; }
   absl::string_view clang_format_exe_path() const {
@@ -65,7 +100,38 @@ class Cmdline {
   absl::string_view rustfmt_config_path() const { return rustfmt_config_path_; }
   absl::string_view instantiations_out() const { return instantiations_out_; }
   absl::string_view error_report_out() const { return error_report_out_; }
+  absl::string_view size_report_out() const { return size_report_out_; }
+  absl::string_view query_profile_out() const { return query_profile_out_; }
+  absl::string_view timing_report_out() const { return timing_report_out_; }
+  absl::string_view trace_out() const { return trace_out_; }
+  absl::string_view ir_cache_dir() const { return ir_cache_dir_; }
+  absl::string_view nullability_inference_table() const {
+    return nullability_inference_table_;
+  }
+  absl::string_view lifetime_summaries() const { return lifetime_summaries_; }
+  bool infer_nullability() const { return infer_nullability_; }
+  bool infer_lifetimes() const { return infer_lifetimes_; }
+  int max_template_instantiations() const {
+    return max_template_instantiations_;
+  }
+  int max_template_instantiation_depth() const {
+    return max_template_instantiation_depth_;
+  }
+  absl::string_view rustc_dep_externs() const { return rustc_dep_externs_; }
+  absl::string_view rustc_dep_externs_out() const {
+    return rustc_dep_externs_out_;
+  }
+  absl::string_view module_out() const { return module_out_; }
   bool do_nothing() const { return do_nothing_; }
+  int codegen_threads() const { return codegen_threads_; }
+  bool format_cc_in_process() const { return format_cc_in_process_; }
+  bool lazy_dependency_imports() const { return lazy_dependency_imports_; }
+  FormatMode format_mode() const { return format_mode_; }
+  LayoutAssertions layout_assertions() const { return layout_assertions_; }
+  bool omit_thunk_free_rs_api_impl() const {
+    return omit_thunk_free_rs_api_impl_;
+  }
+  bool collapse_opaque_fields() const { return collapse_opaque_fields_; }
   SourceLocationDocComment generate_source_location_in_doc_comment() const {
     return generate_source_location_in_doc_comment_;
   }
@@ -81,6 +147,14 @@ class Cmdline {
     return srcs_to_scan_for_instantiations_;
   }
 
+  const std::vector<std::string>& srcs_to_scan_for_used_names() const {
+    return srcs_to_scan_for_used_names_;
+  }
+
+  const std::vector<std::string>& dependency_modules() const {
+    return dependency_modules_;
+  }
+
   const BazelLabel& current_target() const { return current_target_; }
 
   const absl::flat_hash_map<HeaderName, BazelLabel>& headers_to_targets()
@@ -88,6 +162,14 @@ class Cmdline {
     return headers_to_targets_;
   }
 
+  // Maps the C++ names of class template instantiations (as spelled in
+  // `GetClassTemplateSpecializationCcName` with `use_preferred_names=false`)
+  // to the targets whose bindings own them.
+  const absl::flat_hash_map<std::string, BazelLabel>&
+  instantiations_to_targets() const {
+    return instantiations_to_targets_;
+  }
+
   const absl::flat_hash_map<BazelLabel, absl::flat_hash_set<std::string>>&
   target_to_features() const {
     return target_to_features_;
@@ -105,29 +187,70 @@ class Cmdline {
       std::string target_args_str, std::vector<std::string> extra_rs_srcs,
       std::vector<std::string> srcs_to_scan_for_instantiations,
       std::string instantiations_out, std::string error_report_out,
-      SourceLocationDocComment generate_source_location_in_doc_comment);
+      SourceLocationDocComment generate_source_location_in_doc_comment,
+      std::string ir_cache_dir, std::string module_out,
+      std::vector<std::string> dependency_modules, int codegen_threads,
+      bool format_cc_in_process, FormatMode format_mode,
+      std::vector<std::string> rs_out_shards,
+      std::vector<std::string> srcs_to_scan_for_used_names,
+      std::string timing_report_out, std::string trace_out,
+      bool lazy_dependency_imports, LayoutAssertions layout_assertions,
+      bool omit_thunk_free_rs_api_impl, std::string binary_ir_out,
+      std::string binary_ir_in, std::string nullability_inference_table,
+      std::string lifetime_summaries, std::string size_report_out,
+      std::string rustc_dep_externs, std::string rustc_dep_externs_out,
+      bool infer_nullability, bool infer_lifetimes,
+      int max_template_instantiations, int max_template_instantiation_depth,
+      bool collapse_opaque_fields, std::string query_profile_out);
 
   absl::StatusOr<BazelLabel> FindHeader(const HeaderName& header) const;
 
   std::string cc_out_;
   std::string rs_out_;
+  std::vector<std::string> rs_out_shards_;
   std::string ir_out_;
+  std::string binary_ir_out_;
+  std::string binary_ir_in_;
   std::string crubit_support_path_;
   std::string clang_format_exe_path_;
   std::string rustfmt_exe_path_;
   std::string rustfmt_config_path_;
   std::string error_report_out_;
+  std::string size_report_out_;
+  std::string query_profile_out_;
+  std::string timing_report_out_;
+  std::string trace_out_;
+  std::string ir_cache_dir_;
+  std::string nullability_inference_table_;
+  std::string lifetime_summaries_;
+  std::string rustc_dep_externs_;
+  std::string rustc_dep_externs_out_;
+  std::string module_out_;
+  std::vector<std::string> dependency_modules_;
   bool do_nothing_ = true;
+  int codegen_threads_ = 1;
+  bool format_cc_in_process_ = false;
+  bool lazy_dependency_imports_ = false;
+  bool infer_nullability_ = false;
+  bool infer_lifetimes_ = false;
+  int max_template_instantiations_ = 0;
+  int max_template_instantiation_depth_ = 0;
+  FormatMode format_mode_ = FormatMode::Full;
+  LayoutAssertions layout_assertions_ = LayoutAssertions::PerItem;
+  bool omit_thunk_free_rs_api_impl_ = false;
+  bool collapse_opaque_fields_ = false;
   SourceLocationDocComment generate_source_location_in_doc_comment_ =
       SourceLocationDocComment::Enabled;
 
   BazelLabel current_target_;
   std::vector<HeaderName> public_headers_;
   absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets_;
+  absl::flat_hash_map<std::string, BazelLabel> instantiations_to_targets_;
 
   std::vector<std::string> extra_rs_srcs_;
 
   std::vector<std::string> srcs_to_scan_for_instantiations_;
+  std::vector<std::string> srcs_to_scan_for_used_names_;
   std::string instantiations_out_;
 
   std::string namespaces_out_;
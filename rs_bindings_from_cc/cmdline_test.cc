@@ -12,9 +12,11 @@
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "common/ffi_types.h"
 #include "common/status_test_matchers.h"
+#include "common/test_utils.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/ir.h"
 
@@ -24,6 +26,7 @@ namespace {
 using ::testing::AllOf;
 using ::testing::ElementsAre;
 using ::testing::HasSubstr;
+using ::testing::IsEmpty;
 using ::testing::Pair;
 using ::testing::UnorderedElementsAre;
 
@@ -173,6 +176,33 @@ TEST(CmdlineTest, TargetArgsDuplicateHeader) {
   }
 }
 
+TEST(CmdlineTest, TargetArgsFromFile) {
+  std::string path = WriteFileForCurrentTest("target_args.json", R"([
+      {"t": "//:t1", "h": ["h1"], "f": ["supported"]},
+      {"t": "//:t2", "h": ["h2"]} ])");
+  ASSERT_OK_AND_ASSIGN(Cmdline cmdline,
+                       TestCmdline("//:t1", {"h1"}, absl::StrCat("@", path)));
+  EXPECT_THAT(
+      cmdline.headers_to_targets(),
+      UnorderedElementsAre(Pair(HeaderName("h1"), BazelLabel("//:t1")),
+                           Pair(HeaderName("h2"), BazelLabel("//:t2"))));
+}
+
+TEST(CmdlineTest, TargetArgsFromMissingFile) {
+  ASSERT_THAT(TestCmdline({"h1"}, "@does/not/exist.json"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       AllOf(HasSubstr("--target_args"),
+                             HasSubstr("does/not/exist.json"))));
+}
+
+TEST(CmdlineTest, TargetArgsFromFileWithInvalidJson) {
+  std::string path = WriteFileForCurrentTest("target_args.json", "#!$%");
+  ASSERT_THAT(TestCmdline({"h1"}, absl::StrCat("@", path)),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       AllOf(HasSubstr("--target_args"),
+                             HasSubstr("Invalid JSON"))));
+}
+
 TEST(CmdlineTest, PublicHeadersEmpty) {
   constexpr absl::string_view kTargetsAndHeaders = R"([
     {"t": "//:target1", "h": ["a.h", "b.h"]}
@@ -242,6 +272,32 @@ TEST(CmdlineTest, TargetArgsIntInsteadOfFeature) {
                      HasSubstr("string"))));
 }
 
+TEST(CmdlineTest, TargetArgsInstantiations) {
+  ASSERT_OK_AND_ASSIGN(Cmdline cmdline, TestCmdline({"h1"}, R"([
+      {"t": "//:target", "h": ["h1"]},
+      {"t": "//:instantiations", "i": ["A<int>", "B<char>"]} ])"));
+  EXPECT_THAT(
+      cmdline.instantiations_to_targets(),
+      UnorderedElementsAre(Pair("A<int>", BazelLabel("//:instantiations")),
+                           Pair("B<char>", BazelLabel("//:instantiations"))));
+}
+
+TEST(CmdlineTest, TargetArgsEmptyInstantiation) {
+  ASSERT_THAT(TestCmdline({"h1"}, R"([
+                {"t": "t1", "h": ["h1"], "i": ["", "A<int>"]}])"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       AllOf(HasSubstr("--target_args"), HasSubstr("`i`"),
+                             HasSubstr("empty string"))));
+}
+
+TEST(CmdlineTest, TargetArgsDuplicateInstantiation) {
+  ASSERT_THAT(TestCmdline({"h1"}, R"([
+                {"t": "t1", "h": ["h1"], "i": ["A<int>"]},
+                {"t": "t2", "i": ["A<int>"]}])"),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       AllOf(HasSubstr("A<int>"), HasSubstr("conflicting"))));
+}
+
 TEST(CmdlineTest, InstantiationsOutEmpty) {
   constexpr absl::string_view kTargetsAndHeaders = R"([
     {"t": "//:target1", "h": ["a.h", "b.h"]}
@@ -370,5 +426,208 @@ TEST(CmdlineTest, RustfmtExePathEmpty) {
       StatusIs(absl::StatusCode::kInvalidArgument,
                HasSubstr("please specify --rustfmt_exe_path")));
 }
+
+TEST(CmdlineTest, FormatterExePathsEmptyWithFastFormat) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "//:target1", "h": ["a.h", "b.h"]}
+  ])";
+  ASSERT_OK_AND_ASSIGN(
+      Cmdline cmdline,
+      Cmdline::CreateForTesting(
+          "//:target1", "cc_out", "rs_out", "ir_out", "namespaces_out",
+          "crubit_support_path", /* clang_format_exe_path= */ "",
+          /* rustfmt_exe_path= */ "", /* rustfmt_config_path= */ "",
+          /* do_nothing= */ false, {"a.h"}, std::string(kTargetsAndHeaders),
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "", "error_report_out",
+          SourceLocationDocComment::Enabled, /* ir_cache_dir= */ "",
+          /* module_out= */ "", /* dependency_modules= */ {},
+          /* codegen_threads= */ 1, /* format_cc_in_process= */ false,
+          FormatMode::Fast));
+  EXPECT_EQ(cmdline.format_mode(), FormatMode::Fast);
+}
+
+TEST(CmdlineTest, CodegenThreadsZero) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "//:target1", "h": ["a.h", "b.h"]}
+  ])";
+  ASSERT_THAT(
+      Cmdline::CreateForTesting(
+          "//:target1", "cc_out", "rs_out", "ir_out", "namespaces_out",
+          "crubit_support_path", "clang_format_exe_path", "rustfmt_exe_path",
+          "rustfmt_config_path",
+          /* do_nothing= */ false, {"a.h"}, std::string(kTargetsAndHeaders),
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "", "error_report_out",
+          SourceLocationDocComment::Enabled, /* ir_cache_dir= */ "",
+          /* module_out= */ "", /* dependency_modules= */ {},
+          /* codegen_threads= */ 0),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("please specify a positive number of "
+                         "--codegen_threads")));
+}
+
+TEST(CmdlineTest, RsOutShardsInOtherDirectory) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "//:target1", "h": ["a.h", "b.h"]}
+  ])";
+  ASSERT_THAT(
+      Cmdline::CreateForTesting(
+          "//:target1", "cc_out", "out/rs_out.rs", "ir_out", "namespaces_out",
+          "crubit_support_path", "clang_format_exe_path", "rustfmt_exe_path",
+          "rustfmt_config_path",
+          /* do_nothing= */ false, {"a.h"}, std::string(kTargetsAndHeaders),
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "", "error_report_out",
+          SourceLocationDocComment::Enabled, /* ir_cache_dir= */ "",
+          /* module_out= */ "", /* dependency_modules= */ {},
+          /* codegen_threads= */ 1, /* format_cc_in_process= */ false,
+          FormatMode::Full,
+          /* rs_out_shards= */ {"out/rs_out_shard_0.rs", "rs_out_shard_1.rs"}),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("please specify --rs_out_shards in the directory of "
+                         "--rs_out")));
+}
+
+TEST(CmdlineTest, BinaryIrOutWithoutRsOutAndCcOut) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "//:target1", "h": ["a.h", "b.h"]}
+  ])";
+  ASSERT_OK_AND_ASSIGN(
+      Cmdline cmdline,
+      Cmdline::CreateForTesting(
+          "//:target1", /* cc_out= */ "", /* rs_out= */ "", /* ir_out= */ "",
+          "namespaces_out", /* crubit_support_path= */ "",
+          /* clang_format_exe_path= */ "", /* rustfmt_exe_path= */ "",
+          /* rustfmt_config_path= */ "",
+          /* do_nothing= */ false, {"a.h"}, std::string(kTargetsAndHeaders),
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "", /* error_report_out= */ "",
+          SourceLocationDocComment::Enabled, /* ir_cache_dir= */ "",
+          /* module_out= */ "", /* dependency_modules= */ {},
+          /* codegen_threads= */ 1, /* format_cc_in_process= */ false,
+          FormatMode::Full, /* rs_out_shards= */ {},
+          /* srcs_to_scan_for_used_names= */ {}, /* timing_report_out= */ "",
+          /* trace_out= */ "", /* lazy_dependency_imports= */ false,
+          LayoutAssertions::PerItem,
+          /* omit_thunk_free_rs_api_impl= */ false,
+          /* binary_ir_out= */ "binary_ir_out"));
+  EXPECT_EQ(cmdline.binary_ir_out(), "binary_ir_out");
+  EXPECT_THAT(cmdline.rs_out(), IsEmpty());
+  EXPECT_THAT(cmdline.cc_out(), IsEmpty());
+}
+
+TEST(CmdlineTest, BinaryIrInWithoutPublicHeadersAndTargetArgs) {
+  ASSERT_OK_AND_ASSIGN(
+      Cmdline cmdline,
+      Cmdline::CreateForTesting(
+          "//:target1", "cc_out", "rs_out", /* ir_out= */ "",
+          /* namespaces_out= */ "", "crubit_support_path",
+          "clang_format_exe_path", "rustfmt_exe_path", "rustfmt_config_path",
+          /* do_nothing= */ false, /* public_headers= */ {},
+          /* target_args_str= */ "", /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "", "error_report_out",
+          SourceLocationDocComment::Enabled, /* ir_cache_dir= */ "",
+          /* module_out= */ "", /* dependency_modules= */ {},
+          /* codegen_threads= */ 1, /* format_cc_in_process= */ false,
+          FormatMode::Full, /* rs_out_shards= */ {},
+          /* srcs_to_scan_for_used_names= */ {}, /* timing_report_out= */ "",
+          /* trace_out= */ "", /* lazy_dependency_imports= */ false,
+          LayoutAssertions::PerItem,
+          /* omit_thunk_free_rs_api_impl= */ false, /* binary_ir_out= */ "",
+          /* binary_ir_in= */ "binary_ir_in"));
+  EXPECT_EQ(cmdline.binary_ir_in(), "binary_ir_in");
+  EXPECT_THAT(cmdline.public_headers(), IsEmpty());
+}
+
+TEST(CmdlineTest, BinaryIrInWithNamespacesOut) {
+  ASSERT_THAT(
+      Cmdline::CreateForTesting(
+          "//:target1", "cc_out", "rs_out", /* ir_out= */ "", "namespaces_out",
+          "crubit_support_path", "clang_format_exe_path", "rustfmt_exe_path",
+          "rustfmt_config_path",
+          /* do_nothing= */ false, /* public_headers= */ {},
+          /* target_args_str= */ "", /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "", "error_report_out",
+          SourceLocationDocComment::Enabled, /* ir_cache_dir= */ "",
+          /* module_out= */ "", /* dependency_modules= */ {},
+          /* codegen_threads= */ 1, /* format_cc_in_process= */ false,
+          FormatMode::Full, /* rs_out_shards= */ {},
+          /* srcs_to_scan_for_used_names= */ {}, /* timing_report_out= */ "",
+          /* trace_out= */ "", /* lazy_dependency_imports= */ false,
+          LayoutAssertions::PerItem,
+          /* omit_thunk_free_rs_api_impl= */ false, /* binary_ir_out= */ "",
+          /* binary_ir_in= */ "binary_ir_in"),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("please don't specify --namespaces_out together "
+                         "with --binary_ir_in")));
+}
+
+TEST(CmdlineTest, RustcDepExternsWithoutRustcDepExternsOut) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "//:target1", "h": ["a.h", "b.h"]}
+  ])";
+  ASSERT_THAT(
+      Cmdline::CreateForTesting(
+          "//:target1", "cc_out", "rs_out", "ir_out", "namespaces_out",
+          "crubit_support_path", "clang_format_exe_path", "rustfmt_exe_path",
+          "rustfmt_config_path",
+          /* do_nothing= */ false, {"a.h"}, std::string(kTargetsAndHeaders),
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "", "error_report_out",
+          SourceLocationDocComment::Enabled, /* ir_cache_dir= */ "",
+          /* module_out= */ "", /* dependency_modules= */ {},
+          /* codegen_threads= */ 1, /* format_cc_in_process= */ false,
+          FormatMode::Full, /* rs_out_shards= */ {},
+          /* srcs_to_scan_for_used_names= */ {}, /* timing_report_out= */ "",
+          /* trace_out= */ "", /* lazy_dependency_imports= */ false,
+          LayoutAssertions::PerItem,
+          /* omit_thunk_free_rs_api_impl= */ false, /* binary_ir_out= */ "",
+          /* binary_ir_in= */ "", /* nullability_inference_table= */ "",
+          /* lifetime_summaries= */ "", /* size_report_out= */ "",
+          /* rustc_dep_externs= */ "rustc_dep_externs"),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("please specify both --rustc_dep_externs and "
+                         "--rustc_dep_externs_out")));
+}
+
+TEST(CmdlineTest, InferNullabilityWithNullabilityInferenceTable) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "//:target1", "h": ["a.h", "b.h"]}
+  ])";
+  ASSERT_THAT(
+      Cmdline::CreateForTesting(
+          "//:target1", "cc_out", "rs_out", "ir_out", "namespaces_out",
+          "crubit_support_path", "clang_format_exe_path", "rustfmt_exe_path",
+          "rustfmt_config_path",
+          /* do_nothing= */ false, {"a.h"}, std::string(kTargetsAndHeaders),
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "", "error_report_out",
+          SourceLocationDocComment::Enabled, /* ir_cache_dir= */ "",
+          /* module_out= */ "", /* dependency_modules= */ {},
+          /* codegen_threads= */ 1, /* format_cc_in_process= */ false,
+          FormatMode::Full, /* rs_out_shards= */ {},
+          /* srcs_to_scan_for_used_names= */ {}, /* timing_report_out= */ "",
+          /* trace_out= */ "", /* lazy_dependency_imports= */ false,
+          LayoutAssertions::PerItem,
+          /* omit_thunk_free_rs_api_impl= */ false, /* binary_ir_out= */ "",
+          /* binary_ir_in= */ "",
+          /* nullability_inference_table= */ "inferences.nullinf",
+          /* lifetime_summaries= */ "", /* size_report_out= */ "",
+          /* rustc_dep_externs= */ "", /* rustc_dep_externs_out= */ "",
+          /* infer_nullability= */ true),
+      StatusIs(absl::StatusCode::kInvalidArgument,
+               HasSubstr("please don't specify --infer_nullability together "
+                         "with --nullability_inference_table")));
+}
+
 }  // namespace
 }  // namespace crubit
@@ -16,32 +16,50 @@
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/JSON.h"
 
-// This function is implemented in Rust.
+// These functions are implemented in Rust.
 extern "C" crubit::FfiU8SliceBox CollectInstantiationsImpl(
     crubit::FfiU8Slice json);
+extern "C" crubit::FfiU8SliceBox CollectIdentifiersImpl(
+    crubit::FfiU8Slice json);
 
 namespace crubit {
 
-absl::StatusOr<std::vector<std::string>> CollectInstantiations(
-    absl::Span<const std::string> rust_sources) {
+namespace {
+
+// Passes `rust_sources` to `collect_impl`, and returns the strings it collects.
+absl::StatusOr<std::vector<std::string>> CollectFromRustSources(
+    absl::Span<const std::string> rust_sources,
+    FfiU8SliceBox (*collect_impl)(FfiU8Slice)) {
   llvm::json::Value rust_sources_json = llvm::json::Array(rust_sources);
   std::string json = llvm::formatv("{0}", rust_sources_json);
-  FfiU8SliceBox result = CollectInstantiationsImpl(MakeFfiU8Slice(json));
+  FfiU8SliceBox result = collect_impl(MakeFfiU8Slice(json));
   std::string result_string = std::string(result.ptr, result.size);
-  llvm::Expected<llvm::json::Value> expected_instantiations =
+  FreeFfiU8SliceBox(result);
+  llvm::Expected<llvm::json::Value> expected_results =
       llvm::json::parse(result_string);
-  if (auto error = expected_instantiations.takeError()) {
+  if (auto error = expected_results.takeError()) {
     return absl::InternalError(llvm::toString(std::move(error)));
   }
 
-  llvm::json::Value instantiations = *expected_instantiations;
-  FreeFfiU8SliceBox(result);
-  std::vector<std::string> instantiations_vector;
+  llvm::json::Value results = *expected_results;
+  std::vector<std::string> results_vector;
   llvm::json::Path::Root root;
-  if (llvm::json::fromJSON(instantiations, instantiations_vector, root)) {
-    return instantiations_vector;
+  if (llvm::json::fromJSON(results, results_vector, root)) {
+    return results_vector;
   }
   return absl::InternalError(llvm::toString(root.getError()));
 }
 
+}  // namespace
+
+absl::StatusOr<std::vector<std::string>> CollectInstantiations(
+    absl::Span<const std::string> rust_sources) {
+  return CollectFromRustSources(rust_sources, CollectInstantiationsImpl);
+}
+
+absl::StatusOr<std::vector<std::string>> CollectIdentifiers(
+    absl::Span<const std::string> rust_sources) {
+  return CollectFromRustSources(rust_sources, CollectIdentifiersImpl);
+}
+
 }  // namespace crubit
@@ -19,6 +19,11 @@ namespace crubit {
 absl::StatusOr<std::vector<std::string>> CollectInstantiations(
     absl::Span<const std::string> rust_sources);
 
+// Parses Rust source files given their filenames and returns a vector with all
+// identifiers used in them, sorted and without duplicates.
+absl::StatusOr<std::vector<std::string>> CollectIdentifiers(
+    absl::Span<const std::string> rust_sources);
+
 }  // namespace crubit
 
 #endif  // CRUBIT_RS_BINDINGS_FROM_CC_COLLECT_INSTANTIATIONS_H_
@@ -5,13 +5,20 @@
 use arc_anyhow::{Context, Result};
 use ffi_types::FfiU8Slice;
 use ffi_types::FfiU8SliceBox;
+use once_cell::sync::Lazy;
 use proc_macro2::TokenStream;
 use proc_macro2::TokenTree;
-use std::collections::HashSet;
+use std::collections::hash_map::DefaultHasher;
+use std::collections::{HashMap, HashSet};
 use std::fs;
-use std::panic::catch_unwind;
-use std::path::PathBuf;
+use std::hash::{Hash, Hasher};
+use std::num::NonZeroUsize;
+use std::panic::{self, catch_unwind};
+use std::path::{Path, PathBuf};
 use std::process;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread;
 
 /// Parses given files and returns a Json list with all  C++ class
 /// template instantiations requested by calls to the `cc_template!` macro.
@@ -45,20 +52,149 @@ pub unsafe extern "C" fn CollectInstantiationsImpl(json: FfiU8Slice) -> FfiU8Sli
     .unwrap_or_else(|_| process::abort())
 }
 
+/// Parses given files and returns a Json list with all identifiers used in
+/// them.
+///
+/// This function panics on error.
+///
+/// # Safety
+///
+/// Same as for `CollectInstantiationsImpl`.
+#[no_mangle]
+pub unsafe extern "C" fn CollectIdentifiersImpl(json: FfiU8Slice) -> FfiU8SliceBox {
+    catch_unwind(|| {
+        let filenames: Vec<PathBuf> = serde_json::from_reader(json.as_slice())
+            .with_context(|| {
+                let json_str = std::str::from_utf8(json.as_slice()).unwrap();
+                format!("Couldn't deserialize json '{}'", json_str)
+            })
+            .unwrap();
+        let identifiers = collect_identifiers_impl(filenames).unwrap();
+        let result_json = serde_json::to_string(&identifiers).unwrap();
+        FfiU8SliceBox::from_boxed_slice(result_json.into_bytes().into_boxed_slice())
+    })
+    .unwrap_or_else(|_| process::abort())
+}
+
 fn collect_instantiations_impl(filenames: Vec<PathBuf>) -> Result<Vec<String>> {
+    static CACHE: FileResultsCache = Lazy::new(Default::default);
+    collect_from_files(filenames, find_cc_template_calls, &CACHE)
+}
+
+fn collect_identifiers_impl(filenames: Vec<PathBuf>) -> Result<Vec<String>> {
+    static CACHE: FileResultsCache = Lazy::new(Default::default);
+    collect_from_files(filenames, find_identifiers, &CACHE)
+}
+
+/// Identifies the contents of a file.
+#[derive(Clone, Copy, PartialEq, Eq, Hash)]
+struct ContentKey {
+    hash: u64,
+    len: usize,
+}
+
+impl ContentKey {
+    fn new(content: &str) -> Self {
+        let mut hasher = DefaultHasher::new();
+        content.hash(&mut hasher);
+        ContentKey { hash: hasher.finish(), len: content.len() }
+    }
+}
+
+/// The results of a `find` function for each file content it was run on, so
+/// that a process running many times (e.g. a persistent worker) only parses
+/// the files that changed.
+type FileResultsCache = Lazy<Mutex<HashMap<ContentKey, Arc<HashSet<String>>>>>;
+
+/// Parses the given files, and returns the sorted, deduplicated results that
+/// `find` collects from them.
+///
+/// The files are parsed in parallel. If several files fail, the error of the
+/// first one (in the order of `filenames`) is returned.
+fn collect_from_files(
+    filenames: Vec<PathBuf>,
+    find: fn(TokenStream, &mut HashSet<String>),
+    cache: &FileResultsCache,
+) -> Result<Vec<String>> {
+    let num_threads =
+        thread::available_parallelism().map_or(1, NonZeroUsize::get).min(filenames.len());
+    let next_index = AtomicUsize::new(0);
+    let next_index = &next_index;
+    let filenames = &filenames;
+    let worker_results = thread::scope(|scope| {
+        let workers = (0..num_threads)
+            .map(|_| {
+                scope.spawn(move || {
+                    let mut file_results = vec![];
+                    loop {
+                        let index = next_index.fetch_add(1, Ordering::Relaxed);
+                        let Some(filename) = filenames.get(index) else {
+                            break;
+                        };
+                        file_results.push((index, collect_from_file(filename, find, cache)));
+                    }
+                    file_results
+                })
+            })
+            .collect::<Vec<_>>();
+        workers
+            .into_iter()
+            .map(|worker| worker.join().unwrap_or_else(|payload| panic::resume_unwind(payload)))
+            .collect::<Vec<_>>()
+    });
+    let mut file_results = worker_results.into_iter().flatten().collect::<Vec<_>>();
+    file_results.sort_by_key(|(index, _)| *index);
+
     let mut result = HashSet::<String>::new();
-    for filename in filenames {
-        let content = fs::read_to_string(&filename)
-            .with_context(|| format!("Couldn't read '{}'", filename.display()))?;
-        let token_stream = syn::parse_str(&content)
-            .with_context(|| format!("Couldn't parse the file '{}'", filename.display()))?;
-        find_cc_template_calls(token_stream, &mut result);
+    for (_, file_result) in file_results {
+        result.extend(file_result?.iter().cloned());
     }
     let mut result_vec = result.into_iter().collect::<Vec<_>>();
     result_vec.sort();
     Ok(result_vec)
 }
 
+/// Returns the results that `find` collects from `filename`, parsing it only
+/// if `cache` doesn't have them yet.
+fn collect_from_file(
+    filename: &Path,
+    find: fn(TokenStream, &mut HashSet<String>),
+    cache: &FileResultsCache,
+) -> Result<Arc<HashSet<String>>> {
+    let content = fs::read_to_string(filename)
+        .with_context(|| format!("Couldn't read '{}'", filename.display()))?;
+    let key = ContentKey::new(&content);
+    if let Some(results) = cache.lock().unwrap().get(&key) {
+        return Ok(results.clone());
+    }
+    let token_stream = syn::parse_str(&content)
+        .with_context(|| format!("Couldn't parse the file '{}'", filename.display()))?;
+    let mut results = HashSet::new();
+    find(token_stream, &mut results);
+    let results = Arc::new(results);
+    cache.lock().unwrap().insert(key, results.clone());
+    Ok(results)
+}
+
+/// Collects all identifiers in `input`, including the ones in macro calls.
+///
+/// This over-approximates the C++ names used by the Rust code (e.g. it also
+/// collects the names of local variables), but doesn't depend on how the
+/// bindings crate is named or imported.
+fn find_identifiers(input: TokenStream, results: &mut HashSet<String>) {
+    for token in input {
+        match token {
+            TokenTree::Ident(ident) => {
+                let ident = ident.to_string();
+                let ident = ident.strip_prefix("r#").map(str::to_string).unwrap_or(ident);
+                results.insert(ident);
+            }
+            TokenTree::Group(group) => find_identifiers(group.stream(), results),
+            TokenTree::Punct(_) | TokenTree::Literal(_) => {}
+        }
+    }
+}
+
 fn find_cc_template_calls(input: TokenStream, results: &mut HashSet<String>) {
     let mut iter = input.into_iter();
     while let Some(next) = iter.next() {
@@ -67,22 +203,8 @@ fn find_cc_template_calls(input: TokenStream, results: &mut HashSet<String>) {
         let macro_tokens = std::iter::once(next.clone()).chain(iter.clone().take(2)).collect();
         if let Ok(m) = syn::parse2::<syn::Macro>(macro_tokens) {
             if m.path.is_ident("cc_template") {
-                // In theory `TokenStream` -> `instantiation_name` translation could go through
-                // `token_stream_printer::tokens_to_string`.  This route is not used because:
-                // - The dependencies it would bring would run into b/216638047
-                // - Extra functionality from that route is not needed (e.g. no need for
-                //   `__COMMENT__`-aware or `__SPACE__`-aware processing, nor for special
-                //   handling of `TokenTree::Group`).
-                //
-                // TODO(lukasza, hlopko): In the future, extra canonicalization might be
-                // considered, so that `std::vector<int>`, and `std::vector<(int)>`, and
-                // `std::vector<int32_t>` are treated as equivalent.
-                //
-                // TODO(lukasza, hlopko): More explicitly ensure that the same canonicalization
-                // (e.g. TokenStream->String transformation) is used here and in
-                // `cc_template/cc_template_impl.rs`.
-                let instantiation_name = m.tokens.to_string();
-
+                // `cc_template_impl.rs` looks the instantiation up with the same key.
+                let instantiation_name = cc_template_key::instantiation_key(m.tokens);
                 results.insert(instantiation_name);
             }
         }
@@ -175,6 +297,17 @@ mod tests {
         );
     }
 
+    #[test]
+    fn test_spelling_variants_are_collected_once() {
+        let result = write_file_and_collect_instantiations(quote! {
+            cc_template!(std::vector<int>);
+            cc_template!(::std::vector<std::int32_t>);
+            cc_template!(std::vector<signed int>);
+        })
+        .unwrap();
+        assert_eq!(result, vec!["std :: vector < int >".to_string()]);
+    }
+
     #[test]
     fn test_instantiations_in_subgroups() {
         let result = write_file_and_collect_instantiations(quote! {
@@ -206,6 +339,78 @@ mod tests {
         assert_eq!(result, vec!["std :: vector < Foo >".to_string(),]);
     }
 
+    #[test]
+    fn test_identifiers() {
+        let file = make_tmp_input_file(
+            "identifiers",
+            &quote! {
+                use cc_lib::ns::SomeStruct;
+                fn f(x: cc_lib::SomeEnum) -> i32 {
+                    cc_lib::r#type(cc_template!(std::vector<Foo>), x)
+                }
+            }
+            .to_string(),
+        );
+        assert_eq!(
+            collect_identifiers_impl(vec![file]).unwrap(),
+            vec![
+                "Foo",
+                "SomeEnum",
+                "SomeStruct",
+                "cc_lib",
+                "cc_template",
+                "f",
+                "fn",
+                "i32",
+                "ns",
+                "std",
+                "type",
+                "use",
+                "vector",
+                "x",
+            ],
+        );
+    }
+
+    #[test]
+    fn test_multiple_files() {
+        let files = (0..16)
+            .map(|i| {
+                make_tmp_input_file(
+                    &format!("multiple_files_{i}"),
+                    &format!("cc_template!(MyTemplate<{}>);", i % 4),
+                )
+            })
+            .collect::<Vec<_>>();
+        assert_eq!(
+            collect_instantiations_impl(files).unwrap(),
+            vec!["MyTemplate < 0 >", "MyTemplate < 1 >", "MyTemplate < 2 >", "MyTemplate < 3 >"]
+        );
+    }
+
+    #[test]
+    fn test_first_error_is_reported() {
+        let good = make_tmp_input_file("good", "cc_template!(MyTemplate<int>);");
+        let bad1 = make_tmp_input_file("bad1", "This is not (Rust>!");
+        let bad2 = make_tmp_input_file("bad2", "Neither is this (Rust>!");
+        let err = collect_instantiations_impl(vec![good, bad1.clone(), bad2]).unwrap_err();
+        assert_eq!(
+            format!("{:#}", err),
+            format!("Couldn't parse the file '{}': lex error", bad1.display())
+        );
+    }
+
+    #[test]
+    fn test_changed_file_is_parsed_again() {
+        let file = make_tmp_input_file("changed", "cc_template!(MyTemplate<int>);");
+        assert_eq!(
+            collect_instantiations_impl(vec![file.clone()]).unwrap(),
+            vec!["MyTemplate < int >"]
+        );
+        fs::write(&file, "cc_template!(MyTemplate<bool>);").unwrap();
+        assert_eq!(collect_instantiations_impl(vec![file]).unwrap(), vec!["MyTemplate < bool >"]);
+    }
+
     fn collect_instantiations_from_json(json: &str) -> String {
         let u8_slice = unsafe {
             CollectInstantiationsImpl(FfiU8Slice::from_slice(json.as_bytes())).into_boxed_slice()
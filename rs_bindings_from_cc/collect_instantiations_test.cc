@@ -32,5 +32,13 @@ TEST(CollectInstantiationsTest, ReturnInstantiationsFromRustTest) {
               IsOkAndHolds(ElementsAre(StrEq("std :: vector < bool >"))));
 }
 
+TEST(CollectIdentifiersTest, ReturnIdentifiersFromRustTest) {
+  std::string path =
+      WriteFileForCurrentTest("a.rs", "fn f() { cc_lib::ns::g(); }");
+  EXPECT_THAT(CollectIdentifiers({std::move(path)}),
+              IsOkAndHolds(ElementsAre(StrEq("cc_lib"), StrEq("f"),
+                                       StrEq("fn"), StrEq("g"), StrEq("ns"))));
+}
+
 }  // namespace
 }  // namespace crubit
@@ -5,6 +5,7 @@
 #ifndef CRUBIT_RS_BINDINGS_FROM_CC_DECL_IMPORTER_H_
 #define CRUBIT_RS_BINDINGS_FROM_CC_DECL_IMPORTER_H_
 
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <set>
@@ -14,11 +15,15 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "lifetime_annotations/lifetime_annotations.h"
 #include "lifetime_annotations/type_lifetimes.h"
+#include "nullability/inference/inference_table.h"
 #include "rs_bindings_from_cc/bazel_types.h"
+#include "rs_bindings_from_cc/chrome_trace.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
 #include "clang/AST/DeclBase.h"
 #include "clang/AST/Type.h"
 #include "clang/Basic/SourceLocation.h"
@@ -26,6 +31,18 @@
 
 namespace crubit {
 
+// Hit and miss counts of the importer's type conversion cache.
+struct TypeConversionCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+};
+
+// Hit and miss counts of the importer's cache of mangled names.
+struct MangledNameCacheStats {
+  int64_t hits = 0;
+  int64_t misses = 0;
+};
+
 // Top-level parameters as well as return value of an importer invocation.
 class Invocation {
  public:
@@ -52,6 +69,21 @@ class Invocation {
                                          : std::nullopt;
   }
 
+  // Returns the target owning the bindings of the class template
+  // instantiation named `cc_name`, if it was assigned one.
+  std::optional<BazelLabel> instantiation_target(
+      absl::string_view cc_name) const {
+    if (instantiation_targets_ == nullptr) return std::nullopt;
+    auto it = instantiation_targets_->find(cc_name);
+    return (it != instantiation_targets_->end()) ? std::optional(it->second)
+                                                 : std::nullopt;
+  }
+
+  bool has_instantiation_targets() const {
+    return instantiation_targets_ != nullptr &&
+           !instantiation_targets_->empty();
+  }
+
   // The main target from which we are importing.
   const BazelLabel target_;
 
@@ -65,6 +97,55 @@ class Invocation {
   // The main output of the import process
   IR ir_;
 
+  // How often converting a type could reuse an earlier conversion.
+  TypeConversionCacheStats type_conversion_cache_stats_;
+
+  // How often a mangled name could be reused instead of mangling it again.
+  MangledNameCacheStats mangled_name_cache_stats_;
+
+  // If non-null, receives the time spent in the phases of the import.
+  TimingReport* timing_report_ = nullptr;
+
+  // If non-null, receives a span for the import of each decl.
+  ChromeTrace* trace_ = nullptr;
+
+  // If non-null, maps the C++ names of class template instantiations to the
+  // targets owning their bindings (see `IrFromCcOptions`).
+  const absl::flat_hash_map<std::string, BazelLabel>* instantiation_targets_ =
+      nullptr;
+
+  // If true, decls of other targets are only imported when the decls of
+  // `target_` refer to them, rather than every decl the headers declare.
+  bool lazy_dependency_imports_ = false;
+
+  // If non-null, the nullability inferred for functions: pointer parameters
+  // and return types inferred to be non-null aren't bound as `Option`s.
+  const clang::tidy::nullability::InferenceTable* nullability_inferences_ =
+      nullptr;
+
+  // If true, `AstConsumer` infers the nullability of the functions in the
+  // headers before importing them, into `inferred_nullability_`, and points
+  // `nullability_inferences_` at it.
+  bool infer_nullability_ = false;
+  std::optional<clang::tidy::nullability::InferenceTable>
+      inferred_nullability_;
+
+  // If true, `AstConsumer` runs lifetime_analysis before importing the
+  // headers, and adds the lifetimes it infers to the summaries of
+  // `lifetime_context_`.
+  bool infer_lifetimes_ = false;
+
+  // If positive, the maximum number of class template specializations that
+  // are instantiated and imported because the types of the decls refer to
+  // them, and the maximum number of those that are imported within each
+  // other's import (e.g. for the types of their members).
+  int max_template_instantiations_ = 0;
+  int max_template_instantiation_depth_ = 0;
+
+  // The names of the class template specializations that weren't imported
+  // because of these limits, in the order they were skipped in.
+  std::vector<std::string> skipped_template_instantiations_;
+
  private:
   const absl::flat_hash_map<HeaderName, BazelLabel>& header_targets_;
 };
@@ -96,10 +177,13 @@ class ImportContext {
   virtual std::optional<IR::Item> ImportDecl(clang::Decl* decl) = 0;
 
   // Returns the Item of a Decl, importing it first if necessary.
-  // Updates the cache.
-  virtual std::optional<IR::Item> GetDeclItem(clang::Decl* decl) = 0;
+  // Updates the cache. The returned reference points into the cache, and stays
+  // valid while more decls are imported.
+  virtual const std::optional<IR::Item>& GetDeclItem(clang::Decl* decl) = 0;
 
-  virtual std::optional<IR::Item> GetImportedItem(const clang::Decl* decl) = 0;
+  // Returns the Item of a Decl that was already imported, or null if there is
+  // none.
+  virtual const IR::Item* GetImportedItem(const clang::Decl* decl) = 0;
 
   // Imports children of `decl`.
   //
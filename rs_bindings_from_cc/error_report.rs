@@ -117,7 +117,16 @@ pub trait ErrorReporting: std::fmt::Debug {
     /// Inserts a new error. Uses interior mutability so that references can be
     /// shared freely.
     fn insert(&self, error: &arc_anyhow::Error);
+    /// Inserts the errors of `report`, with the same result as inserting them
+    /// again in the order in which they were inserted into `report`.
+    fn merge(&self, report: ErrorReport);
     fn serialize_to_vec(&self) -> anyhow::Result<Vec<u8>>;
+
+    /// Returns whether inserted errors are recorded. If not, callers can skip
+    /// building errors that they only create to insert them.
+    fn is_enabled(&self) -> bool {
+        true
+    }
 }
 
 /// A null [`ErrorReporting`] strategy.
@@ -127,9 +136,15 @@ pub struct IgnoreErrors;
 impl ErrorReporting for IgnoreErrors {
     fn insert(&self, _error: &arc_anyhow::Error) {}
 
+    fn merge(&self, _report: ErrorReport) {}
+
     fn serialize_to_vec(&self) -> anyhow::Result<Vec<u8>> {
         Ok(vec![])
     }
+
+    fn is_enabled(&self) -> bool {
+        false
+    }
 }
 
 /// An aggregate of zero or more errors.
@@ -144,6 +159,11 @@ impl ErrorReport {
     pub fn new() -> Self {
         Self::default()
     }
+
+    /// Returns the errors inserted so far, and leaves this report empty.
+    pub fn take(&self) -> ErrorReport {
+        ErrorReport { map: RefCell::new(self.map.take()) }
+    }
 }
 
 impl ErrorReporting for ErrorReport {
@@ -164,6 +184,13 @@ impl ErrorReporting for ErrorReport {
         }
     }
 
+    fn merge(&self, report: ErrorReport) {
+        let mut map = self.map.borrow_mut();
+        for (fmt, entry) in report.map.into_inner() {
+            map.entry(fmt).or_default().merge(entry);
+        }
+    }
+
     fn serialize_to_vec(&self) -> anyhow::Result<Vec<u8>> {
         Ok(serde_json::to_vec(&*self.map.borrow())?)
     }
@@ -183,6 +210,13 @@ impl ErrorReportEntry {
         }
         self.count += 1;
     }
+
+    fn merge(&mut self, other: ErrorReportEntry) {
+        if self.count == 0 {
+            self.sample_message = other.sample_message;
+        }
+        self.count += other.count;
+    }
 }
 
 #[cfg(test)]
@@ -371,4 +405,39 @@ mod tests {
 }"#,
         );
     }
+
+    #[test]
+    fn error_report_merge() {
+        let errors = [
+            anyhow!("abc{}", "def"),
+            anyhow!("no parameters"),
+            anyhow!("abc{}", "123"),
+            anyhow!("error code: {}", 65535),
+            anyhow!("no parameters"),
+        ];
+        let expected = ErrorReport::new();
+        for error in &errors {
+            expected.insert(error);
+        }
+
+        let report = ErrorReport::new();
+        report.insert(&errors[0]);
+        let part = ErrorReport::new();
+        for error in &errors[1..4] {
+            part.insert(error);
+        }
+        report.merge(part.take());
+        assert!(part.map.borrow().is_empty());
+        let part = ErrorReport::new();
+        part.insert(&errors[4]);
+        report.merge(part);
+
+        assert_eq!(report.serialize_to_vec().unwrap(), expected.serialize_to_vec().unwrap());
+    }
+
+    #[test]
+    fn is_enabled() {
+        assert!(ErrorReport::new().is_enabled());
+        assert!(!IgnoreErrors.is_enabled());
+    }
 }
@@ -0,0 +1,181 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/file_system_cache.h"
+
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+namespace crubit {
+
+namespace {
+
+std::string CacheKey(const llvm::Twine& path) {
+  llvm::SmallString<256> key;
+  path.toVector(key);
+  llvm::sys::path::remove_dots(key, /*remove_dot_dot=*/false);
+  return std::string(key.str());
+}
+
+// A buffer sharing the contents of a cached one, which stay alive even if the
+// cache entry is dropped.
+class SharedMemoryBuffer : public llvm::MemoryBuffer {
+ public:
+  SharedMemoryBuffer(std::shared_ptr<const llvm::MemoryBuffer> contents,
+                     std::string name)
+      : contents_(std::move(contents)), name_(std::move(name)) {
+    init(contents_->getBufferStart(), contents_->getBufferEnd(),
+         /*RequiresNullTerminator=*/false);
+  }
+
+  llvm::StringRef getBufferIdentifier() const override { return name_; }
+  BufferKind getBufferKind() const override {
+    return contents_->getBufferKind();
+  }
+
+ private:
+  std::shared_ptr<const llvm::MemoryBuffer> contents_;
+  std::string name_;
+};
+
+class CachedFile : public llvm::vfs::File {
+ public:
+  CachedFile(llvm::vfs::Status status,
+             std::shared_ptr<const llvm::MemoryBuffer> contents)
+      : status_(std::move(status)), contents_(std::move(contents)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status() override { return status_; }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> getBuffer(
+      const llvm::Twine& name, int64_t file_size,
+      bool requires_null_terminator, bool is_volatile) override {
+    // The cached contents are always null-terminated.
+    return std::make_unique<SharedMemoryBuffer>(contents_, name.str());
+  }
+
+  std::error_code close() override { return std::error_code(); }
+
+ private:
+  llvm::vfs::Status status_;
+  std::shared_ptr<const llvm::MemoryBuffer> contents_;
+};
+
+// Drops the entries of `cache` which have no digest, or whose digest isn't
+// the one in `digests`.
+template <typename Entry>
+void DropChangedEntries(
+    absl::flat_hash_map<std::string, Entry>& cache,
+    const absl::flat_hash_map<std::string, std::string>& digests) {
+  for (auto it = cache.begin(); it != cache.end();) {
+    auto current = it++;
+    auto digest = digests.find(current->first);
+    if (!current->second.digest.has_value() || digest == digests.end() ||
+        *current->second.digest != digest->second) {
+      cache.erase(current);
+    }
+  }
+}
+
+}  // namespace
+
+FileSystemCache::FileSystemCache(
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base)
+    : ProxyFileSystem(std::move(base)) {}
+
+void FileSystemCache::SetInputDigests(
+    absl::flat_hash_map<std::string, std::string> digests) {
+  absl::MutexLock lock(&mutex_);
+  digests_ = std::move(digests);
+  DropChangedEntries(stat_cache_, digests_);
+  DropChangedEntries(file_cache_, digests_);
+}
+
+std::optional<std::string> FileSystemCache::GetDigest(
+    const std::string& key) const {
+  auto it = digests_.find(key);
+  if (it == digests_.end()) return std::nullopt;
+  return it->second;
+}
+
+llvm::ErrorOr<llvm::vfs::Status> FileSystemCache::status(
+    const llvm::Twine& path) {
+  std::string key = CacheKey(path);
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = stat_cache_.find(key);
+    if (it != stat_cache_.end()) return it->second.status;
+  }
+  // Two threads may both miss and stat the same path, with the same result.
+  llvm::ErrorOr<llvm::vfs::Status> status = ProxyFileSystem::status(path);
+  absl::MutexLock lock(&mutex_);
+  std::optional<std::string> digest = GetDigest(key);
+  return stat_cache_
+      .try_emplace(std::move(key),
+                   StatEntry{.status = std::move(status),
+                             .digest = std::move(digest)})
+      .first->second.status;
+}
+
+// `ProxyFileSystem` would forward `exists` without going through `status`.
+bool FileSystemCache::exists(const llvm::Twine& path) {
+  llvm::ErrorOr<llvm::vfs::Status> status = this->status(path);
+  return status && status->exists();
+}
+
+llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>>
+FileSystemCache::openFileForRead(const llvm::Twine& path) {
+  std::string key = CacheKey(path);
+  {
+    absl::MutexLock lock(&mutex_);
+    auto it = file_cache_.find(key);
+    if (it != file_cache_.end()) {
+      return std::make_unique<CachedFile>(it->second.status,
+                                          it->second.contents);
+    }
+  }
+  // Files which can't be read aren't cached, as it may be a transient error.
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> file =
+      ProxyFileSystem::openFileForRead(path);
+  if (!file) return file.getError();
+  llvm::ErrorOr<llvm::vfs::Status> status = (*file)->status();
+  if (!status) return status.getError();
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> contents =
+      (*file)->getBuffer(path, status->getSize(),
+                         /*RequiresNullTerminator=*/true, /*IsVolatile=*/false);
+  if (!contents) return contents.getError();
+
+  absl::MutexLock lock(&mutex_);
+  std::optional<std::string> digest = GetDigest(key);
+  const FileEntry& entry =
+      file_cache_
+          .try_emplace(std::move(key),
+                       FileEntry{.status = *status,
+                                 .contents = std::move(*contents),
+                                 .digest = std::move(digest)})
+          .first->second;
+  return std::make_unique<CachedFile>(entry.status, entry.contents);
+}
+
+std::error_code FileSystemCache::setCurrentWorkingDirectory(
+    const llvm::Twine& path) {
+  // Relative paths in the cache would refer to other files.
+  return std::make_error_code(std::errc::operation_not_permitted);
+}
+
+}  // namespace crubit
@@ -0,0 +1,83 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_FILE_SYSTEM_CACHE_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_FILE_SYSTEM_CACHE_H_
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+
+#include "absl/base/thread_annotations.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/synchronization/mutex.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+namespace crubit {
+
+// A file system which forwards to another one, but looks up the status of each
+// path (including whether it exists at all) and reads the contents of each
+// file only once. It can be passed in `IrFromCcOptions::file_system` to any
+// number of `IrFromCc` runs, so that the headers they have in common (e.g.
+// those of the standard library) are stat'ed and read once.
+//
+// Unlike a `clang::FileManager`, it is thread-safe, so that the targets of a
+// `--batch_manifest` can share it.
+//
+// Paths are cached as given (other than `.` components), so the working
+// directory can't be changed. Files are assumed not to change, unless
+// `SetInputDigests` is called, as when the files differ between work requests
+// of a persistent worker.
+class FileSystemCache : public llvm::vfs::ProxyFileSystem {
+ public:
+  explicit FileSystemCache(
+      llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base);
+
+  // Sets the digests of the files, keyed by their paths, as given in the
+  // `inputs` of a Bazel work request.
+  //
+  // From now on, only cache entries for files with the same digest as when
+  // they were cached are used: entries for files with another digest, or
+  // without a digest (including files which don't exist), are dropped.
+  void SetInputDigests(absl::flat_hash_map<std::string, std::string> digests);
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override;
+  bool exists(const llvm::Twine& path) override;
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(
+      const llvm::Twine& path) override;
+  std::error_code setCurrentWorkingDirectory(const llvm::Twine& path) override;
+
+ private:
+  struct StatEntry {
+    llvm::ErrorOr<llvm::vfs::Status> status;
+    std::optional<std::string> digest;
+  };
+
+  struct FileEntry {
+    llvm::vfs::Status status;
+    std::shared_ptr<const llvm::MemoryBuffer> contents;
+    std::optional<std::string> digest;
+  };
+
+  // Returns the digest of the file at `key`, if any.
+  std::optional<std::string> GetDigest(const std::string& key) const
+      ABSL_EXCLUSIVE_LOCKS_REQUIRED(mutex_);
+
+  absl::Mutex mutex_;
+  absl::flat_hash_map<std::string, StatEntry> stat_cache_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, FileEntry> file_cache_
+      ABSL_GUARDED_BY(mutex_);
+  absl::flat_hash_map<std::string, std::string> digests_
+      ABSL_GUARDED_BY(mutex_);
+};
+
+}  // namespace crubit
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_FILE_SYSTEM_CACHE_H_
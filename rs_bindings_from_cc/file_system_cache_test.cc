@@ -0,0 +1,160 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/file_system_cache.h"
+
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/Twine.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+namespace crubit {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::IsEmpty;
+
+// Records the paths whose status is looked up, and the files opened.
+class RecordingFileSystem : public llvm::vfs::ProxyFileSystem {
+ public:
+  explicit RecordingFileSystem(
+      llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> base)
+      : ProxyFileSystem(std::move(base)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override {
+    stat_calls.push_back(path.str());
+    return ProxyFileSystem::status(path);
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(
+      const llvm::Twine& path) override {
+    open_calls.push_back(path.str());
+    return ProxyFileSystem::openFileForRead(path);
+  }
+
+  std::vector<std::string> stat_calls;
+  std::vector<std::string> open_calls;
+};
+
+class FileSystemCacheTest : public testing::Test {
+ protected:
+  FileSystemCacheTest()
+      : in_memory_(llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>()),
+        base_(llvm::makeIntrusiveRefCnt<RecordingFileSystem>(in_memory_)),
+        cache_(llvm::makeIntrusiveRefCnt<FileSystemCache>(base_)) {
+    AddFile("/a.h", "// a.h");
+  }
+
+  void AddFile(llvm::StringRef path, llvm::StringRef contents) {
+    in_memory_->addFile(path, 0, llvm::MemoryBuffer::getMemBuffer(contents));
+  }
+
+  std::string ReadFile(const llvm::Twine& path) {
+    llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+        cache_->getBufferForFile(path);
+    if (!buffer) return "<error>";
+    return std::string((*buffer)->getBuffer());
+  }
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem> in_memory_;
+  llvm::IntrusiveRefCntPtr<RecordingFileSystem> base_;
+  llvm::IntrusiveRefCntPtr<FileSystemCache> cache_;
+};
+
+TEST_F(FileSystemCacheTest, StatsExistingFileOnce) {
+  for (int i = 0; i < 3; ++i) {
+    llvm::ErrorOr<llvm::vfs::Status> status = cache_->status("/a.h");
+    ASSERT_TRUE(status);
+    EXPECT_EQ(status->getSize(), 6);
+  }
+  EXPECT_THAT(base_->stat_calls, ElementsAre("/a.h"));
+}
+
+TEST_F(FileSystemCacheTest, StatsMissingFileOnce) {
+  EXPECT_FALSE(cache_->status("/missing.h"));
+  EXPECT_FALSE(cache_->status("/missing.h"));
+  EXPECT_TRUE(cache_->exists("/a.h"));
+  EXPECT_FALSE(cache_->exists("/missing.h"));
+  EXPECT_THAT(base_->stat_calls, ElementsAre("/missing.h", "/a.h"));
+}
+
+TEST_F(FileSystemCacheTest, ReadsFileOnce) {
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+  EXPECT_THAT(base_->open_calls, ElementsAre("/a.h"));
+}
+
+TEST_F(FileSystemCacheTest, DoesNotCacheUnreadableFiles) {
+  EXPECT_EQ(ReadFile("/b.h"), "<error>");
+  AddFile("/b.h", "// b.h");
+  EXPECT_EQ(ReadFile("/b.h"), "// b.h");
+}
+
+TEST_F(FileSystemCacheTest, IgnoresDotComponents) {
+  EXPECT_EQ(ReadFile("/./a.h"), "// a.h");
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+  EXPECT_TRUE(cache_->exists("/a.h"));
+  EXPECT_TRUE(cache_->exists("/./a.h"));
+  EXPECT_THAT(base_->open_calls, ElementsAre("/./a.h"));
+  EXPECT_THAT(base_->stat_calls, ElementsAre("/a.h"));
+}
+
+TEST_F(FileSystemCacheTest, KeepsEntriesWithUnchangedDigests) {
+  cache_->SetInputDigests({{"/a.h", "digest1"}});
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+  EXPECT_TRUE(cache_->exists("/a.h"));
+
+  cache_->SetInputDigests({{"/a.h", "digest1"}});
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+  EXPECT_TRUE(cache_->exists("/a.h"));
+  EXPECT_THAT(base_->open_calls, ElementsAre("/a.h"));
+  EXPECT_THAT(base_->stat_calls, ElementsAre("/a.h"));
+}
+
+TEST_F(FileSystemCacheTest, DropsEntriesWithChangedDigests) {
+  cache_->SetInputDigests({{"/a.h", "digest1"}});
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+
+  cache_->SetInputDigests({{"/a.h", "digest2"}});
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+  EXPECT_THAT(base_->open_calls, ElementsAre("/a.h", "/a.h"));
+}
+
+TEST_F(FileSystemCacheTest, DropsEntriesWithoutDigests) {
+  EXPECT_FALSE(cache_->exists("/b.h"));
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+
+  AddFile("/b.h", "// b.h");
+  cache_->SetInputDigests({});
+  EXPECT_TRUE(cache_->exists("/b.h"));
+  EXPECT_EQ(ReadFile("/a.h"), "// a.h");
+  EXPECT_THAT(base_->stat_calls, ElementsAre("/b.h", "/b.h"));
+  EXPECT_THAT(base_->open_calls, ElementsAre("/a.h", "/a.h"));
+}
+
+TEST_F(FileSystemCacheTest, BuffersOutliveDroppedEntries) {
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      cache_->getBufferForFile("/a.h");
+  ASSERT_TRUE(buffer);
+  cache_->SetInputDigests({});
+  EXPECT_EQ((*buffer)->getBuffer(), "// a.h");
+  EXPECT_EQ((*buffer)->getBufferIdentifier(), "/a.h");
+}
+
+TEST_F(FileSystemCacheTest, CantChangeWorkingDirectory) {
+  EXPECT_TRUE(cache_->setCurrentWorkingDirectory("/"));
+  EXPECT_THAT(base_->stat_calls, IsEmpty());
+}
+
+}  // namespace
+}  // namespace crubit
@@ -4,6 +4,8 @@
 
 #include "rs_bindings_from_cc/generate_bindings_and_metadata.h"
 
+#include <future>
+#include <memory>
 #include <optional>
 #include <string>
 #include <utility>
@@ -12,21 +14,34 @@
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "common/file_io.h"
 #include "common/status_macros.h"
+#include "lifetime_annotations/lifetime_summaries.h"
+#include "nullability/inference/inference_table.h"
+#include "rs_bindings_from_cc/chrome_trace.h"
 #include "rs_bindings_from_cc/cmdline.h"
 #include "rs_bindings_from_cc/collect_instantiations.h"
 #include "rs_bindings_from_cc/collect_namespaces.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/ir_cache.h"
 #include "rs_bindings_from_cc/ir_from_cc.h"
+#include "rs_bindings_from_cc/prune_unused_items.h"
 #include "rs_bindings_from_cc/src_code_gen.h"
+#include "rs_bindings_from_cc/timing_report.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/VirtualFileSystem.h"
 
 namespace crubit {
 
 std::optional<const Namespace*> FindNamespace(const IR& ir,
                                               absl::string_view name) {
   for (const auto* ns : ir.get_items_if<Namespace>()) {
-    if (ns->name.Ident() == kInstantiationsNamespaceName) {
+    if (ns->name.Ident() == name) {
       return ns;
     }
   }
@@ -36,6 +51,7 @@ std::optional<const Namespace*> FindNamespace(const IR& ir,
 std::vector<const Record*> FindInstantiationsInNamespace(const IR& ir,
                                                          ItemId namespace_id) {
   absl::flat_hash_set<ItemId> record_ids;
+  std::vector<const Record*> result;
   for (const auto* type_alias : ir.get_items_if<TypeAlias>()) {
     if (type_alias->enclosing_namespace_id.has_value() &&
         type_alias->enclosing_namespace_id == namespace_id) {
@@ -44,30 +60,92 @@ std::vector<const Record*> FindInstantiationsInNamespace(const IR& ir,
       CHECK(mapped_type->rs_type.decl_id.has_value());
       CHECK(mapped_type->cc_type.decl_id.value() ==
             mapped_type->rs_type.decl_id.value());
-      record_ids.insert(mapped_type->rs_type.decl_id.value());
+      ItemId record_id = mapped_type->rs_type.decl_id.value();
+      if (!record_ids.insert(record_id).second) {
+        continue;
+      }
+      if (const auto* record = ir.FindItem<Record>(record_id)) {
+        result.push_back(record);
+      }
     }
   }
+  return result;
+}
 
-  std::vector<const Record*> result;
-  for (const auto* record : ir.get_items_if<Record>()) {
-    if (record_ids.find(record->id) != record_ids.end()) {
-      result.push_back(record);
-    }
+// Returns the file names of the `--rs_out_shards`, relative to their
+// directory.
+static std::vector<std::string> RsApiShardFileNames(const Cmdline& cmdline) {
+  std::vector<std::string> rs_api_shard_file_names;
+  for (const std::string& rs_out_shard : cmdline.rs_out_shards()) {
+    rs_api_shard_file_names.push_back(
+        std::string(llvm::sys::path::filename(rs_out_shard)));
   }
-  return result;
+  return rs_api_shard_file_names;
 }
 
 absl::StatusOr<BindingsAndMetadata> GenerateBindingsAndMetadata(
     Cmdline& cmdline, std::vector<std::string> clang_args,
     absl::flat_hash_map<const HeaderName, const std::string>
-        virtual_headers_contents_for_testing) {
+        virtual_headers_contents_for_testing,
+    TimingReport* timing_report, ChromeTrace* trace,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system) {
   std::vector<absl::string_view> clang_args_view;
   clang_args_view.insert(clang_args_view.end(), clang_args.begin(),
                          clang_args.end());
 
-  CRUBIT_ASSIGN_OR_RETURN(
-      std::vector<std::string> requested_instantiations,
-      CollectInstantiations(cmdline.srcs_to_scan_for_instantiations()));
+  // The Rust sources are scanned while Clang parses the public headers, as
+  // `IrFromCc` only needs the instantiations at the end of the translation
+  // unit.
+  std::shared_future<absl::StatusOr<std::vector<std::string>>>
+      requested_instantiations;
+  if (!cmdline.srcs_to_scan_for_instantiations().empty()) {
+    requested_instantiations = std::async(std::launch::async, [&cmdline] {
+      return CollectInstantiations(cmdline.srcs_to_scan_for_instantiations());
+    });
+  }
+
+  // The module is built first, since `IrFromCc` consumes the virtual headers.
+  std::string module;
+  if (!cmdline.module_out().empty()) {
+    TimingReport::Phase phase(timing_report, "module_from_cc");
+    CRUBIT_ASSIGN_OR_RETURN(
+        module,
+        ModuleFromCc({.current_target = cmdline.current_target(),
+                      .public_headers = cmdline.public_headers(),
+                      .virtual_headers_contents_for_testing =
+                          virtual_headers_contents_for_testing,
+                      .clang_args = clang_args_view,
+                      .dependency_modules = cmdline.dependency_modules(),
+                      .file_system = file_system},
+                     cmdline.module_out()));
+  }
+
+  std::optional<clang::tidy::nullability::InferenceTable> inferences;
+  if (!cmdline.nullability_inference_table().empty()) {
+    auto table = clang::tidy::nullability::InferenceTable::open(
+        cmdline.nullability_inference_table());
+    if (!table) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Failed to read --nullability_inference_table: ",
+                       toString(table.takeError())));
+    }
+    inferences = std::move(*table);
+  }
+
+  std::shared_ptr<const clang::tidy::lifetimes::LifetimeSummaries>
+      lifetime_summaries;
+  if (!cmdline.lifetime_summaries().empty()) {
+    auto summaries = clang::tidy::lifetimes::LifetimeSummaries::Load(
+        cmdline.lifetime_summaries());
+    if (!summaries) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Failed to read --lifetime_summaries: ",
+                       toString(summaries.takeError())));
+    }
+    lifetime_summaries =
+        std::make_shared<const clang::tidy::lifetimes::LifetimeSummaries>(
+            std::move(*summaries));
+  }
 
   CRUBIT_ASSIGN_OR_RETURN(
       IR ir, IrFromCc({.current_target = cmdline.current_target(),
@@ -75,24 +153,33 @@ absl::StatusOr<BindingsAndMetadata> GenerateBindingsAndMetadata(
                        .virtual_headers_contents_for_testing =
                            std::move(virtual_headers_contents_for_testing),
                        .headers_to_targets = cmdline.headers_to_targets(),
+                       .instantiations_to_targets =
+                           cmdline.instantiations_to_targets(),
                        .extra_rs_srcs = cmdline.extra_rs_srcs(),
                        .clang_args = clang_args_view,
-                       .extra_instantiations = requested_instantiations,
-                       .crubit_features = cmdline.target_to_features()}));
+                       .deferred_extra_instantiations =
+                           std::move(requested_instantiations),
+                       .crubit_features = cmdline.target_to_features(),
+                       .dependency_modules = cmdline.dependency_modules(),
+                       .timing_report = timing_report,
+                       .trace = trace,
+                       .file_system = std::move(file_system),
+                       .lazy_dependency_imports =
+                           cmdline.lazy_dependency_imports(),
+                       .nullability_inferences =
+                           inferences ? &*inferences : nullptr,
+                       .lifetime_summaries = std::move(lifetime_summaries),
+                       .infer_nullability = cmdline.infer_nullability(),
+                       .infer_lifetimes = cmdline.infer_lifetimes(),
+                       .max_template_instantiations =
+                           cmdline.max_template_instantiations(),
+                       .max_template_instantiation_depth =
+                           cmdline.max_template_instantiation_depth()}));
 
   if (!cmdline.instantiations_out().empty()) {
     ir.crate_root_path = "__cc_template_instantiations_rs_api";
   }
 
-  bool generate_error_report = !cmdline.error_report_out().empty();
-  CRUBIT_ASSIGN_OR_RETURN(
-      Bindings bindings,
-      GenerateBindings(ir, cmdline.crubit_support_path(),
-                       cmdline.clang_format_exe_path(),
-                       cmdline.rustfmt_exe_path(),
-                       cmdline.rustfmt_config_path(), generate_error_report,
-                       cmdline.generate_source_location_in_doc_comment()));
-
   absl::flat_hash_map<std::string, std::string> instantiations;
   std::optional<const Namespace*> ns =
       FindNamespace(ir, kInstantiationsNamespaceName);
@@ -104,15 +191,132 @@ absl::StatusOr<BindingsAndMetadata> GenerateBindingsAndMetadata(
     }
   }
 
+  if (!cmdline.srcs_to_scan_for_used_names().empty()) {
+    TimingReport::Phase phase(timing_report, "prune_unused_items");
+    CRUBIT_ASSIGN_OR_RETURN(
+        std::vector<std::string> identifiers,
+        CollectIdentifiers(cmdline.srcs_to_scan_for_used_names()));
+    absl::flat_hash_set<std::string> used_names(identifiers.begin(),
+                                                identifiers.end());
+    // Instantiations are used through `cc_template!`, not by their Rust names.
+    for (const auto& [cc_name, rs_name] : instantiations) {
+      used_names.insert(rs_name);
+    }
+    PruneUnusedItems(ir, used_names);
+  }
+
+  // Header changes that leave the IR as it was (e.g. in the bodies of inline
+  // functions) don't need the bindings to be generated again.
+  //
+  // The IR is serialized once, for the cache key, the code generator, and
+  // `--binary_ir_out`.
+  std::string binary_ir;
+  if (!cmdline.rs_out().empty() || !cmdline.binary_ir_out().empty()) {
+    TimingReport::Phase phase(timing_report, "serialize_ir");
+    binary_ir = IrToBinary(ir, cmdline.codegen_threads());
+  }
+  std::string bindings_cache_key;
+  std::optional<CachedBindings> bindings;
+  if (cmdline.rs_out().empty()) {
+    // Only the binary IR was requested: the bindings are generated from it by
+    // another invocation of the tool (see `--binary_ir_in`).
+    bindings = CachedBindings{};
+  } else if (!cmdline.ir_cache_dir().empty()) {
+    TimingReport::Phase phase(timing_report, "read_bindings_cache");
+    CRUBIT_ASSIGN_OR_RETURN(bindings_cache_key,
+                            BindingsCacheKey(cmdline, binary_ir));
+    CRUBIT_ASSIGN_OR_RETURN(
+        bindings,
+        ReadBindingsFromCache(cmdline.ir_cache_dir(), bindings_cache_key));
+  }
+  // Not cached: it profiles the generation, which a cache hit skips.
+  std::string query_profile;
+  if (!bindings.has_value()) {
+    bool generate_error_report = !cmdline.error_report_out().empty();
+    bool generate_size_report = !cmdline.size_report_out().empty();
+    bool generate_query_profile = !cmdline.query_profile_out().empty();
+    CRUBIT_ASSIGN_OR_RETURN(
+        Bindings generated,
+        GenerateBindingsFromBinaryIr(
+            binary_ir, cmdline.crubit_support_path(),
+            cmdline.format_cc_in_process() ? ""
+                                           : cmdline.clang_format_exe_path(),
+            cmdline.rustfmt_exe_path(), cmdline.rustfmt_config_path(),
+            generate_error_report, generate_size_report, generate_query_profile,
+            cmdline.generate_source_location_in_doc_comment(),
+            cmdline.codegen_threads(), cmdline.format_mode(),
+            cmdline.layout_assertions(), cmdline.omit_thunk_free_rs_api_impl(),
+            cmdline.collapse_opaque_fields(), RsApiShardFileNames(cmdline),
+            timing_report, trace));
+    bindings = CachedBindings{
+        .rs_api = std::move(generated.rs_api),
+        .rs_api_shards = std::move(generated.rs_api_shards),
+        .rs_api_impl = std::move(generated.rs_api_impl),
+        .error_report = std::move(generated.error_report),
+        .size_report = std::move(generated.size_report),
+        .used_dep_targets = std::move(generated.used_dep_targets),
+    };
+    query_profile = std::move(generated.query_profile);
+    if (!bindings_cache_key.empty()) {
+      TimingReport::Phase phase(timing_report, "write_bindings_cache");
+      CRUBIT_RETURN_IF_ERROR(WriteBindingsToCache(
+          cmdline.ir_cache_dir(), bindings_cache_key, *bindings));
+    }
+  }
+
   auto top_level_namespaces = crubit::CollectNamespaces(ir);
+  if (cmdline.binary_ir_out().empty()) {
+    binary_ir.clear();
+    binary_ir.shrink_to_fit();
+  }
 
   return BindingsAndMetadata{
-      .ir = ir,
-      .rs_api = bindings.rs_api,
-      .rs_api_impl = bindings.rs_api_impl,
+      .ir = std::move(ir),
+      .binary_ir = std::move(binary_ir),
+      .rs_api = std::move(bindings->rs_api),
+      .rs_api_shards = std::move(bindings->rs_api_shards),
+      .rs_api_impl = std::move(bindings->rs_api_impl),
       .namespaces = std::move(top_level_namespaces),
       .instantiations = std::move(instantiations),
-      .error_report = bindings.error_report,
+      .error_report = std::move(bindings->error_report),
+      .size_report = std::move(bindings->size_report),
+      .query_profile = std::move(query_profile),
+      .used_dep_targets = std::move(bindings->used_dep_targets),
+      .module = std::move(module),
+  };
+}
+
+absl::StatusOr<BindingsAndMetadata> GenerateBindingsFromBinaryIrFile(
+    const Cmdline& cmdline, TimingReport* timing_report, ChromeTrace* trace) {
+  std::string binary_ir;
+  {
+    TimingReport::Phase phase(timing_report, "read_binary_ir");
+    CRUBIT_ASSIGN_OR_RETURN(binary_ir, GetFileContents(cmdline.binary_ir_in()));
+  }
+  bool generate_error_report = !cmdline.error_report_out().empty();
+  bool generate_size_report = !cmdline.size_report_out().empty();
+  bool generate_query_profile = !cmdline.query_profile_out().empty();
+  CRUBIT_ASSIGN_OR_RETURN(
+      Bindings bindings,
+      GenerateBindingsFromBinaryIr(
+          binary_ir, cmdline.crubit_support_path(),
+          cmdline.format_cc_in_process() ? ""
+                                         : cmdline.clang_format_exe_path(),
+          cmdline.rustfmt_exe_path(), cmdline.rustfmt_config_path(),
+          generate_error_report, generate_size_report, generate_query_profile,
+          cmdline.generate_source_location_in_doc_comment(),
+          cmdline.codegen_threads(), cmdline.format_mode(),
+          cmdline.layout_assertions(), cmdline.omit_thunk_free_rs_api_impl(),
+          cmdline.collapse_opaque_fields(), RsApiShardFileNames(cmdline),
+          timing_report, trace));
+  return BindingsAndMetadata{
+      .rs_api = std::move(bindings.rs_api),
+      .rs_api_shards = std::move(bindings.rs_api_shards),
+      .rs_api_impl = std::move(bindings.rs_api_impl),
+      .error_report = std::move(bindings.error_report),
+      .size_report = std::move(bindings.size_report),
+      .query_profile = std::move(bindings.query_profile),
+      .used_dep_targets = std::move(bindings.used_dep_targets),
   };
 }
 
@@ -10,9 +10,13 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
+#include "rs_bindings_from_cc/chrome_trace.h"
 #include "rs_bindings_from_cc/cmdline.h"
 #include "rs_bindings_from_cc/collect_namespaces.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/VirtualFileSystem.h"
 
 namespace crubit {
 // Contains generated bindings and all related metadata, such as the IR.
@@ -20,8 +24,14 @@ struct BindingsAndMetadata {
   // Intermediate representation of the Clang AST from which we generated
   // bindings.
   IR ir;
+  // `ir` serialized by `IrToBinary`, if `--binary_ir_out` was requested. It is
+  // the serialization the bindings were generated from, so it isn't redone.
+  std::string binary_ir;
   // Generated Rust source code.
   std::string rs_api;
+  // Generated Rust source code `include!`d by `rs_api`, one entry per
+  // `--rs_out_shards` file.
+  std::vector<std::string> rs_api_shards;
   // Generated C++ source code.
   std::string rs_api_impl;
   // A hierarchy tree for all C++ namespaces used in the target.
@@ -31,13 +41,38 @@ struct BindingsAndMetadata {
   absl::flat_hash_map<std::string, std::string> instantiations;
   // A JSON error report, if requested.
   std::string error_report;
+  // A JSON report of the size of the code generated for each item, if
+  // requested.
+  std::string size_report;
+  // A JSON profile of the memoized queries of the code generation, if
+  // requested. Empty if the bindings were read from the cache.
+  std::string query_profile;
+  // The labels of the dependency targets whose crates the generated Rust
+  // source code names, sorted.
+  std::vector<std::string> used_dep_targets;
+  // A Clang module containing the public headers, if requested.
+  std::string module;
 };
 
 // Returns `BindingsAndMetadata` as requested by the user on the command line.
+//
+// If `timing_report` is not null, it receives the time spent in the phases of
+// the generation. If `trace` is not null, it receives a span for the import of
+// each C++ decl and for the generation of each item. If `file_system` is not
+// null, the headers are read from it (see `IrFromCcOptions::file_system`).
 absl::StatusOr<BindingsAndMetadata> GenerateBindingsAndMetadata(
     Cmdline& cmdline, std::vector<std::string> clang_args,
     absl::flat_hash_map<const HeaderName, const std::string>
-        virtual_headers_contents_for_testing = {});
+        virtual_headers_contents_for_testing = {},
+    TimingReport* timing_report = nullptr, ChromeTrace* trace = nullptr,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system = nullptr);
+
+// Returns the bindings generated from the `--binary_ir_in` file, which was
+// written by an earlier invocation of the tool via `--binary_ir_out`. The `ir`,
+// `namespaces`, `instantiations` and `module` of the result are empty.
+absl::StatusOr<BindingsAndMetadata> GenerateBindingsFromBinaryIrFile(
+    const Cmdline& cmdline, TimingReport* timing_report = nullptr,
+    ChromeTrace* trace = nullptr);
 
 }  // namespace crubit
 
@@ -6,12 +6,14 @@
 
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
 #include "common/ffi_types.h"
 #include "common/status_macros.h"
 #include "common/test_utils.h"
@@ -24,8 +26,10 @@ namespace {
 
 using ::testing::ElementsAre;
 using ::testing::IsEmpty;
+using ::testing::Not;
 using ::testing::Pair;
 using ::testing::StrEq;
+using ::testing::UnorderedElementsAre;
 
 constexpr absl::string_view kDefaultRustfmtExePath =
     "nowhere/llvm/rust/main_sysroot/bin/rustfmt";
@@ -290,5 +294,197 @@ TEST(GenerateBindingsAndMetadataTest, NamespacesJsonGenerated) {
   ASSERT_THAT(NamespacesAsJson(result.namespaces), StrEq(kExpected));
 }
 
+TEST(GenerateBindingsAndMetadataTest, DependencyModules) {
+  // The module map built for `//:dep` refers to its headers by absolute path,
+  // so the test uses absolute paths throughout.
+  std::string dep_h =
+      WriteFileForCurrentTest("dep.h", "#pragma once\nstruct Dep {};\n");
+  std::string a_h = WriteFileForCurrentTest(
+      "a.h", "#pragma once\n#include \"dep.h\"\nstruct S { Dep dep; };\n");
+  std::string dep_pcm = WriteFileForCurrentTest("dep.pcm", "");
+  std::string targets_and_headers = absl::Substitute(
+      R"([{"t": "//:dep", "h": ["$0"]}, {"t": "//:target", "h": ["$1"]}])",
+      dep_h, a_h);
+
+  ASSERT_OK_AND_ASSIGN(
+      Cmdline dep_cmdline,
+      Cmdline::CreateForTesting(
+          "//:dep", "cc_out", "rs_out", "ir_out", "namespaces_out",
+          "crubit_support_path", std::string(kDefaultClangFormatExePath),
+          std::string(kDefaultRustfmtExePath), "nowhere/rustfmt.toml",
+          /* do_nothing= */ false,
+          /* public_headers= */ {dep_h}, targets_and_headers,
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "",
+          /* error_report_out= */ "", SourceLocationDocComment::Enabled,
+          /* ir_cache_dir= */ "", /* module_out= */ dep_pcm));
+  ASSERT_OK_AND_ASSIGN(
+      BindingsAndMetadata dep_result,
+      GenerateBindingsAndMetadata(dep_cmdline, DefaultClangArgs()));
+  ASSERT_THAT(dep_result.module, Not(IsEmpty()));
+  WriteFileForCurrentTest("dep.pcm", dep_result.module);
+
+  ASSERT_OK_AND_ASSIGN(
+      Cmdline cmdline,
+      Cmdline::CreateForTesting(
+          "//:target", "cc_out", "rs_out", "ir_out", "namespaces_out",
+          "crubit_support_path", std::string(kDefaultClangFormatExePath),
+          std::string(kDefaultRustfmtExePath), "nowhere/rustfmt.toml",
+          /* do_nothing= */ false,
+          /* public_headers= */ {a_h}, targets_and_headers,
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "",
+          /* error_report_out= */ "", SourceLocationDocComment::Enabled,
+          /* ir_cache_dir= */ "", /* module_out= */ "",
+          /* dependency_modules= */ {dep_pcm}));
+  ASSERT_OK_AND_ASSIGN(
+      BindingsAndMetadata result,
+      GenerateBindingsAndMetadata(cmdline, DefaultClangArgs()));
+
+  absl::flat_hash_map<std::string, std::string> owning_targets;
+  for (const Record* record : result.ir.get_items_if<Record>()) {
+    owning_targets[record->cc_name] = record->owning_target.value();
+  }
+  EXPECT_THAT(owning_targets, UnorderedElementsAre(Pair("Dep", "//:dep"),
+                                                   Pair("S", "//:target")));
+}
+
+TEST(GenerateBindingsAndMetadataTest, InstantiationsOwnedByOtherTarget) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "//:target", "h": ["a.h"]},
+    {"t": "//:instantiations", "i": ["MyTemplate<int>"]}
+  ])";
+  ASSERT_OK_AND_ASSIGN(
+      Cmdline cmdline,
+      Cmdline::CreateForTesting(
+          "//:target", "cc_out", "rs_out", "ir_out", "namespaces_out",
+          "crubit_support_path", std::string(kDefaultClangFormatExePath),
+          std::string(kDefaultRustfmtExePath), "nowhere/rustfmt.toml",
+          /* do_nothing= */ false,
+          /* public_headers= */ {"a.h"}, std::string(kTargetsAndHeaders),
+          /* extra_rs_srcs= */ {},
+          /* srcs_to_scan_for_instantiations= */ {},
+          /* instantiations_out= */ "",
+          /* error_report_out= */ "", SourceLocationDocComment::Enabled));
+
+  ASSERT_OK_AND_ASSIGN(
+      BindingsAndMetadata result,
+      GenerateBindingsAndMetadata(cmdline, DefaultClangArgs(),
+                                  /*virtual_headers_contents_for_testing=*/
+                                  {{HeaderName("a.h"), R"(
+      template <typename T> struct MyTemplate { T value; };
+      struct S {
+        MyTemplate<int> i;
+        MyTemplate<char> c;
+      };)"}}));
+
+  absl::flat_hash_map<std::string, std::string> owning_targets;
+  for (const Record* record : result.ir.get_items_if<Record>()) {
+    owning_targets[record->cc_name] = record->owning_target.value();
+  }
+  EXPECT_THAT(owning_targets,
+              UnorderedElementsAre(Pair("MyTemplate<int>", "//:instantiations"),
+                                   Pair("MyTemplate<char>", "//:target"),
+                                   Pair("S", "//:target")));
+}
+
+TEST(GenerateBindingsAndMetadataTest, FormatCcInProcess) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "//:target", "h": ["a.h"]}
+  ])";
+  constexpr absl::string_view kHeader =
+      "struct S final { S(const S&); ~S(); int field; }; "
+      "inline int Add(int a, int b) { return a + b; }";
+
+  std::string rs_api_impl[2];
+  for (bool format_cc_in_process : {false, true}) {
+    ASSERT_OK_AND_ASSIGN(
+        Cmdline cmdline,
+        Cmdline::CreateForTesting(
+            "//:target", "cc_out", "rs_out", "ir_out", "namespaces_out",
+            "crubit_support_path",
+            format_cc_in_process ? "" : std::string(kDefaultClangFormatExePath),
+            std::string(kDefaultRustfmtExePath), "nowhere/rustfmt.toml",
+            /* do_nothing= */ false,
+            /* public_headers= */ {"a.h"}, std::string(kTargetsAndHeaders),
+            /* extra_rs_srcs= */ {},
+            /* srcs_to_scan_for_instantiations= */ {},
+            /* instantiations_out= */ "",
+            /* error_report_out= */ "", SourceLocationDocComment::Enabled,
+            /* ir_cache_dir= */ "", /* module_out= */ "",
+            /* dependency_modules= */ {}, /* codegen_threads= */ 1,
+            format_cc_in_process));
+    ASSERT_OK_AND_ASSIGN(
+        BindingsAndMetadata result,
+        GenerateBindingsAndMetadata(
+            cmdline, DefaultClangArgs(),
+            /*virtual_headers_contents_for_testing=*/
+            {{HeaderName("a.h"), std::string(kHeader)}}));
+    rs_api_impl[format_cc_in_process] = std::move(result.rs_api_impl);
+  }
+
+  // The clang-format library should format exactly like the executable.
+  EXPECT_THAT(rs_api_impl[1], Not(IsEmpty()));
+  EXPECT_EQ(rs_api_impl[1], rs_api_impl[0]);
+}
+
+TEST(GenerateBindingsAndMetadataTest, OutputIsTheSameOnEveryRun) {
+  constexpr absl::string_view kTargetsAndHeaders = R"([
+    {"t": "target1", "h": ["a.h"]}
+  ])";
+  constexpr absl::string_view kHeader = R"cc(
+    namespace ns {
+    struct S {
+      int field;
+    };
+    int Function(S s);
+    }  // namespace ns
+  )cc";
+  // Both `Cmdline`s are alive at the same time, so that nothing derived from
+  // their addresses (e.g. of their `extra_rs_srcs`) can be the same.
+  std::vector<Cmdline> cmdlines;
+  for (int i = 0; i < 2; ++i) {
+    ASSERT_OK_AND_ASSIGN(
+        Cmdline cmdline,
+        Cmdline::CreateForTesting(
+            "//:target", "cc_out", "rs_out", "ir_out", "namespaces_out",
+            "crubit_support_path", std::string(kDefaultClangFormatExePath),
+            std::string(kDefaultRustfmtExePath), "nowhere/rustfmt.toml",
+            /* do_nothing= */ false,
+            /* public_headers= */ {"a.h"}, std::string(kTargetsAndHeaders),
+            /* extra_rs_srcs= */ {"extra.rs"},
+            /* srcs_to_scan_for_instantiations= */ {},
+            /* instantiations_out= */ "",
+            /* error_report_out= */ "", SourceLocationDocComment::Enabled));
+    cmdlines.push_back(std::move(cmdline));
+  }
+
+  std::vector<BindingsAndMetadata> results;
+  for (const Cmdline& cmdline : cmdlines) {
+    ASSERT_OK_AND_ASSIGN(
+        BindingsAndMetadata result,
+        GenerateBindingsAndMetadata(
+            cmdline, DefaultClangArgs(),
+            /*virtual_headers_contents_for_testing=*/
+            {{HeaderName("a.h"), std::string(kHeader)}}));
+    results.push_back(std::move(result));
+  }
+
+  auto use_mods = [](const IR& ir) {
+    std::vector<std::pair<ItemId, std::string>> use_mods;
+    for (const UseMod* use_mod : ir.get_items_if<UseMod>()) {
+      use_mods.push_back({use_mod->id, use_mod->path});
+    }
+    return use_mods;
+  };
+  EXPECT_THAT(use_mods(results[0].ir), Not(IsEmpty()));
+  EXPECT_EQ(use_mods(results[0].ir), use_mods(results[1].ir));
+  EXPECT_EQ(results[0].ir.top_level_item_ids, results[1].ir.top_level_item_ids);
+  EXPECT_EQ(results[0].rs_api, results[1].rs_api);
+  EXPECT_EQ(results[0].rs_api_impl, results[1].rs_api_impl);
+}
+
 }  // namespace
 }  // namespace crubit
@@ -10,7 +10,6 @@
 #include <cassert>
 #include <cstddef>
 #include <iterator>
-#include <map>
 #include <memory>
 #include <optional>
 #include <set>
@@ -36,7 +35,9 @@
 #include "lifetime_annotations/type_lifetimes.h"
 #include "rs_bindings_from_cc/ast_util.h"
 #include "rs_bindings_from_cc/bazel_types.h"
+#include "rs_bindings_from_cc/chrome_trace.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
 #include "rs_bindings_from_cc/type_map.h"
 #include "clang/AST/ASTContext.h"
 #include "clang/AST/Decl.h"
@@ -53,6 +54,7 @@
 #include "clang/Basic/SourceManager.h"
 #include "clang/Basic/Specifiers.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/ArrayRef.h"
 #include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/Casting.h"
 #include "llvm/Support/FormatVariadic.h"
@@ -313,33 +315,40 @@ std::vector<ItemId> Importer::GetItemIdsInSourceOrder(
   std::vector<SourceLocationComparator::OrderedItemId> items;
   auto compare_locations = SourceLocationComparator(sm);
 
-  // We are only interested in comments within this decl context.
-  std::vector<const clang::RawComment*> comments_in_range(
-      llvm::lower_bound(comments_, parent_decl->getBeginLoc(),
-                        compare_locations),
-      llvm::upper_bound(comments_, parent_decl->getEndLoc(),
-                        compare_locations));
-
-  std::map<clang::SourceLocation, const clang::RawComment*,
-           SourceLocationComparator>
-      ordered_comments(compare_locations);
-  for (auto& comment : comments_in_range) {
-    ordered_comments.insert({comment->getBeginLoc(), comment});
-  }
+  // We are only interested in comments within this decl context. They are
+  // already sorted, as `comments_` is.
+  llvm::ArrayRef<const clang::RawComment*> all_comments(comments_);
+  const clang::RawComment* const* comments_begin = llvm::lower_bound(
+      all_comments, parent_decl->getBeginLoc(), compare_locations);
+  const clang::RawComment* const* comments_end =
+      std::upper_bound(comments_begin, all_comments.end(),
+                       parent_decl->getEndLoc(), compare_locations);
+  llvm::ArrayRef<const clang::RawComment*> comments_in_range(comments_begin,
+                                                             comments_end);
+  std::vector<bool> is_comment_removed(comments_in_range.size());
+  auto remove_comments = [&](clang::SourceLocation begin,
+                             clang::SourceLocation end) {
+    auto first = llvm::lower_bound(comments_in_range, begin, compare_locations);
+    auto last = std::upper_bound(first, comments_in_range.end(), end,
+                                 compare_locations);
+    for (auto it = first; it != last; ++it) {
+      is_comment_removed[it - comments_in_range.begin()] = true;
+    }
+  };
 
   absl::flat_hash_set<ItemId> visited_item_ids;
 
   auto* decl_context = clang::cast<clang::DeclContext>(parent_decl);
   for (auto decl : GetCanonicalChildren(decl_context)) {
-    auto item = GetDeclItem(decl);
     // We generated IR for top level items coming from different targets,
     // however we shouldn't generate bindings for them, so we don't add them
-    // to ir.top_level_item_ids.
-    if (decl_context->isTranslationUnit() && !IsFromCurrentTarget(decl)) {
-      continue;
-    }
+    // to ir.top_level_item_ids. With lazy dependency imports, we don't even
+    // generate IR for them until something refers to them.
+    bool is_listed =
+        !IsImportedOnlyOnDemand(decl) && GetDeclItem(decl).has_value() &&
+        !(decl_context->isTranslationUnit() && !IsFromCurrentTarget(decl));
     // Only add item ids for decls that can be successfully imported.
-    if (item.has_value()) {
+    if (is_listed) {
       auto item_id = GenerateItemId(decl);
       // TODO(rosica): Drop this check when we start importing also other
       // redecls, not just the canonical
@@ -352,20 +361,33 @@ std::vector<ItemId> Importer::GetItemIdsInSourceOrder(
     // We remove comments attached to a child decl or that are within a child
     // decl.
     if (auto raw_comment = ctx_.getRawCommentForDeclNoCache(decl)) {
-      ordered_comments.erase(raw_comment->getBeginLoc());
+      remove_comments(raw_comment->getBeginLoc(), raw_comment->getBeginLoc());
     }
-    ordered_comments.erase(ordered_comments.lower_bound(decl->getBeginLoc()),
-                           ordered_comments.upper_bound(decl->getEndLoc()));
+    remove_comments(decl->getBeginLoc(), decl->getEndLoc());
   }
 
-  for (auto& [_, comment] : ordered_comments) {
-    items.push_back({GetSourceOrderKey(comment), GenerateItemId(comment)});
-  }
+  // Child decls are mostly, but not always, in source order (e.g. a
+  // canonical decl may be a forward declaration), so only they are sorted,
+  // before being merged with the remaining comments.
   llvm::sort(items, compare_locations);
+  std::vector<SourceLocationComparator::OrderedItemId> comment_items;
+  for (size_t i = 0; i < comments_in_range.size(); ++i) {
+    if (is_comment_removed[i]) continue;
+    const clang::RawComment* comment = comments_in_range[i];
+    comment_items.push_back(
+        {GetSourceOrderKey(comment),
+         GenerateItemId(comment, ctx_.getSourceManager())});
+  }
+
+  std::vector<SourceLocationComparator::OrderedItemId> ordered_items;
+  ordered_items.reserve(items.size() + comment_items.size());
+  std::merge(items.begin(), items.end(), comment_items.begin(),
+             comment_items.end(), std::back_inserter(ordered_items),
+             compare_locations);
 
   std::vector<ItemId> ordered_item_ids;
-  ordered_item_ids.reserve(items.size());
-  for (auto& ordered_item : items) {
+  ordered_item_ids.reserve(ordered_items.size());
+  for (auto& ordered_item : ordered_items) {
     ordered_item_ids.push_back(ordered_item.second);
   }
   return ordered_item_ids;
@@ -407,6 +429,7 @@ void Importer::ImportFreeComments() {
 }
 
 void Importer::Import(clang::TranslationUnitDecl* translation_unit_decl) {
+  TimingReport::Phase phase(invocation_.timing_report_, "import");
   ImportFreeComments();
   clang::SourceManager& sm = ctx_.getSourceManager();
   std::vector<SourceLocationComparator::OrderedItem> ordered_items;
@@ -416,17 +439,19 @@ void Importer::Import(clang::TranslationUnitDecl* translation_unit_decl) {
     ordered_items.push_back(
         {GetSourceOrderKey(comment),
          Comment{.text = comment->getFormattedText(sm, sm.getDiagnostics()),
-                 .id = GenerateItemId(comment)}});
+                 .id = GenerateItemId(comment, sm)}});
   }
 
   ImportDeclsFromDeclContext(translation_unit_decl);
-  for (const auto& [decl, item] : import_cache_) {
+  // Nothing is imported after this point, so the items can be moved out of
+  // the cache instead of being copied.
+  for (auto& [decl, item] : import_cache_) {
     if (item.has_value()) {
       if (std::holds_alternative<UnsupportedItem>(*item) &&
           !IsFromCurrentTarget(decl)) {
         continue;
       }
-      ordered_items.push_back({GetSourceOrderKey(decl), *item});
+      ordered_items.push_back({GetSourceOrderKey(decl), std::move(*item)});
     }
   }
 
@@ -434,7 +459,7 @@ void Importer::Import(clang::TranslationUnitDecl* translation_unit_decl) {
 
   invocation_.ir_.items.reserve(ordered_items.size());
   for (auto& ordered_item : ordered_items) {
-    invocation_.ir_.items.push_back(ordered_item.second);
+    invocation_.ir_.items.push_back(std::move(ordered_item.second));
   }
   invocation_.ir_.top_level_item_ids =
       GetItemIdsInSourceOrder(translation_unit_decl);
@@ -448,11 +473,20 @@ void Importer::Import(clang::TranslationUnitDecl* translation_unit_decl) {
 void Importer::ImportDeclsFromDeclContext(
     const clang::DeclContext* decl_context) {
   for (auto decl : GetCanonicalChildren(decl_context)) {
+    if (IsImportedOnlyOnDemand(decl)) continue;
     GetDeclItem(decl);
   }
 }
 
-std::optional<IR::Item> Importer::GetDeclItem(clang::Decl* decl) {
+bool Importer::IsImportedOnlyOnDemand(const clang::Decl* decl) const {
+  // Namespaces are still visited, as the decls of the current target may be
+  // in any of their blocks, and the decls imported on demand refer to them as
+  // their enclosing namespace.
+  return invocation_.lazy_dependency_imports_ &&
+         !clang::isa<clang::NamespaceDecl>(decl) && !IsFromCurrentTarget(decl);
+}
+
+const std::optional<IR::Item>& Importer::GetDeclItem(clang::Decl* decl) {
   // TODO(jeanpierreda): Move `decl->getCanonicalDecl()` from callers into here.
   if (auto it = import_cache_.find(decl); it != import_cache_.end()) {
     return it->second;
@@ -491,8 +525,20 @@ std::optional<IR::Item> Importer::GetDeclItem(clang::Decl* decl) {
   // Note: insert_or_assign, not insert, in case a record, so as to overwrite
   // any null entries introduced by cycles.
 
-  std::optional<IR::Item> result = ImportDecl(decl);
-  auto [it, inserted] = import_cache_.try_emplace(decl, result);
+  std::optional<IR::Item> result;
+  {
+    // The span includes the imports of the decls this one depends on, so that
+    // the trace shows which top-level decls are expensive to import.
+    ChromeTrace::Span span(invocation_.trace_, "import", [decl] {
+      std::string name = decl->getDeclKindName();
+      if (auto* named_decl = clang::dyn_cast<clang::NamedDecl>(decl)) {
+        absl::StrAppend(&name, " ", named_decl->getQualifiedNameAsString());
+      }
+      return name;
+    });
+    result = ImportDecl(decl);
+  }
+  auto [it, inserted] = import_cache_.try_emplace(decl);
   if (!inserted) {
     // TODO(jeanpierreda): Fix and promote to CHECK.
     // At least one cycle occurs with Typedef, where a typedef will import
@@ -509,8 +555,9 @@ std::optional<IR::Item> Importer::GetDeclItem(clang::Decl* decl) {
         << "\n  trying to import a " << decl->getDeclKindName()
         << "\n  present entry: " << ItemToString(it->second)
         << "\n  was going to be inserted: " << ItemToString(result);
-    it->second = result;
   }
+  it->second = std::move(result);
+  const std::optional<IR::Item>& cached_item = it->second;
   if (auto* record_decl = clang::dyn_cast<clang::CXXRecordDecl>(decl)) {
     // TODO(forster): Should we even visit the nested decl if we couldn't
     // import the parent? For now we have tests that check that we generate
@@ -523,7 +570,7 @@ std::optional<IR::Item> Importer::GetDeclItem(clang::Decl* decl) {
     // IR::top_level_item_ids.
     class_template_instantiations_.insert(specialization_decl);
   }
-  return result;
+  return cached_item;
 }
 
 /// Returns true if a decl is inside a private section, or is inside a
@@ -554,8 +601,10 @@ bool IsTransitivelyInPrivate(clang::Decl* decl_to_check) {
 
 std::optional<IR::Item> Importer::ImportDecl(clang::Decl* decl) {
   if (IsTransitivelyInPrivate(decl)) return std::nullopt;
-  for (auto& importer : decl_importers_) {
-    std::optional<IR::Item> result = importer->ImportDecl(decl);
+  for (size_t i = 0; i < decl_importers_.size(); ++i) {
+    TimingReport::Phase phase(invocation_.timing_report_,
+                              decl_importer_phases_[i]);
+    std::optional<IR::Item> result = decl_importers_[i]->ImportDecl(decl);
     if (result.has_value()) {
       return result;
     }
@@ -563,33 +612,49 @@ std::optional<IR::Item> Importer::ImportDecl(clang::Decl* decl) {
   return std::nullopt;
 }
 
-std::optional<IR::Item> Importer::GetImportedItem(const clang::Decl* decl) {
+const IR::Item* Importer::GetImportedItem(const clang::Decl* decl) {
   auto it = import_cache_.find(decl);
-  if (it != import_cache_.end()) {
-    return it->second;
+  if (it != import_cache_.end() && it->second.has_value()) {
+    return &*it->second;
   }
-  return std::nullopt;
+  return nullptr;
 }
 
 BazelLabel Importer::GetOwningTarget(const clang::Decl* decl) const {
   // Template instantiations need to be generated in the target that triggered
-  // the instantiation (not in the target where the template is defined).
-  if (IsFullClassTemplateSpecializationOrChild(decl)) {
+  // the instantiation (not in the target where the template is defined),
+  // unless `--target_args` assigns them to a target of their own, which other
+  // targets then reuse.
+  if (const clang::ClassTemplateSpecializationDecl* specialization_decl =
+          GetFullClassTemplateSpecializationOrParent(decl)) {
+    if (invocation_.has_instantiation_targets()) {
+      std::string cc_name = GetClassTemplateSpecializationCcName(
+          ctx_, specialization_decl, /*use_preferred_names=*/false);
+      if (std::optional<BazelLabel> target =
+              invocation_.instantiation_target(cc_name)) {
+        return *std::move(target);
+      }
+    }
     return invocation_.target_;
   }
 
-  clang::SourceManager& source_manager = ctx_.getSourceManager();
-  auto source_location = decl->getLocation();
+  clang::SourceLocation source_location = decl->getLocation();
+  if (!source_location.isValid()) {
+    return BazelLabel("//:virtual_clang_resource_dir_target");
+  }
+  const clang::SourceManager& source_manager = ctx_.getSourceManager();
+  return GetOwningTargetOfFile(source_manager.getFileID(
+      source_manager.getExpansionLoc(source_location)));
+}
 
-  // If the header this decl comes from is not associated with a target we
-  // consider it a textual header. In that case we go up the include stack
-  // until we find a header that has an owning target.
+BazelLabel Importer::GetOwningTargetOfFile(clang::FileID id) const {
+  if (auto it = owning_targets_of_files_.find(id);
+      it != owning_targets_of_files_.end()) {
+    return it->second;
+  }
 
-  while (source_location.isValid()) {
-    if (source_location.isMacroID()) {
-      source_location = source_manager.getExpansionLoc(source_location);
-    }
-    auto id = source_manager.getFileID(source_location);
+  const clang::SourceManager& source_manager = ctx_.getSourceManager();
+  BazelLabel target = [&] {
     std::optional<llvm::StringRef> filename =
         source_manager.getNonBuiltinFilenameForID(id);
     if (!filename) {
@@ -598,29 +663,61 @@ BazelLabel Importer::GetOwningTarget(const clang::Decl* decl) const {
     if (filename->startswith("./")) {
       filename = filename->substr(2);
     }
-
     if (auto target = invocation_.header_target(HeaderName(filename->str()))) {
       return *target;
     }
-    source_location = source_manager.getIncludeLoc(id);
-  }
 
-  return BazelLabel("//:virtual_clang_resource_dir_target");
+    // If the header this decl comes from is not associated with a target we
+    // consider it a textual header. In that case we go up the include stack
+    // until we find a header that has an owning target.
+    clang::SourceLocation include_location = source_manager.getIncludeLoc(id);
+    if (!include_location.isValid()) {
+      return BazelLabel("//:virtual_clang_resource_dir_target");
+    }
+    return GetOwningTargetOfFile(source_manager.getFileID(
+        source_manager.getExpansionLoc(include_location)));
+  }();
+  owning_targets_of_files_.try_emplace(id, target);
+  return target;
+}
+
+bool Importer::IsFileOfCurrentTarget(clang::FileID id) const {
+  auto [it, inserted] = is_file_of_current_target_.try_emplace(id, false);
+  if (inserted) {
+    it->second = invocation_.target_ == GetOwningTargetOfFile(id);
+  }
+  return it->second;
 }
 
 bool Importer::IsFromCurrentTarget(const clang::Decl* decl) const {
+  // For all decls but template instantiations (see `GetOwningTarget`), the
+  // file they are expanded in decides, which is only looked up once.
+  clang::SourceLocation source_location = decl->getLocation();
+  if (source_location.isValid() &&
+      GetFullClassTemplateSpecializationOrParent(decl) == nullptr) {
+    const clang::SourceManager& source_manager = ctx_.getSourceManager();
+    return IsFileOfCurrentTarget(source_manager.getFileID(
+        source_manager.getExpansionLoc(source_location)));
+  }
   return invocation_.target_ == GetOwningTarget(decl);
 }
 
 IR::Item Importer::ImportUnsupportedItem(const clang::Decl* decl,
                                          std::string error) {
+  // The unsupported items of other targets are not part of the IR. Only their
+  // message is used, to explain why the items that refer to them are
+  // unsupported, so don't spend time on spelling their name and location.
+  if (!IsFromCurrentTarget(decl)) {
+    return UnsupportedItem{.message = std::move(error),
+                           .id = GenerateItemId(decl)};
+  }
   std::string name = "unnamed";
   if (const auto* named_decl = clang::dyn_cast<clang::NamedDecl>(decl)) {
     name = named_decl->getQualifiedNameAsString();
   }
   std::string source_loc = ConvertSourceLocation(decl->getBeginLoc());
   return UnsupportedItem{.name = name,
-                         .message = error,
+                         .message = std::move(error),
                          .source_loc = source_loc,
                          .id = GenerateItemId(decl)};
 }
@@ -726,6 +823,32 @@ absl::StatusOr<MappedType> Importer::ConvertTemplateSpecializationType(
   if (HasBeenAlreadySuccessfullyImported(specialization_decl))
     return ConvertTypeDecl(specialization_decl);
 
+  // Only specializations that haven't been imported yet count towards the
+  // limits, as the others don't need any more Sema work.
+  if (!import_cache_.contains(specialization_decl)) {
+    const char* exceeded_flag = nullptr;
+    int limit = 0;
+    if (invocation_.max_template_instantiations_ > 0 &&
+        num_template_instantiations_ >=
+            invocation_.max_template_instantiations_) {
+      exceeded_flag = "max_template_instantiations";
+      limit = invocation_.max_template_instantiations_;
+    } else if (invocation_.max_template_instantiation_depth_ > 0 &&
+               template_instantiation_depth_ >=
+                   invocation_.max_template_instantiation_depth_) {
+      exceeded_flag = "max_template_instantiation_depth";
+      limit = invocation_.max_template_instantiation_depth_;
+    }
+    if (exceeded_flag != nullptr) {
+      invocation_.skipped_template_instantiations_.push_back(type_string);
+      return absl::ResourceExhaustedError(absl::Substitute(
+          "Skipped the instantiation of template specialization type $0: "
+          "--$1=$2 was reached",
+          type_string, exceeded_flag, limit));
+    }
+    ++num_template_instantiations_;
+  }
+
   // `Sema::isCompleteType` will try to instantiate the class template as a
   // side-effect and we rely on this here. `decl->getDefinition()` can
   // return nullptr before the call to sema and return its definition
@@ -733,11 +856,10 @@ absl::StatusOr<MappedType> Importer::ConvertTemplateSpecializationType(
   (void)sema_.isCompleteType(specialization_decl->getLocation(),
                              ctx_.getRecordType(specialization_decl));
 
-  // TODO(lukasza): Limit specialization depth? (e.g. using
-  // `isSpecializationDepthGreaterThan` from earlier prototypes).
-
+  ++template_instantiation_depth_;
   absl::Status import_status =
       CheckImportStatus(GetDeclItem(specialization_decl));
+  --template_instantiation_depth_;
   if (!import_status.ok()) {
     return absl::InvalidArgumentError(absl::Substitute(
         "Failed to create bindings for template specialization type $0: $1",
@@ -916,6 +1038,61 @@ absl::StatusOr<MappedType> Importer::ConvertType(
       default:
         return absl::UnimplementedError("Unsupported builtin type");
     }
+  } else if (std::optional<clang::QualType> span_element_type =
+                 GetSpanElementType(*type);
+             span_element_type.has_value()) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        MappedType mapped_element_type,
+        ConvertQualType(*span_element_type, /*lifetimes=*/nullptr,
+                        /*ref_qualifier_kind=*/std::nullopt));
+    return MappedType::SpanOf(
+        std::move(mapped_element_type),
+        clang::QualType(type, 0).getCanonicalType().getAsString());
+  } else if (IsStdStringWithKnownLayout(*type, sema_) &&
+             // `cc_std` itself can't refer to `cc_std::String` by the crate's
+             // name, so it keeps the ordinary bindings of `std::string`.
+             !IsFromCurrentTarget(type->getAsCXXRecordDecl())) {
+    return MappedType::StdString(
+        clang::QualType(type, 0).getCanonicalType().getAsString());
+  } else if (std::optional<clang::QualType> vector_element_type =
+                 GetVectorElementType(*type);
+             vector_element_type.has_value()) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        MappedType mapped_element_type,
+        ConvertQualType(*vector_element_type, /*lifetimes=*/nullptr,
+                        /*ref_qualifier_kind=*/std::nullopt));
+    return MappedType::VectorOf(
+        std::move(mapped_element_type),
+        clang::QualType(type, 0).getCanonicalType().getAsString());
+  } else if (std::optional<clang::QualType> optional_value_type =
+                 GetOptionalValueType(*type, sema_);
+             optional_value_type.has_value() &&
+             // `cc_std` can't refer to `cc_std::Optional` by the crate's name.
+             !IsFromCurrentTarget(type->getAsCXXRecordDecl())) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        MappedType mapped_value_type,
+        ConvertQualType(*optional_value_type, /*lifetimes=*/nullptr,
+                        /*ref_qualifier_kind=*/std::nullopt));
+    return MappedType::OptionalOf(
+        std::move(mapped_value_type),
+        clang::QualType(type, 0).getCanonicalType().getAsString());
+  } else if (std::optional<clang::QualType> unique_ptr_element_type =
+                 GetUniquePtrElementType(*type, sema_);
+             unique_ptr_element_type.has_value() &&
+             // The bindings of the target of `T` implement `cc_std::CcDelete`
+             // for it, and `cc_std` can't refer to `cc_std::CcBox`.
+             ((*unique_ptr_element_type)->isBuiltinType() ||
+              IsFromCurrentTarget(
+                  (*unique_ptr_element_type)->getAsCXXRecordDecl())) &&
+             !IsFromCurrentTarget(type->getAsCXXRecordDecl())) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        MappedType mapped_element_type,
+        ConvertQualType(*unique_ptr_element_type, /*lifetimes=*/nullptr,
+                        /*ref_qualifier_kind=*/std::nullopt));
+    return MappedType::UniquePtrOf(
+        std::move(mapped_element_type),
+        type->getAsCXXRecordDecl()->canPassInRegisters(),
+        clang::QualType(type, 0).getCanonicalType().getAsString());
   } else if (const auto* tag_type = type->getAsAdjusted<clang::TagType>()) {
     return ConvertTypeDecl(tag_type->getDecl());
   } else if (const auto* typedef_type =
@@ -965,6 +1142,21 @@ absl::StatusOr<MappedType> Importer::ConvertQualType(
     const clang::tidy::lifetimes::ValueLifetimes* lifetimes,
     std::optional<clang::RefQualifierKind> ref_qualifier_kind, bool nullable) {
   qual_type = GetUnelaboratedType(std::move(qual_type), ctx_);
+
+  // Conversions with lifetimes aren't cached: `ValueLifetimes` don't outlive
+  // the declaration being imported, so their address can't be part of the key.
+  // Lifetime-less `ValueLifetimes` don't affect the conversion.
+  std::optional<decltype(type_cache_)::key_type> cache_key;
+  if (lifetimes == nullptr || !lifetimes->HasLifetimes()) {
+    cache_key.emplace(qual_type.getAsOpaquePtr(), ref_qualifier_kind,
+                      nullable);
+    if (auto it = type_cache_.find(*cache_key); it != type_cache_.end()) {
+      ++invocation_.type_conversion_cache_stats_.hits;
+      return it->second;
+    }
+    ++invocation_.type_conversion_cache_stats_.misses;
+  }
+
   std::string type_string = qual_type.getAsString();
   absl::StatusOr<MappedType> type = ConvertType(
       qual_type.getTypePtr(), lifetimes, ref_qualifier_kind, nullable);
@@ -982,10 +1174,26 @@ absl::StatusOr<MappedType> Importer::ConvertQualType(
         absl::StrCat("Unsupported `volatile` qualifier: ", type_string));
   }
 
+  // Errors are not cached, as a decl which can't be converted yet may be
+  // successfully imported later on.
+  if (cache_key.has_value()) type_cache_.try_emplace(*cache_key, *type);
   return type;
 }
 
 std::string Importer::GetMangledName(const clang::NamedDecl* named_decl) const {
+  // The same decls are mangled many times, e.g. records for every type and
+  // upcast thunk referring to them, and for sorting items.
+  auto [it, inserted] = mangled_names_.try_emplace(named_decl);
+  if (inserted) {
+    ++invocation_.mangled_name_cache_stats_.misses;
+    it->second = MangleName(named_decl);
+  } else {
+    ++invocation_.mangled_name_cache_stats_.hits;
+  }
+  return it->second;
+}
+
+std::string Importer::MangleName(const clang::NamedDecl* named_decl) const {
   if (auto record_decl = clang::dyn_cast<clang::RecordDecl>(named_decl)) {
     // Mangled record names are used to 1) provide valid Rust identifiers for
     // C++ template specializations, and 2) help build unique names for virtual
@@ -9,10 +9,15 @@
 #include <optional>
 #include <set>
 #include <string>
+#include <tuple>
 #include <utility>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/node_hash_map.h"
 #include "absl/log/die_if_null.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
 #include "common/status_macros.h"
 #include "rs_bindings_from_cc/decl_importer.h"
 #include "rs_bindings_from_cc/importers/class_template.h"
@@ -24,9 +29,13 @@
 #include "rs_bindings_from_cc/importers/namespace.h"
 #include "rs_bindings_from_cc/importers/type_alias.h"
 #include "rs_bindings_from_cc/importers/type_map_override.h"
+#include "rs_bindings_from_cc/importers/var.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
 #include "clang/AST/Mangle.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/Basic/SourceLocation.h"
+#include "llvm/ADT/DenseMap.h"
 
 namespace crubit {
 
@@ -39,17 +48,17 @@ class Importer final : public ImportContext {
                     clang::Sema& sema)
       : ImportContext(invocation, ctx, sema),
         mangler_(ABSL_DIE_IF_NULL(ctx_.createMangleContext())) {
-    decl_importers_.push_back(std::make_unique<TypeMapOverrideImporter>(*this));
-    decl_importers_.push_back(
-        std::make_unique<ClassTemplateDeclImporter>(*this));
-    decl_importers_.push_back(std::make_unique<CXXRecordDeclImporter>(*this));
-    decl_importers_.push_back(std::make_unique<EnumDeclImporter>(*this));
-    decl_importers_.push_back(std::make_unique<FriendDeclImporter>(*this));
-    decl_importers_.push_back(std::make_unique<FunctionDeclImporter>(*this));
-    decl_importers_.push_back(
-        std::make_unique<FunctionTemplateDeclImporter>(*this));
-    decl_importers_.push_back(std::make_unique<NamespaceDeclImporter>(*this));
-    decl_importers_.push_back(std::make_unique<TypeAliasImporter>(*this));
+    AddDeclImporter<TypeMapOverrideImporter>("TypeMapOverrideImporter");
+    AddDeclImporter<ClassTemplateDeclImporter>("ClassTemplateDeclImporter");
+    AddDeclImporter<CXXRecordDeclImporter>("CXXRecordDeclImporter");
+    AddDeclImporter<EnumDeclImporter>("EnumDeclImporter");
+    AddDeclImporter<FriendDeclImporter>("FriendDeclImporter");
+    AddDeclImporter<FunctionDeclImporter>("FunctionDeclImporter");
+    AddDeclImporter<FunctionTemplateDeclImporter>(
+        "FunctionTemplateDeclImporter");
+    AddDeclImporter<NamespaceDeclImporter>("NamespaceDeclImporter");
+    AddDeclImporter<TypeAliasImporter>("TypeAliasImporter");
+    AddDeclImporter<VarDeclImporter>("VarDeclImporter");
   }
 
   // Import all visible declarations from a translation unit.
@@ -64,7 +73,7 @@ class Importer final : public ImportContext {
   IR::Item ImportUnsupportedItem(const clang::Decl* decl,
                                  std::set<std::string> errors) override;
   std::optional<IR::Item> ImportDecl(clang::Decl* decl) override;
-  std::optional<IR::Item> GetImportedItem(const clang::Decl* decl) override;
+  const IR::Item* GetImportedItem(const clang::Decl* decl) override;
   std::vector<ItemId> GetItemIdsInSourceOrder(clang::Decl* decl) override;
   std::string GetMangledName(const clang::NamedDecl* named_decl) const override;
   BazelLabel GetOwningTarget(const clang::Decl* decl) const override;
@@ -116,7 +125,32 @@ class Importer final : public ImportContext {
   // deterministic/reproducible order.
   std::vector<ItemId> GetOrderedItemIdsOfTemplateInstantiations() const;
 
-  std::optional<IR::Item> GetDeclItem(clang::Decl* decl) override;
+  // Returns the mangled name of `named_decl`, without memoizing it like
+  // `GetMangledName` does.
+  std::string MangleName(const clang::NamedDecl* named_decl) const;
+
+  // Returns true if `decl` is only imported when another decl refers to it,
+  // rather than when visiting its parent (see
+  // `Invocation::lazy_dependency_imports_`).
+  bool IsImportedOnlyOnDemand(const clang::Decl* decl) const;
+
+  // Returns the owning target of the decls in the file `id`: the target of the
+  // header, or, for textual headers, of the nearest header including it which
+  // has one.
+  BazelLabel GetOwningTargetOfFile(clang::FileID id) const;
+
+  // Returns true if the owning target of the decls in the file `id` is the
+  // current target.
+  bool IsFileOfCurrentTarget(clang::FileID id) const;
+
+  // Adds a decl importer, whose timing phase is named after `name`.
+  template <typename T>
+  void AddDeclImporter(absl::string_view name) {
+    decl_importers_.push_back(std::make_unique<T>(*this));
+    decl_importer_phases_.push_back(absl::StrCat("import.", name));
+  }
+
+  const std::optional<IR::Item>& GetDeclItem(clang::Decl* decl) override;
   // Stores the comments of this target in source order.
   void ImportFreeComments();
 
@@ -140,12 +174,38 @@ class Importer final : public ImportContext {
   // The different decl importers. Note that order matters: the first importer
   // to successfully match a decl "wins", and no other importers are tried.
   std::vector<std::unique_ptr<DeclImporter>> decl_importers_;
+  // The `TimingReport` phase of each of the `decl_importers_`.
+  std::vector<std::string> decl_importer_phases_;
   std::unique_ptr<clang::MangleContext> mangler_;
-  absl::flat_hash_map<const clang::Decl*, std::optional<IR::Item>>
+  // A node map, so that the references returned by `GetDeclItem` stay valid
+  // while the decls they depend on are imported. `Import` moves the items out
+  // into the IR once all of them are imported.
+  absl::node_hash_map<const clang::Decl*, std::optional<IR::Item>>
       import_cache_;
+  // Successful conversions of `ConvertQualType`, keyed by the (sugared,
+  // unelaborated) type and the `ref_qualifier_kind` and `nullable` arguments.
+  // Typedefs map to their own decls, so the key can't be the canonical type.
+  absl::flat_hash_map<
+      std::tuple<const void*, std::optional<clang::RefQualifierKind>, bool>,
+      MappedType>
+      type_cache_;
   absl::flat_hash_set<const clang::ClassTemplateSpecializationDecl*>
       class_template_instantiations_;
+  // The number of class template specializations that
+  // `ConvertTemplateSpecializationType` has imported, and the number of those
+  // it is in the middle of importing, for the limits of
+  // `Invocation::max_template_instantiations_` and
+  // `Invocation::max_template_instantiation_depth_`.
+  int num_template_instantiations_ = 0;
+  int template_instantiation_depth_ = 0;
   std::vector<const clang::RawComment*> comments_;
+  mutable absl::flat_hash_map<const clang::NamedDecl*, std::string>
+      mangled_names_;
+  // Memoizes `GetOwningTargetOfFile`, which runs for almost every decl.
+  mutable llvm::DenseMap<clang::FileID, BazelLabel> owning_targets_of_files_;
+  // Memoizes `IsFileOfCurrentTarget`, so that deciding whether a decl is from
+  // the current target doesn't copy and compare labels.
+  mutable llvm::DenseMap<clang::FileID, bool> is_file_of_current_target_;
 
   // Set of decls that have been successfully imported (i.e. that will be
   // present in the IR output / that will not produce dangling ItemIds in the IR
@@ -2,6 +2,7 @@
 // Exceptions. See /LICENSE for license information.
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
+#include <memory>
 #include <optional>
 #include <string>
 #include <variant>
@@ -10,11 +11,19 @@
 #include "gmock/gmock.h"
 #include "gtest/gtest.h"
 #include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/substitute.h"
 #include "common/status_test_matchers.h"
+#include "lifetime_annotations/lifetime_summaries.h"
+#include "nullability/inference/inference.proto.h"
+#include "nullability/inference/inference_table.h"
 #include "rs_bindings_from_cc/bazel_types.h"
+#include "rs_bindings_from_cc/decl_importer.h"
 #include "rs_bindings_from_cc/ir.h"
 #include "rs_bindings_from_cc/ir_from_cc.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace crubit {
 namespace {
@@ -268,6 +277,9 @@ auto Destructor(const Args&... matchers) {
 // Matches a Record which is trivial for calls.
 MATCHER(IsTrivialAbi, "") { return arg.is_trivial_abi; }
 
+// Matches a Record which is trivially relocatable.
+MATCHER(IsTriviallyRelocatable, "") { return arg.is_trivially_relocatable; }
+
 // Matches a Field that has the given offset.
 MATCHER_P(OffsetIs, offset, "") {
   if (arg.offset == offset) return true;
@@ -350,6 +362,85 @@ TEST(ImporterTest, TwoFuncsFromTwoHeaders) {
                                    VariantWith<Func>(IdentifierIs("Bar"))));
 }
 
+TEST(ImporterTest, LazyDependencyImports) {
+  ASSERT_OK_AND_ASSIGN(
+      IR ir,
+      IrFromCc({.current_target = BazelLabel{"//test:target"},
+                .public_headers = {HeaderName("a.h")},
+                .virtual_headers_contents_for_testing =
+                    {{HeaderName("dep.h"),
+                      "struct Used {}; struct Unused {}; void DepFunc();"},
+                     {HeaderName("a.h"),
+                      "#include \"dep.h\"\nvoid Foo(Used* used);"}},
+                .headers_to_targets = {{HeaderName("a.h"),
+                                        BazelLabel{"//test:target"}},
+                                       {HeaderName("dep.h"),
+                                        BazelLabel{"//test:dep"}}},
+                .lazy_dependency_imports = true}));
+  EXPECT_THAT(ItemsWithoutBuiltins(ir),
+              UnorderedElementsAre(VariantWith<Record>(RsNameIs("Used")),
+                                   VariantWith<Func>(IdentifierIs("Foo"))));
+}
+
+TEST(ImporterTest, MaxTemplateInstantiations) {
+  absl::string_view file = R"cc(
+    template <typename T>
+    struct S {
+      T t;
+    };
+    void Foo(S<int>* s);
+    void Bar(S<char>* s);
+    void Baz(S<int>* s);
+  )cc";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({.extra_source_code_for_testing = file,
+                                        .max_template_instantiations = 1}));
+  EXPECT_THAT(ir.get_items_if<Func>(),
+              UnorderedElementsAre(Pointee(IdentifierIs("Foo")),
+                                   Pointee(IdentifierIs("Baz"))));
+  EXPECT_THAT(ir.get_items_if<UnsupportedItem>(),
+              Contains(Pointee(NameIs("Bar"))));
+}
+
+TEST(ImporterTest, MaxTemplateInstantiationDepth) {
+  absl::string_view file = R"cc(
+    template <typename T>
+    struct W {
+      T t;
+    };
+    void Foo(W<W<int>>* w);
+  )cc";
+  ASSERT_OK_AND_ASSIGN(
+      IR ir, IrFromCc({.extra_source_code_for_testing = file,
+                       .max_template_instantiation_depth = 1}));
+  // `W<int>` would only be instantiated for the field of `W<W<int>>`.
+  EXPECT_THAT(ir.get_items_if<Record>(), SizeIs(1));
+  EXPECT_THAT(ir.get_items_if<Func>(),
+              UnorderedElementsAre(Pointee(IdentifierIs("Foo"))));
+}
+
+TEST(ImporterTest, ItemIdsDontDependOnOtherDecls) {
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({"struct S {}; namespace ns {}"}));
+  ASSERT_OK_AND_ASSIGN(
+      IR ir_with_more_decls,
+      IrFromCc({"struct Other {}; struct S {}; "
+                "namespace ns {} namespace ns {}"}));
+  std::vector<const Record*> records = ir.get_items_if<Record>();
+  ASSERT_THAT(records, SizeIs(1));
+  std::vector<const Record*> records_with_more_decls =
+      ir_with_more_decls.get_items_if<Record>();
+  ASSERT_THAT(records_with_more_decls, SizeIs(2));
+  EXPECT_EQ(records_with_more_decls[1]->id, records[0]->id);
+  EXPECT_NE(records_with_more_decls[0]->id, records[0]->id);
+
+  // Reopened namespaces are items of their own.
+  std::vector<const Namespace*> namespaces =
+      ir_with_more_decls.get_items_if<Namespace>();
+  ASSERT_THAT(namespaces, SizeIs(2));
+  EXPECT_NE(namespaces[0]->id, namespaces[1]->id);
+  EXPECT_EQ(namespaces[0]->canonical_namespace_id, namespaces[0]->id);
+  EXPECT_EQ(namespaces[1]->canonical_namespace_id, namespaces[0]->id);
+}
+
 TEST(ImporterTest, NonInlineFunc) {
   ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({"void Foo() {}"}));
   EXPECT_THAT(ItemsWithoutBuiltins(ir),
@@ -395,6 +486,70 @@ TEST(ImporterTest, TestImportConstStructPointerFunc) {
                             ParamsAre(ParamType(is_ptr_to_const_s))))));
 }
 
+TEST(ImporterTest, InferredNonnullPointerIsReference) {
+  clang::tidy::nullability::Inference inference;
+  inference.mutable_symbol()->set_usr("c:@F@Foo#*I#");
+  auto* slot_inference = inference.add_slot_inference();
+  slot_inference->set_slot(clang::tidy::nullability::SLOT_PARAM);
+  slot_inference->set_nullability(clang::tidy::nullability::Inference::NONNULL);
+  std::string table_data;
+  llvm::raw_string_ostream os(table_data);
+  clang::tidy::nullability::writeInferenceTable({inference}, os);
+  os.flush();
+  auto table = clang::tidy::nullability::InferenceTable::fromBuffer(
+      llvm::MemoryBuffer::getMemBufferCopy(table_data));
+  ASSERT_TRUE(static_cast<bool>(table));
+
+  ASSERT_OK_AND_ASSIGN(
+      IR ir, IrFromCc({.extra_source_code_for_testing =
+                           "#pragma clang lifetime_elision\n"
+                           "int* Foo(int* a);",
+                       .nullability_inferences = &*table}));
+  // The return type wasn't inferred, so it stays nullable.
+  EXPECT_THAT(ItemsWithoutBuiltins(ir),
+              UnorderedElementsAre(VariantWith<Func>(
+                  AllOf(ReturnType(RsTypeIs(NameIs("Option"))),
+                        ParamsAre(ParamType(RsTypeIs(NameIs("&mut"))))))));
+}
+
+TEST(ImporterTest, InferredLifetimesMakePointersReferences) {
+  auto summaries = clang::tidy::lifetimes::LifetimeSummaries::Parse(
+      "c:@F@Foo#*I#\ta, a\n");
+  ASSERT_TRUE(static_cast<bool>(summaries));
+
+  ASSERT_OK_AND_ASSIGN(
+      IR ir, IrFromCc({.extra_source_code_for_testing = "int* Foo(int* a);",
+                       .lifetime_summaries = std::make_shared<
+                           const clang::tidy::lifetimes::LifetimeSummaries>(
+                           std::move(*summaries))}));
+  EXPECT_THAT(ItemsWithoutBuiltins(ir),
+              UnorderedElementsAre(VariantWith<Func>(
+                  AllOf(ReturnType(RsTypeIs(NameIs("Option"))),
+                        ParamsAre(ParamType(RsTypeIs(NameIs("Option"))))))));
+}
+
+TEST(ImporterTest, NullabilityInferredInProcess) {
+  ASSERT_OK_AND_ASSIGN(
+      IR ir, IrFromCc({.extra_source_code_for_testing =
+                           "#pragma clang lifetime_elision\n"
+                           "inline void Foo(int* a) { *a = 1; }",
+                       .infer_nullability = true}));
+  EXPECT_THAT(ItemsWithoutBuiltins(ir),
+              UnorderedElementsAre(VariantWith<Func>(
+                  ParamsAre(ParamType(RsTypeIs(NameIs("&mut")))))));
+}
+
+TEST(ImporterTest, LifetimesInferredInProcess) {
+  ASSERT_OK_AND_ASSIGN(
+      IR ir, IrFromCc({.extra_source_code_for_testing =
+                           "inline int* Foo(int* a) { return a; }",
+                       .infer_lifetimes = true}));
+  EXPECT_THAT(ItemsWithoutBuiltins(ir),
+              UnorderedElementsAre(VariantWith<Func>(
+                  AllOf(ReturnType(RsTypeIs(NameIs("Option"))),
+                        ParamsAre(ParamType(RsTypeIs(NameIs("Option"))))))));
+}
+
 TEST(ImporterTest, TestImportReferenceFunc) {
   ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({"int& Foo(int& a);"}));
 
@@ -409,11 +564,19 @@ TEST(ImporterTest, TrivialCopyConstructor) {
     struct Defaulted {
       Defaulted(const Defaulted&) = default;
     };
+
+    // Not trivially copyable as far as C++ is concerned, because the *first*
+    // declaration is not defaulted, but it copies exactly like `Defaulted`.
+    struct DefaultedOutOfLine {
+      DefaultedOutOfLine(const DefaultedOutOfLine&);
+    };
+    inline DefaultedOutOfLine::DefaultedOutOfLine(const DefaultedOutOfLine&) =
+        default;
   )cc";
   ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
 
   std::vector<const Record*> records = ir.get_items_if<Record>();
-  EXPECT_THAT(records, SizeIs(2));
+  EXPECT_THAT(records, SizeIs(3));
   EXPECT_THAT(records,
               Each(Pointee(CopyConstructor(SpecialMemberFunc::kTrivial))));
 }
@@ -425,9 +588,8 @@ TEST(ImporterTest, NontrivialUserDefinedCopyConstructor) {
     };
     struct NontrivialSub : public NontrivialUserDefined {};
 
-    // Despite having a defaulted copy constructor, this is not trivially
-    // copyable, because the *first* declaration is not defaulted.
-    struct NontrivialUserDefinedDefaulted {
+    // Defaulted out of line, but copying the base class isn't trivial.
+    struct NontrivialUserDefinedDefaulted : public NontrivialUserDefined {
       NontrivialUserDefinedDefaulted(const NontrivialUserDefinedDefaulted&);
     };
     inline NontrivialUserDefinedDefaulted::NontrivialUserDefinedDefaulted(
@@ -528,11 +690,19 @@ TEST(ImporterTest, TrivialMoveConstructor) {
     struct Defaulted {
       Defaulted(Defaulted&&) = default;
     };
+
+    // Not trivially movable as far as C++ is concerned, because the *first*
+    // declaration is not defaulted, but it moves exactly like `Defaulted`.
+    struct DefaultedOutOfLine {
+      DefaultedOutOfLine(DefaultedOutOfLine&&);
+    };
+    inline DefaultedOutOfLine::DefaultedOutOfLine(DefaultedOutOfLine&&) =
+        default;
   )cc";
   ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
 
   std::vector<const Record*> records = ir.get_items_if<Record>();
-  EXPECT_THAT(records, SizeIs(2));
+  EXPECT_THAT(records, SizeIs(3));
   EXPECT_THAT(records,
               Each(Pointee(MoveConstructor(SpecialMemberFunc::kTrivial))));
 }
@@ -544,9 +714,8 @@ TEST(ImporterTest, NontrivialUserDefinedMoveConstructor) {
     };
     struct NontrivialSub : public NontrivialUserDefined {};
 
-    // Despite having a defaulted move constructor, this is not trivially
-    // movable, because the *first* declaration is not defaulted.
-    struct NontrivialUserDefinedDefaulted {
+    // Defaulted out of line, but moving the base class isn't trivial.
+    struct NontrivialUserDefinedDefaulted : public NontrivialUserDefined {
       NontrivialUserDefinedDefaulted(NontrivialUserDefinedDefaulted&&);
     };
     inline NontrivialUserDefinedDefaulted::NontrivialUserDefinedDefaulted(
@@ -646,11 +815,18 @@ TEST(ImporterTest, TrivialDestructor) {
     struct Defaulted {
       ~Defaulted() = default;
     };
+
+    // Not trivially destructible as far as C++ is concerned, because the
+    // *first* declaration is not defaulted, but it is a no-op like `Defaulted`.
+    struct DefaultedOutOfLine {
+      ~DefaultedOutOfLine();
+    };
+    inline DefaultedOutOfLine::~DefaultedOutOfLine() = default;
   )cc";
   ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
 
   std::vector<const Record*> records = ir.get_items_if<Record>();
-  EXPECT_THAT(records, SizeIs(2));
+  EXPECT_THAT(records, SizeIs(3));
   EXPECT_THAT(records, Each(Pointee(Destructor(SpecialMemberFunc::kTrivial))));
 }
 
@@ -667,9 +843,8 @@ TEST(ImporterTest, NontrivialUserDefinedDestructor) {
       virtual ~VirtualDestructor() = default;
     };
 
-    // Despite having a defaulted destructor, this is not trivially
-    // destructible, because the *first* declaration is not defaulted.
-    struct NontrivialUserDefinedDefaulted {
+    // Defaulted out of line, but destroying the base class isn't trivial.
+    struct NontrivialUserDefinedDefaulted : public NontrivialUserDefined {
       ~NontrivialUserDefinedDefaulted();
     };
     inline NontrivialUserDefinedDefaulted::~NontrivialUserDefinedDefaulted() =
@@ -776,6 +951,7 @@ TEST(ImporterTest, TrivialAbi) {
   std::vector<const Record*> records = ir.get_items_if<Record>();
   EXPECT_THAT(records, SizeIs(3));
   EXPECT_THAT(records, Each(Pointee(IsTrivialAbi())));
+  EXPECT_THAT(records, Each(Pointee(IsTriviallyRelocatable())));
 }
 
 TEST(ImporterTest, NotTrivialAbi) {
@@ -783,14 +959,81 @@ TEST(ImporterTest, NotTrivialAbi) {
     struct Nontrivial {
       Nontrivial(const Nontrivial&) {}
     };
+    // Passed indirectly in the C++ ABI, but still trivially relocatable.
+    struct DefaultedOutOfLine {
+      DefaultedOutOfLine(const DefaultedOutOfLine&);
+    };
+    inline DefaultedOutOfLine::DefaultedOutOfLine(const DefaultedOutOfLine&) =
+        default;
   )cc";
   ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
 
   std::vector<const Record*> records = ir.get_items_if<Record>();
-  EXPECT_THAT(records, SizeIs(1));
+  EXPECT_THAT(records, SizeIs(2));
   EXPECT_THAT(records, Each(Pointee(Not(IsTrivialAbi()))));
 }
 
+TEST(ImporterTest, TriviallyRelocatable) {
+  absl::string_view file = R"cc(
+    struct DefaultedOutOfLine {
+      DefaultedOutOfLine(const DefaultedOutOfLine&);
+    };
+    inline DefaultedOutOfLine::DefaultedOutOfLine(const DefaultedOutOfLine&) =
+        default;
+    struct [[clang::annotate("crubit_internal_trivially_relocatable")]]
+    Annotated {
+      Annotated(Annotated&&) {}
+      ~Annotated() {}
+    };
+  )cc";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  std::vector<const Record*> records = ir.get_items_if<Record>();
+  EXPECT_THAT(records, SizeIs(2));
+  EXPECT_THAT(records, Each(Pointee(IsTriviallyRelocatable())));
+}
+
+TEST(ImporterTest, NotTriviallyRelocatable) {
+  absl::string_view file = R"cc(
+    struct Nontrivial {
+      Nontrivial(Nontrivial&&) {}
+    };
+    struct Polymorphic {
+      Polymorphic(const Polymorphic&);
+      virtual void f();
+    };
+    inline Polymorphic::Polymorphic(const Polymorphic&) = default;
+  )cc";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  std::vector<const Record*> records = ir.get_items_if<Record>();
+  EXPECT_THAT(records, SizeIs(2));
+  EXPECT_THAT(records, Each(Pointee(Not(IsTriviallyRelocatable()))));
+}
+
+TEST(ImporterTest, InvalidTriviallyRelocatableAttribute) {
+  absl::string_view file = R"cc(
+    struct [[clang::annotate("crubit_internal_trivially_relocatable", 1)]]
+    Invalid {};
+  )cc";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  EXPECT_THAT(ir.get_items_if<Record>(), IsEmpty());
+  EXPECT_THAT(ir.get_items_if<UnsupportedItem>(),
+              Contains(Pointee(NameIs("Invalid"))));
+}
+
+TEST(ImporterTest, InvalidThreadSafeAttribute) {
+  absl::string_view file = R"cc(
+    struct [[clang::annotate("crubit_internal_thread_safe", 1)]] Invalid {};
+  )cc";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  EXPECT_THAT(ir.get_items_if<Record>(), IsEmpty());
+  EXPECT_THAT(ir.get_items_if<UnsupportedItem>(),
+              Contains(Pointee(NameIs("Invalid"))));
+}
+
 TEST(ImporterTest, TopLevelItemIds) {
   absl::string_view file = R"cc(
     struct TopLevelStruct {};
@@ -826,6 +1069,33 @@ TEST(ImporterTest, TopLevelItemIds) {
           VariantWith<Comment>(TextIs("namespace top_level_namespace"))));
 }
 
+TEST(ImporterTest, ItemIdsOfManyCommentedDecls) {
+  constexpr int kNumStructs = 1000;
+  std::string file = "namespace ns {\n";
+  for (int i = 0; i < kNumStructs; ++i) {
+    absl::SubstituteAndAppend(&file,
+                              "// free comment $0\n\n"
+                              "// doc comment $0\n"
+                              "struct S$0 {};\n",
+                              i);
+  }
+  absl::StrAppend(&file, "}  // namespace ns\n");
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  std::vector<const Namespace*> namespaces = ir.get_items_if<Namespace>();
+  ASSERT_THAT(namespaces, SizeIs(1));
+  const std::vector<ItemId>& ids = namespaces[0]->child_item_ids;
+  ASSERT_THAT(ids, SizeIs(2 * kNumStructs));
+  for (int i = 0; i < kNumStructs; ++i) {
+    const auto* comment = ir.FindItem<Comment>(ids[2 * i]);
+    ASSERT_NE(comment, nullptr);
+    EXPECT_EQ(comment->text, absl::StrCat("free comment ", i));
+    const auto* record = ir.FindItem<Record>(ids[2 * i + 1]);
+    ASSERT_NE(record, nullptr);
+    EXPECT_EQ(record->rs_name, absl::StrCat("S", i));
+  }
+}
+
 TEST(ImporterTest, RecordItemIds) {
   absl::string_view file = R"cc(
     struct TopLevelStruct {
@@ -867,5 +1137,79 @@ TEST(ImporterTest, CrashRepro_FunctionTypeAlias) {
   ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
 }
 
+TEST(ImporterTest, MangledNameCacheReusesMangledNames) {
+  absl::string_view file = R"cc(
+    template <typename T>
+    struct Template {
+      T value;
+    };
+    void f(Template<int> t);
+    void g(Template<int> t);
+  )cc";
+  MangledNameCacheStats stats;
+  ASSERT_OK_AND_ASSIGN(
+      IR ir, IrFromCc({.extra_source_code_for_testing = file,
+                       .mangled_name_cache_stats = &stats}));
+  EXPECT_GT(stats.hits, 0);
+  EXPECT_GT(stats.misses, 0);
+}
+
+TEST(ImporterTest, TypeConversionCacheReusesConvertedTypes) {
+  absl::string_view file = R"cc(
+    template <typename T>
+    struct Template {
+      T value;
+    };
+    void f(Template<int> t);
+    void g(Template<int> t);
+  )cc";
+  TypeConversionCacheStats stats;
+  ASSERT_OK_AND_ASSIGN(
+      IR ir, IrFromCc({.extra_source_code_for_testing = file,
+                       .type_conversion_cache_stats = &stats}));
+  EXPECT_GT(stats.hits, 0);
+  EXPECT_GT(stats.misses, 0);
+
+  std::vector<const Func*> funcs = ir.get_items_if<Func>();
+  std::vector<std::optional<ItemId>> param_decl_ids;
+  for (const Func* func : funcs) {
+    auto* identifier = std::get_if<Identifier>(&func->name);
+    if (identifier == nullptr ||
+        (identifier->Ident() != "f" && identifier->Ident() != "g")) {
+      continue;
+    }
+    ASSERT_THAT(func->params, SizeIs(1));
+    param_decl_ids.push_back(func->params[0].type.rs_type.decl_id);
+  }
+  ASSERT_THAT(param_decl_ids, SizeIs(2));
+  EXPECT_TRUE(param_decl_ids[0].has_value());
+  EXPECT_EQ(param_decl_ids[0], param_decl_ids[1]);
+}
+
+TEST(ImporterTest, TypeConversionCacheDistinguishesTypeAliases) {
+  absl::string_view file = R"cc(
+    struct S {};
+    using Alias = S;
+    void f(S s);
+    void g(Alias a);
+  )cc";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  std::optional<ItemId> f_param;
+  std::optional<ItemId> g_param;
+  for (const Func* func : ir.get_items_if<Func>()) {
+    auto* identifier = std::get_if<Identifier>(&func->name);
+    if (identifier == nullptr || func->params.size() != 1) continue;
+    if (identifier->Ident() == "f") {
+      f_param = func->params[0].type.rs_type.decl_id;
+    } else if (identifier->Ident() == "g") {
+      g_param = func->params[0].type.rs_type.decl_id;
+    }
+  }
+  ASSERT_TRUE(f_param.has_value());
+  ASSERT_TRUE(g_param.has_value());
+  EXPECT_NE(*f_param, *g_param);
+}
+
 }  // namespace
 }  // namespace crubit
@@ -18,22 +18,28 @@
 #include "absl/log/die_if_null.h"
 #include "absl/log/log.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "lifetime_annotations/type_lifetimes.h"
 #include "rs_bindings_from_cc/ast_convert.h"
+#include "rs_bindings_from_cc/ast_util.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "clang/AST/APValue.h"
 #include "clang/AST/ASTContext.h"
+#include "clang/AST/Attr.h"
 #include "clang/AST/CXXInheritance.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclCXX.h"
-#include "clang/AST/PrettyPrinter.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
 #include "clang/AST/RecordLayout.h"
 #include "clang/AST/Type.h"
 #include "clang/Basic/LLVM.h"
 #include "clang/Basic/Specifiers.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/STLExtras.h"
 #include "llvm/Support/ErrorHandling.h"
 namespace crubit {
 
@@ -60,25 +66,6 @@ const absl::flat_hash_set<absl::string_view>& FinalOverrides() {
   return final_overrides;
 }
 
-std::string GetClassTemplateSpecializationCcName(
-    const clang::ASTContext& ast_context,
-    const clang::ClassTemplateSpecializationDecl* specialization_decl,
-    bool use_preferred_names) {
-  clang::PrintingPolicy policy(ast_context.getLangOpts());
-  policy.IncludeTagDefinition = false;
-  // Canonicalize types -- in particular, the template parameter types must be
-  // desugared out of an `ElaboratedType` so that their namespaces are written
-  // down.
-  policy.PrintCanonicalTypes = true;
-  policy.UsePreferredNames = use_preferred_names;
-  // Use type suffix (e.g. `123u` rather than just `123`) to avoid the
-  // `-Wimplicitly-unsigned-literal` warning.  See also b/244616557.
-  policy.AlwaysIncludeTypeForTemplateArgument = true;
-
-  return clang::QualType(specialization_decl->getTypeForDecl(), 0)
-      .getAsString(policy);
-}
-
 AccessSpecifier TranslateAccessSpecifier(clang::AccessSpecifier access) {
   switch (access) {
     case clang::AS_public:
@@ -118,6 +105,168 @@ absl::StatusOr<RecordType> TranslateRecordType(
   llvm::report_fatal_error("Unrecognized clang::TagKind");
 }
 
+// Returns true if a record with the given special member functions is passed
+// to functions the same way as a trivial type, assuming that special members
+// reported as `kTrivial` are actually trivial (c.f.
+// `clang::CXXRecordDecl::canPassInRegisters`, which is false for special
+// members that are defaulted out of line).
+bool IsTrivialForCallsInPractice(SpecialMemberFunc copy_constructor,
+                                 SpecialMemberFunc move_constructor,
+                                 SpecialMemberFunc destructor) {
+  auto is_trivial_or_unavailable = [](SpecialMemberFunc f) {
+    return f == SpecialMemberFunc::kTrivial ||
+           f == SpecialMemberFunc::kUnavailable;
+  };
+  return destructor == SpecialMemberFunc::kTrivial &&
+         is_trivial_or_unavailable(copy_constructor) &&
+         is_trivial_or_unavailable(move_constructor) &&
+         (copy_constructor == SpecialMemberFunc::kTrivial ||
+          move_constructor == SpecialMemberFunc::kTrivial);
+}
+
+// Gets the `annotation` attribute (e.g.
+// `crubit_internal_trivially_relocatable`) for `decl`, which takes no
+// arguments. If the attribute is specified, returns true. If it's unspecified,
+// returns false. If the attribute is malformed, returns a bad status.
+absl::StatusOr<bool> GetNoArgsAnnotateAttribute(const clang::Decl& decl,
+                                                absl::string_view annotation) {
+  bool found = false;
+  for (const clang::AnnotateAttr* attr :
+       decl.specific_attrs<clang::AnnotateAttr>()) {
+    if (attr->getAnnotation() != annotation) {
+      continue;
+    }
+    if (attr->args_size() != 0) {
+      return absl::InvalidArgumentError(absl::StrCat(
+          "The `", annotation, "` attribute takes no arguments."));
+    }
+    found = true;
+  }
+  return found;
+}
+
+// Returns true if `record_decl` is passed by value exactly like a C struct
+// with the same fields.
+//
+// For now this is only the case for (non-union) records that explicitly opt
+// into `[[clang::trivial_abi]]` and that are made only of scalar fields with
+// their natural layout.
+bool IsCAbiCompatibleByValue(const clang::CXXRecordDecl& record_decl,
+                             const clang::ASTContext& ast_context) {
+  if (!record_decl.hasAttr<clang::TrivialABIAttr>() ||
+      !record_decl.canPassInRegisters() || record_decl.isUnion() ||
+      record_decl.getNumBases() != 0 || record_decl.isDynamicClass() ||
+      record_decl.hasAttr<clang::AlignedAttr>() ||
+      record_decl.hasAttr<clang::PackedAttr>() || record_decl.field_empty()) {
+    return false;
+  }
+  return llvm::all_of(record_decl.fields(), [&](const clang::FieldDecl* field) {
+    if (field->isBitField() || field->isZeroSize(ast_context) ||
+        field->hasAttr<clang::AlignedAttr>() ||
+        field->hasAttr<clang::NoUniqueAddressAttr>()) {
+      return false;
+    }
+    clang::QualType type = field->getType().getCanonicalType();
+    if (type->isPointerType() || type->isEnumeralType()) return true;
+    // `__int128` and friends are excluded, because Rust and C don't always
+    // agree about their alignment.
+    return type->isBuiltinType() && type->isScalarType() &&
+           ast_context.getTypeSize(type) <= 64;
+  });
+}
+
+// Returns true if `decl` is annotated with `crubit_internal_rust_type`, i.e. if
+// its Rust type is given by the annotation rather than by its C++ definition.
+bool HasRustTypeAnnotation(const clang::Decl& decl) {
+  return llvm::any_of(decl.specific_attrs<clang::AnnotateAttr>(),
+                      [](const clang::AnnotateAttr* attr) {
+                        return attr->getAnnotation() ==
+                               "crubit_internal_rust_type";
+                      });
+}
+
+bool IsZeroInitializable(const clang::CXXRecordDecl& record_decl,
+                         clang::ASTContext& ast_context);
+
+// Returns true if zero bytes are the value that `type` is default-initialized
+// (or left uninitialized) to by the default constructor of a record with a
+// field of that type, and a valid value of its Rust bindings.
+//
+// Function pointers are excluded, because Rust `fn` pointers can't be null, and
+// so are pointers to members, whose null value isn't zero in the Itanium ABI.
+bool IsZeroInitializableType(clang::QualType type,
+                             clang::ASTContext& ast_context) {
+  for (const auto* alias = type->getAs<clang::TypedefType>(); alias != nullptr;
+       alias = alias->desugar()->getAs<clang::TypedefType>()) {
+    if (HasRustTypeAnnotation(*alias->getDecl())) return false;
+  }
+  type = type.getCanonicalType();
+  if (const clang::ConstantArrayType* array =
+          ast_context.getAsConstantArrayType(type)) {
+    return IsZeroInitializableType(array->getElementType(), ast_context);
+  }
+  if (type->isFunctionPointerType()) return false;
+  if (type->isPointerType() || type->isNullPtrType()) return true;
+  if (const auto* enum_type = type->getAs<clang::EnumType>()) {
+    return !HasRustTypeAnnotation(*enum_type->getDecl());
+  }
+  if (type->isBuiltinType()) return type->isArithmeticType();
+  if (const clang::CXXRecordDecl* record_decl = type->getAsCXXRecordDecl()) {
+    return IsZeroInitializable(*record_decl, ast_context);
+  }
+  return false;
+}
+
+// Returns true if the default member initializer `init` initializes its field
+// to zero bytes.
+bool IsZeroInitializer(const clang::Expr& init,
+                       clang::ASTContext& ast_context) {
+  const clang::Expr* expr = init.IgnoreImplicit();
+  if (const auto* list = llvm::dyn_cast<clang::InitListExpr>(expr)) {
+    return list->getNumInits() == 0;
+  }
+  if (const auto* construct = llvm::dyn_cast<clang::CXXConstructExpr>(expr)) {
+    return construct->getNumArgs() == 0 &&
+           construct->getConstructor()->isDefaultConstructor();
+  }
+  if (expr->isNullPointerConstant(
+          ast_context, clang::Expr::NPC_ValueDependentIsNotNull)) {
+    return true;
+  }
+  clang::Expr::EvalResult result;
+  if (expr->isValueDependent() ||
+      !expr->EvaluateAsRValue(result, ast_context)) {
+    return false;
+  }
+  const clang::APValue& value = result.Val;
+  return (value.isInt() && value.getInt().isZero()) ||
+         (value.isFloat() && value.getFloat().isPosZero());
+}
+
+// Returns true if the default constructor of `record_decl` (if it has a usable
+// one) zero-initializes it, see `Record::is_zero_initializable`.
+bool IsZeroInitializable(const clang::CXXRecordDecl& record_decl,
+                         clang::ASTContext& ast_context) {
+  const clang::CXXRecordDecl* definition = record_decl.getDefinition();
+  if (definition == nullptr || definition->isDynamicClass() ||
+      definition->hasUserProvidedDefaultConstructor() ||
+      HasRustTypeAnnotation(*definition)) {
+    return false;
+  }
+  for (const clang::CXXBaseSpecifier& base : definition->bases()) {
+    const clang::CXXRecordDecl* base_decl =
+        base.getType()->getAsCXXRecordDecl();
+    if (base_decl == nullptr || !IsZeroInitializable(*base_decl, ast_context)) {
+      return false;
+    }
+  }
+  return llvm::all_of(definition->fields(), [&](const clang::FieldDecl* field) {
+    if (!IsZeroInitializableType(field->getType(), ast_context)) return false;
+    const clang::Expr* init = field->getInClassInitializer();
+    return init == nullptr || IsZeroInitializer(*init, ast_context);
+  });
+}
+
 }  // namespace
 
 std::optional<Identifier> CXXRecordDeclImporter::GetTranslatedFieldName(
@@ -287,6 +436,27 @@ std::optional<IR::Item> CXXRecordDeclImporter::Import(
         .enclosing_namespace_id = GetEnclosingNamespaceId(record_decl)};
   }
 
+  // Unsafe annotations from `support/internal/attribute_macros.h`.
+  bool has_trivially_relocatable_attribute = false;
+  bool has_thread_safe_attribute = false;
+  bool has_thread_compatible_attribute = false;
+  for (auto [annotation, has_attribute] : {
+           std::pair{"crubit_internal_trivially_relocatable",
+                     &has_trivially_relocatable_attribute},
+           std::pair{"crubit_internal_thread_safe", &has_thread_safe_attribute},
+           std::pair{"crubit_internal_thread_compatible",
+                     &has_thread_compatible_attribute},
+       }) {
+    absl::StatusOr<bool> found =
+        GetNoArgsAnnotateAttribute(*record_decl, annotation);
+    if (!found.ok()) {
+      return ictx_.ImportUnsupportedItem(
+          record_decl, absl::StrCat("Invalid ", annotation, " attribute: ",
+                                    found.status().message()));
+    }
+    *has_attribute = *found;
+  }
+
   // At this point we know that the import of `record_decl` will succeed /
   // cannot fail.
   ictx_.MarkAsSuccessfullyImported(record_decl);
@@ -306,6 +476,11 @@ std::optional<IR::Item> CXXRecordDeclImporter::Import(
   auto item_ids = ictx_.GetItemIdsInSourceOrder(record_decl);
   const clang::TypedefNameDecl* anon_typedef =
       record_decl->getTypedefNameForAnonDecl();
+  SpecialMemberFunc copy_constructor =
+      GetCopyCtorSpecialMemberFunc(*record_decl);
+  SpecialMemberFunc move_constructor =
+      GetMoveCtorSpecialMemberFunc(*record_decl);
+  SpecialMemberFunc destructor = GetDestructorSpecialMemberFunc(*record_decl);
   auto record = Record{
       .rs_name = std::move(rs_name),
       .cc_name = std::move(cc_name),
@@ -324,10 +499,20 @@ std::optional<IR::Item> CXXRecordDeclImporter::Import(
           },
       .is_derived_class = is_derived_class,
       .override_alignment = override_alignment,
-      .copy_constructor = GetCopyCtorSpecialMemberFunc(*record_decl),
-      .move_constructor = GetMoveCtorSpecialMemberFunc(*record_decl),
-      .destructor = GetDestructorSpecialMemberFunc(*record_decl),
+      .copy_constructor = copy_constructor,
+      .move_constructor = move_constructor,
+      .destructor = destructor,
       .is_trivial_abi = record_decl->canPassInRegisters(),
+      .is_trivially_relocatable =
+          record_decl->canPassInRegisters() ||
+          IsTrivialForCallsInPractice(copy_constructor, move_constructor,
+                                      destructor) ||
+          has_trivially_relocatable_attribute,
+      .is_send = has_thread_safe_attribute || has_thread_compatible_attribute,
+      .is_sync = has_thread_safe_attribute || has_thread_compatible_attribute,
+      .is_c_abi_compatible_by_value =
+          IsCAbiCompatibleByValue(*record_decl, ictx_.ctx_),
+      .is_zero_initializable = IsZeroInitializable(*record_decl, ictx_.ctx_),
       .is_inheritable = !is_effectively_final,
       .is_abstract = record_decl->isAbstract(),
       .record_type = *record_type,
@@ -414,9 +599,8 @@ std::vector<Field> CXXRecordDeclImporter::ImportFields(
     if (field_record) {
       // If it is a record as a direct member, its item must be already
       // imported.
-      auto item = ictx_.GetImportedItem(field_record);
-      if (item.has_value()) {
-        if (const auto* record = std::get_if<Record>(&item.value())) {
+      if (const IR::Item* item = ictx_.GetImportedItem(field_record)) {
+        if (const auto* record = std::get_if<Record>(item)) {
           is_inheritable = record->is_inheritable;
         }
       }
@@ -497,8 +681,19 @@ std::vector<BaseClass> CXXRecordDeclImporter::GetUnambiguousPublicBases(
       std::optional<int64_t> offset = {0};
       for (const clang::CXXBasePathElement& base_path_element : path) {
         if (base_path_element.Base->isVirtual()) {
-          offset.reset();
-          break;
+          // The offset of a virtual base depends on the most derived class.
+          // If `record_decl` is final, it is always the most derived class, so
+          // the offset is known statically after all.
+          if (!record_decl.isEffectivelyFinal()) {
+            offset.reset();
+            break;
+          }
+          offset = ictx_.ctx_.getASTRecordLayout(&record_decl)
+                       .getVBaseClassOffset(ABSL_DIE_IF_NULL(
+                           base_path_element.Base->getType()
+                               ->getAsCXXRecordDecl()))
+                       .getQuantity();
+          continue;
         }
         *offset +=
             {ictx_.ctx_.getASTRecordLayout(base_path_element.Class)
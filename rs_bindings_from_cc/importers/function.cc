@@ -4,6 +4,8 @@
 
 #include "rs_bindings_from_cc/importers/function.h"
 
+#include <algorithm>
+#include <cstdint>
 #include <memory>
 #include <optional>
 #include <set>
@@ -15,20 +17,35 @@
 #include "absl/status/statusor.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/substitute.h"
+#include "common/status_macros.h"
 #include "lifetime_annotations/lifetime.h"
 #include "lifetime_annotations/lifetime_annotations.h"
 #include "lifetime_annotations/lifetime_error.h"
+#include "lifetime_annotations/lifetime_summaries.h"
 #include "lifetime_annotations/lifetime_symbol_table.h"
 #include "lifetime_annotations/type_lifetimes.h"
+#include "nullability/inference/inference.proto.h"
+#include "nullability/inference/inference_table.h"
 #include "rs_bindings_from_cc/ast_util.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/type_map.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Attr.h"
+#include "clang/AST/DeclCXX.h"
 #include "clang/AST/DeclarationName.h"
+#include "clang/AST/Expr.h"
+#include "clang/AST/ExprCXX.h"
+#include "clang/AST/Stmt.h"
 #include "clang/AST/Type.h"
 #include "clang/Basic/LLVM.h"
+#include "clang/Basic/OperatorKinds.h"
 #include "clang/Basic/Specifiers.h"
+#include "clang/Index/USRGeneration.h"
 #include "clang/Sema/Sema.h"
+#include "llvm/ADT/APSInt.h"
 #include "llvm/ADT/STLExtras.h"
+#include "llvm/ADT/SmallString.h"
 #include "llvm/ADT/StringRef.h"
 #include "llvm/Support/Error.h"
 
@@ -45,6 +62,329 @@ static bool IsInStdNamespace(const clang::FunctionDecl* decl) {
   return false;
 }
 
+// How many calls `GetInlinedRead` follows from one getter of `*this` to the
+// next (e.g. from `foo()` to `_internal_foo()` in protobuf messages).
+static constexpr int kMaxInlinedReadDepth = 4;
+
+// Strips parentheses and the implicit casts that neither change the value nor
+// the object referred to by `expr`.
+static const clang::Expr* IgnoreParenNoOpCasts(const clang::Expr* expr) {
+  while (true) {
+    expr = expr->IgnoreParens();
+    const auto* cast = clang::dyn_cast<clang::ImplicitCastExpr>(expr);
+    if (cast == nullptr || (cast->getCastKind() != clang::CK_LValueToRValue &&
+                            cast->getCastKind() != clang::CK_NoOp)) {
+      return expr;
+    }
+    expr = cast->getSubExpr();
+  }
+}
+
+static bool IsBuiltinScalar(clang::QualType type) {
+  const auto* builtin = type->getAs<clang::BuiltinType>();
+  return builtin != nullptr &&
+         (builtin->isInteger() || builtin->isFloatingPoint());
+}
+
+static std::optional<uint64_t> GetConstantIndex(const clang::Expr* index,
+                                                const clang::ASTContext& ctx) {
+  std::optional<llvm::APSInt> value = index->getIntegerConstantExpr(ctx);
+  if (!value.has_value() || value->isNegative()) return std::nullopt;
+  return value->getLimitedValue();
+}
+
+static std::optional<uint64_t> GetOffsetFromThis(const clang::Expr* expr,
+                                                 const clang::ASTContext& ctx,
+                                                 int depth);
+
+// If `array` is an array subobject of `*this` that decayed to a pointer,
+// returns the offset of its element at `index` in bits.
+static std::optional<uint64_t> GetElementOffsetFromThis(
+    const clang::Expr* array, uint64_t index, const clang::ASTContext& ctx,
+    int depth) {
+  const auto* decay =
+      clang::dyn_cast<clang::ImplicitCastExpr>(array->IgnoreParens());
+  if (decay == nullptr ||
+      decay->getCastKind() != clang::CK_ArrayToPointerDecay) {
+    return std::nullopt;
+  }
+  const clang::ConstantArrayType* array_type =
+      ctx.getAsConstantArrayType(decay->getSubExpr()->getType());
+  if (array_type == nullptr ||
+      index >= array_type->getSize().getLimitedValue()) {
+    return std::nullopt;
+  }
+  std::optional<uint64_t> array_offset =
+      GetOffsetFromThis(decay->getSubExpr(), ctx, depth);
+  if (!array_offset.has_value()) return std::nullopt;
+  return *array_offset + index * ctx.getTypeSize(array_type->getElementType());
+}
+
+// If `expr` refers to a subobject of `*this` at a fixed offset, returns that
+// offset in bits. Supports (nested) data members, elements of arrays at
+// constant indices, and `operator[]`s that just return such an element of an
+// array member, like the one of protobuf's `HasBits`.
+static std::optional<uint64_t> GetOffsetFromThis(const clang::Expr* expr,
+                                                 const clang::ASTContext& ctx,
+                                                 int depth) {
+  expr = IgnoreParenNoOpCasts(expr);
+  if (clang::isa<clang::CXXThisExpr>(expr)) return 0;
+
+  if (const auto* member_expr = clang::dyn_cast<clang::MemberExpr>(expr)) {
+    const auto* field_decl =
+        clang::dyn_cast<clang::FieldDecl>(member_expr->getMemberDecl());
+    if (field_decl == nullptr || field_decl->isBitField() ||
+        field_decl->getType().isVolatileQualified() ||
+        field_decl->getParent()->isInvalidDecl()) {
+      return std::nullopt;
+    }
+    // `this->field` is the only supported access through a pointer.
+    const clang::Expr* base = member_expr->getBase();
+    if (member_expr->isArrow() &&
+        !clang::isa<clang::CXXThisExpr>(IgnoreParenNoOpCasts(base))) {
+      return std::nullopt;
+    }
+    std::optional<uint64_t> base_offset = GetOffsetFromThis(base, ctx, depth);
+    if (!base_offset.has_value()) return std::nullopt;
+    return *base_offset + ctx.getFieldOffset(field_decl);
+  }
+
+  if (const auto* subscript =
+          clang::dyn_cast<clang::ArraySubscriptExpr>(expr)) {
+    std::optional<uint64_t> index = GetConstantIndex(subscript->getIdx(), ctx);
+    if (!index.has_value()) return std::nullopt;
+    return GetElementOffsetFromThis(subscript->getBase(), *index, ctx, depth);
+  }
+
+  if (const auto* op_call = clang::dyn_cast<clang::CXXOperatorCallExpr>(expr);
+      op_call != nullptr && op_call->getOperator() == clang::OO_Subscript &&
+      op_call->getNumArgs() == 2 && depth < kMaxInlinedReadDepth) {
+    const auto* method =
+        clang::dyn_cast_or_null<clang::CXXMethodDecl>(op_call->getCalleeDecl());
+    if (method == nullptr || !method->isInlined() || method->isVirtual() ||
+        method->getNumParams() != 1) {
+      return std::nullopt;
+    }
+    const auto* body =
+        llvm::dyn_cast_or_null<clang::CompoundStmt>(method->getBody());
+    if (body == nullptr || body->size() != 1) return std::nullopt;
+    const auto* return_stmt =
+        clang::dyn_cast<clang::ReturnStmt>(body->body_front());
+    if (return_stmt == nullptr || return_stmt->getRetValue() == nullptr) {
+      return std::nullopt;
+    }
+    // The body must be `return array_[param];`.
+    const auto* subscript = clang::dyn_cast<clang::ArraySubscriptExpr>(
+        IgnoreParenNoOpCasts(return_stmt->getRetValue()));
+    if (subscript == nullptr) return std::nullopt;
+    const auto* param_ref = clang::dyn_cast<clang::DeclRefExpr>(
+        subscript->getIdx()->IgnoreParenImpCasts());
+    if (param_ref == nullptr ||
+        param_ref->getDecl() != method->getParamDecl(0)) {
+      return std::nullopt;
+    }
+    std::optional<uint64_t> index = GetConstantIndex(op_call->getArg(1), ctx);
+    if (!index.has_value()) return std::nullopt;
+    std::optional<uint64_t> object_offset =
+        GetOffsetFromThis(op_call->getArg(0), ctx, depth);
+    std::optional<uint64_t> element_offset = GetElementOffsetFromThis(
+        subscript->getBase(), *index, ctx, depth + 1);
+    if (!object_offset.has_value() || !element_offset.has_value()) {
+      return std::nullopt;
+    }
+    return *object_offset + *element_offset;
+  }
+
+  return std::nullopt;
+}
+
+// Returns whether `stmt` is a call to a free function with an empty inline
+// body and arguments without side effects, e.g. to protobuf's `TSanRead()` in
+// builds without ThreadSanitizer.
+static bool IsCallWithoutEffects(const clang::Stmt* stmt,
+                                 const clang::ASTContext& ctx) {
+  const auto* call = clang::dyn_cast<clang::CallExpr>(stmt);
+  if (call == nullptr) return false;
+  const clang::FunctionDecl* callee = call->getDirectCallee();
+  if (callee == nullptr || clang::isa<clang::CXXMethodDecl>(callee) ||
+      !callee->isInlined()) {
+    return false;
+  }
+  const auto* body =
+      llvm::dyn_cast_or_null<clang::CompoundStmt>(callee->getBody());
+  return body != nullptr && body->body_empty() &&
+         llvm::none_of(call->arguments(), [&ctx](const clang::Expr* arg) {
+           return arg->HasSideEffects(ctx);
+         });
+}
+
+static std::optional<InlinedRead> GetInlinedRead(
+    const clang::CXXMethodDecl* method, const clang::ASTContext& ctx,
+    int depth);
+
+// Returns how to read the value of `expr`, which has type `result_type`, from
+// `*this`, if it is either:
+//   * a builtin scalar subobject of `*this`,
+//   * `(word & MASK) != 0` for an unsigned integer subobject `word`,
+//   * a call to another getter of `*this` that `GetInlinedRead` supports.
+static std::optional<InlinedRead> GetInlinedReadOfExpr(
+    const clang::Expr* expr, clang::QualType result_type,
+    const clang::ASTContext& ctx, int depth) {
+  expr = IgnoreParenNoOpCasts(expr);
+
+  if (const auto* call = clang::dyn_cast<clang::CXXMemberCallExpr>(expr)) {
+    const clang::CXXMethodDecl* callee = call->getMethodDecl();
+    if (callee == nullptr || callee->isVirtual() || call->getNumArgs() != 0 ||
+        depth >= kMaxInlinedReadDepth ||
+        !clang::isa<clang::CXXThisExpr>(
+            IgnoreParenNoOpCasts(call->getImplicitObjectArgument())) ||
+        !ctx.hasSameUnqualifiedType(callee->getReturnType(), result_type)) {
+      return std::nullopt;
+    }
+    return GetInlinedRead(callee, ctx, depth + 1);
+  }
+
+  if (const auto* compare = clang::dyn_cast<clang::BinaryOperator>(expr)) {
+    if (compare->getOpcode() != clang::BO_NE ||
+        !result_type->isBooleanType()) {
+      return std::nullopt;
+    }
+    std::optional<llvm::APSInt> zero =
+        compare->getRHS()->getIntegerConstantExpr(ctx);
+    const auto* bit_and = clang::dyn_cast<clang::BinaryOperator>(
+        IgnoreParenNoOpCasts(compare->getLHS()));
+    if (!zero.has_value() || !zero->isZero() || bit_and == nullptr ||
+        bit_and->getOpcode() != clang::BO_And) {
+      return std::nullopt;
+    }
+    const clang::Expr* word = bit_and->getLHS();
+    const clang::Expr* mask_expr = bit_and->getRHS();
+    if (word->getIntegerConstantExpr(ctx).has_value()) {
+      std::swap(word, mask_expr);
+    }
+    std::optional<llvm::APSInt> mask = mask_expr->getIntegerConstantExpr(ctx);
+    word = IgnoreParenNoOpCasts(word);
+    clang::QualType word_type = word->getType();
+    if (!mask.has_value() || mask->isNegative() ||
+        !IsBuiltinScalar(word_type) || !word_type->isUnsignedIntegerType() ||
+        word_type->isBooleanType() ||
+        mask->getActiveBits() >
+            std::min<uint64_t>(64, ctx.getTypeSize(word_type))) {
+      return std::nullopt;
+    }
+    std::optional<uint64_t> offset = GetOffsetFromThis(word, ctx, depth);
+    if (!offset.has_value() || *offset % 8 != 0) return std::nullopt;
+    return InlinedRead{
+        .offset = *offset / 8,
+        .size = static_cast<uint64_t>(
+            ctx.getTypeSizeInChars(word_type).getQuantity()),
+        .bit_mask = mask->getZExtValue(),
+    };
+  }
+
+  if (!IsBuiltinScalar(result_type) ||
+      !ctx.hasSameUnqualifiedType(expr->getType(), result_type)) {
+    return std::nullopt;
+  }
+  std::optional<uint64_t> offset = GetOffsetFromThis(expr, ctx, depth);
+  if (!offset.has_value() || *offset % 8 != 0) return std::nullopt;
+  return InlinedRead{
+      .offset = *offset / 8,
+      .size = static_cast<uint64_t>(
+          ctx.getTypeSizeInChars(result_type).getQuantity()),
+  };
+}
+
+// If `method` is an inline instance method that returns a builtin scalar
+// which `GetInlinedReadOfExpr` can read from `*this`, returns how to read it.
+//
+// Besides `return expr;`, the body may also be `T value = expr; return value;`
+// and contain calls without effects, which is how protobuf generates getters.
+static std::optional<InlinedRead> GetInlinedRead(
+    const clang::CXXMethodDecl* method, const clang::ASTContext& ctx,
+    int depth) {
+  if (method == nullptr || !method->isInstance() || !method->isInlined() ||
+      method->isDependentContext() ||
+      !IsBuiltinScalar(method->getReturnType())) {
+    return std::nullopt;
+  }
+  const auto* body =
+      llvm::dyn_cast_or_null<clang::CompoundStmt>(method->getBody());
+  if (body == nullptr) return std::nullopt;
+  const clang::Expr* result = nullptr;
+  const clang::VarDecl* result_var = nullptr;
+  for (const clang::Stmt* stmt : body->body()) {
+    // Nothing may follow the `return` statement.
+    if (result != nullptr) return std::nullopt;
+    if (const auto* return_stmt = clang::dyn_cast<clang::ReturnStmt>(stmt)) {
+      result = return_stmt->getRetValue();
+      if (result == nullptr) return std::nullopt;
+      if (result_var != nullptr) {
+        const auto* var_ref =
+            clang::dyn_cast<clang::DeclRefExpr>(IgnoreParenNoOpCasts(result));
+        if (var_ref == nullptr || var_ref->getDecl() != result_var) {
+          return std::nullopt;
+        }
+        result = result_var->getInit();
+      }
+    } else if (const auto* decl_stmt = clang::dyn_cast<clang::DeclStmt>(stmt);
+               decl_stmt != nullptr && decl_stmt->isSingleDecl() &&
+               result_var == nullptr) {
+      result_var = clang::dyn_cast<clang::VarDecl>(decl_stmt->getSingleDecl());
+      if (result_var == nullptr || !result_var->hasInit() ||
+          !ctx.hasSameUnqualifiedType(result_var->getType(),
+                                      method->getReturnType())) {
+        return std::nullopt;
+      }
+    } else if (!IsCallWithoutEffects(stmt, ctx)) {
+      return std::nullopt;
+    }
+  }
+  if (result == nullptr) return std::nullopt;
+  return GetInlinedReadOfExpr(result, method->getReturnType(), ctx, depth);
+}
+
+// Converts a returned `absl::StatusOr<T>` (see `GetStatusOrTypes`) to the
+// mapped type of a Rust `Result<T, Status>`.
+static absl::StatusOr<MappedType> ConvertStatusOrReturnType(
+    ImportContext& ictx, clang::QualType return_type,
+    const StatusOrTypes& status_or) {
+  CRUBIT_ASSIGN_OR_RETURN(
+      MappedType value_type,
+      ictx.ConvertQualType(status_or.value_type, /*lifetimes=*/nullptr,
+                           /*ref_qualifier_kind=*/std::nullopt));
+  CRUBIT_ASSIGN_OR_RETURN(
+      MappedType status_type,
+      ictx.ConvertQualType(status_or.status_type, /*lifetimes=*/nullptr,
+                           /*ref_qualifier_kind=*/std::nullopt));
+  return MappedType::StatusOrOf(
+      std::move(value_type), std::move(status_type),
+      return_type.getUnqualifiedType().getCanonicalType().getAsString());
+}
+
+// Converts an `absl::FunctionRef<R(Args...)>` parameter (see
+// `GetFunctionRefSignature`) to the mapped type of a Rust closure.
+static absl::StatusOr<MappedType> ConvertFunctionRefParamType(
+    ImportContext& ictx, clang::QualType param_type,
+    const clang::FunctionProtoType& signature) {
+  CRUBIT_ASSIGN_OR_RETURN(
+      MappedType return_type,
+      ictx.ConvertQualType(signature.getReturnType(), /*lifetimes=*/nullptr,
+                           /*ref_qualifier_kind=*/std::nullopt));
+  std::vector<MappedType> param_types;
+  param_types.reserve(signature.getNumParams());
+  for (clang::QualType type : signature.getParamTypes()) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        MappedType mapped_type,
+        ictx.ConvertQualType(type, /*lifetimes=*/nullptr,
+                             /*ref_qualifier_kind=*/std::nullopt));
+    param_types.push_back(std::move(mapped_type));
+  }
+  return MappedType::FunctionRefOf(
+      std::move(return_type), std::move(param_types),
+      param_type.getUnqualifiedType().getCanonicalType().getAsString());
+}
+
 Identifier FunctionDeclImporter::GetTranslatedParamName(
     const clang::ParmVarDecl* param_decl) {
   int param_pos = param_decl->getFunctionScopeIndex();
@@ -61,6 +401,42 @@ Identifier FunctionDeclImporter::GetTranslatedParamName(
   return *name;
 }
 
+std::optional<Identifier> FunctionDeclImporter::GetReturnedFieldName(
+    const clang::FunctionDecl* function_decl) {
+  const auto* method_decl =
+      clang::dyn_cast<clang::CXXMethodDecl>(function_decl);
+  if (method_decl == nullptr || !method_decl->isInstance() ||
+      !method_decl->isInlined()) {
+    return std::nullopt;
+  }
+  const auto* body =
+      llvm::dyn_cast_or_null<clang::CompoundStmt>(method_decl->getBody());
+  if (body == nullptr || body->size() != 1) return std::nullopt;
+  const auto* return_stmt =
+      clang::dyn_cast<clang::ReturnStmt>(body->body_front());
+  if (return_stmt == nullptr || return_stmt->getRetValue() == nullptr) {
+    return std::nullopt;
+  }
+  const auto* member_expr = clang::dyn_cast<clang::MemberExpr>(
+      return_stmt->getRetValue()->IgnoreParenImpCasts());
+  if (member_expr == nullptr ||
+      !clang::isa<clang::CXXThisExpr>(
+          member_expr->getBase()->IgnoreParenImpCasts())) {
+    return std::nullopt;
+  }
+  const auto* field_decl =
+      clang::dyn_cast<clang::FieldDecl>(member_expr->getMemberDecl());
+  if (field_decl == nullptr ||
+      field_decl->getParent() != method_decl->getParent() ||
+      field_decl->isBitField() || field_decl->getName().empty() ||
+      field_decl->getType().isVolatileQualified()) {
+    return std::nullopt;
+  }
+  absl::StatusOr<Identifier> name = ictx_.GetTranslatedIdentifier(field_decl);
+  if (!name.ok()) return std::nullopt;
+  return *std::move(name);
+}
+
 std::optional<IR::Item> FunctionDeclImporter::Import(
     clang::FunctionDecl* function_decl) {
   if (!ictx_.IsFromCurrentTarget(function_decl)) return std::nullopt;
@@ -137,6 +513,27 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
     }
   }
 
+  // Without (elidable) annotations, fall back to lifetimes that
+  // lifetime_analysis inferred for the function ahead of time, if any.
+  const auto& lifetime_summaries =
+      ictx_.invocation_.lifetime_context_->summaries;
+  if (!lifetimes.has_value() && lifetime_summaries != nullptr) {
+    if (std::optional<llvm::StringRef> summary =
+            lifetime_summaries->Find(function_decl)) {
+      lifetime_symbol_table = clang::tidy::lifetimes::LifetimeSymbolTable();
+      llvm::Expected<clang::tidy::lifetimes::FunctionLifetimes> inferred =
+          clang::tidy::lifetimes::ParseFunctionLifetimesSummary(
+              function_decl, *summary, &lifetime_symbol_table);
+      if (inferred) {
+        lifetimes = std::move(*inferred);
+      } else {
+        // A summary that doesn't match the declaration, e.g. because it was
+        // computed for a different version of the header, is ignored.
+        llvm::consumeError(inferred.takeError());
+      }
+    }
+  }
+
   absl::StatusOr<UnqualifiedIdentifier> translated_name =
       ictx_.GetTranslatedName(function_decl);
   if (!translated_name.ok()) {
@@ -182,14 +579,35 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
     CHECK(lifetimes->IsValidForDecl(function_decl));
   }
 
+  // Pointers which nullability inference concluded are non-null are bound as
+  // references, rather than as `Option`s of references.
+  const clang::tidy::nullability::InferenceTable* inferences =
+      ictx_.invocation_.nullability_inferences_;
+  llvm::SmallString<128> usr;
+  if (inferences && clang::index::generateUSRForDecl(function_decl, usr)) {
+    inferences = nullptr;
+  }
+  auto is_nullable = [&](unsigned slot) {
+    return inferences == nullptr ||
+           inferences->lookup(usr, slot) != clang::NullabilityKind::NonNull;
+  };
+
   for (unsigned i = 0; i < function_decl->getNumParams(); ++i) {
     const clang::ParmVarDecl* param = function_decl->getParamDecl(i);
     const clang::tidy::lifetimes::ValueLifetimes* param_lifetimes = nullptr;
     if (lifetimes) {
       param_lifetimes = &lifetimes->GetParamLifetimes(i);
     }
-    auto param_type =
-        ictx_.ConvertQualType(param->getType(), param_lifetimes, std::nullopt);
+    absl::StatusOr<MappedType> param_type;
+    if (const clang::FunctionProtoType* signature =
+            GetFunctionRefSignature(*param->getType())) {
+      param_type =
+          ConvertFunctionRefParamType(ictx_, param->getType(), *signature);
+    } else {
+      param_type = ictx_.ConvertQualType(
+          param->getType(), param_lifetimes, std::nullopt,
+          is_nullable(clang::tidy::nullability::SLOT_PARAM + i));
+    }
     if (!param_type.ok()) {
       add_error(absl::Substitute("Parameter #$0 is not supported: $1", i,
                                  param_type.status().message()));
@@ -214,8 +632,17 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
     return_lifetimes = &lifetimes->GetReturnLifetimes();
   }
 
-  auto return_type = ictx_.ConvertQualType(function_decl->getReturnType(),
-                                           return_lifetimes, std::nullopt);
+  absl::StatusOr<MappedType> return_type;
+  if (std::optional<StatusOrTypes> status_or = GetStatusOrTypes(
+          *function_decl->getReturnType(), ictx_.sema_);
+      status_or.has_value()) {
+    return_type = ConvertStatusOrReturnType(
+        ictx_, function_decl->getReturnType(), *status_or);
+  } else {
+    return_type = ictx_.ConvertQualType(
+        function_decl->getReturnType(), return_lifetimes, std::nullopt,
+        is_nullable(clang::tidy::nullability::SLOT_RETURN_TYPE));
+  }
   if (!return_type.ok()) {
     add_error(absl::StrCat("Return type is not supported: ",
                            return_type.status().message()));
@@ -260,6 +687,9 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
           .reference = reference,
           .is_const = method_decl->isConst(),
           .is_virtual = method_decl->isVirtual(),
+          .is_final = method_decl->isVirtual() && !method_decl->isPure() &&
+                      (method_decl->hasAttr<clang::FinalAttr>() ||
+                       method_decl->getParent()->isEffectivelyFinal()),
       };
     }
 
@@ -277,6 +707,13 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
       clang::CC_C;
   bool is_member_or_descendant_of_class_template =
       IsFullClassTemplateSpecializationOrChild(function_decl);
+  // Only an exception specification written in the source is recorded: Clang
+  // computes the ones of implicit special member functions only on demand.
+  const auto* proto_type =
+      function_decl->getType()->getAs<clang::FunctionProtoType>();
+  bool is_noexcept = proto_type != nullptr &&
+                     function_decl->getExceptionSpecSourceRange().isValid() &&
+                     proto_type->isNothrow();
 
   std::optional<std::string> doc_comment = ictx_.GetComment(function_decl);
   if (!doc_comment.has_value() && is_member_or_descendant_of_class_template) {
@@ -314,8 +751,13 @@ std::optional<IR::Item> FunctionDeclImporter::Import(
       .is_inline = function_decl->isInlined(),
       .member_func_metadata = std::move(member_func_metadata),
       .has_c_calling_convention = has_c_calling_convention,
+      .is_noexcept = is_noexcept,
       .is_member_or_descendant_of_class_template =
           is_member_or_descendant_of_class_template,
+      .returned_field = GetReturnedFieldName(function_decl),
+      .inlined_read =
+          GetInlinedRead(clang::dyn_cast<clang::CXXMethodDecl>(function_decl),
+                         function_decl->getASTContext(), /*depth=*/0),
       .source_loc = ictx_.ConvertSourceLocation(function_decl->getBeginLoc()),
       .id = GenerateItemId(function_decl),
       .enclosing_namespace_id = GetEnclosingNamespaceId(function_decl),
@@ -22,6 +22,12 @@ class FunctionDeclImporter : public DeclImporterBase<clang::FunctionDecl> {
 
  private:
   Identifier GetTranslatedParamName(const clang::ParmVarDecl* param_decl);
+
+  // If `function_decl` is an inline instance method whose body is just
+  // `return field;` for a data member `field` of its own class, returns the
+  // translated name of that field.
+  std::optional<Identifier> GetReturnedFieldName(
+      const clang::FunctionDecl* function_decl);
 };
 
 }  // namespace crubit
@@ -0,0 +1,165 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/importers/var.h"
+
+#include <optional>
+#include <string>
+
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "lifetime_annotations/type_lifetimes.h"
+#include "rs_bindings_from_cc/ast_util.h"
+#include "rs_bindings_from_cc/ir.h"
+#include "clang/AST/APValue.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/Type.h"
+#include "clang/Basic/LLVM.h"
+
+namespace crubit {
+
+std::optional<IR::Item> VarDeclImporter::Import(clang::VarDecl* var_decl) {
+  if (clang::isa<clang::ParmVarDecl>(var_decl) ||
+      clang::isa<clang::VarTemplateSpecializationDecl>(var_decl) ||
+      var_decl->getDescribedVarTemplate() != nullptr ||
+      var_decl->getDeclContext()->isFunctionOrMethod() ||
+      var_decl->getDeclContext()->isDependentContext()) {
+    return std::nullopt;
+  }
+  // The initializers of the static data members of class template
+  // specializations are only instantiated when they are used.
+  if (IsFullClassTemplateSpecializationOrChild(var_decl)) return std::nullopt;
+
+  // The value of constants is known here, so Rust code can use it without
+  // reading the variable.
+  const clang::VarDecl* initializing_decl =
+      var_decl->getInitializingDeclaration();
+  if (initializing_decl != nullptr &&
+      initializing_decl->isUsableInConstantExpressions(
+          var_decl->getASTContext())) {
+    return ImportConstant(var_decl, *initializing_decl);
+  }
+  if (var_decl->getDeclContext()->getRedeclContext()->isFileContext()) {
+    return ImportGlobalVar(var_decl);
+  }
+  return std::nullopt;
+}
+
+std::optional<IR::Item> VarDeclImporter::ImportConstant(
+    clang::VarDecl* var_decl, const clang::VarDecl& initializing_decl) {
+  std::optional<ItemId> enclosing_record_id = std::nullopt;
+  if (auto* record_decl =
+          clang::dyn_cast<clang::RecordDecl>(var_decl->getDeclContext())) {
+    if (!ictx_.EnsureSuccessfullyImported(record_decl)) {
+      return ictx_.ImportUnsupportedItem(var_decl,
+                                         "Couldn't import the parent");
+    }
+    enclosing_record_id = GenerateItemId(record_decl);
+  }
+
+  absl::StatusOr<Identifier> identifier =
+      ictx_.GetTranslatedIdentifier(var_decl);
+  if (!identifier.ok()) {
+    return ictx_.ImportUnsupportedItem(
+        var_decl, absl::StrCat("Constant name is not supported: ",
+                               identifier.status().message()));
+  }
+
+  clang::QualType type = var_decl->getType().getUnqualifiedType();
+  if (!type->isIntegerType() || type->isEnumeralType()) {
+    return ictx_.ImportUnsupportedItem(
+        var_decl, "Only constants of integer types and `bool` are supported");
+  }
+  const clang::APValue* value = initializing_decl.evaluateValue();
+  if (value == nullptr || !value->isInt() ||
+      value->getInt().getSignificantBits() > 64) {
+    return ictx_.ImportUnsupportedItem(
+        var_decl, "The value of the constant couldn't be evaluated");
+  }
+
+  clang::tidy::lifetimes::ValueLifetimes* no_lifetimes = nullptr;
+  absl::StatusOr<MappedType> mapped_type =
+      ictx_.ConvertQualType(type, no_lifetimes, std::nullopt);
+  if (!mapped_type.ok()) {
+    return ictx_.ImportUnsupportedItem(
+        var_decl, std::string(mapped_type.status().message()));
+  }
+
+  ictx_.MarkAsSuccessfullyImported(var_decl);
+  return Constant{
+      .identifier = *identifier,
+      .id = GenerateItemId(var_decl),
+      .owning_target = ictx_.GetOwningTarget(var_decl),
+      .doc_comment = ictx_.GetComment(var_decl),
+      .source_loc = ictx_.ConvertSourceLocation(var_decl->getBeginLoc()),
+      .type = *mapped_type,
+      .value = IntegerConstant(value->getInt()),
+      .enclosing_record_id = enclosing_record_id,
+      .enclosing_namespace_id = GetEnclosingNamespaceId(var_decl),
+  };
+}
+
+std::optional<IR::Item> VarDeclImporter::ImportGlobalVar(
+    clang::VarDecl* var_decl) {
+  // Variables with internal linkage have no symbol to refer to.
+  if (!var_decl->hasExternalFormalLinkage()) return std::nullopt;
+  if (var_decl->getTLSKind() != clang::VarDecl::TLS_None) {
+    return ictx_.ImportUnsupportedItem(
+        var_decl, "Thread-local variables are not supported");
+  }
+  // An inline variable is only emitted by the translation units that use it,
+  // so Rust code can't refer to its symbol.
+  if (var_decl->isInline()) {
+    return ictx_.ImportUnsupportedItem(var_decl,
+                                       "Inline variables are not supported");
+  }
+
+  absl::StatusOr<Identifier> identifier =
+      ictx_.GetTranslatedIdentifier(var_decl);
+  if (!identifier.ok()) {
+    return ictx_.ImportUnsupportedItem(
+        var_decl, absl::StrCat("Variable name is not supported: ",
+                               identifier.status().message()));
+  }
+
+  clang::QualType type = var_decl->getType();
+  if (type->isReferenceType()) {
+    return ictx_.ImportUnsupportedItem(var_decl,
+                                       "Reference variables are not supported");
+  }
+  if (type->isIncompleteType()) {
+    return ictx_.ImportUnsupportedItem(
+        var_decl, "Variables of incomplete types are not supported");
+  }
+  clang::tidy::lifetimes::ValueLifetimes* no_lifetimes = nullptr;
+  absl::StatusOr<MappedType> mapped_type =
+      ictx_.ConvertQualType(type, no_lifetimes, std::nullopt);
+  if (!mapped_type.ok()) {
+    return ictx_.ImportUnsupportedItem(
+        var_decl, std::string(mapped_type.status().message()));
+  }
+
+  const clang::ASTContext& ast_context = var_decl->getASTContext();
+  ictx_.MarkAsSuccessfullyImported(var_decl);
+  return GlobalVar{
+      .identifier = *identifier,
+      .id = GenerateItemId(var_decl),
+      .owning_target = ictx_.GetOwningTarget(var_decl),
+      .doc_comment = ictx_.GetComment(var_decl),
+      .source_loc = ictx_.ConvertSourceLocation(var_decl->getBeginLoc()),
+      .mangled_name = ictx_.GetMangledName(var_decl),
+      .type = *mapped_type,
+      .size_align =
+          {
+              .size = ast_context.getTypeSizeInChars(type).getQuantity(),
+              .alignment = ast_context.getTypeAlignInChars(type).getQuantity(),
+          },
+      .enclosing_namespace_id = GetEnclosingNamespaceId(var_decl),
+  };
+}
+
+}  // namespace crubit
@@ -0,0 +1,34 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_IMPORTERS_VAR_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_IMPORTERS_VAR_H_
+
+#include <optional>
+
+#include "rs_bindings_from_cc/decl_importer.h"
+#include "rs_bindings_from_cc/ir.h"
+#include "clang/AST/Decl.h"
+
+namespace crubit {
+
+// A `DeclImporter` for `VarDecl`s of constants (e.g. `constexpr int kSize = 8`
+// or `static constexpr int kSize = 8` in a class), which are imported as
+// Rust `const`s, and of other variables at namespace scope, which are imported
+// as Rust `extern` statics. Other variables are not imported.
+class VarDeclImporter : public DeclImporterBase<clang::VarDecl> {
+ public:
+  explicit VarDeclImporter(ImportContext& context)
+      : DeclImporterBase(context) {}
+  std::optional<IR::Item> Import(clang::VarDecl* var_decl) override;
+
+ private:
+  std::optional<IR::Item> ImportConstant(
+      clang::VarDecl* var_decl, const clang::VarDecl& initializing_decl);
+  std::optional<IR::Item> ImportGlobalVar(clang::VarDecl* var_decl);
+};
+
+}  // namespace crubit
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_IMPORTERS_VAR_H_
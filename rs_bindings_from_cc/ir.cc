@@ -4,23 +4,100 @@
 
 #include "rs_bindings_from_cc/ir.h"
 
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/container/flat_hash_map.h"
 #include "absl/log/check.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "common/string_type.h"
 #include "common/strong_int.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/RawCommentList.h"
 #include "clang/AST/Type.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Index/USRGeneration.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringRef.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+#include "llvm/Support/xxhash.h"
 
 namespace crubit {
 
+namespace {
+
+// Returns the `ItemId` for `key`.
+//
+// Unlike `absl::Hash`, `llvm::xxHash64` isn't seeded per process, so the ID
+// is the same across runs. It is truncated to 63 bits, because the IR
+// serializes IDs as signed JSON integers.
+ItemId ItemIdFromKey(llvm::StringRef key) {
+  return ItemId(llvm::xxHash64(key) & std::numeric_limits<int64_t>::max());
+}
+
+// Appends a spelling of `loc` to `key` which, unlike the raw encoding of `loc`,
+// doesn't depend on the other files parsed before it.
+void AppendLocation(const clang::SourceManager& source_manager,
+                    clang::SourceLocation loc,
+                    llvm::SmallVectorImpl<char>& key) {
+  if (loc.isInvalid()) return;
+  clang::SourceLocation expansion_loc = source_manager.getExpansionLoc(loc);
+  llvm::raw_svector_ostream os(key);
+  // Decls expanded from the same macro invocation share their expansion
+  // location, but not their spelling location.
+  os << "@" << source_manager.getFilename(expansion_loc) << ":"
+     << source_manager.getFileOffset(expansion_loc) << ":"
+     << source_manager.getFileOffset(source_manager.getSpellingLoc(loc));
+}
+
+}  // namespace
+
+ItemId GenerateItemId(const clang::Decl* decl) {
+  // Reopened namespaces are items of their own, but share their USR.
+  bool is_namespace = clang::isa<clang::NamespaceDecl>(decl);
+  if (!is_namespace) decl = decl->getCanonicalDecl();
+  // Templates share their USR with their templated decl, so the key starts
+  // with the kind of the decl.
+  llvm::SmallString<128> key(decl->getDeclKindName());
+  llvm::SmallString<128> usr;
+  // E.g. friend declarations don't have a USR.
+  bool has_usr = !clang::index::generateUSRForDecl(decl, usr);
+  if (has_usr) key += usr;
+  if (is_namespace || !has_usr) {
+    AppendLocation(decl->getASTContext().getSourceManager(),
+                   decl->getLocation(), key);
+  }
+  return ItemIdFromKey(key);
+}
+
+ItemId GenerateItemId(const clang::RawComment* comment,
+                      const clang::SourceManager& source_manager) {
+  llvm::SmallString<128> key("comment");
+  AppendLocation(source_manager, comment->getBeginLoc(), key);
+  return ItemIdFromKey(key);
+}
+
+ItemId GenerateItemId(absl::string_view key) {
+  // The prefix keeps these IDs apart from the decl ones, whose keys start with
+  // a decl kind.
+  return ItemIdFromKey(absl::StrCat("synthesized:", key));
+}
+
 template <class T>
 llvm::json::Value toJSON(const T& t) {
   return t.ToJson();
@@ -144,6 +221,77 @@ MappedType MappedType::RValueReferenceTo(MappedType pointee_type,
                               /*nullable=*/false);
 }
 
+MappedType MappedType::SpanOf(MappedType element_type, std::string cc_name) {
+  absl::string_view rs_pointer_name = element_type.cc_type.is_const
+                                          ? internal::kRustPtrConst
+                                          : internal::kRustPtrMut;
+  RsType slice{.name = std::string(internal::kRustSlice),
+               .type_args = {std::move(element_type.rs_type)}};
+  return MappedType{
+      RsType{.name = std::string(rs_pointer_name),
+             .type_args = {std::move(slice)}},
+      CcType{.name = std::move(cc_name)}};
+}
+
+MappedType MappedType::VectorOf(MappedType element_type, std::string cc_name) {
+  return MappedType{
+      RsType{.name = std::string(internal::kRustVector),
+             .type_args = {std::move(element_type.rs_type)}},
+      CcType{.name = std::move(cc_name)}};
+}
+
+MappedType MappedType::StdString(std::string cc_name) {
+  return MappedType{RsType{.name = std::string(internal::kRustString)},
+                    CcType{.name = std::move(cc_name)}};
+}
+
+MappedType MappedType::OptionalOf(MappedType value_type, std::string cc_name) {
+  return MappedType{
+      RsType{.name = std::string(internal::kRustOptional),
+             .type_args = {std::move(value_type.rs_type)}},
+      CcType{.name = std::move(cc_name)}};
+}
+
+MappedType MappedType::UniquePtrOf(MappedType element_type,
+                                   bool is_trivial_abi, std::string cc_name) {
+  absl::string_view rs_name = is_trivial_abi
+                                  ? internal::kRustTrivialAbiUniquePtr
+                                  : internal::kRustUniquePtr;
+  return MappedType{RsType{.name = std::string(rs_name),
+                           .type_args = {std::move(element_type.rs_type)}},
+                    CcType{.name = std::move(cc_name)}};
+}
+
+MappedType MappedType::StatusOrOf(MappedType value_type,
+                                  MappedType status_type,
+                                  std::string cc_name) {
+  return MappedType{
+      RsType{.name = std::string(internal::kRustStatusOr),
+             .type_args = {std::move(value_type.rs_type),
+                           std::move(status_type.rs_type)}},
+      CcType{.name = std::move(cc_name),
+             .type_args = {std::move(value_type.cc_type),
+                           std::move(status_type.cc_type)}}};
+}
+
+MappedType MappedType::FunctionRefOf(MappedType return_type,
+                                     std::vector<MappedType> param_types,
+                                     std::string cc_name) {
+  std::vector<MappedType> type_args = std::move(param_types);
+  type_args.push_back(std::move(return_type));
+
+  MappedType result{
+      RsType{.name = std::string(internal::kRustFunctionRef)},
+      CcType{.name = std::move(cc_name)}};
+  result.rs_type.type_args.reserve(type_args.size());
+  result.cc_type.type_args.reserve(type_args.size());
+  for (MappedType& type_arg : type_args) {
+    result.rs_type.type_args.push_back(std::move(type_arg.rs_type));
+    result.cc_type.type_args.push_back(std::move(type_arg.cc_type));
+  }
+  return result;
+}
+
 MappedType MappedType::FuncPtr(absl::string_view cc_call_conv,
                                absl::string_view rs_abi,
                                std::optional<LifetimeId> lifetime,
@@ -283,6 +431,7 @@ llvm::json::Value MemberFuncMetadata::InstanceMethodMetadata::ToJson() const {
       {"reference", reference_str},
       {"is_const", is_const},
       {"is_virtual", is_virtual},
+      {"is_final", is_final},
   };
 }
 
@@ -293,6 +442,14 @@ llvm::json::Value MemberFuncMetadata::ToJson() const {
   };
 }
 
+llvm::json::Value InlinedRead::ToJson() const {
+  return llvm::json::Object{
+      {"offset", offset},
+      {"size", size},
+      {"bit_mask", bit_mask},
+  };
+}
+
 llvm::json::Value TypeMapOverride::ToJson() const {
   llvm::json::Object override{
       {"rs_name", rs_name},
@@ -334,8 +491,11 @@ llvm::json::Value Func::ToJson() const {
       {"is_inline", is_inline},
       {"member_func_metadata", member_func_metadata},
       {"has_c_calling_convention", has_c_calling_convention},
+      {"is_noexcept", is_noexcept},
       {"is_member_or_descendant_of_class_template",
        is_member_or_descendant_of_class_template},
+      {"returned_field", returned_field},
+      {"inlined_read", inlined_read},
       {"source_loc", source_loc},
       {"id", id},
       {"enclosing_namespace_id", enclosing_namespace_id},
@@ -459,6 +619,11 @@ llvm::json::Value Record::ToJson() const {
       {"move_constructor", move_constructor},
       {"destructor", destructor},
       {"is_trivial_abi", is_trivial_abi},
+      {"is_trivially_relocatable", is_trivially_relocatable},
+      {"is_send", is_send},
+      {"is_sync", is_sync},
+      {"is_c_abi_compatible_by_value", is_c_abi_compatible_by_value},
+      {"is_zero_initializable", is_zero_initializable},
       {"is_inheritable", is_inheritable},
       {"is_abstract", is_abstract},
       {"record_type", RecordTypeToString(record_type)},
@@ -513,6 +678,42 @@ llvm::json::Value TypeAlias::ToJson() const {
   };
 }
 
+llvm::json::Value Constant::ToJson() const {
+  llvm::json::Object constant{
+      {"identifier", identifier},
+      {"id", id},
+      {"owning_target", owning_target},
+      {"doc_comment", doc_comment},
+      {"source_loc", source_loc},
+      {"type", type},
+      {"value", value},
+      {"enclosing_record_id", enclosing_record_id},
+      {"enclosing_namespace_id", enclosing_namespace_id},
+  };
+
+  return llvm::json::Object{
+      {"Constant", std::move(constant)},
+  };
+}
+
+llvm::json::Value GlobalVar::ToJson() const {
+  llvm::json::Object global_var{
+      {"identifier", identifier},
+      {"id", id},
+      {"owning_target", owning_target},
+      {"doc_comment", doc_comment},
+      {"source_loc", source_loc},
+      {"mangled_name", mangled_name},
+      {"type", type},
+      {"size_align", size_align.ToJson()},
+      {"enclosing_namespace_id", enclosing_namespace_id},
+  };
+
+  return llvm::json::Object{
+      {"GlobalVar", std::move(global_var)},
+  };
+}
+
 llvm::json::Value UnsupportedItem::ToJson() const {
   llvm::json::Object unsupported{
       {"name", name},
@@ -559,13 +760,33 @@ llvm::json::Value Namespace::ToJson() const {
   };
 }
 
-llvm::json::Value IR::ToJson() const {
-  std::vector<llvm::json::Value> json_items;
-  json_items.reserve(items.size());
-  for (const auto& item : items) {
-    std::visit([&](auto&& item) { json_items.push_back(item.ToJson()); }, item);
+llvm::json::Value IR::ToJson(int threads) const {
+  std::vector<llvm::json::Value> json_items(items.size(), nullptr);
+  auto convert_items = [&](size_t begin, size_t end) {
+    for (size_t i = begin; i < end; ++i) {
+      json_items[i] =
+          std::visit([](auto&& item) { return item.ToJson(); }, items[i]);
+    }
+  };
+  // Threads only pay off for IRs with many items, and each of them converts a
+  // contiguous range of items, so that `json_items` stays in the same order.
+  constexpr size_t kMinItemsPerThread = 1024;
+  size_t num_threads = std::clamp<size_t>(items.size() / kMinItemsPerThread, 1,
+                                          std::max(threads, 1));
+  if (num_threads == 1) {
+    convert_items(0, items.size());
+  } else {
+    std::vector<std::thread> workers;
+    workers.reserve(num_threads);
+    size_t items_per_thread = (items.size() + num_threads - 1) / num_threads;
+    for (size_t begin = 0; begin < items.size(); begin += items_per_thread) {
+      workers.emplace_back(convert_items, begin,
+                           std::min(begin + items_per_thread, items.size()));
+    }
+    for (std::thread& worker : workers) {
+      worker.join();
+    }
   }
-  CHECK_EQ(json_items.size(), items.size());
 
   std::vector<llvm::json::Value> top_level_ids;
   top_level_ids.reserve(top_level_item_ids.size());
@@ -575,9 +796,12 @@ llvm::json::Value IR::ToJson() const {
 
   llvm::json::Object features_json;
   for (const auto& [target, features] : crubit_features) {
+    // Sorted, so that the JSON (and everything hashing it) is deterministic.
+    std::vector<std::string> sorted_features(features.begin(), features.end());
+    std::sort(sorted_features.begin(), sorted_features.end());
     std::vector<llvm::json::Value> feature_array;
-    for (const std::string& feature : features) {
-      feature_array.push_back(feature);
+    for (std::string& feature : sorted_features) {
+      feature_array.push_back(std::move(feature));
     }
     features_json[target.value()] = std::move(feature_array);
   }
@@ -595,6 +819,176 @@ llvm::json::Value IR::ToJson() const {
   return std::move(result);
 }
 
+const IR::Item* IR::FindItem(ItemId id) const {
+  std::shared_ptr<const ItemIndex> index = GetItemIndex();
+  auto it = index->position_by_id.find(id);
+  if (it == index->position_by_id.end()) {
+    return nullptr;
+  }
+  return &items[it->second];
+}
+
+std::shared_ptr<const IR::ItemIndex> IR::ItemIndexCache::Get(
+    const std::vector<Item>& items) const {
+  absl::MutexLock lock(&mutex_);
+  if (index_ != nullptr && index_->items_data == items.data() &&
+      index_->items_size == items.size()) {
+    return index_;
+  }
+
+  auto index = std::make_shared<ItemIndex>();
+  index->items_data = items.data();
+  index->items_size = items.size();
+  index->position_by_id.reserve(items.size());
+  for (size_t position = 0; position < items.size(); ++position) {
+    const Item& item = items[position];
+    index->positions_by_variant[item.index()].push_back(position);
+    // Like a linear search would, lookups by id find the first such item.
+    std::visit(
+        [&](const auto& item) {
+          index->position_by_id.try_emplace(item.id, position);
+        },
+        item);
+  }
+  index_ = std::move(index);
+  return index_;
+}
+
+void IR::ItemIndexCache::Reset() {
+  absl::MutexLock lock(&mutex_);
+  index_ = nullptr;
+}
+
+namespace {
+
+// LINT.IfChange
+constexpr absl::string_view kBinaryIrMagic = "CRBTIR02";
+
+enum BinaryIrTag : char {
+  kBinaryIrNull = 0,
+  kBinaryIrFalse = 1,
+  kBinaryIrTrue = 2,
+  kBinaryIrInt64 = 3,
+  kBinaryIrUint64 = 4,
+  kBinaryIrDouble = 5,
+  kBinaryIrString = 6,
+  kBinaryIrArray = 7,
+  kBinaryIrObject = 8,
+};
+// LINT.ThenChange(//depot/rs_bindings_from_cc/ir_binary.rs)
+
+void AppendLittleEndian(uint64_t value, int num_bytes, std::string& out) {
+  for (int i = 0; i < num_bytes; ++i) {
+    out.push_back(static_cast<char>((value >> (8 * i)) & 0xff));
+  }
+}
+
+// Encodes a value tree, replacing each string (and object key) by its index
+// in a table of the distinct strings, so that identifiers, labels and names
+// which occur many times are only encoded once.
+class BinaryIrEncoder {
+ public:
+  void AppendValue(const llvm::json::Value& value);
+
+  // Returns the string table, followed by the values appended so far.
+  std::string Finish() &&;
+
+ private:
+  void AppendString(llvm::StringRef s);
+
+  // The strings are owned by the value tree being encoded.
+  absl::flat_hash_map<absl::string_view, uint32_t> string_indices_;
+  std::vector<absl::string_view> strings_;
+  std::string values_;
+};
+
+void BinaryIrEncoder::AppendString(llvm::StringRef s) {
+  auto [it, inserted] = string_indices_.try_emplace(
+      absl::string_view(s.data(), s.size()), strings_.size());
+  if (inserted) {
+    CHECK_LE(s.size(), UINT32_MAX);
+    CHECK_LT(strings_.size(), UINT32_MAX);
+    strings_.push_back(it->first);
+  }
+  AppendLittleEndian(it->second, 4, values_);
+}
+
+void BinaryIrEncoder::AppendValue(const llvm::json::Value& value) {
+  std::string& out = values_;
+  switch (value.kind()) {
+    case llvm::json::Value::Null:
+      out.push_back(kBinaryIrNull);
+      return;
+    case llvm::json::Value::Boolean:
+      out.push_back(*value.getAsBoolean() ? kBinaryIrTrue : kBinaryIrFalse);
+      return;
+    case llvm::json::Value::Number:
+      if (std::optional<int64_t> i = value.getAsInteger()) {
+        out.push_back(kBinaryIrInt64);
+        AppendLittleEndian(static_cast<uint64_t>(*i), 8, out);
+      } else if (std::optional<uint64_t> u = value.getAsUINT64()) {
+        out.push_back(kBinaryIrUint64);
+        AppendLittleEndian(*u, 8, out);
+      } else {
+        double d = *value.getAsNumber();
+        uint64_t bits;
+        std::memcpy(&bits, &d, sizeof(bits));
+        out.push_back(kBinaryIrDouble);
+        AppendLittleEndian(bits, 8, out);
+      }
+      return;
+    case llvm::json::Value::String:
+      out.push_back(kBinaryIrString);
+      AppendString(*value.getAsString());
+      return;
+    case llvm::json::Value::Array: {
+      const llvm::json::Array& array = *value.getAsArray();
+      CHECK_LE(array.size(), UINT32_MAX);
+      out.push_back(kBinaryIrArray);
+      AppendLittleEndian(array.size(), 4, out);
+      for (const llvm::json::Value& element : array) {
+        AppendValue(element);
+      }
+      return;
+    }
+    case llvm::json::Value::Object: {
+      const llvm::json::Object& object = *value.getAsObject();
+      CHECK_LE(object.size(), UINT32_MAX);
+      out.push_back(kBinaryIrObject);
+      AppendLittleEndian(object.size(), 4, out);
+      for (const auto& entry : object) {
+        AppendString(entry.first);
+        AppendValue(entry.second);
+      }
+      return;
+    }
+  }
+}
+
+std::string BinaryIrEncoder::Finish() && {
+  size_t strings_size = 4;
+  for (absl::string_view s : strings_) strings_size += 4 + s.size();
+  std::string result;
+  result.reserve(kBinaryIrMagic.size() + strings_size + values_.size());
+  result.append(kBinaryIrMagic);
+  AppendLittleEndian(strings_.size(), 4, result);
+  for (absl::string_view s : strings_) {
+    AppendLittleEndian(s.size(), 4, result);
+    result.append(s);
+  }
+  result.append(values_);
+  return result;
+}
+
+}  // namespace
+
+std::string IrToBinary(const IR& ir, int threads) {
+  llvm::json::Value json = ir.ToJson(threads);
+  BinaryIrEncoder encoder;
+  encoder.AppendValue(json);
+  return std::move(encoder).Finish();
+}
+
 std::string ItemToString(const IR::Item& item) {
   return std::visit(
       [&](auto&& item) { return llvm::formatv("{0}", item.ToJson()); }, item);
@@ -13,25 +13,32 @@
 
 #include <stdint.h>
 
+#include <array>
+#include <cstddef>
 #include <iomanip>
+#include <memory>
 #include <optional>
 #include <ostream>
 #include <string>
+#include <type_traits>
 #include <utility>
 #include <variant>
 #include <vector>
 
+#include "absl/base/thread_annotations.h"
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/log/check.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/synchronization/mutex.h"
 #include "common/strong_int.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "clang/AST/Decl.h"
 #include "clang/AST/DeclBase.h"
 #include "clang/AST/DeclTemplate.h"
 #include "clang/AST/RawCommentList.h"
+#include "clang/Basic/SourceManager.h"
 #include "clang/AST/Type.h"
 #include "clang/Basic/LLVM.h"
 #include "llvm/ADT/APSInt.h"
@@ -55,6 +62,31 @@ inline constexpr absl::string_view kRustRvalueRefConst =
 // Function pointers.
 inline constexpr absl::string_view kRustFuncPtr = "#funcPtr";
 
+// Slices (`[T]`), only used as the pointee of a pointer.
+inline constexpr absl::string_view kRustSlice = "#slice";
+
+// C++ `std::vector<T>`, mapped to `cc_std::Vector<T>`.
+inline constexpr absl::string_view kRustVector = "#vector";
+
+// C++ `std::string`, mapped to `cc_std::String`.
+inline constexpr absl::string_view kRustString = "#string";
+
+// C++ `std::optional<T>`, mapped to `cc_std::Optional<T>`.
+inline constexpr absl::string_view kRustOptional = "#optional";
+
+// C++ `std::unique_ptr<T>`, mapped to `cc_std::CcBox<T>`. The second spelling
+// is used when `std::unique_ptr<T>` is `[[clang::trivial_abi]]`, and so is
+// passed in a register, like a pointer.
+inline constexpr absl::string_view kRustUniquePtr = "#uniquePtr";
+inline constexpr absl::string_view kRustTrivialAbiUniquePtr =
+    "#uniquePtr trivial_abi";
+
+// A C++ `absl::StatusOr<T>` return value, mapped to `Result<T, Status>`.
+inline constexpr absl::string_view kRustStatusOr = "#statusOr";
+
+// A C++ `absl::FunctionRef<R(Args...)>` parameter, mapped to a Rust closure.
+inline constexpr absl::string_view kRustFunctionRef = "#functionRef";
+
 // C++ types therein.
 inline constexpr absl::string_view kCcPtr = "*";
 inline constexpr absl::string_view kCcLValueRef = "&";
@@ -99,16 +131,21 @@ inline std::ostream& operator<<(std::ostream& o, const HeaderName& h) {
 //  We use ItemIds for this.
 CRUBIT_DEFINE_STRONG_INT_TYPE(ItemId, uintptr_t);
 
-inline ItemId GenerateItemId(const clang::Decl* decl) {
-  if (auto namespace_decl = clang::dyn_cast<clang::NamespaceDecl>(decl)) {
-    return ItemId(reinterpret_cast<uintptr_t>(namespace_decl));
-  }
-  return ItemId(reinterpret_cast<uintptr_t>(decl->getCanonicalDecl()));
-}
+// Returns the ID of the item for `decl`, which is the same for all its
+// redeclarations, except for reopened namespaces.
+//
+// IDs are hashes of the decl's USR (or, for decls without a USR and for
+// namespaces, of its location), so they are the same across runs, and don't
+// depend on which other headers are parsed.
+ItemId GenerateItemId(const clang::Decl* decl);
 
-inline ItemId GenerateItemId(const clang::RawComment* comment) {
-  return ItemId(reinterpret_cast<uintptr_t>(comment));
-}
+// Returns the ID of the item for `comment`, a hash of its location.
+ItemId GenerateItemId(const clang::RawComment* comment,
+                      const clang::SourceManager& source_manager);
+
+// Returns the ID of an item that doesn't come from the AST (e.g. a `UseMod`),
+// a hash of `key`, which must be unique among such items.
+ItemId GenerateItemId(absl::string_view key);
 
 // Returns the ID of the parent namespace, if such exists, and `std::nullopt`
 // for top level decls. We use this function to assign a parent namespace to all
@@ -160,6 +197,11 @@ struct CcType {
   // - "#funcValue <callConv>" (compare with "#funcPtr <abi>" in RsType::name
   //   and note that Rust only supports function pointers; note that <callConv>
   //   in CcType doesn't map 1:1 to <abi> in RsType).
+  // - "absl::StatusOr<T>", for return values (`T` stored in `type_args[0]`,
+  //   `absl::Status` in `type_args[1]`; see `MappedType::StatusOrOf`)
+  // - "absl::FunctionRef<R(Args...)>", for parameters (`Args...` stored in
+  //   `type_args[0...n-1]`, `R` in `type_args[n]`; see
+  //   `MappedType::FunctionRefOf`)
   // - An empty string when `decl_id` is non-empty.
   std::string name;
 
@@ -198,6 +240,21 @@ struct RsType {
   //   `type_args`; param types are stored in other `type_args`; <abi> would be
   //   replaced with "cdecl", "stdcall" or other Abi - see
   //   https://doc.rust-lang.org/reference/types/function-pointer.html);
+  // - "#slice" (the slice `[T]` pointed to by a raw slice pointer; element type
+  //   stored in `type_args[0]`)
+  // - "#vector" (`cc_std::Vector<T>`, the Rust type of `std::vector<T>`;
+  //   element type stored in `type_args[0]`)
+  // - "#string" (`cc_std::String`, the Rust type of `std::string`)
+  // - "#optional" (`cc_std::Optional<T>`, the Rust type of `std::optional<T>`;
+  //   value type stored in `type_args[0]`)
+  // - "#uniquePtr" and "#uniquePtr trivial_abi" (`cc_std::CcBox<T>`, the Rust
+  //   type of `std::unique_ptr<T>`; element type stored in `type_args[0]`)
+  // - "#statusOr" (`Result<T, Status>`, the Rust type of a returned
+  //   `absl::StatusOr<T>`; `T` stored in `type_args[0]`, `absl::Status` in
+  //   `type_args[1]`)
+  // - "#functionRef" (`impl FnMut(Args...) -> R`, the Rust type of an
+  //   `absl::FunctionRef<R(Args...)>` parameter; `Args...` stored in
+  //   `type_args[0...n-1]`, `R` in `type_args[n]`)
   // - An empty string when `decl_id` is non-empty.
   std::string name;
 
@@ -262,6 +319,47 @@ struct MappedType {
   static MappedType RValueReferenceTo(MappedType pointee_type,
                                       LifetimeId lifetime);
 
+  // Creates the mapped type of a C++ span or string view (`cc_name`, e.g.
+  // `absl::Span<const int>`) of `element_type`. Spans are passed to and from
+  // Rust as raw slice pointers (e.g. `*const [i32]`), without a copy.
+  static MappedType SpanOf(MappedType element_type, std::string cc_name);
+
+  // Creates the mapped type of a C++ `std::vector` (`cc_name`) of
+  // `element_type`. Vectors are mapped to `cc_std::Vector<T>`, which exposes
+  // the elements as a Rust slice without a copy.
+  static MappedType VectorOf(MappedType element_type, std::string cc_name);
+
+  // Creates the mapped type of a C++ `std::string` (`cc_name`), which is
+  // mapped to `cc_std::String`.
+  static MappedType StdString(std::string cc_name);
+
+  // Creates the mapped type of a C++ `std::optional` (`cc_name`) of
+  // `value_type`. `optional`s are mapped to `cc_std::Optional<T>`, which has
+  // the same layout, and tests for and reads the value without a thunk.
+  static MappedType OptionalOf(MappedType value_type, std::string cc_name);
+
+  // Creates the mapped type of a C++ `std::unique_ptr` (`cc_name`) of
+  // `element_type`. `unique_ptr`s are mapped to `cc_std::CcBox<T>`, an owning
+  // pointer that dereferences to `T` without a thunk. `is_trivial_abi` tells
+  // whether the `unique_ptr` can be passed to and from thunks by value.
+  static MappedType UniquePtrOf(MappedType element_type, bool is_trivial_abi,
+                                std::string cc_name);
+
+  // Creates the mapped type of a returned C++ `absl::StatusOr<T>` (`cc_name`),
+  // which is mapped to `Result<T, Status>`. The C++ types of `value_type` and
+  // `status_type` are kept as the type arguments of the C++ type, so that the
+  // thunk can move them out of the `StatusOr`.
+  static MappedType StatusOrOf(MappedType value_type, MappedType status_type,
+                               std::string cc_name);
+
+  // Creates the mapped type of a C++ `absl::FunctionRef<R(Args...)>`
+  // parameter (`cc_name`), which is mapped to a Rust closure. The C++ types of
+  // `param_types` and `return_type` are kept as the type arguments of the C++
+  // type, so that the thunk can spell the function that calls the closure.
+  static MappedType FunctionRefOf(MappedType return_type,
+                                  std::vector<MappedType> param_types,
+                                  std::string cc_name);
+
   static MappedType FuncPtr(absl::string_view cc_call_conv,
                             absl::string_view rs_abi,
                             std::optional<LifetimeId> lifetime,
@@ -415,6 +513,9 @@ struct MemberFuncMetadata {
     ReferenceQualification reference = kUnqualified;
     bool is_const = false;
     bool is_virtual = false;
+    // Whether calls to this virtual method always reach this definition,
+    // because the method or its class is `final`.
+    bool is_final = false;
   };
 
   llvm::json::Value ToJson() const;
@@ -428,6 +529,19 @@ struct MemberFuncMetadata {
   std::optional<InstanceMethodMetadata> instance_method_metadata;
 };
 
+// A read of a builtin scalar that is stored at a fixed offset in `*this`.
+struct InlinedRead {
+  llvm::json::Value ToJson() const;
+
+  // The offset of the value from the start of `*this`, in bytes.
+  uint64_t offset;
+  // The size of the value, in bytes.
+  uint64_t size;
+  // If present, the value read is an unsigned integer word, and the result
+  // is whether any of these bits are set in it.
+  std::optional<uint64_t> bit_mask;
+};
+
 // A function involved in the bindings.
 struct Func {
   llvm::json::Value ToJson() const;
@@ -443,7 +557,15 @@ struct Func {
   // If null, this is not a member function.
   std::optional<MemberFuncMetadata> member_func_metadata;
   bool has_c_calling_convention = true;
+  // True if the function is declared `noexcept` (or `throw()`).
+  bool is_noexcept = false;
   bool is_member_or_descendant_of_class_template = false;
+  // If present, this is an inline instance method whose body only returns
+  // this field of `*this`.
+  std::optional<Identifier> returned_field;
+  // If present, this is an inline instance method whose result can be read
+  // directly from `*this`, e.g. a protobuf field or has-bit getter.
+  std::optional<InlinedRead> inlined_read;
   std::string source_loc;
   ItemId id;
   std::optional<ItemId> enclosing_namespace_id;
@@ -504,6 +626,8 @@ inline std::ostream& operator<<(std::ostream& o, const Field& f) {
 // it is kNontrivialMembers, we can directly implement it in Rust in terms of
 // the member variables.
 enum class SpecialMemberFunc : char {
+  // Trivial, or defaulted out of line where it would otherwise be trivial (so
+  // that it can be implemented as a `memcpy`, or as a no-op for destructors).
   kTrivial,
   // Nontrivial, but only because of a member variable with a nontrivial
   // special member function.
@@ -528,7 +652,7 @@ struct BaseClass {
 
   // The offset the base class subobject is located at. This is always nonempty
   // for nonvirtual inheritance, and always empty if a virtual base class is
-  // anywhere in the inheritance chain.
+  // anywhere in the inheritance chain, unless the derived class is final.
   std::optional<int64_t> offset;
 };
 
@@ -603,6 +727,49 @@ struct Record {
   //  * https://clang.llvm.org/docs/AttributeReference.html#trivial-abi
   bool is_trivial_abi = false;
 
+  // Whether this type can be moved by `memcpy`, followed by forgetting the
+  // source object (without running its destructor). See docs/unpin.md.
+  //
+  // This is true if, either:
+  //
+  //  * the type is trivial for calls (`is_trivial_abi`),
+  //  * the type would be trivial for calls, except that some of its special
+  //    member functions are defaulted out of line (see
+  //    `SpecialMemberFunc::kTrivial`), or
+  //  * the type is annotated with `CRUBIT_INTERNAL_TRIVIALLY_RELOCATABLE`.
+  //
+  // Values of such types can be moved around in Rust, but are still passed to
+  // C++ functions indirectly unless `is_trivial_abi`.
+  bool is_trivially_relocatable = false;
+
+  // Whether the Rust bindings of this type implement `Send` and `Sync`.
+  //
+  // C++ types don't tell whether they are thread-safe, so this is only true for
+  // types annotated with `CRUBIT_INTERNAL_THREAD_SAFE` or
+  // `CRUBIT_INTERNAL_THREAD_COMPATIBLE` (which both give `Send` and `Sync`, see
+  // `support/internal/attribute_macros.h`). Otherwise, the bindings
+  // implement `Send` and `Sync` only if Rust infers them from the fields.
+  bool is_send = false;
+  bool is_sync = false;
+
+  // Whether this type is passed by value exactly like a C struct with the same
+  // fields would be, so that `extern "C"` functions can take and return it by
+  // value.
+  //
+  // This is currently only computed for `[[clang::trivial_abi]]` records whose
+  // fields are all scalars with their natural layout.
+  bool is_c_abi_compatible_by_value = false;
+
+  // Whether the default constructor, if there is a usable one, leaves the
+  // object in the same state as filling it with zero bytes, which are a valid
+  // value of the Rust bindings of all of its fields.
+  //
+  // This is the case if the default constructor is trivial, or defaulted with
+  // only zero (or null) default member initializers, and all bases and fields
+  // are scalars, pointers to data or such records themselves. The bindings then
+  // implement `Default` by zeroing the memory, without calling a C++ thunk.
+  bool is_zero_initializable = false;
+
   // Whether this type can be inherited from.
   //
   // A type might not be inheritable if:
@@ -688,6 +855,48 @@ inline std::ostream& operator<<(std::ostream& o, const TypeAlias& t) {
   return o << std::string(llvm::formatv("{0:2}", t.ToJson()));
 }
 
+// A variable whose value is a compile-time integer constant (e.g.
+// `constexpr int kSize = 8`, or a `static constexpr` data member), which is
+// imported as a Rust `const`.
+struct Constant {
+  llvm::json::Value ToJson() const;
+
+  Identifier identifier;
+  ItemId id;
+  BazelLabel owning_target;
+  std::optional<std::string> doc_comment;
+  std::string source_loc;
+  MappedType type;
+  IntegerConstant value;
+  std::optional<ItemId> enclosing_record_id;
+  std::optional<ItemId> enclosing_namespace_id;
+};
+
+inline std::ostream& operator<<(std::ostream& o, const Constant& c) {
+  return o << std::string(llvm::formatv("{0:2}", c.ToJson()));
+}
+
+// A variable at namespace scope that isn't a constant, which Rust code reads
+// and writes through an `extern` static.
+struct GlobalVar {
+  llvm::json::Value ToJson() const;
+
+  Identifier identifier;
+  ItemId id;
+  BazelLabel owning_target;
+  std::optional<std::string> doc_comment;
+  std::string source_loc;
+  std::string mangled_name;
+  MappedType type;
+  // The size and alignment of `type`.
+  SizeAlign size_align;
+  std::optional<ItemId> enclosing_namespace_id;
+};
+
+inline std::ostream& operator<<(std::ostream& o, const GlobalVar& v) {
+  return o << std::string(llvm::formatv("{0:2}", v.ToJson()));
+}
+
 // A placeholder for an item that we can't generate bindings for (yet)
 struct UnsupportedItem {
   llvm::json::Value ToJson() const;
@@ -773,22 +982,59 @@ inline std::ostream& operator<<(std::ostream& o,
   return o << std::string(llvm::formatv("{0:2}", type_mapped.ToJson()));
 }
 
+// `VariantIndex<T, std::variant<...>>::value` is the index of the alternative
+// `T` in the variant.
+template <typename T, typename Variant>
+struct VariantIndex;
+template <typename T, typename... Ts>
+struct VariantIndex<T, std::variant<T, Ts...>>
+    : std::integral_constant<size_t, 0> {};
+template <typename T, typename U, typename... Ts>
+struct VariantIndex<T, std::variant<U, Ts...>>
+    : std::integral_constant<
+          size_t, 1 + VariantIndex<T, std::variant<Ts...>>::value> {};
+
 // A complete intermediate representation of bindings for publicly accessible
 // declarations of a single C++ library.
 struct IR {
-  llvm::json::Value ToJson() const;
+  // Converts the IR to JSON. The items are converted on up to `threads`
+  // threads, as they don't depend on each other.
+  llvm::json::Value ToJson(int threads = 1) const;
+
+  using Item = std::variant<Func, Record, IncompleteRecord, Enum, TypeAlias,
+                            UnsupportedItem, Comment, Namespace, UseMod,
+                            TypeMapOverride, Constant, GlobalVar>;
 
+  // Returns all items of type `T`, in the order of `items`.
   template <typename T>
   std::vector<const T*> get_items_if() const {
+    std::shared_ptr<const ItemIndex> index = GetItemIndex();
+    const std::vector<size_t>& positions =
+        index->positions_by_variant[VariantIndex<T, Item>::value];
     std::vector<const T*> filtered_items;
-    for (const auto& item : items) {
-      if (auto* filtered_item = std::get_if<T>(&item)) {
-        filtered_items.push_back(filtered_item);
-      }
+    filtered_items.reserve(positions.size());
+    for (size_t position : positions) {
+      filtered_items.push_back(&std::get<T>(items[position]));
     }
     return filtered_items;
   }
 
+  // Returns the item with the given `id`, or nullptr if there is none.
+  const Item* FindItem(ItemId id) const;
+
+  // Returns the item with the given `id`, or nullptr if there is none or if it
+  // is not a `T`.
+  template <typename T>
+  const T* FindItem(ItemId id) const {
+    const Item* item = FindItem(id);
+    return item == nullptr ? nullptr : std::get_if<T>(item);
+  }
+
+  // Drops the index used by `get_items_if` and `FindItem`. The index is
+  // rebuilt automatically after `items` is resized or reallocated, so this is
+  // only needed after an element of `items` is replaced in place.
+  void InvalidateItemIndex() { item_index_.Reset(); }
+
   // Collection of public headers that were used to construct the AST this `IR`.
   //
   // In production, these come from the `--public_headers` cmdline flag.
@@ -798,9 +1044,6 @@ struct IR {
 
   BazelLabel current_target;
 
-  using Item = std::variant<Func, Record, IncompleteRecord, Enum, TypeAlias,
-                            UnsupportedItem, Comment, Namespace, UseMod,
-                            TypeMapOverride>;
   std::vector<Item> items;
   std::vector<ItemId> top_level_item_ids;
   // Empty string signals that the bindings should be generated in the crate
@@ -819,12 +1062,58 @@ struct IR {
 
   absl::flat_hash_map<BazelLabel, absl::flat_hash_set<std::string>>
       crubit_features;
+
+ private:
+  // Positions in `items`, by variant alternative and by `ItemId`.
+  struct ItemIndex {
+    // The `items` this index was built for.
+    const Item* items_data = nullptr;
+    size_t items_size = 0;
+
+    std::array<std::vector<size_t>, std::variant_size_v<Item>>
+        positions_by_variant;
+    absl::flat_hash_map<ItemId, size_t> position_by_id;
+  };
+
+  // A lazily built `ItemIndex`. Copies start out empty, because the index of
+  // the original refers to its own `items`.
+  class ItemIndexCache {
+   public:
+    ItemIndexCache() = default;
+    ItemIndexCache(const ItemIndexCache&) {}
+    ItemIndexCache& operator=(const ItemIndexCache&) {
+      Reset();
+      return *this;
+    }
+
+    std::shared_ptr<const ItemIndex> Get(const std::vector<Item>& items) const;
+    void Reset();
+
+   private:
+    mutable absl::Mutex mutex_;
+    mutable std::shared_ptr<const ItemIndex> index_ ABSL_GUARDED_BY(mutex_);
+  };
+
+  std::shared_ptr<const ItemIndex> GetItemIndex() const {
+    return item_index_.Get(items);
+  }
+
+  ItemIndexCache item_index_;
 };
 
-inline std::string IrToJson(const IR& ir) {
-  return std::string(llvm::formatv("{0:2}", ir.ToJson()));
+// `threads` is passed to `IR::ToJson`.
+inline std::string IrToJson(const IR& ir, int threads = 1) {
+  return std::string(llvm::formatv("{0:2}", ir.ToJson(threads)));
 }
 
+// Serializes `ir` into a compact binary encoding of the same value tree as
+// `IR::ToJson()`. This is how the IR is handed to `src_code_gen.rs`
+// (`ir.rs::deserialize_ir_binary`); use `IrToJson` for human-readable output
+// such as `--ir_out`. The format is documented in `ir_binary.rs`.
+//
+// `threads` is passed to `IR::ToJson`.
+std::string IrToBinary(const IR& ir, int threads = 1);
+
 inline std::ostream& operator<<(std::ostream& o, const IR& ir) {
   return o << IrToJson(ir);
 }
@@ -10,7 +10,7 @@ use arc_anyhow::{anyhow, bail, Context, Error, Result};
 use once_cell::unsync::OnceCell;
 use proc_macro2::TokenStream;
 use quote::{quote, ToTokens};
-use serde::Deserialize;
+use serde::{Deserialize, Serialize};
 use std::collections::hash_map::{Entry, HashMap};
 use std::convert::TryFrom;
 use std::fmt::{self, Debug, Display, Formatter};
@@ -18,6 +18,8 @@ use std::hash::{Hash, Hasher};
 use std::io::Read;
 use std::rc::Rc;
 
+mod ir_binary;
+
 /// Common data about all items.
 pub trait GenericItem {
     fn id(&self) -> ItemId;
@@ -47,10 +49,64 @@ where
 
 /// Deserialize `IR` from JSON given as a reader.
 pub fn deserialize_ir<R: Read>(reader: R) -> Result<IR> {
-    let flat_ir = serde_json::from_reader(reader)?;
+    let interner = Rc::new(RsTypeInterner::default());
+    let flat_ir = with_rs_type_interner(&interner, || serde_json::from_reader(reader))?;
     Ok(make_ir(flat_ir))
 }
 
+/// Deserialize `IR` from the binary encoding produced by `IrToBinary` in
+/// `ir.h`.
+///
+/// Items are decoded lazily: this only walks the encoding to find each item's
+/// extent and the few fields `IR` indexes by, and the rest of an item is decoded
+/// the first time it is accessed. Large parts of a typical IR (e.g. items from
+/// dependencies that no generated binding refers to) are never decoded at all.
+///
+/// For convenience, JSON input (as produced by `IrToJson`) is accepted as well.
+pub fn deserialize_ir_binary(bytes: &[u8]) -> Result<IR> {
+    if !ir_binary::is_binary_ir(bytes) {
+        return deserialize_ir(bytes);
+    }
+    let (strings, value) = ir_binary::read_header(bytes)?;
+    let value_start = bytes.len() - value.len();
+    let buffer = Rc::new(BinaryIrBuffer {
+        bytes: bytes.into(),
+        strings,
+        rs_types: Rc::new(RsTypeInterner::default()),
+    });
+    let strings = &buffer.strings;
+    let mut public_headers = vec![];
+    let mut current_target = None;
+    let mut items = vec![];
+    let mut top_level_item_ids = vec![];
+    let mut crate_root_path = None;
+    let mut crubit_features = HashMap::new();
+    for (key, value) in ir_binary::object_entries(strings, &buffer.bytes[value_start..])? {
+        match key {
+            "public_headers" => public_headers = ir_binary::from_value(strings, value)?,
+            "current_target" => current_target = Some(ir_binary::from_value(strings, value)?),
+            "items" => {
+                items = ir_binary::array_elements(strings, value)?
+                    .into_iter()
+                    .map(|item| LazyItem::from_binary(&buffer, item))
+                    .collect::<Result<_>>()?
+            }
+            "top_level_item_ids" => top_level_item_ids = ir_binary::from_value(strings, value)?,
+            "crate_root_path" => crate_root_path = ir_binary::from_value(strings, value)?,
+            "crubit_features" => crubit_features = ir_binary::from_value(strings, value)?,
+            other => bail!("Unexpected field in binary IR: {other}"),
+        }
+    }
+    Ok(make_ir(FlatIR {
+        public_headers,
+        current_target: current_target.context("Binary IR is missing `current_target`")?,
+        items,
+        top_level_item_ids,
+        crate_root_path,
+        crubit_features,
+    }))
+}
+
 /// Create a testing `IR` instance from given parts. This function does not use
 /// any mock values.
 pub fn make_ir_from_parts<CrubitFeatures>(
@@ -67,7 +123,7 @@ where
     make_ir(FlatIR {
         public_headers,
         current_target,
-        items,
+        items: items.into_iter().map(LazyItem::from).collect(),
         top_level_item_ids,
         crate_root_path,
         crubit_features: crubit_features
@@ -80,7 +136,7 @@ where
 fn make_ir(flat_ir: FlatIR) -> IR {
     let mut used_decl_ids = HashMap::new();
     for item in &flat_ir.items {
-        if let Some(existing_decl) = used_decl_ids.insert(item.id(), item) {
+        if let Some(existing_decl) = used_decl_ids.insert(item.id, item) {
             panic!("Duplicate decl_id found in {:?} and {:?}", existing_decl, item);
         }
     }
@@ -88,17 +144,14 @@ fn make_ir(flat_ir: FlatIR) -> IR {
         .items
         .iter()
         .enumerate()
-        .map(|(idx, item)| (item.id(), idx))
+        .map(|(idx, item)| (item.id, idx))
         .collect::<HashMap<_, _>>();
 
+    let index_keys = flat_ir.items.iter().map(LazyItem::index_keys).collect::<Vec<_>>();
+
     let mut lifetimes: HashMap<LifetimeId, LifetimeName> = HashMap::new();
-    for item in &flat_ir.items {
-        let lifetime_params = match item {
-            Item::Record(record) => &record.lifetime_params,
-            Item::Func(func) => &func.lifetime_params,
-            _ => continue,
-        };
-        for lifetime in lifetime_params {
+    for (item, keys) in flat_ir.items.iter().zip(&index_keys) {
+        for lifetime in &keys.lifetime_params {
             match lifetimes.entry(lifetime.id) {
                 Entry::Occupied(occupied) => {
                     panic!(
@@ -117,11 +170,10 @@ fn make_ir(flat_ir: FlatIR) -> IR {
     let mut namespace_id_to_number_of_reopened_namespaces = HashMap::new();
     let mut reopened_namespace_id_to_idx = HashMap::new();
 
-    flat_ir
-        .items
+    index_keys
         .iter()
-        .filter_map(|item| match item {
-            Item::Namespace(ns) if ns.owning_target == flat_ir.current_target => {
+        .filter_map(|keys| match &keys.namespace {
+            Some(ns) if ns.owning_target == flat_ir.current_target => {
                 Some((ns.canonical_namespace_id, ns.id))
             }
             _ => None,
@@ -133,17 +185,12 @@ fn make_ir(flat_ir: FlatIR) -> IR {
             namespace_id_to_number_of_reopened_namespaces.insert(canonical_id, current_count + 1);
         });
 
-    let mut function_name_to_functions = HashMap::<UnqualifiedIdentifier, Vec<Rc<Func>>>::new();
-    flat_ir
-        .items
-        .iter()
-        .filter_map(|item| match item {
-            Item::Func(func) => Some(func),
-            _ => None,
-        })
-        .for_each(|f| {
-            function_name_to_functions.entry(f.name.clone()).or_default().push(f.clone());
-        });
+    let mut function_name_to_functions = HashMap::<UnqualifiedIdentifier, Vec<usize>>::new();
+    for (idx, keys) in index_keys.into_iter().enumerate() {
+        if let Some(func_name) = keys.func_name {
+            function_name_to_functions.entry(func_name).or_default().push(idx);
+        }
+    }
 
     IR {
         flat_ir,
@@ -173,13 +220,112 @@ pub struct LifetimeName {
     pub id: LifetimeId,
 }
 
-#[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
-#[serde(deny_unknown_fields)]
+/// A Rust type.
+///
+/// `RsType`s are hash-consed as they are deserialized: structurally equal types
+/// share their `type_args`, and each type carries a hash of its contents
+/// computed once on construction. This keeps hashing and comparing them (e.g.
+/// as the keys of memoized codegen queries) cheap, even for deeply nested
+/// template types.
+#[derive(Clone, Deserialize)]
+#[serde(from = "RsTypeFields")]
 pub struct RsType {
     pub name: Option<Rc<str>>,
     pub lifetime_args: Rc<[LifetimeId]>,
     pub type_args: Rc<[RsType]>,
     pub decl_id: Option<ItemId>,
+    hash: u64,
+}
+
+#[derive(Deserialize)]
+#[serde(deny_unknown_fields)]
+struct RsTypeFields {
+    name: Option<Rc<str>>,
+    lifetime_args: Rc<[LifetimeId]>,
+    type_args: Rc<[RsType]>,
+    decl_id: Option<ItemId>,
+}
+
+/// The canonical instance of every `RsType` deserialized as part of one IR.
+///
+/// The interner lives as long as the IR (a lazily decoded binary IR keeps using
+/// it as its items are decoded), so that nothing accumulates across the IRs
+/// deserialized by a long-lived process.
+#[derive(Default)]
+struct RsTypeInterner(std::cell::RefCell<std::collections::HashSet<RsType>>);
+
+impl RsTypeInterner {
+    fn intern(&self, rs_type: RsType) -> RsType {
+        let mut rs_types = self.0.borrow_mut();
+        if let Some(canonical) = rs_types.get(&rs_type) {
+            return canonical.clone();
+        }
+        rs_types.insert(rs_type.clone());
+        rs_type
+    }
+}
+
+thread_local! {
+    /// The interner of the IR being deserialized on this thread, if any.
+    static RS_TYPE_INTERNER: std::cell::RefCell<Option<Rc<RsTypeInterner>>> = Default::default();
+}
+
+/// Runs `f`, interning the `RsType`s it deserializes into `interner`.
+fn with_rs_type_interner<T>(interner: &Rc<RsTypeInterner>, f: impl FnOnce() -> T) -> T {
+    struct Restore(Option<Rc<RsTypeInterner>>);
+    impl Drop for Restore {
+        fn drop(&mut self) {
+            RS_TYPE_INTERNER.with(|current| *current.borrow_mut() = self.0.take());
+        }
+    }
+    let _restore =
+        Restore(RS_TYPE_INTERNER.with(|current| current.replace(Some(interner.clone()))));
+    f()
+}
+
+impl From<RsTypeFields> for RsType {
+    fn from(fields: RsTypeFields) -> Self {
+        let RsTypeFields { name, lifetime_args, type_args, decl_id } = fields;
+        let mut hasher = std::collections::hash_map::DefaultHasher::new();
+        name.hash(&mut hasher);
+        lifetime_args.hash(&mut hasher);
+        type_args.hash(&mut hasher);
+        decl_id.hash(&mut hasher);
+        let rs_type = RsType { name, lifetime_args, type_args, decl_id, hash: hasher.finish() };
+        RS_TYPE_INTERNER.with(|interner| match &*interner.borrow() {
+            Some(interner) => interner.intern(rs_type),
+            None => rs_type,
+        })
+    }
+}
+
+impl PartialEq for RsType {
+    fn eq(&self, other: &Self) -> bool {
+        self.hash == other.hash
+            && self.name == other.name
+            && self.lifetime_args == other.lifetime_args
+            && self.decl_id == other.decl_id
+            && (Rc::ptr_eq(&self.type_args, &other.type_args) || self.type_args == other.type_args)
+    }
+}
+
+impl Eq for RsType {}
+
+impl Hash for RsType {
+    fn hash<H: Hasher>(&self, state: &mut H) {
+        state.write_u64(self.hash);
+    }
+}
+
+impl Debug for RsType {
+    fn fmt(&self, f: &mut Formatter<'_>) -> fmt::Result {
+        f.debug_struct("RsType")
+            .field("name", &self.name)
+            .field("lifetime_args", &self.lifetime_args)
+            .field("type_args", &self.type_args)
+            .field("decl_id", &self.decl_id)
+            .finish()
+    }
 }
 
 impl RsType {
@@ -267,7 +413,7 @@ impl Debug for Operator {
     }
 }
 
-#[derive(Debug, PartialEq, Eq, Hash, Clone, Copy, Deserialize)]
+#[derive(Debug, PartialEq, Eq, PartialOrd, Ord, Hash, Clone, Copy, Deserialize, Serialize)]
 #[serde(transparent)]
 pub struct ItemId(usize);
 
@@ -284,7 +430,7 @@ impl ToTokens for ItemId {
 }
 
 /// A Bazel label, e.g. `//foo:bar`.
-#[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
+#[derive(Debug, PartialEq, Eq, Hash, PartialOrd, Ord, Clone, Deserialize)]
 #[serde(transparent)]
 pub struct BazelLabel(pub Rc<str>);
 
@@ -354,6 +500,7 @@ pub struct InstanceMethodMetadata {
     pub reference: ReferenceQualification,
     pub is_const: bool,
     pub is_virtual: bool,
+    pub is_final: bool,
 }
 
 #[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
@@ -363,6 +510,19 @@ pub struct MemberFuncMetadata {
     pub instance_method_metadata: Option<InstanceMethodMetadata>,
 }
 
+/// A read of a builtin scalar that is stored at a fixed offset in `*this`.
+#[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
+#[serde(deny_unknown_fields)]
+pub struct InlinedRead {
+    /// The offset of the value from the start of `*this`, in bytes.
+    pub offset: u64,
+    /// The size of the value, in bytes.
+    pub size: u64,
+    /// If present, the value read is an unsigned integer word, and the result
+    /// is whether any of these bits are set in it.
+    pub bit_mask: Option<u64>,
+}
+
 #[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
 #[serde(deny_unknown_fields)]
 pub struct FuncParam {
@@ -389,7 +549,15 @@ pub struct Func {
     pub is_inline: bool,
     pub member_func_metadata: Option<MemberFuncMetadata>,
     pub has_c_calling_convention: bool,
+    /// True if the function is declared `noexcept` (or `throw()`).
+    pub is_noexcept: bool,
     pub is_member_or_descendant_of_class_template: bool,
+    /// If present, this is an inline instance method whose body only returns
+    /// this field of `*this`.
+    pub returned_field: Option<Identifier>,
+    /// If present, this is an inline instance method whose result can be read
+    /// directly from `*this`, e.g. a protobuf field or has-bit getter.
+    pub inlined_read: Option<InlinedRead>,
     pub source_loc: Rc<str>,
     pub id: ItemId,
     pub enclosing_namespace_id: Option<ItemId>,
@@ -545,6 +713,11 @@ pub struct Record {
     pub move_constructor: SpecialMemberFunc,
     pub destructor: SpecialMemberFunc,
     pub is_trivial_abi: bool,
+    pub is_trivially_relocatable: bool,
+    pub is_send: bool,
+    pub is_sync: bool,
+    pub is_c_abi_compatible_by_value: bool,
+    pub is_zero_initializable: bool,
     pub is_inheritable: bool,
     pub is_abstract: bool,
     pub record_type: RecordType,
@@ -575,8 +748,8 @@ impl Record {
     ///
     /// Conditions:
     ///
-    /// 1. It is trivially relocatable, and thus can be passed by value and have
-    ///    its memory directly mutated by Rust using memcpy-like
+    /// 1. It is trivially relocatable (`is_trivially_relocatable`), and thus
+    ///    can have its memory directly mutated by Rust using memcpy-like
     ///    assignment/swap.
     ///
     /// 2. It cannot overlap with any other objects. In particular, it cannot be
@@ -594,7 +767,9 @@ impl Record {
     ///
     /// Described in more detail at: docs/unpin
     pub fn is_unpin(&self) -> bool {
-        self.is_trivial_abi && !self.is_inheritable && self.fields.iter().all(|f| !f.is_inheritable)
+        self.is_trivially_relocatable
+            && !self.is_inheritable
+            && self.fields.iter().all(|f| !f.is_inheritable)
     }
 
     pub fn is_union(&self) -> bool {
@@ -661,6 +836,64 @@ impl GenericItem for TypeAlias {
     }
 }
 
+/// A variable whose value is a compile-time integer constant (e.g. `constexpr
+/// int kSize = 8`, or a `static constexpr` data member).
+#[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
+#[serde(deny_unknown_fields)]
+pub struct Constant {
+    pub identifier: Identifier,
+    pub id: ItemId,
+    pub owning_target: BazelLabel,
+    pub doc_comment: Option<Rc<str>>,
+    pub source_loc: Rc<str>,
+    #[serde(rename(deserialize = "type"))]
+    pub type_: MappedType,
+    pub value: IntegerConstant,
+    pub enclosing_record_id: Option<ItemId>,
+    pub enclosing_namespace_id: Option<ItemId>,
+}
+
+impl GenericItem for Constant {
+    fn id(&self) -> ItemId {
+        self.id
+    }
+    fn debug_name(&self, _: &IR) -> Rc<str> {
+        self.identifier.identifier.clone()
+    }
+    fn source_loc(&self) -> Option<Rc<str>> {
+        Some(self.source_loc.clone())
+    }
+}
+
+/// A variable at namespace scope that isn't a constant.
+#[derive(Debug, PartialEq, Eq, Hash, Clone, Deserialize)]
+#[serde(deny_unknown_fields)]
+pub struct GlobalVar {
+    pub identifier: Identifier,
+    pub id: ItemId,
+    pub owning_target: BazelLabel,
+    pub doc_comment: Option<Rc<str>>,
+    pub source_loc: Rc<str>,
+    pub mangled_name: Rc<str>,
+    #[serde(rename(deserialize = "type"))]
+    pub type_: MappedType,
+    /// The size and alignment of `type_`.
+    pub size_align: SizeAlign,
+    pub enclosing_namespace_id: Option<ItemId>,
+}
+
+impl GenericItem for GlobalVar {
+    fn id(&self) -> ItemId {
+        self.id
+    }
+    fn debug_name(&self, _: &IR) -> Rc<str> {
+        self.identifier.identifier.clone()
+    }
+    fn source_loc(&self) -> Option<Rc<str>> {
+        Some(self.source_loc.clone())
+    }
+}
+
 /// A wrapper type that does not contribute to equality or hashing. All
 /// instances are equal.
 #[derive(Clone, Copy, Default)]
@@ -833,6 +1066,8 @@ pub enum Item {
     Namespace(Rc<Namespace>),
     UseMod(Rc<UseMod>),
     TypeMapOverride(Rc<TypeMapOverride>),
+    Constant(Rc<Constant>),
+    GlobalVar(Rc<GlobalVar>),
 }
 
 macro_rules! forward_item {
@@ -848,6 +1083,8 @@ macro_rules! forward_item {
             Item::Namespace($item_name) => $expr,
             Item::UseMod($item_name) => $expr,
             Item::TypeMapOverride($item_name) => $expr,
+            Item::Constant($item_name) => $expr,
+            Item::GlobalVar($item_name) => $expr,
         }
     };
 }
@@ -877,6 +1114,24 @@ impl GenericItem for Item {
 }
 
 impl Item {
+    /// Returns the name of the kind of the item, e.g. "Func".
+    pub fn kind_name(&self) -> &'static str {
+        match self {
+            Item::Func(..) => "Func",
+            Item::IncompleteRecord(..) => "IncompleteRecord",
+            Item::Record(..) => "Record",
+            Item::Enum(..) => "Enum",
+            Item::TypeAlias(..) => "TypeAlias",
+            Item::UnsupportedItem(..) => "UnsupportedItem",
+            Item::Comment(..) => "Comment",
+            Item::Namespace(..) => "Namespace",
+            Item::UseMod(..) => "UseMod",
+            Item::TypeMapOverride(..) => "TypeMapOverride",
+            Item::Constant(..) => "Constant",
+            Item::GlobalVar(..) => "GlobalVar",
+        }
+    }
+
     pub fn enclosing_namespace_id(&self) -> Option<ItemId> {
         match self {
             Item::Record(record) => record.enclosing_namespace_id,
@@ -889,6 +1144,8 @@ impl Item {
             Item::UnsupportedItem(..) => None,
             Item::UseMod(..) => None,
             Item::TypeMapOverride(..) => None,
+            Item::Constant(constant) => constant.enclosing_namespace_id,
+            Item::GlobalVar(global_var) => global_var.enclosing_namespace_id,
         }
     }
 
@@ -914,6 +1171,8 @@ impl Item {
             Item::Namespace(..) => None,
             Item::UseMod(..) => None,
             Item::TypeMapOverride(type_override) => Some(&type_override.owning_target),
+            Item::Constant(constant) => Some(&constant.owning_target),
+            Item::GlobalVar(global_var) => Some(&global_var.owning_target),
         }
     }
 }
@@ -980,6 +1239,13 @@ flagset::flags! {
         /// Experimental is never *set* without also setting Supported, but we allow it to be
         /// *required* without also requiring Supported, so that error messages can be more direct.
         Experimental,
+        /// Opt-in generation of `*_batch` variants of free functions, which call the function
+        /// over slices of arguments with a single thunk call, and of functions that destroy or
+        /// clone slices of records with a single thunk call.
+        BatchCalls,
+        /// Opt-in reads of the values returned by trivial inline getters (e.g. those of protobuf
+        /// messages) directly from the layout of the record, instead of through a thunk.
+        ProtoAccessors,
     }
 }
 
@@ -989,6 +1255,8 @@ impl CrubitFeature {
         match self {
             Self::Supported => "supported",
             Self::Experimental => "experimental",
+            Self::BatchCalls => "batch_calls",
+            Self::ProtoAccessors => "proto_accessors",
         }
     }
 
@@ -997,6 +1265,8 @@ impl CrubitFeature {
         match self {
             Self::Supported => "//:supported",
             Self::Experimental => "//:experimental",
+            Self::BatchCalls => "//:batch_calls",
+            Self::ProtoAccessors => "//:proto_accessors",
         }
     }
 }
@@ -1016,6 +1286,8 @@ impl<'de> serde::Deserialize<'de> for CrubitFeaturesIR {
             features |= match &*feature {
                 "experimental" => CrubitFeature::Experimental,
                 "supported" => CrubitFeature::Supported,
+                "batch_calls" => CrubitFeature::BatchCalls,
+                "proto_accessors" => CrubitFeature::ProtoAccessors,
                 other => {
                     return Err(<D::Error as serde::de::Error>::custom(format!(
                         "Unexpected Crubit feature: {other}"
@@ -1034,7 +1306,7 @@ struct FlatIR {
     public_headers: Vec<HeaderName>,
     current_target: BazelLabel,
     #[serde(default)]
-    items: Vec<Item>,
+    items: Vec<LazyItem>,
     #[serde(default)]
     top_level_item_ids: Vec<ItemId>,
     #[serde(default)]
@@ -1079,6 +1351,153 @@ impl Debug for FlatIR {
     }
 }
 
+/// An `Item` of `FlatIR`, which may still be in its binary IR encoding.
+///
+/// An encoded item is decoded (and cached) the first time it is accessed.
+#[derive(Clone)]
+struct LazyItem {
+    id: ItemId,
+    item: OnceCell<Item>,
+    /// The buffer holding the binary IR, and the extent of this item within it.
+    encoded: Option<(Rc<BinaryIrBuffer>, std::ops::Range<usize>)>,
+}
+
+/// A binary IR buffer, and its string table.
+struct BinaryIrBuffer {
+    bytes: Box<[u8]>,
+    strings: ir_binary::StringTable,
+    /// The interner for the `RsType`s of the items decoded from `bytes`.
+    rs_types: Rc<RsTypeInterner>,
+}
+
+/// The parts of an `Item` that `make_ir` builds indices from.
+#[derive(Default)]
+struct ItemIndexKeys {
+    lifetime_params: Vec<LifetimeName>,
+    func_name: Option<UnqualifiedIdentifier>,
+    namespace: Option<Rc<Namespace>>,
+}
+
+impl LazyItem {
+    /// Creates a `LazyItem` for `encoded`, which must be a slice of `buffer`.
+    fn from_binary(buffer: &Rc<BinaryIrBuffer>, encoded: &[u8]) -> Result<LazyItem> {
+        let strings = &buffer.strings;
+        let (variant, fields) = ir_binary::enum_variant(strings, encoded)?;
+        let (_, id) = ir_binary::object_entries(strings, fields)?
+            .into_iter()
+            .find(|(key, _)| *key == "id")
+            .with_context(|| format!("Binary IR item of kind {variant} has no `id`"))?;
+        let start = encoded.as_ptr() as usize - buffer.bytes.as_ptr() as usize;
+        Ok(LazyItem {
+            id: ir_binary::from_value(strings, id)?,
+            item: OnceCell::new(),
+            encoded: Some((buffer.clone(), start..start + encoded.len())),
+        })
+    }
+
+    fn get(&self) -> &Item {
+        self.item.get_or_init(|| {
+            let (buffer, range) = self.encoded.as_ref().expect("LazyItem has no item");
+            with_rs_type_interner(&buffer.rs_types, || {
+                ir_binary::from_value(&buffer.strings, &buffer.bytes[range.clone()])
+            })
+            .unwrap_or_else(|e| panic!("Failed to decode item {:?} from binary IR: {e}", self.id))
+        })
+    }
+
+    fn get_mut(&mut self) -> &mut Item {
+        self.get();
+        self.item.get_mut().unwrap()
+    }
+
+    /// Returns the fields `make_ir` indexes by. For an item which is still
+    /// encoded, only those fields are decoded, except for namespaces, which are
+    /// small and always needed by codegen anyway.
+    fn index_keys(&self) -> ItemIndexKeys {
+        let (strings, (variant, fields)) = match (self.item.get(), &self.encoded) {
+            (None, Some((buffer, range))) => (
+                &buffer.strings,
+                ir_binary::enum_variant(&buffer.strings, &buffer.bytes[range.clone()])
+                    .expect("LazyItem::from_binary already validated the item"),
+            ),
+            _ => {
+                return match self.get() {
+                    Item::Record(record) => ItemIndexKeys {
+                        lifetime_params: record.lifetime_params.clone(),
+                        ..Default::default()
+                    },
+                    Item::Func(func) => ItemIndexKeys {
+                        lifetime_params: func.lifetime_params.clone(),
+                        func_name: Some(func.name.clone()),
+                        ..Default::default()
+                    },
+                    Item::Namespace(ns) => {
+                        ItemIndexKeys { namespace: Some(ns.clone()), ..Default::default() }
+                    }
+                    _ => ItemIndexKeys::default(),
+                };
+            }
+        };
+        if variant == "Namespace" {
+            self.get();
+            return self.index_keys();
+        }
+        let mut keys = ItemIndexKeys::default();
+        if variant != "Record" && variant != "Func" {
+            return keys;
+        }
+        fn decode<T: serde::de::DeserializeOwned>(
+            strings: &ir_binary::StringTable,
+            id: ItemId,
+            key: &str,
+            value: &[u8],
+        ) -> T {
+            ir_binary::from_value(strings, value).unwrap_or_else(|e| {
+                panic!("Failed to decode {key} of item {id:?} from binary IR: {e}")
+            })
+        }
+        for (key, value) in ir_binary::object_entries(strings, fields).unwrap() {
+            match key {
+                "lifetime_params" => keys.lifetime_params = decode(strings, self.id, key, value),
+                "name" if variant == "Func" => {
+                    keys.func_name = Some(decode(strings, self.id, key, value))
+                }
+                _ => {}
+            }
+        }
+        keys
+    }
+}
+
+impl From<Item> for LazyItem {
+    fn from(item: Item) -> Self {
+        LazyItem { id: item.id(), item: OnceCell::from(item), encoded: None }
+    }
+}
+
+impl<'de> Deserialize<'de> for LazyItem {
+    fn deserialize<D>(deserializer: D) -> std::result::Result<Self, D::Error>
+    where
+        D: serde::Deserializer<'de>,
+    {
+        Item::deserialize(deserializer).map(LazyItem::from)
+    }
+}
+
+impl PartialEq for LazyItem {
+    fn eq(&self, other: &Self) -> bool {
+        self.get() == other.get()
+    }
+}
+
+impl Eq for LazyItem {}
+
+impl Debug for LazyItem {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        Debug::fmt(self.get(), f)
+    }
+}
+
 /// Struct providing the necessary information about the API of a C++ target to
 /// enable generation of Rust bindings source code (both `rs_api.rs` and
 /// `rs_api_impl.cc` files).
@@ -1090,12 +1509,14 @@ pub struct IR {
     lifetimes: HashMap<LifetimeId, LifetimeName>,
     namespace_id_to_number_of_reopened_namespaces: HashMap<ItemId, usize>,
     reopened_namespace_id_to_idx: HashMap<ItemId, usize>,
-    function_name_to_functions: HashMap<UnqualifiedIdentifier, Vec<Rc<Func>>>,
+    // A map from a function name to the indices of `Func` items in the
+    // `flat_ir.items` vec.
+    function_name_to_functions: HashMap<UnqualifiedIdentifier, Vec<usize>>,
 }
 
 impl IR {
     pub fn items(&self) -> impl Iterator<Item = &Item> {
-        self.flat_ir.items.iter()
+        self.flat_ir.items.iter().map(LazyItem::get)
     }
 
     pub fn top_level_item_ids(&self) -> impl Iterator<Item = &ItemId> {
@@ -1103,7 +1524,7 @@ impl IR {
     }
 
     pub fn items_mut(&mut self) -> impl Iterator<Item = &mut Item> {
-        self.flat_ir.items.iter_mut()
+        self.flat_ir.items.iter_mut().map(LazyItem::get_mut)
     }
 
     pub fn public_headers(&self) -> impl Iterator<Item = &HeaderName> {
@@ -1174,6 +1595,7 @@ impl IR {
             .items
             .get(idx)
             .unwrap_or_else(|| panic!("Couldn't find an item at idx {}", idx))
+            .get()
     }
 
     /// Returns whether `target` is the current target.
@@ -1183,6 +1605,12 @@ impl IR {
         *target == *self.current_target()
     }
 
+    /// Returns the targets whose Crubit features are known, i.e. the current
+    /// target and its dependencies.
+    pub fn targets(&self) -> impl Iterator<Item = &BazelLabel> {
+        self.flat_ir.crubit_features.keys()
+    }
+
     /// Returns the Crubit features enabled for the given `target`.
     #[must_use]
     pub fn target_crubit_features(&self, target: &BazelLabel) -> flagset::FlagSet<CrubitFeature> {
@@ -1266,7 +1694,14 @@ impl IR {
         &self,
         function_name: &UnqualifiedIdentifier,
     ) -> impl Iterator<Item = &Rc<Func>> {
-        self.function_name_to_functions.get(function_name).map_or([].iter(), |v| v.iter())
+        self.function_name_to_functions
+            .get(function_name)
+            .map_or(&[][..], Vec::as_slice)
+            .iter()
+            .map(|&idx| match self.flat_ir.items[idx].get() {
+                Item::Func(func) => func,
+                item => panic!("Expected a Func at idx {idx}, found {item:?}"),
+            })
     }
 }
 
@@ -1292,6 +1727,34 @@ mod tests {
         assert_eq!(format!("{:?}", UnqualifiedIdentifier::Destructor), "Destructor");
     }
 
+    #[test]
+    fn test_rs_types_are_hash_consed() {
+        let input = r#"
+        {
+            "name": "Vec",
+            "lifetime_args": [],
+            "type_args": [{ "name": "i32", "lifetime_args": [], "type_args": [] }]
+        }
+        "#;
+        let interner = Rc::new(RsTypeInterner::default());
+        let (a, b, c) = with_rs_type_interner(&interner, || {
+            let a: RsType = serde_json::from_str(input).unwrap();
+            let b: RsType = serde_json::from_str(input).unwrap();
+            let c: RsType = serde_json::from_str(&input.replace("i32", "u32")).unwrap();
+            (a, b, c)
+        });
+        assert_eq!(a, b);
+        assert!(Rc::ptr_eq(&a.type_args, &b.type_args));
+        assert_eq!(&*a.type_args[0].name.clone().unwrap(), "i32");
+        assert_ne!(a, c);
+
+        // Types deserialized outside of the interner's scope aren't interned.
+        let d: RsType = serde_json::from_str(input).unwrap();
+        assert_eq!(a, d);
+        assert!(!Rc::ptr_eq(&a.type_args, &d.type_args));
+        assert!(RS_TYPE_INTERNER.with(|current| current.borrow().is_none()));
+    }
+
     #[test]
     fn test_used_headers() {
         let input = r#"
@@ -1331,6 +1794,89 @@ mod tests {
         assert_eq!(ir.crate_root_path().as_deref(), Some("__cc_template_instantiations_rs_api"));
     }
 
+    /// Returns binary IR with the given string table and encoded value.
+    fn binary_ir(strings: &[&str], value: &[u8]) -> Vec<u8> {
+        let mut input = ir_binary::MAGIC.to_vec();
+        input.extend_from_slice(&(strings.len() as u32).to_le_bytes());
+        for s in strings {
+            input.extend_from_slice(&(s.len() as u32).to_le_bytes());
+            input.extend_from_slice(s.as_bytes());
+        }
+        input.extend_from_slice(value);
+        input
+    }
+
+    #[test]
+    fn test_binary_ir() {
+        // {"current_target": "//foo:bar", "public_headers": [{"name": "foo/bar.h"}]}
+        let strings = ["current_target", "//foo:bar", "public_headers", "name", "foo/bar.h"];
+        let mut value = vec![8];
+        value.extend_from_slice(&2u32.to_le_bytes());
+        value.extend_from_slice(&0u32.to_le_bytes());
+        value.push(6);
+        value.extend_from_slice(&1u32.to_le_bytes());
+        value.extend_from_slice(&2u32.to_le_bytes());
+        value.push(7);
+        value.extend_from_slice(&1u32.to_le_bytes());
+        value.push(8);
+        value.extend_from_slice(&1u32.to_le_bytes());
+        value.extend_from_slice(&3u32.to_le_bytes());
+        value.push(6);
+        value.extend_from_slice(&4u32.to_le_bytes());
+
+        let ir = deserialize_ir_binary(&binary_ir(&strings, &value)).unwrap();
+        let expected = FlatIR {
+            public_headers: vec![HeaderName { name: "foo/bar.h".into() }],
+            current_target: "//foo:bar".into(),
+            top_level_item_ids: vec![],
+            items: vec![],
+            crate_root_path: None,
+            crubit_features: Default::default(),
+        };
+        assert_eq!(ir.flat_ir, expected);
+    }
+
+    #[test]
+    fn test_binary_ir_items_are_decoded_lazily() {
+        // {"current_target": "//foo:bar",
+        //  "items": [{"Comment": {"text": "hello", "id": 42}}]}
+        let strings = ["current_target", "//foo:bar", "items", "Comment", "text", "hello", "id"];
+        let mut value = vec![8];
+        value.extend_from_slice(&2u32.to_le_bytes());
+        value.extend_from_slice(&0u32.to_le_bytes());
+        value.push(6);
+        value.extend_from_slice(&1u32.to_le_bytes());
+        value.extend_from_slice(&2u32.to_le_bytes());
+        value.push(7);
+        value.extend_from_slice(&1u32.to_le_bytes());
+        value.push(8);
+        value.extend_from_slice(&1u32.to_le_bytes());
+        value.extend_from_slice(&3u32.to_le_bytes());
+        value.push(8);
+        value.extend_from_slice(&2u32.to_le_bytes());
+        value.extend_from_slice(&4u32.to_le_bytes());
+        value.push(6);
+        value.extend_from_slice(&5u32.to_le_bytes());
+        value.extend_from_slice(&6u32.to_le_bytes());
+        value.push(4);
+        value.extend_from_slice(&42u64.to_le_bytes());
+
+        let ir = deserialize_ir_binary(&binary_ir(&strings, &value)).unwrap();
+        assert!(ir.flat_ir.items[0].item.get().is_none());
+        let comments = ir.comments().collect::<Vec<_>>();
+        assert_eq!(
+            comments,
+            [&Rc::new(Comment { text: "hello".into(), id: ItemId::new_for_testing(42) })]
+        );
+        assert!(ir.flat_ir.items[0].item.get().is_some());
+    }
+
+    #[test]
+    fn test_binary_ir_accepts_json() {
+        let ir = deserialize_ir_binary(b"{ \"current_target\": \"//foo:bar\" }").unwrap();
+        assert_eq!(ir.current_target(), &BazelLabel::from("//foo:bar"));
+    }
+
     #[test]
     fn test_bazel_label_target() {
         let label: BazelLabel = "//foo:bar".into();
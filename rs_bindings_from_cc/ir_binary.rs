@@ -0,0 +1,630 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! A `serde::Deserializer` for the binary IR encoding produced by
+//! `IrToBinary` in `rs_bindings_from_cc/ir.cc`.
+//!
+//! The encoding mirrors the JSON value tree produced by `IR::ToJson()`, so the
+//! IR schema stays defined in one place (the `ToJson` methods in C++ and the
+//! `Deserialize` derives in `ir.rs`). What it avoids is the text formatting on
+//! the C++ side, and the tokenizing, unescaping and number parsing on the Rust
+//! side.
+//!
+//! After the `MAGIC` prefix, the buffer contains a string table: a `u32`
+//! count, followed by that many strings, each a `u32` byte length followed by
+//! UTF-8 bytes. Each distinct string of the value (including object keys)
+//! occurs in the table exactly once, and is referred to by its `u32` index in
+//! the table, so that identifiers, labels and names which occur many times are
+//! only encoded (and validated) once.
+//!
+//! The string table is followed by a single value. Each value starts with a
+//! one-byte tag:
+//!
+//!   * `TAG_NULL`, `TAG_FALSE`, `TAG_TRUE`: no payload.
+//!   * `TAG_I64`, `TAG_U64`, `TAG_F64`: 8 bytes, little-endian.
+//!   * `TAG_STRING`: `u32` index in the string table.
+//!   * `TAG_ARRAY`: `u32` element count, followed by the elements.
+//!   * `TAG_OBJECT`: `u32` entry count, followed by the entries. Each entry is
+//!     a key (`u32` index in the string table, without a tag) and a value.
+//!
+//! All `u32`s are little-endian.
+//!
+//! Besides the `Deserializer`, `array_elements`, `object_entries` and
+//! `enum_variant` give access to still-encoded subvalues without decoding them,
+//! which `ir.rs` uses to decode items lazily. All of them take the
+//! `StringTable` returned by `read_header`, since subvalues only contain
+//! indices into it.
+
+use serde::de::{
+    self, DeserializeOwned, DeserializeSeed, EnumAccess, IntoDeserializer, MapAccess, SeqAccess,
+    VariantAccess, Visitor,
+};
+use std::fmt::{self, Display};
+
+// LINT.IfChange
+/// Prefix identifying the binary IR encoding (and its version).
+pub const MAGIC: &[u8] = b"CRBTIR02";
+
+const TAG_NULL: u8 = 0;
+const TAG_FALSE: u8 = 1;
+const TAG_TRUE: u8 = 2;
+const TAG_I64: u8 = 3;
+const TAG_U64: u8 = 4;
+const TAG_F64: u8 = 5;
+const TAG_STRING: u8 = 6;
+const TAG_ARRAY: u8 = 7;
+const TAG_OBJECT: u8 = 8;
+// LINT.ThenChange(//depot/rs_bindings_from_cc/ir.cc)
+
+/// Returns whether `bytes` look like binary IR (as opposed to JSON).
+pub fn is_binary_ir(bytes: &[u8]) -> bool {
+    bytes.starts_with(MAGIC)
+}
+
+/// The distinct strings of a binary IR buffer.
+#[derive(Debug, Default)]
+pub struct StringTable {
+    strings: Vec<Box<str>>,
+}
+
+impl StringTable {
+    fn get(&self, index: usize) -> Result<&str> {
+        self.strings.get(index).map(|s| &**s).ok_or_else(|| {
+            BinaryIrError(format!(
+                "Binary IR refers to string {index}, but has only {} strings",
+                self.strings.len()
+            ))
+        })
+    }
+}
+
+/// Decodes the header of `bytes`, and returns its string table and the single
+/// encoded value following it.
+pub fn read_header(bytes: &[u8]) -> Result<(StringTable, &[u8])> {
+    let input = bytes
+        .strip_prefix(MAGIC)
+        .ok_or_else(|| BinaryIrError("Binary IR is missing the expected header".to_string()))?;
+    static NO_STRINGS: StringTable = StringTable { strings: Vec::new() };
+    let mut deserializer = Deserializer { input, strings: &NO_STRINGS };
+    let len = deserializer.read_u32()?;
+    let strings = (0..len)
+        .map(|_| {
+            let len = deserializer.read_u32()?;
+            let s = std::str::from_utf8(deserializer.take(len)?)
+                .map_err(|e| BinaryIrError(format!("Binary IR contains an invalid string: {e}")))?;
+            Ok(s.into())
+        })
+        .collect::<Result<_>>()?;
+    Ok((StringTable { strings }, deserializer.input))
+}
+
+/// Deserializes a `T` from `value`, a single encoded value without a header
+/// (as returned by `read_header`, `array_elements` or `object_entries`).
+pub fn from_value<T: DeserializeOwned>(strings: &StringTable, value: &[u8]) -> Result<T> {
+    let mut deserializer = Deserializer { input: value, strings };
+    let value = T::deserialize(&mut deserializer)?;
+    deserializer.expect_end()?;
+    Ok(value)
+}
+
+/// Splits the encoded array `value` into its still-encoded elements.
+pub fn array_elements<'a>(strings: &'a StringTable, value: &'a [u8]) -> Result<Vec<&'a [u8]>> {
+    let mut deserializer = Deserializer { input: value, strings };
+    let tag = deserializer.read_tag()?;
+    if tag != TAG_ARRAY {
+        return Err(BinaryIrError(format!("Binary IR expected an array, found tag {tag}")));
+    }
+    let len = deserializer.read_u32()?;
+    let elements = (0..len).map(|_| deserializer.take_value()).collect::<Result<_>>()?;
+    deserializer.expect_end()?;
+    Ok(elements)
+}
+
+/// Splits the encoded object `value` into its keys and still-encoded values.
+pub fn object_entries<'a>(
+    strings: &'a StringTable,
+    value: &'a [u8],
+) -> Result<Vec<(&'a str, &'a [u8])>> {
+    let mut deserializer = Deserializer { input: value, strings };
+    let tag = deserializer.read_tag()?;
+    if tag != TAG_OBJECT {
+        return Err(BinaryIrError(format!("Binary IR expected an object, found tag {tag}")));
+    }
+    let len = deserializer.read_u32()?;
+    let entries = (0..len)
+        .map(|_| Ok((deserializer.read_str()?, deserializer.take_value()?)))
+        .collect::<Result<_>>()?;
+    deserializer.expect_end()?;
+    Ok(entries)
+}
+
+/// Splits the encoded non-unit enum variant `value` into the variant name and
+/// its still-encoded contents.
+pub fn enum_variant<'a>(strings: &'a StringTable, value: &'a [u8]) -> Result<(&'a str, &'a [u8])> {
+    match object_entries(strings, value)?[..] {
+        [entry] => Ok(entry),
+        ref entries => Err(BinaryIrError(format!(
+            "Binary IR enum must be an object with exactly one entry, found {}",
+            entries.len()
+        ))),
+    }
+}
+
+/// An error encountered while decoding binary IR.
+#[derive(Debug, Clone, PartialEq, Eq)]
+pub struct BinaryIrError(String);
+
+impl Display for BinaryIrError {
+    fn fmt(&self, f: &mut fmt::Formatter<'_>) -> fmt::Result {
+        f.write_str(&self.0)
+    }
+}
+
+impl std::error::Error for BinaryIrError {}
+
+impl de::Error for BinaryIrError {
+    fn custom<T: Display>(msg: T) -> Self {
+        BinaryIrError(msg.to_string())
+    }
+}
+
+type Result<T> = std::result::Result<T, BinaryIrError>;
+
+struct Deserializer<'de> {
+    input: &'de [u8],
+    strings: &'de StringTable,
+}
+
+impl<'de> Deserializer<'de> {
+    fn take(&mut self, len: usize) -> Result<&'de [u8]> {
+        if self.input.len() < len {
+            return Err(BinaryIrError(format!(
+                "Binary IR is truncated: expected {len} more bytes, found {}",
+                self.input.len()
+            )));
+        }
+        let (head, tail) = self.input.split_at(len);
+        self.input = tail;
+        Ok(head)
+    }
+
+    fn peek_tag(&self) -> Result<u8> {
+        self.input
+            .first()
+            .copied()
+            .ok_or_else(|| BinaryIrError("Binary IR is truncated: expected a tag".to_string()))
+    }
+
+    fn read_tag(&mut self) -> Result<u8> {
+        Ok(self.take(1)?[0])
+    }
+
+    fn read_u32(&mut self) -> Result<usize> {
+        let bytes: [u8; 4] = self.take(4)?.try_into().unwrap();
+        Ok(u32::from_le_bytes(bytes) as usize)
+    }
+
+    fn read_8_bytes(&mut self) -> Result<[u8; 8]> {
+        Ok(self.take(8)?.try_into().unwrap())
+    }
+
+    fn read_str(&mut self) -> Result<&'de str> {
+        let index = self.read_u32()?;
+        self.strings.get(index)
+    }
+
+    /// Consumes the next value without decoding it, and returns its encoding.
+    fn take_value(&mut self) -> Result<&'de [u8]> {
+        let start = self.input;
+        self.skip_value()?;
+        Ok(&start[..start.len() - self.input.len()])
+    }
+
+    fn skip_value(&mut self) -> Result<()> {
+        match self.read_tag()? {
+            TAG_NULL | TAG_FALSE | TAG_TRUE => {}
+            TAG_I64 | TAG_U64 | TAG_F64 => {
+                self.take(8)?;
+            }
+            TAG_STRING => {
+                self.take(4)?;
+            }
+            TAG_ARRAY => {
+                for _ in 0..self.read_u32()? {
+                    self.skip_value()?;
+                }
+            }
+            TAG_OBJECT => {
+                for _ in 0..self.read_u32()? {
+                    self.take(4)?;
+                    self.skip_value()?;
+                }
+            }
+            tag => return Err(BinaryIrError(format!("Binary IR contains an unknown tag: {tag}"))),
+        }
+        Ok(())
+    }
+
+    fn expect_end(&self) -> Result<()> {
+        if !self.input.is_empty() {
+            return Err(BinaryIrError(format!(
+                "Binary IR has {} unexpected trailing bytes",
+                self.input.len()
+            )));
+        }
+        Ok(())
+    }
+}
+
+impl<'de, 'a> de::Deserializer<'de> for &'a mut Deserializer<'de> {
+    type Error = BinaryIrError;
+
+    fn deserialize_any<V: Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        match self.read_tag()? {
+            TAG_NULL => visitor.visit_unit(),
+            TAG_FALSE => visitor.visit_bool(false),
+            TAG_TRUE => visitor.visit_bool(true),
+            TAG_I64 => visitor.visit_i64(i64::from_le_bytes(self.read_8_bytes()?)),
+            TAG_U64 => visitor.visit_u64(u64::from_le_bytes(self.read_8_bytes()?)),
+            TAG_F64 => visitor.visit_f64(f64::from_le_bytes(self.read_8_bytes()?)),
+            TAG_STRING => visitor.visit_borrowed_str(self.read_str()?),
+            TAG_ARRAY => {
+                let remaining = self.read_u32()?;
+                visitor.visit_seq(Elements { de: self, remaining })
+            }
+            TAG_OBJECT => {
+                let remaining = self.read_u32()?;
+                visitor.visit_map(Elements { de: self, remaining })
+            }
+            tag => Err(BinaryIrError(format!("Binary IR contains an unknown tag: {tag}"))),
+        }
+    }
+
+    fn deserialize_option<V: Visitor<'de>>(self, visitor: V) -> Result<V::Value> {
+        if self.peek_tag()? == TAG_NULL {
+            self.read_tag()?;
+            visitor.visit_none()
+        } else {
+            visitor.visit_some(self)
+        }
+    }
+
+    fn deserialize_newtype_struct<V: Visitor<'de>>(
+        self,
+        _name: &'static str,
+        visitor: V,
+    ) -> Result<V::Value> {
+        visitor.visit_newtype_struct(self)
+    }
+
+    /// Enums use the same externally tagged representation as JSON: either a
+    /// string naming a unit variant, or a single-entry object mapping the
+    /// variant name to its contents.
+    fn deserialize_enum<V: Visitor<'de>>(
+        self,
+        _name: &'static str,
+        _variants: &'static [&'static str],
+        visitor: V,
+    ) -> Result<V::Value> {
+        match self.read_tag()? {
+            TAG_STRING => visitor.visit_enum(self.read_str()?.into_deserializer()),
+            TAG_OBJECT => {
+                let len = self.read_u32()?;
+                if len != 1 {
+                    return Err(BinaryIrError(format!(
+                        "Binary IR enum must be an object with exactly one entry, found {len}"
+                    )));
+                }
+                visitor.visit_enum(Variant { de: self })
+            }
+            tag => Err(BinaryIrError(format!("Binary IR expected an enum, found tag {tag}"))),
+        }
+    }
+
+    serde::forward_to_deserialize_any! {
+        bool i8 i16 i32 i64 i128 u8 u16 u32 u64 u128 f32 f64 char str string
+        bytes byte_buf unit unit_struct seq tuple tuple_struct map struct
+        identifier ignored_any
+    }
+}
+
+/// The elements of an array, or the entries of an object.
+struct Elements<'a, 'de> {
+    de: &'a mut Deserializer<'de>,
+    remaining: usize,
+}
+
+impl<'de, 'a> SeqAccess<'de> for Elements<'a, 'de> {
+    type Error = BinaryIrError;
+
+    fn next_element_seed<T: DeserializeSeed<'de>>(&mut self, seed: T) -> Result<Option<T::Value>> {
+        if self.remaining == 0 {
+            return Ok(None);
+        }
+        self.remaining -= 1;
+        seed.deserialize(&mut *self.de).map(Some)
+    }
+
+    fn size_hint(&self) -> Option<usize> {
+        Some(self.remaining)
+    }
+}
+
+impl<'de, 'a> MapAccess<'de> for Elements<'a, 'de> {
+    type Error = BinaryIrError;
+
+    fn next_key_seed<K: DeserializeSeed<'de>>(&mut self, seed: K) -> Result<Option<K::Value>> {
+        if self.remaining == 0 {
+            return Ok(None);
+        }
+        self.remaining -= 1;
+        let key = self.de.read_str()?;
+        seed.deserialize(de::value::BorrowedStrDeserializer::new(key)).map(Some)
+    }
+
+    fn next_value_seed<V: DeserializeSeed<'de>>(&mut self, seed: V) -> Result<V::Value> {
+        seed.deserialize(&mut *self.de)
+    }
+
+    fn size_hint(&self) -> Option<usize> {
+        Some(self.remaining)
+    }
+}
+
+/// The single entry of an object representing a non-unit enum variant.
+struct Variant<'a, 'de> {
+    de: &'a mut Deserializer<'de>,
+}
+
+impl<'de, 'a> EnumAccess<'de> for Variant<'a, 'de> {
+    type Error = BinaryIrError;
+    type Variant = Self;
+
+    fn variant_seed<V: DeserializeSeed<'de>>(self, seed: V) -> Result<(V::Value, Self)> {
+        let key = self.de.read_str()?;
+        let variant = seed.deserialize(de::value::BorrowedStrDeserializer::new(key))?;
+        Ok((variant, self))
+    }
+}
+
+impl<'de, 'a> VariantAccess<'de> for Variant<'a, 'de> {
+    type Error = BinaryIrError;
+
+    /// Unit variants are spelled `{"Constructor": null}` by `IR::ToJson()`.
+    fn unit_variant(self) -> Result<()> {
+        de::Deserialize::deserialize(self.de)
+    }
+
+    fn newtype_variant_seed<T: DeserializeSeed<'de>>(self, seed: T) -> Result<T::Value> {
+        seed.deserialize(self.de)
+    }
+
+    fn tuple_variant<V: Visitor<'de>>(self, _len: usize, visitor: V) -> Result<V::Value> {
+        de::Deserializer::deserialize_seq(self.de, visitor)
+    }
+
+    fn struct_variant<V: Visitor<'de>>(
+        self,
+        _fields: &'static [&'static str],
+        visitor: V,
+    ) -> Result<V::Value> {
+        de::Deserializer::deserialize_map(self.de, visitor)
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use serde::Deserialize;
+
+    /// A minimal encoder, mirroring `BinaryIrEncoder` in `ir.cc`.
+    enum Value {
+        Null,
+        Bool(bool),
+        I64(i64),
+        U64(u64),
+        Str(&'static str),
+        Array(Vec<Value>),
+        Object(Vec<(&'static str, Value)>),
+    }
+
+    #[derive(Default)]
+    struct Encoder {
+        strings: Vec<&'static str>,
+        values: Vec<u8>,
+    }
+
+    impl Encoder {
+        fn append_str(&mut self, s: &'static str) {
+            let index = self.strings.iter().position(|t| *t == s).unwrap_or_else(|| {
+                self.strings.push(s);
+                self.strings.len() - 1
+            });
+            self.values.extend_from_slice(&(index as u32).to_le_bytes());
+        }
+
+        fn append(&mut self, value: &Value) {
+            match value {
+                Value::Null => self.values.push(TAG_NULL),
+                Value::Bool(false) => self.values.push(TAG_FALSE),
+                Value::Bool(true) => self.values.push(TAG_TRUE),
+                Value::I64(i) => {
+                    self.values.push(TAG_I64);
+                    self.values.extend_from_slice(&i.to_le_bytes());
+                }
+                Value::U64(u) => {
+                    self.values.push(TAG_U64);
+                    self.values.extend_from_slice(&u.to_le_bytes());
+                }
+                Value::Str(s) => {
+                    self.values.push(TAG_STRING);
+                    self.append_str(s);
+                }
+                Value::Array(elements) => {
+                    self.values.push(TAG_ARRAY);
+                    self.values.extend_from_slice(&(elements.len() as u32).to_le_bytes());
+                    elements.iter().for_each(|element| self.append(element));
+                }
+                Value::Object(entries) => {
+                    self.values.push(TAG_OBJECT);
+                    self.values.extend_from_slice(&(entries.len() as u32).to_le_bytes());
+                    for (key, value) in entries {
+                        self.append_str(key);
+                        self.append(value);
+                    }
+                }
+            }
+        }
+    }
+
+    fn from_slice<T: DeserializeOwned>(bytes: &[u8]) -> Result<T> {
+        let (strings, value) = read_header(bytes)?;
+        from_value(&strings, value)
+    }
+
+    fn encode(value: Value) -> Vec<u8> {
+        let mut encoder = Encoder::default();
+        encoder.append(&value);
+        let mut out = MAGIC.to_vec();
+        out.extend_from_slice(&(encoder.strings.len() as u32).to_le_bytes());
+        for s in &encoder.strings {
+            out.extend_from_slice(&(s.len() as u32).to_le_bytes());
+            out.extend_from_slice(s.as_bytes());
+        }
+        out.extend_from_slice(&encoder.values);
+        out
+    }
+
+    #[derive(Debug, PartialEq, Deserialize)]
+    enum Name {
+        Identifier(String),
+        Constructor,
+    }
+
+    #[derive(Debug, PartialEq, Deserialize)]
+    #[serde(deny_unknown_fields)]
+    struct Thing {
+        names: Vec<Name>,
+        id: usize,
+        offset: i32,
+        comment: Option<String>,
+        missing: Option<String>,
+        flag: bool,
+        result: std::result::Result<u64, String>,
+    }
+
+    #[test]
+    fn test_round_trip() {
+        let bytes = encode(Value::Object(vec![
+            (
+                "names",
+                Value::Array(vec![
+                    Value::Object(vec![("Identifier", Value::Str("foo"))]),
+                    Value::Object(vec![("Constructor", Value::Null)]),
+                    Value::Str("Constructor"),
+                ]),
+            ),
+            ("id", Value::U64(u64::MAX >> 1)),
+            ("offset", Value::I64(-4)),
+            ("comment", Value::Null),
+            ("flag", Value::Bool(true)),
+            ("result", Value::Object(vec![("Ok", Value::I64(7))])),
+        ]));
+        let thing: Thing = from_slice(&bytes).unwrap();
+        assert_eq!(
+            thing,
+            Thing {
+                names: vec![
+                    Name::Identifier("foo".to_string()),
+                    Name::Constructor,
+                    Name::Constructor
+                ],
+                id: (u64::MAX >> 1) as usize,
+                offset: -4,
+                comment: None,
+                missing: None,
+                flag: true,
+                result: Ok(7),
+            }
+        );
+    }
+
+    #[test]
+    fn test_raw_access() {
+        let bytes = encode(Value::Object(vec![
+            ("ints", Value::Array(vec![Value::I64(1), Value::Str("two"), Value::Null])),
+            ("name", Value::Object(vec![("Identifier", Value::Str("foo"))])),
+        ]));
+        let (strings, value) = read_header(&bytes).unwrap();
+        let entries = object_entries(&strings, value).unwrap();
+        assert_eq!(entries.iter().map(|(key, _)| *key).collect::<Vec<_>>(), ["ints", "name"]);
+
+        let ints = array_elements(&strings, entries[0].1).unwrap();
+        assert_eq!(ints.len(), 3);
+        assert_eq!(from_value::<i64>(&strings, ints[0]).unwrap(), 1);
+        assert_eq!(from_value::<String>(&strings, ints[1]).unwrap(), "two");
+        assert_eq!(from_value::<Option<bool>>(&strings, ints[2]).unwrap(), None);
+
+        let (variant, contents) = enum_variant(&strings, entries[1].1).unwrap();
+        assert_eq!(variant, "Identifier");
+        assert_eq!(from_value::<String>(&strings, contents).unwrap(), "foo");
+        assert_eq!(
+            from_value::<Name>(&strings, entries[1].1).unwrap(),
+            Name::Identifier("foo".to_string())
+        );
+
+        let err = array_elements(&strings, entries[1].1).unwrap_err();
+        assert_eq!(err.to_string(), "Binary IR expected an array, found tag 8");
+    }
+
+    #[test]
+    fn test_strings_are_encoded_once() {
+        let bytes = encode(Value::Array(vec![
+            Value::Object(vec![("name", Value::Str("foo"))]),
+            Value::Object(vec![("name", Value::Str("foo"))]),
+            Value::Object(vec![("name", Value::Str("bar"))]),
+        ]));
+        let (strings, _) = read_header(&bytes).unwrap();
+        assert_eq!(strings.strings.iter().map(|s| &**s).collect::<Vec<_>>(), ["name", "foo", "bar"]);
+
+        #[derive(Debug, PartialEq, Deserialize)]
+        struct Named {
+            name: String,
+        }
+        let named: Vec<Named> = from_slice(&bytes).unwrap();
+        assert_eq!(named.iter().map(|n| &n.name[..]).collect::<Vec<_>>(), ["foo", "foo", "bar"]);
+    }
+
+    #[test]
+    fn test_string_index_out_of_range() {
+        let mut bytes = encode(Value::Str("hello"));
+        let len = bytes.len();
+        bytes[len - 4..].copy_from_slice(&1u32.to_le_bytes());
+        let err = from_slice::<String>(&bytes).unwrap_err();
+        assert_eq!(err.to_string(), "Binary IR refers to string 1, but has only 1 strings");
+    }
+
+    #[test]
+    fn test_missing_magic() {
+        assert!(!is_binary_ir(b"{}"));
+        let err = from_slice::<Option<bool>>(b"{}").unwrap_err();
+        assert_eq!(err.to_string(), "Binary IR is missing the expected header");
+    }
+
+    #[test]
+    fn test_truncated() {
+        let mut bytes = encode(Value::Str("hello"));
+        bytes.pop();
+        let err = from_slice::<String>(&bytes).unwrap_err();
+        assert_eq!(err.to_string(), "Binary IR is truncated: expected 4 more bytes, found 3");
+    }
+
+    #[test]
+    fn test_trailing_bytes() {
+        let mut bytes = encode(Value::Bool(false));
+        bytes.push(TAG_NULL);
+        let err = from_slice::<bool>(&bytes).unwrap_err();
+        assert_eq!(err.to_string(), "Binary IR has 1 unexpected trailing bytes");
+    }
+}
@@ -0,0 +1,390 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/ir_cache.h"
+
+#include <algorithm>
+#include <memory>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "common/file_io.h"
+#include "common/status_macros.h"
+#include "rs_bindings_from_cc/cmdline.h"
+#include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/ir_from_cc.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/ErrorOr.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace crubit {
+
+namespace {
+
+// Bump this whenever the format of cache entries, or the set of inputs hashed
+// into the key, changes.
+constexpr absl::string_view kIrCacheFormatVersion = "4";
+
+// Accumulates a hash of a sequence of strings.
+class KeyHasher {
+ public:
+  void Add(absl::string_view value) {
+    // Length-prefix each value, so that different sequences of values can't
+    // hash the same by moving bytes from one value to the next.
+    hasher_.update(absl::StrCat(value.size(), ":"));
+    hasher_.update(llvm::StringRef(value.data(), value.size()));
+  }
+
+  absl::Status AddFileContents(absl::string_view path) {
+    CRUBIT_ASSIGN_OR_RETURN(std::string contents, GetFileContents(path));
+    Add(path);
+    Add(contents);
+    return absl::OkStatus();
+  }
+
+  std::string Finish() {
+    return llvm::toHex(hasher_.final(), /*LowerCase=*/true);
+  }
+
+ private:
+  llvm::SHA256 hasher_;
+};
+
+// Identifies the running `rs_bindings_from_cc` binary, so that a rebuilt tool
+// doesn't reuse outputs cached by an older version.
+absl::StatusOr<std::string> ExecutableIdentity() {
+  static int anchor;
+  std::string path =
+      llvm::sys::fs::getMainExecutable("rs_bindings_from_cc", &anchor);
+  llvm::sys::fs::file_status status;
+  if (std::error_code err = llvm::sys::fs::status(path, status)) {
+    return absl::InternalError(absl::StrCat(
+        "Could not determine the identity of `", path, "`: ", err.message()));
+  }
+  return absl::StrCat(
+      path, ":", status.getSize(), ":",
+      status.getLastModificationTime().time_since_epoch().count());
+}
+
+std::string CacheEntryPath(absl::string_view cache_dir, absl::string_view key,
+                           absl::string_view extension) {
+  llvm::SmallString<256> path(cache_dir);
+  llvm::sys::path::append(path, absl::StrCat(key, extension));
+  return std::string(path);
+}
+
+absl::Status WriteCacheFile(absl::string_view path,
+                            absl::string_view contents) {
+  // `writeToOutput` writes to a temporary file and renames it into place.
+  if (llvm::Error err = llvm::writeToOutput(path, [&](llvm::raw_ostream& os) {
+        os << contents;
+        return llvm::Error::success();
+      })) {
+    return absl::InternalError(absl::StrCat("Could not write IR cache entry `",
+                                            path, "`: ",
+                                            toString(std::move(err))));
+  }
+  return absl::OkStatus();
+}
+
+// Hashes the cmdline arguments that affect how bindings are generated from an
+// `IR`.
+absl::Status AddCodegenOptions(const Cmdline& cmdline, KeyHasher& hasher) {
+  hasher.Add(cmdline.crubit_support_path());
+  hasher.Add(cmdline.format_cc_in_process() ? "format_cc_in_process"
+                                            : cmdline.clang_format_exe_path());
+  hasher.Add(cmdline.rustfmt_exe_path());
+  hasher.Add(cmdline.rustfmt_config_path());
+  // The shards are `include!`d by file name.
+  for (const std::string& rs_out_shard : cmdline.rs_out_shards()) {
+    hasher.Add(llvm::sys::path::filename(rs_out_shard));
+  }
+  if (!cmdline.rustfmt_config_path().empty()) {
+    CRUBIT_RETURN_IF_ERROR(
+        hasher.AddFileContents(cmdline.rustfmt_config_path()));
+  }
+  hasher.Add(
+      absl::StrCat("format_mode:", static_cast<int>(cmdline.format_mode())));
+  hasher.Add(cmdline.generate_source_location_in_doc_comment() ==
+                     SourceLocationDocComment::Enabled
+                 ? "source_location_enabled"
+                 : "source_location_disabled");
+  hasher.Add(cmdline.layout_assertions() == LayoutAssertions::Consolidated
+                 ? "consolidated_layout_assertions"
+                 : "per_item_layout_assertions");
+  hasher.Add(cmdline.omit_thunk_free_rs_api_impl()
+                 ? "omit_thunk_free_rs_api_impl"
+                 : "");
+  hasher.Add(cmdline.collapse_opaque_fields() ? "collapse_opaque_fields" : "");
+  // Requesting an error report changes the contents of the other outputs.
+  hasher.Add(cmdline.error_report_out().empty() ? "" : "error_report");
+  // The size report is only generated when requested.
+  hasher.Add(cmdline.size_report_out().empty() ? "" : "size_report");
+  return absl::OkStatus();
+}
+
+}  // namespace
+
+bool fromJSON(const llvm::json::Value& json, CachedBindings& out,
+              llvm::json::Path path) {
+  llvm::json::ObjectMapper mapper(json, path);
+  return mapper && mapper.map("rs_api", out.rs_api) &&
+         mapper.map("rs_api_shards", out.rs_api_shards) &&
+         mapper.map("rs_api_impl", out.rs_api_impl) &&
+         mapper.map("error_report", out.error_report) &&
+         mapper.map("size_report", out.size_report) &&
+         mapper.map("used_dep_targets", out.used_dep_targets);
+}
+
+bool fromJSON(const llvm::json::Value& json, CachedOutputs& out,
+              llvm::json::Path path) {
+  llvm::json::ObjectMapper mapper(json, path);
+  return mapper && mapper.map("rs_api", out.rs_api) &&
+         mapper.map("rs_api_shards", out.rs_api_shards) &&
+         mapper.map("rs_api_impl", out.rs_api_impl) &&
+         mapper.map("ir_json", out.ir_json) &&
+         mapper.map("namespaces_json", out.namespaces_json) &&
+         mapper.map("instantiations_json", out.instantiations_json) &&
+         mapper.map("error_report", out.error_report) &&
+         mapper.map("size_report", out.size_report) &&
+         mapper.map("used_dep_targets", out.used_dep_targets);
+}
+
+absl::StatusOr<std::string> IrCacheKey(
+    const Cmdline& cmdline, absl::Span<const std::string> clang_args,
+    const absl::flat_hash_map<const HeaderName, const std::string>&
+        virtual_headers_contents_for_testing,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system) {
+  KeyHasher hasher;
+  hasher.Add(kIrCacheFormatVersion);
+  CRUBIT_ASSIGN_OR_RETURN(std::string executable, ExecutableIdentity());
+  hasher.Add(executable);
+
+  std::vector<absl::string_view> clang_args_view(clang_args.begin(),
+                                                 clang_args.end());
+  CRUBIT_ASSIGN_OR_RETURN(
+      std::string preprocessed_inputs,
+      HashPreprocessedInputs(
+          {.current_target = cmdline.current_target(),
+           .public_headers = cmdline.public_headers(),
+           .virtual_headers_contents_for_testing =
+               virtual_headers_contents_for_testing,
+           .clang_args = clang_args_view,
+           .dependency_modules = cmdline.dependency_modules(),
+           .file_system = std::move(file_system)}));
+  hasher.Add(preprocessed_inputs);
+  // Headers imported from dependency modules are not seen by the
+  // preprocessor, so hash the modules themselves.
+  for (const std::string& module_file : cmdline.dependency_modules()) {
+    CRUBIT_RETURN_IF_ERROR(hasher.AddFileContents(module_file));
+  }
+
+  hasher.Add(cmdline.current_target().value());
+  for (const HeaderName& header : cmdline.public_headers()) {
+    hasher.Add(header.IncludePath());
+  }
+
+  // Hash maps iterate in an unspecified order, so sort their entries first.
+  std::vector<std::pair<absl::string_view, absl::string_view>>
+      headers_to_targets;
+  for (const auto& [header, target] : cmdline.headers_to_targets()) {
+    headers_to_targets.push_back({header.IncludePath(), target.value()});
+  }
+  std::sort(headers_to_targets.begin(), headers_to_targets.end());
+  for (const auto& [header, target] : headers_to_targets) {
+    hasher.Add(header);
+    hasher.Add(target);
+  }
+  std::vector<std::pair<absl::string_view, absl::string_view>>
+      instantiations_to_targets;
+  for (const auto& [instantiation, target] :
+       cmdline.instantiations_to_targets()) {
+    instantiations_to_targets.push_back({instantiation, target.value()});
+  }
+  std::sort(instantiations_to_targets.begin(),
+            instantiations_to_targets.end());
+  for (const auto& [instantiation, target] : instantiations_to_targets) {
+    hasher.Add(instantiation);
+    hasher.Add(target);
+  }
+  hasher.Add(cmdline.lazy_dependency_imports() ? "lazy" : "eager");
+  hasher.Add(cmdline.infer_nullability() ? "infer_nullability" : "");
+  hasher.Add(cmdline.infer_lifetimes() ? "infer_lifetimes" : "");
+  hasher.Add(absl::StrCat(cmdline.max_template_instantiations(), "/",
+                          cmdline.max_template_instantiation_depth()));
+  if (!cmdline.nullability_inference_table().empty()) {
+    CRUBIT_RETURN_IF_ERROR(
+        hasher.AddFileContents(cmdline.nullability_inference_table()));
+  }
+  if (!cmdline.lifetime_summaries().empty()) {
+    CRUBIT_RETURN_IF_ERROR(
+        hasher.AddFileContents(cmdline.lifetime_summaries()));
+  }
+  std::vector<std::string> target_features;
+  for (const auto& [target, features] : cmdline.target_to_features()) {
+    for (const std::string& feature : features) {
+      target_features.push_back(absl::StrCat(target.value(), ":", feature));
+    }
+  }
+  std::sort(target_features.begin(), target_features.end());
+  for (const std::string& target_feature : target_features) {
+    hasher.Add(target_feature);
+  }
+
+  // The contents of `extra_rs_srcs` are only included by the generated code,
+  // so their paths are enough. `srcs_to_scan_for_instantiations` and
+  // `srcs_to_scan_for_used_names` are read by the tool itself.
+  for (const std::string& extra_rs_src : cmdline.extra_rs_srcs()) {
+    hasher.Add(extra_rs_src);
+  }
+  for (const std::string& src : cmdline.srcs_to_scan_for_instantiations()) {
+    CRUBIT_RETURN_IF_ERROR(hasher.AddFileContents(src));
+  }
+  // Scanning for used names prunes the IR, even if no names are used.
+  hasher.Add(absl::StrCat("srcs_to_scan_for_used_names:",
+                          cmdline.srcs_to_scan_for_used_names().size()));
+  for (const std::string& src : cmdline.srcs_to_scan_for_used_names()) {
+    CRUBIT_RETURN_IF_ERROR(hasher.AddFileContents(src));
+  }
+
+  CRUBIT_RETURN_IF_ERROR(AddCodegenOptions(cmdline, hasher));
+  // These outputs being requested changes the contents of other outputs.
+  hasher.Add(cmdline.instantiations_out().empty() ? "" : "instantiations");
+  hasher.Add(cmdline.module_out());
+  return hasher.Finish();
+}
+
+absl::StatusOr<std::optional<CachedOutputs>> ReadFromIrCache(
+    absl::string_view cache_dir, absl::string_view key) {
+  std::string path = CacheEntryPath(cache_dir, key, ".json");
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (std::error_code err = buffer.getError()) {
+    if (err == std::errc::no_such_file_or_directory) {
+      return std::nullopt;
+    }
+    return absl::InternalError(absl::StrCat(
+        "Could not read IR cache entry `", path, "`: ", err.message()));
+  }
+  llvm::Expected<CachedOutputs> outputs =
+      llvm::json::parse<CachedOutputs>((*buffer)->getBuffer());
+  if (llvm::Error err = outputs.takeError()) {
+    return absl::InternalError(absl::StrCat("Malformed IR cache entry `", path,
+                                            "`: ", toString(std::move(err))));
+  }
+  std::string module_path = CacheEntryPath(cache_dir, key, ".pcm");
+  if (llvm::sys::fs::exists(module_path)) {
+    CRUBIT_ASSIGN_OR_RETURN(outputs->module, GetFileContents(module_path));
+  }
+  return *std::move(outputs);
+}
+
+absl::Status WriteToIrCache(absl::string_view cache_dir, absl::string_view key,
+                            const CachedOutputs& outputs) {
+  if (std::error_code err = llvm::sys::fs::create_directories(cache_dir)) {
+    return absl::InternalError(
+        absl::StrCat("Could not create IR cache directory `", cache_dir,
+                     "`: ", err.message()));
+  }
+  llvm::json::Object entry{
+      {"rs_api", outputs.rs_api},
+      {"rs_api_shards", llvm::json::Array(outputs.rs_api_shards.begin(),
+                                          outputs.rs_api_shards.end())},
+      {"rs_api_impl", outputs.rs_api_impl},
+      {"ir_json", outputs.ir_json},
+      {"namespaces_json", outputs.namespaces_json},
+      {"instantiations_json", outputs.instantiations_json},
+      {"error_report", outputs.error_report},
+      {"size_report", outputs.size_report},
+      {"used_dep_targets", llvm::json::Array(outputs.used_dep_targets.begin(),
+                                             outputs.used_dep_targets.end())},
+  };
+  // The module is binary, so it gets a file of its own. It is written first,
+  // so that whenever the JSON file exists, so does the module.
+  if (!outputs.module.empty()) {
+    CRUBIT_RETURN_IF_ERROR(WriteCacheFile(
+        CacheEntryPath(cache_dir, key, ".pcm"), outputs.module));
+  }
+  return WriteCacheFile(
+      CacheEntryPath(cache_dir, key, ".json"),
+      llvm::formatv("{0}", llvm::json::Value(std::move(entry))).str());
+}
+
+absl::StatusOr<std::string> BindingsCacheKey(const Cmdline& cmdline,
+                                             absl::string_view binary_ir) {
+  KeyHasher hasher;
+  hasher.Add(kIrCacheFormatVersion);
+  CRUBIT_ASSIGN_OR_RETURN(std::string executable, ExecutableIdentity());
+  hasher.Add(executable);
+  hasher.Add(binary_ir);
+  CRUBIT_RETURN_IF_ERROR(AddCodegenOptions(cmdline, hasher));
+  return hasher.Finish();
+}
+
+absl::StatusOr<std::optional<CachedBindings>> ReadBindingsFromCache(
+    absl::string_view cache_dir, absl::string_view key) {
+  std::string path = CacheEntryPath(cache_dir, key, ".bindings.json");
+  llvm::ErrorOr<std::unique_ptr<llvm::MemoryBuffer>> buffer =
+      llvm::MemoryBuffer::getFile(path, /*IsText=*/true);
+  if (std::error_code err = buffer.getError()) {
+    if (err == std::errc::no_such_file_or_directory) {
+      return std::nullopt;
+    }
+    return absl::InternalError(absl::StrCat(
+        "Could not read bindings cache entry `", path, "`: ", err.message()));
+  }
+  llvm::Expected<CachedBindings> bindings =
+      llvm::json::parse<CachedBindings>((*buffer)->getBuffer());
+  if (llvm::Error err = bindings.takeError()) {
+    return absl::InternalError(absl::StrCat("Malformed bindings cache entry `",
+                                            path, "`: ",
+                                            toString(std::move(err))));
+  }
+  return *std::move(bindings);
+}
+
+absl::Status WriteBindingsToCache(absl::string_view cache_dir,
+                                  absl::string_view key,
+                                  const CachedBindings& bindings) {
+  if (std::error_code err = llvm::sys::fs::create_directories(cache_dir)) {
+    return absl::InternalError(
+        absl::StrCat("Could not create IR cache directory `", cache_dir,
+                     "`: ", err.message()));
+  }
+  llvm::json::Object entry{
+      {"rs_api", bindings.rs_api},
+      {"rs_api_shards", llvm::json::Array(bindings.rs_api_shards.begin(),
+                                          bindings.rs_api_shards.end())},
+      {"rs_api_impl", bindings.rs_api_impl},
+      {"error_report", bindings.error_report},
+      {"size_report", bindings.size_report},
+      {"used_dep_targets",
+       llvm::json::Array(bindings.used_dep_targets.begin(),
+                         bindings.used_dep_targets.end())},
+  };
+  return WriteCacheFile(
+      CacheEntryPath(cache_dir, key, ".bindings.json"),
+      llvm::formatv("{0}", llvm::json::Value(std::move(entry))).str());
+}
+
+}  // namespace crubit
@@ -0,0 +1,99 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_IR_CACHE_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_IR_CACHE_H_
+
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "rs_bindings_from_cc/cmdline.h"
+#include "rs_bindings_from_cc/ir.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/VirtualFileSystem.h"
+
+namespace crubit {
+
+// The contents of all output files of an `rs_bindings_from_cc` invocation, as
+// stored in the `--ir_cache_dir`.
+struct CachedOutputs {
+  std::string rs_api;
+  std::vector<std::string> rs_api_shards;
+  std::string rs_api_impl;
+  std::string ir_json;
+  std::string namespaces_json;
+  std::string instantiations_json;
+  std::string error_report;
+  std::string size_report;
+  std::vector<std::string> used_dep_targets;
+  std::string module;
+};
+
+// Returns the key under which the outputs of the invocation described by
+// `cmdline` and `clang_args` are cached.
+//
+// The key is a hash of the preprocessed public headers (see
+// `HashPreprocessedInputs`), the Clang args, all cmdline arguments that affect
+// the outputs, the contents of the files they refer to, and the identity (size
+// and modification time) of the running executable.
+//
+// The headers are read from `file_system`, if it is non-null, as in
+// `IrFromCcOptions::file_system`.
+absl::StatusOr<std::string> IrCacheKey(
+    const Cmdline& cmdline, absl::Span<const std::string> clang_args,
+    const absl::flat_hash_map<const HeaderName, const std::string>&
+        virtual_headers_contents_for_testing = {},
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system = nullptr);
+
+// Returns the outputs cached in `cache_dir` under `key`, or `std::nullopt` if
+// there are none.
+absl::StatusOr<std::optional<CachedOutputs>> ReadFromIrCache(
+    absl::string_view cache_dir, absl::string_view key);
+
+// Stores `outputs` in `cache_dir` under `key`, creating `cache_dir` if needed.
+//
+// The entry is written to a temporary file and then renamed, so that
+// concurrent invocations never observe a partially written entry.
+absl::Status WriteToIrCache(absl::string_view cache_dir, absl::string_view key,
+                            const CachedOutputs& outputs);
+
+// The bindings generated from an `IR`, as stored in the `--ir_cache_dir`.
+struct CachedBindings {
+  std::string rs_api;
+  std::vector<std::string> rs_api_shards;
+  std::string rs_api_impl;
+  std::string error_report;
+  std::string size_report;
+  std::vector<std::string> used_dep_targets;
+};
+
+// Returns the key under which the bindings generated from `binary_ir`, an IR
+// serialized by `IrToBinary`, are cached.
+//
+// Unlike `IrCacheKey`, this key only depends on the IR and on the cmdline
+// arguments that affect code generation. Header changes that don't affect the
+// IR (e.g. changes to the bodies of inline functions) therefore still hit this
+// cache, even though they miss the `IrCacheKey` one.
+absl::StatusOr<std::string> BindingsCacheKey(const Cmdline& cmdline,
+                                             absl::string_view binary_ir);
+
+// Returns the bindings cached in `cache_dir` under `key`, or `std::nullopt` if
+// there are none.
+absl::StatusOr<std::optional<CachedBindings>> ReadBindingsFromCache(
+    absl::string_view cache_dir, absl::string_view key);
+
+// Stores `bindings` in `cache_dir` under `key`, creating `cache_dir` if needed.
+absl::Status WriteBindingsToCache(absl::string_view cache_dir,
+                                  absl::string_view key,
+                                  const CachedBindings& bindings);
+
+}  // namespace crubit
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_IR_CACHE_H_
@@ -0,0 +1,131 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/ir_cache.h"
+
+#include <optional>
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+#include "common/status_test_matchers.h"
+#include "common/test_utils.h"
+#include "rs_bindings_from_cc/cmdline.h"
+#include "rs_bindings_from_cc/ir.h"
+
+namespace crubit {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Eq;
+using ::testing::Ne;
+
+absl::StatusOr<Cmdline> TestCmdline() {
+  return Cmdline::CreateForTesting(
+      "//:target", "cc_out", "rs_out", "ir_out", "namespaces_out",
+      "crubit_support_path", "clang_format_exe_path", "rustfmt_exe_path",
+      /* rustfmt_config_path= */ "",
+      /* do_nothing= */ false,
+      /* public_headers= */ {"a.h"}, R"([{"t": "//:target", "h": ["a.h"]}])",
+      /* extra_rs_srcs= */ {},
+      /* srcs_to_scan_for_instantiations= */ {},
+      /* instantiations_out= */ "",
+      /* error_report_out= */ "", SourceLocationDocComment::Enabled,
+      /* ir_cache_dir= */ "cache");
+}
+
+TEST(IrCacheTest, RoundTrip) {
+  std::string cache_dir = absl::StrCat(testing::TempDir(), "/round_trip");
+  ASSERT_OK(WriteToIrCache(cache_dir, "key",
+                           {.rs_api = "rs_api",
+                            .rs_api_impl = "rs_api_impl",
+                            .ir_json = "{}",
+                            .namespaces_json = "[]",
+                            .instantiations_json = "{}",
+                            .error_report = "report"}));
+
+  ASSERT_OK_AND_ASSIGN(std::optional<CachedOutputs> outputs,
+                       ReadFromIrCache(cache_dir, "key"));
+  ASSERT_TRUE(outputs.has_value());
+  EXPECT_EQ(outputs->rs_api, "rs_api");
+  EXPECT_EQ(outputs->rs_api_impl, "rs_api_impl");
+  EXPECT_EQ(outputs->ir_json, "{}");
+  EXPECT_EQ(outputs->namespaces_json, "[]");
+  EXPECT_EQ(outputs->instantiations_json, "{}");
+  EXPECT_EQ(outputs->error_report, "report");
+}
+
+TEST(IrCacheTest, MissingEntry) {
+  std::string cache_dir = absl::StrCat(testing::TempDir(), "/missing_entry");
+  ASSERT_OK(WriteToIrCache(cache_dir, "key", {}));
+  ASSERT_OK_AND_ASSIGN(std::optional<CachedOutputs> outputs,
+                       ReadFromIrCache(cache_dir, "other_key"));
+  EXPECT_FALSE(outputs.has_value());
+}
+
+TEST(IrCacheTest, KeyDependsOnIncludedHeaders) {
+  ASSERT_OK_AND_ASSIGN(Cmdline cmdline, TestCmdline());
+  WriteFileForCurrentTest("a.h", "#include \"b.h\"\n");
+  WriteFileForCurrentTest("b.h", "struct S {};");
+  ASSERT_OK_AND_ASSIGN(std::string key,
+                       IrCacheKey(cmdline, DefaultClangArgs()));
+  EXPECT_THAT(IrCacheKey(cmdline, DefaultClangArgs()), IsOkAndHolds(Eq(key)));
+
+  WriteFileForCurrentTest("b.h", "struct S { int x; };");
+  EXPECT_THAT(IrCacheKey(cmdline, DefaultClangArgs()), IsOkAndHolds(Ne(key)));
+}
+
+TEST(IrCacheTest, KeyDependsOnClangArgs) {
+  ASSERT_OK_AND_ASSIGN(Cmdline cmdline, TestCmdline());
+  WriteFileForCurrentTest("a.h", "struct S {};");
+  ASSERT_OK_AND_ASSIGN(std::string key,
+                       IrCacheKey(cmdline, DefaultClangArgs()));
+
+  std::vector<std::string> clang_args = DefaultClangArgs();
+  clang_args.push_back("-DFOO");
+  EXPECT_THAT(IrCacheKey(cmdline, clang_args), IsOkAndHolds(Ne(key)));
+}
+
+TEST(IrCacheTest, BindingsRoundTrip) {
+  std::string cache_dir = absl::StrCat(testing::TempDir(), "/bindings");
+  ASSERT_OK(WriteBindingsToCache(cache_dir, "key",
+                                 {.rs_api = "rs_api",
+                                  .rs_api_shards = {"shard_0", "shard_1"},
+                                  .rs_api_impl = "rs_api_impl",
+                                  .error_report = "report"}));
+
+  ASSERT_OK_AND_ASSIGN(std::optional<CachedBindings> bindings,
+                       ReadBindingsFromCache(cache_dir, "key"));
+  ASSERT_TRUE(bindings.has_value());
+  EXPECT_EQ(bindings->rs_api, "rs_api");
+  EXPECT_THAT(bindings->rs_api_shards, ElementsAre("shard_0", "shard_1"));
+  EXPECT_EQ(bindings->rs_api_impl, "rs_api_impl");
+  EXPECT_EQ(bindings->error_report, "report");
+
+  // Bindings and full outputs are cached in separate entries.
+  ASSERT_OK_AND_ASSIGN(std::optional<CachedOutputs> outputs,
+                       ReadFromIrCache(cache_dir, "key"));
+  EXPECT_FALSE(outputs.has_value());
+}
+
+TEST(IrCacheTest, BindingsKeyDependsOnIr) {
+  ASSERT_OK_AND_ASSIGN(Cmdline cmdline, TestCmdline());
+  IR ir;
+  ir.current_target = BazelLabel("//:target");
+  ir.items.push_back(Comment{.text = "comment", .id = ItemId(1)});
+  ASSERT_OK_AND_ASSIGN(std::string key,
+                       BindingsCacheKey(cmdline, IrToBinary(ir)));
+  EXPECT_THAT(BindingsCacheKey(cmdline, IrToBinary(ir)),
+              IsOkAndHolds(Eq(key)));
+
+  std::get<Comment>(ir.items[0]).text = "other comment";
+  EXPECT_THAT(BindingsCacheKey(cmdline, IrToBinary(ir)),
+              IsOkAndHolds(Ne(key)));
+}
+
+}  // namespace
+}  // namespace crubit
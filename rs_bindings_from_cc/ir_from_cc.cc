@@ -4,9 +4,13 @@
 
 #include "rs_bindings_from_cc/ir_from_cc.h"
 
+#include <algorithm>
 #include <cstdint>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <string>
+#include <system_error>
 #include <utility>
 #include <vector>
 
@@ -14,16 +18,37 @@
 #include "absl/log/check.h"
 #include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/ascii.h"
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/strings/substitute.h"
 #include "absl/types/span.h"
+#include "common/status_macros.h"
 #include "rs_bindings_from_cc/bazel_types.h"
 #include "rs_bindings_from_cc/decl_importer.h"
 #include "rs_bindings_from_cc/frontend_action.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
+#include "clang/Basic/SourceLocation.h"
+#include "clang/Basic/SourceManager.h"
+#include "clang/Frontend/CompilerInstance.h"
+#include "clang/Frontend/FrontendActions.h"
+#include "clang/Lex/PPCallbacks.h"
+#include "clang/Lex/Preprocessor.h"
 #include "clang/Serialization/PCHContainerOperations.h"
 #include "clang/Tooling/Tooling.h"
+#include "llvm/ADT/SmallString.h"
+#include "llvm/ADT/SmallVector.h"
+#include "llvm/ADT/StringExtras.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/FileSystem.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/MemoryBuffer.h"
+#include "llvm/Support/Path.h"
+#include "llvm/Support/SHA256.h"
+#include "llvm/Support/VirtualFileSystem.h"
+#include "llvm/Support/raw_ostream.h"
 
 namespace crubit {
 
@@ -31,69 +56,367 @@ static constexpr absl::string_view kVirtualHeaderPath =
     "ir_from_cc_virtual_header.h";
 static constexpr absl::string_view kVirtualInputPath =
     "ir_from_cc_virtual_input.cc";
+static constexpr absl::string_view kVirtualModuleMapPath =
+    "ir_from_cc_virtual_module.modulemap";
+static constexpr absl::string_view kVirtualInstantiationsHeaderPath =
+    "ir_from_cc_virtual_instantiations.h";
 
-absl::StatusOr<IR> IrFromCc(IrFromCcOptions options) {
-  // Caller should verify that the inputs are not empty.
-  CHECK(!options.extra_source_code_for_testing.empty() ||
-        !options.public_headers.empty() ||
-        !options.extra_instantiations.empty());
+namespace {
 
+// The input file, arguments and virtual files `IrFromCc` runs Clang with.
+struct ClangInputs {
+  std::vector<HeaderName> public_headers;
+  std::string virtual_input_file_content;
+  std::vector<std::string> args;
   clang::tooling::FileContentMappings file_contents;
+  // If set, computes the contents of `kVirtualInstantiationsHeaderPath`. It is
+  // only called once Clang looks the header up.
+  std::function<std::string()> deferred_instantiations_header;
+};
 
+// Returns code which instantiates the class template specializations
+// `instantiations`.
+std::string InstantiationsSource(absl::Span<const std::string> instantiations) {
+  std::string source;
+  absl::SubstituteAndAppend(&source, "namespace $0 {\n",
+                            kInstantiationsNamespaceName);
+  int counter = 0;
+  for (const std::string& instantiation : instantiations) {
+    absl::SubstituteAndAppend(&source,
+                              "using __cc_template_instantiation_$0 = $1;\n",
+                              counter++, instantiation);
+  }
+  absl::SubstituteAndAppend(&source, "}  // namespace $0\n",
+                            kInstantiationsNamespaceName);
+  return source;
+}
+
+ClangInputs GetClangInputs(const IrFromCcOptions& options) {
+  ClangInputs inputs;
   for (auto const& name_and_content :
        options.virtual_headers_contents_for_testing) {
-    file_contents.push_back({std::string(name_and_content.first.IncludePath()),
-                             name_and_content.second});
+    inputs.file_contents.push_back(
+        {std::string(name_and_content.first.IncludePath()),
+         name_and_content.second});
   }
 
   // Tests may inject `extra_source_code_for_testing` - it needs to be appended
   // to `public_headers` and exposed via `file_contents` virtual file system.
-  std::vector<HeaderName> augmented_public_headers(
-      options.public_headers.begin(), options.public_headers.end());
+  inputs.public_headers.assign(options.public_headers.begin(),
+                               options.public_headers.end());
   if (!options.extra_source_code_for_testing.empty()) {
-    file_contents.push_back(
+    inputs.file_contents.push_back(
         {std::string(kVirtualHeaderPath),
          std::string(options.extra_source_code_for_testing)});
-    HeaderName header_name = HeaderName(std::string(kVirtualHeaderPath));
-    augmented_public_headers.push_back(header_name);
-    options.headers_to_targets.insert({header_name, options.current_target});
+    inputs.public_headers.push_back(
+        HeaderName(std::string(kVirtualHeaderPath)));
   }
 
-  std::string virtual_input_file_content;
-  for (const HeaderName& header_name : augmented_public_headers) {
-    absl::SubstituteAndAppend(&virtual_input_file_content, "#include \"$0\"\n",
-                              header_name.IncludePath());
-  }
-  if (!options.extra_instantiations.empty()) {
-    absl::SubstituteAndAppend(&virtual_input_file_content, "namespace $0 {\n",
-                              kInstantiationsNamespaceName);
-    int counter = 0;
-    for (const std::string& extra_instantiation :
-         options.extra_instantiations) {
-      absl::SubstituteAndAppend(&virtual_input_file_content,
-                                "using __cc_template_instantiation_$0 = $1;\n",
-                                counter++, extra_instantiation);
+  for (const HeaderName& header_name : inputs.public_headers) {
+    absl::SubstituteAndAppend(&inputs.virtual_input_file_content,
+                              "#include \"$0\"\n", header_name.IncludePath());
+  }
+  if (options.deferred_extra_instantiations.valid()) {
+    absl::SubstituteAndAppend(&inputs.virtual_input_file_content,
+                              "#include \"$0\"\n",
+                              kVirtualInstantiationsHeaderPath);
+    inputs.deferred_instantiations_header = [&options] {
+      std::vector<std::string> instantiations(
+          options.extra_instantiations.begin(),
+          options.extra_instantiations.end());
+      {
+        // Only measures the time spent waiting, not the whole computation.
+        TimingReport::Phase phase(options.timing_report,
+                                  "collect_instantiations");
+        const absl::StatusOr<std::vector<std::string>>& deferred =
+            options.deferred_extra_instantiations.get();
+        // Errors are reported by `IrFromCc` once Clang is done.
+        if (deferred.ok()) {
+          instantiations.insert(instantiations.end(), deferred->begin(),
+                                deferred->end());
+        }
+      }
+      return InstantiationsSource(instantiations);
+    };
+  } else if (!options.extra_instantiations.empty()) {
+    absl::StrAppend(&inputs.virtual_input_file_content,
+                    InstantiationsSource(options.extra_instantiations));
+  }
+  inputs.args = {"-std=gnu++17",
+                 // Parse non-doc comments that are used as documentation
+                 "-fparse-all-comments"};
+  inputs.args.insert(inputs.args.end(), options.clang_args.begin(),
+                     options.clang_args.end());
+  if (!options.dependency_modules.empty()) {
+    // Headers belonging to a dependency module are imported from it instead
+    // of being parsed again.
+    inputs.args.insert(inputs.args.end(),
+                       {"-fmodules", "-fno-implicit-modules",
+                        "-fno-implicit-module-maps"});
+    for (const std::string& module_file : options.dependency_modules) {
+      inputs.args.push_back(absl::StrCat("-fmodule-file=", module_file));
     }
-    absl::SubstituteAndAppend(&virtual_input_file_content,
-                              "}  // namespace $0\n",
-                              kInstantiationsNamespaceName);
-  }
-  std::vector<std::string> args_as_strings = {
-      "-std=gnu++17",
-      // Parse non-doc comments that are used as documentation
-      "-fparse-all-comments"};
-  args_as_strings.insert(args_as_strings.end(), options.clang_args.begin(),
-                         options.clang_args.end());
-
-  Invocation invocation(options.current_target, augmented_public_headers,
-                        options.headers_to_targets);
-  if (!clang::tooling::runToolOnCodeWithArgs(
-          std::make_unique<FrontendAction>(invocation),
-          virtual_input_file_content, args_as_strings, kVirtualInputPath,
-          "rs_bindings_from_cc",
-          std::make_shared<clang::PCHContainerOperations>(), file_contents)) {
+  }
+  return inputs;
+}
+
+// Adds a file to an `InMemoryFileSystem` the first time it is looked up, so
+// that computing its contents can overlap with parsing the files included
+// before it.
+class DeferredFileSystem : public llvm::vfs::ProxyFileSystem {
+ public:
+  DeferredFileSystem(
+      llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system,
+      llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>
+          in_memory_file_system,
+      absl::string_view file_name, std::function<std::string()> get_contents)
+      : ProxyFileSystem(std::move(file_system)),
+        in_memory_file_system_(std::move(in_memory_file_system)),
+        file_name_(file_name),
+        get_contents_(std::move(get_contents)) {}
+
+  llvm::ErrorOr<llvm::vfs::Status> status(const llvm::Twine& path) override {
+    AddFileIfLookedUp(path);
+    return ProxyFileSystem::status(path);
+  }
+
+  bool exists(const llvm::Twine& path) override {
+    AddFileIfLookedUp(path);
+    return ProxyFileSystem::exists(path);
+  }
+
+  llvm::ErrorOr<std::unique_ptr<llvm::vfs::File>> openFileForRead(
+      const llvm::Twine& path) override {
+    AddFileIfLookedUp(path);
+    return ProxyFileSystem::openFileForRead(path);
+  }
+
+ private:
+  void AddFileIfLookedUp(const llvm::Twine& path) {
+    if (get_contents_ == nullptr) return;
+    llvm::SmallString<256> storage;
+    if (llvm::sys::path::filename(path.toStringRef(storage)) != file_name_) {
+      return;
+    }
+    in_memory_file_system_->addFile(
+        file_name_, 0, llvm::MemoryBuffer::getMemBufferCopy(get_contents_()));
+    get_contents_ = nullptr;
+  }
+
+  llvm::IntrusiveRefCntPtr<llvm::vfs::InMemoryFileSystem>
+      in_memory_file_system_;
+  std::string file_name_;
+  std::function<std::string()> get_contents_;
+};
+
+// Runs `action` on `code`, as a file named `file_name`, with the args and
+// virtual files of `inputs` overlaid on `file_system` (or on the real file
+// system, if it is null).
+bool RunClang(std::unique_ptr<clang::FrontendAction> action,
+              const std::string& code, absl::string_view file_name,
+              const ClangInputs& inputs,
+              llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system) {
+  if (file_system == nullptr) file_system = llvm::vfs::getRealFileSystem();
+  auto overlay_file_system =
+      llvm::makeIntrusiveRefCnt<llvm::vfs::OverlayFileSystem>(
+          std::move(file_system));
+  auto in_memory_file_system =
+      llvm::makeIntrusiveRefCnt<llvm::vfs::InMemoryFileSystem>();
+  overlay_file_system->pushOverlay(in_memory_file_system);
+  in_memory_file_system->addFile(file_name, 0,
+                                 llvm::MemoryBuffer::getMemBuffer(code));
+  for (const auto& [name, contents] : inputs.file_contents) {
+    in_memory_file_system->addFile(name, 0,
+                                   llvm::MemoryBuffer::getMemBuffer(contents));
+  }
+  llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> clang_file_system =
+      std::move(overlay_file_system);
+  if (inputs.deferred_instantiations_header != nullptr) {
+    clang_file_system = llvm::makeIntrusiveRefCnt<DeferredFileSystem>(
+        std::move(clang_file_system), std::move(in_memory_file_system),
+        kVirtualInstantiationsHeaderPath,
+        inputs.deferred_instantiations_header);
+  }
+  return clang::tooling::runToolOnCodeWithArgs(
+      std::move(action), code, std::move(clang_file_system), inputs.args,
+      file_name, "rs_bindings_from_cc",
+      std::make_shared<clang::PCHContainerOperations>());
+}
+
+// Builds a Clang module from a module map into `module_contents`.
+class ModuleWritingAction : public clang::GenerateModuleFromModuleMapAction {
+ public:
+  ModuleWritingAction(absl::string_view module_path,
+                      llvm::SmallVectorImpl<char>& module_contents)
+      : module_path_(module_path), module_contents_(module_contents) {}
+
+ private:
+  bool BeginInvocation(clang::CompilerInstance& instance) override {
+    // The output file name is recorded in the module, even though the module
+    // is written to `module_contents_`.
+    instance.getFrontendOpts().OutputFile = module_path_;
+    return clang::GenerateModuleFromModuleMapAction::BeginInvocation(instance);
+  }
+
+  std::unique_ptr<llvm::raw_pwrite_stream> CreateOutputFile(
+      clang::CompilerInstance& instance, llvm::StringRef in_file) override {
+    return std::make_unique<llvm::raw_svector_ostream>(module_contents_);
+  }
+
+  std::string module_path_;
+  llvm::SmallVectorImpl<char>& module_contents_;
+};
+
+// Feeds the name and contents of every file the preprocessor enters into
+// `hasher`.
+class InputHashingCallbacks : public clang::PPCallbacks {
+ public:
+  InputHashingCallbacks(const clang::SourceManager& source_manager,
+                        llvm::SHA256& hasher)
+      : source_manager_(source_manager), hasher_(hasher) {}
+
+  void FileChanged(clang::SourceLocation loc, FileChangeReason reason,
+                   clang::SrcMgr::CharacteristicKind file_type,
+                   clang::FileID prev_file_id) override {
+    if (reason != EnterFile) return;
+    clang::FileID file_id = source_manager_.getFileID(loc);
+    std::optional<llvm::StringRef> contents =
+        source_manager_.getBufferDataOrNone(file_id);
+    if (!contents.has_value()) return;
+    llvm::StringRef name = source_manager_.getBufferName(loc);
+    // Length-prefix both strings, so that different files can't hash the same
+    // by moving bytes between the name and the contents.
+    hasher_.update(absl::StrCat(name.size(), ":"));
+    hasher_.update(name);
+    hasher_.update(absl::StrCat(contents->size(), ":"));
+    hasher_.update(*contents);
+  }
+
+ private:
+  const clang::SourceManager& source_manager_;
+  llvm::SHA256& hasher_;
+};
+
+class InputHashingAction : public clang::PreprocessOnlyAction {
+ public:
+  explicit InputHashingAction(llvm::SHA256& hasher) : hasher_(hasher) {}
+
+  bool BeginSourceFileAction(clang::CompilerInstance& instance) override {
+    instance.getPreprocessor().addPPCallbacks(
+        std::make_unique<InputHashingCallbacks>(instance.getSourceManager(),
+                                                hasher_));
+    return true;
+  }
+
+ private:
+  llvm::SHA256& hasher_;
+};
+
+}  // namespace
+
+absl::StatusOr<std::string> HashPreprocessedInputs(
+    const IrFromCcOptions& options) {
+  ClangInputs inputs = GetClangInputs(options);
+  llvm::SHA256 hasher;
+  for (const std::string& arg : inputs.args) {
+    hasher.update(absl::StrCat(arg.size(), ":"));
+    hasher.update(arg);
+  }
+  if (!RunClang(std::make_unique<InputHashingAction>(hasher),
+                inputs.virtual_input_file_content, kVirtualInputPath, inputs,
+                options.file_system)) {
     return absl::Status(absl::StatusCode::kInvalidArgument,
-                        "Could not compile header contents");
+                        "Could not preprocess header contents");
+  }
+  return llvm::toHex(hasher.final(), /*LowerCase=*/true);
+}
+
+std::string ModuleNameForTarget(const BazelLabel& target) {
+  std::string module_name = absl::StrCat("crubit_", target.value());
+  for (char& c : module_name) {
+    if (!absl::ascii_isalnum(c)) c = '_';
+  }
+  return module_name;
+}
+
+absl::StatusOr<std::string> ModuleFromCc(const IrFromCcOptions& options,
+                                         absl::string_view module_path) {
+  ClangInputs inputs = GetClangInputs(options);
+  std::string module_map = absl::Substitute(
+      "module $0 {\n", ModuleNameForTarget(options.current_target));
+  for (const HeaderName& header_name : inputs.public_headers) {
+    // Paths in a module map are relative to the module map itself, which is a
+    // virtual file.
+    llvm::SmallString<256> path(header_name.IncludePath());
+    if (std::error_code err = llvm::sys::fs::make_absolute(path)) {
+      return absl::InternalError(absl::StrCat("Could not make `", path.str(),
+                                              "` absolute: ", err.message()));
+    }
+    absl::SubstituteAndAppend(&module_map, "  header \"$0\"\n", path.str());
+  }
+  absl::StrAppend(&module_map, "  export *\n}\n");
+
+  inputs.args.insert(inputs.args.end(),
+                     {"-fmodules", "-fno-implicit-modules",
+                      "-fno-implicit-module-maps",
+                      absl::StrCat("-fmodule-name=",
+                                   ModuleNameForTarget(options.current_target)),
+                      "-Xclang", "-emit-module",
+                      // Keep the module independent of header timestamps,
+                      // which are not stable across Bazel sandboxes.
+                      "-Xclang", "-fno-pch-timestamp"});
+  llvm::SmallString<0> module_contents;
+  if (!RunClang(
+          std::make_unique<ModuleWritingAction>(module_path, module_contents),
+          module_map, kVirtualModuleMapPath, inputs, options.file_system)) {
+    return absl::Status(absl::StatusCode::kInvalidArgument,
+                        "Could not build a module from header contents");
+  }
+  return std::string(module_contents.str());
+}
+
+absl::StatusOr<IR> IrFromCc(IrFromCcOptions options) {
+  // Caller should verify that the inputs are not empty.
+  CHECK(!options.extra_source_code_for_testing.empty() ||
+        !options.public_headers.empty() ||
+        !options.extra_instantiations.empty() ||
+        options.deferred_extra_instantiations.valid());
+  CHECK(!options.infer_nullability ||
+        options.nullability_inferences == nullptr);
+
+  ClangInputs inputs = GetClangInputs(options);
+  if (!options.extra_source_code_for_testing.empty()) {
+    options.headers_to_targets.insert(
+        {HeaderName(std::string(kVirtualHeaderPath)), options.current_target});
+  }
+
+  Invocation invocation(options.current_target, inputs.public_headers,
+                        options.headers_to_targets);
+  invocation.timing_report_ = options.timing_report;
+  invocation.trace_ = options.trace;
+  invocation.instantiation_targets_ = &options.instantiations_to_targets;
+  invocation.lazy_dependency_imports_ = options.lazy_dependency_imports;
+  invocation.nullability_inferences_ = options.nullability_inferences;
+  invocation.lifetime_context_->summaries = options.lifetime_summaries;
+  invocation.infer_nullability_ = options.infer_nullability;
+  invocation.infer_lifetimes_ = options.infer_lifetimes;
+  invocation.max_template_instantiations_ = options.max_template_instantiations;
+  invocation.max_template_instantiation_depth_ =
+      options.max_template_instantiation_depth;
+  {
+    // Measures parsing, as importing is measured separately.
+    TimingReport::Phase phase(options.timing_report, "clang");
+    bool compiled = RunClang(std::make_unique<FrontendAction>(invocation),
+                             inputs.virtual_input_file_content,
+                             kVirtualInputPath, inputs, options.file_system);
+    if (options.deferred_extra_instantiations.valid()) {
+      CRUBIT_RETURN_IF_ERROR(
+          options.deferred_extra_instantiations.get().status());
+    }
+    if (!compiled) {
+      return absl::Status(absl::StatusCode::kInvalidArgument,
+                          "Could not compile header contents");
+    }
   }
 
   invocation.ir_.items.reserve(invocation.ir_.items.size() +
@@ -103,17 +426,48 @@ absl::StatusOr<IR> IrFromCc(IrFromCcOptions options) {
     // TODO(jeanpierreda): It'd be nice to give these human-readable names, e.g. the
     // name of the file without the `.rs`, but it's also annoying to handle name
     // collisions.
-    ItemId id(reinterpret_cast<uintptr_t>(&extra_source));
+    std::string mod_name = absl::StrCat("__crubit_mod_", i);
+    // Derived from the path rather than from the address of `extra_source`, so
+    // that the IR (and the bindings) are the same on every run.
+    ItemId id = GenerateItemId(absl::StrCat("UseMod:", mod_name, ":",
+                                            extra_source));
     invocation.ir_.items.push_back(UseMod{
         .path = extra_source,
-        .mod_name = Identifier(absl::StrCat("__crubit_mod_", i)),
+        .mod_name = Identifier(std::move(mod_name)),
         .id = id,
     });
     invocation.ir_.top_level_item_ids.push_back(id);
     ++i;
   }
   invocation.ir_.crubit_features = std::move(options.crubit_features);
-  return invocation.ir_;
+  if (options.type_conversion_cache_stats != nullptr) {
+    *options.type_conversion_cache_stats =
+        invocation.type_conversion_cache_stats_;
+  }
+  if (options.mangled_name_cache_stats != nullptr) {
+    *options.mangled_name_cache_stats = invocation.mangled_name_cache_stats_;
+  }
+  if (options.timing_report != nullptr) {
+    options.timing_report->Add(
+        "mangled_name_cache",
+        llvm::json::Object{
+            {"hits", invocation.mangled_name_cache_stats_.hits},
+            {"misses", invocation.mangled_name_cache_stats_.misses}});
+    std::vector<std::string>& skipped =
+        invocation.skipped_template_instantiations_;
+    if (!skipped.empty()) {
+      // A specialization is skipped again whenever another type refers to it.
+      std::sort(skipped.begin(), skipped.end());
+      skipped.erase(std::unique(skipped.begin(), skipped.end()),
+                    skipped.end());
+      llvm::json::Array names;
+      for (std::string& name : skipped) names.push_back(std::move(name));
+      options.timing_report->Add("skipped_template_instantiations",
+                                 std::move(names));
+    }
+  }
+  // `invocation` is a local, but its members aren't moved from implicitly.
+  return std::move(invocation.ir_);
 }
 
 }  // namespace crubit
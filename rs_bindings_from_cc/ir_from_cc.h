@@ -5,16 +5,26 @@
 #ifndef CRUBIT_RS_BINDINGS_FROM_CC_IR_FROM_CC_H_
 #define CRUBIT_RS_BINDINGS_FROM_CC_IR_FROM_CC_H_
 
+#include <future>
+#include <memory>
 #include <string>
 #include <type_traits>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
+#include "lifetime_annotations/lifetime_summaries.h"
+#include "nullability/inference/inference_table.h"
 #include "rs_bindings_from_cc/bazel_types.h"
+#include "rs_bindings_from_cc/chrome_trace.h"
+#include "rs_bindings_from_cc/decl_importer.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/VirtualFileSystem.h"
 
 namespace crubit {
 
@@ -35,11 +45,29 @@ struct IrFromCcOptions final {
   absl::flat_hash_map<const HeaderName, const std::string>
       virtual_headers_contents_for_testing = {};
   absl::flat_hash_map<HeaderName, BazelLabel> headers_to_targets = {};
+  absl::flat_hash_map<std::string, BazelLabel> instantiations_to_targets = {};
   absl::Span<const std::string> extra_rs_srcs = {};
   absl::Span<const absl::string_view> clang_args = {};
   absl::Span<const std::string> extra_instantiations = {};
+  std::shared_future<absl::StatusOr<std::vector<std::string>>>
+      deferred_extra_instantiations = {};
   absl::flat_hash_map<BazelLabel, absl::flat_hash_set<std::string>>
       crubit_features = {};
+  absl::Span<const std::string> dependency_modules = {};
+  TypeConversionCacheStats* type_conversion_cache_stats = nullptr;
+  MangledNameCacheStats* mangled_name_cache_stats = nullptr;
+  TimingReport* timing_report = nullptr;
+  ChromeTrace* trace = nullptr;
+  llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system = nullptr;
+  bool lazy_dependency_imports = false;
+  const clang::tidy::nullability::InferenceTable* nullability_inferences =
+      nullptr;
+  std::shared_ptr<const clang::tidy::lifetimes::LifetimeSummaries>
+      lifetime_summaries = nullptr;
+  bool infer_nullability = false;
+  bool infer_lifetimes = false;
+  int max_template_instantiations = 0;
+  int max_template_instantiation_depth = 0;
 
   // Not an argument, just here to prevent the options struct from being
   // copied/moved with nontrivial lifetime implications.
@@ -66,15 +94,86 @@ static_assert(std::is_aggregate_v<IrFromCcOptions>);
 //   If `extra_source_code` is specified it's added automatically under
 //   `//test:testing_target`. Headers from
 //   `virtual_headers_contents_for_testing` are not added automatically.
+// * `instantiations_to_targets`: mapping of the C++ names of class template
+//   instantiations to the label of the target owning their bindings. Other
+//   instantiations are owned by `current_target`.
 // * `clang_args`: additional command line arguments for Clang
 // * `extra_rs_srcs`: A list of paths for additional rust files to include into
 //    the crate. This is done via `#[path="..."] mod <...>; pub use <...>::*;`.
 // * `extra_instantiations`: names of full C++ class template specializations
 //   to instantiate and generate bindings from.
+// * `deferred_extra_instantiations`: if valid, more names like
+//   `extra_instantiations`, which may still be being computed. They are
+//   declared at the end of the translation unit, so Clang parses the public
+//   headers first and only waits for them once it gets there.
 // * `crubit_features`: The set of Crubit features to enable for each target.
+// * `dependency_modules`: paths of Clang modules (as produced by
+//   `ModuleFromCc`) for dependency targets. Headers which belong to one of
+//   these modules are imported from it rather than parsed.
+// * `type_conversion_cache_stats`: if non-null, receives the hit and miss
+//   counts of the importer's type conversion cache.
+// * `mangled_name_cache_stats`: if non-null, receives the hit and miss counts
+//   of the importer's mangled name cache. They are also added to
+//   `timing_report`, if any.
+// * `timing_report`: if non-null, receives the time spent parsing the headers
+//   and importing their declarations.
+// * `trace`: if non-null, receives a span for the import of each declaration.
+// * `file_system`: if non-null, the file system headers are read from instead
+//   of the real one, e.g. a `FileSystemCache` shared with other runs. Virtual
+//   headers are overlaid on it.
+// * `lazy_dependency_imports`: if true, decls of other targets are only
+//   imported when the decls of `current_target` refer to them.
+// * `nullability_inferences`: if non-null, the nullability inferred for
+//   functions (see nullability/inference). Pointer parameters and return types
+//   inferred to be non-null are bound as references rather than as `Option`s
+//   of references. This only matters for pointers that have lifetimes.
+// * `lifetime_summaries`: if non-null, the lifetimes inferred for functions by
+//   lifetime_analysis. Functions without lifetime annotations use these
+//   lifetimes, so their pointers are bound as references rather than as raw
+//   pointers.
+// * `infer_nullability`: if true, nullability inference runs on the AST the
+//   headers are imported from, before they are imported, and its conclusions
+//   are used like `nullability_inferences` (which must then be null). Only
+//   evidence within the headers is taken into account.
+// * `infer_lifetimes`: if true, lifetime_analysis runs on the functions defined
+//   in the headers, on the AST they are imported from, and the lifetimes it
+//   infers are used for the functions that `lifetime_summaries` have no
+//   lifetimes for.
+// * `max_template_instantiations`: if positive, the maximum number of class
+//   template specializations instantiated and imported because the types of
+//   the declarations refer to them. Declarations referring to any others are
+//   unsupported, and the others are listed under
+//   `skipped_template_instantiations` in `timing_report`, if any.
+// * `max_template_instantiation_depth`: if positive, the maximum number of
+//   such specializations that are imported within each other's import, e.g.
+//   for recursive templates whose members refer to other specializations.
 //
 absl::StatusOr<IR> IrFromCc(IrFromCcOptions options);
 
+// Returns the name of the Clang module `ModuleFromCc` builds for `target`.
+std::string ModuleNameForTarget(const BazelLabel& target);
+
+// Builds a Clang module containing the headers `IrFromCc(options)` would parse,
+// and returns its contents. `module_path` is the path the module will be
+// written to.
+//
+// Targets depending on `options.current_target` can pass the module in their
+// `dependency_modules`, so that headers of deep dependency chains are parsed
+// once rather than once per dependent target.
+absl::StatusOr<std::string> ModuleFromCc(const IrFromCcOptions& options,
+                                         absl::string_view module_path);
+
+// Runs only the Clang preprocessor on the input `IrFromCc(options)` would
+// parse, and returns a hex-encoded hash of the Clang args and of the names and
+// contents of all (transitively) included files.
+//
+// The hash changes whenever the preprocessed input changes, but it is
+// conservative: e.g. editing a comment in a header changes it, too. It does not
+// account for files which were looked for but not found, so a header newly
+// shadowing another one on the include path goes unnoticed.
+absl::StatusOr<std::string> HashPreprocessedInputs(
+    const IrFromCcOptions& options);
+
 }  // namespace crubit
 
 #endif  // CRUBIT_RS_BINDINGS_FROM_CC_IR_FROM_CC_H_
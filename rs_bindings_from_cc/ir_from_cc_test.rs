@@ -86,7 +86,10 @@ fn test_function() {
                 is_inline: false,
                 member_func_metadata: None,
                 has_c_calling_convention: true,
+                is_noexcept: false,
                 is_member_or_descendant_of_class_template: false,
+                returned_field: None,
+                inlined_read: None,
                 source_loc: "Generated from: google3/ir_from_cc_virtual_header.h;l=3",
                 id: ItemId(...),
                 enclosing_namespace_id: None,
@@ -638,6 +641,64 @@ fn test_record_special_member_access_specifiers() {
     );
 }
 
+#[test]
+fn test_record_is_c_abi_compatible_by_value() {
+    let ir = ir_from_cc(
+        "
+        struct [[clang::trivial_abi]] Scalars final {
+            Scalars(const Scalars&);
+            int i;
+            double d;
+            const char* p;
+        };
+        struct ImplicitlyTrivial final { int i; };
+        struct [[clang::trivial_abi]] Bitfield final { int i : 3; };
+        struct [[clang::trivial_abi]] Empty final {};
+        struct [[clang::trivial_abi]] Nested final { ImplicitlyTrivial t; };
+    ",
+    )
+    .unwrap();
+    let is_c_abi_compatible_by_value = |name: &str| {
+        ir.records().find(|r| r.rs_name.as_ref() == name).unwrap().is_c_abi_compatible_by_value
+    };
+    assert!(is_c_abi_compatible_by_value("Scalars"));
+    assert!(!is_c_abi_compatible_by_value("ImplicitlyTrivial"));
+    assert!(!is_c_abi_compatible_by_value("Bitfield"));
+    assert!(!is_c_abi_compatible_by_value("Empty"));
+    assert!(!is_c_abi_compatible_by_value("Nested"));
+}
+
+#[test]
+fn test_record_is_zero_initializable() {
+    let ir = ir_from_cc(
+        "
+        enum E { kA = 1 };
+        struct Trivial final { int i; double d; const char* p; E e; int a[2]; };
+        struct ZeroInitializers final { int i = 0; bool b = false; int* p = nullptr; };
+        struct Nested final : Trivial { ZeroInitializers z[2]; };
+        struct UserProvided final { UserProvided(); int i; };
+        struct NonzeroInitializer final { int i = 1; };
+        struct FunctionPointer final { void (*f)(); };
+        struct MemberPointer final { int Trivial::*m; };
+        struct Polymorphic { virtual void f(); };
+        struct NestedUserProvided final { UserProvided u; };
+    ",
+    )
+    .unwrap();
+    let is_zero_initializable = |name: &str| {
+        ir.records().find(|r| r.rs_name.as_ref() == name).unwrap().is_zero_initializable
+    };
+    assert!(is_zero_initializable("Trivial"));
+    assert!(is_zero_initializable("ZeroInitializers"));
+    assert!(is_zero_initializable("Nested"));
+    assert!(!is_zero_initializable("UserProvided"));
+    assert!(!is_zero_initializable("NonzeroInitializer"));
+    assert!(!is_zero_initializable("FunctionPointer"));
+    assert!(!is_zero_initializable("MemberPointer"));
+    assert!(!is_zero_initializable("Polymorphic"));
+    assert!(!is_zero_initializable("NestedUserProvided"));
+}
+
 #[test]
 fn test_record_special_member_definition() {
     let ir = ir_from_cc(
@@ -1035,6 +1096,139 @@ fn test_typedef() -> Result<()> {
     Ok(())
 }
 
+#[test]
+fn test_constant() -> Result<()> {
+    let ir = ir_from_cc(
+        r#"
+            // Doc comment for kSize.
+            constexpr int kSize = 2 * 4;
+            struct S final {
+              static constexpr bool kIsS = true;
+            };
+            inline constexpr long kMin = -(1L << 40);
+            constexpr double kPi = 3.14;
+            const int kConstInt = 0;
+            int variable = 0;
+        "#,
+    )?;
+    assert_ir_matches!(
+        ir,
+        quote! {
+          Constant {
+            identifier: "kSize",
+            id: ItemId(...),
+            owning_target: BazelLabel("//test:testing_target"),
+            doc_comment: Some("Doc comment for kSize."),
+            source_loc: ...,
+            type_: MappedType { rs_type: RsType { name: Some("::core::ffi::c_int"), ... }, ... },
+            value: IntegerConstant { is_negative: false, wrapped_value: 8 },
+            enclosing_record_id: None,
+            enclosing_namespace_id: None,
+          }
+        }
+    );
+    assert_ir_matches!(
+        ir,
+        quote! {
+          Constant {
+            identifier: "kIsS",
+            ...
+            value: IntegerConstant { is_negative: false, wrapped_value: 1 },
+            enclosing_record_id: Some(...),
+            ...
+          }
+        }
+    );
+    assert_ir_matches!(
+        ir,
+        quote! {
+          Constant {
+            identifier: "kMin",
+            ...
+            value: IntegerConstant {
+              is_negative: true,
+              wrapped_value: 18446742974197923840,
+            },
+            ...
+          }
+        }
+    );
+    assert_ir_matches!(
+        ir,
+        quote! {
+          UnsupportedItem {
+            name: "kPi",
+            message: "Only constants of integer types and `bool` are supported",
+            ...
+          }
+        }
+    );
+    // `const int` variables initialized by a constant expression are constants
+    // as well, but other variables are not.
+    assert_ir_matches!(ir, quote! { Constant { identifier: "kConstInt", ... } });
+    assert_ir_not_matches!(ir, quote! { Constant { identifier: "variable", ... } });
+    assert_ir_not_matches!(ir, quote! { UnsupportedItem { name: "variable", ... } });
+    Ok(())
+}
+
+#[test]
+fn test_global_var() -> Result<()> {
+    let ir = ir_from_cc(
+        r#"
+            namespace ns {
+            // Doc comment for counter.
+            extern int counter;
+            }
+            extern const long kTableSize;
+            static int internal = 0;
+            thread_local int per_thread = 0;
+        "#,
+    )?;
+    assert_ir_matches!(
+        ir,
+        quote! {
+          GlobalVar {
+            identifier: "counter",
+            id: ItemId(...),
+            owning_target: BazelLabel("//test:testing_target"),
+            doc_comment: Some("Doc comment for counter."),
+            source_loc: ...,
+            mangled_name: "_ZN2ns7counterE",
+            type_: MappedType {
+              rs_type: RsType { name: Some("::core::ffi::c_int"), ... },
+              cc_type: CcType { name: Some("int"), is_const: false, ... },
+            },
+            size_align: SizeAlign { size: 4, alignment: 4 },
+            enclosing_namespace_id: Some(...),
+          }
+        }
+    );
+    assert_ir_matches!(
+        ir,
+        quote! {
+          GlobalVar {
+            identifier: "kTableSize",
+            ...
+            mangled_name: "kTableSize",
+            type_: MappedType { ..., cc_type: CcType { name: Some("long"), is_const: true, ... } },
+            ...
+          }
+        }
+    );
+    assert_ir_not_matches!(ir, quote! { GlobalVar { identifier: "internal", ... } });
+    assert_ir_matches!(
+        ir,
+        quote! {
+          UnsupportedItem {
+            name: "per_thread",
+            message: "Thread-local variables are not supported",
+            ...
+          }
+        }
+    );
+    Ok(())
+}
+
 #[test]
 fn test_typedef_duplicate() -> Result<()> {
     let ir = ir_from_cc(
@@ -2763,6 +2957,7 @@ fn test_member_function() {
             reference: ir::ReferenceQualification::Unqualified,
             is_const: false,
             is_virtual: false,
+            is_final: false,
         }),
     );
 }
@@ -2776,6 +2971,7 @@ fn test_member_function_const() {
             reference: ir::ReferenceQualification::Unqualified,
             is_const: true,
             is_virtual: false,
+            is_final: false,
         }),
     );
 }
@@ -2789,6 +2985,56 @@ fn test_member_function_virtual() {
             reference: ir::ReferenceQualification::Unqualified,
             is_const: false,
             is_virtual: true,
+            is_final: false,
+        }),
+    );
+}
+
+#[test]
+fn test_member_function_virtual_final() {
+    assert_member_function_has_instance_method_metadata(
+        "Function",
+        "virtual void Function() final;",
+        &Some(ir::InstanceMethodMetadata {
+            reference: ir::ReferenceQualification::Unqualified,
+            is_const: false,
+            is_virtual: true,
+            is_final: true,
+        }),
+    );
+}
+
+#[test]
+fn test_member_function_virtual_in_final_class() {
+    let ir = ir_from_cc(
+        r#"
+        struct Struct final {
+          virtual void Function();
+          virtual void PureFunction() = 0;
+        };"#,
+    )
+    .unwrap();
+    assert_member_function_with_predicate_has_instance_method_metadata(
+        &ir,
+        "Struct",
+        |f| f.name == UnqualifiedIdentifier::Identifier(ir_id("Function")),
+        &Some(ir::InstanceMethodMetadata {
+            reference: ir::ReferenceQualification::Unqualified,
+            is_const: false,
+            is_virtual: true,
+            is_final: true,
+        }),
+    );
+    // Pure virtual functions have no definition to call directly.
+    assert_member_function_with_predicate_has_instance_method_metadata(
+        &ir,
+        "Struct",
+        |f| f.name == UnqualifiedIdentifier::Identifier(ir_id("PureFunction")),
+        &Some(ir::InstanceMethodMetadata {
+            reference: ir::ReferenceQualification::Unqualified,
+            is_const: false,
+            is_virtual: true,
+            is_final: false,
         }),
     );
 }
@@ -2802,6 +3048,7 @@ fn test_member_function_lvalue() {
             reference: ir::ReferenceQualification::LValue,
             is_const: false,
             is_virtual: false,
+            is_final: false,
         }),
     );
 }
@@ -2815,10 +3062,112 @@ fn test_member_function_rvalue() {
             reference: ir::ReferenceQualification::RValue,
             is_const: false,
             is_virtual: false,
+            is_final: false,
         }),
     );
 }
 
+#[test]
+fn test_member_function_returned_field() {
+    let ir = ir_from_cc(
+        r#"
+            struct SomeStruct final {
+                int get() const { return field_; }
+                int get_this() const { return this->field_; }
+                int get_plus_one() const { return field_ + 1; }
+                int get_other(const SomeStruct& other) const { return other.field_; }
+                int get_declared_only() const;
+              private:
+                int field_;
+            };
+        "#,
+    )
+    .unwrap();
+    for name in ["get", "get_this"] {
+        let func = retrieve_func(&ir, name);
+        assert_eq!(func.returned_field, Some(ir::Identifier { identifier: "field_".into() }));
+    }
+    for name in ["get_plus_one", "get_other", "get_declared_only"] {
+        assert_eq!(retrieve_func(&ir, name).returned_field, None);
+    }
+}
+
+#[test]
+fn test_member_function_inlined_read() {
+    let ir = ir_from_cc(
+        r#"
+            namespace internal {
+            inline void TSanRead(const void*) {}
+            template <int N>
+            struct HasBits {
+                const unsigned int& operator[](int index) const { return has_bits_[index]; }
+                unsigned int has_bits_[N];
+            };
+            }  // namespace internal
+
+            struct Message final {
+                int foo() const { return _internal_foo(); }
+                bool has_foo() const {
+                    bool value = (_impl_._has_bits_[0] & 0x00000002u) != 0;
+                    return value;
+                }
+                double bar() const { return _impl_.bar_; }
+                int foo_plus_one() const { return _impl_.foo_ + 1; }
+                bool has_unknown() const { return (_impl_._has_bits_[1] & 1u) != 0; }
+                int declared_only() const;
+              private:
+                int _internal_foo() const {
+                    internal::TSanRead(&_impl_);
+                    return _impl_.foo_;
+                }
+                struct Impl {
+                    internal::HasBits<1> _has_bits_;
+                    int foo_;
+                    double bar_;
+                } _impl_;
+            };
+        "#,
+    )
+    .unwrap();
+    assert_eq!(
+        retrieve_func(&ir, "foo").inlined_read,
+        Some(ir::InlinedRead { offset: 4, size: 4, bit_mask: None })
+    );
+    assert_eq!(
+        retrieve_func(&ir, "has_foo").inlined_read,
+        Some(ir::InlinedRead { offset: 0, size: 4, bit_mask: Some(2) })
+    );
+    assert_eq!(
+        retrieve_func(&ir, "bar").inlined_read,
+        Some(ir::InlinedRead { offset: 8, size: 8, bit_mask: None })
+    );
+    for name in ["foo_plus_one", "has_unknown", "declared_only"] {
+        assert_eq!(retrieve_func(&ir, name).inlined_read, None);
+    }
+}
+
+#[test]
+fn test_func_noexcept() {
+    let ir = ir_from_cc(
+        r#"
+            void Noexcept() noexcept;
+            void NoexceptTrue() noexcept(true);
+            void NoexceptFalse() noexcept(false);
+            void MayThrow();
+            struct SomeStruct final {
+                void Method() noexcept;
+            };
+        "#,
+    )
+    .unwrap();
+    for name in ["Noexcept", "NoexceptTrue", "Method"] {
+        assert!(retrieve_func(&ir, name).is_noexcept, "{name}");
+    }
+    for name in ["NoexceptFalse", "MayThrow"] {
+        assert!(!retrieve_func(&ir, name).is_noexcept, "{name}");
+    }
+}
+
 #[test]
 fn test_member_function_rvalue_ref_qualified_this_param_type() {
     let ir = ir_from_cc(
@@ -2870,6 +3219,7 @@ fn test_member_function_explicit_constructor() {
             reference: ir::ReferenceQualification::Unqualified,
             is_const: false,
             is_virtual: false,
+            is_final: false,
         }),
     );
 }
@@ -2892,6 +3242,7 @@ fn test_member_function_constructor() {
                 reference: ir::ReferenceQualification::Unqualified,
                 is_const: false,
                 is_virtual: false,
+                is_final: false,
             }),
         );
     }
@@ -3012,6 +3363,46 @@ fn test_elided_lifetimes() {
     assert_eq!(&*func.params[1].type_.rs_type.lifetime_args, &[b_id]);
 }
 
+#[test]
+fn test_trivially_relocatable_attribute() {
+    let ir = ir_from_cc(
+        r#"
+        struct [[clang::annotate("crubit_internal_trivially_relocatable")]] Annotated {
+          Annotated(Annotated&&);
+          ~Annotated();
+        };
+        struct NotAnnotated {
+          NotAnnotated(NotAnnotated&&);
+          ~NotAnnotated();
+        };"#,
+    )
+    .unwrap();
+    let annotated = ir.records().find(|r| r.rs_name.as_ref() == "Annotated").unwrap();
+    assert!(!annotated.is_trivial_abi);
+    assert!(annotated.is_trivially_relocatable);
+    let not_annotated = ir.records().find(|r| r.rs_name.as_ref() == "NotAnnotated").unwrap();
+    assert!(!not_annotated.is_trivial_abi);
+    assert!(!not_annotated.is_trivially_relocatable);
+}
+
+#[test]
+fn test_thread_safety_attributes() {
+    let ir = ir_from_cc(
+        r#"
+        struct [[clang::annotate("crubit_internal_thread_safe")]] ThreadSafe {};
+        struct [[clang::annotate("crubit_internal_thread_compatible")]] ThreadCompatible {};
+        struct NotAnnotated {};"#,
+    )
+    .unwrap();
+    let record = |name: &str| ir.records().find(|r| r.rs_name.as_ref() == name).unwrap();
+    assert!(record("ThreadSafe").is_send);
+    assert!(record("ThreadSafe").is_sync);
+    assert!(record("ThreadCompatible").is_send);
+    assert!(record("ThreadCompatible").is_sync);
+    assert!(!record("NotAnnotated").is_send);
+    assert!(!record("NotAnnotated").is_sync);
+}
+
 fn verify_elided_lifetimes_in_default_constructor(ir: &IR) {
     let r = ir.records().next().expect("IR should contain `struct S`");
     assert_eq!(r.rs_name.as_ref(), "S");
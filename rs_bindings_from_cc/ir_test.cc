@@ -0,0 +1,84 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/ir.h"
+
+#include <string>
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/strings/str_cat.h"
+
+namespace crubit {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::Field;
+using ::testing::IsEmpty;
+using ::testing::IsNull;
+using ::testing::Pointee;
+
+UseMod MakeUseMod(std::string path, ItemId id) {
+  return UseMod{.path = std::move(path),
+                .mod_name = Identifier("m"),
+                .id = id};
+}
+
+TEST(IrTest, GetItemsIf) {
+  IR ir;
+  ir.items.push_back(Comment{.text = "first", .id = ItemId(1)});
+  ir.items.push_back(MakeUseMod("a.rs", ItemId(2)));
+  ir.items.push_back(Comment{.text = "second", .id = ItemId(3)});
+
+  EXPECT_THAT(ir.get_items_if<Comment>(),
+              ElementsAre(Pointee(Field(&Comment::text, "first")),
+                          Pointee(Field(&Comment::text, "second"))));
+  EXPECT_THAT(ir.get_items_if<UseMod>(),
+              ElementsAre(Pointee(Field(&UseMod::path, "a.rs"))));
+  EXPECT_THAT(ir.get_items_if<Record>(), IsEmpty());
+}
+
+TEST(IrTest, FindItem) {
+  IR ir;
+  ir.items.push_back(Comment{.text = "comment", .id = ItemId(1)});
+  ir.items.push_back(MakeUseMod("a.rs", ItemId(2)));
+
+  EXPECT_THAT(ir.FindItem<Comment>(ItemId(1)),
+              Pointee(Field(&Comment::text, "comment")));
+  EXPECT_THAT(ir.FindItem<UseMod>(ItemId(1)), IsNull());
+  EXPECT_THAT(ir.FindItem(ItemId(3)), IsNull());
+}
+
+TEST(IrTest, IndexFollowsItems) {
+  IR ir;
+  ir.items.push_back(Comment{.text = "first", .id = ItemId(1)});
+  EXPECT_THAT(ir.FindItem(ItemId(2)), IsNull());
+
+  ir.items.push_back(Comment{.text = "second", .id = ItemId(2)});
+  EXPECT_THAT(ir.FindItem<Comment>(ItemId(2)),
+              Pointee(Field(&Comment::text, "second")));
+
+  ir.items[0] = MakeUseMod("a.rs", ItemId(1));
+  ir.InvalidateItemIndex();
+  EXPECT_THAT(ir.get_items_if<Comment>(),
+              ElementsAre(Pointee(Field(&Comment::text, "second"))));
+
+  IR copy = ir;
+  EXPECT_THAT(copy.FindItem<UseMod>(ItemId(1)),
+              Pointee(Field(&UseMod::path, "a.rs")));
+  EXPECT_NE(copy.FindItem(ItemId(1)), ir.FindItem(ItemId(1)));
+}
+
+TEST(IrTest, ToJsonOnThreads) {
+  IR ir;
+  for (int i = 0; i < 10000; ++i) {
+    ir.items.push_back(
+        Comment{.text = absl::StrCat("comment ", i), .id = ItemId(i)});
+  }
+  EXPECT_EQ(ir.ToJson(/*threads=*/4), ir.ToJson());
+}
+
+}  // namespace
+}  // namespace crubit
@@ -8,10 +8,13 @@
 #include "absl/strings/string_view.h"
 #include "common/ffi_types.h"
 #include "rs_bindings_from_cc/bazel_types.h"
+#include "rs_bindings_from_cc/file_system_cache.h"
 #include "rs_bindings_from_cc/ir.h"
 #include "rs_bindings_from_cc/ir_from_cc.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
 #include "llvm/Support/ErrorHandling.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/VirtualFileSystem.h"
 
 namespace crubit {
 
@@ -22,10 +25,16 @@ static constexpr absl::string_view kDependencyHeaderName =
     "test/dependency_header.h";
 // LINT.ThenChange(//depot/rs_bindings_from_cc/ir_testing.rs)
 
-// This is intended to be called from Rust tests.
+// This is intended to be called from Rust tests, many times per process. The
+// files on disk, e.g. the standard library headers, don't change meanwhile, so
+// all calls read them through the same `FileSystemCache`.
 extern "C" FfiU8SliceBox json_from_cc_dependency(
     FfiU8Slice target_triple, FfiU8Slice header_source,
     FfiU8Slice dependency_header_source) {
+  static auto* file_system_cache =
+      new llvm::IntrusiveRefCntPtr<FileSystemCache>(
+          llvm::makeIntrusiveRefCnt<FileSystemCache>(
+              llvm::vfs::getRealFileSystem()));
   absl::StatusOr<IR> ir = IrFromCc(
       {.extra_source_code_for_testing = StringViewFromFfiU8Slice(header_source),
        .current_target = BazelLabel{"//test:testing_target"},
@@ -34,7 +43,8 @@ extern "C" FfiU8SliceBox json_from_cc_dependency(
              std::string(StringViewFromFfiU8Slice(dependency_header_source))}},
        .headers_to_targets = {{HeaderName(std::string(kDependencyHeaderName)),
                                BazelLabel{std::string(kDependencyTarget)}}},
-       .clang_args = {"-target", StringViewFromFfiU8Slice(target_triple)}});
+       .clang_args = {"-target", StringViewFromFfiU8Slice(target_triple)},
+       .file_system = *file_system_cache});
 
   // TODO(forster): For now it is good enough to just exit: We are just
   // using this from tests, which are ok to just fail. Clang has already
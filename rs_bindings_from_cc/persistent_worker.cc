@@ -0,0 +1,83 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/persistent_worker.h"
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "absl/strings/str_cat.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace crubit {
+
+namespace {
+
+// An element of `WorkRequest.inputs`.
+//
+// Fields with default values are omitted from the JSON encoding, so all
+// fields are optional.
+struct Input {
+  std::string path;
+  std::string digest;
+};
+
+bool fromJSON(const llvm::json::Value& json, Input& out,
+              llvm::json::Path path) {
+  llvm::json::ObjectMapper mapper(json, path);
+  return mapper && mapper.mapOptional("path", out.path) &&
+         mapper.mapOptional("digest", out.digest);
+}
+
+}  // namespace
+
+bool fromJSON(const llvm::json::Value& json, WorkRequest& out,
+              llvm::json::Path path) {
+  llvm::json::ObjectMapper mapper(json, path);
+  std::vector<Input> inputs;
+  if (!mapper || !mapper.mapOptional("arguments", out.arguments) ||
+      !mapper.mapOptional("inputs", inputs) ||
+      !mapper.mapOptional("requestId", out.request_id)) {
+    return false;
+  }
+  for (Input& input : inputs) {
+    out.input_digests.insert_or_assign(std::move(input.path),
+                                       std::move(input.digest));
+  }
+  return true;
+}
+
+absl::Status RunPersistentWorker(std::istream& in, llvm::raw_ostream& out,
+                                 WorkRequestHandler handle_request) {
+  std::string line;
+  while (std::getline(in, line)) {
+    if (line.empty()) continue;
+    llvm::Expected<WorkRequest> request =
+        llvm::json::parse<WorkRequest>(line);
+    if (!request) {
+      return absl::InvalidArgumentError(
+          absl::StrCat("Invalid work request: ",
+                       llvm::toString(request.takeError()), ": ", line));
+    }
+
+    absl::Status status = handle_request(*request);
+    llvm::json::Object response = {
+        {"exitCode", status.ok() ? 0 : 1},
+        {"output", status.ok() ? "" : std::string(status.message())},
+        {"requestId", request->request_id},
+    };
+    out << llvm::json::Value(std::move(response)) << "\n";
+    out.flush();
+  }
+  return absl::OkStatus();
+}
+
+}  // namespace crubit
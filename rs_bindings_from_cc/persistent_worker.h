@@ -0,0 +1,47 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_PERSISTENT_WORKER_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_PERSISTENT_WORKER_H_
+
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/functional/function_ref.h"
+#include "absl/status/status.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace crubit {
+
+// The fields of a `WorkRequest` that the worker uses. See
+// https://github.com/bazelbuild/bazel/blob/master/src/main/protobuf/worker_protocol.proto.
+struct WorkRequest {
+  std::vector<std::string> arguments;
+  // The digests of the input files, keyed by their paths. Bazel computes them
+  // anyway, so files whose digest didn't change since an earlier request don't
+  // need to be read again.
+  absl::flat_hash_map<std::string, std::string> input_digests;
+  int64_t request_id = 0;
+};
+
+// Handles a single work request. The returned status is reported to Bazel in
+// the work response.
+using WorkRequestHandler =
+    absl::FunctionRef<absl::Status(const WorkRequest& request)>;
+
+// Implements the JSON flavor of the Bazel persistent worker protocol
+// (https://bazel.build/remote/persistent): reads work requests, one JSON object
+// per line, from `in`, calls `handle_request` for each of them and writes the
+// work response for each to `out`.
+//
+// Returns when `in` is exhausted, or an error if a request can't be parsed.
+absl::Status RunPersistentWorker(std::istream& in, llvm::raw_ostream& out,
+                                 WorkRequestHandler handle_request);
+
+}  // namespace crubit
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_PERSISTENT_WORKER_H_
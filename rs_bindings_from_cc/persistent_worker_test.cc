@@ -0,0 +1,92 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/persistent_worker.h"
+
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_map.h"
+#include "absl/status/status.h"
+#include "common/status_test_matchers.h"
+#include "llvm/Support/raw_ostream.h"
+
+namespace crubit {
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::HasSubstr;
+using ::testing::Pair;
+using ::testing::UnorderedElementsAre;
+
+TEST(PersistentWorkerTest, HandlesRequestsInOrder) {
+  std::istringstream in(
+      R"({"arguments": ["--a", "b"], "requestId": 1})"
+      "\n"
+      R"({"arguments": ["--fail"], "requestId": 2, "inputs": []})"
+      "\n"
+      // `requestId` is omitted from the JSON encoding when it is 0.
+      R"({"arguments": []})"
+      "\n");
+  std::string out;
+  llvm::raw_string_ostream out_stream(out);
+  std::vector<std::vector<std::string>> handled_arguments;
+
+  ASSERT_OK(RunPersistentWorker(
+      in, out_stream, [&](const WorkRequest& request) {
+        const std::vector<std::string>& arguments = request.arguments;
+        handled_arguments.push_back(arguments);
+        if (!arguments.empty() && arguments[0] == "--fail") {
+          return absl::InvalidArgumentError("failed");
+        }
+        return absl::OkStatus();
+      }));
+
+  EXPECT_THAT(handled_arguments,
+              ElementsAre(ElementsAre("--a", "b"), ElementsAre("--fail"),
+                          ElementsAre()));
+  EXPECT_EQ(out,
+            R"({"exitCode":0,"output":"","requestId":1})"
+            "\n"
+            R"({"exitCode":1,"output":"failed","requestId":2})"
+            "\n"
+            R"({"exitCode":0,"output":"","requestId":0})"
+            "\n");
+}
+
+TEST(PersistentWorkerTest, InputDigests) {
+  std::istringstream in(
+      R"({"inputs": [{"path": "a.h", "digest": "ZGlnZXN0"}, {"path": "b.h"}]})"
+      "\n");
+  std::string out;
+  llvm::raw_string_ostream out_stream(out);
+  absl::flat_hash_map<std::string, std::string> input_digests;
+
+  ASSERT_OK(RunPersistentWorker(in, out_stream,
+                                [&](const WorkRequest& request) {
+                                  input_digests = request.input_digests;
+                                  return absl::OkStatus();
+                                }));
+
+  EXPECT_THAT(input_digests,
+              UnorderedElementsAre(Pair("a.h", "ZGlnZXN0"), Pair("b.h", "")));
+}
+
+TEST(PersistentWorkerTest, InvalidRequest) {
+  std::istringstream in("not json\n");
+  std::string out;
+  llvm::raw_string_ostream out_stream(out);
+  EXPECT_THAT(RunPersistentWorker(
+                  in, out_stream,
+                  [](const WorkRequest&) { return absl::OkStatus(); }),
+              StatusIs(absl::StatusCode::kInvalidArgument,
+                       HasSubstr("Invalid work request")));
+  EXPECT_EQ(out, "");
+}
+
+}  // namespace
+}  // namespace crubit
@@ -0,0 +1,280 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/prune_unused_items.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <optional>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <variant>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "rs_bindings_from_cc/bazel_types.h"
+#include "rs_bindings_from_cc/ir.h"
+
+namespace crubit {
+
+namespace {
+
+// Returns the target owning `item`, or `std::nullopt` for items which are
+// always owned by the current target.
+template <typename T>
+std::optional<BazelLabel> OwningTarget(const T& item) {
+  return item.owning_target;
+}
+std::optional<BazelLabel> OwningTarget(const UnsupportedItem&) {
+  return std::nullopt;
+}
+std::optional<BazelLabel> OwningTarget(const Comment&) { return std::nullopt; }
+std::optional<BazelLabel> OwningTarget(const UseMod&) { return std::nullopt; }
+
+// Returns the name under which Rust code refers to `item`, if Rust code can
+// refer to `item` directly (rather than e.g. through the record defining it).
+template <typename T>
+std::optional<absl::string_view> UsableRsName(const T&) {
+  return std::nullopt;
+}
+std::optional<absl::string_view> UsableRsName(const Func& func) {
+  const auto* identifier = std::get_if<Identifier>(&func.name);
+  if (identifier == nullptr || func.member_func_metadata.has_value()) {
+    return std::nullopt;
+  }
+  return identifier->Ident();
+}
+std::optional<absl::string_view> UsableRsName(const Record& record) {
+  return record.rs_name;
+}
+std::optional<absl::string_view> UsableRsName(
+    const IncompleteRecord& record) {
+  return record.rs_name;
+}
+std::optional<absl::string_view> UsableRsName(const Enum& enum_) {
+  return enum_.identifier.Ident();
+}
+std::optional<absl::string_view> UsableRsName(const TypeAlias& type_alias) {
+  return type_alias.identifier.Ident();
+}
+std::optional<absl::string_view> UsableRsName(const Constant& constant) {
+  if (constant.enclosing_record_id.has_value()) return std::nullopt;
+  return constant.identifier.Ident();
+}
+std::optional<absl::string_view> UsableRsName(const GlobalVar& global_var) {
+  return global_var.identifier.Ident();
+}
+
+// Returns true if `item` has bindings regardless of the names used by the Rust
+// code. Free operators are only used through traits (e.g. `a == b` uses
+// `PartialEq`), so their names never appear in the Rust sources.
+template <typename T>
+bool IsAlwaysUsed(const T&) {
+  return false;
+}
+bool IsAlwaysUsed(const Func& func) {
+  return std::holds_alternative<Operator>(func.name) &&
+         !func.member_func_metadata.has_value();
+}
+
+// Computes the transitive closure of the items used by a set of items.
+class UsedItems {
+ public:
+  explicit UsedItems(const IR& ir) : ir_(ir) {}
+
+  void Use(ItemId id) {
+    if (used_.insert(id).second) {
+      worklist_.push_back(id);
+    }
+  }
+
+  // Returns the used items, including all of their dependencies.
+  absl::flat_hash_set<ItemId> Finish() && {
+    while (!worklist_.empty()) {
+      ItemId id = worklist_.back();
+      worklist_.pop_back();
+      if (const IR::Item* item = ir_.FindItem(id)) {
+        std::visit([&](const auto& item) { UseDependencies(item); }, *item);
+      }
+    }
+    return std::move(used_);
+  }
+
+ private:
+  void UseType(const RsType& type) {
+    if (type.decl_id.has_value()) Use(*type.decl_id);
+    for (const RsType& type_arg : type.type_args) UseType(type_arg);
+  }
+
+  void UseType(const CcType& type) {
+    if (type.decl_id.has_value()) Use(*type.decl_id);
+    for (const CcType& type_arg : type.type_args) UseType(type_arg);
+  }
+
+  void UseType(const MappedType& type) {
+    UseType(type.rs_type);
+    UseType(type.cc_type);
+  }
+
+  template <typename T>
+  void UseDependencies(const T&) {}
+
+  void UseDependencies(const Func& func) {
+    UseType(func.return_type);
+    for (const FuncParam& param : func.params) UseType(param.type);
+    if (func.member_func_metadata.has_value()) {
+      Use(func.member_func_metadata->record_id);
+    }
+  }
+
+  void UseDependencies(const Record& record) {
+    for (const BaseClass& base : record.unambiguous_public_bases) {
+      Use(base.base_record_id);
+    }
+    for (const Field& field : record.fields) {
+      if (field.type.ok()) UseType(*field.type);
+    }
+    // Member functions are used through the record, and special members are
+    // needed for the record's trait implementations.
+    for (ItemId child : record.child_item_ids) Use(child);
+  }
+
+  void UseDependencies(const Enum& enum_) { UseType(enum_.underlying_type); }
+
+  void UseDependencies(const TypeAlias& type_alias) {
+    UseType(type_alias.underlying_type);
+    if (type_alias.enclosing_record_id.has_value()) {
+      Use(*type_alias.enclosing_record_id);
+    }
+  }
+
+  void UseDependencies(const GlobalVar& global_var) {
+    UseType(global_var.type);
+  }
+
+  void UseDependencies(const Constant& constant) {
+    UseType(constant.type);
+    if (constant.enclosing_record_id.has_value()) {
+      Use(*constant.enclosing_record_id);
+    }
+  }
+
+  const IR& ir_;
+  absl::flat_hash_set<ItemId> used_;
+  std::vector<ItemId> worklist_;
+};
+
+class Pruner {
+ public:
+  Pruner(IR& ir, absl::flat_hash_set<ItemId> used,
+         const absl::flat_hash_set<std::string>& used_names)
+      : ir_(ir), used_(std::move(used)), used_names_(used_names) {
+    for (size_t i = 0; i < ir_.items.size(); ++i) {
+      std::visit([&](const auto& item) { positions_[item.id] = i; },
+                 ir_.items[i]);
+    }
+  }
+
+  // Removes the unused items from `ids` and from the children of the
+  // namespaces in it.
+  void PruneChildren(std::vector<ItemId>& ids) {
+    ids.erase(std::remove_if(ids.begin(), ids.end(),
+                             [&](ItemId id) { return !Keep(id); }),
+              ids.end());
+  }
+
+  // Removes the items of the current target which are neither used nor kept
+  // by `PruneChildren`.
+  // The items are compacted in place, rather than moved to a new vector.
+  void RemoveUnreachableItems() {
+    ir_.items.erase(
+        std::remove_if(ir_.items.begin(), ir_.items.end(),
+                       [&](const IR::Item& item) {
+                         return std::visit(
+                             [&](const auto& item) {
+                               return !used_.contains(item.id) &&
+                                      !kept_.contains(item.id) &&
+                                      IsOwnedByCurrentTarget(item);
+                             },
+                             item);
+                       }),
+        ir_.items.end());
+  }
+
+ private:
+  template <typename T>
+  bool IsOwnedByCurrentTarget(const T& item) const {
+    std::optional<BazelLabel> owning_target = OwningTarget(item);
+    return !owning_target.has_value() || *owning_target == ir_.current_target;
+  }
+
+  bool Keep(ItemId id) {
+    auto position = positions_.find(id);
+    if (position == positions_.end()) return false;
+    IR::Item& item = ir_.items[position->second];
+    bool keep = std::visit(
+        [&](auto& item) {
+          using T = std::decay_t<decltype(item)>;
+          if constexpr (std::is_same_v<T, Namespace>) {
+            PruneChildren(item.child_item_ids);
+            return !item.child_item_ids.empty();
+          } else if constexpr (std::is_same_v<T, Comment>) {
+            return false;
+          } else if constexpr (std::is_same_v<T, UnsupportedItem>) {
+            absl::string_view name = item.name;
+            size_t last_separator = name.rfind("::");
+            if (last_separator != absl::string_view::npos) {
+              name.remove_prefix(last_separator + 2);
+            }
+            return used_names_.contains(name);
+          } else if constexpr (std::is_same_v<T, UseMod> ||
+                               std::is_same_v<T, TypeMapOverride>) {
+            return true;
+          } else {
+            return used_.contains(id) || !IsOwnedByCurrentTarget(item);
+          }
+        },
+        item);
+    if (keep) kept_.insert(id);
+    return keep;
+  }
+
+  IR& ir_;
+  absl::flat_hash_set<ItemId> used_;
+  const absl::flat_hash_set<std::string>& used_names_;
+  absl::flat_hash_map<ItemId, size_t> positions_;
+  absl::flat_hash_set<ItemId> kept_;
+};
+
+}  // namespace
+
+void PruneUnusedItems(IR& ir,
+                      const absl::flat_hash_set<std::string>& used_names) {
+  UsedItems used_items(ir);
+  for (const IR::Item& item : ir.items) {
+    std::visit(
+        [&](const auto& item) {
+          std::optional<BazelLabel> owning_target = OwningTarget(item);
+          if (owning_target.has_value() &&
+              *owning_target != ir.current_target) {
+            return;
+          }
+          std::optional<absl::string_view> rs_name = UsableRsName(item);
+          if (IsAlwaysUsed(item) ||
+              (rs_name.has_value() && used_names.contains(*rs_name))) {
+            used_items.Use(item.id);
+          }
+        },
+        item);
+  }
+
+  Pruner pruner(ir, std::move(used_items).Finish(), used_names);
+  pruner.PruneChildren(ir.top_level_item_ids);
+  pruner.RemoveUnreachableItems();
+}
+
+}  // namespace crubit
@@ -0,0 +1,36 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_PRUNE_UNUSED_ITEMS_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_PRUNE_UNUSED_ITEMS_H_
+
+#include <string>
+
+#include "absl/container/flat_hash_set.h"
+#include "rs_bindings_from_cc/ir.h"
+
+namespace crubit {
+
+// Removes the items of the current target that the Rust code using the
+// bindings can't refer to, so that no bindings are generated for them.
+//
+// An item is kept if its Rust name is one of `used_names`, if it is a free
+// operator (which Rust code uses through a trait rather than by name), or if a
+// kept item
+// depends on it: records keep their bases, the types of their fields, and all
+// of their members; functions keep their parameter and return types, and type
+// aliases and enums keep their underlying types. Namespaces are kept if they
+// still have children. Comments are removed, and so are unsupported items,
+// unless the last component of their name is used. Items of other targets,
+// `UseMod`s, and `TypeMapOverride`s are always kept.
+//
+// This pass only runs when `--srcs_to_scan_for_used_names` is passed. The
+// Bazel aspect doesn't pass it (it can't know the Rust crates that will use
+// the bindings), so pruning is opt-in for direct invocations of the tool.
+void PruneUnusedItems(IR& ir,
+                      const absl::flat_hash_set<std::string>& used_names);
+
+}  // namespace crubit
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_PRUNE_UNUSED_ITEMS_H_
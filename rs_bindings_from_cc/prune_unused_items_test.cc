@@ -0,0 +1,132 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/prune_unused_items.h"
+
+#include <string>
+#include <variant>
+#include <vector>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/container/flat_hash_set.h"
+#include "absl/strings/string_view.h"
+#include "common/status_test_matchers.h"
+#include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/ir_from_cc.h"
+
+namespace crubit {
+namespace {
+
+using ::testing::IsEmpty;
+using ::testing::UnorderedElementsAre;
+
+// Returns the names of the records, enums, type aliases, free functions, and
+// namespaces in `ir`.
+std::vector<std::string> ItemNames(const IR& ir) {
+  std::vector<std::string> names;
+  for (const Record* record : ir.get_items_if<Record>()) {
+    names.push_back(record->rs_name);
+  }
+  for (const Enum* enum_ : ir.get_items_if<Enum>()) {
+    names.emplace_back(enum_->identifier.Ident());
+  }
+  for (const TypeAlias* type_alias : ir.get_items_if<TypeAlias>()) {
+    names.emplace_back(type_alias->identifier.Ident());
+  }
+  for (const Func* func : ir.get_items_if<Func>()) {
+    const auto* identifier = std::get_if<Identifier>(&func->name);
+    if (identifier != nullptr && !func->member_func_metadata.has_value()) {
+      names.emplace_back(identifier->Ident());
+    }
+  }
+  for (const Namespace* ns : ir.get_items_if<Namespace>()) {
+    names.emplace_back(ns->name.Ident());
+  }
+  return names;
+}
+
+TEST(PruneUnusedItemsTest, KeepsUsedItemsAndTheirDependencies) {
+  absl::string_view file = R"(
+    struct Field {};
+    struct Param {};
+    struct Base {};
+    enum Underlying { kUnderlying };
+    struct UsedStruct : Base { Field field; };
+    void UsedFunction(Param param);
+    using UsedAlias = Underlying;
+    struct UnusedStruct {};
+    void UnusedFunction();
+  )";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  PruneUnusedItems(ir, {"UsedStruct", "UsedFunction", "UsedAlias"});
+
+  EXPECT_THAT(ItemNames(ir),
+              UnorderedElementsAre("Field", "Param", "Base", "Underlying",
+                                   "UsedStruct", "UsedFunction", "UsedAlias"));
+  EXPECT_THAT(ir.get_items_if<Comment>(), IsEmpty());
+}
+
+TEST(PruneUnusedItemsTest, KeepsFreeOperatorsAndTheirParameterTypes) {
+  absl::string_view file = R"(
+    struct Comparable {};
+    bool operator==(const Comparable& lhs, const Comparable& rhs);
+    bool operator<(const Comparable& lhs, const Comparable& rhs);
+    struct UnusedStruct {};
+  )";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  PruneUnusedItems(ir, {});
+
+  std::vector<std::string> operator_names;
+  for (const Func* func : ir.get_items_if<Func>()) {
+    if (const auto* op = std::get_if<Operator>(&func->name)) {
+      if (!func->member_func_metadata.has_value()) {
+        operator_names.emplace_back(op->Name());
+      }
+    }
+  }
+  EXPECT_THAT(operator_names, UnorderedElementsAre("==", "<"));
+  EXPECT_THAT(ItemNames(ir), UnorderedElementsAre("Comparable"));
+}
+
+TEST(PruneUnusedItemsTest, KeepsMembersOfUsedRecords) {
+  absl::string_view file = R"(
+    struct Result {};
+    struct UsedStruct {
+      Result Method();
+    };
+  )";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  PruneUnusedItems(ir, {"UsedStruct"});
+
+  EXPECT_THAT(ItemNames(ir), UnorderedElementsAre("Result", "UsedStruct"));
+  bool has_method = false;
+  for (const Func* func : ir.get_items_if<Func>()) {
+    const auto* identifier = std::get_if<Identifier>(&func->name);
+    has_method |= identifier != nullptr && identifier->Ident() == "Method";
+  }
+  EXPECT_TRUE(has_method);
+}
+
+TEST(PruneUnusedItemsTest, RemovesNamespacesWithoutUsedItems) {
+  absl::string_view file = R"(
+    namespace used_ns { struct UsedStruct {}; struct UnusedStruct {}; }
+    namespace unused_ns { struct OtherStruct {}; }
+  )";
+  ASSERT_OK_AND_ASSIGN(IR ir, IrFromCc({file}));
+
+  PruneUnusedItems(ir, {"UsedStruct"});
+
+  EXPECT_THAT(ItemNames(ir), UnorderedElementsAre("used_ns", "UsedStruct"));
+  ASSERT_EQ(ir.top_level_item_ids.size(), 1);
+  const auto* used_ns = ir.FindItem<Namespace>(ir.top_level_item_ids[0]);
+  ASSERT_NE(used_ns, nullptr);
+  EXPECT_EQ(used_ns->child_item_ids.size(), 1);
+}
+
+}  // namespace
+}  // namespace crubit
@@ -6,25 +6,58 @@
 // * a Rust source file with bindings for the C++ API
 // * a C++ source file with the implementation of the bindings
 
+#include <algorithm>
 #include <cstddef>
+#include <iostream>
+#include <map>
+#include <optional>
 #include <string>
+#include <thread>  // NOLINT(build/c++11)
 #include <utility>
 #include <vector>
 
+#include "absl/flags/flag.h"
 #include "absl/flags/parse.h"
+#include "absl/flags/reflection.h"
 #include "absl/status/status.h"
+#include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "common/file_io.h"
 #include "common/status_macros.h"
+#include "rs_bindings_from_cc/batch.h"
+#include "rs_bindings_from_cc/chrome_trace.h"
 #include "rs_bindings_from_cc/cmdline.h"
 #include "rs_bindings_from_cc/collect_namespaces.h"
+#include "rs_bindings_from_cc/file_system_cache.h"
 #include "rs_bindings_from_cc/generate_bindings_and_metadata.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/ir_cache.h"
+#include "rs_bindings_from_cc/persistent_worker.h"
+#include "rs_bindings_from_cc/timing_report.h"
+#include "llvm/ADT/IntrusiveRefCntPtr.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/FormatVariadic.h"
 #include "llvm/Support/JSON.h"
+#include "llvm/Support/VirtualFileSystem.h"
 #include "llvm/Support/raw_ostream.h"
 
+ABSL_FLAG(bool, persistent_worker, false,
+          "run as a Bazel persistent worker: instead of generating bindings "
+          "once, read work requests from stdin and write work responses to "
+          "stdout (see https://bazel.build/remote/persistent).");
+ABSL_FLAG(std::string, batch_manifest, "",
+          "(optional) path to a JSON file listing the arguments of many "
+          "targets, as in [{\"arguments\": [\"--target=//foo:bar\", ...]}, "
+          "...]. If present, the bindings of all of them are generated in "
+          "this process, on --batch_threads threads, instead of those "
+          "described by the other flags.");
+ABSL_FLAG(int, batch_threads, 0,
+          "number of targets of the --batch_manifest whose bindings are "
+          "generated in parallel. Defaults to the number of hardware "
+          "threads.");
+
 namespace crubit {
 
 std::string InstantiationsAsJson(
@@ -36,16 +69,219 @@ std::string InstantiationsAsJson(
   return std::string(llvm::formatv("{0:2}", llvm::json::Value(std::move(obj))));
 }
 
-absl::Status Main(absl::Span<char* const> args) {
-  CRUBIT_ASSIGN_OR_RETURN(Cmdline cmdline, Cmdline::Create());
+// Returns the contents of the --rustc_dep_externs_out argument file: the
+// --rustc_dep_externs `--extern` flags of the `used_dep_targets`, one per line.
+// Used targets without an entry (e.g. direct dependencies, which are always
+// passed to rustc) are skipped.
+absl::StatusOr<std::string> RustcDepExternsArgs(
+    const Cmdline& cmdline, absl::Span<const std::string> used_dep_targets) {
+  CRUBIT_ASSIGN_OR_RETURN(std::string externs_json,
+                          GetFileContents(cmdline.rustc_dep_externs()));
+  llvm::Expected<std::map<std::string, std::string>> externs =
+      llvm::json::parse<std::map<std::string, std::string>>(externs_json);
+  if (!externs) {
+    return absl::InvalidArgumentError(
+        absl::StrCat("Malformed --rustc_dep_externs: ",
+                     llvm::toString(externs.takeError())));
+  }
+  std::string args;
+  for (const std::string& target : used_dep_targets) {
+    auto it = externs->find(target);
+    if (it == externs->end()) continue;
+    absl::StrAppend(&args, "--extern=", it->second, "\n");
+  }
+  return args;
+}
+
+// Writes `outputs` to the files requested by `cmdline`. Files that already
+// have the right contents are left untouched, so that build systems relying on
+// modification times don't rebuild their dependents.
+absl::Status WriteOutputs(const Cmdline& cmdline,
+                          const CachedOutputs& outputs) {
+  if (!cmdline.ir_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContentsIfChanged(cmdline.ir_out(), outputs.ir_json));
+  }
+
+  // Without --rs_out and --cc_out, only the binary IR was requested.
+  if (!cmdline.rs_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContentsIfChanged(cmdline.rs_out(), outputs.rs_api));
+    if (outputs.rs_api_shards.size() != cmdline.rs_out_shards().size()) {
+      return absl::InternalError(
+          "The number of rs_api shards doesn't match --rs_out_shards");
+    }
+    for (size_t i = 0; i < outputs.rs_api_shards.size(); ++i) {
+      CRUBIT_RETURN_IF_ERROR(SetFileContentsIfChanged(
+          cmdline.rs_out_shards()[i], outputs.rs_api_shards[i]));
+    }
+  }
+  if (!cmdline.cc_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContentsIfChanged(cmdline.cc_out(), outputs.rs_api_impl));
+  }
+
+  if (!cmdline.instantiations_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(SetFileContentsIfChanged(
+        cmdline.instantiations_out(), outputs.instantiations_json));
+  }
+
+  if (!cmdline.namespaces_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(SetFileContentsIfChanged(cmdline.namespaces_out(),
+                                                    outputs.namespaces_json));
+  }
+
+  if (!cmdline.error_report_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(SetFileContentsIfChanged(cmdline.error_report_out(),
+                                                    outputs.error_report));
+  }
+
+  if (!cmdline.size_report_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(SetFileContentsIfChanged(cmdline.size_report_out(),
+                                                    outputs.size_report));
+  }
+
+  if (!cmdline.rustc_dep_externs_out().empty()) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        std::string args,
+        RustcDepExternsArgs(cmdline, outputs.used_dep_targets));
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContentsIfChanged(cmdline.rustc_dep_externs_out(), args));
+  }
+
+  if (!cmdline.module_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContentsIfChanged(cmdline.module_out(), outputs.module));
+  }
+
+  return absl::OkStatus();
+}
+
+// Writes `query_profile` to `--query_profile_out`, if requested. The profile
+// isn't part of `CachedOutputs`, because it describes a single generation: it
+// is empty when the outputs were read from a cache instead.
+absl::Status WriteQueryProfile(const Cmdline& cmdline,
+                               absl::string_view query_profile) {
+  if (cmdline.query_profile_out().empty()) return absl::OkStatus();
+  return SetFileContents(cmdline.query_profile_out(), query_profile);
+}
+
+// Generates the outputs requested by `cmdline`, or reads them from the IR
+// cache, and writes them. The headers are read from `file_system`, if it is
+// non-null.
+absl::Status GenerateAndWriteOutputs(
+    Cmdline& cmdline, std::vector<std::string> clang_args,
+    TimingReport* timing_report, ChromeTrace* trace,
+    llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system) {
+  if (!cmdline.binary_ir_in().empty()) {
+    CRUBIT_ASSIGN_OR_RETURN(
+        BindingsAndMetadata bindings_and_metadata,
+        GenerateBindingsFromBinaryIrFile(cmdline, timing_report, trace));
+    CRUBIT_RETURN_IF_ERROR(
+        WriteQueryProfile(cmdline, bindings_and_metadata.query_profile));
+    CachedOutputs outputs = {
+        .rs_api = std::move(bindings_and_metadata.rs_api),
+        .rs_api_shards = std::move(bindings_and_metadata.rs_api_shards),
+        .rs_api_impl = std::move(bindings_and_metadata.rs_api_impl),
+        .error_report = std::move(bindings_and_metadata.error_report),
+        .size_report = std::move(bindings_and_metadata.size_report),
+        .used_dep_targets = std::move(bindings_and_metadata.used_dep_targets),
+    };
+    TimingReport::Phase phase(timing_report, "write_outputs");
+    return WriteOutputs(cmdline, outputs);
+  }
+
+  std::string cache_key;
+  if (!cmdline.ir_cache_dir().empty()) {
+    std::optional<CachedOutputs> cached_outputs;
+    {
+      TimingReport::Phase phase(timing_report, "read_ir_cache");
+      CRUBIT_ASSIGN_OR_RETURN(
+          cache_key,
+          IrCacheKey(cmdline, clang_args,
+                     /*virtual_headers_contents_for_testing=*/{}, file_system));
+      CRUBIT_ASSIGN_OR_RETURN(
+          cached_outputs, ReadFromIrCache(cmdline.ir_cache_dir(), cache_key));
+    }
+    if (cached_outputs.has_value()) {
+      TimingReport::Phase phase(timing_report, "write_outputs");
+      CRUBIT_RETURN_IF_ERROR(WriteQueryProfile(cmdline, ""));
+      return WriteOutputs(cmdline, *cached_outputs);
+    }
+  }
 
+  CRUBIT_ASSIGN_OR_RETURN(
+      BindingsAndMetadata bindings_and_metadata,
+      GenerateBindingsAndMetadata(cmdline, std::move(clang_args),
+                                  /*virtual_headers_contents_for_testing=*/{},
+                                  timing_report, trace,
+                                  std::move(file_system)));
+  CRUBIT_RETURN_IF_ERROR(
+      WriteQueryProfile(cmdline, bindings_and_metadata.query_profile));
+
+  // When caching, all outputs are stored, so that the entry can be used by
+  // invocations requesting a different set of optional outputs.
+  bool all_outputs = !cache_key.empty();
+  CachedOutputs outputs = {
+      .rs_api = std::move(bindings_and_metadata.rs_api),
+      .rs_api_shards = std::move(bindings_and_metadata.rs_api_shards),
+      .rs_api_impl = std::move(bindings_and_metadata.rs_api_impl),
+      .error_report = std::move(bindings_and_metadata.error_report),
+      .size_report = std::move(bindings_and_metadata.size_report),
+      .used_dep_targets = std::move(bindings_and_metadata.used_dep_targets),
+      .module = std::move(bindings_and_metadata.module),
+  };
+  std::string binary_ir = std::move(bindings_and_metadata.binary_ir);
+  {
+    TimingReport::Phase phase(timing_report, "serialize_outputs");
+    if (all_outputs || !cmdline.ir_out().empty()) {
+      outputs.ir_json =
+          IrToJson(bindings_and_metadata.ir, cmdline.codegen_threads());
+    }
+    if (all_outputs || !cmdline.instantiations_out().empty()) {
+      outputs.instantiations_json =
+          InstantiationsAsJson(bindings_and_metadata);
+    }
+    if (all_outputs || !cmdline.namespaces_out().empty()) {
+      outputs.namespaces_json =
+          crubit::NamespacesAsJson(bindings_and_metadata.namespaces);
+    }
+  }
+  if (!cache_key.empty()) {
+    TimingReport::Phase phase(timing_report, "write_ir_cache");
+    CRUBIT_RETURN_IF_ERROR(
+        WriteToIrCache(cmdline.ir_cache_dir(), cache_key, outputs));
+  }
+  TimingReport::Phase phase(timing_report, "write_outputs");
+  if (!cmdline.binary_ir_out().empty()) {
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContentsIfChanged(cmdline.binary_ir_out(), binary_ir));
+  }
+  return WriteOutputs(cmdline, outputs);
+}
+
+// Generates the bindings of a single target, described by `cmdline`.
+absl::Status Run(Cmdline& cmdline, std::vector<std::string> clang_args,
+                 llvm::IntrusiveRefCntPtr<llvm::vfs::FileSystem> file_system) {
   if (cmdline.do_nothing()) {
-    CRUBIT_RETURN_IF_ERROR(SetFileContents(
-        cmdline.rs_out(),
-        "// intentionally left empty because --do_nothing was passed."));
-    CRUBIT_RETURN_IF_ERROR(SetFileContents(
-        cmdline.cc_out(),
-        "// intentionally left empty because --do_nothing was passed."));
+    if (!cmdline.rs_out().empty()) {
+      CRUBIT_RETURN_IF_ERROR(SetFileContents(
+          cmdline.rs_out(),
+          "// intentionally left empty because --do_nothing was passed."));
+    }
+    for (const std::string& rs_out_shard : cmdline.rs_out_shards()) {
+      CRUBIT_RETURN_IF_ERROR(SetFileContents(
+          rs_out_shard,
+          "// intentionally left empty because --do_nothing was passed."));
+    }
+    if (!cmdline.cc_out().empty()) {
+      CRUBIT_RETURN_IF_ERROR(SetFileContents(
+          cmdline.cc_out(),
+          "// intentionally left empty because --do_nothing was passed."));
+    }
+    if (!cmdline.binary_ir_out().empty()) {
+      CRUBIT_RETURN_IF_ERROR(SetFileContents(cmdline.binary_ir_out(), ""));
+    }
     if (!cmdline.instantiations_out().empty()) {
       CRUBIT_RETURN_IF_ERROR(
           SetFileContents(cmdline.instantiations_out(), "[]"));
@@ -56,40 +292,125 @@ absl::Status Main(absl::Span<char* const> args) {
     return absl::OkStatus();
   }
 
-  std::vector<std::string> clang_args;
-  clang_args.insert(clang_args.end(), args.begin(), args.end());
+  std::optional<TimingReport> timing_report;
+  if (!cmdline.timing_report_out().empty()) timing_report.emplace();
+  std::optional<ChromeTrace> trace;
+  if (!cmdline.trace_out().empty()) trace.emplace();
+  CRUBIT_RETURN_IF_ERROR(GenerateAndWriteOutputs(
+      cmdline, std::move(clang_args),
+      timing_report.has_value() ? &*timing_report : nullptr,
+      trace.has_value() ? &*trace : nullptr, std::move(file_system)));
 
-  CRUBIT_ASSIGN_OR_RETURN(
-      BindingsAndMetadata bindings_and_metadata,
-      GenerateBindingsAndMetadata(cmdline, std::move(clang_args)));
-
-  if (!cmdline.ir_out().empty()) {
+  if (timing_report.has_value()) {
     CRUBIT_RETURN_IF_ERROR(
-        SetFileContents(cmdline.ir_out(), IrToJson(bindings_and_metadata.ir)));
+        SetFileContents(cmdline.timing_report_out(), timing_report->ToJson()));
   }
+  if (trace.has_value()) {
+    CRUBIT_RETURN_IF_ERROR(
+        SetFileContents(cmdline.trace_out(), trace->ToJson()));
+  }
+  return absl::OkStatus();
+}
 
-  CRUBIT_RETURN_IF_ERROR(
-      SetFileContents(cmdline.rs_out(), bindings_and_metadata.rs_api));
-  CRUBIT_RETURN_IF_ERROR(
-      SetFileContents(cmdline.cc_out(), bindings_and_metadata.rs_api_impl));
+absl::Status Main(absl::Span<char* const> args) {
+  CRUBIT_ASSIGN_OR_RETURN(Cmdline cmdline, Cmdline::Create());
+  return Run(cmdline, std::vector<std::string>(args.begin(), args.end()),
+             /*file_system=*/nullptr);
+}
 
-  if (!cmdline.instantiations_out().empty()) {
-    CRUBIT_RETURN_IF_ERROR(
-        SetFileContents(cmdline.instantiations_out(),
-                        InstantiationsAsJson(bindings_and_metadata)));
+// Parses `arguments`, which don't include argv[0], as the flags of the tool,
+// and returns the remaining arguments (including argv[0]).
+std::vector<std::string> ParseArguments(
+    char* argv0, const std::vector<std::string>& arguments) {
+  std::vector<char*> argv = {argv0};
+  for (const std::string& argument : arguments) {
+    argv.push_back(const_cast<char*>(argument.c_str()));
   }
+  std::vector<char*> args =
+      absl::ParseCommandLine(static_cast<int>(argv.size()), argv.data());
+  return std::vector<std::string>(args.begin(), args.end());
+}
 
-  if (!cmdline.namespaces_out().empty()) {
-    CRUBIT_RETURN_IF_ERROR(SetFileContents(
-        cmdline.namespaces_out(),
-        crubit::NamespacesAsJson(bindings_and_metadata.namespaces)));
+// Handles the work requests of a persistent worker. Each request carries the
+// same arguments as a one-shot invocation of the tool (other than argv[0]).
+// Flags are parsed anew for every request, starting from their default values.
+//
+// Keeping the process alive saves starting it and initializing LLVM for every
+// target. Headers whose digest is unchanged since an earlier request aren't
+// stat'ed or read again.
+absl::Status RunAsPersistentWorker(char* argv0) {
+  auto file_system_cache = llvm::makeIntrusiveRefCnt<FileSystemCache>(
+      llvm::vfs::getRealFileSystem());
+  return RunPersistentWorker(
+      std::cin, llvm::outs(), [&](const WorkRequest& request) {
+        absl::FlagSaver flag_saver;
+        std::vector<std::string> args =
+            ParseArguments(argv0, request.arguments);
+        CRUBIT_ASSIGN_OR_RETURN(Cmdline cmdline, Cmdline::Create());
+        file_system_cache->SetInputDigests(request.input_digests);
+        return Run(cmdline, std::move(args), file_system_cache);
+      });
+}
+
+// A target of a `--batch_manifest`, with its flags parsed.
+struct BatchTarget {
+  Cmdline cmdline;
+  std::vector<std::string> clang_args;
+};
+
+// Generates the bindings of all targets listed in the `--batch_manifest` file
+// at `manifest_path`, `threads` targets at a time.
+//
+// Besides starting the process and initializing LLVM once, this lets the
+// targets share a `FileSystemCache`, which stats and reads each path once:
+// their headers, and the include directories searched for them, overlap
+// heavily. The Rust code
+// generator and the in-process clang-format are stateless, so there is nothing
+// else to share.
+absl::Status RunBatch(char* argv0, absl::string_view manifest_path,
+                      int threads) {
+  if (threads < 0) {
+    return absl::InvalidArgumentError(
+        "please specify a non-negative number of --batch_threads");
   }
+  CRUBIT_ASSIGN_OR_RETURN(std::string manifest,
+                          GetFileContents(manifest_path));
+  CRUBIT_ASSIGN_OR_RETURN(std::vector<std::vector<std::string>> arguments,
+                          ParseBatchManifest(manifest));
 
-  if (!cmdline.error_report_out().empty()) {
-    CRUBIT_RETURN_IF_ERROR(SetFileContents(cmdline.error_report_out(),
-                                           bindings_and_metadata.error_report));
+  // Flags are global, so the flags of all targets are parsed upfront, one
+  // target at a time.
+  std::vector<BatchTarget> targets;
+  targets.reserve(arguments.size());
+  for (const std::vector<std::string>& target_arguments : arguments) {
+    absl::FlagSaver flag_saver;
+    std::vector<std::string> args = ParseArguments(argv0, target_arguments);
+    CRUBIT_ASSIGN_OR_RETURN(Cmdline cmdline, Cmdline::Create());
+    targets.push_back({.cmdline = std::move(cmdline),
+                       .clang_args = std::move(args)});
+  }
+
+  auto file_system_cache = llvm::makeIntrusiveRefCnt<FileSystemCache>(
+      llvm::vfs::getRealFileSystem());
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
   }
+  std::vector<absl::Status> statuses =
+      RunInParallel(targets.size(), threads, [&](int i) {
+        return Run(targets[i].cmdline, targets[i].clang_args,
+                   file_system_cache);
+      });
 
+  // Reports the errors of all targets, rather than only the first one.
+  std::optional<absl::StatusCode> error_code;
+  std::string errors;
+  for (size_t i = 0; i < statuses.size(); ++i) {
+    if (statuses[i].ok()) continue;
+    if (!error_code.has_value()) error_code = statuses[i].code();
+    absl::StrAppend(&errors, targets[i].cmdline.current_target().value(), ": ",
+                    statuses[i].message(), "\n");
+  }
+  if (error_code.has_value()) return absl::Status(*error_code, errors);
   return absl::OkStatus();
 }
 
@@ -97,7 +418,15 @@ absl::Status Main(absl::Span<char* const> args) {
 
 int main(int argc, char* argv[]) {
   auto args = absl::ParseCommandLine(argc, argv);
-  absl::Status status = crubit::Main(args);
+  absl::Status status;
+  if (absl::GetFlag(FLAGS_persistent_worker)) {
+    status = crubit::RunAsPersistentWorker(argv[0]);
+  } else if (!absl::GetFlag(FLAGS_batch_manifest).empty()) {
+    status = crubit::RunBatch(argv[0], absl::GetFlag(FLAGS_batch_manifest),
+                              absl::GetFlag(FLAGS_batch_threads));
+  } else {
+    status = crubit::Main(args);
+  }
   if (!status.ok()) {
     llvm::errs() << status.message() << "\n";
     return -1;
@@ -4,67 +4,207 @@
 
 #include "rs_bindings_from_cc/src_code_gen.h"
 
+#include <cstddef>
 #include <string>
+#include <utility>
+#include <vector>
 
+#include "absl/status/status.h"
 #include "absl/status/statusor.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "common/ffi_types.h"
 #include "common/status_macros.h"
+#include "rs_bindings_from_cc/chrome_trace.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
+#include "clang/Format/Format.h"
+#include "clang/Tooling/Core/Replacement.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Error.h"
 #include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
 
 namespace crubit {
 
-// FFI equivalent of `Bindings`.
+// FFI equivalent of `Bindings`: the buffers that Rust writes the outputs to.
 struct FfiBindings {
-  FfiU8SliceBox rs_api;
-  FfiU8SliceBox rs_api_impl;
-  FfiU8SliceBox error_report;
+  FfiStringBuffer rs_api;
+  FfiStringBuffer rs_api_impl;
+  FfiStringBuffer error_report;
+  FfiStringBuffer size_report;
+  FfiStringBuffer query_profile;
+  // One buffer per `rs_api` shard.
+  FfiStringBuffer* rs_api_shards;
+  // JSON array of the dependency targets whose crates `rs_api` names.
+  FfiStringBuffer used_dep_targets;
+  // JSON object with the time spent in the phases of the generation in Rust.
+  FfiStringBuffer timings;
+  // JSON array of the Chrome trace events recorded in Rust.
+  FfiStringBuffer trace_events;
 };
 
 // This function is implemented in Rust.
-extern "C" FfiBindings GenerateBindingsImpl(
-    FfiU8Slice json, FfiU8Slice crubit_support_path,
+extern "C" void GenerateBindingsImpl(
+    FfiU8Slice binary_ir, FfiU8Slice crubit_support_path,
     FfiU8Slice clang_format_exe_path, FfiU8Slice rustfmt_exe_path,
     FfiU8Slice rustfmt_config_path, bool generate_error_report,
-    SourceLocationDocComment generate_source_location_in_doc_comment);
+    bool generate_size_report, bool generate_query_profile,
+    SourceLocationDocComment generate_source_location_in_doc_comment,
+    size_t codegen_threads, FormatMode format_mode,
+    LayoutAssertions layout_assertions, bool omit_thunk_free_rs_api_impl,
+    bool collapse_opaque_fields, FfiU8Slice rs_api_shard_file_names,
+    bool trace, FfiBindings out);
 
-// Creates `Bindings` instance from copied data from `ffi_bindings`.
-static absl::StatusOr<Bindings> MakeBindingsFromFfiBindings(
-    const FfiBindings& ffi_bindings) {
-  Bindings bindings;
-
-  const FfiU8SliceBox& rs_api = ffi_bindings.rs_api;
-  const FfiU8SliceBox& rs_api_impl = ffi_bindings.rs_api_impl;
-  const FfiU8SliceBox& error_report = ffi_bindings.error_report;
+// Adds the Rust `timings_json` to `timing_report` (if not null).
+static absl::Status AddTimings(absl::string_view timings_json,
+                               TimingReport* timing_report) {
+  if (timing_report == nullptr) return absl::OkStatus();
+  llvm::Expected<llvm::json::Value> value = llvm::json::parse(
+      llvm::StringRef(timings_json.data(), timings_json.size()));
+  if (!value) {
+    return absl::InternalError(absl::StrCat(
+        "Malformed timings: ", llvm::toString(value.takeError())));
+  }
+  timing_report->Add("rust", std::move(*value));
+  return absl::OkStatus();
+}
 
-  bindings.rs_api = std::string(rs_api.ptr, rs_api.size);
-  bindings.rs_api_impl = std::string(rs_api_impl.ptr, rs_api_impl.size);
-  bindings.error_report = std::string(error_report.ptr, error_report.size);
-  return bindings;
+// Adds the Rust `trace_events_json` to `trace` (if not null).
+static absl::Status AddTraceEvents(absl::string_view trace_events_json,
+                                   ChromeTrace* trace) {
+  if (trace == nullptr) return absl::OkStatus();
+  llvm::Expected<llvm::json::Array> events =
+      llvm::json::parse<llvm::json::Array>(
+          llvm::StringRef(trace_events_json.data(), trace_events_json.size()));
+  if (!events) {
+    return absl::InternalError(absl::StrCat(
+        "Malformed trace events: ", llvm::toString(events.takeError())));
+  }
+  trace->AddEvents(std::move(*events));
+  return absl::OkStatus();
 }
 
-// Deallocates given `ffi_bindings` instance that was created in Rust.
-static void FreeFfiBindings(FfiBindings ffi_bindings) {
-  FreeFfiU8SliceBox(ffi_bindings.rs_api);
-  FreeFfiU8SliceBox(ffi_bindings.rs_api_impl);
-  FreeFfiU8SliceBox(ffi_bindings.error_report);
+// Formats `code` like `clang-format --style=google` does, without starting a
+// `clang-format` process.
+static absl::StatusOr<std::string> FormatCcInProcess(absl::string_view code) {
+  constexpr llvm::StringLiteral kFileName = "rs_api_impl.cc";
+  llvm::StringRef input(code.data(), code.size());
+  clang::format::FormatStyle style =
+      clang::format::getGoogleStyle(clang::format::FormatStyle::LK_Cpp);
+
+  // Like the `clang-format` executable, sort includes before reformatting.
+  clang::tooling::Replacements sort_includes = clang::format::sortIncludes(
+      style, input, {clang::tooling::Range(0, input.size())}, kFileName);
+  llvm::Expected<std::string> sorted =
+      clang::tooling::applyAllReplacements(input, sort_includes);
+  if (!sorted) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to sort includes: ", llvm::toString(sorted.takeError())));
+  }
+
+  clang::tooling::Replacements reformat = clang::format::reformat(
+      style, *sorted, {clang::tooling::Range(0, sorted->size())}, kFileName);
+  llvm::Expected<std::string> formatted =
+      clang::tooling::applyAllReplacements(*sorted, reformat);
+  if (!formatted) {
+    return absl::InternalError(absl::StrCat(
+        "Failed to format C++ code: ", llvm::toString(formatted.takeError())));
+  }
+  return std::move(*formatted);
 }
 
 absl::StatusOr<Bindings> GenerateBindings(
     const IR& ir, absl::string_view crubit_support_path,
     absl::string_view clang_format_exe_path, absl::string_view rustfmt_exe_path,
     absl::string_view rustfmt_config_path, bool generate_error_report,
-    SourceLocationDocComment generate_source_location_in_doc_comment) {
-  std::string json = llvm::formatv("{0}", ir.ToJson());
-  FfiBindings ffi_bindings = GenerateBindingsImpl(
-      MakeFfiU8Slice(json), MakeFfiU8Slice(crubit_support_path),
-      MakeFfiU8Slice(clang_format_exe_path), MakeFfiU8Slice(rustfmt_exe_path),
-      MakeFfiU8Slice(rustfmt_config_path), generate_error_report,
-      generate_source_location_in_doc_comment);
-  CRUBIT_ASSIGN_OR_RETURN(Bindings bindings,
-                          MakeBindingsFromFfiBindings(ffi_bindings));
-  FreeFfiBindings(ffi_bindings);
+    bool generate_size_report, bool generate_query_profile,
+    SourceLocationDocComment generate_source_location_in_doc_comment,
+    int codegen_threads, FormatMode format_mode,
+    LayoutAssertions layout_assertions, bool omit_thunk_free_rs_api_impl,
+    bool collapse_opaque_fields,
+    absl::Span<const std::string> rs_api_shard_file_names,
+    TimingReport* timing_report, ChromeTrace* trace) {
+  std::string binary_ir;
+  {
+    TimingReport::Phase phase(timing_report, "serialize_ir");
+    binary_ir = IrToBinary(ir, codegen_threads);
+  }
+  return GenerateBindingsFromBinaryIr(
+      binary_ir, crubit_support_path, clang_format_exe_path, rustfmt_exe_path,
+      rustfmt_config_path, generate_error_report, generate_size_report,
+      generate_query_profile, generate_source_location_in_doc_comment,
+      codegen_threads, format_mode, layout_assertions,
+      omit_thunk_free_rs_api_impl, collapse_opaque_fields,
+      rs_api_shard_file_names, timing_report, trace);
+}
+
+absl::StatusOr<Bindings> GenerateBindingsFromBinaryIr(
+    absl::string_view binary_ir, absl::string_view crubit_support_path,
+    absl::string_view clang_format_exe_path, absl::string_view rustfmt_exe_path,
+    absl::string_view rustfmt_config_path, bool generate_error_report,
+    bool generate_size_report, bool generate_query_profile,
+    SourceLocationDocComment generate_source_location_in_doc_comment,
+    int codegen_threads, FormatMode format_mode,
+    LayoutAssertions layout_assertions, bool omit_thunk_free_rs_api_impl,
+    bool collapse_opaque_fields,
+    absl::Span<const std::string> rs_api_shard_file_names,
+    TimingReport* timing_report, ChromeTrace* trace) {
+  std::string shard_file_names_json =
+      llvm::formatv("{0}", llvm::json::Value(llvm::json::Array(
+                               rs_api_shard_file_names.begin(),
+                               rs_api_shard_file_names.end())))
+          .str();
+  // Rust appends each output to its string here directly, rather than
+  // returning Rust allocations to be copied.
+  Bindings bindings;
+  bindings.rs_api_shards.resize(rs_api_shard_file_names.size());
+  std::vector<FfiStringBuffer> shard_buffers;
+  shard_buffers.reserve(bindings.rs_api_shards.size());
+  for (std::string& shard : bindings.rs_api_shards) {
+    shard_buffers.push_back(MakeFfiStringBuffer(shard));
+  }
+  std::string used_dep_targets_json;
+  std::string timings_json;
+  std::string trace_events_json;
+  FfiBindings ffi_bindings = {
+      .rs_api = MakeFfiStringBuffer(bindings.rs_api),
+      .rs_api_impl = MakeFfiStringBuffer(bindings.rs_api_impl),
+      .error_report = MakeFfiStringBuffer(bindings.error_report),
+      .size_report = MakeFfiStringBuffer(bindings.size_report),
+      .query_profile = MakeFfiStringBuffer(bindings.query_profile),
+      .rs_api_shards = shard_buffers.data(),
+      .used_dep_targets = MakeFfiStringBuffer(used_dep_targets_json),
+      .timings = MakeFfiStringBuffer(timings_json),
+      .trace_events = MakeFfiStringBuffer(trace_events_json),
+  };
+  {
+    TimingReport::Phase phase(timing_report, "generate_bindings_impl");
+    GenerateBindingsImpl(
+        MakeFfiU8Slice(binary_ir), MakeFfiU8Slice(crubit_support_path),
+        MakeFfiU8Slice(clang_format_exe_path), MakeFfiU8Slice(rustfmt_exe_path),
+        MakeFfiU8Slice(rustfmt_config_path), generate_error_report,
+        generate_size_report, generate_query_profile,
+        generate_source_location_in_doc_comment, codegen_threads, format_mode,
+        layout_assertions, omit_thunk_free_rs_api_impl, collapse_opaque_fields,
+        MakeFfiU8Slice(shard_file_names_json), trace != nullptr, ffi_bindings);
+  }
+  CRUBIT_RETURN_IF_ERROR(AddTimings(timings_json, timing_report));
+  CRUBIT_RETURN_IF_ERROR(AddTraceEvents(trace_events_json, trace));
+  llvm::Expected<std::vector<std::string>> used_dep_targets =
+      llvm::json::parse<std::vector<std::string>>(used_dep_targets_json);
+  if (!used_dep_targets) {
+    return absl::InternalError(absl::StrCat(
+        "Malformed used dependency targets: ",
+        llvm::toString(used_dep_targets.takeError())));
+  }
+  bindings.used_dep_targets = std::move(*used_dep_targets);
+  if (format_mode == FormatMode::Full && clang_format_exe_path.empty()) {
+    TimingReport::Phase phase(timing_report, "clang_format");
+    CRUBIT_ASSIGN_OR_RETURN(bindings.rs_api_impl,
+                            FormatCcInProcess(bindings.rs_api_impl));
+  }
   return bindings;
 }
 
@@ -6,11 +6,15 @@
 #define CRUBIT_RS_BINDINGS_FROM_CC_SRC_CODE_GEN_H_
 
 #include <string>
+#include <vector>
 
 #include "absl/status/statusor.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "common/ffi_types.h"
+#include "rs_bindings_from_cc/chrome_trace.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "rs_bindings_from_cc/timing_report.h"
 
 namespace crubit {
 
@@ -20,16 +24,82 @@ struct Bindings {
   std::string rs_api;
   // C++ source code.
   std::string rs_api_impl;
+  // Rust source code `include!`d by `rs_api`, one entry per shard.
+  std::vector<std::string> rs_api_shards;
   // Optional JSON error report.
   std::string error_report;
+  // Optional JSON report of the size of the code generated for each item.
+  std::string size_report;
+  // Optional JSON profile of the memoized queries of the generation.
+  std::string query_profile;
+  // The labels of the dependency targets whose crates `rs_api` or
+  // `rs_api_shards` name, sorted.
+  std::vector<std::string> used_dep_targets;
 };
 
-// Generates bindings from the given `IR`.
+// Generates bindings from the given `IR`. Bindings for top-level items are
+// generated on `codegen_threads` threads; the result does not depend on it.
+//
+// With `FormatMode::Full`, the C++ code is formatted by running
+// `clang_format_exe_path`, or, if it is empty, by the clang-format library
+// linked into this binary.
+//
+// With `LayoutAssertions::Consolidated`, the layouts of all records are checked
+// by a single assertion in `rs_api` and a single one in `rs_api_impl`.
+//
+// If `omit_thunk_free_rs_api_impl` is true and the bindings don't need any C++
+// thunks, `rs_api_impl` contains no includes and no layout assertions, so that
+// compiling it is nearly free.
+//
+// If `collapse_opaque_fields` is true, the fields of records without any field
+// of a Rust type are laid out as a single blob of bytes, which only needs the
+// size and alignment assertions of the record.
+//
+// If `rs_api_shard_file_names` is not empty, the bindings of top-level
+// namespaces are split across that many `rs_api_shards`, which `rs_api`
+// `include!`s under the given file names (relative to `rs_api`'s directory).
+//
+// If `timing_report` is not null, it receives the time spent in the phases of
+// the generation, including a breakdown of the generation in Rust under
+// "rust".
+//
+// If `trace` is not null, it receives a span for the generation of each item.
+//
+// If `generate_size_report` is true, `size_report` is a JSON array with an
+// entry for each generated item: its `ItemId`, kind and name, the number of
+// tokens and (unformatted) bytes generated for it in `rs_api` and
+// `rs_api_impl`, its number of thunks, and its number of generic parameters.
+// The sizes of namespaces and records include those of the items they contain.
+//
+// If `generate_query_profile` is true, `query_profile` is a JSON object with an
+// entry for each memoized query of the generation in Rust (e.g.
+// "rs_type_kind"): its number of calls, of cache hits and of executions, and
+// the wall time spent in its calls.
 absl::StatusOr<Bindings> GenerateBindings(
     const IR& ir, absl::string_view crubit_support_path,
     absl::string_view clang_format_exe_path, absl::string_view rustfmt_exe_path,
     absl::string_view rustfmt_config_path, bool generate_error_report,
-    SourceLocationDocComment generate_source_location_in_doc_comment);
+    bool generate_size_report, bool generate_query_profile,
+    SourceLocationDocComment generate_source_location_in_doc_comment,
+    int codegen_threads, FormatMode format_mode,
+    LayoutAssertions layout_assertions, bool omit_thunk_free_rs_api_impl,
+    bool collapse_opaque_fields,
+    absl::Span<const std::string> rs_api_shard_file_names = {},
+    TimingReport* timing_report = nullptr, ChromeTrace* trace = nullptr);
+
+// Same as `GenerateBindings`, but for IR that was serialized by `IrToBinary`,
+// possibly by another invocation of the tool.
+absl::StatusOr<Bindings> GenerateBindingsFromBinaryIr(
+    absl::string_view binary_ir, absl::string_view crubit_support_path,
+    absl::string_view clang_format_exe_path, absl::string_view rustfmt_exe_path,
+    absl::string_view rustfmt_config_path, bool generate_error_report,
+    bool generate_size_report, bool generate_query_profile,
+    SourceLocationDocComment generate_source_location_in_doc_comment,
+    int codegen_threads, FormatMode format_mode,
+    LayoutAssertions layout_assertions, bool omit_thunk_free_rs_api_impl,
+    bool collapse_opaque_fields,
+    absl::Span<const std::string> rs_api_shard_file_names = {},
+    TimingReport* timing_report = nullptr, ChromeTrace* trace = nullptr);
 
 }  // namespace crubit
 
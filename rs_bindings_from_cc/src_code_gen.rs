@@ -4,70 +4,119 @@
 #![allow(clippy::collapsible_else_if)]
 
 use arc_anyhow::{Context, Error, Result};
+use chrome_trace::ChromeTrace;
 use code_gen_utils::{format_cc_includes, make_rs_ident, CcInclude, NamespaceQualifier};
 use error_report::{anyhow, bail, ensure, ErrorReport, ErrorReporting, IgnoreErrors};
 use ffi_types::*;
 use ir::*;
 use itertools::Itertools;
 use once_cell::sync::Lazy;
-use proc_macro2::{Ident, Literal, TokenStream};
+use proc_macro2::{Delimiter, Group, Ident, Literal, TokenStream, TokenTree};
 use quote::{format_ident, quote, ToTokens};
-use std::collections::{BTreeSet, HashMap, HashSet};
+use std::collections::{BTreeMap, BTreeSet, HashMap, HashSet};
 use std::ffi::{OsStr, OsString};
 use std::fmt::Write as _;
 use std::iter::{self, Iterator};
-use std::panic::catch_unwind;
+use std::panic::{self, catch_unwind};
 use std::path::Path;
 use std::process;
 use std::ptr;
 use std::rc::Rc;
+use std::sync::atomic::{AtomicUsize, Ordering};
+use std::sync::{Arc, Mutex};
+use std::thread;
+use std::time::{Duration, Instant};
 use token_stream_printer::{
-    cc_tokens_to_formatted_string, rs_tokens_to_formatted_string, write_unformatted_tokens,
-    RustfmtConfig,
+    cc_tokens_to_formatted_string, rs_tokens_to_formatted_string, tokens_to_indented_string,
+    write_unformatted_tokens, RustfmtConfig,
 };
 
-/// FFI equivalent of `Bindings`.
+/// FFI equivalent of `Bindings`: the C++ buffers that the outputs are written
+/// to.
 #[repr(C)]
 pub struct FfiBindings {
-    rs_api: FfiU8SliceBox,
-    rs_api_impl: FfiU8SliceBox,
-    error_report: FfiU8SliceBox,
+    rs_api: FfiStringBuffer,
+    rs_api_impl: FfiStringBuffer,
+    error_report: FfiStringBuffer,
+    /// JSON array with the size of the code generated for each item (see
+    /// `SizeReport::to_json`), left empty unless `generate_size_report` is
+    /// true.
+    size_report: FfiStringBuffer,
+    /// JSON object with the calls of the memoized queries of the generation
+    /// (see `QueryProfile::to_json`), left empty unless
+    /// `generate_query_profile` is true.
+    query_profile: FfiStringBuffer,
+    /// One buffer per `rs_api` shard, i.e. per element of
+    /// `rs_api_shard_file_names`.
+    rs_api_shards: *mut FfiStringBuffer,
+    /// JSON array of the dependency targets whose crates `rs_api` names.
+    used_dep_targets: FfiStringBuffer,
+    /// JSON object with the time spent in the phases of the generation (see
+    /// `Timings::to_json`).
+    timings: FfiStringBuffer,
+    /// JSON array of the Chrome trace events recorded during the generation,
+    /// empty unless `trace` is true.
+    trace_events: FfiStringBuffer,
 }
 
-/// Deserializes IR from `json` and generates bindings source code.
+/// Deserializes IR from `binary_ir`, generates bindings source code, and
+/// appends it (and the other outputs) to the buffers of `out`.
+///
+/// The source code is formatted according to `format_mode`.  With
+/// `FormatMode::Full`, an empty `clang_format_exe_path` leaves the returned
+/// C++ source code unformatted.
+///
+/// If `trace` is true, a Chrome trace span is recorded for each generated item
+/// and returned in `trace_events`.
 ///
 /// This function panics on error.
 ///
 /// # Safety
 ///
 /// Expectations:
-///    * `json` should be a FfiU8Slice for a valid array of bytes with the given
-///      size.
+///    * `binary_ir` should be a FfiU8Slice for a valid array of bytes with the
+///      given size, produced by `IrToBinary` (see `ir.h`).
 ///    * `crubit_support_path` should be a FfiU8Slice for a valid array of bytes
 ///      representing an UTF8-encoded string
+///    * `rs_api_shard_file_names` should be a FfiU8Slice for a valid array of
+///      bytes representing a UTF8-encoded JSON array of strings
 ///    * `rustfmt_exe_path` and `rustfmt_config_path` should both be a
 ///      FfiU8Slice for a valid array of bytes representing an UTF8-encoded
 ///      string (without the UTF-8 requirement, it seems that Rust doesn't offer
 ///      a way to convert to OsString on Windows)
-///    * `json`, `crubit_support_path`, `rustfmt_exe_path`, and
-///      `rustfmt_config_path` shouldn't change during the call.
+///    * `out.rs_api_shards` should point to as many buffers as
+///      `rs_api_shard_file_names` has elements (and may dangle if there are
+///      none)
+///    * `binary_ir`, `crubit_support_path`, `rustfmt_exe_path`,
+///      `rustfmt_config_path`, and `rs_api_shard_file_names` shouldn't change
+///      during the call.
 ///
 /// Ownership:
 ///    * function doesn't take ownership of (in other words it borrows) the
-///      input params: `json`, `crubit_support_path`, `rustfmt_exe_path`, and
-///      `rustfmt_config_path`
-///    * function passes ownership of the returned value to the caller
+///      input params: `binary_ir`, `crubit_support_path`, `rustfmt_exe_path`,
+///      `rustfmt_config_path`, and `rs_api_shard_file_names`
+///    * the buffers of `out` stay owned by the caller
 #[no_mangle]
 pub unsafe extern "C" fn GenerateBindingsImpl(
-    json: FfiU8Slice,
+    binary_ir: FfiU8Slice,
     crubit_support_path: FfiU8Slice,
     clang_format_exe_path: FfiU8Slice,
     rustfmt_exe_path: FfiU8Slice,
     rustfmt_config_path: FfiU8Slice,
     generate_error_report: bool,
+    generate_size_report: bool,
+    generate_query_profile: bool,
     generate_source_loc_doc_comment: SourceLocationDocComment,
-) -> FfiBindings {
-    let json: &[u8] = json.as_slice();
+    codegen_threads: usize,
+    format_mode: FormatMode,
+    layout_assertions: LayoutAssertions,
+    omit_thunk_free_rs_api_impl: bool,
+    collapse_opaque_fields: bool,
+    rs_api_shard_file_names: FfiU8Slice,
+    trace: bool,
+    mut out: FfiBindings,
+) {
+    let binary_ir: &[u8] = binary_ir.as_slice();
     let crubit_support_path: &str = std::str::from_utf8(crubit_support_path.as_slice()).unwrap();
     let clang_format_exe_path: OsString =
         std::str::from_utf8(clang_format_exe_path.as_slice()).unwrap().into();
@@ -75,71 +124,200 @@ pub unsafe extern "C" fn GenerateBindingsImpl(
         std::str::from_utf8(rustfmt_exe_path.as_slice()).unwrap().into();
     let rustfmt_config_path: OsString =
         std::str::from_utf8(rustfmt_config_path.as_slice()).unwrap().into();
-    catch_unwind(|| {
+    let rs_api_shard_file_names: Vec<String> =
+        serde_json::from_slice(rs_api_shard_file_names.as_slice()).unwrap();
+    let rs_api_shard_buffers: &mut [FfiStringBuffer] = if rs_api_shard_file_names.is_empty() {
+        &mut []
+    } else {
+        std::slice::from_raw_parts_mut(out.rs_api_shards, rs_api_shard_file_names.len())
+    };
+    // `AssertUnwindSafe`: the process aborts on panic, so the buffers can't be
+    // observed in a broken state.
+    catch_unwind(panic::AssertUnwindSafe(|| {
         // It is ok to abort here.
         let errors: Rc<dyn ErrorReporting> =
             if generate_error_report { Rc::new(ErrorReport::new()) } else { Rc::new(IgnoreErrors) };
-        let Bindings { rs_api, rs_api_impl } = generate_bindings(
-            json,
+        let timings = Timings {
+            trace: Arc::new(if trace { ChromeTrace::new() } else { ChromeTrace::default() }),
+            size_report: Arc::new(SizeReport::new(generate_size_report)),
+            query_profile: Arc::new(QueryProfile::new(generate_query_profile)),
+            ..Timings::default()
+        };
+        let Bindings { rs_api, rs_api_impl, rs_api_shards, used_dep_targets } = generate_bindings(
+            binary_ir,
             crubit_support_path,
             &clang_format_exe_path,
             &rustfmt_exe_path,
             &rustfmt_config_path,
             errors.clone(),
             generate_source_loc_doc_comment,
+            codegen_threads,
+            format_mode,
+            layout_assertions,
+            omit_thunk_free_rs_api_impl,
+            collapse_opaque_fields,
+            &rs_api_shard_file_names,
+            &timings,
         )
         .unwrap();
-        FfiBindings {
-            rs_api: FfiU8SliceBox::from_boxed_slice(rs_api.into_bytes().into_boxed_slice()),
-            rs_api_impl: FfiU8SliceBox::from_boxed_slice(
-                rs_api_impl.into_bytes().into_boxed_slice(),
-            ),
-            error_report: FfiU8SliceBox::from_boxed_slice(
-                errors.serialize_to_vec().unwrap().into_boxed_slice(),
-            ),
+        // Each output is appended to its C++ buffer, and dropped, right away, so that
+        // the generated code only exists twice for as long as needed.
+        out.rs_api.append(rs_api.as_bytes());
+        drop(rs_api);
+        assert_eq!(rs_api_shards.len(), rs_api_shard_buffers.len());
+        for (shard, buffer) in rs_api_shards.into_iter().zip(rs_api_shard_buffers.iter_mut()) {
+            buffer.append(shard.as_bytes());
         }
-    })
+        out.rs_api_impl.append(rs_api_impl.as_bytes());
+        drop(rs_api_impl);
+        out.error_report.append(&errors.serialize_to_vec().unwrap());
+        if generate_size_report {
+            serde_json::to_writer(out.size_report, &timings.size_report.to_json()).unwrap();
+        }
+        if generate_query_profile {
+            serde_json::to_writer(out.query_profile, &timings.query_profile.to_json()).unwrap();
+        }
+        serde_json::to_writer(out.used_dep_targets, &used_dep_targets).unwrap();
+        serde_json::to_writer(out.timings, &timings.to_json()).unwrap();
+        serde_json::to_writer(out.trace_events, &timings.trace.to_json_events()).unwrap();
+    }))
     .unwrap_or_else(|_| process::abort())
 }
 
+// The queries that callers are expected to use are `transparent`: they record
+// the call in the `QueryProfile`, and forward it to the memoized query of the
+// same name prefixed with `memoized_`.
 #[salsa::query_group(BindingsGeneratorStorage)]
-trait BindingsGenerator {
+trait BindingsGenerator: ProfilesQueries {
     #[salsa::input]
     fn ir(&self) -> Rc<IR>;
     #[salsa::input]
     fn generate_source_loc_doc_comment(&self) -> SourceLocationDocComment;
     #[salsa::input]
+    fn layout_assertions(&self) -> LayoutAssertions;
+    #[salsa::input]
+    fn collapse_opaque_fields(&self) -> bool;
+    #[salsa::input]
     fn errors(&self) -> Rc<dyn ErrorReporting>;
 
+    #[salsa::transparent]
+    #[salsa::invoke(profiled_rs_type_kind)]
     fn rs_type_kind(&self, rs_type: RsType) -> Result<RsTypeKind>;
+    #[salsa::invoke(rs_type_kind)]
+    fn memoized_rs_type_kind(&self, rs_type: RsType) -> Result<RsTypeKind>;
 
+    #[salsa::transparent]
+    #[salsa::invoke(profiled_generate_func)]
     fn generate_func(&self, func: Rc<Func>) -> Result<Option<(Rc<GeneratedItem>, Rc<FunctionId>)>>;
+    #[salsa::invoke(generate_func)]
+    fn memoized_generate_func(
+        &self,
+        func: Rc<Func>,
+    ) -> Result<Option<(Rc<GeneratedItem>, Rc<FunctionId>)>>;
+
+    #[salsa::transparent]
+    #[salsa::invoke(profiled_overloaded_funcs)]
+    fn overloaded_funcs(&self) -> Rc<HashSet<ItemId>>;
+    #[salsa::invoke(overloaded_funcs)]
+    fn memoized_overloaded_funcs(&self) -> Rc<HashSet<ItemId>>;
 
-    fn overloaded_funcs(&self) -> Rc<HashSet<Rc<FunctionId>>>;
+    fn unique_ptr_pointees(&self) -> Rc<HashSet<ItemId>>;
 
+    #[salsa::transparent]
+    #[salsa::invoke(profiled_is_record_clonable)]
     fn is_record_clonable(&self, record: Rc<Record>) -> bool;
+    #[salsa::invoke(is_record_clonable)]
+    fn memoized_is_record_clonable(&self, record: Rc<Record>) -> bool;
 
+    #[salsa::transparent]
+    #[salsa::invoke(profiled_get_binding)]
     fn get_binding(
         &self,
         expected_function_name: UnqualifiedIdentifier,
         expected_param_types: Vec<RsTypeKind>,
     ) -> Option<(Ident, ImplKind)>;
+    #[salsa::invoke(get_binding)]
+    fn memoized_get_binding(
+        &self,
+        expected_function_name: UnqualifiedIdentifier,
+        expected_param_types: Vec<RsTypeKind>,
+    ) -> Option<(Ident, ImplKind)>;
+
+    fn functions_with_bindings_by_param_types(
+        &self,
+        function_name: UnqualifiedIdentifier,
+    ) -> Rc<HashMap<Vec<RsTypeKind>, Vec<Rc<Func>>>>;
+}
+
+/// Gives the queries of `BindingsGenerator` access to the `QueryProfile` of
+/// the `Database`, without making it an input that every query depends on.
+trait ProfilesQueries {
+    fn query_profile(&self) -> &QueryProfile;
+}
+
+fn profiled_rs_type_kind(db: &dyn BindingsGenerator, rs_type: RsType) -> Result<RsTypeKind> {
+    db.query_profile().call("rs_type_kind", || db.memoized_rs_type_kind(rs_type))
+}
+
+fn profiled_generate_func(
+    db: &dyn BindingsGenerator,
+    func: Rc<Func>,
+) -> Result<Option<(Rc<GeneratedItem>, Rc<FunctionId>)>> {
+    db.query_profile().call("generate_func", || db.memoized_generate_func(func))
+}
+
+fn profiled_overloaded_funcs(db: &dyn BindingsGenerator) -> Rc<HashSet<ItemId>> {
+    db.query_profile().call("overloaded_funcs", || db.memoized_overloaded_funcs())
+}
+
+fn profiled_is_record_clonable(db: &dyn BindingsGenerator, record: Rc<Record>) -> bool {
+    db.query_profile().call("is_record_clonable", || db.memoized_is_record_clonable(record))
+}
+
+fn profiled_get_binding(
+    db: &dyn BindingsGenerator,
+    expected_function_name: UnqualifiedIdentifier,
+    expected_param_types: Vec<RsTypeKind>,
+) -> Option<(Ident, ImplKind)> {
+    db.query_profile().call("get_binding", || {
+        db.memoized_get_binding(expected_function_name, expected_param_types)
+    })
 }
 
 #[salsa::database(BindingsGeneratorStorage)]
 #[derive(Default)]
 struct Database {
     storage: salsa::Storage<Self>,
+    /// Records a span for each item generated with this database (see
+    /// `generate_item_impl`).
+    trace: Arc<ChromeTrace>,
+    /// Records the size of each item generated with this database (see
+    /// `generate_item`).
+    size_report: Arc<SizeReport>,
+    /// Records the calls of the queries of this database (see
+    /// `ProfilesQueries`).
+    query_profile: Arc<QueryProfile>,
 }
 
 impl salsa::Database for Database {}
 
+impl ProfilesQueries for Database {
+    fn query_profile(&self) -> &QueryProfile {
+        &self.query_profile
+    }
+}
+
 /// Source code for generated bindings.
 struct Bindings {
     // Rust source code.
     rs_api: String,
     // C++ source code.
     rs_api_impl: String,
+    // Rust source code `include!`d by `rs_api`.
+    rs_api_shards: Vec<String>,
+    // The dependency targets whose crates `rs_api` or `rs_api_shards` name
+    // (see `used_dep_targets`).
+    used_dep_targets: Vec<String>,
 }
 
 /// Source code for generated bindings, as tokens.
@@ -148,36 +326,102 @@ struct BindingsTokens {
     rs_api: TokenStream,
     // C++ source code.
     rs_api_impl: TokenStream,
+    // Rust source code `include!`d by `rs_api`.
+    rs_api_shards: Vec<TokenStream>,
 }
 
 fn generate_bindings(
-    json: &[u8],
+    binary_ir: &[u8],
     crubit_support_path: &str,
     clang_format_exe_path: &OsStr,
     rustfmt_exe_path: &OsStr,
     rustfmt_config_path: &OsStr,
     errors: Rc<dyn ErrorReporting>,
     generate_source_loc_doc_comment: SourceLocationDocComment,
+    codegen_threads: usize,
+    format_mode: FormatMode,
+    layout_assertions: LayoutAssertions,
+    omit_thunk_free_rs_api_impl: bool,
+    collapse_opaque_fields: bool,
+    rs_api_shard_file_names: &[String],
+    timings: &Timings,
 ) -> Result<Bindings> {
-    let ir = Rc::new(deserialize_ir(json)?);
+    let ir = Rc::new(timings.measure("deserialize_ir", || deserialize_ir_binary(binary_ir))?);
+    timings.count_items(&ir);
 
-    let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(
+    let BindingsTokens { rs_api, rs_api_impl, rs_api_shards } = generate_bindings_tokens(
         ir.clone(),
         crubit_support_path,
         errors,
         generate_source_loc_doc_comment,
+        layout_assertions,
+        omit_thunk_free_rs_api_impl,
+        collapse_opaque_fields,
+        Some(ParallelCodegen {
+            num_threads: codegen_threads,
+            make_ir: &|| deserialize_ir_binary(binary_ir),
+        }),
+        rs_api_shard_file_names,
+        timings,
     )?;
-    let rs_api = {
-        let rustfmt_exe_path = Path::new(rustfmt_exe_path);
-        let rustfmt_config_path = if rustfmt_config_path.is_empty() {
-            None
-        } else {
-            Some(Path::new(rustfmt_config_path))
-        };
-        let rustfmt_config = RustfmtConfig::new(rustfmt_exe_path, rustfmt_config_path);
-        rs_tokens_to_formatted_string(rs_api, &rustfmt_config)?
+    let used_dep_targets = timings.measure("used_dep_targets", || {
+        used_dep_targets(&ir, iter::once(&rs_api).chain(&rs_api_shards))
+    });
+    let unformatted = |tokens| -> Result<String> {
+        let mut result = String::new();
+        write_unformatted_tokens(&mut result, tokens)?;
+        Ok(result)
+    };
+    let rustfmt_config = RustfmtConfig::new(
+        Path::new(rustfmt_exe_path),
+        if rustfmt_config_path.is_empty() { None } else { Some(Path::new(rustfmt_config_path)) },
+    );
+    let format_rs = |tokens| -> Result<String> {
+        timings.measure("format_rs", || -> Result<String> {
+            Ok(match format_mode {
+                FormatMode::Raw => unformatted(tokens)?,
+                FormatMode::Fast => tokens_to_indented_string(tokens, /* indent_width= */ 4)?,
+                FormatMode::Full => rs_tokens_to_formatted_string(tokens, &rustfmt_config)?,
+            })
+        })
     };
-    let rs_api_impl = cc_tokens_to_formatted_string(rs_api_impl, Path::new(clang_format_exe_path))?;
+    let format_rs = &format_rs;
+    // The shards are formatted on threads of their own, so that they don't add
+    // up on the critical path. `TokenStream`s are not `Send`, so they are sent
+    // as strings and parsed back on the formatting thread.
+    let rs_api_shards: Vec<String> = rs_api_shards.iter().map(|shard| shard.to_string()).collect();
+    let (rs_api, rs_api_shards) = thread::scope(|scope| -> Result<_> {
+        let shard_threads = rs_api_shards
+            .iter()
+            .map(|shard| {
+                scope.spawn(move || {
+                    format_rs(
+                        shard
+                            .parse()
+                            .map_err(|err| anyhow!("Failed to parse generated tokens: {}", err))?,
+                    )
+                })
+            })
+            .collect_vec();
+        let rs_api = format_rs(rs_api)?;
+        let rs_api_shards = shard_threads
+            .into_iter()
+            .map(|thread| thread.join().unwrap_or_else(|payload| panic::resume_unwind(payload)))
+            .collect::<Result<Vec<_>>>()?;
+        Ok((rs_api, rs_api_shards))
+    })?;
+    let rs_api_impl = timings.measure("format_cc", || -> Result<String> {
+        Ok(match format_mode {
+            FormatMode::Raw => unformatted(rs_api_impl)?,
+            FormatMode::Fast => tokens_to_indented_string(rs_api_impl, /* indent_width= */ 2)?,
+            // The caller formats the C++ code in-process (see `FormatCcInProcess` in
+            // `src_code_gen.cc`).
+            FormatMode::Full if clang_format_exe_path.is_empty() => unformatted(rs_api_impl)?,
+            FormatMode::Full => {
+                cc_tokens_to_formatted_string(rs_api_impl, Path::new(clang_format_exe_path))?
+            }
+        })
+    })?;
 
     // Add top-level comments that help identify where the generated bindings came
     // from.
@@ -227,8 +471,213 @@ fn generate_bindings(
         "{top_level_comment}\n\
         {rs_api_impl}"
     );
+    // `include!`d files can't have inner attributes, so the shards rely on the
+    // "@generated" marker alone to not be reformatted.
+    let rs_api_shards =
+        rs_api_shards.into_iter().map(|shard| format!("{top_level_comment}\n{shard}")).collect();
+
+    Ok(Bindings { rs_api, rs_api_impl, rs_api_shards, used_dep_targets })
+}
+
+/// Returns the labels of the targets, other than the current one, whose crates
+/// are named in `rs_api`, sorted.
+///
+/// Only the crates of the dependencies of the current target are considered:
+/// other crates (e.g. `ctor`) are always dependencies of the bindings.  This
+/// doesn't deserialize the items of `ir`.  A local variable or field that
+/// happens to have the name of a crate makes its target used, too, which is
+/// harmless.
+fn used_dep_targets<'a>(ir: &IR, rs_api: impl Iterator<Item = &'a TokenStream>) -> Vec<String> {
+    let mut targets_by_crate_name: HashMap<String, BTreeSet<&BazelLabel>> = HashMap::new();
+    for target in ir.targets() {
+        if let Some(crate_ident) = rs_imported_crate_name(target, ir) {
+            targets_by_crate_name.entry(crate_ident.to_string()).or_default().insert(target);
+        }
+    }
+    fn visit<'t>(
+        tokens: TokenStream,
+        targets_by_crate_name: &HashMap<String, BTreeSet<&'t BazelLabel>>,
+        used: &mut BTreeSet<&'t BazelLabel>,
+    ) {
+        for tt in tokens {
+            match tt {
+                TokenTree::Group(group) => visit(group.stream(), targets_by_crate_name, used),
+                TokenTree::Ident(ident) => {
+                    if let Some(targets) = targets_by_crate_name.get(&ident.to_string()) {
+                        used.extend(targets);
+                    }
+                }
+                _ => (),
+            }
+        }
+    }
+    let mut used = BTreeSet::new();
+    if !targets_by_crate_name.is_empty() {
+        for tokens in rs_api {
+            visit(tokens.clone(), &targets_by_crate_name, &mut used);
+        }
+    }
+    used.into_iter().map(|target| target.to_string()).collect()
+}
+
+/// How the Rust bindings of an inline getter read its result directly from
+/// `*this`, instead of calling a C++ thunk.
+///
+/// Reading the value in Rust lets calls to trivial getters be inlined even in
+/// builds without cross-language LTO.
+enum InlinedGetter {
+    /// The getter returns this field of a builtin scalar type by value, e.g.
+    /// `int size() const { return size_; }`. The target owning the getter must
+    /// enable the `experimental` feature.
+    Field(Ident),
+    /// The getter returns a builtin scalar stored at a fixed offset of the
+    /// record, or whether some bits of such an unsigned integer are set, e.g. a
+    /// protobuf field or has-bit getter. The target owning the getter must
+    /// enable the `proto_accessors` feature.
+    Read(InlinedRead),
+}
+
+/// Returns how the Rust bindings of `func` can read its result directly,
+/// instead of calling a C++ thunk.
+fn get_inlined_getter(db: &dyn BindingsGenerator, func: &Func) -> Option<InlinedGetter> {
+    if func.returned_field.is_none() && func.inlined_read.is_none() {
+        return None;
+    }
+    let ir = db.ir();
+    let features = ir.target_crubit_features(&func.owning_target);
+    if !matches!(func.name, UnqualifiedIdentifier::Identifier(_))
+        || func.is_member_or_descendant_of_class_template
+        || func.params.len() != 1
+    {
+        return None;
+    }
+    let instance_method_metadata =
+        func.member_func_metadata.as_ref()?.instance_method_metadata.as_ref()?;
+    if (instance_method_metadata.is_virtual && !instance_method_metadata.is_final)
+        || instance_method_metadata.reference == ReferenceQualification::RValue
+    {
+        return None;
+    }
+    let record = <&Rc<Record>>::try_from(ir.record_for_member_func(func)?).ok()?;
+    if record.is_union() {
+        return None;
+    }
+    let this_type = db.rs_type_kind(func.params[0].type_.rs_type.clone()).ok()?;
+    if !matches!(this_type, RsTypeKind::Reference { .. }) || !this_type.is_ref_to(record) {
+        return None;
+    }
+    // Only builtin types (which have no `decl_id`) are known to be `Copy` and to
+    // be represented the same way in C++ and in Rust.
+    if func.return_type.rs_type.decl_id.is_some() {
+        return None;
+    }
+    let return_type = db.rs_type_kind(func.return_type.rs_type.clone()).ok()?;
+
+    if features.contains(CrubitFeature::Experimental) {
+        if let Some(field) = get_inlined_field(db, func, record, &return_type) {
+            return Some(InlinedGetter::Field(field));
+        }
+    }
+    if features.contains(CrubitFeature::ProtoAccessors) {
+        let read = func.inlined_read.as_ref()?;
+        let is_primitive =
+            matches!(&return_type, RsTypeKind::Other { type_args, .. } if type_args.is_empty());
+        let is_const_ref =
+            matches!(this_type, RsTypeKind::Reference { mutability: Mutability::Const, .. });
+        let end = read.offset.checked_add(read.size)?;
+        if is_primitive
+            && is_const_ref
+            && end <= record.size_align.size as u64
+            && (read.bit_mask.is_none() || (read.size.is_power_of_two() && read.size <= 16))
+        {
+            return Some(InlinedGetter::Read(read.clone()));
+        }
+    }
+    None
+}
+
+/// Returns the Rust identifier of the field of `record` that `func` returns,
+/// if the bindings of `func` can read that field directly.
+fn get_inlined_field(
+    db: &dyn BindingsGenerator,
+    func: &Func,
+    record: &Record,
+    return_type: &RsTypeKind,
+) -> Option<Ident> {
+    let field_name = func.returned_field.as_ref()?;
+    let field = record.fields.iter().find(|field| field.identifier.as_ref() == Some(field_name))?;
+    if field.is_bitfield || field.is_no_unique_address {
+        return None;
+    }
+    let field_type = field.type_.as_ref().ok()?;
+    if field_type.rs_type.decl_id.is_some() {
+        return None;
+    }
+    let is_scalar = match return_type {
+        RsTypeKind::Pointer { .. } => true,
+        RsTypeKind::Other { type_args, .. } => type_args.is_empty(),
+        _ => false,
+    };
+    if !is_scalar || db.rs_type_kind(field_type.rs_type.clone()).ok()? != *return_type {
+        return None;
+    }
+    Some(make_rs_ident(&field_name.identifier))
+}
+
+/// Returns the body of the Rust bindings of `func`, which read its result from
+/// `this` as described by `getter`.
+fn generate_inlined_getter_body(
+    db: &dyn BindingsGenerator,
+    func: &Func,
+    getter: &InlinedGetter,
+    this: &TokenStream,
+    return_type: &RsTypeKind,
+) -> Result<TokenStream> {
+    let read = match getter {
+        InlinedGetter::Field(field) => return Ok(quote! { #this.#field }),
+        InlinedGetter::Read(read) => read,
+    };
+    let ir = db.ir();
+    let record = ir.record_for_member_func(func).ok_or_else(|| anyhow!("Not a member function"))?;
+    let record = <&Rc<Record>>::try_from(record)?;
+    let record_type = RsTypeKind::new_record(record.clone(), &ir)?;
+    let offset = Literal::u64_unsuffixed(read.offset);
+    let size = Literal::u64_unsuffixed(read.size);
+    let (value_type, result) = match read.bit_mask {
+        Some(mask) => {
+            let word = format_ident!("u{}", read.size * 8);
+            let mask = Literal::u64_unsuffixed(mask);
+            (quote! { #word }, quote! { (value & #mask) != 0 })
+        }
+        None => (return_type.to_token_stream(), quote! { value }),
+    };
+    // `Self` can't be used in the `const` items, so the record is named instead.
+    //
+    // The read is sound because the C++ getter reads the same bytes of `*this`,
+    // which is borrowed by `this`. It is unaligned in case the record is packed.
+    Ok(quote! {
+        const _: () = assert!(::core::mem::size_of::<#value_type>() == #size);
+        const _: () = assert!(#offset + #size <= ::core::mem::size_of::<#record_type>());
+        let value = unsafe {
+            ::core::ptr::read_unaligned(
+                (#this as *const Self as *const u8).add(#offset) as *const #value_type
+            )
+        };
+        #result
+    })
+}
 
-    Ok(Bindings { rs_api, rs_api_impl })
+/// Returns whether `func` is the default constructor of an `Unpin` record whose
+/// default value is all-zero bytes (see `Record::is_zero_initializable`), so
+/// that its bindings zero the memory instead of calling a C++ thunk.
+fn is_zeroing_default_constructor(db: &dyn BindingsGenerator, func: &Func) -> bool {
+    if !matches!(func.name, UnqualifiedIdentifier::Constructor) || func.params.len() != 1 {
+        return false;
+    }
+    let ir = db.ir();
+    ir.record_for_member_func(func)
+        .and_then(|record| <&Rc<Record>>::try_from(record).ok())
+        .map_or(false, |record| record.is_zero_initializable && record.is_unpin())
 }
 
 /// If we know the original C++ function is codegenned and already compatible
@@ -246,9 +695,12 @@ fn can_skip_cc_thunk(db: &dyn BindingsGenerator, func: &Func) -> bool {
     //
     // This is not great runtime-performance-wise in regular builds (inline function
     // will not be inlined, there will always be a function call), but it is
-    // correct. ThinLTO builds will be able to see through the thunk and inline
-    // code across the language boundary. For non-ThinLTO builds we plan to
+    // correct. Cross-language ThinLTO builds (see the `cross_language_lto` build
+    // setting in `bazel_support/BUILD`) see through the thunk and inline code
+    // across the language boundary. For non-ThinLTO builds we plan to
     // implement <internal link> which removes the runtime performance overhead.
+    // Until then, trivial getters avoid the thunk altogether (see
+    // `get_inlined_getter`).
     if func.is_inline {
         return false;
     }
@@ -272,9 +724,13 @@ fn can_skip_cc_thunk(db: &dyn BindingsGenerator, func: &Func) -> bool {
     // In terms of runtime performance, since this only occurs for virtual function
     // calls, which are already slow, it may not be such a big deal. We can
     // benchmark it later. :)
+    //
+    // `final` methods (and methods of `final` classes) are the exception: there is
+    // no other overrider to dispatch to, so we can call the concrete `A::Method`
+    // directly.
     if let Some(meta) = &func.member_func_metadata {
         if let Some(inst_meta) = &meta.instance_method_metadata {
-            if inst_meta.is_virtual {
+            if inst_meta.is_virtual && !inst_meta.is_final {
                 return false;
             }
         }
@@ -822,8 +1278,7 @@ fn api_func_shape(
             }
             // PartialOrd requires PartialEq, so we need to make sure operator== is
             // implemented for this Record type.
-            match get_binding(
-                db,
+            match db.get_binding(
                 UnqualifiedIdentifier::Operator(Operator { name: Rc::from("==") }),
                 param_types.to_vec(),
             ) {
@@ -1134,26 +1589,45 @@ fn get_binding(
     expected_function_name: UnqualifiedIdentifier,
     expected_param_types: Vec<RsTypeKind>,
 ) -> Option<(Ident, ImplKind)> {
-    db.ir()
-        .get_functions_by_name(&expected_function_name)
-        .filter(|function| generate_func(db, (*function).clone()).ok().flatten().is_some())
+    db.query_profile().record_execution("get_binding");
+    db.functions_with_bindings_by_param_types(expected_function_name)
+        .get(&expected_param_types)?
+        .iter()
         .find_map(|function| {
-            let mut function_param_types = function
-                .params
-                .iter()
-                .map(|param| db.rs_type_kind(param.type_.rs_type.clone()))
-                .collect::<Result<Vec<_>>>()
-                .ok()?;
-            if !function_param_types.iter().eq(expected_param_types.iter()) {
-                return None;
-            }
+            let mut function_param_types = expected_param_types.clone();
             api_func_shape(db, function, &mut function_param_types).ok().flatten()
         })
 }
 
+/// Returns the functions named `function_name` that have bindings, grouped by
+/// the Rust types of their parameters (and in IR order within a group), so
+/// that each `get_binding` call only looks at the functions it can return.
+fn functions_with_bindings_by_param_types(
+    db: &dyn BindingsGenerator,
+    function_name: UnqualifiedIdentifier,
+) -> Rc<HashMap<Vec<RsTypeKind>, Vec<Rc<Func>>>> {
+    let mut functions = HashMap::<Vec<RsTypeKind>, Vec<Rc<Func>>>::new();
+    for function in db.ir().get_functions_by_name(&function_name) {
+        if !matches!(db.generate_func(function.clone()), Ok(Some(_))) {
+            continue;
+        }
+        let Ok(param_types) = function
+            .params
+            .iter()
+            .map(|param| db.rs_type_kind(param.type_.rs_type.clone()))
+            .collect::<Result<Vec<_>>>()
+        else {
+            continue;
+        };
+        functions.entry(param_types).or_default().push(function.clone());
+    }
+    Rc::new(functions)
+}
+
 /// Returns whether the given record either implements or derives the Clone
 /// trait.
 fn is_record_clonable(db: &dyn BindingsGenerator, record: Rc<Record>) -> bool {
+    db.query_profile().record_execution("is_record_clonable");
     if !record.is_unpin() {
         return false;
     }
@@ -1228,6 +1702,7 @@ fn generate_func(
     db: &dyn BindingsGenerator,
     func: Rc<Func>,
 ) -> Result<Option<(Rc<GeneratedItem>, Rc<FunctionId>)>> {
+    db.query_profile().record_execution("generate_func");
     let ir = db.ir();
     let crate_root_path = crate_root_path_tokens(&ir);
     let mut features = BTreeSet::new();
@@ -1255,7 +1730,13 @@ fn generate_func(
     return_type.check_by_value()?;
     let param_idents =
         func.params.iter().map(|p| make_rs_ident(&p.identifier.identifier)).collect_vec();
-    let thunk = generate_func_thunk(db, &func, &param_idents, &param_types, &return_type)?;
+    let inlined_getter = get_inlined_getter(db, &func);
+    let zeroing_default_constructor = is_zeroing_default_constructor(db, &func);
+    let thunk = if inlined_getter.is_some() || zeroing_default_constructor {
+        quote! {}
+    } else {
+        generate_func_thunk(db, &func, &param_idents, &param_types, &return_type)?
+    };
 
     // If the Rust trait require a function to take the params by const reference
     // and the thunk takes some of its params by value then we should add a const
@@ -1274,7 +1755,7 @@ fn generate_func(
                 .into_iter()
                 .map(|param_type|
                     {if let RsTypeKind::Record { record: param_record, .. } = &param_type {
-                        if !is_record_clonable(db, param_record.clone()) {
+                        if !db.is_record_clonable(param_record.clone()) {
                             bail!(
                                 "function requires const ref params in Rust but C++ takes non-cloneable record {:?} by value {:?}",
                                 param_record,
@@ -1320,6 +1801,22 @@ fn generate_func(
     let api_func_def = {
         let thunk_ident = thunk_ident(&func);
         let func_body = match &impl_kind {
+            _ if inlined_getter.is_some() => {
+                // `get_inlined_getter` only accepts methods with a reference to
+                // `Self` as their only parameter, so `thunk_args[0]` is `self`.
+                generate_inlined_getter_body(
+                    db,
+                    &func,
+                    inlined_getter.as_ref().unwrap(),
+                    &thunk_args[0],
+                    &return_type,
+                )?
+            }
+            _ if zeroing_default_constructor => {
+                // SAFETY: The C++ default constructor would leave the object in the
+                // same state, which is a valid value (see `Record::is_zero_initializable`).
+                quote! { unsafe { ::core::mem::zeroed() } }
+            }
             ImplKind::Trait { trait_name: TraitName::UnpinConstructor { .. }, .. } => {
                 // SAFETY: A user-defined constructor is not guaranteed to
                 // initialize all the fields. To make the `assume_init()` call
@@ -1343,7 +1840,21 @@ fn generate_func(
                 // not generate the thunk at all, but this would be a bit of extra work.
                 //
                 // TODO(jeanpierreda): separately handle non-Unpin and non-trivial types.
-                let mut body = if return_type.is_c_abi_compatible_by_value() {
+                let mut body = if let RsTypeKind::StatusOr { value, status } = &return_type {
+                    // Both are `Unpin` (see `check_by_value`).
+                    quote! {
+                        let mut __value = ::core::mem::MaybeUninit::<#value>::uninit();
+                        let mut __status = ::core::mem::MaybeUninit::<#status>::uninit();
+                        if #crate_root_path::detail::#thunk_ident(
+                            &mut __value, &mut __status
+                            #( , #clone_prefixes #thunk_args #clone_suffixes )*
+                        ) {
+                            ::core::result::Result::Ok(__value.assume_init())
+                        } else {
+                            ::core::result::Result::Err(__status.assume_init())
+                        }
+                    }
+                } else if return_type.is_c_abi_compatible_by_value() {
                     quote! {
                         #crate_root_path::detail::#thunk_ident(
                             #( #clone_prefixes #thunk_args #clone_suffixes ),*
@@ -1603,13 +2114,23 @@ fn generate_func(
         }
     }
 
-    let generated_item = GeneratedItem {
+    let thunk_impls = generate_func_thunk_impl(db, &func)?;
+    let mut generated_item = GeneratedItem {
         item: api_func,
         thunks: thunk,
         features,
-        thunk_impls: generate_func_thunk_impl(db, &func)?,
+        has_cc_thunks: !thunk_impls.is_empty(),
+        thunk_impls,
         ..Default::default()
     };
+    if let Some(batch) =
+        generate_func_batch(db, &func, &func_name, &param_idents, &param_types, &return_type)?
+    {
+        generated_item.item.extend(batch.item);
+        generated_item.thunks.extend(batch.thunks);
+        generated_item.thunk_impls.extend(batch.thunk_impls);
+        generated_item.has_cc_thunks = true;
+    }
     Ok(Some((Rc::new(generated_item), Rc::new(function_id))))
 }
 
@@ -1695,7 +2216,39 @@ fn function_signature(
             } else {
                 quote! {#type_}
             };
-            if type_.is_c_abi_compatible_by_value() {
+            if let RsTypeKind::FunctionRef { return_type, param_types } = type_ {
+                // The signatures of trait methods can't take `impl FnMut`.
+                if let ImplKind::Trait { .. } = &impl_kind {
+                    bail!("`absl::FunctionRef` parameters are not supported in trait impls");
+                }
+                // The thunk receives a pointer to the closure, and an `extern "C"` function
+                // monomorphized for the closure type, which calls it. A panic in the closure
+                // aborts, because it can't unwind through the `extern "C"` function.
+                let data = format_ident!("__{}_data", ident);
+                let invoke = format_ident!("__{}_invoke", ident);
+                let invoker_type = format_function_ref_invoker_type(return_type, param_types);
+                let fn_mut = quote! { FnMut( #( #param_types ),* ) };
+                let return_frag = return_type.format_as_return_type_fragment(None);
+                let arg_idents = (0..param_types.len()).map(|i| format_ident!("__arg{i}"));
+                let arg_idents_ = arg_idents.clone();
+                thunk_prepare.extend(quote! {
+                    let (#data, #invoke) = {
+                        unsafe extern "C" fn __invoke<F: #fn_mut #return_frag>(
+                            __data: *mut ::core::ffi::c_void #( , #arg_idents: #param_types )*
+                        ) #return_frag {
+                            (*(__data as *mut F))( #( #arg_idents_ ),* )
+                        }
+                        fn __trampoline<F: #fn_mut #return_frag>(
+                            f: &mut F
+                        ) -> (*mut ::core::ffi::c_void, #invoker_type) {
+                            (f as *mut F as *mut ::core::ffi::c_void, __invoke::<F>)
+                        }
+                        __trampoline(&mut #ident)
+                    };
+                });
+                api_params.push(quote! {mut #ident: #quoted_type_or_self});
+                thunk_args.push(quote! {#data, #invoke});
+            } else if type_.is_c_abi_compatible_by_value() {
                 api_params.push(quote! {#ident: #quoted_type_or_self});
                 thunk_args.push(quote! {#ident});
             } else {
@@ -1839,52 +2392,171 @@ fn generate_func_thunk(
     };
     let lifetimes: Vec<_> = unique_lifetimes(param_types).collect();
 
-    // The first parameter is the output parameter, if any.
+    // The first parameters are the output parameters, if any.
     let mut param_types = param_types.iter();
     let mut param_idents = param_idents.iter();
-    let mut out_param = None;
-    let mut out_param_ident = None;
+    let mut out_params = vec![];
+    let mut out_param_idents = vec![];
     let mut return_type_fragment = return_type.format_as_return_type_fragment(None);
     if func.name == UnqualifiedIdentifier::Constructor {
         // For constructors, inject MaybeUninit into the type of `__this_` parameter.
         let first_param = param_types
             .next()
             .ok_or_else(|| anyhow!("Constructors should have at least one parameter (__this)"))?;
-        out_param = Some(first_param.format_mut_ref_as_uninitialized().with_context(|| {
+        out_params.push(first_param.format_mut_ref_as_uninitialized().with_context(|| {
             format!(
                 "Failed to format `__this` param for a constructor thunk: {:?}",
                 func.params.get(0)
             )
         })?);
-        out_param_ident = Some(param_idents.next().unwrap().clone());
+        out_param_idents.push(param_idents.next().unwrap().clone());
+    } else if let RsTypeKind::StatusOr { value, status } = return_type {
+        // The thunk moves either the value or the status out of the `StatusOr`, and returns
+        // whether it was the value.
+        out_params.push(quote! { &mut ::core::mem::MaybeUninit< #value > });
+        out_params.push(quote! { &mut ::core::mem::MaybeUninit< #status > });
+        out_param_idents.push(make_rs_ident("__value"));
+        out_param_idents.push(make_rs_ident("__status"));
+        return_type_fragment = quote! { -> bool };
     } else if !return_type.is_c_abi_compatible_by_value() {
         // For return types that can't be passed by value, create a new out parameter.
         // The lifetime doesn't matter, so we can insert a new anonymous lifetime here.
-        out_param = Some(quote! {
+        out_params.push(quote! {
             &mut ::core::mem::MaybeUninit< #return_type >
         });
-        out_param_ident = Some(make_rs_ident("__return"));
+        out_param_idents.push(make_rs_ident("__return"));
         return_type_fragment = quote! {};
     }
 
     let thunk_ident = thunk_ident(func);
 
     let generic_params = format_generic_params(&lifetimes, std::iter::empty::<syn::Ident>());
-    let param_idents = out_param_ident.as_ref().into_iter().chain(param_idents);
-    let param_types = out_param.into_iter().chain(param_types.map(|t| {
-        if !t.is_c_abi_compatible_by_value() {
-            quote! {&mut #t}
+    let mut thunk_param_idents = out_param_idents;
+    let mut thunk_param_types = out_params;
+    for (ident, t) in param_idents.zip(param_types) {
+        if let RsTypeKind::FunctionRef { return_type, param_types } = t {
+            // See `function_signature`.
+            thunk_param_idents.push(format_ident!("__{}_data", ident));
+            thunk_param_types.push(quote! {*mut ::core::ffi::c_void});
+            thunk_param_idents.push(format_ident!("__{}_invoke", ident));
+            thunk_param_types.push(format_function_ref_invoker_type(return_type, param_types));
+        } else if !t.is_c_abi_compatible_by_value() {
+            thunk_param_idents.push(ident.clone());
+            thunk_param_types.push(quote! {&mut #t});
         } else {
-            quote! {#t}
+            thunk_param_idents.push(ident.clone());
+            thunk_param_types.push(quote! {#t});
         }
-    }));
+    }
 
     Ok(quote! {
         #thunk_attr
-        pub(crate) fn #thunk_ident #generic_params( #( #param_idents: #param_types ),*
+        pub(crate) fn #thunk_ident #generic_params(
+            #( #thunk_param_idents: #thunk_param_types ),*
         ) #return_type_fragment ;
     })
 }
+
+/// Formats the type of the `extern "C"` function through which C++ calls the
+/// Rust closure passed as an `absl::FunctionRef` with the given signature. It
+/// takes a pointer to the closure, followed by the arguments of the closure.
+fn format_function_ref_invoker_type(
+    return_type: &RsTypeKind,
+    param_types: &[RsTypeKind],
+) -> TokenStream {
+    let return_frag = return_type.format_as_return_type_fragment(None);
+    quote! {
+        unsafe extern "C" fn(*mut ::core::ffi::c_void #( , #param_types )*) #return_frag
+    }
+}
+
+/// Generates the `#func_name_batch` variant of `func`, if the owning target
+/// opted into `CrubitFeature::BatchCalls`.
+///
+/// The batch variant takes one slice per parameter, plus an output slice for
+/// the results, and calls `func` over all of them with a single thunk call: the
+/// loop runs in the C++ thunk, where it can be inlined and vectorized.
+///
+/// Only free functions that take and return `Copy` types without lifetimes get
+/// a batch variant, so the slices can be handed to C++ as plain arrays.
+fn generate_func_batch(
+    db: &dyn BindingsGenerator,
+    func: &Func,
+    func_name: &Ident,
+    param_idents: &[Ident],
+    param_types: &[RsTypeKind],
+    return_type: &RsTypeKind,
+) -> Result<Option<GeneratedItem>> {
+    let ir = db.ir();
+    if !ir.target_crubit_features(&func.owning_target).contains(CrubitFeature::BatchCalls)
+        || func.member_func_metadata.is_some()
+        || param_types.is_empty()
+        || *return_type == RsTypeKind::Unit
+        || !param_types
+            .iter()
+            .chain(iter::once(return_type))
+            .all(|t| t.implements_copy() && t.lifetimes().next().is_none())
+    {
+        return Ok(None);
+    }
+    let UnqualifiedIdentifier::Identifier(id) = &func.name else {
+        return Ok(None);
+    };
+    let crate_root_path = crate_root_path_tokens(&ir);
+    let batch_name = format_ident!("{}_batch", func_name);
+    let thunk_ident = format_ident!("{}_batch", thunk_ident(func));
+    let doc = format!(
+        " Calls [`{func_name}`] once per element of the argument slices, and writes the results \
+        to `__return`.\n \n Panics if the slices don't have the same length."
+    );
+    let item = quote! {
+        #[doc = #doc]
+        #[inline(always)]
+        pub fn #batch_name( #( #param_idents: &[#param_types], )* __return: &mut [#return_type]) {
+            #( assert_eq!(#param_idents.len(), __return.len()); )*
+            unsafe {
+                #crate_root_path::detail::#thunk_ident(
+                    __return.len(), __return.as_mut_ptr() #( , #param_idents.as_ptr() )*
+                )
+            }
+        }
+    };
+    let thunks = quote! {
+        pub(crate) fn #thunk_ident(
+            __n: usize, __return: *mut #return_type #( , #param_idents: *const #param_types )*
+        );
+    };
+
+    let fn_ident = format_cc_ident(&id.identifier);
+    let namespace_qualifier = namespace_qualifier_of_item(func.id, &ir)?.format_for_cc()?;
+    let cc_param_idents =
+        func.params.iter().map(|p| format_cc_ident(&p.identifier.identifier)).collect_vec();
+    let cc_param_types = func
+        .params
+        .iter()
+        .map(|p| {
+            let mut cc_type = p.type_.cc_type.clone();
+            cc_type.is_const = false;
+            format_cc_type(&cc_type, &ir)
+        })
+        .collect::<Result<Vec<_>>>()?;
+    let mut cc_return_type = func.return_type.cc_type.clone();
+    cc_return_type.is_const = false;
+    let cc_return_type = format_cc_type(&cc_return_type, &ir)?;
+    let noexcept = func.is_noexcept.then(|| quote! { noexcept });
+    let thunk_impls = quote! {
+        extern "C" void #thunk_ident(
+            size_t __n, #cc_return_type* __return #( , #cc_param_types const* #cc_param_idents )*
+        ) #noexcept {
+            for (size_t __i = 0; __i < __n; ++__i) {
+                new (__return + __i) auto(
+                    #namespace_qualifier #fn_ident( #( #cc_param_idents[__i] ),* ));
+            }
+        }
+    };
+    Ok(Some(GeneratedItem { item, thunks, thunk_impls, has_cc_thunks: true, ..Default::default() }))
+}
+
 fn generate_doc_comment(
     comment: Option<&str>,
     source_loc: Option<&str>,
@@ -2086,29 +2758,33 @@ fn generate_record(db: &Database, record: &Rc<Record>) -> Result<GeneratedItem>
     );
     let mut field_copy_trait_assertions: Vec<TokenStream> = vec![];
 
+    // The layout type of each field is looked up once here, and shared by the
+    // field definitions and the offset assertions below.
     let fields_with_bounds = (record.fields.iter())
         .map(|field| {
+            let rs_type_kind = get_field_rs_type_kind_for_layout(db, field);
+            // We retain the end offset of fields only if we have a matching Rust type
+            // to represent them. Otherwise we'll fill up all the space to the next field.
+            // See: docs/struct_layout
+            let end = match &rs_type_kind {
+                // Regular field
+                Ok(_rs_type) => Some(field.offset + field.size),
+                // Opaque field
+                Err(_error) => {
+                    if record.is_union() {
+                        Some(field.size)
+                    } else {
+                        None
+                    }
+                }
+            };
             (
                 // We don't represent bitfields directly in Rust. We drop the field itself here
                 // and only retain the offset information. Adjacent bitfields then get merged in
                 // the next step.
-                if field.is_bitfield { None } else { Some(field) },
+                if field.is_bitfield { None } else { Some((field, rs_type_kind)) },
                 field.offset,
-                // We retain the end offset of fields only if we have a matching Rust type
-                // to represent them. Otherwise we'll fill up all the space to the next field.
-                // See: docs/struct_layout
-                match get_field_rs_type_kind_for_layout(db, field) {
-                    // Regular field
-                    Ok(_rs_type) => Some(field.offset + field.size),
-                    // Opaque field
-                    Err(_error) => {
-                        if record.is_union() {
-                            Some(field.size)
-                        } else {
-                            None
-                        }
-                    }
-                },
+                end,
                 vec![format!(
                     "{} : {} bits",
                     field.identifier.as_ref().map(|i| i.identifier.clone()).unwrap_or("".into()),
@@ -2123,164 +2799,196 @@ fn generate_record(db: &Database, record: &Rc<Record>) -> Result<GeneratedItem>
                 Ok((None, offset, end, [desc1, desc2].concat()))
             }
             pair => Err(pair),
-        });
+        })
+        .collect_vec();
 
     let mut override_alignment = record.override_alignment;
 
+    // With `collapse_opaque_fields`, a record none of whose fields has a Rust type is laid out as
+    // a single blob of bytes after its non-field data. Its size and alignment assertions then
+    // cover its whole layout, so its fields need no offset assertions. Bitfields and
+    // `[[no_unique_address]]` fields keep blobs of their own, which their accessors refer to.
+    let is_opaque = db.collapse_opaque_fields()
+        && !record.is_union()
+        && !fields_with_bounds.is_empty()
+        && fields_with_bounds.iter().all(|(field, ..)| match field {
+            Some((field, Err(_))) => !field.is_no_unique_address,
+            _ => false,
+        });
+
     // Pair up fields with the preceeding and following fields (if any):
     // - the end offset of the previous field determines if we need to insert
     //   padding.
     // - the start offset of the next field may be need to grow the current field to
     //   there.
     // This uses two separate `map` invocations on purpose to limit available state.
-    let field_definitions = iter::once(None)
-        .chain(fields_with_bounds.clone().map(Some))
-        .chain(iter::once(None))
-        .tuple_windows()
-        .map(|(prev, cur, next)| {
-            let (field, offset, end, desc) = cur.unwrap();
-            let prev_end = prev.as_ref().and_then(|(_, _, e, _)| *e).unwrap_or(offset);
-            let next_offset = next.map(|(_, o, _, _)| o);
-            let end = end.or(next_offset).unwrap_or(record.size_align.size * 8);
-
-            if let Some((Some(prev_field), _, Some(prev_end), _)) = prev {
-                assert!(
-                    record.is_union() || prev_end <= offset,
-                    "Unexpected offset+size for field {:?} in record {}",
-                    prev_field,
-                    record.cc_name.as_ref()
-                );
-            }
-
-            (field, prev_end, offset, end, desc)
-        })
-        .enumerate()
-        .map(|(field_index, (field, prev_end, offset, end, desc))| {
-            // `is_opaque_blob` and bitfield representations are always
-            // unaligned, even though the actual C++ field might be aligned.
-            // To put the current field at the right offset, we might need to
-            // insert some extra padding.
-            //
-            // No padding should be needed if the type of the current field is
-            // known (i.e. if the current field is correctly aligned based on
-            // its original type).
-            //
-            // We also don't need padding if we're in a union.
-            let padding_size_in_bits = if record.is_union()
-                || (field.is_some()
-                    && get_field_rs_type_kind_for_layout(db, field.unwrap()).is_ok())
-            {
-                0
-            } else {
-                let padding_start = (prev_end + 7) / 8 * 8; // round up to byte boundary
-                offset - padding_start
-            };
+    let field_definitions = if is_opaque {
+        override_alignment = true;
+        let reasons = fields_with_bounds
+            .iter()
+            .filter_map(|(field, ..)| match field {
+                Some((field, Err(err))) => {
+                    let name = field.identifier.as_ref().map_or("(unnamed)", |id| &*id.identifier);
+                    Some(format!("`{name}`: {err:#}"))
+                }
+                _ => None,
+            })
+            .join("\n");
+        let doc_comment = generate_doc_comment(
+            Some(&format!("Reason for representing the fields as a blob of bytes:\n{reasons}")),
+            None,
+            db.generate_source_loc_doc_comment(),
+        );
+        let blob = bit_padding(record.size_align.size * 8 - record.fields[0].offset);
+        vec![quote! { #doc_comment pub(crate) __opaque_fields: #blob }]
+    } else {
+        iter::once(None)
+            .chain(fields_with_bounds.iter().map(Some))
+            .chain(iter::once(None))
+            .tuple_windows()
+            .map(|(prev, cur, next)| {
+                let (field, offset, end, desc) = cur.unwrap();
+                let offset = *offset;
+                let prev_end = prev.and_then(|(_, _, e, _)| *e).unwrap_or(offset);
+                let next_offset = next.map(|(_, o, _, _)| *o);
+                let end = end.or(next_offset).unwrap_or(record.size_align.size * 8);
+
+                if let Some((Some((prev_field, _)), _, Some(prev_end), _)) = prev {
+                    assert!(
+                        record.is_union() || *prev_end <= offset,
+                        "Unexpected offset+size for field {:?} in record {}",
+                        prev_field,
+                        record.cc_name.as_ref()
+                    );
+                }
 
-            let padding = if padding_size_in_bits == 0 {
-                quote! {}
-            } else {
-                let padding_name = make_rs_ident(&format!("__padding{}", field_index));
-                let padding_type = bit_padding(padding_size_in_bits);
-                quote! { #padding_name: #padding_type, }
-            };
+                (field.as_ref(), prev_end, offset, end, desc)
+            })
+            .enumerate()
+            .map(|(field_index, (field, prev_end, offset, end, desc))| {
+                // `is_opaque_blob` and bitfield representations are always
+                // unaligned, even though the actual C++ field might be aligned.
+                // To put the current field at the right offset, we might need to
+                // insert some extra padding.
+                //
+                // No padding should be needed if the type of the current field is
+                // known (i.e. if the current field is correctly aligned based on
+                // its original type).
+                //
+                // We also don't need padding if we're in a union.
+                let padding_size_in_bits = if record.is_union()
+                    || field.map_or(false, |(_, rs_type_kind)| rs_type_kind.is_ok())
+                {
+                    0
+                } else {
+                    let padding_start = (prev_end + 7) / 8 * 8; // round up to byte boundary
+                    offset - padding_start
+                };
 
-            // Bitfields get represented by private padding to ensure overall
-            // struct layout is compatible.
-            if field.is_none() {
-                let name = make_rs_ident(&format!("__bitfields{}", field_index));
-                let bitfield_padding = bit_padding(end - offset);
-                override_alignment = true;
-                return Ok(quote! {
-                    __NEWLINE__ #(  __COMMENT__ #desc )*
-                    #padding #name: #bitfield_padding
-                });
-            }
-            let field = field.unwrap();
+                let padding = if padding_size_in_bits == 0 {
+                    quote! {}
+                } else {
+                    let padding_name = make_rs_ident(&format!("__padding{}", field_index));
+                    let padding_type = bit_padding(padding_size_in_bits);
+                    quote! { #padding_name: #padding_type, }
+                };
 
-            let ident = make_rs_field_ident(field, field_index);
-            let field_rs_type_kind = get_field_rs_type_kind_for_layout(db, field);
-            let doc_comment = match &field_rs_type_kind {
-                Ok(_) => generate_doc_comment(
-                    field.doc_comment.as_deref(),
-                    None,
-                    db.generate_source_loc_doc_comment(),
-                ),
-                Err(msg) => {
+                // Bitfields get represented by private padding to ensure overall
+                // struct layout is compatible.
+                if field.is_none() {
+                    let name = make_rs_ident(&format!("__bitfields{}", field_index));
+                    let bitfield_padding = bit_padding(end - offset);
                     override_alignment = true;
-                    let supplemental_text = format!(
-                        "Reason for representing this field as a blob of bytes:\n{:#}",
-                        msg
-                    );
-                    let new_text = match &field.doc_comment {
-                        None => supplemental_text,
-                        Some(old_text) => format!("{}\n\n{}", old_text.as_ref(), supplemental_text),
-                    };
-                    generate_doc_comment(
-                        Some(new_text.as_str()),
-                        None,
-                        db.generate_source_loc_doc_comment(),
-                    )
-                }
-            };
-            let access = if field.access == AccessSpecifier::Public && field_rs_type_kind.is_ok() {
-                quote! { pub }
-            } else {
-                quote! { pub(crate) }
-            };
-
-            let field_type = match field_rs_type_kind {
-                Err(_) => bit_padding(end - field.offset),
-                Ok(type_kind) => {
-                    let mut formatted = quote! {#type_kind};
-                    if should_implement_drop(record) || record.is_union() {
-                        if needs_manually_drop(&type_kind) {
-                            // TODO(b/212690698): Avoid (somewhat unergonomic) ManuallyDrop
-                            // if we can ask Rust to preserve field destruction order if the
-                            // destructor is the SpecialMemberFunc::NontrivialMembers
-                            // case.
-                            formatted = quote! { ::core::mem::ManuallyDrop<#formatted> }
-                        } else {
-                            field_copy_trait_assertions.push(quote! {
-                                const _: () = {
-                                    static_assertions::assert_impl_all!(#formatted: Copy);
-                                };
-                            });
-                        }
-                    };
-                    formatted
+                    return Ok(quote! {
+                        __NEWLINE__ #(  __COMMENT__ #desc )*
+                        #padding #name: #bitfield_padding
+                    });
                 }
-            };
+                let (field, field_rs_type_kind) = field.unwrap();
 
-            Ok(quote! { #padding #doc_comment #access #ident: #field_type })
-        })
-        .collect::<Result<Vec<_>>>()?;
+                let ident = make_rs_field_ident(field, field_index);
+                let doc_comment = match field_rs_type_kind {
+                    Ok(_) => generate_doc_comment(
+                        field.doc_comment.as_deref(),
+                        None,
+                        db.generate_source_loc_doc_comment(),
+                    ),
+                    Err(msg) => {
+                        override_alignment = true;
+                        let supplemental_text = format!(
+                            "Reason for representing this field as a blob of bytes:\n{:#}",
+                            msg
+                        );
+                        let new_text = match &field.doc_comment {
+                            None => supplemental_text,
+                            Some(old_text) => {
+                                format!("{}\n\n{}", old_text.as_ref(), supplemental_text)
+                            }
+                        };
+                        generate_doc_comment(
+                            Some(new_text.as_str()),
+                            None,
+                            db.generate_source_loc_doc_comment(),
+                        )
+                    }
+                };
+                let access =
+                    if field.access == AccessSpecifier::Public && field_rs_type_kind.is_ok() {
+                        quote! { pub }
+                    } else {
+                        quote! { pub(crate) }
+                    };
+
+                let field_type = match field_rs_type_kind {
+                    Err(_) => bit_padding(end - field.offset),
+                    Ok(type_kind) => {
+                        let mut formatted = quote! {#type_kind};
+                        if should_implement_drop(record) || record.is_union() {
+                            if needs_manually_drop(type_kind) {
+                                // TODO(b/212690698): Avoid (somewhat unergonomic) ManuallyDrop
+                                // if we can ask Rust to preserve field destruction order if the
+                                // destructor is the SpecialMemberFunc::NontrivialMembers
+                                // case.
+                                formatted = quote! { ::core::mem::ManuallyDrop<#formatted> }
+                            } else {
+                                field_copy_trait_assertions.push(quote! {
+                                    const _: () = {
+                                        static_assertions::assert_impl_all!(#formatted: Copy);
+                                    };
+                                });
+                            }
+                        };
+                        formatted
+                    }
+                };
+
+                Ok(quote! { #padding #doc_comment #access #ident: #field_type })
+            })
+            .collect::<Result<Vec<_>>>()?
+    };
 
-    let field_offset_assertions = if record.is_union() {
+    let field_offset_checks = if record.is_union() {
         // TODO(https://github.com/Gilnaa/memoffset/issues/66): generate assertions for unions once
         // offsetof supports them.
         vec![]
+    } else if is_opaque {
+        vec![]
     } else {
         fields_with_bounds
+            .iter()
             .enumerate()
-            .map(|(field_index, (field, _, _, _))| {
-                if let Some(field) = field {
-                    let field_ident = make_rs_field_ident(field, field_index);
-
-                    // The assertion below reinforces that the division by 8 on the next line is
-                    // justified (because the bitfields have been coallesced / filtered out
-                    // earlier).
-                    assert_eq!(field.offset % 8, 0);
-                    let expected_offset = Literal::usize_unsuffixed(field.offset / 8);
-
-                    let actual_offset_expr = quote! {
-                        memoffset::offset_of!(#qualified_ident, #field_ident)
-                    };
-                    quote! {
-                        const _: () = assert!(#actual_offset_expr == #expected_offset);
-                    }
-                } else {
-                    quote! {}
-                }
+            .filter_map(|(field_index, (field, _, _, _))| {
+                let (field, _) = field.as_ref()?;
+                let field_ident = make_rs_field_ident(field, field_index);
+
+                // The assertion below reinforces that the division by 8 on the next line is
+                // justified (because the bitfields have been coallesced / filtered out
+                // earlier).
+                assert_eq!(field.offset % 8, 0);
+                Some(LayoutCheck {
+                    actual: quote! { memoffset::offset_of!(#qualified_ident, #field_ident) },
+                    expected: Literal::usize_unsuffixed(field.offset / 8),
+                })
             })
             .collect_vec()
     };
@@ -2359,6 +3067,24 @@ fn generate_record(db: &Database, record: &Rc<Record>) -> Result<GeneratedItem>
         forward_declare::unsafe_define!(forward_declare::symbol!(#incomplete_symbol), #qualified_ident);
     };
 
+    // Without an annotation, `Send` and `Sync` are left to be inferred from the fields.
+    let send_impl = if record.is_send {
+        quote! {
+            __COMMENT__ "SAFETY: The C++ type is annotated as thread-safe or thread-compatible."
+            unsafe impl Send for #qualified_ident {}
+        }
+    } else {
+        quote! {}
+    };
+    let sync_impl = if record.is_sync {
+        quote! {
+            __COMMENT__ "SAFETY: The C++ type is annotated as thread-safe or thread-compatible."
+            unsafe impl Sync for #qualified_ident {}
+        }
+    } else {
+        quote! {}
+    };
+
     let no_unique_address_accessors = cc_struct_no_unique_address_impl(db, record)?;
     let mut record_generated_items = record
         .child_item_ids
@@ -2372,27 +3098,22 @@ fn generate_record(db: &Database, record: &Rc<Record>) -> Result<GeneratedItem>
         .collect::<Result<Vec<_>>>()?;
 
     record_generated_items.push(cc_struct_upcast_impl(record, &ir)?);
-
-    let mut items = vec![];
-    let mut thunks_from_record_items = vec![];
-    let mut thunk_impls_from_record_items = vec![cc_struct_layout_assertion(db, record)?];
-    let mut assertions_from_record_items = vec![];
-
+    record_generated_items.push(cc_struct_slice_impl(record, &ir)?);
+    record_generated_items.push(cc_struct_cc_delete_impl(db, record)?);
+    record_generated_items.push(cc_struct_bitfield_accessors_impl(db, record)?);
+
+    let mut record_items =
+        GeneratedItemsBuilder::new(quote! { __NEWLINE__ __NEWLINE__ }, quote! {});
+    let (cc_layout_assertions, cc_layout_check_entries) =
+        cc_layout_assertions(db, &cc_struct_layout_checks(db, record, !is_opaque)?);
+    record_items.push_thunk_impls(cc_layout_assertions);
+    record_items.cc_layout_checks.extend(cc_layout_check_entries);
     for generated in record_generated_items {
-        items.push(generated.item);
-        if !generated.thunks.is_empty() {
-            thunks_from_record_items.push(generated.thunks);
-        }
-        if !generated.assertions.is_empty() {
-            assertions_from_record_items.push(generated.assertions);
-        }
-        if !generated.thunk_impls.is_empty() {
-            thunk_impls_from_record_items.push(generated.thunk_impls);
-        }
-        features.extend(generated.features.clone());
+        record_items.push(generated);
     }
+    features.append(&mut record_items.features);
 
-    let record_tokens = quote! {
+    let mut record_tokens = quote! {
         #doc_comment
         #derives
         #recursively_pinned_attribute
@@ -2404,11 +3125,14 @@ fn generate_record(db: &Database, record: &Rc<Record>) -> Result<GeneratedItem>
 
         #incomplete_definition
 
+        #send_impl
+        #sync_impl
+
         #no_unique_address_accessors
 
         __NEWLINE__ __NEWLINE__
-        #( #items __NEWLINE__ __NEWLINE__)*
     };
+    record_tokens.extend(record_items.items);
 
     let record_trait_assertions = {
         let record_type_name = RsTypeKind::new_record(record.clone(), &ir)?.to_token_stream();
@@ -2436,36 +3160,120 @@ fn generate_record(db: &Database, record: &Rc<Record>) -> Result<GeneratedItem>
         add_conditional_assertion(should_implement_drop(record), quote! { Drop });
         assertions
     };
-    let size_align_assertions = rs_size_align_assertions(qualified_ident, &record.size_align);
-    let assertion_tokens = quote! {
+    let (size_align_assertions, size_align_check_entries) =
+        rs_layout_assertions(db, &rs_size_align_checks(&qualified_ident, &record.size_align));
+    let (field_offset_assertions, field_offset_check_entries) =
+        rs_layout_assertions(db, &field_offset_checks);
+    let mut assertion_tokens = quote! {
         #size_align_assertions
         #( #record_trait_assertions )*
-        #( #field_offset_assertions )*
+        #field_offset_assertions
         #( #field_copy_trait_assertions )*
-        #( #assertions_from_record_items )*
     };
-
-    let thunk_tokens = quote! {
-        #( #thunks_from_record_items )*
+    assertion_tokens.extend(record_items.assertions);
+    let mut rs_layout_checks = quote! {
+        #size_align_check_entries
+        #field_offset_check_entries
     };
+    rs_layout_checks.extend(record_items.rs_layout_checks);
 
     Ok(GeneratedItem {
         item: record_tokens,
         features,
         assertions: assertion_tokens,
-        thunks: thunk_tokens,
-        thunk_impls: quote! {#(#thunk_impls_from_record_items __NEWLINE__ __NEWLINE__)*},
-        ..Default::default()
+        thunks: record_items.thunks,
+        thunk_impls: record_items.thunk_impls,
+        has_cc_thunks: record_items.has_cc_thunks,
+        rs_layout_checks,
+        cc_layout_checks: record_items.cc_layout_checks,
     })
 }
 
-fn rs_size_align_assertions(type_name: impl ToTokens, size_align: &ir::SizeAlign) -> TokenStream {
+/// A check that the constant expression `actual` evaluates to `expected`, as
+/// part of asserting that a type has the layout known to the IR.
+struct LayoutCheck {
+    actual: TokenStream,
+    expected: Literal,
+}
+
+fn rs_size_align_checks(type_name: impl ToTokens, size_align: &ir::SizeAlign) -> Vec<LayoutCheck> {
     let type_name = type_name.into_token_stream();
-    let size = Literal::usize_unsuffixed(size_align.size);
-    let alignment = Literal::usize_unsuffixed(size_align.alignment);
+    vec![
+        LayoutCheck {
+            actual: quote! { ::core::mem::size_of::<#type_name>() },
+            expected: Literal::usize_unsuffixed(size_align.size),
+        },
+        LayoutCheck {
+            actual: quote! { ::core::mem::align_of::<#type_name>() },
+            expected: Literal::usize_unsuffixed(size_align.alignment),
+        },
+    ]
+}
+
+/// Returns the Rust assertions of `checks`, and their entries in the table
+/// checked by `rs_layout_check_table`. Depending on `db.layout_assertions()`,
+/// one of them is empty.
+fn rs_layout_assertions(db: &Database, checks: &[LayoutCheck]) -> (TokenStream, TokenStream) {
+    let actual = checks.iter().map(|check| &check.actual);
+    let expected = checks.iter().map(|check| &check.expected);
+    match db.layout_assertions() {
+        LayoutAssertions::PerItem => {
+            (quote! { #( const _: () = assert!(#actual == #expected); )* }, quote! {})
+        }
+        LayoutAssertions::Consolidated => (quote! {}, quote! { #( (#actual, #expected), )* }),
+    }
+}
+
+/// Returns the C++ assertions of `checks`, and their entries in the table
+/// checked by `cc_layout_check_table`. Depending on `db.layout_assertions()`,
+/// one of them is empty.
+fn cc_layout_assertions(db: &Database, checks: &[LayoutCheck]) -> (TokenStream, TokenStream) {
+    let actual = checks.iter().map(|check| &check.actual);
+    let expected = checks.iter().map(|check| &check.expected);
+    match db.layout_assertions() {
+        LayoutAssertions::PerItem => {
+            (quote! { #( static_assert(#actual == #expected); )* }, quote! {})
+        }
+        LayoutAssertions::Consolidated => (quote! {}, quote! { #( #actual == #expected, )* }),
+    }
+}
+
+/// Returns a single Rust assertion checking all the `rs_layout_checks` of the
+/// generated items, if any.
+///
+/// Each entry of the table is a pair of the actual and the expected value.
+/// Checking them in a loop is much cheaper for rustc than evaluating a
+/// separate `const` item per check.
+fn rs_layout_check_table(rs_layout_checks: TokenStream) -> TokenStream {
+    if rs_layout_checks.is_empty() {
+        return quote! {};
+    }
+    quote! {
+        const _: () = {
+            const LAYOUT_CHECKS: &[(usize, usize)] = &[ #rs_layout_checks ];
+            let mut i = 0;
+            while i < LAYOUT_CHECKS.len() {
+                assert!(LAYOUT_CHECKS[i].0 == LAYOUT_CHECKS[i].1);
+                i += 1;
+            }
+        };
+    }
+}
+
+/// Returns a single `static_assert` checking all the `cc_layout_checks` of the
+/// generated items, if any.
+fn cc_layout_check_table(cc_layout_checks: TokenStream) -> TokenStream {
+    if cc_layout_checks.is_empty() {
+        return quote! {};
+    }
     quote! {
-        const _: () = assert!(::core::mem::size_of::<#type_name>() == #size);
-        const _: () = assert!(::core::mem::align_of::<#type_name>() == #alignment);
+        static_assert([] {
+            constexpr bool kLayoutChecks[] = { #cc_layout_checks };
+            for (bool check : kLayoutChecks) {
+                if (!check) return false;
+            }
+            return true;
+        }());
     }
 }
 
@@ -2520,21 +3328,10 @@ fn generate_enum(db: &Database, enum_: &Enum) -> Result<GeneratedItem> {
     let underlying_type = db.rs_type_kind(enum_.underlying_type.rs_type.clone())?;
     let enumerator_names =
         enum_.enumerators.iter().map(|enumerator| make_rs_ident(&enumerator.identifier.identifier));
-    let enumerator_values = enum_.enumerators.iter().map(|enumerator| {
-        if underlying_type.is_bool() {
-            if enumerator.value.wrapped_value == 0 {
-                quote! {false}
-            } else {
-                quote! {true}
-            }
-        } else {
-            if enumerator.value.is_negative {
-                Literal::i64_unsuffixed(enumerator.value.wrapped_value as i64).into_token_stream()
-            } else {
-                Literal::u64_unsuffixed(enumerator.value.wrapped_value).into_token_stream()
-            }
-        }
-    });
+    let enumerator_values = enum_
+        .enumerators
+        .iter()
+        .map(|enumerator| format_integer_constant(&enumerator.value, underlying_type.is_bool()));
 
     Ok(quote! {
         #[repr(transparent)]
@@ -2557,6 +3354,81 @@ fn generate_enum(db: &Database, enum_: &Enum) -> Result<GeneratedItem> {
     .into())
 }
 
+/// Formats `value` as a literal of `bool` if `is_bool`, and as an unsuffixed
+/// integer literal otherwise.
+fn format_integer_constant(value: &IntegerConstant, is_bool: bool) -> TokenStream {
+    if is_bool {
+        if value.wrapped_value == 0 {
+            quote! {false}
+        } else {
+            quote! {true}
+        }
+    } else if value.is_negative {
+        Literal::i64_unsuffixed(value.wrapped_value as i64).into_token_stream()
+    } else {
+        Literal::u64_unsuffixed(value.wrapped_value).into_token_stream()
+    }
+}
+
+/// Generates a Rust `const` for a C++ constant. Its value is known at
+/// generation time, so no thunk is needed.
+fn generate_constant(db: &Database, constant: &Constant) -> Result<GeneratedItem> {
+    let ident = make_rs_ident(&constant.identifier.identifier);
+    let doc_comment = generate_doc_comment(
+        constant.doc_comment.as_deref(),
+        Some(&constant.source_loc),
+        db.generate_source_loc_doc_comment(),
+    );
+    let type_ = db
+        .rs_type_kind(constant.type_.rs_type.clone())
+        .with_context(|| format!("Failed to format the type of {:?}", constant))?;
+    let value = format_integer_constant(&constant.value, type_.is_bool());
+    let definition = quote! {
+        #doc_comment
+        pub const #ident: #type_ = #value;
+    };
+    let item = match constant.enclosing_record_id {
+        None => definition,
+        Some(record_id) => {
+            let ir = db.ir();
+            let record = ir.find_decl::<Rc<Record>>(record_id)?;
+            let record_name = make_rs_ident(record.rs_name.as_ref());
+            quote! { impl #record_name { #definition } }
+        }
+    };
+    Ok(item.into())
+}
+
+/// Generates an `extern` static for a C++ global variable, which refers to the
+/// variable's symbol directly.
+fn generate_global_var(db: &Database, global_var: &GlobalVar) -> Result<GeneratedItem> {
+    let ident = make_rs_ident(&global_var.identifier.identifier);
+    let doc_comment = generate_doc_comment(
+        global_var.doc_comment.as_deref(),
+        Some(&global_var.source_loc),
+        db.generate_source_loc_doc_comment(),
+    );
+    let type_ = db
+        .rs_type_kind(global_var.type_.rs_type.clone())
+        .with_context(|| format!("Failed to format the type of {:?}", global_var))?;
+    let mutability = (!global_var.type_.cc_type.is_const).then(|| quote! { mut });
+    let mangled_name = global_var.mangled_name.as_ref();
+    let (layout_assertions, rs_layout_checks) =
+        rs_layout_assertions(db, &rs_size_align_checks(&type_, &global_var.size_align));
+    Ok(GeneratedItem {
+        item: quote! {
+            extern "C" {
+                #doc_comment
+                #[link_name = #mangled_name]
+                pub static #mutability #ident: #type_;
+            }
+            #layout_assertions
+        },
+        rs_layout_checks,
+        ..Default::default()
+    })
+}
+
 fn generate_type_alias(db: &Database, type_alias: &TypeAlias) -> Result<GeneratedItem> {
     let ident = make_rs_ident(&type_alias.identifier.identifier);
     let doc_comment = generate_doc_comment(
@@ -2576,7 +3448,10 @@ fn generate_type_alias(db: &Database, type_alias: &TypeAlias) -> Result<Generate
 
 /// Generates Rust source code for a given `UnsupportedItem`.
 fn generate_unsupported(db: &Database, item: &UnsupportedItem) -> Result<GeneratedItem> {
-    db.errors().insert(item.cause());
+    let errors = db.errors();
+    if errors.is_enabled() {
+        errors.insert(item.cause());
+    }
 
     let source_loc = item.source_loc();
     let source_loc = match &source_loc {
@@ -2603,28 +3478,12 @@ fn generate_comment(comment: &Comment) -> Result<GeneratedItem> {
 
 fn generate_namespace(db: &Database, namespace: &Namespace) -> Result<GeneratedItem> {
     let ir = db.ir();
-    let mut items = vec![];
-    let mut thunks = vec![];
-    let mut thunk_impls = vec![];
-    let mut assertions = vec![];
-    let mut features = BTreeSet::new();
-
+    let mut namespace_items = GeneratedItemsBuilder::new(quote! {}, quote! {});
     for item_id in namespace.child_item_ids.iter() {
         let item = ir.find_decl(*item_id).with_context(|| {
             format!("Failed to look up namespace.child_item_ids for {:?}", namespace)
         })?;
-        let generated = generate_item(db, item)?;
-        items.push(generated.item);
-        if !generated.thunks.is_empty() {
-            thunks.push(generated.thunks);
-        }
-        if !generated.thunk_impls.is_empty() {
-            thunk_impls.push(generated.thunk_impls);
-        }
-        if !generated.assertions.is_empty() {
-            assertions.push(generated.assertions);
-        }
-        features.extend(generated.features);
+        namespace_items.push(generate_item(db, item)?);
     }
 
     let reopened_namespace_idx = ir.get_reopened_namespace_idx(namespace.id)?;
@@ -2656,23 +3515,24 @@ fn generate_namespace(db: &Database, namespace: &Namespace) -> Result<GeneratedI
         quote! {}
     };
 
+    let mut namespace_body = use_stmt_for_previous_namespace;
+    namespace_body.extend(namespace_items.items);
+    let namespace_body = Group::new(Delimiter::Brace, namespace_body);
     let namespace_tokens = quote! {
-        pub mod #name {
-            #use_stmt_for_previous_namespace
-
-            #( #items __NEWLINE__ __NEWLINE__ )*
-        }
+        pub mod #name #namespace_body
         __NEWLINE__
         #use_stmt_for_inline_namespace
     };
 
     Ok(GeneratedItem {
         item: namespace_tokens,
-        features,
-        thunks: quote! { #( #thunks )* },
-        thunk_impls: quote! { #( #thunk_impls )* },
-        assertions: quote! { #( #assertions )* },
-        ..Default::default()
+        features: namespace_items.features,
+        thunks: namespace_items.thunks,
+        thunk_impls: namespace_items.thunk_impls,
+        has_cc_thunks: namespace_items.has_cc_thunks,
+        assertions: namespace_items.assertions,
+        rs_layout_checks: namespace_items.rs_layout_checks,
+        cc_layout_checks: namespace_items.cc_layout_checks,
     })
 }
 
@@ -2682,7 +3542,14 @@ struct GeneratedItem {
     thunks: TokenStream,
     // C++ source code for helper functions.
     thunk_impls: TokenStream,
+    // Whether `thunk_impls` defines any C++ functions, rather than only
+    // asserting the C++ layouts of records.
+    has_cc_thunks: bool,
     assertions: TokenStream,
+    // Entries of the tables of layout checks in Rust and C++, with
+    // `LayoutAssertions::Consolidated`.
+    rs_layout_checks: TokenStream,
+    cc_layout_checks: TokenStream,
     features: BTreeSet<Ident>,
 }
 
@@ -2698,7 +3565,7 @@ impl PartialEq for GeneratedItem {
     fn eq(&self, other: &Self) -> bool {
         fn to_comparable_tuple(
             _x: &GeneratedItem,
-        ) -> (&BTreeSet<Ident>, String, String, String, String) {
+        ) -> (&BTreeSet<Ident>, String, String, String, bool, String, String, String) {
             // TokenStream doesn't implement `PartialEq`, so we convert to an equivalent
             // `String`. This is a bit expensive, but should be okay (especially
             // given that this code doesn't execute at this point).  Having a
@@ -2719,28 +3586,111 @@ impl PartialEq for GeneratedItem {
                 _x.item.to_string(),
                 _x.thunks.to_string(),
                 _x.thunk_impls.to_string(),
+                _x.has_cc_thunks,
                 _x.assertions.to_string(),
+                _x.rs_layout_checks.to_string(),
+                _x.cc_layout_checks.to_string(),
             )
         }
         to_comparable_tuple(self) == to_comparable_tuple(other)
     }
 }
 
+/// An append-only builder for the combined output of a sequence of
+/// `GeneratedItem`s (e.g. the children of a record or namespace).
+///
+/// Each `GeneratedItem` is moved into the builder as it is generated, rather
+/// than collected into `Vec<TokenStream>`s which are then re-quoted as a
+/// whole.
+struct GeneratedItemsBuilder {
+    /// The items, each followed by a blank line.
+    items: TokenStream,
+    thunks: TokenStream,
+    thunk_impls: TokenStream,
+    has_cc_thunks: bool,
+    assertions: TokenStream,
+    rs_layout_checks: TokenStream,
+    cc_layout_checks: TokenStream,
+    features: BTreeSet<Ident>,
+    /// Emitted after each non-empty `thunk_impls` and `assertions`
+    /// respectively.
+    thunk_impls_separator: TokenStream,
+    assertions_separator: TokenStream,
+}
+
+impl GeneratedItemsBuilder {
+    fn new(thunk_impls_separator: TokenStream, assertions_separator: TokenStream) -> Self {
+        GeneratedItemsBuilder {
+            items: TokenStream::new(),
+            thunks: TokenStream::new(),
+            thunk_impls: TokenStream::new(),
+            has_cc_thunks: false,
+            assertions: TokenStream::new(),
+            rs_layout_checks: TokenStream::new(),
+            cc_layout_checks: TokenStream::new(),
+            features: BTreeSet::new(),
+            thunk_impls_separator,
+            assertions_separator,
+        }
+    }
+
+    /// Appends all of `generated`.
+    fn push(&mut self, generated: GeneratedItem) {
+        let item = self.push_all_but_item(generated);
+        self.push_item(item);
+    }
+
+    /// Appends everything in `generated` except for its item, which is
+    /// returned instead.
+    fn push_all_but_item(&mut self, generated: GeneratedItem) -> TokenStream {
+        self.thunks.extend(generated.thunks);
+        self.push_thunk_impls(generated.thunk_impls);
+        self.has_cc_thunks |= generated.has_cc_thunks;
+        self.push_assertions(generated.assertions);
+        self.rs_layout_checks.extend(generated.rs_layout_checks);
+        self.cc_layout_checks.extend(generated.cc_layout_checks);
+        self.features.extend(generated.features);
+        generated.item
+    }
+
+    fn push_item(&mut self, item: TokenStream) {
+        self.items.extend(item);
+        self.items.extend(quote! { __NEWLINE__ __NEWLINE__ });
+    }
+
+    fn push_thunk_impls(&mut self, thunk_impls: TokenStream) {
+        if !thunk_impls.is_empty() {
+            self.thunk_impls.extend(thunk_impls);
+            self.thunk_impls.extend(self.thunk_impls_separator.clone());
+        }
+    }
+
+    fn push_assertions(&mut self, assertions: TokenStream) {
+        if !assertions.is_empty() {
+            self.assertions.extend(assertions);
+            self.assertions.extend(self.assertions_separator.clone());
+        }
+    }
+}
+
 /// Returns generated bindings for an item, or `Err` if bindings generation
 /// failed in such a way as to make the generated bindings as a whole invalid.
 fn generate_item(db: &Database, item: &Item) -> Result<GeneratedItem> {
-    match generate_item_impl(db, item) {
-        Ok(generated) => Ok(generated),
+    let generated = match generate_item_impl(db, item) {
+        Ok(generated) => generated,
         Err(err) => {
             let ir = db.ir();
             if has_bindings(db, item) != HasBindings::Yes {
                 // We didn't guarantee that bindings would exist, so it is not invalid to
                 // write down the error but continue.
-                return generate_unsupported(db, &UnsupportedItem::new_with_cause(&ir, item, err));
+                generate_unsupported(db, &UnsupportedItem::new_with_cause(&ir, item, err))?
+            } else {
+                return Err(err);
             }
-            Err(err)
         }
-    }
+    };
+    db.size_report.record(&db.ir(), item, &generated);
+    Ok(generated)
 }
 
 /// The implementation of generate_item, without the error recovery logic.
@@ -2753,12 +3703,14 @@ fn generate_item_impl(db: &Database, item: &Item) -> Result<GeneratedItem> {
             return Ok(GeneratedItem::default());
         }
     }
+    let _span =
+        db.trace.span("generate_item", || format!("{} {}", item.kind_name(), item.debug_name(&ir)));
     let overloaded_funcs = db.overloaded_funcs();
     let generated_item = match item {
         Item::Func(func) => match db.generate_func(func.clone())? {
             None => GeneratedItem::default(),
-            Some((item, function_id)) => {
-                if overloaded_funcs.contains(&function_id) {
+            Some((item, _)) => {
+                if overloaded_funcs.contains(&func.id) {
                     bail!("Cannot generate bindings for overloaded function")
                 } else {
                     (*item).clone()
@@ -2783,6 +3735,8 @@ fn generate_item_impl(db: &Database, item: &Item) -> Result<GeneratedItem> {
                 generate_type_alias(db, type_alias)?
             }
         }
+        Item::Constant(constant) => generate_constant(db, constant)?,
+        Item::GlobalVar(global_var) => generate_global_var(db, global_var)?,
         Item::UnsupportedItem(unsupported) => generate_unsupported(db, unsupported)?,
         Item::Comment(comment) => generate_comment(comment)?,
         Item::Namespace(namespace) => generate_namespace(db, namespace)?,
@@ -2804,16 +3758,20 @@ fn generate_item_impl(db: &Database, item: &Item) -> Result<GeneratedItem> {
                     an existing Rust type ({rs_type})",
                 cc_type = type_override.debug_name(&ir),
             );
-            let layout_assertions = if let Some(size_align) = &type_override.size_align {
-                rs_size_align_assertions(rs_type, size_align)
+            let layout_checks = if let Some(size_align) = &type_override.size_align {
+                rs_size_align_checks(rs_type, size_align)
             } else {
-                quote! {}
+                vec![]
             };
-            quote! {
-                __COMMENT__ #disable_comment
-                #layout_assertions
+            let (layout_assertions, rs_layout_checks) = rs_layout_assertions(db, &layout_checks);
+            GeneratedItem {
+                item: quote! {
+                    __COMMENT__ #disable_comment
+                    #layout_assertions
+                },
+                rs_layout_checks,
+                ..Default::default()
             }
-            .into()
         }
     };
 
@@ -2873,6 +3831,8 @@ fn has_bindings(db: &dyn BindingsGenerator, item: &Item) -> HasBindings {
         // Function bindings aren't guaranteed, because they don't _need_ to be guaranteed. We
         // choose not to generate code which relies on functions existing in other TUs.
         Item::Func(..) => HasBindings::Maybe,
+        // Nothing depends on variables, so their bindings aren't guaranteed either.
+        Item::Constant(..) | Item::GlobalVar(..) => HasBindings::Maybe,
         Item::TypeAlias(alias) => match db.rs_type_kind(alias.underlying_type.rs_type.clone()) {
             Ok(_) => HasBindings::Yes,
             Err(error) => HasBindings::No(NoBindingsReason::DependencyFailed {
@@ -2916,97 +3876,440 @@ fn crubit_features_for_item(item: &Item) -> flagset::FlagSet<ir::CrubitFeature>
 /// Identifies all functions having overloads that we can't import (yet).
 ///
 /// TODO(b/213280424): Implement support for overloaded functions.
-fn overloaded_funcs(db: &dyn BindingsGenerator) -> Rc<HashSet<Rc<FunctionId>>> {
-    let mut seen_funcs = HashSet::new();
-    let mut overloaded_funcs = HashSet::new();
+fn overloaded_funcs(db: &dyn BindingsGenerator) -> Rc<HashSet<ItemId>> {
+    db.query_profile().record_execution("overloaded_funcs");
+    // Grouping the functions once means that `generate_item` only needs to hash
+    // an `ItemId`, rather than the `syn::Path`s of a `FunctionId`.
+    let mut funcs_by_id = HashMap::<Rc<FunctionId>, Vec<ItemId>>::new();
     for func in db.ir().functions() {
-        if let Ok(Some(f)) = db.generate_func(func.clone()) {
-            let (.., function_id) = &f;
-            if !seen_funcs.insert(function_id.clone()) {
-                overloaded_funcs.insert(function_id.clone());
+        if let Ok(Some((_, function_id))) = db.generate_func(func.clone()) {
+            funcs_by_id.entry(function_id).or_default().push(func.id);
+        }
+    }
+    Rc::new(funcs_by_id.into_values().filter(|funcs| funcs.len() > 1).flatten().collect())
+}
+
+/// Returns the records that appear as `T` in a `std::unique_ptr<T>` (mapped to
+/// `cc_std::CcBox<T>`) in the IR, directly or through type aliases.
+fn unique_ptr_pointees(db: &dyn BindingsGenerator) -> Rc<HashSet<ItemId>> {
+    fn visit(ir: &IR, rs_type: &RsType, pointees: &mut HashSet<ItemId>) {
+        if matches!(rs_type.name.as_deref(), Some("#uniquePtr" | "#uniquePtr trivial_abi")) {
+            let mut pointee = rs_type.type_args.first();
+            while let Some(item) = pointee.and_then(|pointee| ir.item_for_type(pointee).ok()) {
+                match item {
+                    Item::TypeAlias(type_alias) => {
+                        pointee = Some(&type_alias.underlying_type.rs_type)
+                    }
+                    _ => {
+                        pointees.insert(item.id());
+                        break;
+                    }
+                }
+            }
+        }
+        for type_arg in rs_type.type_args.iter() {
+            visit(ir, type_arg, pointees);
+        }
+    }
+    let ir = db.ir();
+    let mut pointees = HashSet::new();
+    for item in ir.items() {
+        match item {
+            Item::Func(func) => {
+                visit(&ir, &func.return_type.rs_type, &mut pointees);
+                for param in &func.params {
+                    visit(&ir, &param.type_.rs_type, &mut pointees);
+                }
+            }
+            Item::Record(record) => {
+                for field in &record.fields {
+                    if let Ok(type_) = &field.type_ {
+                        visit(&ir, &type_.rs_type, &mut pointees);
+                    }
+                }
             }
+            Item::TypeAlias(type_alias) => {
+                visit(&ir, &type_alias.underlying_type.rs_type, &mut pointees)
+            }
+            _ => {}
+        }
+    }
+    Rc::new(pointees)
+}
+
+/// Wall time spent in the phases of `generate_bindings`, and the number of IR
+/// items of each kind, for the timing report of `rs_bindings_from_cc`.
+///
+/// Phases running on several threads at once (e.g. `generate_item` for
+/// different items) add up the time spent on each thread.
+#[derive(Default)]
+struct Timings {
+    phases: Mutex<BTreeMap<String, (usize, Duration)>>,
+    item_counts: Mutex<BTreeMap<&'static str, usize>>,
+    /// The trace of the generation, shared with the `Database`s generating the
+    /// items.
+    trace: Arc<ChromeTrace>,
+    /// The size report of the generation, shared with the `Database`s
+    /// generating the items.
+    size_report: Arc<SizeReport>,
+    /// The query profile of the generation, shared with the `Database`s
+    /// generating the items.
+    query_profile: Arc<QueryProfile>,
+}
+
+impl Timings {
+    /// Runs `f`, adding the time it takes to `phase`.
+    fn measure<T>(&self, phase: &str, f: impl FnOnce() -> T) -> T {
+        let start = Instant::now();
+        let result = f();
+        let elapsed = start.elapsed();
+        let mut phases = self.phases.lock().unwrap();
+        let (count, wall) = phases.entry(phase.to_string()).or_default();
+        *count += 1;
+        *wall += elapsed;
+        result
+    }
+
+    /// Runs `generate_item` for `item`, adding the time it takes to the
+    /// `generate_item` phase of the item's kind.
+    fn measure_generate_item(&self, db: &Database, item: &Item) -> Result<GeneratedItem> {
+        self.measure(&format!("generate_item.{}", item.kind_name()), || generate_item(db, item))
+    }
+
+    fn count_items(&self, ir: &IR) {
+        let mut item_counts = self.item_counts.lock().unwrap();
+        for item in ir.items() {
+            *item_counts.entry(item.kind_name()).or_default() += 1;
+        }
+    }
+
+    /// Returns `{"phases": {"<phase>": {"count": ..., "wall_seconds": ...}},
+    /// "item_counts": {"<kind>": ...}}`.
+    fn to_json(&self) -> serde_json::Value {
+        let phases: serde_json::Map<String, serde_json::Value> = self
+            .phases
+            .lock()
+            .unwrap()
+            .iter()
+            .map(|(phase, (count, wall))| {
+                (
+                    phase.clone(),
+                    serde_json::json!({"count": count, "wall_seconds": wall.as_secs_f64()}),
+                )
+            })
+            .collect();
+        let item_counts: serde_json::Map<String, serde_json::Value> = self
+            .item_counts
+            .lock()
+            .unwrap()
+            .iter()
+            .map(|(kind, count)| (kind.to_string(), serde_json::json!(count)))
+            .collect();
+        serde_json::json!({"phases": phases, "item_counts": item_counts})
+    }
+}
+
+/// The size of the code generated for each item, for the size report of
+/// `rs_bindings_from_cc`.
+///
+/// The sizes of an item include those of the items nested in it (e.g. the
+/// members of a record, or the items of a namespace).
+#[derive(Default)]
+struct SizeReport {
+    enabled: bool,
+    /// The entries of `to_json`, by item.
+    items: Mutex<BTreeMap<ItemId, serde_json::Value>>,
+}
+
+impl SizeReport {
+    fn new(enabled: bool) -> Self {
+        SizeReport { enabled, ..SizeReport::default() }
+    }
+
+    /// Records the size of `generated`, unless it is empty (e.g. for items of
+    /// other targets).
+    fn record(&self, ir: &IR, item: &Item, generated: &GeneratedItem) {
+        if !self.enabled {
+            return;
+        }
+        let rs_api = [
+            &generated.item,
+            &generated.thunks,
+            &generated.assertions,
+            &generated.rs_layout_checks,
+        ];
+        let rs_api_impl = [&generated.thunk_impls, &generated.cc_layout_checks];
+        if rs_api.iter().chain(&rs_api_impl).all(|tokens| tokens.is_empty()) {
+            return;
+        }
+        let tokens_in = |streams: &[&TokenStream]| -> usize {
+            streams.iter().map(|tokens| count_tokens((*tokens).clone())).sum()
+        };
+        let bytes_in = |streams: &[&TokenStream]| -> usize {
+            streams.iter().map(|tokens| tokens.to_string().len()).sum()
+        };
+        let generic_params = match item {
+            Item::Func(func) => func.lifetime_params.len(),
+            Item::Record(record) => record.lifetime_params.len(),
+            _ => 0,
+        };
+        let entry = serde_json::json!({
+            "id": item.id(),
+            "kind": item.kind_name(),
+            "name": &*item.debug_name(ir),
+            "rs_api_tokens": tokens_in(&rs_api),
+            "rs_api_bytes": bytes_in(&rs_api),
+            "rs_api_impl_tokens": tokens_in(&rs_api_impl),
+            "rs_api_impl_bytes": bytes_in(&rs_api_impl),
+            "thunks": count_thunks(generated.thunks.clone()),
+            "generic_params": generic_params,
+        });
+        self.items.lock().unwrap().insert(item.id(), entry);
+    }
+
+    /// Returns `[{"id": ..., "kind": "<kind>", "name": "<name>",
+    /// "rs_api_tokens": ..., "rs_api_bytes": ..., "rs_api_impl_tokens": ...,
+    /// "rs_api_impl_bytes": ..., "thunks": ..., "generic_params": ...}]`,
+    /// ordered by `ItemId`.
+    ///
+    /// Bytes are counted in the unformatted tokens, so they are only
+    /// comparable with each other.
+    fn to_json(&self) -> serde_json::Value {
+        serde_json::Value::Array(self.items.lock().unwrap().values().cloned().collect())
+    }
+}
+
+/// The calls of the memoized queries of `BindingsGenerator`, for the query
+/// profile of `rs_bindings_from_cc`.
+#[derive(Default)]
+struct QueryProfile {
+    enabled: bool,
+    queries: Mutex<BTreeMap<&'static str, QueryStats>>,
+}
+
+#[derive(Default)]
+struct QueryStats {
+    calls: usize,
+    /// The calls that missed the memo of the query, and ran it.
+    executions: usize,
+    /// Includes the time spent in the queries it calls, so that the time of
+    /// recursive calls is counted more than once.
+    wall: Duration,
+}
+
+impl QueryProfile {
+    fn new(enabled: bool) -> Self {
+        QueryProfile { enabled, ..QueryProfile::default() }
+    }
+
+    /// Runs `f`, a call of `query`, adding the time it takes to `query`.
+    fn call<T>(&self, query: &'static str, f: impl FnOnce() -> T) -> T {
+        if !self.enabled {
+            return f();
         }
+        let start = Instant::now();
+        let result = f();
+        let elapsed = start.elapsed();
+        let mut queries = self.queries.lock().unwrap();
+        let stats = queries.entry(query).or_default();
+        stats.calls += 1;
+        stats.wall += elapsed;
+        result
+    }
+
+    /// Records that `query` is being run, rather than returning a memoized
+    /// result.
+    fn record_execution(&self, query: &'static str) {
+        if self.enabled {
+            self.queries.lock().unwrap().entry(query).or_default().executions += 1;
+        }
+    }
+
+    /// Returns `{"<query>": {"calls": ..., "cache_hits": ..., "executions":
+    /// ..., "wall_seconds": ...}}`.
+    fn to_json(&self) -> serde_json::Value {
+        let queries: serde_json::Map<String, serde_json::Value> = self
+            .queries
+            .lock()
+            .unwrap()
+            .iter()
+            .map(|(query, stats)| {
+                (
+                    query.to_string(),
+                    serde_json::json!({
+                        "calls": stats.calls,
+                        "cache_hits": stats.calls.saturating_sub(stats.executions),
+                        "executions": stats.executions,
+                        "wall_seconds": stats.wall.as_secs_f64(),
+                    }),
+                )
+            })
+            .collect();
+        serde_json::Value::Object(queries)
     }
-    Rc::new(overloaded_funcs)
+}
+
+/// Returns the number of tokens in `tokens`, including those nested in groups,
+/// but not the `__NEWLINE__` and `__SPACE__` placeholders.
+fn count_tokens(tokens: TokenStream) -> usize {
+    tokens
+        .into_iter()
+        .map(|tt| match tt {
+            TokenTree::Group(group) => 1 + count_tokens(group.stream()),
+            TokenTree::Ident(ident) if ident == "__NEWLINE__" || ident == "__SPACE__" => 0,
+            _ => 1,
+        })
+        .sum()
+}
+
+/// Returns the number of functions declared in `thunks`, the contents of the
+/// `extern "C"` block of `mod detail`.
+///
+/// Function pointer types (e.g. in return types) are not counted, because their
+/// `fn` is not followed by a name.
+fn count_thunks(thunks: TokenStream) -> usize {
+    thunks
+        .into_iter()
+        .tuple_windows()
+        .filter(|(tt, next)| {
+            matches!(tt, TokenTree::Ident(ident) if ident == "fn")
+                && matches!(next, TokenTree::Ident(_))
+        })
+        .count()
+}
+
+/// Configuration for generating bindings for top-level items on worker threads.
+struct ParallelCodegen<'a> {
+    num_threads: usize,
+    /// Creates the `IR` used by a worker thread.
+    ///
+    /// `IR` and `Database` are built on `Rc`, so they can't be shared across
+    /// threads: instead, each worker creates its own copy of the `IR`. The copy
+    /// must be identical to the `IR` passed to `generate_bindings_tokens`.
+    make_ir: &'a (dyn Fn() -> Result<IR> + Sync),
 }
 
 // Returns the Rust code implementing bindings, plus any auxiliary C++ code
 // needed to support it.
+//
+// If `rs_api_shard_file_names` is not empty, top-level namespaces are moved
+// out of `rs_api` into one of `rs_api_shards` each, and `rs_api` `include!`s
+// the shards under the given file names.
 fn generate_bindings_tokens(
     ir: Rc<IR>,
     crubit_support_path: &str,
     errors: Rc<dyn ErrorReporting>,
     generate_source_loc_doc_comment: SourceLocationDocComment,
+    layout_assertions: LayoutAssertions,
+    omit_thunk_free_rs_api_impl: bool,
+    collapse_opaque_fields: bool,
+    parallel_codegen: Option<ParallelCodegen>,
+    rs_api_shard_file_names: &[String],
+    timings: &Timings,
 ) -> Result<BindingsTokens> {
     let mut db = Database::default();
+    db.trace = timings.trace.clone();
+    db.size_report = timings.size_report.clone();
+    db.query_profile = timings.query_profile.clone();
     db.set_ir(ir.clone());
     db.set_generate_source_loc_doc_comment(generate_source_loc_doc_comment);
-    db.set_errors(errors);
-    let mut items = vec![];
-    let mut thunks = vec![];
-    let mut thunk_impls = vec![
-        generate_rs_api_impl_includes(&mut db, crubit_support_path)?,
-        quote! {
-            __HASH_TOKEN__ pragma clang diagnostic push __NEWLINE__
-            // Disable Clang thread-safety-analysis warnings that would otherwise
-            // complain about thunks that call mutex locking functions in an unpaired way.
-            __HASH_TOKEN__ pragma clang diagnostic ignored "-Wthread-safety-analysis" __NEWLINE__
-        },
-    ];
-    let mut assertions = vec![];
+    db.set_layout_assertions(layout_assertions);
+    db.set_collapse_opaque_fields(collapse_opaque_fields);
+    db.set_errors(errors.clone());
+    let mut output = GeneratedItemsBuilder::new(
+        quote! { __NEWLINE__ __NEWLINE__ },
+        quote! { __NEWLINE__ __NEWLINE__ },
+    );
+    output.push_thunk_impls(generate_rs_api_impl_includes(&mut db, crubit_support_path)?);
+    output.push_thunk_impls(quote! {
+        __HASH_TOKEN__ pragma clang diagnostic push __NEWLINE__
+        // Disable Clang thread-safety-analysis warnings that would otherwise
+        // complain about thunks that call mutex locking functions in an unpaired way.
+        __HASH_TOKEN__ pragma clang diagnostic ignored "-Wthread-safety-analysis" __NEWLINE__
+    });
 
     // We import nullable pointers as an Option<&T> and assume that at the ABI
     // level, None is represented as a zero pointer value whereas Some is
     // represented as as non-zero pointer value. This seems like a pretty safe
     // assumption to make, but to provide some safeguard, assert that
     // `Option<&i32>` and `&i32` have the same size.
-    assertions.push(quote! {
+    output.push_assertions(quote! {
         const _: () = assert!(::core::mem::size_of::<Option<&i32>>() == ::core::mem::size_of::<&i32>());
     });
 
-    let mut features = BTreeSet::new();
-
     // For #![rustfmt::skip].
-    features.insert(make_rs_ident("custom_inner_attributes"));
+    output.features.insert(make_rs_ident("custom_inner_attributes"));
 
-    for top_level_item_id in ir.top_level_item_ids() {
-        let item =
+    let generated_items = match parallel_codegen {
+        Some(parallel_codegen) if parallel_codegen.num_threads > 1 => generate_items_in_parallel(
+            &ir,
+            &*errors,
+            generate_source_loc_doc_comment,
+            layout_assertions,
+            collapse_opaque_fields,
+            &parallel_codegen,
+            timings,
+        )?,
+        _ => ir
+            .top_level_item_ids()
+            .map(|top_level_item_id| {
+                let item = ir
+                    .find_decl(*top_level_item_id)
+                    .context("Failed to look up ir.top_level_item_ids")?;
+                timings.measure_generate_item(&db, item)
+            })
+            .collect::<Result<Vec<_>>>()?,
+    };
+    let mut shards = RsApiShards::new(rs_api_shard_file_names.len());
+    for (top_level_item_id, generated) in ir.top_level_item_ids().zip(generated_items) {
+        let item: &Item =
             ir.find_decl(*top_level_item_id).context("Failed to look up ir.top_level_item_ids")?;
-        let generated = generate_item(&db, item)?;
-        items.push(generated.item);
-        if !generated.thunks.is_empty() {
-            thunks.push(generated.thunks);
-        }
-        if !generated.assertions.is_empty() {
-            assertions.push(generated.assertions);
-        }
-        if !generated.thunk_impls.is_empty() {
-            thunk_impls.push(generated.thunk_impls);
+        let generated_item = output.push_all_but_item(generated);
+        match item {
+            Item::Namespace(namespace) if !shards.is_empty() => {
+                shards.push(namespace, generated_item)
+            }
+            _ => output.push_item(generated_item),
         }
-        features.extend(generated.features);
     }
+    let rs_layout_check_table = rs_layout_check_table(std::mem::take(&mut output.rs_layout_checks));
+    output.push_assertions(rs_layout_check_table);
+    let cc_layout_check_table = cc_layout_check_table(std::mem::take(&mut output.cc_layout_checks));
+    output.push_thunk_impls(cc_layout_check_table);
 
-    thunk_impls.push(quote! {
+    output.push_thunk_impls(quote! {
         __NEWLINE__
         __HASH_TOKEN__ pragma clang diagnostic pop __NEWLINE__
         // To satisfy http://cs/symbol:devtools.metadata.Presubmit.CheckTerminatingNewline check.
         __NEWLINE__
     });
 
-    let mod_detail = if thunks.is_empty() {
+    // Without thunks, `rs_api_impl` only contains the C++ layout assertions,
+    // which can be omitted so that compiling it doesn't parse the headers.
+    let rs_api_impl = if omit_thunk_free_rs_api_impl && !output.has_cc_thunks {
+        quote! {
+            __COMMENT__ "The bindings of this target don't need any C++ thunks." __NEWLINE__
+        }
+    } else {
+        output.thunk_impls
+    };
+
+    let mod_detail = if output.thunks.is_empty() {
         quote! {}
     } else {
+        let thunks = output.thunks;
         quote! {
             mod detail {
                 #[allow(unused_imports)]
                 use super::*;
                 extern "C" {
-                    #( #thunks )*
+                    #thunks
                 }
             }
         }
     };
 
+    let features = output.features;
     let features = if features.is_empty() {
         quote! {}
     } else {
@@ -3016,33 +4319,261 @@ fn generate_bindings_tokens(
         }
     };
 
-    Ok(BindingsTokens {
-        rs_api: quote! {
-            #features __NEWLINE__
-            #![no_std] __NEWLINE__
+    let mut rs_api = quote! {
+        #features __NEWLINE__
+        #![no_std] __NEWLINE__
 
-            // `rust_builtin_type_abi_assumptions.md` documents why the generated
-            // bindings need to relax the `improper_ctypes_definitions` warning
-            // for `char` (and possibly for other built-in types in the future).
-            #![allow(improper_ctypes)] __NEWLINE__
+        // `rust_builtin_type_abi_assumptions.md` documents why the generated
+        // bindings need to relax the `improper_ctypes_definitions` warning
+        // for `char` (and possibly for other built-in types in the future).
+        #![allow(improper_ctypes)] __NEWLINE__
 
-            // C++ names don't follow Rust guidelines:
-            #![allow(non_camel_case_types)] __NEWLINE__
-            #![allow(non_snake_case)] __NEWLINE__
-            #![allow(non_upper_case_globals)] __NEWLINE__
+        // C++ names don't follow Rust guidelines:
+        #![allow(non_camel_case_types)] __NEWLINE__
+        #![allow(non_snake_case)] __NEWLINE__
+        #![allow(non_upper_case_globals)] __NEWLINE__
 
-            #![deny(warnings)] __NEWLINE__ __NEWLINE__
+        #![deny(warnings)] __NEWLINE__ __NEWLINE__
+    };
+    rs_api.extend(output.items);
+    rs_api.extend(quote! {
+        #( include!(#rs_api_shard_file_names); __NEWLINE__ )*
 
-            #( #items __NEWLINE__ __NEWLINE__ )*
+        #mod_detail __NEWLINE__ __NEWLINE__
+    });
+    rs_api.extend(output.assertions);
 
-            #mod_detail __NEWLINE__ __NEWLINE__
+    Ok(BindingsTokens { rs_api, rs_api_impl, rs_api_shards: shards.into_tokens() })
+}
 
-            #( #assertions __NEWLINE__ __NEWLINE__ )*
-        },
-        rs_api_impl: quote! {#(#thunk_impls  __NEWLINE__ __NEWLINE__ )*},
-    })
+/// Distributes the bindings of top-level namespaces across a fixed number of
+/// `rs_api` shards.
+///
+/// All reopenings of a namespace go into the same shard, which is the
+/// smallest shard at the time the namespace is first seen. This keeps the
+/// shards balanced, and only depends on the order of the top-level items.
+struct RsApiShards {
+    shards: Vec<Vec<TokenStream>>,
+    /// The approximate size of each shard, in bytes of printed tokens.
+    sizes: Vec<usize>,
+    shard_of_namespace: HashMap<Rc<str>, usize>,
+}
+
+impl RsApiShards {
+    fn new(num_shards: usize) -> Self {
+        RsApiShards {
+            shards: vec![vec![]; num_shards],
+            sizes: vec![0; num_shards],
+            shard_of_namespace: HashMap::new(),
+        }
+    }
+
+    fn is_empty(&self) -> bool {
+        self.shards.is_empty()
+    }
+
+    fn push(&mut self, namespace: &Namespace, item: TokenStream) {
+        let sizes = &self.sizes;
+        let shard = *self
+            .shard_of_namespace
+            .entry(namespace.name.identifier.clone())
+            .or_insert_with(|| (0..sizes.len()).min_by_key(|&shard| sizes[shard]).unwrap());
+        self.sizes[shard] += item.to_string().len();
+        self.shards[shard].push(item);
+    }
+
+    fn into_tokens(self) -> Vec<TokenStream> {
+        self.shards
+            .into_iter()
+            .map(|items| quote! { #( #items __NEWLINE__ __NEWLINE__ )* })
+            .collect()
+    }
+}
+
+/// A `GeneratedItem` in a form that can be sent across threads.
+///
+/// `proc_macro2` token streams are not `Send`, so they are sent as strings and
+/// parsed back on the receiving thread.
+struct SendableGeneratedItem {
+    item: String,
+    thunks: String,
+    thunk_impls: String,
+    has_cc_thunks: bool,
+    assertions: String,
+    rs_layout_checks: String,
+    cc_layout_checks: String,
+    features: Vec<String>,
+}
+
+impl SendableGeneratedItem {
+    fn new(generated: GeneratedItem) -> Self {
+        SendableGeneratedItem {
+            item: generated.item.to_string(),
+            thunks: generated.thunks.to_string(),
+            thunk_impls: generated.thunk_impls.to_string(),
+            has_cc_thunks: generated.has_cc_thunks,
+            assertions: generated.assertions.to_string(),
+            rs_layout_checks: generated.rs_layout_checks.to_string(),
+            cc_layout_checks: generated.cc_layout_checks.to_string(),
+            features: generated.features.iter().map(|feature| feature.to_string()).collect(),
+        }
+    }
+
+    fn into_generated_item(self) -> Result<GeneratedItem> {
+        fn parse(tokens: &str) -> Result<TokenStream> {
+            tokens.parse().map_err(|err| anyhow!("Failed to parse generated tokens: {}", err))
+        }
+        Ok(GeneratedItem {
+            item: parse(&self.item)?,
+            thunks: parse(&self.thunks)?,
+            thunk_impls: parse(&self.thunk_impls)?,
+            has_cc_thunks: self.has_cc_thunks,
+            assertions: parse(&self.assertions)?,
+            rs_layout_checks: parse(&self.rs_layout_checks)?,
+            cc_layout_checks: parse(&self.cc_layout_checks)?,
+            features: self.features.iter().map(|feature| make_rs_ident(feature)).collect(),
+        })
+    }
+}
+
+/// An [`ErrorReporting`] strategy for worker threads, which aggregates the
+/// errors of each item, so that they can be merged into the main thread's
+/// [`ErrorReporting`] in source order.
+#[derive(Debug)]
+struct ErrorCollector {
+    errors: ErrorReport,
+    /// Whether the main thread's [`ErrorReporting`] records errors.
+    enabled: bool,
+}
+
+impl ErrorCollector {
+    fn new(enabled: bool) -> Self {
+        Self { errors: ErrorReport::new(), enabled }
+    }
+
+    fn take(&self) -> ErrorReport {
+        self.errors.take()
+    }
+}
+
+impl ErrorReporting for ErrorCollector {
+    fn insert(&self, error: &Error) {
+        if self.enabled {
+            self.errors.insert(error);
+        }
+    }
+
+    fn merge(&self, _report: ErrorReport) {
+        unreachable!("ErrorCollector errors are merged into the main thread's ErrorReporting")
+    }
+
+    fn serialize_to_vec(&self) -> anyhow::Result<Vec<u8>> {
+        unreachable!("ErrorCollector errors are merged into the main thread's ErrorReporting")
+    }
+
+    fn is_enabled(&self) -> bool {
+        self.enabled
+    }
+}
+
+/// Generates bindings for the top-level items of `ir` on
+/// `parallel_codegen.num_threads` worker threads.
+///
+/// Returns the generated items in the order of `ir.top_level_item_ids()`, and
+/// inserts the errors reported while generating them into `errors` in the same
+/// order, so that the result is the same as when generating them one by one.
+/// In particular, the errors reported while generating an item whose
+/// generation fails are inserted before that failure is returned.
+fn generate_items_in_parallel(
+    ir: &IR,
+    errors: &dyn ErrorReporting,
+    generate_source_loc_doc_comment: SourceLocationDocComment,
+    layout_assertions: LayoutAssertions,
+    collapse_opaque_fields: bool,
+    parallel_codegen: &ParallelCodegen,
+    timings: &Timings,
+) -> Result<Vec<GeneratedItem>> {
+    let num_items = ir.top_level_item_ids().count();
+    // Items are handed out one at a time, rather than in fixed chunks, because the cost of
+    // generating an item varies widely (e.g. a namespace vs. a single function).
+    let next_index = AtomicUsize::new(0);
+    let next_index = &next_index;
+    let make_ir = parallel_codegen.make_ir;
+    let errors_enabled = errors.is_enabled();
+    let worker_results = thread::scope(|scope| {
+        let workers = (0..parallel_codegen.num_threads.min(num_items))
+            .map(|_| {
+                scope.spawn(move || -> Result<Vec<(usize, GeneratedItemAndErrors)>> {
+                    let ir = Rc::new(make_ir()?);
+                    let worker_errors = Rc::new(ErrorCollector::new(errors_enabled));
+                    let mut db = Database::default();
+                    db.trace = timings.trace.clone();
+                    db.size_report = timings.size_report.clone();
+                    db.query_profile = timings.query_profile.clone();
+                    db.set_ir(ir.clone());
+                    db.set_generate_source_loc_doc_comment(generate_source_loc_doc_comment);
+                    db.set_layout_assertions(layout_assertions);
+                    db.set_collapse_opaque_fields(collapse_opaque_fields);
+                    db.set_errors(worker_errors.clone());
+
+                    let top_level_item_ids = ir.top_level_item_ids().collect_vec();
+                    let mut generated_items = vec![];
+                    loop {
+                        let index = next_index.fetch_add(1, Ordering::Relaxed);
+                        let Some(top_level_item_id) = top_level_item_ids.get(index) else {
+                            break;
+                        };
+                        let generated = ir
+                            .find_decl(**top_level_item_id)
+                            .context("Failed to look up ir.top_level_item_ids")
+                            .and_then(|item| timings.measure_generate_item(&db, item))
+                            .map(SendableGeneratedItem::new);
+                        generated_items.push((index, (generated, worker_errors.take())));
+                    }
+                    Ok(generated_items)
+                })
+            })
+            .collect_vec();
+        workers
+            .into_iter()
+            .map(|worker| worker.join().unwrap_or_else(|payload| panic::resume_unwind(payload)))
+            .collect_vec()
+    });
+
+    let mut generated_items: Vec<Option<GeneratedItemAndErrors>> =
+        iter::repeat_with(|| None).take(num_items).collect();
+    let mut worker_error = None;
+    for worker_result in worker_results {
+        match worker_result {
+            Ok(worker_items) => {
+                for (index, generated) in worker_items {
+                    generated_items[index] = Some(generated);
+                }
+            }
+            Err(err) => {
+                worker_error.get_or_insert(err);
+            }
+        }
+    }
+    let mut items = Vec::with_capacity(num_items);
+    for generated in generated_items {
+        // Items are only missing if every worker failed.
+        let Some((generated, item_errors)) = generated else {
+            break;
+        };
+        errors.merge(item_errors);
+        items.push(generated?.into_generated_item()?);
+    }
+    match worker_error {
+        Some(err) => Err(err),
+        None => Ok(items),
+    }
 }
 
+/// The result of generating an item on a worker thread, and the errors reported
+/// while generating it (whether or not that succeeded).
+type GeneratedItemAndErrors = (Result<SendableGeneratedItem>, ErrorReport);
+
 /// Formats a C++ identifier.  Panics if `ident` is a C++ reserved keyword.
 fn format_cc_ident(ident: &str) -> TokenStream {
     code_gen_utils::format_cc_ident(ident).expect("IR should only contain valid C++ identifiers")
@@ -3213,6 +4744,37 @@ enum RsTypeKind {
         crate_path: Rc<CratePath>,
     },
     Unit,
+    /// A slice `[T]`. Only appears as the pointee of a `Pointer`, which is
+    /// what C++ spans are mapped to.
+    Slice(Rc<RsTypeKind>),
+    /// `cc_std::Vector<T>`, the Rust type that C++ `std::vector<T>` is mapped
+    /// to.
+    Vector(Rc<RsTypeKind>),
+    /// `cc_std::String`, the Rust type that C++ `std::string` is mapped to.
+    String,
+    /// `cc_std::Optional<T>`, the Rust type that C++ `std::optional<T>` is
+    /// mapped to.
+    Optional(Rc<RsTypeKind>),
+    /// `cc_std::CcBox<T>`, the Rust type that C++ `std::unique_ptr<T>` is
+    /// mapped to. `is_trivial_abi` tells whether the `unique_ptr` is passed in
+    /// a register, like a pointer.
+    UniquePtr {
+        pointee: Rc<RsTypeKind>,
+        is_trivial_abi: bool,
+    },
+    /// `Result<T, Status>`, the Rust type of a returned C++ `absl::StatusOr<T>`.
+    /// Only appears as a return type.
+    StatusOr {
+        value: Rc<RsTypeKind>,
+        status: Rc<RsTypeKind>,
+    },
+    /// `impl FnMut(Args...) -> R`, the Rust type of a C++
+    /// `absl::FunctionRef<R(Args...)>` parameter. Only appears as a parameter
+    /// type.
+    FunctionRef {
+        return_type: Rc<RsTypeKind>,
+        param_types: Rc<[RsTypeKind]>,
+    },
     Other {
         name: Rc<str>,
         type_args: Rc<[RsTypeKind]>,
@@ -3261,12 +4823,31 @@ impl RsTypeKind {
             // `rs_bindings_from_cc` can change the type of fields (e.g. using a blob of bytes for
             // unsupported field types, or for no_unique_address fields).  Changing the type
             // of fields may change the ABI, which means that we can no longer assume
-            // that `extern "C"` ABI thunks can pass such types by value.
+            // that `extern "C"` ABI thunks can pass such types by value.  The exception are
+            // records that the importer found to be passed like C structs, and whose fields all
+            // keep their type in the bindings.  `!Unpin` records are always passed by pointer.
             //
-            // TODO(b/274177296): Return `true` for structs where bindings replicate the type of
-            // all the fields.
-            RsTypeKind::Record { .. } => false,
+            // TODO(b/274177296): Return `true` for all structs where bindings replicate the type
+            // of all the fields.
+            RsTypeKind::Record { record, .. } => {
+                record.is_c_abi_compatible_by_value
+                    && record.is_unpin()
+                    && record.fields.iter().all(|field| field.type_.is_ok())
+            }
             RsTypeKind::Other { is_same_abi, .. } => *is_same_abi,
+            // `std::vector` and `std::string` have non-trivial destructors, and so they are
+            // passed by pointer in the C++ ABI.
+            RsTypeKind::Vector(_) | RsTypeKind::String => false,
+            // The calling convention may differ: e.g. the value of a C++ `std::optional<float>`
+            // is a union of a `char` and a `float`, which is passed in an integer register.
+            RsTypeKind::Optional(_) => false,
+            RsTypeKind::UniquePtr { is_trivial_abi, .. } => *is_trivial_abi,
+            // The thunk moves the value or the status out of the `StatusOr`
+            // into one of two output parameters.
+            RsTypeKind::StatusOr { .. } => false,
+            // The closure is passed to the thunk as a pointer to it, and the function that
+            // calls it (see `format_function_ref_invoker_type`).
+            RsTypeKind::FunctionRef { .. } => false,
             _ => true,
         }
     }
@@ -3295,6 +4876,20 @@ impl RsTypeKind {
         match self {
             RsTypeKind::Record { record, .. } => check_by_value(record),
             RsTypeKind::TypeAlias { underlying_type, .. } => underlying_type.check_by_value(),
+            RsTypeKind::StatusOr { value, status } => {
+                // The value and the status are moved out of the `StatusOr` into Rust values.
+                for type_ in [value, status] {
+                    if !type_.is_unpin() {
+                        bail!(
+                            "`absl::StatusOr` can only be returned as a `Result` of `Unpin` types, \
+                             but `{}` is not `Unpin`",
+                            type_.to_token_stream()
+                        );
+                    }
+                    type_.check_by_value()?;
+                }
+                Ok(())
+            }
             _ => Ok(()),
         }
     }
@@ -3388,6 +4983,11 @@ impl RsTypeKind {
             RsTypeKind::IncompleteRecord { .. } => false,
             RsTypeKind::Record { record, .. } => should_derive_copy(record),
             RsTypeKind::TypeAlias { underlying_type, .. } => underlying_type.implements_copy(),
+            RsTypeKind::Slice(_) => false,
+            RsTypeKind::Vector(_) | RsTypeKind::String => false,
+            RsTypeKind::Optional(value) => value.implements_copy(),
+            RsTypeKind::UniquePtr { .. } | RsTypeKind::StatusOr { .. } => false,
+            RsTypeKind::FunctionRef { .. } => false,
             RsTypeKind::Other { type_args, .. } => {
                 // All types that may appear here without `type_args` (e.g.
                 // primitive types like `i32`) implement `Copy`. Generic types
@@ -3424,6 +5024,15 @@ impl RsTypeKind {
         }
     }
 
+    /// Returns the type that `self` refers to after looking through type
+    /// aliases.
+    pub fn unalias(&self) -> &RsTypeKind {
+        match self {
+            RsTypeKind::TypeAlias { underlying_type, .. } => underlying_type.unalias(),
+            _ => self,
+        }
+    }
+
     pub fn is_bool(&self) -> bool {
         match self {
             RsTypeKind::Other { name, .. } => &**name == "bool",
@@ -3513,6 +5122,36 @@ impl RsTypeKind {
                     quote! { #crate_path #ident }
                 }
             }
+            RsTypeKind::Slice(element) => {
+                let element_ = element.to_token_stream_replacing_by_self(self_record);
+                quote! {[#element_]}
+            }
+            RsTypeKind::Vector(element) => {
+                let element_ = element.to_token_stream_replacing_by_self(self_record);
+                quote! {::cc_std::Vector<#element_>}
+            }
+            RsTypeKind::String => quote! {::cc_std::String},
+            RsTypeKind::Optional(value) => {
+                let value_ = value.to_token_stream_replacing_by_self(self_record);
+                quote! {::cc_std::Optional<#value_>}
+            }
+            RsTypeKind::UniquePtr { pointee, .. } => {
+                let pointee_ = pointee.to_token_stream_replacing_by_self(self_record);
+                quote! {::cc_std::CcBox<#pointee_>}
+            }
+            RsTypeKind::StatusOr { value, status } => {
+                let value_ = value.to_token_stream_replacing_by_self(self_record);
+                let status_ = status.to_token_stream_replacing_by_self(self_record);
+                quote! {::core::result::Result<#value_, #status_>}
+            }
+            RsTypeKind::FunctionRef { return_type, param_types } => {
+                let param_types_: Vec<TokenStream> = param_types
+                    .iter()
+                    .map(|type_| type_.to_token_stream_replacing_by_self(self_record))
+                    .collect();
+                let return_frag = return_type.format_as_return_type_fragment(self_record);
+                quote! { impl FnMut( #( #param_types_ ),* ) #return_frag }
+            }
             RsTypeKind::Other { name, type_args, .. } => {
                 let name: TokenStream = name.parse().expect("Invalid RsType::name in the IR");
                 let generic_params =
@@ -3591,6 +5230,18 @@ impl ToTokens for RsTypeKind {
             // This doesn't affect void in function return values, as those are special-cased to be
             // omitted.
             RsTypeKind::Unit => quote! {::core::ffi::c_void},
+            RsTypeKind::Slice(element) => quote! {[#element]},
+            RsTypeKind::Vector(element) => quote! {::cc_std::Vector<#element>},
+            RsTypeKind::String => quote! {::cc_std::String},
+            RsTypeKind::Optional(value) => quote! {::cc_std::Optional<#value>},
+            RsTypeKind::UniquePtr { pointee, .. } => quote! {::cc_std::CcBox<#pointee>},
+            RsTypeKind::StatusOr { value, status } => {
+                quote! {::core::result::Result<#value, #status>}
+            }
+            RsTypeKind::FunctionRef { return_type, param_types } => {
+                let return_frag = return_type.format_as_return_type_fragment(None);
+                quote! { impl FnMut( #( #param_types ),* ) #return_frag }
+            }
             RsTypeKind::Other { name, type_args, .. } => {
                 let name: TokenStream = name.parse().expect("Invalid RsType::name in the IR");
                 let generic_params =
@@ -3620,13 +5271,23 @@ impl<'ty> Iterator for RsTypeKindIter<'ty> {
             Some(curr) => {
                 match curr {
                     RsTypeKind::Unit
+                    | RsTypeKind::String
                     | RsTypeKind::IncompleteRecord { .. }
                     | RsTypeKind::Record { .. } => {}
                     RsTypeKind::Pointer { pointee, .. } => self.todo.push(pointee),
                     RsTypeKind::Reference { referent, .. } => self.todo.push(referent),
                     RsTypeKind::RvalueReference { referent, .. } => self.todo.push(referent),
                     RsTypeKind::TypeAlias { underlying_type: t, .. } => self.todo.push(t),
-                    RsTypeKind::FuncPtr { return_type, param_types, .. } => {
+                    RsTypeKind::Slice(element)
+                    | RsTypeKind::Vector(element)
+                    | RsTypeKind::Optional(element) => self.todo.push(element),
+                    RsTypeKind::UniquePtr { pointee, .. } => self.todo.push(pointee),
+                    RsTypeKind::StatusOr { value, status } => {
+                        self.todo.push(status);
+                        self.todo.push(value);
+                    }
+                    RsTypeKind::FuncPtr { return_type, param_types, .. }
+                    | RsTypeKind::FunctionRef { return_type, param_types } => {
                         self.todo.push(return_type);
                         self.todo.extend(param_types.iter().rev());
                     }
@@ -3649,6 +5310,7 @@ fn unique_lifetimes<'a>(
 }
 
 fn rs_type_kind(db: &dyn BindingsGenerator, ty: ir::RsType) -> Result<RsTypeKind> {
+    db.query_profile().record_execution("rs_type_kind");
     let ir = db.ir();
     // The lambdas deduplicate code needed by multiple `match` branches.
     let get_type_args = || -> Result<Vec<RsTypeKind>> {
@@ -3756,6 +5418,72 @@ fn rs_type_kind(db: &dyn BindingsGenerator, ty: ir::RsType) -> Result<RsTypeKind
                 mutability: Mutability::Const,
                 lifetime: get_lifetime()?,
             },
+            "#slice" => RsTypeKind::Slice(get_pointee()?),
+            "#vector" => RsTypeKind::Vector(get_pointee()?),
+            "#string" => RsTypeKind::String,
+            "#optional" => {
+                let value = get_pointee()?;
+                // `cc_std::Optional<T>` requires `T: Copy`.
+                if !value.implements_copy() {
+                    bail!(
+                        "`std::optional` of a type that doesn't implement `Copy`: {}",
+                        value.to_token_stream()
+                    );
+                }
+                RsTypeKind::Optional(value)
+            }
+            "#uniquePtr" | "#uniquePtr trivial_abi" => {
+                let pointee = get_pointee()?;
+                // `CcBox<T>` requires `T: CcDelete`, which the bindings of `T`'s record implement
+                // (see `cc_struct_cc_delete_impl`), and `cc_std` for builtin types.
+                match pointee.unalias() {
+                    RsTypeKind::Record { record, .. } => {
+                        if record.destructor == SpecialMemberFunc::Unavailable {
+                            bail!(
+                                "`std::unique_ptr<{}>` can't be deleted: the destructor is not \
+                                 public",
+                                record.cc_name
+                            );
+                        }
+                    }
+                    RsTypeKind::Other { .. } => {}
+                    other => bail!("`std::unique_ptr` of unsupported type: {:?}", other),
+                }
+                RsTypeKind::UniquePtr { pointee, is_trivial_abi: name == "#uniquePtr trivial_abi" }
+            }
+            "#statusOr" => match get_type_args()?.as_slice() {
+                [value, status] => RsTypeKind::StatusOr {
+                    value: Rc::new(value.clone()),
+                    status: Rc::new(status.clone()),
+                },
+                _ => bail!("StatusOr must have exactly 2 type arguments: {:?}", ty),
+            },
+            "#functionRef" => {
+                let mut type_args = get_type_args()?;
+                ensure!(
+                    !type_args.is_empty(),
+                    "In well-formed IR `absl::FunctionRef`s include at least the return type",
+                );
+                // The closure is called through an `extern "C"` function (see
+                // `format_function_ref_invoker_type`), which passes the arguments and the return
+                // value by value.
+                for type_arg in &type_args {
+                    ensure!(
+                        type_arg.is_c_abi_compatible_by_value() && type_arg.is_unpin(),
+                        "`absl::FunctionRef` of a type that can't be passed to Rust by value: {}",
+                        type_arg.to_token_stream()
+                    );
+                    ensure!(
+                        type_arg.lifetimes().next().is_none(),
+                        "`absl::FunctionRef` of a type with lifetimes is not supported yet: {}",
+                        type_arg.to_token_stream()
+                    );
+                }
+                RsTypeKind::FunctionRef {
+                    return_type: Rc::new(type_args.remove(type_args.len() - 1)),
+                    param_types: Rc::from(type_args),
+                }
+            }
             name => {
                 let mut type_args = get_type_args()?;
                 match name.strip_prefix("#funcPtr ") {
@@ -3933,13 +5661,20 @@ fn format_cc_type_inner(ty: &ir::CcType, ir: &IR, references_ok: bool) -> Result
         Ok(quote! {#const_fragment #type_name})
     }
 }
-fn cc_struct_layout_assertion(db: &Database, record: &Record) -> Result<TokenStream> {
+/// Returns the C++ checks of the size and alignment of `record`, and, if
+/// `check_field_offsets` is true, of the offsets of its public fields.
+fn cc_struct_layout_checks(
+    db: &Database,
+    record: &Record,
+    check_field_offsets: bool,
+) -> Result<Vec<LayoutCheck>> {
     let record_ident = format_cc_ident(record.cc_name.as_ref());
     let namespace_qualifier = namespace_qualifier_of_item(record.id, &db.ir())?.format_for_cc()?;
     let tag_kind = cc_tag_kind(record);
-    let field_assertions = record
+    let field_checks = record
         .fields
         .iter()
+        .filter(|_| check_field_offsets)
         .filter(|f| f.access == AccessSpecifier::Public && f.identifier.is_some())
         // https://en.cppreference.com/w/cpp/types/offsetof points out that "if member is [...]
         // a bit-field [...] the behavior [of `offsetof` macro] is undefined.".  In such
@@ -3951,29 +5686,32 @@ fn cc_struct_layout_assertion(db: &Database, record: &Record) -> Result<TokenStr
             // `field.offset` is always at field boundaries, because the
             // bitfields have been filtered out earlier.
             assert_eq!(field.offset % 8, 0);
-            let expected_offset = Literal::usize_unsuffixed(field.offset / 8);
-
             let field_ident = format_cc_ident(&field.identifier.as_ref().unwrap().identifier);
-            let actual_offset = quote! {
-                CRUBIT_OFFSET_OF(#field_ident, #tag_kind #namespace_qualifier #record_ident)
-            };
-
-            quote! { static_assert( #actual_offset == #expected_offset); }
+            LayoutCheck {
+                actual: quote! {
+                    CRUBIT_OFFSET_OF(#field_ident, #tag_kind #namespace_qualifier #record_ident)
+                },
+                expected: Literal::usize_unsuffixed(field.offset / 8),
+            }
         });
     // only use CRUBIT_SIZEOF for alignment > 1, so as to simplify the generated
     // code.
-    let size = Literal::usize_unsuffixed(record.size_align.size);
-    let alignment = Literal::usize_unsuffixed(record.size_align.alignment);
     let sizeof = if record.size_align.alignment == 1 {
         quote! {sizeof}
     } else {
         quote! {CRUBIT_SIZEOF}
     };
-    Ok(quote! {
-        static_assert(#sizeof(#tag_kind #namespace_qualifier #record_ident) == #size);
-        static_assert(alignof(#tag_kind #namespace_qualifier #record_ident) == #alignment);
-        #( #field_assertions )*
-    })
+    let size_align_checks = [
+        LayoutCheck {
+            actual: quote! { #sizeof(#tag_kind #namespace_qualifier #record_ident) },
+            expected: Literal::usize_unsuffixed(record.size_align.size),
+        },
+        LayoutCheck {
+            actual: quote! { alignof(#tag_kind #namespace_qualifier #record_ident) },
+            expected: Literal::usize_unsuffixed(record.size_align.alignment),
+        },
+    ];
+    Ok(size_align_checks.into_iter().chain(field_checks).collect())
 }
 
 // Returns the accessor functions for no_unique_address member variables.
@@ -4072,17 +5810,285 @@ fn cc_struct_upcast_impl(record: &Rc<Record>, ir: &IR) -> Result<GeneratedItem>
     Ok(GeneratedItem {
         item: quote! {#(#impls)*},
         thunks: quote! {#(#thunks)*},
+        has_cc_thunks: !cc_impls.is_empty(),
+        thunk_impls: quote! {#(#cc_impls)*},
+        ..Default::default()
+    })
+}
+
+/// Returns the implementation of `cc_std::CcDelete` for `record`, if it appears
+/// in a `std::unique_ptr` (`cc_std::CcBox`) of the current target.
+///
+/// Only the bindings of the record itself can implement the trait, so uses of
+/// `std::unique_ptr<T>` in other targets keep the ordinary bindings (see
+/// `Importer::ConvertType`).
+fn cc_struct_cc_delete_impl(db: &Database, record: &Rc<Record>) -> Result<GeneratedItem> {
+    if record.destructor == SpecialMemberFunc::Unavailable
+        || !db.unique_ptr_pointees().contains(&record.id)
+    {
+        return Ok(GeneratedItem::default());
+    }
+    let ir = db.ir();
+    let record_name = RsTypeKind::new_record(record.clone(), &ir)?.into_token_stream();
+    let record_cc_name = cc_type_name_for_record(record.as_ref(), &ir)?;
+    let delete_fn_name = make_rs_ident(&format!("__crubit_delete__{}", record.mangled_cc_name));
+    let crate_root_path = crate_root_path_tokens(&ir);
+    Ok(GeneratedItem {
+        item: quote! {
+            unsafe impl ::cc_std::CcDelete for #record_name {
+                #[inline(always)]
+                unsafe fn cc_delete(ptr: *mut Self) {
+                    #crate_root_path::detail::#delete_fn_name(ptr)
+                }
+            }
+        },
+        thunks: quote! {
+            pub fn #delete_fn_name(ptr: *mut #record_name);
+        },
+        thunk_impls: quote! {
+            extern "C" void #delete_fn_name(#record_cc_name* ptr) {
+                delete ptr;
+            }
+        },
+        has_cc_thunks: true,
+        ..Default::default()
+    })
+}
+
+/// Returns the `drop_slice_in_place` and `clone_slice` functions of `record`, if
+/// its owning target opted into `CrubitFeature::BatchCalls`.
+///
+/// These run the C++ destructors or copy constructors of all the elements of a
+/// slice with a single thunk call, instead of one call per element. They are
+/// only generated when the record's `Drop` or `Clone` impl calls into C++, and
+/// only for `Unpin` records, which can be stored in Rust slices and `Vec`s.
+fn cc_struct_slice_impl(record: &Rc<Record>, ir: &IR) -> Result<GeneratedItem> {
+    if !ir.target_crubit_features(&record.owning_target).contains(CrubitFeature::BatchCalls)
+        || !record.is_unpin()
+        || record.is_abstract
+        || record.is_union()
+    {
+        return Ok(GeneratedItem::default());
+    }
+    let record_name = RsTypeKind::new_record(record.clone(), ir)?.into_token_stream();
+    let record_cc_name = cc_type_name_for_record(record.as_ref(), ir)?;
+    let crate_root_path = crate_root_path_tokens(ir);
+    let mut items = vec![];
+    let mut thunks = vec![];
+    let mut cc_impls = vec![];
+    if should_implement_drop(record) {
+        let destroy_fn_name =
+            make_rs_ident(&format!("__crubit_destroy_n__{}", record.mangled_cc_name));
+        items.push(quote! {
+            /// Drops the elements of `slice` in place, running all of their C++ destructors with
+            /// a single thunk call.
+            ///
+            /// # Safety
+            ///
+            /// The same as for `core::ptr::drop_in_place`: the elements must not be used or
+            /// dropped again afterwards.
+            #[inline(always)]
+            pub unsafe fn drop_slice_in_place(slice: *mut [Self]) {
+                #crate_root_path::detail::#destroy_fn_name(slice.cast::<Self>(), slice.len())
+            }
+        });
+        thunks.push(quote! {
+            pub(crate) fn #destroy_fn_name(__this: *mut #record_name, __n: usize);
+        });
+        cc_impls.push(quote! {
+            extern "C" void #destroy_fn_name(#record_cc_name* __this, size_t __n) {
+                std::destroy_n(__this, __n);
+            }
+        });
+    }
+    if matches!(
+        record.copy_constructor,
+        SpecialMemberFunc::NontrivialMembers | SpecialMemberFunc::NontrivialUserDefined
+    ) {
+        let copy_fn_name = make_rs_ident(&format!("__crubit_copy_n__{}", record.mangled_cc_name));
+        items.push(quote! {
+            /// Returns clones of the elements of `slice`, running all of their C++ copy
+            /// constructors with a single thunk call.
+            #[inline(always)]
+            pub fn clone_slice(slice: &[Self]) -> ::std::vec::Vec<Self> {
+                let mut clones = ::std::vec::Vec::with_capacity(slice.len());
+                unsafe {
+                    #crate_root_path::detail::#copy_fn_name(
+                        clones.as_mut_ptr(), slice.as_ptr(), slice.len());
+                    clones.set_len(slice.len());
+                }
+                clones
+            }
+        });
+        thunks.push(quote! {
+            pub(crate) fn #copy_fn_name(
+                __return: *mut #record_name, __src: *const #record_name, __n: usize);
+        });
+        cc_impls.push(quote! {
+            extern "C" void #copy_fn_name(
+                #record_cc_name* __return, const #record_cc_name* __src, size_t __n) {
+                std::uninitialized_copy_n(__src, __n, __return);
+            }
+        });
+    }
+    if items.is_empty() {
+        return Ok(GeneratedItem::default());
+    }
+    Ok(GeneratedItem {
+        item: quote! { impl #record_name { #(#items)* } },
+        thunks: quote! {#(#thunks)*},
+        has_cc_thunks: true,
         thunk_impls: quote! {#(#cc_impls)*},
         ..Default::default()
     })
 }
 
+/// Returns getters and setters for the public bitfields of `record` that have a
+/// builtin integer type or `bool`, which are otherwise only represented by
+/// opaque padding.
+///
+/// The accessors shift and mask the bytes that hold the bitfield, so they
+/// don't call into C++. As in C++, the setter preserves the other bits of these
+/// bytes. This relies on the little-endian bitfield layout of the Itanium ABI.
+///
+/// The storage of bitfields is `MaybeUninit<u8>`, and other bitfields (or
+/// padding) sharing it may be uninitialized. The accessors only assume that
+/// the bytes holding bits of the bitfield itself are initialized, and the
+/// setter only reads the first and last of them, and only if they also hold
+/// bits of something else.
+fn cc_struct_bitfield_accessors_impl(db: &Database, record: &Rc<Record>) -> Result<GeneratedItem> {
+    let ir = db.ir();
+    let method_names: HashSet<&str> = ir
+        .functions()
+        .filter(|func| {
+            func.member_func_metadata.as_ref().map(|meta| meta.record_id) == Some(record.id)
+        })
+        .filter_map(|func| match &func.name {
+            UnqualifiedIdentifier::Identifier(id) => Some(id.identifier.as_ref()),
+            _ => None,
+        })
+        .collect();
+    let mut accessors = vec![];
+    for field in &record.fields {
+        if !field.is_bitfield
+            || field.access != AccessSpecifier::Public
+            || field.size == 0
+            || field.size > 64
+        {
+            continue;
+        }
+        let (identifier, field_type) = match (&field.identifier, &field.type_) {
+            (Some(identifier), Ok(field_type)) if field_type.rs_type.decl_id.is_none() => {
+                (identifier, field_type)
+            }
+            _ => continue,
+        };
+        let rs_type = match db.rs_type_kind(field_type.rs_type.clone()) {
+            Ok(rs_type) => rs_type,
+            Err(_) => continue,
+        };
+        // Builtin integer types and `bool`.
+        if !matches!(&rs_type, RsTypeKind::Other { type_args, .. } if type_args.is_empty()) {
+            continue;
+        }
+
+        // The bitfield is accumulated in the smallest unsigned integer holding
+        // all of the bytes that it spans.
+        let byte_offset = Literal::usize_unsuffixed(field.offset / 8);
+        let bit_shift = Literal::usize_unsuffixed(field.offset % 8);
+        let byte_count = (field.offset % 8 + field.size + 7) / 8;
+        // The bits of the first and last bytes that don't belong to the bitfield.
+        let bits_to_preserve = (0..byte_count).filter_map(|i| {
+            let first_bit = (field.offset % 8).saturating_sub(i * 8).min(8);
+            let end_bit = (field.offset % 8 + field.size - i * 8).min(8);
+            let field_bits = (0xffu16 >> (8 - (end_bit - first_bit)) << first_bit) as u8;
+            (field_bits != 0xff)
+                .then(|| (Literal::usize_unsuffixed(i), Literal::u8_unsuffixed(!field_bits)))
+        });
+        let (preserved_bytes, preserved_masks): (Vec<_>, Vec<_>) = bits_to_preserve.unzip();
+        let (bits_type, bits_size) =
+            if byte_count <= 8 { (quote! { u64 }, 8) } else { (quote! { u128 }, 16) };
+        let bits_size = Literal::usize_unsuffixed(bits_size);
+        let width = Literal::u32_unsuffixed(field.size as u32);
+        let byte_count = Literal::usize_unsuffixed(byte_count);
+        let mask = quote! {
+            let mask: #bits_type = #bits_type::MAX >> (#bits_type::BITS - #width);
+        };
+        let value = if rs_type.is_bool() {
+            quote! { ((#bits_type::from_le_bytes(bytes) >> #bit_shift) & mask) != 0 }
+        } else {
+            // Shifting the value back and forth sign-extends signed bitfields.
+            quote! {
+                let value = ((#bits_type::from_le_bytes(bytes) >> #bit_shift) & mask) as #rs_type;
+                let shift = <#rs_type>::BITS.saturating_sub(#width);
+                (value << shift) >> shift
+            }
+        };
+
+        let getter_name = make_rs_ident(&identifier.identifier);
+        let doc_comment = generate_doc_comment(
+            field.doc_comment.as_deref(),
+            None,
+            db.generate_source_loc_doc_comment(),
+        );
+        accessors.push(quote! {
+            #doc_comment
+            #[inline(always)]
+            pub fn #getter_name(&self) -> #rs_type {
+                unsafe {
+                    let storage = (self as *const Self as *const ::core::mem::MaybeUninit<u8>)
+                        .add(#byte_offset);
+                    let mut bytes = [0u8; #bits_size];
+                    for i in 0..#byte_count {
+                        bytes[i] = storage.add(i).read().assume_init();
+                    }
+                    #mask
+                    #value
+                }
+            }
+        });
+        // Setters can't be used on `!Unpin` records, which are only mutated
+        // through `Pin<&mut Self>`.
+        let setter_name = format!("set_{}", identifier.identifier);
+        if !record.is_unpin() || method_names.contains(setter_name.as_str()) {
+            continue;
+        }
+        let setter_name = make_rs_ident(&setter_name);
+        accessors.push(quote! {
+            #[inline(always)]
+            pub fn #setter_name(&mut self, value: #rs_type) {
+                unsafe {
+                    let storage = (self as *mut Self as *mut ::core::mem::MaybeUninit<u8>)
+                        .add(#byte_offset);
+                    #mask
+                    let mut bytes = (((value as #bits_type) & mask) << #bit_shift).to_le_bytes();
+                    #(
+                        bytes[#preserved_bytes] |=
+                            storage.add(#preserved_bytes).read().assume_init() & #preserved_masks;
+                    )*
+                    for i in 0..#byte_count {
+                        storage.add(i).write(::core::mem::MaybeUninit::new(bytes[i]));
+                    }
+                }
+            }
+        });
+    }
+    if accessors.is_empty() {
+        return Ok(GeneratedItem::default());
+    }
+    let record_name = RsTypeKind::new_record(record.clone(), &ir)?.into_token_stream();
+    Ok(quote! { impl #record_name { #(#accessors)* } }.into())
+}
+
 fn thunk_ident(func: &Func) -> Ident {
     format_ident!("__rust_thunk__{}", func.mangled_name.as_ref())
 }
 
 fn generate_func_thunk_impl(db: &dyn BindingsGenerator, func: &Func) -> Result<TokenStream> {
-    if can_skip_cc_thunk(db, func) {
+    if can_skip_cc_thunk(db, func)
+        || get_inlined_getter(db, func).is_some()
+        || is_zeroing_default_constructor(db, func)
+    {
         return Ok(quote! {});
     }
     let ir = db.ir();
@@ -4132,8 +6138,13 @@ fn generate_func_thunk_impl(db: &dyn BindingsGenerator, func: &Func) -> Result<T
         .params
         .iter()
         .map(|p| {
+            let type_kind = db.rs_type_kind(p.type_.rs_type.clone())?;
+            if let RsTypeKind::FunctionRef { .. } = type_kind {
+                // The pointer to the Rust closure. The function that calls it is inserted below.
+                return Ok(quote! {void*});
+            }
             let formatted = format_cc_type(&p.type_.cc_type, &ir)?;
-            if !db.rs_type_kind(p.type_.rs_type.clone())?.is_c_abi_compatible_by_value() {
+            if !type_kind.is_c_abi_compatible_by_value() {
                 // non-Unpin types are wrapped by a pointer in the thunk.
                 Ok(quote! {#formatted *})
             } else {
@@ -4151,9 +6162,29 @@ fn generate_func_thunk_impl(db: &dyn BindingsGenerator, func: &Func) -> Result<T
                 Some("&") => Ok(quote! { * #ident }),
                 Some("&&") => Ok(quote! { std::move(* #ident) }),
                 _ => {
+                    let type_kind = db.rs_type_kind(p.type_.rs_type.clone())?;
+                    if let RsTypeKind::FunctionRef { .. } = type_kind {
+                        // The `absl::FunctionRef` binds to the lambda, which lives until the
+                        // end of the full-expression that calls the function. Forwarding the
+                        // arguments lets `decltype(auto)` keep the exact return type.
+                        let invoke =
+                            format_cc_ident(&format!("__{}_invoke", p.identifier.identifier));
+                        return Ok(quote! {
+                            [&](auto&&... __args) -> decltype(auto) {
+                                return #invoke(#ident, std::forward<decltype(__args)>(__args)...);
+                            }
+                        });
+                    }
                     // non-Unpin types are wrapped by a pointer in the thunk.
-                    if !db.rs_type_kind(p.type_.rs_type.clone())?.is_c_abi_compatible_by_value() {
+                    if !type_kind.is_c_abi_compatible_by_value() {
                         Ok(quote! { std::move(* #ident) })
+                    } else if matches!(
+                        type_kind.unalias(),
+                        RsTypeKind::Record { .. } | RsTypeKind::UniquePtr { .. }
+                    ) {
+                        // Records passed by value may still have non-trivial copy constructors,
+                        // and `std::unique_ptr` can only be moved.
+                        Ok(quote! { std::move(#ident) })
                     } else {
                         Ok(quote! { #ident })
                     }
@@ -4162,14 +6193,56 @@ fn generate_func_thunk_impl(db: &dyn BindingsGenerator, func: &Func) -> Result<T
         })
         .collect::<Result<Vec<_>>>()?;
 
+    // An `absl::FunctionRef` is passed as a pointer to the Rust closure, followed by the function
+    // that calls it (see `format_function_ref_invoker_type`). Inserting from the back keeps the
+    // indices of the preceding parameters.
+    for (i, p) in func.params.iter().enumerate().rev() {
+        if let RsTypeKind::FunctionRef { .. } = db.rs_type_kind(p.type_.rs_type.clone())? {
+            let (return_type, invoker_param_types) = match p.type_.cc_type.type_args.split_last() {
+                Some(split) => split,
+                None => bail!("FunctionRef without a return type: {:?}", p.type_.cc_type),
+            };
+            // Like function pointer types, the function type keeps references.
+            let return_type =
+                format_cc_type_inner(return_type, &ir, /* references_ok= */ true)?;
+            let invoker_param_types = invoker_param_types
+                .iter()
+                .map(|t| format_cc_type_inner(t, &ir, /* references_ok= */ true))
+                .collect::<Result<Vec<_>>>()?;
+            let invoke = format_cc_ident(&format!("__{}_invoke", p.identifier.identifier));
+            param_idents.insert(i + 1, invoke);
+            param_types.insert(
+                i + 1,
+                quote! {
+                    crubit::type_identity_t<#return_type(void* #( , #invoker_param_types )*)>*
+                },
+            );
+        }
+    }
+
     // Here, we add a `__return` parameter if the return type can't be passed by
     // value across `extern "C"` ABI.  (We do this after the arg_expressions
     // computation, so that it's only in the parameter list, not the argument
     // list.)
-    let is_return_value_c_abi_compatible =
-        db.rs_type_kind(func.return_type.rs_type.clone())?.is_c_abi_compatible_by_value();
-
-    let return_type_name = if !is_return_value_c_abi_compatible {
+    let return_type_kind = db.rs_type_kind(func.return_type.rs_type.clone())?;
+    let is_return_value_c_abi_compatible = return_type_kind.is_c_abi_compatible_by_value();
+    let is_status_or = matches!(return_type_kind, RsTypeKind::StatusOr { .. });
+
+    let return_type_name = if is_status_or {
+        // `MappedType::StatusOrOf` keeps the C++ types of the value and the status as the type
+        // arguments.
+        let (value_type, status_type) = match &func.return_type.cc_type.type_args[..] {
+            [value_type, status_type] => (value_type, status_type),
+            _ => bail!("Invalid StatusOr type (need exactly 2 type arguments)"),
+        };
+        let mut value_type = value_type.clone();
+        value_type.is_const = false;
+        let value_type_name = format_cc_type(&value_type, &ir)?;
+        let status_type_name = format_cc_type(status_type, &ir)?;
+        param_idents.splice(0..0, [format_cc_ident("__value"), format_cc_ident("__status")]);
+        param_types.splice(0..0, [quote! {#value_type_name *}, quote! {#status_type_name *}]);
+        quote! {bool}
+    } else if !is_return_value_c_abi_compatible {
         param_idents.insert(0, format_cc_ident("__return"));
         // In order to be modified, the return type can't be const.
         let mut cc_return_type = func.return_type.cc_type.clone();
@@ -4211,7 +6284,19 @@ fn generate_func_thunk_impl(db: &dyn BindingsGenerator, func: &Func) -> Result<T
         };
 
     let return_expr = quote! {#implementation_function( #( #arg_expressions ),* )};
-    let return_stmt = if !is_return_value_c_abi_compatible {
+    let return_stmt = if is_status_or {
+        // Moving the value (or the status) out of the `StatusOr` doesn't allocate, so neither
+        // does the OK path, unless moving the value does.
+        quote! {
+            auto __status_or = #return_expr;
+            if (__status_or.ok()) {
+                new(__value) auto(*std::move(__status_or));
+                return true;
+            }
+            new(__status) auto(std::move(__status_or).status());
+            return false
+        }
+    } else if !is_return_value_c_abi_compatible {
         // Explicitly use placement `new` so that we get guaranteed copy elision in
         // C++17.
         let out_param = &param_idents[0];
@@ -4239,8 +6324,11 @@ fn generate_func_thunk_impl(db: &dyn BindingsGenerator, func: &Func) -> Result<T
         }
     };
 
+    // Rust declares the thunks `extern "C"`, so they must not unwind anyway. Marking the thunks of
+    // `noexcept` functions `noexcept`, too, lets the C++ compiler omit their unwind tables.
+    let noexcept = func.is_noexcept.then(|| quote! { noexcept });
     Ok(quote! {
-        extern "C" #return_type_name #thunk_ident( #( #param_types #param_idents ),* ) {
+        extern "C" #return_type_name #thunk_ident( #( #param_types #param_idents ),* ) #noexcept {
             #return_stmt;
         }
     })
@@ -4254,6 +6342,10 @@ fn generate_rs_api_impl_includes(
 
     let mut internal_includes = BTreeSet::new();
     internal_includes.insert(CcInclude::memory()); // ubiquitous.
+    if ir.target_crubit_features(ir.current_target()).contains(CrubitFeature::BatchCalls) {
+        // `size_t` in batch thunks.
+        internal_includes.insert(CcInclude::cstddef());
+    }
     if ir.records().next().is_some() {
         internal_includes.insert(CcInclude::cstddef());
         internal_includes.insert(CcInclude::user_header(
@@ -4313,22 +6405,171 @@ mod tests {
             "crubit/rs_bindings_support",
             Rc::new(IgnoreErrors),
             SourceLocationDocComment::Enabled,
+            LayoutAssertions::PerItem,
+            /* omit_thunk_free_rs_api_impl= */ false,
+            /* collapse_opaque_fields= */ false,
+            None,
+            /* rs_api_shard_file_names= */ &[],
+            &Timings::default(),
         )
     }
 
-    fn db_from_cc(cc_src: &str) -> Result<Database> {
-        let mut db = Database::default();
-        db.set_ir(Rc::new(ir_from_cc(cc_src)?));
-        Ok(db)
+    #[test]
+    fn test_parallel_codegen_matches_sequential_codegen() -> Result<()> {
+        let header = r#"
+            struct SomeStruct final {
+              int field;
+            };
+            inline SomeStruct MakeStruct() { return {}; }
+            namespace ns {
+              struct Nested final {};
+              void Overloaded(int);
+              void Overloaded(float);
+            }
+            template <typename T> struct SomeTemplate {};
+            using SomeAlias = SomeTemplate<int>;
+            enum Color { kRed, kGreen };
+            struct HasUnsupportedMember final {
+              void* operator new(__SIZE_TYPE__) = delete;
+            };
+        "#;
+        let make_ir = || ir_from_cc(header);
+        let generate = |errors: Rc<ErrorReport>, parallel_codegen| {
+            super::generate_bindings_tokens(
+                Rc::new(make_ir()?),
+                "crubit/rs_bindings_support",
+                errors,
+                SourceLocationDocComment::Enabled,
+                LayoutAssertions::PerItem,
+                /* omit_thunk_free_rs_api_impl= */ false,
+                /* collapse_opaque_fields= */ false,
+                parallel_codegen,
+                /* rs_api_shard_file_names= */ &[],
+                &Timings::default(),
+            )
+        };
+        // Parallel codegen passes the generated tokens between threads as strings, so
+        // compare the printed tokens after one round trip through a string, too.
+        let normalize = |tokens: TokenStream| -> Result<String> {
+            Ok(tokens.to_string().parse::<TokenStream>().map_err(|err| anyhow!(err))?.to_string())
+        };
+
+        let sequential_errors = Rc::new(ErrorReport::new());
+        let sequential = generate(sequential_errors.clone(), None)?;
+        let parallel_errors = Rc::new(ErrorReport::new());
+        let parallel = generate(
+            parallel_errors.clone(),
+            Some(ParallelCodegen { num_threads: 4, make_ir: &make_ir }),
+        )?;
+
+        assert_eq!(normalize(parallel.rs_api)?, normalize(sequential.rs_api)?);
+        assert_eq!(normalize(parallel.rs_api_impl)?, normalize(sequential.rs_api_impl)?);
+        assert_eq!(parallel_errors.serialize_to_vec()?, sequential_errors.serialize_to_vec()?);
+        Ok(())
     }
 
     #[test]
-    fn test_disable_thread_safety_warnings() -> Result<()> {
-        let ir = ir_from_cc("inline void foo() {}")?;
-        let rs_api_impl = generate_bindings_tokens(ir)?.rs_api_impl;
-        assert_cc_matches!(
-            rs_api_impl,
-            quote! {
+    fn test_size_report() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            namespace ns {
+              inline int Add(int a, int b) { return a + b; }
+            }
+            struct SomeStruct final {
+              int field;
+            };
+            "#,
+        )?;
+        let timings =
+            Timings { size_report: Arc::new(SizeReport::new(true)), ..Timings::default() };
+        super::generate_bindings_tokens(
+            Rc::new(ir),
+            "crubit/rs_bindings_support",
+            Rc::new(IgnoreErrors),
+            SourceLocationDocComment::Enabled,
+            LayoutAssertions::PerItem,
+            /* omit_thunk_free_rs_api_impl= */ false,
+            /* collapse_opaque_fields= */ false,
+            None,
+            /* rs_api_shard_file_names= */ &[],
+            &timings,
+        )?;
+        let report = timings.size_report.to_json();
+        let entry = |kind: &str| {
+            report.as_array().unwrap().iter().find(|entry| entry["kind"] == kind).unwrap().clone()
+        };
+        let func = entry("Func");
+        assert_eq!(func["thunks"], 1);
+        assert_eq!(func["generic_params"], 0);
+        assert!(func["rs_api_impl_bytes"].as_u64().unwrap() > 0);
+        // The namespace includes the function.
+        let namespace = entry("Namespace");
+        assert!(namespace["rs_api_tokens"].as_u64() > func["rs_api_tokens"].as_u64());
+        assert_eq!(namespace["thunks"], 1);
+        let record = entry("Record");
+        assert!(record["rs_api_bytes"].as_u64().unwrap() > 0);
+        Ok(())
+    }
+
+    #[test]
+    fn test_query_profile() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            struct SomeStruct final {
+              int field;
+            };
+            int First(SomeStruct s);
+            int Second(SomeStruct s);
+            "#,
+        )?;
+        let timings =
+            Timings { query_profile: Arc::new(QueryProfile::new(true)), ..Timings::default() };
+        super::generate_bindings_tokens(
+            Rc::new(ir),
+            "crubit/rs_bindings_support",
+            Rc::new(IgnoreErrors),
+            SourceLocationDocComment::Enabled,
+            LayoutAssertions::PerItem,
+            /* omit_thunk_free_rs_api_impl= */ false,
+            /* collapse_opaque_fields= */ false,
+            None,
+            /* rs_api_shard_file_names= */ &[],
+            &timings,
+        )?;
+        let profile = timings.query_profile.to_json();
+        let rs_type_kind = &profile["rs_type_kind"];
+        // `SomeStruct` is looked up for both functions, but only mapped once.
+        assert!(rs_type_kind["cache_hits"].as_u64().unwrap() > 0);
+        assert_eq!(
+            rs_type_kind["calls"].as_u64().unwrap(),
+            rs_type_kind["cache_hits"].as_u64().unwrap()
+                + rs_type_kind["executions"].as_u64().unwrap()
+        );
+        assert!(profile["generate_func"]["executions"].as_u64().unwrap() >= 2);
+        Ok(())
+    }
+
+    #[test]
+    fn test_query_profile_disabled() {
+        let db = Database::default();
+        db.query_profile().call("rs_type_kind", || ());
+        db.query_profile().record_execution("rs_type_kind");
+        assert_eq!(db.query_profile().to_json(), serde_json::json!({}));
+    }
+
+    fn db_from_cc(cc_src: &str) -> Result<Database> {
+        let mut db = Database::default();
+        db.set_ir(Rc::new(ir_from_cc(cc_src)?));
+        Ok(db)
+    }
+
+    #[test]
+    fn test_disable_thread_safety_warnings() -> Result<()> {
+        let ir = ir_from_cc("inline void foo() {}")?;
+        let rs_api_impl = generate_bindings_tokens(ir)?.rs_api_impl;
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
                 ...
                 __HASH_TOKEN__ pragma clang diagnostic push
                 __HASH_TOKEN__ pragma clang diagnostic ignored "-Wthread-safety-analysis"
@@ -4344,7 +6585,7 @@ mod tests {
     #[test]
     fn test_simple_function() -> Result<()> {
         let ir = ir_from_cc("int Add(int a, int b);")?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -4376,7 +6617,7 @@ mod tests {
     #[test]
     fn test_inline_function() -> Result<()> {
         let ir = ir_from_cc("inline int Add(int a, int b);")?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -4410,6 +6651,257 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn test_noexcept_function_thunk() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            inline int Add(int a, int b) noexcept;
+            inline int MayThrow(int a);"#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                extern "C" {
+                    pub(crate) fn __rust_thunk___Z3Addii(a: ::core::ffi::c_int, b: ::core::ffi::c_int) -> ::core::ffi::c_int;
+                    ...
+                }
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" int __rust_thunk___Z3Addii(int a, int b) noexcept {
+                    return Add(a, b);
+                }
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" int __rust_thunk___Z8MayThrowi(int a) {
+                    return MayThrow(a);
+                }
+            }
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_trivial_abi_record_passed_by_value_without_thunk() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            struct [[clang::trivial_abi]] S final {
+              S(const S&);
+              ~S();
+              int i;
+            };
+            S Take(S s);
+            inline S TakeInline(S s);"#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                #[inline(always)]
+                pub fn Take(s: crate::S) -> crate::S {
+                    unsafe { crate::detail::__rust_thunk___Z4Take1S(s) }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                #[link_name = "_Z4Take1S"]
+                pub(crate) fn __rust_thunk___Z4Take1S(s: crate::S) -> crate::S;
+            }
+        );
+        assert_cc_not_matches!(rs_api_impl, quote! {__rust_thunk___Z4Take1S});
+
+        // Inline functions still need a thunk, but it can take and return the record by value.
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub(crate) fn __rust_thunk___Z10TakeInline1S(s: crate::S) -> crate::S;
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" struct S __rust_thunk___Z10TakeInline1S(struct S s) {
+                    return TakeInline(std::move(s));
+                }
+            }
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_batch_function() -> Result<()> {
+        let mut ir = ir_from_cc(
+            r#"
+            namespace ns {
+            struct S final { int i; };
+            int Add(int a, int b);
+            S Scale(S s, float factor);
+            void NoReturnValue(int a);
+            int* Pointer(int* p);
+            }"#,
+        )?;
+        *ir.target_crubit_features_mut(&ir.current_target().clone()) |= CrubitFeature::BatchCalls;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                #[inline(always)]
+                pub fn Add_batch(
+                    a: &[::core::ffi::c_int],
+                    b: &[::core::ffi::c_int],
+                    __return: &mut [::core::ffi::c_int]
+                ) {
+                    assert_eq!(a.len(), __return.len());
+                    assert_eq!(b.len(), __return.len());
+                    unsafe {
+                        crate::detail::__rust_thunk___ZN2ns3AddEii_batch(
+                            __return.len(), __return.as_mut_ptr(), a.as_ptr(), b.as_ptr()
+                        )
+                    }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub(crate) fn __rust_thunk___ZN2ns3AddEii_batch(
+                    __n: usize,
+                    __return: *mut ::core::ffi::c_int,
+                    a: *const ::core::ffi::c_int,
+                    b: *const ::core::ffi::c_int
+                );
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" void __rust_thunk___ZN2ns3AddEii_batch(
+                    size_t __n, int* __return, int const* a, int const* b
+                ) {
+                    for (size_t __i = 0; __i < __n; ++__i) {
+                        new (__return + __i) auto(ns::Add(a[__i], b[__i]));
+                    }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn Scale_batch(
+                    s: &[crate::ns::S],
+                    factor: &[f32],
+                    __return: &mut [crate::ns::S]
+                )
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn Pointer_batch(
+                    p: &[*mut ::core::ffi::c_int],
+                    __return: &mut [*mut ::core::ffi::c_int]
+                )
+            }
+        );
+        assert_rs_not_matches!(rs_api, quote! { NoReturnValue_batch });
+        Ok(())
+    }
+
+    #[test]
+    fn test_record_slice_functions() -> Result<()> {
+        let mut ir = ir_from_cc(
+            r#"
+            namespace ns {
+            struct [[clang::trivial_abi]] S final {
+              S(const S&);
+              ~S();
+              int i;
+            };
+            struct [[clang::trivial_abi]] DestructorOnly final {
+              ~DestructorOnly();
+              int i;
+            };
+            struct Trivial final { int i; };
+            struct NotUnpin final {
+              NotUnpin(const NotUnpin&);
+              ~NotUnpin();
+            };
+            }"#,
+        )?;
+        *ir.target_crubit_features_mut(&ir.current_target().clone()) |= CrubitFeature::BatchCalls;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                impl crate::ns::S {
+                    ...
+                    #[inline(always)]
+                    pub unsafe fn drop_slice_in_place(slice: *mut [Self]) {
+                        crate::detail::__crubit_destroy_n__N2ns1SE(
+                            slice.cast::<Self>(), slice.len())
+                    }
+                    ...
+                    #[inline(always)]
+                    pub fn clone_slice(slice: &[Self]) -> ::std::vec::Vec<Self> {
+                        let mut clones = ::std::vec::Vec::with_capacity(slice.len());
+                        unsafe {
+                            crate::detail::__crubit_copy_n__N2ns1SE(
+                                clones.as_mut_ptr(), slice.as_ptr(), slice.len());
+                            clones.set_len(slice.len());
+                        }
+                        clones
+                    }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub(crate) fn __crubit_destroy_n__N2ns1SE(__this: *mut crate::ns::S, __n: usize);
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" void __crubit_destroy_n__N2ns1SE(struct ns::S* __this, size_t __n) {
+                    std::destroy_n(__this, __n);
+                }
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" void __crubit_copy_n__N2ns1SE(
+                    struct ns::S* __return, const struct ns::S* __src, size_t __n) {
+                    std::uninitialized_copy_n(__src, __n, __return);
+                }
+            }
+        );
+        assert_rs_matches!(rs_api, quote! { __crubit_destroy_n__N2ns14DestructorOnlyE });
+        assert_rs_not_matches!(rs_api, quote! { __crubit_copy_n__N2ns14DestructorOnlyE });
+        assert_rs_not_matches!(rs_api, quote! { __crubit_destroy_n__N2ns7TrivialE });
+        assert_rs_not_matches!(rs_api, quote! { __crubit_copy_n__N2ns7TrivialE });
+        assert_rs_not_matches!(rs_api, quote! { __crubit_destroy_n__N2ns8NotUnpinE });
+        Ok(())
+    }
+
+    #[test]
+    fn test_batch_function_requires_crubit_feature() -> Result<()> {
+        let ir = ir_from_cc("int Add(int a, int b);")?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_not_matches!(rs_api, quote! { Add_batch });
+        assert_cc_not_matches!(rs_api_impl, quote! { __rust_thunk___Z3Addii_batch });
+        Ok(())
+    }
+
     #[test]
     fn test_simple_function_with_types_from_other_target() -> Result<()> {
         let ir = ir_from_cc_dependency(
@@ -4417,7 +6909,7 @@ mod tests {
             "struct ReturnStruct final {}; struct ParamStruct final {};",
         )?;
 
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -4461,6 +6953,24 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn test_used_dep_targets() -> Result<()> {
+        let used_dep_targets = |header| -> Result<Vec<String>> {
+            let dep_header = "struct ParamStruct final {};";
+            // `generate_bindings_tokens` consumes the IR.
+            let ir = ir_from_cc_dependency(header, dep_header)?;
+            let BindingsTokens { rs_api, .. } =
+                generate_bindings_tokens(ir_from_cc_dependency(header, dep_header)?)?;
+            Ok(super::used_dep_targets(&ir, iter::once(&rs_api)))
+        };
+        assert_eq!(
+            used_dep_targets("inline void DoSomething(ParamStruct param);")?,
+            vec![ir_testing::DEPENDENCY_TARGET]
+        );
+        assert!(used_dep_targets("inline void DoSomething(int param);")?.is_empty());
+        Ok(())
+    }
+
     #[test]
     fn test_template_in_dependency_and_alias_in_current_target() -> Result<()> {
         // See also the test with the same name in `ir_from_cc_test.rs`.
@@ -4476,7 +6986,7 @@ mod tests {
             ir_from_cc_dependency(current_target_src, dependency_src)?
         };
 
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -4604,7 +7114,7 @@ mod tests {
         "#,
         )?;
 
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -4667,7 +7177,7 @@ mod tests {
             };
         "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
 
         // A Rust `struct` is generated for both `SomeStruct` and `SomeClass`.
         assert_rs_matches!(rs_api, quote! { pub struct SomeStruct },);
@@ -4701,7 +7211,7 @@ mod tests {
             } SomeAnonStruct __attribute__((aligned(16)));
         "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
 
         // A `struct` is generated for both `SomeStruct` and `SomeAnonStruct`, both
         // in Rust and in C++.
@@ -4757,7 +7267,7 @@ mod tests {
             inline SomeStruct::Type Function() {return 0;}
         "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         // TODO(b/200067824): This should use the alias's real name in Rust, as well.
         assert_rs_matches!(rs_api, quote! { pub fn Function() -> ::core::ffi::c_int { ... } },);
 
@@ -4857,51 +7367,141 @@ mod tests {
     }
 
     #[test]
-    fn test_record_with_unsupported_field_type() -> Result<()> {
-        // Using a nested struct because it's currently not supported.
-        // But... any other unsupported type would also work for this test.
+    fn test_record_trivial_getter_reads_field_without_thunk() -> Result<()> {
         let ir = ir_from_cc(
-            r#"
-            struct StructWithUnsupportedField {
-              struct NestedStruct {
-                int nested_field;
-              };
-
-              // Doc comment for `my_field`.
-              NestedStruct my_field;
-            };
-        "#,
+            r#"#pragma clang lifetime_elision
+            struct SomeStruct {
+                int size() const { return size_; }
+                int size_plus_one() const { return size_ + 1; }
+              private:
+                int size_;
+            }; "#,
         )?;
-        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
-                #[repr(C, align(4))]
-                pub struct StructWithUnsupportedField {
-                    #[doc = " Doc comment for `my_field`.\n \n Reason for representing this field as a blob of bytes:\n Unsupported type 'struct StructWithUnsupportedField::NestedStruct': No generated bindings found for 'NestedStruct'"]
-                    pub(crate) my_field: [::core::mem::MaybeUninit<u8>; 4],
+                #[inline(always)]
+                pub fn size<'a>(&'a self) -> ::core::ffi::c_int {
+                    self.size_
                 }
-                ...
-                const _: () = assert!(
-                    memoffset::offset_of!(crate::StructWithUnsupportedField, my_field) == 0);
             }
         );
+        assert_rs_not_matches!(rs_api, quote! { __rust_thunk___ZNK10SomeStruct4sizeEv });
+        assert_cc_not_matches!(rs_api_impl, quote! { __rust_thunk___ZNK10SomeStruct4sizeEv });
+
+        // Other inline bodies still go through a thunk.
+        assert_rs_matches!(
+            rs_api,
+            quote! { crate::detail::__rust_thunk___ZNK10SomeStruct13size_plus_oneEv(self) }
+        );
+        assert_cc_matches!(rs_api_impl, quote! { __rust_thunk___ZNK10SomeStruct13size_plus_oneEv });
         Ok(())
     }
 
-    /// This is a regression test for b/283835873 where the alignment of the
-    /// generated struct was wrong/missing.
     #[test]
-    fn test_struct_with_only_bitfields() -> Result<()> {
-        let ir = ir_from_cc(
-            r#"
-                struct SomeStruct {
-                  char32_t code_point : 31;
-                  enum : char32_t {
-                    ok = 0,
-                    error = 1
-                  } status : 1;
-                };
+    fn test_record_proto_accessors_read_without_thunk() -> Result<()> {
+        let mut ir = ir_from_cc(
+            r#"#pragma clang lifetime_elision
+            struct Message final {
+                int foo() const { return _internal_foo(); }
+                bool has_foo() const { return (has_bits_[0] & 0x2u) != 0; }
+                int foo_plus_one() const { return _internal_foo() + 1; }
+              private:
+                int _internal_foo() const { return foo_; }
+                unsigned int has_bits_[1];
+                int foo_;
+            }; "#,
+        )?;
+        *ir.target_crubit_features_mut(&ir.current_target().clone()) |=
+            CrubitFeature::ProtoAccessors;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                #[inline(always)]
+                pub fn foo<'a>(&'a self) -> ::core::ffi::c_int {
+                    const _: () = assert!(::core::mem::size_of::<::core::ffi::c_int>() == 4);
+                    const _: () = assert!(4 + 4 <= ::core::mem::size_of::<crate::Message>());
+                    let value = unsafe {
+                        ::core::ptr::read_unaligned(
+                            (self as *const Self as *const u8).add(4) as *const ::core::ffi::c_int
+                        )
+                    };
+                    value
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                #[inline(always)]
+                pub fn has_foo<'a>(&'a self) -> bool {
+                    const _: () = assert!(::core::mem::size_of::<u32>() == 4);
+                    const _: () = assert!(0 + 4 <= ::core::mem::size_of::<crate::Message>());
+                    let value = unsafe {
+                        ::core::ptr::read_unaligned(
+                            (self as *const Self as *const u8).add(0) as *const u32
+                        )
+                    };
+                    (value & 2) != 0
+                }
+            }
+        );
+        assert_cc_not_matches!(rs_api_impl, quote! { __rust_thunk___ZNK7Message3fooEv });
+        assert_cc_not_matches!(rs_api_impl, quote! { __rust_thunk___ZNK7Message7has_fooEv });
+
+        // Other inline bodies still go through a thunk.
+        assert_cc_matches!(rs_api_impl, quote! { __rust_thunk___ZNK7Message12foo_plus_oneEv });
+        Ok(())
+    }
+
+    #[test]
+    fn test_record_with_unsupported_field_type() -> Result<()> {
+        // Using a nested struct because it's currently not supported.
+        // But... any other unsupported type would also work for this test.
+        let ir = ir_from_cc(
+            r#"
+            struct StructWithUnsupportedField {
+              struct NestedStruct {
+                int nested_field;
+              };
+
+              // Doc comment for `my_field`.
+              NestedStruct my_field;
+            };
+        "#,
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                #[repr(C, align(4))]
+                pub struct StructWithUnsupportedField {
+                    #[doc = " Doc comment for `my_field`.\n \n Reason for representing this field as a blob of bytes:\n Unsupported type 'struct StructWithUnsupportedField::NestedStruct': No generated bindings found for 'NestedStruct'"]
+                    pub(crate) my_field: [::core::mem::MaybeUninit<u8>; 4],
+                }
+                ...
+                const _: () = assert!(
+                    memoffset::offset_of!(crate::StructWithUnsupportedField, my_field) == 0);
+            }
+        );
+        Ok(())
+    }
+
+    /// This is a regression test for b/283835873 where the alignment of the
+    /// generated struct was wrong/missing.
+    #[test]
+    fn test_struct_with_only_bitfields() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+                struct SomeStruct {
+                  char32_t code_point : 31;
+                  enum : char32_t {
+                    ok = 0,
+                    error = 1
+                  } status : 1;
+                };
                 static_assert(sizeof(SomeStruct) == 4);
                 static_assert(alignof(SomeStruct) == 4);
             "#,
@@ -4925,6 +7525,75 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn test_struct_bitfield_accessors() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+                struct Flags final {
+                  unsigned a : 3;
+                  bool b : 1;
+                  int c : 4;
+                  void set_c(int c);
+                };
+            "#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                impl crate::Flags {
+                    #[inline(always)]
+                    pub fn a(&self) -> ::core::ffi::c_uint {
+                        unsafe {
+                            let storage = (self as *const Self
+                                as *const ::core::mem::MaybeUninit<u8>)
+                                .add(0);
+                            let mut bytes = [0u8; 8];
+                            for i in 0..1 {
+                                bytes[i] = storage.add(i).read().assume_init();
+                            }
+                            let mask: u64 = u64::MAX >> (u64::BITS - 3);
+                            let value = ((u64::from_le_bytes(bytes) >> 0) & mask)
+                                as ::core::ffi::c_uint;
+                            let shift = <::core::ffi::c_uint>::BITS.saturating_sub(3);
+                            (value << shift) >> shift
+                        }
+                    }
+                    #[inline(always)]
+                    pub fn set_a(&mut self, value: ::core::ffi::c_uint) {
+                        unsafe {
+                            let storage = (self as *mut Self
+                                as *mut ::core::mem::MaybeUninit<u8>)
+                                .add(0);
+                            let mask: u64 = u64::MAX >> (u64::BITS - 3);
+                            let mut bytes = (((value as u64) & mask) << 0).to_le_bytes();
+                            bytes[0] |= storage.add(0).read().assume_init() & 248;
+                            for i in 0..1 {
+                                storage.add(i).write(::core::mem::MaybeUninit::new(bytes[i]));
+                            }
+                        }
+                    }
+                    #[inline(always)]
+                    pub fn b(&self) -> bool {
+                        unsafe {
+                            ...
+                            ((u64::from_le_bytes(bytes) >> 3) & mask) != 0
+                        }
+                    }
+                    ...
+                    pub fn c(&self) -> ::core::ffi::c_int { ... }
+                }
+            }
+        );
+        // The setter of `c` would conflict with the C++ member function.
+        assert_rs_not_matches!(
+            rs_api,
+            quote! { pub fn set_c(&mut self, value: ::core::ffi::c_int) }
+        );
+        assert_cc_not_matches!(rs_api_impl, quote! { __bitfields });
+        Ok(())
+    }
+
     #[test]
     fn test_struct_with_unnamed_bitfield_member() -> Result<()> {
         // This test input causes `field_decl->getName()` to return an empty string.
@@ -5172,7 +7841,7 @@ mod tests {
     #[test]
     fn test_struct_from_other_target() -> Result<()> {
         let ir = ir_from_cc_dependency("// intentionally empty", "struct SomeStruct {};")?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_not_matches!(rs_api, quote! { SomeStruct });
         assert_cc_not_matches!(rs_api_impl, quote! { SomeStruct });
         Ok(())
@@ -5185,9 +7854,10 @@ mod tests {
     }
 
     #[test]
-    fn test_copy_derives_not_is_trivial_abi() {
+    fn test_copy_derives_not_trivially_relocatable() {
         let mut record = ir_record("S");
         record.is_trivial_abi = false;
+        record.is_trivially_relocatable = false;
         assert_eq!(generate_derives(&record), &[""; 0]);
     }
 
@@ -5237,11 +7907,46 @@ mod tests {
         }
     }
 
+    /// Special members that are defaulted out of line are non-trivial in C++,
+    /// but the importer reports them as trivial when the implicit ones would
+    /// have been: copying such structs doesn't need a thunk.
+    #[test]
+    fn test_copy_derives_special_members_defaulted_out_of_line() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            struct DefaultedOutOfLine final {
+              DefaultedOutOfLine(const DefaultedOutOfLine&);
+              ~DefaultedOutOfLine();
+              int x;
+            };
+            inline DefaultedOutOfLine::DefaultedOutOfLine(const DefaultedOutOfLine&) = default;
+            inline DefaultedOutOfLine::~DefaultedOutOfLine() = default;
+            "#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                #[derive(Clone, Copy)]
+                #[repr(C)]
+                pub struct DefaultedOutOfLine { ... }
+            }
+        );
+        assert_rs_not_matches!(rs_api, quote! { impl Clone for DefaultedOutOfLine });
+        assert_rs_not_matches!(rs_api, quote! { impl Drop for DefaultedOutOfLine });
+        assert_cc_not_matches!(
+            rs_api_impl,
+            quote! { __rust_thunk___ZN18DefaultedOutOfLineC1ERKS_ }
+        );
+        assert_cc_not_matches!(rs_api_impl, quote! { __rust_thunk___ZN18DefaultedOutOfLineD1Ev });
+        Ok(())
+    }
+
     #[test]
     fn test_ptr_func() -> Result<()> {
         let ir = ir_from_cc(r#" inline int* Deref(int*const* p); "#)?;
 
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -5284,7 +7989,7 @@ mod tests {
         // generate a thunk for it (where we then process the CcType).
         let ir = ir_from_cc(r#" inline void f(const signed char *str); "#)?;
 
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -5297,25 +8002,522 @@ mod tests {
         assert_rs_matches!(
             rs_api,
             quote! {
-                extern "C" {
-                    pub(crate) fn __rust_thunk___Z1fPKa(str: *const ::core::ffi::c_schar);
-                }
+                extern "C" {
+                    pub(crate) fn __rust_thunk___Z1fPKa(str: *const ::core::ffi::c_schar);
+                }
+            }
+        );
+
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" void __rust_thunk___Z1fPKa(signed char const * str){ f(str); }
+            }
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_span_params_are_raw_slices() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            namespace absl {
+            template <typename T>
+            class Span {
+              T* ptr_;
+              decltype(sizeof(0)) len_;
+            };
+            }  // namespace absl
+
+            int Sum(absl::Span<const int> values);
+            void Fill(absl::Span<int> values);
+            "#,
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub unsafe fn Sum(values: *const [::core::ffi::c_int]) -> ::core::ffi::c_int { ... }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub unsafe fn Fill(values: *mut [::core::ffi::c_int]) { ... }
+            }
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_string_views_are_raw_slices() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            namespace std {
+            template <typename CharT, typename Traits>
+            class basic_string_view {
+              const CharT* data_;
+              decltype(sizeof(0)) size_;
+            };
+            template <typename CharT>
+            struct char_traits {};
+            using u16string_view = basic_string_view<char16_t, char_traits<char16_t>>;
+            }  // namespace std
+
+            std::u16string_view Trim(std::u16string_view s);
+            "#,
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub unsafe fn Trim(s: *const [u16]) -> *const [u16] { ... }
+            }
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_vectors_are_cc_std_vectors() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            namespace std {
+            template <typename T>
+            class allocator {};
+            template <typename T, typename Allocator = allocator<T>>
+            class vector {
+              T* begin_;
+              T* end_;
+              T* end_cap_;
+            };
+            }  // namespace std
+
+            float Sum(const std::vector<float>& values);
+            std::vector<int> Iota(int n);
+            "#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub unsafe fn Sum(values: *const ::cc_std::Vector<f32>) -> f32 { ... }
+            }
+        );
+        // `std::vector` is returned through an out-parameter, like other types with a
+        // non-trivial destructor.
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn Iota(n: ::core::ffi::c_int) -> ::cc_std::Vector<::core::ffi::c_int> {
+                    unsafe {
+                        let mut __return =
+                            ::core::mem::MaybeUninit::<::cc_std::Vector<::core::ffi::c_int>>::uninit();
+                        ...
+                    }
+                }
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" void __rust_thunk___Z4Iotai(std::vector<...>* __return, int n) { ... }
+            }
+        );
+        Ok(())
+    }
+
+    /// A `std::string` declared like libc++'s, with a layout that `cc_std::String`
+    /// supports if `libcxx` is true.
+    fn fake_std_string_header(libcxx: bool) -> String {
+        let version = if libcxx { "#define _LIBCPP_VERSION 170000" } else { "" };
+        format!(
+            r#"
+            {version}
+            namespace std {{
+            inline namespace __u {{
+            template <typename T>
+            class allocator {{}};
+            template <typename CharT>
+            class char_traits {{}};
+            template <typename CharT, typename Traits = char_traits<CharT>,
+                      typename Allocator = allocator<CharT>>
+            class basic_string {{
+              void* words_[3];
+            }};
+            using string = basic_string<char>;
+            }}  // namespace __u
+            }}  // namespace std
+            "#
+        )
+    }
+
+    #[test]
+    fn test_std_string_with_known_layout_is_cc_std_string() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "int Length(const std::string& s); std::string Greeting();",
+            &fake_std_string_header(true),
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! { pub unsafe fn Length(s: *const ::cc_std::String) -> ::core::ffi::c_int { ... } }
+        );
+        // `std::string` is returned through an out-parameter, like other types with a
+        // non-trivial destructor.
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn Greeting() -> ::cc_std::String {
+                    unsafe {
+                        let mut __return = ::core::mem::MaybeUninit::<::cc_std::String>::uninit();
+                        ...
+                    }
+                }
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! { extern "C" void __rust_thunk___Z8Greetingv(std::...* __return) { ... } }
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_std_string_with_unknown_layout_is_not_mapped() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "int Length(const std::string& s);",
+            &fake_std_string_header(false),
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_not_matches!(rs_api, quote! { ::cc_std::String });
+        Ok(())
+    }
+
+    /// A `std::optional` laid out like libc++'s.
+    const FAKE_STD_OPTIONAL_HEADER: &str = r#"
+        namespace std {
+        template <typename T>
+        struct __optional_destruct_base {
+          union {
+            char __null_state_;
+            T __val_;
+          };
+          bool __engaged_;
+        };
+        template <typename T>
+        class optional : private __optional_destruct_base<T> {};
+        }  // namespace std
+    "#;
+
+    #[test]
+    fn test_optional_is_cc_std_optional() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "std::optional<double> Find(int key);
+             int ValueOr(std::optional<int> o, int default_value);",
+            FAKE_STD_OPTIONAL_HEADER,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn Find(key: ::core::ffi::c_int) -> ::cc_std::Optional<f64> {
+                    unsafe {
+                        let mut __return = ::core::mem::MaybeUninit::<::cc_std::Optional<f64>>::uninit();
+                        ...
+                    }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn ValueOr(
+                    mut o: ::cc_std::Optional<::core::ffi::c_int>,
+                    default_value: ::core::ffi::c_int
+                ) -> ::core::ffi::c_int { ... }
+            }
+        );
+        assert_cc_matches!(rs_api_impl, quote! { std::optional<int>* o });
+        Ok(())
+    }
+
+    #[test]
+    fn test_optional_of_non_trivially_copyable_type_is_not_mapped() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "struct NonTrivial { NonTrivial(const NonTrivial&); };
+             void Take(std::optional<NonTrivial>* o);",
+            FAKE_STD_OPTIONAL_HEADER,
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_not_matches!(rs_api, quote! { ::cc_std::Optional });
+        Ok(())
+    }
+
+    fn fake_std_unique_ptr_header(trivial_abi: bool) -> String {
+        let attribute = if trivial_abi { "[[clang::trivial_abi]]" } else { "" };
+        format!(
+            r#"
+            namespace std {{
+            template <typename T>
+            struct default_delete {{}};
+            template <typename T, typename Deleter = default_delete<T>>
+            class {attribute} unique_ptr {{
+             public:
+              ~unique_ptr();
+             private:
+              T* ptr_;
+            }};
+            }}  // namespace std
+            "#
+        )
+    }
+
+    #[test]
+    fn test_unique_ptr_is_cc_box() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "struct Widget { int x; };
+             std::unique_ptr<Widget> MakeWidget();
+             void TakeInt(std::unique_ptr<int> p);",
+            &fake_std_unique_ptr_header(false),
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        // Without `[[clang::trivial_abi]]`, `std::unique_ptr` is passed by pointer.
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn MakeWidget() -> ::cc_std::CcBox<crate::Widget> {
+                    unsafe {
+                        let mut __return =
+                            ::core::mem::MaybeUninit::<::cc_std::CcBox<crate::Widget>>::uninit();
+                        ...
+                    }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn TakeInt(mut p: ::cc_std::CcBox<::core::ffi::c_int>) { ... }
+            }
+        );
+        // Deleting a `Widget` takes a single thunk call.
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                unsafe impl ::cc_std::CcDelete for crate::Widget {
+                    #[inline(always)]
+                    unsafe fn cc_delete(ptr: *mut Self) {
+                        crate::detail::__crubit_delete__6Widget(ptr)
+                    }
+                }
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" void __crubit_delete__6Widget(struct Widget* ptr) {
+                    delete ptr;
+                }
+            }
+        );
+        assert_cc_matches!(rs_api_impl, quote! { std::unique_ptr<...>* p });
+        assert_cc_matches!(rs_api_impl, quote! { TakeInt(std::move(*p)) });
+        Ok(())
+    }
+
+    #[test]
+    fn test_trivial_abi_unique_ptr_is_passed_by_value() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "struct Widget { int x; };
+             std::unique_ptr<Widget> MakeWidget();
+             void TakeWidget(std::unique_ptr<Widget> p);",
+            &fake_std_unique_ptr_header(true),
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn MakeWidget() -> ::cc_std::CcBox<crate::Widget> {
+                    unsafe { crate::detail::__rust_thunk___Z10MakeWidgetv() }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! { pub fn TakeWidget(p: ::cc_std::CcBox<crate::Widget>) { ... } }
+        );
+        assert_cc_matches!(rs_api_impl, quote! { std::unique_ptr<...> p });
+        assert_cc_matches!(rs_api_impl, quote! { TakeWidget(std::move(p)) });
+        Ok(())
+    }
+
+    #[test]
+    fn test_unique_ptr_of_dependency_record_is_not_mapped() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "std::unique_ptr<Widget> MakeWidget();",
+            &format!("{} struct Widget {{ int x; }};", fake_std_unique_ptr_header(false)),
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_not_matches!(rs_api, quote! { ::cc_std::CcBox });
+        Ok(())
+    }
+
+    const FAKE_ABSL_STATUSOR_HEADER: &str = r#"
+        namespace absl {
+        class Status {
+         public:
+          bool ok() const;
+         private:
+          void* rep_;
+        };
+        template <typename T>
+        class StatusOr {
+         public:
+          bool ok() const;
+          const Status& status() const&;
+          Status status() &&;
+          T&& operator*() &&;
+         private:
+          Status status_;
+          T value_;
+        };
+        }  // namespace absl
+    "#;
+
+    #[test]
+    fn test_status_or_is_returned_as_result() -> Result<()> {
+        let ir =
+            ir_from_cc_dependency("absl::StatusOr<int> Parse(int x);", FAKE_ABSL_STATUSOR_HEADER)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn Parse(x: ::core::ffi::c_int)
+                    -> ::core::result::Result<::core::ffi::c_int, dependency::absl::Status> {
+                    unsafe {
+                        let mut __value = ::core::mem::MaybeUninit::<::core::ffi::c_int>::uninit();
+                        let mut __status =
+                            ::core::mem::MaybeUninit::<dependency::absl::Status>::uninit();
+                        if crate::detail::__rust_thunk___Z5Parsei(&mut __value, &mut __status, x) {
+                            ::core::result::Result::Ok(__value.assume_init())
+                        } else {
+                            ::core::result::Result::Err(__status.assume_init())
+                        }
+                    }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub(crate) fn __rust_thunk___Z5Parsei(
+                    __value: &mut ::core::mem::MaybeUninit<::core::ffi::c_int>,
+                    __status: &mut ::core::mem::MaybeUninit<dependency::absl::Status>,
+                    x: ::core::ffi::c_int) -> bool;
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                extern "C" bool __rust_thunk___Z5Parsei(
+                    int* __value, class absl::Status* __status, int x) {
+                    auto __status_or = Parse(x);
+                    if (__status_or.ok()) {
+                        new (__value) auto(*std::move(__status_or));
+                        return true;
+                    }
+                    new (__status) auto(std::move(__status_or).status());
+                    return false;
+                }
+            }
+        );
+        Ok(())
+    }
+
+    const FAKE_ABSL_FUNCTION_REF_HEADER: &str = r#"
+        namespace absl {
+        template <typename T>
+        class FunctionRef;
+        template <typename R, typename... Args>
+        class FunctionRef<R(Args...)> {
+         public:
+          template <typename F>
+          FunctionRef(const F& f);
+          R operator()(Args... args) const;
+         private:
+          const void* obj_;
+          R (*invoker_)(const void*, Args...);
+        };
+        }  // namespace absl
+    "#;
+
+    #[test]
+    fn test_function_ref_param_is_a_closure() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "void ForEach(int n, absl::FunctionRef<bool(int)> f);",
+            FAKE_ABSL_FUNCTION_REF_HEADER,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn ForEach(n: ::core::ffi::c_int, mut f: impl FnMut(::core::ffi::c_int) -> bool) {
+                    let (__f_data, __f_invoke) = {
+                        unsafe extern "C" fn __invoke<F: FnMut(::core::ffi::c_int) -> bool>(
+                            __data: *mut ::core::ffi::c_void, __arg0: ::core::ffi::c_int
+                        ) -> bool {
+                            (*(__data as *mut F))(__arg0)
+                        }
+                        ...
+                        __trampoline(&mut f)
+                    };
+                    unsafe { crate::detail:: ... (n, __f_data, __f_invoke) }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub(crate) fn ... (
+                    n: ::core::ffi::c_int,
+                    __f_data: *mut ::core::ffi::c_void,
+                    __f_invoke: unsafe extern "C" fn(
+                        *mut ::core::ffi::c_void, ::core::ffi::c_int) -> bool
+                );
             }
         );
-
         assert_cc_matches!(
             rs_api_impl,
             quote! {
-                extern "C" void __rust_thunk___Z1fPKa(signed char const * str){ f(str); }
+                extern "C" void ... (
+                    int n, void* f, crubit::type_identity_t<bool(void*, int)>* __f_invoke) {
+                    ForEach(n, [&](auto&&... __args) -> decltype(auto) {
+                        return __f_invoke(f, std::forward<decltype(__args)>(__args)...);
+                    });
+                }
             }
         );
         Ok(())
     }
 
+    #[test]
+    fn test_function_ref_of_nontrivial_type_is_unsupported() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            r#"
+            struct Nontrivial final { ~Nontrivial(); };
+            void Visit(absl::FunctionRef<void(Nontrivial)> f);
+            "#,
+            FAKE_ABSL_FUNCTION_REF_HEADER,
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_not_matches!(rs_api, quote! {pub fn Visit});
+        Ok(())
+    }
+
     #[test]
     fn test_func_ptr_where_params_are_primitive_types() -> Result<()> {
         let ir = ir_from_cc(r#" int (*get_ptr_to_func())(float, double); "#)?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -5387,7 +8589,7 @@ mod tests {
     #[test]
     fn test_func_ptr_where_params_are_raw_ptrs() -> Result<()> {
         let ir = ir_from_cc(r#" const int* (*get_ptr_to_func())(const int*); "#)?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -5469,7 +8671,7 @@ mod tests {
                 }
             );
 
-            let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+            let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
             // Check that the custom "vectorcall" ABI gets propagated into the
             // return type (i.e. into `extern "vectorcall" fn`).
             assert_rs_matches!(
@@ -5568,7 +8770,7 @@ mod tests {
                 double f_c_calling_convention(double p1, double p2);
             "#,
             )?;
-            let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+            let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
             assert_rs_matches!(
                 rs_api,
                 quote! {
@@ -6287,7 +9489,7 @@ mod tests {
             };
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
 
         assert_rs_matches!(
             rs_api,
@@ -6303,7 +9505,8 @@ mod tests {
         assert_cc_matches!(
             rs_api_impl,
             quote! {
-                extern "C" void __rust_thunk___ZN9SomeUnionC1Ev(union SomeUnion*__this) {...}
+                extern "C" void __rust_thunk___ZN9SomeUnionC1EOS_(
+                    union SomeUnion*__this, union SomeUnion*__param_0) {...}
             }
         );
         assert_cc_matches!(
@@ -6576,11 +9779,7 @@ mod tests {
                 impl Default for UnionWithDefaultConstructors {
                     #[inline(always)]
                     fn default() -> Self {
-                        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-                        unsafe {
-                            crate::detail::__rust_thunk___ZN28UnionWithDefaultConstructorsC1Ev(&mut tmp);
-                            tmp.assume_init()
-                        }
+                        unsafe { ::core::mem::zeroed() }
                     }
                 }
             }
@@ -6653,6 +9852,46 @@ mod tests {
         Ok(())
     }
 
+    /// The offset of a virtual base of a final class is known statically, so
+    /// the upcast doesn't need a C++ thunk.
+    #[test]
+    fn test_virtual_base_of_final_class() -> Result<()> {
+        let ir = ir_from_cc_dependency(
+            "
+            struct VirtualBase { int x; };
+            struct Mid : virtual VirtualBase {};
+            struct Derived final : Mid { int y; };
+        ",
+            "",
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                unsafe impl oops::Inherits<crate::VirtualBase> for crate::Derived {
+                    unsafe fn upcast_ptr(derived: *const Self) -> *const crate::VirtualBase {
+                        (derived as *const _ as *const u8).offset(12) as *const crate::VirtualBase
+                    }
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                unsafe impl oops::Inherits<crate::VirtualBase> for crate::Mid {
+                    unsafe fn upcast_ptr(derived: *const Self) -> *const crate::VirtualBase {
+                        crate::detail::__crubit_dynamic_upcast__3Mid__to__11VirtualBase(derived)
+                    }
+                }
+            }
+        );
+        assert_cc_not_matches!(
+            rs_api_impl,
+            quote! { __crubit_dynamic_upcast__7Derived__to__11VirtualBase }
+        );
+        Ok(())
+    }
+
     /// Contrary to intuitions: a base class conversion is ambiguous even if the
     /// ambiguity is from a private base class cast that you can't even
     /// perform.
@@ -6696,6 +9935,26 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn test_final_virtual_method_without_thunk() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            struct Base { virtual void Foo(); virtual void Bar(); };
+            struct FinalMethod : Base { void Foo() final; };
+            struct FinalClass final : Base { void Bar() override; };"#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(rs_api, quote! { #[link_name = "_ZN11FinalMethod3FooEv"] });
+        assert_rs_matches!(rs_api, quote! { #[link_name = "_ZN10FinalClass3BarEv"] });
+        assert_cc_not_matches!(rs_api_impl, quote! { __rust_thunk___ZN11FinalMethod3FooEv });
+        assert_cc_not_matches!(rs_api_impl, quote! { __rust_thunk___ZN10FinalClass3BarEv });
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! { extern "C" void __rust_thunk___ZN4Base3FooEv(struct Base * __this) }
+        );
+        Ok(())
+    }
+
     /// A trivially relocatable final struct is safe to use in Rust as normal,
     /// and is Unpin.
     #[test]
@@ -6706,6 +9965,63 @@ mod tests {
         Ok(())
     }
 
+    /// A final struct annotated as trivially relocatable is Unpin, even though
+    /// it has a user-defined move constructor and destructor: it is moved by
+    /// `memcpy` in Rust, and still passed to C++ functions indirectly.
+    #[test]
+    fn test_no_negative_impl_unpin_trivially_relocatable_attribute() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            struct [[clang::annotate("crubit_internal_trivially_relocatable")]]
+                Relocatable final {
+              Relocatable(Relocatable&&);
+              ~Relocatable();
+              int* p;
+            };
+            void TakeByValue(Relocatable r);
+            "#,
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_not_matches!(rs_api, quote! {#[::ctor::recursively_pinned]});
+        assert_rs_matches!(rs_api, quote! { impl Drop for Relocatable { ... } });
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub fn TakeByValue(mut r: crate::Relocatable) {
+                    unsafe { crate::detail::__rust_thunk___Z11TakeByValue11Relocatable(&mut r) }
+                }
+            }
+        );
+        Ok(())
+    }
+
+    /// Records annotated as thread-safe or thread-compatible are Send and
+    /// Sync, even though they have pointer fields.
+    #[test]
+    fn test_thread_safety_attributes() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            struct [[clang::annotate("crubit_internal_thread_safe")]] ThreadSafe {
+              int* p;
+            };
+            struct [[clang::annotate("crubit_internal_thread_compatible")]] ThreadCompatible {
+              int* p;
+            };
+            struct NotAnnotated {
+              int* p;
+            };
+            "#,
+        )?;
+        let rs_api = generate_bindings_tokens(ir)?.rs_api;
+        assert_rs_matches!(rs_api, quote! { unsafe impl Send for crate::ThreadSafe {} });
+        assert_rs_matches!(rs_api, quote! { unsafe impl Sync for crate::ThreadSafe {} });
+        assert_rs_matches!(rs_api, quote! { unsafe impl Send for crate::ThreadCompatible {} });
+        assert_rs_matches!(rs_api, quote! { unsafe impl Sync for crate::ThreadCompatible {} });
+        assert_rs_not_matches!(rs_api, quote! { unsafe impl Send for crate::NotAnnotated {} });
+        assert_rs_not_matches!(rs_api, quote! { unsafe impl Sync for crate::NotAnnotated {} });
+        Ok(())
+    }
+
     /// A non-final struct, even if it's trivial, is not usable by mut
     /// reference, and so is !Unpin.
     #[test]
@@ -6808,7 +10124,7 @@ mod tests {
                 int x;
             };"#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_not_matches!(rs_api, quote! {impl Drop});
         assert_rs_not_matches!(rs_api, quote! {impl ::ctor::PinnedDrop});
         assert_rs_matches!(rs_api, quote! {pub x: ::core::ffi::c_int});
@@ -6822,18 +10138,45 @@ mod tests {
             r#"#pragma clang lifetime_elision
             struct DefaultedConstructor final {
                 DefaultedConstructor() = default;
+                int i = 0;
+                int* p = nullptr;
             };"#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
                 impl Default for DefaultedConstructor {
+                    #[inline(always)]
+                    fn default() -> Self {
+                        unsafe { ::core::mem::zeroed() }
+                    }
+                }
+            }
+        );
+        assert_rs_not_matches!(rs_api, quote! { __rust_thunk___ZN20DefaultedConstructorC1Ev });
+        assert_cc_not_matches!(rs_api_impl, quote! { __rust_thunk___ZN20DefaultedConstructorC1Ev });
+        Ok(())
+    }
+
+    #[test]
+    fn test_impl_default_nonzero_default_member_initializer() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"#pragma clang lifetime_elision
+            struct NonzeroInitializer final {
+                int i = 1;
+            };"#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                impl Default for NonzeroInitializer {
                     #[inline(always)]
                     fn default() -> Self {
                         let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
                         unsafe {
-                            crate::detail::__rust_thunk___ZN20DefaultedConstructorC1Ev(&mut tmp);
+                            crate::detail::__rust_thunk___ZN18NonzeroInitializerC1Ev(&mut tmp);
                             tmp.assume_init()
                         }
                     }
@@ -6843,8 +10186,8 @@ mod tests {
         assert_cc_matches!(
             rs_api_impl,
             quote! {
-                extern "C" void __rust_thunk___ZN20DefaultedConstructorC1Ev(
-                        struct DefaultedConstructor* __this) {
+                extern "C" void __rust_thunk___ZN18NonzeroInitializerC1Ev(
+                        struct NonzeroInitializer* __this) {
                     crubit::construct_at(__this);
                 }
             }
@@ -7010,7 +10353,7 @@ mod tests {
                 int i;
             };"#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -7122,7 +10465,7 @@ mod tests {
                 int i;
             };"#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -7389,6 +10732,37 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn test_impl_lt_for_several_records() -> Result<()> {
+        let cc_src = r#"#pragma clang lifetime_elision
+            struct Vec2 final {
+                inline bool operator==(const Vec2& other) const { return x == other.x; }
+                inline bool operator<(const Vec2& other) const { return x < other.x; }
+                int x;
+            };
+            struct Vec3 final {
+                inline bool operator==(const Vec3& other) const { return x == other.x; }
+                inline bool operator<(const Vec3& other) const { return x < other.x; }
+                int x;
+            };"#;
+        let mut db = Database::default();
+        db.set_ir(Rc::new(ir_from_cc(cc_src)?));
+        db.set_generate_source_loc_doc_comment(SourceLocationDocComment::Enabled);
+        db.set_layout_assertions(LayoutAssertions::PerItem);
+        db.set_collapse_opaque_fields(false);
+        db.set_errors(Rc::new(IgnoreErrors));
+        let eq = UnqualifiedIdentifier::Operator(Operator { name: Rc::from("==") });
+        // One group per record, each with the record's own `operator==`.
+        let functions = db.functions_with_bindings_by_param_types(eq);
+        assert_eq!(functions.len(), 2);
+        assert!(functions.values().all(|functions| functions.len() == 1));
+
+        let rs_api = generate_bindings_tokens(ir_from_cc(cc_src)?)?.rs_api;
+        assert_rs_matches!(rs_api, quote! { impl PartialOrd for Vec2 });
+        assert_rs_matches!(rs_api, quote! { impl PartialOrd for Vec3 });
+        Ok(())
+    }
+
     #[test]
     fn test_impl_lt_missing_eq_impl() -> Result<()> {
         let ir = ir_from_cc(
@@ -7534,7 +10908,7 @@ mod tests {
                 namespace bar { void not_overloaded(); }
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
 
         // Cannot overload free functions.
         assert_cc_matches!(rs_api, {
@@ -7588,7 +10962,7 @@ mod tests {
                 inline void f(MyTypedefDecl t) {}
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -7613,6 +10987,71 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn test_global_var() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+                namespace ns { extern int counter; }
+                extern const unsigned kLimit;
+            "#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                pub mod ns {
+                    ...
+                    extern "C" {
+                        #[link_name = "_ZN2ns7counterE"]
+                        pub static mut counter: ::core::ffi::c_int;
+                    }
+                    const _: () = assert!(::core::mem::size_of::<::core::ffi::c_int>() == 4);
+                    const _: () = assert!(::core::mem::align_of::<::core::ffi::c_int>() == 4);
+                    ...
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                extern "C" {
+                    #[link_name = "kLimit"]
+                    pub static kLimit: ::core::ffi::c_uint;
+                }
+            }
+        );
+        assert_cc_not_matches!(rs_api_impl, quote! { counter });
+        assert_cc_not_matches!(rs_api_impl, quote! { kLimit });
+        Ok(())
+    }
+
+    #[test]
+    fn test_constant() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+                constexpr unsigned kMask = 0xFFu;
+                struct S final {
+                  static constexpr int kMin = -8;
+                  static constexpr bool kFlag = true;
+                };
+            "#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
+        assert_rs_matches!(rs_api, quote! { pub const kMask: ::core::ffi::c_uint = 255; });
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                impl S {
+                    pub const kMin: ::core::ffi::c_int = -8;
+                }
+            }
+        );
+        assert_rs_matches!(rs_api, quote! { impl S { pub const kFlag: bool = true; } });
+        assert_cc_not_matches!(rs_api_impl, quote! { kMask });
+        assert_cc_not_matches!(rs_api_impl, quote! { kMin });
+        Ok(())
+    }
+
     #[test]
     fn test_rs_type_kind_implements_copy() -> Result<()> {
         let template = r#" LIFETIMES
@@ -8255,7 +11694,7 @@ mod tests {
             Nontrivial ReturnsByValue(const int& x, const int& y);
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -8295,7 +11734,7 @@ mod tests {
             const Nontrivial ReturnsByValue(const int& x, const int& y);
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -8336,7 +11775,7 @@ mod tests {
             void foo(Trivial param);
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -8374,7 +11813,7 @@ mod tests {
             Trivial foo();
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -8484,7 +11923,7 @@ mod tests {
             };
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -8534,7 +11973,7 @@ mod tests {
             void TakesByValue(Nontrivial x);
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -8607,7 +12046,7 @@ mod tests {
             void TakesByValue(Nonmovable) {}
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         // Bindings for TakesByValue cannot be generated.
         assert_rs_not_matches!(rs_api, quote! {TakesByValue});
         assert_cc_not_matches!(rs_api_impl, quote! {TakesByValue});
@@ -8627,7 +12066,7 @@ mod tests {
             };
             "#,
         )?;
-        let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
         assert_rs_matches!(
             rs_api,
             quote! {
@@ -8830,6 +12269,198 @@ mod tests {
         Ok(())
     }
 
+    #[test]
+    fn test_namespaces_in_rs_api_shards() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            namespace a { struct A final {}; }
+            namespace b { struct B final {}; }
+            namespace a { struct A2 final {}; }
+            struct TopLevel final {};"#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_shards, .. } = super::generate_bindings_tokens(
+            Rc::new(ir),
+            "crubit/rs_bindings_support",
+            Rc::new(IgnoreErrors),
+            SourceLocationDocComment::Enabled,
+            LayoutAssertions::PerItem,
+            /* omit_thunk_free_rs_api_impl= */ false,
+            /* collapse_opaque_fields= */ false,
+            None,
+            &["shard_0.rs".to_string(), "shard_1.rs".to_string()],
+            &Timings::default(),
+        )?;
+
+        assert_rs_matches!(rs_api, quote! { pub struct TopLevel { ... } });
+        assert_rs_matches!(rs_api, quote! { include!("shard_0.rs"); include!("shard_1.rs"); });
+        assert_rs_not_matches!(rs_api, quote! { pub mod a });
+        assert_rs_not_matches!(rs_api, quote! { pub mod b });
+        // Both `a`s stay together, so that `a` can re-export the items of `a_0`.
+        let [shard_0, shard_1] = <[TokenStream; 2]>::try_from(rs_api_shards).unwrap();
+        assert_rs_matches!(
+            shard_0,
+            quote! {
+                pub mod a_0 { ... pub struct A { ... } ... }
+                ...
+                pub mod a { pub use super::a_0::*; ... pub struct A2 { ... } ... }
+            }
+        );
+        assert_rs_matches!(shard_1, quote! { pub mod b { ... pub struct B { ... } ... } });
+        assert_rs_not_matches!(shard_1, quote! { pub mod a });
+        Ok(())
+    }
+
+    #[test]
+    fn test_consolidated_layout_assertions() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            struct SomeStruct final { int first; int second; };
+            namespace ns { struct Nested final { char c; }; }"#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = super::generate_bindings_tokens(
+            Rc::new(ir),
+            "crubit/rs_bindings_support",
+            Rc::new(IgnoreErrors),
+            SourceLocationDocComment::Enabled,
+            LayoutAssertions::Consolidated,
+            /* omit_thunk_free_rs_api_impl= */ false,
+            /* collapse_opaque_fields= */ false,
+            None,
+            /* rs_api_shard_file_names= */ &[],
+            &Timings::default(),
+        )?;
+
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                const _: () = {
+                    const LAYOUT_CHECKS: &[(usize, usize)] = &[
+                        (::core::mem::size_of::<crate::SomeStruct>(), 8),
+                        (::core::mem::align_of::<crate::SomeStruct>(), 4),
+                        (memoffset::offset_of!(crate::SomeStruct, first), 0),
+                        (memoffset::offset_of!(crate::SomeStruct, second), 4),
+                        (::core::mem::size_of::<crate::ns::Nested>(), 1),
+                        (::core::mem::align_of::<crate::ns::Nested>(), 1),
+                        (memoffset::offset_of!(crate::ns::Nested, c), 0),
+                    ];
+                    ...
+                };
+            }
+        );
+        assert_rs_not_matches!(rs_api, quote! { assert!(memoffset::offset_of!(...) == ...) });
+        assert_rs_not_matches!(
+            rs_api,
+            quote! { assert!(::core::mem::size_of::<crate::SomeStruct>() == 8) }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! {
+                static_assert([] {
+                    constexpr bool kLayoutChecks[] = {
+                        CRUBIT_SIZEOF(struct SomeStruct) == 8,
+                        alignof(struct SomeStruct) == 4,
+                        CRUBIT_OFFSET_OF(first, struct SomeStruct) == 0,
+                        CRUBIT_OFFSET_OF(second, struct SomeStruct) == 4,
+                        sizeof(struct ns::Nested) == 1,
+                        alignof(struct ns::Nested) == 1,
+                        CRUBIT_OFFSET_OF(c, struct ns::Nested) == 0,
+                    };
+                    ...
+                }());
+            }
+        );
+        assert_cc_not_matches!(rs_api_impl, quote! { static_assert(CRUBIT_OFFSET_OF(...) == ...) });
+        Ok(())
+    }
+
+    #[test]
+    fn test_collapse_opaque_fields() -> Result<()> {
+        let ir = ir_from_cc(
+            r#"
+            class Opaque final {
+              int first;
+              char second;
+            };
+            struct Visible final { int field; };"#,
+        )?;
+        let BindingsTokens { rs_api, rs_api_impl, .. } = super::generate_bindings_tokens(
+            Rc::new(ir),
+            "crubit/rs_bindings_support",
+            Rc::new(IgnoreErrors),
+            SourceLocationDocComment::Enabled,
+            LayoutAssertions::PerItem,
+            /* omit_thunk_free_rs_api_impl= */ false,
+            /* collapse_opaque_fields= */ true,
+            None,
+            /* rs_api_shard_file_names= */ &[],
+            &Timings::default(),
+        )?;
+
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                #[repr(C, align(4))]
+                pub struct Opaque {
+                    __non_field_data: [::core::mem::MaybeUninit<u8>; 0],
+                    #[doc = " Reason for representing the fields as a blob of bytes:\n `first`: Types of non-public C++ fields can be elided away\n `second`: Types of non-public C++ fields can be elided away"]
+                    pub(crate) __opaque_fields: [::core::mem::MaybeUninit<u8>; 8],
+                }
+            }
+        );
+        assert_rs_matches!(
+            rs_api,
+            quote! { const _: () = assert!(::core::mem::size_of::<crate::Opaque>() == 8); }
+        );
+        assert_rs_not_matches!(rs_api, quote! { memoffset::offset_of!(crate::Opaque, ...) });
+        assert_cc_not_matches!(rs_api_impl, quote! { CRUBIT_OFFSET_OF(..., class Opaque) });
+
+        // Records with fields of Rust types are laid out as before.
+        assert_rs_matches!(
+            rs_api,
+            quote! {
+                const _: () = assert!(memoffset::offset_of!(crate::Visible, field) == 0);
+            }
+        );
+        assert_cc_matches!(
+            rs_api_impl,
+            quote! { static_assert(CRUBIT_OFFSET_OF(field, struct Visible) == 0); }
+        );
+        Ok(())
+    }
+
+    #[test]
+    fn test_omit_thunk_free_rs_api_impl() -> Result<()> {
+        let generate = |header: &str| {
+            super::generate_bindings_tokens(
+                Rc::new(ir_from_cc(header)?),
+                "crubit/rs_bindings_support",
+                Rc::new(IgnoreErrors),
+                SourceLocationDocComment::Enabled,
+                LayoutAssertions::PerItem,
+                /* omit_thunk_free_rs_api_impl= */ true,
+                /* collapse_opaque_fields= */ false,
+                None,
+                /* rs_api_shard_file_names= */ &[],
+                &Timings::default(),
+            )
+        };
+
+        let BindingsTokens { rs_api, rs_api_impl, .. } = generate(
+            r#"
+            enum Color { kRed, kGreen };
+            extern "C" int Add(int a, int b);"#,
+        )?;
+        assert_rs_matches!(rs_api, quote! { pub fn Add(...) -> ... });
+        assert_rs_not_matches!(rs_api, quote! { mod detail });
+        assert_cc_not_matches!(rs_api_impl, quote! { __HASH_TOKEN__ include });
+        assert_cc_not_matches!(rs_api_impl, quote! { static_assert });
+
+        let rs_api_impl = generate("inline int Mul(int a, int b) { return a * b; }")?.rs_api_impl;
+        assert_cc_matches!(rs_api_impl, quote! { __HASH_TOKEN__ include <memory> });
+        assert_cc_matches!(rs_api_impl, quote! { extern "C" int __rust_thunk___Z3Mulii(...) });
+        Ok(())
+    }
+
     #[test]
     fn test_qualified_identifiers_in_impl_file() -> Result<()> {
         let rs_api_impl = generate_bindings_tokens(ir_from_cc(
@@ -9269,7 +12900,7 @@ mod tests {
         {
             let mut ir = ir_from_cc(item)?;
             ir.target_crubit_features_mut(&ir.current_target().clone()).clear();
-            let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+            let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
             assert_rs_not_matches!(rs_api, quote! {NotPresent});
             assert_cc_not_matches!(rs_api_impl, quote! {NotPresent});
             let expected = "\
@@ -9287,7 +12918,7 @@ mod tests {
         for dependency in ["struct NotPresent {};", "using NotPresent = int;"] {
             let mut ir = ir_from_cc_dependency("void Func(NotPresent);", dependency)?;
             ir.target_crubit_features_mut(&ir::BazelLabel("//test:dependency".into())).clear();
-            let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+            let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
             assert_rs_not_matches!(rs_api, quote! {Func});
             assert_cc_not_matches!(rs_api_impl, quote! {Func});
             let expected = "\
@@ -9305,7 +12936,7 @@ mod tests {
         for dependency in ["struct NotPresent {};", "using NotPresent = int;"] {
             let mut ir = ir_from_cc_dependency("NotPresent Func();", dependency)?;
             ir.target_crubit_features_mut(&ir::BazelLabel("//test:dependency".into())).clear();
-            let BindingsTokens { rs_api, rs_api_impl } = generate_bindings_tokens(ir)?;
+            let BindingsTokens { rs_api, rs_api_impl, .. } = generate_bindings_tokens(ir)?;
             assert_rs_not_matches!(rs_api, quote! {Func});
             assert_cc_not_matches!(rs_api_impl, quote! {Func});
             let expected = "\
@@ -9324,7 +12955,7 @@ mod tests {
         {
             let mut ir = ir_from_cc_dependency("struct Present {NotPresent field;};", dependency)?;
             ir.target_crubit_features_mut(&ir::BazelLabel("//test:dependency".into())).clear();
-            let BindingsTokens { rs_api, rs_api_impl: _ } = generate_bindings_tokens(ir)?;
+            let BindingsTokens { rs_api, .. } = generate_bindings_tokens(ir)?;
             assert_rs_matches!(
                 rs_api,
                 quote! {
@@ -0,0 +1,25 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/test/benchmarks/call_overhead/call_overhead.h"
+
+int AddOutOfLine(int x, int y) { return x + y; }
+
+unsigned Accumulator::AddOutOfLine(unsigned x) {
+  total += x;
+  return total;
+}
+
+unsigned VirtualAccumulator::Add(unsigned x) {
+  total_ += x;
+  return total_;
+}
+
+Point MakePoint(int x, int y) { return Point{x, y}; }
+
+Nontrivial::Nontrivial(int value) : value_(value) {}
+Nontrivial::Nontrivial(const Nontrivial& other) : value_(other.value_) {}
+Nontrivial::~Nontrivial() {}
+
+Nontrivial MakeNontrivial(int value) { return Nontrivial(value); }
@@ -0,0 +1,69 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_TEST_BENCHMARKS_CALL_OVERHEAD_CALL_OVERHEAD_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_TEST_BENCHMARKS_CALL_OVERHEAD_CALL_OVERHEAD_H_
+
+#pragma clang lifetime_elision
+
+// Functions called from Rust by `call_overhead_benchmark.rs`. Functions which
+// are not `inline` are defined in `call_overhead.cc`, so that they can't be
+// inlined into the thunks.
+
+int AddOutOfLine(int x, int y);
+
+inline int AddInline(int x, int y) { return x + y; }
+
+// A trivial (and therefore `Unpin`) record.
+//
+// The totals of the accumulators are unsigned, so that they wrap around
+// (rather than overflow) when a benchmark adds up a million calls' arguments.
+struct Accumulator final {
+  unsigned AddOutOfLine(unsigned x);
+  unsigned AddInline(unsigned x) {
+    total += x;
+    return total;
+  }
+
+  unsigned total;
+};
+
+// A polymorphic (and therefore `!Unpin`) class.
+class VirtualAccumulator {
+ public:
+  VirtualAccumulator() = default;
+  virtual ~VirtualAccumulator() = default;
+
+  virtual unsigned Add(unsigned x);
+
+ private:
+  unsigned total_ = 0;
+};
+
+// A trivial record, which is returned by value through an out-parameter of the
+// thunk.
+struct Point final {
+  int x;
+  int y;
+};
+
+Point MakePoint(int x, int y);
+
+// A record with a user-provided copy constructor and destructor (and therefore
+// `!Unpin`), which is constructed in place through a `Ctor`.
+class Nontrivial final {
+ public:
+  explicit Nontrivial(int value);
+  Nontrivial(const Nontrivial& other);
+  ~Nontrivial();
+
+  int value() const { return value_; }
+
+ private:
+  int value_;
+};
+
+Nontrivial MakeNontrivial(int value);
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_TEST_BENCHMARKS_CALL_OVERHEAD_CALL_OVERHEAD_H_
@@ -0,0 +1,97 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! Microbenchmarks of the cost of calling C++ from Rust through the bindings
+//! generated by `rs_bindings_from_cc`.
+//!
+//! Each test prints the average time per call, e.g.:
+//!
+//! ```text
+//! bazel test -c opt --test_output=all \
+//!     //rs_bindings_from_cc/test/benchmarks/call_overhead:call_overhead_benchmark
+//! ```
+
+#[cfg(test)]
+mod tests {
+    use call_overhead::*;
+    use ctor::CtorNew as _;
+    use std::hint::black_box;
+    use std::time::Instant;
+
+    const CALLS: i32 = 1_000_000;
+
+    /// Calls `f` `CALLS` times, and prints the average time per call.
+    fn report_time_per_call(name: &str, mut f: impl FnMut(i32) -> i32) {
+        let start = Instant::now();
+        for i in 0..CALLS {
+            black_box(f(black_box(i)));
+        }
+        let nanos_per_call = start.elapsed().as_nanos() as f64 / CALLS as f64;
+        println!("{name}: {nanos_per_call:.2} ns/call");
+    }
+
+    #[test]
+    fn bench_rust_baseline() {
+        #[inline(never)]
+        fn add(x: i32, y: i32) -> i32 {
+            x.wrapping_add(y)
+        }
+        report_time_per_call("Rust function", |i| add(i, 1));
+    }
+
+    #[test]
+    fn bench_free_function() {
+        report_time_per_call("free function", |i| AddOutOfLine(i, 1));
+    }
+
+    #[test]
+    fn bench_inline_function() {
+        report_time_per_call("inline function", |i| AddInline(i, 1));
+    }
+
+    #[test]
+    fn bench_method() {
+        let mut accumulator = Accumulator::default();
+        report_time_per_call("method", |i| accumulator.AddOutOfLine(i as u32) as i32);
+    }
+
+    #[test]
+    fn bench_inline_method() {
+        let mut accumulator = Accumulator::default();
+        report_time_per_call("inline method", |i| accumulator.AddInline(i as u32) as i32);
+    }
+
+    #[test]
+    fn bench_virtual_method() {
+        ctor::emplace! {
+            let mut accumulator = VirtualAccumulator::ctor_new(());
+        }
+        report_time_per_call("virtual method", |i| accumulator.as_mut().Add(i as u32) as i32);
+    }
+
+    #[test]
+    fn bench_record_returned_by_value() {
+        report_time_per_call("record returned by value", |i| MakePoint(i, 1).x);
+    }
+
+    #[test]
+    fn bench_ctor_construction() {
+        report_time_per_call("Ctor construction", |i| {
+            ctor::emplace! {
+                let nontrivial = Nontrivial::ctor_new(i);
+            }
+            nontrivial.value()
+        });
+    }
+
+    #[test]
+    fn bench_ctor_returned_by_value() {
+        report_time_per_call("Ctor returned by value", |i| {
+            ctor::emplace! {
+                let nontrivial = MakeNontrivial(i);
+            }
+            nontrivial.value()
+        });
+    }
+}
@@ -0,0 +1,23 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_OPTIONAL_OPTIONAL_APIS_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_OPTIONAL_OPTIONAL_APIS_H_
+
+#include <optional>
+
+namespace crubit_optional {
+
+inline std::optional<double> HalfIfEven(int n) {
+  if (n % 2 != 0) return std::nullopt;
+  return n / 2.0;
+}
+
+inline int ValueOr(std::optional<int> o, int default_value) {
+  return o.value_or(default_value);
+}
+
+}  // namespace crubit_optional
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_OPTIONAL_OPTIONAL_APIS_H_
@@ -0,0 +1,20 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+use cc_std::Optional;
+use optional_apis::crubit_optional::{HalfIfEven, ValueOr};
+
+#[test]
+fn test_returned_optional() {
+    assert_eq!(HalfIfEven(4).as_option(), Some(&2.0));
+    assert!(!HalfIfEven(3).has_value());
+    assert_eq!(Option::from(HalfIfEven(3)), None);
+}
+
+#[test]
+fn test_optional_param() {
+    assert_eq!(ValueOr(Optional::some(1), 2), 1);
+    assert_eq!(ValueOr(Optional::none(), 2), 2);
+    assert_eq!(ValueOr(Some(3).into(), 2), 3);
+}
@@ -0,0 +1,21 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_STRING_STRING_APIS_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_STRING_STRING_APIS_H_
+
+#include <cstddef>
+#include <string>
+
+namespace crubit_string {
+
+inline std::string Repeat(char c, size_t n) { return std::string(n, c); }
+
+inline size_t GetSize(const std::string& s) { return s.size(); }
+
+inline void Append(std::string& s, char c) { s.push_back(c); }
+
+}  // namespace crubit_string
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_STRING_STRING_APIS_H_
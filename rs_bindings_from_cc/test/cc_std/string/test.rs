@@ -0,0 +1,40 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+use cc_std::String;
+use string_apis::crubit_string::{Append, GetSize, Repeat};
+
+#[test]
+fn test_empty_string() {
+    let s = String::new();
+    assert!(s.is_empty());
+    assert_eq!(s.as_bytes(), b"");
+    assert_eq!(unsafe { GetSize(&s) }, 0);
+}
+
+#[test]
+fn test_short_string_returned_by_value() {
+    let s = Repeat(b'a' as _, 3);
+    assert_eq!(s.to_str(), Ok("aaa"));
+    assert_eq!(unsafe { *s.as_ptr().add(3) }, 0);
+}
+
+#[test]
+fn test_long_string_returned_by_value() {
+    let s = Repeat(b'b' as _, 100);
+    assert_eq!(s.len(), 100);
+    assert!(s.as_bytes().iter().all(|&c| c == b'b'));
+    assert_eq!(unsafe { *s.as_ptr().add(100) }, 0);
+}
+
+#[test]
+fn test_string_grown_in_cc() {
+    let mut s = String::new();
+    for _ in 0..50 {
+        unsafe { Append(&mut s, b'c' as _) };
+    }
+    assert_eq!(s.len(), 50);
+    assert_eq!(unsafe { GetSize(&s) }, 50);
+    assert_eq!(&s[..3], b"ccc");
+}
@@ -5,6 +5,7 @@
 #ifndef CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_STRING_VIEW_STRING_VIEW_APIS_H_
 #define CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_STRING_VIEW_STRING_VIEW_APIS_H_
 
+#include <cstddef>
 #include <string_view>
 namespace crubit_string_view {
 
@@ -12,6 +13,8 @@ inline std::string_view GetHelloWorld() { return "Hello, world!"; }
 
 inline std::string_view GetInvalidUtf8() { return "Not a UTF-8 byte: \xff"; }
 
+inline size_t GetSize(std::string_view sv) { return sv.size(); }
+
 }  // namespace crubit_string_view
 
 #endif  // CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_STRING_VIEW_STRING_VIEW_APIS_H_
@@ -3,24 +3,29 @@
 // SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
 
 use cc_std::*;
-use string_view_apis::crubit_string_view::{GetHelloWorld, GetInvalidUtf8};
+use string_view_apis::crubit_string_view::{GetHelloWorld, GetInvalidUtf8, GetSize};
 
 #[test]
 fn test_valid_utf8_str() {
-    let hello_str: &'static str = GetHelloWorld().try_into().unwrap();
+    let hello_str = unsafe { string_view_as_str(GetHelloWorld()) }.unwrap();
     assert_eq!(hello_str, "Hello, world!");
 }
 
 #[test]
 fn test_invalid_utf8_str() {
-    let not_a_str: Result<&'static str, _> = GetInvalidUtf8().try_into();
+    let not_a_str = unsafe { string_view_as_str(GetInvalidUtf8()) };
     let _ = not_a_str.unwrap_err();
 }
 
+#[test]
+fn test_string_view_param() {
+    assert_eq!(unsafe { GetSize(string_view_from_str("Hello")) }, 5);
+}
+
 #[test]
 fn test_round_trip_empty_str() {
     let original: &[u8] = &[];
-    let sv: std::string_view = original.into();
-    let round_tripped: &[u8] = sv.into();
+    let sv: std::string_view = string_view_from_bytes(original);
+    let round_tripped: &[u8] = unsafe { string_view_as_bytes(sv) };
     assert_eq!(original, round_tripped);
 }
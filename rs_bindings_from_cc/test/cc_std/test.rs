@@ -42,7 +42,7 @@ mod tests {
     #[test]
     fn test_string_view() {
         let x = "this is a string";
-        let x_sv = std::string_view::from(x);
-        assert_eq!(x, <&str>::try_from(x_sv).unwrap());
+        let x_sv = string_view_from_str(x);
+        assert_eq!(x, unsafe { string_view_as_str(x_sv) }.unwrap());
     }
 }
@@ -0,0 +1,41 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+use cc_std::CcBox;
+use unique_ptr_apis::crubit_unique_ptr::{ConsumeInt, DestroyedWidgets, MakeInt, MakeWidget};
+
+#[test]
+fn test_deref_without_thunk() {
+    let mut p = MakeInt(42);
+    assert_eq!(*p, 42);
+    *p += 1;
+    assert_eq!(ConsumeInt(p), 43);
+}
+
+#[test]
+fn test_null() {
+    let p = CcBox::<i32>::null();
+    assert!(p.is_null());
+    assert_eq!(p.as_ref(), None);
+    assert_eq!(ConsumeInt(p), -1);
+}
+
+#[test]
+fn test_drop_runs_cc_destructor() {
+    let destroyed = DestroyedWidgets();
+    {
+        let widget = MakeWidget(7);
+        assert_eq!(widget.value, 7);
+    }
+    assert_eq!(DestroyedWidgets(), destroyed + 1);
+}
+
+#[test]
+fn test_into_raw_releases_ownership() {
+    let p = MakeInt(1);
+    let raw = p.into_raw();
+    // SAFETY: `raw` was released by `into_raw`, and is owned again.
+    let p = unsafe { CcBox::from_raw(raw) };
+    assert_eq!(*p, 1);
+}
@@ -0,0 +1,33 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_UNIQUE_PTR_UNIQUE_PTR_APIS_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_UNIQUE_PTR_UNIQUE_PTR_APIS_H_
+
+#include <memory>
+
+namespace crubit_unique_ptr {
+
+inline int destroyed_widgets = 0;
+
+struct Widget {
+  ~Widget() { ++destroyed_widgets; }
+  int value;
+};
+
+inline std::unique_ptr<Widget> MakeWidget(int value) {
+  return std::unique_ptr<Widget>(new Widget{value});
+}
+
+inline int DestroyedWidgets() { return destroyed_widgets; }
+
+inline std::unique_ptr<int> MakeInt(int value) {
+  return std::make_unique<int>(value);
+}
+
+inline int ConsumeInt(std::unique_ptr<int> p) { return p ? *p : -1; }
+
+}  // namespace crubit_unique_ptr
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_UNIQUE_PTR_UNIQUE_PTR_APIS_H_
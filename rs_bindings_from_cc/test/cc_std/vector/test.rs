@@ -0,0 +1,40 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+use cc_std::Vector;
+use vector_apis::crubit_vector::{AppendOne, GetSize, Iota, Sum};
+
+#[test]
+fn test_vector_returned_by_value() {
+    let v = Iota(5);
+    assert_eq!(v.as_slice(), &[0, 1, 2, 3, 4]);
+}
+
+#[test]
+fn test_vector_filled_in_rust() {
+    let mut v = Vector::<f32>::new();
+    v.extend_from_slice(&[1.0, 2.0, 3.0]);
+    v.push(4.0);
+    assert_eq!(unsafe { Sum(&v) }, 10.0);
+}
+
+#[test]
+fn test_vector_grown_in_cc() {
+    let mut v = Vector::<f32>::new();
+    v.reserve(1);
+    let capacity = v.capacity();
+    unsafe { AppendOne(&mut v) };
+    unsafe { AppendOne(&mut v) };
+    assert_eq!(v.as_slice(), &[1.0, 1.0]);
+    assert!(v.capacity() >= capacity);
+    v.as_mut_slice()[0] = 2.0;
+    assert_eq!(unsafe { Sum(&v) }, 3.0);
+}
+
+#[test]
+fn test_vector_passed_by_value() {
+    let mut v = Vector::<f32>::new();
+    v.extend_from_slice(&[1.0, 2.0]);
+    assert_eq!(GetSize(v), 2);
+}
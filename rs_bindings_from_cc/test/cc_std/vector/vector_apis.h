@@ -0,0 +1,31 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_VECTOR_VECTOR_APIS_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_VECTOR_VECTOR_APIS_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <vector>
+
+namespace crubit_vector {
+
+inline std::vector<int64_t> Iota(int64_t n) {
+  std::vector<int64_t> result(n);
+  std::iota(result.begin(), result.end(), 0);
+  return result;
+}
+
+inline float Sum(const std::vector<float>& values) {
+  return std::accumulate(values.begin(), values.end(), 0.0f);
+}
+
+inline void AppendOne(std::vector<float>& values) { values.push_back(1.0f); }
+
+inline size_t GetSize(std::vector<float> values) { return values.size(); }
+
+}  // namespace crubit_vector
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_TEST_CC_STD_VECTOR_VECTOR_APIS_H_
@@ -0,0 +1,11 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_TEST_CROSS_LANGUAGE_LTO_ADD_ONE_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_TEST_CROSS_LANGUAGE_LTO_ADD_ONE_H_
+
+// Inline, so that Rust calls it through the `__rust_thunk___Z6AddOnei` thunk.
+inline int AddOne(int x) { return x + 1; }
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_TEST_CROSS_LANGUAGE_LTO_ADD_ONE_H_
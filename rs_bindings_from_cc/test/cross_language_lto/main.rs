@@ -0,0 +1,9 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+fn main() {
+    // Not a constant, so that the call isn't folded before it reaches the linker.
+    let x = std::env::args().count() as i32;
+    println!("{}", add_one::AddOne(x));
+}
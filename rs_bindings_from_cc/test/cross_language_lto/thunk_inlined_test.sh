@@ -0,0 +1,22 @@
+#!/bin/bash
+# Part of the Crubit project, under the Apache License v2.0 with LLVM
+# Exceptions. See /LICENSE for license information.
+# SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+# Checks that the C++ thunk of `AddOne` was inlined into its Rust caller, and
+# then dropped, by cross-language ThinLTO.
+
+binary="$1"
+
+if [[ "$("${binary}")" != "2" ]]; then
+  echo "Unexpected output of ${binary}"
+  exit 1
+fi
+
+if nm "${binary}" | grep -q "__rust_thunk___Z6AddOnei"; then
+  echo "The thunk of AddOne was not inlined. Was the test built with" \
+       "--config=cross_language_lto?"
+  exit 1
+fi
+
+echo "Success!"
@@ -141,6 +141,79 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for WithBitfields {
     }
 }
 
+impl crate::WithBitfields {
+    #[inline(always)]
+    pub fn f1(&self) -> ::core::ffi::c_int {
+        unsafe {
+            let storage = (self as *const Self as *const ::core::mem::MaybeUninit<u8>).add(0);
+            let mut bytes = [0u8; 8];
+            for i in 0..1 {
+                bytes[i] = storage.add(i).read().assume_init();
+            }
+            let mask: u64 = u64::MAX >> (u64::BITS - 2);
+            let value = ((u64::from_le_bytes(bytes) >> 0) & mask) as ::core::ffi::c_int;
+            let shift = <::core::ffi::c_int>::BITS.saturating_sub(2);
+            (value << shift) >> shift
+        }
+    }
+    #[inline(always)]
+    pub fn f3(&self) -> ::core::ffi::c_int {
+        unsafe {
+            let storage = (self as *const Self as *const ::core::mem::MaybeUninit<u8>).add(8);
+            let mut bytes = [0u8; 8];
+            for i in 0..1 {
+                bytes[i] = storage.add(i).read().assume_init();
+            }
+            let mask: u64 = u64::MAX >> (u64::BITS - 4);
+            let value = ((u64::from_le_bytes(bytes) >> 0) & mask) as ::core::ffi::c_int;
+            let shift = <::core::ffi::c_int>::BITS.saturating_sub(4);
+            (value << shift) >> shift
+        }
+    }
+    #[inline(always)]
+    pub fn f4(&self) -> ::core::ffi::c_int {
+        unsafe {
+            let storage = (self as *const Self as *const ::core::mem::MaybeUninit<u8>).add(8);
+            let mut bytes = [0u8; 8];
+            for i in 0..2 {
+                bytes[i] = storage.add(i).read().assume_init();
+            }
+            let mask: u64 = u64::MAX >> (u64::BITS - 8);
+            let value = ((u64::from_le_bytes(bytes) >> 4) & mask) as ::core::ffi::c_int;
+            let shift = <::core::ffi::c_int>::BITS.saturating_sub(8);
+            (value << shift) >> shift
+        }
+    }
+    #[inline(always)]
+    pub fn f6(&self) -> ::core::ffi::c_int {
+        unsafe {
+            let storage = (self as *const Self as *const ::core::mem::MaybeUninit<u8>).add(24);
+            let mut bytes = [0u8; 8];
+            for i in 0..3 {
+                bytes[i] = storage.add(i).read().assume_init();
+            }
+            let mask: u64 = u64::MAX >> (u64::BITS - 23);
+            let value = ((u64::from_le_bytes(bytes) >> 0) & mask) as ::core::ffi::c_int;
+            let shift = <::core::ffi::c_int>::BITS.saturating_sub(23);
+            (value << shift) >> shift
+        }
+    }
+    #[inline(always)]
+    pub fn f8(&self) -> ::core::ffi::c_int {
+        unsafe {
+            let storage = (self as *const Self as *const ::core::mem::MaybeUninit<u8>).add(28);
+            let mut bytes = [0u8; 8];
+            for i in 0..1 {
+                bytes[i] = storage.add(i).read().assume_init();
+            }
+            let mask: u64 = u64::MAX >> (u64::BITS - 2);
+            let value = ((u64::from_le_bytes(bytes) >> 0) & mask) as ::core::ffi::c_int;
+            let shift = <::core::ffi::c_int>::BITS.saturating_sub(2);
+            (value << shift) >> shift
+        }
+    }
+}
+
 /// This is a regression test for b/283835873 where the alignment of the
 /// generated struct was wrong/missing.
 #[::ctor::recursively_pinned]
@@ -248,6 +321,23 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for AlignmentRegressi
 // Error while generating bindings for item 'AlignmentRegressionTest::(unnamed enum at ./rs_bindings_from_cc/test/golden/bitfields.h:26:3)':
 // Unnamed enums are not supported yet
 
+impl crate::AlignmentRegressionTest {
+    #[inline(always)]
+    pub fn code_point(&self) -> u32 {
+        unsafe {
+            let storage = (self as *const Self as *const ::core::mem::MaybeUninit<u8>).add(0);
+            let mut bytes = [0u8; 8];
+            for i in 0..4 {
+                bytes[i] = storage.add(i).read().assume_init();
+            }
+            let mask: u64 = u64::MAX >> (u64::BITS - 31);
+            let value = ((u64::from_le_bytes(bytes) >> 0) & mask) as u32;
+            let shift = <u32>::BITS.saturating_sub(31);
+            (value << shift) >> shift
+        }
+    }
+}
+
 // CRUBIT_RS_BINDINGS_FROM_CC_TEST_GOLDEN_BITFIELDS_H_
 
 mod detail {
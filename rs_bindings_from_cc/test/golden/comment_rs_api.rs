@@ -40,11 +40,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("Foo"), crate::Foo);
 impl Default for Foo {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN3FooC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -109,11 +105,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("Bar"), crate::Bar);
 impl Default for Bar {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN3BarC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -157,11 +149,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("HasNoComments"), crate
 impl Default for HasNoComments {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN13HasNoCommentsC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -202,9 +190,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN3FooC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::Foo>,
-        );
         pub(crate) fn __rust_thunk___ZN3FooC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::Foo>,
             __param_0: ::ctor::RvalueReference<'b, crate::Foo>,
@@ -218,9 +203,6 @@ mod detail {
             __param_0: ::ctor::RvalueReference<'b, crate::Foo>,
         ) -> &'a mut crate::Foo;
         pub(crate) fn __rust_thunk___Z3foov();
-        pub(crate) fn __rust_thunk___ZN3BarC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::Bar>,
-        );
         pub(crate) fn __rust_thunk___ZN3BarC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::Bar>,
             __param_0: ::ctor::RvalueReference<'b, crate::Bar>,
@@ -233,9 +215,6 @@ mod detail {
             __this: &'a mut crate::Bar,
             __param_0: ::ctor::RvalueReference<'b, crate::Bar>,
         ) -> &'a mut crate::Bar;
-        pub(crate) fn __rust_thunk___ZN13HasNoCommentsC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::HasNoComments>,
-        );
         pub(crate) fn __rust_thunk___ZN13HasNoCommentsC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::HasNoComments>,
             __param_0: ::ctor::RvalueReference<'b, crate::HasNoComments>,
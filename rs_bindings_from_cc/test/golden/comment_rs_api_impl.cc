@@ -24,10 +24,6 @@ static_assert(alignof(struct Foo) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct Foo) == 0);
 static_assert(CRUBIT_OFFSET_OF(j, struct Foo) == 4);
 
-extern "C" void __rust_thunk___ZN3FooC1Ev(struct Foo* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN3FooC1EOS_(struct Foo* __this,
                                             struct Foo* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -49,10 +45,6 @@ static_assert(CRUBIT_SIZEOF(struct Bar) == 4);
 static_assert(alignof(struct Bar) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct Bar) == 0);
 
-extern "C" void __rust_thunk___ZN3BarC1Ev(struct Bar* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN3BarC1EOS_(struct Bar* __this,
                                             struct Bar* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -72,11 +64,6 @@ static_assert(CRUBIT_SIZEOF(struct HasNoComments) == 4);
 static_assert(alignof(struct HasNoComments) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct HasNoComments) == 0);
 
-extern "C" void __rust_thunk___ZN13HasNoCommentsC1Ev(
-    struct HasNoComments* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN13HasNoCommentsC1EOS_(
     struct HasNoComments* __this, struct HasNoComments* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
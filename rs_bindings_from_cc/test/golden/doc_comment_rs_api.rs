@@ -130,11 +130,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("DocCommentBang"), crat
 impl Default for DocCommentBang {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN14DocCommentBangC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -184,11 +180,7 @@ forward_declare::unsafe_define!(
 impl Default for MultilineCommentTwoStars {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN24MultilineCommentTwoStarsC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -235,11 +227,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("LineComment"), crate::
 impl Default for LineComment {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN11LineCommentC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -289,11 +277,7 @@ forward_declare::unsafe_define!(
 impl Default for MultilineOneStar {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN16MultilineOneStarC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -524,9 +508,6 @@ mod detail {
         );
         #[link_name = "_ZN17DocCommentSlashes13static_methodEv"]
         pub(crate) fn __rust_thunk___ZN17DocCommentSlashes13static_methodEv() -> ::core::ffi::c_int;
-        pub(crate) fn __rust_thunk___ZN14DocCommentBangC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::DocCommentBang>,
-        );
         pub(crate) fn __rust_thunk___ZN14DocCommentBangC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::DocCommentBang>,
             __param_0: ::ctor::RvalueReference<'b, crate::DocCommentBang>,
@@ -539,9 +520,6 @@ mod detail {
             __this: &'a mut crate::DocCommentBang,
             __param_0: ::ctor::RvalueReference<'b, crate::DocCommentBang>,
         ) -> &'a mut crate::DocCommentBang;
-        pub(crate) fn __rust_thunk___ZN24MultilineCommentTwoStarsC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::MultilineCommentTwoStars>,
-        );
         pub(crate) fn __rust_thunk___ZN24MultilineCommentTwoStarsC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::MultilineCommentTwoStars>,
             __param_0: ::ctor::RvalueReference<'b, crate::MultilineCommentTwoStars>,
@@ -554,9 +532,6 @@ mod detail {
             __this: &'a mut crate::MultilineCommentTwoStars,
             __param_0: ::ctor::RvalueReference<'b, crate::MultilineCommentTwoStars>,
         ) -> &'a mut crate::MultilineCommentTwoStars;
-        pub(crate) fn __rust_thunk___ZN11LineCommentC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::LineComment>,
-        );
         pub(crate) fn __rust_thunk___ZN11LineCommentC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::LineComment>,
             __param_0: ::ctor::RvalueReference<'b, crate::LineComment>,
@@ -569,9 +544,6 @@ mod detail {
             __this: &'a mut crate::LineComment,
             __param_0: ::ctor::RvalueReference<'b, crate::LineComment>,
         ) -> &'a mut crate::LineComment;
-        pub(crate) fn __rust_thunk___ZN16MultilineOneStarC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::MultilineOneStar>,
-        );
         pub(crate) fn __rust_thunk___ZN16MultilineOneStarC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::MultilineOneStar>,
             __param_0: ::ctor::RvalueReference<'b, crate::MultilineOneStar>,
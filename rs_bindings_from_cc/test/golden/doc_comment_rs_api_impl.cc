@@ -44,11 +44,6 @@ static_assert(CRUBIT_SIZEOF(struct DocCommentBang) == 4);
 static_assert(alignof(struct DocCommentBang) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct DocCommentBang) == 0);
 
-extern "C" void __rust_thunk___ZN14DocCommentBangC1Ev(
-    struct DocCommentBang* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN14DocCommentBangC1EOS_(
     struct DocCommentBang* __this, struct DocCommentBang* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -68,11 +63,6 @@ static_assert(CRUBIT_SIZEOF(struct MultilineCommentTwoStars) == 4);
 static_assert(alignof(struct MultilineCommentTwoStars) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct MultilineCommentTwoStars) == 0);
 
-extern "C" void __rust_thunk___ZN24MultilineCommentTwoStarsC1Ev(
-    struct MultilineCommentTwoStars* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN24MultilineCommentTwoStarsC1EOS_(
     struct MultilineCommentTwoStars* __this,
     struct MultilineCommentTwoStars* __param_0) {
@@ -97,10 +87,6 @@ static_assert(CRUBIT_SIZEOF(struct LineComment) == 4);
 static_assert(alignof(struct LineComment) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct LineComment) == 0);
 
-extern "C" void __rust_thunk___ZN11LineCommentC1Ev(struct LineComment* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN11LineCommentC1EOS_(
     struct LineComment* __this, struct LineComment* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -120,11 +106,6 @@ static_assert(CRUBIT_SIZEOF(struct MultilineOneStar) == 4);
 static_assert(alignof(struct MultilineOneStar) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct MultilineOneStar) == 0);
 
-extern "C" void __rust_thunk___ZN16MultilineOneStarC1Ev(
-    struct MultilineOneStar* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN16MultilineOneStarC1EOS_(
     struct MultilineOneStar* __this, struct MultilineOneStar* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -30,11 +30,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("type"), crate::r#type)
 impl Default for r#type {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN4typeC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -84,9 +80,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN4typeC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::r#type>,
-        );
         pub(crate) fn __rust_thunk___ZN4typeC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::r#type>,
             __param_0: ::ctor::RvalueReference<'b, crate::r#type>,
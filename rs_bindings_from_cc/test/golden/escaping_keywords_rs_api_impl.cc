@@ -23,10 +23,6 @@ static_assert(CRUBIT_SIZEOF(struct type) == 4);
 static_assert(alignof(struct type) == 4);
 static_assert(CRUBIT_OFFSET_OF(dyn, struct type) == 0);
 
-extern "C" void __rust_thunk___ZN4typeC1Ev(struct type* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN4typeC1EOS_(struct type* __this,
                                              struct type* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -30,11 +30,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("SomeClass"), crate::So
 impl Default for SomeClass {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN9SomeClassC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -103,9 +99,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN9SomeClassC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::SomeClass>,
-        );
         pub(crate) fn __rust_thunk___ZN9SomeClassC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::SomeClass>,
             __param_0: ::ctor::RvalueReference<'b, crate::SomeClass>,
@@ -22,10 +22,6 @@
 static_assert(sizeof(class SomeClass) == 1);
 static_assert(alignof(class SomeClass) == 1);
 
-extern "C" void __rust_thunk___ZN9SomeClassC1Ev(class SomeClass* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN9SomeClassC1EOS_(class SomeClass* __this,
                                                   class SomeClass* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
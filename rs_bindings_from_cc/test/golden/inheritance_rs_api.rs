@@ -339,11 +339,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("Derived"), crate::Deri
 impl Default for Derived {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN7DerivedC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -976,11 +972,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("MethodDerived"), crate
 impl Default for MethodDerived {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN13MethodDerivedC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -1087,9 +1079,6 @@ mod detail {
             __this: ::core::pin::Pin<&'a mut crate::Base2>,
             __param_0: ::ctor::RvalueReference<'b, crate::Base2>,
         ) -> ::core::pin::Pin<&'a mut crate::Base2>;
-        pub(crate) fn __rust_thunk___ZN7DerivedC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::Derived>,
-        );
         pub(crate) fn __rust_thunk___ZN7DerivedC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::Derived>,
             __param_0: ::ctor::RvalueReference<'b, crate::Derived>,
@@ -1236,9 +1225,6 @@ mod detail {
         pub(crate) fn __rust_thunk___ZN11MethodBase210Colliding2Ev<'a>(
             __this: ::core::pin::Pin<&'a mut crate::MethodBase2>,
         );
-        pub(crate) fn __rust_thunk___ZN13MethodDerivedC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::MethodDerived>,
-        );
         pub(crate) fn __rust_thunk___ZN13MethodDerivedC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::MethodDerived>,
             __param_0: ::ctor::RvalueReference<'b, crate::MethodDerived>,
@@ -104,10 +104,6 @@ static_assert(CRUBIT_SIZEOF(struct Derived) == 16);
 static_assert(alignof(struct Derived) == 8);
 static_assert(CRUBIT_OFFSET_OF(derived_1, struct Derived) == 12);
 
-extern "C" void __rust_thunk___ZN7DerivedC1Ev(struct Derived* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN7DerivedC1EOS_(struct Derived* __this,
                                                 struct Derived* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -300,11 +296,6 @@ extern "C" class MethodBase2* __rust_thunk___ZN11MethodBase2aSEOS_(
 static_assert(sizeof(class MethodDerived) == 1);
 static_assert(alignof(class MethodDerived) == 1);
 
-extern "C" void __rust_thunk___ZN13MethodDerivedC1Ev(
-    class MethodDerived* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN13MethodDerivedC1EOS_(
     class MethodDerived* __this, class MethodDerived* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
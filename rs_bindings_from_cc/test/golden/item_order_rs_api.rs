@@ -30,11 +30,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("FirstStruct"), crate::
 impl Default for FirstStruct {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN11FirstStructC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -82,11 +78,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("SecondStruct"), crate:
 impl Default for SecondStruct {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN12SecondStructC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -130,9 +122,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN11FirstStructC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::FirstStruct>,
-        );
         pub(crate) fn __rust_thunk___ZN11FirstStructC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::FirstStruct>,
             __param_0: ::ctor::RvalueReference<'b, crate::FirstStruct>,
@@ -146,9 +135,6 @@ mod detail {
             __param_0: ::ctor::RvalueReference<'b, crate::FirstStruct>,
         ) -> &'a mut crate::FirstStruct;
         pub(crate) fn __rust_thunk___Z10first_funcv() -> ::core::ffi::c_int;
-        pub(crate) fn __rust_thunk___ZN12SecondStructC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::SecondStruct>,
-        );
         pub(crate) fn __rust_thunk___ZN12SecondStructC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::SecondStruct>,
             __param_0: ::ctor::RvalueReference<'b, crate::SecondStruct>,
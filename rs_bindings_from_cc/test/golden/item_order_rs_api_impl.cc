@@ -23,10 +23,6 @@ static_assert(CRUBIT_SIZEOF(struct FirstStruct) == 4);
 static_assert(alignof(struct FirstStruct) == 4);
 static_assert(CRUBIT_OFFSET_OF(field, struct FirstStruct) == 0);
 
-extern "C" void __rust_thunk___ZN11FirstStructC1Ev(struct FirstStruct* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN11FirstStructC1EOS_(
     struct FirstStruct* __this, struct FirstStruct* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -48,11 +44,6 @@ static_assert(CRUBIT_SIZEOF(struct SecondStruct) == 4);
 static_assert(alignof(struct SecondStruct) == 4);
 static_assert(CRUBIT_OFFSET_OF(field, struct SecondStruct) == 0);
 
-extern "C" void __rust_thunk___ZN12SecondStructC1Ev(
-    struct SecondStruct* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN12SecondStructC1EOS_(
     struct SecondStruct* __this, struct SecondStruct* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -34,11 +34,7 @@ pub mod test_namespace_bindings {
     impl Default for S {
         #[inline(always)]
         fn default() -> Self {
-            let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-            unsafe {
-                crate::detail::__rust_thunk___ZN23test_namespace_bindings1SC1Ev(&mut tmp);
-                tmp.assume_init()
-            }
+            unsafe { ::core::mem::zeroed() }
         }
     }
 
@@ -216,11 +212,7 @@ pub mod test_namespace_bindings_inline {
         impl Default for StructInInlineNamespace {
             #[inline(always)]
             fn default() -> Self {
-                let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-                unsafe {
-                    crate::detail::__rust_thunk___ZN30test_namespace_bindings_inline5inner23StructInInlineNamespaceC1Ev(&mut tmp);
-                    tmp.assume_init()
-                }
+                unsafe { ::core::mem::zeroed() }
             }
         }
 
@@ -295,9 +287,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN23test_namespace_bindings1SC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::test_namespace_bindings::S>,
-        );
         pub(crate) fn __rust_thunk___ZN23test_namespace_bindings1SC1EOS0_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::test_namespace_bindings::S>,
             __param_0: ::ctor::RvalueReference<'b, crate::test_namespace_bindings::S>,
@@ -352,13 +341,6 @@ mod detail {
         pub(crate) fn __rust_thunk___ZN32test_namespace_bindings_reopened5inner1zENS0_1SE(
             s: &mut crate::test_namespace_bindings_reopened::inner::S,
         );
-        pub(crate) fn __rust_thunk___ZN30test_namespace_bindings_inline5inner23StructInInlineNamespaceC1Ev<
-            'a,
-        >(
-            __this: &'a mut ::core::mem::MaybeUninit<
-                crate::test_namespace_bindings_inline::inner::StructInInlineNamespace,
-            >,
-        );
         pub(crate) fn __rust_thunk___ZN30test_namespace_bindings_inline5inner23StructInInlineNamespaceC1EOS1_<
             'a,
             'b,
@@ -23,11 +23,6 @@ static_assert(CRUBIT_SIZEOF(struct test_namespace_bindings::S) == 4);
 static_assert(alignof(struct test_namespace_bindings::S) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct test_namespace_bindings::S) == 0);
 
-extern "C" void __rust_thunk___ZN23test_namespace_bindings1SC1Ev(
-    struct test_namespace_bindings::S* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN23test_namespace_bindings1SC1EOS0_(
     struct test_namespace_bindings::S* __this,
     struct test_namespace_bindings::S* __param_0) {
@@ -103,13 +98,6 @@ static_assert(sizeof(struct test_namespace_bindings_inline::inner::
 static_assert(alignof(struct test_namespace_bindings_inline::inner::
                           StructInInlineNamespace) == 1);
 
-extern "C" void
-__rust_thunk___ZN30test_namespace_bindings_inline5inner23StructInInlineNamespaceC1Ev(
-    struct test_namespace_bindings_inline::inner::StructInInlineNamespace*
-        __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void
 __rust_thunk___ZN30test_namespace_bindings_inline5inner23StructInInlineNamespaceC1EOS1_(
     struct test_namespace_bindings_inline::inner::StructInInlineNamespace*
@@ -41,11 +41,7 @@ forward_declare::unsafe_define!(
 impl Default for AddableConstMember {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN18AddableConstMemberC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -106,11 +102,7 @@ forward_declare::unsafe_define!(
 impl Default for AddableNonConstMember {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN21AddableNonConstMemberC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -174,11 +166,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("AddableFriend"), crate
 impl Default for AddableFriend {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN13AddableFriendC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -236,11 +224,7 @@ forward_declare::unsafe_define!(
 impl Default for AddableFreeByConstRef {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN21AddableFreeByConstRefC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -286,11 +270,7 @@ forward_declare::unsafe_define!(
 impl Default for AddableFreeByMutRef {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN19AddableFreeByMutRefC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -336,11 +316,7 @@ forward_declare::unsafe_define!(
 impl Default for AddableFreeByValue {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN18AddableFreeByValueC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -386,11 +362,7 @@ forward_declare::unsafe_define!(
 impl Default for AddableFreeByRValueRef {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN22AddableFreeByRValueRefC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -480,11 +452,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("Overloaded"), crate::O
 impl Default for Overloaded {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN10OverloadedC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -546,11 +514,7 @@ forward_declare::unsafe_define!(
 impl Default for IncompatibleLHS {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN15IncompatibleLHSC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -605,11 +569,7 @@ forward_declare::unsafe_define!(
 impl Default for AddableReturnsVoid {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN18AddableReturnsVoidC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -759,11 +719,7 @@ forward_declare::unsafe_define!(
 impl Default for AddAssignMemberInt {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN18AddAssignMemberIntC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -818,11 +774,7 @@ forward_declare::unsafe_define!(
 impl Default for AddAssignMemberByConstRef {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN25AddAssignMemberByConstRefC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -877,11 +829,7 @@ forward_declare::unsafe_define!(
 impl Default for AddAssignFreeByConstRef {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN23AddAssignFreeByConstRefC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -930,11 +878,7 @@ forward_declare::unsafe_define!(
 impl Default for AddAssignFreeByValue {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN20AddAssignFreeByValueC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -989,11 +933,7 @@ forward_declare::unsafe_define!(
 impl Default for AddAssignFriendByConstRef {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN25AddAssignFriendByConstRefC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -1039,11 +979,7 @@ forward_declare::unsafe_define!(
 impl Default for AddAssignFriendByValue {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN22AddAssignFriendByValueC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -1098,11 +1034,7 @@ forward_declare::unsafe_define!(
 impl Default for AddAssignProhibitedConstMember {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN30AddAssignProhibitedConstMemberC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -1155,11 +1087,7 @@ forward_declare::unsafe_define!(
 impl Default for AddAssignProhibitedFriendConstLhs {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN33AddAssignProhibitedFriendConstLhsC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -1213,11 +1141,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("ManyOperators"), crate
 impl Default for ManyOperators {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN13ManyOperatorsC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -1496,9 +1420,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN18AddableConstMemberC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddableConstMember>,
-        );
         pub(crate) fn __rust_thunk___ZN18AddableConstMemberC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddableConstMember>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableConstMember>,
@@ -1516,9 +1437,6 @@ mod detail {
             __this: &'a crate::AddableConstMember,
             rhs: &'b crate::AddableConstMember,
         );
-        pub(crate) fn __rust_thunk___ZN21AddableNonConstMemberC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddableNonConstMember>,
-        );
         pub(crate) fn __rust_thunk___ZN21AddableNonConstMemberC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddableNonConstMember>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableNonConstMember>,
@@ -1536,9 +1454,6 @@ mod detail {
             __this: &'a mut crate::AddableNonConstMember,
             rhs: &'b crate::AddableNonConstMember,
         );
-        pub(crate) fn __rust_thunk___ZN13AddableFriendC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFriend>,
-        );
         pub(crate) fn __rust_thunk___ZN13AddableFriendC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFriend>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableFriend>,
@@ -1556,9 +1471,6 @@ mod detail {
             lhs: &'a crate::AddableFriend,
             rhs: &'b crate::AddableFriend,
         );
-        pub(crate) fn __rust_thunk___ZN21AddableFreeByConstRefC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFreeByConstRef>,
-        );
         pub(crate) fn __rust_thunk___ZN21AddableFreeByConstRefC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFreeByConstRef>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableFreeByConstRef>,
@@ -1571,9 +1483,6 @@ mod detail {
             __this: &'a mut crate::AddableFreeByConstRef,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableFreeByConstRef>,
         ) -> &'a mut crate::AddableFreeByConstRef;
-        pub(crate) fn __rust_thunk___ZN19AddableFreeByMutRefC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFreeByMutRef>,
-        );
         pub(crate) fn __rust_thunk___ZN19AddableFreeByMutRefC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFreeByMutRef>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableFreeByMutRef>,
@@ -1586,9 +1495,6 @@ mod detail {
             __this: &'a mut crate::AddableFreeByMutRef,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableFreeByMutRef>,
         ) -> &'a mut crate::AddableFreeByMutRef;
-        pub(crate) fn __rust_thunk___ZN18AddableFreeByValueC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFreeByValue>,
-        );
         pub(crate) fn __rust_thunk___ZN18AddableFreeByValueC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFreeByValue>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableFreeByValue>,
@@ -1601,9 +1507,6 @@ mod detail {
             __this: &'a mut crate::AddableFreeByValue,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableFreeByValue>,
         ) -> &'a mut crate::AddableFreeByValue;
-        pub(crate) fn __rust_thunk___ZN22AddableFreeByRValueRefC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFreeByRValueRef>,
-        );
         pub(crate) fn __rust_thunk___ZN22AddableFreeByRValueRefC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddableFreeByRValueRef>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableFreeByRValueRef>,
@@ -1631,9 +1534,6 @@ mod detail {
             lhs: &mut crate::AddableFreeByValue,
             rhs: &mut crate::AddableFreeByValue,
         );
-        pub(crate) fn __rust_thunk___ZN10OverloadedC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::Overloaded>,
-        );
         pub(crate) fn __rust_thunk___ZN10OverloadedC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::Overloaded>,
             __param_0: ::ctor::RvalueReference<'b, crate::Overloaded>,
@@ -1656,9 +1556,6 @@ mod detail {
             lhs: &'a crate::Overloaded,
             rhs: ::core::ffi::c_uint,
         ) -> ::core::ffi::c_int;
-        pub(crate) fn __rust_thunk___ZN15IncompatibleLHSC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::IncompatibleLHS>,
-        );
         pub(crate) fn __rust_thunk___ZN15IncompatibleLHSC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::IncompatibleLHS>,
             __param_0: ::ctor::RvalueReference<'b, crate::IncompatibleLHS>,
@@ -1671,9 +1568,6 @@ mod detail {
             __this: &'a mut crate::IncompatibleLHS,
             __param_0: ::ctor::RvalueReference<'b, crate::IncompatibleLHS>,
         ) -> &'a mut crate::IncompatibleLHS;
-        pub(crate) fn __rust_thunk___ZN18AddableReturnsVoidC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddableReturnsVoid>,
-        );
         pub(crate) fn __rust_thunk___ZN18AddableReturnsVoidC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddableReturnsVoid>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddableReturnsVoid>,
@@ -1710,9 +1604,6 @@ mod detail {
         pub(crate) fn __rust_thunk___ZN26AddableConstMemberNonunpinD1Ev<'a>(
             __this: ::core::pin::Pin<&'a mut crate::AddableConstMemberNonunpin>,
         );
-        pub(crate) fn __rust_thunk___ZN18AddAssignMemberIntC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignMemberInt>,
-        );
         pub(crate) fn __rust_thunk___ZN18AddAssignMemberIntC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignMemberInt>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignMemberInt>,
@@ -1730,9 +1621,6 @@ mod detail {
             __this: &'a mut crate::AddAssignMemberInt,
             rhs: ::core::ffi::c_int,
         ) -> ::core::ffi::c_int;
-        pub(crate) fn __rust_thunk___ZN25AddAssignMemberByConstRefC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignMemberByConstRef>,
-        );
         pub(crate) fn __rust_thunk___ZN25AddAssignMemberByConstRefC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignMemberByConstRef>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignMemberByConstRef>,
@@ -1750,9 +1638,6 @@ mod detail {
             __this: &'a mut crate::AddAssignMemberByConstRef,
             rhs: &'b crate::AddAssignMemberByConstRef,
         ) -> &'a mut crate::AddAssignMemberByConstRef;
-        pub(crate) fn __rust_thunk___ZN23AddAssignFreeByConstRefC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignFreeByConstRef>,
-        );
         pub(crate) fn __rust_thunk___ZN23AddAssignFreeByConstRefC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignFreeByConstRef>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignFreeByConstRef>,
@@ -1765,9 +1650,6 @@ mod detail {
             __this: &'a mut crate::AddAssignFreeByConstRef,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignFreeByConstRef>,
         ) -> &'a mut crate::AddAssignFreeByConstRef;
-        pub(crate) fn __rust_thunk___ZN20AddAssignFreeByValueC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignFreeByValue>,
-        );
         pub(crate) fn __rust_thunk___ZN20AddAssignFreeByValueC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignFreeByValue>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignFreeByValue>,
@@ -1784,9 +1666,6 @@ mod detail {
             lhs: &'a mut crate::AddAssignFreeByValue,
             rhs: &mut crate::AddAssignFreeByValue,
         ) -> &'a mut crate::AddAssignFreeByValue;
-        pub(crate) fn __rust_thunk___ZN25AddAssignFriendByConstRefC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignFriendByConstRef>,
-        );
         pub(crate) fn __rust_thunk___ZN25AddAssignFriendByConstRefC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignFriendByConstRef>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignFriendByConstRef>,
@@ -1799,9 +1678,6 @@ mod detail {
             __this: &'a mut crate::AddAssignFriendByConstRef,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignFriendByConstRef>,
         ) -> &'a mut crate::AddAssignFriendByConstRef;
-        pub(crate) fn __rust_thunk___ZN22AddAssignFriendByValueC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignFriendByValue>,
-        );
         pub(crate) fn __rust_thunk___ZN22AddAssignFriendByValueC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignFriendByValue>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignFriendByValue>,
@@ -1818,9 +1694,6 @@ mod detail {
             lhs: &'a mut crate::AddAssignFriendByValue,
             rhs: &mut crate::AddAssignFriendByValue,
         ) -> &'a mut crate::AddAssignFriendByValue;
-        pub(crate) fn __rust_thunk___ZN30AddAssignProhibitedConstMemberC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignProhibitedConstMember>,
-        );
         pub(crate) fn __rust_thunk___ZN30AddAssignProhibitedConstMemberC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignProhibitedConstMember>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignProhibitedConstMember>,
@@ -1833,9 +1706,6 @@ mod detail {
             __this: &'a mut crate::AddAssignProhibitedConstMember,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignProhibitedConstMember>,
         ) -> &'a mut crate::AddAssignProhibitedConstMember;
-        pub(crate) fn __rust_thunk___ZN33AddAssignProhibitedFriendConstLhsC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignProhibitedFriendConstLhs>,
-        );
         pub(crate) fn __rust_thunk___ZN33AddAssignProhibitedFriendConstLhsC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::AddAssignProhibitedFriendConstLhs>,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignProhibitedFriendConstLhs>,
@@ -1848,9 +1718,6 @@ mod detail {
             __this: &'a mut crate::AddAssignProhibitedFriendConstLhs,
             __param_0: ::ctor::RvalueReference<'b, crate::AddAssignProhibitedFriendConstLhs>,
         ) -> &'a mut crate::AddAssignProhibitedFriendConstLhs;
-        pub(crate) fn __rust_thunk___ZN13ManyOperatorsC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::ManyOperators>,
-        );
         pub(crate) fn __rust_thunk___ZN13ManyOperatorsC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::ManyOperators>,
             __param_0: ::ctor::RvalueReference<'b, crate::ManyOperators>,
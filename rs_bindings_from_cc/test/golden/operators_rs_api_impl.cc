@@ -22,11 +22,6 @@
 static_assert(CRUBIT_SIZEOF(class AddableConstMember) == 4);
 static_assert(alignof(class AddableConstMember) == 4);
 
-extern "C" void __rust_thunk___ZN18AddableConstMemberC1Ev(
-    class AddableConstMember* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN18AddableConstMemberC1EOS_(
     class AddableConstMember* __this, class AddableConstMember* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -54,11 +49,6 @@ extern "C" void __rust_thunk___ZNK18AddableConstMemberplERKS_(
 static_assert(CRUBIT_SIZEOF(class AddableNonConstMember) == 4);
 static_assert(alignof(class AddableNonConstMember) == 4);
 
-extern "C" void __rust_thunk___ZN21AddableNonConstMemberC1Ev(
-    class AddableNonConstMember* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN21AddableNonConstMemberC1EOS_(
     class AddableNonConstMember* __this,
     class AddableNonConstMember* __param_0) {
@@ -88,11 +78,6 @@ extern "C" void __rust_thunk___ZN21AddableNonConstMemberplERKS_(
 static_assert(CRUBIT_SIZEOF(class AddableFriend) == 4);
 static_assert(alignof(class AddableFriend) == 4);
 
-extern "C" void __rust_thunk___ZN13AddableFriendC1Ev(
-    class AddableFriend* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN13AddableFriendC1EOS_(
     class AddableFriend* __this, class AddableFriend* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -117,11 +102,6 @@ extern "C" void __rust_thunk___ZplRK13AddableFriendS1_(
 static_assert(sizeof(class AddableFreeByConstRef) == 1);
 static_assert(alignof(class AddableFreeByConstRef) == 1);
 
-extern "C" void __rust_thunk___ZN21AddableFreeByConstRefC1Ev(
-    class AddableFreeByConstRef* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN21AddableFreeByConstRefC1EOS_(
     class AddableFreeByConstRef* __this,
     class AddableFreeByConstRef* __param_0) {
@@ -145,11 +125,6 @@ __rust_thunk___ZN21AddableFreeByConstRefaSEOS_(
 static_assert(sizeof(class AddableFreeByMutRef) == 1);
 static_assert(alignof(class AddableFreeByMutRef) == 1);
 
-extern "C" void __rust_thunk___ZN19AddableFreeByMutRefC1Ev(
-    class AddableFreeByMutRef* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN19AddableFreeByMutRefC1EOS_(
     class AddableFreeByMutRef* __this, class AddableFreeByMutRef* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -171,11 +146,6 @@ __rust_thunk___ZN19AddableFreeByMutRefaSEOS_(
 static_assert(sizeof(class AddableFreeByValue) == 1);
 static_assert(alignof(class AddableFreeByValue) == 1);
 
-extern "C" void __rust_thunk___ZN18AddableFreeByValueC1Ev(
-    class AddableFreeByValue* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN18AddableFreeByValueC1EOS_(
     class AddableFreeByValue* __this, class AddableFreeByValue* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -197,11 +167,6 @@ __rust_thunk___ZN18AddableFreeByValueaSEOS_(
 static_assert(sizeof(class AddableFreeByRValueRef) == 1);
 static_assert(alignof(class AddableFreeByRValueRef) == 1);
 
-extern "C" void __rust_thunk___ZN22AddableFreeByRValueRefC1Ev(
-    class AddableFreeByRValueRef* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN22AddableFreeByRValueRefC1EOS_(
     class AddableFreeByRValueRef* __this,
     class AddableFreeByRValueRef* __param_0) {
@@ -244,10 +209,6 @@ extern "C" void __rust_thunk___Zpl18AddableFreeByValueS_(
 static_assert(sizeof(class Overloaded) == 1);
 static_assert(alignof(class Overloaded) == 1);
 
-extern "C" void __rust_thunk___ZN10OverloadedC1Ev(class Overloaded* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN10OverloadedC1EOS_(
     class Overloaded* __this, class Overloaded* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -266,11 +227,6 @@ extern "C" class Overloaded* __rust_thunk___ZN10OverloadedaSEOS_(
 static_assert(sizeof(class IncompatibleLHS) == 1);
 static_assert(alignof(class IncompatibleLHS) == 1);
 
-extern "C" void __rust_thunk___ZN15IncompatibleLHSC1Ev(
-    class IncompatibleLHS* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN15IncompatibleLHSC1EOS_(
     class IncompatibleLHS* __this, class IncompatibleLHS* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -289,11 +245,6 @@ extern "C" class IncompatibleLHS* __rust_thunk___ZN15IncompatibleLHSaSEOS_(
 static_assert(CRUBIT_SIZEOF(class AddableReturnsVoid) == 4);
 static_assert(alignof(class AddableReturnsVoid) == 4);
 
-extern "C" void __rust_thunk___ZN18AddableReturnsVoidC1Ev(
-    class AddableReturnsVoid* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN18AddableReturnsVoidC1EOS_(
     class AddableReturnsVoid* __this, class AddableReturnsVoid* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -348,11 +299,6 @@ extern "C" void __rust_thunk___ZN26AddableConstMemberNonunpinD1Ev(
 static_assert(sizeof(struct AddAssignMemberInt) == 1);
 static_assert(alignof(struct AddAssignMemberInt) == 1);
 
-extern "C" void __rust_thunk___ZN18AddAssignMemberIntC1Ev(
-    struct AddAssignMemberInt* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN18AddAssignMemberIntC1EOS_(
     struct AddAssignMemberInt* __this, struct AddAssignMemberInt* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -374,11 +320,6 @@ __rust_thunk___ZN18AddAssignMemberIntaSEOS_(
 static_assert(sizeof(struct AddAssignMemberByConstRef) == 1);
 static_assert(alignof(struct AddAssignMemberByConstRef) == 1);
 
-extern "C" void __rust_thunk___ZN25AddAssignMemberByConstRefC1Ev(
-    struct AddAssignMemberByConstRef* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN25AddAssignMemberByConstRefC1EOS_(
     struct AddAssignMemberByConstRef* __this,
     struct AddAssignMemberByConstRef* __param_0) {
@@ -402,11 +343,6 @@ __rust_thunk___ZN25AddAssignMemberByConstRefaSEOS_(
 static_assert(sizeof(struct AddAssignFreeByConstRef) == 1);
 static_assert(alignof(struct AddAssignFreeByConstRef) == 1);
 
-extern "C" void __rust_thunk___ZN23AddAssignFreeByConstRefC1Ev(
-    struct AddAssignFreeByConstRef* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN23AddAssignFreeByConstRefC1EOS_(
     struct AddAssignFreeByConstRef* __this,
     struct AddAssignFreeByConstRef* __param_0) {
@@ -430,11 +366,6 @@ __rust_thunk___ZN23AddAssignFreeByConstRefaSEOS_(
 static_assert(sizeof(struct AddAssignFreeByValue) == 1);
 static_assert(alignof(struct AddAssignFreeByValue) == 1);
 
-extern "C" void __rust_thunk___ZN20AddAssignFreeByValueC1Ev(
-    struct AddAssignFreeByValue* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN20AddAssignFreeByValueC1EOS_(
     struct AddAssignFreeByValue* __this,
     struct AddAssignFreeByValue* __param_0) {
@@ -464,11 +395,6 @@ __rust_thunk___ZpLR20AddAssignFreeByValueS_(struct AddAssignFreeByValue* lhs,
 static_assert(sizeof(struct AddAssignFriendByConstRef) == 1);
 static_assert(alignof(struct AddAssignFriendByConstRef) == 1);
 
-extern "C" void __rust_thunk___ZN25AddAssignFriendByConstRefC1Ev(
-    struct AddAssignFriendByConstRef* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN25AddAssignFriendByConstRefC1EOS_(
     struct AddAssignFriendByConstRef* __this,
     struct AddAssignFriendByConstRef* __param_0) {
@@ -492,11 +418,6 @@ __rust_thunk___ZN25AddAssignFriendByConstRefaSEOS_(
 static_assert(sizeof(struct AddAssignFriendByValue) == 1);
 static_assert(alignof(struct AddAssignFriendByValue) == 1);
 
-extern "C" void __rust_thunk___ZN22AddAssignFriendByValueC1Ev(
-    struct AddAssignFriendByValue* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN22AddAssignFriendByValueC1EOS_(
     struct AddAssignFriendByValue* __this,
     struct AddAssignFriendByValue* __param_0) {
@@ -526,11 +447,6 @@ __rust_thunk___ZpLR22AddAssignFriendByValueS_(
 static_assert(sizeof(struct AddAssignProhibitedConstMember) == 1);
 static_assert(alignof(struct AddAssignProhibitedConstMember) == 1);
 
-extern "C" void __rust_thunk___ZN30AddAssignProhibitedConstMemberC1Ev(
-    struct AddAssignProhibitedConstMember* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN30AddAssignProhibitedConstMemberC1EOS_(
     struct AddAssignProhibitedConstMember* __this,
     struct AddAssignProhibitedConstMember* __param_0) {
@@ -554,11 +470,6 @@ __rust_thunk___ZN30AddAssignProhibitedConstMemberaSEOS_(
 static_assert(sizeof(struct AddAssignProhibitedFriendConstLhs) == 1);
 static_assert(alignof(struct AddAssignProhibitedFriendConstLhs) == 1);
 
-extern "C" void __rust_thunk___ZN33AddAssignProhibitedFriendConstLhsC1Ev(
-    struct AddAssignProhibitedFriendConstLhs* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN33AddAssignProhibitedFriendConstLhsC1EOS_(
     struct AddAssignProhibitedFriendConstLhs* __this,
     struct AddAssignProhibitedFriendConstLhs* __param_0) {
@@ -582,11 +493,6 @@ __rust_thunk___ZN33AddAssignProhibitedFriendConstLhsaSEOS_(
 static_assert(sizeof(struct ManyOperators) == 1);
 static_assert(alignof(struct ManyOperators) == 1);
 
-extern "C" void __rust_thunk___ZN13ManyOperatorsC1Ev(
-    struct ManyOperators* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN13ManyOperatorsC1EOS_(
     struct ManyOperators* __this, struct ManyOperators* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
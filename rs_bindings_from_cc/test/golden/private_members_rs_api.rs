@@ -38,11 +38,7 @@ pub mod test_namespace_bindings {
     impl Default for SomeClass {
         #[inline(always)]
         fn default() -> Self {
-            let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-            unsafe {
-                crate::detail::__rust_thunk___ZN23test_namespace_bindings9SomeClassC1Ev(&mut tmp);
-                tmp.assume_init()
-            }
+            unsafe { ::core::mem::zeroed() }
         }
     }
 
@@ -110,9 +106,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN23test_namespace_bindings9SomeClassC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::test_namespace_bindings::SomeClass>,
-        );
         pub(crate) fn __rust_thunk___ZN23test_namespace_bindings9SomeClassC1EOS0_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::test_namespace_bindings::SomeClass>,
             __param_0: ::ctor::RvalueReference<'b, crate::test_namespace_bindings::SomeClass>,
@@ -24,11 +24,6 @@ static_assert(alignof(class test_namespace_bindings::SomeClass) == 4);
 static_assert(CRUBIT_OFFSET_OF(public_member_variable_,
                                class test_namespace_bindings::SomeClass) == 0);
 
-extern "C" void __rust_thunk___ZN23test_namespace_bindings9SomeClassC1Ev(
-    class test_namespace_bindings::SomeClass* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN23test_namespace_bindings9SomeClassC1EOS0_(
     class test_namespace_bindings::SomeClass* __this,
     class test_namespace_bindings::SomeClass* __param_0) {
@@ -35,11 +35,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("DifferentScope"), crat
 impl Default for DifferentScope {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN14DifferentScopeC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -1006,9 +1002,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN14DifferentScopeC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::DifferentScope>,
-        );
         pub(crate) fn __rust_thunk___ZN14DifferentScopeC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::DifferentScope>,
             __param_0: ::ctor::RvalueReference<'b, crate::DifferentScope>,
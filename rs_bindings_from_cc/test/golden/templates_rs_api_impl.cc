@@ -22,11 +22,6 @@
 static_assert(sizeof(struct DifferentScope) == 1);
 static_assert(alignof(struct DifferentScope) == 1);
 
-extern "C" void __rust_thunk___ZN14DifferentScopeC1Ev(
-    struct DifferentScope* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN14DifferentScopeC1EOS_(
     struct DifferentScope* __this, struct DifferentScope* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
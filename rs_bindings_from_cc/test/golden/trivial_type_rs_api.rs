@@ -39,11 +39,7 @@ pub mod ns {
     impl Default for Trivial {
         #[inline(always)]
         fn default() -> Self {
-            let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-            unsafe {
-                crate::detail::__rust_thunk___ZN2ns7TrivialC1Ev(&mut tmp);
-                tmp.assume_init()
-            }
+            unsafe { ::core::mem::zeroed() }
         }
     }
 
@@ -326,9 +322,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN2ns7TrivialC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::ns::Trivial>,
-        );
         pub(crate) fn __rust_thunk___ZN2ns7TrivialC1EOS0_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::ns::Trivial>,
             __param_0: ::ctor::RvalueReference<'b, crate::ns::Trivial>,
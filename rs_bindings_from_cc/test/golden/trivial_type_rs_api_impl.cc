@@ -23,10 +23,6 @@ static_assert(CRUBIT_SIZEOF(struct ns::Trivial) == 4);
 static_assert(alignof(struct ns::Trivial) == 4);
 static_assert(CRUBIT_OFFSET_OF(trivial_field, struct ns::Trivial) == 0);
 
-extern "C" void __rust_thunk___ZN2ns7TrivialC1Ev(struct ns::Trivial* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN2ns7TrivialC1EOS0_(
     struct ns::Trivial* __this, struct ns::Trivial* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -238,11 +238,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("SomeUnion"), crate::So
 impl Default for SomeUnion {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN9SomeUnionC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -288,11 +284,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("SomeOtherUnion"), crat
 impl Default for SomeOtherUnion {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN14SomeOtherUnionC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -374,9 +366,6 @@ mod detail {
             __this: ::core::pin::Pin<&'a mut crate::SomeOtherStruct>,
             __param_0: ::ctor::RvalueReference<'b, crate::SomeOtherStruct>,
         ) -> ::core::pin::Pin<&'a mut crate::SomeOtherStruct>;
-        pub(crate) fn __rust_thunk___ZN9SomeUnionC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::SomeUnion>,
-        );
         pub(crate) fn __rust_thunk___ZN9SomeUnionC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::SomeUnion>,
             __param_0: ::ctor::RvalueReference<'b, crate::SomeUnion>,
@@ -389,9 +378,6 @@ mod detail {
             __this: &'a mut crate::SomeUnion,
             __param_0: ::ctor::RvalueReference<'b, crate::SomeUnion>,
         ) -> &'a mut crate::SomeUnion;
-        pub(crate) fn __rust_thunk___ZN14SomeOtherUnionC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::SomeOtherUnion>,
-        );
         pub(crate) fn __rust_thunk___ZN14SomeOtherUnionC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::SomeOtherUnion>,
             __param_0: ::ctor::RvalueReference<'b, crate::SomeOtherUnion>,
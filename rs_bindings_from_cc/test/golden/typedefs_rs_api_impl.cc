@@ -77,10 +77,6 @@ extern "C" SomeOtherStruct* __rust_thunk___ZN15SomeOtherStructaSEOS_(
 static_assert(sizeof(union SomeUnion) == 1);
 static_assert(alignof(union SomeUnion) == 1);
 
-extern "C" void __rust_thunk___ZN9SomeUnionC1Ev(union SomeUnion* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN9SomeUnionC1EOS_(union SomeUnion* __this,
                                                   union SomeUnion* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -99,10 +95,6 @@ extern "C" union SomeUnion* __rust_thunk___ZN9SomeUnionaSEOS_(
 static_assert(sizeof(SomeOtherUnion) == 1);
 static_assert(alignof(SomeOtherUnion) == 1);
 
-extern "C" void __rust_thunk___ZN14SomeOtherUnionC1Ev(SomeOtherUnion* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN14SomeOtherUnionC1EOS_(
     SomeOtherUnion* __this, SomeOtherUnion* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
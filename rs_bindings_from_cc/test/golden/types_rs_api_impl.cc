@@ -22,10 +22,6 @@
 static_assert(sizeof(struct SomeStruct) == 1);
 static_assert(alignof(struct SomeStruct) == 1);
 
-extern "C" void __rust_thunk___ZN10SomeStructC1Ev(struct SomeStruct* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN10SomeStructC1EOS_(
     struct SomeStruct* __this, struct SomeStruct* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -35,11 +35,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("EmptyUnion"), crate::E
 impl Default for EmptyUnion {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN10EmptyUnionC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -187,11 +183,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("NonEmptyUnion"), crate
 impl Default for NonEmptyUnion {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN13NonEmptyUnionC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -283,11 +275,7 @@ forward_declare::unsafe_define!(
 impl Default for UnionWithOpaqueField {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN20UnionWithOpaqueFieldC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -530,11 +518,7 @@ forward_declare::unsafe_define!(forward_declare::symbol!("TypedefUnion"), crate:
 impl Default for TypedefUnion {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN12TypedefUnionC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -673,9 +657,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN10EmptyUnionC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::EmptyUnion>,
-        );
         pub(crate) fn __rust_thunk___ZN10EmptyUnionC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::EmptyUnion>,
             __param_0: ::ctor::RvalueReference<'b, crate::EmptyUnion>,
@@ -716,9 +697,6 @@ mod detail {
         pub(crate) fn __rust_thunk___ZN44TriviallyCopyableButNontriviallyDestructibleD1Ev<'a>(
             __this: ::core::pin::Pin<&'a mut crate::TriviallyCopyableButNontriviallyDestructible>,
         );
-        pub(crate) fn __rust_thunk___ZN13NonEmptyUnionC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::NonEmptyUnion>,
-        );
         pub(crate) fn __rust_thunk___ZN13NonEmptyUnionC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::NonEmptyUnion>,
             __param_0: ::ctor::RvalueReference<'b, crate::NonEmptyUnion>,
@@ -739,9 +717,6 @@ mod detail {
             __this: ::core::pin::Pin<&'a mut crate::NonCopyUnion2>,
             __param_0: ::ctor::RvalueReference<'b, crate::NonCopyUnion2>,
         ) -> ::core::pin::Pin<&'a mut crate::NonCopyUnion2>;
-        pub(crate) fn __rust_thunk___ZN20UnionWithOpaqueFieldC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::UnionWithOpaqueField>,
-        );
         pub(crate) fn __rust_thunk___ZN20UnionWithOpaqueFieldC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::UnionWithOpaqueField>,
             __param_0: ::ctor::RvalueReference<'b, crate::UnionWithOpaqueField>,
@@ -792,9 +767,6 @@ mod detail {
             __this: ::core::pin::Pin<&'a mut crate::UnionWithInheritable>,
             __param_0: ::ctor::RvalueReference<'b, crate::UnionWithInheritable>,
         ) -> ::core::pin::Pin<&'a mut crate::UnionWithInheritable>;
-        pub(crate) fn __rust_thunk___ZN12TypedefUnionC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::TypedefUnion>,
-        );
         pub(crate) fn __rust_thunk___ZN12TypedefUnionC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::TypedefUnion>,
             __param_0: ::ctor::RvalueReference<'b, crate::TypedefUnion>,
@@ -22,10 +22,6 @@
 static_assert(sizeof(union EmptyUnion) == 1);
 static_assert(alignof(union EmptyUnion) == 1);
 
-extern "C" void __rust_thunk___ZN10EmptyUnionC1Ev(union EmptyUnion* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN10EmptyUnionC1EOS_(
     union EmptyUnion* __this, union EmptyUnion* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -76,11 +72,6 @@ static_assert(CRUBIT_OFFSET_OF(char_field, union NonEmptyUnion) == 0);
 static_assert(CRUBIT_OFFSET_OF(int_field, union NonEmptyUnion) == 0);
 static_assert(CRUBIT_OFFSET_OF(long_long_field, union NonEmptyUnion) == 0);
 
-extern "C" void __rust_thunk___ZN13NonEmptyUnionC1Ev(
-    union NonEmptyUnion* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN13NonEmptyUnionC1EOS_(
     union NonEmptyUnion* __this, union NonEmptyUnion* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -121,11 +112,6 @@ static_assert(alignof(union UnionWithOpaqueField) == 1);
 static_assert(CRUBIT_OFFSET_OF(constant_array_field_not_yet_supported,
                                union UnionWithOpaqueField) == 0);
 
-extern "C" void __rust_thunk___ZN20UnionWithOpaqueFieldC1Ev(
-    union UnionWithOpaqueField* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN20UnionWithOpaqueFieldC1EOS_(
     union UnionWithOpaqueField* __this, union UnionWithOpaqueField* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -216,10 +202,6 @@ static_assert(sizeof(TypedefUnion) == 1);
 static_assert(alignof(TypedefUnion) == 1);
 static_assert(CRUBIT_OFFSET_OF(trivial_member, TypedefUnion) == 0);
 
-extern "C" void __rust_thunk___ZN12TypedefUnionC1Ev(TypedefUnion* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN12TypedefUnionC1EOS_(TypedefUnion* __this,
                                                       TypedefUnion* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
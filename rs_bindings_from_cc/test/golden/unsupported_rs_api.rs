@@ -38,11 +38,7 @@ forward_declare::unsafe_define!(
 impl Default for TrivialCustomType {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN17TrivialCustomTypeC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -146,11 +142,7 @@ forward_declare::unsafe_define!(
 impl Default for ContainingStruct {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN16ContainingStructC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -192,9 +184,6 @@ mod detail {
     #[allow(unused_imports)]
     use super::*;
     extern "C" {
-        pub(crate) fn __rust_thunk___ZN17TrivialCustomTypeC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::TrivialCustomType>,
-        );
         pub(crate) fn __rust_thunk___ZN17TrivialCustomTypeC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::TrivialCustomType>,
             __param_0: ::ctor::RvalueReference<'b, crate::TrivialCustomType>,
@@ -212,9 +201,6 @@ mod detail {
             __this: &'a mut ::core::mem::MaybeUninit<crate::NontrivialCustomType>,
             __param_0: ::ctor::RvalueReference<'b, crate::NontrivialCustomType>,
         );
-        pub(crate) fn __rust_thunk___ZN16ContainingStructC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::ContainingStruct>,
-        );
         pub(crate) fn __rust_thunk___ZN16ContainingStructC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::ContainingStruct>,
             __param_0: ::ctor::RvalueReference<'b, crate::ContainingStruct>,
@@ -23,11 +23,6 @@ static_assert(CRUBIT_SIZEOF(struct TrivialCustomType) == 4);
 static_assert(alignof(struct TrivialCustomType) == 4);
 static_assert(CRUBIT_OFFSET_OF(i, struct TrivialCustomType) == 0);
 
-extern "C" void __rust_thunk___ZN17TrivialCustomTypeC1Ev(
-    struct TrivialCustomType* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN17TrivialCustomTypeC1EOS_(
     struct TrivialCustomType* __this, struct TrivialCustomType* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
@@ -53,11 +48,6 @@ static_assert(sizeof(struct ContainingStruct) == 1);
 static_assert(alignof(struct ContainingStruct) == 1);
 static_assert(CRUBIT_OFFSET_OF(nested_struct, struct ContainingStruct) == 0);
 
-extern "C" void __rust_thunk___ZN16ContainingStructC1Ev(
-    struct ContainingStruct* __this) {
-  crubit::construct_at(__this);
-}
-
 extern "C" void __rust_thunk___ZN16ContainingStructC1EOS_(
     struct ContainingStruct* __this, struct ContainingStruct* __param_0) {
   crubit::construct_at(__this, std::move(*__param_0));
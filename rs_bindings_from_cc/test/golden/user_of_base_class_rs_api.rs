@@ -130,7 +130,7 @@ impl<'b> ::ctor::Assign<::ctor::RvalueReference<'b, Self>> for Derived2 {
 
 unsafe impl oops::Inherits<inheritance_cc::Base0> for crate::Derived2 {
     unsafe fn upcast_ptr(derived: *const Self) -> *const inheritance_cc::Base0 {
-        crate::detail::__crubit_dynamic_upcast__8Derived2__to__5Base0(derived)
+        (derived as *const _ as *const u8).offset(0) as *const inheritance_cc::Base0
     }
 }
 unsafe impl oops::Inherits<inheritance_cc::Base1> for crate::Derived2 {
@@ -285,9 +285,6 @@ mod detail {
             __this: ::core::pin::Pin<&'a mut crate::Derived2>,
             __param_0: ::ctor::RvalueReference<'b, crate::Derived2>,
         ) -> ::core::pin::Pin<&'a mut crate::Derived2>;
-        pub fn __crubit_dynamic_upcast__8Derived2__to__5Base0(
-            from: *const crate::Derived2,
-        ) -> *const inheritance_cc::Base0;
         pub(crate) fn __rust_thunk___ZN15VirtualDerived2C1Ev<'a>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::VirtualDerived2>,
         );
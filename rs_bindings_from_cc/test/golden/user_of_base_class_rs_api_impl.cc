@@ -47,11 +47,6 @@ extern "C" struct Derived2* __rust_thunk___ZN8Derived2aSEOS_(
   return &__this->operator=(std::move(*__param_0));
 }
 
-extern "C" const class Base0& __crubit_dynamic_upcast__8Derived2__to__5Base0(
-    const struct Derived2& from) {
-  return from;
-}
-
 static_assert(CRUBIT_SIZEOF(class VirtualDerived2) == 32);
 static_assert(alignof(class VirtualDerived2) == 8);
 
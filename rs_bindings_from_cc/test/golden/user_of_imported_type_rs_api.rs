@@ -42,11 +42,7 @@ forward_declare::unsafe_define!(
 impl Default for UserOfImportedType {
     #[inline(always)]
     fn default() -> Self {
-        let mut tmp = ::core::mem::MaybeUninit::<Self>::zeroed();
-        unsafe {
-            crate::detail::__rust_thunk___ZN18UserOfImportedTypeC1Ev(&mut tmp);
-            tmp.assume_init()
-        }
+        unsafe { ::core::mem::zeroed() }
     }
 }
 
@@ -89,9 +85,6 @@ mod detail {
             __return: &mut ::core::mem::MaybeUninit<trivial_type_cc::ns::Trivial>,
             t: &mut trivial_type_cc::ns::Trivial,
         );
-        pub(crate) fn __rust_thunk___ZN18UserOfImportedTypeC1Ev<'a>(
-            __this: &'a mut ::core::mem::MaybeUninit<crate::UserOfImportedType>,
-        );
         pub(crate) fn __rust_thunk___ZN18UserOfImportedTypeC1EOS_<'a, 'b>(
             __this: &'a mut ::core::mem::MaybeUninit<crate::UserOfImportedType>,
             __param_0: ::ctor::RvalueReference<'b, crate::UserOfImportedType>,
@@ -296,4 +296,53 @@ EOT
     "Verify #include paths are based on the argument of --crubit_support_path"
 }
 
+# Remote caching needs the outputs to be the same byte-for-byte on every run.
+# Each run is a separate process, which gets a different address space layout
+# and different seeds for the `absl` and Rust hash maps.
+function test::output_is_deterministic() {
+  local hdr="${TEST_TMPDIR}/deterministic.h"
+  cat >"${hdr}" <<EOF
+namespace ns {
+struct S { int field; };
+struct T { S s; };
+int F(S s, T t);
+template <typename U> struct Template { U value; };
+using TemplateAlias = Template<int>;
+}  // namespace ns
+enum E { kA, kB };
+EOF
+  local extra_rs_src="${TEST_TMPDIR}/extra.rs"
+  echo "pub fn extra() {}" > "${extra_rs_src}"
+
+  local json
+  json="$(cat <<-EOT
+  [{"t": "//foo/bar:baz", "h": ["${hdr}"], "f": ["experimental", "supported"]}]
+EOT
+)"
+
+  local run
+  for run in 1 2; do
+    EXPECT_SUCCEED \
+      "\"${RS_BINDINGS_FROM_CC}\" \
+        --target=//foo/bar:baz \
+        --rs_out=\"${TEST_TMPDIR}/${run}_rs_api.rs\" \
+        --cc_out=\"${TEST_TMPDIR}/${run}_rs_api_impl.cc\" \
+        --ir_out=\"${TEST_TMPDIR}/${run}_ir.json\" \
+        --crubit_support_path=test/crubit/support/path \
+        --clang_format_exe_path=\"${DEFAULT_CLANG_FORMAT_EXE_PATH}\" \
+        --rustfmt_exe_path=\"${DEFAULT_RUSTFMT_EXE_PATH}\" \
+        --public_headers=\"${hdr}\" \
+        --extra_rs_srcs=\"${extra_rs_src}\" \
+        --target_args=\"$(echo "${json}" | quote_escape)\""
+  done
+
+  local out
+  for out in rs_api.rs rs_api_impl.cc ir.json; do
+    EXPECT_FILE_NOT_EMPTY "${TEST_TMPDIR}/1_${out}"
+    EXPECT_SUCCEED \
+      "cmp \"${TEST_TMPDIR}/1_${out}\" \"${TEST_TMPDIR}/2_${out}\"" \
+      "${out} should be the same on every run"
+  done
+}
+
 gbash::unit::main "$@"
@@ -0,0 +1,98 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/timing_report.h"
+
+#include <sys/resource.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+#include "absl/strings/string_view.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/FormatVariadic.h"
+#include "llvm/Support/JSON.h"
+
+namespace crubit {
+
+namespace {
+
+struct ResourceUsage {
+  absl::Duration cpu;
+  int64_t peak_rss_bytes;
+};
+
+ResourceUsage GetResourceUsage() {
+  struct rusage usage = {};
+  getrusage(RUSAGE_SELF, &usage);
+  return {
+      .cpu = absl::DurationFromTimeval(usage.ru_utime) +
+             absl::DurationFromTimeval(usage.ru_stime),
+#ifdef __APPLE__
+      .peak_rss_bytes = static_cast<int64_t>(usage.ru_maxrss),
+#else
+      // Linux reports kilobytes.
+      .peak_rss_bytes = static_cast<int64_t>(usage.ru_maxrss) * 1024,
+#endif
+  };
+}
+
+}  // namespace
+
+int64_t PeakRssBytes() { return GetResourceUsage().peak_rss_bytes; }
+
+TimingReport::Phase::Phase(TimingReport* report, absl::string_view name)
+    : report_(report) {
+  if (report_ == nullptr) return;
+  name_ = std::string(name);
+  report_->active_phases_.push_back(this);
+  cpu_start_ = GetResourceUsage().cpu;
+  wall_start_ = absl::Now();
+}
+
+TimingReport::Phase::~Phase() {
+  if (report_ == nullptr) return;
+  absl::Duration wall = absl::Now() - wall_start_;
+  ResourceUsage usage = GetResourceUsage();
+  absl::Duration cpu = usage.cpu - cpu_start_;
+
+  report_->active_phases_.pop_back();
+  if (!report_->active_phases_.empty()) {
+    Phase& parent = *report_->active_phases_.back();
+    parent.nested_wall_ += wall;
+    parent.nested_cpu_ += cpu;
+  }
+
+  PhaseStats& stats = report_->phases_[name_];
+  ++stats.count;
+  stats.wall += wall - nested_wall_;
+  stats.cpu += cpu - nested_cpu_;
+  stats.peak_rss_bytes = std::max(stats.peak_rss_bytes, usage.peak_rss_bytes);
+}
+
+void TimingReport::Add(absl::string_view key, llvm::json::Value value) {
+  added_[llvm::StringRef(key.data(), key.size())] = std::move(value);
+}
+
+std::string TimingReport::ToJson() const {
+  llvm::json::Object phases;
+  for (const auto& [name, stats] : phases_) {
+    phases[name] = llvm::json::Object{
+        {"count", stats.count},
+        {"wall_seconds", absl::ToDoubleSeconds(stats.wall)},
+        {"cpu_seconds", absl::ToDoubleSeconds(stats.cpu)},
+        {"peak_rss_bytes", stats.peak_rss_bytes},
+    };
+  }
+  llvm::json::Object report = added_;
+  report["phases"] = std::move(phases);
+  report["peak_rss_bytes"] = PeakRssBytes();
+  return llvm::formatv("{0:2}", llvm::json::Value(std::move(report))).str();
+}
+
+}  // namespace crubit
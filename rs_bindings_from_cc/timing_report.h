@@ -0,0 +1,89 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_RS_BINDINGS_FROM_CC_TIMING_REPORT_H_
+#define CRUBIT_RS_BINDINGS_FROM_CC_TIMING_REPORT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/strings/string_view.h"
+#include "absl/time/time.h"
+#include "llvm/Support/JSON.h"
+
+namespace crubit {
+
+// Collects the wall time, CPU time and peak memory use of the phases of a
+// bindings generation, as written to `--timing_report_out`.
+//
+// Phases can be nested. The time of a phase excludes the time of the phases
+// nested in it, so that the times of all phases add up to the total. CPU time
+// and peak memory use are those of the whole process, including any threads
+// running while the phase is measured.
+//
+// Not thread-safe.
+class TimingReport {
+ public:
+  // Measures the phase `name` from construction to destruction. Does nothing
+  // if `report` is null.
+  class Phase {
+   public:
+    Phase(TimingReport* report, absl::string_view name);
+    ~Phase();
+
+    Phase(const Phase&) = delete;
+    Phase& operator=(const Phase&) = delete;
+
+   private:
+    TimingReport* report_;
+    std::string name_;
+    absl::Time wall_start_;
+    absl::Duration cpu_start_;
+    absl::Duration nested_wall_;
+    absl::Duration nested_cpu_;
+  };
+
+  // Adds `value` to the report under `key`, e.g. measurements taken in Rust.
+  void Add(absl::string_view key, llvm::json::Value value);
+
+  // Returns the report as JSON:
+  //
+  // {
+  //   "phases": {
+  //     "<phase>": {
+  //       "count": <number of times the phase ran>,
+  //       "wall_seconds": <total wall time>,
+  //       "cpu_seconds": <total CPU time>,
+  //       "peak_rss_bytes": <peak RSS of the process when the phase ended>
+  //     },
+  //     ...
+  //   },
+  //   "peak_rss_bytes": <peak RSS of the process so far>,
+  //   "<key>": <value passed to `Add`>,
+  //   ...
+  // }
+  std::string ToJson() const;
+
+ private:
+  struct PhaseStats {
+    int64_t count = 0;
+    absl::Duration wall;
+    absl::Duration cpu;
+    int64_t peak_rss_bytes = 0;
+  };
+
+  absl::flat_hash_map<std::string, PhaseStats> phases_;
+  // The phases being measured, innermost last.
+  std::vector<Phase*> active_phases_;
+  llvm::json::Object added_;
+};
+
+// Returns the peak resident set size of the process so far, in bytes.
+int64_t PeakRssBytes();
+
+}  // namespace crubit
+
+#endif  // CRUBIT_RS_BINDINGS_FROM_CC_TIMING_REPORT_H_
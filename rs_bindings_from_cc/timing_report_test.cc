@@ -0,0 +1,92 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "rs_bindings_from_cc/timing_report.h"
+
+#include <utility>
+
+#include "gmock/gmock.h"
+#include "gtest/gtest.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "llvm/Support/Error.h"
+#include "llvm/Support/JSON.h"
+
+namespace crubit {
+namespace {
+
+using ::testing::DoubleNear;
+using ::testing::Ge;
+using ::testing::Lt;
+using ::testing::Optional;
+
+llvm::json::Object ParseReport(const TimingReport& report) {
+  llvm::Expected<llvm::json::Value> json = llvm::json::parse(report.ToJson());
+  if (!json) {
+    ADD_FAILURE() << llvm::toString(json.takeError());
+    return {};
+  }
+  if (json->getAsObject() == nullptr) {
+    ADD_FAILURE() << "The report is not a JSON object";
+    return {};
+  }
+  return std::move(*json->getAsObject());
+}
+
+TEST(TimingReportTest, NestedPhasesExcludeEachOther) {
+  TimingReport report;
+  {
+    TimingReport::Phase outer(&report, "outer");
+    absl::SleepFor(absl::Milliseconds(10));
+    for (int i = 0; i < 2; ++i) {
+      TimingReport::Phase inner(&report, "inner");
+      absl::SleepFor(absl::Milliseconds(100));
+    }
+  }
+
+  llvm::json::Object json = ParseReport(report);
+  const llvm::json::Object* phases = json.getObject("phases");
+  ASSERT_NE(phases, nullptr);
+  const llvm::json::Object* outer = phases->getObject("outer");
+  const llvm::json::Object* inner = phases->getObject("inner");
+  ASSERT_NE(outer, nullptr);
+  ASSERT_NE(inner, nullptr);
+  EXPECT_THAT(outer->getInteger("count"), Optional(1));
+  EXPECT_THAT(inner->getInteger("count"), Optional(2));
+  EXPECT_THAT(inner->getNumber("wall_seconds"), Optional(Ge(0.2)));
+  // The time spent in `inner` is only counted once.
+  EXPECT_THAT(outer->getNumber("wall_seconds"), Optional(Ge(0.01)));
+  EXPECT_THAT(outer->getNumber("wall_seconds"), Optional(Lt(0.2)));
+}
+
+TEST(TimingReportTest, JsonShape) {
+  TimingReport report;
+  { TimingReport::Phase phase(&report, "phase"); }
+  report.Add("rust", llvm::json::Object{{"codegen_seconds", 1.5}});
+
+  llvm::json::Object json = ParseReport(report);
+  EXPECT_THAT(json.getInteger("peak_rss_bytes"), Optional(Ge(1)));
+  const llvm::json::Object* rust = json.getObject("rust");
+  ASSERT_NE(rust, nullptr);
+  EXPECT_THAT(rust->getNumber("codegen_seconds"),
+              Optional(DoubleNear(1.5, 1e-9)));
+
+  const llvm::json::Object* phases = json.getObject("phases");
+  ASSERT_NE(phases, nullptr);
+  EXPECT_EQ(phases->size(), 1u);
+  const llvm::json::Object* phase = phases->getObject("phase");
+  ASSERT_NE(phase, nullptr);
+  EXPECT_EQ(phase->size(), 4u);
+  EXPECT_THAT(phase->getInteger("count"), Optional(1));
+  EXPECT_THAT(phase->getNumber("wall_seconds"), Optional(Ge(0)));
+  EXPECT_THAT(phase->getNumber("cpu_seconds"), Optional(Ge(0)));
+  EXPECT_THAT(phase->getInteger("peak_rss_bytes"), Optional(Ge(1)));
+}
+
+TEST(TimingReportTest, PhaseWithoutReportDoesNothing) {
+  TimingReport::Phase phase(nullptr, "phase");
+}
+
+}  // namespace
+}  // namespace crubit
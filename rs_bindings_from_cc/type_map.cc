@@ -4,22 +4,41 @@
 
 #include "rs_bindings_from_cc/type_map.h"
 
+#include <cstdint>
 #include <optional>
 #include <string>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/flat_hash_set.h"
 #include "absl/strings/string_view.h"
+#include "absl/strings/strip.h"
 #include "rs_bindings_from_cc/ir.h"
+#include "clang/AST/ASTContext.h"
+#include "clang/AST/Decl.h"
+#include "clang/AST/DeclBase.h"
+#include "clang/AST/DeclCXX.h"
+#include "clang/AST/DeclTemplate.h"
+#include "clang/AST/RecordLayout.h"
+#include "clang/AST/TemplateBase.h"
 #include "clang/AST/Type.h"
+#include "clang/Basic/TargetInfo.h"
+#include "clang/Lex/Preprocessor.h"
+#include "clang/Sema/Sema.h"
+#include "llvm/ADT/StringRef.h"
+#include "llvm/Support/Casting.h"
+#include "llvm/Support/MathExtras.h"
 
 namespace crubit {
 
 namespace {
+
+using WellKnownTypeMap =
+    absl::flat_hash_map<absl::string_view, absl::string_view>;
+
 // A mapping of C++ standard types to their equivalent Rust types.
-std::optional<absl::string_view> MapKnownCcTypeToRsType(
-    absl::string_view cc_type) {
-  static const auto* const kWellKnownTypes =
-      new absl::flat_hash_map<absl::string_view, absl::string_view>({
+const WellKnownTypeMap& WellKnownTypes() {
+  static const auto* const kWellKnownTypes = new WellKnownTypeMap({
           // TODO(lukasza): Try to deduplicate the entries below - for example:
           // - Try to unify `std::int32_t` and `int32_t`
           // One approach would be to desugar the types before calling
@@ -58,14 +77,138 @@ std::optional<absl::string_view> MapKnownCcTypeToRsType(
           {"char16_t", "u16"},
           {"char32_t", "u32"},
       });
-  auto it = kWellKnownTypes->find(cc_type);
-  if (it == kWellKnownTypes->end()) return std::nullopt;
+  return *kWellKnownTypes;
+}
+
+std::optional<absl::string_view> MapKnownCcTypeToRsType(
+    absl::string_view cc_type) {
+  auto it = WellKnownTypes().find(cc_type);
+  if (it == WellKnownTypes().end()) return std::nullopt;
   return it->second;
 }
 
+// Returns false if `cc_type` certainly doesn't print as one of the
+// `WellKnownTypes()`, without printing it.
+//
+// Apart from `char16_t` and `char32_t`, the well-known types are all typedefs,
+// so only typedef types (possibly behind sugar which prints as the typedef's
+// name, e.g. `std::` qualification) can match.
+bool MayBeWellKnownType(const clang::Type& cc_type) {
+  static const auto* const kTypedefNames = [] {
+    auto* names = new absl::flat_hash_set<absl::string_view>();
+    for (const auto& [cc_name, rs_name] : WellKnownTypes()) {
+      names->insert(absl::StripPrefix(cc_name, "std::"));
+    }
+    return names;
+  }();
+
+  const clang::Type* type = &cc_type;
+  while (true) {
+    if (const auto* builtin = llvm::dyn_cast<clang::BuiltinType>(type)) {
+      return builtin->getKind() == clang::BuiltinType::Char16 ||
+             builtin->getKind() == clang::BuiltinType::Char32;
+    } else if (const auto* typedef_type =
+                   llvm::dyn_cast<clang::TypedefType>(type)) {
+      const clang::IdentifierInfo* identifier =
+          typedef_type->getDecl()->getIdentifier();
+      return identifier != nullptr &&
+             kTypedefNames->contains(identifier->getName());
+    } else if (const auto* elaborated =
+                   llvm::dyn_cast<clang::ElaboratedType>(type)) {
+      type = elaborated->getNamedType().getTypePtr();
+    } else if (const auto* using_type =
+                   llvm::dyn_cast<clang::UsingType>(type)) {
+      type = using_type->getUnderlyingType().getTypePtr();
+    } else if (const auto* subst =
+                   llvm::dyn_cast<clang::SubstTemplateTypeParmType>(type)) {
+      type = subst->getReplacementType().getTypePtr();
+    } else {
+      return false;
+    }
+  }
+}
+
+// Returns true if `decl` is declared in the top-level namespace `name` (looking
+// through inline namespaces, such as libc++'s `std::__u`).
+bool IsInTopLevelNamespace(const clang::Decl& decl, llvm::StringRef name) {
+  const clang::DeclContext* context = decl.getDeclContext();
+  while (context->isInlineNamespace()) context = context->getParent();
+  const auto* namespace_decl = llvm::dyn_cast<clang::NamespaceDecl>(context);
+  return namespace_decl != nullptr && namespace_decl->getName() == name &&
+         namespace_decl->getParent()->getRedeclContext()->isTranslationUnit();
+}
+
+// Returns the class template specialization named by `cc_type`, if any.
+//
+// Type aliases of specializations are mapped the same way as the
+// specializations themselves (and imported as aliases of the mapped type).
+const clang::ClassTemplateSpecializationDecl* GetNamedSpecialization(
+    const clang::Type& cc_type) {
+  const clang::Type* type = &cc_type;
+  if (const auto* elaborated = llvm::dyn_cast<clang::ElaboratedType>(type)) {
+    type = elaborated->getNamedType().getTypePtr();
+  }
+  if (!llvm::isa<clang::TemplateSpecializationType, clang::RecordType>(type)) {
+    return nullptr;
+  }
+  const auto* specialization =
+      llvm::dyn_cast_or_null<clang::ClassTemplateSpecializationDecl>(
+          type->getAsCXXRecordDecl());
+  if (specialization == nullptr || specialization->getIdentifier() == nullptr) {
+    return nullptr;
+  }
+  const clang::TemplateArgumentList& args = specialization->getTemplateArgs();
+  if (args.size() == 0 || args[0].getKind() != clang::TemplateArgument::Type) {
+    return nullptr;
+  }
+  return specialization;
+}
+
+// Returns true if `arg` is the type `std::name<char>`, e.g.
+// `std::char_traits<char>`.
+bool IsStdSpecializationOfChar(const clang::TemplateArgument& arg,
+                               llvm::StringRef name) {
+  if (arg.getKind() != clang::TemplateArgument::Type) return false;
+  const clang::ClassTemplateSpecializationDecl* specialization =
+      GetNamedSpecialization(*arg.getAsType());
+  if (specialization == nullptr || specialization->getName() != name ||
+      !IsInTopLevelNamespace(*specialization, "std")) {
+    return false;
+  }
+  const clang::ASTContext& ctx = specialization->getASTContext();
+  return ctx.hasSameType(specialization->getTemplateArgs()[0].getAsType(),
+                         ctx.CharTy);
+}
+
+// Appends the offsets (in bytes, plus `offset`) of the `bool` fields of
+// `record` and of its non-virtual bases to `offsets`. The fields of members
+// (e.g. of anonymous unions) are not included.
+void CollectBoolFieldOffsets(const clang::CXXRecordDecl& record,
+                             int64_t offset, const clang::ASTContext& ctx,
+                             std::vector<int64_t>& offsets) {
+  const clang::ASTRecordLayout& layout = ctx.getASTRecordLayout(&record);
+  for (const clang::CXXBaseSpecifier& base : record.bases()) {
+    const clang::CXXRecordDecl* base_decl =
+        base.getType()->getAsCXXRecordDecl();
+    if (base.isVirtual() || base_decl == nullptr) continue;
+    CollectBoolFieldOffsets(
+        *base_decl,
+        offset + layout.getBaseClassOffset(base_decl).getQuantity(), ctx,
+        offsets);
+  }
+  for (const clang::FieldDecl* field : record.fields()) {
+    if (!field->getType()->isBooleanType() || field->isBitField()) continue;
+    offsets.push_back(
+        offset + ctx.toCharUnitsFromBits(
+                        layout.getFieldOffset(field->getFieldIndex()))
+                     .getQuantity());
+  }
+}
+
 }  // namespace
 
 std::optional<MappedType> GetTypeMapOverride(const clang::Type& cc_type) {
+  if (!MayBeWellKnownType(cc_type)) return std::nullopt;
   std::string type_string = clang::QualType(&cc_type, 0).getAsString();
   std::optional<absl::string_view> rust_type =
       MapKnownCcTypeToRsType(type_string);
@@ -75,4 +218,239 @@ std::optional<MappedType> GetTypeMapOverride(const clang::Type& cc_type) {
   return std::nullopt;
 }
 
+std::optional<clang::QualType> GetSpanElementType(const clang::Type& cc_type) {
+  const clang::ClassTemplateSpecializationDecl* specialization =
+      GetNamedSpecialization(cc_type);
+  if (specialization == nullptr) return std::nullopt;
+  const clang::TemplateArgumentList& args = specialization->getTemplateArgs();
+  llvm::StringRef name = specialization->getName();
+  if (name == "Span" && args.size() == 1 &&
+      IsInTopLevelNamespace(*specialization, "absl")) {
+    return args[0].getAsType();
+  }
+  // `std::span<T, N>` with a static extent `N` doesn't store its size, so only
+  // `std::span<T, std::dynamic_extent>` is layout-compatible with a slice.
+  if (name == "span" && args.size() == 2 &&
+      args[1].getKind() == clang::TemplateArgument::Integral &&
+      args[1].getAsIntegral().isAllOnes() &&
+      IsInTopLevelNamespace(*specialization, "std")) {
+    return args[0].getAsType();
+  }
+  // Like spans, libc++'s string views are a data pointer followed by a size.
+  if (name == "basic_string_view" && args.size() == 2 &&
+      IsInTopLevelNamespace(*specialization, "std")) {
+    return args[0].getAsType().withConst();
+  }
+  return std::nullopt;
+}
+
+std::optional<clang::QualType> GetVectorElementType(
+    const clang::Type& cc_type) {
+  const clang::ClassTemplateSpecializationDecl* specialization =
+      GetNamedSpecialization(cc_type);
+  if (specialization == nullptr || specialization->getName() != "vector" ||
+      !IsInTopLevelNamespace(*specialization, "std")) {
+    return std::nullopt;
+  }
+  const clang::TemplateArgumentList& args = specialization->getTemplateArgs();
+  clang::QualType element_type = args[0].getAsType();
+  // `std::vector<bool>` is a packed bitset, not a contiguous array of `bool`s.
+  if (element_type->isBooleanType()) return std::nullopt;
+
+  // Only `std::allocator<T>` is known to be stateless and to allocate with
+  // the global `operator new`.
+  if (args.size() != 2 || args[1].getKind() != clang::TemplateArgument::Type) {
+    return std::nullopt;
+  }
+  const clang::ClassTemplateSpecializationDecl* allocator =
+      GetNamedSpecialization(*args[1].getAsType());
+  if (allocator == nullptr || allocator->getName() != "allocator" ||
+      !IsInTopLevelNamespace(*allocator, "std") ||
+      allocator->getTemplateArgs()[0].getAsType().getCanonicalType() !=
+          element_type.getCanonicalType()) {
+    return std::nullopt;
+  }
+  return element_type;
+}
+
+bool IsStdStringWithKnownLayout(const clang::Type& cc_type, clang::Sema& sema) {
+  // Unlike spans and vectors, aliases of `std::string` (including
+  // `std::string` itself) are mapped to `cc_std::String` directly: `cc_std`
+  // can't name `cc_std::String` in its own bindings of the aliases.
+  const auto* specialization =
+      llvm::dyn_cast_or_null<clang::ClassTemplateSpecializationDecl>(
+          cc_type.getAsCXXRecordDecl());
+  if (specialization == nullptr ||
+      specialization->getName() != "basic_string" ||
+      !IsInTopLevelNamespace(*specialization, "std")) {
+    return false;
+  }
+  const clang::ASTContext& ctx = specialization->getASTContext();
+  const clang::TemplateArgumentList& args = specialization->getTemplateArgs();
+  if (args.size() != 3 || !ctx.hasSameType(args[0].getAsType(), ctx.CharTy) ||
+      !IsStdSpecializationOfChar(args[1], "char_traits") ||
+      !IsStdSpecializationOfChar(args[2], "allocator")) {
+    return false;
+  }
+
+  // `cc_std::String` has the layout of libc++'s default ABI. The alternate
+  // layout (e.g. of libc++'s unstable ABI) stores long strings differently.
+  const clang::Preprocessor& preprocessor = sema.getPreprocessor();
+  if (!preprocessor.isMacroDefined("_LIBCPP_VERSION") ||
+      preprocessor.isMacroDefined("_LIBCPP_ABI_ALTERNATE_STRING_LAYOUT")) {
+    return false;
+  }
+  if (!ctx.getTargetInfo().isLittleEndian() ||
+      ctx.getTypeSize(ctx.VoidPtrTy) != 64) {
+    return false;
+  }
+
+  // `Sema::isCompleteType` instantiates the class template if needed.
+  clang::QualType string_type = ctx.getRecordType(specialization);
+  if (!sema.isCompleteType(specialization->getLocation(), string_type) ||
+      specialization->isInvalidDecl()) {
+    return false;
+  }
+  return ctx.getTypeSizeInChars(string_type).getQuantity() == 24 &&
+         ctx.getTypeAlignInChars(string_type).getQuantity() == 8;
+}
+
+std::optional<clang::QualType> GetUniquePtrElementType(
+    const clang::Type& cc_type, clang::Sema& sema) {
+  const clang::ClassTemplateSpecializationDecl* specialization =
+      GetNamedSpecialization(cc_type);
+  if (specialization == nullptr || specialization->getName() != "unique_ptr" ||
+      !IsInTopLevelNamespace(*specialization, "std")) {
+    return std::nullopt;
+  }
+  const clang::TemplateArgumentList& args = specialization->getTemplateArgs();
+  clang::QualType element_type = args[0].getAsType();
+  // `std::unique_ptr<T[]>` uses `delete[]`, and `const` objects can't be
+  // handed out as `&mut T`. Only builtin and class types implement
+  // `cc_std::CcDelete`.
+  if (element_type.isConstQualified() || element_type.isVolatileQualified() ||
+      !((element_type->isBuiltinType() && element_type->isArithmeticType()) ||
+        element_type->isRecordType())) {
+    return std::nullopt;
+  }
+
+  // Only `std::default_delete<T>` is known to be stateless and to `delete` the
+  // pointer.
+  if (args.size() != 2 || args[1].getKind() != clang::TemplateArgument::Type) {
+    return std::nullopt;
+  }
+  const clang::ClassTemplateSpecializationDecl* deleter =
+      GetNamedSpecialization(*args[1].getAsType());
+  if (deleter == nullptr || deleter->getName() != "default_delete" ||
+      !IsInTopLevelNamespace(*deleter, "std") ||
+      deleter->getTemplateArgs()[0].getAsType().getCanonicalType() !=
+          element_type.getCanonicalType()) {
+    return std::nullopt;
+  }
+
+  // `Sema::isCompleteType` instantiates the class template if needed.
+  clang::ASTContext& ctx = sema.getASTContext();
+  clang::QualType unique_ptr_type = ctx.getRecordType(specialization);
+  if (!sema.isCompleteType(specialization->getLocation(), unique_ptr_type) ||
+      specialization->isInvalidDecl() ||
+      ctx.getTypeSize(unique_ptr_type) != ctx.getTypeSize(ctx.VoidPtrTy) ||
+      ctx.getTypeAlign(unique_ptr_type) != ctx.getTypeAlign(ctx.VoidPtrTy)) {
+    return std::nullopt;
+  }
+  return element_type;
+}
+
+std::optional<clang::QualType> GetOptionalValueType(const clang::Type& cc_type,
+                                                    clang::Sema& sema) {
+  const clang::ClassTemplateSpecializationDecl* specialization =
+      GetNamedSpecialization(cc_type);
+  if (specialization == nullptr || specialization->getName() != "optional" ||
+      !IsInTopLevelNamespace(*specialization, "std")) {
+    return std::nullopt;
+  }
+  // `Sema::isCompleteType` instantiates the class template (and so completes
+  // `T`) if needed.
+  clang::ASTContext& ctx = sema.getASTContext();
+  clang::QualType optional_type = ctx.getRecordType(specialization);
+  if (!sema.isCompleteType(specialization->getLocation(), optional_type) ||
+      specialization->isInvalidDecl() ||
+      specialization->isDependentContext()) {
+    return std::nullopt;
+  }
+  clang::QualType value_type = specialization->getTemplateArgs()[0].getAsType();
+  if (value_type.isConstQualified() || value_type.isVolatileQualified() ||
+      !value_type->isObjectType() || value_type->isArrayType() ||
+      value_type->isIncompleteType() ||
+      !value_type.isTriviallyCopyableType(ctx)) {
+    return std::nullopt;
+  }
+
+  // `cc_std::Optional<T>` is a `#[repr(C)]` struct of a `T` and a `bool`.
+  int64_t value_size = ctx.getTypeSizeInChars(value_type).getQuantity();
+  int64_t value_align = ctx.getTypeAlignInChars(value_type).getQuantity();
+  int64_t expected_size = llvm::alignTo(value_size + 1, value_align);
+  if (ctx.getTypeSizeInChars(optional_type).getQuantity() != expected_size ||
+      ctx.getTypeAlignInChars(optional_type).getQuantity() != value_align) {
+    return std::nullopt;
+  }
+  std::vector<int64_t> bool_field_offsets;
+  CollectBoolFieldOffsets(*specialization, 0, ctx, bool_field_offsets);
+  if (bool_field_offsets.size() != 1 || bool_field_offsets[0] != value_size) {
+    return std::nullopt;
+  }
+  return value_type;
+}
+
+std::optional<StatusOrTypes> GetStatusOrTypes(const clang::Type& cc_type,
+                                              clang::Sema& sema) {
+  const clang::ClassTemplateSpecializationDecl* specialization =
+      GetNamedSpecialization(cc_type);
+  if (specialization == nullptr || specialization->getName() != "StatusOr" ||
+      !IsInTopLevelNamespace(*specialization, "absl")) {
+    return std::nullopt;
+  }
+  clang::ASTContext& ctx = sema.getASTContext();
+  clang::QualType status_or_type = ctx.getRecordType(specialization);
+  if (!sema.isCompleteType(specialization->getLocation(), status_or_type) ||
+      specialization->isInvalidDecl()) {
+    return std::nullopt;
+  }
+
+  // `status()` has `const&` and `&&` overloads, which both return (a
+  // reference to) `absl::Status`.
+  for (const clang::NamedDecl* decl :
+       specialization->lookup(&ctx.Idents.get("status"))) {
+    const auto* method = llvm::dyn_cast<clang::CXXMethodDecl>(decl);
+    if (method == nullptr) continue;
+    clang::QualType status_type =
+        method->getReturnType().getNonReferenceType().getUnqualifiedType();
+    const clang::CXXRecordDecl* status = status_type->getAsCXXRecordDecl();
+    if (status == nullptr || status->getName() != "Status" ||
+        !IsInTopLevelNamespace(*status, "absl")) {
+      return std::nullopt;
+    }
+    return StatusOrTypes{
+        .value_type = specialization->getTemplateArgs()[0].getAsType(),
+        .status_type = status_type};
+  }
+  return std::nullopt;
+}
+
+const clang::FunctionProtoType* GetFunctionRefSignature(
+    const clang::Type& cc_type) {
+  const clang::ClassTemplateSpecializationDecl* specialization =
+      GetNamedSpecialization(cc_type);
+  if (specialization == nullptr ||
+      specialization->getName() != "FunctionRef" ||
+      !IsInTopLevelNamespace(*specialization, "absl")) {
+    return nullptr;
+  }
+  const auto* signature = specialization->getTemplateArgs()[0]
+                              .getAsType()
+                              ->getAs<clang::FunctionProtoType>();
+  // The arguments of C-style variadic functions can't be forwarded to Rust.
+  if (signature == nullptr || signature->isVariadic()) return nullptr;
+  return signature;
+}
+
 }  // namespace crubit
@@ -9,6 +9,7 @@
 
 #include "rs_bindings_from_cc/ir.h"
 #include "clang/AST/Type.h"
+#include "clang/Sema/Sema.h"
 
 namespace crubit {
 
@@ -24,6 +25,87 @@ namespace crubit {
 // of types.
 std::optional<MappedType> GetTypeMapOverride(const clang::Type& cc_type);
 
+// If `cc_type` is a span with a dynamic extent (`absl::Span<T>` or
+// `std::span<T>`), returns its element type `T`. String views
+// (`std::basic_string_view<CharT>`, e.g. `std::string_view`) are spans of
+// `const CharT`.
+//
+// Spans are mapped to raw Rust slice pointers by `MappedType::SpanOf`, rather
+// than imported as ordinary class template instantiations.
+std::optional<clang::QualType> GetSpanElementType(const clang::Type& cc_type);
+
+// If `cc_type` is `std::vector<T>` (with the default `std::allocator<T>`, and
+// other than `std::vector<bool>`), returns its element type `T`.
+//
+// Vectors are mapped to `cc_std::Vector<T>` by `MappedType::VectorOf`, a Rust
+// type with the same layout as libc++'s `std::vector<T>`.
+std::optional<clang::QualType> GetVectorElementType(const clang::Type& cc_type);
+
+// Returns true if `cc_type` is `std::string` of libc++, and libc++ uses the
+// string layout of its default ABI, on a little-endian 64-bit target.
+//
+// Such strings (and aliases of them) are mapped to `cc_std::String` by
+// `MappedType::StdString`, a Rust type with the same layout, which reads
+// `data()` and `size()` without a thunk. Other strings are imported as ordinary
+// class template instantiations.
+//
+// The size and alignment are checked on the `std::string` class, which is
+// instantiated with `sema` if needed.
+bool IsStdStringWithKnownLayout(const clang::Type& cc_type, clang::Sema& sema);
+
+// If `cc_type` is `std::unique_ptr<T>` with the default deleter
+// (`std::default_delete<T>`), where `T` is an unqualified arithmetic or class
+// type, and the `unique_ptr` is a single pointer, returns `T`.
+//
+// Such `unique_ptr`s are mapped to `cc_std::CcBox<T>` by
+// `MappedType::UniquePtrOf`, a Rust owning pointer with the same layout, which
+// dereferences the pointer without a thunk. The `unique_ptr` class is
+// instantiated with `sema` if needed, to check its size.
+std::optional<clang::QualType> GetUniquePtrElementType(
+    const clang::Type& cc_type, clang::Sema& sema);
+
+// If `cc_type` is `std::optional<T>`, where `T` is a trivially copyable,
+// unqualified object type, and the `optional` is laid out as a `T` followed by
+// a `bool` "engaged" flag at offset `sizeof(T)`, returns `T`.
+//
+// Such `optional`s are mapped to `cc_std::Optional<T>` by
+// `MappedType::OptionalOf`, a `#[repr(C)]` Rust type with the same layout,
+// which tests for and reads the value without a thunk. The `optional` class is
+// instantiated with `sema` if needed, to check its layout.
+std::optional<clang::QualType> GetOptionalValueType(const clang::Type& cc_type,
+                                                    clang::Sema& sema);
+
+// The types that an `absl::StatusOr<T>` holds.
+struct StatusOrTypes {
+  // `T`.
+  clang::QualType value_type;
+  // `absl::Status`, as returned by `absl::StatusOr<T>::status()`.
+  clang::QualType status_type;
+};
+
+// If `cc_type` is `absl::StatusOr<T>`, returns `T` and `absl::Status`.
+//
+// Functions that return `absl::StatusOr<T>` by value are bound as functions
+// returning a Rust `Result<T, Status>` by `MappedType::StatusOrOf`, so that
+// the value or the status is moved out of the `StatusOr` in the thunk, rather
+// than through more thunk calls on the bindings of `absl::StatusOr<T>`.
+//
+// The `StatusOr` class is instantiated with `sema` if needed, to look up the
+// type of `status()`.
+std::optional<StatusOrTypes> GetStatusOrTypes(const clang::Type& cc_type,
+                                              clang::Sema& sema);
+
+// If `cc_type` is `absl::FunctionRef<R(Args...)>`, returns the function type
+// `R(Args...)`.
+//
+// Functions that take an `absl::FunctionRef` by value are bound as functions
+// taking a Rust closure by `MappedType::FunctionRefOf`. The thunk builds the
+// `FunctionRef` from a pointer to the closure and a function that calls it, so
+// passing the closure doesn't allocate, and calling it takes a single indirect
+// call into Rust.
+const clang::FunctionProtoType* GetFunctionRefSignature(
+    const clang::Type& cc_type);
+
 }  // namespace crubit
 
 #endif  // CRUBIT_RS_BINDINGS_FROM_CC_KNOWN_TYPES_MAP_H_
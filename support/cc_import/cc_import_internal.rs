@@ -34,20 +34,23 @@ fn get_namespace_hierarchy() -> MergedNamespaceHierarchy {
     let files: Vec<String> = serde_json::from_str(&namespace_json_files)
         .expect("Could not parse CC_IMPORT_NAMESPACES environment variable");
 
-    let merged_hierarchy = files
-        .iter()
-        .map(|file_path| {
-            let json_file_content = std::fs::read_to_string(file_path)
-                .unwrap_or_else(|_| panic!("Couldn't read file {}", &file_path));
-            let json_namespace_hierarchy: JsonNamespaceHierarchy =
-                serde_json::from_str(&json_file_content)
-                    .expect("Did not parse JSON content successfully");
-            MergedNamespaceHierarchy::from_json_namespace_hierarchy(&json_namespace_hierarchy)
-        })
-        .reduce(|mut merged, next| {
-            merged.merge(next);
-            merged
-        })
-        .unwrap();
-    merged_hierarchy
+    let mut merged_hierarchy: Option<MergedNamespaceHierarchy> = None;
+    for file_path in files.iter() {
+        let json_file_content = std::fs::read_to_string(file_path)
+            .unwrap_or_else(|_| panic!("Couldn't read file {}", &file_path));
+        let json_namespace_hierarchy: JsonNamespaceHierarchy =
+            serde_json::from_str(&json_file_content)
+                .expect("Did not parse JSON content successfully");
+        // Merges each target straight into the merged hierarchy, rather than
+        // building a hierarchy per target first.
+        match &mut merged_hierarchy {
+            Some(merged) => merged.merge_json_namespace_hierarchy(&json_namespace_hierarchy),
+            None => {
+                merged_hierarchy = Some(MergedNamespaceHierarchy::from_json_namespace_hierarchy(
+                    &json_namespace_hierarchy,
+                ))
+            }
+        }
+    }
+    merged_hierarchy.unwrap()
 }
@@ -80,6 +80,37 @@ impl MergedNamespace {
         }
     }
 
+    /// Merges `json_namespace` of the target `label` into the current
+    /// namespace, like `merge` of `MergedNamespace::from_json_namespace(label,
+    /// json_namespace)` would, but without building that intermediate
+    /// namespace first.
+    fn merge_json_namespace(&mut self, label: &Rc<str>, json_namespace: &JsonNamespace) {
+        self.labels.insert(label.clone());
+        self.add_json_children(label, json_namespace);
+    }
+
+    /// The equivalent of `add_child` for each child of `json_namespace`.
+    fn add_json_children(&mut self, label: &Rc<str>, json_namespace: &JsonNamespace) {
+        for child in json_namespace.children.iter() {
+            match self.children.get_mut(&child.name) {
+                Some(child_namespace) => {
+                    // Like `add_child`, only records the label in namespaces that the
+                    // target reopens with children of their own.
+                    if !child.children.is_empty() {
+                        child_namespace.labels.insert(label.clone());
+                    }
+                    child_namespace.add_json_children(label, child);
+                }
+                None => {
+                    self.children.insert(
+                        child.name.clone(),
+                        MergedNamespace::from_json_namespace(label.clone(), child),
+                    );
+                }
+            }
+        }
+    }
+
     fn add_child(&mut self, namespace: MergedNamespace) {
         self.labels.append(&mut namespace.labels.iter().cloned().collect());
         match self.children.get_mut(&namespace.name) {
@@ -109,6 +140,25 @@ impl MergedNamespaceHierarchy {
         MergedNamespaceHierarchy { top_level_namespaces: merged_namespaces }
     }
 
+    /// Merges `jnh` into the current hierarchy. This is equivalent to, but
+    /// cheaper than, merging the result of `from_json_namespace_hierarchy(jnh)`.
+    pub fn merge_json_namespace_hierarchy(&mut self, jnh: &JsonNamespaceHierarchy) {
+        for top_level_namespace in jnh.namespaces.iter() {
+            match self.top_level_namespaces.get_mut(&top_level_namespace.name) {
+                Some(namespace) => namespace.merge_json_namespace(&jnh.label, top_level_namespace),
+                None => {
+                    self.top_level_namespaces.insert(
+                        top_level_namespace.name.clone(),
+                        MergedNamespace::from_json_namespace(
+                            jnh.label.clone(),
+                            top_level_namespace,
+                        ),
+                    );
+                }
+            }
+        }
+    }
+
     // Merges the namespace hierarchy passed as an argument into the current one.
     pub fn merge(&mut self, other: MergedNamespaceHierarchy) {
         for (name, namespace) in other.top_level_namespaces {
@@ -126,33 +176,46 @@ impl MergedNamespaceHierarchy {
 
 impl ToTokens for MergedNamespaceHierarchy {
     fn to_tokens(&self, tokens: &mut TokenStream) {
+        let mut crate_idents = BTreeMap::new();
         for namespace in self.top_level_namespaces.values() {
-            to_use_stmts(namespace, tokens, &mut vec![]);
+            to_use_stmts(namespace, tokens, &mut vec![], &mut crate_idents);
         }
     }
 }
 
+/// Returns the identifier of the crate of the target `label_literal`, parsing
+/// each label only once, since most labels reopen many namespaces.
+fn crate_ident<'a>(
+    label_literal: &Rc<str>,
+    crate_idents: &'a mut BTreeMap<Rc<str>, Ident>,
+) -> &'a Ident {
+    crate_idents.entry(label_literal.clone()).or_insert_with(|| {
+        let span = Span::call_site();
+        let label = AbsoluteLabel::parse(label_literal, &span).expect("Couldn't parse label");
+        // TODO(rosica): Use mangled name for the crate.
+        let crate_name = &label.crate_name(&Mode::NoRenaming);
+        Ident::new(crate_name, span)
+    })
+}
+
 fn to_use_stmts(
     namespace: &MergedNamespace,
     tokens: &mut TokenStream,
     outer_namespaces: &mut Vec<Ident>,
+    crate_idents: &mut BTreeMap<Rc<str>, Ident>,
 ) {
     let module_name = Ident::new(&namespace.name, Span::call_site());
 
     let mut inner_tokens = TokenStream::new();
     for label_literal in namespace.labels.iter() {
-        let span = Span::call_site();
-        let label = AbsoluteLabel::parse(label_literal, &span).expect("Couldn't parse label");
-        // TODO(rosica): Use mangled name for the crate.
-        let crate_name = &label.crate_name(&Mode::NoRenaming);
-        let crate_ident = Ident::new(crate_name, span);
+        let crate_ident = crate_ident(label_literal, crate_idents);
         inner_tokens.append_all(quote! {
             pub use #crate_ident::#(#outer_namespaces::)*#module_name::*;
         });
     }
     outer_namespaces.push(module_name);
     for inner in namespace.children.values() {
-        to_use_stmts(inner, &mut inner_tokens, outer_namespaces);
+        to_use_stmts(inner, &mut inner_tokens, outer_namespaces, crate_idents);
     }
     let module_name = outer_namespaces.pop();
 
@@ -346,6 +409,37 @@ mod tests {
         assert_eq!(d_labels.iter().map(Deref::deref).collect::<Vec<_>>(), ["//:label2"]);
     }
 
+    #[test]
+    fn test_merge_json_namespace_hierarchy_matches_merge() {
+        let hierarchies: Vec<JsonNamespaceHierarchy> = [
+            r#"{"label": "//:a", "namespaces": [
+                {"name": "x", "children": [{"name": "y", "children": []}]}
+            ]}"#,
+            r#"{"label": "//:b", "namespaces": [
+                {"name": "x", "children": [
+                    {"name": "y", "children": [{"name": "z", "children": []}]},
+                    {"name": "w", "children": []}
+                ]},
+                {"name": "v", "children": []}
+            ]}"#,
+            r#"{"label": "//:c", "namespaces": [
+                {"name": "x", "children": [{"name": "y", "children": []}]}
+            ]}"#,
+        ]
+        .iter()
+        .map(|json| serde_json::from_str(json).unwrap())
+        .collect();
+
+        let mut merged = MergedNamespaceHierarchy::from_json_namespace_hierarchy(&hierarchies[0]);
+        let mut merged_json =
+            MergedNamespaceHierarchy::from_json_namespace_hierarchy(&hierarchies[0]);
+        for hierarchy in &hierarchies[1..] {
+            merged.merge(MergedNamespaceHierarchy::from_json_namespace_hierarchy(hierarchy));
+            merged_json.merge_json_namespace_hierarchy(hierarchy);
+        }
+        assert_eq!(quote! {#merged_json}.to_string(), quote! {#merged}.to_string());
+    }
+
     #[test]
     fn test_to_tokens() {
         let hierarchy_one: JsonNamespaceHierarchy = serde_json::from_str(
@@ -0,0 +1,100 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! The Rust type of C++ `std::optional<T>`.
+//!
+//! `std::optional<T>` of a trivially copyable `T` is mapped to `Optional<T>`
+//! if it is laid out as a `T` followed by a `bool` that tells whether the
+//! optional holds a value, like in libc++ and libstdc++. This lets Rust test
+//! for and read the value without calling a thunk.
+
+use core::mem::MaybeUninit;
+
+/// A C++ `std::optional<T>`.
+///
+/// The value is only initialized if `engaged` is true.
+#[repr(C)]
+#[derive(Clone, Copy)]
+pub struct Optional<T: Copy> {
+    value: MaybeUninit<T>,
+    engaged: bool,
+}
+
+impl<T: Copy> Optional<T> {
+    /// Returns an optional without a value, like `std::nullopt`.
+    pub const fn none() -> Self {
+        Optional { value: MaybeUninit::uninit(), engaged: false }
+    }
+
+    /// Returns an optional holding `value`.
+    pub const fn some(value: T) -> Self {
+        Optional { value: MaybeUninit::new(value), engaged: true }
+    }
+
+    /// Returns true if the optional holds a value, like `has_value()` in C++.
+    #[inline(always)]
+    pub fn has_value(&self) -> bool {
+        self.engaged
+    }
+
+    /// Returns the value, if any.
+    #[inline(always)]
+    pub fn as_option(&self) -> Option<&T> {
+        // SAFETY: the value is initialized if the optional is engaged.
+        self.engaged.then(|| unsafe { self.value.assume_init_ref() })
+    }
+
+    /// Returns the value, if any, for modification.
+    #[inline(always)]
+    pub fn as_mut_option(&mut self) -> Option<&mut T> {
+        // SAFETY: the same as for `as_option`.
+        self.engaged.then(|| unsafe { self.value.assume_init_mut() })
+    }
+
+    /// Returns a copy of the value, if any.
+    #[inline(always)]
+    pub fn get(&self) -> Option<T> {
+        self.as_option().copied()
+    }
+
+    /// Replaces the value, like assigning to the optional in C++.
+    pub fn set(&mut self, value: Option<T>) {
+        *self = value.into();
+    }
+}
+
+impl<T: Copy> Default for Optional<T> {
+    fn default() -> Self {
+        Self::none()
+    }
+}
+
+impl<T: Copy> From<Option<T>> for Optional<T> {
+    fn from(value: Option<T>) -> Self {
+        match value {
+            Some(value) => Self::some(value),
+            None => Self::none(),
+        }
+    }
+}
+
+impl<T: Copy> From<Optional<T>> for Option<T> {
+    fn from(value: Optional<T>) -> Self {
+        value.get()
+    }
+}
+
+impl<T: Copy + PartialEq> PartialEq for Optional<T> {
+    fn eq(&self, other: &Self) -> bool {
+        self.as_option() == other.as_option()
+    }
+}
+
+impl<T: Copy + Eq> Eq for Optional<T> {}
+
+impl<T: Copy + core::fmt::Debug> core::fmt::Debug for Optional<T> {
+    fn fmt(&self, f: &mut core::fmt::Formatter<'_>) -> core::fmt::Result {
+        core::fmt::Debug::fmt(&self.as_option(), f)
+    }
+}
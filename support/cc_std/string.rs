@@ -0,0 +1,131 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! The Rust type of C++ `std::string`.
+//!
+//! When the bindings are generated against libc++ with its default string
+//! layout, `std::string` is mapped to `String`, which has the same layout. This
+//! lets Rust read the characters of a C++ string without calling a thunk.
+//! Other standard libraries and layouts keep the ordinary bindings of
+//! `std::string`.
+
+use core::ffi::c_void;
+use core::mem::{align_of, size_of, MaybeUninit};
+
+// See docs/rust_builtin_type_abi_assumptions.md.
+extern "C" {
+    /// `void operator delete(void*)`
+    #[link_name = "_ZdlPv"]
+    fn operator_delete(ptr: *mut c_void);
+}
+
+/// A C++ `std::string`.
+///
+/// Like libc++'s `std::string` (in its default layout, on little-endian 64-bit
+/// platforms), this is 3 words, and the lowest bit of the first byte tells
+/// whether the string is "long":
+///   * a short string stores its size in the other 7 bits of the first byte,
+///     followed by its characters and a NUL,
+///   * a long string stores its capacity in the first word, its size in the
+///     second word, and a pointer to its characters (followed by a NUL) in the
+///     third word.
+#[repr(C, align(8))]
+pub struct String {
+    repr: [MaybeUninit<u8>; 24],
+}
+
+const _: () = assert!(size_of::<String>() == 3 * size_of::<usize>());
+const _: () = assert!(align_of::<String>() == align_of::<usize>());
+
+impl String {
+    /// Returns an empty string, without allocating.
+    pub const fn new() -> Self {
+        // An empty short string.
+        String { repr: [MaybeUninit::new(0); 24] }
+    }
+
+    fn is_long(&self) -> bool {
+        // SAFETY: the first byte is always initialized.
+        let first_byte = unsafe { self.repr[0].assume_init() };
+        first_byte & 1 != 0
+    }
+
+    /// Returns the `index`th word of a long string.
+    ///
+    /// SAFETY: the string must be long.
+    unsafe fn long_word<T>(&self, index: usize) -> T {
+        (self.repr.as_ptr() as *const T).add(index).read()
+    }
+
+    /// Returns the number of bytes in the string, like `size()` in C++.
+    pub fn len(&self) -> usize {
+        if self.is_long() {
+            // SAFETY: the string is long.
+            unsafe { self.long_word::<usize>(1) }
+        } else {
+            // SAFETY: the first byte is always initialized.
+            (unsafe { self.repr[0].assume_init() } >> 1) as usize
+        }
+    }
+
+    /// Returns true if the string is empty.
+    pub fn is_empty(&self) -> bool {
+        self.len() == 0
+    }
+
+    /// Returns a pointer to the characters of the string, followed by a NUL,
+    /// like `data()` in C++.
+    pub fn as_ptr(&self) -> *const u8 {
+        if self.is_long() {
+            // SAFETY: the string is long.
+            unsafe { self.long_word::<*const u8>(2) }
+        } else {
+            self.repr[1..].as_ptr() as *const u8
+        }
+    }
+
+    /// Returns the bytes of the string, without copying them.
+    pub fn as_bytes(&self) -> &[u8] {
+        // SAFETY: `as_ptr()` is non-null, and points to `len()` initialized
+        // bytes, which live as long as `self` and are not modified through it.
+        unsafe { core::slice::from_raw_parts(self.as_ptr(), self.len()) }
+    }
+
+    /// Converts the string to a Rust string, failing if it is not UTF8.
+    pub fn to_str(&self) -> Result<&str, core::str::Utf8Error> {
+        core::str::from_utf8(self.as_bytes())
+    }
+}
+
+impl Default for String {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl Drop for String {
+    fn drop(&mut self) {
+        if self.is_long() {
+            // SAFETY: the characters of a long string are allocated by
+            // `std::allocator<char>`, which uses the global `operator new`.
+            unsafe { operator_delete(self.long_word::<*mut c_void>(2)) }
+        }
+    }
+}
+
+impl core::ops::Deref for String {
+    type Target = [u8];
+    fn deref(&self) -> &[u8] {
+        self.as_bytes()
+    }
+}
+
+impl core::fmt::Debug for String {
+    fn fmt(&self, f: &mut core::fmt::Formatter<'_>) -> core::fmt::Result {
+        match self.to_str() {
+            Ok(s) => core::fmt::Debug::fmt(s, f),
+            Err(_) => core::fmt::Debug::fmt(self.as_bytes(), f),
+        }
+    }
+}
@@ -0,0 +1,157 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! The Rust type of C++ `std::unique_ptr<T>`.
+//!
+//! `std::unique_ptr<T>` (with the default `std::default_delete<T>`) is mapped
+//! to `CcBox<T>`, which is a single pointer, like `std::unique_ptr<T>`. This
+//! lets Rust dereference the pointer without calling a thunk. Dropping a
+//! `CcBox<T>` calls a single thunk, which runs `delete` in C++.
+
+use core::ffi::c_void;
+use core::ptr;
+
+// See docs/rust_builtin_type_abi_assumptions.md.
+extern "C" {
+    /// `void operator delete(void*)`
+    #[link_name = "_ZdlPv"]
+    fn operator_delete(ptr: *mut c_void);
+}
+
+/// A type whose C++ objects Rust can `delete`.
+///
+/// The bindings of a C++ class implement this trait if the class appears in
+/// a `std::unique_ptr` of the same target. The builtin types implement it
+/// below.
+///
+/// # Safety
+///
+/// `cc_delete(ptr)` must be equivalent to the C++ expression `delete ptr`.
+pub unsafe trait CcDelete {
+    /// Destroys the object `ptr` points to, and frees its memory, like `delete
+    /// ptr` in C++.
+    ///
+    /// # Safety
+    ///
+    /// `ptr` must have been returned by a C++ `new` expression, and not been
+    /// deleted yet.
+    unsafe fn cc_delete(ptr: *mut Self);
+}
+
+macro_rules! impl_cc_delete_for_builtin_types {
+    ($($t:ty),*) => {
+        $(
+            // SAFETY: `delete` of a builtin type doesn't run a destructor, and
+            // frees the memory with the global `operator delete`.
+            unsafe impl CcDelete for $t {
+                #[inline(always)]
+                unsafe fn cc_delete(ptr: *mut Self) {
+                    operator_delete(ptr as *mut c_void)
+                }
+            }
+        )*
+    };
+}
+
+impl_cc_delete_for_builtin_types!(
+    bool, i8, u8, i16, u16, i32, u32, i64, u64, i128, u128, isize, usize, f32, f64
+);
+
+/// A C++ `std::unique_ptr<T>`: an owning, possibly null, pointer to a `T`
+/// allocated by C++ `new`.
+#[repr(transparent)]
+pub struct CcBox<T: CcDelete> {
+    ptr: *mut T,
+}
+
+impl<T: CcDelete> CcBox<T> {
+    /// Returns a null `CcBox`, like a default-constructed `std::unique_ptr`.
+    pub const fn null() -> Self {
+        CcBox { ptr: ptr::null_mut() }
+    }
+
+    /// Takes ownership of `ptr`, like the `std::unique_ptr(T*)` constructor.
+    ///
+    /// # Safety
+    ///
+    /// `ptr` must be null, or have been returned by a C++ `new` expression and
+    /// not be owned by anything else.
+    pub unsafe fn from_raw(ptr: *mut T) -> Self {
+        CcBox { ptr }
+    }
+
+    /// Gives up the ownership of the pointer, like `release()` in C++.
+    pub fn into_raw(self) -> *mut T {
+        let ptr = self.ptr;
+        core::mem::forget(self);
+        ptr
+    }
+
+    /// Returns the pointer, which stays owned by `self`, like `get()` in C++.
+    pub fn as_ptr(&self) -> *mut T {
+        self.ptr
+    }
+
+    /// Returns true if the pointer is null.
+    pub fn is_null(&self) -> bool {
+        self.ptr.is_null()
+    }
+
+    /// Returns the object, or `None` if the pointer is null.
+    #[inline(always)]
+    pub fn as_ref(&self) -> Option<&T> {
+        // SAFETY: a non-null pointer points to a live `T` owned by `self`.
+        unsafe { self.ptr.as_ref() }
+    }
+}
+
+impl<T: CcDelete + Unpin> CcBox<T> {
+    /// Returns the object, or `None` if the pointer is null.
+    #[inline(always)]
+    pub fn as_mut(&mut self) -> Option<&mut T> {
+        // SAFETY: the same as for `as_ref`, and `self` is borrowed mutably.
+        unsafe { self.ptr.as_mut() }
+    }
+}
+
+impl<T: CcDelete> Default for CcBox<T> {
+    fn default() -> Self {
+        Self::null()
+    }
+}
+
+impl<T: CcDelete> Drop for CcBox<T> {
+    fn drop(&mut self) {
+        if !self.ptr.is_null() {
+            // SAFETY: `self` owns the object, which C++ allocated with `new`.
+            unsafe { T::cc_delete(self.ptr) }
+        }
+    }
+}
+
+impl<T: CcDelete> core::ops::Deref for CcBox<T> {
+    type Target = T;
+    /// Panics if the pointer is null.
+    #[inline(always)]
+    fn deref(&self) -> &T {
+        self.as_ref().expect("dereferenced a null CcBox")
+    }
+}
+
+impl<T: CcDelete + Unpin> core::ops::DerefMut for CcBox<T> {
+    /// Panics if the pointer is null.
+    #[inline(always)]
+    fn deref_mut(&mut self) -> &mut T {
+        self.as_mut().expect("dereferenced a null CcBox")
+    }
+}
+
+impl<T: CcDelete + core::fmt::Debug> core::fmt::Debug for CcBox<T> {
+    fn fmt(&self, f: &mut core::fmt::Formatter<'_>) -> core::fmt::Result {
+        match self.as_ref() {
+            Some(value) => core::fmt::Debug::fmt(value, f),
+            None => f.write_str("null"),
+        }
+    }
+}
@@ -0,0 +1,214 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! The Rust type of C++ `std::vector<T>`.
+//!
+//! `std::vector<T>` (with the default `std::allocator<T>`) is mapped to
+//! `Vector<T>`, which has the same layout as libc++'s `std::vector<T>`. This
+//! lets Rust access the elements of a C++ vector as a slice, without a copy
+//! and without calling a thunk for each element.
+
+use core::ffi::c_void;
+use core::mem::{align_of, size_of};
+use core::ptr;
+
+/// libc++'s `__STDCPP_DEFAULT_NEW_ALIGNMENT__` on the platforms supported by
+/// Crubit: `std::allocator<T>` only uses the aligned `operator new` for
+/// over-aligned `T`.
+const DEFAULT_NEW_ALIGNMENT: usize = 16;
+
+// The global allocation functions used by `std::allocator<T>`. See
+// docs/rust_builtin_type_abi_assumptions.md for the ABI assumptions made
+// here.
+extern "C" {
+    /// `void* operator new(std::size_t)`
+    #[link_name = "_Znwm"]
+    fn operator_new(size: usize) -> *mut c_void;
+    /// `void* operator new(std::size_t, std::align_val_t)`
+    #[link_name = "_ZnwmSt11align_val_t"]
+    fn operator_new_aligned(size: usize, alignment: usize) -> *mut c_void;
+    /// `void operator delete(void*)`
+    #[link_name = "_ZdlPv"]
+    fn operator_delete(ptr: *mut c_void);
+    /// `void operator delete(void*, std::align_val_t)`
+    #[link_name = "_ZdlPvSt11align_val_t"]
+    fn operator_delete_aligned(ptr: *mut c_void, alignment: usize);
+}
+
+/// A C++ `std::vector<T>`.
+///
+/// Like libc++'s `std::vector<T>`, this is a pointer to the first element, a
+/// pointer past the last element, and a pointer past the end of the
+/// allocation. An empty vector may have null pointers.
+#[repr(C)]
+pub struct Vector<T> {
+    begin: *mut T,
+    end: *mut T,
+    end_cap: *mut T,
+}
+
+impl<T> Vector<T> {
+    /// Returns an empty vector, without allocating.
+    pub const fn new() -> Self {
+        Vector { begin: ptr::null_mut(), end: ptr::null_mut(), end_cap: ptr::null_mut() }
+    }
+
+    /// Returns the number of elements in the vector.
+    pub fn len(&self) -> usize {
+        if self.begin.is_null() {
+            return 0;
+        }
+        // SAFETY: `begin` and `end` point into (or one past) the same
+        // allocation, and `end` is not before `begin`.
+        unsafe { self.end.offset_from(self.begin) as usize }
+    }
+
+    /// Returns true if the vector contains no elements.
+    pub fn is_empty(&self) -> bool {
+        self.begin == self.end
+    }
+
+    /// Returns the number of elements the vector can hold without
+    /// reallocating.
+    pub fn capacity(&self) -> usize {
+        if self.begin.is_null() {
+            return 0;
+        }
+        // SAFETY: the same as for `len`.
+        unsafe { self.end_cap.offset_from(self.begin) as usize }
+    }
+
+    /// Returns the elements of the vector, without copying them.
+    pub fn as_slice(&self) -> &[T] {
+        if self.begin.is_null() {
+            return &[];
+        }
+        // SAFETY: the first `len()` elements are initialized.
+        unsafe { core::slice::from_raw_parts(self.begin, self.len()) }
+    }
+
+    /// Returns the elements of the vector, without copying them.
+    pub fn as_mut_slice(&mut self) -> &mut [T] {
+        if self.begin.is_null() {
+            return &mut [];
+        }
+        // SAFETY: the first `len()` elements are initialized, and `&mut self`
+        // guarantees exclusive access to them.
+        unsafe { core::slice::from_raw_parts_mut(self.begin, self.len()) }
+    }
+}
+
+/// Methods that may reallocate the vector.
+///
+/// These are limited to `Copy` element types, whose C++ counterparts are
+/// trivially copyable: the elements are relocated with a `memcpy`, rather than
+/// with their C++ move constructors.
+impl<T: Copy> Vector<T> {
+    /// Reserves capacity for at least `additional` more elements, like
+    /// `reserve(size() + additional)` in C++.
+    pub fn reserve(&mut self, additional: usize) {
+        // Zero-sized types don't exist in C++.
+        assert_ne!(size_of::<T>(), 0, "`Vector` doesn't support zero-sized types");
+        let len = self.len();
+        let required = len.checked_add(additional).expect("capacity overflow");
+        if required <= self.capacity() {
+            return;
+        }
+        // Grow geometrically (like `std::vector::push_back` does), so that
+        // repeated `push` and `extend_from_slice` calls take amortized
+        // constant time per element.
+        let new_capacity = core::cmp::max(required, 2 * self.capacity());
+        let size = new_capacity.checked_mul(size_of::<T>()).expect("capacity overflow");
+        // SAFETY: `operator new` either returns a suitably aligned allocation of
+        // `size` bytes, or doesn't return. The old elements don't overlap the
+        // new allocation, and are trivially copyable.
+        unsafe {
+            let new_begin = if align_of::<T>() > DEFAULT_NEW_ALIGNMENT {
+                operator_new_aligned(size, align_of::<T>()) as *mut T
+            } else {
+                operator_new(size) as *mut T
+            };
+            if !self.begin.is_null() {
+                ptr::copy_nonoverlapping(self.begin, new_begin, len);
+                self.deallocate();
+            }
+            self.begin = new_begin;
+            self.end = new_begin.add(len);
+            self.end_cap = new_begin.add(new_capacity);
+        }
+    }
+
+    /// Appends `value`, like `push_back(value)` in C++.
+    pub fn push(&mut self, value: T) {
+        self.extend_from_slice(core::slice::from_ref(&value));
+    }
+
+    /// Appends all of `values` at once: the vector reallocates at most once,
+    /// and the elements are copied with a single `memcpy`.
+    pub fn extend_from_slice(&mut self, values: &[T]) {
+        self.reserve(values.len());
+        if values.is_empty() {
+            return;
+        }
+        // SAFETY: `reserve` made room for `values.len()` elements past `end`,
+        // and `values` can't alias the vector's spare capacity.
+        unsafe {
+            ptr::copy_nonoverlapping(values.as_ptr(), self.end, values.len());
+            self.end = self.end.add(values.len());
+        }
+    }
+}
+
+impl<T> Vector<T> {
+    /// Deallocates the vector's allocation, without destroying its elements.
+    ///
+    /// SAFETY: `begin` must be non-null, and must have been allocated the way
+    /// `std::allocator<T>` does.
+    unsafe fn deallocate(&mut self) {
+        if align_of::<T>() > DEFAULT_NEW_ALIGNMENT {
+            operator_delete_aligned(self.begin as *mut c_void, align_of::<T>());
+        } else {
+            operator_delete(self.begin as *mut c_void);
+        }
+    }
+}
+
+impl<T> Default for Vector<T> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<T> Drop for Vector<T> {
+    fn drop(&mut self) {
+        if self.begin.is_null() {
+            return;
+        }
+        // SAFETY: the elements are initialized, and are not used after being
+        // dropped (which, for bindings of C++ types, runs their destructors).
+        unsafe {
+            ptr::drop_in_place(self.as_mut_slice());
+            self.deallocate();
+        }
+    }
+}
+
+impl<T> core::ops::Deref for Vector<T> {
+    type Target = [T];
+    fn deref(&self) -> &[T] {
+        self.as_slice()
+    }
+}
+
+impl<T> core::ops::DerefMut for Vector<T> {
+    fn deref_mut(&mut self) -> &mut [T] {
+        self.as_mut_slice()
+    }
+}
+
+impl<T: core::fmt::Debug> core::fmt::Debug for Vector<T> {
+    fn fmt(&self, f: &mut core::fmt::Formatter<'_>) -> core::fmt::Result {
+        f.debug_list().entries(self.as_slice()).finish()
+    }
+}
@@ -8,11 +8,13 @@ use std::collections::HashMap;
 use std::env;
 use std::fs::File;
 use std::io::BufReader;
+use std::sync::{Arc, Mutex};
+use std::time::SystemTime;
 
 pub fn to_private_struct_path(input: TokenStream) -> Result<TokenStream, syn::Error> {
     validate_user_input(&input)?;
     let instantiations = read_instantiations_map()?;
-    get_instantiation_struct_name(input, instantiations)
+    get_instantiation_struct_name(input, &instantiations)
 }
 
 fn validate_user_input(_input: &TokenStream) -> Result<(), syn::Error> {
@@ -21,37 +23,54 @@ fn validate_user_input(_input: &TokenStream) -> Result<(), syn::Error> {
     Ok(())
 }
 
-fn read_instantiations_map() -> Result<HashMap<String, String>, syn::Error> {
+/// The instantiations map that was read last, along with what identifies the
+/// version of the file it was read from.
+struct CachedInstantiations {
+    path: String,
+    modified: SystemTime,
+    len: u64,
+    map: Arc<HashMap<String, String>>,
+}
+
+/// The proc macro runs once per `cc_template!` invocation, but in the same
+/// process for the whole crate, so the map is only parsed again if the file
+/// changes.
+static CACHED_INSTANTIATIONS: Mutex<Option<CachedInstantiations>> = Mutex::new(None);
+
+fn read_instantiations_map() -> Result<Arc<HashMap<String, String>>, syn::Error> {
     let path = env::var("CRUBIT_INSTANTIATIONS_FILE").map_err(|err| {
         make_syn_error(format!("Couldn't read 'CRUBIT_INSTANTIATIONS_FILE': {}.", err))
     })?;
     let file = File::open(&path).map_err(|err| {
         make_syn_error(format!("Couldn't read C++ instantiations from '{}': {}", path, err))
     })?;
+    let metadata = file.metadata().map_err(|err| {
+        make_syn_error(format!("Couldn't read C++ instantiations from '{}': {}", path, err))
+    })?;
+    let modified = metadata.modified().unwrap_or(SystemTime::UNIX_EPOCH);
+    let len = metadata.len();
+
+    let mut cache = CACHED_INSTANTIATIONS.lock().unwrap_or_else(|err| err.into_inner());
+    if let Some(cached) = &*cache {
+        if cached.path == path && cached.modified == modified && cached.len == len {
+            return Ok(cached.map.clone());
+        }
+    }
     let reader = BufReader::new(file);
-    serde_json::from_reader(reader)
-        .map_err(|err| make_syn_error(format!("Couldn't deserialize JSON from {}: {}", path, err)))
+    let map: Arc<HashMap<String, String>> =
+        Arc::new(serde_json::from_reader(reader).map_err(|err| {
+            make_syn_error(format!("Couldn't deserialize JSON from {}: {}", path, err))
+        })?);
+    *cache = Some(CachedInstantiations { path, modified, len, map: map.clone() });
+    Ok(map)
 }
 
 fn get_instantiation_struct_name(
     input: TokenStream,
-    instantiations: HashMap<String, String>,
+    instantiations: &HashMap<String, String>,
 ) -> Result<TokenStream, syn::Error> {
-    // In theory `TokenStream` -> `instantiation_name` translation could go through
-    // `token_stream_printer::tokens_to_string`.  This route is not used because:
-    // - The dependencies it would bring would run into b/216638047
-    // - Extra functionality from that route is not needed (e.g. no need for
-    //   `__COMMENT__`-aware or `__SPACE__`-aware processing, nor for special
-    //   handling of `TokenTree::Group`).
-    //
-    // TODO(lukasza, hlopko): In the future, extra canonicalization might be
-    // considered, so that `std::vector<int>`, and `std::vector<(int)>`, and
-    // `std::vector<int32_t>` are treated as equivalent.
-    //
-    // TODO(lukasza, hlopko): More explicitly ensure that the same canonicalization
-    // (e.g. TokenStream->String transformation) is used here and in
-    // `rs_bindings_from_cc/collect_instantiations.rs`.
-    let instantiation_name = input.to_string();
+    // `collect_instantiations.rs` keys the instantiations map the same way.
+    let instantiation_name = cc_template_key::instantiation_key(input);
 
     match instantiations.get(&instantiation_name) {
         Some(concrete_struct_name) => {
@@ -133,14 +152,29 @@ mod tests {
         let deserialized_map =
             read_instantiations_map().expect("Expected successful deserialization.");
 
-        assert_eq!(deserialized_map, hashmap! { key.to_string() => value.to_string() });
+        assert_eq!(*deserialized_map, hashmap! { key.to_string() => value.to_string() });
+    }
+
+    #[test]
+    fn test_instantiations_map_is_reread_when_file_changes() {
+        let path = Path::join(Path::new(&env::var("TEST_TMPDIR").unwrap()), "changing.json");
+        std::fs::write(&path, serde_json::to_string(&hashmap! {"a" => "A"}).unwrap()).unwrap();
+        env::set_var("CRUBIT_INSTANTIATIONS_FILE", &path);
+
+        let first = read_instantiations_map().unwrap();
+        let again = read_instantiations_map().unwrap();
+        assert!(Arc::ptr_eq(&first, &again));
+
+        std::fs::write(&path, serde_json::to_string(&hashmap! {"bb" => "BB"}).unwrap()).unwrap();
+        let changed = read_instantiations_map().unwrap();
+        assert_eq!(*changed, hashmap! { "bb".to_string() => "BB".to_string() });
     }
 
     #[test]
     fn test_successful_expansion() {
         let expanded = get_instantiation_struct_name(
             quote!{ std::vector<bool> },
-            hashmap! {
+            &hashmap! {
                 quote!{ std::vector<bool> }.to_string() => "__std_vector__bool__".to_string(),
             },
         )
@@ -151,6 +185,21 @@ mod tests {
         );
     }
 
+    #[test]
+    fn test_expansion_of_spelling_variant() {
+        let expanded = get_instantiation_struct_name(
+            quote! { ::std::vector<std::int32_t> },
+            &hashmap! {
+                "std :: vector < int >".to_string() => "__std_vector__int__".to_string(),
+            },
+        )
+        .unwrap();
+        assert_eq!(
+            expanded.to_string(),
+            quote! {__cc_template_instantiations_rs_api::__std_vector__int__}.to_string()
+        );
+    }
+
     #[test]
     fn test_parsing_valid_cc_instantiations() {
         validate_user_input(&quote! {vector<bool>}).unwrap();
@@ -105,6 +105,7 @@
 extern crate alloc;
 
 use alloc::boxed::Box;
+use alloc::vec::Vec;
 use core::marker::{PhantomData, Unpin};
 use core::mem::{ManuallyDrop, MaybeUninit};
 use core::ops::{Deref, DerefMut};
@@ -158,6 +159,24 @@ pub trait Ctor {
     {
         CtorThen { ctor: self, f }
     }
+
+    /// Returns a chained Ctor, which will assign `src` after construction.
+    ///
+    /// This is equivalent to `self.ctor_then(|inited| inited.assign(src))`,
+    /// but doesn't create a closure, so that the type of the Ctor only depends
+    /// on the type of `self` and `src`. This is the common "default-construct,
+    /// then assign" pattern:
+    ///
+    /// ```
+    /// emplace! { let x = T::ctor_new(()).ctor_then_assign(&y); }
+    /// ```
+    fn ctor_then_assign<From>(self, src: From) -> CtorThenAssign<Self, From>
+    where
+        Self: Sized,
+        Self::Output: Assign<From>,
+    {
+        CtorThenAssign { ctor: self, src }
+    }
 }
 
 pub trait Emplace<T>: Sized {
@@ -467,6 +486,34 @@ impl<C: Ctor, F: FnOnce(Pin<&mut C::Output>)> Ctor for CtorThen<C, F> {
 
 impl<C: Ctor, F: FnOnce(Pin<&mut C::Output>)> !Unpin for CtorThen<C, F> {}
 
+/// A `Ctor` which constructs using `self.ctor`, and then assigns `self.src` to
+/// the resulting object.
+///
+/// This struct is created by the `ctor_then_assign` method on `Ctor`. See its
+/// documentation for more.
+#[must_use = must_use_ctor!()]
+pub struct CtorThenAssign<C: Ctor, From>
+where
+    C::Output: Assign<From>,
+{
+    ctor: C,
+    src: From,
+}
+
+impl<C: Ctor, From> Ctor for CtorThenAssign<C, From>
+where
+    C::Output: Assign<From>,
+{
+    type Output = C::Output;
+    unsafe fn ctor(self, mut dest: Pin<&mut MaybeUninit<Self::Output>>) {
+        self.ctor.ctor(dest.as_mut());
+        let dest = Pin::new_unchecked(Pin::into_inner_unchecked(dest).assume_init_mut());
+        dest.assign(self.src)
+    }
+}
+
+impl<C: Ctor, From> !Unpin for CtorThenAssign<C, From> where C::Output: Assign<From> {}
+
 // ========
 // emplace!
 // ========
@@ -661,6 +708,228 @@ impl<T> Slot<T> {
     }
 }
 
+/// A fixed number of pinned slots, which can store in-place constructed
+/// objects, e.g. as output buffers for C++ calls.
+///
+/// Unlike `[Slot<T>; N]`, the values are stored contiguously, without an
+/// `is_initialized` flag each: which slots are initialized is tracked by a
+/// separate bitmap. The values live on the heap and are never moved, so the
+/// `SlotVec` itself doesn't need to be pinned.
+///
+/// ```
+/// let mut slots = SlotVec::<u32>::new(3);
+/// slots.replace(1, 42);
+/// assert_eq!(slots.as_opt(0), None);
+/// assert_eq!(slots.as_opt(1), Some(&42));
+/// ```
+pub struct SlotVec<T> {
+    initialized: Box<[u64]>,
+    values: Box<[MaybeUninit<T>]>,
+}
+
+impl<T> Drop for SlotVec<T> {
+    fn drop(&mut self) {
+        for i in 0..self.len() {
+            self.clear(i);
+        }
+    }
+}
+
+impl<T> SlotVec<T> {
+    /// Returns `len` uninitialized slots.
+    pub fn new(len: usize) -> Self {
+        let mut values = Vec::with_capacity(len);
+        values.resize_with(len, MaybeUninit::uninit);
+        SlotVec {
+            initialized: alloc::vec![0; (len + 63) / 64].into_boxed_slice(),
+            values: values.into_boxed_slice(),
+        }
+    }
+
+    pub fn len(&self) -> usize {
+        self.values.len()
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.values.is_empty()
+    }
+
+    pub fn is_initialized(&self, i: usize) -> bool {
+        assert!(i < self.len(), "slot index {i} out of range");
+        self.initialized[i / 64] & (1 << (i % 64)) != 0
+    }
+
+    pub fn clear(&mut self, i: usize) {
+        if self.is_initialized(i) {
+            self.initialized[i / 64] &= !(1 << (i % 64));
+            unsafe {
+                core::ptr::drop_in_place(self.values[i].as_mut_ptr());
+            }
+        }
+    }
+
+    pub fn replace(&mut self, i: usize, value: impl Ctor<Output = T>) -> Pin<&mut T> {
+        self.clear(i);
+        unsafe {
+            value.ctor(Pin::new_unchecked(&mut self.values[i]));
+            self.assume_init(i);
+        }
+        self.as_opt_mut(i).unwrap()
+    }
+
+    pub fn as_opt_mut(&mut self, i: usize) -> Option<Pin<&mut T>> {
+        if self.is_initialized(i) {
+            Some(unsafe { Pin::new_unchecked(self.values[i].assume_init_mut()) })
+        } else {
+            None
+        }
+    }
+
+    pub fn as_opt(&self, i: usize) -> Option<&T> {
+        if self.is_initialized(i) {
+            Some(unsafe { self.values[i].assume_init_ref() })
+        } else {
+            None
+        }
+    }
+
+    /// Returns a pointer to the first of the `len()` contiguous slots, e.g. to
+    /// pass to C++ as an output buffer.
+    pub fn as_mut_ptr(&mut self) -> *mut T {
+        self.values.as_mut_ptr().cast::<T>()
+    }
+
+    /// Marks slot `i` as initialized, after it was initialized through
+    /// `as_mut_ptr()`.
+    ///
+    /// Safety: slot `i` must have been uninitialized, and must now hold a
+    /// valid `T`.
+    pub unsafe fn assume_init(&mut self, i: usize) {
+        debug_assert!(!self.is_initialized(i));
+        self.initialized[i / 64] |= 1 << (i % 64);
+    }
+}
+
+/// A growable collection of pinned, in-place constructed objects.
+///
+/// Unlike a `Vec<Pin<Box<T>>>` built with `Box::emplace`, which allocates once
+/// per object, the objects are stored in chunks that double in size, so the
+/// allocations are amortized. Chunks are never reallocated, so the objects
+/// never move and stay pinned until the `PinnedVec` is dropped, which drops
+/// them in the order they were emplaced.
+///
+/// ```
+/// let mut v = PinnedVec::new();
+/// for i in 0..100 {
+///     v.emplace(i);
+/// }
+/// assert_eq!(v[42], 42);
+/// ```
+pub struct PinnedVec<T> {
+    len: usize,
+    chunks: Vec<Box<[MaybeUninit<T>]>>,
+}
+
+impl<T> PinnedVec<T> {
+    /// The size of the first chunk. Must be a power of two.
+    const FIRST_CHUNK_LEN: usize = 8;
+
+    pub fn new() -> Self {
+        PinnedVec { len: 0, chunks: Vec::new() }
+    }
+
+    pub fn len(&self) -> usize {
+        self.len
+    }
+
+    pub fn is_empty(&self) -> bool {
+        self.len == 0
+    }
+
+    /// Returns the chunk and the index in that chunk of element `i`.
+    fn locate(i: usize) -> (usize, usize) {
+        let j = i + Self::FIRST_CHUNK_LEN;
+        let chunk_start = 1 << (usize::BITS - 1 - j.leading_zeros());
+        let chunk = (chunk_start / Self::FIRST_CHUNK_LEN).trailing_zeros() as usize;
+        (chunk, j - chunk_start)
+    }
+
+    /// Constructs a new object at the end, and returns it.
+    pub fn emplace(&mut self, ctor: impl Ctor<Output = T>) -> Pin<&mut T> {
+        let (chunk, index) = Self::locate(self.len);
+        if chunk == self.chunks.len() {
+            let mut values = Vec::new();
+            values.resize_with(Self::FIRST_CHUNK_LEN << chunk, MaybeUninit::uninit);
+            self.chunks.push(values.into_boxed_slice());
+        }
+        let slot = &mut self.chunks[chunk][index];
+        unsafe {
+            ctor.ctor(Pin::new_unchecked(&mut *slot));
+        }
+        // Only counted once constructed, so that a panicking `ctor` leaves
+        // nothing to drop.
+        self.len += 1;
+        unsafe { Pin::new_unchecked(slot.assume_init_mut()) }
+    }
+
+    pub fn get(&self, i: usize) -> Option<&T> {
+        if i >= self.len {
+            return None;
+        }
+        let (chunk, index) = Self::locate(i);
+        Some(unsafe { self.chunks[chunk][index].assume_init_ref() })
+    }
+
+    pub fn get_mut(&mut self, i: usize) -> Option<Pin<&mut T>> {
+        if i >= self.len {
+            return None;
+        }
+        let (chunk, index) = Self::locate(i);
+        Some(unsafe { Pin::new_unchecked(self.chunks[chunk][index].assume_init_mut()) })
+    }
+
+    pub fn iter(&self) -> impl Iterator<Item = &T> {
+        (0..self.len).map(|i| self.get(i).unwrap())
+    }
+}
+
+impl<T> Default for PinnedVec<T> {
+    fn default() -> Self {
+        Self::new()
+    }
+}
+
+impl<T> core::ops::Index<usize> for PinnedVec<T> {
+    type Output = T;
+    fn index(&self, i: usize) -> &T {
+        match self.get(i) {
+            Some(value) => value,
+            None => panic!("index {i} out of range for PinnedVec of length {}", self.len),
+        }
+    }
+}
+
+impl<T> Drop for PinnedVec<T> {
+    fn drop(&mut self) {
+        if !core::mem::needs_drop::<T>() {
+            return;
+        }
+        let mut remaining = self.len;
+        // Set first, so that a panicking destructor can't cause a double drop.
+        self.len = 0;
+        for chunk in self.chunks.iter_mut() {
+            let initialized = remaining.min(chunk.len());
+            remaining -= initialized;
+            unsafe {
+                core::ptr::drop_in_place(core::ptr::slice_from_raw_parts_mut(
+                    chunk.as_mut_ptr().cast::<T>(),
+                    initialized,
+                ));
+            }
+        }
+    }
+}
+
 #[doc(hidden)]
 pub mod macro_internal {
     use super::*;
@@ -704,8 +973,12 @@ pub mod macro_internal {
     /// struct is completely initialized, the drop guards can be forgotten
     /// with `std::mem::forget()`. See the `ctor!` macro, where this is used.
     ///
+    /// The drop guard has a concrete type that only depends on the type of the
+    /// field, so that the guards of a `ctor!` expansion don't add an opaque
+    /// type per field and sub-`Ctor`.
+    ///
     /// Safety: the field must satisfy the Pin guarantee.
-    pub unsafe fn init_field<T>(field: *mut T, ctor: impl Ctor<Output = T>) -> impl Drop {
+    pub unsafe fn init_field<T>(field: *mut T, ctor: impl Ctor<Output = T>) -> UnsafeDropGuard<T> {
         // safety: MaybeUninit<T> is the same layout as T, the caller guarantees it's
         // pinned.
         let maybe_uninit = field as *mut MaybeUninit<T>;
@@ -1701,6 +1974,33 @@ mod test {
         assert_eq!(*x, 42);
     }
 
+    #[test]
+    fn test_ctor_then_assign() {
+        let src = 42;
+        emplace! {
+            let x = <i32 as CtorNew<()>>::ctor_new(()).ctor_then_assign(&src);
+        }
+        assert_eq!(*x, 42);
+    }
+
+    #[test]
+    fn test_ctor_then_assign_nonunpin() {
+        #[derive(Default)]
+        struct Assigned {
+            value: i32,
+            _pin: core::marker::PhantomPinned,
+        }
+        impl Assign<i32> for Assigned {
+            fn assign(self: Pin<&mut Self>, src: i32) {
+                unsafe { Pin::into_inner_unchecked(self) }.value = src * 2;
+            }
+        }
+        emplace! {
+            let x = RustMoveCtor(Assigned::default()).ctor_then_assign(21);
+        }
+        assert_eq!(x.value, 42);
+    }
+
     /// Test that a slot can be created in a temporary.
     #[test]
     fn test_slot_temporary() {
@@ -1741,6 +2041,86 @@ mod test {
         assert_eq!(*slot.as_opt().unwrap(), 42);
     }
 
+    #[test]
+    fn test_slot_vec() {
+        let mut slots = SlotVec::<u32>::new(100);
+        assert_eq!(slots.len(), 100);
+        assert_eq!(*slots.replace(0, 1), 1);
+        assert_eq!(*slots.replace(99, 2), 2);
+        assert_eq!(*slots.replace(99, 3), 3);
+        assert_eq!(slots.as_opt(0), Some(&1));
+        assert_eq!(slots.as_opt(1), None);
+        assert_eq!(slots.as_opt(99), Some(&3));
+        slots.clear(0);
+        assert!(!slots.is_initialized(0));
+        assert!(slots.as_opt_mut(0).is_none());
+    }
+
+    #[test]
+    fn test_slot_vec_output_buffer() {
+        let mut slots = SlotVec::<u32>::new(3);
+        // Fill the slots as a C++ function with an output array would.
+        let buffer = slots.as_mut_ptr();
+        for i in 0..3 {
+            unsafe {
+                buffer.add(i).write(i as u32 * 10);
+                slots.assume_init(i);
+            }
+        }
+        assert_eq!(slots.as_opt(2), Some(&20));
+    }
+
+    #[test]
+    fn test_pinned_vec() {
+        let mut v = PinnedVec::new();
+        assert!(v.is_empty());
+        let mut addresses = vec![];
+        for i in 0..1000 {
+            let value = v.emplace(i);
+            addresses.push(&*value as *const i32);
+        }
+        assert_eq!(v.len(), 1000);
+        for i in 0..1000 {
+            assert_eq!(v[i], i as i32);
+            // Emplacing more objects didn't move the earlier ones.
+            assert_eq!(v.get(i).unwrap() as *const i32, addresses[i]);
+        }
+        assert_eq!(v.get(1000), None);
+        *v.get_mut(3).unwrap() = 42;
+        assert_eq!(v.iter().nth(3), Some(&42));
+    }
+
+    #[test]
+    fn test_pinned_vec_drop() {
+        let drops = RefCell::new(vec![]);
+        struct RecordsDrop<'a>(&'a RefCell<Vec<i32>>, i32);
+        impl Drop for RecordsDrop<'_> {
+            fn drop(&mut self) {
+                self.0.borrow_mut().push(self.1);
+            }
+        }
+        {
+            let mut v = PinnedVec::new();
+            for i in 0..20 {
+                v.emplace(RecordsDrop(&drops, i));
+            }
+        }
+        assert_eq!(*drops.borrow(), (0..20).collect::<Vec<_>>());
+    }
+
+    #[test]
+    fn test_slot_vec_drop() {
+        let rc = std::rc::Rc::new(());
+        {
+            let mut slots = SlotVec::new(70);
+            slots.replace(3, rc.clone());
+            slots.replace(65, rc.clone());
+            slots.replace(65, rc.clone());
+            assert_eq!(std::rc::Rc::strong_count(&rc), 3);
+        }
+        assert_eq!(std::rc::Rc::strong_count(&rc), 1);
+    }
+
     #[test]
     fn test_ctor_trait_captures() {
         fn adder<'a, 'b>(
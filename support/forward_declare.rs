@@ -135,9 +135,12 @@
 //! forward-declared type can be cast to a slice of references to a
 //! fully-defined type):
 //!
-//!   * Slices - `&[T]`
+//!   * Slices - `&[T]`, `&mut [T]`, `Pin<&mut [T]>`
 //!   * Arrays - `[T; N]`
 //!   * `Vec<T>`
+//!
+//! None of these casts visit the elements or allocate: they only reinterpret
+//! the pointer (and length, and capacity).
 //!   * TODO: Add support for more containers as needed (HashSet?  bindings for
 //!     std::vector?)
 //!
@@ -575,13 +578,23 @@ where
     }
 }
 
-impl<'a, T: ?Sized, U: ?Sized> CcCast<Vec<&'a U>> for Vec<&'a T>
+/// Casts the elements of a `Vec` in place, without reallocating or visiting
+/// them. This covers e.g. `Vec<&T>`, `Vec<Pin<&mut T>>`, and `Vec` of
+/// complete types.
+///
+/// # Safety notes
+///
+/// `T` and `U` are transmutable, so they have the same size and alignment, and
+/// the allocation of a `Vec<T>` is also a valid allocation of a `Vec<U>`.
+impl<T, U> CcCast<Vec<U>> for Vec<T>
 where
     T: CcType,
     U: CcType<Name = T::Name>,
 {
-    fn cc_cast(self) -> Vec<&'a U> {
+    fn cc_cast(self) -> Vec<U> {
+        assert_eq!(std::mem::size_of::<T>(), std::mem::size_of::<U>());
+        assert_eq!(std::mem::align_of::<T>(), std::mem::align_of::<U>());
         let (p, len, capacity) = self.into_raw_parts();
-        unsafe { Vec::from_raw_parts(p as *mut &'a U, len, capacity) }
+        unsafe { Vec::from_raw_parts(p as *mut U, len, capacity) }
     }
 }
@@ -107,6 +107,39 @@ fn test_conversions() {
         assert_eq!(slice_location(&complete_vec), loc);
     }
 
+    // Vec<Pin<&mut>> <-> Vec<Pin<&mut>>
+    {
+        let complete_vec: Vec<::std::pin::Pin<&mut MyType>> =
+            vec![::std::pin::Pin::new(&mut complete)];
+        let loc = slice_location(&complete_vec);
+
+        let incomplete_vec: Vec<::std::pin::Pin<&mut MyTypeIncomplete>> = complete_vec.cc_cast();
+        assert_eq!(slice_location(&incomplete_vec), loc);
+        let complete_vec: Vec<::std::pin::Pin<&mut MyType>> = incomplete_vec.cc_cast();
+        assert_eq!(slice_location(&complete_vec), loc);
+    }
+
+    // Vec<complete> <-> Vec<complete>, e.g. of two identical template instantiations.
+    {
+        struct MyTypeCopy;
+        ::forward_declare::unsafe_define!(MyTypeSymbol, MyTypeCopy);
+        let complete_vec: Vec<MyType> = vec![MyType, MyType];
+        let copy_vec: Vec<MyTypeCopy> = complete_vec.cc_cast();
+        assert_eq!(copy_vec.len(), 2);
+    }
+
+    // &mut [&] <-> &mut [&]
+    {
+        let mut complete_vec: Vec<&MyType> = vec![&complete];
+        let complete_slice: &mut [&MyType] = complete_vec.as_mut_slice();
+        let loc = slice_location(complete_slice);
+
+        let incomplete_slice: &mut [&MyTypeIncomplete] = complete_slice.cc_cast();
+        assert_eq!(slice_location(incomplete_slice), loc);
+        let complete_slice: &mut [&MyType] = incomplete_slice.cc_cast();
+        assert_eq!(slice_location(complete_slice), loc);
+    }
+
     // &[&] <-> &[&]
     {
         let complete_vec: Vec<&MyType> = vec![&complete];
@@ -71,4 +71,107 @@
 #define CRUBIT_INTERNAL_SAME_ABI \
   CRUBIT_INTERNAL_ANNOTATE("crubit_internal_same_abi")
 
+// Unsafe: forces a type to be treated as trivially relocatable.
+//
+// A trivially relocatable type can be moved to a new location by copying its
+// bytes (e.g. with `memcpy`) and forgetting the original object, without
+// calling its move constructor or destructor. Together with `final`, this
+// makes the Rust bindings for the type `Unpin`: Rust code can then own,
+// move, and swap values of the type, and mutate them through `&mut`, without
+// `Pin` or `ctor::emplace!`. (See docs/unpin.md.)
+//
+// This is only useful for types which Crubit can't already prove to be
+// trivially relocatable, such as types whose move constructor and destructor
+// are user-defined, but which don't store pointers to themselves. The type is
+// still passed to C++ functions indirectly.
+//
+// For example:
+//
+// ```c++
+// struct CRUBIT_INTERNAL_TRIVIALLY_RELOCATABLE Buffer final {
+//   Buffer(Buffer&& other) : data(std::exchange(other.data, nullptr)) {}
+//   ~Buffer() { delete[] data; }
+//   char* data;
+// };
+// ```
+//
+// SAFETY:
+//   If a `memcpy` followed by forgetting the source object isn't equivalent to
+//   a move construction followed by destroying the source object, the
+//   behavior is undefined.
+#define CRUBIT_INTERNAL_TRIVIALLY_RELOCATABLE \
+  CRUBIT_INTERNAL_ANNOTATE("crubit_internal_trivially_relocatable")
+
+// Unsafe: makes the Rust bindings for a type `Send` and `Sync`.
+//
+// Objects of a thread-safe type can be used from several threads at the same
+// time, and can be used and destroyed on threads other than the one that
+// created them. Rust code can then share the objects between threads (e.g. by
+// reference from `rayon` tasks, or in an `Arc`) without wrapping them in a
+// `Mutex`.
+//
+// Rust only calls non-const member functions of a type through exclusive
+// (`&mut` or `Pin<&mut>`) references, so it is enough that the const member
+// functions can be called concurrently. Without an annotation, the bindings
+// are only `Send` or `Sync` if Rust infers so from the fields.
+//
+// For example:
+//
+// ```c++
+// class CRUBIT_INTERNAL_THREAD_SAFE Counter final {
+//  public:
+//   void Increment() const { value_.fetch_add(1); }
+//
+//  private:
+//   mutable std::atomic<int> value_;
+// };
+// ```
+//
+// SAFETY:
+//   If the const member functions of the type (or the functions that take it
+//   by const reference) can't be called from multiple threads at the same time,
+//   or if an object can't be destroyed on another thread, the behavior is
+//   undefined.
+#define CRUBIT_INTERNAL_THREAD_SAFE \
+  CRUBIT_INTERNAL_ANNOTATE("crubit_internal_thread_safe")
+
+// Unsafe: makes the Rust bindings for a type `Send` and `Sync`.
+//
+// Objects of a thread-compatible type can be used and destroyed on threads
+// other than the one that created them, and their const member functions can
+// be called from several threads at the same time, while non-const member
+// functions need exclusive access. As explained for
+// CRUBIT_INTERNAL_THREAD_SAFE above, that is all that Rust needs for `Sync`,
+// since a shared `&T` only reaches the const member functions. The two
+// annotations therefore have the same effect on the bindings, and only differ
+// in what they document about the C++ type.
+//
+// SAFETY:
+//   If an object of the type can't be used or destroyed on another thread
+//   (e.g. because it uses thread-local storage), or if its const member
+//   functions can't be called from multiple threads at the same time (e.g.
+//   because they update a cache without synchronization), the behavior is
+//   undefined.
+#define CRUBIT_INTERNAL_THREAD_COMPATIBLE \
+  CRUBIT_INTERNAL_ANNOTATE("crubit_internal_thread_compatible")
+
+// Marks a C++ binding of a Rust type as `[[clang::trivial_abi]]`.
+//
+// All Rust types are movable with `memcpy`, so the C++ bindings generated by
+// `cc_bindings_from_rs` are trivially relocatable even when they have a
+// user-provided move constructor or destructor (e.g. because of a Rust `Drop`
+// impl). With this attribute, Clang knows that too: containers like
+// `std::vector` relocate the objects with `memcpy` instead of calling their
+// move constructors and destructors one by one, and the objects are passed in
+// registers where the ABI allows it.
+//
+// SAFETY:
+//   The type must be trivially relocatable (see
+//   CRUBIT_INTERNAL_TRIVIALLY_RELOCATABLE above).
+#if ABSL_HAVE_CPP_ATTRIBUTE(clang::trivial_abi)
+#define CRUBIT_INTERNAL_TRIVIAL_ABI [[clang::trivial_abi]]
+#else
+#define CRUBIT_INTERNAL_TRIVIAL_ABI
+#endif
+
 #endif  // CRUBIT_SUPPORT_INTERNAL_ATTRIBUTES_H_
@@ -0,0 +1,50 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_SUPPORT_INTERNAL_INIT_IN_PLACE_H_
+#define CRUBIT_SUPPORT_INTERNAL_INIT_IN_PLACE_H_
+
+// This header is included by the bindings of every Rust ADT, so it
+// deliberately doesn't include any other headers.
+
+namespace crubit {
+
+// `InitInPlaceTag` selects a constructor that lets a Rust thunk initialize the
+// object under construction directly.  `cc_bindings_from_rs` generates such a
+// constructor for every Rust ADT:
+//
+//     ```cc
+//     struct SomeStruct final {
+//       template <typename F>
+//       explicit SomeStruct(crubit::InitInPlaceTag, F init) {
+//         init(this);
+//       }
+//       ...
+//     };
+//
+//     inline SomeStruct foo(int32_t arg1, int32_t arg2) {
+//       return SomeStruct(crubit::InitInPlaceTag{},
+//                         [&](SomeStruct* __ret_ptr) {
+//                           __rust_thunk_for_foo(arg1, arg2, __ret_ptr);
+//                         });
+//     }
+//     ```
+//
+// Because `foo` returns a prvalue, C++17 guaranteed copy elision constructs
+// the result directly in the caller's storage, and so the Rust thunk writes
+// the return value there without any C++ move constructor (or destructor of a
+// moved-from value) running afterwards.  This matches the semantics of
+// returning by value in Rust.
+//
+// SAFETY REQUIREMENTS: The constructor must not initialize any of the fields
+// of the object (the fields of Rust ADTs are wrapped in anonymous unions, or
+// are arrays of bytes, so this holds for the generated bindings), and `init`
+// must fully initialize `*this` before returning.
+struct InitInPlaceTag {
+  explicit InitInPlaceTag() = default;
+};
+
+}  // namespace crubit
+
+#endif  // CRUBIT_SUPPORT_INTERNAL_INIT_IN_PLACE_H_
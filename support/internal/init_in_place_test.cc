@@ -0,0 +1,49 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "support/internal/init_in_place.h"
+
+#include "gtest/gtest.h"
+
+namespace crubit {
+namespace {
+
+// Mimics the shape of the C++ bindings that `cc_bindings_from_rs` generates
+// for a Rust ADT.  The move constructor is deleted to verify (at compile time)
+// that `InitInPlaceTag` constructors don't require moving the return value.
+struct InitInPlaceHelper final {
+  template <typename F>
+  explicit InitInPlaceHelper(InitInPlaceTag, F init) {
+    init(this);
+  }
+  InitInPlaceHelper(InitInPlaceHelper&&) = delete;
+  InitInPlaceHelper(const InitInPlaceHelper&) = delete;
+
+  union {
+    int value;
+  };
+};
+
+// Stands in for a Rust thunk that writes the return value through a pointer.
+void WriteReturnValue(int value, InitInPlaceHelper** init_ptr,
+                      InitInPlaceHelper* ret_ptr) {
+  *init_ptr = ret_ptr;
+  ret_ptr->value = value;
+}
+
+InitInPlaceHelper ReturnByValue(int value, InitInPlaceHelper** init_ptr) {
+  return InitInPlaceHelper(InitInPlaceTag{}, [&](InitInPlaceHelper* ret_ptr) {
+    WriteReturnValue(value, init_ptr, ret_ptr);
+  });
+}
+
+TEST(InitInPlaceTag, InitializesTheCallersObject) {
+  InitInPlaceHelper* init_ptr = nullptr;
+  InitInPlaceHelper result = ReturnByValue(123, &init_ptr);
+  EXPECT_EQ(init_ptr, &result);
+  EXPECT_EQ(result.value, 123);
+}
+
+}  // namespace
+}  // namespace crubit
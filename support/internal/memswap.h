@@ -5,18 +5,47 @@
 #ifndef THIRD_PARTY_CRUBIT_SUPPORT_INTERNAL_MEMSWAP_H_
 #define THIRD_PARTY_CRUBIT_SUPPORT_INTERNAL_MEMSWAP_H_
 
+#include <cstddef>
 #include <cstring>
 
 #include "absl/base/optimization.h"
 
 namespace crubit {
 
+namespace internal {
+
+// The size of the chunks that `MemSwap` swaps at a time.  Big enough to
+// vectorize well, small enough to not use much stack and to stay in L1.
+inline constexpr std::size_t kMemSwapChunkSize = 256;
+
+// Swaps the `Size` bytes at `a` and `b` (which must not overlap), a chunk at a
+// time.
+template <std::size_t Size>
+void MemSwapChunked(unsigned char* a, unsigned char* b) {
+  unsigned char tmp[kMemSwapChunkSize];
+  std::size_t offset = 0;
+  for (; offset + kMemSwapChunkSize <= Size; offset += kMemSwapChunkSize) {
+    std::memcpy(tmp, a + offset, kMemSwapChunkSize);
+    std::memcpy(a + offset, b + offset, kMemSwapChunkSize);
+    std::memcpy(b + offset, tmp, kMemSwapChunkSize);
+  }
+  constexpr std::size_t kRemainder = Size % kMemSwapChunkSize;
+  if constexpr (kRemainder > 0) {
+    std::memcpy(tmp, a + offset, kRemainder);
+    std::memcpy(a + offset, b + offset, kRemainder);
+    std::memcpy(b + offset, tmp, kRemainder);
+  }
+}
+
+}  // namespace internal
+
 // Like `std::swap`, but the implementation is guaranteed to have no
 // dependencies on `T`-specific code (e.g. it does *not* call into
 // `T::operator=`).
 //
 // SAFETY REQUIREMENTS: Should only be called on `[[clang::trivial_abi]]` (aka
-// `std::is_trivially_relocatable`) types.
+// `std::is_trivially_relocatable`) types, or on types annotated with
+// `CRUBIT_INTERNAL_TRIVIALLY_RELOCATABLE`.
 // TODO(b/290992400): Enforce these safety requirements via
 // `static_assert(absl::is_trivially_relocatable<T>::value);`.
 template <typename T>
@@ -25,10 +54,17 @@ void MemSwap(T& a, T& b) {
     return;
   }
 
-  char tmp[sizeof(T)];
-  std::memcpy(tmp, &a, sizeof(T));
-  std::memcpy(&a, &b, sizeof(T));
-  std::memcpy(&b, tmp, sizeof(T));
+  if constexpr (sizeof(T) <= internal::kMemSwapChunkSize) {
+    char tmp[sizeof(T)];
+    std::memcpy(tmp, &a, sizeof(T));
+    std::memcpy(&a, &b, sizeof(T));
+    std::memcpy(&b, tmp, sizeof(T));
+  } else {
+    // Large types are swapped a chunk at a time, so that the temporary stays
+    // small and each chunk is still in cache when it is copied back.
+    internal::MemSwapChunked<sizeof(T)>(reinterpret_cast<unsigned char*>(&a),
+                                        reinterpret_cast<unsigned char*>(&b));
+  }
 }
 
 }  // namespace crubit
@@ -0,0 +1,72 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+// Microbenchmark of `crubit::MemSwap` against `std::swap`, for a range of
+// sizes.
+//
+// Prints the average time per swap, e.g.:
+//
+//   bazel test -c opt --test_output=all \
+//       //support/internal:memswap_benchmark
+
+#include <chrono>  // NOLINT(build/c++11)
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <utility>
+
+#include "gtest/gtest.h"
+#include "support/internal/memswap.h"
+
+namespace crubit {
+namespace {
+
+constexpr std::int32_t kSwaps = 100'000;
+
+template <int N>
+struct Bytes {
+  unsigned char bytes[N];
+};
+
+// Swaps two `Bytes<N>` with `swap` `kSwaps` times, and prints the average
+// time per swap.
+template <int N, typename Swap>
+void ReportTimePerSwap(const char* name, Swap swap) {
+  // Heap-allocated, so that large sizes don't overflow the stack.
+  auto a = std::make_unique<Bytes<N>>();
+  auto b = std::make_unique<Bytes<N>>();
+  auto start = std::chrono::steady_clock::now();
+  for (std::int32_t i = 0; i < kSwaps; ++i) {
+    swap(*a, *b);
+    // Keeps the compiler from optimizing pairs of swaps away.
+    asm volatile("" : : "r"(a.get()), "r"(b.get()) : "memory");
+  }
+  std::chrono::duration<double, std::nano> elapsed =
+      std::chrono::steady_clock::now() - start;
+  std::cout << name << " (" << N << " bytes): " << elapsed.count() / kSwaps
+            << " ns/swap\n";
+}
+
+template <int N>
+void ReportSize() {
+  ReportTimePerSwap<N>("crubit::MemSwap",
+                       [](Bytes<N>& a, Bytes<N>& b) { MemSwap(a, b); });
+  ReportTimePerSwap<N>("std::swap",
+                       [](Bytes<N>& a, Bytes<N>& b) { std::swap(a, b); });
+}
+
+TEST(MemSwapBenchmark, Small) {
+  ReportSize<8>();
+  ReportSize<64>();
+  ReportSize<256>();
+}
+
+TEST(MemSwapBenchmark, Large) {
+  ReportSize<1024>();
+  ReportSize<16 * 1024>();
+  ReportSize<256 * 1024>();
+}
+
+}  // namespace
+}  // namespace crubit
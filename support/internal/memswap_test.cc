@@ -23,4 +23,40 @@ TEST(MemSwapTest, Aliasing) {
   EXPECT_EQ(a, 123);
 }
 
+template <int N>
+struct Bytes {
+  unsigned char bytes[N];
+};
+
+template <int N>
+void TestSwapsAllBytes() {
+  Bytes<N> a, b;
+  for (int i = 0; i < N; ++i) {
+    a.bytes[i] = i % 251;
+    b.bytes[i] = 250 - i % 251;
+  }
+  crubit::MemSwap(a, b);
+  for (int i = 0; i < N; ++i) {
+    ASSERT_EQ(a.bytes[i], 250 - i % 251) << "N=" << N << ", i=" << i;
+    ASSERT_EQ(b.bytes[i], i % 251) << "N=" << N << ", i=" << i;
+  }
+}
+
+// Sizes around and above the chunk size, with and without a remainder.
+TEST(MemSwapTest, LargeTypes) {
+  TestSwapsAllBytes<255>();
+  TestSwapsAllBytes<256>();
+  TestSwapsAllBytes<257>();
+  TestSwapsAllBytes<512>();
+  TestSwapsAllBytes<1000>();
+  TestSwapsAllBytes<16 * 1024 + 3>();
+}
+
+TEST(MemSwapTest, LargeTypeAliasing) {
+  Bytes<1000> a;
+  for (int i = 0; i < 1000; ++i) a.bytes[i] = i % 251;
+  crubit::MemSwap(a, a);
+  for (int i = 0; i < 1000; ++i) ASSERT_EQ(a.bytes[i], i % 251);
+}
+
 }  // namespace
@@ -47,7 +47,8 @@ namespace crubit {
 // Behavior of `ReturnValueSlot<T>` in steps 1 and 2 is identical to
 // `MaybeUninit<T>` in Rust, but the behavior on line 3 is a bit different:
 // there is an extra call to a move constructor in C++, but there are no move
-// constructors in Rust.
+// constructors in Rust.  The bindings generated by `cc_bindings_from_rs` avoid
+// this extra move by using `InitInPlaceTag` (see init_in_place.h) instead.
 template <typename T>
 class ReturnValueSlot {
  public:
@@ -0,0 +1,63 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_SUPPORT_RS_STD_BOX_H_
+#define CRUBIT_SUPPORT_RS_STD_BOX_H_
+
+namespace rs_std {
+
+// `rs_std::Box<T>` owns a Rust `Box<T>` returned by a Rust function.  The
+// pointee stays in the Rust allocation, where it is accessed in place, and it
+// is dropped (by a single call into Rust) when the `Box` is destroyed.
+//
+// Like a `std::unique_ptr<T>`, a `Box` can be moved but not copied.  Unlike a
+// Rust `Box<T>`, a moved-from `Box` holds a null pointer.
+template <typename T>
+class Box final {
+ public:
+  // Drops the Rust `Box<T>` pointing to `ptr` (and the pointee).
+  using DropFn = void (*)(T* ptr);
+
+  // The raw parts of a Rust `Box<T>`, with the same layout as
+  // `rs_std_owned::RawBox<T>` (see `owned.rs`).
+  struct RawParts {
+    T* ptr;
+    DropFn drop;
+  };
+
+  // Takes ownership of the Rust `Box<T>` with the raw parts `raw`.  Only meant
+  // to be called by the generated bindings, which get `raw` from Rust.
+  explicit Box(RawParts raw) : raw_(raw) {}
+
+  Box(const Box&) = delete;
+  Box& operator=(const Box&) = delete;
+
+  Box(Box&& other) noexcept : raw_(other.raw_) { other.raw_ = RawParts{}; }
+  Box& operator=(Box&& other) noexcept {
+    if (this != &other) {
+      Drop();
+      raw_ = other.raw_;
+      other.raw_ = RawParts{};
+    }
+    return *this;
+  }
+
+  ~Box() { Drop(); }
+
+  T* get() const { return raw_.ptr; }
+  T& operator*() const { return *raw_.ptr; }
+  T* operator->() const { return raw_.ptr; }
+
+ private:
+  void Drop() {
+    if (raw_.drop != nullptr) raw_.drop(raw_.ptr);
+    raw_ = RawParts{};
+  }
+
+  RawParts raw_;
+};
+
+}  // namespace rs_std
+
+#endif  // CRUBIT_SUPPORT_RS_STD_BOX_H_
@@ -0,0 +1,56 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "support/rs_std/box.h"
+
+#include <type_traits>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+struct Point {
+  int x;
+  int y;
+  int num_drop_calls = 0;
+};
+
+using Box = rs_std::Box<Point>;
+
+static_assert(!std::is_copy_constructible_v<Box>);
+static_assert(std::is_nothrow_move_constructible_v<Box>);
+static_assert(std::is_nothrow_move_assignable_v<Box>);
+
+void Drop(Point* point) { ++point->num_drop_calls; }
+
+TEST(BoxTest, AccessesThePointeeInPlace) {
+  Point point = {1, 2};
+  {
+    Box box(Box::RawParts{&point, Drop});
+    EXPECT_EQ(&point, box.get());
+    EXPECT_EQ(1, box->x);
+    (*box).y = 42;
+    EXPECT_EQ(42, point.y);
+  }
+  EXPECT_EQ(1, point.num_drop_calls);
+}
+
+TEST(BoxTest, DropsOnce) {
+  Point point = {1, 2};
+  Point other_point = {3, 4};
+  {
+    Box box(Box::RawParts{&point, Drop});
+    Box moved = std::move(box);
+    EXPECT_EQ(nullptr, box.get());  // NOLINT(bugprone-use-after-move)
+    EXPECT_EQ(0, point.num_drop_calls);
+
+    moved = Box(Box::RawParts{&other_point, Drop});
+    EXPECT_EQ(1, point.num_drop_calls);
+  }
+  EXPECT_EQ(1, point.num_drop_calls);
+  EXPECT_EQ(1, other_point.num_drop_calls);
+}
+
+}  // namespace
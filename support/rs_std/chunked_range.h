@@ -0,0 +1,163 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_SUPPORT_RS_STD_CHUNKED_RANGE_H_
+#define CRUBIT_SUPPORT_RS_STD_CHUNKED_RANGE_H_
+
+#include <cstddef>
+#include <cstring>
+#include <iterator>
+#include <new>
+#include <type_traits>
+
+namespace rs_std {
+
+// `rs_std::ChunkedRange<T>` is a C++ input range over the items of a Rust
+// `impl Iterator<Item = T>`.  The C++ bindings of Rust functions that return
+// such an iterator return a `ChunkedRange<T>` that owns the Rust iterator, and
+// drops it when destroyed.
+//
+// Rather than calling into Rust once per item, the range pulls up to
+// `kChunkSize` items at a time into a fixed buffer inside the range, through a
+// single call of the `next_chunk` function that came with the Rust iterator.
+// A chunk with fewer items than requested ends the range: `ChunkedRange` never
+// calls `next_chunk` again after that, even if the Rust iterator isn't fused.
+//
+// Like other input ranges, a `ChunkedRange` can only be iterated once, and
+// advancing any of its iterators advances all of them.
+template <typename T>
+class ChunkedRange final {
+  // Rust writes the items into the buffer by copying their bytes.
+  static_assert(std::is_trivially_copyable_v<T>);
+
+ public:
+  // The number of items pulled from Rust at a time.
+  static constexpr std::size_t kChunkSize =
+      sizeof(T) >= 512 ? 1 : 512 / sizeof(T);
+
+  // Writes up to `capacity` items of the Rust iterator `iter` to `out`, and
+  // returns the number of items written.
+  using NextChunkFn = std::size_t (*)(void* iter, T* out,
+                                      std::size_t capacity);
+
+  // Drops the Rust iterator `iter`.
+  using DropFn = void (*)(void* iter);
+
+  class Sentinel final {};
+
+  class Iterator final {
+   public:
+    using iterator_category = std::input_iterator_tag;
+    using value_type = T;
+    using difference_type = std::ptrdiff_t;
+    using pointer = const T*;
+    using reference = const T&;
+
+    const T& operator*() const { return range_->buffer()[range_->pos_]; }
+    const T* operator->() const { return &**this; }
+
+    Iterator& operator++() {
+      range_->Advance();
+      return *this;
+    }
+    void operator++(int) { ++*this; }
+
+    friend bool operator==(const Iterator& it, Sentinel) {
+      return it.AtEnd();
+    }
+    friend bool operator!=(const Iterator& it, Sentinel) {
+      return !it.AtEnd();
+    }
+    friend bool operator==(Sentinel, const Iterator& it) {
+      return it.AtEnd();
+    }
+    friend bool operator!=(Sentinel, const Iterator& it) {
+      return !it.AtEnd();
+    }
+
+   private:
+    friend class ChunkedRange;
+    explicit Iterator(ChunkedRange* range) : range_(range) {}
+
+    bool AtEnd() const { return range_->AtEnd(); }
+
+    ChunkedRange* range_;
+  };
+
+  // Takes ownership of the Rust iterator `iter`.  Only meant to be called by
+  // the generated bindings, which get all three arguments from Rust.
+  ChunkedRange(void* iter, NextChunkFn next_chunk, DropFn drop)
+      : iter_(iter), next_chunk_(next_chunk), drop_(drop) {}
+
+  ChunkedRange(const ChunkedRange&) = delete;
+  ChunkedRange& operator=(const ChunkedRange&) = delete;
+
+  ChunkedRange(ChunkedRange&& other) noexcept { MoveFrom(other); }
+  ChunkedRange& operator=(ChunkedRange&& other) noexcept {
+    if (this != &other) {
+      Drop();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  ~ChunkedRange() { Drop(); }
+
+  // Pulls the first chunk, unless that has already happened.
+  Iterator begin() {
+    if (pos_ == len_ && !done_) Refill();
+    return Iterator(this);
+  }
+  Sentinel end() { return Sentinel(); }
+
+ private:
+  T* buffer() { return std::launder(reinterpret_cast<T*>(storage_)); }
+
+  bool AtEnd() const { return pos_ == len_; }
+
+  void Advance() {
+    ++pos_;
+    if (pos_ == len_ && !done_) Refill();
+  }
+
+  void Refill() {
+    len_ = iter_ == nullptr ? 0 : next_chunk_(iter_, buffer(), kChunkSize);
+    pos_ = 0;
+    done_ = len_ < kChunkSize;
+  }
+
+  void Drop() {
+    if (iter_ != nullptr) drop_(iter_);
+    iter_ = nullptr;
+  }
+
+  // Leaves `other` empty.
+  void MoveFrom(ChunkedRange& other) {
+    iter_ = other.iter_;
+    next_chunk_ = other.next_chunk_;
+    drop_ = other.drop_;
+    pos_ = other.pos_;
+    len_ = other.len_;
+    done_ = other.done_;
+    std::memcpy(storage_, other.storage_, len_ * sizeof(T));
+    other.iter_ = nullptr;
+    other.pos_ = 0;
+    other.len_ = 0;
+    other.done_ = true;
+  }
+
+  void* iter_ = nullptr;
+  NextChunkFn next_chunk_ = nullptr;
+  DropFn drop_ = nullptr;
+  // The items `[pos_, len_)` of the buffer haven't been visited yet.
+  std::size_t pos_ = 0;
+  std::size_t len_ = 0;
+  // Whether the Rust iterator has no more items.
+  bool done_ = false;
+  alignas(T) unsigned char storage_[kChunkSize * sizeof(T)];
+};
+
+}  // namespace rs_std
+
+#endif  // CRUBIT_SUPPORT_RS_STD_CHUNKED_RANGE_H_
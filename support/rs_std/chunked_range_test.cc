@@ -0,0 +1,117 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "support/rs_std/chunked_range.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+using Range = rs_std::ChunkedRange<std::int32_t>;
+
+static_assert(!std::is_copy_constructible_v<Range>);
+static_assert(std::is_nothrow_move_constructible_v<Range>);
+static_assert(std::is_nothrow_move_assignable_v<Range>);
+
+// Stands in for a Rust iterator over `0..end`.
+struct Counter {
+  explicit Counter(std::int32_t end) : end(end) {}
+
+  std::int32_t next = 0;
+  std::int32_t end;
+  int num_next_chunk_calls = 0;
+  int num_drop_calls = 0;
+};
+
+std::size_t NextChunk(void* iter, std::int32_t* out, std::size_t capacity) {
+  Counter& counter = *static_cast<Counter*>(iter);
+  ++counter.num_next_chunk_calls;
+  std::size_t len = 0;
+  while (len < capacity && counter.next < counter.end) {
+    out[len++] = counter.next++;
+  }
+  return len;
+}
+
+void Drop(void* iter) { ++static_cast<Counter*>(iter)->num_drop_calls; }
+
+std::vector<std::int32_t> Collect(Range& range) {
+  std::vector<std::int32_t> result;
+  for (std::int32_t item : range) result.push_back(item);
+  return result;
+}
+
+std::vector<std::int32_t> Iota(std::int32_t end) {
+  std::vector<std::int32_t> result;
+  for (std::int32_t i = 0; i < end; ++i) result.push_back(i);
+  return result;
+}
+
+TEST(ChunkedRangeTest, Empty) {
+  Counter counter(0);
+  {
+    Range range(&counter, NextChunk, Drop);
+    EXPECT_TRUE(Collect(range).empty());
+    EXPECT_EQ(1, counter.num_next_chunk_calls);
+  }
+  EXPECT_EQ(1, counter.num_drop_calls);
+}
+
+TEST(ChunkedRangeTest, PullsOneChunkPerCall) {
+  constexpr std::int32_t kEnd = 3 * Range::kChunkSize + 1;
+  Counter counter(kEnd);
+  {
+    Range range(&counter, NextChunk, Drop);
+    EXPECT_EQ(Iota(kEnd), Collect(range));
+    EXPECT_EQ(4, counter.num_next_chunk_calls);
+  }
+  EXPECT_EQ(1, counter.num_drop_calls);
+}
+
+TEST(ChunkedRangeTest, FullLastChunk) {
+  constexpr std::int32_t kEnd = 2 * Range::kChunkSize;
+  Counter counter(kEnd);
+  Range range(&counter, NextChunk, Drop);
+  EXPECT_EQ(Iota(kEnd), Collect(range));
+  // The end is only known after an empty chunk.
+  EXPECT_EQ(3, counter.num_next_chunk_calls);
+
+  // The range is exhausted, and doesn't call into the iterator again.
+  EXPECT_TRUE(Collect(range).empty());
+  EXPECT_EQ(3, counter.num_next_chunk_calls);
+}
+
+TEST(ChunkedRangeTest, MoveKeepsTheRemainingItems) {
+  Counter counter(10);
+  Range range(&counter, NextChunk, Drop);
+  auto it = range.begin();
+  EXPECT_EQ(0, *it);
+  ++it;
+  EXPECT_EQ(1, *it);
+
+  Range moved = std::move(range);
+  EXPECT_EQ(std::vector<std::int32_t>({1, 2, 3, 4, 5, 6, 7, 8, 9}),
+            Collect(moved));
+  EXPECT_TRUE(Collect(range).empty());  // NOLINT(bugprone-use-after-move)
+  EXPECT_EQ(1, counter.num_next_chunk_calls);
+  EXPECT_EQ(0, counter.num_drop_calls);
+}
+
+TEST(ChunkedRangeTest, MoveAssignmentDropsTheOldIterator) {
+  Counter old_counter(1);
+  Counter new_counter(2);
+  Range range(&old_counter, NextChunk, Drop);
+  range = Range(&new_counter, NextChunk, Drop);
+  EXPECT_EQ(1, old_counter.num_drop_calls);
+  EXPECT_EQ(0, old_counter.num_next_chunk_calls);
+  EXPECT_EQ(std::vector<std::int32_t>({0, 1}), Collect(range));
+}
+
+}  // namespace
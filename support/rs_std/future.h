@@ -0,0 +1,128 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_SUPPORT_RS_STD_FUTURE_H_
+#define CRUBIT_SUPPORT_RS_STD_FUTURE_H_
+
+#include <cstring>
+#include <new>
+#include <type_traits>
+
+namespace rs_std {
+
+// `rs_std::Future<T>` is a C++20 awaitable for a Rust `impl Future<Output =
+// T>` (with `T = void` for `()`).  The C++ bindings of Rust functions that
+// return such a future (e.g. of `async fn`s) return a `Future<T>` that owns the
+// Rust future, and drops it when destroyed.
+//
+// `co_await`ing a `Future<T>` polls the Rust future on the awaiting thread.  If
+// it is pending, the coroutine is suspended without blocking the thread.  Once
+// the Rust future is woken, it is polled again on the executor thread of
+// `future.rs`, and the coroutine is resumed on that thread when the future is
+// ready, so resumed coroutines should hand long-running work to threads of
+// their own.  The Rust future is never polled inside an async runtime, so it
+// must not need one (see `future.rs`).  A `Future<T>` can only be awaited
+// once, and it can't be destroyed while its completion would resume the
+// awaiting coroutine.
+//
+// This header doesn't depend on `<coroutine>`, so that it can be included (by
+// the generated bindings) in C++17 translation units.
+template <typename T>
+class Future final {
+  // Rust moves the output into the buffer by copying its bytes.
+  static_assert(std::is_void_v<T> || std::is_trivially_copyable_v<T>);
+
+ public:
+  // Called by Rust when the pending future becomes ready.
+  using ReadyFn = void (*)(void* data);
+
+  // If the Rust future `future` is ready, writes its output to `out` and
+  // returns true.  Otherwise, returns false and calls `on_ready(data)` later,
+  // when the future becomes ready.
+  using PollFn = bool (*)(void* future, void* out, ReadyFn on_ready,
+                          void* data);
+
+  // Drops the Rust future `future`.
+  using DropFn = void (*)(void* future);
+
+  // Takes ownership of the Rust future `future`.  Only meant to be called by
+  // the generated bindings, which get all three arguments from Rust.
+  Future(void* future, PollFn poll, DropFn drop)
+      : future_(future), poll_(poll), drop_(drop) {}
+
+  Future(const Future&) = delete;
+  Future& operator=(const Future&) = delete;
+
+  Future(Future&& other) noexcept { MoveFrom(other); }
+  Future& operator=(Future&& other) noexcept {
+    if (this != &other) {
+      Drop();
+      MoveFrom(other);
+    }
+    return *this;
+  }
+
+  ~Future() { Drop(); }
+
+  // The awaiter interface.  `Handle` is a `std::coroutine_handle`.
+  bool await_ready() const noexcept { return false; }
+  template <typename Handle>
+  bool await_suspend(Handle handle) {
+    if (!poll_(future_, out(), &Resume<Handle>, handle.address())) {
+      // Rust may have resumed the coroutine on another thread already, so
+      // `this` can't be used anymore.
+      return true;
+    }
+    has_output_ = true;
+    return false;
+  }
+  T await_resume() {
+    if (!has_output_) {
+      // Resumed by Rust, so the future is ready.
+      poll_(future_, out(), &Ignore, nullptr);
+      has_output_ = true;
+    }
+    if constexpr (!std::is_void_v<T>) {
+      return *std::launder(reinterpret_cast<T*>(storage_));
+    }
+  }
+
+ private:
+  using Storage = std::conditional_t<std::is_void_v<T>, char, T>;
+
+  template <typename Handle>
+  static void Resume(void* address) {
+    Handle::from_address(address).resume();
+  }
+  static void Ignore(void*) {}
+
+  // Rust doesn't write `()` outputs.
+  void* out() { return std::is_void_v<T> ? nullptr : storage_; }
+
+  void Drop() {
+    if (future_ != nullptr) drop_(future_);
+    future_ = nullptr;
+  }
+
+  // Leaves `other` empty.
+  void MoveFrom(Future& other) {
+    future_ = other.future_;
+    poll_ = other.poll_;
+    drop_ = other.drop_;
+    has_output_ = other.has_output_;
+    std::memcpy(storage_, other.storage_, sizeof(storage_));
+    other.future_ = nullptr;
+  }
+
+  void* future_ = nullptr;
+  PollFn poll_ = nullptr;
+  DropFn drop_ = nullptr;
+  // Whether Rust has written the output to `storage_`.
+  bool has_output_ = false;
+  alignas(Storage) unsigned char storage_[sizeof(Storage)];
+};
+
+}  // namespace rs_std
+
+#endif  // CRUBIT_SUPPORT_RS_STD_FUTURE_H_
@@ -0,0 +1,439 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! The Rust side of `rs_std::Future<T>` (see `future.h`).
+//!
+//! The C++ bindings of a Rust function returning `impl Future<Output = T>`
+//! (e.g. of an `async fn`) box the future with `into_raw`, and hand it to C++
+//! together with `PollFn` and `DropFn` functions instantiated for its type.
+//!
+//! The future is first polled by `PollFn` on the C++ thread that `co_await`s
+//! it.  If it is pending, waking it only hands it to the executor thread of
+//! this module (started on first use), which polls it again, and once it is
+//! ready, calls the `ReadyFn` that C++ passed to `PollFn` (which resumes the
+//! awaiting C++ coroutine).  Wakers never poll the future or run C++ code
+//! themselves, so they can be called while holding locks that the future
+//! takes, or from within the I/O driver of a runtime.  No thread is blocked
+//! while waiting for the future.
+//!
+//! Neither the awaiting C++ thread nor the executor thread runs inside an async
+//! runtime, so the future must not need a runtime context to be polled: e.g. a
+//! `tokio` timer or socket would panic when polled, and the panic would abort
+//! the process at the `extern "C"` boundary.  Rust functions returning such a
+//! future to C++ should instead spawn it on their runtime, and return a
+//! runtime-independent future for its result (e.g. a oneshot receiver).
+
+use core::cell::UnsafeCell;
+use core::ffi::c_void;
+use core::future::Future;
+use core::mem::MaybeUninit;
+use core::pin::Pin;
+use core::sync::atomic::{AtomicU8, Ordering};
+use core::task::{Context, Poll, Waker};
+use std::sync::{mpsc, Arc, Mutex, OnceLock};
+use std::task::Wake;
+
+/// Called by Rust when a pending future becomes ready.
+pub type ReadyFn = unsafe extern "C" fn(data: *mut c_void);
+
+/// Polls the boxed `future`.
+///
+/// If the future is ready, moves its output to `out` (unless `out` is null,
+/// which C++ uses for `()` outputs), and returns true.  Otherwise, returns
+/// false, and arranges for `on_ready(data)` to be called exactly once when the
+/// future becomes ready - after which `PollFn` must be called again to get the
+/// output.
+pub type PollFn = unsafe extern "C" fn(
+    future: *mut c_void,
+    out: *mut c_void,
+    on_ready: ReadyFn,
+    data: *mut c_void,
+) -> bool;
+
+/// Drops the boxed `future`.  `on_ready` won't be called after that.
+pub type DropFn = unsafe extern "C" fn(future: *mut c_void);
+
+// The states of a `Task`.  `CANCELLED` is a flag, which is only combined with
+// `POLLING` and `REPOLL` while the thread polling the future finishes.
+const IDLE: u8 = 0; // Pending (or never polled), and not being polled.
+const POLLING: u8 = 1;
+const REPOLL: u8 = 2; // Woken while being polled.
+const READY: u8 = 3; // The output is stored in the task.
+const CANCELLED: u8 = 4;
+
+struct Task<F: Future> {
+    state: AtomicU8,
+    /// Only accessed by the thread that moved `state` to `POLLING`, or by C++
+    /// once `state` is `READY`.
+    inner: UnsafeCell<Inner<F>>,
+}
+
+struct Inner<F: Future> {
+    /// Never moved: it lives in the `Arc` allocation until it is dropped.
+    future: Option<F>,
+    output: Option<F::Output>,
+    on_ready: Option<(ReadyFn, *mut c_void)>,
+}
+
+// SAFETY: `Inner` is only accessed by a single thread at a time (see
+// `Task::inner`), and the future and its output may move between threads.
+unsafe impl<F: Future + Send> Send for Task<F> where F::Output: Send {}
+unsafe impl<F: Future + Send> Sync for Task<F> where F::Output: Send {}
+
+impl<F: Future + Send + 'static> Task<F>
+where
+    F::Output: Send,
+{
+    /// Polls the future until it is ready, or until it is pending and hasn't
+    /// been woken while being polled.  Returns true if it is ready.
+    ///
+    /// SAFETY: The caller must have moved `state` to `POLLING`.
+    unsafe fn run(self: &Arc<Self>) -> bool {
+        let inner = self.inner.get();
+        loop {
+            let waker = Waker::from(self.clone());
+            let future = (*inner).future.as_mut().expect("rs_std::Future polled after completion");
+            let is_ready = match Pin::new_unchecked(future).poll(&mut Context::from_waker(&waker)) {
+                Poll::Ready(output) => {
+                    (*inner).future = None;
+                    (*inner).output = Some(output);
+                    true
+                }
+                Poll::Pending => false,
+            };
+            let next_state = |state| match state {
+                POLLING | REPOLL if is_ready => Some(READY),
+                POLLING => Some(IDLE),
+                REPOLL => Some(POLLING),
+                _ => None, // Cancelled.
+            };
+            match self.state.fetch_update(Ordering::AcqRel, Ordering::Acquire, next_state) {
+                Ok(REPOLL) if !is_ready => continue,
+                Ok(_) => return is_ready,
+                Err(_) => {
+                    (*inner).future = None;
+                    (*inner).output = None;
+                    return false;
+                }
+            }
+        }
+    }
+
+    /// Implements `PollFn` (see there).
+    unsafe fn poll(
+        self: &Arc<Self>,
+        out: *mut c_void,
+        on_ready: ReadyFn,
+        data: *mut c_void,
+    ) -> bool {
+        match self.state.compare_exchange(IDLE, POLLING, Ordering::Acquire, Ordering::Acquire) {
+            Ok(_) => {
+                (*self.inner.get()).on_ready = Some((on_ready, data));
+                if !self.run() {
+                    return false;
+                }
+            }
+            Err(READY) => (),
+            Err(_) => panic!("rs_std::Future polled while it is pending"),
+        }
+        let output = (*self.inner.get()).output.take().expect("rs_std::Future awaited twice");
+        if !out.is_null() {
+            (out as *mut F::Output).write(output);
+        }
+        true
+    }
+
+    /// Implements `DropFn` (see there).
+    fn cancel(self: Arc<Self>) {
+        let state = self.state.fetch_or(CANCELLED, Ordering::AcqRel);
+        if state == IDLE || state == READY {
+            // SAFETY: Nothing is polling the future, and nothing will start to,
+            // because `state` is not `IDLE` anymore.
+            let inner = unsafe { &mut *self.inner.get() };
+            inner.future = None;
+            inner.output = None;
+        }
+        // Otherwise, the thread that is polling the future will drop it.
+    }
+}
+
+impl<F: Future + Send + 'static> Wake for Task<F>
+where
+    F::Output: Send,
+{
+    fn wake(self: Arc<Self>) {
+        self.wake_by_ref()
+    }
+
+    fn wake_by_ref(self: &Arc<Self>) {
+        let mut state = self.state.load(Ordering::Acquire);
+        loop {
+            let next_state = match state {
+                IDLE => POLLING,
+                POLLING => REPOLL,
+                _ => return,
+            };
+            match self.state.compare_exchange_weak(
+                state,
+                next_state,
+                Ordering::Acquire,
+                Ordering::Acquire,
+            ) {
+                Ok(_) => break,
+                Err(actual) => state = actual,
+            }
+        }
+        if state == POLLING {
+            return; // The thread that is polling the future will poll it again.
+        }
+        schedule(self.clone());
+    }
+}
+
+/// A task that a waker handed to the executor thread.
+trait Scheduled: Send + Sync {
+    /// Called on the executor thread.
+    fn run_scheduled(self: Arc<Self>);
+}
+
+impl<F: Future + Send + 'static> Scheduled for Task<F>
+where
+    F::Output: Send,
+{
+    fn run_scheduled(self: Arc<Self>) {
+        // SAFETY: `wake_by_ref` moved `state` to `POLLING` before scheduling the task.
+        // `on_ready` has been set by the `PollFn` call that first polled the future,
+        // which created the waker.
+        unsafe {
+            let (on_ready, data) = (*self.inner.get()).on_ready.expect("Woken before polled");
+            if self.run() {
+                // C++ is waiting for `on_ready`, and hasn't dropped the future (which
+                // would have cancelled it).
+                on_ready(data)
+            }
+        }
+    }
+}
+
+/// Hands `task` to the executor thread, which polls the woken tasks one at a
+/// time, in the order in which they were woken.
+fn schedule(task: Arc<dyn Scheduled>) {
+    static QUEUE: OnceLock<Mutex<mpsc::Sender<Arc<dyn Scheduled>>>> = OnceLock::new();
+    let queue = QUEUE.get_or_init(|| {
+        let (sender, receiver) = mpsc::channel::<Arc<dyn Scheduled>>();
+        std::thread::Builder::new()
+            .name("rs_std::Future".into())
+            .spawn(move || receiver.into_iter().for_each(Scheduled::run_scheduled))
+            .expect("Failed to start the rs_std::Future executor thread");
+        Mutex::new(sender)
+    });
+    queue.lock().unwrap().send(task).expect("The rs_std::Future executor thread has exited");
+}
+
+unsafe extern "C" fn poll_impl<F: Future + Send + 'static>(
+    future: *mut c_void,
+    out: *mut c_void,
+    on_ready: ReadyFn,
+    data: *mut c_void,
+) -> bool
+where
+    F::Output: Send,
+{
+    let task = Arc::from_raw(future as *const Task<F>);
+    let result = task.poll(out, on_ready, data);
+    core::mem::forget(task); // Still owned by C++.
+    result
+}
+
+unsafe extern "C" fn drop_impl<F: Future + Send + 'static>(future: *mut c_void)
+where
+    F::Output: Send,
+{
+    Arc::from_raw(future as *const Task<F>).cancel()
+}
+
+/// Boxes `future` for C++, and writes the functions that C++ uses to poll it
+/// and to drop it to `poll` and `drop`.
+pub fn into_raw<F: Future + Send + 'static>(
+    future: F,
+    poll: &mut MaybeUninit<PollFn>,
+    drop: &mut MaybeUninit<DropFn>,
+) -> *mut c_void
+where
+    F::Output: Send,
+{
+    poll.write(poll_impl::<F>);
+    drop.write(drop_impl::<F>);
+    let task = Task {
+        state: AtomicU8::new(IDLE),
+        inner: UnsafeCell::new(Inner { future: Some(future), output: None, on_ready: None }),
+    };
+    Arc::into_raw(Arc::new(task)) as *mut c_void
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::thread::{self, ThreadId};
+    use std::time::{Duration, Instant};
+
+    /// A future that is ready once `Channel::send` has been called, like a
+    /// oneshot channel.
+    #[derive(Default)]
+    struct Channel {
+        value: Mutex<(Option<i32>, Option<Waker>)>,
+    }
+
+    impl Channel {
+        fn send(&self, value: i32) {
+            let waker = {
+                let mut state = self.value.lock().unwrap();
+                state.0 = Some(value);
+                state.1.take()
+            };
+            if let Some(waker) = waker {
+                waker.wake();
+            }
+        }
+
+        async fn recv(self: Arc<Self>) -> i32 {
+            core::future::poll_fn(|cx| {
+                let mut state = self.value.lock().unwrap();
+                match state.0 {
+                    Some(value) => Poll::Ready(value),
+                    None => {
+                        state.1 = Some(cx.waker().clone());
+                        Poll::Pending
+                    }
+                }
+            })
+            .await
+        }
+    }
+
+    /// The `data` of each `on_ready` call, and the thread that made it.
+    static READY_CALLS: Mutex<Vec<(usize, ThreadId)>> = Mutex::new(Vec::new());
+
+    unsafe extern "C" fn on_ready(data: *mut c_void) {
+        READY_CALLS.lock().unwrap().push((data as usize, thread::current().id()));
+    }
+
+    /// Returns the thread that called `on_ready` for `data`, if any.
+    fn ready_call(data: usize) -> Option<ThreadId> {
+        READY_CALLS.lock().unwrap().iter().find(|(d, _)| *d == data).map(|(_, id)| *id)
+    }
+
+    /// Waits until `on_ready` is called for `data` (on the executor thread), and
+    /// returns the thread that called it.
+    fn wait_for_ready_call(data: usize) -> ThreadId {
+        let deadline = Instant::now() + Duration::from_secs(10);
+        loop {
+            if let Some(thread_id) = ready_call(data) {
+                return thread_id;
+            }
+            assert!(Instant::now() < deadline, "on_ready({data}) wasn't called");
+            thread::sleep(Duration::from_millis(1));
+        }
+    }
+
+    fn into_raw_for_test<F: Future + Send + 'static>(future: F) -> (*mut c_void, PollFn, DropFn)
+    where
+        F::Output: Send,
+    {
+        let mut poll = MaybeUninit::uninit();
+        let mut drop = MaybeUninit::uninit();
+        let future = into_raw(future, &mut poll, &mut drop);
+        unsafe { (future, poll.assume_init(), drop.assume_init()) }
+    }
+
+    #[test]
+    fn test_ready_future() {
+        let (future, poll, drop) = into_raw_for_test(async { 42 });
+        let mut out = 0i32;
+        unsafe {
+            assert!(poll(future, &mut out as *mut i32 as *mut c_void, on_ready, 1 as *mut c_void));
+            drop(future);
+        }
+        assert_eq!(out, 42);
+        assert_eq!(ready_call(1), None);
+    }
+
+    #[test]
+    fn test_pending_future() {
+        let channel = Arc::new(Channel::default());
+        let (future, poll, drop) = into_raw_for_test(channel.clone().recv());
+        let mut out = 0i32;
+        let out_ptr = &mut out as *mut i32 as *mut c_void;
+        unsafe {
+            assert!(!poll(future, out_ptr, on_ready, 2 as *mut c_void));
+            assert_eq!(ready_call(2), None);
+
+            // Schedules the future to be polled on the executor thread, which then
+            // calls `on_ready`.
+            channel.send(42);
+            assert_ne!(wait_for_ready_call(2), thread::current().id());
+
+            assert!(poll(future, out_ptr, on_ready, 2 as *mut c_void));
+            drop(future);
+        }
+        assert_eq!(out, 42);
+    }
+
+    #[test]
+    fn test_dropped_pending_future() {
+        let channel = Arc::new(Channel::default());
+        let (future, poll, drop) = into_raw_for_test(channel.clone().recv());
+        unsafe {
+            assert!(!poll(future, core::ptr::null_mut(), on_ready, 3 as *mut c_void));
+            drop(future);
+        }
+        // The future has been dropped, and held the only other reference.
+        assert_eq!(Arc::strong_count(&channel), 1);
+        channel.send(42);
+        assert_eq!(ready_call(3), None);
+    }
+
+    #[test]
+    fn test_woken_while_polled() {
+        let mut first_poll = true;
+        let future = core::future::poll_fn(move |cx| {
+            if first_poll {
+                first_poll = false;
+                cx.waker().wake_by_ref();
+                Poll::Pending
+            } else {
+                Poll::Ready(())
+            }
+        });
+        let (future, poll, drop) = into_raw_for_test(future);
+        unsafe {
+            // Polled again without returning, rather than calling `on_ready` from
+            // within `poll`.
+            assert!(poll(future, core::ptr::null_mut(), on_ready, 4 as *mut c_void));
+            drop(future);
+        }
+        assert_eq!(ready_call(4), None);
+    }
+
+    #[test]
+    fn test_woken_while_holding_a_lock_the_future_takes() {
+        let channel = Arc::new(Channel::default());
+        let (future, poll, drop) = into_raw_for_test(channel.clone().recv());
+        let mut out = 0i32;
+        let out_ptr = &mut out as *mut i32 as *mut c_void;
+        unsafe {
+            assert!(!poll(future, out_ptr, on_ready, 5 as *mut c_void));
+            {
+                // Polling the future inline would deadlock on `channel.value`.
+                let mut state = channel.value.lock().unwrap();
+                state.0 = Some(42);
+                state.1.take().unwrap().wake();
+            }
+            wait_for_ready_call(5);
+            assert!(poll(future, out_ptr, on_ready, 5 as *mut c_void));
+            drop(future);
+        }
+        assert_eq!(out, 42);
+    }
+}
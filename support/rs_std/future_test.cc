@@ -0,0 +1,118 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "support/rs_std/future.h"
+
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+static_assert(!std::is_copy_constructible_v<rs_std::Future<std::int32_t>>);
+static_assert(std::is_nothrow_move_constructible_v<rs_std::Future<void>>);
+
+// Stands in for a Rust future, which is ready once `Complete` is called.
+struct FakeFuture {
+  bool ready = false;
+  std::int32_t value = 0;
+  void (*on_ready)(void*) = nullptr;
+  void* data = nullptr;
+  int num_drop_calls = 0;
+
+  void Complete(std::int32_t v) {
+    ready = true;
+    value = v;
+    on_ready(data);
+  }
+};
+
+bool Poll(void* future, void* out, void (*on_ready)(void*), void* data) {
+  FakeFuture& fake = *static_cast<FakeFuture*>(future);
+  if (!fake.ready) {
+    fake.on_ready = on_ready;
+    fake.data = data;
+    return false;
+  }
+  if (out != nullptr) *static_cast<std::int32_t*>(out) = fake.value;
+  return true;
+}
+
+void Drop(void* future) { ++static_cast<FakeFuture*>(future)->num_drop_calls; }
+
+// Stands in for a `std::coroutine_handle`, so that the test doesn't need
+// C++20.
+struct FakeCoroutine {
+  int num_resumes = 0;
+};
+
+class FakeHandle {
+ public:
+  explicit FakeHandle(FakeCoroutine* coroutine) : coroutine_(coroutine) {}
+  static FakeHandle from_address(void* address) {
+    return FakeHandle(static_cast<FakeCoroutine*>(address));
+  }
+  void* address() const { return coroutine_; }
+  void resume() { ++coroutine_->num_resumes; }
+
+ private:
+  FakeCoroutine* coroutine_;
+};
+
+TEST(FutureTest, ReadyWithoutSuspending) {
+  FakeFuture fake;
+  fake.ready = true;
+  fake.value = 42;
+  FakeCoroutine coroutine;
+  {
+    rs_std::Future<std::int32_t> future(&fake, Poll, Drop);
+    EXPECT_FALSE(future.await_ready());
+    EXPECT_FALSE(future.await_suspend(FakeHandle(&coroutine)));
+    EXPECT_EQ(42, future.await_resume());
+  }
+  EXPECT_EQ(0, coroutine.num_resumes);
+  EXPECT_EQ(1, fake.num_drop_calls);
+}
+
+TEST(FutureTest, SuspendsUntilReady) {
+  FakeFuture fake;
+  FakeCoroutine coroutine;
+  rs_std::Future<std::int32_t> future(&fake, Poll, Drop);
+  EXPECT_TRUE(future.await_suspend(FakeHandle(&coroutine)));
+  EXPECT_EQ(0, coroutine.num_resumes);
+
+  fake.Complete(42);
+  EXPECT_EQ(1, coroutine.num_resumes);
+  EXPECT_EQ(42, future.await_resume());
+}
+
+TEST(FutureTest, Void) {
+  FakeFuture fake;
+  FakeCoroutine coroutine;
+  rs_std::Future<void> future(&fake, Poll, Drop);
+  EXPECT_TRUE(future.await_suspend(FakeHandle(&coroutine)));
+  fake.Complete(42);
+  EXPECT_EQ(1, coroutine.num_resumes);
+  future.await_resume();
+}
+
+TEST(FutureTest, MoveDropsTheFutureOnce) {
+  FakeFuture fake;
+  {
+    rs_std::Future<std::int32_t> future(&fake, Poll, Drop);
+    rs_std::Future<std::int32_t> moved = std::move(future);
+    EXPECT_EQ(0, fake.num_drop_calls);
+  }
+  EXPECT_EQ(1, fake.num_drop_calls);
+
+  FakeFuture other_fake;
+  rs_std::Future<std::int32_t> future(&fake, Poll, Drop);
+  future = rs_std::Future<std::int32_t>(&other_fake, Poll, Drop);
+  EXPECT_EQ(2, fake.num_drop_calls);
+  EXPECT_EQ(0, other_fake.num_drop_calls);
+}
+
+}  // namespace
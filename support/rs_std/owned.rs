@@ -0,0 +1,106 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+//! The Rust side of `rs_std::Vec<T>`, `rs_std::String`, and `rs_std::Box<T>`
+//! (see `vec.h`, `rs_string.h`, and `box.h`).
+//!
+//! The C++ bindings of a Rust function returning a `Vec<T>`, a `String`, or a
+//! `Box<T>` hand the raw parts of the returned value to C++, without copying
+//! the elements (or the pointee), together with a `drop` function instantiated
+//! for its type.  C++ calls `drop` once, to give the value back to Rust.
+
+use core::mem::ManuallyDrop;
+
+/// The raw parts of a `Vec<T>` (or of a `String`, with `T = u8`), with the same
+/// layout as `rs_std::Vec<T>::RawParts`.
+#[repr(C)]
+pub struct RawVec<T> {
+    pub data: *mut T,
+    pub size: usize,
+    pub capacity: usize,
+    pub drop: unsafe extern "C" fn(data: *mut T, size: usize, capacity: usize),
+}
+
+/// The raw parts of a `Box<T>`, with the same layout as
+/// `rs_std::Box<T>::RawParts`.
+#[repr(C)]
+pub struct RawBox<T> {
+    pub ptr: *mut T,
+    pub drop: unsafe extern "C" fn(ptr: *mut T),
+}
+
+unsafe extern "C" fn drop_vec<T>(data: *mut T, size: usize, capacity: usize) {
+    drop(Vec::from_raw_parts(data, size, capacity))
+}
+
+unsafe extern "C" fn drop_box<T>(ptr: *mut T) {
+    drop(Box::from_raw(ptr))
+}
+
+/// Leaks `vec` into raw parts, which `RawVec::drop` turns back into a `Vec<T>`
+/// (and drops).
+pub fn vec_into_raw<T>(vec: Vec<T>) -> RawVec<T> {
+    let mut vec = ManuallyDrop::new(vec);
+    RawVec {
+        data: vec.as_mut_ptr(),
+        size: vec.len(),
+        capacity: vec.capacity(),
+        drop: drop_vec::<T>,
+    }
+}
+
+/// Same as `vec_into_raw`, for the UTF-8 bytes of `string`.
+pub fn string_into_raw(string: String) -> RawVec<u8> {
+    vec_into_raw(string.into_bytes())
+}
+
+/// Leaks `boxed` into raw parts, which `RawBox::drop` turns back into a
+/// `Box<T>` (and drops).
+pub fn box_into_raw<T>(boxed: Box<T>) -> RawBox<T> {
+    RawBox { ptr: Box::into_raw(boxed), drop: drop_box::<T> }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+    use std::rc::Rc;
+
+    #[test]
+    fn test_vec_round_trip() {
+        let element = Rc::new(42);
+        let raw = vec_into_raw(vec![element.clone(), element.clone()]);
+        assert_eq!(raw.size, 2);
+        assert!(raw.capacity >= 2);
+        assert_eq!(unsafe { **raw.data.add(1) }, 42);
+        assert_eq!(Rc::strong_count(&element), 3);
+        unsafe { (raw.drop)(raw.data, raw.size, raw.capacity) };
+        assert_eq!(Rc::strong_count(&element), 1);
+    }
+
+    #[test]
+    fn test_empty_vec() {
+        let raw = vec_into_raw(Vec::<u64>::new());
+        assert_eq!(raw.size, 0);
+        assert!(!raw.data.is_null());
+        unsafe { (raw.drop)(raw.data, raw.size, raw.capacity) };
+    }
+
+    #[test]
+    fn test_string() {
+        let raw = string_into_raw(String::from("abc"));
+        let bytes = unsafe { core::slice::from_raw_parts(raw.data, raw.size) };
+        assert_eq!(bytes, b"abc");
+        unsafe { (raw.drop)(raw.data, raw.size, raw.capacity) };
+    }
+
+    #[test]
+    fn test_box() {
+        let pointee = Rc::new(42);
+        let raw = box_into_raw(Box::new(pointee.clone()));
+        assert_eq!(unsafe { **raw.ptr }, 42);
+        assert_eq!(Rc::strong_count(&pointee), 2);
+        unsafe { (raw.drop)(raw.ptr) };
+        assert_eq!(Rc::strong_count(&pointee), 1);
+    }
+}
@@ -5,11 +5,17 @@
 #ifndef CRUBIT_SUPPORT_RS_STD_CHAR_H_
 #define CRUBIT_SUPPORT_RS_STD_CHAR_H_
 
+#include <cstddef>
 #include <cstdint>
 #include <optional>
 
+#if __has_include(<span>)
+#include <span>
+#endif
+
 #include "absl/base/optimization.h"
 #include "support/internal/attribute_macros.h"
+#include "support/rs_std/slice_ref.h"
 
 namespace rs_std {
 
@@ -56,6 +62,50 @@ class CRUBIT_INTERNAL_RUST_TYPE("char") CRUBIT_INTERNAL_SAME_ABI rs_char final {
     return from_u32_unchecked(c);
   }
 
+  // Returns whether each of the `size` code points starting at `data` is a
+  // valid `rs_std::rs_char` (see `from_u32`).
+  //
+  // Unlike calling `from_u32` for each code point, this doesn't branch per
+  // code point, so that compilers can vectorize the checks: large buffers
+  // (e.g. a `std::u32string`) are validated at close to memory bandwidth.
+  static constexpr bool validate_span(const char32_t* data, std::size_t size) {
+    // Checks a block at a time, so that invalid input is still detected
+    // early without adding a branch to the vectorized loop.
+    constexpr std::size_t kBlockSize = 256;
+    for (std::size_t block = 0; block < size; block += kBlockSize) {
+      std::size_t block_end =
+          size - block < kBlockSize ? size : block + kBlockSize;
+      bool invalid = false;
+      for (std::size_t i = block; i < block_end; ++i) {
+        std::uint32_t c = data[i];
+        // `c - 0xd800 < 0x800` is `0xd800 <= c && c <= 0xdfff` without a
+        // second comparison.
+        invalid |= (c > 0x10ffff) | (c - 0xd800 < 0x800);
+      }
+      if (ABSL_PREDICT_FALSE(invalid)) return false;
+    }
+    return true;
+  }
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+  static constexpr bool validate_span(std::span<const char32_t> span) {
+    return validate_span(span.data(), span.size());
+  }
+#endif
+
+  // Returns the `size` code points starting at `data` as a slice of
+  // `rs_std::rs_char` (i.e. a Rust `&[char]`), without copying them, or
+  // `std::nullopt` if any of them is not a valid `rs_std::rs_char`.
+  //
+  // This mirrors `from_u32` for a whole buffer: `rs_std::rs_char` has the
+  // same ABI as `char32_t`.
+  static std::optional<SliceRef<const rs_char>> from_u32_span(
+      const char32_t* data, std::size_t size) {
+    if (!validate_span(data, size)) return std::nullopt;
+    return SliceRef<const rs_char>(reinterpret_cast<const rs_char*>(data),
+                                   size);
+  }
+
   constexpr rs_char(const rs_char&) = default;
   constexpr rs_char& operator=(const rs_char&) = default;
   constexpr rs_char(rs_char&&) = default;
@@ -113,6 +163,9 @@ class CRUBIT_INTERNAL_RUST_TYPE("char") CRUBIT_INTERNAL_SAME_ABI rs_char final {
 // 'const rs_char'.
 constexpr rs_char rs_char::MAX = rs_char::from_u32_unchecked(0x10ffff);
 
+static_assert(sizeof(rs_char) == sizeof(char32_t));
+static_assert(alignof(rs_char) == alignof(char32_t));
+
 }  // namespace rs_std
 
 #endif  // CRUBIT_SUPPORT_RS_STD_CHAR_H_
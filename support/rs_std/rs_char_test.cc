@@ -7,6 +7,7 @@
 #include <stdint.h>
 
 #include <optional>
+#include <string>
 #include <type_traits>
 
 #include "gtest/gtest.h"
@@ -168,6 +169,39 @@ TEST(RsCharTest, ComparisonWithAnotherRsChar) {
   EXPECT_TRUE(*b > *a);
 }
 
+TEST(RsCharTest, ValidateSpan) {
+  std::u32string valid = U"abc🦀";
+  EXPECT_TRUE(rs_std::rs_char::validate_span(valid.data(), valid.size()));
+  EXPECT_TRUE(rs_std::rs_char::validate_span(nullptr, 0));
+
+  // Invalid values, also past the first block of code points.
+  for (char32_t invalid : {char32_t{0xd800}, char32_t{0xdfff},
+                           char32_t{0x110000}, char32_t{0xffffffff}}) {
+    std::u32string s(1000, U'a');
+    s[700] = invalid;
+    EXPECT_FALSE(rs_std::rs_char::validate_span(s.data(), s.size()));
+    EXPECT_TRUE(rs_std::rs_char::validate_span(s.data(), 700));
+  }
+
+  // Values right next to the invalid ranges.
+  std::u32string boundaries = {0xd7ff, 0xe000, 0x10ffff};
+  EXPECT_TRUE(
+      rs_std::rs_char::validate_span(boundaries.data(), boundaries.size()));
+}
+
+TEST(RsCharTest, FromU32Span) {
+  std::u32string s = U"abc";
+  std::optional<rs_std::SliceRef<const rs_std::rs_char>> chars =
+      rs_std::rs_char::from_u32_span(s.data(), s.size());
+  ASSERT_TRUE(chars.has_value());
+  ASSERT_EQ(chars->size(), 3u);
+  EXPECT_EQ(static_cast<const void*>(chars->data()), s.data());
+  EXPECT_EQ('b', uint32_t{(*chars)[1]});
+
+  s[1] = 0xd800;
+  EXPECT_FALSE(rs_std::rs_char::from_u32_span(s.data(), s.size()).has_value());
+}
+
 TEST(RsCharTest, DefaultConstructedValue) {
   rs_std::rs_char c;
   EXPECT_EQ(0, uint32_t{c});
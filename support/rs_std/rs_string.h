@@ -0,0 +1,46 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_SUPPORT_RS_STD_RS_STRING_H_
+#define CRUBIT_SUPPORT_RS_STD_RS_STRING_H_
+
+#include <cstddef>
+#include <string_view>
+
+#include "support/rs_std/vec.h"
+
+namespace rs_std {
+
+// `rs_std::String` owns a Rust `String` returned by a Rust function.  Like
+// `rs_std::Vec<T>`, it accesses the UTF-8 bytes in place (converting to
+// `std::string_view` doesn't copy them), and drops the Rust allocation when
+// destroyed.
+class String final {
+ public:
+  // Rust `String`s are returned as the raw parts of their `Vec<u8>`.
+  using RawParts = Vec<char>::RawParts;
+
+  // Takes ownership of the Rust `String` with the raw parts `raw`.  Only meant
+  // to be called by the generated bindings, which get `raw` from Rust.
+  explicit String(RawParts raw) : bytes_(raw) {}
+
+  String(String&&) = default;
+  String& operator=(String&&) = default;
+
+  const char* data() const { return bytes_.data(); }
+  std::size_t size() const { return bytes_.size(); }
+  bool empty() const { return bytes_.empty(); }
+
+  // Returns a view of the bytes of the string (without copying them).
+  operator std::string_view() const {  // NOLINT(google-explicit-constructor)
+    return std::string_view(bytes_.data(), bytes_.size());
+  }
+
+ private:
+  Vec<char> bytes_;
+};
+
+}  // namespace rs_std
+
+#endif  // CRUBIT_SUPPORT_RS_STD_RS_STRING_H_
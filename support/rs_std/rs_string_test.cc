@@ -0,0 +1,42 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "support/rs_std/rs_string.h"
+
+#include <cstddef>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+static_assert(!std::is_copy_constructible_v<rs_std::String>);
+static_assert(std::is_nothrow_move_constructible_v<rs_std::String>);
+
+int num_drop_calls = 0;
+
+void Drop(char*, std::size_t, std::size_t) { ++num_drop_calls; }
+
+TEST(RsStringTest, ViewsTheBytesInPlace) {
+  num_drop_calls = 0;
+  std::string bytes = "Hello, world!";
+  {
+    rs_std::String string(rs_std::String::RawParts{bytes.data(), bytes.size(),
+                                                   bytes.capacity(), Drop});
+    std::string_view view = string;
+    EXPECT_EQ(bytes.data(), view.data());
+    EXPECT_EQ("Hello, world!", view);
+
+    rs_std::String moved = std::move(string);
+    EXPECT_TRUE(string.empty());  // NOLINT(bugprone-use-after-move)
+    EXPECT_EQ(bytes.data(), moved.data());
+    EXPECT_EQ(0, num_drop_calls);
+  }
+  EXPECT_EQ(1, num_drop_calls);
+}
+
+}  // namespace
@@ -0,0 +1,91 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_SUPPORT_RS_STD_SLICE_REF_H_
+#define CRUBIT_SUPPORT_RS_STD_SLICE_REF_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+namespace rs_std {
+
+// `rs_std::SliceRef<T>` is a C++ representation of the Rust slice references:
+// `SliceRef<const T>` represents `&[T]`, and `SliceRef<T>` represents
+// `&mut [T]`.  `rust_builtin_type_abi_assumptions.md` documents the ABI
+// compatibility of these types.
+//
+// Like a `std::span<T>`, a `SliceRef<T>` doesn't own the elements, and
+// converting between the two doesn't copy the elements.  Unlike a
+// `std::span<T>`, a `SliceRef<T>` never holds a null pointer: Rust requires a
+// non-null, aligned pointer even for empty slices.
+//
+// The lifetime of the elements is not checked: it is up to the caller to
+// ensure that they outlive the `SliceRef` (and, for `SliceRef<T>` with a
+// non-const `T`, that they are not accessed through another reference while
+// Rust uses the `&mut [T]`).
+template <typename T>
+class SliceRef final {
+ public:
+  // Creates an empty slice.
+  SliceRef() : SliceRef(nullptr, 0) {}
+
+  // Creates a slice of the `size` elements starting at `data`.  `data` may be
+  // null only if `size` is 0.
+  SliceRef(T* data, std::size_t size)
+      : data_(data == nullptr ? Dangling() : data), size_(size) {}
+
+  // Creates a `SliceRef<const T>` from a `SliceRef<T>` (i.e. a `&[T]` from a
+  // `&mut [T]`).
+  template <typename U, typename = std::enable_if_t<
+                            std::is_same_v<T, const U> && !std::is_const_v<U>>>
+  SliceRef(SliceRef<U> other)  // NOLINT(google-explicit-constructor)
+      : SliceRef(other.data(), other.size()) {}
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+  // Creates a slice of the elements of `span` (without copying them).
+  SliceRef(std::span<T> span)  // NOLINT(google-explicit-constructor)
+      : SliceRef(span.data(), span.size()) {}
+
+  // Returns a span of the elements of the slice (without copying them).
+  operator std::span<T>() const {  // NOLINT(google-explicit-constructor)
+    return std::span<T>(data_, size_);
+  }
+#endif
+
+  SliceRef(const SliceRef&) = default;
+  SliceRef& operator=(const SliceRef&) = default;
+  SliceRef(SliceRef&&) = default;
+  SliceRef& operator=(SliceRef&&) = default;
+  ~SliceRef() = default;
+
+  T* data() const { return data_; }
+  std::size_t size() const { return size_; }
+  bool empty() const { return size_ == 0; }
+
+  T* begin() const { return data_; }
+  T* end() const { return data_ + size_; }
+  T& operator[](std::size_t index) const { return data_[index]; }
+
+ private:
+  // Mimics Rust's `core::ptr::NonNull::dangling`.
+  static T* Dangling() {
+    return reinterpret_cast<T*>(static_cast<std::uintptr_t>(alignof(T)));
+  }
+
+  // The order of the fields matches the order of the scalars of the Rust slice
+  // reference (a pointer, and then a length) - this is verified by the
+  // `layout.abi()` assertion in `format_ty_for_cc` in
+  // `cc_bindings_from_rs/bindings.rs`.
+  T* data_;
+  std::size_t size_;
+};
+
+}  // namespace rs_std
+
+#endif  // CRUBIT_SUPPORT_RS_STD_SLICE_REF_H_
@@ -0,0 +1,95 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "support/rs_std/slice_ref.h"
+
+#include <stdint.h>
+
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// Check that `rs_std::SliceRef` is trivially destructible, copyable, and
+// moveable (and therefore trivial for the purposes of calls).
+static_assert(std::is_trivially_destructible_v<rs_std::SliceRef<const int>>);
+static_assert(
+    std::is_trivially_copy_constructible_v<rs_std::SliceRef<const int>>);
+static_assert(std::is_trivially_copy_assignable_v<rs_std::SliceRef<const int>>);
+static_assert(
+    std::is_trivially_move_constructible_v<rs_std::SliceRef<const int>>);
+static_assert(std::is_trivially_move_assignable_v<rs_std::SliceRef<const int>>);
+
+// Layout assertions.
+//
+// Equivalent layout and ABI assertions are also checked on Rust side in
+// `format_ty_for_cc` in `cc_bindings_from_rs/bindings.rs`.  Under the System V
+// ABI a trivial struct with a pointer and a `size_t` is passed in two INTEGER
+// eightbytes - the same as the `ScalarPair` ABI of Rust slice references.
+static_assert(sizeof(rs_std::SliceRef<const int>) == 2 * sizeof(void*));
+static_assert(alignof(rs_std::SliceRef<const int>) == alignof(void*));
+static_assert(std::is_standard_layout_v<rs_std::SliceRef<const int>>);
+
+// `&mut [T]` converts to `&[T]`, but not the other way around.
+static_assert(std::is_convertible_v<rs_std::SliceRef<int>,
+                                    rs_std::SliceRef<const int>>);
+static_assert(!std::is_convertible_v<rs_std::SliceRef<const int>,
+                                     rs_std::SliceRef<int>>);
+
+TEST(SliceRefTest, Empty) {
+  rs_std::SliceRef<const int32_t> s;
+  EXPECT_TRUE(s.empty());
+  EXPECT_EQ(0u, s.size());
+  EXPECT_EQ(s.begin(), s.end());
+
+  // Rust requires a non-null, aligned pointer even for empty slices.
+  EXPECT_NE(nullptr, s.data());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(s.data()) % alignof(int32_t));
+}
+
+TEST(SliceRefTest, EmptyFromNull) {
+  rs_std::SliceRef<const int64_t> s(nullptr, 0);
+  EXPECT_TRUE(s.empty());
+  EXPECT_NE(nullptr, s.data());
+  EXPECT_EQ(0u, reinterpret_cast<uintptr_t>(s.data()) % alignof(int64_t));
+}
+
+TEST(SliceRefTest, NoCopies) {
+  std::vector<int> v = {1, 2, 3};
+  rs_std::SliceRef<int> s(v.data(), v.size());
+  EXPECT_EQ(v.data(), s.data());
+  EXPECT_EQ(3u, s.size());
+  EXPECT_FALSE(s.empty());
+
+  s[1] = 42;
+  EXPECT_EQ(42, v[1]);
+
+  rs_std::SliceRef<const int> const_s = s;
+  EXPECT_EQ(v.data(), const_s.data());
+  int sum = 0;
+  for (int i : const_s) sum += i;
+  EXPECT_EQ(1 + 42 + 3, sum);
+}
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+TEST(SliceRefTest, Span) {
+  std::vector<int> v = {1, 2, 3};
+  rs_std::SliceRef<const int> s = std::span<const int>(v);
+  EXPECT_EQ(v.data(), s.data());
+  EXPECT_EQ(3u, s.size());
+
+  std::span<const int> span = s;
+  EXPECT_EQ(v.data(), span.data());
+  EXPECT_EQ(3u, span.size());
+
+  rs_std::SliceRef<const int> empty = std::span<const int>();
+  EXPECT_NE(nullptr, empty.data());
+  EXPECT_TRUE(empty.empty());
+}
+#endif
+
+}  // namespace
@@ -0,0 +1,132 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_SUPPORT_RS_STD_STR_REF_H_
+#define CRUBIT_SUPPORT_RS_STD_STR_REF_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string_view>
+
+#include "absl/base/optimization.h"
+
+namespace rs_std {
+
+// `rs_std::StrRef` is a C++ representation of the `&str` type from Rust.
+// `rust_builtin_type_abi_assumptions.md` documents the ABI compatibility of
+// these types.
+//
+// Like a `std::string_view`, a `StrRef` doesn't own the characters, and
+// converting between the two doesn't copy the characters.  Unlike a
+// `std::string_view`, a `StrRef`
+// - always holds valid UTF-8 (which is verified by `from_utf8`),
+// - never holds a null pointer (Rust requires a non-null pointer even for
+//   empty strings).
+class StrRef final {
+ public:
+  // Creates an empty string.
+  constexpr StrRef() = default;
+
+  // Converts a `std::string_view` into a `rs_std::StrRef`, without copying
+  // the characters.
+  //
+  // Returns `std::nullopt` if `s` is not valid UTF-8: see
+  // https://doc.rust-lang.org/reference/behavior-considered-undefined.html
+  // which documents that undefined behavior may result in presence of
+  // "Invalid values in ... `str`".
+  //
+  // This function mimics Rust's `core::str::from_utf8`:
+  // https://doc.rust-lang.org/core/str/fn.from_utf8.html
+  static constexpr std::optional<StrRef> from_utf8(std::string_view s) {
+    if (ABSL_PREDICT_FALSE(!IsValidUtf8(s))) {
+      return std::nullopt;
+    }
+    return from_utf8_unchecked(s);
+  }
+
+  constexpr StrRef(const StrRef&) = default;
+  constexpr StrRef& operator=(const StrRef&) = default;
+  constexpr StrRef(StrRef&&) = default;
+  constexpr StrRef& operator=(StrRef&&) = default;
+  ~StrRef() = default;
+
+  // Returns a `std::string_view` of the characters (without copying them).
+  constexpr operator std::string_view() const {  // NOLINT
+    return std::string_view(data_, size_);
+  }
+
+  constexpr const char* data() const { return data_; }
+  constexpr std::size_t size() const { return size_; }
+  constexpr bool empty() const { return size_ == 0; }
+
+ private:
+  // This function mimics Rust's `core::str::from_utf8_unchecked`:
+  // https://doc.rust-lang.org/core/str/fn.from_utf8_unchecked.html
+  //
+  // TODO(b/254095482): Figure out how to annotate/expose unsafe functions in
+  // C++ and then make this method public.
+  static constexpr StrRef from_utf8_unchecked(std::string_view s) {
+    // Empty `std::string_view`s may have a null `data()`, which is never valid
+    // for a Rust `&str`: keep the default, non-null `data_` for them.
+    return s.empty() ? StrRef() : StrRef(s.data(), s.size());
+  }
+
+  // Private constructor - intended to only be used from `from_utf8_unchecked`.
+  constexpr StrRef(const char* data, std::size_t size)
+      : data_(data), size_(size) {}
+
+  // Returns true if `s` is well-formed UTF-8 (as defined by
+  // https://www.unicode.org/versions/Unicode15.0.0/ch03.pdf, table 3-7): no
+  // overlong encodings, no surrogates, and no code points above U+10FFFF.
+  static constexpr bool IsValidUtf8(std::string_view s) {
+    std::size_t i = 0;
+    while (i < s.size()) {
+      auto byte = [&](std::size_t j) -> std::uint8_t {
+        return static_cast<std::uint8_t>(s[j]);
+      };
+      std::uint8_t b0 = byte(i);
+      if (b0 < 0x80) {
+        i += 1;
+        continue;
+      }
+      std::size_t len = 0;
+      std::uint8_t min = 0x80;
+      std::uint8_t max = 0xbf;
+      if (b0 >= 0xc2 && b0 <= 0xdf) {
+        len = 2;
+      } else if (b0 >= 0xe0 && b0 <= 0xef) {
+        len = 3;
+        if (b0 == 0xe0) min = 0xa0;  // Overlong encodings.
+        if (b0 == 0xed) max = 0x9f;  // Surrogates.
+      } else if (b0 >= 0xf0 && b0 <= 0xf4) {
+        len = 4;
+        if (b0 == 0xf0) min = 0x90;  // Overlong encodings.
+        if (b0 == 0xf4) max = 0x8f;  // Code points above U+10FFFF.
+      } else {
+        return false;
+      }
+      if (s.size() - i < len) return false;
+      if (byte(i + 1) < min || byte(i + 1) > max) return false;
+      for (std::size_t j = 2; j < len; ++j) {
+        if (byte(i + j) < 0x80 || byte(i + j) > 0xbf) return false;
+      }
+      i += len;
+    }
+    return true;
+  }
+
+  // The order of the fields matches the order of the scalars of the Rust
+  // `&str` (a pointer, and then a length) - this is verified by the
+  // `layout.abi()` assertion in `format_ty_for_cc` in
+  // `cc_bindings_from_rs/bindings.rs`.
+  //
+  // `""` provides a non-null pointer for empty strings.
+  const char* data_ = "";
+  std::size_t size_ = 0;
+};
+
+}  // namespace rs_std
+
+#endif  // CRUBIT_SUPPORT_RS_STD_STR_REF_H_
@@ -0,0 +1,90 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "support/rs_std/str_ref.h"
+
+#include <optional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+#include "gtest/gtest.h"
+
+namespace {
+
+// Check that `rs_std::StrRef` is trivially destructible, copyable, and
+// moveable (and therefore trivial for the purposes of calls).
+static_assert(std::is_trivially_destructible_v<rs_std::StrRef>);
+static_assert(std::is_trivially_copy_constructible_v<rs_std::StrRef>);
+static_assert(std::is_trivially_copy_assignable_v<rs_std::StrRef>);
+static_assert(std::is_trivially_move_constructible_v<rs_std::StrRef>);
+static_assert(std::is_trivially_move_assignable_v<rs_std::StrRef>);
+
+// Layout assertions - see the comments in `slice_ref_test.cc`.
+static_assert(sizeof(rs_std::StrRef) == 2 * sizeof(void*));
+static_assert(alignof(rs_std::StrRef) == alignof(void*));
+static_assert(std::is_standard_layout_v<rs_std::StrRef>);
+
+TEST(StrRefTest, Empty) {
+  rs_std::StrRef s;
+  EXPECT_TRUE(s.empty());
+  EXPECT_EQ(0u, s.size());
+  EXPECT_NE(nullptr, s.data());
+  EXPECT_EQ("", std::string_view(s));
+}
+
+TEST(StrRefTest, EmptyFromNull) {
+  std::optional<rs_std::StrRef> s = rs_std::StrRef::from_utf8({});
+  ASSERT_TRUE(s.has_value());
+  EXPECT_TRUE(s->empty());
+  EXPECT_NE(nullptr, s->data());
+}
+
+TEST(StrRefTest, NoCopies) {
+  std::string str = "foo";
+  std::optional<rs_std::StrRef> s = rs_std::StrRef::from_utf8(str);
+  ASSERT_TRUE(s.has_value());
+  EXPECT_EQ(str.data(), s->data());
+  EXPECT_EQ(3u, s->size());
+  std::string_view view = *s;
+  EXPECT_EQ(str.data(), view.data());
+  EXPECT_EQ("foo", view);
+}
+
+TEST(StrRefTest, ValidUtf8) {
+  for (std::string_view s : {
+           "ascii",
+           "\xc2\xa9",          // U+00A9 COPYRIGHT SIGN
+           "\xe2\x82\xac",      // U+20AC EURO SIGN
+           "\xed\x9f\xbf",      // U+D7FF (the last one before the surrogates)
+           "\xf0\x9f\xa6\x80",  // U+1F980 CRAB
+           "\xf4\x8f\xbf\xbf",  // U+10FFFF (Rust's `char::MAX`)
+       }) {
+    EXPECT_TRUE(rs_std::StrRef::from_utf8(s).has_value()) << s;
+  }
+}
+
+TEST(StrRefTest, InvalidUtf8) {
+  for (std::string_view s : {
+           "\x80",              // Unexpected continuation byte.
+           "\xc0\x80",          // Overlong encoding of U+0000.
+           "\xe0\x80\x80",      // Overlong encoding of U+0000.
+           "\xed\xa0\x80",      // U+D800 (a surrogate).
+           "\xf4\x90\x80\x80",  // U+110000 (above Rust's `char::MAX`).
+           "\xf5\x80\x80\x80",  // Invalid leading byte.
+           "\xe2\x82",          // Truncated sequence.
+           "\xe2\x28\xa1",      // Invalid continuation byte.
+       }) {
+    EXPECT_FALSE(rs_std::StrRef::from_utf8(s).has_value()) << s;
+  }
+}
+
+TEST(StrRefTest, Constexpr) {
+  constexpr std::optional<rs_std::StrRef> s = rs_std::StrRef::from_utf8("abc");
+  static_assert(s.has_value());
+  static_assert(s->size() == 3);
+  static_assert(!rs_std::StrRef::from_utf8("\xff").has_value());
+}
+
+}  // namespace
@@ -0,0 +1,103 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#ifndef CRUBIT_SUPPORT_RS_STD_VEC_H_
+#define CRUBIT_SUPPORT_RS_STD_VEC_H_
+
+#include <cstddef>
+
+#if __has_include(<span>)
+#include <span>
+#endif
+
+#include "support/rs_std/slice_ref.h"
+
+namespace rs_std {
+
+// `rs_std::Vec<T>` owns a Rust `Vec<T>` returned by a Rust function.  The
+// elements stay in the Rust allocation: they are accessed in place (and
+// converting to `std::span<T>` or `rs_std::SliceRef<T>` doesn't copy them), and
+// they are dropped together with the allocation, by a single call into Rust,
+// when the `Vec` is destroyed.
+//
+// A `Vec` can be moved but not copied, and it can't grow: elements can only be
+// read and assigned.  A moved-from `Vec` is empty.
+template <typename T>
+class Vec final {
+ public:
+  // Drops the Rust `Vec<T>` with the given raw parts (and its elements).
+  using DropFn = void (*)(T* data, std::size_t size, std::size_t capacity);
+
+  // The raw parts of a Rust `Vec<T>`, with the same layout as
+  // `rs_std_owned::RawVec<T>` (see `owned.rs`).
+  struct RawParts {
+    T* data;
+    std::size_t size;
+    std::size_t capacity;
+    DropFn drop;
+  };
+
+  // Takes ownership of the Rust `Vec<T>` with the raw parts `raw`.  Only meant
+  // to be called by the generated bindings, which get `raw` from Rust.
+  explicit Vec(RawParts raw) : raw_(raw) {}
+
+  Vec(const Vec&) = delete;
+  Vec& operator=(const Vec&) = delete;
+
+  Vec(Vec&& other) noexcept : raw_(other.raw_) { other.raw_ = RawParts{}; }
+  Vec& operator=(Vec&& other) noexcept {
+    if (this != &other) {
+      Drop();
+      raw_ = other.raw_;
+      other.raw_ = RawParts{};
+    }
+    return *this;
+  }
+
+  ~Vec() { Drop(); }
+
+  T* data() { return raw_.data; }
+  const T* data() const { return raw_.data; }
+  std::size_t size() const { return raw_.size; }
+  bool empty() const { return raw_.size == 0; }
+
+  T& operator[](std::size_t i) { return raw_.data[i]; }
+  const T& operator[](std::size_t i) const { return raw_.data[i]; }
+
+  T* begin() { return raw_.data; }
+  T* end() { return raw_.data + raw_.size; }
+  const T* begin() const { return raw_.data; }
+  const T* end() const { return raw_.data + raw_.size; }
+
+  // Returns a slice of the elements (without copying them), e.g. to pass them
+  // to a Rust function taking `&[T]` or `&mut [T]`.
+  operator SliceRef<T>() {  // NOLINT(google-explicit-constructor)
+    return SliceRef<T>(raw_.data, raw_.size);
+  }
+  operator SliceRef<const T>() const {  // NOLINT(google-explicit-constructor)
+    return SliceRef<const T>(raw_.data, raw_.size);
+  }
+
+#if defined(__cpp_lib_span) && __cpp_lib_span >= 202002L
+  // Returns a span of the elements (without copying them).
+  operator std::span<T>() {  // NOLINT(google-explicit-constructor)
+    return std::span<T>(raw_.data, raw_.size);
+  }
+  operator std::span<const T>() const {  // NOLINT(google-explicit-constructor)
+    return std::span<const T>(raw_.data, raw_.size);
+  }
+#endif
+
+ private:
+  void Drop() {
+    if (raw_.drop != nullptr) raw_.drop(raw_.data, raw_.size, raw_.capacity);
+    raw_ = RawParts{};
+  }
+
+  RawParts raw_;
+};
+
+}  // namespace rs_std
+
+#endif  // CRUBIT_SUPPORT_RS_STD_VEC_H_
@@ -0,0 +1,92 @@
+// Part of the Crubit project, under the Apache License v2.0 with LLVM
+// Exceptions. See /LICENSE for license information.
+// SPDX-License-Identifier: Apache-2.0 WITH LLVM-exception
+
+#include "support/rs_std/vec.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include "gtest/gtest.h"
+#include "support/rs_std/slice_ref.h"
+
+namespace {
+
+using Vec = rs_std::Vec<std::int32_t>;
+
+static_assert(!std::is_copy_constructible_v<Vec>);
+static_assert(std::is_nothrow_move_constructible_v<Vec>);
+static_assert(std::is_nothrow_move_assignable_v<Vec>);
+
+// Stands in for the Rust allocations, which are "dropped" by clearing them.
+std::vector<std::vector<std::int32_t>> allocations;
+
+void Drop(std::int32_t* data, std::size_t size, std::size_t capacity) {
+  for (std::vector<std::int32_t>& allocation : allocations) {
+    if (allocation.data() == data) {
+      EXPECT_EQ(allocation.size(), size);
+      EXPECT_EQ(allocation.capacity(), capacity);
+      allocation.clear();
+      return;
+    }
+  }
+  ADD_FAILURE() << "Dropped an unknown allocation";
+}
+
+Vec NewVec(std::vector<std::int32_t> elements) {
+  allocations.push_back(std::move(elements));
+  std::vector<std::int32_t>& allocation = allocations.back();
+  return Vec(Vec::RawParts{allocation.data(), allocation.size(),
+                           allocation.capacity(), Drop});
+}
+
+class VecTest : public testing::Test {
+ protected:
+  void SetUp() override {
+    allocations.clear();
+    // Keeps the allocations from moving when `allocations` grows.
+    allocations.reserve(10);
+  }
+};
+
+TEST_F(VecTest, AccessesTheElementsInPlace) {
+  Vec vec = NewVec({1, 2, 3});
+  EXPECT_EQ(allocations[0].data(), vec.data());
+  EXPECT_EQ(3u, vec.size());
+  EXPECT_FALSE(vec.empty());
+  EXPECT_EQ(2, vec[1]);
+
+  vec[1] = 42;
+  EXPECT_EQ(42, allocations[0][1]);
+
+  std::int32_t sum = 0;
+  for (std::int32_t element : vec) sum += element;
+  EXPECT_EQ(46, sum);
+
+  rs_std::SliceRef<const std::int32_t> slice = std::as_const(vec);
+  EXPECT_EQ(vec.data(), slice.data());
+  EXPECT_EQ(3u, slice.size());
+}
+
+TEST_F(VecTest, DropsOnce) {
+  {
+    Vec vec = NewVec({1, 2, 3});
+    Vec moved = std::move(vec);
+    EXPECT_TRUE(vec.empty());  // NOLINT(bugprone-use-after-move)
+    EXPECT_EQ(3u, allocations[0].size());
+  }
+  EXPECT_TRUE(allocations[0].empty());
+}
+
+TEST_F(VecTest, MoveAssignmentDropsTheOldVec) {
+  Vec vec = NewVec({1});
+  vec = NewVec({2, 3});
+  EXPECT_TRUE(allocations[0].empty());
+  EXPECT_EQ(2u, vec.size());
+  EXPECT_EQ(2, vec[0]);
+}
+
+}  // namespace